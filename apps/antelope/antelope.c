@@ -51,6 +51,12 @@ db_init(void)
   index_init();
 }
 
+db_result_t
+db_flush(void)
+{
+  return relation_flush();
+}
+
 void
 db_set_output_function(db_output_function_t f)
 {
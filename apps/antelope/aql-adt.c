@@ -44,6 +44,10 @@
 #define DEBUG   DEBUG_NONE
 #include "net/uip-debug.h"
 
+#if AQL_PARAMETER_LIMIT > 10
+#error "AQL_PARAMETER_LIMIT must not exceed 10"
+#endif
+
 static unsigned char char_buf[DB_MAX_CHAR_SIZE_PER_ROW];
 static uint8_t next_free_offset;
 
@@ -86,6 +90,7 @@ aql_clear(aql_adt_t *adt)
   adt->relation_count = 0;
   adt->attribute_count = 0;
   adt->value_count = 0;
+  adt->parameter_count = 0;
   adt->flags = 0;
   memset(adt->aggregators, 0, sizeof(adt->aggregators));
 }
@@ -120,6 +125,42 @@ aql_add_attribute(aql_adt_t *adt, char *name, domain_t domain,
   return DB_OK;
 }
 
+db_result_t
+aql_set_group_attribute(aql_adt_t *adt, char *name)
+{
+  int i;
+
+  /* Reuse a non-aggregated attribute of the same name. The projected
+     attributes precede those that are only used in the predicate. */
+  for(i = 0; i < AQL_ATTRIBUTE_COUNT(adt); i++) {
+    if(adt->aggregators[i] == AQL_NONE &&
+       strcmp(adt->attributes[i].name, name) == 0) {
+      adt->attributes[i].flags |= ATTRIBUTE_FLAG_GROUP;
+      AQL_SET_FLAG(adt, AQL_FLAG_AGGREGATE | AQL_FLAG_GROUP);
+      return DB_OK;
+    }
+  }
+
+  if(DB_ERROR(aql_add_attribute(adt, name, DOMAIN_UNSPECIFIED, 0, 0))) {
+    return DB_LIMIT_ERROR;
+  }
+  adt->attributes[adt->attribute_count - 1].flags =
+    ATTRIBUTE_FLAG_NO_STORE | ATTRIBUTE_FLAG_GROUP;
+  AQL_SET_FLAG(adt, AQL_FLAG_AGGREGATE | AQL_FLAG_GROUP);
+
+  return DB_OK;
+}
+
+void
+aql_parameter_name(char *name, unsigned parameter)
+{
+  /* Parameters appear as variables named "?0", "?1", and so on
+     in the condition of a statement. */
+  name[0] = '?';
+  name[1] = '0' + parameter;
+  name[2] = '\0';
+}
+
 db_result_t
 aql_add_value(aql_adt_t *adt, domain_t domain, void *value_ptr)
 {
@@ -136,6 +177,10 @@ aql_add_value(aql_adt_t *adt, domain_t domain, void *value_ptr)
   case DOMAIN_INT:
     VALUE_LONG(value) = *(long *)value_ptr;
     break;
+  case DOMAIN_UNSPECIFIED:
+    /* A parameter of a prepared statement, identified by its number. */
+    VALUE_LONG(value) = *(long *)value_ptr;
+    break;
   case DOMAIN_STRING:
     VALUE_STRING(value) = save_char(value_ptr, strlen(value_ptr) + 1);
     if(VALUE_STRING(value) != NULL) {
@@ -45,12 +45,17 @@
 #include "net/uip-debug.h"
 
 #include "index.h"
+#include "lvm.h"
 #include "relation.h"
 #include "result.h"
 #include "aql.h"
 
 static aql_adt_t adt;
 
+/* Marks the LVM variables of a prepared statement that are parameters
+   instead of attributes. */
+#define VARIABLE_PARAMETER	0x80
+
 static void
 clear_handle(db_handle_t *handle)
 {
@@ -112,8 +117,20 @@ aql_execute(db_handle_t *handle, aql_adt_t *adt)
     result = index_create(AQL_GET_INDEX_TYPE(adt), rel, relattr);
     break;
   case AQL_TYPE_CREATE_RELATION:
-    if(relation_create(adt->relations[0], DB_STORAGE) != NULL) {
+    rel = relation_create(adt->relations[0], DB_STORAGE);
+    if(rel != NULL) {
       result = DB_OK;
+      if(adt->flags & AQL_FLAG_DELTA) {
+#if DB_FEATURE_DELTA
+        result = relation_set_delta(rel);
+#else
+        result = DB_IMPLEMENTATION_ERROR;
+#endif /* DB_FEATURE_DELTA */
+        if(DB_ERROR(result)) {
+          relation_remove(adt->relations[0], 1);
+        }
+      }
+      rel = NULL;
     }
     break;
   case AQL_TYPE_REMOVE_ATTRIBUTE:
@@ -205,11 +222,186 @@ db_query(db_handle_t *handle, const char *format, ...)
     return DB_PARSING_ERROR;
   }
 
+  if(adt.parameter_count > 0) {
+    /* Parameters can only be bound to prepared statements. */
+    return DB_ARGUMENT_ERROR;
+  }
+
   /*aql_optimize(&adt);*/
 
   return aql_execute(handle, &adt);
 }
 
+db_result_t
+db_prepare(db_statement_t *statement, const char *format, ...)
+{
+  va_list ap;
+  char query_string[AQL_MAX_QUERY_LENGTH];
+  aql_adt_t *statement_adt;
+  lvm_instance_t *condition;
+  attribute_value_t *value;
+  unsigned char *chars;
+  size_t length;
+  char *name;
+  unsigned id;
+  unsigned i;
+
+  va_start(ap, format);
+  vsnprintf(query_string, sizeof(query_string), format, ap);
+  va_end(ap);
+
+  memset(statement, 0, sizeof(*statement));
+  statement_adt = &statement->adt;
+
+  if(AQL_ERROR(aql_parse(statement_adt, query_string))) {
+    return DB_PARSING_ERROR;
+  }
+
+  /* The string constants are kept in a buffer of the parser, which is
+     overwritten by the next query. */
+  chars = statement->chars;
+  for(i = 0; i < statement_adt->value_count; i++) {
+    value = &statement_adt->values[i];
+    if(value->domain == DOMAIN_STRING) {
+      length = strlen((char *)VALUE_STRING(value)) + 1;
+      if(chars + length > statement->chars + sizeof(statement->chars)) {
+        return DB_LIMIT_ERROR;
+      }
+      memcpy(chars, VALUE_STRING(value), length);
+      VALUE_STRING(value) = chars;
+      chars += length;
+    }
+  }
+
+  /* Likewise, the condition is compiled into a buffer of the parser,
+     and its variables are registered in the LVM. Keep a copy of the
+     bytecode, and record what each variable refers to. */
+  condition = statement_adt->lvm_instance;
+  if(condition != NULL) {
+    length = lvm_get_code_length(condition);
+    if(length > sizeof(statement->code)) {
+      PRINTF("DB: The condition of the statement is too large (%u bytes)\n",
+             (unsigned)length);
+      return DB_LIMIT_ERROR;
+    }
+    memcpy(statement->code, condition->code, length);
+    statement->code_length = length;
+
+    for(id = 0; (name = lvm_get_variable_name(id)) != NULL; id++) {
+      if(name[0] == '?') {
+        statement->variables[id] = VARIABLE_PARAMETER | (name[1] - '0');
+        continue;
+      }
+      for(i = 0; i < statement_adt->attribute_count; i++) {
+        if(strcmp(statement_adt->attributes[i].name, name) == 0) {
+          break;
+        }
+      }
+      if(i == statement_adt->attribute_count) {
+        return DB_IMPLEMENTATION_ERROR;
+      }
+      statement->variables[id] = i;
+    }
+    statement->variable_count = id;
+  }
+
+  return DB_OK;
+}
+
+db_result_t
+db_bind_long(db_statement_t *statement, unsigned parameter, long value)
+{
+  attribute_value_t *parameter_value;
+
+  if(parameter >= statement->adt.parameter_count) {
+    return DB_ARGUMENT_ERROR;
+  }
+
+  /* Integer values are handled like the integer constants of a query. */
+  parameter_value = &statement->parameters[parameter];
+  parameter_value->domain = DOMAIN_INT;
+  VALUE_LONG(parameter_value) = value;
+
+  return DB_OK;
+}
+
+db_result_t
+db_bind_string(db_statement_t *statement, unsigned parameter, char *value)
+{
+  attribute_value_t *parameter_value;
+
+  if(parameter >= statement->adt.parameter_count) {
+    return DB_ARGUMENT_ERROR;
+  }
+
+  /* The string is not copied, so it must remain valid until the
+     statement has been executed. */
+  parameter_value = &statement->parameters[parameter];
+  parameter_value->domain = DOMAIN_STRING;
+  VALUE_STRING(parameter_value) = (unsigned char *)value;
+
+  return DB_OK;
+}
+
+db_result_t
+db_execute(db_handle_t *handle, db_statement_t *statement)
+{
+  attribute_value_t *parameter;
+  lvm_instance_t *condition;
+  char parameter_name[3];
+  char *name;
+  unsigned i;
+
+  /* Execute a copy of the statement, since the execution of a query
+     may modify its representation. */
+  memcpy(&adt, &statement->adt, sizeof(adt));
+
+  for(i = 0; i < adt.parameter_count; i++) {
+    if(statement->parameters[i].domain == DOMAIN_UNSPECIFIED) {
+      PRINTF("DB: Parameter %u is not bound\n", i);
+      return DB_ARGUMENT_ERROR;
+    }
+  }
+
+  for(i = 0; i < adt.value_count; i++) {
+    if(adt.values[i].domain == DOMAIN_UNSPECIFIED) {
+      parameter = &statement->parameters[VALUE_LONG(&adt.values[i])];
+      memcpy(&adt.values[i], parameter, sizeof(adt.values[i]));
+    }
+  }
+
+  if(adt.lvm_instance != NULL) {
+    condition = aql_load_condition(statement->code, statement->code_length);
+    for(i = 0; i < statement->variable_count; i++) {
+      if(statement->variables[i] & VARIABLE_PARAMETER) {
+        aql_parameter_name(parameter_name,
+                           statement->variables[i] & ~VARIABLE_PARAMETER);
+        name = parameter_name;
+      } else {
+        name = adt.attributes[statement->variables[i]].name;
+      }
+      lvm_register_variable(name, LVM_LONG);
+    }
+
+    /* Substitute the parameters with constants, so that they can be
+       used for selecting an index. */
+    for(i = 0; i < adt.parameter_count; i++) {
+      aql_parameter_name(parameter_name, i);
+      parameter = &statement->parameters[i];
+      lvm_substitute_variable(condition, parameter_name,
+                              parameter->domain == DOMAIN_INT ?
+                              VALUE_LONG(parameter) : 0);
+    }
+    adt.lvm_instance = condition;
+  }
+
+  if(handle != NULL) {
+    clear_handle(handle);
+  }
+
+  return aql_execute(handle, &adt);
+}
+
 db_result_t
 db_process(db_handle_t *handle)
 {
@@ -238,3 +430,35 @@ db_process(db_handle_t *handle)
 
   return DB_INCONSISTENCY_ERROR;
 }
+
+db_result_t
+db_next(db_handle_t *handle)
+{
+  db_result_t result;
+
+  /* Process the query until the next tuple of the result is available
+     in the handle. The tuple is not stored anywhere else, so a caller
+     can stream the result without keeping a copy of it. */
+  do {
+    result = db_process(handle);
+  } while(result == DB_OK);
+
+  return result;
+}
+
+db_result_t
+db_skip(db_handle_t *handle, unsigned count)
+{
+  db_result_t result;
+
+  /* Discard a number of tuples, for instance to resume the transfer
+     of a result at a given block. */
+  for(result = DB_OK; count > 0; count--) {
+    result = db_next(handle);
+    if(result != DB_GOT_ROW) {
+      break;
+    }
+  }
+
+  return result;
+}
@@ -64,6 +64,7 @@ static const struct keyword keywords[] = {
   {"*", MUL},
   {"/", DIV},
   {"#", COMMENT},
+  {"?", PARAMETER},
 
   {">=", GEQ},
   {"<=", LEQ},
@@ -73,6 +74,7 @@ static const struct keyword keywords[] = {
   {"IS", IS},
   {"ON", ON},
   {"IN", IN},
+  {"BY", BY},
 
   {"AND", AND},
   {"NOT", NOT},
@@ -91,6 +93,9 @@ static const struct keyword keywords[] = {
   {"WHERE", WHERE},
   {"COUNT", COUNT},
   {"INDEX", INDEX},
+  {"BTREE", BTREE},
+  {"GROUP", GROUP},
+  {"DELTA", DELTA},
 
   {"INSERT", INSERT},
   {"SELECT", SELECT},
@@ -111,9 +116,9 @@ static const struct keyword keywords[] = {
 };
 
 /* Provides a pointer to the first keyword of a specific length. */
-static const int8_t skip_hint[] = {0, 13, 21, 27, 33, 36, 44, 47, 48};
+static const int8_t skip_hint[] = {0, 14, 23, 29, 35, 41, 49, 52, 53};
 
-static char separators[] = "#.;,() \t\n";
+static char separators[] = "#?.;,() \t\n";
 
 int
 lexer_start(lexer_t *lexer, char *input, token_t *token, value_t *value)
@@ -239,6 +239,21 @@ PARSER(relations)
   RETURN(OK);
 }
 
+PARSER(parameter)
+{
+  long number;
+
+  /* Number the parameters of a statement in the order of appearance,
+     and leave the number in the value of the token. */
+  if(adt->parameter_count == AQL_PARAMETER_LIMIT) {
+    RETURN(SYNTAX_ERROR);
+  }
+  number = adt->parameter_count++;
+  memcpy(VALUE, &number, sizeof(number));
+
+  RETURN(OK);
+}
+
 PARSER(values)
 {
   /* Parse comma-separated attribute values. */
@@ -250,6 +265,12 @@ PARSER(values)
   case INTEGER_VALUE:
     AQL_ADD_VALUE(adt, DOMAIN_INT, VALUE);
     break;
+  case PARAMETER:
+    if(!PARSE(parameter)) {
+      RETURN(SYNTAX_ERROR);
+    }
+    AQL_ADD_VALUE(adt, DOMAIN_UNSPECIFIED, VALUE);
+    break;
   default:
     RETURN(SYNTAX_ERROR);
   }
@@ -266,6 +287,8 @@ PARSER(values)
 
 PARSER(operand)
 {
+  char name[3];
+
   NEXT;
   switch(TOKEN) {
   case IDENTIFIER:
@@ -280,6 +303,18 @@ PARSER(operand)
   case INTEGER_VALUE:
     lvm_set_long(&p, *(long *)lexer->value);
     break;
+  case PARAMETER:
+    /* The value of the parameter is substituted when the statement
+       is executed. */
+    aql_parameter_name(name, adt->parameter_count);
+    if(!PARSE(parameter)) {
+      RETURN(SYNTAX_ERROR);
+    }
+    if(LVM_ERROR(lvm_register_variable(name, LVM_LONG))) {
+      RETURN(SYNTAX_ERROR);
+    }
+    lvm_set_variable(&p, name);
+    break;
   default:
     RETURN(SYNTAX_ERROR);
   }
@@ -502,14 +537,28 @@ PARSER(select)
     }
 
     AQL_SET_CONDITION(adt, &p);
-  } else {
-    REWIND;
-    RETURN(OK);
+    NEXT;
   }
 
-  CONSUME(END);
+  if(TOKEN == GROUP) {
+    CONSUME(BY);
+    CONSUME(IDENTIFIER);
 
-  return OK;
+    PRINTF("Group by attribute %s\n", VALUE);
+    if(DB_ERROR(aql_set_group_attribute(adt, VALUE))) {
+      RETURN(SYNTAX_ERROR);
+    }
+    NEXT;
+  }
+
+  if(TOKEN == END) {
+    return OK;
+  } else if(AQL_GET_FLAGS(adt) & AQL_FLAG_GROUP || adt->lvm_instance != NULL) {
+    RETURN(SYNTAX_ERROR);
+  }
+
+  REWIND;
+  RETURN(OK);
 }
 
 PARSER(insert)
@@ -645,6 +694,9 @@ PARSER_TOKEN(index_type)
   case MEMHASH:
     type = INDEX_MEMHASH;
     break;
+  case BTREE:
+    type = INDEX_BTREE;
+    break;
   default:
     return NONE;
   };
@@ -682,6 +734,15 @@ PARSER(create_relation)
   AQL_SET_TYPE(adt, AQL_TYPE_CREATE_RELATION);
   AQL_ADD_RELATION(adt, VALUE);
 
+  NEXT;
+  if(TOKEN == TYPE) {
+    /* Delta encoding is currently the only alternative storage type. */
+    CONSUME(DELTA);
+    AQL_SET_FLAG(adt, AQL_FLAG_DELTA);
+  } else {
+    REWIND;
+  }
+
   RETURN(OK);
 }
 
@@ -854,3 +915,16 @@ aql_parse(aql_adt_t *external_adt, char *input_string)
 
   return result;
 }
+
+void *
+aql_load_condition(unsigned char *code, unsigned length)
+{
+  /* Install the condition of a prepared statement in place of a
+     parsed one. The variables must be registered again by the caller
+     in the order of their identifiers. */
+  lvm_reset(&p, vmcode, sizeof(vmcode));
+  memcpy(vmcode, code, length);
+  lvm_set_end(&p, length);
+
+  return &p;
+}
@@ -104,6 +104,11 @@ enum token {
   MEMHASH = 46,
   RELATION = 47,
   ATTRIBUTE = 48,
+  BTREE = 49,
+  GROUP = 50,
+  BY = 51,
+  PARAMETER = 52,
+  DELTA = 53,
 
   INTEGER_VALUE = 251,
   FLOAT_VALUE = 252,
@@ -154,12 +159,26 @@ struct aql_adt {
   uint8_t relation_count;
   uint8_t attribute_count;
   uint8_t value_count;
+  uint8_t parameter_count;
   uint8_t optype;
   uint8_t flags;
   void *lvm_instance;
 };
 typedef struct aql_adt aql_adt_t;
 
+/* A prepared statement holds a parsed query, which can be executed
+   repeatedly with different values bound to its parameters. */
+struct db_statement {
+  aql_adt_t adt;
+  attribute_value_t parameters[AQL_PARAMETER_LIMIT];
+  unsigned char code[AQL_STATEMENT_CODE_SIZE];
+  unsigned char chars[AQL_STATEMENT_CHAR_SIZE];
+  uint8_t variables[AQL_ATTRIBUTE_LIMIT + AQL_PARAMETER_LIMIT];
+  uint8_t variable_count;
+  uint8_t code_length;
+};
+typedef struct db_statement db_statement_t;
+
 #define AQL_TYPE_NONE           	0
 #define AQL_TYPE_SELECT			1
 #define AQL_TYPE_INSERT			2
@@ -179,6 +198,8 @@ typedef struct aql_adt aql_adt_t;
 #define AQL_FLAG_AGGREGATE		1
 #define AQL_FLAG_ASSIGN			2
 #define AQL_FLAG_INVERSE_LOGIC		4
+#define AQL_FLAG_GROUP			8
+#define AQL_FLAG_DELTA			16
 
 #define AQL_CLEAR(adt)			aql_clear(adt)
 #define AQL_SET_TYPE(adt, type)	(((adt))->optype = (type))
@@ -214,8 +235,19 @@ aql_status_t aql_parse(aql_adt_t *adt, char *query_string);
 db_result_t aql_add_attribute(aql_adt_t *adt, char *name,
                                domain_t domain, unsigned element_size,
                                int processed_only);
+db_result_t aql_set_group_attribute(aql_adt_t *adt, char *name);
+void aql_parameter_name(char *name, unsigned parameter);
+void *aql_load_condition(unsigned char *code, unsigned length);
 db_result_t aql_add_value(aql_adt_t *adt, domain_t domain, void *value);
 db_result_t db_query(db_handle_t *handle, const char *format, ...);
 db_result_t db_process(db_handle_t *handle);
+db_result_t db_next(db_handle_t *handle);
+db_result_t db_prepare(db_statement_t *statement, const char *format, ...);
+db_result_t db_bind_long(db_statement_t *statement, unsigned parameter,
+                         long value);
+db_result_t db_bind_string(db_statement_t *statement, unsigned parameter,
+                           char *value);
+db_result_t db_execute(db_handle_t *handle, db_statement_t *statement);
+db_result_t db_skip(db_handle_t *handle, unsigned count);
 
 #endif /* !AQL_H */
@@ -64,6 +64,11 @@
 #define DB_FEATURE_COFFEE		1
 #endif /* DB_FEATURE_COFFEE */
 
+/* Support relations that store their tuples delta encoded. */
+#ifndef DB_FEATURE_DELTA
+#define DB_FEATURE_DELTA		0
+#endif /* DB_FEATURE_DELTA */
+
 /* Enable basic data integrity checks. */
 #ifndef DB_FEATURE_INTEGRITY
 #define DB_FEATURE_INTEGRITY		0
@@ -83,6 +88,19 @@
 #define DB_INDEX_POOL_SIZE		3
 #endif /* DB_INDEX_POOL_SIZE */
 
+/* The number of index insertions that are collected before they are
+   applied together in key order. Lookups apply them first. */
+#ifndef DB_INDEX_BATCH_SIZE
+#define DB_INDEX_BATCH_SIZE		4
+#endif /* DB_INDEX_BATCH_SIZE */
+
+/* The maximum time that inserted tuples and index entries are kept in
+   memory before being written out. A value of 0 keeps them until the
+   buffers are full or db_flush() is called. */
+#ifndef DB_INSERT_FLUSH_INTERVAL
+#define DB_INSERT_FLUSH_INTERVAL	(5 * CLOCK_SECOND)
+#endif /* DB_INSERT_FLUSH_INTERVAL */
+
 /* The maximum number of relations loaded in memory. */
 #ifndef DB_RELATION_POOL_SIZE
 #define DB_RELATION_POOL_SIZE		5
@@ -110,6 +128,48 @@
 #define DB_VM_BYTECODE_SIZE		128
 #endif /* DB_VM_BYTECODE_SIZE */
 
+/* The size of the buffers used for transferring several tuples in one
+   storage operation. Tuples that are larger are transferred one at a
+   time. */
+#ifndef DB_ROW_BUFFER_SIZE
+#define DB_ROW_BUFFER_SIZE		128
+#endif /* DB_ROW_BUFFER_SIZE */
+
+/* The number of relations whose tuples can be read ahead at the same
+   time. A join reads from two relations. */
+#ifndef DB_ROW_READ_BUFFERS
+#define DB_ROW_READ_BUFFERS		2
+#endif /* DB_ROW_READ_BUFFERS */
+
+/* The size of the blocks in which delta encoded relations store their
+   tuples. An encoded tuple must fit in a block. */
+#ifndef DB_DELTA_BLOCK_SIZE
+#define DB_DELTA_BLOCK_SIZE		64
+#endif /* DB_DELTA_BLOCK_SIZE */
+
+/* The maximum number of tuples in the smaller relation of a hash join.
+   Joins on attributes that are not indexed in either relation fall back
+   to a nested-loop join if the smaller relation has more tuples. */
+#ifndef DB_JOIN_HASH_LIMIT
+#define DB_JOIN_HASH_LIMIT		128
+#endif /* DB_JOIN_HASH_LIMIT */
+
+/* The number of buckets in the hash table of a hash join. */
+#ifndef DB_JOIN_HASH_BUCKETS
+#define DB_JOIN_HASH_BUCKETS		16
+#endif /* DB_JOIN_HASH_BUCKETS */
+
+/* The maximum number of distinct groups in an aggregating query. A
+   query that produces more groups fails with DB_LIMIT_ERROR. */
+#ifndef DB_GROUP_LIMIT
+#define DB_GROUP_LIMIT			8
+#endif /* DB_GROUP_LIMIT */
+
+/* The number of buckets in the hash table of the groups. */
+#ifndef DB_GROUP_HASH_BUCKETS
+#define DB_GROUP_HASH_BUCKETS		4
+#endif /* DB_GROUP_HASH_BUCKETS */
+
 /*----------------------------------------------------------------------------*/
 
 /* Language options. */
@@ -133,6 +193,22 @@
 #define AQL_ATTRIBUTE_LIMIT    		5
 #endif /* AQL_ATTRIBUTE_LIMIT */
 
+/* The maximum number of parameters ("?") in a prepared statement. */
+#ifndef AQL_PARAMETER_LIMIT
+#define AQL_PARAMETER_LIMIT    		4
+#endif /* AQL_PARAMETER_LIMIT */
+
+/* The space for the condition of a prepared statement. Statements
+   whose LVM bytecode is larger cannot be prepared. */
+#ifndef AQL_STATEMENT_CODE_SIZE
+#define AQL_STATEMENT_CODE_SIZE		96
+#endif /* AQL_STATEMENT_CODE_SIZE */
+
+/* The space for the string constants of a prepared statement. */
+#ifndef AQL_STATEMENT_CHAR_SIZE
+#define AQL_STATEMENT_CHAR_SIZE		16
+#endif /* AQL_STATEMENT_CHAR_SIZE */
+
 /*----------------------------------------------------------------------------*/
 
 /*
@@ -186,6 +262,17 @@
 #define DB_INDEX_COST			64
 #endif /* DB_INDEX_COST */
 
+/* The size in bytes of the Bloom filter kept for each index whose
+   lookups access storage. A value of 0 disables the filters. */
+#ifndef DB_BLOOM_FILTER_SIZE
+#define DB_BLOOM_FILTER_SIZE		0
+#endif /* DB_BLOOM_FILTER_SIZE */
+
+/* The number of bits set in a Bloom filter for each key. */
+#ifndef DB_BLOOM_HASH_COUNT
+#define DB_BLOOM_HASH_COUNT		3
+#endif /* DB_BLOOM_HASH_COUNT */
+
 /* The maximum number of hash table indexes. */
 #ifndef DB_MEMHASH_INDEX_LIMIT
 #define DB_MEMHASH_INDEX_LIMIT  	1
@@ -206,6 +293,32 @@
 #define DB_HEAP_CACHE_LIMIT		1
 #endif /* DB_HEAP_CACHE_LIMIT */
 
+/* The maximum number of B+-tree indexes. */
+#ifndef DB_BTREE_INDEX_LIMIT
+#define DB_BTREE_INDEX_LIMIT		1
+#endif /* DB_BTREE_INDEX_LIMIT */
+
+/* The maximum number of keys in a B+-tree node. */
+#ifndef DB_BTREE_ORDER
+#define DB_BTREE_ORDER			16
+#endif /* DB_BTREE_ORDER */
+
+/* The maximum number of nodes in a B+-tree index, which determines
+   the size of the file reserved for the index. */
+#ifndef DB_BTREE_NODE_LIMIT
+#define DB_BTREE_NODE_LIMIT		512
+#endif /* DB_BTREE_NODE_LIMIT */
+
+/* The maximum height of a B+-tree index. */
+#ifndef DB_BTREE_MAX_DEPTH
+#define DB_BTREE_MAX_DEPTH		8
+#endif /* DB_BTREE_MAX_DEPTH */
+
+/* The maximum number of nodes cached in the B+-tree index. */
+#ifndef DB_BTREE_CACHE_LIMIT
+#define DB_BTREE_CACHE_LIMIT		4
+#endif /* DB_BTREE_CACHE_LIMIT */
+
 /*----------------------------------------------------------------------------*/
 
 /* LVM options. */
@@ -219,7 +332,7 @@
 /* The maximum variable identifier number in the LVM. The default 
    value corresponds to the highest attribute ID. */
 #ifndef LVM_MAX_VARIABLE_ID
-#define LVM_MAX_VARIABLE_ID		AQL_ATTRIBUTE_LIMIT - 1
+#define LVM_MAX_VARIABLE_ID		(AQL_ATTRIBUTE_LIMIT - 1 + AQL_PARAMETER_LIMIT)
 #endif /* LVM_MAX_VARIABLE_ID */
 
 /* Specify whether floats should be used or not inside the LVM. */
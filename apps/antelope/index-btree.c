@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2010, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *     A B+-tree index for flash memory.
+ *
+ *     The nodes of the tree are stored in a single file and are
+ *     addressed by their number. Keys are kept sorted within each node,
+ *     and the leaves are linked in key order, so that a range query
+ *     descends once to the first matching key and then follows the leaf
+ *     chain until it passes the upper end of the range. Duplicate keys
+ *     are allowed; a key that is equal to a separator in an internal
+ *     node may be found in the subtrees on both sides of the separator.
+ *
+ *     A small cache keeps the most recently used nodes in RAM. Node
+ *     writes go through the cache to storage.
+ * \author
+ * 	Nicolas Tsiftes <nvt@sics.se>
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cfs/cfs.h"
+#include "lib/memb.h"
+
+#include "db-options.h"
+#include "index.h"
+#include "result.h"
+#include "storage.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+#define NO_NODE		0xffff
+
+typedef int32_t btree_key_t;
+typedef uint16_t btree_node_id_t;
+
+struct btree_header {
+  btree_node_id_t root;
+  btree_node_id_t node_count;
+};
+
+/*
+ * A node holds at most DB_BTREE_ORDER keys in storage. The arrays have
+ * room for one more item, so that an item can be inserted into a full
+ * node before the node is split.
+ */
+struct btree_node {
+  uint8_t leaf;
+  uint8_t count;
+  btree_node_id_t next;
+  btree_key_t keys[DB_BTREE_ORDER + 1];
+  union {
+    tuple_id_t values[DB_BTREE_ORDER + 1];
+    btree_node_id_t children[DB_BTREE_ORDER + 2];
+  } u;
+};
+typedef struct btree_node btree_node_t;
+
+struct btree {
+  db_storage_id_t storage;
+  struct btree_header header;
+};
+typedef struct btree btree_t;
+
+struct node_cache {
+  btree_t *tree;
+  btree_node_id_t id;
+  uint8_t age;
+  btree_node_t node;
+};
+
+#define NODE_OFFSET(id)	(sizeof(struct btree_header) + \
+			 (unsigned long)(id) * sizeof(btree_node_t))
+#define BTREE_SIZE	NODE_OFFSET(DB_BTREE_NODE_LIMIT)
+
+static struct node_cache node_cache[DB_BTREE_CACHE_LIMIT];
+static uint8_t cache_clock;
+MEMB(btrees, btree_t, DB_BTREE_INDEX_LIMIT);
+
+static db_result_t create(index_t *);
+static db_result_t destroy(index_t *);
+static db_result_t load(index_t *);
+static db_result_t release(index_t *);
+static db_result_t insert(index_t *, attribute_value_t *, tuple_id_t);
+static db_result_t delete(index_t *, attribute_value_t *);
+static tuple_id_t get_next(index_iterator_t *);
+
+index_api_t index_btree = {
+  INDEX_BTREE,
+  INDEX_API_EXTERNAL | INDEX_API_RANGE_QUERIES,
+  create,
+  destroy,
+  load,
+  release,
+  insert,
+  delete,
+  get_next
+};
+
+static struct node_cache *
+cache_lookup(btree_t *tree, btree_node_id_t id)
+{
+  struct node_cache *cache;
+  struct node_cache *victim;
+
+  victim = &node_cache[0];
+  for(cache = node_cache; cache < &node_cache[DB_BTREE_CACHE_LIMIT]; cache++) {
+    if(cache->tree == tree && cache->id == id) {
+      cache->age = ++cache_clock;
+      return cache;
+    }
+    if(cache->tree == NULL) {
+      victim = cache;
+    } else if(victim->tree != NULL &&
+              (uint8_t)(cache_clock - cache->age) >
+              (uint8_t)(cache_clock - victim->age)) {
+      victim = cache;
+    }
+  }
+
+  /* Return the least recently used entry, which the caller fills. */
+  victim->tree = NULL;
+  return victim;
+}
+
+static void
+cache_invalidate(btree_t *tree)
+{
+  int i;
+
+  for(i = 0; i < DB_BTREE_CACHE_LIMIT; i++) {
+    if(node_cache[i].tree == tree) {
+      node_cache[i].tree = NULL;
+    }
+  }
+}
+
+static int
+node_read(btree_t *tree, btree_node_id_t id, btree_node_t *node)
+{
+  struct node_cache *cache;
+
+  cache = cache_lookup(tree, id);
+  if(cache->tree == NULL) {
+    if(DB_ERROR(storage_read(tree->storage, &cache->node,
+                             NODE_OFFSET(id), sizeof(cache->node)))) {
+      PRINTF("DB: Failed to read B+-tree node %u\n", (unsigned)id);
+      return 0;
+    }
+    cache->tree = tree;
+    cache->id = id;
+    cache->age = ++cache_clock;
+  }
+
+  memcpy(node, &cache->node, sizeof(*node));
+  return 1;
+}
+
+static int
+node_write(btree_t *tree, btree_node_id_t id, btree_node_t *node)
+{
+  struct node_cache *cache;
+
+  if(DB_ERROR(storage_write(tree->storage, node,
+                            NODE_OFFSET(id), sizeof(*node)))) {
+    PRINTF("DB: Failed to write B+-tree node %u\n", (unsigned)id);
+    return 0;
+  }
+
+  cache = cache_lookup(tree, id);
+  memcpy(&cache->node, node, sizeof(*node));
+  cache->tree = tree;
+  cache->id = id;
+  cache->age = ++cache_clock;
+  return 1;
+}
+
+static int
+header_write(btree_t *tree)
+{
+  return DB_SUCCESS(storage_write(tree->storage, &tree->header, 0,
+                                  sizeof(tree->header)));
+}
+
+static btree_node_id_t
+node_alloc(btree_t *tree)
+{
+  if(tree->header.node_count >= DB_BTREE_NODE_LIMIT) {
+    PRINTF("DB: No more B+-tree nodes available\n");
+    return NO_NODE;
+  }
+
+  tree->header.node_count++;
+  if(!header_write(tree)) {
+    tree->header.node_count--;
+    return NO_NODE;
+  }
+  return tree->header.node_count - 1;
+}
+
+/* Returns the number of keys in the node that are smaller than the key,
+   or, if "upper" is set, that are smaller than or equal to the key. */
+static uint8_t
+node_search(btree_node_t *node, btree_key_t key, int upper)
+{
+  uint8_t low, high, mid;
+
+  low = 0;
+  high = node->count;
+  while(low < high) {
+    mid = low + (high - low) / 2;
+    if(node->keys[mid] < key || (upper && node->keys[mid] == key)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/* Finds the leftmost leaf that may contain the key. */
+static btree_node_id_t
+find_leaf(btree_t *tree, btree_key_t key, btree_node_t *node)
+{
+  btree_node_id_t id;
+  uint8_t depth;
+
+  id = tree->header.root;
+  for(depth = 0; depth < DB_BTREE_MAX_DEPTH; depth++) {
+    if(!node_read(tree, id, node)) {
+      return NO_NODE;
+    }
+    if(node->leaf) {
+      return id;
+    }
+    id = node->u.children[node_search(node, key, 0)];
+  }
+
+  return NO_NODE;
+}
+
+static void
+split(btree_node_t *node, btree_node_t *sibling, btree_node_id_t sibling_id,
+      btree_key_t *separator)
+{
+  uint8_t half;
+
+  half = node->count / 2;
+  sibling->leaf = node->leaf;
+
+  if(node->leaf) {
+    sibling->count = node->count - half;
+    memcpy(sibling->keys, &node->keys[half],
+           sibling->count * sizeof(node->keys[0]));
+    memcpy(sibling->u.values, &node->u.values[half],
+           sibling->count * sizeof(node->u.values[0]));
+    sibling->next = node->next;
+    node->next = sibling_id;
+    *separator = sibling->keys[0];
+  } else {
+    /* The middle key moves up to the parent. */
+    sibling->count = node->count - half - 1;
+    memcpy(sibling->keys, &node->keys[half + 1],
+           sibling->count * sizeof(node->keys[0]));
+    memcpy(sibling->u.children, &node->u.children[half + 1],
+           (sibling->count + 1) * sizeof(node->u.children[0]));
+    sibling->next = NO_NODE;
+    *separator = node->keys[half];
+  }
+
+  node->count = half;
+}
+
+static btree_key_t
+value_to_key(attribute_value_t *value)
+{
+  long l;
+
+  /* Clamp the bounds of open ranges on platforms with 64-bit longs. */
+  l = db_value_to_long(value);
+  if(l < INT32_MIN) {
+    return INT32_MIN;
+  } else if(l > INT32_MAX) {
+    return INT32_MAX;
+  }
+  return (btree_key_t)l;
+}
+
+static int
+insert_item(btree_t *tree, btree_key_t key, tuple_id_t value)
+{
+  static btree_node_t node;
+  static btree_node_t sibling;
+  btree_node_id_t path[DB_BTREE_MAX_DEPTH];
+  uint8_t child_index[DB_BTREE_MAX_DEPTH];
+  btree_node_id_t sibling_id;
+  btree_node_id_t root_id;
+  uint8_t depth;
+  uint8_t pos;
+
+  /* Descend to the leaf, remembering the path for splits. */
+  path[0] = tree->header.root;
+  for(depth = 0;; depth++) {
+    if(!node_read(tree, path[depth], &node)) {
+      return 0;
+    }
+    if(node.leaf) {
+      break;
+    }
+    if(depth + 1 == DB_BTREE_MAX_DEPTH) {
+      PRINTF("DB: The B+-tree is too deep\n");
+      return 0;
+    }
+    child_index[depth] = node_search(&node, key, 1);
+    path[depth + 1] = node.u.children[child_index[depth]];
+  }
+
+  pos = node_search(&node, key, 1);
+  memmove(&node.keys[pos + 1], &node.keys[pos],
+          (node.count - pos) * sizeof(node.keys[0]));
+  memmove(&node.u.values[pos + 1], &node.u.values[pos],
+          (node.count - pos) * sizeof(node.u.values[0]));
+  node.keys[pos] = key;
+  node.u.values[pos] = value;
+  node.count++;
+
+  /* Split full nodes upwards from the leaf. */
+  for(;;) {
+    if(node.count <= DB_BTREE_ORDER) {
+      return node_write(tree, path[depth], &node);
+    }
+
+    sibling_id = node_alloc(tree);
+    if(sibling_id == NO_NODE) {
+      return 0;
+    }
+    split(&node, &sibling, sibling_id, &key);
+    if(!node_write(tree, sibling_id, &sibling) ||
+       !node_write(tree, path[depth], &node)) {
+      return 0;
+    }
+
+    PRINTF("DB: Split B+-tree node %u into node %u\n",
+           (unsigned)path[depth], (unsigned)sibling_id);
+
+    if(depth == 0) {
+      /* The root was split, so the tree grows by one level. */
+      root_id = node_alloc(tree);
+      if(root_id == NO_NODE) {
+        return 0;
+      }
+      node.leaf = 0;
+      node.count = 1;
+      node.next = NO_NODE;
+      node.keys[0] = key;
+      node.u.children[0] = path[0];
+      node.u.children[1] = sibling_id;
+      if(!node_write(tree, root_id, &node)) {
+        return 0;
+      }
+      tree->header.root = root_id;
+      return header_write(tree);
+    }
+
+    depth--;
+    if(!node_read(tree, path[depth], &node)) {
+      return 0;
+    }
+
+    /* Insert the separator and the new node right after the child
+       that was split. */
+    pos = child_index[depth];
+    memmove(&node.keys[pos + 1], &node.keys[pos],
+            (node.count - pos) * sizeof(node.keys[0]));
+    memmove(&node.u.children[pos + 2], &node.u.children[pos + 1],
+            (node.count - pos) * sizeof(node.u.children[0]));
+    node.keys[pos] = key;
+    node.u.children[pos + 1] = sibling_id;
+    node.count++;
+  }
+}
+
+static db_result_t
+create(index_t *index)
+{
+  char *filename;
+  btree_t *tree;
+  btree_node_t root;
+
+  filename = storage_generate_file("btree", BTREE_SIZE);
+  if(filename == NULL) {
+    PRINTF("DB: Failed to generate a B+-tree file\n");
+    return DB_INDEX_ERROR;
+  }
+
+  memcpy(index->descriptor_file, filename,
+	 sizeof(index->descriptor_file));
+
+  PRINTF("DB: Generated the B+-tree file \"%s\" using %lu bytes of space\n",
+	 index->descriptor_file, (unsigned long)BTREE_SIZE);
+
+  index->opaque_data = tree = memb_alloc(&btrees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    cfs_remove(index->descriptor_file);
+    index->descriptor_file[0] = '\0';
+    return DB_ALLOCATION_ERROR;
+  }
+
+  tree->storage = storage_open(index->descriptor_file);
+  if(tree->storage < 0) {
+    goto error;
+  }
+
+  /* The tree starts as a single empty leaf. */
+  tree->header.root = 0;
+  tree->header.node_count = 0;
+  memset(&root, 0, sizeof(root));
+  root.leaf = 1;
+  root.next = NO_NODE;
+  if(node_alloc(tree) == NO_NODE || !node_write(tree, 0, &root)) {
+    goto error;
+  }
+
+  PRINTF("DB: Created a B+-tree index\n");
+  return DB_OK;
+
+error:
+  cache_invalidate(tree);
+  storage_close(tree->storage);
+  memb_free(&btrees, tree);
+  cfs_remove(index->descriptor_file);
+  index->descriptor_file[0] = '\0';
+  return DB_STORAGE_ERROR;
+}
+
+static db_result_t
+destroy(index_t *index)
+{
+  cfs_remove(index->descriptor_file);
+  return DB_OK;
+}
+
+static db_result_t
+load(index_t *index)
+{
+  btree_t *tree;
+
+  index->opaque_data = tree = memb_alloc(&btrees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    return DB_ALLOCATION_ERROR;
+  }
+
+  tree->storage = storage_open(index->descriptor_file);
+  if(tree->storage < 0 ||
+     DB_ERROR(storage_read(tree->storage, &tree->header, 0,
+                           sizeof(tree->header)))) {
+    storage_close(tree->storage);
+    memb_free(&btrees, tree);
+    return DB_STORAGE_ERROR;
+  }
+
+  PRINTF("DB: Loaded a B+-tree index from file %s (%u nodes)\n",
+	 index->descriptor_file, (unsigned)tree->header.node_count);
+
+  return DB_OK;
+}
+
+static db_result_t
+release(index_t *index)
+{
+  btree_t *tree;
+
+  tree = index->opaque_data;
+
+  cache_invalidate(tree);
+  storage_close(tree->storage);
+  memb_free(&btrees, tree);
+  return DB_OK;
+}
+
+static db_result_t
+insert(index_t *index, attribute_value_t *key, tuple_id_t value)
+{
+  btree_key_t btree_key;
+
+  btree_key = value_to_key(key);
+
+  if(insert_item(index->opaque_data, btree_key, value) == 0) {
+    PRINTF("DB: Failed to insert key %ld into a B+-tree index\n",
+           (long)btree_key);
+    return DB_INDEX_ERROR;
+  }
+  return DB_OK;
+}
+
+static db_result_t
+delete(index_t *index, attribute_value_t *value)
+{
+  static btree_node_t node;
+  btree_t *tree;
+  btree_key_t key;
+  btree_node_id_t id;
+  uint8_t pos, end, count;
+
+  tree = index->opaque_data;
+  key = value_to_key(value);
+
+  /*
+   * Remove all items with the key from the leaves. Leaves are not
+   * merged when they become sparse; the range scan skips over them.
+   */
+  for(id = find_leaf(tree, key, &node); id != NO_NODE; id = node.next) {
+    if(!node_read(tree, id, &node)) {
+      return DB_STORAGE_ERROR;
+    }
+    pos = node_search(&node, key, 0);
+    end = node_search(&node, key, 1);
+    count = node.count;
+    if(pos < end) {
+      memmove(&node.keys[pos], &node.keys[end],
+              (node.count - end) * sizeof(node.keys[0]));
+      memmove(&node.u.values[pos], &node.u.values[end],
+              (node.count - end) * sizeof(node.u.values[0]));
+      node.count -= end - pos;
+      if(!node_write(tree, id, &node)) {
+        return DB_STORAGE_ERROR;
+      }
+    }
+    /* A larger key follows in this leaf, so no later leaf holds the key. */
+    if(end < count) {
+      break;
+    }
+  }
+
+  return DB_OK;
+}
+
+static tuple_id_t
+get_next(index_iterator_t *iterator)
+{
+  struct iteration_cache {
+    index_iterator_t *index_iterator;
+    btree_node_id_t leaf;
+    uint8_t slot;
+  };
+  static struct iteration_cache cache;
+  static btree_node_t node;
+  btree_t *tree;
+  btree_key_t min;
+  btree_key_t max;
+
+  tree = (btree_t *)iterator->index->opaque_data;
+  min = value_to_key(&iterator->min_value);
+  max = value_to_key(&iterator->max_value);
+
+  if(cache.index_iterator != iterator || iterator->next_item_no == 0) {
+    /* Initialize the cache for a new search. */
+    cache.index_iterator = iterator;
+    cache.leaf = find_leaf(tree, min, &node);
+    cache.slot = node_search(&node, min, 0);
+  }
+
+  while(cache.leaf != NO_NODE) {
+    if(!node_read(tree, cache.leaf, &node)) {
+      break;
+    }
+    if(cache.slot < node.count) {
+      if(node.keys[cache.slot] > max) {
+        break;
+      }
+      iterator->next_item_no++;
+      PRINTF("DB: Found key %ld with value %lu\n",
+             (long)node.keys[cache.slot],
+             (unsigned long)node.u.values[cache.slot]);
+      return node.u.values[cache.slot++];
+    }
+    cache.leaf = node.next;
+    cache.slot = 0;
+  }
+
+  cache.leaf = NO_NODE;
+  return INVALID_TUPLE;
+}
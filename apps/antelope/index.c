@@ -35,6 +35,8 @@
  * 	Nicolas Tsiftes <nvt@sics.se>
  */
 
+#include <string.h>
+
 #include "contiki.h"
 #include "lib/memb.h"
 #include "lib/list.h"
@@ -49,11 +51,27 @@
 #include "storage.h"
 
 static index_api_t *index_components[] = {&index_inline,
-	&index_maxheap};
+	&index_maxheap, &index_btree};
 
 LIST(indices);
 MEMB(index_memb, index_t, DB_INDEX_POOL_SIZE);
 
+#if DB_INDEX_BATCH_SIZE > 1
+/*
+ * Insertions are collected and applied in key order, so that index
+ * structures that cache parts of their storage, such as the buckets
+ * of the MaxHeap index, handle neighbouring keys together.
+ */
+struct pending_insert {
+  index_t *index;
+  attribute_value_t value;
+  tuple_id_t tuple_id;
+};
+
+static struct pending_insert pending_inserts[DB_INDEX_BATCH_SIZE];
+static uint8_t pending_count;
+#endif /* DB_INDEX_BATCH_SIZE > 1 */
+
 static process_event_t load_request_event;
 PROCESS(db_indexer, "DB Indexer");
 
@@ -71,6 +89,85 @@ find_index_api(index_type_t index_type)
   return NULL;
 }
 
+#if DB_BLOOM_FILTER_SIZE > 0
+/*
+ * Indexes whose lookups read from storage keep a Bloom filter of their
+ * keys, which lets point queries for absent keys finish without any
+ * storage access. Internal indexes are cheaper to probe directly.
+ */
+#define BLOOM_ENABLED(index)	(!((index)->api->flags & INDEX_API_INTERNAL))
+#define BLOOM_BITS		((uint32_t)DB_BLOOM_FILTER_SIZE * 8)
+
+static unsigned
+bloom_bit(long key, unsigned i)
+{
+  uint32_t h1;
+  uint32_t h2;
+
+  /* Derive the bit positions from two hash values through double
+     hashing, so that each key costs only one multiplication. */
+  h1 = (uint32_t)key * 2654435761UL;
+  h1 ^= h1 >> 15;
+  h2 = (h1 >> 16) | 1;
+
+  return (h1 + i * h2) % BLOOM_BITS;
+}
+
+static void
+bloom_add(index_t *index, attribute_value_t *value)
+{
+  long key;
+  unsigned i;
+  unsigned bit;
+
+  key = db_value_to_long(value);
+  for(i = 0; i < DB_BLOOM_HASH_COUNT; i++) {
+    bit = bloom_bit(key, i);
+    index->bloom_filter[bit / 8] |= 1 << (bit % 8);
+  }
+  index->bloom_modified = 1;
+}
+
+static db_result_t
+bloom_update(index_t *index)
+{
+  tuple_id_t cardinality;
+  tuple_id_t tuple_id;
+  unsigned char row[index->rel->row_length];
+  attribute_value_t value;
+
+  cardinality = relation_cardinality(index->rel);
+  if(cardinality == INVALID_TUPLE) {
+    return DB_STORAGE_ERROR;
+  }
+
+  if(index->bloom_cardinality > cardinality) {
+    /* The relation has been replaced since the filter was stored. */
+    memset(index->bloom_filter, 0, sizeof(index->bloom_filter));
+    index->bloom_cardinality = 0;
+  }
+
+  /* Tuples are only appended to a relation, so the filter needs only
+     the keys of the tuples that were inserted after it was stored. */
+  for(tuple_id = index->bloom_cardinality; tuple_id < cardinality; tuple_id++) {
+    if(DB_ERROR(storage_get_row(index->rel, &tuple_id, row)) ||
+       DB_ERROR(relation_get_value(index->rel, index->attr, row, &value))) {
+      return DB_STORAGE_ERROR;
+    }
+    bloom_add(index, &value);
+  }
+
+  if(index->bloom_cardinality != cardinality) {
+    PRINTF("DB: Added tuples %lu-%lu to the Bloom filter of %s.%s\n",
+           (unsigned long)index->bloom_cardinality,
+           (unsigned long)cardinality, index->rel->name, index->attr->name);
+    index->bloom_cardinality = cardinality;
+  }
+
+  return DB_OK;
+}
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
+
 void
 index_init(void)
 {
@@ -121,6 +218,11 @@ index_create(index_type_t index_type, relation_t *rel, attribute_t *attr)
   index->opaque_data = NULL;
   index->descriptor_file[0] = '\0';
   index->type = index_type;
+#if DB_BLOOM_FILTER_SIZE > 0
+  index->bloom_cardinality = 0;
+  index->bloom_modified = 0;
+  memset(index->bloom_filter, 0, sizeof(index->bloom_filter));
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
 
   if(DB_ERROR(api->create(index))) {
     memb_free(&index_memb, index);
@@ -131,8 +233,11 @@ index_create(index_type_t index_type, relation_t *rel, attribute_t *attr)
   attr->index = index;
   list_push(indices, index);
 
-  if(index->descriptor_file[0] != '\0' &&
-     DB_ERROR(storage_put_index(index))) {
+  if((index->descriptor_file[0] != '\0'
+#if DB_BLOOM_FILTER_SIZE > 0
+      || BLOOM_ENABLED(index)
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
+     ) && DB_ERROR(storage_put_index(index))) {
     api->destroy(index);
     memb_free(&index_memb, index);
     PRINTF("DB: Failed to store index data in file \"%s\"\n",
@@ -154,9 +259,61 @@ index_create(index_type_t index_type, relation_t *rel, attribute_t *attr)
   return DB_OK;
 }
 
+db_result_t
+index_flush(void)
+{
+#if DB_INDEX_BATCH_SIZE > 1
+  struct pending_insert pending;
+  db_result_t result;
+  int i;
+  int j;
+
+  /* Sort the insertions by index and key. Insertions with equal keys
+     keep their order, so that the tuples are found in the same order
+     as if they had been inserted one at a time. */
+  for(i = 1; i < pending_count; i++) {
+    pending = pending_inserts[i];
+    for(j = i; j > 0; j--) {
+      if(pending_inserts[j - 1].index < pending.index ||
+         (pending_inserts[j - 1].index == pending.index &&
+          db_value_to_long(&pending_inserts[j - 1].value) <=
+          db_value_to_long(&pending.value))) {
+        break;
+      }
+      pending_inserts[j] = pending_inserts[j - 1];
+    }
+    pending_inserts[j] = pending;
+  }
+
+  result = DB_OK;
+  for(i = 0; i < pending_count; i++) {
+    if(DB_ERROR(pending_inserts[i].index->api->insert(pending_inserts[i].index,
+                                                      &pending_inserts[i].value,
+                                                      pending_inserts[i].tuple_id))) {
+      PRINTF("DB: Failed to insert into the index for %s.%s\n",
+             pending_inserts[i].index->rel->name,
+             pending_inserts[i].index->attr->name);
+      result = DB_INDEX_ERROR;
+    }
+  }
+
+  PRINTF("DB: Applied %u batched index insertions\n", (unsigned)pending_count);
+  pending_count = 0;
+
+  return result;
+#else
+  return DB_OK;
+#endif /* DB_INDEX_BATCH_SIZE > 1 */
+}
+
 db_result_t
 index_destroy(index_t *index)
 {
+#if DB_BLOOM_FILTER_SIZE > 0
+  /* There is no need to store the filter of a removed index. */
+  index->bloom_modified = 0;
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
+
   if(DB_ERROR(index_release(index)) ||
      DB_ERROR(index->api->destroy(index))) {
     return DB_INDEX_ERROR;
@@ -196,6 +353,9 @@ index_load(relation_t *rel, attribute_t *attr)
   }
 
   index->api = api;
+#if DB_BLOOM_FILTER_SIZE > 0
+  index->bloom_modified = 0;
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
 
   if(DB_ERROR(api->load(index))) {
     PRINTF("DB: Index-specific load failed\n");
@@ -212,6 +372,19 @@ index_load(relation_t *rel, attribute_t *attr)
 db_result_t
 index_release(index_t *index)
 {
+  if(DB_ERROR(index_flush())) {
+    return DB_INDEX_ERROR;
+  }
+
+#if DB_BLOOM_FILTER_SIZE > 0
+  /* The index records are appended, and the last record of an
+     index takes precedence when the index is loaded again. */
+  if(index->bloom_modified && DB_ERROR(storage_put_index(index))) {
+    PRINTF("DB: Failed to store the Bloom filter of %s.%s\n",
+           index->rel->name, index->attr->name);
+  }
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
+
   if(DB_ERROR(index->api->release(index))) {
     return DB_INDEX_ERROR;
   }
@@ -227,13 +400,35 @@ db_result_t
 index_insert(index_t *index, attribute_value_t *value,
              tuple_id_t tuple_id)
 {
+#if DB_BLOOM_FILTER_SIZE > 0
+  if(BLOOM_ENABLED(index)) {
+    bloom_add(index, value);
+    if(tuple_id == index->bloom_cardinality) {
+      index->bloom_cardinality++;
+    }
+  }
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
+
+#if DB_INDEX_BATCH_SIZE > 1
+  if(pending_count == DB_INDEX_BATCH_SIZE && DB_ERROR(index_flush())) {
+    return DB_INDEX_ERROR;
+  }
+
+  pending_inserts[pending_count].index = index;
+  pending_inserts[pending_count].value = *value;
+  pending_inserts[pending_count].tuple_id = tuple_id;
+  pending_count++;
+
+  return DB_OK;
+#else
   return index->api->insert(index, value, tuple_id);
+#endif /* DB_INDEX_BATCH_SIZE > 1 */
 }
 
 db_result_t
 index_delete(index_t *index, attribute_value_t *value)
 {
-  if(index->flags != INDEX_READY) {
+  if(index->flags != INDEX_READY || DB_ERROR(index_flush())) {
     return DB_INDEX_ERROR;
   }
 
@@ -256,7 +451,7 @@ index_get_iterator(index_iterator_t *iterator, index_t *index,
     return DB_STORAGE_ERROR;
   }
 
-  if(index->flags != INDEX_READY) {
+  if(index->flags != INDEX_READY || DB_ERROR(index_flush())) {
     return DB_INDEX_ERROR;
   }
 
@@ -290,6 +485,10 @@ index_get_iterator(index_iterator_t *iterator, index_t *index,
   }
 
   iterator->index = index;
+  if(range == 0 && !index_may_contain(index, min_value)) {
+    /* The key is absent; let index_get_next() finish immediately. */
+    iterator->index = NULL;
+  }
   iterator->min_value = *min_value;
   iterator->max_value = *max_value;
   iterator->next_item_no = 0;
@@ -329,6 +528,33 @@ index_get_next(index_iterator_t *iterator)
   return iterator->index->api->get_next(iterator);
 }
 
+int
+index_may_contain(index_t *index, attribute_value_t *value)
+{
+#if DB_BLOOM_FILTER_SIZE > 0
+  long key;
+  unsigned i;
+  unsigned bit;
+
+  if(!BLOOM_ENABLED(index) || index->flags != INDEX_READY ||
+     DB_ERROR(bloom_update(index))) {
+    return 1;
+  }
+
+  key = db_value_to_long(value);
+  for(i = 0; i < DB_BLOOM_HASH_COUNT; i++) {
+    bit = bloom_bit(key, i);
+    if(!(index->bloom_filter[bit / 8] & (1 << (bit % 8)))) {
+      PRINTF("DB: The Bloom filter of %s.%s excludes the value %ld\n",
+             index->rel->name, index->attr->name, key);
+      return 0;
+    }
+  }
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
+
+  return 1;
+}
+
 int
 index_exists(attribute_t *attr)
 {
@@ -415,6 +641,11 @@ PROCESS_THREAD(db_indexer, ev, data)
       }
     }
 
+    if(DB_ERROR(index_flush())) {
+      index->flags |= INDEX_LOAD_ERROR;
+      goto cleanup;
+    }
+
     PRINTF("DB: Loaded %lu rows into the index\n",
 	(unsigned long)handle.current_row);
 
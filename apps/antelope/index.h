@@ -43,7 +43,8 @@ typedef enum {
   INDEX_NONE = 0,
   INDEX_INLINE = 1,
   INDEX_MEMHASH = 2,
-  INDEX_MAXHEAP = 3
+  INDEX_MAXHEAP = 3,
+  INDEX_BTREE = 4
 } index_type_t;
 
 #define INDEX_READY		0x00
@@ -67,6 +68,12 @@ struct index {
   void *opaque_data;
   index_type_t type;
   uint8_t flags;
+#if DB_BLOOM_FILTER_SIZE > 0
+  /* The filter covers the keys of all tuples below bloom_cardinality. */
+  tuple_id_t bloom_cardinality;
+  uint8_t bloom_modified;
+  uint8_t bloom_filter[DB_BLOOM_FILTER_SIZE];
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
 };
 
 typedef struct index index_t;
@@ -97,6 +104,7 @@ typedef struct index_api index_api_t;
 extern index_api_t index_inline;
 extern index_api_t index_maxheap;
 extern index_api_t index_memhash;
+extern index_api_t index_btree;
 
 void index_init(void);
 db_result_t index_create(index_type_t, relation_t *, attribute_t *);
@@ -105,9 +113,11 @@ db_result_t index_load(relation_t *, attribute_t *);
 db_result_t index_release(index_t *);
 db_result_t index_insert(index_t *, attribute_value_t *, tuple_id_t);
 db_result_t index_delete(index_t *, attribute_value_t *);
+db_result_t index_flush(void);
 db_result_t index_get_iterator(index_iterator_t *, index_t *, 
                                attribute_value_t *, attribute_value_t *);
 tuple_id_t index_get_next(index_iterator_t *);
+int index_may_contain(index_t *, attribute_value_t *);
 int index_exists(attribute_t *);
 
 #endif /* !INDEX_H */
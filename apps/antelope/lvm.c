@@ -64,12 +64,19 @@
 #define LVM_USE_FLOATS			0
 #endif
 
+#ifndef LVM_PROGRAM_LENGTH
+#define LVM_PROGRAM_LENGTH		24
+#endif
+
 #define IS_CONNECTIVE(op) ((op) & LVM_CONNECTIVE)
 
 struct variable {
   operand_type_t type;
   operand_value_t value;
   char name[LVM_MAX_NAME_LENGTH + 1];
+  /* The location of the variable in a row, if it has been bound. */
+  uint16_t row_offset;
+  uint8_t row_size;
 };
 typedef struct variable variable_t;
 
@@ -82,10 +89,31 @@ typedef struct derivation derivation_t;
 
 /* Registered variables for a LVM expression. Their values may be 
    changed between executions of the expression. */
-static variable_t variables[LVM_MAX_VARIABLE_ID - 1];
+static variable_t variables[LVM_MAX_VARIABLE_ID];
 
 /* Range derivations of variables that are used for index searches. */
-static derivation_t derivations[LVM_MAX_VARIABLE_ID - 1];
+static derivation_t derivations[LVM_MAX_VARIABLE_ID];
+
+/*
+ * A prepared predicate is a program in postfix order, in which the
+ * variables bound to a row have been resolved to their offsets in the
+ * row, and in which constant subexpressions have been folded. It is
+ * evaluated with a value stack instead of decoding the prefix code
+ * for each tuple.
+ */
+#define PUSH_CONSTANT	1
+#define PUSH_VARIABLE	2
+#define PUSH_INT	3
+#define PUSH_LONG	4
+
+struct instruction {
+  uint8_t code;
+  long value;
+};
+
+static struct instruction program[LVM_PROGRAM_LENGTH];
+static uint8_t program_length;
+static lvm_instance_t *prepared_instance;
 
 #if DEBUG
 static void
@@ -107,7 +135,7 @@ lookup(char *name)
 {
   variable_t *var;
 
-  for(var = variables; var <= &variables[LVM_MAX_VARIABLE_ID - 1] && var->name[0] != '\0'; var++) {
+  for(var = variables; var < &variables[LVM_MAX_VARIABLE_ID] && var->name[0] != '\0'; var++) {
     if(strcmp(var->name, name) == 0) {
       break;
     }
@@ -162,6 +190,55 @@ operand_to_long(operand_t *operand)
   }
 }
 
+static lvm_status_t
+apply_arith(operator_t op, long a, long b, long *result)
+{
+  switch(op) {
+  case LVM_ADD:
+    *result = a + b;
+    break;
+  case LVM_SUB:
+    *result = a - b;
+    break;
+  case LVM_MUL:
+    *result = a * b;
+    break;
+  case LVM_DIV:
+    if(b == 0) {
+      return MATH_ERROR;
+    }
+    *result = a / b;
+    break;
+  default:
+    return EXECUTION_ERROR;
+  }
+
+  return TRUE;
+}
+
+static int
+compare(operator_t op, long l1, long l2)
+{
+  switch(op) {
+  case LVM_EQ:
+    return l1 == l2;
+  case LVM_NEQ:
+    return l1 != l2;
+  case LVM_GE:
+    return l1 > l2;
+  case LVM_GEQ:
+    return l1 >= l2;
+  case LVM_LE:
+    return l1 < l2;
+  case LVM_LEQ:
+    return l1 <= l2;
+  default:
+    break;
+  }
+
+  return EXECUTION_ERROR;
+}
+
 static lvm_status_t
 eval_expr(lvm_instance_t *p, operator_t op, operand_t *result)
 {
@@ -192,24 +269,9 @@ eval_expr(lvm_instance_t *p, operator_t op, operand_t *result)
     value[i] = operand_to_long(&operand[i]);
   }
 
-  switch(op) {
-  case LVM_ADD:
-    result_value = value[0] + value[1];
-    break;
-  case LVM_SUB:
-    result_value = value[0] - value[1];
-    break;
-  case LVM_MUL:
-    result_value = value[0] * value[1];
-    break;
-  case LVM_DIV:
-    if(value[1] == 0) {
-      return MATH_ERROR;
-    }
-    result_value = value[0] / value[1];
-    break;
-  default:
-    return EXECUTION_ERROR;
+  r = apply_arith(op, value[0], value[1], &result_value);
+  if(LVM_ERROR(r)) {
+    return r;
   }
 
   result->type = LVM_LONG;
@@ -277,24 +339,102 @@ eval_logic(lvm_instance_t *p, operator_t *op)
   l2 = result[1];
   PRINTF("Result1: %ld\nResult2: %ld\n", l1, l2);
 
-  switch(*op) {
-  case LVM_EQ:
-    return l1 == l2;
-  case LVM_NEQ:
-    return l1 != l2;
-  case LVM_GE:
-    return l1 > l2;
-  case LVM_GEQ:
-    return l1 >= l2;
-  case LVM_LE:
-    return l1 < l2;
-  case LVM_LEQ:
-    return l1 <= l2;
+  return compare(*op, l1, l2);
+}
+
+static lvm_status_t
+emit(uint8_t code, long value)
+{
+  if(program_length == LVM_PROGRAM_LENGTH) {
+    return STACK_OVERFLOW;
+  }
+
+  program[program_length].code = code;
+  program[program_length].value = value;
+  program_length++;
+
+  return TRUE;
+}
+
+static lvm_status_t
+prepare_expr(lvm_instance_t *p)
+{
+  operand_t operand;
+  variable_t *var;
+  operator_t op;
+  struct instruction *insn;
+  long folded;
+  int i;
+  lvm_status_t r;
+
+  switch(get_type(p)) {
+  case LVM_OPERAND:
+    get_operand(p, &operand);
+    if(operand.type != LVM_VARIABLE) {
+      return emit(PUSH_CONSTANT, operand_to_long(&operand));
+    }
+    if(operand.value.id >= LVM_MAX_VARIABLE_ID) {
+      return INVALID_IDENTIFIER;
+    }
+    var = &variables[operand.value.id];
+    if(var->row_size == 2) {
+      return emit(PUSH_INT, var->row_offset);
+    } else if(var->row_size == 4) {
+      return emit(PUSH_LONG, var->row_offset);
+    }
+    return emit(PUSH_VARIABLE, operand.value.id);
+  case LVM_ARITH_OP:
+    op = *get_operator(p);
+    for(i = 0; i < 2; i++) {
+      r = prepare_expr(p);
+      if(LVM_ERROR(r)) {
+        return r;
+      }
+    }
+
+    /* Fold operations on constants, but leave errors such as divisions
+       by zero to be reported when the predicate is executed. */
+    insn = &program[program_length - 2];
+    if(insn[0].code == PUSH_CONSTANT && insn[1].code == PUSH_CONSTANT &&
+       !LVM_ERROR(apply_arith(op, insn[0].value, insn[1].value, &folded))) {
+      insn[0].value = folded;
+      program_length--;
+      return TRUE;
+    }
+    return emit(op, 0);
   default:
-    break;
+    return SEMANTIC_ERROR;
   }
+}
 
-  return EXECUTION_ERROR;
+static lvm_status_t
+prepare_logic(lvm_instance_t *p, operator_t op)
+{
+  int i;
+  unsigned arguments;
+  lvm_status_t r;
+
+  if(IS_CONNECTIVE(op)) {
+    arguments = op == LVM_NOT ? 1 : 2;
+    for(i = 0; i < arguments; i++) {
+      if(get_type(p) != LVM_CMP_OP) {
+	return SEMANTIC_ERROR;
+      }
+      r = prepare_logic(p, *get_operator(p));
+      if(LVM_ERROR(r)) {
+	return r;
+      }
+    }
+  } else {
+    for(i = 0; i < 2; i++) {
+      r = prepare_expr(p);
+      if(LVM_ERROR(r)) {
+	return r;
+      }
+    }
+  }
+
+  return emit(op, 0);
 }
 
 void
@@ -309,6 +449,7 @@ lvm_reset(lvm_instance_t *p, unsigned char *code, lvm_ip_t size)
 
   memset(variables, 0, sizeof(variables));
   memset(derivations, 0, sizeof(derivations));
+  prepared_instance = NULL;
 }
 
 lvm_ip_t
@@ -403,6 +544,89 @@ lvm_execute(lvm_instance_t *p)
   return status;
 }
 
+lvm_status_t
+lvm_prepare(lvm_instance_t *p)
+{
+  lvm_status_t r;
+
+  prepared_instance = NULL;
+  program_length = 0;
+
+  p->ip = 0;
+  if(get_type(p) != LVM_CMP_OP) {
+    return SEMANTIC_ERROR;
+  }
+
+  r = prepare_logic(p, *get_operator(p));
+  if(LVM_ERROR(r)) {
+    PRINTF("Failed to prepare the code: %d\n", (int)r);
+    return r;
+  }
+
+  PRINTF("Prepared a program of %u instructions\n", (unsigned)program_length);
+  prepared_instance = p;
+  return TRUE;
+}
+
+lvm_status_t
+lvm_execute_row(lvm_instance_t *p, const unsigned char *row)
+{
+  static long stack[LVM_PROGRAM_LENGTH];
+  struct instruction *insn;
+  const unsigned char *ptr;
+  int sp;
+  int r;
+
+  if(p != prepared_instance) {
+    return lvm_execute(p);
+  }
+
+  sp = 0;
+  for(insn = program; insn < &program[program_length]; insn++) {
+    switch(insn->code) {
+    case PUSH_CONSTANT:
+      stack[sp++] = insn->value;
+      break;
+    case PUSH_VARIABLE:
+      stack[sp++] = variables[insn->value].value.l;
+      break;
+    case PUSH_INT:
+      ptr = row + insn->value;
+      stack[sp++] = ptr[0] << 8 | ptr[1];
+      break;
+    case PUSH_LONG:
+      ptr = row + insn->value;
+      stack[sp++] = (uint32_t)ptr[0] << 24 | (uint32_t)ptr[1] << 16 |
+                    (uint32_t)ptr[2] << 8 | ptr[3];
+      break;
+    case LVM_NOT:
+      stack[sp - 1] = !stack[sp - 1];
+      break;
+    case LVM_AND:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] && stack[sp];
+      break;
+    case LVM_OR:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] || stack[sp];
+      break;
+    default:
+      sp--;
+      if(insn->code & LVM_ARITH_OP) {
+        r = apply_arith(insn->code, stack[sp - 1], stack[sp], &stack[sp - 1]);
+      } else {
+        r = compare(insn->code, stack[sp - 1], stack[sp]);
+        stack[sp - 1] = r;
+      }
+      if(LVM_ERROR(r)) {
+        return r;
+      }
+    }
+  }
+
+  return stack[0] ? TRUE : FALSE;
+}
+
 void
 lvm_set_op(lvm_instance_t *p, operator_t op)
 {
@@ -472,6 +696,33 @@ lvm_set_variable_value(char *name, operand_value_t value)
   return TRUE;
 }
 
+lvm_status_t
+lvm_bind_variable(char *name, unsigned offset, unsigned size)
+{
+  variable_id_t id;
+
+  id = lookup(name);
+  if(id == LVM_MAX_VARIABLE_ID || variables[id].name[0] == '\0') {
+    return INVALID_IDENTIFIER;
+  }
+  if(size != 2 && size != 4) {
+    return TYPE_ERROR;
+  }
+
+  variables[id].row_offset = offset;
+  variables[id].row_size = size;
+  return TRUE;
+}
+
+char *
+lvm_get_variable_name(variable_id_t id)
+{
+  if(id >= LVM_MAX_VARIABLE_ID || variables[id].name[0] == '\0') {
+    return NULL;
+  }
+  return variables[id].name;
+}
+
 void
 lvm_set_variable(lvm_instance_t *p, char *name)
 {
@@ -544,12 +795,9 @@ create_union(derivation_t *result, derivation_t *d1, derivation_t *d2)
   for(i = 0; i < LVM_MAX_VARIABLE_ID; i++) {
     if(!d1[i].derived && !d2[i].derived) {
       continue;
-    } else if(d1[i].derived && !d2[i].derived) {
-      result[i].min.l = d1[i].min.l;
-      result[i].max.l = d1[i].max.l;
-    } else if(!d1[i].derived && d2[i].derived) {
-      result[i].min.l = d2[i].min.l;
-      result[i].max.l = d2[i].max.l;
+    } else if(!d1[i].derived || !d2[i].derived) {
+      /* The variable is unconstrained on one side of the union. */
+      continue;
     } else {
       /* Both derivations have been made; create a
          union of the ranges. */
@@ -579,6 +827,81 @@ create_union(derivation_t *result, derivation_t *d1, derivation_t *d2)
 #endif /* DEBUG */
 }
 
+static void
+skip_node(lvm_instance_t *p)
+{
+  operator_t *operator;
+  int i;
+
+  switch(get_type(p)) {
+  case LVM_OPERAND:
+    p->ip += sizeof(operand_t);
+    break;
+  case LVM_CMP_OP:
+  case LVM_ARITH_OP:
+    operator = get_operator(p);
+    for(i = *operator == LVM_NOT ? 1 : 2; i > 0; i--) {
+      skip_node(p);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+lvm_ip_t
+lvm_get_code_length(lvm_instance_t *p)
+{
+  p->ip = 0;
+  skip_node(p);
+  return p->ip;
+}
+
+static void
+substitute_variable(lvm_instance_t *p, variable_id_t id, long value)
+{
+  operator_t *operator;
+  operand_t operand;
+  int i;
+
+  switch(get_type(p)) {
+  case LVM_OPERAND:
+    get_operand(p, &operand);
+    if(operand.type == LVM_VARIABLE && operand.value.id == id) {
+      operand.type = LVM_LONG;
+      operand.value.l = value;
+      memcpy(&p->code[p->ip - sizeof(operand)], &operand, sizeof(operand));
+    }
+    break;
+  case LVM_CMP_OP:
+  case LVM_ARITH_OP:
+    operator = get_operator(p);
+    for(i = *operator == LVM_NOT ? 1 : 2; i > 0; i--) {
+      substitute_variable(p, id, value);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+lvm_status_t
+lvm_substitute_variable(lvm_instance_t *p, char *name, long value)
+{
+  variable_id_t id;
+
+  /* Replace the references to a variable with a constant, so that the
+     value can be used for deriving ranges and for folding. */
+  id = lookup(name);
+  if(id == LVM_MAX_VARIABLE_ID || variables[id].name[0] == '\0') {
+    return INVALID_IDENTIFIER;
+  }
+
+  p->ip = 0;
+  substitute_variable(p, id, value);
+  return TRUE;
+}
+
 static int
 derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
 {
@@ -586,10 +909,12 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
   node_type_t type;
   operand_t operand[2];
   int i;
-  int var;
   int variable_id;
+  operator_t op;
   operand_value_t *value;
   derivation_t *derivation;
+  lvm_ip_t ip;
+  lvm_status_t r1, r2;
 
   type = get_type(p);
   operator = get_operator(p);
@@ -607,15 +932,28 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
     memset(d1, 0, sizeof(d1));
     memset(d2, 0, sizeof(d2));
 
-    if(LVM_ERROR(derive_relation(p, d1)) ||
-       LVM_ERROR(derive_relation(p, d2))) {
-      return DERIVATION_ERROR;
+    /* A conjunction is at least as narrow as each of its terms, so
+       ranges can be derived from it even if one of the terms cannot
+       be used. Skip over such a term. */
+    ip = p->ip;
+    r1 = derive_relation(p, d1);
+    if(LVM_ERROR(r1)) {
+      p->ip = ip;
+      skip_node(p);
+    }
+    ip = p->ip;
+    r2 = derive_relation(p, d2);
+    if(LVM_ERROR(r2)) {
+      p->ip = ip;
+      skip_node(p);
     }
 
-    if(*operator == LVM_AND) {
+    if(*operator == LVM_AND && !(LVM_ERROR(r1) && LVM_ERROR(r2))) {
       create_intersection(local_derivations, d1, d2);
-    } else if(*operator == LVM_OR) {
+    } else if(*operator == LVM_OR && !LVM_ERROR(r1) && !LVM_ERROR(r2)) {
       create_union(local_derivations, d1, d2);
+    } else {
+      return DERIVATION_ERROR;
     }
     return TRUE;
   }
@@ -635,18 +973,34 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
     return DERIVATION_ERROR;
   }
 
-  /* Determine which of the operands that is the variable. */
+  /* Determine which of the operands that is the variable. If it is
+     the right operand, mirror the operator so that the variable can be
+     treated as the left operand. */
+  op = *operator;
   if(operand[0].type == LVM_VARIABLE) {
-    if(operand[1].type == LVM_VARIABLE) {
-      return DERIVATION_ERROR;
-    }
-    var = 0;
     variable_id = operand[0].value.id;
     value = &operand[1].value;
-  } else {
-    var = 1;
+  } else if(operand[1].type == LVM_VARIABLE) {
     variable_id = operand[1].value.id;
     value = &operand[0].value;
+    switch(op) {
+    case LVM_GE:
+      op = LVM_LE;
+      break;
+    case LVM_GEQ:
+      op = LVM_LEQ;
+      break;
+    case LVM_LE:
+      op = LVM_GE;
+      break;
+    case LVM_LEQ:
+      op = LVM_GEQ;
+      break;
+    default:
+      break;
+    }
+  } else {
+    return DERIVATION_ERROR;
   }
 
   if(variable_id >= LVM_MAX_VARIABLE_ID) {
@@ -660,7 +1014,7 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
   derivation->max.l = LONG_MAX;
   derivation->min.l = LONG_MIN;
 
-  switch(*operator) {
+  switch(op) {
   case LVM_EQ:
     derivation->max = *value;
     derivation->min = *value;
@@ -855,6 +1209,10 @@ main(void)
 
   lvm_execute(&p);
 
+  /* The same predicate, prepared. */
+  lvm_prepare(&p);
+  printf("Prepared result: %d\n", (int)lvm_execute_row(&p, NULL));
+
   /* Infix: !(9999 + 1 < -1 + 10001) => !(10000 < 10000) => true */
   lvm_reset(&p, code, sizeof(code));
   lvm_set_relation(&p, LVM_NOT);
@@ -899,7 +1257,7 @@ main(void)
   lvm_set_relation(&p, LVM_LE);
   lvm_set_variable(&p, "a");
   lvm_set_long(&p, 100);
-  lvm_set_relation(&p, LVM_GE);
+  lvm_set_relation(&p, LVM_LE);
   lvm_set_long(&p, 10);
   lvm_set_variable(&p, "a");
 
@@ -930,8 +1288,8 @@ main(void)
   lvm_set_long(&p, 100);
   lvm_set_relation(&p, LVM_OR);
   lvm_set_relation(&p, LVM_LE);
-  lvm_set_long(&p, 1000);
   lvm_set_variable(&p, "a");
+  lvm_set_long(&p, 1000);
   lvm_set_relation(&p, LVM_LE);
   lvm_set_variable(&p, "a");
   lvm_set_long(&p, 1902);
@@ -940,7 +1298,7 @@ main(void)
   lvm_print_derivations(&p);
 
   /* Infix: (a < 100 /\ a < 90 /\ a > 80 /\ a < 105) \/ b > 10000 =>
-     a:(81,89), b:(10001:oo) */
+     no ranges, because each variable is unconstrained on one side */
   lvm_reset(&p, code, sizeof(code));
   lvm_register_variable("a", LVM_LONG);
   lvm_register_variable("b", LVM_LONG);
@@ -128,12 +128,18 @@ lvm_status_t lvm_get_derived_range(lvm_instance_t *p, char *name,
                                    operand_value_t *max);
 void lvm_print_derivations(lvm_instance_t *p);
 lvm_status_t lvm_execute(lvm_instance_t *p);
+lvm_status_t lvm_prepare(lvm_instance_t *p);
+lvm_status_t lvm_execute_row(lvm_instance_t *p, const unsigned char *row);
 lvm_status_t lvm_register_variable(char *name, operand_type_t type);
 lvm_status_t lvm_set_variable_value(char *name, operand_value_t value);
+lvm_status_t lvm_bind_variable(char *name, unsigned offset, unsigned size);
+char *lvm_get_variable_name(variable_id_t id);
+lvm_status_t lvm_substitute_variable(lvm_instance_t *p, char *name, long value);
 void lvm_print_code(lvm_instance_t *p);
 lvm_ip_t lvm_jump_to_operand(lvm_instance_t *p);
 lvm_ip_t lvm_shift_for_operator(lvm_instance_t *p, lvm_ip_t end);
 lvm_ip_t lvm_get_end(lvm_instance_t *p);
+lvm_ip_t lvm_get_code_length(lvm_instance_t *p);
 lvm_ip_t lvm_set_end(lvm_instance_t *p, lvm_ip_t end);
 void lvm_set_op(lvm_instance_t *p, operator_t op);
 void lvm_set_relation(lvm_instance_t *p, operator_t op);
@@ -40,6 +40,7 @@
 #include "lib/crc16.h"
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "sys/ctimer.h"
 
 #define DEBUG DEBUG_NONE
 #include "net/uip-debug.h"
@@ -68,6 +69,30 @@ struct source_dest_map {
 
 static struct source_dest_map attr_map[AQL_ATTRIBUTE_LIMIT];
 
+/*
+ * An aggregating selection keeps the state of its aggregators for each
+ * distinct value of the grouping attribute in a fixed-size hash table.
+ * A selection without a GROUP BY clause has a single group with an
+ * empty key.
+ */
+#define GROUP_END	0xff
+
+#if DB_GROUP_LIMIT >= GROUP_END
+#error "DB_GROUP_LIMIT must be less than 255"
+#endif
+
+struct group {
+  long values[AQL_ATTRIBUTE_LIMIT];
+  long count;
+  uint8_t next;
+  unsigned char key[DB_MAX_ELEMENT_SIZE];
+};
+
+static struct group groups[DB_GROUP_LIMIT];
+static uint8_t group_buckets[DB_GROUP_HASH_BUCKETS];
+static uint8_t group_count;
+static struct source_dest_map *group_map;
+
 #if DB_FEATURE_JOIN
 /*
  * The source_map structure is used for mapping attributes to
@@ -79,6 +104,22 @@ struct source_map {
 };
 
 static struct source_map source_map[AQL_ATTRIBUTE_LIMIT];
+
+/*
+ * The hash table of a hash join maps join attribute values in the
+ * inner relation to the tuples that have them. Each bucket is a chain
+ * of entries linked by their indices.
+ */
+#define JOIN_HASH_END	0xffff
+
+struct join_hash_entry {
+  long key;
+  tuple_id_t tuple_id;
+  uint16_t next;
+};
+
+static struct join_hash_entry join_hash_entries[DB_JOIN_HASH_LIMIT];
+static uint16_t join_hash_buckets[DB_JOIN_HASH_BUCKETS];
 #endif /* DB_FEATURE_JOIN */
 
 static unsigned char row[DB_MAX_ATTRIBUTES_PER_RELATION * DB_MAX_ELEMENT_SIZE];
@@ -101,6 +142,17 @@ static void relation_clear(relation_t *);
 static relation_t *relation_allocate(void);
 static void relation_free(relation_t *);
 
+#if DB_INSERT_FLUSH_INTERVAL > 0
+static struct ctimer flush_timer;
+
+static void
+flush_inserts(void *ptr)
+{
+  PRINTF("DB: Flushing the insertion buffers\n");
+  relation_flush();
+}
+#endif /* DB_INSERT_FLUSH_INTERVAL > 0 */
+
 static relation_t *
 relation_find(char *name)
 {
@@ -205,6 +257,12 @@ relation_free(relation_t *rel)
 {
   attribute_t *attr;
 
+  /* Write out any rows that are buffered for the relation, and close
+     its tuple file. */
+  rel->references = 0;
+  storage_flush();
+  storage_unload(rel);
+
   while((attr = list_pop(rel->attributes)) != NULL) {
     attribute_free(rel, attr);
   }
@@ -281,7 +339,11 @@ relation_create(char *name, db_direction_t dir)
   if(*name != '\0') {
     relation_clear(&old_rel);
 
-    if(storage_get_relation(&old_rel, name) == DB_OK) {
+    /* Relations in memory, such as the result of a selection, are
+       never written to storage, so there is no need to look for
+       them in the storage. */
+    if(dir == DB_MEMORY ? relation_find(name) != NULL :
+       storage_get_relation(&old_rel, name) == DB_OK) {
       /* Reject a creation request if the relation already exists. */
       PRINTF("DB: Attempted to create a relation that already exists (%s)\n",
              name);
@@ -316,6 +378,20 @@ relation_create(char *name, db_direction_t dir)
   return NULL;
 }
 
+#if DB_FEATURE_DELTA
+db_result_t
+relation_set_delta(relation_t *rel)
+{
+  /* The storage format can only be chosen for a new relation. */
+  if(rel->dir != DB_STORAGE || rel->attribute_count > 0) {
+    return DB_RELATIONAL_ERROR;
+  }
+
+  rel->flags |= RELATION_FLAG_DELTA;
+  return storage_put_relation(rel);
+}
+#endif /* DB_FEATURE_DELTA */
+
 #if DB_FEATURE_REMOVE
 db_result_t
 relation_rename(char *old_name, char *new_name)
@@ -544,11 +620,34 @@ relation_insert(relation_t *rel, attribute_value_t *values)
 
   rel->cardinality++;
   rel->next_row++;
-  return storage_put_row(rel, record);
+  result = storage_put_row(rel, record);
+
+#if DB_INSERT_FLUSH_INTERVAL > 0
+  /* Bound the time that the tuple stays in the insertion buffers. */
+  if(ctimer_expired(&flush_timer)) {
+    ctimer_set(&flush_timer, DB_INSERT_FLUSH_INTERVAL, flush_inserts, NULL);
+  }
+#endif /* DB_INSERT_FLUSH_INTERVAL > 0 */
+
+  return result;
+}
+
+db_result_t
+relation_flush(void)
+{
+  db_result_t result;
+
+  /* Store the tuples before the index entries that refer to them. */
+  result = storage_flush();
+  if(DB_ERROR(index_flush())) {
+    result = DB_INDEX_ERROR;
+  }
+
+  return result;
 }
 
 static void
-aggregate(attribute_t *attr, attribute_value_t *value)
+aggregate(aql_aggregator_t aggregator, long *state, attribute_value_t *value)
 {
   long long_value;
 
@@ -563,25 +662,21 @@ aggregate(attribute_t *attr, attribute_value_t *value)
     return;
   }
 
-  switch(attr->aggregator) {
-  case AQL_COUNT:
-    attr->aggregation_value++;
-    break;
+  switch(aggregator) {
   case AQL_SUM:
-    attr->aggregation_value += long_value;
-    break;
   case AQL_MEAN:
+    *state += long_value;
     break;
   case AQL_MEDIAN:
     break;
   case AQL_MAX:
-    if(long_value > attr->aggregation_value) {
-      attr->aggregation_value = long_value;
+    if(long_value > *state) {
+      *state = long_value;
     }
     break;
   case AQL_MIN:
-    if(long_value < attr->aggregation_value) {
-      attr->aggregation_value = long_value;
+    if(long_value < *state) {
+      *state = long_value;
     }
     break;
   default:
@@ -589,6 +684,80 @@ aggregate(attribute_t *attr, attribute_value_t *value)
   }
 }
 
+static long
+aggregation_result(aql_aggregator_t aggregator, struct group *group, long state)
+{
+  switch(aggregator) {
+  case AQL_COUNT:
+    return group->count;
+  case AQL_MEAN:
+    return group->count > 0 ? state / group->count : 0;
+  default:
+    return state;
+  }
+}
+
+static void
+clear_groups(void)
+{
+  unsigned i;
+
+  for(i = 0; i < DB_GROUP_HASH_BUCKETS; i++) {
+    group_buckets[i] = GROUP_END;
+  }
+  group_count = 0;
+}
+
+static struct group *
+get_group(unsigned char *key, unsigned attribute_count)
+{
+  unsigned key_size;
+  unsigned hash;
+  unsigned i;
+  uint8_t group_id;
+  struct group *group;
+
+  key_size = group_map == NULL ? 0 : group_map->from_attr->element_size;
+  for(i = hash = 0; i < key_size; i++) {
+    hash = hash * 31 + key[i];
+  }
+  hash %= DB_GROUP_HASH_BUCKETS;
+
+  for(group_id = group_buckets[hash];
+      group_id != GROUP_END;
+      group_id = groups[group_id].next) {
+    if(memcmp(groups[group_id].key, key, key_size) == 0) {
+      return &groups[group_id];
+    }
+  }
+
+  if(group_count == DB_GROUP_LIMIT) {
+    PRINTF("DB: Too many groups in the selection\n");
+    return NULL;
+  }
+
+  group = &groups[group_count];
+  memcpy(group->key, key, key_size);
+  group->count = 0;
+  for(i = 0; i < attribute_count; i++) {
+    switch(attr_map[i].to_attr->aggregator) {
+    case AQL_MAX:
+      group->values[i] = LONG_MIN;
+      break;
+    case AQL_MIN:
+      group->values[i] = LONG_MAX;
+      break;
+    default:
+      group->values[i] = 0;
+      break;
+    }
+  }
+  group->next = group_buckets[hash];
+  group_buckets[hash] = group_count++;
+
+  return group;
+}
+
 static db_result_t
 generate_attribute_map(struct source_dest_map *attr_map, unsigned attribute_count,
                        relation_t *from_rel, relation_t *to_rel, 
@@ -648,14 +817,16 @@ select_index(db_handle_t *handle, lvm_instance_t *lvm_instance)
       attr != NULL;
       attr = attr->next) {
     if(attr->index != NULL &&
-       !LVM_ERROR(lvm_get_derived_range(lvm_instance, attr->name, &min, &max))) {
+       !LVM_ERROR(lvm_get_derived_range(lvm_instance, attr->name, &min, &max)) &&
+       (min.l != LONG_MIN || max.l != LONG_MAX)) {
       range = (unsigned long)max.l - (unsigned long)min.l;
       PRINTF("DB: The search range for attribute \"%s\" comprises %ld values\n",
              attr->name, range + 1);
 
       if(range <= min_range) {
+        min_range = range;
         index = attr->index;
-        av_min.domain = av_max.domain = DOMAIN_INT;
+        av_min.domain = av_max.domain = DOMAIN_LONG;
         VALUE_LONG(&av_min) = min.l;
         VALUE_LONG(&av_max) = max.l;
       }
@@ -671,12 +842,40 @@ select_index(db_handle_t *handle, lvm_instance_t *lvm_instance)
   }
 }
 
+static void
+remove_result_relation(char *name, db_direction_t dir)
+{
+  relation_t *rel;
+
+  if(dir == DB_STORAGE) {
+    relation_remove(name, 1);
+    return;
+  }
+
+  /* Drop the in-memory result of a previous query without accessing
+     the storage, unless it is still referenced by another handle. */
+  rel = relation_find(name);
+  if(rel != NULL && rel->references == 0) {
+    relation_free(rel);
+  }
+}
+
+static void
+release_result_relation(db_handle_t *handle)
+{
+  /* Release the result relation of a query that could not be started,
+     so that it can be removed by the next query. */
+  relation_release(handle->result_rel);
+  handle->result_rel = NULL;
+}
+
 static db_result_t
 generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
 {
   relation_t *result_rel;
   unsigned attribute_count;
   attribute_t *attr;
+  struct source_dest_map *attr_map_ptr;
 
   result_rel = handle->result_rel;
 
@@ -696,11 +895,48 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
     return DB_IMPLEMENTATION_ERROR;
   }
 
+  if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
+    clear_groups();
+    group_map = NULL;
+    for(attr_map_ptr = attr_map;
+        attr_map_ptr < attr_map + attribute_count;
+        attr_map_ptr++) {
+      if(attr_map_ptr->to_attr->flags & ATTRIBUTE_FLAG_GROUP) {
+        group_map = attr_map_ptr;
+      }
+    }
+    if(group_map == NULL) {
+      /* Without grouping, the aggregated result is produced even if
+         no tuple is selected. */
+      get_group(NULL, attribute_count);
+    }
+    handle->next_group = 0;
+  }
+
   if(adt->lvm_instance != NULL) {
-    /* Try to establish acceptable ranges for the attribute values. */
-    if(!LVM_ERROR(lvm_derive(adt->lvm_instance))) {
+    /* Try to establish acceptable ranges for the attribute values.
+       The ranges are of no use when the tuples that do not fulfil the
+       predicate are wanted. */
+    if(!(AQL_GET_FLAGS(adt) & AQL_FLAG_INVERSE_LOGIC) &&
+       !LVM_ERROR(lvm_derive(adt->lvm_instance))) {
       select_index(handle, adt->lvm_instance);
     }
+
+    /* Resolve the attributes of the predicate to their locations in
+       the rows of the relation, so that the predicate can be evaluated
+       directly on each row. */
+    for(attr_map_ptr = attr_map;
+        attr_map_ptr < attr_map + attribute_count;
+        attr_map_ptr++) {
+      attr = attr_map_ptr->from_attr;
+      if(attr->domain == DOMAIN_INT || attr->domain == DOMAIN_LONG) {
+        lvm_bind_variable(attr->name, attr_map_ptr->from_offset,
+                          attr->domain == DOMAIN_INT ? 2 : 4);
+      }
+    }
+    if(!LVM_ERROR(lvm_prepare(adt->lvm_instance))) {
+      handle->flags |= DB_HANDLE_FLAG_PREPARED;
+    }
   }
 
   handle->flags |= DB_HANDLE_FLAG_PROCESSING;
@@ -743,9 +979,9 @@ relation_process_select(void *handle_ptr)
   unsigned char *from_ptr;
   unsigned char *to_ptr;
   operand_value_t operand_value;
-  uint8_t intbuf[2];
   attribute_value_t value;
   lvm_status_t wanted_result;
+  struct group *group;
 
   handle = (db_handle_t *)handle_ptr;
   adt = (aql_adt_t *)handle->adt;
@@ -753,6 +989,10 @@ relation_process_select(void *handle_ptr)
   attribute_count = handle->result_rel->attribute_count;
   attr_map_end = attr_map + attribute_count;
 
+  if(handle->flags & DB_HANDLE_FLAG_GROUPS) {
+    goto end_aggregation;
+  }
+
   if(handle->flags & DB_HANDLE_FLAG_SEARCH_INDEX) {
     handle->tuple_id = index_get_next(&handle->index_iterator);
     if(handle->tuple_id == INVALID_TUPLE) {
@@ -788,11 +1028,14 @@ relation_process_select(void *handle_ptr)
     from_ptr = row + attr_map_ptr->from_offset;
     result_attr = attr_map_ptr->to_attr;
 
-    /* Update the internal state of the PLE. */
-    if(result_attr->domain == DOMAIN_INT) {
+    /* Update the internal state of the PLE, unless the predicate reads
+       the values from the row by itself. */
+    if(handle->flags & DB_HANDLE_FLAG_PREPARED) {
+      /* Nothing to do. */
+    } else if(attr_map_ptr->from_attr->domain == DOMAIN_INT) {
       operand_value.l = from_ptr[0] << 8 | from_ptr[1];
       lvm_set_variable_value(result_attr->name, operand_value);
-    } else if(result_attr->domain == DOMAIN_LONG) {
+    } else if(attr_map_ptr->from_attr->domain == DOMAIN_LONG) {
       operand_value.l = (uint32_t)from_ptr[0] << 24 |
                         (uint32_t)from_ptr[1] << 16 |
                         (uint32_t)from_ptr[2] << 8 |
@@ -820,15 +1063,26 @@ relation_process_select(void *handle_ptr)
 
   /* Check whether the given predicate is true for this tuple. */
   if(adt->lvm_instance == NULL ||
-     lvm_execute(adt->lvm_instance) == wanted_result) {
+     lvm_execute_row(adt->lvm_instance, row) == wanted_result) {
     if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
+      group = get_group(group_map == NULL ? NULL : row + group_map->from_offset,
+                        attribute_count);
+      if(group == NULL) {
+        return DB_LIMIT_ERROR;
+      }
+      group->count++;
+
       for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
+        if(attr_map_ptr->to_attr->aggregator == AQL_NONE) {
+          continue;
+        }
         from_ptr = row + attr_map_ptr->from_offset;
-        result = db_phy_to_value(&value, attr_map_ptr->to_attr, from_ptr);
+        result = db_phy_to_value(&value, attr_map_ptr->from_attr, from_ptr);
         if(DB_ERROR(result)) {
 	  return result;
         }
-        aggregate(attr_map_ptr->to_attr, &value);
+        aggregate(attr_map_ptr->to_attr->aggregator,
+                  &group->values[attr_map_ptr - attr_map], &value);
       }
     } else {
       if(AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
@@ -845,15 +1099,31 @@ relation_process_select(void *handle_ptr)
   return DB_OK;
 
 end_aggregation:
-  /* Generate aggregated result if requested. */
+  /* Generate one aggregated tuple for each group. */
+  handle->flags |= DB_HANDLE_FLAG_GROUPS;
+  if(handle->next_group == group_count) {
+    AQL_GET_FLAGS(adt) &= ~AQL_FLAG_AGGREGATE; /* Stop the aggregation. */
+    return DB_FINISHED;
+  }
+  group = &groups[handle->next_group++];
+
   for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
     result_attr = attr_map_ptr->to_attr;
-    to_ptr = result_row + attr_map_ptr->to_offset;
+    if(result_attr->flags & ATTRIBUTE_FLAG_NO_STORE) {
+      continue;
+    }
 
-    intbuf[0] = result_attr->aggregation_value >> 8;
-    intbuf[1] = result_attr->aggregation_value & 0xff;
-    from_ptr = intbuf;
-    memcpy(to_ptr, from_ptr, result_attr->element_size);
+    to_ptr = result_row + attr_map_ptr->to_offset;
+    if(result_attr->aggregator == AQL_NONE) {
+      /* The grouping attribute. */
+      memcpy(to_ptr, group->key, result_attr->element_size);
+    } else {
+      value.domain = DOMAIN_LONG;
+      VALUE_LONG(&value) =
+        aggregation_result(result_attr->aggregator, group,
+                           group->values[attr_map_ptr - attr_map]);
+      db_value_to_phy(to_ptr, result_attr, &value);
+    }
   }
 
   if(AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
@@ -863,8 +1133,7 @@ end_aggregation:
     }
   }
 
-  handle->current_row = 1;
-  AQL_GET_FLAGS(adt) &= ~AQL_FLAG_AGGREGATE; /* Stop the aggregation. */
+  handle->current_row++;
 
   return DB_GOT_ROW;
 }
@@ -894,7 +1163,7 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     name = RESULT_RELATION;
     dir = DB_MEMORY;
   }
-  relation_remove(name, 1);
+  remove_result_relation(name, dir);
   relation_create(name, dir);
   handle->result_rel = relation_load(name);
 
@@ -910,149 +1179,377 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     if(attr == NULL) {
       PRINTF("DB: Select for invalid attribute %s in relation %s!\n",
 	     attribute_name, rel->name);
+      release_result_relation(handle);
       return DB_NAME_ERROR;
     }
 
     PRINTF("DB: Found attribute %s in relation %s\n",
 	attribute_name, rel->name);
 
+    /* Aggregated values are produced in the LONG domain, so that
+       sums and counts of INT attributes do not overflow. */
     attr = relation_attribute_add(handle->result_rel, dir,
 				  attribute_name, 
-				  adt->aggregators[i] ? DOMAIN_INT : attr->domain,
-				  attr->element_size);
+				  adt->aggregators[i] ? DOMAIN_LONG : attr->domain,
+				  adt->aggregators[i] ? 4 : attr->element_size);
     if(attr == NULL) {
       PRINTF("DB: Failed to add a result attribute\n");
-      relation_release(handle->result_rel);
+      release_result_relation(handle);
       return DB_ALLOCATION_ERROR;
     }
 
     attr->aggregator = adt->aggregators[i];
-    switch(attr->aggregator) {
-    case AQL_NONE:
-      if(!(adt->attributes[i].flags & ATTRIBUTE_FLAG_NO_STORE)) {
-        /* Only count attributes projected into the result set. */
-        normal_attributes++;
-      }
-      break;
-    case AQL_MAX:
-      attr->aggregation_value = LONG_MIN;
-      break;
-    case AQL_MIN:
-      attr->aggregation_value = LONG_MAX;
-      break;
-    default:
-      attr->aggregation_value = 0;
-      break;
-    }
-
     attr->flags = adt->attributes[i].flags;
+    if(attr->aggregator == AQL_NONE &&
+       !(attr->flags & (ATTRIBUTE_FLAG_NO_STORE | ATTRIBUTE_FLAG_GROUP))) {
+      /* Only count attributes projected into the result set. */
+      normal_attributes++;
+    }
   }
 
   /* Preclude mixes of normal attributes and aggregated ones in 
-     selection results. */
-  if(normal_attributes > 0 &&
-     handle->result_rel->attribute_count > normal_attributes) {
-     return DB_RELATIONAL_ERROR;
+     selection results. The grouping attribute is the only normal
+     attribute allowed in an aggregated result. */
+  if(normal_attributes > 0 && (AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE)) {
+    release_result_relation(handle);
+    return DB_RELATIONAL_ERROR;
   }
 
   return generate_selection_result(handle, rel, adt);
 }
 
 #if DB_FEATURE_JOIN
-db_result_t
-relation_process_join(void *handle_ptr)
+#define JOIN_HASH(key)	((unsigned long)(key) % DB_JOIN_HASH_BUCKETS)
+
+static int
+join_key_is_integral(attribute_t *attr)
 {
-  db_handle_t *handle;
-  db_result_t result;
-  relation_t *left_rel;
-  relation_t *right_rel;
-  relation_t *join_rel;
-  unsigned char *join_next_attribute_ptr;
-  size_t element_size;
-  tuple_id_t right_tuple_id;
+  return attr->domain == DOMAIN_INT || attr->domain == DOMAIN_LONG;
+}
+
+static int
+join_values_equal(attribute_value_t *value1, attribute_value_t *value2)
+{
+  if(value1->domain == DOMAIN_STRING || value2->domain == DOMAIN_STRING) {
+    return value1->domain == value2->domain &&
+           strcmp((char *)VALUE_STRING(value1),
+                  (char *)VALUE_STRING(value2)) == 0;
+  }
+
+  return db_value_to_long(value1) == db_value_to_long(value2);
+}
+
+static void
+get_join_roles(db_handle_t *handle,
+               relation_t **outer_rel, attribute_t **outer_attr,
+               unsigned char **outer_row,
+               relation_t **inner_rel, attribute_t **inner_attr,
+               unsigned char **inner_row)
+{
+  /* The source map refers to the left and right row buffers, so the
+     rows of each relation must be read into the same buffer regardless
+     of which one is iterated in the outer loop. */
+  if(handle->flags & DB_HANDLE_FLAG_JOIN_SWAPPED) {
+    *outer_rel = handle->right_rel;
+    *outer_attr = handle->right_join_attr;
+    *outer_row = right_row;
+    *inner_rel = handle->left_rel;
+    *inner_attr = handle->left_join_attr;
+    *inner_row = left_row;
+  } else {
+    *outer_rel = handle->left_rel;
+    *outer_attr = handle->left_join_attr;
+    *outer_row = left_row;
+    *inner_rel = handle->right_rel;
+    *inner_attr = handle->right_join_attr;
+    *inner_row = right_row;
+  }
+}
+
+static db_result_t
+build_join_hash(db_handle_t *handle)
+{
+  relation_t *outer_rel;
+  relation_t *inner_rel;
+  attribute_t *outer_attr;
+  attribute_t *inner_attr;
+  unsigned char *outer_row;
+  unsigned char *inner_row;
   attribute_value_t value;
-  int i;
+  tuple_id_t tuple_id;
+  db_result_t result;
+  struct join_hash_entry *entry;
+  unsigned bucket;
+  uint16_t count;
 
-  handle = (db_handle_t *)handle_ptr;
-  left_rel = handle->left_rel;
-  right_rel = handle->right_rel;
-  join_rel = handle->join_rel;
+  get_join_roles(handle, &outer_rel, &outer_attr, &outer_row,
+                 &inner_rel, &inner_attr, &inner_row);
 
-  if(!(handle->flags & DB_HANDLE_FLAG_INDEX_STEP)) {
-    goto inner_loop;
+  for(bucket = 0; bucket < DB_JOIN_HASH_BUCKETS; bucket++) {
+    join_hash_buckets[bucket] = JOIN_HASH_END;
   }
 
-  /* Equi-join for indexed attributes only. In the outer loop, we iterate over
-     each tuple in the left relation. */
-  for(handle->tuple_id = 0;; handle->tuple_id++) {
-    result = storage_get_row(left_rel, &handle->tuple_id, left_row);
+  for(tuple_id = 0, count = 0;; tuple_id++) {
+    result = storage_get_row(inner_rel, &tuple_id, inner_row);
     if(DB_ERROR(result)) {
-      PRINTF("DB: Failed to get a row in left relation %s!\n", left_rel->name);
       return result;
     } else if(result == DB_FINISHED) {
-      return DB_FINISHED;
+      break;
     }
 
-    if(DB_ERROR(relation_get_value(left_rel, handle->left_join_attr, left_row, &value))) {
-      PRINTF("DB: Failed to get a value of the attribute \"%s\" to join on\n",
-	handle->left_join_attr->name);
+    if(count == DB_JOIN_HASH_LIMIT) {
+      PRINTF("DB: The hash table is full after %u tuples\n", (unsigned)count);
+      return DB_ALLOCATION_ERROR;
+    }
+
+    if(DB_ERROR(relation_get_value(inner_rel, inner_attr, inner_row, &value))) {
       return DB_IMPLEMENTATION_ERROR;
     }
 
-    if(DB_ERROR(index_get_iterator(&handle->index_iterator, 
-                                   handle->right_join_attr->index, 
-                                   &value, &value))) { 
+    /* Append the entry to its chain, so that the inner tuples matching
+       an outer tuple are produced in storage order. */
+    entry = &join_hash_entries[count];
+    entry->key = db_value_to_long(&value);
+    entry->tuple_id = tuple_id;
+    entry->next = JOIN_HASH_END;
+
+    bucket = JOIN_HASH(entry->key);
+    if(join_hash_buckets[bucket] == JOIN_HASH_END) {
+      join_hash_buckets[bucket] = count;
+    } else {
+      uint16_t last;
+
+      for(last = join_hash_buckets[bucket];
+          join_hash_entries[last].next != JOIN_HASH_END;
+          last = join_hash_entries[last].next);
+      join_hash_entries[last].next = count;
+    }
+    count++;
+  }
+
+  PRINTF("DB: Built a join hash table over %u tuples in %s\n",
+         (unsigned)count, inner_rel->name);
+
+  return DB_OK;
+}
+
+static db_result_t
+start_inner_loop(db_handle_t *handle, attribute_t *inner_attr,
+                 attribute_value_t *value)
+{
+  switch(handle->join_method) {
+  case DB_JOIN_INDEX:
+    if(DB_ERROR(index_get_iterator(&handle->index_iterator,
+                                   inner_attr->index, value, value))) {
       PRINTF("DB: Failed to get an index iterator\n");
       return DB_INDEX_ERROR;
     }
-    handle->flags &= ~DB_HANDLE_FLAG_INDEX_STEP;
+    break;
+  case DB_JOIN_HASH:
+    handle->join_inner_id = join_hash_buckets[JOIN_HASH(db_value_to_long(value))];
+    break;
+  default:
+    handle->join_inner_id = 0;
+    break;
+  }
 
-    /* In the inner loop, we iterate over all rows with a matching value for the
-       join attribute. The index component provides an iterator for this purpose. */
-inner_loop:
+  return DB_OK;
+}
+
+/* Read the next row of the inner relation that matches the value of the
+   join attribute in the outer row. Returns DB_FINISHED when there are no
+   more matching rows. */
+static db_result_t
+get_inner_row(db_handle_t *handle, relation_t *inner_rel,
+              attribute_t *inner_attr, unsigned char *inner_row,
+              attribute_value_t *value)
+{
+  tuple_id_t tuple_id;
+  attribute_value_t inner_value;
+  struct join_hash_entry *entry;
+  db_result_t result;
+  long key;
+
+  switch(handle->join_method) {
+  case DB_JOIN_INDEX:
+    tuple_id = index_get_next(&handle->index_iterator);
+    if(tuple_id == INVALID_TUPLE) {
+      return DB_FINISHED;
+    }
+    break;
+  case DB_JOIN_HASH:
+    key = db_value_to_long(value);
     for(;;) {
-      /* Get all rows matching the attribute value in the right relation. */
-      right_tuple_id = index_get_next(&handle->index_iterator);
-      if(right_tuple_id == INVALID_TUPLE) {
-        /* Exclude this row from the left relation in the result,
-           and step to the next value in the index iteration. */
-        handle->flags |= DB_HANDLE_FLAG_INDEX_STEP;
+      if(handle->join_inner_id == JOIN_HASH_END) {
+        return DB_FINISHED;
+      }
+      entry = &join_hash_entries[handle->join_inner_id];
+      handle->join_inner_id = entry->next;
+      if(entry->key == key) {
+        tuple_id = entry->tuple_id;
         break;
       }
-
-      result = storage_get_row(right_rel, &right_tuple_id, right_row);
-      if(DB_ERROR(result)) {
-        PRINTF("DB: Failed to get a row in right relation %s!\n", right_rel->name);
+    }
+    break;
+  default:
+    /* Nested loop: scan the inner relation from where the previous
+       call stopped. */
+    for(;;) {
+      tuple_id = handle->join_inner_id;
+      result = storage_get_row(inner_rel, &tuple_id, inner_row);
+      if(result != DB_OK) {
         return result;
-      } else if(result == DB_FINISHED) {
-	PRINTF("DB: The index refers to an invalid row: %lu\n",
-	       (unsigned long)right_tuple_id);
+      }
+      handle->join_inner_id++;
+
+      if(DB_ERROR(relation_get_value(inner_rel, inner_attr, inner_row,
+                                     &inner_value))) {
         return DB_IMPLEMENTATION_ERROR;
       }
+      if(join_values_equal(value, &inner_value)) {
+        return DB_OK;
+      }
+    }
+  }
 
-      /* Use the source attribute map to fill in the physical representation
-	 of the resulting tuple. */
-      join_next_attribute_ptr = join_row;
+  result = storage_get_row(inner_rel, &tuple_id, inner_row);
+  if(result == DB_FINISHED) {
+    PRINTF("DB: The join refers to an invalid row: %lu\n",
+           (unsigned long)tuple_id);
+    return DB_IMPLEMENTATION_ERROR;
+  }
+
+  return result;
+}
 
-      for(i = 0; i < join_rel->attribute_count; i++) {
-	element_size = source_map[i].attr->element_size;
+db_result_t
+relation_process_join(void *handle_ptr)
+{
+  db_handle_t *handle;
+  db_result_t result;
+  relation_t *outer_rel;
+  relation_t *inner_rel;
+  relation_t *join_rel;
+  attribute_t *outer_attr;
+  attribute_t *inner_attr;
+  unsigned char *outer_row;
+  unsigned char *inner_row;
+  unsigned char *join_next_attribute_ptr;
+  size_t element_size;
+  attribute_value_t value;
+  int i;
 
-	memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
-	join_next_attribute_ptr += element_size;
+  handle = (db_handle_t *)handle_ptr;
+  join_rel = handle->join_rel;
+  get_join_roles(handle, &outer_rel, &outer_attr, &outer_row,
+                 &inner_rel, &inner_attr, &inner_row);
+
+  /* Equi-join. In the outer loop, we iterate over each tuple in the outer
+     relation. In the inner loop, we iterate over all tuples of the inner
+     relation that have a matching value for the join attribute. Depending
+     on the join method, these are found through an index on the inner
+     relation, through a hash table built over the inner relation, or by
+     scanning the inner relation. */
+  for(;;) {
+    if(handle->flags & DB_HANDLE_FLAG_INDEX_STEP) {
+      result = storage_get_row(outer_rel, &handle->tuple_id, outer_row);
+      if(DB_ERROR(result)) {
+        PRINTF("DB: Failed to get a row in relation %s!\n", outer_rel->name);
+        return result;
+      } else if(result == DB_FINISHED) {
+        return DB_FINISHED;
       }
+    }
 
-      if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
-        if(DB_ERROR(storage_put_row(join_rel, join_row))) {
-          return DB_STORAGE_ERROR;
-        }
+    if(DB_ERROR(relation_get_value(outer_rel, outer_attr, outer_row, &value))) {
+      PRINTF("DB: Failed to get a value of the attribute \"%s\" to join on\n",
+	outer_attr->name);
+      return DB_IMPLEMENTATION_ERROR;
+    }
+
+    if(handle->flags & DB_HANDLE_FLAG_INDEX_STEP) {
+      result = start_inner_loop(handle, inner_attr, &value);
+      if(DB_ERROR(result)) {
+        return result;
       }
+      handle->flags &= ~DB_HANDLE_FLAG_INDEX_STEP;
+    }
 
-      handle->current_row++;
-      return DB_GOT_ROW;
+    result = get_inner_row(handle, inner_rel, inner_attr, inner_row, &value);
+    if(DB_ERROR(result)) {
+      PRINTF("DB: Failed to get a row in relation %s!\n", inner_rel->name);
+      return result;
+    } else if(result == DB_FINISHED) {
+      /* Exclude this row from the outer relation in the result,
+         and step to the next one. */
+      handle->flags |= DB_HANDLE_FLAG_INDEX_STEP;
+      handle->tuple_id++;
+      continue;
+    }
+
+    /* Use the source attribute map to fill in the physical representation
+       of the resulting tuple. */
+    join_next_attribute_ptr = join_row;
+
+    for(i = 0; i < join_rel->attribute_count; i++) {
+      element_size = source_map[i].attr->element_size;
+
+      memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
+      join_next_attribute_ptr += element_size;
+    }
+
+    if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
+      if(DB_ERROR(storage_put_row(join_rel, join_row))) {
+        return DB_STORAGE_ERROR;
+      }
     }
+
+    handle->current_row++;
+    return DB_GOT_ROW;
   }
+}
 
-  return DB_OK;
+static void
+select_join_method(db_handle_t *handle)
+{
+  tuple_id_t left_cardinality;
+  tuple_id_t right_cardinality;
+  tuple_id_t inner_cardinality;
+
+  handle->flags &= ~DB_HANDLE_FLAG_JOIN_SWAPPED;
+
+  /* Prefer an index on the inner relation, and let the relation that has
+     one be the inner relation. */
+  if(index_exists(handle->right_join_attr)) {
+    handle->join_method = DB_JOIN_INDEX;
+    return;
+  }
+  if(index_exists(handle->left_join_attr)) {
+    handle->join_method = DB_JOIN_INDEX;
+    handle->flags |= DB_HANDLE_FLAG_JOIN_SWAPPED;
+    return;
+  }
+
+  /* Otherwise, the smaller relation becomes the inner relation. */
+  left_cardinality = relation_cardinality(handle->left_rel);
+  right_cardinality = relation_cardinality(handle->right_rel);
+  inner_cardinality = right_cardinality;
+  if(left_cardinality < right_cardinality) {
+    handle->flags |= DB_HANDLE_FLAG_JOIN_SWAPPED;
+    inner_cardinality = left_cardinality;
+  }
+
+  handle->join_method = DB_JOIN_NESTED_LOOP;
+  if(join_key_is_integral(handle->left_join_attr) &&
+     join_key_is_integral(handle->right_join_attr) &&
+     inner_cardinality <= DB_JOIN_HASH_LIMIT &&
+     build_join_hash(handle) == DB_OK) {
+    handle->join_method = DB_JOIN_HASH;
+  }
+
+  PRINTF("DB: Join method %d over %lu and %lu tuples\n",
+         handle->join_method, (unsigned long)left_cardinality,
+         (unsigned long)right_cardinality);
 }
 
 static db_result_t
@@ -1136,7 +1633,7 @@ relation_join(void *query_result, void *adt_ptr)
     name = RESULT_RELATION;
     dir = DB_MEMORY;
   }
-  relation_remove(name, 1);
+  remove_result_relation(name, dir);
   relation_create(name, dir);
   join_rel = relation_load(name);
   handle->result_rel = join_rel;
@@ -1158,10 +1655,7 @@ relation_join(void *query_result, void *adt_ptr)
     return DB_RELATIONAL_ERROR;
   }
 
-  if(!index_exists(handle->right_join_attr)) {
-    PRINTF("DB: The attribute to join on is not indexed\n");
-    return DB_INDEX_ERROR;
-  }
+  select_join_method(handle);
 
   /*
    * Define the resulting relation. We start from 1 when counting attributes
@@ -56,6 +56,9 @@ typedef enum db_direction {
 
 #define RELATION_HAS_TUPLES(rel) ((rel)->tuple_storage >= 0)
 
+/* The tuples of the relation are stored delta encoded. */
+#define RELATION_FLAG_DELTA	0x01
+
 /*
  * A relation consists of a name, a set of domains, a set of indexes,
  * and a set of keys. Each relation must have a primary key.
@@ -71,6 +74,7 @@ struct relation {
   db_storage_id_t tuple_storage;
   db_direction_t dir;
   uint8_t references;
+  uint8_t flags;
   char name[RELATION_NAME_LENGTH + 1];
   char tuple_filename[RELATION_NAME_LENGTH + 1];
 };
@@ -95,8 +99,10 @@ db_result_t relation_attribute_remove(relation_t *, char *);
 db_result_t relation_set_primary_key(relation_t *, char *);
 db_result_t relation_remove(char *, int);
 db_result_t relation_insert(relation_t *, attribute_value_t *);
+db_result_t relation_flush(void);
 db_result_t relation_select(void *, relation_t *, void *);
 db_result_t relation_join(void *, void *);
 tuple_id_t relation_cardinality(relation_t *);
+db_result_t relation_set_delta(relation_t *);
 
 #endif /* RELATION_H */
@@ -49,11 +49,20 @@ typedef unsigned char *tuple_t;
 #define DB_HANDLE_FLAG_INDEX_STEP	0x01
 #define DB_HANDLE_FLAG_SEARCH_INDEX	0x02
 #define DB_HANDLE_FLAG_PROCESSING	0x04
+#define DB_HANDLE_FLAG_PREPARED		0x08
+#define DB_HANDLE_FLAG_JOIN_SWAPPED	0x10
+#define DB_HANDLE_FLAG_GROUPS		0x20
+
+/* Join methods, in order of preference. */
+#define DB_JOIN_INDEX			0
+#define DB_JOIN_HASH			1
+#define DB_JOIN_NESTED_LOOP		2
 
 struct db_handle {
   index_iterator_t index_iterator;
   tuple_id_t tuple_id;
   tuple_id_t current_row;
+  tuple_id_t join_inner_id;
   relation_t *rel;
   relation_t *left_rel;
   relation_t *join_rel;
@@ -64,6 +73,8 @@ struct db_handle {
   tuple_t tuple;
   uint8_t flags;
   uint8_t ncolumns;
+  uint8_t join_method;
+  uint8_t next_group;
   void *adt;
 };
 typedef struct db_handle db_handle_t;
@@ -58,6 +58,10 @@ struct index_record {
   char attribute_name[ATTRIBUTE_NAME_LENGTH];
   char file_name[DB_MAX_FILENAME_LENGTH];
   uint8_t type;
+#if DB_BLOOM_FILTER_SIZE > 0
+  tuple_id_t bloom_cardinality;
+  uint8_t bloom_filter[DB_BLOOM_FILTER_SIZE];
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
 };
 
 #if DB_FEATURE_COFFEE
@@ -68,6 +72,66 @@ struct index_record {
 
 #define ROW_XOR 0xf6U
 
+/*
+ * Tuples are read ahead into a read buffer when a relation is scanned
+ * sequentially, and appended tuples are collected in the write buffer
+ * until it is full or the relation is accessed in another way.
+ */
+struct read_buffer {
+  relation_t *rel;
+  tuple_id_t first;
+  tuple_id_t next;
+  uint16_t rows;
+  uint8_t age;
+  unsigned char data[DB_ROW_BUFFER_SIZE];
+};
+
+struct write_buffer {
+  relation_t *rel;
+  uint16_t rows;
+  unsigned char data[DB_ROW_BUFFER_SIZE];
+};
+
+static struct read_buffer read_buffers[DB_ROW_READ_BUFFERS];
+static struct write_buffer write_buffer;
+static uint8_t read_clock;
+
+#if DB_FEATURE_DELTA
+/*
+ * Delta encoded relations store their tuples in blocks of
+ * DB_DELTA_BLOCK_SIZE bytes. A block starts with the ID of its first
+ * tuple, which makes the block headers a sparse index that can be
+ * searched for random accesses. Each number in a tuple is stored as
+ * the zig-zag encoded difference from the same attribute in the
+ * previous tuple of the block, using as few bytes as possible. Other
+ * values are stored verbatim. The first tuple of a block is encoded
+ * against zeroes, so that every block can be decoded on its own.
+ *
+ * One block is decoded at a time for reading, and the last block of
+ * one relation is kept in memory for appending tuples to it.
+ */
+#define DELTA_HEADER_SIZE	4
+
+struct delta_block {
+  relation_t *rel;
+  unsigned block;
+  tuple_id_t first;
+  tuple_id_t next;
+  tuple_id_t end;
+  uint16_t offset;
+  uint16_t length;
+  unsigned char data[DB_DELTA_BLOCK_SIZE];
+  unsigned char row[DB_DELTA_BLOCK_SIZE];
+};
+
+/* In the reader, "end" is the first tuple after the block, and
+   "length" is the amount of bytes in the block. In the writer, "end"
+   is the cardinality of the relation, and "length" is the amount of
+   bytes that have been written to storage. */
+static struct delta_block delta_reader;
+static struct delta_block delta_writer;
+#endif /* DB_FEATURE_DELTA */
+
 static void
 merge_strings(char *dest, char *prefix, char *suffix)
 {
@@ -75,6 +139,505 @@ merge_strings(char *dest, char *prefix, char *suffix)
   strcat(dest, suffix);
 }
 
+static db_result_t
+write_rows(relation_t *rel, unsigned char *data, unsigned length)
+{
+  cfs_offset_t end;
+  int r;
+#if DB_FEATURE_INTEGRITY
+  int missing_bytes;
+  char buf[rel->row_length];
+#endif
+
+  end = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
+  if(end == (cfs_offset_t)-1) {
+    return DB_STORAGE_ERROR;
+  }
+
+#if DB_FEATURE_INTEGRITY
+  missing_bytes = end % rel->row_length;
+#if DB_FEATURE_DELTA
+  if(rel->flags & RELATION_FLAG_DELTA) {
+    missing_bytes = 0;
+  }
+#endif /* DB_FEATURE_DELTA */
+  if(missing_bytes > 0) {
+    memset(buf, 0xff, sizeof(buf));
+    r = cfs_write(rel->tuple_storage, buf, sizeof(buf));
+    if(r != missing_bytes) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+#endif
+
+  do {
+    r = cfs_write(rel->tuple_storage, data, length);
+    if(r < 0) {
+      PRINTF("DB: Failed to store %u bytes\n", length);
+      return DB_STORAGE_ERROR;
+    }
+    data += r;
+    length -= r;
+  } while(length > 0);
+
+  return DB_OK;
+}
+
+static void close_tuples(relation_t *);
+
+static db_result_t
+flush_rows(relation_t *rel)
+{
+  db_result_t result;
+
+  if(write_buffer.rel != rel || write_buffer.rows == 0) {
+    return DB_OK;
+  }
+
+  PRINTF("DB: Flushing %u buffered rows to relation %s\n",
+         (unsigned)write_buffer.rows, rel->name);
+
+  result = write_rows(rel, write_buffer.data,
+                      write_buffer.rows * rel->row_length);
+  write_buffer.rows = 0;
+  if(rel->references == 0) {
+    /* The relation was unloaded while it had buffered rows. */
+    close_tuples(rel);
+  }
+  return result;
+}
+
+static void
+invalidate_rows(relation_t *rel)
+{
+  int i;
+
+  for(i = 0; i < DB_ROW_READ_BUFFERS; i++) {
+    if(read_buffers[i].rel == rel) {
+      read_buffers[i].rel = NULL;
+    }
+  }
+}
+
+static struct read_buffer *
+get_read_buffer(relation_t *rel, tuple_id_t tuple_id)
+{
+  struct read_buffer *buffer;
+  struct read_buffer *victim;
+  int i;
+
+  victim = NULL;
+  for(i = 0; i < DB_ROW_READ_BUFFERS; i++) {
+    buffer = &read_buffers[i];
+    if(buffer->rel == rel) {
+      if(tuple_id >= buffer->first && tuple_id < buffer->first + buffer->rows) {
+        buffer->age = ++read_clock;
+        return buffer;
+      }
+      /* Keep at most one buffer per relation. */
+      victim = buffer;
+      break;
+    }
+    if(victim == NULL || buffer->rel == NULL ||
+       (victim->rel != NULL &&
+        (uint8_t)(read_clock - buffer->age) >
+        (uint8_t)(read_clock - victim->age))) {
+      victim = buffer;
+    }
+  }
+
+  if(victim->rel != rel) {
+    victim->rel = rel;
+    victim->next = INVALID_TUPLE;
+  }
+  victim->rows = 0;
+  victim->age = ++read_clock;
+  return victim;
+}
+
+#if DB_FEATURE_DELTA
+static uint32_t
+get_number(unsigned char *ptr, unsigned size)
+{
+  uint32_t value;
+
+  /* Sign-extend the value so that small negative changes of an INT
+     attribute remain small. */
+  value = ptr[0] & 0x80 ? (uint32_t)-1 : 0;
+  while(size-- > 0) {
+    value = value << 8 | *ptr++;
+  }
+  return value;
+}
+
+static void
+put_number(unsigned char *ptr, unsigned size, uint32_t value)
+{
+  while(size-- > 0) {
+    ptr[size] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+static unsigned
+encode_row(relation_t *rel, unsigned char *prev, unsigned char *row,
+           unsigned char *ptr, unsigned space)
+{
+  attribute_t *attr;
+  unsigned length;
+  unsigned offset;
+  uint32_t delta;
+
+  length = 0;
+  offset = 0;
+  for(attr = list_head(rel->attributes); attr != NULL; attr = attr->next) {
+    if(attr->domain == DOMAIN_INT || attr->domain == DOMAIN_LONG) {
+      delta = get_number(row + offset, attr->element_size) -
+              get_number(prev + offset, attr->element_size);
+      delta = (delta << 1) ^ -(delta >> 31);
+      /* Seven bits are stored per byte, and the last byte of a number
+         is marked by the high bit. Hence, the last byte of a tuple is
+         never 0, which Coffee requires at the end of a file. */
+      do {
+        if(length == space) {
+          return 0;
+        }
+        ptr[length++] = (delta & 0x7f) | (delta < 0x80 ? 0x80 : 0);
+        delta >>= 7;
+      } while(delta > 0);
+    } else {
+      if(length + attr->element_size > space) {
+        return 0;
+      }
+      memcpy(ptr + length, row + offset, attr->element_size);
+      length += attr->element_size;
+      ptr[length - 1] ^= ROW_XOR;
+    }
+    offset += attr->element_size;
+  }
+
+  return length;
+}
+
+static unsigned
+decode_row(relation_t *rel, unsigned char *row,
+           unsigned char *ptr, unsigned space)
+{
+  attribute_t *attr;
+  unsigned length;
+  unsigned offset;
+  unsigned shift;
+  uint32_t delta;
+
+  length = 0;
+  offset = 0;
+  for(attr = list_head(rel->attributes); attr != NULL; attr = attr->next) {
+    if(attr->domain == DOMAIN_INT || attr->domain == DOMAIN_LONG) {
+      delta = 0;
+      shift = 0;
+      do {
+        if(length == space || shift > 28) {
+          return 0;
+        }
+        delta |= (uint32_t)(ptr[length] & 0x7f) << shift;
+        shift += 7;
+      } while(!(ptr[length++] & 0x80));
+      delta = (delta >> 1) ^ -(delta & 1);
+      put_number(row + offset, attr->element_size,
+                 get_number(row + offset, attr->element_size) + delta);
+    } else {
+      if(length + attr->element_size > space) {
+        return 0;
+      }
+      memcpy(row + offset, ptr + length, attr->element_size);
+      length += attr->element_size;
+      row[offset + attr->element_size - 1] ^= ROW_XOR;
+    }
+    offset += attr->element_size;
+  }
+
+  return length;
+}
+
+static unsigned
+max_encoded_length(relation_t *rel)
+{
+  attribute_t *attr;
+  unsigned length;
+
+  length = 0;
+  for(attr = list_head(rel->attributes); attr != NULL; attr = attr->next) {
+    if(attr->domain == DOMAIN_INT || attr->domain == DOMAIN_LONG) {
+      /* A 32-bit number takes at most five bytes. */
+      length += 5;
+    } else {
+      length += attr->element_size;
+    }
+  }
+
+  return length;
+}
+
+static int
+read_block(relation_t *rel, unsigned block, unsigned char *data,
+           unsigned length)
+{
+  unsigned count;
+  int r;
+
+  if(cfs_seek(rel->tuple_storage, (cfs_offset_t)block * DB_DELTA_BLOCK_SIZE,
+              CFS_SEEK_SET) == (cfs_offset_t)-1) {
+    return -1;
+  }
+
+  for(count = 0; count < length; count += r) {
+    r = cfs_read(rel->tuple_storage, data + count, length - count);
+    if(r < 0) {
+      return -1;
+    } else if(r == 0) {
+      break;
+    }
+  }
+
+  return count;
+}
+
+static tuple_id_t
+read_block_header(relation_t *rel, unsigned block)
+{
+  unsigned char header[DELTA_HEADER_SIZE];
+
+  if(read_block(rel, block, header, sizeof(header)) != sizeof(header)) {
+    return INVALID_TUPLE;
+  }
+  return get_number(header, sizeof(header));
+}
+
+static db_result_t
+flush_delta_rows(relation_t *rel)
+{
+  db_result_t result;
+
+  if(rel == NULL || delta_writer.rel != rel ||
+     delta_writer.length == delta_writer.offset) {
+    return DB_OK;
+  }
+
+  result = write_rows(rel, delta_writer.data + delta_writer.length,
+                      delta_writer.offset - delta_writer.length);
+  delta_writer.length = delta_writer.offset;
+  if(rel->references == 0) {
+    close_tuples(rel);
+  }
+  return result;
+}
+
+static db_result_t
+load_delta_tail(relation_t *rel)
+{
+  cfs_offset_t end;
+  unsigned length;
+  unsigned r;
+
+  if(delta_writer.rel == rel) {
+    return DB_OK;
+  }
+
+  if(DB_ERROR(flush_delta_rows(delta_writer.rel))) {
+    return DB_STORAGE_ERROR;
+  }
+  delta_writer.rel = NULL;
+
+  end = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
+  if(end == (cfs_offset_t)-1) {
+    return DB_STORAGE_ERROR;
+  }
+
+  delta_writer.block = 0;
+  delta_writer.first = 0;
+  delta_writer.end = 0;
+  delta_writer.offset = 0;
+  delta_writer.length = 0;
+
+  if(end > 0) {
+    /* Decode the last block to find the cardinality of the relation
+       and the tuple that the next one is encoded against. */
+    delta_writer.block = (end - 1) / DB_DELTA_BLOCK_SIZE;
+    length = end - (cfs_offset_t)delta_writer.block * DB_DELTA_BLOCK_SIZE;
+    if(length < DELTA_HEADER_SIZE ||
+       read_block(rel, delta_writer.block, delta_writer.data, length) != length) {
+      return DB_STORAGE_ERROR;
+    }
+
+    delta_writer.first = get_number(delta_writer.data, DELTA_HEADER_SIZE);
+    delta_writer.end = delta_writer.first;
+    memset(delta_writer.row, 0, rel->row_length);
+    for(delta_writer.offset = DELTA_HEADER_SIZE;
+        delta_writer.offset < length;
+        delta_writer.offset += r) {
+      r = decode_row(rel, delta_writer.row,
+                     delta_writer.data + delta_writer.offset,
+                     length - delta_writer.offset);
+      if(r == 0) {
+        PRINTF("DB: Corrupt block %u in relation %s\n",
+               delta_writer.block, rel->name);
+        return DB_STORAGE_ERROR;
+      }
+      delta_writer.end++;
+    }
+    delta_writer.length = length;
+  }
+
+  delta_writer.rel = rel;
+  return DB_OK;
+}
+
+static db_result_t
+put_delta_row(relation_t *rel, storage_row_t row)
+{
+  unsigned length;
+
+  if(rel->row_length == 0 || rel->row_length > sizeof(delta_writer.row) ||
+     max_encoded_length(rel) > DB_DELTA_BLOCK_SIZE - DELTA_HEADER_SIZE) {
+    PRINTF("DB: The tuples of %s do not fit in a block\n", rel->name);
+    return DB_LIMIT_ERROR;
+  }
+
+  if(DB_ERROR(load_delta_tail(rel))) {
+    return DB_STORAGE_ERROR;
+  }
+
+  length = 0;
+  if(delta_writer.offset > 0) {
+    length = encode_row(rel, delta_writer.row, row,
+                        delta_writer.data + delta_writer.offset,
+                        DB_DELTA_BLOCK_SIZE - delta_writer.offset);
+  }
+
+  if(length == 0) {
+    if(delta_writer.offset > 0) {
+      /* Pad the full block, and start a new one. */
+      memset(delta_writer.data + delta_writer.offset, 0xff,
+             DB_DELTA_BLOCK_SIZE - delta_writer.offset);
+      delta_writer.offset = DB_DELTA_BLOCK_SIZE;
+      if(DB_ERROR(flush_delta_rows(rel))) {
+        return DB_STORAGE_ERROR;
+      }
+      delta_writer.block++;
+    }
+
+    delta_writer.first = delta_writer.end;
+    put_number(delta_writer.data, DELTA_HEADER_SIZE, delta_writer.first);
+    delta_writer.offset = DELTA_HEADER_SIZE;
+    delta_writer.length = 0;
+    memset(delta_writer.row, 0, rel->row_length);
+
+    length = encode_row(rel, delta_writer.row, row,
+                        delta_writer.data + delta_writer.offset,
+                        DB_DELTA_BLOCK_SIZE - delta_writer.offset);
+  }
+
+  memcpy(delta_writer.row, row, rel->row_length);
+  delta_writer.offset += length;
+  delta_writer.end++;
+
+  return DB_OK;
+}
+
+static db_result_t
+get_delta_row(relation_t *rel, tuple_id_t tuple_id, storage_row_t row)
+{
+  unsigned low;
+  unsigned high;
+  unsigned middle;
+  unsigned r;
+  int length;
+
+  if(delta_reader.rel != rel ||
+     tuple_id < delta_reader.first || tuple_id >= delta_reader.end) {
+    delta_reader.rel = NULL;
+
+    if(DB_ERROR(load_delta_tail(rel))) {
+      return DB_STORAGE_ERROR;
+    }
+    if(tuple_id >= delta_writer.end) {
+      return DB_FINISHED;
+    }
+    if(DB_ERROR(flush_delta_rows(rel))) {
+      return DB_STORAGE_ERROR;
+    }
+
+    /* Search for the last block that starts at or before the tuple. */
+    low = 0;
+    high = delta_writer.block;
+    while(low < high) {
+      middle = low + (high - low + 1) / 2;
+      if(read_block_header(rel, middle) <= tuple_id) {
+        low = middle;
+      } else {
+        high = middle - 1;
+      }
+    }
+
+    length = read_block(rel, low, delta_reader.data, DB_DELTA_BLOCK_SIZE);
+    if(length < DELTA_HEADER_SIZE) {
+      return DB_STORAGE_ERROR;
+    }
+
+    delta_reader.block = low;
+    delta_reader.length = length;
+    delta_reader.first = get_number(delta_reader.data, DELTA_HEADER_SIZE);
+    if(low == delta_writer.block) {
+      delta_reader.end = delta_writer.end;
+    } else {
+      delta_reader.end = read_block_header(rel, low + 1);
+    }
+    if(tuple_id < delta_reader.first || tuple_id >= delta_reader.end) {
+      return DB_STORAGE_ERROR;
+    }
+
+    delta_reader.next = delta_reader.end;
+    delta_reader.rel = rel;
+    PRINTF("DB: Read block %u with tuples %lu-%lu of relation %s\n",
+           low, (unsigned long)delta_reader.first,
+           (unsigned long)delta_reader.end - 1, rel->name);
+  }
+
+  if(tuple_id < delta_reader.next || delta_reader.next == delta_reader.end) {
+    /* Decode the block from the beginning. */
+    delta_reader.next = delta_reader.first;
+    delta_reader.offset = DELTA_HEADER_SIZE;
+    memset(delta_reader.row, 0, rel->row_length);
+  }
+
+  while(delta_reader.next <= tuple_id) {
+    r = decode_row(rel, delta_reader.row,
+                   delta_reader.data + delta_reader.offset,
+                   delta_reader.length - delta_reader.offset);
+    if(r == 0) {
+      delta_reader.rel = NULL;
+      return DB_STORAGE_ERROR;
+    }
+    delta_reader.offset += r;
+    delta_reader.next++;
+  }
+
+  memcpy(row, delta_reader.row, rel->row_length);
+  return DB_OK;
+}
+
+static void
+invalidate_delta_rows(relation_t *rel)
+{
+  if(delta_reader.rel == rel) {
+    delta_reader.rel = NULL;
+  }
+  if(delta_writer.rel == rel) {
+    delta_writer.rel = NULL;
+  }
+}
+#endif /* DB_FEATURE_DELTA */
+
 char *
 storage_generate_file(char *prefix, unsigned long size)
 {
@@ -100,9 +663,31 @@ storage_generate_file(char *prefix, unsigned long size)
 #endif /* DB_FEATURE_COFFEE */
 }
 
+static void
+close_tuples(relation_t *rel)
+{
+  PRINTF("DB: Unload tuple file %s\n", rel->tuple_filename);
+
+  invalidate_rows(rel);
+  if(write_buffer.rel == rel) {
+    write_buffer.rel = NULL;
+  }
+#if DB_FEATURE_DELTA
+  invalidate_delta_rows(rel);
+#endif /* DB_FEATURE_DELTA */
+
+  cfs_close(rel->tuple_storage);
+  rel->tuple_storage = -1;
+}
+
 db_result_t
 storage_load(relation_t *rel)
 {
+  if(RELATION_HAS_TUPLES(rel)) {
+    /* The tuple file is still open for rows that are being buffered. */
+    return DB_OK;
+  }
+
   PRINTF("DB: Opening the tuple file %s\n", rel->tuple_filename);
   rel->tuple_storage = cfs_open(rel->tuple_filename,
                                 CFS_READ | CFS_WRITE | CFS_APPEND);
@@ -117,12 +702,23 @@ storage_load(relation_t *rel)
 void
 storage_unload(relation_t *rel)
 {
-  if(RELATION_HAS_TUPLES(rel)) {
-    PRINTF("DB: Unload tuple file %s\n", rel->tuple_filename);
+  if(!RELATION_HAS_TUPLES(rel)) {
+    return;
+  }
 
-    cfs_close(rel->tuple_storage);
-    rel->tuple_storage = -1;
+  /* Keep the tuple file open while rows are buffered for it, so that
+     consecutive insertions are written together. The file is closed
+     when the rows have been flushed. */
+  if(write_buffer.rel == rel && write_buffer.rows > 0) {
+    return;
+  }
+#if DB_FEATURE_DELTA
+  if(delta_writer.rel == rel && delta_writer.length != delta_writer.offset) {
+    return;
   }
+#endif /* DB_FEATURE_DELTA */
+
+  close_tuples(rel);
 }
 
 db_result_t
@@ -156,6 +752,16 @@ storage_get_relation(relation_t *rel, char *name)
 
   rel->tuple_filename[sizeof(rel->tuple_filename) - 1] ^= ROW_XOR;
 
+#if DB_FEATURE_DELTA
+  r = cfs_read(fd, &rel->flags, sizeof(rel->flags));
+  if(r != sizeof(rel->flags)) {
+    cfs_close(fd);
+    PRINTF("DB: Failed to read the relation flags\n");
+    return DB_STORAGE_ERROR;
+  }
+  rel->flags ^= ROW_XOR;
+#endif /* DB_FEATURE_DELTA */
+
   /* Read attribute records. */
   result = DB_OK;
   for(i = 0;; i++) {
@@ -241,6 +847,19 @@ storage_put_relation(relation_t *rel)
     return DB_STORAGE_ERROR;
   }
 
+#if DB_FEATURE_DELTA
+  /* The flags are also encoded to keep the last byte separated from 0
+     before any attribute has been stored. */
+  rel->flags ^= ROW_XOR;
+  r = cfs_write(fd, &rel->flags, sizeof(rel->flags));
+  rel->flags ^= ROW_XOR;
+  if(r != sizeof(rel->flags)) {
+    cfs_close(fd);
+    cfs_remove(rel->tuple_filename);
+    return DB_STORAGE_ERROR;
+  }
+#endif /* DB_FEATURE_DELTA */
+
   PRINTF("DB: Saved relation %s\n", rel->name);
 
   cfs_close(fd);
@@ -280,6 +899,14 @@ db_result_t
 storage_drop_relation(relation_t *rel, int remove_tuples)
 {
   if(remove_tuples && RELATION_HAS_TUPLES(rel)) {
+    invalidate_rows(rel);
+    if(write_buffer.rel == rel) {
+      write_buffer.rel = NULL;
+      write_buffer.rows = 0;
+    }
+#if DB_FEATURE_DELTA
+    invalidate_delta_rows(rel);
+#endif /* DB_FEATURE_DELTA */
     cfs_remove(rel->tuple_filename);
   }
   return cfs_remove(rel->name) < 0 ? DB_STORAGE_ERROR : DB_OK;
@@ -295,6 +922,17 @@ storage_rename_relation(char *old_name, char *new_name)
   int r;
   char buf[64];
 
+  /* The renamed relation may be loaded again before the buffered
+     rows of the relation that it refers to are flushed. */
+  if(DB_ERROR(flush_rows(write_buffer.rel))) {
+    return DB_STORAGE_ERROR;
+  }
+#if DB_FEATURE_DELTA
+  if(DB_ERROR(flush_delta_rows(delta_writer.rel))) {
+    return DB_STORAGE_ERROR;
+  }
+#endif /* DB_FEATURE_DELTA */
+
   result = DB_STORAGE_ERROR;
   old_fd = new_fd = -1;
 
@@ -357,6 +995,12 @@ storage_get_index(index_t *index, relation_t *rel, attribute_t *attr)
       index->type = record.type;
       memcpy(index->descriptor_file, record.file_name,
 	     sizeof(index->descriptor_file));
+#if DB_BLOOM_FILTER_SIZE > 0
+      /* Later records of the same index supersede earlier ones. */
+      index->bloom_cardinality = record.bloom_cardinality;
+      memcpy(index->bloom_filter, record.bloom_filter,
+             sizeof(index->bloom_filter));
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
       result = DB_OK;
     }
   }
@@ -385,6 +1029,11 @@ storage_put_index(index_t *index)
   strcpy(record.attribute_name, index->attr->name);
   memcpy(record.file_name, index->descriptor_file, sizeof(record.file_name));
   record.type = index->type;
+#if DB_BLOOM_FILTER_SIZE > 0
+  record.bloom_cardinality = index->bloom_cardinality;
+  memcpy(record.bloom_filter, index->bloom_filter,
+         sizeof(record.bloom_filter));
+#endif /* DB_BLOOM_FILTER_SIZE > 0 */
 
   result = DB_OK;
   r = cfs_write(fd, &record, sizeof(record));
@@ -405,6 +1054,16 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
 {
   int r;
   tuple_id_t nrows;
+  struct read_buffer *buffer;
+  unsigned rows;
+  unsigned char *ptr;
+  unsigned length;
+
+#if DB_FEATURE_DELTA
+  if(rel->flags & RELATION_FLAG_DELTA) {
+    return get_delta_row(rel, *tuple_id, row);
+  }
+#endif /* DB_FEATURE_DELTA */
 
   if(DB_ERROR(storage_get_row_amount(rel, &nrows))) {
     return DB_STORAGE_ERROR;
@@ -414,25 +1073,72 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
     return DB_FINISHED;
   }
 
+  if(rel->row_length > DB_ROW_BUFFER_SIZE) {
+    buffer = NULL;
+    ptr = row;
+    rows = 1;
+  } else {
+    buffer = get_read_buffer(rel, *tuple_id);
+    if(buffer->rows > 0) {
+      goto found;
+    }
+
+    /* Read ahead only if the relation is being scanned sequentially,
+       so that random accesses through an index do not read more than
+       they need. */
+    ptr = buffer->data;
+    rows = 1;
+    if(*tuple_id == buffer->next) {
+      rows = DB_ROW_BUFFER_SIZE / rel->row_length;
+      if(rows > nrows - *tuple_id) {
+        rows = nrows - *tuple_id;
+      }
+    }
+  }
+
   if(cfs_seek(rel->tuple_storage, *tuple_id * rel->row_length, CFS_SEEK_SET) ==
               (cfs_offset_t)-1) {
     return DB_STORAGE_ERROR;
   }
 
-  r = cfs_read(rel->tuple_storage, row, rel->row_length);
-  if(r < 0) {
-    PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
-    return DB_STORAGE_ERROR;
-  } else if(r == 0) {
+  length = rows * rel->row_length;
+  while(length > 0) {
+    r = cfs_read(rel->tuple_storage, ptr, length);
+    if(r < 0) {
+      PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
+      return DB_STORAGE_ERROR;
+    } else if(r == 0) {
+      break;
+    }
+    ptr += r;
+    length -= r;
+  }
+
+  rows -= (length + rel->row_length - 1) / rel->row_length;
+  if(rows == 0) {
+    if(length < rel->row_length) {
+      PRINTF("DB: Incomplete record: %u < %u\n",
+             rel->row_length - length, (unsigned)rel->row_length);
+      return DB_STORAGE_ERROR;
+    }
     return DB_FINISHED;
-  } else if(r < rel->row_length) {
-    PRINTF("DB: Incomplete record: %d < %d\n", r, rel->row_length);
-    return DB_STORAGE_ERROR;
   }
 
-  row[rel->row_length - 1] ^= ROW_XOR;
+  PRINTF("DB: Read %u rows from relation %s\n", rows, rel->name);
+
+  if(buffer == NULL) {
+    row[rel->row_length - 1] ^= ROW_XOR;
+    return DB_OK;
+  }
+
+  buffer->first = *tuple_id;
+  buffer->rows = rows;
 
-  PRINTF("DB: Read %d bytes from relation %s\n", rel->row_length, rel->name);
+found:
+  memcpy(row, buffer->data + (*tuple_id - buffer->first) * rel->row_length,
+         rel->row_length);
+  row[rel->row_length - 1] ^= ROW_XOR;
+  buffer->next = *tuple_id + 1;
 
   return DB_OK;
 }
@@ -440,53 +1146,41 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
 db_result_t
 storage_put_row(relation_t *rel, storage_row_t row)
 {
-  cfs_offset_t end;
-  unsigned remaining;
-  int r;
+  db_result_t result;
   unsigned char *last_byte;
-#if DB_FEATURE_INTEGRITY
-  int missing_bytes;
-  char buf[rel->row_length];
-#endif
-
-  end = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
-  if(end == (cfs_offset_t)-1) {
-    return DB_STORAGE_ERROR;
-  }
 
-#if DB_FEATURE_INTEGRITY
-  missing_bytes = end % rel->row_length;
-  if(missing_bytes > 0) {
-    memset(buf, 0xff, sizeof(buf));
-    r = cfs_write(rel->tuple_storage, buf, sizeof(buf));
-    if(r != missing_bytes) {
-      return DB_STORAGE_ERROR;
-    }
+#if DB_FEATURE_DELTA
+  if(rel->flags & RELATION_FLAG_DELTA) {
+    return put_delta_row(rel, row);
   }
-#endif
+#endif /* DB_FEATURE_DELTA */
 
   /* Ensure that last written byte is separated from 0, to make file
      lengths correct in Coffee. */
   last_byte = row + rel->row_length - 1;
   *last_byte ^= ROW_XOR;
 
-  remaining = rel->row_length;
-  do {
-    r = cfs_write(rel->tuple_storage, row, remaining);
-    if(r < 0) {
-      PRINTF("DB: Failed to store %u bytes\n", remaining);
-      *last_byte ^= ROW_XOR;
-      return DB_STORAGE_ERROR;
+  if(rel->row_length > DB_ROW_BUFFER_SIZE) {
+    result = write_rows(rel, row, rel->row_length);
+  } else {
+    if(write_buffer.rel != rel) {
+      flush_rows(write_buffer.rel);
+      write_buffer.rel = rel;
     }
-    row += r;
-    remaining -= r;
-  } while(remaining > 0);
-
-  PRINTF("DB: Stored a of %d bytes\n", rel->row_length);
+    memcpy(write_buffer.data + write_buffer.rows * rel->row_length,
+           row, rel->row_length);
+    write_buffer.rows++;
+    result = DB_OK;
+    if((write_buffer.rows + 1) * rel->row_length > DB_ROW_BUFFER_SIZE) {
+      result = flush_rows(rel);
+    }
+  }
 
   *last_byte ^= ROW_XOR;
 
-  return DB_OK;
+  PRINTF("DB: Stored a of %d bytes\n", rel->row_length);
+
+  return result;
 }
 
 db_result_t
@@ -494,6 +1188,20 @@ storage_get_row_amount(relation_t *rel, tuple_id_t *amount)
 {
   cfs_offset_t offset;
 
+#if DB_FEATURE_DELTA
+  if(rel->flags & RELATION_FLAG_DELTA) {
+    if(DB_ERROR(load_delta_tail(rel))) {
+      return DB_STORAGE_ERROR;
+    }
+    *amount = delta_writer.end;
+    return DB_OK;
+  }
+#endif /* DB_FEATURE_DELTA */
+
+  if(DB_ERROR(flush_rows(rel))) {
+    return DB_STORAGE_ERROR;
+  }
+
   if(rel->row_length == 0) {
     *amount = 0;
   } else {
@@ -508,6 +1216,21 @@ storage_get_row_amount(relation_t *rel, tuple_id_t *amount)
   return DB_OK;
 }
 
+db_result_t
+storage_flush(void)
+{
+  if(DB_ERROR(flush_rows(write_buffer.rel))) {
+    return DB_STORAGE_ERROR;
+  }
+#if DB_FEATURE_DELTA
+  if(DB_ERROR(flush_delta_rows(delta_writer.rel))) {
+    return DB_STORAGE_ERROR;
+  }
+#endif /* DB_FEATURE_DELTA */
+
+  return DB_OK;
+}
+
 db_storage_id_t
 storage_open(const char *filename)
 {
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Application of differential code images.
+ */
+
+#include "cfs/cfs.h"
+#include "lib/crc16.h"
+#include "codeprop-delta.h"
+
+#include <string.h>
+
+#define BUFSIZE 32
+
+/*---------------------------------------------------------------------*/
+static unsigned short
+get16(const unsigned char *p)
+{
+  return (p[0] << 8) | p[1];
+}
+/*---------------------------------------------------------------------*/
+int
+codeprop_delta_check(int fd)
+{
+  char magic[4];
+
+  return cfs_seek(fd, 0, CFS_SEEK_SET) == 0 &&
+    cfs_read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+    memcmp(magic, CODEPROP_DELTA_MAGIC, sizeof(magic)) == 0;
+}
+/*---------------------------------------------------------------------*/
+static int
+check_base(int base_fd, unsigned short len, unsigned short crc)
+{
+  unsigned char buf[BUFSIZE];
+  unsigned short acc;
+  int n;
+
+  if(cfs_seek(base_fd, 0, CFS_SEEK_SET) != 0) {
+    return 0;
+  }
+  for(acc = 0; len > 0; len -= n) {
+    n = len > sizeof(buf) ? sizeof(buf) : len;
+    if(cfs_read(base_fd, buf, n) != n) {
+      return 0;
+    }
+    acc = crc16_data(buf, n, acc);
+  }
+  return acc == crc;
+}
+/*---------------------------------------------------------------------*/
+int
+codeprop_delta_apply(int delta_fd, int base_fd, int out_fd)
+{
+  unsigned char buf[BUFSIZE];
+  unsigned short base_len, new_len, written;
+  unsigned short len, n;
+  int from_fd, chunk;
+
+  if(!codeprop_delta_check(delta_fd) ||
+     cfs_read(delta_fd, buf, CODEPROP_DELTA_HDRSIZE - 4) !=
+     CODEPROP_DELTA_HDRSIZE - 4) {
+    return CODEPROP_DELTA_BAD_HEADER;
+  }
+  base_len = get16(&buf[0]);
+  new_len = get16(&buf[4]);
+  if(!check_base(base_fd, base_len, get16(&buf[2]))) {
+    return CODEPROP_DELTA_BAD_BASE;
+  }
+
+  if(cfs_seek(out_fd, 0, CFS_SEEK_SET) != 0) {
+    return CODEPROP_DELTA_IO_ERROR;
+  }
+
+  for(written = 0; written < new_len; written += len) {
+    if(cfs_read(delta_fd, buf, 1) != 1) {
+      return CODEPROP_DELTA_BAD_COMMAND;
+    }
+
+    if(buf[0] & CODEPROP_DELTA_COPY) {
+      /* Copy from the base module. */
+      len = (buf[0] & ~CODEPROP_DELTA_COPY) << 8;
+      if(cfs_read(delta_fd, buf, 3) != 3) {
+	return CODEPROP_DELTA_BAD_COMMAND;
+      }
+      len = (len | buf[0]) + 1;
+      if((unsigned long)get16(&buf[1]) + len > base_len ||
+	 cfs_seek(base_fd, get16(&buf[1]), CFS_SEEK_SET) != get16(&buf[1])) {
+	return CODEPROP_DELTA_BAD_COMMAND;
+      }
+      from_fd = base_fd;
+    } else {
+      /* Insert literal bytes from the delta. */
+      len = buf[0] + 1;
+      from_fd = delta_fd;
+    }
+
+    if((unsigned long)written + len > new_len) {
+      return CODEPROP_DELTA_BAD_COMMAND;
+    }
+
+    for(n = 0; n < len; n += chunk) {
+      chunk = len - n > sizeof(buf) ? sizeof(buf) : len - n;
+      if(cfs_read(from_fd, buf, chunk) != chunk) {
+	return from_fd == delta_fd ?
+	  CODEPROP_DELTA_BAD_COMMAND : CODEPROP_DELTA_IO_ERROR;
+      }
+      if(cfs_write(out_fd, buf, chunk) != chunk) {
+	return CODEPROP_DELTA_IO_ERROR;
+      }
+    }
+  }
+  return CODEPROP_DELTA_OK;
+}
+/*---------------------------------------------------------------------*/
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Differential code images: a new module is described as a
+ *         sequence of copies from the currently installed module and
+ *         literal bytes. Deltas are made with tools/codeprop-mkdelta.
+ */
+
+#ifndef __CODEPROP_DELTA_H__
+#define __CODEPROP_DELTA_H__
+
+/*
+ * Delta image format. All multi-byte fields are big endian.
+ *
+ * Header:
+ *   4 bytes  CODEPROP_DELTA_MAGIC
+ *   2 bytes  length of the base module
+ *   2 bytes  CRC16 (lib/crc16.c) of the base module
+ *   2 bytes  length of the new module
+ *
+ * Followed by commands until the new module is complete:
+ *   0nnnnnnn                      insert the n + 1 following bytes
+ *   1nnnnnnn nnnnnnnn oooo oooo   copy n + 1 bytes from base offset o
+ */
+#define CODEPROP_DELTA_MAGIC "CPD1"
+#define CODEPROP_DELTA_HDRSIZE 10
+
+#define CODEPROP_DELTA_INSERT_MAX 128
+#define CODEPROP_DELTA_COPY       0x80
+#define CODEPROP_DELTA_COPY_MAX   32768
+
+#define CODEPROP_DELTA_OK          0
+#define CODEPROP_DELTA_BAD_HEADER  1
+#define CODEPROP_DELTA_BAD_BASE    2
+#define CODEPROP_DELTA_BAD_COMMAND 3
+#define CODEPROP_DELTA_IO_ERROR    4
+
+/**
+ * \brief      Check whether a file holds a delta image
+ * \param fd   The file, positioned anywhere
+ * \return     Non-zero if the file starts with the delta magic
+ */
+int codeprop_delta_check(int fd);
+
+/**
+ * \brief          Apply a delta image
+ * \param delta_fd The delta image
+ * \param base_fd  The currently installed module
+ * \param out_fd   The file that receives the new module
+ * \return         CODEPROP_DELTA_OK, or an error code
+ *
+ *                 The delta is read and the new module written
+ *                 sequentially, so only the base module is accessed
+ *                 at random. The base module is checked against the
+ *                 CRC in the delta header before anything is written.
+ */
+int codeprop_delta_apply(int delta_fd, int base_fd, int out_fd);
+
+#endif /* __CODEPROP_DELTA_H__ */
@@ -61,6 +61,10 @@
  *    binary where the NACK pointed to. (This is *not* very efficient,
  *    but simple to implement...)
  *
+ *    The binary may also be a delta against the last module that was
+ *    loaded (see codeprop-delta.h). The delta is propagated as is and
+ *    applied by each node before loading.
+ *
  * States:
  *
  *  Receiving code header -> receiving code -> sending code
@@ -72,13 +76,22 @@
 #include "contiki-net.h"
 #include "cfs/cfs.h"
 #include "codeprop-tmp.h"
+#include "codeprop-delta.h"
 #include "loader/elfloader.h"
 #include <string.h>
 
 static const char *err_msgs[] =
   {"OK\r\n", "Bad ELF header\r\n", "No symtab\r\n", "No strtab\r\n",
    "No text\r\n", "Symbol not found\r\n", "Segment not found\r\n",
-   "No startpoint\r\n" };
+   "No startpoint\r\n", "Bad delta\r\n" };
+
+#define ERR_BAD_DELTA 8
+
+/* The received binary, the last loaded module, and the output of a
+   delta applied to it. */
+#define IMAGE_FILE   "codeprop-image"
+#define MODULE_FILE  "codeprop-module"
+#define PATCHED_FILE "codeprop-patched"
 
 #define CODEPROP_DATA_PORT 6510
 
@@ -181,7 +194,7 @@ PROCESS_THREAD(codeprop_process, ev, data)
   s.addr = 0;
   s.len = 0;
 
-  fd = cfs_open("codeprop-image", CFS_READ | CFS_WRITE);
+  fd = cfs_open(IMAGE_FILE, CFS_READ | CFS_WRITE);
 
   while(1) {
 
@@ -460,14 +473,81 @@ codeprop_exit_program(void)
   }
 }
 /*---------------------------------------------------------------------*/
+static int
+copy_file(int from, const char *to)
+{
+  char buf[UDPDATASIZE];
+  int to_fd, len;
+
+  cfs_remove(to);
+  to_fd = cfs_open(to, CFS_WRITE);
+  if(to_fd < 0) {
+    return -1;
+  }
+  cfs_seek(from, 0, CFS_SEEK_SET);
+  while((len = cfs_read(from, buf, sizeof(buf))) > 0) {
+    if(cfs_write(to_fd, buf, len) != len) {
+      cfs_close(to_fd);
+      return -1;
+    }
+  }
+  cfs_close(to_fd);
+  return 0;
+}
+/*---------------------------------------------------------------------*/
+static int
+patch_module(void)
+{
+  int module_fd, patched_fd, err;
+
+  module_fd = cfs_open(MODULE_FILE, CFS_READ);
+  if(module_fd < 0) {
+    return CODEPROP_DELTA_BAD_BASE;
+  }
+  cfs_remove(PATCHED_FILE);
+  patched_fd = cfs_open(PATCHED_FILE, CFS_READ | CFS_WRITE);
+  if(patched_fd < 0) {
+    cfs_close(module_fd);
+    return CODEPROP_DELTA_IO_ERROR;
+  }
+
+  err = codeprop_delta_apply(fd, module_fd, patched_fd);
+  cfs_close(module_fd);
+  if(err == CODEPROP_DELTA_OK && copy_file(patched_fd, MODULE_FILE) < 0) {
+    err = CODEPROP_DELTA_IO_ERROR;
+  }
+  cfs_close(patched_fd);
+  cfs_remove(PATCHED_FILE);
+  return err;
+}
+/*---------------------------------------------------------------------*/
 int
 codeprop_start_program(void)
 {
-  int err;
+  int err, module_fd;
 
   codeprop_exit_program();
 
-  err = elfloader_load(fd);
+  if(codeprop_delta_check(fd)) {
+    err = patch_module();
+    if(err != CODEPROP_DELTA_OK) {
+      PRINTF(("codeprop: failed to apply delta, error %d\n", err));
+      return ERR_BAD_DELTA;
+    }
+    module_fd = cfs_open(MODULE_FILE, CFS_READ);
+    if(module_fd < 0) {
+      return ERR_BAD_DELTA;
+    }
+    err = elfloader_load(module_fd);
+    cfs_close(module_fd);
+  } else {
+    err = elfloader_load(fd);
+    /* Keep the module as the base for later deltas. */
+    if(err == ELFLOADER_OK && copy_file(fd, MODULE_FILE) < 0) {
+      PRINTF(("codeprop: failed to save module\n"));
+    }
+  }
+
   if(err == ELFLOADER_OK) {
     PRINTF(("codeprop: starting %s\n",
 	    elfloader_autostart_processes[0]->name));
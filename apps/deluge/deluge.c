@@ -58,6 +58,14 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if DELUGE_PAGE_WINDOW < 1 || DELUGE_PAGE_WINDOW * N_PKT > 32
+#error "DELUGE_PAGE_WINDOW * N_PKT must fit in the 32-bit tx_set"
+#endif
+
+/* The transmission set bits of page pagenum + i in a window starting
+   at pagenum. */
+#define TX_SET_PAGE(i)		((uint32_t)ALL_PACKETS << ((i) * N_PKT))
+
 #define DEBUG	0
 #if DEBUG
 #include <stdio.h>
@@ -120,30 +128,49 @@ transition(int state)
   }
 }
 
+/* Pages are mostly read and written in order, so we keep track of the
+   file position and only seek when the access is not sequential. */
 static int
-write_page(struct deluge_object *obj, unsigned pagenum, unsigned char *data)
+seek_page(struct deluge_object *obj, unsigned pagenum)
 {
   cfs_offset_t offset;
 
-  offset = pagenum * S_PAGE;
+  offset = (cfs_offset_t)pagenum * S_PAGE;
+
+  if(obj->cfs_offset != offset) {
+    if(cfs_seek(obj->cfs_fd, offset, CFS_SEEK_SET) != offset) {
+      obj->cfs_offset = (cfs_offset_t)-1;
+      return -1;
+    }
+    obj->cfs_offset = offset;
+  }
+  return 0;
+}
 
-  if(cfs_seek(obj->cfs_fd, offset, CFS_SEEK_SET) != offset) {
+static int
+write_page(struct deluge_object *obj, unsigned pagenum, unsigned char *data)
+{
+  int r;
+
+  if(seek_page(obj, pagenum) < 0) {
     return -1;
   }
-  return cfs_write(obj->cfs_fd, (char *)data, S_PAGE);
+  r = cfs_write(obj->cfs_fd, (char *)data, S_PAGE);
+  obj->cfs_offset = r == S_PAGE ? obj->cfs_offset + S_PAGE : (cfs_offset_t)-1;
+  return r;
 }
 
 static int
 read_page(struct deluge_object *obj, unsigned pagenum, unsigned char *buf)
 {
-  cfs_offset_t offset;
-
-  offset = pagenum * S_PAGE;
+  int r;
 
-  if(cfs_seek(obj->cfs_fd, offset, CFS_SEEK_SET) != offset) {
+  if(seek_page(obj, pagenum) < 0) {
     return -1;
   }
-  return cfs_read(obj->cfs_fd, (char *)buf, S_PAGE);
+  r = cfs_read(obj->cfs_fd, (char *)buf, S_PAGE);
+  obj->cfs_offset = r == S_PAGE ? obj->cfs_offset + S_PAGE : (cfs_offset_t)-1;
+  return r;
 }
 
 static void
@@ -197,6 +224,7 @@ init_object(struct deluge_object *obj, char *filename, unsigned version)
   if(obj->cfs_fd < 0) {
     return -1;
   }
+  obj->cfs_offset = 0;
 
   obj->filename = filename;
   obj->object_id = next_object_id++;
@@ -240,19 +268,41 @@ static void
 send_request(void *arg)
 {
   struct deluge_object *obj;
-  struct deluge_msg_request request;
+  struct deluge_msg_request *request;
+  struct deluge_page *page;
+  unsigned char buf[sizeof(*request) + DELUGE_PAGE_WINDOW - 1];
+  int i, len;
 
   obj = (struct deluge_object *)arg;
+  request = (struct deluge_msg_request *)buf;
+
+  request->cmd = DELUGE_CMD_REQUEST;
+  request->pagenum = obj->current_rx_page;
+  request->version = obj->pages[request->pagenum].version;
+  request->request_set = ~obj->pages[obj->current_rx_page].packet_set;
+  request->object_id = obj->object_id;
+
+  /* Ask for the missing packets of the following pages in the same
+     request, so that the sender can stream several pages at once. */
+  len = sizeof(*request);
+  for(i = 1; i < DELUGE_PAGE_WINDOW &&
+	request->pagenum + i < OBJECT_PAGE_COUNT(*obj); i++) {
+    page = &obj->pages[request->pagenum + i];
+    if(page->version == request->version) {
+      request->next_sets[i - 1] = ~page->packet_set & ALL_PACKETS;
+    } else {
+      request->next_sets[i - 1] = 0;
+    }
+    len++;
+  }
+  while(len > sizeof(*request) && buf[len - 1] == 0) {
+    len--;
+  }
 
-  request.cmd = DELUGE_CMD_REQUEST;
-  request.pagenum = obj->current_rx_page;
-  request.version = obj->pages[request.pagenum].version;
-  request.request_set = ~obj->pages[obj->current_rx_page].packet_set;
-  request.object_id = obj->object_id;
-
-  PRINTF("Sending request for page %d, version %u, request_set %u\n", 
-	request.pagenum, request.version, request.request_set);
-  packetbuf_copyfrom(&request, sizeof(request));
+  PRINTF("Sending request for page %d, version %u, request_set %u, %d more pages\n", 
+	request->pagenum, request->version, request->request_set,
+	len - (int)sizeof(*request));
+  packetbuf_copyfrom(buf, len);
   unicast_send(&deluge_uc, &obj->summary_from);
 
   /* Deluge R.2 */
@@ -344,7 +394,7 @@ handle_summary(struct deluge_msg_summary *msg, const rimeaddr_t *sender)
 }
 
 static void
-send_page(struct deluge_object *obj, unsigned pagenum)
+send_page(struct deluge_object *obj, unsigned pagenum, uint8_t tx_set)
 {
   unsigned char buf[S_PAGE];
   struct deluge_msg_packet pkt;
@@ -361,7 +411,7 @@ send_page(struct deluge_object *obj, unsigned pagenum)
 
   /* Divide the page into packets and send them one at a time. */
   for(cp = buf; cp + S_PKT <= (unsigned char *)&buf[S_PAGE]; cp += S_PKT) {
-    if(obj->tx_set & (1 << pkt.packetnum)) {
+    if(tx_set & (1 << pkt.packetnum)) {
       pkt.crc = crc16_data(cp, S_PKT, 0);
       memcpy(pkt.payload, cp, S_PKT);
       packetbuf_copyfrom(&pkt, sizeof(pkt));
@@ -369,17 +419,21 @@ send_page(struct deluge_object *obj, unsigned pagenum)
     }
     pkt.packetnum++;
   }
-  obj->tx_set = 0;
 }
 
 static void
 tx_callback(void *arg)
 {
   struct deluge_object *obj;
+  int i;
 
   obj = (struct deluge_object *)arg;
   if(obj->current_tx_page >= 0 && obj->tx_set) {
-    send_page(obj, obj->current_tx_page);
+    /* Send the lowest requested page of the window in this round. */
+    for(i = 0; !(obj->tx_set & TX_SET_PAGE(i)); i++);
+    send_page(obj, obj->current_tx_page + i,
+	      (obj->tx_set & TX_SET_PAGE(i)) >> (i * N_PKT));
+    obj->tx_set &= ~TX_SET_PAGE(i);
     /* Deluge T.2. */
     if(obj->tx_set) {
       packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
@@ -395,9 +449,12 @@ tx_callback(void *arg)
 }
 
 static void
-handle_request(struct deluge_msg_request *msg)
+handle_request(struct deluge_msg_request *msg, int len)
 {
-  int highest_available;
+  struct deluge_page *page;
+  uint32_t request_set;
+  uint8_t page_set;
+  int i, nsets;
 
   if(msg->pagenum >= OBJECT_PAGE_COUNT(current_object)) {
     return;
@@ -407,19 +464,38 @@ handle_request(struct deluge_msg_request *msg)
     neighbor_inconsistency = 1;
   }
 
-  highest_available = highest_available_page(&current_object);
-
   /* Deluge M.6 */
-  if(msg->version == current_object.version &&
-      msg->pagenum <= highest_available) {
-    current_object.pages[msg->pagenum].last_request = clock_time();
+  if(msg->version == current_object.version) {
+    /* Gather the requested packets of every complete page in the window
+       into a single transmission set. */
+    nsets = len - sizeof(*msg);
+    request_set = 0;
+    for(i = 0; i < DELUGE_PAGE_WINDOW &&
+	  msg->pagenum + i < OBJECT_PAGE_COUNT(current_object); i++) {
+      if(i == 0) {
+	page_set = msg->request_set;
+      } else if(i <= nsets) {
+	page_set = msg->next_sets[i - 1];
+      } else {
+	break;
+      }
+      page = &current_object.pages[msg->pagenum + i];
+      if((page->flags & PAGE_COMPLETE) && (page_set & ALL_PACKETS)) {
+	page->last_request = clock_time();
+	request_set |= (uint32_t)(page_set & ALL_PACKETS) << (i * N_PKT);
+      }
+    }
+
+    if(request_set == 0) {
+      return;
+    }
 
     /* Deluge T.1 */
     if(msg->pagenum == current_object.current_tx_page) {
-      current_object.tx_set |= msg->request_set;
+      current_object.tx_set |= request_set;
     } else {
       current_object.current_tx_page = msg->pagenum;
-      current_object.tx_set = msg->request_set;
+      current_object.tx_set = request_set;
     }
 
     transition(DELUGE_STATE_TX);
@@ -433,6 +509,7 @@ handle_packet(struct deluge_msg_packet *msg)
   struct deluge_page *page;
   uint16_t crc;
   struct deluge_msg_packet packet;
+  uint8_t *buf;
 
   memcpy(&packet, msg, sizeof(packet));
 
@@ -440,7 +517,11 @@ handle_packet(struct deluge_msg_packet *msg)
 	(unsigned)packet.object_id, (unsigned)packet.version,
 	(unsigned)packet.pagenum, (unsigned)packet.packetnum);
 
-  if(packet.pagenum != current_object.current_rx_page) {
+  /* Accept packets for any page in the receive window. */
+  if(packet.pagenum < current_object.current_rx_page ||
+     packet.pagenum >= current_object.current_rx_page + DELUGE_PAGE_WINDOW ||
+     packet.pagenum >= OBJECT_PAGE_COUNT(current_object) ||
+     packet.packetnum >= N_PKT) {
     return;
   }
 
@@ -450,8 +531,8 @@ handle_packet(struct deluge_msg_packet *msg)
 
   page = &current_object.pages[packet.pagenum];
   if(packet.version == page->version && !(page->flags & PAGE_COMPLETE)) {
-    memcpy(&current_object.current_page[S_PKT * packet.packetnum],
-	packet.payload, S_PKT);
+    buf = current_object.current_page[packet.pagenum % DELUGE_PAGE_WINDOW];
+    memcpy(&buf[S_PKT * packet.packetnum], packet.payload, S_PKT);
 
     crc = crc16_data(packet.payload, S_PKT, 0);
     if(packet.crc != crc) {
@@ -467,14 +548,20 @@ handle_packet(struct deluge_msg_packet *msg)
       packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
 			 PACKETBUF_ATTR_PACKET_TYPE_STREAM_END);
 
-      write_page(&current_object, packet.pagenum, current_object.current_page);
+      write_page(&current_object, packet.pagenum, buf);
       page->version = packet.version;
       page->flags = PAGE_COMPLETE;
       PRINTF("Page %u completed\n", packet.pagenum);
 
-      current_object.current_rx_page++;
+      if(packet.pagenum != current_object.current_rx_page) {
+	/* A later page in the window was completed first. Keep
+	   receiving until the lowest incomplete page is done. */
+	return;
+      }
+
+      current_object.current_rx_page = highest_available_page(&current_object);
 
-      if(packet.pagenum == OBJECT_PAGE_COUNT(current_object) - 1) {
+      if(current_object.current_rx_page == OBJECT_PAGE_COUNT(current_object)) {
 	current_object.version = current_object.update_version;
 	leds_on(LEDS_RED);
 	PRINTF("Update completed for object %u, version %u\n", 
@@ -597,7 +684,7 @@ command_dispatcher(const rimeaddr_t *sender)
     break;
   case DELUGE_CMD_REQUEST:
     if(len >= sizeof(struct deluge_msg_request))
-      handle_request((struct deluge_msg_request *)msg);
+      handle_request((struct deluge_msg_request *)msg, len);
     break;
   case DELUGE_CMD_PACKET:
     if(len >= sizeof(struct deluge_msg_packet))
@@ -41,6 +41,7 @@
 #define DELUGE_H
 
 #include "net/rime.h"
+#include "cfs/cfs.h"
 
 PROCESS_NAME(deluge_process);
 
@@ -64,6 +65,15 @@ PROCESS_NAME(deluge_process);
 #define N_PKT		4		/* Packets per page. */
 #define S_PAGE		(S_PKT * N_PKT)	/* Fixed page size. */
 
+/* The number of consecutive pages, starting at the lowest incomplete
+   page, that a node requests and receives in parallel. Each page in
+   the window costs S_PAGE bytes of RAM. */
+#ifdef DELUGE_CONF_PAGE_WINDOW
+#define DELUGE_PAGE_WINDOW	DELUGE_CONF_PAGE_WINDOW
+#else
+#define DELUGE_PAGE_WINDOW	2
+#endif
+
 /* Bounds for the round time in seconds. */
 #define T_LOW		2
 #define T_HIGH		64
@@ -109,6 +119,8 @@ struct deluge_msg_request {
   uint8_t pagenum;
   uint8_t request_set;
   deluge_object_id_t object_id;
+  /* Optional request sets for the pages following pagenum. */
+  uint8_t next_sets[];
 };
 
 struct deluge_msg_packet {
@@ -139,9 +151,10 @@ struct deluge_object {
   uint8_t current_rx_page;
   int8_t current_tx_page;
   uint8_t nrequests;
-  uint8_t current_page[S_PAGE];
-  uint8_t tx_set;
+  uint8_t current_page[DELUGE_PAGE_WINDOW][S_PAGE];
+  uint32_t tx_set;
   int cfs_fd;
+  cfs_offset_t cfs_offset;
   rimeaddr_t summary_from;
 };
 
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2013, Institute for Pervasive Computing, ETH Zurich
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      CoAP module for block-wise transfers
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cfs/cfs.h"
+#include "er-coap-13-block.h"
+
+#define DEBUG 0
+#if DEBUG
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*
+ * Fills the payload of a Block2 response from a reader. Call it from a resource handler
+ * with the buffer, preferred_size, and offset the handler received; the engine adds the
+ * Block2 option from the updated offset. Returns 0 if the reader failed.
+ */
+int
+coap_block2_stream(void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset, coap_block_reader_t reader, void *data)
+{
+  coap_packet_t *const coap_res = (coap_packet_t *) response;
+  int len;
+
+  len = reader(data, (uint32_t) *offset, buffer, preferred_size);
+  if (len<0)
+  {
+    coap_res->code = INTERNAL_SERVER_ERROR_5_00;
+    coap_set_payload(coap_res, "ReadFailed", 10);
+    return 0;
+  }
+
+  PRINTF("Block2: %d bytes at %ld\n", len, *offset);
+
+  coap_set_payload(coap_res, buffer, len);
+
+  /* A full block may be followed by an empty last one when the body ends on a block boundary. */
+  if (len==preferred_size)
+  {
+    *offset += len;
+  }
+  else
+  {
+    *offset = -1;
+  }
+
+  return 1;
+}
+/*----------------------------------------------------------------------------*/
+/*
+ * Passes the payload of a request to a writer, placed by its Block1 option, and echoes
+ * the option in the response. Returns 1 when the body is complete, 0 when more blocks
+ * are expected, and -1 if the writer failed.
+ */
+int
+coap_block1_receive(void *request, void *response, coap_block_writer_t writer, void *data)
+{
+  coap_packet_t *const coap_req = (coap_packet_t *) request;
+  coap_packet_t *const coap_res = (coap_packet_t *) response;
+  uint32_t num = 0;
+  uint8_t more = 0;
+  uint16_t size = 0;
+  uint32_t offset = 0;
+  const uint8_t *payload = NULL;
+  int len;
+
+  len = coap_get_payload(coap_req, &payload);
+
+  if (coap_get_header_block1(coap_req, &num, &more, &size, &offset))
+  {
+    coap_set_header_block1(coap_res, num, more, size);
+  }
+
+  PRINTF("Block1: %d bytes at %lu%s\n", len, offset, more ? "+" : "");
+
+  if (writer(data, offset, payload, len, more)!=len)
+  {
+    coap_res->code = INTERNAL_SERVER_ERROR_5_00;
+    coap_set_payload(coap_res, "WriteFailed", 11);
+    return -1;
+  }
+
+  return !more;
+}
+/*----------------------------------------------------------------------------*/
+int
+coap_block_file_reader(void *data, uint32_t offset, uint8_t *buffer, uint16_t size)
+{
+  int fd;
+  int len;
+
+  fd = cfs_open((const char *) data, CFS_READ);
+  if (fd<0)
+  {
+    return -1;
+  }
+
+  len = -1;
+  if (cfs_seek(fd, offset, CFS_SEEK_SET)==(cfs_offset_t) offset)
+  {
+    len = cfs_read(fd, buffer, size);
+  }
+  else
+  {
+    /* Reading beyond the end of the file. */
+    len = 0;
+  }
+
+  cfs_close(fd);
+
+  return len;
+}
+/*----------------------------------------------------------------------------*/
+int
+coap_block_file_writer(void *data, uint32_t offset, const uint8_t *buffer, uint16_t size, uint8_t more)
+{
+  int fd;
+  int len;
+
+  /* The first block replaces the previous contents. */
+  if (offset==0)
+  {
+    cfs_remove((const char *) data);
+  }
+
+  fd = cfs_open((const char *) data, CFS_READ | CFS_WRITE);
+  if (fd<0)
+  {
+    return -1;
+  }
+
+  len = -1;
+  if (cfs_seek(fd, offset, CFS_SEEK_SET)==(cfs_offset_t) offset)
+  {
+    len = cfs_write(fd, buffer, size);
+  }
+
+  cfs_close(fd);
+
+  return len;
+}
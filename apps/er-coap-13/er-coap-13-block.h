@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2013, Institute for Pervasive Computing, ETH Zurich
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      CoAP module for block-wise transfers
+ */
+
+#ifndef COAP_BLOCK_H_
+#define COAP_BLOCK_H_
+
+#include "er-coap-13.h"
+
+/*
+ * Reads up to size bytes of a resource body at offset. Returns the number of bytes read,
+ * which is less than size at the end of the body, or -1 on error.
+ */
+typedef int (*coap_block_reader_t)(void *data, uint32_t offset, uint8_t *buffer, uint16_t size);
+
+/*
+ * Writes one block of a request body at offset; more is 0 for the last block.
+ * Returns the number of bytes written, or -1 on error.
+ */
+typedef int (*coap_block_writer_t)(void *data, uint32_t offset, const uint8_t *buffer, uint16_t size, uint8_t more);
+
+int coap_block2_stream(void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset, coap_block_reader_t reader, void *data);
+int coap_block1_receive(void *request, void *response, coap_block_writer_t writer, void *data);
+
+/* Readers and writers for bodies stored in CFS files; data is the file name. */
+int coap_block_file_reader(void *data, uint32_t offset, uint8_t *buffer, uint16_t size);
+int coap_block_file_writer(void *data, uint32_t offset, const uint8_t *buffer, uint16_t size, uint8_t more);
+
+#endif /* COAP_BLOCK_H_ */
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2013, Institute for Pervasive Computing, ETH Zurich
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      CoAP module for caching responses
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "er-coap-13-cache.h"
+
+#define DEBUG 0
+#if DEBUG
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+#if COAP_CACHE_ENTRIES
+
+/*
+ * A cached 2.05 response to a GET request, keyed on the resource, the URI path and query,
+ * and the first Accept option of the request.
+ */
+typedef struct coap_cache_entry {
+  resource_t *resource;
+  unsigned long expires; /* in clock_seconds() */
+  uint16_t accept;
+  uint16_t content_type;
+  uint8_t key_len;
+  char key[COAP_CACHE_KEY_LEN];
+  uint8_t etag_len;
+  uint8_t etag[COAP_ETAG_LEN];
+  uint16_t payload_len;
+  uint8_t payload[COAP_CACHE_PAYLOAD_SIZE];
+} coap_cache_entry_t;
+
+static coap_cache_entry_t cache[COAP_CACHE_ENTRIES];
+
+/*----------------------------------------------------------------------------*/
+/* Packs path and query of a request into a key; returns 0 if it does not fit. */
+static int
+cache_key(coap_packet_t *coap_req, char *key)
+{
+  size_t len = coap_req->uri_path_len;
+
+  if (len + 1 + coap_req->uri_query_len > COAP_CACHE_KEY_LEN)
+  {
+    return 0;
+  }
+
+  memcpy(key, coap_req->uri_path, coap_req->uri_path_len);
+  if (coap_req->uri_query_len)
+  {
+    key[len++] = '?';
+    memcpy(key + len, coap_req->uri_query, coap_req->uri_query_len);
+    len += coap_req->uri_query_len;
+  }
+
+  return len;
+}
+/*----------------------------------------------------------------------------*/
+static int
+is_cacheable_request(coap_packet_t *coap_req)
+{
+  return coap_req->code==COAP_GET
+      && !IS_OPTION(coap_req, COAP_OPTION_OBSERVE)
+      && !IS_OPTION(coap_req, COAP_OPTION_BLOCK1)
+      && !IS_OPTION(coap_req, COAP_OPTION_BLOCK2);
+}
+/*----------------------------------------------------------------------------*/
+static uint16_t
+request_accept(coap_packet_t *coap_req)
+{
+  return coap_req->accept_num ? coap_req->accept[0] : 0xFFFF;
+}
+/*----------------------------------------------------------------------------*/
+/* Answers a request with a matching ETag with 2.03 Valid instead of the representation. */
+static void
+validate(coap_packet_t *coap_req, coap_packet_t *coap_res)
+{
+  if (IS_OPTION(coap_req, COAP_OPTION_ETAG) && IS_OPTION(coap_res, COAP_OPTION_ETAG)
+      && coap_req->etag_len==coap_res->etag_len && memcmp(coap_req->etag, coap_res->etag, coap_res->etag_len)==0)
+  {
+    PRINTF("Cache: ETag valid\n");
+    coap_res->code = VALID_2_03;
+    coap_set_payload(coap_res, coap_res->payload, 0);
+  }
+}
+/*----------------------------------------------------------------------------*/
+/*
+ * Serves the GET responses of a resource from the cache while their Max-Age lasts. This
+ * replaces the pre- and post-handlers, so it is not meant for observable or separate resources.
+ */
+void
+coap_cache_activate(resource_t *resource)
+{
+  rest_set_pre_handler(resource, coap_cache_pre_handler);
+  rest_set_post_handler(resource, coap_cache_post_handler);
+}
+/*----------------------------------------------------------------------------*/
+/* Drops the cached responses of a resource, e.g., when its representation has changed. */
+void
+coap_cache_invalidate(resource_t *resource)
+{
+  int i;
+
+  for (i=0; i<COAP_CACHE_ENTRIES; ++i)
+  {
+    if (resource==NULL || cache[i].resource==resource)
+    {
+      cache[i].resource = NULL;
+    }
+  }
+}
+/*----------------------------------------------------------------------------*/
+int
+coap_cache_pre_handler(resource_t *resource, void *request, void *response)
+{
+  coap_packet_t *const coap_req = (coap_packet_t *) request;
+  coap_packet_t *const coap_res = (coap_packet_t *) response;
+  char key[COAP_CACHE_KEY_LEN];
+  int key_len;
+  unsigned long now;
+  int i;
+
+  if (!is_cacheable_request(coap_req) || (key_len = cache_key(coap_req, key))==0)
+  {
+    return 1;
+  }
+
+  now = clock_seconds();
+
+  for (i=0; i<COAP_CACHE_ENTRIES; ++i)
+  {
+    coap_cache_entry_t *entry = &cache[i];
+
+    if (entry->resource==resource && entry->key_len==key_len && memcmp(entry->key, key, key_len)==0
+        && entry->accept==request_accept(coap_req))
+    {
+      if ((long)(entry->expires - now) <= 0)
+      {
+        entry->resource = NULL;
+        break;
+      }
+
+      PRINTF("Cache: hit for /%.*s\n", key_len, key);
+
+      coap_res->code = CONTENT_2_05;
+      if (entry->content_type!=0xFFFF)
+      {
+        coap_set_header_content_type(coap_res, entry->content_type);
+      }
+      if (entry->etag_len)
+      {
+        coap_set_header_etag(coap_res, entry->etag, entry->etag_len);
+      }
+      coap_set_header_max_age(coap_res, entry->expires - now);
+      coap_set_payload(coap_res, entry->payload, entry->payload_len);
+
+      validate(coap_req, coap_res);
+
+      /* Skip the resource handler. */
+      return 0;
+    }
+  }
+
+  return 1;
+}
+/*----------------------------------------------------------------------------*/
+void
+coap_cache_post_handler(resource_t *resource, void *request, void *response)
+{
+  coap_packet_t *const coap_req = (coap_packet_t *) request;
+  coap_packet_t *const coap_res = (coap_packet_t *) response;
+  coap_cache_entry_t *entry = NULL;
+  uint32_t max_age;
+  int i;
+
+  /*
+   * Responses that fill the whole chunk may be continued block-wise by the handler and
+   * are therefore not cached.
+   */
+  if (is_cacheable_request(coap_req) && coap_res->code==CONTENT_2_05
+      && coap_res->payload_len<REST_MAX_CHUNK_SIZE && coap_res->payload_len<=COAP_CACHE_PAYLOAD_SIZE
+      && coap_get_header_max_age(coap_res, &max_age) && max_age>0)
+  {
+    /* Use a free entry, or else the one expiring first. */
+    for (i=0; i<COAP_CACHE_ENTRIES; ++i)
+    {
+      if (cache[i].resource==NULL)
+      {
+        entry = &cache[i];
+        break;
+      }
+      if (entry==NULL || (long)(cache[i].expires - entry->expires) < 0)
+      {
+        entry = &cache[i];
+      }
+    }
+
+    entry->key_len = cache_key(coap_req, entry->key);
+    if (entry->key_len)
+    {
+      PRINTF("Cache: storing /%.*s for %lu s\n", entry->key_len, entry->key, max_age);
+
+      entry->resource = resource;
+      entry->expires = clock_seconds() + max_age;
+      entry->accept = request_accept(coap_req);
+      entry->content_type = IS_OPTION(coap_res, COAP_OPTION_CONTENT_TYPE) ? coap_res->content_type : 0xFFFF;
+      entry->etag_len = IS_OPTION(coap_res, COAP_OPTION_ETAG) ? coap_res->etag_len : 0;
+      memcpy(entry->etag, coap_res->etag, entry->etag_len);
+      entry->payload_len = coap_res->payload_len;
+      memcpy(entry->payload, coap_res->payload, coap_res->payload_len);
+    }
+    else
+    {
+      entry->resource = NULL;
+    }
+  }
+
+  validate(coap_req, coap_res);
+}
+/*----------------------------------------------------------------------------*/
+#else /* COAP_CACHE_ENTRIES */
+
+void
+coap_cache_activate(resource_t *resource)
+{
+}
+
+void
+coap_cache_invalidate(resource_t *resource)
+{
+}
+
+int
+coap_cache_pre_handler(resource_t *resource, void *request, void *response)
+{
+  return 1;
+}
+
+void
+coap_cache_post_handler(resource_t *resource, void *request, void *response)
+{
+}
+
+#endif /* COAP_CACHE_ENTRIES */
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2013, Institute for Pervasive Computing, ETH Zurich
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      CoAP module for caching responses
+ */
+
+
+#ifndef COAP_CACHE_H_
+#define COAP_CACHE_H_
+
+#include "er-coap-13.h"
+
+/*
+ * The number of responses kept by the response cache. With 0, the cache is disabled.
+ */
+#ifndef COAP_CACHE_ENTRIES
+#define COAP_CACHE_ENTRIES       0
+#endif /* COAP_CACHE_ENTRIES */
+
+/* The maximum payload size of a cached response. */
+#ifndef COAP_CACHE_PAYLOAD_SIZE
+#define COAP_CACHE_PAYLOAD_SIZE  REST_MAX_CHUNK_SIZE
+#endif /* COAP_CACHE_PAYLOAD_SIZE */
+
+/* The maximum length of the URI path and query a cached response is stored for. */
+#ifndef COAP_CACHE_KEY_LEN
+#define COAP_CACHE_KEY_LEN       32
+#endif /* COAP_CACHE_KEY_LEN */
+
+void coap_cache_activate(resource_t *resource);
+void coap_cache_invalidate(resource_t *resource);
+
+int coap_cache_pre_handler(resource_t *resource, void *request, void *response);
+void coap_cache_post_handler(resource_t *resource, void *request, void *response);
+
+#endif /* COAP_CACHE_H_ */
@@ -86,6 +86,7 @@ coap_receive(void)
   static coap_packet_t message[1]; /* This way the packet can be treated as pointer as usual. */
   static coap_packet_t response[1];
   static coap_transaction_t *transaction = NULL;
+  static uint8_t *response_buffer = NULL;
 
   if (uip_newdata()) {
 
@@ -109,8 +110,27 @@ coap_receive(void)
       /* Handle requests. */
       if (message->code >= COAP_GET && message->code <= COAP_DELETE)
       {
+        transaction = NULL;
+        response_buffer = NULL;
+
+#if COAP_ZERO_COPY
+        /*
+         * Responses are never retransmitted, so they can be built in the uIP buffer. The handler
+         * writes the payload behind the request, which stays readable until serialization.
+         */
+        if (MAX(uip_datalen(), COAP_MAX_HEADER_SIZE) + REST_MAX_CHUNK_SIZE <= UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN)
+        {
+          response_buffer = (uint8_t *) uip_appdata + MAX(uip_datalen(), COAP_MAX_HEADER_SIZE);
+        }
+        else
+#endif /* COAP_ZERO_COPY */
         /* Use transaction buffer for response to confirmable request. */
         if ( (transaction = coap_new_transaction(message->mid, &UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport)) )
+        {
+          response_buffer = transaction->packet+COAP_MAX_HEADER_SIZE;
+        }
+
+        if (response_buffer)
         {
           uint32_t block_num = 0;
           uint16_t block_size = REST_MAX_CHUNK_SIZE;
@@ -147,7 +167,7 @@ coap_receive(void)
           if (service_cbk)
           {
             /* Call REST framework and check if found and allowed. */
-            if (service_cbk(message, response, transaction->packet+COAP_MAX_HEADER_SIZE, block_size, &new_offset))
+            if (service_cbk(message, response, response_buffer, block_size, &new_offset))
             {
               if (coap_error_code==NO_ERROR)
               {
@@ -197,13 +217,28 @@ coap_receive(void)
             } /* successful service callback */
 
             /* Serialize response. */
-            if (coap_error_code==NO_ERROR)
+            if (coap_error_code==NO_ERROR && transaction)
             {
               if ((transaction->packet_len = coap_serialize_message(response, transaction->packet))==0)
               {
                 coap_error_code = PACKET_SERIALIZATION_ERROR;
               }
             }
+#if COAP_ZERO_COPY
+            else if (coap_error_code==NO_ERROR)
+            {
+              uint16_t response_len;
+
+              if ((response_len = coap_serialize_message(response, uip_appdata))==0)
+              {
+                coap_error_code = PACKET_SERIALIZATION_ERROR;
+              }
+              else
+              {
+                coap_send_message(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport, uip_appdata, response_len);
+              }
+            }
+#endif /* COAP_ZERO_COPY */
 
           }
           else
@@ -498,6 +533,10 @@ PROCESS_THREAD(coap_receiver, ev, data)
   PRINTF("Starting CoAP-13 receiver...\n");
 
   rest_activate_resource(&resource_well_known_core);
+#if COAP_CACHE_ENTRIES
+  /* rest_activate_resource() drops the cached listing whenever a resource is added. */
+  coap_cache_activate(&resource_well_known_core);
+#endif
 
   coap_register_as_transaction_handler();
   coap_init_connection(SERVER_LISTEN_PORT);
@@ -518,76 +557,176 @@ PROCESS_THREAD(coap_receiver, ev, data)
 /*----------------------------------------------------------------------------*/
 /*- Client part --------------------------------------------------------------*/
 /*----------------------------------------------------------------------------*/
+#define BLOCK_FREE     0
+#define BLOCK_PENDING  1
+#define BLOCK_RETRY    2
+
+#define BLOCK_END_UNKNOWN 0xFFFFFFFF
+
+/*
+ * Called for each response or timeout of a block request. The chunk handler is invoked
+ * right away, while the response is still in the uIP buffer.
+ */
 void coap_blocking_request_callback(void *callback_data, void *response) {
-  struct request_state_t *state = (struct request_state_t *) callback_data;
+  struct request_block_t *block = (struct request_block_t *) callback_data;
+  struct request_state_t *state = block->state;
+  uint32_t res_block = 0;
+  uint8_t more = 0;
+
   state->response = (coap_packet_t*) response;
+  block->status = BLOCK_FREE;
+
+  if (state->failed)
+  {
+    return;
+  }
+
+  if (!state->response)
+  {
+    PRINTF("Server not responding to #%lu\n", block->block_num);
+    state->failed = 1;
+  }
+  else if (!coap_get_header_block2(state->response, &res_block, &more, NULL, NULL))
+  {
+    /* Complete representation, or an error for a block beyond the end. */
+    if (block->block_num==0)
+    {
+      state->handler(state->response);
+    }
+    state->end_block = MIN(state->end_block, 1);
+  }
+  else if (res_block==block->block_num)
+  {
+    PRINTF("Received #%lu%s (%u bytes)\n", res_block, more ? "+" : "", state->response->payload_len);
+
+    state->handler(state->response);
+
+    if (!more)
+    {
+      state->end_block = MIN(state->end_block, res_block + 1);
+    }
+    else if (res_block==0)
+    {
+      /* Open the window once the server has confirmed a block-wise transfer. */
+      state->end_block = BLOCK_END_UNKNOWN;
+    }
+  }
+  else
+  {
+    PRINTF("WRONG BLOCK %lu/%lu\n", res_block, block->block_num);
+    if (++(block->attempts)<COAP_MAX_ATTEMPTS)
+    {
+      block->status = BLOCK_RETRY;
+    }
+    else
+    {
+      state->failed = 1;
+    }
+  }
+
   process_poll(state->process);
 }
 /*----------------------------------------------------------------------------*/
+static int
+send_block_request(struct request_state_t *state, struct request_block_t *block,
+                   uip_ipaddr_t *remote_ipaddr, uint16_t remote_port, coap_packet_t *request)
+{
+  request->mid = coap_get_mid();
+  if ((state->transaction = coap_new_transaction(request->mid, remote_ipaddr, remote_port)))
+  {
+    state->transaction->callback = coap_blocking_request_callback;
+    state->transaction->callback_data = block;
+
+    /* Block 0 goes out as the application set it up; later blocks keep a block size it chose. */
+    if (block->block_num>0)
+    {
+      coap_set_header_block2(request, block->block_num, 0,
+                             IS_OPTION(request, COAP_OPTION_BLOCK2) ? request->block2_size : REST_MAX_CHUNK_SIZE);
+    }
+
+    state->transaction->packet_len = coap_serialize_message(request, state->transaction->packet);
+
+    block->transaction = state->transaction;
+    block->status = BLOCK_PENDING;
+    coap_send_transaction(state->transaction);
+    PRINTF("Requested #%lu (MID %u)\n", block->block_num, request->mid);
+    return 1;
+  }
+
+  PRINTF("Could not allocate transaction buffer");
+  return 0;
+}
+/*----------------------------------------------------------------------------*/
 PT_THREAD(coap_blocking_request(struct request_state_t *state, process_event_t ev,
                                 uip_ipaddr_t *remote_ipaddr, uint16_t remote_port,
                                 coap_packet_t *request,
                                 blocking_response_handler request_callback)) {
   PT_BEGIN(&state->pt);
 
-  static uint8_t more;
-  static uint32_t res_block;
-  static uint8_t block_error;
+  static int i;
+  static uint8_t pending;
 
   state->block_num = 0;
+  state->end_block = 1; /* until block 0 announces more */
+  state->failed = 0;
   state->response = NULL;
+  state->handler = request_callback;
   state->process = PROCESS_CURRENT();
 
-  more = 0;
-  res_block = 0;
-  block_error = 0;
+  for (i=0; i<COAP_BLOCKING_REQUEST_WINDOW; ++i)
+  {
+    state->blocks[i].state = state;
+    state->blocks[i].status = BLOCK_FREE;
+  }
 
   do {
-    request->mid = coap_get_mid();
-    if ((state->transaction = coap_new_transaction(request->mid, remote_ipaddr, remote_port)))
+    /* Keep up to COAP_BLOCKING_REQUEST_WINDOW block requests outstanding. */
+    pending = 0;
+    for (i=0; i<COAP_BLOCKING_REQUEST_WINDOW; ++i)
     {
-      state->transaction->callback = coap_blocking_request_callback;
-      state->transaction->callback_data = state;
+      struct request_block_t *block = &state->blocks[i];
 
-      if (state->block_num>0)
+      if (block->status==BLOCK_FREE && state->block_num<state->end_block)
+      {
+        block->block_num = state->block_num++;
+        block->attempts = 0;
+        if (!send_block_request(state, block, remote_ipaddr, remote_port, request))
+        {
+          --(state->block_num);
+        }
+      }
+      else if (block->status==BLOCK_RETRY)
       {
-        coap_set_header_block2(request, state->block_num, 0, REST_MAX_CHUNK_SIZE);
+        if (!send_block_request(state, block, remote_ipaddr, remote_port, request))
+        {
+          block->status = BLOCK_FREE;
+          state->failed = 1;
+        }
       }
 
-      state->transaction->packet_len = coap_serialize_message(request, state->transaction->packet);
-
-      coap_send_transaction(state->transaction);
-      PRINTF("Requested #%lu (MID %u)\n", state->block_num, request->mid);
-
-      PT_YIELD_UNTIL(&state->pt, ev == PROCESS_EVENT_POLL);
-
-      if (!state->response)
+      if (block->status==BLOCK_PENDING)
       {
-        PRINTF("Server not responding\n");
-        PT_EXIT(&state->pt);
+        pending = 1;
       }
+    }
 
-      coap_get_header_block2(state->response, &res_block, &more, NULL, NULL);
+    if (!pending)
+    {
+      break;
+    }
 
-      PRINTF("Received #%lu%s (%u bytes)\n", res_block, more ? "+" : "", state->response->payload_len);
+    PT_YIELD_UNTIL(&state->pt, ev == PROCESS_EVENT_POLL);
+  } while (!state->failed);
 
-      if (res_block==state->block_num)
-      {
-        request_callback(state->response);
-        ++(state->block_num);
-      }
-      else
-      {
-        PRINTF("WRONG BLOCK %lu/%lu\n", res_block, state->block_num);
-        ++block_error;
-      }
-    }
-    else
+  /* After a failure, the blocks still in flight must not call back into the finished request. */
+  for (i=0; i<COAP_BLOCKING_REQUEST_WINDOW; ++i)
+  {
+    if (state->blocks[i].status==BLOCK_PENDING)
     {
-      PRINTF("Could not allocate transaction buffer");
-      PT_EXIT(&state->pt);
+      coap_clear_transaction(state->blocks[i].transaction);
+      state->blocks[i].status = BLOCK_FREE;
     }
-  } while (more && block_error<COAP_MAX_ATTEMPTS);
+  }
 
   PT_END(&state->pt);
 }
@@ -47,6 +47,8 @@
 #include "er-coap-13-transactions.h"
 #include "er-coap-13-observing.h"
 #include "er-coap-13-separate.h"
+#include "er-coap-13-block.h"
+#include "er-coap-13-cache.h"
 
 #include "pt.h"
 
@@ -62,19 +64,45 @@ extern const struct rest_implementation coap_rest_implementation;
 
 void coap_receiver_init(void);
 
+/* The /.well-known/core resource provided by the engine */
+extern resource_t resource_well_known_core;
+
 /*-----------------------------------------------------------------------------------*/
 /*- Client part ---------------------------------------------------------------------*/
 /*-----------------------------------------------------------------------------------*/
+/*
+ * The number of Block2 requests a blocking request keeps outstanding at the same time.
+ * With more than one, blocks can arrive out of order; chunk handlers then have to place
+ * the payload by the offset from coap_get_header_block2().
+ */
+#ifndef COAP_BLOCKING_REQUEST_WINDOW
+#define COAP_BLOCKING_REQUEST_WINDOW 1
+#endif /* COAP_BLOCKING_REQUEST_WINDOW */
+
+typedef void (*blocking_response_handler) (void* response);
+
+struct request_state_t;
+
+struct request_block_t {
+    struct request_state_t *state;
+    coap_transaction_t *transaction;
+    uint32_t block_num;
+    uint8_t status;
+    uint8_t attempts;
+};
+
 struct request_state_t {
     struct pt pt;
     struct process *process;
     coap_transaction_t *transaction;
     coap_packet_t *response;
-    uint32_t block_num;
+    blocking_response_handler handler;
+    uint32_t block_num; /* next block to request */
+    uint32_t end_block; /* first block not to request */
+    uint8_t failed;
+    struct request_block_t blocks[COAP_BLOCKING_REQUEST_WINDOW];
 };
 
-typedef void (*blocking_response_handler) (void* response);
-
 PT_THREAD(coap_blocking_request(struct request_state_t *state, process_event_t ev,
                                 uip_ipaddr_t *remote_ipaddr, uint16_t remote_port,
                                 coap_packet_t *request,
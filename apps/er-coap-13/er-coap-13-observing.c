@@ -166,15 +166,46 @@ coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
   return removed;
 }
 /*-----------------------------------------------------------------------------------*/
+/*
+ * Builds the notification for another observer from an already serialized one. Only the
+ * message type, MID, and Token differ between the observers of a resource.
+ */
+static size_t
+coap_copy_notification(uint8_t *buffer, const uint8_t *template, size_t template_len, coap_observer_t *obs, uint16_t mid, uint8_t type)
+{
+  uint8_t template_token_len = template[0] & COAP_HEADER_TOKEN_LEN_MASK;
+  size_t rest_len = template_len - COAP_HEADER_LEN - template_token_len;
+
+  if (COAP_HEADER_LEN + obs->token_len + rest_len > COAP_MAX_PACKET_SIZE)
+  {
+    return 0;
+  }
+
+  buffer[0] = template[0] & COAP_HEADER_VERSION_MASK;
+  buffer[0] |= COAP_HEADER_TYPE_MASK & type<<COAP_HEADER_TYPE_POSITION;
+  buffer[0] |= COAP_HEADER_TOKEN_LEN_MASK & obs->token_len<<COAP_HEADER_TOKEN_LEN_POSITION;
+  buffer[1] = template[1];
+  buffer[2] = (uint8_t) (mid>>8);
+  buffer[3] = (uint8_t) (mid);
+  memcpy(buffer + COAP_HEADER_LEN, obs->token, obs->token_len);
+  memcpy(buffer + COAP_HEADER_LEN + obs->token_len, template + COAP_HEADER_LEN + template_token_len, rest_len);
+
+  return COAP_HEADER_LEN + obs->token_len + rest_len;
+}
+/*-----------------------------------------------------------------------------------*/
 void
 coap_notify_observers(resource_t *resource, int32_t obs_counter, void *notification)
 {
   coap_packet_t *const coap_res = (coap_packet_t *) notification;
   coap_observer_t* obs = NULL;
   uint8_t preferred_type = coap_res->type;
+  coap_transaction_t *first = NULL;
+  clock_time_t delay = 0;
 
   PRINTF("Observing: Notification from %s\n", resource->url);
 
+  if (obs_counter>=0) coap_set_header_observe(coap_res, obs_counter);
+
   /* Iterate over observers. */
   for (obs = (coap_observer_t*)list_head(observers_list); obs; obs = obs->next)
   {
@@ -195,7 +226,6 @@ coap_notify_observers(resource_t *resource, int32_t obs_counter, void *notificat
 
         /* Prepare response */
         coap_res->mid = transaction->mid;
-        if (obs_counter>=0) coap_set_header_observe(coap_res, obs_counter);
         coap_set_header_token(coap_res, obs->token, obs->token_len);
 
         /* Use CON to check whether client is still there/interested after COAP_OBSERVING_REFRESH_INTERVAL. */
@@ -210,12 +240,44 @@ coap_notify_observers(resource_t *resource, int32_t obs_counter, void *notificat
           coap_res->type = preferred_type;
         }
 
-        transaction->packet_len = coap_serialize_message(coap_res, transaction->packet);
+        /*
+         * The notification is serialized only for the first observer. Its transaction is kept back
+         * until all others have been copied from it, as sending a NON message frees the transaction.
+         */
+        transaction->packet_len = 0;
+        if (first)
+        {
+          transaction->packet_len = coap_copy_notification(transaction->packet, first->packet, first->packet_len, obs, coap_res->mid, coap_res->type);
+        }
+        if (transaction->packet_len==0)
+        {
+          transaction->packet_len = coap_serialize_message(coap_res, transaction->packet);
+        }
 
-        coap_send_transaction(transaction);
+        if (first==NULL)
+        {
+          first = transaction;
+        }
+        else
+        {
+          delay += COAP_OBSERVING_PACING_INTERVAL;
+          if (delay==0)
+          {
+            coap_send_transaction(transaction);
+          }
+          else
+          {
+            coap_send_transaction_delayed(transaction, delay);
+          }
+        }
       }
     }
   }
+
+  if (first)
+  {
+    coap_send_transaction(first);
+  }
 }
 /*-----------------------------------------------------------------------------------*/
 void
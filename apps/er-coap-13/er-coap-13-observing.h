@@ -50,6 +50,15 @@
 /* Interval in seconds in which NON notifies are changed to CON notifies to check client. */
 #define COAP_OBSERVING_REFRESH_INTERVAL  60
 
+/*
+ * Interval in clock ticks between the notifications sent to consecutive observers of a resource.
+ * Use e.g. CLOCK_SECOND/NETSTACK_RDC_CHANNEL_CHECK_RATE to spread them across the RDC cycle.
+ * With 0, all notifications are sent at once.
+ */
+#ifndef COAP_OBSERVING_PACING_INTERVAL
+#define COAP_OBSERVING_PACING_INTERVAL   0
+#endif /* COAP_OBSERVING_PACING_INTERVAL */
+
 #if COAP_MAX_OPEN_TRANSACTIONS<COAP_MAX_OBSERVERS
 #warning "COAP_MAX_OPEN_TRANSACTIONS smaller than COAP_MAX_OBSERVERS: cannot handle CON notifications"
 #endif
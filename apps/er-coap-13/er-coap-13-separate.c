@@ -39,6 +39,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "lib/list.h"
+#include "lib/memb.h"
+
 #include "er-coap-13-separate.h"
 #include "er-coap-13-transactions.h"
 
@@ -53,6 +56,9 @@
 #define PRINTLLADDR(addr)
 #endif
 
+MEMB(separate_memb, coap_separate_pending_t, COAP_MAX_SEPARATE);
+LIST(separate_list);
+
 /*----------------------------------------------------------------------------*/
 void
 coap_separate_reject()
@@ -68,8 +74,28 @@ coap_separate_accept(void *request, coap_separate_t *separate_store)
   coap_transaction_t *const t = coap_get_transaction_by_mid(coap_req->mid);
 
   PRINTF("Separate ACCEPT: /%.*s MID %u\n", coap_req->uri_path_len, coap_req->uri_path, coap_req->mid);
+#if COAP_ZERO_COPY
+  /* Responses built in the uIP buffer have no transaction; the request is still in the buffer. */
+  if (t || uip_newdata())
+#else
   if (t)
+#endif
   {
+    /* Store remote address. */
+#if COAP_ZERO_COPY
+    /* Taken from the request before the ACK overwrites the IP header. */
+    if (t==NULL)
+    {
+      uip_ipaddr_copy(&separate_store->addr, &UIP_IP_BUF->srcipaddr);
+      separate_store->port = UIP_UDP_BUF->srcport;
+    }
+    else
+#endif
+    {
+      uip_ipaddr_copy(&separate_store->addr, &t->addr);
+      separate_store->port = t->port;
+    }
+
     /* Send separate ACK for CON. */
     if (coap_req->type==COAP_TYPE_CON)
     {
@@ -80,10 +106,6 @@ coap_separate_accept(void *request, coap_separate_t *separate_store)
       coap_send_message(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport, (uip_appdata), coap_serialize_message(ack, uip_appdata));
     }
 
-    /* Store remote address. */
-    uip_ipaddr_copy(&separate_store->addr, &t->addr);
-    separate_store->port = t->port;
-
     /* Store correct response type. */
     separate_store->type = coap_req->type==COAP_TYPE_CON ? COAP_TYPE_CON : COAP_TYPE_NON;
     separate_store->mid = coap_get_mid(); /* if it was a NON, we burned one MID in the engine... */
@@ -115,3 +137,135 @@ coap_separate_resume(void *response, coap_separate_t *separate_store, uint8_t co
     coap_set_header_token(response, separate_store->token, separate_store->token_len);
   }
 }
+/*----------------------------------------------------------------------------*/
+int
+coap_separate_queue(resource_t *resource, void *request, uint16_t *key)
+{
+  static uint16_t last_key = 0;
+  coap_packet_t *const coap_req = (coap_packet_t *) request;
+  coap_separate_pending_t *p = NULL;
+  coap_separate_pending_t *group = NULL;
+  const char *query = NULL;
+  int len = coap_get_header_uri_query(request, &query);
+
+  if ((p = memb_alloc(&separate_memb))==NULL)
+  {
+    PRINTF("Separate pool full: /%s\n", resource->url);
+    coap_separate_reject();
+    return COAP_SEPARATE_FULL;
+  }
+
+  /* Only GETs may share a result, and only if the whole query can be compared. */
+  p->shared = coap_req->code==COAP_GET && len<=COAP_SEPARATE_QUERY_LEN;
+  p->query_len = 0;
+  if (p->shared)
+  {
+    /* Copied now, as the separate ACK overwrites the request. */
+    p->query_len = len;
+    if (len>0)
+    {
+      memcpy(p->query, query, len);
+    }
+
+    for (group = (coap_separate_pending_t *) list_head(separate_list); group; group = group->next)
+    {
+      if (group->shared && group->resource==resource && group->query_len==p->query_len && memcmp(group->query, p->query, p->query_len)==0)
+      {
+        break;
+      }
+    }
+  }
+
+  if (!coap_separate_accept(request, &p->store))
+  {
+    memb_free(&separate_memb, p);
+    coap_separate_reject();
+    return COAP_SEPARATE_FULL;
+  }
+
+  p->resource = resource;
+  p->key = group ? group->key : ++last_key;
+  list_add(separate_list, p);
+  *key = p->key;
+
+  PRINTF("Separate queued: /%s key %u%s\n", resource->url, p->key, group ? "" : " (start)");
+
+  return group ? COAP_SEPARATE_QUEUED : COAP_SEPARATE_START;
+}
+/*----------------------------------------------------------------------------*/
+int
+coap_separate_pending(resource_t *resource, uint16_t key)
+{
+  coap_separate_pending_t *p = NULL;
+  int count = 0;
+
+  for (p = (coap_separate_pending_t *) list_head(separate_list); p; p = p->next)
+  {
+    if (p->resource==resource && p->key==key)
+    {
+      ++count;
+    }
+  }
+  return count;
+}
+/*----------------------------------------------------------------------------*/
+static void
+send_pending(coap_separate_pending_t *p, uint8_t code, unsigned int content_type, const uint8_t *payload, size_t length)
+{
+  coap_transaction_t *transaction = NULL;
+  coap_packet_t response[1];
+  uint16_t size = p->store.block2_size ? p->store.block2_size : REST_MAX_CHUNK_SIZE;
+  uint32_t offset = 0;
+
+  if (size > REST_MAX_CHUNK_SIZE) size = REST_MAX_CHUNK_SIZE;
+  offset = p->store.block2_num * size;
+
+  if ( (transaction = coap_new_transaction(p->store.mid, &p->store.addr, p->store.port))==NULL )
+  {
+    PRINTF("Separate response for /%s dropped: no transaction\n", p->resource->url);
+    return;
+  }
+
+  if (offset > length)
+  {
+    coap_separate_resume(response, &p->store, BAD_OPTION_4_02);
+    coap_set_payload(response, "BlockOutOfScope", 15);
+  }
+  else
+  {
+    coap_separate_resume(response, &p->store, code);
+    coap_set_header_content_type(response, content_type);
+
+    /* Each waiting client gets the block it asked for from the shared representation. */
+    if (p->store.block2_size || length > size)
+    {
+      coap_set_header_block2(response, p->store.block2_num, offset + size < length, size);
+    }
+    coap_set_payload(response, payload + offset, length - offset < size ? length - offset : size);
+  }
+
+  transaction->packet_len = coap_serialize_message(response, transaction->packet);
+  coap_send_transaction(transaction);
+}
+/*----------------------------------------------------------------------------*/
+int
+coap_separate_complete(resource_t *resource, uint16_t key, uint8_t code, unsigned int content_type, const uint8_t *payload, size_t length)
+{
+  coap_separate_pending_t *p = NULL;
+  coap_separate_pending_t *next = NULL;
+  int count = 0;
+
+  for (p = (coap_separate_pending_t *) list_head(separate_list); p; p = next)
+  {
+    next = p->next;
+    if (p->resource==resource && p->key==key)
+    {
+      PRINTF("Separate resume: /%s key %u\n", resource->url, key);
+      send_pending(p, code, content_type, payload, length);
+      list_remove(separate_list, p);
+      memb_free(&separate_memb, p);
+      ++count;
+    }
+  }
+  return count;
+}
@@ -41,6 +41,21 @@
 
 #include "er-coap-13.h"
 
+/* Number of separate requests that can wait in the pool at the same time. */
+#ifndef COAP_MAX_SEPARATE
+#define COAP_MAX_SEPARATE    COAP_MAX_OPEN_TRANSACTIONS
+#endif /* COAP_MAX_SEPARATE */
+
+/* Longest URI query stored to recognise identical GETs; GETs with longer queries are never coalesced. */
+#ifndef COAP_SEPARATE_QUERY_LEN
+#define COAP_SEPARATE_QUERY_LEN 16
+#endif /* COAP_SEPARATE_QUERY_LEN */
+
+/* Return values of coap_separate_queue(). */
+#define COAP_SEPARATE_FULL     -1
+#define COAP_SEPARATE_QUEUED    0
+#define COAP_SEPARATE_START     1
+
 typedef struct coap_separate {
 
   uip_ipaddr_t addr;
@@ -58,9 +73,32 @@ typedef struct coap_separate {
 
 } coap_separate_t;
 
+typedef struct coap_separate_pending {
+  struct coap_separate_pending *next; /* for LIST */
+
+  resource_t *resource;
+  uint16_t key; /* identifies the requests that are answered together */
+  uint8_t shared; /* GET that later identical GETs may join */
+  uint8_t query_len;
+  char query[COAP_SEPARATE_QUERY_LEN];
+  coap_separate_t store;
+} coap_separate_pending_t;
+
 int coap_separate_handler(resource_t *resource, void *request, void *response);
 void coap_separate_reject();
 int coap_separate_accept(void *request, coap_separate_t *separate_store);
 void coap_separate_resume(void *response, coap_separate_t *separate_store, uint8_t code);
 
+/*
+ * Pool of separate requests that wait for slow resources. A handler queues the request
+ * instead of keeping its own coap_separate_t, and gets the key of its group. GETs for the
+ * same resource and query wait for the same result: only the first one returns
+ * COAP_SEPARATE_START, telling the handler to start the slow operation. Other methods
+ * always start their own group. When the data is ready, coap_separate_complete() answers
+ * the whole group. COAP_SEPARATE_FULL means the request was rejected with 5.03.
+ */
+int coap_separate_queue(resource_t *resource, void *request, uint16_t *key);
+int coap_separate_complete(resource_t *resource, uint16_t key, uint8_t code, unsigned int content_type, const uint8_t *payload, size_t length);
+int coap_separate_pending(resource_t *resource, uint16_t key);
+
 #endif /* COAP_SEPARATE_H_ */
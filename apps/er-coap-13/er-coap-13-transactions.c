@@ -63,11 +63,135 @@
 
 
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
-LIST(transactions_list);
 
+/* Open transactions are chained in hash buckets by their message ID. */
+#define TRANSACTION_BUCKET(mid) ((mid) % COAP_TRANSACTION_HASH_SIZE)
+static coap_transaction_t *transactions_hash[COAP_TRANSACTION_HASH_SIZE];
+
+/*
+ * Confirmable transactions waiting for an ACK are kept in a min-heap ordered by
+ * their retransmission time. A single timer is set for the earliest one.
+ */
+#define HEAP_INVALID_INDEX 0xffff
+#define TIME_BEFORE(a, b) ((clock_time_t)((a) - (b)) > (clock_time_t)(~(clock_time_t)0 >> 1))
+
+static coap_transaction_t *retrans_heap[COAP_MAX_OPEN_TRANSACTIONS];
+static uint16_t retrans_heap_size = 0;
+static struct etimer retrans_timer;
 
 static struct process *transaction_handler_process = NULL;
 
+/*----------------------------------------------------------------------------*/
+static void
+heap_set(uint16_t index, coap_transaction_t *t)
+{
+  retrans_heap[index] = t;
+  t->heap_index = index;
+}
+/*----------------------------------------------------------------------------*/
+static void
+heap_sift_up(uint16_t index)
+{
+  coap_transaction_t *t = retrans_heap[index];
+  uint16_t parent;
+
+  while (index>0)
+  {
+    parent = (index - 1) / 2;
+    if (!TIME_BEFORE(t->retrans_time, retrans_heap[parent]->retrans_time))
+    {
+      break;
+    }
+    heap_set(index, retrans_heap[parent]);
+    index = parent;
+  }
+  heap_set(index, t);
+}
+/*----------------------------------------------------------------------------*/
+static void
+heap_sift_down(uint16_t index)
+{
+  coap_transaction_t *t = retrans_heap[index];
+  uint16_t child;
+
+  while ((child = 2 * index + 1) < retrans_heap_size)
+  {
+    if (child + 1 < retrans_heap_size
+        && TIME_BEFORE(retrans_heap[child + 1]->retrans_time, retrans_heap[child]->retrans_time))
+    {
+      ++child;
+    }
+    if (!TIME_BEFORE(retrans_heap[child]->retrans_time, t->retrans_time))
+    {
+      break;
+    }
+    heap_set(index, retrans_heap[child]);
+    index = child;
+  }
+  heap_set(index, t);
+}
+/*----------------------------------------------------------------------------*/
+static void
+heap_remove(coap_transaction_t *t)
+{
+  uint16_t index = t->heap_index;
+  coap_transaction_t *last;
+
+  if (index==HEAP_INVALID_INDEX)
+  {
+    return;
+  }
+  t->heap_index = HEAP_INVALID_INDEX;
+
+  last = retrans_heap[--retrans_heap_size];
+  if (last!=t)
+  {
+    heap_set(index, last);
+    if (index>0 && TIME_BEFORE(last->retrans_time, retrans_heap[(index - 1) / 2]->retrans_time))
+    {
+      heap_sift_up(index);
+    }
+    else
+    {
+      heap_sift_down(index);
+    }
+  }
+}
+/*----------------------------------------------------------------------------*/
+static void
+heap_insert(coap_transaction_t *t)
+{
+  heap_remove(t);
+  retrans_heap[retrans_heap_size] = t;
+  heap_sift_up(retrans_heap_size++);
+}
+/*----------------------------------------------------------------------------*/
+static void
+set_retrans_timer(void)
+{
+  clock_time_t now;
+
+  if (retrans_heap_size==0)
+  {
+    etimer_stop(&retrans_timer);
+    return;
+  }
+
+  now = clock_time();
+
+  /* The timer is set on behalf of the process that calls coap_check_transactions(). */
+  PROCESS_CONTEXT_BEGIN(transaction_handler_process);
+  if (TIME_BEFORE(now, retrans_heap[0]->retrans_time))
+  {
+    etimer_set(&retrans_timer, retrans_heap[0]->retrans_time - now);
+  }
+  else
+  {
+    etimer_set(&retrans_timer, 0);
+  }
+  PROCESS_CONTEXT_END(transaction_handler_process);
+}
+/*----------------------------------------------------------------------------*/
 void
 coap_register_as_transaction_handler()
 {
@@ -83,12 +207,14 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
   {
     t->mid = mid;
     t->retrans_counter = 0;
+    t->heap_index = HEAP_INVALID_INDEX;
 
     /* save client address */
     uip_ipaddr_copy(&t->addr, addr);
     t->port = port;
 
-    list_add(transactions_list, t); /* List itself makes sure same element is not added twice. */
+    t->next = transactions_hash[TRANSACTION_BUCKET(mid)];
+    transactions_hash[TRANSACTION_BUCKET(mid)] = t;
   }
 
   return t;
@@ -110,23 +236,18 @@ coap_send_transaction(coap_transaction_t *t)
 
       if (t->retrans_counter==0)
       {
-        t->retrans_timer.timer.interval = COAP_RESPONSE_TIMEOUT_TICKS + (random_rand() % (clock_time_t) COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
-        PRINTF("Initial interval %f\n", (float)t->retrans_timer.timer.interval/CLOCK_SECOND);
+        t->retrans_interval = COAP_RESPONSE_TIMEOUT_TICKS + (random_rand() % (clock_time_t) COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+        PRINTF("Initial interval %f\n", (float)t->retrans_interval/CLOCK_SECOND);
       }
       else
       {
-        t->retrans_timer.timer.interval <<= 1; /* double */
-        PRINTF("Doubled (%u) interval %f\n", t->retrans_counter, (float)t->retrans_timer.timer.interval/CLOCK_SECOND);
+        t->retrans_interval <<= 1; /* double */
+        PRINTF("Doubled (%u) interval %f\n", t->retrans_counter, (float)t->retrans_interval/CLOCK_SECOND);
       }
 
-      /*FIXME
-       * Hack: Setting timer for responsible process.
-       * Maybe there is a better way, but avoid posting everything to the process.
-       */
-      struct process *process_actual = PROCESS_CURRENT();
-      process_current = transaction_handler_process;
-      etimer_restart(&t->retrans_timer); /* interval updated above */
-      process_current = process_actual;
+      t->retrans_time = clock_time() + t->retrans_interval;
+      heap_insert(t);
+      set_retrans_timer();
 
       t = NULL;
     }
@@ -153,15 +274,41 @@ coap_send_transaction(coap_transaction_t *t)
   }
 }
 
+/*
+ * Schedules the first transmission of a transaction. It is sent from coap_check_transactions()
+ * once the delay has passed, and is retransmitted from then on like any other transaction.
+ */
+void
+coap_send_transaction_delayed(coap_transaction_t *t, clock_time_t delay)
+{
+  PRINTF("Delaying transaction %u by %lu ticks\n", t->mid, (unsigned long)delay);
+
+  t->retrans_interval = 0; /* not sent yet */
+  t->retrans_time = clock_time() + delay;
+  heap_insert(t);
+  set_retrans_timer();
+}
+
 void
 coap_clear_transaction(coap_transaction_t *t)
 {
+  coap_transaction_t **prev;
+
   if (t)
   {
     PRINTF("Freeing transaction %u: %p\n", t->mid, t);
 
-    etimer_stop(&t->retrans_timer);
-    list_remove(transactions_list, t);
+    /* The timer is left running; coap_check_transactions() re-arms it when it fires. */
+    heap_remove(t);
+
+    for (prev = &transactions_hash[TRANSACTION_BUCKET(t->mid)]; *prev; prev = &(*prev)->next)
+    {
+      if (*prev==t)
+      {
+        *prev = t->next;
+        break;
+      }
+    }
     memb_free(&transactions_memb, t);
   }
 }
@@ -171,7 +318,7 @@ coap_get_transaction_by_mid(uint16_t mid)
 {
   coap_transaction_t *t = NULL;
 
-  for (t = (coap_transaction_t*)list_head(transactions_list); t; t = t->next)
+  for (t = transactions_hash[TRANSACTION_BUCKET(mid)]; t; t = t->next)
   {
     if (t->mid==mid)
     {
@@ -186,14 +333,20 @@ void
 coap_check_transactions()
 {
   coap_transaction_t *t = NULL;
+  clock_time_t now = clock_time();
 
-  for (t = (coap_transaction_t*)list_head(transactions_list); t; t = t->next)
+  while (retrans_heap_size>0 && !TIME_BEFORE(now, retrans_heap[0]->retrans_time))
   {
-    if (etimer_expired(&t->retrans_timer))
+    t = retrans_heap[0];
+    heap_remove(t);
+
+    if (t->retrans_interval!=0)
     {
       ++(t->retrans_counter);
       PRINTF("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
-      coap_send_transaction(t);
     }
+    coap_send_transaction(t);
   }
+
+  set_retrans_timer();
 }
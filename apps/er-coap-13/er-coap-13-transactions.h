@@ -48,12 +48,22 @@
 #define COAP_MAX_OPEN_TRANSACTIONS 4 
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/*
+ * The number of hash buckets used to look up open transactions by their message ID.
+ * A power of two keeps the bucket computation cheap.
+ */
+#ifndef COAP_TRANSACTION_HASH_SIZE
+#define COAP_TRANSACTION_HASH_SIZE 8
+#endif /* COAP_TRANSACTION_HASH_SIZE */
+
 /* container for transactions with message buffer and retransmission info */
 typedef struct coap_transaction {
-  struct coap_transaction *next; /* for LIST */
+  struct coap_transaction *next; /* for the MID hash chain */
 
   uint16_t mid;
-  struct etimer retrans_timer;
+  clock_time_t retrans_interval;
+  clock_time_t retrans_time; /* when the next retransmission is due */
+  uint16_t heap_index; /* position in the retransmission heap */
   uint8_t retrans_counter;
 
   uip_ipaddr_t addr;
@@ -70,6 +80,7 @@ void coap_register_as_transaction_handler();
 
 coap_transaction_t *coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port);
 void coap_send_transaction(coap_transaction_t *t);
+void coap_send_transaction_delayed(coap_transaction_t *t, clock_time_t delay);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
 
@@ -85,6 +85,14 @@
 #error "UIP_CONF_BUFFER_SIZE too small for REST_MAX_CHUNK_SIZE"
 #endif
 
+/*
+ * Serialize responses directly into the uIP buffer instead of a transaction buffer.
+ * The request is overwritten while serializing, so response options must not point into it.
+ */
+#ifndef COAP_ZERO_COPY
+#define COAP_ZERO_COPY                0
+#endif /* COAP_ZERO_COPY */
+
 /*
  * Maximum number of failed request attempts before action
  */
@@ -104,6 +112,10 @@ enum { OPTION_MAP_SIZE = sizeof(uint8_t) * 8 };
 #define MIN(a, b) ((a) < (b)? (a) : (b))
 #endif /* MIN */
 
+#ifndef MAX
+#define MAX(a, b) ((a) > (b)? (a) : (b))
+#endif /* MAX */
+
 /* CoAP message types */
 typedef enum {
   COAP_TYPE_CON, /* confirmables */
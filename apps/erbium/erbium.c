@@ -41,6 +41,9 @@
 #include <stdio.h> /*for sprintf in rest_set_header_**/
 
 #include "erbium.h"
+#if WITH_COAP == 13
+#include "er-coap-13-engine.h"
+#endif /* WITH_COAP == 13 */
 
 #define DEBUG 0
 #if DEBUG
@@ -58,6 +61,94 @@ PROCESS_NAME(rest_manager_process);
 LIST(restful_services);
 LIST(restful_periodic_services);
 
+/*
+ * Activated resources are indexed by their URI path. Resources that also handle
+ * sub-resources are matched by prefix and are kept in a separate list instead.
+ */
+static resource_t *resource_hash[REST_RESOURCE_HASH_SIZE];
+static resource_t *sub_resources;
+
+/*-----------------------------------------------------------------------------------*/
+static unsigned int
+resource_hash_index(const char *url, size_t url_len)
+{
+  unsigned int hash = 0;
+
+  while (url_len--)
+  {
+    hash = hash * 31 + (uint8_t)*url++;
+  }
+  return hash % REST_RESOURCE_HASH_SIZE;
+}
+
+static resource_t **
+resource_index_head(resource_t* resource)
+{
+  if (resource->flags & HAS_SUB_RESOURCES)
+  {
+    return &sub_resources;
+  }
+  return &resource_hash[resource_hash_index(resource->url, strlen(resource->url))];
+}
+
+static void
+resource_index_add(resource_t* resource)
+{
+  resource_t **r;
+
+  /* Append, so that sub-resource handlers are matched in activation order. */
+  for (r = resource_index_head(resource); *r; r = &(*r)->hash_next)
+  {
+    if (*r==resource)
+    {
+      return;
+    }
+  }
+  resource->hash_next = NULL;
+  *r = resource;
+}
+
+static int
+resource_index_remove(resource_t* resource)
+{
+  resource_t **r;
+
+  for (r = resource_index_head(resource); *r; r = &(*r)->hash_next)
+  {
+    if (*r==resource)
+    {
+      *r = resource->hash_next;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static resource_t *
+resource_find(const char *url, size_t url_len)
+{
+  resource_t* resource = NULL;
+
+  for (resource = resource_hash[resource_hash_index(url, url_len)]; resource; resource = resource->hash_next)
+  {
+    if (strlen(resource->url)==url_len && strncmp(resource->url, url, url_len)==0)
+    {
+      return resource;
+    }
+  }
+
+  for (resource = sub_resources; resource; resource = resource->hash_next)
+  {
+    if (strlen(resource->url)<=url_len && strncmp(resource->url, url, strlen(resource->url))==0)
+    {
+      return resource;
+    }
+  }
+
+  return NULL;
+}
+/*-----------------------------------------------------------------------------------*/
+
 
 void
 rest_init_engine(void)
@@ -88,6 +179,12 @@ rest_activate_resource(resource_t* resource)
   }
 
   list_add(restful_services, resource);
+  resource_index_add(resource);
+
+#if WITH_COAP == 13
+  /* A cached /.well-known/core listing would miss the new resource */
+  coap_cache_invalidate(&resource_well_known_core);
+#endif /* WITH_COAP == 13 */
 }
 
 void
@@ -140,7 +237,16 @@ rest_set_post_handler(resource_t* resource, restful_post_handler post_handler)
 void
 rest_set_special_flags(resource_t* resource, rest_resource_flags_t flags)
 {
-  resource->flags |= flags;
+  /* The flags decide where the resource is indexed. */
+  if (resource_index_remove(resource))
+  {
+    resource->flags |= flags;
+    resource_index_add(resource);
+  }
+  else
+  {
+    resource->flags |= flags;
+  }
 }
 
 int
@@ -149,42 +255,37 @@ rest_invoke_restful_service(void* request, void* response, uint8_t *buffer, uint
   uint8_t found = 0;
   uint8_t allowed = 0;
 
-  PRINTF("rest_invoke_restful_service url /%.*s -->\n", url_len, url);
-
   resource_t* resource = NULL;
   const char *url = NULL;
+  int url_len = REST.get_url(request, &url);
 
-  for (resource = (resource_t*)list_head(restful_services); resource; resource = resource->next)
+  PRINTF("rest_invoke_restful_service url /%.*s -->\n", url_len, url);
+
+  if ((resource = resource_find(url, url_len)))
   {
-    /*if the web service handles that kind of requests and urls matches*/
-    if ((REST.get_url(request, &url)==strlen(resource->url) || (REST.get_url(request, &url)>strlen(resource->url) && (resource->flags & HAS_SUB_RESOURCES)))
-        && strncmp(resource->url, url, strlen(resource->url)) == 0)
-    {
-      found = 1;
-      rest_resource_flags_t method = REST.get_method_type(request);
+    found = 1;
+    rest_resource_flags_t method = REST.get_method_type(request);
 
-      PRINTF("method %u, resource->flags %u\n", (uint16_t)method, resource->flags);
+    PRINTF("method %u, resource->flags %u\n", (uint16_t)method, resource->flags);
 
-      if (resource->flags & method)
+    if (resource->flags & method)
+    {
+      allowed = 1;
+
+      /*call pre handler if it exists*/
+      if (!resource->pre_handler || resource->pre_handler(resource, request, response))
       {
-        allowed = 1;
+        /* call handler function*/
+        resource->handler(request, response, buffer, buffer_size, offset);
 
-        /*call pre handler if it exists*/
-        if (!resource->pre_handler || resource->pre_handler(resource, request, response))
+        /*call post handler if it exists*/
+        if (resource->post_handler)
         {
-          /* call handler function*/
-          resource->handler(request, response, buffer, buffer_size, offset);
-
-          /*call post handler if it exists*/
-          if (resource->post_handler)
-          {
-            resource->post_handler(resource, request, response);
-          }
+          resource->post_handler(resource, request, response);
         }
-      } else {
-        REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
       }
-      break;
+    } else {
+      REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
     }
   }
 
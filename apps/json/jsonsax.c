@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+#include "jsonsax.h"
+#include <string.h>
+
+struct parser {
+  const struct jsonsax_path *paths;
+  const char *json;
+  int pos;
+  int len;
+  int matches;
+};
+
+/*--------------------------------------------------------------------*/
+static void
+skip_ws(struct parser *p)
+{
+  char c;
+
+  while(p->pos < p->len &&
+        ((c = p->json[p->pos]) == ' ' || c == '\n' ||
+         c == '\r' || c == '\t')) {
+    p->pos++;
+  }
+}
+/*--------------------------------------------------------------------*/
+static char
+peek(struct parser *p)
+{
+  skip_ws(p);
+  return p->pos < p->len ? p->json[p->pos] : 0;
+}
+/*--------------------------------------------------------------------*/
+/* returns component number depth of path, or NULL past its end */
+/*--------------------------------------------------------------------*/
+static const char *
+component(const char *path, int depth, int *len)
+{
+  const char *end;
+
+  for(;;) {
+    if(*path == '/') {
+      path++;
+    }
+    end = strchr(path, '/');
+    if(end == NULL) {
+      end = path + strlen(path);
+    }
+    if(depth == 0) {
+      break;
+    }
+    if(*end == 0) {
+      return NULL;
+    }
+    path = end;
+    depth--;
+  }
+  *len = end - path;
+  return *len > 0 ? path : NULL;
+}
+/*--------------------------------------------------------------------*/
+/* the paths in mask whose component at depth matches an object key
+   (key != NULL) or an array index */
+/*--------------------------------------------------------------------*/
+static uint32_t
+match(struct parser *p, uint32_t mask, int depth,
+      const char *key, int keylen, int index)
+{
+  const char *comp;
+  uint32_t result;
+  int i, len, n;
+
+  result = 0;
+  for(i = 0; mask != 0; i++, mask >>= 1) {
+    if((mask & 1) == 0 ||
+       (comp = component(p->paths[i].path, depth, &len)) == NULL) {
+      continue;
+    }
+    if(len == 1 && *comp == '*') {
+      result |= (uint32_t)1 << i;
+    } else if(key != NULL) {
+      if(len == keylen && memcmp(comp, key, len) == 0) {
+        result |= (uint32_t)1 << i;
+      }
+    } else if(*comp >= '0' && *comp <= '9') {
+      for(n = 0; len > 0 && *comp >= '0' && *comp <= '9'; len--, comp++) {
+        n = n * 10 + *comp - '0';
+      }
+      if(len == 0 && n == index) {
+        result |= (uint32_t)1 << i;
+      }
+    }
+  }
+  return result;
+}
+/*--------------------------------------------------------------------*/
+/* scans a string starting after the opening quote */
+/*--------------------------------------------------------------------*/
+static int
+string(struct parser *p, struct jsonsax_value *v)
+{
+  char c;
+
+  v->type = JSON_TYPE_STRING;
+  v->n = 0;
+  v->str = &p->json[p->pos];
+  while(p->pos < p->len && (c = p->json[p->pos++]) != '"') {
+    if(c == '\\') {
+      p->pos++;
+    }
+  }
+  if(p->pos > p->len || p->json[p->pos - 1] != '"') {
+    return JSON_ERROR_UNEXPECTED_STRING;
+  }
+  v->len = &p->json[p->pos - 1] - v->str;
+  return JSON_ERROR_OK;
+}
+/*--------------------------------------------------------------------*/
+static int
+number(struct parser *p, struct jsonsax_value *v)
+{
+  char c;
+  int neg;
+
+  v->type = JSON_TYPE_NUMBER;
+  v->str = &p->json[p->pos];
+  v->n = 0;
+  neg = p->json[p->pos] == '-';
+  if(neg) {
+    p->pos++;
+  }
+  while(p->pos < p->len &&
+        (c = p->json[p->pos]) >= '0' && c <= '9') {
+    v->n = v->n * 10 + c - '0';
+    p->pos++;
+  }
+  if(neg) {
+    v->n = -v->n;
+  }
+  /* fractions and exponents are validated but only the integer part
+     is decoded */
+  while(p->pos < p->len &&
+        ((c = p->json[p->pos]) == '.' || c == 'e' || c == 'E' ||
+         c == '+' || c == '-' || (c >= '0' && c <= '9'))) {
+    p->pos++;
+  }
+  v->len = &p->json[p->pos] - v->str;
+  if(v->len == neg) {
+    return JSON_ERROR_SYNTAX;
+  }
+  return JSON_ERROR_OK;
+}
+/*--------------------------------------------------------------------*/
+static int
+literal(struct parser *p, struct jsonsax_value *v,
+        const char *word, char type, long n)
+{
+  int len;
+
+  len = strlen(word);
+  if(p->len - p->pos < len || memcmp(&p->json[p->pos], word, len) != 0) {
+    return JSON_ERROR_SYNTAX;
+  }
+  v->type = type;
+  v->n = n;
+  v->str = &p->json[p->pos];
+  v->len = len;
+  p->pos += len;
+  return JSON_ERROR_OK;
+}
+/*--------------------------------------------------------------------*/
+static int
+value(struct parser *p, uint32_t mask, int depth)
+{
+  struct jsonsax_value v;
+  const char *key;
+  int keylen;
+  int index;
+  int err;
+  int i, len;
+  char c;
+
+  c = peek(p);
+  if(c == '{' || c == '[') {
+    if(depth >= JSONSAX_MAX_DEPTH) {
+      return c == '{' ? JSON_ERROR_UNEXPECTED_OBJECT :
+        JSON_ERROR_UNEXPECTED_ARRAY;
+    }
+    p->pos++;
+    if(peek(p) == (c == '{' ? '}' : ']')) {
+      p->pos++;
+      return JSON_ERROR_OK;
+    }
+    for(index = 0;; index++) {
+      if(c == '{') {
+        if(peek(p) != '"') {
+          return JSON_ERROR_SYNTAX;
+        }
+        p->pos++;
+        if((err = string(p, &v)) != JSON_ERROR_OK) {
+          return err;
+        }
+        key = v.str;
+        keylen = v.len;
+        if(peek(p) != ':') {
+          return JSON_ERROR_SYNTAX;
+        }
+        p->pos++;
+      } else {
+        key = NULL;
+        keylen = 0;
+      }
+      err = value(p, mask == 0 ? 0 :
+                  match(p, mask, depth, key, keylen, index), depth + 1);
+      if(err != JSON_ERROR_OK) {
+        return err;
+      }
+      switch(peek(p)) {
+      case ',':
+        p->pos++;
+        break;
+      case '}':
+        p->pos++;
+        return c == '{' ? JSON_ERROR_OK : JSON_ERROR_SYNTAX;
+      case ']':
+        p->pos++;
+        return c == '[' ? JSON_ERROR_OK : JSON_ERROR_UNEXPECTED_END_OF_ARRAY;
+      default:
+        return JSON_ERROR_SYNTAX;
+      }
+    }
+  }
+
+  p->pos++;
+  switch(c) {
+  case '"':
+    err = string(p, &v);
+    break;
+  case 't':
+    err = literal(p, &v, "rue", JSON_TYPE_TRUE, 1);
+    break;
+  case 'f':
+    err = literal(p, &v, "alse", JSON_TYPE_FALSE, 0);
+    break;
+  case 'n':
+    err = literal(p, &v, "ull", JSON_TYPE_NULL, 0);
+    break;
+  default:
+    p->pos--;
+    err = number(p, &v);
+    break;
+  }
+  if(err != JSON_ERROR_OK) {
+    return err;
+  }
+  if(v.type != JSON_TYPE_STRING && v.type != JSON_TYPE_NUMBER) {
+    /* include the first letter of the literal */
+    v.str--;
+    v.len++;
+  }
+
+  /* only paths that end exactly here get the value */
+  for(i = 0; mask != 0; i++, mask >>= 1) {
+    if((mask & 1) && component(p->paths[i].path, depth, &len) == NULL) {
+      p->matches++;
+      if(p->paths[i].callback != NULL) {
+        p->paths[i].callback(&v, p->paths[i].ptr);
+      }
+    }
+  }
+  return JSON_ERROR_OK;
+}
+/*--------------------------------------------------------------------*/
+int
+jsonsax_parse(const struct jsonsax_path *paths, int npaths,
+              const char *json, int len)
+{
+  struct parser p;
+  uint32_t mask;
+  int err;
+
+  if(npaths > JSONSAX_MAX_PATHS) {
+    npaths = JSONSAX_MAX_PATHS;
+  }
+  mask = npaths == JSONSAX_MAX_PATHS ? 0xffffffff :
+    ((uint32_t)1 << npaths) - 1;
+
+  p.paths = paths;
+  p.json = json;
+  p.pos = 0;
+  p.len = len;
+  p.matches = 0;
+
+  err = value(&p, mask, 0);
+  if(err == JSON_ERROR_OK && peek(&p) != 0) {
+    err = JSON_ERROR_SYNTAX;
+  }
+  return err == JSON_ERROR_OK ? p.matches : -err;
+}
+/*--------------------------------------------------------------------*/
+void
+jsonsax_set_int(const struct jsonsax_value *value, void *ptr)
+{
+  if(value->type != JSON_TYPE_STRING) {
+    *(int *)ptr = (int)value->n;
+  }
+}
+/*--------------------------------------------------------------------*/
+void
+jsonsax_set_long(const struct jsonsax_value *value, void *ptr)
+{
+  if(value->type != JSON_TYPE_STRING) {
+    *(long *)ptr = value->n;
+  }
+}
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A callback-driven JSON parser that matches values against a
+ *         table of key paths while tokenizing.
+ *
+ *         Unlike jsonparse, which leaves each value for the caller to
+ *         copy or convert after the fact, jsonsax decodes numbers and
+ *         booleans while scanning them and only calls back for values
+ *         whose path is listed in the table. Strings are passed as a
+ *         pointer into the input and are never copied.
+ *
+ *         Paths are written as "/cfg/interval". A component "*"
+ *         matches any key or any array element and a decimal component
+ *         matches that array index, as in "/nodes/2/id".
+ */
+
+#ifndef __JSONSAX_H__
+#define __JSONSAX_H__
+
+#include "contiki-conf.h"
+#include "json.h"
+
+#ifdef JSONSAX_CONF_MAX_DEPTH
+#define JSONSAX_MAX_DEPTH JSONSAX_CONF_MAX_DEPTH
+#else
+#define JSONSAX_MAX_DEPTH 10
+#endif
+
+/* One bit per path entry is tracked while parsing */
+#define JSONSAX_MAX_PATHS 32
+
+struct jsonsax_value {
+  /* JSON_TYPE_NUMBER, JSON_TYPE_STRING, JSON_TYPE_TRUE,
+     JSON_TYPE_FALSE or JSON_TYPE_NULL */
+  char type;
+  /* integer part of a number, 1 for true and 0 for false/null */
+  long n;
+  /* raw token in the input; strings without quotes and unescaped */
+  const char *str;
+  int len;
+};
+
+struct jsonsax_path {
+  const char *path;
+  void (* callback)(const struct jsonsax_value *value, void *ptr);
+  void *ptr;
+};
+
+/**
+ * \brief      Parse a JSON text and call back for matching values.
+ * \param paths Table of paths to match
+ * \param npaths Number of entries in the table, at most JSONSAX_MAX_PATHS
+ * \param json The string to parse as JSON
+ * \param len  The length of the string to parse
+ * \return     The number of matched values, or a negative JSON_ERROR_*
+ *
+ *             The whole text is always validated, so a negative
+ *             return value may follow callbacks for values that
+ *             preceded the error.
+ */
+int jsonsax_parse(const struct jsonsax_path *paths, int npaths,
+                  const char *json, int len);
+
+/* stores a number or boolean into the int pointed to by ptr */
+void jsonsax_set_int(const struct jsonsax_value *value, void *ptr);
+
+/* stores a number or boolean into the long pointed to by ptr */
+void jsonsax_set_long(const struct jsonsax_value *value, void *ptr);
+
+#endif /* __JSONSAX_H__ */
@@ -212,6 +212,73 @@ jsontree_print_next(struct jsontree_context *js_ctx)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+/* The chunk that jsontree_print_chunk() is writing. */
+static char *chunk_buf;
+static int32_t chunk_start, chunk_end, chunk_pos;
+
+static int
+chunk_putchar(int c)
+{
+  if(chunk_pos >= chunk_start && chunk_pos < chunk_end) {
+    chunk_buf[chunk_pos - chunk_start] = c;
+  }
+  chunk_pos++;
+  return c;
+}
+/*---------------------------------------------------------------------------*/
+void
+jsontree_chunk_setup(struct jsontree_chunk_state *state,
+                     struct jsontree_value *root)
+{
+  state->root = root;
+  jsontree_setup(&state->ctx, root, chunk_putchar);
+  state->pos = 0;
+  state->done = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+jsontree_print_chunk(struct jsontree_chunk_state *state,
+                     char *buf, int size, int32_t offset)
+{
+  struct jsontree_context step_start;
+  int32_t step_pos;
+
+  if(offset < state->pos || state->done) {
+    /* An earlier part of the output; start over. */
+    jsontree_chunk_setup(state, state->root);
+  }
+
+  chunk_buf = buf;
+  chunk_start = offset;
+  chunk_end = offset + size;
+  chunk_pos = state->pos;
+
+  while(1) {
+    /* Remember the state before each step, in case the step crosses
+       the end of the chunk and has to be repeated for the next one. */
+    memcpy(&step_start, &state->ctx, sizeof(step_start));
+    step_pos = chunk_pos;
+
+    if(!jsontree_print_next(&state->ctx) ||
+       state->ctx.path > state->ctx.depth) {
+      if(chunk_pos <= chunk_end) {
+        state->done = 1;
+        state->pos = chunk_pos;
+        return chunk_pos > chunk_start ? chunk_pos - chunk_start : 0;
+      }
+    }
+    if(chunk_pos > chunk_end) {
+      memcpy(&state->ctx, &step_start, sizeof(step_start));
+      state->pos = step_pos;
+      return size;
+    }
+    if(chunk_pos == chunk_end) {
+      state->pos = chunk_pos;
+      return size;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 static struct jsontree_value *
 find_next(struct jsontree_context *js_ctx)
 {
@@ -132,4 +132,29 @@ int jsontree_print_next(struct jsontree_context *js_ctx);
 struct jsontree_value *jsontree_find_next(struct jsontree_context *js_ctx,
                                           int type);
 
+/*
+ * Output of a tree in chunks, such as CoAP Block2 payloads. The state
+ * is kept between chunks so that each chunk continues where the
+ * previous one ended, instead of printing the tree from the start and
+ * discarding everything before the requested offset. Only the one
+ * print step that crosses a chunk boundary is repeated. Callbacks
+ * must give the same output when a step is repeated.
+ */
+struct jsontree_chunk_state {
+  struct jsontree_value *root;
+  struct jsontree_context ctx;  /* State at output offset pos */
+  int32_t pos;
+  uint8_t done;
+};
+
+void jsontree_chunk_setup(struct jsontree_chunk_state *state,
+                          struct jsontree_value *root);
+/*
+ * Write the output from offset into buf, at most size bytes.
+ * Returns the number of bytes written. state->done is set when
+ * the end of the output is within this chunk.
+ */
+int jsontree_print_chunk(struct jsontree_chunk_state *state,
+                         char *buf, int size, int32_t offset);
+
 #endif /* __JSONTREE_H__ */
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Periodic export of the metrics registry over UDP
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/simple-udp.h"
+#include "sys/metrics.h"
+
+#include "metrics-export.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef METRICS_EXPORT_CONF_DATAGRAM_SIZE
+#define DATAGRAM_SIZE METRICS_EXPORT_CONF_DATAGRAM_SIZE
+#else /* METRICS_EXPORT_CONF_DATAGRAM_SIZE */
+#define DATAGRAM_SIZE 100
+#endif /* METRICS_EXPORT_CONF_DATAGRAM_SIZE */
+
+#ifdef METRICS_EXPORT_CONF_LOCAL_PORT
+#define LOCAL_PORT METRICS_EXPORT_CONF_LOCAL_PORT
+#else /* METRICS_EXPORT_CONF_LOCAL_PORT */
+#define LOCAL_PORT 4711
+#endif /* METRICS_EXPORT_CONF_LOCAL_PORT */
+
+#define LINE_SIZE 80
+
+static struct simple_udp_connection conn;
+static uip_ipaddr_t collector;
+static uint16_t collector_port;
+static clock_time_t export_interval;
+static uint16_t seqno;
+
+static char datagram[DATAGRAM_SIZE];
+static int datagram_len;
+
+PROCESS(metrics_export_process, "Metrics export");
+/*---------------------------------------------------------------------------*/
+static void
+flush(void)
+{
+  if(datagram_len > 0) {
+    simple_udp_sendto_port(&conn, datagram, datagram_len,
+                           &collector, collector_port);
+  }
+  datagram_len = snprintf(datagram, sizeof(datagram), "%u\n", seqno);
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_line(const char *line, int len)
+{
+  if(len >= LINE_SIZE) {
+    /* Truncated by snprintf(). */
+    len = LINE_SIZE - 1;
+  }
+  if(datagram_len + len + 1 > sizeof(datagram)) {
+    flush();
+    if(datagram_len + len + 1 > sizeof(datagram)) {
+      len = sizeof(datagram) - datagram_len - 1;
+    }
+  }
+  memcpy(&datagram[datagram_len], line, len);
+  datagram_len += len;
+  datagram[datagram_len++] = '\n';
+}
+/*---------------------------------------------------------------------------*/
+static void
+export(void)
+{
+  char line[LINE_SIZE];
+  struct metrics_counter *c;
+  struct metrics_histogram *h;
+
+  datagram_len = 0;
+  flush();
+  for(c = metrics_counters(); c != NULL; c = c->next) {
+    add_line(line, metrics_snprint_counter(line, sizeof(line), c));
+  }
+  for(h = metrics_histograms(); h != NULL; h = h->next) {
+    add_line(line, metrics_snprint_histogram(line, sizeof(line), h));
+  }
+  flush();
+  seqno++;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(metrics_export_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  if(conn.udp_conn == NULL) {
+    simple_udp_register(&conn, LOCAL_PORT, NULL, 0, NULL);
+  }
+
+  while(1) {
+    etimer_set(&et, export_interval);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    export();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+metrics_export_start(const uip_ipaddr_t *addr, uint16_t port,
+                     clock_time_t interval)
+{
+  uip_ipaddr_copy(&collector, addr);
+  collector_port = port;
+  export_interval = interval;
+  process_exit(&metrics_export_process);
+  process_start(&metrics_export_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+metrics_export_stop(void)
+{
+  process_exit(&metrics_export_process);
+}
+/*---------------------------------------------------------------------------*/
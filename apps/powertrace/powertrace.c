@@ -46,6 +46,12 @@
 #include <stdio.h>
 #include <string.h>
 
+#ifdef POWERTRACE_CONF_BINARY
+#define POWERTRACE_BINARY POWERTRACE_CONF_BINARY
+#else
+#define POWERTRACE_BINARY 0
+#endif
+
 struct powertrace_sniff_stats {
   struct powertrace_sniff_stats *next;
   uint32_t num_input, num_output;
@@ -57,6 +63,7 @@ struct powertrace_sniff_stats {
   uint16_t channel;
   uint32_t last_input_txtime, last_input_rxtime;
   uint32_t last_output_txtime, last_output_rxtime;
+  uint32_t last_num_input, last_num_output;
 };
 
 #define INPUT  1
@@ -67,6 +74,34 @@ struct powertrace_sniff_stats {
 MEMB(stats_memb, struct powertrace_sniff_stats, MAX_NUM_STATS);
 LIST(stats_list);
 
+/* Radio time attributed to each neighbor by the RDC layer. */
+struct powertrace_neighbor_stats {
+  struct powertrace_neighbor_stats *next;
+  rimeaddr_t addr;
+  uint32_t num_packets, txtime, rxtime;
+  uint32_t last_num_packets, last_txtime, last_rxtime;
+};
+
+#define MAX_NUM_NEIGHBORS 8
+
+MEMB(neighbor_memb, struct powertrace_neighbor_stats, MAX_NUM_NEIGHBORS);
+LIST(neighbor_list);
+
+/* Binary records are written to the serial line as SLIP frames, so
+   that they can be told apart from ordinary printf output. */
+#define FRAME_END     0300
+#define FRAME_ESC     0333
+#define FRAME_ESC_END 0334
+#define FRAME_ESC_ESC 0335
+
+#define RECORD_MAX_SIZE 40
+
+static void serial_output(const uint8_t *record, int len);
+
+static powertrace_output_t output = serial_output;
+static uint8_t record[RECORD_MAX_SIZE];
+static uint8_t *recordptr;
+
 PROCESS(powertrace_process, "Periodic power output");
 /*---------------------------------------------------------------------------*/
 void
@@ -85,6 +120,7 @@ powertrace_print(char *str)
   uint32_t time, all_time, radio, all_radio;
   
   struct powertrace_sniff_stats *s;
+  struct powertrace_neighbor_stats *n;
 
   energest_flush();
 
@@ -188,6 +224,155 @@ powertrace_print(char *str)
     s->last_output_rxtime = s->output_rxtime;
     
   }
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    printf("%s %lu NP %d.%d %lu %d.%d %lu %lu %lu\n",
+           str, clock_time(), rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1], seqno,
+           n->addr.u8[0], n->addr.u8[1],
+           n->num_packets, n->txtime, n->rxtime);
+  }
+  seqno++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+serial_output(const uint8_t *record, int len)
+{
+  int i;
+
+  putchar(FRAME_END);
+  for(i = 0; i < len; i++) {
+    if(record[i] == FRAME_END) {
+      putchar(FRAME_ESC);
+      putchar(FRAME_ESC_END);
+    } else if(record[i] == FRAME_ESC) {
+      putchar(FRAME_ESC);
+      putchar(FRAME_ESC_ESC);
+    } else {
+      putchar(record[i]);
+    }
+  }
+  putchar(FRAME_END);
+}
+/*---------------------------------------------------------------------------*/
+static void
+put8(uint8_t v)
+{
+  *recordptr++ = v;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put16(uint16_t v)
+{
+  put8(v >> 8);
+  put8(v);
+}
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint32_t v)
+{
+  put16(v >> 16);
+  put16(v);
+}
+/*---------------------------------------------------------------------------*/
+static void
+begin_record(uint8_t type, uint16_t seqno)
+{
+  recordptr = record;
+  put8(POWERTRACE_RECORD_VERSION);
+  put8(type);
+  put8(rimeaddr_node_addr.u8[0]);
+  put8(rimeaddr_node_addr.u8[1]);
+  put16(seqno);
+}
+/*---------------------------------------------------------------------------*/
+static void
+end_record(void)
+{
+  if(output != NULL) {
+    output(record, recordptr - record);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+powertrace_set_output(powertrace_output_t f)
+{
+  output = f;
+}
+/*---------------------------------------------------------------------------*/
+void
+powertrace_binary(void)
+{
+  static uint32_t last_cpu, last_lpm, last_transmit, last_listen;
+  static uint32_t last_idle_transmit, last_idle_listen;
+  static uint16_t seqno;
+  uint32_t v;
+
+  struct powertrace_sniff_stats *s;
+  struct powertrace_neighbor_stats *n;
+
+  energest_flush();
+
+  /* Only the counter increments since the previous report are sent;
+     the host-side decoder adds them up to reconstruct the totals. */
+  begin_record(POWERTRACE_RECORD_POWER, seqno);
+  put32(clock_time());
+  v = energest_type_time(ENERGEST_TYPE_CPU);
+  put32(v - last_cpu);
+  last_cpu = v;
+  v = energest_type_time(ENERGEST_TYPE_LPM);
+  put32(v - last_lpm);
+  last_lpm = v;
+  v = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  put32(v - last_transmit);
+  last_transmit = v;
+  v = energest_type_time(ENERGEST_TYPE_LISTEN);
+  put32(v - last_listen);
+  last_listen = v;
+  v = compower_idle_activity.transmit;
+  put32(v - last_idle_transmit);
+  last_idle_transmit = v;
+  v = compower_idle_activity.listen;
+  put32(v - last_idle_listen);
+  last_idle_listen = v;
+  end_record();
+
+  for(s = list_head(stats_list); s != NULL; s = list_item_next(s)) {
+    begin_record(POWERTRACE_RECORD_CHANNEL, seqno);
+    put16(s->channel);
+#if UIP_CONF_IPV6
+    put16(s->proto);
+#else
+    put16(0);
+#endif
+    put16(s->num_input - s->last_num_input);
+    put32(s->input_txtime - s->last_input_txtime);
+    put32(s->input_rxtime - s->last_input_rxtime);
+    put16(s->num_output - s->last_num_output);
+    put32(s->output_txtime - s->last_output_txtime);
+    put32(s->output_rxtime - s->last_output_rxtime);
+    end_record();
+
+    s->last_num_input = s->num_input;
+    s->last_input_txtime = s->input_txtime;
+    s->last_input_rxtime = s->input_rxtime;
+    s->last_num_output = s->num_output;
+    s->last_output_txtime = s->output_txtime;
+    s->last_output_rxtime = s->output_rxtime;
+  }
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    begin_record(POWERTRACE_RECORD_NEIGHBOR, seqno);
+    put8(n->addr.u8[0]);
+    put8(n->addr.u8[1]);
+    put16(n->num_packets - n->last_num_packets);
+    put32(n->txtime - n->last_txtime);
+    put32(n->rxtime - n->last_rxtime);
+    end_record();
+
+    n->last_num_packets = n->num_packets;
+    n->last_txtime = n->txtime;
+    n->last_rxtime = n->rxtime;
+  }
   seqno++;
 }
 /*---------------------------------------------------------------------------*/
@@ -207,7 +392,11 @@ PROCESS_THREAD(powertrace_process, ev, data)
   while(1) {
     PROCESS_WAIT_UNTIL(etimer_expired(&periodic));
     etimer_reset(&periodic);
+#if POWERTRACE_BINARY
+    powertrace_binary();
+#else
     powertrace_print("");
+#endif
   }
 
   PROCESS_END();
@@ -349,6 +538,31 @@ powertrace_printsniff(powertrace_onoff_t onoff)
 }
 #endif
 /*---------------------------------------------------------------------------*/
+static void
+neighbor_activity(const rimeaddr_t *neighbor, uint32_t transmit,
+                  uint32_t listen)
+{
+  struct powertrace_neighbor_stats *n;
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(rimeaddr_cmp(&n->addr, neighbor)) {
+      break;
+    }
+  }
+  if(n == NULL) {
+    n = memb_alloc(&neighbor_memb);
+    if(n == NULL) {
+      return;
+    }
+    memset(n, 0, sizeof(struct powertrace_neighbor_stats));
+    rimeaddr_copy(&n->addr, neighbor);
+    list_add(neighbor_list, n);
+  }
+  n->num_packets++;
+  n->txtime += transmit;
+  n->rxtime += listen;
+}
+/*---------------------------------------------------------------------------*/
 RIME_SNIFFER(powersniff, input_sniffer, output_sniffer);
 /*---------------------------------------------------------------------------*/
 void
@@ -357,9 +571,11 @@ powertrace_sniff(powertrace_onoff_t onoff)
   switch(onoff) {
   case POWERTRACE_ON:
     rime_sniffer_add(&powersniff);
+    compower_set_neighbor_callback(neighbor_activity);
     break;
   case POWERTRACE_OFF:
     rime_sniffer_remove(&powersniff);
+    compower_set_neighbor_callback(NULL);
     break;
   }
 }
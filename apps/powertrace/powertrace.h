@@ -54,4 +54,36 @@ void powertrace_sniff(powertrace_onoff_t onoff);
 
 void powertrace_print(char *str);
 
+/*
+ * Binary power records. Each call to powertrace_binary() produces one
+ * power record followed by one record per channel and per neighbor.
+ * All fields are big-endian and all counters are the increments since
+ * the previous report, so a lost record can be detected through the
+ * sequence number. Every record starts with the same header:
+ *
+ *   version (1), type (1), node address (2), sequence number (2)
+ *
+ * followed by, depending on the type:
+ *
+ *   'P': clock time (4), cpu, lpm, transmit, listen,
+ *        idle transmit, idle listen (4 each)
+ *   'C': channel (2), protocol (2), packets in (2), in transmit (4),
+ *        in listen (4), packets out (2), out transmit (4), out listen (4)
+ *   'N': neighbor address (2), packets (2), transmit (4), listen (4)
+ *
+ * By default records are written to the serial line as SLIP frames;
+ * tools/powertrace/decode-binary-power turns them back into the text
+ * format of powertrace_print(). Setting POWERTRACE_CONF_BINARY makes
+ * powertrace_start() report in binary instead of with printf.
+ */
+#define POWERTRACE_RECORD_VERSION  1
+#define POWERTRACE_RECORD_POWER    'P'
+#define POWERTRACE_RECORD_CHANNEL  'C'
+#define POWERTRACE_RECORD_NEIGHBOR 'N'
+
+typedef void (* powertrace_output_t)(const uint8_t *record, int len);
+
+void powertrace_binary(void);
+void powertrace_set_output(powertrace_output_t output);
+
 #endif /* POWERTRACE_H */
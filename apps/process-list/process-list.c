@@ -49,6 +49,14 @@ static struct ctk_window processwindow;
 static struct {struct process *p; char id[2];} processes[MAX_PROCESSLABELS];
 static struct ctk_label processidlabels[MAX_PROCESSLABELS];
 static struct ctk_label processnamelabels[MAX_PROCESSLABELS];
+#if PROCESS_CONF_ACCOUNTING
+/* Each process' share of the CPU time spent in processes. */
+#define NAME_WIDTH 18
+static char processcpu[MAX_PROCESSLABELS][4];
+static struct ctk_label processcpulabels[MAX_PROCESSLABELS];
+#else /* PROCESS_CONF_ACCOUNTING */
+#define NAME_WIDTH 22
+#endif /* PROCESS_CONF_ACCOUNTING */
 
 static struct ctk_label killlabel =
   {CTK_LABEL(0, PROCESSLIST_HEIGHT - 2, 12, 1, "Kill process")};
@@ -77,6 +85,14 @@ update_processwindow(void)
   unsigned char i;
   struct process *p;
   char *idptr;
+#if PROCESS_CONF_ACCOUNTING
+  unsigned long total, share;
+
+  total = 0;
+  for(p = PROCESS_LIST(); p != NULL; p = p->next) {
+    total += p->acct.ticks;
+  }
+#endif /* PROCESS_CONF_ACCOUNTING */
 
   i = 0;
   for(p = PROCESS_LIST(); p != NULL && i < MAX_PROCESSLABELS; p = p->next) {
@@ -89,9 +105,23 @@ update_processwindow(void)
     CTK_WIDGET_ADD(&processwindow, &processidlabels[i]);
     
     CTK_LABEL_NEW(&processnamelabels[i],
-		  4, i + 1, 22, 1, PROCESS_NAME_STRING(p));
+		  4, i + 1, NAME_WIDTH, 1, PROCESS_NAME_STRING(p));
     CTK_WIDGET_ADD(&processwindow, &processnamelabels[i]);
 
+#if PROCESS_CONF_ACCOUNTING
+    share = total == 0 ? 0 : p->acct.ticks / (total / 100 + 1);
+    if(share > 99) {
+      share = 99;
+    }
+    processcpu[i][0] = share >= 10 ? '0' + share / 10 : ' ';
+    processcpu[i][1] = '0' + share % 10;
+    processcpu[i][2] = '%';
+    processcpu[i][3] = 0;
+    CTK_LABEL_NEW(&processcpulabels[i],
+		  4 + NAME_WIDTH + 1, i + 1, 3, 1, processcpu[i]);
+    CTK_WIDGET_ADD(&processwindow, &processcpulabels[i]);
+#endif /* PROCESS_CONF_ACCOUNTING */
+
     ++i;
   }
 
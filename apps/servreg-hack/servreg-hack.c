@@ -51,24 +51,51 @@
 #include "servreg-hack.h"
 
 #include <stdio.h>
+#include <string.h>
 
 struct servreg_hack_registration {
   struct servreg_hack_registration *next;
 
   struct timer timer;
   uip_ipaddr_t addr;
+  clock_time_t rtt;
   servreg_hack_id_t id;
   uint8_t seqno;
+  uint8_t hops;
+  uint8_t flags;
 };
 
+/* Set on a learned registration when a neighbor has already
+   announced it at least as well as we would during this period. */
+#define FLAG_SUPPRESSED 0x01
 
 #define MAX_REGISTRATIONS 16
 
+/* Lookups are served from a small direct-mapped cache indexed by the
+   service ID. Must be a power of two. */
+#ifdef SERVREG_HACK_CONF_CACHE_SIZE
+#define CACHE_SIZE SERVREG_HACK_CONF_CACHE_SIZE
+#else /* SERVREG_HACK_CONF_CACHE_SIZE */
+#define CACHE_SIZE 4
+#endif /* SERVREG_HACK_CONF_CACHE_SIZE */
+
+/* Registrations that are further away than this are not relayed. */
+#ifdef SERVREG_HACK_CONF_MAX_HOPS
+#define MAX_HOPS SERVREG_HACK_CONF_MAX_HOPS
+#else /* SERVREG_HACK_CONF_MAX_HOPS */
+#define MAX_HOPS 8
+#endif /* SERVREG_HACK_CONF_MAX_HOPS */
+
 LIST(others_services);
 LIST(own_services);
 
 MEMB(registrations, struct servreg_hack_registration, MAX_REGISTRATIONS);
 
+static struct {
+  struct servreg_hack_registration *reg;
+  servreg_hack_id_t id;
+} cache[CACHE_SIZE];
+
 PROCESS(servreg_hack_process, "Service regstry hack");
 
 #define PERIOD_TIME 120 * CLOCK_SECOND
@@ -87,13 +114,19 @@ static struct etimer sendtimer;
 
 static uint8_t started = 0;
 
+/*---------------------------------------------------------------------------*/
+static void
+invalidate_cache(void)
+{
+  memset(cache, 0, sizeof(cache));
+}
 /*---------------------------------------------------------------------------*/
 /* Go through the list of registrations and remove those that are too
    old. */
 static void
 purge_registrations(void)
 {
-  struct servreg_hack_registration *t;
+  struct servreg_hack_registration *t, *next;
 
   for(t = list_head(own_services);
       t != NULL;
@@ -106,13 +139,42 @@ purge_registrations(void)
 
   for(t = list_head(others_services);
       t != NULL;
-      t = list_item_next(t)) {
+      t = next) {
+    next = list_item_next(t);
     if(timer_expired(&t->timer)) {
       list_remove(others_services, t);
       memb_free(&registrations, t);
-      t = list_head(others_services);
+      invalidate_cache();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns non-zero if registration a is a better choice than b: fewer
+   hops first, then the lower measured round-trip time. */
+static int
+lower_cost(struct servreg_hack_registration *a,
+           struct servreg_hack_registration *b)
+{
+  if(a->hops != b->hops) {
+    return a->hops < b->hops;
+  }
+  if(a->rtt != 0 && (b->rtt == 0 || a->rtt < b->rtt)) {
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static struct servreg_hack_registration *
+find_registration(list_t list, servreg_hack_id_t id, const uip_ipaddr_t *addr)
+{
+  struct servreg_hack_registration *t;
+
+  for(t = list_head(list); t != NULL; t = list_item_next(t)) {
+    if(t->id == id && uip_ipaddr_cmp(&t->addr, addr)) {
+      return t;
     }
   }
+  return NULL;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -122,6 +184,7 @@ servreg_hack_init(void)
     list_init(others_services);
     list_init(own_services);
     memb_init(&registrations);
+    invalidate_cache();
 
     process_start(&servreg_hack_process, NULL);
     started = 1;
@@ -155,6 +218,9 @@ servreg_hack_register(servreg_hack_id_t id, const uip_ipaddr_t *addr)
   }
   r->id = id;
   r->seqno = 1;
+  r->hops = 0;
+  r->rtt = 0;
+  r->flags = 0;
   uip_ipaddr_copy(&r->addr, addr);
   timer_set(&r->timer, LIFETIME / 2);
   list_push(own_services, r);
@@ -185,70 +251,147 @@ servreg_hack_item_address(servreg_hack_item_t *item)
   return &((struct servreg_hack_registration *)item)->addr;
 }
 /*---------------------------------------------------------------------------*/
+uint8_t
+servreg_hack_item_hops(servreg_hack_item_t *item)
+{
+  return ((struct servreg_hack_registration *)item)->hops;
+}
+/*---------------------------------------------------------------------------*/
+void
+servreg_hack_set_rtt(servreg_hack_id_t id, const uip_ipaddr_t *addr,
+                     clock_time_t rtt)
+{
+  struct servreg_hack_registration *r;
+
+  r = find_registration(others_services, id, addr);
+  if(r != NULL) {
+    /* Zero means that no measurement is available. */
+    r->rtt = rtt == 0 ? 1 : rtt;
+    invalidate_cache();
+  }
+}
+/*---------------------------------------------------------------------------*/
 uip_ipaddr_t *
 servreg_hack_lookup(servreg_hack_id_t id)
 {
-  servreg_hack_item_t *t;
+  struct servreg_hack_registration *t, *best;
+  int i;
 
   servreg_hack_init();
 
+  i = id & (CACHE_SIZE - 1);
+  if(cache[i].reg != NULL && cache[i].id == id &&
+     !timer_expired(&cache[i].reg->timer)) {
+    return &cache[i].reg->addr;
+  }
+
   purge_registrations();
 
-  for(t = servreg_hack_list_head(); t != NULL; t = list_item_next(t)) {
-    if(servreg_hack_item_id(t) == id) {
-      return servreg_hack_item_address(t);
+  best = NULL;
+  for(t = list_head(others_services); t != NULL; t = list_item_next(t)) {
+    if(t->id == id && (best == NULL || lower_cost(t, best))) {
+      best = t;
     }
   }
-  return NULL;
+  if(best == NULL) {
+    return NULL;
+  }
+  cache[i].reg = best;
+  cache[i].id = id;
+  return &best->addr;
+}
+/*---------------------------------------------------------------------------*/
+static struct servreg_hack_registration *
+reclaim_registration(uint8_t hops)
+{
+  struct servreg_hack_registration *t, *worst;
+
+  /* Give up the most distant registration learned from others, if it
+     is further away than the one we want to store. */
+  worst = NULL;
+  for(t = list_head(others_services); t != NULL; t = list_item_next(t)) {
+    if(worst == NULL || t->hops >= worst->hops) {
+      worst = t;
+    }
+  }
+  if(worst == NULL || worst->hops <= hops) {
+    return NULL;
+  }
+  list_remove(others_services, worst);
+  return worst;
 }
 /*---------------------------------------------------------------------------*/
 static void
-handle_incoming_reg(const uip_ipaddr_t *owner, servreg_hack_id_t id, uint8_t seqno)
+handle_incoming_reg(const uip_ipaddr_t *owner, servreg_hack_id_t id,
+                    uint8_t seqno, uint8_t hops)
 {
-  servreg_hack_item_t *t;
   struct servreg_hack_registration *r;
 
-  /* Walk through list, see if we already have a service ID
-     registered. If so, we do different things depending on the seqno
-     of the update: if the seqno is older than what we have, we
-     discard the incoming registration. If the seqno is newer than
+  /* Registrations for services that we provide ourselves are echoes
+     of our own announcements. */
+  if(find_registration(own_services, id, owner) != NULL) {
+    return;
+  }
+
+  /* Walk through list, see if we already have this provider of the
+     service ID registered. If so, we do different things depending on
+     the seqno of the update: if the seqno is older than what we have,
+     we discard the incoming registration. If the seqno is newer than
      what we have, we reset the lifetime timer of the current
-     registration.
+     registration and take the hop count of the update. An update with
+     the same seqno may still tell us about a shorter path.
 
-     If we did not have the service registered already, we allocate a
-     new registration and put it on our list. If we cannot allocate a
-     service registration, we discard the incoming registration (for
-     now - we might later choose to discard the oldest registration
-     that we have). */
+     If a neighbor relayed the registration with the same hop count
+     as we would, it has already covered our part of the network and
+     there is no need for us to relay it during this period.
 
-  for(t = servreg_hack_list_head();
-      t != NULL;
-      t = list_item_next(t)) {
-    if(servreg_hack_item_id(t) == id) {
-      r = t;
-      if(SEQNO_LT(r->seqno, seqno)) {
-        r->seqno = seqno;
-        timer_set(&r->timer, LIFETIME);
-
-        /* Put item first on list, so that subsequent lookups will
-           find this one. */
-        list_remove(others_services, r);
-        list_push(others_services, r);
+     If we did not have the provider registered already, we allocate a
+     new registration and put it on our list. If we cannot allocate a
+     service registration, we reclaim the most distant registration
+     that we have, provided that it is further away than the incoming
+     one. */
+
+  r = find_registration(others_services, id, owner);
+  if(r != NULL) {
+    if(SEQNO_LT(r->seqno, seqno)) {
+      r->seqno = seqno;
+      r->hops = hops;
+      r->flags = 0;
+      timer_set(&r->timer, LIFETIME);
+
+      /* Put item first on list, so that subsequent lookups will
+         find this one. */
+      list_remove(others_services, r);
+      list_push(others_services, r);
+      invalidate_cache();
+    } else if(r->seqno == seqno) {
+      if(hops < r->hops) {
+        r->hops = hops;
+        invalidate_cache();
+      }
+      if(hops == r->hops + 1) {
+        r->flags |= FLAG_SUPPRESSED;
       }
-      return;
     }
+    return;
   }
 
   r = memb_alloc(&registrations);
   if(r == NULL) {
-    printf("servreg_hack_register: error, could not allocate memory, should reclaim another registration but this has not been implemented yet.\n");
-    return;
+    r = reclaim_registration(hops);
+    if(r == NULL) {
+      return;
+    }
   }
   r->id = id;
-  r->seqno = 1;
+  r->seqno = seqno;
+  r->hops = hops;
+  r->rtt = 0;
+  r->flags = 0;
   uip_ipaddr_copy(&r->addr, owner);
   timer_set(&r->timer, LIFETIME);
   list_add(others_services, r);
+  invalidate_cache();
 }
 /*---------------------------------------------------------------------------*/
 /*
@@ -256,13 +399,16 @@ handle_incoming_reg(const uip_ipaddr_t *owner, servreg_hack_id_t id, uint8_t seq
  *
  *  +-------------------+-------------------+
  *  |  Numregs (1 byte) |   Flags (1 byte)  |
- *  +-------------------+-------------------+-------------------+
- *  | IP addr (16 bytes)| 3 regs (3 bytes)  |  Seqno (1 byte)   |
- *  +-------------------+-------------------+-------------------+
- *  | IP addr (16 bytes)| 3 regs (3 bytes)  |  Seqno (1 byte)   |
- *  +-------------------+-------------------+-------------------+
- *  |        ...        |       ...         |       ...         |
- *  +-------------------+-------------------+-------------------+
+ *  +-------------------+-------------------+-------------------+-------------------+-------------------+
+ *  | IP addr (16 bytes)|    ID (1 byte)    |   Hops (1 byte)   | Reserved (1 byte) |  Seqno (1 byte)   |
+ *  +-------------------+-------------------+-------------------+-------------------+-------------------+
+ *  | IP addr (16 bytes)|    ID (1 byte)    |   Hops (1 byte)   | Reserved (1 byte) |  Seqno (1 byte)   |
+ *  +-------------------+-------------------+-------------------+-------------------+-------------------+
+ *  |        ...        |       ...         |       ...         |       ...         |       ...         |
+ *  +-------------------+-------------------+-------------------+-------------------+-------------------+
+ *
+ * The hop count is the number of hops between the sender and the node
+ * that provides the service, zero for the sender's own services.
  */
 
 #define MSG_NUMREGS_OFFSET   0
@@ -271,10 +417,24 @@ handle_incoming_reg(const uip_ipaddr_t *owner, servreg_hack_id_t id, uint8_t seq
 
 #define MSG_IPADDR_SUBOFFSET 0
 #define MSG_REGS_SUBOFFSET   16
+#define MSG_HOPS_SUBOFFSET   17
 #define MSG_SEQNO_SUBOFFSET  19
 
 #define MSG_ADDRS_LEN        20
 
+/*---------------------------------------------------------------------------*/
+static int
+add_reg(uint8_t *buf, int bufptr, struct servreg_hack_registration *r)
+{
+  uip_ipaddr_copy((uip_ipaddr_t *)&buf[bufptr + MSG_IPADDR_SUBOFFSET],
+                  &r->addr);
+  buf[bufptr + MSG_REGS_SUBOFFSET] = r->id;
+  buf[bufptr + MSG_HOPS_SUBOFFSET] = r->hops;
+  buf[bufptr + MSG_REGS_SUBOFFSET + 2] = 0;
+  buf[bufptr + MSG_SEQNO_SUBOFFSET] = r->seqno;
+
+  return bufptr + MSG_ADDRS_LEN;
+}
 /*---------------------------------------------------------------------------*/
 static void
 send_udp_packet(struct uip_udp_conn *conn)
@@ -282,7 +442,7 @@ send_udp_packet(struct uip_udp_conn *conn)
   int numregs;
   uint8_t buf[MAX_BUFSIZE];
   int bufptr;
-  servreg_hack_item_t *t;
+  struct servreg_hack_registration *t;
 
   buf[MSG_FLAGS_OFFSET]   = 0;
 
@@ -292,31 +452,20 @@ send_udp_packet(struct uip_udp_conn *conn)
   for(t = list_head(own_services);
       (bufptr + MSG_ADDRS_LEN <= MAX_BUFSIZE) && t != NULL;
       t = list_item_next(t)) {
-
-    uip_ipaddr_copy((uip_ipaddr_t *)&buf[bufptr + MSG_IPADDR_SUBOFFSET],
-                    servreg_hack_item_address(t));
-    buf[bufptr + MSG_REGS_SUBOFFSET] =
-      servreg_hack_item_id(t);
-    buf[bufptr + MSG_REGS_SUBOFFSET + 1] =
-      buf[bufptr + MSG_REGS_SUBOFFSET + 2] = 0;
-    buf[bufptr + MSG_SEQNO_SUBOFFSET] = ((struct servreg_hack_registration *)t)->seqno;
-
-    bufptr += MSG_ADDRS_LEN;
+    bufptr = add_reg(buf, bufptr, t);
     ++numregs;
   }
 
+  /* Relay the registrations learned from others, except those that a
+     neighbor already has announced and those that are too far away
+     to be of use. */
   for(t = servreg_hack_list_head();
       (bufptr + MSG_ADDRS_LEN <= MAX_BUFSIZE) && t != NULL;
       t = list_item_next(t)) {
-    uip_ipaddr_copy((uip_ipaddr_t *)&buf[bufptr + MSG_IPADDR_SUBOFFSET],
-                    servreg_hack_item_address(t));
-    buf[bufptr + MSG_REGS_SUBOFFSET] =
-      servreg_hack_item_id(t);
-    buf[bufptr + MSG_REGS_SUBOFFSET + 1] =
-      buf[bufptr + MSG_REGS_SUBOFFSET + 2] = 0;
-    buf[bufptr + MSG_SEQNO_SUBOFFSET] = ((struct servreg_hack_registration *)t)->seqno;
-
-    bufptr += MSG_ADDRS_LEN;
+    if((t->flags & FLAG_SUPPRESSED) || t->hops >= MAX_HOPS) {
+      continue;
+    }
+    bufptr = add_reg(buf, bufptr, t);
     ++numregs;
   }
   /*  printf("send_udp_packet numregs %d\n", numregs);*/
@@ -335,6 +484,11 @@ parse_incoming_packet(const uint8_t *buf, int len)
   int flags;
   int i;
   int bufptr;
+  uint8_t hops;
+
+  if(len < MSG_ADDRS_OFFSET) {
+    return;
+  }
 
   numregs = buf[MSG_NUMREGS_OFFSET];
   flags   = buf[MSG_FLAGS_OFFSET];
@@ -342,10 +496,28 @@ parse_incoming_packet(const uint8_t *buf, int len)
   /*  printf("parse_incoming_packet Numregs %d flags %d\n", numregs, flags);*/
 
   bufptr = MSG_ADDRS_OFFSET;
-  for(i = 0; i < numregs; ++i) {
+  for(i = 0; i < numregs && bufptr + MSG_ADDRS_LEN <= len; ++i) {
+    /* The registration is one hop further away from us than it was
+       from the sender. */
+    hops = buf[bufptr + MSG_HOPS_SUBOFFSET];
+    if(hops < 0xff) {
+      hops++;
+    }
     handle_incoming_reg((uip_ipaddr_t *)&buf[bufptr + MSG_IPADDR_SUBOFFSET],
                         buf[bufptr + MSG_REGS_SUBOFFSET],
-                        buf[bufptr + MSG_SEQNO_SUBOFFSET]);
+                        buf[bufptr + MSG_SEQNO_SUBOFFSET],
+                        hops);
+    bufptr += MSG_ADDRS_LEN;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+clear_suppression(void)
+{
+  struct servreg_hack_registration *t;
+
+  for(t = list_head(others_services); t != NULL; t = list_item_next(t)) {
+    t->flags &= ~FLAG_SUPPRESSED;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -369,6 +541,7 @@ PROCESS_THREAD(servreg_hack_process, ev, data)
     PROCESS_WAIT_EVENT();
     if(ev == PROCESS_EVENT_TIMER && data == &periodic) {
       etimer_reset(&periodic);
+      clear_suppression();
       etimer_set(&sendtimer, random_rand() % (PERIOD_TIME));
     } else if(ev == PROCESS_EVENT_TIMER && data == &sendtimer) {
       send_udp_packet(outconn);
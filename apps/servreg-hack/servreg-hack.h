@@ -103,7 +103,9 @@ void servreg_hack_register(servreg_hack_id_t service_id, const uip_ipaddr_t *add
  *             a specific service. If the service is not known, the
  *             function returns NULL. If there are more than one nodes
  *             offering the service, this function returns the address
- *             of the node that most recently announced its service.
+ *             of the node that is the fewest hops away, using the
+ *             round-trip time reported with servreg_hack_set_rtt()
+ *             to choose between nodes at the same distance.
  *
  *             To get a list of all nodes offering a specific service,
  *             use the servreg_hack_list_head() function to get the
@@ -143,6 +145,27 @@ servreg_hack_id_t servreg_hack_item_id(servreg_hack_item_t *item);
  */
 uip_ipaddr_t * servreg_hack_item_address(servreg_hack_item_t *item);
 
+/**
+ * \brief      Get the hop count for a list item
+ * \param item The list item
+ * \return     The number of hops to the node offering the service
+ *             This function is used when iterating through the list
+ *             of registered services.
+ */
+uint8_t servreg_hack_item_hops(servreg_hack_item_t *item);
+
+/**
+ * \brief      Report the round-trip time to a node offering a service
+ * \param service_id The service ID of the service
+ * \param addr The address of the node offering the service
+ * \param rtt The measured round-trip time
+ *             This function lets an application that measures the
+ *             round-trip time to a service provider feed it back into
+ *             the provider selection of servreg_hack_lookup().
+ */
+void servreg_hack_set_rtt(servreg_hack_id_t service_id,
+                          const uip_ipaddr_t *addr, clock_time_t rtt);
+
 #endif /* SERVREG_HACK_H */
 
 
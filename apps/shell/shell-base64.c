@@ -114,31 +114,62 @@ base64_add_char(struct base64_decoder_state *s, char c)
   return 1;
 }
 /*---------------------------------------------------------------------------*/
+static struct base64_decoder_state s;
+/*---------------------------------------------------------------------------*/
+static void
+dec64_flush(void)
+{
+  int len;
+
+  /* Padding characters only belong to the decoded data once their
+     group of four characters is complete. */
+  len = s.dataptr;
+  if(s.sextets == 0) {
+    len -= s.padding;
+    s.padding = 0;
+  }
+  if(len > 0) {
+    shell_output(&dec64_command, s.data, len, "", 0);
+  }
+  s.dataptr = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dec64_add(const char *data, int len)
+{
+  int i;
+
+  for(i = 0; i < len; ++i) {
+    base64_add_char(&s, data[i]);
+    if(s.dataptr == sizeof(s.data)) {
+      dec64_flush();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_dec64_process, ev, data)
 {
   struct shell_input *input;
-  struct base64_decoder_state s;
-  int i;
 
   PROCESS_BEGIN();
 
+  /* The decoder state is kept between inputs, so that the input does
+     not have to be split on four-character boundaries. */
+  s.sextets = s.dataptr = s.padding = 0;
+  s.tmpdata = 0;
+
   while(1) {
     PROCESS_WAIT_EVENT_UNTIL(ev == shell_event_input);
     input = data;
 
     if(input->len1 + input->len2 == 0) {
+      dec64_flush();
       PROCESS_EXIT();
     }
 
-    s.sextets = s.dataptr = s.padding = 0;
-
-    for(i = 0; i < input->len1; ++i) {
-      base64_add_char(&s, input->data1[i]);
-    }
-    for(i = 0; i < input->len2; ++i) {
-      base64_add_char(&s, input->data2[i]);
-    }
-    shell_output(&dec64_command, s.data, s.dataptr - s.padding, "", 0);
+    dec64_add(input->data1, input->len1);
+    dec64_add(input->data2, input->len2);
+    dec64_flush();
   }
   PROCESS_END();
 }
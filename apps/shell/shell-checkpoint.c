@@ -38,12 +38,14 @@
 #include "lib/checkpoint.h"
 
 #include <stdio.h>
+#include <string.h>
 
 /*---------------------------------------------------------------------------*/
 PROCESS(shell_checkpoint_process, "checkpoint");
 SHELL_COMMAND(checkpoint_command,
           "checkpoint",
-          "checkpoint <filename>: checkpoint local state to file",
+          "checkpoint [-i] <filename|->: checkpoint local state to file, "
+          "or to the serial line (-), only changed memory with -i",
           &shell_checkpoint_process);
 PROCESS(shell_rollback_process, "rollback");
 SHELL_COMMAND(rollback_command,
@@ -55,20 +57,34 @@ SHELL_COMMAND(rollback_command,
 PROCESS_THREAD(shell_checkpoint_process, ev, data)
 {
   int fd = 0;
+  char *name;
 
   PROCESS_BEGIN();
 
+  name = data;
+  checkpoint_set_incremental(0);
+  if(strncmp(name, "-i ", 3) == 0) {
+    checkpoint_set_incremental(1);
+    name += 3;
+  }
+
+  if(strcmp(name, "-") == 0) {
+    /* Stream over the serial line */
+    checkpoint_checkpoint(CHECKPOINT_FD_SERIAL);
+    PROCESS_EXIT();
+  }
+
   /* Make sure file does not already exist */
-  cfs_remove(data);
+  cfs_remove(name);
 
-  cfs_coffee_reserve(data, checkpoint_arch_size());
-  fd = cfs_open(data, CFS_WRITE);
+  cfs_coffee_reserve(name, checkpoint_arch_size());
+  fd = cfs_open(name, CFS_WRITE);
 
   if(fd < 0) {
     shell_output_str(&checkpoint_command,
-             "checkpoint: could not open file for writing: ", data);
+             "checkpoint: could not open file for writing: ", name);
   } else {
-    shell_output_str(&checkpoint_command, "checkpoint to: ", data);
+    shell_output_str(&checkpoint_command, "checkpoint to: ", name);
     checkpoint_checkpoint(fd);
     cfs_close(fd);
     shell_output_str(&checkpoint_command, "checkpointing done", "");
@@ -48,7 +48,7 @@
 PROCESS(shell_exec_process, "exec");
 SHELL_COMMAND(exec_command,
 	      "exec",
-	      "exec <filename>: load and execute the ELF file filename",
+	      "exec <filename>: load and execute the ELF or CELF file filename",
 	      &shell_exec_process);
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_exec_process, ev, data)
@@ -45,7 +45,26 @@
 #include <string.h>
 
 #define MAX_FILENAME_LEN 40
-#define MAX_BLOCKSIZE 40
+
+#ifdef SHELL_FILE_CONF_MAX_BLOCKSIZE
+#define MAX_BLOCKSIZE SHELL_FILE_CONF_MAX_BLOCKSIZE
+#else
+#define MAX_BLOCKSIZE 128
+#endif
+
+#ifdef SHELL_FILE_CONF_BLOCKSIZE
+#define DEFAULT_BLOCKSIZE SHELL_FILE_CONF_BLOCKSIZE
+#else
+#define DEFAULT_BLOCKSIZE 40
+#endif
+
+/* The number of blocks that read outputs before it yields, as long as
+   the commands after it in the pipeline keep up. */
+#ifdef SHELL_FILE_CONF_READ_BURST
+#define READ_BURST SHELL_FILE_CONF_READ_BURST
+#else
+#define READ_BURST 4
+#endif
 
 /*---------------------------------------------------------------------------*/
 PROCESS(shell_ls_process, "ls");
@@ -186,10 +205,10 @@ PROCESS_THREAD(shell_write_process, ev, data)
 PROCESS_THREAD(shell_read_process, ev, data)
 {
   static int fd = 0;
-  static int block_size = MAX_BLOCKSIZE;
+  static int block_size;
   char *next;
   char filename[MAX_FILENAME_LEN];
-  int len;
+  int len, i;
   int offset = 0;
   char buf[MAX_BLOCKSIZE];
   struct shell_input *input;
@@ -197,6 +216,7 @@ PROCESS_THREAD(shell_read_process, ev, data)
   PROCESS_EXITHANDLER(cfs_close(fd));
   PROCESS_BEGIN();
 
+  block_size = DEFAULT_BLOCKSIZE;
   if(data != NULL) {
     next = strchr(data, ' ');
     if(next == NULL) {
@@ -238,15 +258,21 @@ PROCESS_THREAD(shell_read_process, ev, data)
     } else {
       
       while(1) {
-	len = cfs_read(fd, buf, block_size);
-	if(len <= 0) {
-	  cfs_close(fd);
-	  PROCESS_EXIT();
+	for(i = 0; i < READ_BURST && !shell_output_busy(&read_command); ++i) {
+	  len = cfs_read(fd, buf, block_size);
+	  if(len <= 0) {
+	    cfs_close(fd);
+	    PROCESS_EXIT();
+	  }
+	  shell_output(&read_command,
+		       buf, len, "", 0);
+	}
+
+	/* If a command further down the pipeline is busy, it posts a
+	   continue event to us when it is ready for more data. */
+	if(!shell_output_busy(&read_command)) {
+	  process_post(&shell_read_process, PROCESS_EVENT_CONTINUE, NULL);
 	}
-	shell_output(&read_command,
-		     buf, len, "", 0);
-	
-	process_post(&shell_read_process, PROCESS_EVENT_CONTINUE, NULL);
 	PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE ||
 				 ev == shell_event_input);
 	
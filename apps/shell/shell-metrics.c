@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Shell command for printing the metrics registry
+ */
+
+#include "shell.h"
+#include "sys/metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+PROCESS(shell_metrics_process, "metrics");
+SHELL_COMMAND(metrics_command,
+	      "metrics",
+	      "metrics [reset]: print counters and latency histograms, or reset them",
+	      &shell_metrics_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_metrics_process, ev, data)
+{
+  char buf[80];
+  struct metrics_counter *c;
+  struct metrics_histogram *h;
+
+  PROCESS_BEGIN();
+
+  if(data != NULL && strncmp(data, "reset", 5) == 0) {
+    metrics_reset();
+    PROCESS_EXIT();
+  }
+
+  for(c = metrics_counters(); c != NULL; c = c->next) {
+    metrics_snprint_counter(buf, sizeof(buf), c);
+    shell_output_str(&metrics_command, buf, "");
+  }
+  for(h = metrics_histograms(); h != NULL; h = h->next) {
+    metrics_snprint_histogram(buf, sizeof(buf), h);
+    shell_output_str(&metrics_command, buf, "");
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_metrics_init(void)
+{
+  shell_register_command(&metrics_command);
+}
+/*---------------------------------------------------------------------------*/
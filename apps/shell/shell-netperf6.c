@@ -0,0 +1,763 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Measure UDP, TCP and CoAP performance between two IPv6 nodes
+ */
+
+#include "contiki.h"
+#include "shell-netperf6.h"
+
+#if UIP_CONF_IPV6
+
+#include "contiki-net.h"
+#include "net/simple-udp.h"
+#include "net/uiplib.h"
+#include "sys/energest.h"
+
+#if WITH_COAP == 13
+#include "erbium.h"
+#include "er-coap-13-engine.h"
+#endif /* WITH_COAP == 13 */
+
+#include <stdio.h>
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+#ifdef NETPERF6_CONF_MAX_SIZE
+#define MAX_SIZE NETPERF6_CONF_MAX_SIZE
+#else /* NETPERF6_CONF_MAX_SIZE */
+#define MAX_SIZE 80
+#endif /* NETPERF6_CONF_MAX_SIZE */
+
+#define DEFAULT_SIZE 32
+
+#ifdef NETPERF6_CONF_TIMEOUT
+#define TIMEOUT NETPERF6_CONF_TIMEOUT
+#else /* NETPERF6_CONF_TIMEOUT */
+#define TIMEOUT (4 * CLOCK_SECOND)
+#endif /* NETPERF6_CONF_TIMEOUT */
+
+#ifdef NETPERF6_CONF_STREAM_INTERVAL
+#define STREAM_INTERVAL NETPERF6_CONF_STREAM_INTERVAL
+#else /* NETPERF6_CONF_STREAM_INTERVAL */
+#define STREAM_INTERVAL (CLOCK_SECOND / 8)
+#endif /* NETPERF6_CONF_STREAM_INTERVAL */
+
+/* Currents in microamperes and supply voltage in millivolts used to
+   turn energest times into energy. The defaults are the Tmote Sky
+   data sheet values. */
+#ifdef NETPERF6_CONF_CURRENT_CPU
+#define CURRENT_CPU NETPERF6_CONF_CURRENT_CPU
+#else
+#define CURRENT_CPU 1800UL
+#endif
+#ifdef NETPERF6_CONF_CURRENT_LPM
+#define CURRENT_LPM NETPERF6_CONF_CURRENT_LPM
+#else
+#define CURRENT_LPM 55UL
+#endif
+#ifdef NETPERF6_CONF_CURRENT_RX
+#define CURRENT_RX NETPERF6_CONF_CURRENT_RX
+#else
+#define CURRENT_RX 20000UL
+#endif
+#ifdef NETPERF6_CONF_CURRENT_TX
+#define CURRENT_TX NETPERF6_CONF_CURRENT_TX
+#else
+#define CURRENT_TX 17700UL
+#endif
+#ifdef NETPERF6_CONF_VOLTAGE
+#define VOLTAGE NETPERF6_CONF_VOLTAGE
+#else
+#define VOLTAGE 3000UL
+#endif
+
+#define MAX_RETRIES 8
+
+/* RTT histogram bucket i holds round-trip times below 2^i ms. */
+#define HISTOGRAM_BUCKETS 13
+
+#define CONTINUE_EVENT 128
+
+struct power {
+  unsigned long lpm, cpu, rx, tx;
+};
+
+/* What the measuring node keeps about the current test. */
+struct stats {
+  uint16_t sent, received, timedout;
+  unsigned long bytes;
+  clock_time_t start, end;
+  unsigned long rtt_min, rtt_max, rtt_total;
+  uint16_t histogram[HISTOGRAM_BUCKETS];
+  struct power power0, power;
+};
+
+/* What the peer counts between a CLEAR and a STATS request. */
+struct peer_stats {
+  unsigned long packets, bytes, second;
+  struct power power;
+};
+
+enum {
+  TYPE_NONE      = 0,
+  TYPE_PINGPONG  = 1,
+  TYPE_STREAM    = 2,
+  TYPE_TCP       = 3,
+  TYPE_COAP      = 4,
+};
+
+static const char *type_names[] = {
+  "", "UDP ping-pong", "UDP stream", "TCP bulk", "CoAP request/response"
+};
+
+static struct simple_udp_connection conn;
+
+static struct stats stats;
+static struct peer_stats served, remote;
+static struct power served_power0;
+
+static uip_ipaddr_t receiver;
+static uint8_t current_type;
+static uint16_t seqno;
+static uint8_t awaited_type;
+static clock_time_t sent_clock;
+static rtimer_clock_t sent_rtimer;
+
+static uint8_t txbuf[MAX_SIZE];
+static uint8_t replybuf[NETPERF6_STATS_REPLY_LEN > MAX_SIZE ?
+                        NETPERF6_STATS_REPLY_LEN : MAX_SIZE];
+
+/*---------------------------------------------------------------------------*/
+PROCESS(shell_netperf6_process, "netperf6");
+PROCESS(netperf6_server_process, "netperf6 server");
+SHELL_COMMAND(netperf6_command,
+	      "netperf6",
+	      "netperf6: measure IPv6 UDP, TCP and CoAP performance",
+	      &shell_netperf6_process);
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint8_t *p, unsigned long v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+get32(const uint8_t *p)
+{
+  return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) |
+    ((unsigned long)p[2] << 8) | p[3];
+}
+/*---------------------------------------------------------------------------*/
+static void
+sample_power_profile(struct power *p)
+{
+  energest_flush();
+  p->lpm = energest_type_time(ENERGEST_TYPE_LPM);
+  p->cpu = energest_type_time(ENERGEST_TYPE_CPU);
+  p->rx = energest_type_time(ENERGEST_TYPE_LISTEN);
+  p->tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+}
+/*---------------------------------------------------------------------------*/
+static void
+power_diff(struct power *result, const struct power *p0)
+{
+  result->lpm -= p0->lpm;
+  result->cpu -= p0->cpu;
+  result->rx -= p0->rx;
+  result->tx -= p0->tx;
+}
+/*---------------------------------------------------------------------------*/
+/* Energy in microjoules spent during the energest times in p. */
+static unsigned long
+energy_uj(const struct power *p, unsigned long second)
+{
+  uint64_t charge;
+
+  if(second == 0) {
+    return 0;
+  }
+  charge = (uint64_t)p->cpu * CURRENT_CPU + (uint64_t)p->lpm * CURRENT_LPM +
+    (uint64_t)p->rx * CURRENT_RX + (uint64_t)p->tx * CURRENT_TX;
+  return (unsigned long)(charge * VOLTAGE / 1000 / second);
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_energy(const char *who, const struct power *p, unsigned long second,
+             unsigned long bytes)
+{
+  unsigned long total_time, uj;
+
+  total_time = p->cpu + p->lpm;
+  if(total_time == 0) {
+    return;
+  }
+  printf("  %s radio duty cycle:%*srx %lu.%02lu%% tx %lu.%02lu%%\n",
+         who, (int)(8 - strlen(who)), "",
+         (100 * p->rx) / total_time, ((10000 * p->rx) / total_time) % 100,
+         (100 * p->tx) / total_time, ((10000 * p->tx) / total_time) % 100);
+  uj = energy_uj(p, second);
+  printf("  %s energy:%*s%lu uJ", who, (int)(18 - strlen(who)), "", uj);
+  if(bytes > 0) {
+    printf(", %lu nJ/bit", (1000 * uj) / (8 * bytes));
+  }
+  printf("\n");
+}
+/*---------------------------------------------------------------------------*/
+static void
+clear_stats(void)
+{
+  memset(&stats, 0, sizeof(stats));
+  stats.rtt_min = ~0UL;
+  stats.start = clock_time();
+  sample_power_profile(&stats.power0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+finalize_stats(void)
+{
+  stats.end = clock_time();
+  sample_power_profile(&stats.power);
+  power_diff(&stats.power, &stats.power0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+record_rtt(void)
+{
+  unsigned long rtt;
+  clock_time_t elapsed;
+  uint8_t bucket;
+
+  /* The rtimer is the finer clock, but wraps quickly on 16-bit
+     platforms. */
+  elapsed = clock_time() - sent_clock;
+  if(elapsed > CLOCK_SECOND) {
+    rtt = (1000UL * elapsed) / CLOCK_SECOND;
+  } else {
+    rtt = (1000UL * (rtimer_clock_t)(RTIMER_NOW() - sent_rtimer)) /
+      RTIMER_ARCH_SECOND;
+  }
+
+  for(bucket = 0; bucket < HISTOGRAM_BUCKETS - 1 && rtt >= (1UL << bucket);
+      bucket++);
+  stats.histogram[bucket]++;
+  stats.rtt_total += rtt;
+  if(rtt < stats.rtt_min) {
+    stats.rtt_min = rtt;
+  }
+  if(rtt > stats.rtt_max) {
+    stats.rtt_max = rtt;
+  }
+  stats.received++;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+percentile(uint8_t p)
+{
+  unsigned long target, count;
+  uint8_t i;
+
+  target = ((unsigned long)stats.received * p + 99) / 100;
+  count = 0;
+  for(i = 0; i < HISTOGRAM_BUCKETS - 1; i++) {
+    count += stats.histogram[i];
+    if(count >= target) {
+      return 1UL << i;
+    }
+  }
+  return stats.rtt_max;
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_local_stats(void)
+{
+  unsigned long time, bytes;
+  uint8_t i;
+
+  time = stats.end - stats.start;
+  if(time == 0) {
+    time = 1;
+  }
+  bytes = current_type == TYPE_PINGPONG || current_type == TYPE_COAP ?
+    stats.bytes : remote.bytes;
+
+  printf("%d 0 %u %u %u %lu %lu %lu %lu %lu %lu %lu %lu %lu # for automatic processing\n",
+         current_type, stats.sent, stats.received, stats.timedout,
+         (1000UL * time) / CLOCK_SECOND, bytes,
+         stats.received ? stats.rtt_min : 0,
+         stats.received ? stats.rtt_total / stats.received : 0,
+         stats.rtt_max,
+         stats.power.cpu, stats.power.lpm, stats.power.rx, stats.power.tx);
+
+  printf("Local node statistics:\n");
+  printf("  Total transfer time:       %lu.%02lu seconds, %lu bytes/second\n",
+         time / CLOCK_SECOND, ((100 * time) / CLOCK_SECOND) % 100,
+         (bytes * CLOCK_SECOND) / time);
+  if(stats.sent > 0) {
+    printf("  Packets:                   sent %u, answered %u, timed out %u\n",
+           stats.sent, stats.received, stats.timedout);
+  }
+  if(stats.received > 0) {
+    printf("  Round-trip time:           min %lu avg %lu max %lu ms\n",
+           stats.rtt_min, stats.rtt_total / stats.received, stats.rtt_max);
+    printf("  Round-trip percentiles:    50%% <= %lu 90%% <= %lu 99%% <= %lu ms\n",
+           percentile(50), percentile(90), percentile(99));
+    for(i = 0; i < HISTOGRAM_BUCKETS; i++) {
+      if(stats.histogram[i] > 0) {
+        if(i == HISTOGRAM_BUCKETS - 1) {
+          printf("    >= %5lu ms: %u\n", 1UL << (i - 1), stats.histogram[i]);
+        } else {
+          printf("    <  %5lu ms: %u\n", 1UL << i, stats.histogram[i]);
+        }
+      }
+    }
+  }
+  print_energy("Local", &stats.power, RTIMER_ARCH_SECOND, bytes);
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_remote_stats(void)
+{
+  printf("%d 1 %lu %lu %lu %lu %lu %lu # for automatic processing\n",
+         current_type, remote.packets, remote.bytes, remote.power.cpu,
+         remote.power.lpm, remote.power.rx, remote.power.tx);
+
+  printf("Remote node statistics:\n");
+  printf("  Received:                  %lu packets, %lu bytes\n",
+         remote.packets, remote.bytes);
+  if(current_type == TYPE_STREAM && stats.sent > 0) {
+    printf("  Packets received:          %lu.%lu%%, %lu of %u\n",
+           (100 * remote.packets) / stats.sent,
+           ((1000 * remote.packets) / stats.sent) % 10,
+           remote.packets, stats.sent);
+  }
+  print_energy("Remote", &remote.power, remote.second, remote.bytes);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(uint8_t type, uint16_t len)
+{
+  if(len < NETPERF6_HDR_LEN) {
+    len = NETPERF6_HDR_LEN;
+  }
+  txbuf[0] = type;
+  txbuf[1] = 0;
+  txbuf[2] = seqno >> 8;
+  txbuf[3] = seqno & 0xff;
+  sent_clock = clock_time();
+  sent_rtimer = RTIMER_NOW();
+  simple_udp_sendto(&conn, txbuf, len, &receiver);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_served_stats(const uip_ipaddr_t *to, uint16_t port)
+{
+  struct power p;
+
+  sample_power_profile(&p);
+  power_diff(&p, &served_power0);
+  put32(&replybuf[NETPERF6_HDR_LEN], served.packets);
+  put32(&replybuf[NETPERF6_HDR_LEN + 4], served.bytes);
+  put32(&replybuf[NETPERF6_HDR_LEN + 8], RTIMER_ARCH_SECOND);
+  put32(&replybuf[NETPERF6_HDR_LEN + 12], p.cpu);
+  put32(&replybuf[NETPERF6_HDR_LEN + 16], p.lpm);
+  put32(&replybuf[NETPERF6_HDR_LEN + 20], p.rx);
+  put32(&replybuf[NETPERF6_HDR_LEN + 24], p.tx);
+  simple_udp_sendto_port(&conn, replybuf, NETPERF6_STATS_REPLY_LEN, to, port);
+}
+/*---------------------------------------------------------------------------*/
+static void
+receiver_callback(struct simple_udp_connection *c,
+                  const uip_ipaddr_t *sender_addr,
+                  uint16_t sender_port,
+                  const uip_ipaddr_t *receiver_addr,
+                  uint16_t receiver_port,
+                  const uint8_t *data,
+                  uint16_t datalen)
+{
+  if(datalen < NETPERF6_HDR_LEN) {
+    return;
+  }
+
+  /* Requests are answered by every node. */
+  switch(data[0]) {
+  case NETPERF6_ECHO_REQUEST:
+    if(datalen > sizeof(replybuf)) {
+      datalen = sizeof(replybuf);
+    }
+    memcpy(replybuf, data, datalen);
+    replybuf[0] = NETPERF6_ECHO_REPLY;
+    served.packets++;
+    served.bytes += datalen;
+    simple_udp_sendto_port(c, replybuf, datalen, sender_addr, sender_port);
+    return;
+  case NETPERF6_STREAM:
+    served.packets++;
+    served.bytes += datalen;
+    return;
+  case NETPERF6_CLEAR:
+    memset(&served, 0, sizeof(served));
+    sample_power_profile(&served_power0);
+    memcpy(replybuf, data, NETPERF6_HDR_LEN);
+    replybuf[0] = NETPERF6_CLEAR_ACK;
+    simple_udp_sendto_port(c, replybuf, NETPERF6_HDR_LEN,
+                           sender_addr, sender_port);
+    return;
+  case NETPERF6_STATS:
+    memcpy(replybuf, data, NETPERF6_HDR_LEN);
+    replybuf[0] = NETPERF6_STATS_REPLY;
+    send_served_stats(sender_addr, sender_port);
+    return;
+  }
+
+  /* Replies are only of interest to an ongoing measurement. */
+  if(data[0] != awaited_type ||
+     ((data[2] << 8) | data[3]) != seqno ||
+     !uip_ipaddr_cmp(sender_addr, &receiver)) {
+    return;
+  }
+  awaited_type = 0;
+  if(data[0] == NETPERF6_ECHO_REPLY) {
+    record_rtt();
+    stats.bytes += datalen;
+  } else if(data[0] == NETPERF6_STATS_REPLY &&
+            datalen >= NETPERF6_STATS_REPLY_LEN) {
+    data += NETPERF6_HDR_LEN;
+    remote.packets = get32(data);
+    remote.bytes = get32(data + 4);
+    remote.second = get32(data + 8);
+    remote.power.cpu = get32(data + 12);
+    remote.power.lpm = get32(data + 16);
+    remote.power.rx = get32(data + 20);
+    remote.power.tx = get32(data + 24);
+  }
+  process_post(&shell_netperf6_process, CONTINUE_EVENT, NULL);
+}
+/*---------------------------------------------------------------------------*/
+#if WITH_COAP == 13
+RESOURCE(netperf6, METHOD_GET | METHOD_POST, "netperf",
+         "title=\"netperf6 sink\";rt=\"Debug\"");
+
+void
+netperf6_handler(void *request, void *response, uint8_t *buffer,
+                 uint16_t preferred_size, int32_t *offset)
+{
+  const uint8_t *payload;
+
+  served.packets++;
+  served.bytes += REST.get_request_payload(request, &payload);
+  REST.set_response_status(response, REST.status.CHANGED);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t coap_answered;
+
+static void
+coap_response(void *response)
+{
+  coap_answered = 1;
+}
+#endif /* WITH_COAP == 13 */
+/*---------------------------------------------------------------------------*/
+static void
+print_usage(void)
+{
+  shell_output_str(&netperf6_command,
+		   "netperf6 [-p|s|t|c] <receiver> <num> [size]: measure IPv6 performance to receiver", "");
+  shell_output_str(&netperf6_command,
+		   "        -p measure UDP ping-pong performance", "");
+  shell_output_str(&netperf6_command,
+		   "        -s measure UDP stream performance", "");
+#if UIP_TCP
+  shell_output_str(&netperf6_command,
+		   "        -t measure TCP bulk transfer of num * size bytes", "");
+#endif /* UIP_TCP */
+#if WITH_COAP == 13
+  shell_output_str(&netperf6_command,
+		   "        -c measure CoAP request/response performance", "");
+#endif /* WITH_COAP == 13 */
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_netperf6_init(void)
+{
+  process_start(&netperf6_server_process, NULL);
+#if WITH_COAP == 13
+  rest_init_engine();
+  rest_activate_resource(&resource_netperf6);
+#endif /* WITH_COAP == 13 */
+  shell_register_command(&netperf6_command);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(netperf6_server_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  simple_udp_register(&conn, NETPERF6_UDP_PORT, NULL, NETPERF6_UDP_PORT,
+                      receiver_callback);
+#if UIP_TCP
+  tcp_listen(UIP_HTONS(NETPERF6_TCP_PORT));
+#endif /* UIP_TCP */
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+#if UIP_TCP
+    if(uip_newdata()) {
+      served.packets++;
+      served.bytes += uip_datalen();
+    }
+#endif /* UIP_TCP */
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Sends a control message until it is answered. The reply is handled
+   by receiver_callback(), which posts CONTINUE_EVENT. */
+#define CONTROL(type, reply)                                            \
+  do {                                                                  \
+    seqno++;                                                            \
+    for(retries = 0; retries < MAX_RETRIES; retries++) {                \
+      awaited_type = (reply);                                           \
+      send_packet((type), NETPERF6_HDR_LEN);                            \
+      etimer_set(&et, TIMEOUT);                                         \
+      PROCESS_WAIT_EVENT_UNTIL(ev == CONTINUE_EVENT ||                  \
+                               etimer_expired(&et));                    \
+      if(ev == CONTINUE_EVENT) {                                        \
+        break;                                                          \
+      }                                                                 \
+    }                                                                   \
+    if(retries == MAX_RETRIES) {                                        \
+      shell_output_str(&netperf6_command,                               \
+                       "netperf6 control connection failed", "");       \
+      PROCESS_EXIT();                                                   \
+    }                                                                   \
+  } while(0)
+
+PROCESS_THREAD(shell_netperf6_process, ev, data)
+{
+  static struct etimer et;
+  static char recvstr[40];
+  static int i, num_packets, size, retries;
+  static uint8_t do_tests[TYPE_COAP + 1];
+#if UIP_TCP
+  static struct uip_conn *tcp;
+  static unsigned long left, unacked;
+#endif /* UIP_TCP */
+#if WITH_COAP == 13
+  static coap_packet_t request[1];
+  static struct request_state_t request_state;
+#endif /* WITH_COAP == 13 */
+  const char *nextptr;
+  const char *args;
+  int len;
+
+  PROCESS_EXITHANDLER(awaited_type = 0);
+  PROCESS_BEGIN();
+
+  current_type = TYPE_NONE;
+  memset(do_tests, 0, sizeof(do_tests));
+
+  args = data;
+
+  /* Parse the -pstc options */
+  while(*args == '-') {
+    ++args;
+    while(*args != ' ' &&
+	  *args != 0) {
+      if(*args == 'p') {
+	do_tests[TYPE_PINGPONG] = 1;
+      }
+      if(*args == 's') {
+	do_tests[TYPE_STREAM] = 1;
+      }
+#if UIP_TCP
+      if(*args == 't') {
+	do_tests[TYPE_TCP] = 1;
+      }
+#endif /* UIP_TCP */
+#if WITH_COAP == 13
+      if(*args == 'c') {
+	do_tests[TYPE_COAP] = 1;
+      }
+#endif /* WITH_COAP == 13 */
+      ++args;
+    }
+    while(*args == ' ') {
+      args++;
+    }
+  }
+
+  /* Parse the receiver address */
+  nextptr = strchr(args, ' ');
+  len = nextptr == NULL ? 0 : nextptr - args;
+  if(len == 0 || len >= sizeof(recvstr)) {
+    print_usage();
+    PROCESS_EXIT();
+  }
+  memcpy(recvstr, args, len);
+  recvstr[len] = 0;
+  if(uiplib_ipaddrconv(recvstr, &receiver) == 0) {
+    print_usage();
+    PROCESS_EXIT();
+  }
+
+  /* Parse the number of packets and their size */
+  num_packets = shell_strtolong(nextptr, &nextptr);
+  if(num_packets <= 0) {
+    print_usage();
+    PROCESS_EXIT();
+  }
+  size = shell_strtolong(nextptr, &nextptr);
+  if(size == 0) {
+    size = DEFAULT_SIZE;
+  }
+  if(size < NETPERF6_HDR_LEN || size > MAX_SIZE) {
+    print_usage();
+    PROCESS_EXIT();
+  }
+  memset(txbuf, 'n', sizeof(txbuf));
+
+  for(current_type = TYPE_PINGPONG; current_type <= TYPE_COAP;
+      current_type++) {
+    if(!do_tests[current_type]) {
+      continue;
+    }
+    printf("-------- %s --------\n", type_names[current_type]);
+    shell_output_str(&netperf6_command, "Contacting ", recvstr);
+    CONTROL(NETPERF6_CLEAR, NETPERF6_CLEAR_ACK);
+
+    shell_output_str(&netperf6_command, "Measuring performance to ", recvstr);
+    clear_stats();
+
+    if(current_type == TYPE_PINGPONG) {
+      for(i = 0; i < num_packets; ++i) {
+        seqno++;
+        awaited_type = NETPERF6_ECHO_REPLY;
+        send_packet(NETPERF6_ECHO_REQUEST, size);
+        stats.sent++;
+        etimer_set(&et, TIMEOUT);
+        PROCESS_WAIT_EVENT_UNTIL(ev == CONTINUE_EVENT || etimer_expired(&et));
+        if(ev != CONTINUE_EVENT) {
+          stats.timedout++;
+        }
+      }
+    } else if(current_type == TYPE_STREAM) {
+      for(i = 0; i < num_packets; ++i) {
+        seqno++;
+        send_packet(NETPERF6_STREAM, size);
+        stats.sent++;
+        etimer_set(&et, STREAM_INTERVAL);
+        PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+      }
+#if UIP_TCP
+    } else if(current_type == TYPE_TCP) {
+      left = (unsigned long)num_packets * size;
+      unacked = 0;
+      tcp = tcp_connect(&receiver, UIP_HTONS(NETPERF6_TCP_PORT), NULL);
+      if(tcp == NULL) {
+        shell_output_str(&netperf6_command, "No free TCP connection", "");
+        continue;
+      }
+      while(1) {
+        PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+        if(uip_aborted() || uip_timedout() || uip_closed()) {
+          break;
+        }
+        if(uip_acked()) {
+          stats.bytes += unacked;
+          left -= unacked;
+          unacked = 0;
+        }
+        if(uip_rexmit() ||
+           ((uip_connected() || uip_acked() || uip_poll()) && unacked == 0)) {
+          if(left == 0) {
+            uip_close();
+            continue;
+          }
+          if(unacked == 0) {
+            unacked = left < uip_mss() ? left : uip_mss();
+          }
+          memset(uip_appdata, 'n', unacked);
+          uip_send(uip_appdata, unacked);
+        }
+      }
+      if(left > 0) {
+        shell_output_str(&netperf6_command, "TCP connection lost", "");
+      }
+#endif /* UIP_TCP */
+#if WITH_COAP == 13
+    } else if(current_type == TYPE_COAP) {
+      for(i = 0; i < num_packets; ++i) {
+        coap_init_message(request, COAP_TYPE_CON, COAP_POST, 0);
+        coap_set_header_uri_path(request, "netperf");
+        coap_set_payload(request, txbuf, size);
+        coap_answered = 0;
+        sent_clock = clock_time();
+        sent_rtimer = RTIMER_NOW();
+        stats.sent++;
+        PT_SPAWN(process_pt, &request_state.pt,
+                 coap_blocking_request(&request_state, ev, &receiver,
+                                       UIP_HTONS(COAP_DEFAULT_PORT),
+                                       request, coap_response));
+        if(coap_answered && !request_state.failed) {
+          record_rtt();
+          stats.bytes += size;
+        } else {
+          stats.timedout++;
+        }
+      }
+#endif /* WITH_COAP == 13 */
+    }
+
+    finalize_stats();
+    CONTROL(NETPERF6_STATS, NETPERF6_STATS_REPLY);
+    print_local_stats();
+    print_remote_stats();
+  }
+
+  shell_output_str(&netperf6_command, "Done", "");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+#else /* UIP_CONF_IPV6 */
+/*---------------------------------------------------------------------------*/
+void
+shell_netperf6_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_CONF_IPV6 */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Network performance measurements over IPv6: UDP ping-pong,
+ *         UDP stream, TCP bulk transfer and CoAP request/response
+ *
+ *         Every node that runs shell_netperf6_init() answers
+ *         measurement traffic on NETPERF6_UDP_PORT and
+ *         NETPERF6_TCP_PORT, so either another Contiki node or the
+ *         tools/netperf6 host program can be used as the peer.
+ *
+ *         All packets start with a four-byte header: the message
+ *         type, a zero byte and a 16-bit sequence number in network
+ *         byte order. A NETPERF6_STATS_REPLY carries seven 32-bit
+ *         big-endian words after the header: packets received,
+ *         bytes received, energest ticks per second, and the CPU,
+ *         LPM, listen and transmit energest times since the last
+ *         NETPERF6_CLEAR.
+ */
+
+#ifndef __SHELL_NETPERF6_H__
+#define __SHELL_NETPERF6_H__
+
+#include "shell.h"
+
+#ifdef NETPERF6_CONF_UDP_PORT
+#define NETPERF6_UDP_PORT NETPERF6_CONF_UDP_PORT
+#else /* NETPERF6_CONF_UDP_PORT */
+#define NETPERF6_UDP_PORT 6011
+#endif /* NETPERF6_CONF_UDP_PORT */
+
+#ifdef NETPERF6_CONF_TCP_PORT
+#define NETPERF6_TCP_PORT NETPERF6_CONF_TCP_PORT
+#else /* NETPERF6_CONF_TCP_PORT */
+#define NETPERF6_TCP_PORT 6012
+#endif /* NETPERF6_CONF_TCP_PORT */
+
+enum {
+  NETPERF6_ECHO_REQUEST = 1,
+  NETPERF6_ECHO_REPLY   = 2,
+  NETPERF6_STREAM       = 3,
+  NETPERF6_CLEAR        = 4,
+  NETPERF6_CLEAR_ACK    = 5,
+  NETPERF6_STATS        = 6,
+  NETPERF6_STATS_REPLY  = 7,
+};
+
+#define NETPERF6_HDR_LEN         4
+#define NETPERF6_STATS_REPLY_LEN (NETPERF6_HDR_LEN + 7 * 4)
+
+void shell_netperf6_init(void);
+
+#endif /* __SHELL_NETPERF6_H__ */
@@ -47,7 +47,11 @@
 PROCESS(shell_ps_process, "ps");
 SHELL_COMMAND(ps_command,
 	      "ps",
+#if PROCESS_CONF_ACCOUNTING
+	      "ps [reset]: list all running processes and their CPU use, or reset the counters",
+#else /* PROCESS_CONF_ACCOUNTING */
 	      "ps: list all running processes",
+#endif /* PROCESS_CONF_ACCOUNTING */
 	      &shell_ps_process);
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_ps_process, ev, data)
@@ -55,11 +59,32 @@ PROCESS_THREAD(shell_ps_process, ev, data)
   struct process *p;
   PROCESS_BEGIN();
 
+#if PROCESS_CONF_ACCOUNTING
+  if(data != NULL && strncmp(data, "reset", 5) == 0) {
+    process_accounting_reset();
+    PROCESS_EXIT();
+  }
+#endif /* PROCESS_CONF_ACCOUNTING */
+
   shell_output_str(&ps_command, "Processes:", "");
+#if PROCESS_CONF_ACCOUNTING
+  shell_output_str(&ps_command,
+                   "name: calls, ticks, max ticks per call, events", "");
+#endif /* PROCESS_CONF_ACCOUNTING */
   for(p = PROCESS_LIST(); p != NULL; p = p->next) {
     char namebuf[30];
     strncpy(namebuf, PROCESS_NAME_STRING(p), sizeof(namebuf));
+#if PROCESS_CONF_ACCOUNTING
+    {
+      char acctbuf[50];
+      namebuf[sizeof(namebuf) - 1] = 0;
+      snprintf(acctbuf, sizeof(acctbuf), ": %lu, %lu, %lu, %lu",
+               p->acct.calls, p->acct.ticks, p->acct.max, p->acct.events);
+      shell_output_str(&ps_command, namebuf, acctbuf);
+    }
+#else /* PROCESS_CONF_ACCOUNTING */
     shell_output_str(&ps_command, namebuf, "");
+#endif /* PROCESS_CONF_ACCOUNTING */
   }
 
   PROCESS_END();
@@ -124,7 +124,12 @@ PROCESS_THREAD(shell_unicast_send_process, ev, data)
       msg->timestamp = 0;
 #endif
       /*      printf("Sending %d bytes\n", len);*/
-      unicast_send(&uc, &receiver);
+      /* Hold back the commands that feed us until the packet has
+	 been sent. */
+      shell_set_busy(&unicast_send_command, 1);
+      if(!unicast_send(&uc, &receiver)) {
+	shell_set_busy(&unicast_send_command, 0);
+      }
     }
   }
   PROCESS_END();
@@ -167,7 +172,12 @@ recv_uc(struct unicast_conn *c, const rimeaddr_t *from)
 	 msg->data);*/
   
 }
-static const struct unicast_callbacks unicast_callbacks = {recv_uc};
+static void
+sent_uc(struct unicast_conn *c, int status, int num_tx)
+{
+  shell_set_busy(&unicast_send_command, 0);
+}
+static const struct unicast_callbacks unicast_callbacks = {recv_uc, sent_uc};
 
 PROCESS_THREAD(shell_unicast_recv_process, ev, data)
 {
@@ -80,6 +80,9 @@ void shell_rime_init(void);
 /* Rime channel used by the 'netperf' command, which uses 6 channels */
 #define SHELL_RIME_CHANNEL_NETPERF   SHELL_RIME_CHANNEL_DOWNLOAD + 2
 
+/* Rime channel used by the 'xfer-fetch' command, which uses 2 channels */
+#define SHELL_RIME_CHANNEL_XFER      SHELL_RIME_CHANNEL_NETPERF + 6
+
 
 /* Announcement idenfied used by the 'neighbors' command, uses one idenfier */
 #define SHELL_RIME_ANNOUNCEMENT_IDENTIFIER_NEIGHBORS SHELL_RIME_CHANNEL_DOWNLOAD + 2
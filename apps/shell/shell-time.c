@@ -218,8 +218,7 @@ PROCESS_THREAD(shell_repeat_process, ev, data)
     input = data;
     /*    printf("shell repeat input %d %d\n", input->len1, input->len2);*/
     if(input->len1 + input->len2 != 0) {
-      shell_output(&repeat_command, input->data1, input->len1,
-		   input->data2, input->len2);
+      shell_forward(&repeat_command, input);
     }
   }
 
@@ -0,0 +1,562 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Windowed, resumable binary file transfer over the serial
+ *         shell and over Rime
+ */
+
+#include "contiki.h"
+#include "shell-xfer.h"
+#include "shell-rime.h"
+
+#include "net/rime.h"
+#include "cfs/cfs.h"
+#include "lib/crc16.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef SHELL_XFER_CONF_CHUNK_SIZE
+#define CHUNK_SIZE SHELL_XFER_CONF_CHUNK_SIZE
+#else
+#define CHUNK_SIZE 64
+#endif
+
+/* The number of chunks that may be outstanding before the receiver
+   has acknowledged them. */
+#ifdef SHELL_XFER_CONF_WINDOW
+#define DEFAULT_WINDOW SHELL_XFER_CONF_WINDOW
+#else
+#define DEFAULT_WINDOW 8
+#endif
+
+#ifdef SHELL_XFER_CONF_TIMEOUT
+#define TIMEOUT SHELL_XFER_CONF_TIMEOUT
+#else
+#define TIMEOUT (2 * CLOCK_SECOND)
+#endif
+
+#define MAX_RETRIES    8
+#define IDLE_TIMEOUT   (30 * CLOCK_SECOND)
+#define READ_BURST     4
+#define MAX_WINDOW     64
+#define FILENAME_LEN   20
+
+#define DEBUG 0
+#if DEBUG
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+enum {
+  XFER_SEEK,
+  XFER_ACK,
+  XFER_DATA,
+};
+
+/* Header of the Rime messages. A XFER_SEEK message is followed by the
+   name of the file, a XFER_DATA message by the data. */
+struct xfer_msg {
+  uint8_t type;
+  uint8_t window;
+  uint8_t offset[4];
+  uint8_t crc[2];
+};
+
+/*---------------------------------------------------------------------------*/
+PROCESS(shell_xfer_read_process, "xfer-read");
+SHELL_COMMAND(xfer_read_command,
+	      "xfer-read",
+	      "xfer-read <filename> [offset] [window]: send file as binary frames",
+	      &shell_xfer_read_process);
+PROCESS(shell_xfer_fetch_process, "xfer-fetch");
+SHELL_COMMAND(xfer_fetch_command,
+	      "xfer-fetch",
+	      "xfer-fetch <node addr> <filename> [local filename]: copy file from node",
+	      &shell_xfer_fetch_process);
+PROCESS(xfer_server_process, "xfer server");
+/*---------------------------------------------------------------------------*/
+static int read_fd = -1;
+static uint32_t read_pos, read_limit;
+static uint8_t read_window, read_eof;
+
+static struct unicast_conn req_uc, data_uc;
+
+static rimeaddr_t serve_peer;
+static int serve_fd = -1;
+static uint32_t serve_pos, serve_limit;
+static uint8_t serve_eof, serve_sending;
+
+static rimeaddr_t fetch_peer;
+static int fetch_fd = -1;
+static uint32_t fetch_pos, fetch_acked;
+static uint8_t fetch_window, fetch_done, fetch_seeking;
+static char fetch_name[FILENAME_LEN];
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+    ((uint32_t)p[2] << 8) | p[3];
+}
+/*---------------------------------------------------------------------------*/
+static const char *
+parse_filename(const char *str, char *name)
+{
+  int len;
+
+  while(*str == ' ') {
+    ++str;
+  }
+  for(len = 0; str[len] != 0 && str[len] != ' '; ++len);
+  if(len == 0 || len >= FILENAME_LEN) {
+    return NULL;
+  }
+  memcpy(name, str, len);
+  name[len] = 0;
+  return str + len;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+parse_window(const char *str)
+{
+  unsigned long window;
+
+  window = shell_strtolong(str, NULL);
+  if(window == 0) {
+    return DEFAULT_WINDOW;
+  } else if(window > MAX_WINDOW) {
+    return MAX_WINDOW;
+  }
+  return window;
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_close(void)
+{
+  if(read_fd >= 0) {
+    cfs_close(read_fd);
+  }
+  read_fd = -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_send_chunk(void)
+{
+  uint8_t hdr[SHELL_XFER_FRAME_HDRLEN];
+  uint8_t buf[CHUNK_SIZE];
+  uint16_t crc;
+  int len;
+
+  len = cfs_read(read_fd, buf, sizeof(buf));
+  if(len <= 0) {
+    len = 0;
+    read_eof = 1;
+  }
+  crc = crc16_data(buf, len, 0);
+
+  hdr[0] = '#';
+  hdr[1] = 'X';
+  hdr[2] = 'F';
+  put32(&hdr[3], read_pos);
+  hdr[7] = len;
+  hdr[8] = crc >> 8;
+  hdr[9] = crc & 0xff;
+  shell_output(&xfer_read_command, hdr, sizeof(hdr), buf, len);
+
+  read_pos += len;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_xfer_read_process, ev, data)
+{
+  static struct etimer etimer;
+  static char name[FILENAME_LEN];
+  struct shell_input *input;
+  const char *next;
+  uint32_t offset;
+  int i;
+
+  PROCESS_EXITHANDLER(read_close());
+  PROCESS_BEGIN();
+
+  next = parse_filename(data, name);
+  if(next == NULL) {
+    shell_output_str(&xfer_read_command,
+		     "usage: ", xfer_read_command.description);
+    PROCESS_EXIT();
+  }
+  read_pos = shell_strtolong(next, &next);
+  read_window = parse_window(next);
+  read_limit = read_pos + (uint32_t)read_window * CHUNK_SIZE;
+  read_eof = 0;
+
+  read_fd = cfs_open(name, CFS_READ);
+  if(read_fd < 0) {
+    shell_output_str(&xfer_read_command,
+		     "xfer-read: could not open file ", name);
+    PROCESS_EXIT();
+  }
+  cfs_seek(read_fd, read_pos, CFS_SEEK_SET);
+
+  etimer_set(&etimer, IDLE_TIMEOUT);
+  while(1) {
+    for(i = 0; i < READ_BURST && !read_eof && read_pos < read_limit &&
+	  !shell_output_busy(&xfer_read_command); ++i) {
+      read_send_chunk();
+    }
+    if(!read_eof && read_pos < read_limit &&
+       !shell_output_busy(&xfer_read_command)) {
+      process_post(&shell_xfer_read_process, PROCESS_EVENT_CONTINUE, NULL);
+    }
+
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE ||
+			     ev == shell_event_input ||
+			     etimer_expired(&etimer));
+    if(ev == PROCESS_EVENT_TIMER) {
+      /* The host has gone away. */
+      PROCESS_EXIT();
+    }
+    if(ev == shell_event_input) {
+      input = data;
+      if(input->len1 + input->len2 == 0) {
+	PROCESS_EXIT();
+      }
+      etimer_restart(&etimer);
+      offset = shell_strtolong(input->data1 + 1, NULL);
+      if(input->data1[0] == 'a') {
+	if(read_eof && offset >= read_pos) {
+	  /* The host has received the whole file. */
+	  PROCESS_EXIT();
+	}
+	read_limit = offset + (uint32_t)read_window * CHUNK_SIZE;
+      } else if(input->data1[0] == 'r') {
+	read_pos = offset;
+	read_limit = offset + (uint32_t)read_window * CHUNK_SIZE;
+	read_eof = 0;
+	cfs_seek(read_fd, read_pos, CFS_SEEK_SET);
+      }
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_request(uint8_t type)
+{
+  struct xfer_msg *msg;
+  int len;
+
+  packetbuf_clear();
+  msg = packetbuf_dataptr();
+  msg->type = type;
+  msg->window = fetch_window;
+  put32(msg->offset, fetch_pos);
+  msg->crc[0] = msg->crc[1] = 0;
+  len = sizeof(struct xfer_msg);
+  if(type == XFER_SEEK) {
+    strcpy((char *)msg + len, fetch_name);
+    len += strlen(fetch_name) + 1;
+  }
+  packetbuf_set_datalen(len);
+  unicast_send(&req_uc, &fetch_peer);
+  fetch_acked = fetch_pos;
+}
+/*---------------------------------------------------------------------------*/
+static void
+serve_send_chunk(void)
+{
+  struct xfer_msg *msg;
+  uint8_t *buf;
+  uint16_t crc;
+  int len;
+
+  packetbuf_clear();
+  msg = packetbuf_dataptr();
+  buf = (uint8_t *)msg + sizeof(struct xfer_msg);
+  len = cfs_read(serve_fd, buf, CHUNK_SIZE);
+  if(len <= 0) {
+    len = 0;
+    serve_eof = 1;
+  }
+  crc = crc16_data(buf, len, 0);
+  msg->type = XFER_DATA;
+  msg->window = 0;
+  put32(msg->offset, serve_pos);
+  msg->crc[0] = crc >> 8;
+  msg->crc[1] = crc & 0xff;
+  packetbuf_set_datalen(sizeof(struct xfer_msg) + len);
+
+  serve_pos += len;
+  serve_sending = 1;
+  if(!unicast_send(&data_uc, &serve_peer)) {
+    serve_sending = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+recv_req(struct unicast_conn *c, const rimeaddr_t *from)
+{
+  struct xfer_msg *msg;
+  char *name;
+  int len;
+
+  msg = packetbuf_dataptr();
+  len = packetbuf_datalen();
+  if(len < sizeof(struct xfer_msg)) {
+    return;
+  }
+
+  if(msg->type == XFER_SEEK) {
+    if(len == sizeof(struct xfer_msg)) {
+      return;
+    }
+    name = (char *)msg + sizeof(struct xfer_msg);
+    name[len - sizeof(struct xfer_msg) - 1] = 0;
+    if(serve_fd >= 0) {
+      cfs_close(serve_fd);
+    }
+    serve_fd = cfs_open(name, CFS_READ);
+    PRINTF("xfer: %d.%d seeks '%s' to %lu\n", from->u8[0], from->u8[1],
+	   name, (unsigned long)get32(msg->offset));
+    rimeaddr_copy(&serve_peer, from);
+    serve_pos = get32(msg->offset);
+    serve_eof = 0;
+    if(serve_fd >= 0) {
+      cfs_seek(serve_fd, serve_pos, CFS_SEEK_SET);
+    }
+  } else if(msg->type != XFER_ACK ||
+	    !rimeaddr_cmp(from, &serve_peer)) {
+    return;
+  }
+  serve_limit = get32(msg->offset) + (uint32_t)msg->window * CHUNK_SIZE;
+  process_poll(&xfer_server_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sent_data(struct unicast_conn *c, int status, int num_tx)
+{
+  serve_sending = 0;
+  process_poll(&xfer_server_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+recv_data(struct unicast_conn *c, const rimeaddr_t *from)
+{
+  struct xfer_msg *msg;
+  uint8_t *buf;
+  int len;
+
+  if(fetch_fd < 0 || fetch_done || !rimeaddr_cmp(from, &fetch_peer)) {
+    return;
+  }
+
+  msg = packetbuf_dataptr();
+  len = packetbuf_datalen() - sizeof(struct xfer_msg);
+  if(len < 0 || msg->type != XFER_DATA) {
+    return;
+  }
+  buf = (uint8_t *)msg + sizeof(struct xfer_msg);
+
+  if(get32(msg->offset) != fetch_pos ||
+     crc16_data(buf, len, 0) != ((msg->crc[0] << 8) | msg->crc[1])) {
+    /* A chunk was lost or damaged: go back to the first missing
+       byte. Chunks that are already in flight are dropped until the
+       sender has restarted from there. */
+    if(!fetch_seeking) {
+      fetch_seeking = 1;
+      send_request(XFER_SEEK);
+    }
+    return;
+  }
+  fetch_seeking = 0;
+
+  if(len == 0) {
+    fetch_done = 1;
+  } else if(cfs_write(fetch_fd, buf, len) != len) {
+    fetch_done = 2;
+  } else {
+    fetch_pos += len;
+    if(fetch_pos - fetch_acked >= (uint32_t)fetch_window * CHUNK_SIZE / 2) {
+      send_request(XFER_ACK);
+    }
+  }
+  process_poll(&shell_xfer_fetch_process);
+}
+/*---------------------------------------------------------------------------*/
+static const struct unicast_callbacks req_callbacks = {recv_req};
+static const struct unicast_callbacks data_callbacks = {recv_data, sent_data};
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(xfer_server_process, ev, data)
+{
+  static struct etimer etimer;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT();
+
+    if(ev == PROCESS_EVENT_POLL) {
+      etimer_set(&etimer, IDLE_TIMEOUT);
+      if(serve_fd >= 0 && !serve_sending &&
+	 !serve_eof && serve_pos < serve_limit) {
+	serve_send_chunk();
+      }
+    } else if(ev == PROCESS_EVENT_TIMER && etimer_expired(&etimer) &&
+	      serve_fd >= 0) {
+      /* The peer has stopped asking for data. */
+      cfs_close(serve_fd);
+      serve_fd = -1;
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+fetch_close(void)
+{
+  if(fetch_fd >= 0) {
+    cfs_close(fetch_fd);
+  }
+  fetch_fd = -1;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_xfer_fetch_process, ev, data)
+{
+  static struct etimer etimer;
+  static uint8_t retries;
+  static uint32_t start_pos;
+  static clock_time_t start_time;
+  char local_name[FILENAME_LEN];
+  char buf[48];
+  const char *next;
+  unsigned long secs;
+
+  PROCESS_EXITHANDLER(fetch_close());
+  PROCESS_BEGIN();
+
+  fetch_peer.u8[0] = shell_strtolong(data, &next);
+  if(next == data || *next != '.') {
+    shell_output_str(&xfer_fetch_command,
+		     "usage: ", xfer_fetch_command.description);
+    PROCESS_EXIT();
+  }
+  ++next;
+  fetch_peer.u8[1] = shell_strtolong(next, &next);
+
+  next = parse_filename(next, fetch_name);
+  if(next == NULL) {
+    shell_output_str(&xfer_fetch_command,
+		     "usage: ", xfer_fetch_command.description);
+    PROCESS_EXIT();
+  }
+  if(parse_filename(next, local_name) == NULL) {
+    strcpy(local_name, fetch_name);
+  }
+
+  /* Data that is already in the local file is not fetched again, so
+     that an interrupted transfer can be resumed. */
+  fetch_fd = cfs_open(local_name, CFS_WRITE | CFS_APPEND);
+  if(fetch_fd < 0) {
+    shell_output_str(&xfer_fetch_command,
+		     "xfer-fetch: could not open file ", local_name);
+    PROCESS_EXIT();
+  }
+  fetch_pos = cfs_seek(fetch_fd, 0, CFS_SEEK_END);
+  if(fetch_pos == (uint32_t)-1) {
+    fetch_pos = 0;
+  }
+  start_pos = fetch_pos;
+  start_time = clock_time();
+  fetch_window = DEFAULT_WINDOW;
+  fetch_done = 0;
+  fetch_seeking = 0;
+  retries = 0;
+
+  send_request(XFER_SEEK);
+  etimer_set(&etimer, TIMEOUT);
+  while(!fetch_done) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL ||
+			     etimer_expired(&etimer));
+    if(ev == PROCESS_EVENT_POLL) {
+      retries = 0;
+      etimer_restart(&etimer);
+    } else if(++retries > MAX_RETRIES) {
+      snprintf(buf, sizeof(buf), "%d.%d after %lu bytes",
+	       fetch_peer.u8[0], fetch_peer.u8[1], (unsigned long)fetch_pos);
+      shell_output_str(&xfer_fetch_command, "xfer-fetch: no answer from ",
+		       buf);
+      PROCESS_EXIT();
+    } else {
+      fetch_seeking = 1;
+      send_request(XFER_SEEK);
+      etimer_restart(&etimer);
+    }
+  }
+
+  if(fetch_done != 1) {
+    shell_output_str(&xfer_fetch_command,
+		     "xfer-fetch: could not write to file ", local_name);
+    PROCESS_EXIT();
+  }
+
+  secs = (clock_time() - start_time) / CLOCK_SECOND;
+  snprintf(buf, sizeof(buf), "%lu bytes in %lu seconds",
+	   (unsigned long)(fetch_pos - start_pos), secs);
+  shell_output_str(&xfer_fetch_command, "xfer-fetch: done, ", buf);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_xfer_init(void)
+{
+  unicast_open(&req_uc, SHELL_RIME_CHANNEL_XFER, &req_callbacks);
+  unicast_open(&data_uc, SHELL_RIME_CHANNEL_XFER + 1, &data_callbacks);
+  process_start(&xfer_server_process, NULL);
+  shell_register_command(&xfer_read_command);
+  shell_register_command(&xfer_fetch_command);
+}
+/*---------------------------------------------------------------------------*/
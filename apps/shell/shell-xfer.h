@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Windowed, resumable binary file transfer over the serial
+ *         shell and over Rime
+ *
+ *         The xfer-read command sends a file to the host over the
+ *         shell output as binary frames. Each frame carries a
+ *         three-byte "#XF" marker, the 32-bit big-endian file
+ *         offset of the data, the data length, the CRC16 of the
+ *         data and the data itself. A frame with no data marks the
+ *         end of the file. While xfer-read runs, the host controls
+ *         it with input lines: "a <offset>" acknowledges all data
+ *         before offset and opens the window from there, and
+ *         "r <offset>" restarts the transfer at offset after a lost
+ *         or damaged frame.
+ *
+ *         The xfer-fetch command copies a file from another node
+ *         with the same windowed protocol over Rime unicast. Every
+ *         node that runs shell_xfer_init() serves its files.
+ *
+ *         tools/shell-xfer is the host side.
+ */
+
+#ifndef __SHELL_XFER_H__
+#define __SHELL_XFER_H__
+
+#include "shell.h"
+
+void shell_xfer_init(void);
+
+#define SHELL_XFER_FRAME_HDRLEN 10
+
+#endif /* __SHELL_XFER_H__ */
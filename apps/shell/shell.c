@@ -296,6 +296,7 @@ start_command(char *commandline, struct shell_command *child)
     c = NULL;
   } else {
     c->child = child;
+    c->busy = 0;
     /*    printf("shell: start_command starting '%s'\n", c->process->name);*/
     /* Start a new process for the command. */
     process_start(c->process, args);
@@ -404,6 +405,51 @@ shell_output(struct shell_command *c,
 }
 /*---------------------------------------------------------------------------*/
 void
+shell_forward(struct shell_command *c, struct shell_input *input)
+{
+  if(c != NULL && c->child != NULL) {
+    if(process_is_running(c->child->process)) {
+      process_post_synch(c->child->process, shell_event_input, input);
+    }
+  } else {
+    shell_default_output(input->data1, input->len1,
+			 input->data2, input->len2);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+shell_output_busy(struct shell_command *c)
+{
+  for(c = c->child; c != NULL; c = c->child) {
+    if(c->busy && process_is_running(c->process)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_set_busy(struct shell_command *c, int busy)
+{
+  struct shell_command *p, *i;
+
+  c->busy = busy;
+  if(busy) {
+    return;
+  }
+
+  /* Wake up the commands that feed this command with data. */
+  for(p = list_head(commands); p != NULL; p = p->next) {
+    if(p != c && process_is_running(p->process)) {
+      for(i = p->child; i != NULL && i != c; i = i->child);
+      if(i == c) {
+	process_post(p->process, PROCESS_EVENT_CONTINUE, NULL);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
 shell_unregister_command(struct shell_command *c)
 {
   list_remove(commands, c);
@@ -480,6 +526,11 @@ PROCESS_THREAD(shell_server_process, ev, data)
       for(c = list_head(commands);
 	  c != NULL && c->process != p;
 	  c = c->next);
+      if(c != NULL && c->busy) {
+	/* Do not leave the commands that feed the exited command
+	   waiting. */
+	shell_set_busy(c, 0);
+      }
       while(c != NULL) {
 	if(c->child != NULL && c->child->process != NULL) {
 	  /*	  printf("Killing '%s'\n", c->process->name);*/
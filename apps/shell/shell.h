@@ -76,8 +76,11 @@ struct shell_command {
   char *description;
   struct process *process;
   struct shell_command *child;
+  unsigned char busy;
 };
 
+struct shell_input;
+
 /**
  * \name       Shell back-end API
  *
@@ -257,6 +260,50 @@ void shell_output(struct shell_command *c,
 void shell_output_str(struct shell_command *c,
 		      char *str1, const char *str2);
 
+/**
+ * \brief      Forward input data to the next command in a pipeline
+ * \param c    The command that forwards the data
+ * \param input The input that the command received
+ *
+ *             This function is called by pass-through commands that
+ *             do not modify their input. The input is handed to the
+ *             next command in the pipeline as it is, without being
+ *             copied or split up.
+ *
+ */
+void shell_forward(struct shell_command *c, struct shell_input *input);
+
+/**
+ * \brief      Check if the rest of a pipeline is ready for more data
+ * \param c    The command that outputs data
+ * \retval 0   The commands after c are ready for more data
+ * \retval 1   A command after c is still busy with earlier data
+ *
+ *             This function is called by commands that produce
+ *             large amounts of data, such as the read command. If
+ *             it returns non-zero, the command should wait for a
+ *             PROCESS_EVENT_CONTINUE event before producing more
+ *             output.
+ *
+ */
+int shell_output_busy(struct shell_command *c);
+
+/**
+ * \brief      Tell the shell that a command is busy with its input
+ * \param c    The command
+ * \param busy Non-zero if the command cannot accept more input
+ *
+ *             This function is called by commands that handle their
+ *             input asynchronously, such as commands that send the
+ *             input over the radio. While the command is busy,
+ *             shell_output_busy() returns non-zero for the commands
+ *             that feed it with data. When the command is no longer
+ *             busy, the shell posts a PROCESS_EVENT_CONTINUE event to
+ *             those commands.
+ *
+ */
+void shell_set_busy(struct shell_command *c, int busy);
+
 /**
  * \brief      Register a command with the shell
  * \param c    A pointer to a shell command structure, defined with SHELL_COMMAND()
@@ -383,8 +430,10 @@ struct shell_input {
 #include "shell-httpd.h"
 #include "shell-irc.h"
 #include "shell-memdebug.h"
+#include "shell-metrics.h"
 #include "shell-netfile.h"
 #include "shell-netperf.h"
+#include "shell-netperf6.h"
 #include "shell-netstat.h"
 #include "shell-ping.h"
 #include "shell-power.h"
@@ -409,6 +458,7 @@ struct shell_input {
 #include "shell-time.h"
 #include "shell-udpsend.h"
 #include "shell-vars.h"
+#include "shell-xfer.h"
 #include "shell-wget.h"
 
 #endif /* __SHELL_H__ */
@@ -53,6 +53,18 @@ AUTOSTART_PROCESSES(&telnetd_process);
 #ifndef TELNETD_CONF_NUMLINES
 #define TELNETD_CONF_NUMLINES 25
 #endif
+#ifdef TELNETD_CONF_BUFSIZE
+#define BUFSIZE TELNETD_CONF_BUFSIZE
+#else
+#define BUFSIZE (TELNETD_CONF_NUMLINES * TELNETD_CONF_LINELEN)
+#endif
+/* Shell output is held back for at most this long while waiting for
+   enough data to fill a segment. */
+#ifdef TELNETD_CONF_FLUSH_TIME
+#define FLUSH_TIME TELNETD_CONF_FLUSH_TIME
+#else
+#define FLUSH_TIME (CLOCK_SECOND / 8)
+#endif
 
 #ifdef TELNETD_CONF_REJECT
 extern char telnetd_reject_text[];
@@ -65,6 +77,7 @@ struct telnetd_state {
   char buf[TELNETD_CONF_LINELEN + 1];
   char bufptr;
   uint16_t numsent;
+  uint8_t flush;
   uint8_t state;
 #define STATE_NORMAL 0
 #define STATE_IAC    1
@@ -74,6 +87,8 @@ struct telnetd_state {
 #define STATE_DONT   5
 #define STATE_CLOSE  6
   struct timer silence_timer;
+  struct ctimer flush_timer;
+  struct uip_conn *conn;
 };
 static struct telnetd_state s;
 
@@ -92,9 +107,9 @@ static struct telnetd_state s;
 #endif
 
 struct telnetd_buf {
-  char bufmem[TELNETD_CONF_NUMLINES * TELNETD_CONF_LINELEN];
-  int ptr;
-  int size;
+  char bufmem[BUFSIZE];
+  int start;
+  int len;
 };
 
 static struct telnetd_buf buf;
@@ -108,20 +123,30 @@ static uint8_t connected;
 static void
 buf_init(struct telnetd_buf *buf)
 {
-  buf->ptr = 0;
-  buf->size = TELNETD_CONF_NUMLINES * TELNETD_CONF_LINELEN;
+  buf->start = 0;
+  buf->len = 0;
 }
 /*---------------------------------------------------------------------------*/
 static int
 buf_append(struct telnetd_buf *buf, const char *data, int len)
 {
-  int copylen;
+  int copylen, end, n;
+
+  PRINTF("buf_append len %d (%d) '%.*s'\n", len, buf->len, len, data);
+  copylen = MIN(len, BUFSIZE - buf->len);
 
-  PRINTF("buf_append len %d (%d) '%.*s'\n", len, buf->ptr, len, data);
-  copylen = MIN(len, buf->size - buf->ptr);
-  memcpy(&buf->bufmem[buf->ptr], data, copylen);
-  petsciiconv_toascii(&buf->bufmem[buf->ptr], copylen);
-  buf->ptr += copylen;
+  /* The buffer is circular, so the data may have to be split in two
+     parts. */
+  end = buf->start + buf->len;
+  if(end >= BUFSIZE) {
+    end -= BUFSIZE;
+  }
+  n = MIN(copylen, BUFSIZE - end);
+  memcpy(&buf->bufmem[end], data, n);
+  petsciiconv_toascii(&buf->bufmem[end], n);
+  memcpy(&buf->bufmem[0], data + n, copylen - n);
+  petsciiconv_toascii(&buf->bufmem[0], copylen - n);
+  buf->len += copylen;
 
   return copylen;
 }
@@ -129,7 +154,11 @@ buf_append(struct telnetd_buf *buf, const char *data, int len)
 static void
 buf_copyto(struct telnetd_buf *buf, char *to, int len)
 {
-  memcpy(to, &buf->bufmem[0], len);
+  int n;
+
+  n = MIN(len, BUFSIZE - buf->start);
+  memcpy(to, &buf->bufmem[buf->start], n);
+  memcpy(to + n, &buf->bufmem[0], len - n);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -137,16 +166,43 @@ buf_pop(struct telnetd_buf *buf, int len)
 {
   int poplen;
 
-  PRINTF("buf_pop len %d (%d)\n", len, buf->ptr);
-  poplen = MIN(len, buf->ptr);
-  memcpy(&buf->bufmem[0], &buf->bufmem[poplen], buf->ptr - poplen);
-  buf->ptr -= poplen;
+  PRINTF("buf_pop len %d (%d)\n", len, buf->len);
+  poplen = MIN(len, buf->len);
+  buf->start += poplen;
+  if(buf->start >= BUFSIZE) {
+    buf->start -= BUFSIZE;
+  }
+  buf->len -= poplen;
 }
 /*---------------------------------------------------------------------------*/
 static int
 buf_len(struct telnetd_buf *buf)
 {
-  return buf->ptr;
+  return buf->len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_timeout(void *ptr)
+{
+  if(s.conn != NULL) {
+    tcpip_poll_tcp(s.conn);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+output_added(void)
+{
+  /* Small pieces of output are coalesced into full segments, unless
+     the output ends with a prompt or a telnet option reply. Anything
+     else is sent when the flush timer expires. */
+  if(s.conn == NULL) {
+    return;
+  }
+  if(s.flush || buf_len(&buf) >= s.conn->mss) {
+    tcpip_poll_tcp(s.conn);
+  } else if(ctimer_expired(&s.flush_timer)) {
+    ctimer_set(&s.flush_timer, FLUSH_TIME, flush_timeout, NULL);
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -164,6 +220,8 @@ void
 shell_prompt(char *str)
 {
   buf_append(&buf, str, (int)strlen(str));
+  s.flush = 1;
+  output_added();
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -184,6 +242,7 @@ shell_default_output(const char *str1, int len1, const char *str2, int len2)
   buf_append(&buf, str1, len1);
   buf_append(&buf, str2, len2);
   buf_append(&buf, "\r\n", 2);
+  output_added();
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -226,13 +285,30 @@ static void
 acked(void)
 {
   buf_pop(&buf, s.numsent);
+  s.numsent = 0;
 }
 /*---------------------------------------------------------------------------*/
 static void
 senddata(void)
 {
   int len;
-  len = MIN(buf_len(&buf), uip_mss());
+
+  if(uip_rexmit()) {
+    len = s.numsent;
+  } else if(s.numsent > 0) {
+    /* Data is still in flight. */
+    return;
+  } else {
+    len = buf_len(&buf);
+    if(len < uip_mss() && !s.flush && !ctimer_expired(&s.flush_timer)) {
+      /* Wait for more output to fill the segment. */
+      return;
+    }
+    if(len <= uip_mss()) {
+      s.flush = 0;
+    }
+    len = MIN(len, uip_mss());
+  }
   PRINTF("senddata len %d\n", len);
   buf_copyto(&buf, uip_appdata, len);
   uip_send(uip_appdata, len);
@@ -274,6 +350,7 @@ sendopt(uint8_t option, uint8_t value)
   line[3] = 0;
   petsciiconv_topetscii(line, 4);
   buf_append(&buf, line, 4);
+  s.flush = 1;
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -356,7 +433,10 @@ telnetd_appcall(void *ts)
     if(!connected) {
       buf_init(&buf);
       s.bufptr = 0;
+      s.numsent = 0;
+      s.flush = 0;
       s.state = STATE_NORMAL;
+      s.conn = uip_conn;
       connected = 1;
       shell_start();
       timer_set(&s.silence_timer, MAX_SILENCE_TIME);
@@ -378,6 +458,8 @@ telnetd_appcall(void *ts)
        uip_aborted() ||
        uip_timedout()) {
       shell_stop();
+      ctimer_stop(&s.flush_timer);
+      s.conn = NULL;
       connected = 0;
     }
     if(uip_acked()) {
@@ -134,6 +134,7 @@ G * (<br>, <p>, <h>), the <li> tag (but does not even try to
 #define MINORSTATE_TAGATTRPARAMNQ 8 /* Parse tag attr parameter without
 				  quotation marks. */
 #define MINORSTATE_HTMLCOMMENT    9 /* Scan for HTML comment end */
+#define MINORSTATE_SKIP          10 /* Skip script or style content */
 
 #define MAJORSTATE_NONE       0
 #define MAJORSTATE_BODY       1
@@ -153,6 +154,7 @@ struct htmlparser_state {
   unsigned char tagattrparamptr;
   unsigned char lastchar, quotechar;
   unsigned char majorstate, lastmajorstate;
+  unsigned char skip;
   char linkurl[WWW_CONF_MAX_URLLEN + 1];
 
   char word[WWW_CONF_WEBPAGE_WIDTH];
@@ -170,8 +172,6 @@ struct htmlparser_state {
 static struct htmlparser_state s;
 
 /*-----------------------------------------------------------------------------------*/
-static char last[1] = {(char)0xff};
-
 static const char *tags[] = {
 #define TAG_FIRST       0
 #define TAG_SLASHA      0
@@ -223,7 +223,29 @@ static const char *tags[] = {
 #define TAG_TR         23
   html_tr,
 #define TAG_LAST       24
-  last,
+};
+
+/* Perfect hash of the tag names above, indexed by the hash value
+   computed in find_tag(). The hash function was chosen to be
+   collision free for the tags in html-strings, so this table has to
+   be recomputed if tags are added. */
+static const unsigned char taghash[64] = {
+  TAG_INPUT, TAG_H3, TAG_LAST, TAG_STYLE,
+  TAG_TR, TAG_LAST, TAG_SLASHSTYLE, TAG_LAST,
+  TAG_LAST, TAG_SLASHDIV, TAG_H4, TAG_LAST,
+  TAG_LAST, TAG_IMG, TAG_LAST, TAG_LAST,
+  TAG_LAST, TAG_A, TAG_LAST, TAG_LAST,
+  TAG_LAST, TAG_LAST, TAG_LAST, TAG_BODY,
+  TAG_LAST, TAG_SCRIPT, TAG_LAST, TAG_LAST,
+  TAG_LAST, TAG_LAST, TAG_LAST, TAG_LAST,
+  TAG_LAST, TAG_LAST, TAG_LAST, TAG_LAST,
+  TAG_SLASHSCRIPT, TAG_SLASHH, TAG_SLASHA, TAG_P,
+  TAG_LAST, TAG_LAST, TAG_LAST, TAG_LI,
+  TAG_LAST, TAG_LAST, TAG_LAST, TAG_H1,
+  TAG_LAST, TAG_LAST, TAG_BR, TAG_LAST,
+  TAG_SLASHSELECT, TAG_LAST, TAG_FRAME, TAG_SLASHFORM,
+  TAG_H2, TAG_SELECT, TAG_LAST, TAG_LAST,
+  TAG_LAST, TAG_LAST, TAG_LAST, TAG_FORM,
 };
 
 /*-----------------------------------------------------------------------------------*/
@@ -255,6 +277,7 @@ htmlparser_init(void)
   s.majorstate = s.lastmajorstate = MAJORSTATE_DISCARD;
   s.minorstate = MINORSTATE_TEXT;
   s.lastchar = 0;
+  s.skip = 0;
 #if WWW_CONF_FORMS
   s.formaction[0] = 0;
 #endif /* WWW_CONF_FORMS */
@@ -328,39 +351,22 @@ newline(void)
 static unsigned char CC_FASTCALL
 find_tag(char *tag)
 {
-  static unsigned char first, last, i, tabi;
-  static char tagc;
-  
-  first = TAG_FIRST;
-  last = TAG_LAST;
-  i = 0;
-
-  do {
-    tagc = tag[i];
-
-    if((tagc == 0 || tagc == ISO_slash) && tags[first][i] == 0) {
-      return first;
-    }
-
-    tabi = first;
-
-    /* First, find first matching tag from table. */
-    while(tagc > (tags[tabi])[i] && tabi < last) {
-      ++tabi;
-    }
-    first = tabi;
+  static unsigned char len, t;
 
-    /* Second, find last matching tag from table. */
-    while(tagc == (tags[tabi])[i] && tabi < last) {
-      ++tabi;
-    }
-    last = tabi;
+  if(tag[0] == 0) {
+    return TAG_LAST;
+  }
 
-    /* If first and last matching tags are equal, we have a non-match
-       and return. Else we continue with the next character. */
-    ++i;
+  /* The name ends at the first slash that is not its first
+     character, as in <br/>. */
+  for(len = 1; tag[len] != 0 && tag[len] != ISO_slash; ++len);
 
-  } while(last != first);
+  t = taghash[(tag[0] + (tag[len >> 1] << 3) + tag[len - 1] +
+	       (len << 3) - len) & 63];
+  if(t != TAG_LAST && tags[t][len] == 0 &&
+     strncmp(tags[t], tag, len) == 0) {
+    return t;
+  }
   return TAG_LAST;
 }
 /*-----------------------------------------------------------------------------------*/
@@ -396,6 +402,10 @@ parse_tag(void)
     break;
   case TAG_SCRIPT:
   case TAG_STYLE:
+    /* The contents are never rendered, so the tokenizer can skip
+       ahead to the end tag without parsing it. */
+    s.skip = 1;
+    /* FALLTHROUGH */
   case TAG_SELECT:
     switch_majorstate(MAJORSTATE_DISCARD);
     break;
@@ -538,6 +548,11 @@ parse_word(char *data, uint8_t dlen)
 
   len = dlen;
 
+  if(s.minorstate == MINORSTATE_TEXT && s.skip) {
+    s.minorstate = MINORSTATE_SKIP;
+    s.lastchar = 0;
+  }
+
   switch(s.minorstate) {
   case MINORSTATE_TEXT:
     for(i = 0; i < len; ++i) {
@@ -771,6 +786,20 @@ parse_word(char *data, uint8_t dlen)
       }
     }
     break;
+  case MINORSTATE_SKIP:
+    /* Discard characters until the start of an end tag is seen. */
+    for(i = 0; i < len; ++i) {
+      c = data[i];
+      if(c == ISO_slash && s.lastchar == ISO_lt) {
+	s.skip = 0;
+	s.minorstate = MINORSTATE_TAG;
+	s.tag[0] = ISO_slash;
+	s.tagptr = 1;
+	break;
+      }
+      s.lastchar = c;
+    }
+    break;
   case MINORSTATE_TAGEND:
     /* Discard characters until a '>' is seen. */
     for(i = 0; i < len; ++i) {
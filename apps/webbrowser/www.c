@@ -170,6 +170,7 @@ static struct inputattrib *currptr;
 /* The state of the rendering code. */
 static char *webpageptr;
 static unsigned char x, y;
+static unsigned char redrawy;
 static unsigned char loading;
 static unsigned short firsty, pagey;
 
@@ -266,7 +267,7 @@ static void
 start_loading(void)
 {
   loading = 1;
-  x = y = 0;
+  x = y = redrawy = 0;
   pagey = 0;
   webpageptr = webpage;
 
@@ -664,7 +665,12 @@ webclient_datahandler(char *data, uint16_t len)
       count = (count + 1) & 3;
       show_statustext(receivingmsgs[count]);
       htmlparser_parse(data, len);
-      redraw_window();
+      /* Redrawing the whole window is slow, so only do it when more
+	 lines of the visible part of the page have been laid out. */
+      if(y != redrawy) {
+	redrawy = y;
+	redraw_window();
+      }
     } else {
       show_statustext("Cannot display web page");
       uip_abort();
@@ -15,6 +15,18 @@ extern const char http_404_html[10];
 extern const char http_referer[9];
 extern const char http_header_200[85];
 extern const char http_header_404[92];
+extern const char http_header_11_200[66];
+extern const char http_header_11_404[73];
+extern const char http_connection[12];
+extern const char http_close[6];
+extern const char http_connection_close[20];
+extern const char http_content_length[17];
+extern const char http_connection_close_crnl[22];
+extern const char http_header_11_304[76];
+extern const char http_etag[7];
+extern const char http_if_none_match[15];
+extern const char http_accept_encoding[17];
+extern const char http_gzip[5];
 extern const char http_content_type_plain[29];
 extern const char http_content_type_html[28];
 extern const char http_content_type_css [27];
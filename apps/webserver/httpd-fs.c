@@ -32,8 +32,11 @@
  *
  */
 
+#include <string.h>
+
 #include "contiki-net.h"
 #include "httpd.h"
+#include "http-strings.h"
 #include "httpd-fs.h"
 #include "httpd-fsdata.h"
 
@@ -65,8 +68,23 @@ loop:
   goto loop;
 }
 /*-----------------------------------------------------------------------------------*/
-int
-httpd_fs_open(const char *name, struct httpd_fs_file *file)
+static struct httpd_fsdata_file_noconst *
+find_file(const char *name)
+{
+  struct httpd_fsdata_file_noconst *f;
+
+  for(f = (struct httpd_fsdata_file_noconst *)HTTPD_FS_ROOT;
+      f != NULL;
+      f = (struct httpd_fsdata_file_noconst *)f->next) {
+    if(httpd_fs_strcmp(name, f->name) == 0) {
+      break;
+    }
+  }
+  return f;
+}
+/*-----------------------------------------------------------------------------------*/
+static int
+open_file(const char *name, struct httpd_fs_file *file, uint8_t gzip)
 {
 #if HTTPD_FS_STATISTICS
   uint16_t i = 0;
@@ -78,8 +96,17 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
       f = (struct httpd_fsdata_file_noconst *)f->next) {
 
     if(httpd_fs_strcmp(name, f->name) == 0) {
-      file->data = f->data;
-      file->len = f->len;
+      if(gzip && f->gzdata != NULL) {
+	file->data = f->gzdata;
+	file->len = f->gzlen;
+	file->header = f->gzheader;
+	file->segments = NULL;
+      } else {
+	file->data = f->data;
+	file->len = f->len;
+	file->header = f->header;
+	file->segments = f->segments;
+      }
 #if HTTPD_FS_STATISTICS
       ++count[i];
 #endif /* HTTPD_FS_STATISTICS */
@@ -93,6 +120,65 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
   return 0;
 }
 /*-----------------------------------------------------------------------------------*/
+int
+httpd_fs_open(const char *name, struct httpd_fs_file *file)
+{
+  return open_file(name, file, 0);
+}
+/*-----------------------------------------------------------------------------------*/
+int
+httpd_fs_open_gzip(const char *name, struct httpd_fs_file *file)
+{
+  return open_file(name, file, 1);
+}
+/*-----------------------------------------------------------------------------------*/
+static uint8_t
+etag_equal(const char *header, const char *etag)
+{
+  header = strstr(header, http_etag);
+  if(header == NULL) {
+    return 0;
+  }
+  header += sizeof(http_etag) - 1;
+
+  /* Both are quoted strings, so the closing quote ends the match. */
+  if(*header != *etag) {
+    return 0;
+  }
+  do {
+    ++header;
+    ++etag;
+    if(*header != *etag) {
+      return 0;
+    }
+  } while(*header != '"');
+  return 1;
+}
+/*-----------------------------------------------------------------------------------*/
+uint8_t
+httpd_fs_match_etag(const char *name, const char *etag)
+{
+  struct httpd_fsdata_file_noconst *f;
+  uint8_t variants;
+
+  f = find_file(name);
+  if(f == NULL || f->header == NULL) {
+    return 0;
+  }
+
+  variants = 0;
+  if(etag_equal(f->header, etag)) {
+    variants |= HTTPD_FS_IDENTITY;
+  }
+  if(f->gzheader == NULL) {
+    /* httpd_fs_open_gzip() opens the same data. */
+    variants |= variants << 1;
+  } else if(etag_equal(f->gzheader, etag)) {
+    variants |= HTTPD_FS_GZIP;
+  }
+  return variants;
+}
+/*-----------------------------------------------------------------------------------*/
 void
 httpd_fs_init(void)
 {
@@ -38,15 +38,48 @@
 
 #define HTTPD_FS_STATISTICS 1
 
+/* A static chunk of a script and the directive that follows it, as
+   split by makefsdata -T. */
+struct httpd_fs_segment {
+  const char *text;
+  unsigned short len;
+  /* The CGI id of the directive, or one of the values below. */
+  uint8_t cgi;
+  /* The directive as httpd_cgi() takes it. */
+  const char *arg;
+};
+
+#define HTTPD_FS_SEGMENT_INCLUDE 0xfe
+#define HTTPD_FS_SEGMENT_END     0xff
+
 struct httpd_fs_file {
   char *data;
   int len;
+  /* The complete response header for data, or NULL if the file
+     system was generated without precomputed headers. */
+  char *header;
+  /* The script split into segments, ending with an
+     HTTPD_FS_SEGMENT_END segment, or NULL. */
+  const struct httpd_fs_segment *segments;
 };
 
+/* The ways of opening a file, as returned by httpd_fs_match_etag():
+   with httpd_fs_open() and with httpd_fs_open_gzip(). */
+#define HTTPD_FS_IDENTITY 0x01
+#define HTTPD_FS_GZIP     0x02
+
 /* file must be allocated by caller and will be filled in
    by the function. */
 int httpd_fs_open(const char *name, struct httpd_fs_file *file);
 
+/* Like httpd_fs_open(), but opens the gzip-encoded variant of the
+   file if there is one. */
+int httpd_fs_open_gzip(const char *name, struct httpd_fs_file *file);
+
+/* Returns the ways of opening the file that give the data whose
+   quoted ETag etag starts with. */
+uint8_t httpd_fs_match_etag(const char *name, const char *etag);
+
 #ifdef HTTPD_FS_STATISTICS
 #if HTTPD_FS_STATISTICS == 1  
 uint16_t httpd_fs_count(char *name);
@@ -1,183 +1,6 @@
-/*********Generated by contiki/tools/makefsdata on 2013-05-09*********/
+/*********Generated by contiki/tools/makefsdata on 2026-10-15*********/
 
 
-const char data_processes_shtml[185]  = {
-  /* /processes.shtml */
-   0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
-   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x68, 0x31,
-   0x3e, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x20, 0x70, 0x72,
-   0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73, 0x3c, 0x2f, 0x68,
-   0x31, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x74, 0x61, 0x62,
-   0x6c, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x22,
-   0x31, 0x30, 0x30, 0x25, 0x22, 0x3e, 0x0a, 0x3c, 0x74, 0x72,
-   0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x49, 0x44, 0x3c, 0x2f, 0x74,
-   0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x4e, 0x61, 0x6d, 0x65,
-   0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x54,
-   0x68, 0x72, 0x65, 0x61, 0x64, 0x3c, 0x2f, 0x74, 0x68, 0x3e,
-   0x3c, 0x74, 0x68, 0x3e, 0x50, 0x72, 0x6f, 0x63, 0x65, 0x73,
-   0x73, 0x20, 0x73, 0x74, 0x61, 0x74, 0x65, 0x3c, 0x2f, 0x74,
-   0x68, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x25, 0x21,
-   0x20, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73,
-   0x0a, 0x25, 0x21, 0x3a, 0x20, 0x2f, 0x66, 0x6f, 0x6f, 0x74,
-   0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a};
-
-const char data_footer_html[30]  = {
-  /* /footer.html */
-   0x2f, 0x66, 0x6f, 0x6f, 0x74, 0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x20, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a,
-   0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e};
-
-const char data_files_shtml[782]  = {
-  /* /files.shtml */
-   0x2f, 0x66, 0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
-   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x20, 0x3c, 0x68,
-   0x31, 0x3e, 0x46, 0x69, 0x6c, 0x65, 0x20, 0x73, 0x74, 0x61,
-   0x74, 0x69, 0x73, 0x74, 0x69, 0x63, 0x73, 0x3c, 0x2f, 0x68,
-   0x31, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x74, 0x61, 0x62,
-   0x6c, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x22,
-   0x31, 0x30, 0x30, 0x25, 0x22, 0x3e, 0x0a, 0x20, 0x3c, 0x74,
-   0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20, 0x68,
-   0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f, 0x69, 0x6e, 0x64, 0x65,
-   0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e, 0x2f, 0x69,
-   0x6e, 0x64, 0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x3c,
-   0x2f, 0x61, 0x3e, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x20,
-   0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21, 0x20, 0x66, 0x69, 0x6c,
-   0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2f, 0x69,
-   0x6e, 0x64, 0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a,
-   0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e,
-   0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x3c,
-   0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f, 0x66,
-   0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c,
-   0x22, 0x3e, 0x2f, 0x66, 0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73,
-   0x68, 0x74, 0x6d, 0x6c, 0x3c, 0x2f, 0x61, 0x3e, 0x3c, 0x2f,
-   0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21,
-   0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74, 0x61, 0x74,
-   0x73, 0x20, 0x2f, 0x66, 0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73,
-   0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e,
-   0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e,
-   0x3c, 0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65,
-   0x66, 0x3d, 0x22, 0x2f, 0x74, 0x63, 0x70, 0x2e, 0x73, 0x68,
-   0x74, 0x6d, 0x6c, 0x22, 0x3e, 0x2f, 0x74, 0x63, 0x70, 0x2e,
-   0x73, 0x68, 0x74, 0x6d, 0x6c, 0x3c, 0x2f, 0x61, 0x3e, 0x3c,
-   0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e, 0x25,
-   0x21, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74, 0x61,
-   0x74, 0x73, 0x20, 0x2f, 0x74, 0x63, 0x70, 0x2e, 0x73, 0x68,
-   0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c,
-   0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c,
-   0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66,
-   0x3d, 0x22, 0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73,
-   0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e,
-   0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73,
-   0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x3c, 0x2f, 0x61, 0x3e,
-   0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e,
-   0x25, 0x21, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74,
-   0x61, 0x74, 0x73, 0x20, 0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65,
-   0x73, 0x73, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c,
-   0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72,
-   0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e,
-   0x3c, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f,
-   0x73, 0x74, 0x79, 0x6c, 0x65, 0x2e, 0x63, 0x73, 0x73, 0x22,
-   0x3e, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x2e, 0x63, 0x73,
-   0x73, 0x3c, 0x2f, 0x61, 0x3e, 0x3c, 0x2f, 0x74, 0x64, 0x3e,
-   0x0a, 0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21, 0x20, 0x66, 0x69,
-   0x6c, 0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2f,
-   0x63, 0x6f, 0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2e, 0x63, 0x73,
-   0x73, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74,
-   0x72, 0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64,
-   0x3e, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22,
-   0x2f, 0x34, 0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22,
-   0x3e, 0x2f, 0x34, 0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c,
-   0x3c, 0x2f, 0x61, 0x3e, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a,
-   0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21, 0x20, 0x66, 0x69, 0x6c,
-   0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2f, 0x34,
-   0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x2f,
-   0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c,
-   0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20,
-   0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f, 0x69, 0x6d, 0x67,
-   0x2f, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x73, 0x68, 0x6f,
-   0x74, 0x2e, 0x70, 0x6e, 0x67, 0x22, 0x3e, 0x2f, 0x69, 0x6d,
-   0x67, 0x2f, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x73, 0x68,
-   0x6f, 0x74, 0x2e, 0x70, 0x6e, 0x67, 0x3c, 0x2f, 0x61, 0x3e,
-   0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e,
-   0x25, 0x21, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74,
-   0x61, 0x74, 0x73, 0x20, 0x2f, 0x69, 0x6d, 0x67, 0x2f, 0x73,
-   0x63, 0x72, 0x65, 0x65, 0x6e, 0x73, 0x68, 0x6f, 0x74, 0x2e,
-   0x70, 0x6e, 0x67, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c,
-   0x2f, 0x74, 0x72, 0x3e, 0x3c, 0x2f, 0x74, 0x61, 0x62, 0x6c,
-   0x65, 0x3e, 0x0a, 0x25, 0x21, 0x3a, 0x20, 0x2f, 0x66, 0x6f,
-   0x6f, 0x74, 0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c};
-
-const char data_upload_html[209]  = {
-  /* /upload.html */
-   0x2f, 0x75, 0x70, 0x6c, 0x6f, 0x61, 0x64, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a, 0x3c, 0x62, 0x6f,
-   0x64, 0x79, 0x3e, 0x0a, 0x3c, 0x66, 0x6f, 0x72, 0x6d, 0x20,
-   0x61, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x3d, 0x22, 0x75, 0x70,
-   0x6c, 0x6f, 0x61, 0x64, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22,
-   0x20, 0x65, 0x6e, 0x63, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22,
-   0x6d, 0x75, 0x6c, 0x74, 0x69, 0x70, 0x61, 0x72, 0x74, 0x2f,
-   0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x64, 0x61, 0x74, 0x61, 0x22,
-   0x20, 0x6d, 0x65, 0x74, 0x68, 0x6f, 0x64, 0x3d, 0x22, 0x70,
-   0x6f, 0x73, 0x74, 0x22, 0x3e, 0x0a, 0x3c, 0x69, 0x6e, 0x70,
-   0x75, 0x74, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x75,
-   0x73, 0x65, 0x72, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x20, 0x74,
-   0x79, 0x70, 0x65, 0x3d, 0x22, 0x66, 0x69, 0x6c, 0x65, 0x22,
-   0x20, 0x73, 0x69, 0x7a, 0x65, 0x3d, 0x22, 0x35, 0x30, 0x22,
-   0x20, 0x2f, 0x3e, 0x0a, 0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74,
-   0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x3d, 0x22, 0x55, 0x70,
-   0x6c, 0x6f, 0x61, 0x64, 0x22, 0x20, 0x74, 0x79, 0x70, 0x65,
-   0x3d, 0x22, 0x73, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22, 0x20,
-   0x2f, 0x3e, 0x0a, 0x3c, 0x2f, 0x66, 0x6f, 0x72, 0x6d, 0x3e,
-   0x0a, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a, 0x3c,
-   0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e};
-
-const char data_tcp_shtml[221]  = {
-  /* /tcp.shtml */
-   0x2f, 0x74, 0x63, 0x70, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
-   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x68, 0x31,
-   0x3e, 0x43, 0x75, 0x72, 0x72, 0x65, 0x6e, 0x74, 0x20, 0x63,
-   0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x73,
-   0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c,
-   0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74,
-   0x68, 0x3d, 0x22, 0x31, 0x30, 0x30, 0x25, 0x22, 0x3e, 0x0a,
-   0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x4c, 0x6f,
-   0x63, 0x61, 0x6c, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74,
-   0x68, 0x3e, 0x52, 0x65, 0x6d, 0x6f, 0x74, 0x65, 0x3c, 0x2f,
-   0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x53, 0x74, 0x61,
-   0x74, 0x65, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68,
-   0x3e, 0x52, 0x65, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6d, 0x69,
-   0x73, 0x73, 0x69, 0x6f, 0x6e, 0x73, 0x3c, 0x2f, 0x74, 0x68,
-   0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x54, 0x69, 0x6d, 0x65, 0x72,
-   0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x46,
-   0x6c, 0x61, 0x67, 0x73, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c,
-   0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x74, 0x63,
-   0x70, 0x2d, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x69,
-   0x6f, 0x6e, 0x73, 0x0a, 0x25, 0x21, 0x3a, 0x20, 0x2f, 0x66,
-   0x6f, 0x6f, 0x74, 0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c};
-
-const char data_status_shtml[174]  = {
-  /* /status.shtml */
-   0x2f, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
-   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x68, 0x34,
-   0x3e, 0x41, 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x65, 0x73,
-   0x3c, 0x2f, 0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x61,
-   0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x65, 0x73, 0x0a, 0x3c,
-   0x68, 0x34, 0x3e, 0x4e, 0x65, 0x69, 0x67, 0x68, 0x62, 0x6f,
-   0x72, 0x73, 0x3c, 0x2f, 0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21,
-   0x20, 0x6e, 0x65, 0x69, 0x67, 0x68, 0x62, 0x6f, 0x72, 0x73,
-   0x0a, 0x3c, 0x68, 0x34, 0x3e, 0x52, 0x6f, 0x75, 0x74, 0x65,
-   0x73, 0x3c, 0x2f, 0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21, 0x20,
-   0x72, 0x6f, 0x75, 0x74, 0x65, 0x73, 0x0a, 0x3c, 0x68, 0x34,
-   0x3e, 0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x73, 0x3c, 0x2f,
-   0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x73, 0x65, 0x6e,
-   0x73, 0x6f, 0x72, 0x73, 0x0a, 0x3c, 0x2f, 0x74, 0x61, 0x62,
-   0x6c, 0x65, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x66, 0x69, 0x6c,
-   0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2e, 0x0a};
-
 const char data_header_html[801]  = {
   /* /header.html */
    0x2f, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
@@ -261,131 +84,90 @@ const char data_header_html[801]  = {
    0x65, 0x62, 0x20, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x21,
    0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x70, 0x3e, 0x0a};
 
-const char data_index_html[1023]  = {
-  /* /index.html */
-   0x2f, 0x69, 0x6e, 0x64, 0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20,
-   0x48, 0x54, 0x4d, 0x4c, 0x20, 0x50, 0x55, 0x42, 0x4c, 0x49,
-   0x43, 0x20, 0x22, 0x2d, 0x2f, 0x2f, 0x57, 0x33, 0x43, 0x2f,
-   0x2f, 0x44, 0x54, 0x44, 0x20, 0x48, 0x54, 0x4d, 0x4c, 0x20,
-   0x34, 0x2e, 0x30, 0x31, 0x20, 0x54, 0x72, 0x61, 0x6e, 0x73,
-   0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61, 0x6c, 0x2f, 0x2f, 0x45,
-   0x4e, 0x22, 0x20, 0x22, 0x68, 0x74, 0x74, 0x70, 0x3a, 0x2f,
-   0x2f, 0x77, 0x77, 0x77, 0x2e, 0x77, 0x33, 0x2e, 0x6f, 0x72,
-   0x67, 0x2f, 0x54, 0x52, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x34,
-   0x2f, 0x6c, 0x6f, 0x6f, 0x73, 0x65, 0x2e, 0x64, 0x74, 0x64,
-   0x22, 0x3e, 0x0a, 0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a,
-   0x20, 0x20, 0x3c, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x20,
-   0x20, 0x20, 0x20, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e,
-   0x57, 0x65, 0x6c, 0x63, 0x6f, 0x6d, 0x65, 0x20, 0x74, 0x6f,
-   0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
-   0x6b, 0x69, 0x20, 0x77, 0x65, 0x62, 0x20, 0x73, 0x65, 0x72,
-   0x76, 0x65, 0x72, 0x21, 0x3c, 0x2f, 0x74, 0x69, 0x74, 0x6c,
-   0x65, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x6c, 0x69,
-   0x6e, 0x6b, 0x20, 0x72, 0x65, 0x6c, 0x3d, 0x22, 0x73, 0x74,
-   0x79, 0x6c, 0x65, 0x73, 0x68, 0x65, 0x65, 0x74, 0x22, 0x20,
-   0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x74, 0x65, 0x78, 0x74,
-   0x2f, 0x63, 0x73, 0x73, 0x22, 0x20, 0x68, 0x72, 0x65, 0x66,
-   0x3d, 0x22, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x2e, 0x63,
-   0x73, 0x73, 0x22, 0x3e, 0x20, 0x20, 0x0a, 0x20, 0x20, 0x3c,
-   0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
-   0x62, 0x6f, 0x64, 0x79, 0x20, 0x62, 0x67, 0x63, 0x6f, 0x6c,
-   0x6f, 0x72, 0x3d, 0x22, 0x23, 0x66, 0x66, 0x66, 0x65, 0x65,
-   0x63, 0x22, 0x20, 0x74, 0x65, 0x78, 0x74, 0x3d, 0x22, 0x62,
-   0x6c, 0x61, 0x63, 0x6b, 0x22, 0x3e, 0x0a, 0x0a, 0x20, 0x20,
-   0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73,
-   0x3d, 0x22, 0x6d, 0x65, 0x6e, 0x75, 0x62, 0x6c, 0x6f, 0x63,
-   0x6b, 0x22, 0x3e, 0x0a, 0x0a, 0x20, 0x20, 0x3c, 0x64, 0x69,
-   0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x6d,
-   0x65, 0x6e, 0x75, 0x22, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x70,
-   0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x62, 0x6f,
-   0x72, 0x64, 0x65, 0x72, 0x2d, 0x74, 0x69, 0x74, 0x6c, 0x65,
-   0x22, 0x3e, 0x4d, 0x65, 0x6e, 0x75, 0x3c, 0x2f, 0x70, 0x3e,
-   0x0a, 0x20, 0x20, 0x3c, 0x70, 0x20, 0x63, 0x6c, 0x61, 0x73,
-   0x73, 0x3d, 0x22, 0x6d, 0x65, 0x6e, 0x75, 0x22, 0x3e, 0x0a,
-   0x20, 0x20, 0x0a, 0x20, 0x20, 0x3c, 0x61, 0x20, 0x68, 0x72,
-   0x65, 0x66, 0x3d, 0x22, 0x2f, 0x22, 0x3e, 0x46, 0x72, 0x6f,
-   0x6e, 0x74, 0x20, 0x70, 0x61, 0x67, 0x65, 0x3c, 0x2f, 0x61,
-   0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61,
-   0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x73, 0x74, 0x61,
-   0x74, 0x75, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x22,
-   0x3e, 0x53, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3c, 0x2f, 0x61,
-   0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61,
-   0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x66, 0x69, 0x6c,
-   0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e,
-   0x46, 0x69, 0x6c, 0x65, 0x20, 0x73, 0x74, 0x61, 0x74, 0x69,
-   0x73, 0x74, 0x69, 0x63, 0x73, 0x3c, 0x2f, 0x61, 0x3e, 0x3c,
-   0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61, 0x20, 0x68,
-   0x72, 0x65, 0x66, 0x3d, 0x22, 0x74, 0x63, 0x70, 0x2e, 0x73,
-   0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e, 0x4e, 0x65, 0x74, 0x77,
-   0x6f, 0x72, 0x6b, 0x20, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63,
-   0x74, 0x69, 0x6f, 0x6e, 0x73, 0x3c, 0x2f, 0x61, 0x3e, 0x3c,
-   0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61, 0x20, 0x68,
-   0x72, 0x65, 0x66, 0x3d, 0x22, 0x70, 0x72, 0x6f, 0x63, 0x65,
-   0x73, 0x73, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c,
-   0x22, 0x3e, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x20, 0x70,
-   0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73, 0x3c, 0x2f,
-   0x61, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x0a, 0x0a, 0x20, 0x20,
-   0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x64,
-   0x69, 0x76, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x64, 0x69,
-   0x76, 0x3e, 0x0a, 0x0a, 0x20, 0x20, 0x3c, 0x64, 0x69, 0x76,
-   0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x63, 0x6f,
-   0x6e, 0x74, 0x65, 0x6e, 0x74, 0x62, 0x6c, 0x6f, 0x63, 0x6b,
-   0x22, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x70, 0x20, 0x63, 0x6c,
-   0x61, 0x73, 0x73, 0x3d, 0x22, 0x62, 0x6f, 0x72, 0x64, 0x65,
-   0x72, 0x2d, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x22, 0x3e, 0x0a,
-   0x20, 0x20, 0x57, 0x65, 0x6c, 0x63, 0x6f, 0x6d, 0x65, 0x20,
-   0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x3c, 0x61, 0x20,
-   0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x68, 0x74, 0x74, 0x70,
-   0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f, 0x6e,
-   0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f, 0x72,
-   0x67, 0x22, 0x3e, 0x43, 0x6f, 0x6e, 0x74, 0x69, 0x6b, 0x69,
-   0x3c, 0x2f, 0x61, 0x3e, 0x0a, 0x20, 0x20, 0x77, 0x65, 0x62,
-   0x20, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x21, 0x0a, 0x20,
-   0x20, 0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x09, 0x20, 0x20, 0x20,
-   0x20, 0x20, 0x20, 0x0a, 0x09, 0x20, 0x20, 0x3c, 0x70, 0x20,
-   0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x69, 0x6e, 0x74,
-   0x72, 0x6f, 0x22, 0x3e, 0x0a, 0x09, 0x20, 0x20, 0x20, 0x20,
-   0x54, 0x68, 0x65, 0x20, 0x77, 0x65, 0x62, 0x20, 0x70, 0x61,
-   0x67, 0x65, 0x73, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x61, 0x72,
-   0x65, 0x20, 0x77, 0x61, 0x74, 0x63, 0x68, 0x69, 0x6e, 0x67,
-   0x20, 0x61, 0x72, 0x65, 0x20, 0x73, 0x65, 0x72, 0x76, 0x65,
-   0x64, 0x20, 0x62, 0x79, 0x20, 0x61, 0x20, 0x77, 0x65, 0x62,
-   0x0a, 0x09, 0x20, 0x20, 0x20, 0x20, 0x73, 0x65, 0x72, 0x76,
-   0x65, 0x72, 0x20, 0x72, 0x75, 0x6e, 0x6e, 0x69, 0x6e, 0x67,
-   0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65,
-   0x20, 0x3c, 0x61, 0x0a, 0x09, 0x20, 0x20, 0x20, 0x20, 0x68,
-   0x72, 0x65, 0x66, 0x3d, 0x22, 0x68, 0x74, 0x74, 0x70, 0x3a,
-   0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f, 0x6e, 0x74,
-   0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f, 0x72, 0x67,
-   0x22, 0x3e, 0x43, 0x6f, 0x6e, 0x74, 0x69, 0x6b, 0x69, 0x20,
-   0x6f, 0x70, 0x65, 0x72, 0x61, 0x74, 0x69, 0x6e, 0x67, 0x0a,
-   0x09, 0x20, 0x20, 0x20, 0x20, 0x73, 0x79, 0x73, 0x74, 0x65,
-   0x6d, 0x3c, 0x2f, 0x61, 0x3e, 0x2e, 0x0a, 0x09, 0x20, 0x20,
-   0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x0a, 0x09, 0x20, 0x20, 0x0a,
-   0x09, 0x20, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64,
-   0x79, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e,
-   0x0a};
+const char hdr_header_html[155]  = {
+  /* /header.html header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x37, 0x38, 0x38, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d,
+   0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a, 0x20, 0x22, 0x32, 0x64,
+   0x35, 0x35, 0x61, 0x38, 0x62, 0x31, 0x22, 0x0d, 0x0a, 0x56,
+   0x61, 0x72, 0x79, 0x3a, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70,
+   0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67,
+   0x0d, 0x0a, 0x0d, 0x0a, 0x00};
 
-const char data_404_html[170]  = {
-  /* /404.html */
-   0x2f, 0x34, 0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
-   0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
-   0x62, 0x6f, 0x64, 0x79, 0x20, 0x62, 0x67, 0x63, 0x6f, 0x6c,
-   0x6f, 0x72, 0x3d, 0x22, 0x77, 0x68, 0x69, 0x74, 0x65, 0x22,
-   0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x63, 0x65, 0x6e,
-   0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
-   0x20, 0x3c, 0x68, 0x31, 0x3e, 0x34, 0x30, 0x34, 0x20, 0x2d,
-   0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x6e, 0x6f, 0x74, 0x20,
-   0x66, 0x6f, 0x75, 0x6e, 0x64, 0x3c, 0x2f, 0x68, 0x31, 0x3e,
-   0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x68, 0x33,
-   0x3e, 0x47, 0x6f, 0x20, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65,
-   0x66, 0x3d, 0x22, 0x2f, 0x22, 0x3e, 0x68, 0x65, 0x72, 0x65,
-   0x3c, 0x2f, 0x61, 0x3e, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x65,
-   0x61, 0x64, 0x2e, 0x3c, 0x2f, 0x68, 0x33, 0x3e, 0x0a, 0x20,
-   0x20, 0x20, 0x20, 0x3c, 0x2f, 0x63, 0x65, 0x6e, 0x74, 0x65,
-   0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64,
-   0x79, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e};
+const char gz_header_html[414]  = {
+  /* /header.html gzip */
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+   0x75, 0x52, 0x4d, 0x4f, 0xe3, 0x30, 0x10, 0xbd, 0xf3, 0x2b,
+   0x06, 0x73, 0x6e, 0x06, 0x04, 0xa7, 0x55, 0xe2, 0xc3, 0xb6,
+   0xa0, 0x5d, 0x89, 0x2f, 0x2d, 0x41, 0x68, 0x8f, 0x8e, 0x33,
+   0x69, 0xac, 0x3a, 0x71, 0x64, 0x0f, 0x64, 0xfb, 0xef, 0xd7,
+   0x4e, 0x49, 0x29, 0xa8, 0xdc, 0xc6, 0x33, 0xef, 0xcd, 0xbc,
+   0xbc, 0xbc, 0xfc, 0x74, 0xf5, 0xb0, 0x2c, 0xff, 0x3e, 0x5e,
+   0xc3, 0xaf, 0xf2, 0xee, 0x16, 0x1e, 0x9f, 0x7f, 0xde, 0xfe,
+   0x5e, 0x82, 0x58, 0x20, 0xbe, 0x5c, 0x2e, 0x11, 0x57, 0xe5,
+   0x6a, 0x37, 0xb8, 0xca, 0xce, 0x2f, 0xa0, 0xf4, 0xaa, 0x0f,
+   0x86, 0x8d, 0xeb, 0x95, 0x45, 0xbc, 0xbe, 0x17, 0x20, 0x5a,
+   0xe6, 0xe1, 0x07, 0xe2, 0x38, 0x8e, 0xd9, 0x78, 0x99, 0x39,
+   0xbf, 0xc6, 0xf2, 0x0f, 0xb6, 0xdc, 0xd9, 0x2b, 0xb4, 0xce,
+   0x05, 0xca, 0x6a, 0xae, 0x85, 0x3c, 0xc9, 0x53, 0x4b, 0x9e,
+   0x00, 0xe4, 0x2d, 0xa9, 0x3a, 0x15, 0xb1, 0x64, 0xc3, 0x96,
+   0xe4, 0x0b, 0x59, 0xed, 0x3a, 0x02, 0x76, 0xc0, 0x2d, 0xc1,
+   0xd2, 0xf5, 0x6c, 0x36, 0x66, 0x51, 0x53, 0xe7, 0x20, 0x90,
+   0x7f, 0x23, 0x7f, 0x9a, 0xe3, 0x0e, 0xba, 0xa3, 0x59, 0xd3,
+   0x6f, 0xc0, 0x93, 0x2d, 0x44, 0xe0, 0xad, 0xa5, 0xd0, 0x12,
+   0xb1, 0x00, 0xde, 0x0e, 0x54, 0x08, 0xa6, 0x7f, 0x8c, 0x3a,
+   0x04, 0x01, 0xad, 0xa7, 0xa6, 0x10, 0x38, 0x41, 0xb2, 0xd4,
+   0x91, 0x00, 0xe9, 0x3e, 0xce, 0x02, 0xf2, 0xca, 0xd5, 0x5b,
+   0xa8, 0xd6, 0xda, 0x59, 0xe7, 0x0b, 0x71, 0xd6, 0x34, 0x0d,
+   0x91, 0x8e, 0x8b, 0xe2, 0x8a, 0x42, 0x54, 0x56, 0xe9, 0x4d,
+   0x14, 0x9e, 0x80, 0xb5, 0x79, 0x03, 0x6d, 0x55, 0x08, 0x85,
+   0xe8, 0xa8, 0x7f, 0xad, 0xac, 0xfb, 0x6e, 0x24, 0xa6, 0xc5,
+   0xc3, 0xdc, 0xaa, 0x9c, 0xaf, 0xc9, 0x2f, 0x26, 0xf1, 0x42,
+   0xde, 0x45, 0x40, 0x8e, 0xc3, 0x67, 0xc8, 0x9e, 0x95, 0xba,
+   0x6a, 0x56, 0x2d, 0xe4, 0x8d, 0x8f, 0x3e, 0xc0, 0xa0, 0xd6,
+   0x94, 0xa3, 0x92, 0x79, 0xe5, 0xe5, 0x21, 0x20, 0xb0, 0xe2,
+   0xd7, 0x90, 0x85, 0xe4, 0xaa, 0x90, 0x4f, 0xd3, 0xeb, 0x18,
+   0xae, 0x31, 0xd1, 0x9f, 0x19, 0x76, 0x13, 0x1f, 0x90, 0x98,
+   0x26, 0xb0, 0xd1, 0x47, 0xf1, 0xac, 0x87, 0x19, 0x7d, 0x4f,
+   0x3c, 0x3a, 0xbf, 0x01, 0xed, 0xfa, 0x9e, 0x74, 0xfa, 0xe7,
+   0x47, 0x19, 0x83, 0x77, 0x9a, 0x42, 0xf8, 0xb8, 0xf2, 0xb4,
+   0x0d, 0x4c, 0x1d, 0xec, 0xfb, 0x7b, 0xd2, 0x64, 0xfe, 0xee,
+   0xeb, 0x31, 0xda, 0x76, 0x50, 0x7c, 0x31, 0x32, 0x5e, 0x64,
+   0xea, 0x79, 0xb6, 0xf9, 0x7b, 0x43, 0xe3, 0xe8, 0x4b, 0x78,
+   0xf6, 0xb2, 0x0e, 0x62, 0xa9, 0xdf, 0x03, 0xe5, 0xc2, 0x14,
+   0x4f, 0x21, 0xdf, 0x13, 0x96, 0x84, 0xc5, 0x0d, 0x23, 0x55,
+   0x73, 0xcc, 0x66, 0x85, 0xff, 0x01, 0xcd, 0x1a, 0x33, 0xd2,
+   0x14, 0x03, 0x00, 0x00};
+
+const char gzhdr_header_html[179]  = {
+  /* /header.html gzip header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x34, 0x31, 0x34, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d,
+   0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x2d, 0x45,
+   0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x67,
+   0x7a, 0x69, 0x70, 0x0d, 0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a,
+   0x20, 0x22, 0x34, 0x65, 0x63, 0x36, 0x32, 0x66, 0x64, 0x66,
+   0x22, 0x0d, 0x0a, 0x56, 0x61, 0x72, 0x79, 0x3a, 0x20, 0x41,
+   0x63, 0x63, 0x65, 0x70, 0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f,
+   0x64, 0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x0d, 0x0a, 0x00};
 
 const char data_style_css[2571]  = {
   /* /style.css */
@@ -647,6 +429,676 @@ const char data_style_css[2571]  = {
    0x20, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x20, 0x31, 0x70, 0x78,
    0x3b, 0x0a, 0x0a, 0x7d, 0x20, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a};
 
+const char hdr_style_css[155]  = {
+  /* /style.css header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x32, 0x35, 0x36, 0x30, 0x0d, 0x0a, 0x43, 0x6f, 0x6e,
+   0x74, 0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a,
+   0x20, 0x74, 0x65, 0x78, 0x74, 0x2f, 0x63, 0x73, 0x73, 0x0d,
+   0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a, 0x20, 0x22, 0x39, 0x63,
+   0x30, 0x62, 0x30, 0x37, 0x35, 0x65, 0x22, 0x0d, 0x0a, 0x56,
+   0x61, 0x72, 0x79, 0x3a, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70,
+   0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67,
+   0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char gz_style_css[608]  = {
+  /* /style.css gzip */
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+   0xbd, 0x56, 0xdb, 0x6e, 0xe3, 0x20, 0x10, 0x7d, 0x5e, 0xbe,
+   0x02, 0x69, 0xb5, 0x2f, 0x55, 0xed, 0x3a, 0x51, 0xaa, 0x6d,
+   0xec, 0xaf, 0xc1, 0x80, 0x1d, 0x54, 0x0c, 0x88, 0x90, 0x26,
+   0xdd, 0x55, 0xfe, 0x7d, 0xb9, 0xd9, 0xb1, 0x1d, 0xd2, 0x24,
+   0xed, 0xaa, 0x7e, 0x84, 0xf1, 0x9c, 0x0b, 0x33, 0x03, 0x9b,
+   0x05, 0x04, 0x7f, 0x01, 0x84, 0x86, 0x1e, 0x4c, 0x86, 0x38,
+   0x6b, 0x45, 0x09, 0x31, 0x15, 0x86, 0xea, 0xca, 0xae, 0x36,
+   0x52, 0x98, 0x6c, 0xcb, 0xfe, 0xd0, 0x72, 0xb1, 0x52, 0x66,
+   0x58, 0x69, 0x50, 0xc7, 0xf8, 0x7b, 0x89, 0x34, 0x43, 0xfc,
+   0x71, 0x43, 0xf9, 0x1b, 0x35, 0x0c, 0xa3, 0x61, 0x7b, 0x4f,
+   0x59, 0xbb, 0x31, 0x65, 0x2d, 0x39, 0x71, 0x6b, 0x0a, 0x11,
+   0xc2, 0x44, 0x5b, 0x2e, 0x0a, 0x75, 0xa8, 0x20, 0x38, 0x02,
+   0x50, 0x4b, 0xf2, 0x6e, 0x51, 0xed, 0x5e, 0x8d, 0xf0, 0x6b,
+   0xab, 0xe5, 0x4e, 0x90, 0x0c, 0x4b, 0x2e, 0x75, 0x09, 0x7f,
+   0x36, 0x4d, 0x43, 0x29, 0x76, 0x3f, 0x86, 0x95, 0x9a, 0xdb,
+   0x98, 0x0a, 0x4c, 0xd8, 0xbc, 0xdc, 0x40, 0xc6, 0xe2, 0xe4,
+   0x7b, 0x8d, 0x14, 0x74, 0xf2, 0xf6, 0x8c, 0x98, 0x4d, 0x09,
+   0xd7, 0x2f, 0xbf, 0xdc, 0x7f, 0x1d, 0xd2, 0x2d, 0xb3, 0x42,
+   0x0b, 0x88, 0x76, 0x46, 0x56, 0x33, 0xf9, 0x9c, 0x36, 0x57,
+   0xb3, 0xc3, 0xf8, 0x79, 0x94, 0x8e, 0x8a, 0x5d, 0xcd, 0x25,
+   0x7e, 0xf5, 0x4e, 0xf6, 0xc9, 0x57, 0x56, 0xed, 0x80, 0xbc,
+   0x78, 0xf6, 0xc0, 0x0d, 0x97, 0xc8, 0x94, 0x01, 0x60, 0xee,
+   0x0c, 0xf8, 0xe1, 0xfc, 0x90, 0x9a, 0x50, 0xeb, 0xc2, 0x56,
+   0x72, 0x46, 0xe0, 0x22, 0xa4, 0x48, 0x9b, 0x84, 0xc9, 0x72,
+   0xc6, 0xbc, 0x27, 0x3e, 0xb1, 0x6a, 0xad, 0x6e, 0x10, 0xe3,
+   0x65, 0x60, 0x1b, 0x62, 0x4f, 0x3e, 0x2a, 0xf1, 0x69, 0x92,
+   0x5a, 0x9e, 0x8b, 0xeb, 0x5a, 0x46, 0x52, 0xac, 0x08, 0x48,
+   0xa4, 0x31, 0x94, 0xa4, 0xb5, 0xec, 0x37, 0xcc, 0xd0, 0xfb,
+   0xcf, 0xd7, 0xf2, 0xf3, 0xac, 0x05, 0xdd, 0x6f, 0xaf, 0x98,
+   0xbf, 0x5c, 0x9d, 0x13, 0xfe, 0x88, 0xf1, 0x97, 0xcc, 0xbf,
+   0xbf, 0x48, 0x95, 0x66, 0xc2, 0xa0, 0x9a, 0xd3, 0xff, 0xa7,
+   0xa0, 0xa8, 0xae, 0xf5, 0xd6, 0x88, 0xb9, 0x76, 0xdd, 0xfa,
+   0x29, 0xea, 0x84, 0xbd, 0xe5, 0xba, 0x61, 0xad, 0x27, 0x7e,
+   0xee, 0x1e, 0x04, 0xc9, 0xce, 0x1a, 0x11, 0x87, 0x81, 0xf9,
+   0xa0, 0x7a, 0x10, 0x32, 0xa3, 0x32, 0x68, 0x8f, 0x5c, 0x2d,
+   0xb6, 0xd2, 0x34, 0xa7, 0x07, 0xd4, 0xa9, 0xe8, 0x5b, 0x0a,
+   0xfe, 0x1a, 0xd0, 0x07, 0x7d, 0x7f, 0xb3, 0x0d, 0x30, 0x14,
+   0x70, 0xb6, 0x55, 0x08, 0xd3, 0xd2, 0xb2, 0x8a, 0xed, 0x04,
+   0x54, 0x6e, 0x8f, 0x55, 0xcb, 0xd1, 0xa1, 0x66, 0x0e, 0xa1,
+   0x5c, 0x4e, 0x98, 0x64, 0x5e, 0x51, 0x5c, 0x9c, 0x4e, 0xdc,
+   0xc2, 0xa1, 0x3f, 0x3d, 0x24, 0x86, 0x2a, 0x7c, 0x78, 0xba,
+   0xa9, 0xa5, 0x55, 0x8e, 0x39, 0x13, 0xa1, 0x33, 0x46, 0x89,
+   0x97, 0xe7, 0xb2, 0xb0, 0xdc, 0x69, 0x46, 0xf5, 0x63, 0x27,
+   0x85, 0xf4, 0x4a, 0x2a, 0xdf, 0xff, 0x23, 0x7b, 0xfa, 0x4b,
+   0xe1, 0x94, 0x76, 0x3d, 0xcb, 0xbb, 0xfe, 0x72, 0x5a, 0x4d,
+   0x39, 0xb2, 0x73, 0x62, 0xce, 0xb7, 0xb8, 0x69, 0x1a, 0x5c,
+   0x4a, 0x0b, 0x00, 0xeb, 0xda, 0xdc, 0xdb, 0x1c, 0x12, 0x8f,
+   0x0b, 0x69, 0x56, 0x10, 0xc7, 0x10, 0xec, 0xce, 0x69, 0x14,
+   0xdb, 0x17, 0xc6, 0x3c, 0x54, 0xe5, 0x77, 0xd4, 0x7e, 0xcf,
+   0xe8, 0xbe, 0xea, 0xff, 0xad, 0x4c, 0xef, 0xcd, 0xf7, 0x60,
+   0x25, 0x3a, 0xcd, 0x82, 0xf3, 0x6f, 0x06, 0x0f, 0x8e, 0x3b,
+   0xdd, 0x1e, 0x35, 0xe6, 0x09, 0xfd, 0x33, 0xb2, 0xbf, 0x43,
+   0x8c, 0xdb, 0x2d, 0x7d, 0x29, 0xe8, 0x0c, 0x20, 0x5d, 0x9d,
+   0x96, 0x6e, 0xc7, 0x04, 0xe2, 0xc9, 0xb9, 0x18, 0x1b, 0xe9,
+   0x54, 0x3f, 0x97, 0x22, 0x82, 0x35, 0x99, 0x61, 0x26, 0x4e,
+   0xa4, 0x44, 0x39, 0x26, 0x9e, 0x54, 0x23, 0x9b, 0xa6, 0x26,
+   0xad, 0x26, 0x63, 0xa2, 0xb6, 0x37, 0xa8, 0xec, 0x4e, 0xce,
+   0xc5, 0x89, 0x1e, 0x1f, 0x47, 0x17, 0xaf, 0xa9, 0xda, 0x4f,
+   0xa8, 0xc4, 0xc5, 0x06, 0x8e, 0xd0, 0xb5, 0x06, 0xf8, 0x07,
+   0x12, 0x9f, 0x74, 0x66, 0x00, 0x0a, 0x00, 0x00};
+
+const char gzhdr_style_css[178]  = {
+  /* /style.css gzip header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x36, 0x30, 0x38, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x63, 0x73, 0x73, 0x0d, 0x0a,
+   0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x2d, 0x45, 0x6e,
+   0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x67, 0x7a,
+   0x69, 0x70, 0x0d, 0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a, 0x20,
+   0x22, 0x63, 0x66, 0x66, 0x31, 0x63, 0x65, 0x61, 0x39, 0x22,
+   0x0d, 0x0a, 0x56, 0x61, 0x72, 0x79, 0x3a, 0x20, 0x41, 0x63,
+   0x63, 0x65, 0x70, 0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f, 0x64,
+   0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char data_tcp_shtml[221]  = {
+  /* /tcp.shtml */
+   0x2f, 0x74, 0x63, 0x70, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
+   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x68, 0x31,
+   0x3e, 0x43, 0x75, 0x72, 0x72, 0x65, 0x6e, 0x74, 0x20, 0x63,
+   0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x73,
+   0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c,
+   0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74,
+   0x68, 0x3d, 0x22, 0x31, 0x30, 0x30, 0x25, 0x22, 0x3e, 0x0a,
+   0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x4c, 0x6f,
+   0x63, 0x61, 0x6c, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74,
+   0x68, 0x3e, 0x52, 0x65, 0x6d, 0x6f, 0x74, 0x65, 0x3c, 0x2f,
+   0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x53, 0x74, 0x61,
+   0x74, 0x65, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68,
+   0x3e, 0x52, 0x65, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6d, 0x69,
+   0x73, 0x73, 0x69, 0x6f, 0x6e, 0x73, 0x3c, 0x2f, 0x74, 0x68,
+   0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x54, 0x69, 0x6d, 0x65, 0x72,
+   0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x46,
+   0x6c, 0x61, 0x67, 0x73, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c,
+   0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x74, 0x63,
+   0x70, 0x2d, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x69,
+   0x6f, 0x6e, 0x73, 0x0a, 0x25, 0x21, 0x3a, 0x20, 0x2f, 0x66,
+   0x6f, 0x6f, 0x74, 0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c};
+
+const struct httpd_fs_segment seg_tcp_shtml[]  = {
+  /* /tcp.shtml */
+  {data_tcp_shtml + 11 + 0, 0, HTTPD_FS_SEGMENT_INCLUDE, data_tcp_shtml + 11 + 3},
+  {data_tcp_shtml + 11 + 17, 158, 0, data_tcp_shtml + 11 + 178},
+  {data_tcp_shtml + 11 + 194, 0, HTTPD_FS_SEGMENT_INCLUDE, data_tcp_shtml + 11 + 197},
+  {data_tcp_shtml + 11 + 210, 0, HTTPD_FS_SEGMENT_END, NULL}};
+
+const char data_404_html[170]  = {
+  /* /404.html */
+   0x2f, 0x34, 0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+   0x62, 0x6f, 0x64, 0x79, 0x20, 0x62, 0x67, 0x63, 0x6f, 0x6c,
+   0x6f, 0x72, 0x3d, 0x22, 0x77, 0x68, 0x69, 0x74, 0x65, 0x22,
+   0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x63, 0x65, 0x6e,
+   0x74, 0x65, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+   0x20, 0x3c, 0x68, 0x31, 0x3e, 0x34, 0x30, 0x34, 0x20, 0x2d,
+   0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x6e, 0x6f, 0x74, 0x20,
+   0x66, 0x6f, 0x75, 0x6e, 0x64, 0x3c, 0x2f, 0x68, 0x31, 0x3e,
+   0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x68, 0x33,
+   0x3e, 0x47, 0x6f, 0x20, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65,
+   0x66, 0x3d, 0x22, 0x2f, 0x22, 0x3e, 0x68, 0x65, 0x72, 0x65,
+   0x3c, 0x2f, 0x61, 0x3e, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x65,
+   0x61, 0x64, 0x2e, 0x3c, 0x2f, 0x68, 0x33, 0x3e, 0x0a, 0x20,
+   0x20, 0x20, 0x20, 0x3c, 0x2f, 0x63, 0x65, 0x6e, 0x74, 0x65,
+   0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64,
+   0x79, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e};
+
+const char hdr_404_html[155]  = {
+  /* /404.html header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x31, 0x36, 0x30, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d,
+   0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a, 0x20, 0x22, 0x63, 0x35,
+   0x37, 0x31, 0x64, 0x32, 0x34, 0x36, 0x22, 0x0d, 0x0a, 0x56,
+   0x61, 0x72, 0x79, 0x3a, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70,
+   0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67,
+   0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char gz_404_html[135]  = {
+  /* /404.html gzip */
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+   0x45, 0x8e, 0x41, 0x0a, 0x02, 0x31, 0x0c, 0x45, 0xf7, 0x73,
+   0x8a, 0xd0, 0xbd, 0x46, 0x99, 0x59, 0x66, 0xb2, 0xf5, 0x1c,
+   0x9d, 0x69, 0x6a, 0x0a, 0xb5, 0x81, 0x5a, 0x11, 0x6f, 0x6f,
+   0x8b, 0xa2, 0xcb, 0xc7, 0x7b, 0xf0, 0x3f, 0x69, 0xbb, 0x65,
+   0x9e, 0x00, 0x68, 0xb3, 0xf0, 0x82, 0xed, 0xba, 0x5b, 0xb6,
+   0xba, 0xba, 0xa7, 0xa6, 0x26, 0x6e, 0x88, 0xae, 0x76, 0x29,
+   0x4d, 0xea, 0x07, 0x3a, 0xea, 0x99, 0x97, 0xd3, 0x02, 0x07,
+   0x88, 0x29, 0x0b, 0x14, 0x6b, 0x10, 0xed, 0x51, 0x02, 0x61,
+   0x17, 0xbf, 0x66, 0xe6, 0x8b, 0x01, 0x79, 0xd0, 0x2a, 0x71,
+   0x75, 0xe8, 0x58, 0xa5, 0x0a, 0xa1, 0x67, 0x48, 0xe5, 0xde,
+   0xc4, 0x87, 0x63, 0xef, 0xe7, 0xef, 0x00, 0xfe, 0x17, 0x08,
+   0xc7, 0x11, 0x9e, 0xba, 0x1d, 0xcf, 0xde, 0x57, 0x52, 0xaf,
+   0xa7, 0xa0, 0x00, 0x00, 0x00};
+
+const char gzhdr_404_html[179]  = {
+  /* /404.html gzip header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x31, 0x33, 0x35, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d,
+   0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x2d, 0x45,
+   0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x67,
+   0x7a, 0x69, 0x70, 0x0d, 0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a,
+   0x20, 0x22, 0x39, 0x30, 0x34, 0x31, 0x38, 0x38, 0x33, 0x62,
+   0x22, 0x0d, 0x0a, 0x56, 0x61, 0x72, 0x79, 0x3a, 0x20, 0x41,
+   0x63, 0x63, 0x65, 0x70, 0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f,
+   0x64, 0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char data_index_html[1023]  = {
+  /* /index.html */
+   0x2f, 0x69, 0x6e, 0x64, 0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20,
+   0x48, 0x54, 0x4d, 0x4c, 0x20, 0x50, 0x55, 0x42, 0x4c, 0x49,
+   0x43, 0x20, 0x22, 0x2d, 0x2f, 0x2f, 0x57, 0x33, 0x43, 0x2f,
+   0x2f, 0x44, 0x54, 0x44, 0x20, 0x48, 0x54, 0x4d, 0x4c, 0x20,
+   0x34, 0x2e, 0x30, 0x31, 0x20, 0x54, 0x72, 0x61, 0x6e, 0x73,
+   0x69, 0x74, 0x69, 0x6f, 0x6e, 0x61, 0x6c, 0x2f, 0x2f, 0x45,
+   0x4e, 0x22, 0x20, 0x22, 0x68, 0x74, 0x74, 0x70, 0x3a, 0x2f,
+   0x2f, 0x77, 0x77, 0x77, 0x2e, 0x77, 0x33, 0x2e, 0x6f, 0x72,
+   0x67, 0x2f, 0x54, 0x52, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x34,
+   0x2f, 0x6c, 0x6f, 0x6f, 0x73, 0x65, 0x2e, 0x64, 0x74, 0x64,
+   0x22, 0x3e, 0x0a, 0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a,
+   0x20, 0x20, 0x3c, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x20,
+   0x20, 0x20, 0x20, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e,
+   0x57, 0x65, 0x6c, 0x63, 0x6f, 0x6d, 0x65, 0x20, 0x74, 0x6f,
+   0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x20, 0x77, 0x65, 0x62, 0x20, 0x73, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x21, 0x3c, 0x2f, 0x74, 0x69, 0x74, 0x6c,
+   0x65, 0x3e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x3c, 0x6c, 0x69,
+   0x6e, 0x6b, 0x20, 0x72, 0x65, 0x6c, 0x3d, 0x22, 0x73, 0x74,
+   0x79, 0x6c, 0x65, 0x73, 0x68, 0x65, 0x65, 0x74, 0x22, 0x20,
+   0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x74, 0x65, 0x78, 0x74,
+   0x2f, 0x63, 0x73, 0x73, 0x22, 0x20, 0x68, 0x72, 0x65, 0x66,
+   0x3d, 0x22, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x2e, 0x63,
+   0x73, 0x73, 0x22, 0x3e, 0x20, 0x20, 0x0a, 0x20, 0x20, 0x3c,
+   0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x20, 0x20, 0x3c,
+   0x62, 0x6f, 0x64, 0x79, 0x20, 0x62, 0x67, 0x63, 0x6f, 0x6c,
+   0x6f, 0x72, 0x3d, 0x22, 0x23, 0x66, 0x66, 0x66, 0x65, 0x65,
+   0x63, 0x22, 0x20, 0x74, 0x65, 0x78, 0x74, 0x3d, 0x22, 0x62,
+   0x6c, 0x61, 0x63, 0x6b, 0x22, 0x3e, 0x0a, 0x0a, 0x20, 0x20,
+   0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73,
+   0x3d, 0x22, 0x6d, 0x65, 0x6e, 0x75, 0x62, 0x6c, 0x6f, 0x63,
+   0x6b, 0x22, 0x3e, 0x0a, 0x0a, 0x20, 0x20, 0x3c, 0x64, 0x69,
+   0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x6d,
+   0x65, 0x6e, 0x75, 0x22, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x70,
+   0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x62, 0x6f,
+   0x72, 0x64, 0x65, 0x72, 0x2d, 0x74, 0x69, 0x74, 0x6c, 0x65,
+   0x22, 0x3e, 0x4d, 0x65, 0x6e, 0x75, 0x3c, 0x2f, 0x70, 0x3e,
+   0x0a, 0x20, 0x20, 0x3c, 0x70, 0x20, 0x63, 0x6c, 0x61, 0x73,
+   0x73, 0x3d, 0x22, 0x6d, 0x65, 0x6e, 0x75, 0x22, 0x3e, 0x0a,
+   0x20, 0x20, 0x0a, 0x20, 0x20, 0x3c, 0x61, 0x20, 0x68, 0x72,
+   0x65, 0x66, 0x3d, 0x22, 0x2f, 0x22, 0x3e, 0x46, 0x72, 0x6f,
+   0x6e, 0x74, 0x20, 0x70, 0x61, 0x67, 0x65, 0x3c, 0x2f, 0x61,
+   0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61,
+   0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x73, 0x74, 0x61,
+   0x74, 0x75, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x22,
+   0x3e, 0x53, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3c, 0x2f, 0x61,
+   0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61,
+   0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x66, 0x69, 0x6c,
+   0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e,
+   0x46, 0x69, 0x6c, 0x65, 0x20, 0x73, 0x74, 0x61, 0x74, 0x69,
+   0x73, 0x74, 0x69, 0x63, 0x73, 0x3c, 0x2f, 0x61, 0x3e, 0x3c,
+   0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61, 0x20, 0x68,
+   0x72, 0x65, 0x66, 0x3d, 0x22, 0x74, 0x63, 0x70, 0x2e, 0x73,
+   0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e, 0x4e, 0x65, 0x74, 0x77,
+   0x6f, 0x72, 0x6b, 0x20, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63,
+   0x74, 0x69, 0x6f, 0x6e, 0x73, 0x3c, 0x2f, 0x61, 0x3e, 0x3c,
+   0x62, 0x72, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x61, 0x20, 0x68,
+   0x72, 0x65, 0x66, 0x3d, 0x22, 0x70, 0x72, 0x6f, 0x63, 0x65,
+   0x73, 0x73, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c,
+   0x22, 0x3e, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x20, 0x70,
+   0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73, 0x3c, 0x2f,
+   0x61, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x0a, 0x0a, 0x20, 0x20,
+   0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x64,
+   0x69, 0x76, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x64, 0x69,
+   0x76, 0x3e, 0x0a, 0x0a, 0x20, 0x20, 0x3c, 0x64, 0x69, 0x76,
+   0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x63, 0x6f,
+   0x6e, 0x74, 0x65, 0x6e, 0x74, 0x62, 0x6c, 0x6f, 0x63, 0x6b,
+   0x22, 0x3e, 0x0a, 0x20, 0x20, 0x3c, 0x70, 0x20, 0x63, 0x6c,
+   0x61, 0x73, 0x73, 0x3d, 0x22, 0x62, 0x6f, 0x72, 0x64, 0x65,
+   0x72, 0x2d, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x22, 0x3e, 0x0a,
+   0x20, 0x20, 0x57, 0x65, 0x6c, 0x63, 0x6f, 0x6d, 0x65, 0x20,
+   0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x3c, 0x61, 0x20,
+   0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x68, 0x74, 0x74, 0x70,
+   0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f, 0x6e,
+   0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f, 0x72,
+   0x67, 0x22, 0x3e, 0x43, 0x6f, 0x6e, 0x74, 0x69, 0x6b, 0x69,
+   0x3c, 0x2f, 0x61, 0x3e, 0x0a, 0x20, 0x20, 0x77, 0x65, 0x62,
+   0x20, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x21, 0x0a, 0x20,
+   0x20, 0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x09, 0x20, 0x20, 0x20,
+   0x20, 0x20, 0x20, 0x0a, 0x09, 0x20, 0x20, 0x3c, 0x70, 0x20,
+   0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x22, 0x69, 0x6e, 0x74,
+   0x72, 0x6f, 0x22, 0x3e, 0x0a, 0x09, 0x20, 0x20, 0x20, 0x20,
+   0x54, 0x68, 0x65, 0x20, 0x77, 0x65, 0x62, 0x20, 0x70, 0x61,
+   0x67, 0x65, 0x73, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x61, 0x72,
+   0x65, 0x20, 0x77, 0x61, 0x74, 0x63, 0x68, 0x69, 0x6e, 0x67,
+   0x20, 0x61, 0x72, 0x65, 0x20, 0x73, 0x65, 0x72, 0x76, 0x65,
+   0x64, 0x20, 0x62, 0x79, 0x20, 0x61, 0x20, 0x77, 0x65, 0x62,
+   0x0a, 0x09, 0x20, 0x20, 0x20, 0x20, 0x73, 0x65, 0x72, 0x76,
+   0x65, 0x72, 0x20, 0x72, 0x75, 0x6e, 0x6e, 0x69, 0x6e, 0x67,
+   0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65,
+   0x20, 0x3c, 0x61, 0x0a, 0x09, 0x20, 0x20, 0x20, 0x20, 0x68,
+   0x72, 0x65, 0x66, 0x3d, 0x22, 0x68, 0x74, 0x74, 0x70, 0x3a,
+   0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f, 0x6e, 0x74,
+   0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f, 0x72, 0x67,
+   0x22, 0x3e, 0x43, 0x6f, 0x6e, 0x74, 0x69, 0x6b, 0x69, 0x20,
+   0x6f, 0x70, 0x65, 0x72, 0x61, 0x74, 0x69, 0x6e, 0x67, 0x0a,
+   0x09, 0x20, 0x20, 0x20, 0x20, 0x73, 0x79, 0x73, 0x74, 0x65,
+   0x6d, 0x3c, 0x2f, 0x61, 0x3e, 0x2e, 0x0a, 0x09, 0x20, 0x20,
+   0x3c, 0x2f, 0x70, 0x3e, 0x0a, 0x0a, 0x09, 0x20, 0x20, 0x0a,
+   0x09, 0x20, 0x0a, 0x20, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64,
+   0x79, 0x3e, 0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e,
+   0x0a};
+
+const char hdr_index_html[156]  = {
+  /* /index.html header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x31, 0x30, 0x31, 0x31, 0x0d, 0x0a, 0x43, 0x6f, 0x6e,
+   0x74, 0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a,
+   0x20, 0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c,
+   0x0d, 0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a, 0x20, 0x22, 0x65,
+   0x37, 0x63, 0x36, 0x63, 0x66, 0x32, 0x30, 0x22, 0x0d, 0x0a,
+   0x56, 0x61, 0x72, 0x79, 0x3a, 0x20, 0x41, 0x63, 0x63, 0x65,
+   0x70, 0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e,
+   0x67, 0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char gz_index_html[502]  = {
+  /* /index.html gzip */
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+   0x8d, 0x53, 0xc1, 0x6e, 0xdb, 0x30, 0x0c, 0x3d, 0xaf, 0x5f,
+   0xc1, 0x6a, 0xe7, 0x58, 0x1b, 0xda, 0xd3, 0x60, 0xfb, 0xb0,
+   0xa4, 0xc5, 0x06, 0xb4, 0x5d, 0xb1, 0x7a, 0x28, 0x76, 0x94,
+   0x65, 0xda, 0x16, 0xa2, 0x48, 0x86, 0xc4, 0xd4, 0xf3, 0xdf,
+   0x4f, 0x92, 0xe3, 0x34, 0x2b, 0x52, 0x60, 0x06, 0x0c, 0x53,
+   0xe4, 0x23, 0xf9, 0xf8, 0x44, 0xe7, 0x97, 0x9b, 0x1f, 0xeb,
+   0xea, 0xf7, 0xe3, 0x0d, 0x7c, 0xab, 0xee, 0xef, 0xe0, 0xf1,
+   0xd7, 0xd7, 0xbb, 0xef, 0x6b, 0x60, 0x2b, 0xce, 0x9f, 0xaf,
+   0xd6, 0x9c, 0x6f, 0xaa, 0xcd, 0x1c, 0xb8, 0xce, 0x3e, 0x7d,
+   0x86, 0xca, 0x09, 0xe3, 0x15, 0x29, 0x6b, 0x84, 0xe6, 0xfc,
+   0xe6, 0x81, 0x01, 0xeb, 0x89, 0x86, 0x2f, 0x9c, 0x8f, 0xe3,
+   0x98, 0x8d, 0x57, 0x99, 0x75, 0x1d, 0xaf, 0x7e, 0xf2, 0x9e,
+   0x76, 0xfa, 0x9a, 0x6b, 0x6b, 0x3d, 0x66, 0x0d, 0x35, 0xac,
+   0xbc, 0xc8, 0xa3, 0xab, 0xbc, 0x00, 0xc8, 0x7b, 0x14, 0x4d,
+   0x34, 0x82, 0x49, 0x8a, 0x34, 0x96, 0xcf, 0xa8, 0xa5, 0xdd,
+   0x21, 0x90, 0x05, 0xea, 0x11, 0xd6, 0xd6, 0x90, 0xda, 0x2a,
+   0x18, 0xb1, 0x06, 0x8f, 0xee, 0x05, 0xdd, 0x65, 0xce, 0x67,
+   0xe4, 0x9c, 0xa5, 0x95, 0xd9, 0x82, 0x43, 0x5d, 0x30, 0x4f,
+   0x93, 0x46, 0xdf, 0x23, 0x12, 0x03, 0x9a, 0x06, 0x2c, 0x18,
+   0xe1, 0x1f, 0xe2, 0xd2, 0x7b, 0x06, 0xbd, 0xc3, 0xb6, 0x60,
+   0x3c, 0x41, 0xb2, 0xe8, 0x29, 0x01, 0x62, 0x7b, 0xbe, 0xf4,
+   0xcf, 0x6b, 0xdb, 0x4c, 0x50, 0x77, 0xd2, 0x6a, 0xeb, 0x0a,
+   0xf6, 0xb1, 0x6d, 0x5b, 0x44, 0x19, 0x0a, 0x85, 0x12, 0x05,
+   0xab, 0xb5, 0x90, 0xdb, 0xc0, 0x3b, 0x02, 0x1b, 0xf5, 0x02,
+   0x52, 0x0b, 0xef, 0x0b, 0xb6, 0x43, 0xb3, 0xaf, 0xb5, 0x7d,
+   0x2f, 0xc4, 0x52, 0xe1, 0x61, 0x71, 0xd5, 0xd6, 0x35, 0xe8,
+   0x56, 0x89, 0x3c, 0x2b, 0xef, 0x03, 0x20, 0xe7, 0xc3, 0xbf,
+   0x90, 0x63, 0x56, 0xf4, 0x8a, 0x85, 0x35, 0x2b, 0x6f, 0x5d,
+   0x90, 0x01, 0x06, 0xd1, 0x61, 0xce, 0x45, 0x99, 0xd7, 0xae,
+   0x3c, 0x05, 0x78, 0x12, 0xb4, 0xf7, 0x99, 0x8f, 0xa2, 0xb2,
+   0xf2, 0x29, 0x9d, 0xce, 0xe1, 0x5a, 0x15, 0xf4, 0x59, 0x60,
+   0xb7, 0xe1, 0x00, 0x31, 0x53, 0x79, 0x52, 0xf2, 0x2c, 0x9e,
+   0xe4, 0xb0, 0xa0, 0x1f, 0x90, 0x46, 0xeb, 0xb6, 0x20, 0xad,
+   0x31, 0x28, 0xe3, 0x95, 0x9f, 0xcd, 0x18, 0x9c, 0x95, 0xe8,
+   0xfd, 0x6b, 0x97, 0xa7, 0xc9, 0x13, 0xee, 0xe0, 0xe8, 0x3f,
+   0x26, 0x25, 0xf1, 0xe7, 0xe9, 0x79, 0x90, 0xed, 0xc4, 0x78,
+   0x23, 0x64, 0xe8, 0x48, 0x68, 0x68, 0x91, 0xf9, 0x7d, 0x41,
+   0x43, 0xe8, 0xcd, 0xee, 0x1c, 0x69, 0x9d, 0x6c, 0xa5, 0x9c,
+   0xf7, 0x69, 0x65, 0x7d, 0xdc, 0x4e, 0x56, 0x1e, 0xf6, 0x2b,
+   0xf2, 0x0a, 0x05, 0x4e, 0xb6, 0x6c, 0x21, 0xf8, 0x01, 0xd2,
+   0x13, 0xbf, 0xaf, 0x9d, 0x95, 0x21, 0x67, 0xd9, 0x21, 0x58,
+   0x85, 0x56, 0x31, 0x31, 0x5e, 0x8f, 0x87, 0xc9, 0xee, 0x41,
+   0xb8, 0xe0, 0x11, 0x24, 0x7b, 0x65, 0xba, 0x74, 0x48, 0x35,
+   0x1b, 0xa8, 0x27, 0x10, 0x11, 0x3a, 0xe7, 0xcd, 0x8d, 0xc0,
+   0xed, 0x8d, 0x89, 0xb8, 0xbd, 0x09, 0xc3, 0x1c, 0x78, 0xcf,
+   0x80, 0xff, 0x25, 0x0f, 0x76, 0x40, 0x17, 0x2e, 0xd2, 0x74,
+   0x87, 0xc2, 0x49, 0xf4, 0x38, 0x52, 0x96, 0x68, 0xc7, 0x31,
+   0xa2, 0x11, 0xde, 0x34, 0x55, 0x5c, 0xf5, 0xf0, 0x0f, 0xf2,
+   0xf9, 0x27, 0xfc, 0x0b, 0x62, 0xf0, 0xdb, 0x87, 0xf3, 0x03,
+   0x00, 0x00};
+
+const char gzhdr_index_html[179]  = {
+  /* /index.html gzip header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x35, 0x30, 0x32, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d,
+   0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x2d, 0x45,
+   0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x67,
+   0x7a, 0x69, 0x70, 0x0d, 0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a,
+   0x20, 0x22, 0x64, 0x37, 0x35, 0x30, 0x32, 0x64, 0x34, 0x32,
+   0x22, 0x0d, 0x0a, 0x56, 0x61, 0x72, 0x79, 0x3a, 0x20, 0x41,
+   0x63, 0x63, 0x65, 0x70, 0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f,
+   0x64, 0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char data_files_shtml[782]  = {
+  /* /files.shtml */
+   0x2f, 0x66, 0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
+   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x20, 0x3c, 0x68,
+   0x31, 0x3e, 0x46, 0x69, 0x6c, 0x65, 0x20, 0x73, 0x74, 0x61,
+   0x74, 0x69, 0x73, 0x74, 0x69, 0x63, 0x73, 0x3c, 0x2f, 0x68,
+   0x31, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x74, 0x61, 0x62,
+   0x6c, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x22,
+   0x31, 0x30, 0x30, 0x25, 0x22, 0x3e, 0x0a, 0x20, 0x3c, 0x74,
+   0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20, 0x68,
+   0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f, 0x69, 0x6e, 0x64, 0x65,
+   0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e, 0x2f, 0x69,
+   0x6e, 0x64, 0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x3c,
+   0x2f, 0x61, 0x3e, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x20,
+   0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21, 0x20, 0x66, 0x69, 0x6c,
+   0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2f, 0x69,
+   0x6e, 0x64, 0x65, 0x78, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a,
+   0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e,
+   0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x3c,
+   0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f, 0x66,
+   0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c,
+   0x22, 0x3e, 0x2f, 0x66, 0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73,
+   0x68, 0x74, 0x6d, 0x6c, 0x3c, 0x2f, 0x61, 0x3e, 0x3c, 0x2f,
+   0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21,
+   0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74, 0x61, 0x74,
+   0x73, 0x20, 0x2f, 0x66, 0x69, 0x6c, 0x65, 0x73, 0x2e, 0x73,
+   0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e,
+   0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e,
+   0x3c, 0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65,
+   0x66, 0x3d, 0x22, 0x2f, 0x74, 0x63, 0x70, 0x2e, 0x73, 0x68,
+   0x74, 0x6d, 0x6c, 0x22, 0x3e, 0x2f, 0x74, 0x63, 0x70, 0x2e,
+   0x73, 0x68, 0x74, 0x6d, 0x6c, 0x3c, 0x2f, 0x61, 0x3e, 0x3c,
+   0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e, 0x25,
+   0x21, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74, 0x61,
+   0x74, 0x73, 0x20, 0x2f, 0x74, 0x63, 0x70, 0x2e, 0x73, 0x68,
+   0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c,
+   0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c,
+   0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66,
+   0x3d, 0x22, 0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73,
+   0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x22, 0x3e,
+   0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73,
+   0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x3c, 0x2f, 0x61, 0x3e,
+   0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e,
+   0x25, 0x21, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74,
+   0x61, 0x74, 0x73, 0x20, 0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65,
+   0x73, 0x73, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c,
+   0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72,
+   0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e,
+   0x3c, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f,
+   0x73, 0x74, 0x79, 0x6c, 0x65, 0x2e, 0x63, 0x73, 0x73, 0x22,
+   0x3e, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x2e, 0x63, 0x73,
+   0x73, 0x3c, 0x2f, 0x61, 0x3e, 0x3c, 0x2f, 0x74, 0x64, 0x3e,
+   0x0a, 0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21, 0x20, 0x66, 0x69,
+   0x6c, 0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2f,
+   0x63, 0x6f, 0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2e, 0x63, 0x73,
+   0x73, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74,
+   0x72, 0x3e, 0x0a, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64,
+   0x3e, 0x3c, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3d, 0x22,
+   0x2f, 0x34, 0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22,
+   0x3e, 0x2f, 0x34, 0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c,
+   0x3c, 0x2f, 0x61, 0x3e, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a,
+   0x3c, 0x74, 0x64, 0x3e, 0x25, 0x21, 0x20, 0x66, 0x69, 0x6c,
+   0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2f, 0x34,
+   0x30, 0x34, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x2f,
+   0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x3c,
+   0x74, 0x72, 0x3e, 0x3c, 0x74, 0x64, 0x3e, 0x3c, 0x61, 0x20,
+   0x68, 0x72, 0x65, 0x66, 0x3d, 0x22, 0x2f, 0x69, 0x6d, 0x67,
+   0x2f, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x73, 0x68, 0x6f,
+   0x74, 0x2e, 0x70, 0x6e, 0x67, 0x22, 0x3e, 0x2f, 0x69, 0x6d,
+   0x67, 0x2f, 0x73, 0x63, 0x72, 0x65, 0x65, 0x6e, 0x73, 0x68,
+   0x6f, 0x74, 0x2e, 0x70, 0x6e, 0x67, 0x3c, 0x2f, 0x61, 0x3e,
+   0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x0a, 0x3c, 0x74, 0x64, 0x3e,
+   0x25, 0x21, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x2d, 0x73, 0x74,
+   0x61, 0x74, 0x73, 0x20, 0x2f, 0x69, 0x6d, 0x67, 0x2f, 0x73,
+   0x63, 0x72, 0x65, 0x65, 0x6e, 0x73, 0x68, 0x6f, 0x74, 0x2e,
+   0x70, 0x6e, 0x67, 0x0a, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c,
+   0x2f, 0x74, 0x72, 0x3e, 0x3c, 0x2f, 0x74, 0x61, 0x62, 0x6c,
+   0x65, 0x3e, 0x0a, 0x25, 0x21, 0x3a, 0x20, 0x2f, 0x66, 0x6f,
+   0x6f, 0x74, 0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c};
+
+const struct httpd_fs_segment seg_files_shtml[]  = {
+  /* /files.shtml */
+  {data_files_shtml + 13 + 0, 0, HTTPD_FS_SEGMENT_INCLUDE, data_files_shtml + 13 + 3},
+  {data_files_shtml + 13 + 17, 107, 1, data_files_shtml + 13 + 127},
+  {data_files_shtml + 13 + 150, 68, 1, data_files_shtml + 13 + 221},
+  {data_files_shtml + 13 + 245, 64, 1, data_files_shtml + 13 + 312},
+  {data_files_shtml + 13 + 334, 76, 1, data_files_shtml + 13 + 413},
+  {data_files_shtml + 13 + 441, 64, 1, data_files_shtml + 13 + 508},
+  {data_files_shtml + 13 + 532, 62, 1, data_files_shtml + 13 + 597},
+  {data_files_shtml + 13 + 618, 82, 1, data_files_shtml + 13 + 703},
+  {data_files_shtml + 13 + 734, 19, HTTPD_FS_SEGMENT_INCLUDE, data_files_shtml + 13 + 756},
+  {data_files_shtml + 13 + 769, 0, HTTPD_FS_SEGMENT_END, NULL}};
+
+const char data_upload_html[209]  = {
+  /* /upload.html */
+   0x2f, 0x75, 0x70, 0x6c, 0x6f, 0x61, 0x64, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a, 0x3c, 0x62, 0x6f,
+   0x64, 0x79, 0x3e, 0x0a, 0x3c, 0x66, 0x6f, 0x72, 0x6d, 0x20,
+   0x61, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x3d, 0x22, 0x75, 0x70,
+   0x6c, 0x6f, 0x61, 0x64, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x22,
+   0x20, 0x65, 0x6e, 0x63, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22,
+   0x6d, 0x75, 0x6c, 0x74, 0x69, 0x70, 0x61, 0x72, 0x74, 0x2f,
+   0x66, 0x6f, 0x72, 0x6d, 0x2d, 0x64, 0x61, 0x74, 0x61, 0x22,
+   0x20, 0x6d, 0x65, 0x74, 0x68, 0x6f, 0x64, 0x3d, 0x22, 0x70,
+   0x6f, 0x73, 0x74, 0x22, 0x3e, 0x0a, 0x3c, 0x69, 0x6e, 0x70,
+   0x75, 0x74, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x75,
+   0x73, 0x65, 0x72, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x20, 0x74,
+   0x79, 0x70, 0x65, 0x3d, 0x22, 0x66, 0x69, 0x6c, 0x65, 0x22,
+   0x20, 0x73, 0x69, 0x7a, 0x65, 0x3d, 0x22, 0x35, 0x30, 0x22,
+   0x20, 0x2f, 0x3e, 0x0a, 0x3c, 0x69, 0x6e, 0x70, 0x75, 0x74,
+   0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x3d, 0x22, 0x55, 0x70,
+   0x6c, 0x6f, 0x61, 0x64, 0x22, 0x20, 0x74, 0x79, 0x70, 0x65,
+   0x3d, 0x22, 0x73, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22, 0x20,
+   0x2f, 0x3e, 0x0a, 0x3c, 0x2f, 0x66, 0x6f, 0x72, 0x6d, 0x3e,
+   0x0a, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a, 0x3c,
+   0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e};
+
+const char hdr_upload_html[155]  = {
+  /* /upload.html header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x31, 0x39, 0x36, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d,
+   0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a, 0x20, 0x22, 0x65, 0x37,
+   0x30, 0x37, 0x35, 0x31, 0x64, 0x30, 0x22, 0x0d, 0x0a, 0x56,
+   0x61, 0x72, 0x79, 0x3a, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70,
+   0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67,
+   0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char gz_upload_html[153]  = {
+  /* /upload.html gzip */
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+   0x3d, 0x8e, 0x4b, 0x0e, 0xc2, 0x30, 0x0c, 0x44, 0xf7, 0x9c,
+   0xc2, 0xf2, 0x1e, 0xc2, 0x86, 0x5d, 0xc3, 0x2d, 0x38, 0x80,
+   0xdb, 0xa4, 0x6a, 0xa4, 0x38, 0x89, 0x1a, 0x07, 0xa9, 0x3d,
+   0x3d, 0xf9, 0x00, 0xab, 0x19, 0x59, 0xcf, 0x33, 0x33, 0x6d,
+   0xc2, 0xfe, 0x79, 0x99, 0xe6, 0x68, 0x8e, 0x2a, 0x6b, 0xdc,
+   0x19, 0x68, 0x11, 0x17, 0x83, 0xc6, 0x92, 0x7c, 0x24, 0x73,
+   0x6b, 0x04, 0x82, 0x0d, 0x8b, 0x1c, 0xc9, 0x6a, 0xe4, 0xe2,
+   0xc5, 0x25, 0xda, 0x45, 0x35, 0xf8, 0x6a, 0x48, 0x08, 0x81,
+   0xad, 0x6c, 0xd1, 0x68, 0x4c, 0x31, 0x0b, 0xd6, 0x1c, 0x17,
+   0x52, 0x11, 0x08, 0xc4, 0xf5, 0xa1, 0x64, 0xbb, 0xaf, 0xce,
+   0x5b, 0x84, 0x11, 0x30, 0x7c, 0x76, 0x67, 0xf5, 0x8f, 0x3b,
+   0x82, 0xfa, 0xf3, 0x6f, 0xf2, 0xa5, 0x1e, 0x5f, 0xbd, 0xf7,
+   0x87, 0xe7, 0x32, 0xb3, 0x93, 0x81, 0xf5, 0xca, 0xa6, 0xdf,
+   0xb9, 0xaa, 0xaf, 0xff, 0x00, 0x59, 0xc1, 0x4c, 0xed, 0xc4,
+   0x00, 0x00, 0x00};
+
+const char gzhdr_upload_html[179]  = {
+  /* /upload.html gzip header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x31, 0x35, 0x33, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74,
+   0x65, 0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20,
+   0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d,
+   0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x2d, 0x45,
+   0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x67,
+   0x7a, 0x69, 0x70, 0x0d, 0x0a, 0x45, 0x54, 0x61, 0x67, 0x3a,
+   0x20, 0x22, 0x65, 0x34, 0x39, 0x39, 0x65, 0x66, 0x64, 0x63,
+   0x22, 0x0d, 0x0a, 0x56, 0x61, 0x72, 0x79, 0x3a, 0x20, 0x41,
+   0x63, 0x63, 0x65, 0x70, 0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f,
+   0x64, 0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char data_footer_html[30]  = {
+  /* /footer.html */
+   0x2f, 0x66, 0x6f, 0x6f, 0x74, 0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x20, 0x20, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a,
+   0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e};
+
+const char hdr_footer_html[131]  = {
+  /* /footer.html header */
+   0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32,
+   0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x53, 0x65, 0x72,
+   0x76, 0x65, 0x72, 0x3a, 0x20, 0x43, 0x6f, 0x6e, 0x74, 0x69,
+   0x6b, 0x69, 0x2f, 0x32, 0x2e, 0x36, 0x20, 0x68, 0x74, 0x74,
+   0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x63, 0x6f,
+   0x6e, 0x74, 0x69, 0x6b, 0x69, 0x2d, 0x6f, 0x73, 0x2e, 0x6f,
+   0x72, 0x67, 0x2f, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a,
+   0x20, 0x31, 0x37, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65,
+   0x6e, 0x74, 0x2d, 0x74, 0x79, 0x70, 0x65, 0x3a, 0x20, 0x74,
+   0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x0d, 0x0a,
+   0x45, 0x54, 0x61, 0x67, 0x3a, 0x20, 0x22, 0x66, 0x37, 0x63,
+   0x61, 0x62, 0x35, 0x39, 0x63, 0x22, 0x0d, 0x0a, 0x0d, 0x0a, 0x00};
+
+const char data_processes_shtml[185]  = {
+  /* /processes.shtml */
+   0x2f, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
+   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x68, 0x31,
+   0x3e, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x20, 0x70, 0x72,
+   0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73, 0x3c, 0x2f, 0x68,
+   0x31, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x74, 0x61, 0x62,
+   0x6c, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x22,
+   0x31, 0x30, 0x30, 0x25, 0x22, 0x3e, 0x0a, 0x3c, 0x74, 0x72,
+   0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x49, 0x44, 0x3c, 0x2f, 0x74,
+   0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x4e, 0x61, 0x6d, 0x65,
+   0x3c, 0x2f, 0x74, 0x68, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 0x54,
+   0x68, 0x72, 0x65, 0x61, 0x64, 0x3c, 0x2f, 0x74, 0x68, 0x3e,
+   0x3c, 0x74, 0x68, 0x3e, 0x50, 0x72, 0x6f, 0x63, 0x65, 0x73,
+   0x73, 0x20, 0x73, 0x74, 0x61, 0x74, 0x65, 0x3c, 0x2f, 0x74,
+   0x68, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x0a, 0x25, 0x21,
+   0x20, 0x70, 0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x65, 0x73,
+   0x0a, 0x25, 0x21, 0x3a, 0x20, 0x2f, 0x66, 0x6f, 0x6f, 0x74,
+   0x65, 0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a};
+
+const struct httpd_fs_segment seg_processes_shtml[]  = {
+  /* /processes.shtml */
+  {data_processes_shtml + 17 + 0, 0, HTTPD_FS_SEGMENT_INCLUDE, data_processes_shtml + 17 + 3},
+  {data_processes_shtml + 17 + 17, 121, 2, data_processes_shtml + 17 + 141},
+  {data_processes_shtml + 17 + 151, 0, HTTPD_FS_SEGMENT_INCLUDE, data_processes_shtml + 17 + 154},
+  {data_processes_shtml + 17 + 168, 0, HTTPD_FS_SEGMENT_END, NULL}};
+
+const char data_status_shtml[174]  = {
+  /* /status.shtml */
+   0x2f, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x2e, 0x73, 0x68, 0x74, 0x6d, 0x6c, 0x00,
+   0x25, 0x21, 0x3a, 0x20, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x65,
+   0x72, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x0a, 0x3c, 0x68, 0x34,
+   0x3e, 0x41, 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x65, 0x73,
+   0x3c, 0x2f, 0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x61,
+   0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x65, 0x73, 0x0a, 0x3c,
+   0x68, 0x34, 0x3e, 0x4e, 0x65, 0x69, 0x67, 0x68, 0x62, 0x6f,
+   0x72, 0x73, 0x3c, 0x2f, 0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21,
+   0x20, 0x6e, 0x65, 0x69, 0x67, 0x68, 0x62, 0x6f, 0x72, 0x73,
+   0x0a, 0x3c, 0x68, 0x34, 0x3e, 0x52, 0x6f, 0x75, 0x74, 0x65,
+   0x73, 0x3c, 0x2f, 0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21, 0x20,
+   0x72, 0x6f, 0x75, 0x74, 0x65, 0x73, 0x0a, 0x3c, 0x68, 0x34,
+   0x3e, 0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x73, 0x3c, 0x2f,
+   0x68, 0x34, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x73, 0x65, 0x6e,
+   0x73, 0x6f, 0x72, 0x73, 0x0a, 0x3c, 0x2f, 0x74, 0x61, 0x62,
+   0x6c, 0x65, 0x3e, 0x0a, 0x25, 0x21, 0x20, 0x66, 0x69, 0x6c,
+   0x65, 0x2d, 0x73, 0x74, 0x61, 0x74, 0x73, 0x20, 0x2e, 0x0a};
+
+const struct httpd_fs_segment seg_status_shtml[]  = {
+  /* /status.shtml */
+  {data_status_shtml + 14 + 0, 0, HTTPD_FS_SEGMENT_INCLUDE, data_status_shtml + 14 + 3},
+  {data_status_shtml + 14 + 17, 19, 3, data_status_shtml + 14 + 39},
+  {data_status_shtml + 14 + 49, 19, 4, data_status_shtml + 14 + 71},
+  {data_status_shtml + 14 + 81, 16, 5, data_status_shtml + 14 + 100},
+  {data_status_shtml + 14 + 107, 17, 6, data_status_shtml + 14 + 127},
+  {data_status_shtml + 14 + 135, 9, 1, data_status_shtml + 14 + 147},
+  {data_status_shtml + 14 + 160, 0, HTTPD_FS_SEGMENT_END, NULL}};
+
 
 /* Structure of linked list (all offsets relative to start of section):
 struct httpd_fsdata_file {
@@ -654,22 +1106,29 @@ struct httpd_fsdata_file {
    const char *name;                     //offset to coffee file name
    const char *data;                     //offset to coffee file data
    const int len;                        //length of file data
+   const char *header;                   //precomputed response header
+   const char *gzdata;                   //gzip-encoded file data
+   const int gzlen;                      //length of gzip-encoded data
+   const char *gzheader;                 //precomputed header for the gzip data
+   const struct httpd_fs_segment *segments; //script split into chunks and CGI ids
 #if HTTPD_FS_STATISTICS == 1               //not enabled since list is in PROGMEM
    uint16_t count;                       //storage for file statistics
 #endif
 }
 */
-const struct httpd_fsdata_file file_processes_shtml[] ={{                NULL, data_processes_shtml, data_processes_shtml +17, sizeof(data_processes_shtml) -17}};
-const struct httpd_fsdata_file     file_footer_html[] ={{file_processes_shtml, data_footer_html   , data_footer_html    +13, sizeof(data_footer_html)     -13}};
-const struct httpd_fsdata_file     file_files_shtml[] ={{    file_footer_html, data_files_shtml   , data_files_shtml    +13, sizeof(data_files_shtml)     -13}};
-const struct httpd_fsdata_file     file_upload_html[] ={{    file_files_shtml, data_upload_html   , data_upload_html    +13, sizeof(data_upload_html)     -13}};
-const struct httpd_fsdata_file       file_tcp_shtml[] ={{    file_upload_html, data_tcp_shtml     , data_tcp_shtml      +11, sizeof(data_tcp_shtml)       -11}};
-const struct httpd_fsdata_file    file_status_shtml[] ={{      file_tcp_shtml, data_status_shtml  , data_status_shtml   +14, sizeof(data_status_shtml)    -14}};
-const struct httpd_fsdata_file     file_header_html[] ={{   file_status_shtml, data_header_html   , data_header_html    +13, sizeof(data_header_html)     -13}};
-const struct httpd_fsdata_file      file_index_html[] ={{    file_header_html, data_index_html    , data_index_html     +12, sizeof(data_index_html)      -12}};
-const struct httpd_fsdata_file        file_404_html[] ={{     file_index_html, data_404_html      , data_404_html       +10, sizeof(data_404_html)        -10}};
-const struct httpd_fsdata_file       file_style_css[] ={{       file_404_html, data_style_css     , data_style_css      +11, sizeof(data_style_css)       -11}};
-
-#define HTTPD_FS_ROOT  file_style_css
+const struct httpd_fsdata_file     file_header_html[] ={{                NULL, data_header_html   , data_header_html    +13, sizeof(data_header_html)     -13, hdr_header_html, gz_header_html, sizeof(gz_header_html), gzhdr_header_html, NULL}};
+const struct httpd_fsdata_file       file_style_css[] ={{    file_header_html, data_style_css     , data_style_css      +11, sizeof(data_style_css)       -11, hdr_style_css, gz_style_css, sizeof(gz_style_css), gzhdr_style_css, NULL}};
+const struct httpd_fsdata_file       file_tcp_shtml[] ={{      file_style_css, data_tcp_shtml     , data_tcp_shtml      +11, sizeof(data_tcp_shtml)       -11, NULL, NULL, 0, NULL, seg_tcp_shtml}};
+const struct httpd_fsdata_file        file_404_html[] ={{      file_tcp_shtml, data_404_html      , data_404_html       +10, sizeof(data_404_html)        -10, hdr_404_html, gz_404_html, sizeof(gz_404_html), gzhdr_404_html, NULL}};
+const struct httpd_fsdata_file      file_index_html[] ={{       file_404_html, data_index_html    , data_index_html     +12, sizeof(data_index_html)      -12, hdr_index_html, gz_index_html, sizeof(gz_index_html), gzhdr_index_html, NULL}};
+const struct httpd_fsdata_file     file_files_shtml[] ={{     file_index_html, data_files_shtml   , data_files_shtml    +13, sizeof(data_files_shtml)     -13, NULL, NULL, 0, NULL, seg_files_shtml}};
+const struct httpd_fsdata_file     file_upload_html[] ={{    file_files_shtml, data_upload_html   , data_upload_html    +13, sizeof(data_upload_html)     -13, hdr_upload_html, gz_upload_html, sizeof(gz_upload_html), gzhdr_upload_html, NULL}};
+const struct httpd_fsdata_file     file_footer_html[] ={{    file_upload_html, data_footer_html   , data_footer_html    +13, sizeof(data_footer_html)     -13, hdr_footer_html, NULL, 0, NULL, NULL}};
+const struct httpd_fsdata_file file_processes_shtml[] ={{    file_footer_html, data_processes_shtml, data_processes_shtml +17, sizeof(data_processes_shtml) -17, NULL, NULL, 0, NULL, seg_processes_shtml}};
+const struct httpd_fsdata_file    file_status_shtml[] ={{file_processes_shtml, data_status_shtml  , data_status_shtml   +14, sizeof(data_status_shtml)    -14, NULL, NULL, 0, NULL, seg_status_shtml}};
+
+#define HTTPD_FS_ROOT  file_status_shtml
 #define HTTPD_FS_NUMFILES  10
 #define HTTPD_FS_SIZE 6166
+
+/* CGI ids: 0 tcp-connections, 1 file-stats, 2 processes, 3 addresses, 4 neighbors, 5 routes, 6 sensors */
@@ -35,12 +35,18 @@
 #define __HTTPD_FSDATA_H__
 
 #include "contiki-net.h"
+#include "httpd-fs.h"
 
 struct httpd_fsdata_file {
   const struct httpd_fsdata_file *next;
   const char *name;
   const char *data;
   const int len;
+  const char *header;
+  const char *gzdata;
+  const int gzlen;
+  const char *gzheader;
+  const struct httpd_fs_segment *segments;
 #ifdef HTTPD_FS_STATISTICS
 #if HTTPD_FS_STATISTICS == 1
   uint16_t count;
@@ -53,6 +59,11 @@ struct httpd_fsdata_file_noconst {
   char *name;
   char *data;
   int len;
+  char *header;
+  char *gzdata;
+  int gzlen;
+  char *gzheader;
+  const struct httpd_fs_segment *segments;
 #ifdef HTTPD_FS_STATISTICS
 #if HTTPD_FS_STATISTICS == 1
   uint16_t count;
@@ -54,10 +54,49 @@
 #define STATE_WAITING 0
 #define STATE_OUTPUT  1
 
+/* The number of CGI ids from makefsdata -T whose functions are
+   remembered after the first lookup by name. */
+#ifndef WEBSERVER_CONF_CGI_IDS
+#define CGI_IDS 8
+#else /* WEBSERVER_CONF_CGI_IDS */
+#define CGI_IDS WEBSERVER_CONF_CGI_IDS
+#endif /* WEBSERVER_CONF_CGI_IDS */
+
+/* The connection is closed once the queued requests are answered. */
+#define HTTPD_FLAG_LAST       0x01
+/* The response being sent ends by closing the connection. */
+#define HTTPD_FLAG_CLOSE      0x02
+/* The request being parsed asked for the connection to be closed. */
+#define HTTPD_FLAG_CONN_CLOSE 0x04
+/* The header line being parsed did not fit in the input buffer. */
+#define HTTPD_FLAG_MIDLINE    0x08
+/* The response being sent is gzip-encoded if the file allows. */
+#define HTTPD_FLAG_GZIP       0x10
+/* The client already has the file being requested. */
+#define HTTPD_FLAG_NOT_MODIFIED 0x20
+/* The request being answered is an HTTP/1.0 request. */
+#define HTTPD_FLAG_HTTP10     0x40
+
+/* queue_flags holds the HTTPD_FS_ variants whose ETag the client
+   sent, whether it accepts gzip and whether it spoke HTTP/1.0. */
+#define HTTPD_REQ_HTTP10      0x40
+#define HTTPD_REQ_GZIP        0x80
+
+/* The status lines are HTTP/1.1 ones. For an HTTP/1.0 request, their
+   version is skipped and http_10 is sent in its place. */
+#define STATUS_SKIP(s) (((s)->flags & HTTPD_FLAG_HTTP10) ? \
+                        sizeof(http_10) - 1 : 0)
+
+/* The queue slot of the request being parsed. */
+#define NEXT_SLOT(s) (((s)->queue_head + (s)->queued) % WEBSERVER_CONF_PIPELINE)
+
 #define SEND_STRING(s, str) PSOCK_SEND(s, (uint8_t *)str, (unsigned int)strlen(str))
 MEMB(conns, struct httpd_state, CONNS);
 
+static httpd_cgifunction cgi_ids[CGI_IDS];
+
 #define ISO_nl      0x0a
+#define ISO_cr      0x0d
 #define ISO_space   0x20
 #define ISO_bang    0x21
 #define ISO_percent 0x25
@@ -65,33 +104,16 @@ MEMB(conns, struct httpd_state, CONNS);
 #define ISO_slash   0x2f
 #define ISO_colon   0x3a
 
-/*---------------------------------------------------------------------------*/
-static unsigned short
-generate(void *state)
-{
-  struct httpd_state *s = (struct httpd_state *)state;
-
-  if(s->file.len > uip_mss()) {
-    s->len = uip_mss();
-  } else {
-    s->len = s->file.len;
-  }
-  memcpy(uip_appdata, s->file.data, s->len);
-  
-  return s->len;
-}
 /*---------------------------------------------------------------------------*/
 static
 PT_THREAD(send_file(struct httpd_state *s))
 {
   PSOCK_BEGIN(&s->sout);
-  
-  do {
-    PSOCK_GENERATOR_SEND(&s->sout, generate, s);
-    s->file.len -= s->len;
-    s->file.data += s->len;
-  } while(s->file.len > 0);
-      
+
+  /* The file system data does not move, so it's sent as it is and
+     uIP resends lost segments by itself. */
+  PSOCK_SEND(&s->sout, (uint8_t *)s->file.data, s->file.len);
+
   PSOCK_END(&s->sout);
 }
 /*---------------------------------------------------------------------------*/
@@ -123,6 +145,49 @@ next_scriptstate(struct httpd_state *s)
   s->scriptptr = p;*/
 }
 /*---------------------------------------------------------------------------*/
+static httpd_cgifunction
+segment_cgi(const struct httpd_fs_segment *segment)
+{
+  if(segment->cgi >= CGI_IDS) {
+    return httpd_cgi((char *)segment->arg);
+  }
+  if(cgi_ids[segment->cgi] == NULL) {
+    cgi_ids[segment->cgi] = httpd_cgi((char *)segment->arg);
+  }
+  return cgi_ids[segment->cgi];
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(handle_segments(struct httpd_state *s))
+{
+  PT_BEGIN(&s->scriptpt);
+
+  for(s->segment = s->file.segments;; ++s->segment) {
+    s->file.data = (char *)s->segment->text;
+    s->file.len = s->segment->len;
+    while(s->file.len > 0) {
+      s->len = s->file.len > uip_mss() ? uip_mss() : s->file.len;
+      PT_WAIT_THREAD(&s->scriptpt, send_part_of_file(s));
+      s->file.data += s->len;
+      s->file.len -= s->len;
+    }
+
+    if(s->segment->cgi == HTTPD_FS_SEGMENT_END) {
+      break;
+    }
+    s->scriptptr = (char *)s->segment->arg;
+    if(s->segment->cgi == HTTPD_FS_SEGMENT_INCLUDE) {
+      httpd_fs_open(s->scriptptr + 1, &s->file);
+      PT_WAIT_THREAD(&s->scriptpt, send_file(s));
+    } else {
+      PT_WAIT_THREAD(&s->scriptpt,
+                     segment_cgi(s->segment)(s, s->scriptptr));
+    }
+  }
+
+  PT_END(&s->scriptpt);
+}
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(handle_script(struct httpd_state *s))
 {
@@ -181,109 +246,330 @@ PT_THREAD(handle_script(struct httpd_state *s))
   PT_END(&s->scriptpt);
 }
 /*---------------------------------------------------------------------------*/
-static
-PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
+static const char *
+content_type(const char *filename)
 {
-/* gcc warning if not initialized. 
- * If initialized, minimal-net platform segmentation fault if not static...
- */
-  static const char *ptr = NULL;
+  const char *ptr;
 
-  PSOCK_BEGIN(&s->sout);
-
-  SEND_STRING(&s->sout, statushdr);
-
-  ptr = strrchr(s->filename, ISO_period);
+  ptr = strrchr(filename, ISO_period);
   if(ptr == NULL) {
-    ptr = http_content_type_binary;
+    return http_content_type_binary;
   } else if(strncmp(http_html, ptr, 5) == 0 ||
 	    strncmp(http_shtml, ptr, 6) == 0) {
-    ptr = http_content_type_html;
+    return http_content_type_html;
   } else if(strncmp(http_css, ptr, 4) == 0) {
-    ptr = http_content_type_css;
+    return http_content_type_css;
   } else if(strncmp(http_png, ptr, 4) == 0) {
-    ptr = http_content_type_png;
+    return http_content_type_png;
   } else if(strncmp(http_gif, ptr, 4) == 0) {
-    ptr = http_content_type_gif;
+    return http_content_type_gif;
   } else if(strncmp(http_jpg, ptr, 4) == 0) {
-    ptr = http_content_type_jpg;
+    return http_content_type_jpg;
+  }
+  return http_content_type_plain;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+generate_headers(void *state)
+{
+  struct httpd_state *s = (struct httpd_state *)state;
+  char *ptr = (char *)uip_appdata;
+
+  if(s->flags & HTTPD_FLAG_CLOSE) {
+    strcpy(ptr, http_connection_close);
   } else {
-    ptr = http_content_type_plain;
+    sprintf(ptr, "%s%u\r\n", http_content_length, (unsigned int)s->file.len);
   }
-  SEND_STRING(&s->sout, ptr);
+  strcat(ptr, content_type(s->filename));
+
+  return (unsigned short)strlen(ptr);
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
+{
+  PSOCK_BEGIN(&s->sout);
+
+  if(s->flags & HTTPD_FLAG_HTTP10) {
+    PSOCK_SEND(&s->sout, (uint8_t *)http_10, sizeof(http_10) - 1);
+  }
+  SEND_STRING(&s->sout, statushdr + STATUS_SKIP(s));
+  PSOCK_GENERATOR_SEND(&s->sout, generate_headers, s);
+
   PSOCK_END(&s->sout);
 }
 /*---------------------------------------------------------------------------*/
 static
-PT_THREAD(handle_output(struct httpd_state *s))
+PT_THREAD(send_precomputed(struct httpd_state *s, const char *statushdr,
+			   const char *header))
+{
+  /* Without a separate status line, the header starts with one. */
+  if(statushdr == NULL) {
+    header += STATUS_SKIP(s);
+  }
+
+  PSOCK_BEGIN(&s->sout);
+
+  if(s->flags & HTTPD_FLAG_HTTP10) {
+    PSOCK_SEND(&s->sout, (uint8_t *)http_10, sizeof(http_10) - 1);
+  }
+  if(statushdr != NULL) {
+    SEND_STRING(&s->sout, statushdr + STATUS_SKIP(s));
+  }
+  if(s->flags & HTTPD_FLAG_CLOSE) {
+    /* Announce the close in place of the empty line ending header. */
+    PSOCK_SEND(&s->sout, (uint8_t *)header, (unsigned int)strlen(header) - 2);
+    SEND_STRING(&s->sout, http_connection_close_crnl);
+  } else {
+    SEND_STRING(&s->sout, header);
+  }
+
+  PSOCK_END(&s->sout);
+}
+/*---------------------------------------------------------------------------*/
+static int
+open_file(struct httpd_state *s)
+{
+  if(s->flags & HTTPD_FLAG_GZIP) {
+    return httpd_fs_open_gzip(s->filename, &s->file);
+  }
+  return httpd_fs_open(s->filename, &s->file);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned char
+is_script(struct httpd_state *s)
 {
   char *ptr;
-  
+
+  ptr = strrchr(s->filename, ISO_period);
+  return ptr != NULL && strncmp(ptr, http_shtml, 6) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_framing(struct httpd_state *s)
+{
+  if(is_script(s)) {
+    /* The length of a script's output is not known up front, so the
+       end of the response is marked by closing the connection. */
+    s->flags |= HTTPD_FLAG_LAST | HTTPD_FLAG_CLOSE;
+  } else if((s->flags & HTTPD_FLAG_LAST) && s->queued == 0) {
+    s->flags |= HTTPD_FLAG_CLOSE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static unsigned char
+header_match(const char *str, const char *name)
+{
+  /* Header names and connection options are case-insensitive. */
+  for(; *name != 0; ++str, ++name) {
+    if((*str | 0x20) != (*name | 0x20)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(handle_output(struct httpd_state *s))
+{
   PT_BEGIN(&s->outputpt);
- 
-  if(!httpd_fs_open(s->filename, &s->file)) {
-    strcpy(s->filename, http_404_html);
-    httpd_fs_open(s->filename, &s->file);
-    PT_WAIT_THREAD(&s->outputpt,
-		   send_headers(s,
-		   http_header_404));
-    PT_WAIT_THREAD(&s->outputpt,
-		   send_file(s));
-  } else {
-    PT_WAIT_THREAD(&s->outputpt,
-		   send_headers(s,
-		   http_header_200));
-    ptr = strrchr(s->filename, ISO_period);
-    if(ptr != NULL && strncmp(ptr, http_shtml, 6) == 0) {
-      PT_INIT(&s->scriptpt);
-      PT_WAIT_THREAD(&s->outputpt, handle_script(s));
-    } else {
+
+  while(1) {
+    memcpy(s->filename, s->queue[s->queue_head], sizeof(s->filename));
+    s->flags &= ~(HTTPD_FLAG_GZIP | HTTPD_FLAG_NOT_MODIFIED |
+		  HTTPD_FLAG_HTTP10);
+    if(s->queue_flags[s->queue_head] & HTTPD_REQ_HTTP10) {
+      s->flags |= HTTPD_FLAG_HTTP10;
+    }
+    if(s->queue_flags[s->queue_head] & HTTPD_REQ_GZIP) {
+      s->flags |= HTTPD_FLAG_GZIP;
+      if(s->queue_flags[s->queue_head] & HTTPD_FS_GZIP) {
+	s->flags |= HTTPD_FLAG_NOT_MODIFIED;
+      }
+    } else if(s->queue_flags[s->queue_head] & HTTPD_FS_IDENTITY) {
+      s->flags |= HTTPD_FLAG_NOT_MODIFIED;
+    }
+    s->queue_head = (s->queue_head + 1) % WEBSERVER_CONF_PIPELINE;
+    --s->queued;
+
+    if(!open_file(s)) {
+      strcpy(s->filename, http_404_html);
+      httpd_fs_open(s->filename, &s->file);
+      set_framing(s);
+      PT_WAIT_THREAD(&s->outputpt,
+		     send_headers(s,
+		     http_header_11_404));
       PT_WAIT_THREAD(&s->outputpt,
 		     send_file(s));
+    } else if(s->file.header != NULL) {
+      set_framing(s);
+      if(s->flags & HTTPD_FLAG_NOT_MODIFIED) {
+	/* The ETag ends the precomputed header with what a 304 needs. */
+	PT_WAIT_THREAD(&s->outputpt,
+		       send_precomputed(s, http_header_11_304,
+					strstr(s->file.header, http_etag)));
+      } else {
+	PT_WAIT_THREAD(&s->outputpt,
+		       send_precomputed(s, NULL, s->file.header));
+	PT_WAIT_THREAD(&s->outputpt,
+		       send_file(s));
+      }
+    } else {
+      set_framing(s);
+      PT_WAIT_THREAD(&s->outputpt,
+		     send_headers(s,
+		     http_header_11_200));
+      if(is_script(s) && s->file.segments != NULL) {
+	/* The script was split when the file system was generated. */
+	PT_INIT(&s->scriptpt);
+	PT_WAIT_THREAD(&s->outputpt, handle_segments(s));
+      } else if(is_script(s)) {
+	PT_INIT(&s->scriptpt);
+	PT_WAIT_THREAD(&s->outputpt, handle_script(s));
+      } else {
+	PT_WAIT_THREAD(&s->outputpt,
+		       send_file(s));
+      }
+    }
+
+    if((s->flags & HTTPD_FLAG_CLOSE) ||
+       (s->queued == 0 && (s->flags & HTTPD_FLAG_LAST))) {
+      s->flags |= HTTPD_FLAG_LAST;
+      s->queued = 0;
+      s->state = STATE_WAITING;
+      PSOCK_CLOSE(&s->sout);
+      PT_EXIT(&s->outputpt);
+    }
+    if(s->queued == 0) {
+      s->state = STATE_WAITING;
+      PT_EXIT(&s->outputpt);
     }
   }
-  PSOCK_CLOSE(&s->sout);
+
   PT_END(&s->outputpt);
 }
 /*---------------------------------------------------------------------------*/
 static
 PT_THREAD(handle_input(struct httpd_state *s))
 {
+  char *filename;
+  char *ptr;
+  uint8_t *data;
+
   PSOCK_BEGIN(&s->sin);
 
-  PSOCK_READTO(&s->sin, ISO_space);
-  
-  if(strncmp(s->inputbuf, http_get, 4) != 0) {
-    PSOCK_CLOSE_EXIT(&s->sin);
-  }
-  PSOCK_READTO(&s->sin, ISO_space);
+  while(!(s->flags & HTTPD_FLAG_LAST)) {
+    /* Sending the output overwrites uip_appdata, so pipelined
+       requests are parsed into the queue as soon as they arrive. If
+       one comes in while the queue is full, the connection is closed
+       after the queued responses and the client retries the rest. */
+    PSOCK_WAIT_UNTIL(&s->sin, s->queued < WEBSERVER_CONF_PIPELINE ||
+		     PSOCK_NEWDATA(&s->sin));
+    if(s->queued == WEBSERVER_CONF_PIPELINE) {
+      break;
+    }
 
-  if(s->inputbuf[0] != ISO_slash) {
-    PSOCK_CLOSE_EXIT(&s->sin);
-  }
+    PSOCK_READTO(&s->sin, ISO_space);
 
-  if(s->inputbuf[1] == ISO_space) {
-    strncpy(s->filename, http_index_html, sizeof(s->filename));
-  } else {
-    s->inputbuf[PSOCK_DATALEN(&s->sin) - 1] = 0;
-    strncpy(s->filename, s->inputbuf, sizeof(s->filename));
-  }
+    if(strncmp(s->inputbuf, http_get, 4) != 0) {
+      break;
+    }
+    PSOCK_READTO(&s->sin, ISO_space);
 
-  petsciiconv_topetscii(s->filename, sizeof(s->filename));
-  webserver_log_file(&uip_conn->ripaddr, s->filename);
-  petsciiconv_toascii(s->filename, sizeof(s->filename));
-  s->state = STATE_OUTPUT;
+    if(s->inputbuf[0] != ISO_slash) {
+      break;
+    }
 
-  while(1) {
+    /* Answering a request only advances queue_head as it decrements
+       queued, so this slot stays the same until the request is
+       queued below. */
+    filename = s->queue[NEXT_SLOT(s)];
+    s->queue_flags[NEXT_SLOT(s)] = 0;
+    if(s->inputbuf[1] == ISO_space) {
+      strncpy(filename, http_index_html, sizeof(s->filename));
+    } else {
+      s->inputbuf[PSOCK_DATALEN(&s->sin) - 1] = 0;
+      strncpy(filename, s->inputbuf, sizeof(s->filename));
+    }
+
+    petsciiconv_topetscii(filename, sizeof(s->filename));
+    webserver_log_file(&uip_conn->ripaddr, filename);
+    petsciiconv_toascii(filename, sizeof(s->filename));
+
+    /* Only HTTP/1.1 connections are persistent by default; HTTP/1.0
+       keep-alive would need a Connection header in every response. */
     PSOCK_READTO(&s->sin, ISO_nl);
+    if(strncmp(s->inputbuf, http_10, 8) == 0) {
+      s->queue_flags[NEXT_SLOT(s)] |= HTTPD_REQ_HTTP10;
+    }
+    if(!WEBSERVER_CONF_KEEPALIVE || strncmp(s->inputbuf, http_11, 8) != 0) {
+      s->flags |= HTTPD_FLAG_CONN_CLOSE;
+    }
+
+    s->flags &= ~HTTPD_FLAG_MIDLINE;
+    while(1) {
+      PSOCK_READTO(&s->sin, ISO_nl);
+      s->inputbuf[PSOCK_DATALEN(&s->sin)] = 0;
+
+      if(!(s->flags & HTTPD_FLAG_MIDLINE)) {
+	if(s->inputbuf[0] == ISO_cr || s->inputbuf[0] == ISO_nl) {
+	  break;
+	}
+	if(header_match(s->inputbuf, http_connection)) {
+	  ptr = s->inputbuf + sizeof(http_connection) - 1;
+	  while(*ptr == ISO_space) {
+	    ++ptr;
+	  }
+	  if(header_match(ptr, http_close)) {
+	    s->flags |= HTTPD_FLAG_CONN_CLOSE;
+	  }
+	} else if(header_match(s->inputbuf, http_accept_encoding)) {
+	  if(strstr(s->inputbuf, http_gzip) != NULL) {
+	    s->queue_flags[NEXT_SLOT(s)] |= HTTPD_REQ_GZIP;
+	  }
+	} else if(header_match(s->inputbuf, http_if_none_match)) {
+	  ptr = s->inputbuf + sizeof(http_if_none_match) - 1;
+	  while(*ptr == ISO_space) {
+	    ++ptr;
+	  }
+	  /* A weak comparison is what If-None-Match calls for. */
+	  if(ptr[0] == 'W' && ptr[1] == ISO_slash) {
+	    ptr += 2;
+	  }
+	  s->queue_flags[NEXT_SLOT(s)] |=
+	    httpd_fs_match_etag(s->queue[NEXT_SLOT(s)], ptr);
+	} else if(strncmp(s->inputbuf, http_referer, 8) == 0) {
+	  s->inputbuf[PSOCK_DATALEN(&s->sin) - 2] = 0;
+	  petsciiconv_topetscii(s->inputbuf, PSOCK_DATALEN(&s->sin) - 2);
+	  webserver_log(s->inputbuf);
+	}
+      }
 
-    if(strncmp(s->inputbuf, http_referer, 8) == 0) {
-      s->inputbuf[PSOCK_DATALEN(&s->sin) - 2] = 0;
-      petsciiconv_topetscii(s->inputbuf, PSOCK_DATALEN(&s->sin) - 2);
-      webserver_log(s->inputbuf);
+      if(s->inputbuf[PSOCK_DATALEN(&s->sin) - 1] == ISO_nl) {
+	s->flags &= ~HTTPD_FLAG_MIDLINE;
+      } else {
+	s->flags |= HTTPD_FLAG_MIDLINE;
+      }
     }
+
+    ++s->queued;
+    if(s->flags & HTTPD_FLAG_CONN_CLOSE) {
+      s->flags |= HTTPD_FLAG_LAST;
+    }
+    s->state = STATE_OUTPUT;
   }
-  
+
+  /* No more requests are accepted on this connection. */
+  s->flags |= HTTPD_FLAG_LAST;
+  if(s->state == STATE_WAITING) {
+    PSOCK_CLOSE_EXIT(&s->sin);
+  }
+  /* Discard whatever else the client sends, without copying it. */
+  while(1) {
+    PSOCK_WAIT_UNTIL(&s->sin, PSOCK_PEEK(&s->sin, &data) > 0);
+    PSOCK_CONSUME(&s->sin, PSOCK_PEEK(&s->sin, &data));
+  }
+
   PSOCK_END(&s->sin);
 }
 /*---------------------------------------------------------------------------*/
@@ -315,6 +601,8 @@ httpd_appcall(void *state)
     PSOCK_INIT(&s->sin, (uint8_t *)s->inputbuf, sizeof(s->inputbuf) - 1);
     PSOCK_INIT(&s->sout, (uint8_t *)s->inputbuf, sizeof(s->inputbuf) - 1);
     PT_INIT(&s->outputpt);
+    s->queue_head = s->queued = 0;
+    s->flags = 0;
     s->state = STATE_WAITING;
     /*    timer_set(&s->timer, CLOCK_SECOND * 100);*/
     s->timer = 0;
@@ -325,6 +613,10 @@ httpd_appcall(void *state)
       if(s->timer >= 20) {
 	uip_abort();
 	memb_free(&conns, s);
+      } else if(s->timer >= WEBSERVER_CONF_IDLE_TIMEOUT &&
+		s->state == STATE_WAITING) {
+	/* Close a kept-alive connection nobody is using. */
+	uip_close();
       }
     } else {
       s->timer = 0;
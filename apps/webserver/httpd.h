@@ -38,17 +38,42 @@
 #include "contiki-net.h"
 #include "httpd-fs.h"
 
+/* Keep the connection open between HTTP/1.1 requests. Responses are
+   then framed by Content-Length, except for .shtml pages, whose
+   length is not known in advance and which still end by closing.
+   Off by default: every connection carries one request. */
+#ifndef WEBSERVER_CONF_KEEPALIVE
+#define WEBSERVER_CONF_KEEPALIVE 0
+#endif /* WEBSERVER_CONF_KEEPALIVE */
+
+/* The number of pipelined requests that can be queued behind the one
+   being answered. Must be at least one. */
+#ifndef WEBSERVER_CONF_PIPELINE
+#define WEBSERVER_CONF_PIPELINE 2
+#endif /* WEBSERVER_CONF_PIPELINE */
+
+/* The number of TCP polls (half a second each) a kept-alive
+   connection may stay idle before it is closed. */
+#ifndef WEBSERVER_CONF_IDLE_TIMEOUT
+#define WEBSERVER_CONF_IDLE_TIMEOUT 10
+#endif /* WEBSERVER_CONF_IDLE_TIMEOUT */
+
 struct httpd_state {
   unsigned char timer;
   struct psock sin, sout;
   struct pt outputpt, scriptpt;
   char inputbuf[50];
   char filename[20];
+  char queue[WEBSERVER_CONF_PIPELINE][20];
+  unsigned char queue_flags[WEBSERVER_CONF_PIPELINE];
+  unsigned char queue_head, queued;
+  unsigned char flags;
   char state;
   struct httpd_fs_file file;  
   int len;
   char *scriptptr;
   int scriptlen;
+  const struct httpd_fs_segment *segment;
   union {
     unsigned short count;
     void *ptr;
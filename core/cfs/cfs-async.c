@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Asynchronous reads and writes on top of the CFS interface
+ */
+
+#include "cfs/cfs.h"
+#include "cfs/cfs-async.h"
+#include "lib/list.h"
+
+#define OP_READ  0
+#define OP_WRITE 1
+
+LIST(requests);
+
+process_event_t cfs_async_event;
+
+PROCESS(cfs_async_process, "CFS async");
+/*---------------------------------------------------------------------------*/
+static int
+queued(struct cfs_async *req)
+{
+  struct cfs_async *r;
+
+  for(r = list_head(requests); r != NULL; r = list_item_next(r)) {
+    if(r == req) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+enqueue(struct cfs_async *req, int fd, void *buf, unsigned len, uint8_t op)
+{
+  if(fd < 0 || queued(req)) {
+    return -1;
+  }
+  if(!process_is_running(&cfs_async_process)) {
+    cfs_async_event = process_alloc_event();
+    process_start(&cfs_async_process, NULL);
+  }
+
+  req->owner = PROCESS_CURRENT();
+  req->fd = fd;
+  req->buf = buf;
+  req->len = len;
+  req->done = 0;
+  req->result = -1;
+  req->op = op;
+  list_add(requests, req);
+  process_poll(&cfs_async_process);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_read_async(struct cfs_async *req, int fd, void *buf, unsigned len)
+{
+  return enqueue(req, fd, buf, len, OP_READ);
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_write_async(struct cfs_async *req, int fd, const void *buf, unsigned len)
+{
+  return enqueue(req, fd, (void *)buf, len, OP_WRITE);
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_async_cancel(struct cfs_async *req)
+{
+  list_remove(requests, req);
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_async_pending(void)
+{
+  return list_head(requests) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Transfer one slice of the first request; returns non-zero when the
+   request is finished. */
+static int
+run_slice(struct cfs_async *req)
+{
+  unsigned n;
+  int r;
+
+  n = req->len - req->done;
+  if(n > CFS_ASYNC_CHUNK_SIZE) {
+    n = CFS_ASYNC_CHUNK_SIZE;
+  }
+  if(n == 0) {
+    req->result = 0;
+    return 1;
+  }
+
+  if(req->op == OP_READ) {
+    r = cfs_read(req->fd, (uint8_t *)req->buf + req->done, n);
+  } else {
+    r = cfs_write(req->fd, (uint8_t *)req->buf + req->done, n);
+  }
+
+  if(r > 0) {
+    req->done += r;
+  }
+  if(r >= 0 || req->done > 0) {
+    req->result = req->done;
+  }
+  /* A short transfer means end of file or a full medium. */
+  return r < (int)n || req->done == req->len;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(cfs_async_process, ev, data)
+{
+  struct cfs_async *req;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    while((req = list_head(requests)) != NULL) {
+      if(run_slice(req)) {
+        list_remove(requests, req);
+        process_post(req->owner, cfs_async_event, req);
+      }
+      /* Let other processes run between slices. */
+      process_poll(&cfs_async_process);
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
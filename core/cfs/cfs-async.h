@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Asynchronous reads and writes on top of the CFS interface
+ *
+ *         A request is queued with cfs_read_async() or
+ *         cfs_write_async() and carried out by a storage process in
+ *         slices of CFS_ASYNC_CHUNK_SIZE bytes. The process yields
+ *         between slices, so other processes keep running during
+ *         large transfers. When the request is done, the process that
+ *         queued it receives cfs_async_event with the request as data.
+ *
+ *         The request structure and the buffer belong to the storage
+ *         process until the event has been posted. A file must not be
+ *         accessed synchronously while it has requests pending.
+ */
+
+#ifndef CFS_ASYNC_H
+#define CFS_ASYNC_H
+
+#include "contiki.h"
+
+#ifdef CFS_ASYNC_CONF_CHUNK_SIZE
+#define CFS_ASYNC_CHUNK_SIZE CFS_ASYNC_CONF_CHUNK_SIZE
+#else
+#define CFS_ASYNC_CHUNK_SIZE 128
+#endif
+
+struct cfs_async {
+  struct cfs_async *next;
+  struct process *owner;
+  void *buf;
+  unsigned len;
+  unsigned done;
+  int fd;
+  /** The number of bytes transferred, or -1 if nothing could be */
+  int result;
+  uint8_t op;
+};
+
+extern process_event_t cfs_async_event;
+
+/**
+ * \brief      Queue a read from the current position of a file
+ * \param req  The request, which must stay valid until completion
+ * \param fd   The file descriptor
+ * \param buf  The buffer to read into
+ * \param len  The number of bytes to read
+ * \return     0 if the request was queued, -1 otherwise
+ *
+ *             The calling process receives cfs_async_event when the
+ *             read is done. Fewer than len bytes are read at the end
+ *             of the file.
+ */
+int cfs_read_async(struct cfs_async *req, int fd, void *buf, unsigned len);
+
+/**
+ * \brief      Queue a write to the current position of a file
+ * \param req  The request, which must stay valid until completion
+ * \param fd   The file descriptor
+ * \param buf  The data to write
+ * \param len  The number of bytes to write
+ * \return     0 if the request was queued, -1 otherwise
+ */
+int cfs_write_async(struct cfs_async *req, int fd, const void *buf,
+                    unsigned len);
+
+/**
+ * \brief      Remove a request that has not completed yet
+ *
+ *             Part of the transfer may already have been done. No
+ *             event is posted for a cancelled request.
+ */
+void cfs_async_cancel(struct cfs_async *req);
+
+/**
+ * \brief      Check whether any requests are pending
+ */
+int cfs_async_pending(void);
+
+#endif /* CFS_ASYNC_H */
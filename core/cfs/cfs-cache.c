@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A small write-back cache between a CFS backend and its
+ *         storage driver
+ */
+
+#include "cfs/cfs-cache.h"
+
+#include <string.h>
+
+#define LINE_BASE(offset) ((offset) & ~((unsigned long)CFS_CACHE_LINE_SIZE - 1))
+
+/*---------------------------------------------------------------------------*/
+static struct cfs_cache_line *
+lookup(struct cfs_cache *c, unsigned long base)
+{
+  uint8_t i;
+
+  for(i = 0; i < c->num_lines; i++) {
+    if(c->lines[i].valid && c->lines[i].offset == base) {
+      c->lines[i].age = ++c->clock;
+      return &c->lines[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_line(struct cfs_cache *c, struct cfs_cache_line *l)
+{
+  if(l->dirty_end > l->dirty_start) {
+    c->write(&l->data[l->dirty_start], l->dirty_end - l->dirty_start,
+             l->offset + l->dirty_start);
+    l->dirty_start = l->dirty_end = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct cfs_cache_line *
+fill(struct cfs_cache *c, unsigned long base)
+{
+  struct cfs_cache_line *l;
+  uint8_t i;
+
+  /* Take an unused block, or else the least recently used one. */
+  l = &c->lines[0];
+  for(i = 0; i < c->num_lines; i++) {
+    if(!c->lines[i].valid) {
+      l = &c->lines[i];
+      break;
+    }
+    if((uint16_t)(c->clock - c->lines[i].age) >
+       (uint16_t)(c->clock - l->age)) {
+      l = &c->lines[i];
+    }
+  }
+
+  if(l->valid) {
+    flush_line(c, l);
+  }
+
+  c->read(l->data, CFS_CACHE_LINE_SIZE, base);
+  l->offset = base;
+  l->valid = 1;
+  l->dirty_start = l->dirty_end = 0;
+  l->age = ++c->clock;
+  return l;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the length of the run of whole, uncached blocks starting at
+   offset that fits in size, or 0 if offset is not block-aligned. */
+static unsigned
+uncached_run(struct cfs_cache *c, unsigned long offset, unsigned size)
+{
+  unsigned n;
+
+  if(offset != LINE_BASE(offset)) {
+    return 0;
+  }
+  for(n = 0; n + CFS_CACHE_LINE_SIZE <= size; n += CFS_CACHE_LINE_SIZE) {
+    if(lookup(c, offset + n) != NULL) {
+      break;
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_cache_read(struct cfs_cache *c, void *buf, unsigned size,
+               unsigned long offset)
+{
+  struct cfs_cache_line *l;
+  unsigned long base;
+  unsigned n;
+
+  while(size > 0) {
+    base = LINE_BASE(offset);
+    l = lookup(c, base);
+    if(l == NULL) {
+      n = uncached_run(c, offset, size);
+      if(n > 0) {
+        c->read(buf, n, offset);
+        buf = (uint8_t *)buf + n;
+        offset += n;
+        size -= n;
+        continue;
+      }
+      l = fill(c, base);
+    }
+
+    n = base + CFS_CACHE_LINE_SIZE - offset;
+    if(n > size) {
+      n = size;
+    }
+    memcpy(buf, &l->data[offset - base], n);
+    buf = (uint8_t *)buf + n;
+    offset += n;
+    size -= n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_cache_write(struct cfs_cache *c, const void *buf, unsigned size,
+                unsigned long offset)
+{
+  struct cfs_cache_line *l;
+  unsigned long base;
+  unsigned n, start;
+
+  while(size > 0) {
+    base = LINE_BASE(offset);
+    l = lookup(c, base);
+    if(l == NULL) {
+      n = uncached_run(c, offset, size);
+      if(n > 0) {
+        c->write(buf, n, offset);
+        buf = (const uint8_t *)buf + n;
+        offset += n;
+        size -= n;
+        continue;
+      }
+      l = fill(c, base);
+    }
+
+    start = offset - base;
+    n = CFS_CACHE_LINE_SIZE - start;
+    if(n > size) {
+      n = size;
+    }
+    memcpy(&l->data[start], buf, n);
+
+    /* Extend the modified range of the block. Unmodified bytes
+       between two modifications are written back with the data
+       they already hold. */
+    if(l->dirty_end == l->dirty_start) {
+      l->dirty_start = start;
+      l->dirty_end = start + n;
+    } else {
+      if(start < l->dirty_start) {
+        l->dirty_start = start;
+      }
+      if(start + n > l->dirty_end) {
+        l->dirty_end = start + n;
+      }
+    }
+
+    buf = (const uint8_t *)buf + n;
+    offset += n;
+    size -= n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_cache_flush(struct cfs_cache *c)
+{
+  uint8_t i;
+
+  for(i = 0; i < c->num_lines; i++) {
+    if(c->lines[i].valid) {
+      flush_line(c, &c->lines[i]);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_cache_invalidate(struct cfs_cache *c, unsigned long offset,
+                     unsigned long size)
+{
+  uint8_t i;
+
+  for(i = 0; i < c->num_lines; i++) {
+    if(c->lines[i].valid &&
+       c->lines[i].offset + CFS_CACHE_LINE_SIZE > offset &&
+       c->lines[i].offset < offset + size) {
+      c->lines[i].valid = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A small write-back cache between a CFS backend and its
+ *         storage driver
+ *
+ *         The cache holds a few aligned blocks of the medium. Reads
+ *         fill a whole block, so sequential reads of small records
+ *         cost one driver read per block. Writes are collected in the
+ *         cached block and written out as one driver write when the
+ *         block is evicted or the cache is flushed. Requests that
+ *         cover whole uncached blocks go to the driver directly.
+ *
+ *         The block size must divide the size of the medium and the
+ *         alignment of the area that the backend uses.
+ */
+
+#ifndef CFS_CACHE_H
+#define CFS_CACHE_H
+
+#include "contiki-conf.h"
+#include "sys/cc.h"
+
+#ifdef CFS_CACHE_CONF_LINE_SIZE
+#define CFS_CACHE_LINE_SIZE CFS_CACHE_CONF_LINE_SIZE
+#else
+#define CFS_CACHE_LINE_SIZE 64
+#endif
+
+#if (CFS_CACHE_LINE_SIZE & (CFS_CACHE_LINE_SIZE - 1)) != 0
+#error CFS_CACHE_CONF_LINE_SIZE must be a power of two.
+#endif
+
+struct cfs_cache_line {
+  unsigned long offset;
+  uint16_t dirty_start, dirty_end;
+  uint16_t age;
+  uint8_t valid;
+  uint8_t data[CFS_CACHE_LINE_SIZE];
+};
+
+struct cfs_cache {
+  struct cfs_cache_line *lines;
+  uint8_t num_lines;
+  void (*read)(void *buf, unsigned size, unsigned long offset);
+  void (*write)(const void *buf, unsigned size, unsigned long offset);
+  uint16_t clock;
+};
+
+/**
+ * \brief      Declare a cache
+ * \param name The name of the cache structure
+ * \param lines The number of blocks in the cache
+ * \param readf The driver function that reads from the medium
+ * \param writef The driver function that writes to the medium
+ */
+#define CFS_CACHE(name, lines, readf, writef)                           \
+  static struct cfs_cache_line CC_CONCAT(name,_lines)[lines];            \
+  static struct cfs_cache name = { CC_CONCAT(name,_lines), lines,        \
+                                   readf, writef, 0 }
+
+void cfs_cache_read(struct cfs_cache *c, void *buf, unsigned size,
+                    unsigned long offset);
+void cfs_cache_write(struct cfs_cache *c, const void *buf, unsigned size,
+                     unsigned long offset);
+
+/**
+ * \brief      Write all modified blocks to the medium
+ */
+void cfs_cache_flush(struct cfs_cache *c);
+
+/**
+ * \brief      Drop the cached blocks of a region, including unwritten
+ *             modifications; used before the region is erased
+ */
+void cfs_cache_invalidate(struct cfs_cache *c, unsigned long offset,
+                          unsigned long size);
+
+#endif /* CFS_CACHE_H */
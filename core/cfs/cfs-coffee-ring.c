@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Ring files stored in rotating Coffee segment files
+ */
+
+#include "cfs/cfs.h"
+#include "cfs-coffee-arch.h"
+#include "cfs/cfs-coffee.h"
+
+#include <string.h>
+
+/* Each segment starts with the sequence number of the segment. */
+#define HEADER_SIZE sizeof(uint16_t)
+
+/* The longest name that Coffee keeps; the name field of a file
+   header also holds the terminating null. */
+#define NAME_LENGTH (COFFEE_NAME_LENGTH - 1)
+
+/* Room for the ".<index>" suffix of a segment name. */
+#define SUFFIX_LENGTH 4
+
+/*---------------------------------------------------------------------------*/
+static void
+segment_name(char *buf, const char *name, uint8_t index)
+{
+  char *p;
+
+  strncpy(buf, name, NAME_LENGTH - SUFFIX_LENGTH);
+  buf[NAME_LENGTH - SUFFIX_LENGTH] = '\0';
+  p = buf + strlen(buf);
+  *p++ = '.';
+  if(index >= 100) {
+    *p++ = '0' + index / 100;
+  }
+  if(index >= 10) {
+    *p++ = '0' + index / 10 % 10;
+  }
+  *p++ = '0' + index % 10;
+  *p = '\0';
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_seq(const char *name, uint16_t *seq)
+{
+  int fd;
+  int r;
+
+  fd = cfs_open(name, CFS_READ);
+  if(fd < 0) {
+    return -1;
+  }
+  r = cfs_read(fd, seq, sizeof(*seq));
+  cfs_close(fd);
+  return r == sizeof(*seq) ? 0 : -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+open_segment(struct cfs_coffee_ring *ring, int create)
+{
+  char name[NAME_LENGTH + 1];
+
+  segment_name(name, ring->name, ring->current);
+  if(create) {
+    cfs_remove(name);
+    if(cfs_coffee_reserve(name, ring->segment_size + HEADER_SIZE) < 0) {
+      return -1;
+    }
+  }
+
+  ring->fd = cfs_open(name, CFS_WRITE | CFS_APPEND);
+  if(ring->fd < 0) {
+    return -1;
+  }
+  cfs_coffee_set_io_semantics(ring->fd, CFS_COFFEE_IO_APPEND_STREAM |
+                                        CFS_COFFEE_IO_FIRM_SIZE);
+
+  if(create) {
+    if(cfs_write(ring->fd, &ring->seq, HEADER_SIZE) != HEADER_SIZE) {
+      cfs_close(ring->fd);
+      ring->fd = -1;
+      return -1;
+    }
+    ring->offset = 0;
+  } else {
+    ring->offset = cfs_seek(ring->fd, 0, CFS_SEEK_CUR) - HEADER_SIZE;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_coffee_ring_open(struct cfs_coffee_ring *ring, const char *name,
+                     uint8_t segments, cfs_offset_t segment_size)
+{
+  char seg_name[NAME_LENGTH + 1];
+  uint16_t seq;
+  uint8_t i;
+  int found;
+
+  if(segments < 2 || segment_size == 0) {
+    return -1;
+  }
+
+  ring->name = name;
+  ring->segments = segments;
+  ring->segment_size = segment_size;
+  ring->fd = -1;
+
+  /* The newest segment is the one with the highest sequence number. */
+  found = 0;
+  for(i = 0; i < segments; i++) {
+    segment_name(seg_name, name, i);
+    if(read_seq(seg_name, &seq) == 0 &&
+       (!found || (int16_t)(seq - ring->seq) > 0)) {
+      ring->seq = seq;
+      ring->current = i;
+      found = 1;
+    }
+  }
+
+  if(!found) {
+    ring->seq = 1;
+    ring->current = 0;
+  }
+  return open_segment(ring, !found);
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_coffee_ring_write(struct cfs_coffee_ring *ring,
+                      const void *buf, unsigned size)
+{
+  if(ring->fd < 0 || size > ring->segment_size) {
+    return -1;
+  }
+
+  if(ring->offset + size > ring->segment_size) {
+    cfs_close(ring->fd);
+    ring->current = (ring->current + 1) % ring->segments;
+    ring->seq++;
+    if(open_segment(ring, 1) < 0) {
+      return -1;
+    }
+  }
+
+  if(cfs_write(ring->fd, buf, size) != size) {
+    return -1;
+  }
+  ring->offset += size;
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_coffee_ring_segment(struct cfs_coffee_ring *ring, uint8_t age)
+{
+  char name[NAME_LENGTH + 1];
+  uint16_t seq;
+  int fd;
+
+  if(age >= ring->segments) {
+    return -1;
+  }
+
+  segment_name(name, ring->name,
+               (ring->current + ring->segments - age) % ring->segments);
+  fd = cfs_open(name, CFS_READ);
+  if(fd < 0) {
+    return -1;
+  }
+  if(cfs_read(fd, &seq, sizeof(seq)) != sizeof(seq) ||
+     seq != (uint16_t)(ring->seq - age)) {
+    cfs_close(fd);
+    return -1;
+  }
+  return fd;
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_coffee_ring_close(struct cfs_coffee_ring *ring)
+{
+  if(ring->fd >= 0) {
+    cfs_close(ring->fd);
+    ring->fd = -1;
+  }
+}
+/*---------------------------------------------------------------------------*/
@@ -59,6 +59,11 @@
 #include "cfs-coffee-arch.h"
 #include "cfs/cfs-coffee.h"
 
+#if COFFEE_BACKGROUND_GC
+#include "sys/process.h"
+#include "sys/clock.h"
+#endif
+
 /* Micro logs enable modifications on storage types that do not support
    in-place updates. This applies primarily to flash memories. */
 #ifndef COFFEE_MICRO_LOGS
@@ -90,10 +95,123 @@
 #define COFFEE_EXTENDED_WEAR_LEVELLING	1
 #endif
 
+/*
+ * Keep a directory of hashed file names and start pages in RAM, so
+ * that opening a file that is not in the file cache does not require
+ * a sequential scan of the storage medium. The directory holds up to
+ * COFFEE_DIR_CACHE_SIZE files; if there are more files, lookups that
+ * miss in the directory fall back to scanning. Set to 0 to disable.
+ */
+#ifndef COFFEE_DIR_CACHE_SIZE
+#define COFFEE_DIR_CACHE_SIZE	0
+#endif
+
+/*
+ * Record in the file header how far each file has been written, in
+ * eighths of its reserved size. When a file is loaded, the search for
+ * the end of the file can then start at the hinted eighth instead of
+ * at the last reserved page. Updating the hint costs up to eight
+ * extra header writes over the lifetime of a file.
+ */
+#ifndef COFFEE_EOF_HINT
+#define COFFEE_EOF_HINT		0
+#endif
+
+/*
+ * Find the end of a file by a binary search over its pages instead of
+ * a backward scan. This is only correct if no page within the written
+ * part of a file is entirely zero, so it must not be enabled if files
+ * may contain long runs of zeroes or are extended by seeking past
+ * their end.
+ */
+#ifndef COFFEE_EOF_BINARY_SEARCH
+#define COFFEE_EOF_BINARY_SEARCH	0
+#endif
+
+/*
+ * Erase fully obsolete sectors from a background process instead of
+ * waiting until a reservation fails, so that file operations rarely
+ * have to run the garbage collector synchronously. The process works
+ * in slices of at most COFFEE_GC_SLICE_TIME clock ticks, erasing at
+ * most one sector per slice, and yields to other processes in between.
+ */
+#ifndef COFFEE_BACKGROUND_GC
+#define COFFEE_BACKGROUND_GC	0
+#endif
+
+#ifndef COFFEE_GC_SLICE_TIME
+#define COFFEE_GC_SLICE_TIME	(CLOCK_SECOND / 64)
+#endif
+
+/*
+ * Count the erasures of each sector and let reservations prefer free
+ * pages in the least worn sectors. The counters are kept in the last
+ * sector of the Coffee area, which is then no longer available for
+ * files; changing this setting therefore requires a reformat.
+ */
+#ifndef COFFEE_WEAR_COUNTERS
+#define COFFEE_WEAR_COUNTERS	0
+#endif
+
+/* The number of erasures logged before the counter table in the wear
+   sector is rewritten. */
+#ifndef COFFEE_WEAR_LOG_RECORDS
+#define COFFEE_WEAR_LOG_RECORDS	1024
+#endif
+
+/*
+ * Keep COFFEE_CACHE_LINES blocks of the medium in a write-back cache
+ * (see cfs-cache.h), so that small reads and writes are combined into
+ * fewer driver operations. Modified blocks are written out when they
+ * are evicted, when a file is closed, and by cfs_coffee_sync().
+ */
+#ifndef COFFEE_CACHE_LINES
+#define COFFEE_CACHE_LINES	0
+#endif
+
 #if COFFEE_START & (COFFEE_SECTOR_SIZE - 1)
 #error COFFEE_START must point to the first byte in a sector.
 #endif
 
+#if COFFEE_CACHE_LINES > 0
+#include "cfs/cfs-cache.h"
+
+#if COFFEE_SECTOR_SIZE % CFS_CACHE_LINE_SIZE
+#error CFS_CACHE_LINE_SIZE must divide COFFEE_SECTOR_SIZE.
+#endif
+
+/* The driver functions of the cache use the platform's macros, which
+   are then redirected through the cache for the rest of this file. */
+static void
+cache_read(void *buf, unsigned size, unsigned long offset)
+{
+  COFFEE_READ(buf, size, offset);
+}
+static void
+cache_write(const void *buf, unsigned size, unsigned long offset)
+{
+  COFFEE_WRITE(buf, size, offset);
+}
+CFS_CACHE(coffee_cache, COFFEE_CACHE_LINES, cache_read, cache_write);
+
+static void
+cache_erase(uint16_t sector)
+{
+  cfs_cache_invalidate(&coffee_cache, sector * COFFEE_SECTOR_SIZE,
+                       COFFEE_SECTOR_SIZE);
+  COFFEE_ERASE(sector);
+}
+
+#undef COFFEE_READ
+#undef COFFEE_WRITE
+#undef COFFEE_ERASE
+#define COFFEE_READ(buf, size, offset)					\
+  	cfs_cache_read(&coffee_cache, (buf), (size), (offset))
+#define COFFEE_WRITE(buf, size, offset)					\
+  	cfs_cache_write(&coffee_cache, (buf), (size), (offset))
+#define COFFEE_ERASE(sector)	cache_erase(sector)
+#endif /* COFFEE_CACHE_LINES > 0 */
+
 #define COFFEE_FD_FREE		0x0
 #define COFFEE_FD_READ		0x1
 #define COFFEE_FD_WRITE		0x2
@@ -133,6 +251,7 @@
 #define HDR_FLAG_MODIFIED	0x8	/* Modified file, log exists. */
 #define HDR_FLAG_LOG		0x10	/* Log file. */
 #define HDR_FLAG_ISOLATED	0x20	/* Isolated page. */
+#define HDR_FLAG_EOF_HINT	0x40	/* The EOF hint is maintained. */
 
 /* File header macros. */
 #define CHECK_FLAG(hdr, flag)	((hdr).flags & (flag))
@@ -143,16 +262,34 @@
 #define HDR_MODIFIED(hdr)	CHECK_FLAG(hdr, HDR_FLAG_MODIFIED)
 #define HDR_ISOLATED(hdr)	CHECK_FLAG(hdr, HDR_FLAG_ISOLATED)
 #define HDR_OBSOLETE(hdr) 	CHECK_FLAG(hdr, HDR_FLAG_OBSOLETE)
+#define HDR_EOF_HINT(hdr)	CHECK_FLAG(hdr, HDR_FLAG_EOF_HINT)
 #define HDR_ACTIVE(hdr)		(HDR_ALLOCATED(hdr) && \
 				!HDR_OBSOLETE(hdr)  && \
 				!HDR_ISOLATED(hdr))
 
 /* Shortcuts derived from the hardware-dependent configuration of Coffee. */
+#define COFFEE_PAGES_PER_SECTOR	\
+	((coffee_page_t)(COFFEE_SECTOR_SIZE / COFFEE_PAGE_SIZE))
+#if COFFEE_WEAR_COUNTERS
+/* The sector after the last file sector holds the wear counters. */
+#define COFFEE_SECTOR_COUNT	\
+	(unsigned)(COFFEE_SIZE / COFFEE_SECTOR_SIZE - 1)
+#define COFFEE_PAGE_COUNT	\
+	((coffee_page_t)(COFFEE_SECTOR_COUNT * COFFEE_PAGES_PER_SECTOR))
+#define WEAR_SECTOR		COFFEE_SECTOR_COUNT
+#define WEAR_MAGIC		0x57454152UL
+#define WEAR_TABLE_OFFSET	(WEAR_SECTOR * COFFEE_SECTOR_SIZE)
+#define WEAR_LOG_OFFSET		(WEAR_TABLE_OFFSET + sizeof(uint32_t) + \
+				 sizeof(protected_mem.wear))
+
+#if 4 * (COFFEE_SIZE / COFFEE_SECTOR_SIZE + 1) + 2 * COFFEE_WEAR_LOG_RECORDS > COFFEE_SECTOR_SIZE
+#error COFFEE_WEAR_LOG_RECORDS is too large to fit in a sector.
+#endif
+#else
 #define COFFEE_SECTOR_COUNT	(unsigned)(COFFEE_SIZE / COFFEE_SECTOR_SIZE)
 #define COFFEE_PAGE_COUNT	\
 	((coffee_page_t)(COFFEE_SIZE / COFFEE_PAGE_SIZE))
-#define COFFEE_PAGES_PER_SECTOR	\
-	((coffee_page_t)(COFFEE_SECTOR_SIZE / COFFEE_PAGE_SIZE))
+#endif /* COFFEE_WEAR_COUNTERS */
 
 /* This structure is used for garbage collection statistics. */
 struct sector_status {
@@ -169,6 +306,14 @@ struct file {
   int16_t record_count;
   uint8_t references;
   uint8_t flags;
+#if COFFEE_EOF_HINT
+  uint8_t eof_hint;
+#endif
+#if COFFEE_MICRO_LOGS && COFFEE_IO_SEMANTICS
+  /* The offset from which appends through an append stream can be
+     written to the file directly, bypassing the micro log. */
+  cfs_offset_t append_start;
+#endif
 };
 
 /* The file descriptor structure. */
@@ -188,11 +333,23 @@ struct file_header {
   uint16_t log_records;
   uint16_t log_record_size;
   coffee_page_t max_pages;
-  uint8_t deprecated_eof_hint;
+  uint8_t eof_hint;
   uint8_t flags;
   char name[COFFEE_NAME_LENGTH];
 };
 
+#if COFFEE_DIR_CACHE_SIZE > 0
+/* Entries of the RAM directory. */
+struct dir_entry {
+  uint16_t hash;
+  coffee_page_t page;
+};
+
+#define DIR_UNBUILT		0
+#define DIR_COMPLETE		1
+#define DIR_OVERFLOW		2
+#endif
+
 /* This is needed because of a buggy compiler. */
 struct log_param {
   cfs_offset_t offset;
@@ -211,16 +368,47 @@ static struct protected_mem_t {
   struct file_desc coffee_fd_set[COFFEE_FD_SET_SIZE];
   coffee_page_t next_free;
   char gc_wait;
+#if COFFEE_DIR_CACHE_SIZE > 0
+  struct dir_entry dir[COFFEE_DIR_CACHE_SIZE];
+  uint16_t dir_count;
+  uint8_t dir_state;
+#endif
+#if COFFEE_WEAR_COUNTERS
+  /* Erase counts of the file sectors and, last, of the wear sector. */
+  uint32_t wear[COFFEE_SECTOR_COUNT + 1];
+  uint16_t wear_log_records;
+  uint8_t wear_loaded;
+#endif
 } protected_mem;
 static struct file * const coffee_files = protected_mem.coffee_files;
 static struct file_desc * const coffee_fd_set = protected_mem.coffee_fd_set;
 static coffee_page_t * const next_free = &protected_mem.next_free;
 static char * const gc_wait = &protected_mem.gc_wait;
+#if COFFEE_DIR_CACHE_SIZE > 0
+static struct dir_entry * const dir = protected_mem.dir;
+#endif
+
+/* The iteration state of get_sector_status(). */
+struct sector_scan {
+  coffee_page_t skip_pages;
+  char last_pages_are_active;
+};
+static struct sector_scan scan;
+
+#if COFFEE_BACKGROUND_GC
+/* Incremented whenever the page headers or the sectors change, so that
+   the background collector knows when its scan state is stale. */
+static uint16_t layout_version;
+#define LAYOUT_CHANGED()	layout_version++
+#else
+#define LAYOUT_CHANGED()
+#endif
 
 /*---------------------------------------------------------------------------*/
 static void
 write_header(struct file_header *hdr, coffee_page_t page)
 {
+  LAYOUT_CHANGED();
   hdr->flags |= HDR_FLAG_VALID;
   COFFEE_WRITE(hdr, sizeof(*hdr), page * COFFEE_PAGE_SIZE);
 }
@@ -242,11 +430,106 @@ absolute_offset(coffee_page_t page, cfs_offset_t offset)
   return page * COFFEE_PAGE_SIZE + sizeof(struct file_header) + offset;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_WEAR_COUNTERS
+static void
+wear_write_table(void)
+{
+  uint32_t magic;
+
+  COFFEE_ERASE(WEAR_SECTOR);
+  magic = WEAR_MAGIC;
+  COFFEE_WRITE(&magic, sizeof(magic), WEAR_TABLE_OFFSET);
+  COFFEE_WRITE(protected_mem.wear, sizeof(protected_mem.wear),
+               WEAR_TABLE_OFFSET + sizeof(magic));
+  protected_mem.wear_log_records = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wear_load(void)
+{
+  uint32_t magic;
+  uint16_t records[16];
+  uint16_t i, n;
+
+  if(protected_mem.wear_loaded) {
+    return;
+  }
+  protected_mem.wear_loaded = 1;
+
+  COFFEE_READ(&magic, sizeof(magic), WEAR_TABLE_OFFSET);
+  if(magic != WEAR_MAGIC) {
+    PRINTF("Coffee: Initializing the wear counters\n");
+    memset(protected_mem.wear, 0, sizeof(protected_mem.wear));
+    wear_write_table();
+    return;
+  }
+
+  COFFEE_READ(protected_mem.wear, sizeof(protected_mem.wear),
+              WEAR_TABLE_OFFSET + sizeof(magic));
+
+  /* Add the erasures logged since the table was written. Each log
+     record holds a sector number plus one, so that unwritten records
+     read as zero. */
+  for(n = 0; n < COFFEE_WEAR_LOG_RECORDS; n += i) {
+    COFFEE_READ(records, sizeof(records),
+                WEAR_LOG_OFFSET + n * sizeof(records[0]));
+    for(i = 0; i < sizeof(records) / sizeof(records[0]) &&
+          n + i < COFFEE_WEAR_LOG_RECORDS; i++) {
+      if(records[i] == 0) {
+        protected_mem.wear_log_records = n + i;
+        return;
+      }
+      if(records[i] <= COFFEE_SECTOR_COUNT) {
+        protected_mem.wear[records[i] - 1]++;
+      }
+    }
+  }
+  protected_mem.wear_log_records = COFFEE_WEAR_LOG_RECORDS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wear_count(uint16_t sector)
+{
+  uint16_t record;
+
+  wear_load();
+  protected_mem.wear[sector]++;
+
+  if(protected_mem.wear_log_records >= COFFEE_WEAR_LOG_RECORDS) {
+    /* The log is full; fold it into a new table. */
+    protected_mem.wear[WEAR_SECTOR]++;
+    wear_write_table();
+    return;
+  }
+
+  record = sector + 1;
+  COFFEE_WRITE(&record, sizeof(record),
+               WEAR_LOG_OFFSET +
+               protected_mem.wear_log_records * sizeof(record));
+  protected_mem.wear_log_records++;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the erase count of the most worn sector of a page range. */
+static uint32_t
+wear_of_pages(coffee_page_t start, coffee_page_t amount)
+{
+  uint16_t sector, last;
+  uint32_t wear;
+
+  wear = 0;
+  last = (start + amount - 1) / COFFEE_PAGES_PER_SECTOR;
+  for(sector = start / COFFEE_PAGES_PER_SECTOR; sector <= last; sector++) {
+    if(protected_mem.wear[sector] > wear) {
+      wear = protected_mem.wear[sector];
+    }
+  }
+  return wear;
+}
+#endif /* COFFEE_WEAR_COUNTERS */
+/*---------------------------------------------------------------------------*/
 static coffee_page_t
 get_sector_status(uint16_t sector, struct sector_status *stats)
 {
-  static coffee_page_t skip_pages;
-  static char last_pages_are_active;
   struct file_header hdr;
   coffee_page_t active, obsolete, free;
   coffee_page_t sector_start, sector_end;
@@ -256,13 +539,13 @@ get_sector_status(uint16_t sector, struct sector_status *stats)
   active = obsolete = free = 0;
 
   /*
-   * get_sector_status() is an iterative function using local static 
+   * get_sector_status() is an iterative function using static 
    * state. It therefore requires that the caller starts iterating from 
    * sector 0 in order to reset the internal state.
    */
   if(sector == 0) {
-    skip_pages = 0;
-    last_pages_are_active = 0;
+    scan.skip_pages = 0;
+    scan.last_pages_are_active = 0;
   }
 
   sector_start = sector * COFFEE_PAGES_PER_SECTOR;
@@ -273,29 +556,29 @@ get_sector_status(uint16_t sector, struct sector_status *stats)
    * segment that extends into this segment. If the whole segment is 
    * covered, we do not need to continue counting pages in this iteration.
    */
-  if(last_pages_are_active) {
-    if(skip_pages >= COFFEE_PAGES_PER_SECTOR) {
+  if(scan.last_pages_are_active) {
+    if(scan.skip_pages >= COFFEE_PAGES_PER_SECTOR) {
       stats->active = COFFEE_PAGES_PER_SECTOR;
-      skip_pages -= COFFEE_PAGES_PER_SECTOR;
+      scan.skip_pages -= COFFEE_PAGES_PER_SECTOR;
       return 0;
     }
-    active = skip_pages;
+    active = scan.skip_pages;
   } else {
-    if(skip_pages >= COFFEE_PAGES_PER_SECTOR) {
+    if(scan.skip_pages >= COFFEE_PAGES_PER_SECTOR) {
       stats->obsolete = COFFEE_PAGES_PER_SECTOR;
-      skip_pages -= COFFEE_PAGES_PER_SECTOR;
-      return skip_pages >= COFFEE_PAGES_PER_SECTOR ? 0 : skip_pages;
+      scan.skip_pages -= COFFEE_PAGES_PER_SECTOR;
+      return scan.skip_pages >= COFFEE_PAGES_PER_SECTOR ? 0 : scan.skip_pages;
     }
-    obsolete = skip_pages;
+    obsolete = scan.skip_pages;
   }
 
   /* Determine the amount of pages of each type that have not been 
      accounted for yet in the current sector. */
-  for(page = sector_start + skip_pages; page < sector_end;) {
+  for(page = sector_start + scan.skip_pages; page < sector_end;) {
     read_header(&hdr, page);
-    last_pages_are_active = 0;
+    scan.last_pages_are_active = 0;
     if(HDR_ACTIVE(hdr)) {
-      last_pages_are_active = 1;
+      scan.last_pages_are_active = 1;
       page += hdr.max_pages;
       active += hdr.max_pages;
     } else if(HDR_ISOLATED(hdr)) {
@@ -318,9 +601,9 @@ get_sector_status(uint16_t sector, struct sector_status *stats)
    * amount is that there is no need to read in the headers of each 
    * of these pages from the storage.
    */
-  skip_pages = active + obsolete + free - COFFEE_PAGES_PER_SECTOR;
-  if(skip_pages > 0) {
-    if(last_pages_are_active) {
+  scan.skip_pages = active + obsolete + free - COFFEE_PAGES_PER_SECTOR;
+  if(scan.skip_pages > 0) {
+    if(scan.last_pages_are_active) {
       active = COFFEE_PAGES_PER_SECTOR - obsolete;
     } else {
       obsolete = COFFEE_PAGES_PER_SECTOR - active;
@@ -338,8 +621,8 @@ get_sector_status(uint16_t sector, struct sector_status *stats)
    * sector, however, the garbage collection can free the next sector 
    * immediately without requiring page isolation. 
    */
-  return (last_pages_are_active || (skip_pages >= COFFEE_PAGES_PER_SECTOR)) ?
-	0 : skip_pages;
+  return (scan.last_pages_are_active ||
+          (scan.skip_pages >= COFFEE_PAGES_PER_SECTOR)) ? 0 : scan.skip_pages;
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -363,11 +646,33 @@ isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
 }
 /*---------------------------------------------------------------------------*/
 static void
+erase_sector(uint16_t sector, coffee_page_t isolation_count)
+{
+  coffee_page_t first_page;
+
+  first_page = sector * COFFEE_PAGES_PER_SECTOR;
+  if(first_page < *next_free) {
+    *next_free = first_page;
+  }
+
+  if(isolation_count > 0) {
+    isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
+  }
+
+  COFFEE_ERASE(sector);
+  LAYOUT_CHANGED();
+#if COFFEE_WEAR_COUNTERS
+  wear_count(sector);
+#endif
+  PRINTF("Coffee: Erased sector %d!\n", sector);
+}
+/*---------------------------------------------------------------------------*/
+static void
 collect_garbage(int mode)
 {
   uint16_t sector;
   struct sector_status stats;
-  coffee_page_t first_page, isolation_count;
+  coffee_page_t isolation_count;
 
   PRINTF("Coffee: Running the file system garbage collector in %s mode\n",
 	 mode == GC_RELUCTANT ? "reluctant" : "greedy");
@@ -387,17 +692,7 @@ collect_garbage(int mode)
 
     if((mode == GC_RELUCTANT && stats.free == 0) ||
        (mode == GC_GREEDY && stats.obsolete > 0)) {
-      first_page = sector * COFFEE_PAGES_PER_SECTOR;
-      if(first_page < *next_free) {
-        *next_free = first_page;
-      }
-
-      if(isolation_count > 0) {
-        isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
-      }
-
-      COFFEE_ERASE(sector);
-      PRINTF("Coffee: Erased sector %d!\n", sector);
+      erase_sector(sector, isolation_count);
 
       if(mode == GC_RELUCTANT && isolation_count > 0) {
         break;
@@ -406,6 +701,82 @@ collect_garbage(int mode)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_BACKGROUND_GC
+PROCESS(coffee_gc_process, "Coffee GC");
+
+static struct {
+  uint16_t sector;
+  uint16_t layout_version;
+  struct sector_scan scan;
+  uint8_t requested;
+} gc;
+/*---------------------------------------------------------------------------*/
+static void
+request_gc(void)
+{
+  gc.requested = 1;
+  if(!process_is_running(&coffee_gc_process)) {
+    process_start(&coffee_gc_process, NULL);
+  }
+  process_poll(&coffee_gc_process);
+}
+/*---------------------------------------------------------------------------*/
+/* Runs one slice of the background collection. Returns non-zero if
+   the pass is not finished yet. */
+static int
+gc_slice(void)
+{
+  struct sector_status stats;
+  coffee_page_t isolation_count;
+  clock_time_t start;
+
+  /* The scan has to start over if something else has changed the
+     file system since the last slice. */
+  if(gc.layout_version != layout_version) {
+    gc.sector = 0;
+  }
+  scan = gc.scan;
+
+  start = clock_time();
+  while(gc.sector < COFFEE_SECTOR_COUNT) {
+    isolation_count = get_sector_status(gc.sector, &stats);
+    if(stats.active == 0 && stats.obsolete > 0) {
+      erase_sector(gc.sector, isolation_count);
+      gc.sector++;
+      break;
+    }
+    gc.sector++;
+    if(clock_time() - start >= COFFEE_GC_SLICE_TIME) {
+      break;
+    }
+  }
+
+  gc.scan = scan;
+  gc.layout_version = layout_version;
+
+  return gc.sector < COFFEE_SECTOR_COUNT;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_gc_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(gc.requested);
+
+    gc.requested = 0;
+    gc.sector = 0;
+    gc.layout_version = layout_version;
+    while(gc_slice()) {
+      PROCESS_PAUSE();
+    }
+    PRINTF("Coffee: Background garbage collection done\n");
+  }
+
+  PROCESS_END();
+}
+#endif /* COFFEE_BACKGROUND_GC */
+/*---------------------------------------------------------------------------*/
 static coffee_page_t
 next_file(coffee_page_t page, struct file_header *hdr)
 {
@@ -427,6 +798,74 @@ next_file(coffee_page_t page, struct file_header *hdr)
   return page + hdr->max_pages;    
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_DIR_CACHE_SIZE > 0
+static uint16_t
+dir_hash(const char *name)
+{
+  uint16_t hash;
+  int i;
+
+  hash = 0;
+  for(i = 0; i < COFFEE_NAME_LENGTH && name[i] != '\0'; i++) {
+    hash = hash * 31 + (unsigned char)name[i];
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dir_add(const char *name, coffee_page_t page)
+{
+  if(protected_mem.dir_state == DIR_UNBUILT) {
+    /* The directory will pick up the file when it is built. */
+    return;
+  }
+
+  if(protected_mem.dir_count == COFFEE_DIR_CACHE_SIZE) {
+    protected_mem.dir_state = DIR_OVERFLOW;
+    return;
+  }
+
+  dir[protected_mem.dir_count].hash = dir_hash(name);
+  dir[protected_mem.dir_count].page = page;
+  protected_mem.dir_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dir_remove(coffee_page_t page)
+{
+  uint16_t i;
+
+  for(i = 0; i < protected_mem.dir_count; i++) {
+    if(dir[i].page == page) {
+      dir[i] = dir[--protected_mem.dir_count];
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+dir_build(void)
+{
+  struct file_header hdr;
+  coffee_page_t page;
+
+  PRINTF("Coffee: Building the file directory\n");
+
+  protected_mem.dir_count = 0;
+  protected_mem.dir_state = DIR_COMPLETE;
+
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
+      dir_add(hdr.name, page);
+      if(protected_mem.dir_state == DIR_OVERFLOW) {
+        break;
+      }
+    }
+  }
+}
+#endif /* COFFEE_DIR_CACHE_SIZE > 0 */
+/*---------------------------------------------------------------------------*/
 static struct file *
 load_file(coffee_page_t start, struct file_header *hdr)
 {
@@ -465,6 +904,12 @@ load_file(coffee_page_t start, struct file_header *hdr)
   }
   /* We don't know the amount of records yet. */
   file->record_count = -1;
+#if COFFEE_EOF_HINT
+  file->eof_hint = hdr->eof_hint;
+#endif
+#if COFFEE_MICRO_LOGS && COFFEE_IO_SEMANTICS
+  file->append_start = UNKNOWN_OFFSET;
+#endif
 
   return file;
 }
@@ -475,6 +920,9 @@ find_file(const char *name)
   int i;
   struct file_header hdr;
   coffee_page_t page;
+#if COFFEE_DIR_CACHE_SIZE > 0
+  uint16_t hash, j;
+#endif
   
   /* First check if the file metadata is cached. */
   for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
@@ -488,6 +936,28 @@ find_file(const char *name)
     }
   }
   
+#if COFFEE_DIR_CACHE_SIZE > 0
+  /* Then look for the file in the directory. */
+  if(protected_mem.dir_state == DIR_UNBUILT) {
+    dir_build();
+  }
+
+  hash = dir_hash(name);
+  for(j = 0; j < protected_mem.dir_count; j++) {
+    if(dir[j].hash != hash) {
+      continue;
+    }
+    read_header(&hdr, dir[j].page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
+      return load_file(dir[j].page, &hdr);
+    }
+  }
+
+  if(protected_mem.dir_state == DIR_COMPLETE) {
+    return NULL;
+  }
+#endif /* COFFEE_DIR_CACHE_SIZE > 0 */
+
   /* Scan the flash memory sequentially otherwise. */
   for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
     read_header(&hdr, page);
@@ -499,16 +969,95 @@ find_file(const char *name)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_EOF_HINT
+static uint8_t
+eof_hint(cfs_offset_t end, coffee_page_t max_pages)
+{
+  coffee_page_t last_page;
+  uint8_t hint;
+  int i;
+
+  if(end == 0) {
+    return 0;
+  }
+
+  /* Bit i is set if the file has been written up to the i:th eighth
+     of its reserved pages. */
+  last_page = (sizeof(struct file_header) + end - 1) / COFFEE_PAGE_SIZE;
+  hint = 0;
+  for(i = 0; i < 8; i++) {
+    if(last_page >= (coffee_page_t)(((cfs_offset_t)max_pages * i) / 8)) {
+      hint |= 1 << i;
+    }
+  }
+  return hint;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_eof_hint(struct file *file)
+{
+  struct file_header hdr;
+  uint8_t hint;
+
+  hint = eof_hint(file->end, file->max_pages);
+  if((hint & ~file->eof_hint) == 0) {
+    return;
+  }
+
+  read_header(&hdr, file->page);
+  if(!HDR_EOF_HINT(hdr)) {
+    return;
+  }
+  /* The hint only ever gains bits, so the header can be rewritten
+     in place. */
+  hdr.eof_hint |= hint;
+  write_header(&hdr, file->page);
+  file->eof_hint = hdr.eof_hint;
+}
+#endif /* COFFEE_EOF_HINT */
+/*---------------------------------------------------------------------------*/
+static int
+last_modified_byte(coffee_page_t start, coffee_page_t page)
+{
+  unsigned char buf[COFFEE_PAGE_SIZE];
+  int i;
+
+  COFFEE_READ(buf, sizeof(buf), (start + page) * COFFEE_PAGE_SIZE);
+  for(i = COFFEE_PAGE_SIZE - 1; i >= 0; i--) {
+    if(buf[i] != 0) {
+      break;
+    }
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
 static cfs_offset_t
 file_end(coffee_page_t start)
 {
   struct file_header hdr;
-  unsigned char buf[COFFEE_PAGE_SIZE];
-  coffee_page_t page;
+  coffee_page_t page, last;
   int i;
+#if COFFEE_EOF_BINARY_SEARCH
+  coffee_page_t low, high, mid;
+#endif
 
   read_header(&hdr, start);
 
+  last = hdr.max_pages - 1;
+#if COFFEE_EOF_HINT
+  if(HDR_EOF_HINT(hdr)) {
+    /* The data ends before the first eighth whose hint bit is
+       unset. */
+    for(i = 0; i < 8 && (hdr.eof_hint & (1 << i)); i++);
+    if(i == 0) {
+      return 0;
+    }
+    if(i < 8) {
+      last = (((cfs_offset_t)hdr.max_pages * i) / 8) - 1;
+    }
+  }
+#endif /* COFFEE_EOF_HINT */
+
   /*
    * Move from the end of the range towards the beginning and look for
    * a byte that has been modified.
@@ -517,22 +1066,120 @@ file_end(coffee_page_t start)
    * are zeroes, then these are skipped from the calculation.
    */
 
-  for(page = hdr.max_pages - 1; page >= 0; page--) {
-    COFFEE_READ(buf, sizeof(buf), (start + page) * COFFEE_PAGE_SIZE);
-    for(i = COFFEE_PAGE_SIZE - 1; i >= 0; i--) {
-      if(buf[i] != 0) {
-	if(page == 0 && i < sizeof(hdr)) {
-	  return 0;
-	}
-	return 1 + i + (page * COFFEE_PAGE_SIZE) - sizeof(hdr);
-      }
+#if COFFEE_EOF_BINARY_SEARCH
+  /* The first page always contains the header, so the search
+     looks for the last page in [0, last] that has been modified. */
+  page = 0;
+  low = 1;
+  high = last;
+  while(low <= high) {
+    mid = low + (high - low) / 2;
+    if(last_modified_byte(start, mid) >= 0) {
+      page = mid;
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  i = last_modified_byte(start, page);
+#else /* COFFEE_EOF_BINARY_SEARCH */
+  for(page = last; page >= 0; page--) {
+    i = last_modified_byte(start, page);
+    if(i >= 0) {
+      break;
     }
   }
+  if(page < 0) {
+    /* All bytes are writable. */
+    return 0;
+  }
+#endif /* COFFEE_EOF_BINARY_SEARCH */
 
-  /* All bytes are writable. */
-  return 0;
+  if(page == 0 && i < sizeof(hdr)) {
+    return 0;
+  }
+  return 1 + i + (page * COFFEE_PAGE_SIZE) - sizeof(hdr);
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_WEAR_COUNTERS
+/*
+ * Consider the possible placements of a reservation in the free run
+ * [start, end): the beginning of the run and every sector boundary
+ * within it. The placement whose most worn sector has the lowest
+ * erase count wins; ties go to the lowest page.
+ */
+static void
+consider_free_run(coffee_page_t start, coffee_page_t end,
+                  coffee_page_t amount,
+                  coffee_page_t *best, uint32_t *best_wear)
+{
+  coffee_page_t candidate;
+  uint32_t wear;
+
+  for(candidate = start;
+      candidate + amount <= end && candidate + amount < COFFEE_PAGE_COUNT;
+      candidate = (candidate + COFFEE_PAGES_PER_SECTOR) &
+        ~(COFFEE_PAGES_PER_SECTOR - 1)) {
+    wear = wear_of_pages(candidate, amount);
+    if(*best == INVALID_PAGE || wear < *best_wear) {
+      *best = candidate;
+      *best_wear = wear;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static coffee_page_t
+find_contiguous_pages(coffee_page_t amount)
+{
+  coffee_page_t page, start, best;
+  uint32_t best_wear, least_wear;
+  struct file_header hdr;
+  uint16_t sector;
+
+  wear_load();
+
+  /* A placement in a sector with the lowest erase count of all cannot
+     be improved on, so the search stops when it finds one. */
+  least_wear = protected_mem.wear[0];
+  for(sector = 1; sector < COFFEE_SECTOR_COUNT; sector++) {
+    if(protected_mem.wear[sector] < least_wear) {
+      least_wear = protected_mem.wear[sector];
+    }
+  }
+
+  best = INVALID_PAGE;
+  best_wear = 0;
+  start = INVALID_PAGE;
+  for(page = *next_free; page < COFFEE_PAGE_COUNT;) {
+    read_header(&hdr, page);
+    if(HDR_FREE(hdr)) {
+      if(start == INVALID_PAGE) {
+	start = page;
+      }
+      /* All remaining pages in this sector are free --
+         jump to the next sector. */
+      page = next_file(page, &hdr);
+    } else {
+      if(start != INVALID_PAGE) {
+        consider_free_run(start, page, amount, &best, &best_wear);
+        start = INVALID_PAGE;
+        if(best != INVALID_PAGE && best_wear == least_wear) {
+          break;
+        }
+      }
+      page = next_file(page, &hdr);
+    }
+  }
+  if(start != INVALID_PAGE) {
+    consider_free_run(start, page, amount, &best, &best_wear);
+  }
+
+  if(best != INVALID_PAGE && best == *next_free) {
+    *next_free = best + amount;
+  }
+  return best;
+}
+#else /* COFFEE_WEAR_COUNTERS */
 static coffee_page_t
 find_contiguous_pages(coffee_page_t amount)
 {
@@ -568,6 +1215,7 @@ find_contiguous_pages(coffee_page_t amount)
   }
   return INVALID_PAGE;
 }
+#endif /* COFFEE_WEAR_COUNTERS */
 /*---------------------------------------------------------------------------*/
 static int
 remove_by_page(coffee_page_t page, int remove_log, int close_fds,
@@ -590,8 +1238,20 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
   hdr.flags |= HDR_FLAG_OBSOLETE;
   write_header(&hdr, page);
 
+#if COFFEE_DIR_CACHE_SIZE > 0
+  if(!HDR_LOG(hdr)) {
+    dir_remove(page);
+  }
+#endif
+
   *gc_wait = 0;
 
+#if COFFEE_BACKGROUND_GC
+  if(gc_allowed) {
+    request_gc();
+  }
+#endif
+
   /* Close all file descriptors that reference the removed file. */
   if(close_fds) {
     for(i = 0; i < COFFEE_FD_SET_SIZE; i++) {
@@ -609,7 +1269,7 @@ remove_by_page(coffee_page_t page, int remove_log, int close_fds,
     }
   }
 
-#if !COFFEE_EXTENDED_WEAR_LEVELLING
+#if !COFFEE_EXTENDED_WEAR_LEVELLING && !COFFEE_BACKGROUND_GC
   if(gc_allowed) {
     collect_garbage(GC_RELUCTANT);
   }
@@ -654,8 +1314,19 @@ reserve(const char *name, coffee_page_t pages,
   memcpy(hdr.name, name, sizeof(hdr.name) - 1);
   hdr.max_pages = pages;
   hdr.flags = HDR_FLAG_ALLOCATED | flags;
+#if COFFEE_EOF_HINT
+  if(!(flags & HDR_FLAG_LOG)) {
+    hdr.flags |= HDR_FLAG_EOF_HINT;
+  }
+#endif
   write_header(&hdr, page);
 
+#if COFFEE_DIR_CACHE_SIZE > 0
+  if(!(flags & HDR_FLAG_LOG)) {
+    dir_add(hdr.name, page);
+  }
+#endif
+
   PRINTF("Coffee: Reserved %u pages starting from %u for file %s\n",
       pages, page, name);
 
@@ -742,7 +1413,7 @@ get_record_index(coffee_page_t log_page, uint16_t search_records,
 #if COFFEE_MICRO_LOGS
 static int
 read_log_page(struct file_header *hdr, int16_t record_count,
-              struct log_param *lp)
+              struct log_param *lp, void *buf)
 {
   uint16_t region;
   int16_t match_index;
@@ -763,7 +1434,7 @@ read_log_page(struct file_header *hdr, int16_t record_count,
   base = absolute_offset(hdr->log_page, log_records * sizeof(region));
   base += (cfs_offset_t)match_index * log_record_size;
   base += lp->offset;
-  COFFEE_READ(lp->buf, lp->size, base);
+  COFFEE_READ(buf, lp->size, base);
 
   return lp->size;
 }
@@ -856,6 +1527,10 @@ merge_log(coffee_page_t file_page, int extend)
   read_header(&hdr2, new_file->page);
   hdr2.log_record_size = hdr.log_record_size;
   hdr2.log_records = hdr.log_records;
+#if COFFEE_EOF_HINT
+  hdr2.eof_hint = eof_hint(offset, new_file->max_pages);
+  new_file->eof_hint = hdr2.eof_hint;
+#endif
   write_header(&hdr2, new_file->page);
 
   new_file->flags &= ~COFFEE_FILE_MODIFIED;
@@ -949,11 +1624,10 @@ write_log_page(struct file *file, struct log_param *lp)
     char copy_buf[log_record_size];
 
     lp_out.offset = offset = region * log_record_size;
-    lp_out.buf = copy_buf;
     lp_out.size = log_record_size;
 
     if((lp->offset > 0 || lp->size != log_record_size) &&
-	read_log_page(&hdr, log_record, &lp_out) < 0) {
+	read_log_page(&hdr, log_record, &lp_out, copy_buf) < 0) {
       COFFEE_READ(copy_buf, sizeof(copy_buf),
 	  absolute_offset(file->page, offset));
     }
@@ -973,6 +1647,10 @@ write_log_page(struct file *file, struct log_param *lp)
     COFFEE_WRITE(copy_buf, sizeof(copy_buf),
 		 offset + log_record * log_record_size);
     file->record_count = log_record + 1;
+#if COFFEE_IO_SEMANTICS
+    /* The new record may shadow the region that appends go to. */
+    file->append_start = UNKNOWN_OFFSET;
+#endif
   }
 
   return lp->size;
@@ -1031,6 +1709,9 @@ cfs_open(const char *name, int flags)
 void
 cfs_close(int fd)
 {
+#if COFFEE_CACHE_LINES > 0
+  cfs_cache_flush(&coffee_cache);
+#endif
   if(FD_VALID(fd)) {
     coffee_fd_set[fd].flags = COFFEE_FD_FREE;
     coffee_fd_set[fd].file->references--;
@@ -1129,9 +1810,8 @@ cfs_read(int fd, void *buf, unsigned size)
     r = -1;
 
     lp.offset = fdp->offset;
-    lp.buf = buf;
     lp.size = bytes_left;
-    r = read_log_page(&hdr, file->record_count, &lp);
+    r = read_log_page(&hdr, file->record_count, &lp, buf);
 
     /* Read from the original file if we cannot find the data in the log. */
     if(r < 0) {
@@ -1146,6 +1826,51 @@ cfs_read(int fd, void *buf, unsigned size)
   return size;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_MICRO_LOGS && COFFEE_IO_SEMANTICS
+/*
+ * Returns non-zero if a write through an append stream can go directly
+ * to the file. A log record holds a copy of a whole region of the file,
+ * so appended data may bypass the log only in regions that have no
+ * record. Records only exist for regions that start before the end of
+ * the file, which leaves the region containing the end of the file as
+ * the only one that has to be checked; this is done once and then
+ * remembered until a new record is written.
+ */
+static int
+append_directly(struct file_desc *fdp)
+{
+  struct file *file;
+  struct file_header hdr;
+  uint16_t log_record_size, log_records;
+  int16_t record_count;
+  uint16_t region;
+
+  file = fdp->file;
+  if(!(fdp->io_flags & CFS_COFFEE_IO_APPEND_STREAM) ||
+     fdp->offset < file->end) {
+    return 0;
+  }
+  if(!FILE_MODIFIED(file)) {
+    return 1;
+  }
+
+  if(file->append_start == UNKNOWN_OFFSET) {
+    read_header(&hdr, file->page);
+    adjust_log_config(&hdr, &log_record_size, &log_records);
+    region = file->end / log_record_size;
+    file->append_start = file->end;
+    if(file->end % log_record_size != 0) {
+      record_count = find_next_record(file, hdr.log_page, log_records);
+      if(get_record_index(hdr.log_page, record_count, region) >= 0) {
+        file->append_start = (cfs_offset_t)(region + 1) * log_record_size;
+      }
+    }
+  }
+
+  return fdp->offset >= file->append_start;
+}
+#endif /* COFFEE_MICRO_LOGS && COFFEE_IO_SEMANTICS */
+/*---------------------------------------------------------------------------*/
 int
 cfs_write(int fd, const void *buf, unsigned size)
 {
@@ -1184,7 +1909,8 @@ cfs_write(int fd, const void *buf, unsigned size)
 #if COFFEE_MICRO_LOGS
 #if COFFEE_IO_SEMANTICS
   if(!(fdp->io_flags & CFS_COFFEE_IO_FLASH_AWARE) &&
-     (FILE_MODIFIED(file) || fdp->offset < file->end)) {
+     (FILE_MODIFIED(file) || fdp->offset < file->end) &&
+     !append_directly(fdp)) {
 #else
   if(FILE_MODIFIED(file) || fdp->offset < file->end) {
 #endif
@@ -1237,6 +1963,9 @@ cfs_write(int fd, const void *buf, unsigned size)
   if(fdp->offset > file->end) {
     file->end = fdp->offset;
   }
+#if COFFEE_EOF_HINT
+  update_eof_hint(file);
+#endif
 
   return size;
 }
@@ -1345,8 +2074,12 @@ cfs_coffee_format(void)
 
   for(i = 0; i < COFFEE_SECTOR_COUNT; i++) {
     COFFEE_ERASE(i);
+#if COFFEE_WEAR_COUNTERS
+    wear_count(i);
+#endif
     PRINTF(".");
   }
+  LAYOUT_CHANGED();
 
   /* Formatting invalidates the file information. */
   memset(&protected_mem, 0, sizeof(protected_mem));
@@ -1356,6 +2089,40 @@ cfs_coffee_format(void)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+void
+cfs_coffee_sync(void)
+{
+#if COFFEE_CACHE_LINES > 0
+  cfs_cache_flush(&coffee_cache);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_coffee_stats(struct cfs_coffee_stats *stats)
+{
+#if COFFEE_WEAR_COUNTERS
+  unsigned i;
+
+  wear_load();
+
+  stats->sectors = COFFEE_SECTOR_COUNT;
+  stats->min_erases = stats->max_erases = protected_mem.wear[0];
+  stats->total_erases = 0;
+  for(i = 0; i < COFFEE_SECTOR_COUNT; i++) {
+    if(protected_mem.wear[i] < stats->min_erases) {
+      stats->min_erases = protected_mem.wear[i];
+    }
+    if(protected_mem.wear[i] > stats->max_erases) {
+      stats->max_erases = protected_mem.wear[i];
+    }
+    stats->total_erases += protected_mem.wear[i];
+  }
+  return 0;
+#else
+  return -1;
+#endif /* COFFEE_WEAR_COUNTERS */
+}
+/*---------------------------------------------------------------------------*/
 void *
 cfs_coffee_get_protected_mem(unsigned *size)
 {
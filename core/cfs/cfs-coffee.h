@@ -63,6 +63,15 @@
  */
 #define CFS_COFFEE_IO_FIRM_SIZE		0x2
 
+/**
+ * Instruct Coffee that the file is only appended to through this file
+ * descriptor. Appends are then written to the file directly, even if
+ * the file has a micro log, instead of going through the log.
+ *
+ * \sa cfs_coffee_set_io_semantics()
+ */
+#define CFS_COFFEE_IO_APPEND_STREAM	0x4
+
 /**
  * \file
  *	Header for the Coffee file system.
@@ -116,6 +125,91 @@ int cfs_coffee_configure_log(const char *file, unsigned log_size,
  */
 int cfs_coffee_set_io_semantics(int fd, unsigned flags);
 
+/**
+ * \brief Write out modifications held in the Coffee block cache.
+ *
+ * Coffee flushes its cache when a file is closed. This function
+ * flushes it for files that are kept open. It does nothing if Coffee
+ * is built without COFFEE_CACHE_LINES.
+ */
+void cfs_coffee_sync(void);
+
+/** Wear statistics of the sectors used for files. */
+struct cfs_coffee_stats {
+  uint32_t min_erases;   /**< Erase count of the least worn sector. */
+  uint32_t max_erases;   /**< Erase count of the most worn sector. */
+  uint32_t total_erases; /**< Sum of the erase counts of all sectors. */
+  unsigned sectors;      /**< Number of sectors used for files. */
+};
+
+/**
+ * \brief Get the wear statistics of the file system.
+ * \param stats A pointer to the structure to fill in.
+ * \return 0 on success, -1 if Coffee is built without COFFEE_WEAR_COUNTERS.
+ */
+int cfs_coffee_stats(struct cfs_coffee_stats *stats);
+
+/**
+ * A ring file: a log of fixed size that overwrites its oldest records
+ * when it is full. The ring is stored in a number of segment files that
+ * are reused in turn, since flash memory cannot be overwritten in place.
+ */
+struct cfs_coffee_ring {
+  const char *name;
+  cfs_offset_t segment_size;
+  cfs_offset_t offset;
+  uint16_t seq;
+  uint8_t segments;
+  uint8_t current;
+  int fd;
+};
+
+/**
+ * \brief Open a ring file, creating it if it does not exist.
+ * \param ring A pointer to the ring to initialize.
+ * \param name The base name of the segment files.
+ * \param segments The number of segments, at least two.
+ * \param segment_size The number of bytes of records in each segment.
+ * \return 0 on success, -1 on failure.
+ *
+ * The segment files are named by appending ".<index>" to the name,
+ * which must therefore be at least four characters shorter than the
+ * maximum file name length of COFFEE_NAME_LENGTH - 1. The ring holds
+ * between (segments - 1) * segment_size and segments * segment_size
+ * bytes of the most recent records.
+ */
+int cfs_coffee_ring_open(struct cfs_coffee_ring *ring, const char *name,
+                         uint8_t segments, cfs_offset_t segment_size);
+
+/**
+ * \brief Append a record to a ring file.
+ * \param ring A pointer to an opened ring.
+ * \param buf A pointer to the record.
+ * \param size The size of the record.
+ * \return The number of bytes written, or -1 on failure.
+ *
+ * A record is never split between segments. When it does not fit in
+ * the current segment, the segment holding the oldest records is
+ * discarded and reused.
+ */
+int cfs_coffee_ring_write(struct cfs_coffee_ring *ring,
+                          const void *buf, unsigned size);
+
+/**
+ * \brief Open a segment of a ring file for reading.
+ * \param ring A pointer to an opened ring.
+ * \param age The age of the segment, 0 being the one currently written.
+ * \return A file descriptor positioned at the first record of the
+ * segment, or -1 if there is no segment of that age.
+ */
+int cfs_coffee_ring_segment(struct cfs_coffee_ring *ring, uint8_t age);
+
+/**
+ * \brief Close a ring file.
+ * \param ring A pointer to an opened ring.
+ */
+void cfs_coffee_ring_close(struct cfs_coffee_ring *ring);
+
 /**
  * \brief Format the storage area assigned to Coffee.
  * \return 0 on success, -1 on failure.
@@ -42,13 +42,98 @@
 
 #include "cfs/cfs.h"
 
+/*
+ * Files opened for reading only are mapped into memory, so that the
+ * many small reads typical of CFS users become plain memory copies
+ * instead of one system call each.
+ */
+#ifdef CFS_POSIX_CONF_MMAP
+#define CFS_POSIX_MMAP CFS_POSIX_CONF_MMAP
+#elif defined(_MSC_VER)
+#define CFS_POSIX_MMAP 0
+#else
+#define CFS_POSIX_MMAP 1
+#endif
+
+#ifdef CFS_POSIX_CONF_MAX_MAPS
+#define CFS_POSIX_MAX_MAPS CFS_POSIX_CONF_MAX_MAPS
+#else
+#define CFS_POSIX_MAX_MAPS 8
+#endif
+
+#if CFS_POSIX_MMAP
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct map {
+  int fd;
+  unsigned char *data;
+  off_t size;
+  off_t offset;
+};
+
+static struct map maps[CFS_POSIX_MAX_MAPS];
+/*---------------------------------------------------------------------------*/
+static struct map *
+find_map(int fd)
+{
+  int i;
+
+  if(fd >= 0) {
+    for(i = 0; i < CFS_POSIX_MAX_MAPS; i++) {
+      if(maps[i].data != NULL && maps[i].fd == fd) {
+        return &maps[i];
+      }
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+map_file(int fd)
+{
+  struct map *m;
+  struct stat st;
+  void *p;
+
+  if(fd < 0 || fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+     st.st_size == 0 || (off_t)(size_t)st.st_size != st.st_size) {
+    return;
+  }
+  for(m = maps; m < &maps[CFS_POSIX_MAX_MAPS]; m++) {
+    if(m->data == NULL) {
+      break;
+    }
+  }
+  if(m == &maps[CFS_POSIX_MAX_MAPS]) {
+    /* Out of slots: the file is read through the descriptor instead. */
+    return;
+  }
+  p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if(p == MAP_FAILED) {
+    return;
+  }
+  m->fd = fd;
+  m->data = p;
+  m->size = st.st_size;
+  m->offset = 0;
+}
+#endif /* CFS_POSIX_MMAP */
+
 /*---------------------------------------------------------------------------*/
 int
 cfs_open(const char *n, int f)
 {
   int s = 0;
   if(f == CFS_READ) {
+#if CFS_POSIX_MMAP
+    s = open(n, O_RDONLY);
+    map_file(s);
+    return s;
+#else
     return open(n, O_RDONLY);
+#endif /* CFS_POSIX_MMAP */
   } else if(f & CFS_WRITE) {
     s = O_CREAT;
     if(f & CFS_READ) {
@@ -69,12 +154,43 @@ cfs_open(const char *n, int f)
 void
 cfs_close(int f)
 {
+#if CFS_POSIX_MMAP
+  struct map *m;
+
+  m = find_map(f);
+  if(m != NULL) {
+    munmap(m->data, m->size);
+    m->data = NULL;
+  }
+#endif /* CFS_POSIX_MMAP */
   close(f);
 }
 /*---------------------------------------------------------------------------*/
 int
 cfs_read(int f, void *b, unsigned int l)
 {
+#if CFS_POSIX_MMAP
+  struct map *m;
+  ssize_t r;
+
+  m = find_map(f);
+  if(m != NULL) {
+    if(m->offset >= m->size) {
+      /* The file may have grown since it was mapped. */
+      r = pread(f, b, l, m->offset);
+      if(r > 0) {
+        m->offset += r;
+      }
+      return r;
+    }
+    if(l > m->size - m->offset) {
+      l = m->size - m->offset;
+    }
+    memcpy(b, m->data + m->offset, l);
+    m->offset += l;
+    return l;
+  }
+#endif /* CFS_POSIX_MMAP */
   return read(f, b, l);
 }
 /*---------------------------------------------------------------------------*/
@@ -87,6 +203,30 @@ cfs_write(int f, const void *b, unsigned int l)
 cfs_offset_t
 cfs_seek(int f, cfs_offset_t o, int w)
 {
+#if CFS_POSIX_MMAP
+  struct map *m;
+  struct stat st;
+  off_t base;
+
+  m = find_map(f);
+  if(m != NULL) {
+    if(w == CFS_SEEK_SET) {
+      base = 0;
+    } else if(w == CFS_SEEK_CUR) {
+      base = m->offset;
+    } else if(w == CFS_SEEK_END && fstat(f, &st) == 0) {
+      base = st.st_size;
+    } else {
+      return (cfs_offset_t)-1;
+    }
+    if(base + o < 0) {
+      return (cfs_offset_t)-1;
+    }
+    m->offset = base + o;
+    return m->offset;
+  }
+#endif /* CFS_POSIX_MMAP */
+
   if(w == CFS_SEEK_SET) {
     w = SEEK_SET;
   } else if(w == CFS_SEEK_CUR) {
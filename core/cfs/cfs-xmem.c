@@ -56,6 +56,45 @@ struct filestate {
 #define CFS_XMEM_SIZE XMEM_ERASE_UNIT_SIZE
 #endif
 
+/* The number of blocks of the medium to keep in a write-back cache
+   (see cfs-cache.h). Modifications are written out on cfs_close(). */
+#ifdef CFS_XMEM_CONF_CACHE_LINES
+#define CFS_XMEM_CACHE_LINES CFS_XMEM_CONF_CACHE_LINES
+#else
+#define CFS_XMEM_CACHE_LINES 0
+#endif
+
+#if CFS_XMEM_CACHE_LINES > 0
+#include "cfs/cfs-cache.h"
+
+static void
+cache_read(void *buf, unsigned size, unsigned long offset)
+{
+  xmem_pread(buf, size, offset);
+}
+static void
+cache_write(const void *buf, unsigned size, unsigned long offset)
+{
+  xmem_pwrite(buf, size, offset);
+}
+CFS_CACHE(xmem_cache, CFS_XMEM_CACHE_LINES, cache_read, cache_write);
+
+#define XMEM_READ(buf, len, offset) \
+  cfs_cache_read(&xmem_cache, (buf), (len), (offset))
+#define XMEM_WRITE(buf, len, offset) \
+  cfs_cache_write(&xmem_cache, (buf), (len), (offset))
+#define XMEM_ERASE(size, offset) do {                    \
+    cfs_cache_invalidate(&xmem_cache, (offset), (size)); \
+    xmem_erase((size), (offset));                        \
+  } while(0)
+#define XMEM_SYNC() cfs_cache_flush(&xmem_cache)
+#else /* CFS_XMEM_CACHE_LINES > 0 */
+#define XMEM_READ(buf, len, offset) xmem_pread((buf), (len), (offset))
+#define XMEM_WRITE(buf, len, offset) xmem_pwrite((buf), (len), (offset))
+#define XMEM_ERASE(size, offset) xmem_erase((size), (offset))
+#define XMEM_SYNC()
+#endif /* CFS_XMEM_CACHE_LINES > 0 */
+
 static struct filestate file;
 
 /*---------------------------------------------------------------------------*/
@@ -73,7 +112,7 @@ cfs_open(const char *n, int f)
       } else {
 	file.fileptr = 0;
 	file.filesize = 0;
-	xmem_erase(CFS_XMEM_SIZE, CFS_XMEM_OFFSET);
+	XMEM_ERASE(CFS_XMEM_SIZE, CFS_XMEM_OFFSET);
       }
     }
     return 1;
@@ -85,6 +124,7 @@ cfs_open(const char *n, int f)
 void
 cfs_close(int f)
 {
+  XMEM_SYNC();
   file.flag = FLAG_FILE_CLOSED;
 }
 /*---------------------------------------------------------------------------*/
@@ -100,7 +140,7 @@ cfs_read(int f, void *buf, unsigned int len)
   }
 
   if(f == 1) {
-    xmem_pread(buf, len, CFS_XMEM_OFFSET + file.fileptr);
+    XMEM_READ(buf, len, CFS_XMEM_OFFSET + file.fileptr);
     file.fileptr += len;
     return len;
   } else {
@@ -124,7 +164,7 @@ cfs_write(int f, const void *buf, unsigned int len)
   }
 
   if(f == 1) {
-    xmem_pwrite(buf, len, CFS_XMEM_OFFSET + file.fileptr);
+    XMEM_WRITE(buf, len, CFS_XMEM_OFFSET + file.fileptr);
     file.fileptr += len;
     return len;
   } else {
@@ -151,7 +191,7 @@ cfs_remove(const char *name)
   file.flag = FLAG_FILE_CLOSED;
   file.fileptr = 0;
   file.filesize = 0;
-  xmem_erase(CFS_XMEM_SIZE, CFS_XMEM_OFFSET);
+  XMEM_ERASE(CFS_XMEM_SIZE, CFS_XMEM_OFFSET);
   return 0;
 }
 /*---------------------------------------------------------------------------*/
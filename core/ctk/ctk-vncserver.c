@@ -114,8 +114,24 @@ PROCESS(ctk_vncserver_process, "CTK VNC server");
 
 static struct vnc_server_state conns[CTK_VNCSERVER_CONF_NUMCONNS];
 
+#ifdef CTK_VNCSERVER_CONF_MAX_DAMAGE
+#define MAX_DAMAGE CTK_VNCSERVER_CONF_MAX_DAMAGE
+#else
+#define MAX_DAMAGE 4
+#endif
+
+/* The areas that have been redrawn since the connections were last
+   given new updates. */
+static struct {
+  uint8_t x, y, w, h;
+} damage[MAX_DAMAGE];
+static uint8_t num_damage;
+
 #define PRINTF(x) 
 
+#define MIN(a,b) ((a) < (b)? (a): (b))
+#define MAX(a,b) ((a) > (b)? (a): (b))
+
 #define revers(x)
 
 unsigned char ctk_draw_windowborder_height = 1;
@@ -234,27 +250,71 @@ vnc_server_update_remove(struct vnc_server_state *vs,
 }
 /*-----------------------------------------------------------------------------------*/
 /** \internal
- * Flag an area to be updated for all open VNC server connections.
+ * Flag an area as redrawn. The area is handed to the VNC server
+ * connections by flush_damage().
  *
  */
 /*-----------------------------------------------------------------------------------*/
 static void
 update_area(uint8_t x, uint8_t y, uint8_t w, uint8_t h)
 {
-  uint8_t i;
+  uint8_t i, x2, y2;
   
   if(h == 0 || w == 0) {
     return;
   }
-  
-  /* Update for all active VNC connections. */
-  for(i = 0; i < CTK_VNCSERVER_CONF_NUMCONNS; ++i) {
-    if(conns[i].state != VNC_DEALLOCATED) {
-      vnc_out_update_area(&conns[i],
-			  x, y, w, h);
+
+  /* Merge the area with an overlapping one. If there is no room for
+     another area, it is merged with the last one. */
+  for(i = 0; i < num_damage; ++i) {
+    if((x < damage[i].x + damage[i].w && damage[i].x < x + w &&
+	y < damage[i].y + damage[i].h && damage[i].y < y + h) ||
+       i == MAX_DAMAGE - 1) {
+      x2 = MAX(x + w, damage[i].x + damage[i].w);
+      y2 = MAX(y + h, damage[i].y + damage[i].h);
+      damage[i].x = MIN(x, damage[i].x);
+      damage[i].y = MIN(y, damage[i].y);
+      damage[i].w = x2 - damage[i].x;
+      damage[i].h = y2 - damage[i].y;
+      return;
     }
   }
 
+  damage[num_damage].x = x;
+  damage[num_damage].y = y;
+  damage[num_damage].w = w;
+  damage[num_damage].h = h;
+  ++num_damage;
+}
+/*-----------------------------------------------------------------------------------*/
+/** \internal
+ * Queue updates for the parts of the redrawn areas that have changed
+ * for all open VNC server connections. This is done when the
+ * connections are about to send data, so that windows that CTK clears
+ * and redraws with the same contents do not cause any updates.
+ *
+ */
+/*-----------------------------------------------------------------------------------*/
+static void
+flush_damage(void)
+{
+  uint8_t i, j;
+  uint8_t x, y, w, h;
+
+  for(i = 0; i < num_damage; ++i) {
+    x = damage[i].x;
+    y = damage[i].y;
+    w = damage[i].w;
+    h = damage[i].h;
+    if(vnc_out_damaged_area(&x, &y, &w, &h)) {
+      for(j = 0; j < CTK_VNCSERVER_CONF_NUMCONNS; ++j) {
+	if(conns[j].state != VNC_DEALLOCATED) {
+	  vnc_out_update_area(&conns[j], x, y, w, h);
+	}
+      }
+    }
+  }
+  num_damage = 0;
 }
 /*-----------------------------------------------------------------------------------*/
 /** \internal
@@ -1072,6 +1132,7 @@ ctk_vncserver_appcall(void *state)
     }
     return;
   }
+  flush_damage();
   vnc_server_appcall(vs);
 }
 /*-----------------------------------------------------------------------------------*/
@@ -66,6 +66,9 @@
 #endif
 
 
+#define MIN(a,b) ((a) < (b)? (a): (b))
+#define MAX(a,b) ((a) > (b)? (a): (b))
+
 #define BGR(b,g,r) (((b) << 6) | (g) << 3 | (r))
 
 
@@ -203,6 +206,20 @@ staitc uint8_t *colorscreen = CTK_VNCSERVER_CONF_COLORSCREEN;
 static uint8_t colorscreen[CHARS_WIDTH * CHARS_HEIGHT];
 #endif
 
+/* With damage tracking, a copy of the screen as it was when the last
+   updates were queued is kept, so that areas that CTK redraws with
+   the same contents are not sent to the clients again. */
+#ifdef CTK_VNCSERVER_CONF_DAMAGE_TRACKING
+#define DAMAGE_TRACKING CTK_VNCSERVER_CONF_DAMAGE_TRACKING
+#else
+#define DAMAGE_TRACKING 1
+#endif
+
+#if DAMAGE_TRACKING
+static uint8_t sentscreen[CHARS_WIDTH * CHARS_HEIGHT];
+static uint8_t sentcolorscreen[CHARS_WIDTH * CHARS_HEIGHT];
+#endif /* DAMAGE_TRACKING */
+
 
 #define PRINTF(x)
 
@@ -250,6 +267,42 @@ vnc_out_update_screen(uint8_t xpos, uint8_t ypos, uint8_t c, uint8_t color)
   colorscreen[xpos + ypos * CHARS_WIDTH] = color;
 }
 /*-----------------------------------------------------------------------------------*/
+uint8_t
+vnc_out_damaged_area(uint8_t *x, uint8_t *y, uint8_t *w, uint8_t *h)
+{
+#if DAMAGE_TRACKING
+  uint8_t cx, cy, x1, y1, x2, y2;
+  uint16_t i;
+
+  x1 = CHARS_WIDTH;
+  y1 = CHARS_HEIGHT;
+  x2 = y2 = 0;
+  for(cy = *y; cy < *y + *h && cy < CHARS_HEIGHT; ++cy) {
+    i = *x + cy * CHARS_WIDTH;
+    for(cx = *x; cx < *x + *w && cx < CHARS_WIDTH; ++cx, ++i) {
+      if(screen[i] != sentscreen[i] ||
+	 colorscreen[i] != sentcolorscreen[i]) {
+	sentscreen[i] = screen[i];
+	sentcolorscreen[i] = colorscreen[i];
+	x1 = MIN(x1, cx);
+	x2 = MAX(x2, cx + 1);
+	y1 = MIN(y1, cy);
+	y2 = cy + 1;
+      }
+    }
+  }
+
+  if(x2 == 0) {
+    return 0;
+  }
+  *x = x1;
+  *y = y1;
+  *w = x2 - x1;
+  *h = y2 - y1;
+#endif /* DAMAGE_TRACKING */
+  return 1;
+}
+/*-----------------------------------------------------------------------------------*/
 void
 vnc_out_update_area(struct vnc_server_state *vs,
 		    uint8_t x, uint8_t y, uint8_t w, uint8_t h)
@@ -319,8 +372,6 @@ vnc_out_update_area(struct vnc_server_state *vs,
 	     a->x, a->y, ax2, ay2));
       
       /* Find the area that covers both updates. */
-#define MIN(a,b) ((a) < (b)? (a): (b))
-#define MAX(a,b) ((a) > (b)? (a): (b))
       x = MIN(a->x, x);
       y = MIN(a->y, y);
       ax2 = MAX(ax2, x2);
@@ -420,16 +471,20 @@ check_updates(CC_REGISTER_ARG struct vnc_server_state *vs)
 }
 /*-----------------------------------------------------------------------------------*/
 static uint8_t tmp[CTK_VNCFONT_WIDTH * CTK_VNCFONT_HEIGHT];
+static int16_t tmpchar = -1;
+/* Draws the character at (x, y) into a bitmap that is stride pixels
+   wide, so that a run of characters can be sent as one rectangle. */
 static void
-makechar(CC_REGISTER_ARG char *ptr, uint8_t x, uint8_t y)
+makechar(CC_REGISTER_ARG uint8_t *ptr, uint8_t x, uint8_t y, uint16_t stride)
 {
-  uint8_t i, *tmpptr;
+  uint8_t i, j, *tmpptr;
   register uint8_t *colorscheme;
   unsigned char *bitmap;
   uint8_t b, b2;
   uint8_t xmove, ymove;
   unsigned char c, color;
 
+  stride -= CTK_VNCFONT_WIDTH;
   color = colorscreen[x + y * CHARS_WIDTH];
   c = screen[x + y * CHARS_WIDTH];
 
@@ -466,7 +521,8 @@ makechar(CC_REGISTER_ARG char *ptr, uint8_t x, uint8_t y)
 	  *ptr++ = colorscheme[((b >> 5) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b >> 4) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b >> 3) & 0x01) << 2];
-	  *ptr++ = colorscheme[((b >> 2) & 0x01) << 2];		
+	  *ptr++ = colorscheme[((b >> 2) & 0x01) << 2];
+	  ptr += stride;
 	}
 	break;
       case 1:
@@ -478,7 +534,8 @@ makechar(CC_REGISTER_ARG char *ptr, uint8_t x, uint8_t y)
 	  *ptr++ = colorscheme[((b2 >> 7) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b2 >> 6) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b2 >> 5) & 0x01) << 2];
-	  *ptr++ = colorscheme[((b2 >> 4) & 0x01) << 2];		
+	  *ptr++ = colorscheme[((b2 >> 4) & 0x01) << 2];
+	  ptr += stride;
 	}
 	break;
       case 2:
@@ -490,7 +547,8 @@ makechar(CC_REGISTER_ARG char *ptr, uint8_t x, uint8_t y)
 	  *ptr++ = colorscheme[((b >> 1) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b >> 0) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b2 >> 7) & 0x01) << 2];
-	  *ptr++ = colorscheme[((b2 >> 6) & 0x01) << 2];		
+	  *ptr++ = colorscheme[((b2 >> 6) & 0x01) << 2];
+	  ptr += stride;
 	}
 	break;
       case 3:
@@ -501,20 +559,27 @@ makechar(CC_REGISTER_ARG char *ptr, uint8_t x, uint8_t y)
 	  *ptr++ = colorscheme[((b >> 3) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b >> 2) & 0x01) << 2];
 	  *ptr++ = colorscheme[((b >> 1) & 0x01) << 2];
-	  *ptr++ = colorscheme[((b >> 0) & 0x01) << 2];		
+	  *ptr++ = colorscheme[((b >> 0) & 0x01) << 2];
+	  ptr += stride;
 	}
 	break;
       }
     }
   } else {
-    memcpy_P(tmp, &ctk_vncfont[c * (CTK_VNCFONT_WIDTH * CTK_VNCFONT_HEIGHT)],
-	     CTK_VNCFONT_WIDTH * CTK_VNCFONT_HEIGHT);
-    
-    tmpptr = tmp;
+    /* Borders and separators draw the same glyph many times in a
+       row, so the last glyph that was read from the font is kept. */
+    if(c != tmpchar) {
+      memcpy_P(tmp, &ctk_vncfont[c * (CTK_VNCFONT_WIDTH * CTK_VNCFONT_HEIGHT)],
+	       CTK_VNCFONT_WIDTH * CTK_VNCFONT_HEIGHT);
+      tmpchar = c;
+    }
 
-    
-    for(i = 0; i < CTK_VNCFONT_HEIGHT * CTK_VNCFONT_WIDTH; ++i) {
-      *ptr++ = colorscheme[*tmpptr++];
+    tmpptr = tmp;
+    for(i = 0; i < CTK_VNCFONT_HEIGHT; ++i) {
+      for(j = 0; j < CTK_VNCFONT_WIDTH; ++j) {
+	*ptr++ = colorscheme[*tmpptr++];
+      }
+      ptr += stride;
     }
   }
 }
@@ -534,7 +599,7 @@ vnc_out_new(CC_REGISTER_ARG struct vnc_server_state *vs)
   for(i = 0; i < VNC_SERVER_MAX_UPDATES - 1; ++i) {
     vs->updates_pool[i].next = &vs->updates_pool[i + 1];    
   }
-  vs->updates_pool[VNC_SERVER_MAX_UPDATES].next = NULL;
+  vs->updates_pool[VNC_SERVER_MAX_UPDATES - 1].next = NULL;
 
   vs->updates_free = &vs->updates_pool[0];
   vs->updates_pending = vs->updates_current = NULL;
@@ -585,19 +650,19 @@ vnc_out_send_screen(struct vnc_server_state *vs)
   vnc_out_send_update(vs);
 }
 /*-----------------------------------------------------------------------------------*/
-static short tmpbuf[30];
+static short tmpbuf[10];
 void
 vnc_out_send_update(CC_REGISTER_ARG struct vnc_server_state *vs)
 {
-  uint8_t x, y, x0;
-  uint8_t msglen;
+  uint8_t x, y, x0, i;
+  uint16_t msglen;
   uint16_t len, n;
   uint8_t *ptr;
   struct rfb_fb_update *umsg;
   register struct rfb_fb_update_rect_hdr *recthdr;
   struct rfb_rre_hdr *rrehdr;
   uint8_t c, color, lastcolor;
-  uint8_t numblanks;
+  uint8_t numblanks, numchars;
 
   /* First, check if we need to feed the update function with a new
      pending update. */
@@ -706,15 +771,24 @@ vnc_out_send_update(CC_REGISTER_ARG struct vnc_server_state *vs)
 	--x;
       } else {
 
-	/* So there were no blank characters. */
+	/* So there were no blank characters. Instead of sending each
+	   character as a rectangle of its own, we send the run of
+	   non-blank characters that starts here as one raw
+	   rectangle, as long as it fits in the outgoing TCP
+	   segment. */
 
 	/*	PRINTF(("An char at (%d:%d)\n", x, y));*/
-	/* First we must make sure that there is enough space in the
-	   outgoing TCP segment. */
+	numchars = 0;
+	msglen = sizeof(struct rfb_fb_update_rect_hdr);
+	while(x + numchars < vs->x + vs->w &&
+	      screen[x + numchars + y * CHARS_WIDTH] != 0x20 &&
+	      msglen + CTK_VNCFONT_HEIGHT * CTK_VNCFONT_WIDTH <
+	      uip_mss() - len) {
+	  msglen += CTK_VNCFONT_HEIGHT * CTK_VNCFONT_WIDTH;
+	  ++numchars;
+	}
 
-	msglen = sizeof(struct rfb_fb_update_rect_hdr) +
-	  CTK_VNCFONT_HEIGHT * CTK_VNCFONT_WIDTH;
-	if(msglen >= uip_mss() - len) {
+	if(numchars == 0) {
 	  /*	  PRINTF(("Not enouch space for char (%d, left %d)\n",
 		  msglen, uip_mss() - len));*/
 	  
@@ -733,18 +807,25 @@ vnc_out_send_update(CC_REGISTER_ARG struct vnc_server_state *vs)
 
 	recthdr->rect.x = uip_htons(SCREEN_X + x * CTK_VNCFONT_WIDTH);
 	recthdr->rect.y = uip_htons(SCREEN_Y + y * CTK_VNCFONT_HEIGHT);
-	recthdr->rect.w = UIP_HTONS(CTK_VNCFONT_WIDTH);
+	recthdr->rect.w = uip_htons(CTK_VNCFONT_WIDTH * numchars);
 	recthdr->rect.h = UIP_HTONS(CTK_VNCFONT_HEIGHT);
 	recthdr->encoding[0] =
 	  recthdr->encoding[1] =
 	  recthdr->encoding[2] = 0;
 	recthdr->encoding[3] = RFB_ENC_RAW;
+	memcpy(ptr, tmpbuf, sizeof(struct rfb_fb_update_rect_hdr));
 
-	makechar((uint8_t *)recthdr +
-		 sizeof(struct rfb_fb_update_rect_hdr),
-		 x, y);
+	/* The characters are drawn directly into the segment. */
+	for(i = 0; i < numchars; ++i) {
+	  makechar(ptr + sizeof(struct rfb_fb_update_rect_hdr) +
+		   i * CTK_VNCFONT_WIDTH,
+		   x + i, y, CTK_VNCFONT_WIDTH * numchars);
+	}
+	x += numchars - 1;
+      }
+      if(numblanks > 0) {
+	memcpy(ptr, tmpbuf, msglen);
       }
-      memcpy(ptr, tmpbuf, msglen);
       PRINTF(("Msglen %d (%d:%d)\n", msglen, x, y));
       len += msglen;
       ptr += msglen;
@@ -56,6 +56,7 @@ char vnc_out_keyavail(void);
 
 void vnc_out_update_area(struct vnc_server_state *vs,
 			 uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+uint8_t vnc_out_damaged_area(uint8_t *x, uint8_t *y, uint8_t *w, uint8_t *h);
 
 #include "ctk/ctk.h"
 
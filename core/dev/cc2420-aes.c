@@ -116,3 +116,20 @@ cc2420_aes_cipher(uint8_t *data, int len, int key_index)
   }
 }
 /*---------------------------------------------------------------------------*/
+static void
+aes_128_set_key(const uint8_t *key)
+{
+  cc2420_aes_set_key(key, 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+aes_128_encrypt(uint8_t *plaintext_and_result)
+{
+  cc2420_aes_cipher(plaintext_and_result, AES_128_BLOCK_SIZE, 0);
+}
+/*---------------------------------------------------------------------------*/
+const struct aes_128_driver cc2420_aes_128_driver = {
+  aes_128_set_key,
+  aes_128_encrypt
+};
+/*---------------------------------------------------------------------------*/
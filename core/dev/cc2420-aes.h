@@ -40,6 +40,8 @@
 #ifndef __CC2420_AES_H__
 #define __CC2420_AES_H__
 
+#include "lib/aes-128.h"
+
 /**
  * \brief      Setup an AES key
  * \param key  A pointer to a 16-byte AES key
@@ -71,5 +73,10 @@ void cc2420_aes_set_key(const uint8_t *key, int index);
  */
 void cc2420_aes_cipher(uint8_t *data, int len, int key_index);
 
+/**
+ * AES_128 driver that uses key 0 of the CC2420 stand-alone AES
+ * engine. Select it with AES_128_CONF.
+ */
+extern const struct aes_128_driver cc2420_aes_128_driver;
 
 #endif /* __CC2420_AES_H__ */
@@ -137,6 +137,8 @@ static int cc2420_receiving_packet(void);
 static int pending_packet(void);
 static int cc2420_cca(void);
 /*static int detected_energy(void);*/
+static int get_capabilities(void);
+static rtimer_clock_t last_sfd_time(void);
 
 signed char cc2420_last_rssi;
 uint8_t cc2420_last_correlation;
@@ -155,6 +157,10 @@ const struct radio_driver cc2420_driver =
     pending_packet,
     cc2420_on,
     cc2420_off,
+    NULL,
+    get_capabilities,
+    last_sfd_time,
+    cc2420_set_channel,
   };
 
 static uint8_t receive_on;
@@ -199,6 +205,15 @@ status(void)
 /*---------------------------------------------------------------------------*/
 static uint8_t locked, lock_on, lock_off;
 
+#if SPI_DMA
+/* Another driver may hold the bus with interrupts enabled, see
+   spi_acquire(). Treat this like our own lock when invoked from an
+   interrupt. */
+#define LOCKED() (locked || spi_busy)
+#else /* SPI_DMA */
+#define LOCKED() locked
+#endif /* SPI_DMA */
+
 static void
 on(void)
 {
@@ -493,7 +508,7 @@ cc2420_off(void)
 
   /* If we are called when the driver is locked, we indicate that the
      radio should be turned off when the lock is unlocked. */
-  if(locked) {
+  if(LOCKED()) {
     /*    printf("Off when locked (%d)\n", locked);*/
     lock_off = 1;
     return 1;
@@ -519,7 +534,7 @@ cc2420_on(void)
   if(receive_on) {
     return 1;
   }
-  if(locked) {
+  if(LOCKED()) {
     lock_on = 1;
     return 1;
   }
@@ -781,7 +796,7 @@ cc2420_rssi(void)
   int rssi;
   int radio_was_off = 0;
 
-  if(locked) {
+  if(LOCKED()) {
     return 0;
   }
   
@@ -814,7 +829,7 @@ int
 cc2420_cca_valid(void)
 {
   int valid;
-  if(locked) {
+  if(LOCKED()) {
     return 1;
   }
   GET_LOCK();
@@ -833,7 +848,7 @@ cc2420_cca(void)
      being invoked through an interrupt), we preted that the coast is
      clear (i.e., no packet is currently being transmitted by a
      neighbor). */
-  if(locked) {
+  if(LOCKED()) {
     return 1;
   }
 
@@ -870,6 +885,26 @@ cc2420_receiving_packet(void)
 }
 /*---------------------------------------------------------------------------*/
 static int
+get_capabilities(void)
+{
+  int capabilities = RADIO_CAP_HW_CCA;
+
+#if CC2420_CONF_AUTOACK
+  capabilities |= RADIO_CAP_ADDRESS_FILTER | RADIO_CAP_AUTOACK;
+#endif /* CC2420_CONF_AUTOACK */
+#if CC2420_CONF_SFD_TIMESTAMPS
+  capabilities |= RADIO_CAP_SFD_TIMESTAMP;
+#endif /* CC2420_CONF_SFD_TIMESTAMPS */
+  return capabilities;
+}
+/*---------------------------------------------------------------------------*/
+static rtimer_clock_t
+last_sfd_time(void)
+{
+  return cc2420_sfd_start_time;
+}
+/*---------------------------------------------------------------------------*/
+static int
 pending_packet(void)
 {
   return CC2420_FIFOP_IS_1;
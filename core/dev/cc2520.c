@@ -112,6 +112,8 @@ static int cc2520_receiving_packet(void);
 static int pending_packet(void);
 static int cc2520_cca(void);
 /* static int detected_energy(void); */
+static int get_capabilities(void);
+static rtimer_clock_t last_sfd_time(void);
 
 signed char cc2520_last_rssi;
 uint8_t cc2520_last_correlation;
@@ -130,6 +132,10 @@ const struct radio_driver cc2520_driver =
     pending_packet,
     cc2520_on,
     cc2520_off,
+    NULL,
+    get_capabilities,
+    last_sfd_time,
+    cc2520_set_channel,
   };
 
 static uint8_t receive_on;
@@ -836,6 +842,26 @@ cc2520_receiving_packet(void)
 }
 /*---------------------------------------------------------------------------*/
 static int
+get_capabilities(void)
+{
+  int capabilities = RADIO_CAP_HW_CCA;
+
+#if CC2520_CONF_AUTOACK
+  capabilities |= RADIO_CAP_ADDRESS_FILTER | RADIO_CAP_AUTOACK;
+#endif /* CC2520_CONF_AUTOACK */
+#if CC2520_CONF_SFD_TIMESTAMPS
+  capabilities |= RADIO_CAP_SFD_TIMESTAMP;
+#endif /* CC2520_CONF_SFD_TIMESTAMPS */
+  return capabilities;
+}
+/*---------------------------------------------------------------------------*/
+static rtimer_clock_t
+last_sfd_time(void)
+{
+  return cc2520_sfd_start_time;
+}
+/*---------------------------------------------------------------------------*/
+static int
 pending_packet(void)
 {
   return CC2520_FIFOP_IS_1;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Helper functions for the radio API
+ */
+
+#include "dev/radio.h"
+
+#include <string.h>
+
+/* The largest packet that radio_prepare_v() copies together for
+   drivers without prepare_v(). */
+#ifdef RADIO_CONF_PREPARE_V_BUFSIZE
+#define RADIO_PREPARE_V_BUFSIZE RADIO_CONF_PREPARE_V_BUFSIZE
+#else
+#define RADIO_PREPARE_V_BUFSIZE 127
+#endif
+
+/*---------------------------------------------------------------------------*/
+int
+radio_prepare_v(const struct radio_driver *driver,
+                const struct radio_iovec *iov, unsigned char iovcnt)
+{
+  static unsigned char buf[RADIO_PREPARE_V_BUFSIZE];
+  unsigned short len;
+  unsigned char i;
+
+  if(driver->prepare_v != NULL) {
+    return driver->prepare_v(iov, iovcnt);
+  }
+
+  if(iovcnt == 0) {
+    return driver->prepare(NULL, 0);
+  }
+
+  /* Check if the buffers are adjacent, as they most often are when
+     they all point into the packetbuf. */
+  len = iov[0].len;
+  for(i = 1; i < iovcnt; i++) {
+    if((const unsigned char *)iov[0].ptr + len != iov[i].ptr &&
+       iov[i].len > 0) {
+      break;
+    }
+    len += iov[i].len;
+  }
+  if(i == iovcnt) {
+    return driver->prepare(iov[0].ptr, len);
+  }
+
+  len = 0;
+  for(i = 0; i < iovcnt; i++) {
+    if(len + iov[i].len > sizeof(buf)) {
+      return 1;
+    }
+    memcpy(&buf[len], iov[i].ptr, iov[i].len);
+    len += iov[i].len;
+  }
+  return driver->prepare(buf, len);
+}
+/*---------------------------------------------------------------------------*/
+int
+radio_get_capabilities(const struct radio_driver *driver)
+{
+  if(driver->get_capabilities != NULL) {
+    return driver->get_capabilities();
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
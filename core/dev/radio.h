@@ -54,6 +54,16 @@
 #ifndef __RADIO_H__
 #define __RADIO_H__
 
+#include "sys/rtimer.h"
+
+/**
+ * A buffer in a list of buffers that together make up a packet.
+ */
+struct radio_iovec {
+  const void *ptr;
+  unsigned short len;
+};
+
 /**
  * The structure of a device driver for a radio in Contiki.
  */
@@ -88,8 +98,34 @@ struct radio_driver {
 
   /** Turn the radio off. */
   int (* off)(void);
+
+  /** Prepare the radio with a packet made of several buffers. This
+      is optional, use radio_prepare_v() to call it. */
+  int (* prepare_v)(const struct radio_iovec *iov, unsigned char iovcnt);
+
+  /** Get the RADIO_CAP_ flags of what the radio does in hardware. This
+      is optional, use radio_get_capabilities() to call it. */
+  int (* get_capabilities)(void);
+
+  /** Get the time at which the start of frame delimiter of the last
+      frame sent or received was seen. Only used with radios that have
+      RADIO_CAP_SFD_TIMESTAMP. */
+  rtimer_clock_t (* last_sfd_time)(void);
+
+  /** Set the IEEE 802.15.4 channel (11 - 26). This is optional. */
+  int (* set_channel)(int channel);
 };
 
+/* Radio capabilities. */
+/** Frames not addressed to us are dropped by the radio */
+#define RADIO_CAP_ADDRESS_FILTER 0x01
+/** The radio acknowledges frames that request it */
+#define RADIO_CAP_AUTOACK        0x02
+/** channel_clear() reads the CCA result of the radio */
+#define RADIO_CAP_HW_CCA         0x04
+/** last_sfd_time() returns hardware captured SFD times */
+#define RADIO_CAP_SFD_TIMESTAMP  0x08
+
 /* Generic radio return values. */
 enum {
   RADIO_TX_OK,
@@ -98,6 +134,29 @@ enum {
   RADIO_TX_NOACK,
 };
 
+/**
+ * \brief      Prepare the radio with a packet made of several buffers
+ * \param driver The radio driver
+ * \param iov  The buffers, in the order they are to be sent
+ * \param iovcnt The number of buffers
+ * \return     The return value of the driver's prepare function
+ *
+ *             The buffers are passed to the prepare_v() function of
+ *             the driver if it has one. Otherwise, buffers that are
+ *             adjacent in memory are passed to prepare() as they are,
+ *             and other buffers are first copied together.
+ */
+int radio_prepare_v(const struct radio_driver *driver,
+                    const struct radio_iovec *iov, unsigned char iovcnt);
+
+/**
+ * \brief      Get the capabilities of a radio
+ * \param driver The radio driver
+ * \return     The RADIO_CAP_ flags of the radio, zero if the driver
+ *             has no get_capabilities() function
+ */
+int radio_get_capabilities(const struct radio_driver *driver);
+
 #endif /* __RADIO_H__ */
 
 
@@ -30,7 +30,7 @@
  *
  */
 #include "dev/serial-line.h"
-#include <string.h> /* for memcpy() */
+#include <string.h> /* for memcpy() and memchr() */
 
 #include "lib/ringbuf.h"
 
@@ -95,33 +95,45 @@ PROCESS_THREAD(serial_line_process, ev, data)
   ptr = 0;
 
   while(1) {
-    /* Fill application buffer until newline or empty */
-    int c = ringbuf_get(&rxbuf);
-    
-    if(c == -1) {
+    /* Fill application buffer until newline or empty, taking the
+       received bytes in place from the ring buffer */
+    uint8_t *data;
+    uint8_t *eol;
+    int len, n;
+
+    len = ringbuf_peek(&rxbuf, &data);
+    if(len == 0) {
       /* Buffer empty, wait for poll */
       PROCESS_YIELD();
+      continue;
+    }
+
+    eol = memchr(data, END, len);
+    n = eol != NULL ? eol - data : len;
+    if(n > BUFSIZE - 1 - ptr) {
+      /* Ignore the characters that do not fit (wait for EOL) */
+      n = BUFSIZE - 1 - ptr;
+    }
+    memcpy(&buf[ptr], data, n);
+    ptr += n;
+
+    if(eol == NULL) {
+      ringbuf_consume(&rxbuf, len);
     } else {
-      if(c != END) {
-        if(ptr < BUFSIZE-1) {
-          buf[ptr++] = (uint8_t)c;
-        } else {
-          /* Ignore character (wait for EOL) */
-        }
-      } else {
-        /* Terminate */
-        buf[ptr++] = (uint8_t)'\0';
-
-        /* Broadcast event */
-        process_post(PROCESS_BROADCAST, serial_line_event_message, buf);
-
-        /* Wait until all processes have handled the serial line event */
-        if(PROCESS_ERR_OK ==
-          process_post(PROCESS_CURRENT(), PROCESS_EVENT_CONTINUE, NULL)) {
-          PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
-        }
-        ptr = 0;
+      ringbuf_consume(&rxbuf, eol - data + 1);
+
+      /* Terminate */
+      buf[ptr++] = (uint8_t)'\0';
+
+      /* Broadcast event */
+      process_post(PROCESS_BROADCAST, serial_line_event_message, buf);
+
+      /* Wait until all processes have handled the serial line event */
+      if(PROCESS_ERR_OK ==
+        process_post(PROCESS_CURRENT(), PROCESS_EVENT_CONTINUE, NULL)) {
+        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
       }
+      ptr = 0;
     }
   }
 
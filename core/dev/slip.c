@@ -42,6 +42,7 @@
 #define BUF ((struct uip_tcpip_hdr *)&uip_buf[UIP_LLH_LEN])
 
 #include "dev/slip.h"
+#include "lib/ringbuf.h"
 
 #define SLIP_END     0300
 #define SLIP_ESC     0333
@@ -55,35 +56,42 @@ uint8_t slip_active;
 #if 1
 #define SLIP_STATISTICS(statement)
 #else
-uint16_t slip_rubbish, slip_twopackets, slip_overflow, slip_ip_drop;
+uint16_t slip_rubbish, slip_overflow, slip_ip_drop;
 #define SLIP_STATISTICS(statement) statement
 #endif
 
-/* Must be at least one byte larger than UIP_BUFSIZE! */
-#define RX_BUFSIZE (UIP_BUFSIZE - UIP_LLH_LEN + 16)
-
-enum {
-  STATE_TWOPACKETS = 0,	/* We have 2 packets and drop incoming data. */
-  STATE_OK = 1,
-  STATE_ESC = 2,
-  STATE_RUBBISH = 3,
-};
-
 /*
- * Variables begin and end manage the buffer space in a cyclic
- * fashion. The first used byte is at begin and end is one byte past
- * the last. I.e. [begin, end) is the actively used space.
- *
- * If begin != pkt_end we have a packet at [begin, pkt_end),
- * furthermore, if state == STATE_TWOPACKETS we have one more packet at
- * [pkt_end, end). If more bytes arrive in state STATE_TWOPACKETS
- * they are discarded.
+ * The interrupt handler only appends the raw bytes to a small ring
+ * buffer; slip_process unescapes them into rxframe as they arrive and
+ * hands each complete frame to uIP. The ring buffer is a staging
+ * area only and need not hold a whole frame, which keeps it within
+ * what an 8-bit ringbuf_index_t can address. It must be a power of
+ * two.
  */
+#ifdef SLIP_CONF_RX_RINGSIZE
+#define RX_RINGSIZE SLIP_CONF_RX_RINGSIZE
+#else /* SLIP_CONF_RX_RINGSIZE */
+#define RX_RINGSIZE 128
+#endif /* SLIP_CONF_RX_RINGSIZE */
+
+#if (RX_RINGSIZE & (RX_RINGSIZE - 1)) != 0
+#error SLIP_CONF_RX_RINGSIZE must be a power of two.
+#endif
 
-static uint8_t state = STATE_TWOPACKETS;
-static uint16_t begin, end;
-static uint8_t rxbuf[RX_BUFSIZE];
-static uint16_t pkt_end;		/* SLIP_END tracker. */
+static struct ringbuf rxbuf;
+static uint8_t rxbuf_data[RX_RINGSIZE];
+
+/* The frame being unescaped. It holds the unescaped bytes, so an
+   escape-heavy frame needs no more room than any other. */
+static uint8_t rxframe[UIP_BUFSIZE - UIP_LLH_LEN];
+static uint16_t rxframe_len;
+static uint8_t rx_esc, rx_rubbish;
+
+/* Set by the interrupt handler while it drops the rest of a frame
+   that did not fit. */
+static volatile uint8_t overflow;
+
+static uint8_t rx_ready;
 
 static void (* input_callback)(void) = NULL;
 /*---------------------------------------------------------------------------*/
@@ -155,96 +163,105 @@ slip_write(const void *_ptr, int len)
 static void
 rxbuf_init(void)
 {
-  begin = end = pkt_end = 0;
-  state = STATE_OK;
+  rx_ready = 0;
+  ringbuf_init(&rxbuf, rxbuf_data, sizeof(rxbuf_data));
+  rxframe_len = 0;
+  rx_esc = rx_rubbish = 0;
+  overflow = 0;
+  rx_ready = 1;
 }
 /*---------------------------------------------------------------------------*/
-/* Upper half does the polling. */
+/* Upper half does the polling. Unescapes the buffered bytes into
+   rxframe and returns the length of the first complete frame, or
+   zero when no frame has been completed yet. */
 static uint16_t
-slip_poll_handler(uint8_t *outbuf, uint16_t blen)
+slip_poll_handler(void)
 {
-  /* This is a hack and won't work across buffer edge! */
-  if(rxbuf[begin] == 'C') {
-    int i;
-    if(begin < end && (end - begin) >= 6
-       && memcmp(&rxbuf[begin], "CLIENT", 6) == 0) {
-      state = STATE_TWOPACKETS;	/* Interrupts do nothing. */
-      memset(&rxbuf[begin], 0x0, 6);
-      
-      rxbuf_init();
-      
-      for(i = 0; i < 13; i++) {
-	slip_arch_writeb("CLIENTSERVER\300"[i]);
+  uint8_t *data;
+  uint16_t len;
+  uint8_t c;
+  int i, n;
+
+  while((n = ringbuf_peek(&rxbuf, &data)) > 0) {
+    if(rxframe_len == 0 && !rx_esc && !rx_rubbish) {
+      /* This is a hack and won't work across buffer edge! */
+      if(data[0] == 'C' && memcmp(data, "CLIENT", n < 6 ? n : 6) == 0) {
+        if(n < 6) {
+          /* Wait for the rest of it. */
+          return 0;
+        }
+        ringbuf_consume(&rxbuf, 6);
+        for(i = 0; i < 13; i++) {
+          slip_arch_writeb("CLIENTSERVER\300"[i]);
+        }
+        continue;
       }
-      return 0;
-    }
-  }
 #ifdef SLIP_CONF_ANSWER_MAC_REQUEST
-  else if(rxbuf[begin] == '?') { 
-    /* Used by tapslip6 to request mac for auto configure */
-    int i, j;
-    char* hexchar = "0123456789abcdef";
-    if(begin < end && (end - begin) >= 2
-       && rxbuf[begin + 1] == 'M') {
-      state = STATE_TWOPACKETS; /* Interrupts do nothing. */
-      rxbuf[begin] = 0;
-      rxbuf[begin + 1] = 0;
-      
-      rxbuf_init();
-      
-      rimeaddr_t addr = get_mac_addr();
-      /* this is just a test so far... just to see if it works */
-      slip_arch_writeb('!');
-      slip_arch_writeb('M');
-      for(j = 0; j < 8; j++) {
-        slip_arch_writeb(hexchar[addr.u8[j] >> 4]);
-        slip_arch_writeb(hexchar[addr.u8[j] & 15]);
+      if(data[0] == '?') {
+        if(n < 2) {
+          return 0;
+        }
+        if(data[1] == 'M') {
+          /* Used by tapslip6 to request mac for auto configure */
+          int j;
+          char* hexchar = "0123456789abcdef";
+          rimeaddr_t addr = get_mac_addr();
+
+          ringbuf_consume(&rxbuf, 2);
+
+          /* this is just a test so far... just to see if it works */
+          slip_arch_writeb('!');
+          slip_arch_writeb('M');
+          for(j = 0; j < 8; j++) {
+            slip_arch_writeb(hexchar[addr.u8[j] >> 4]);
+            slip_arch_writeb(hexchar[addr.u8[j] & 15]);
+          }
+          slip_arch_writeb(SLIP_END);
+          continue;
+        }
       }
-      slip_arch_writeb(SLIP_END);
-      return 0;
-    }
-  }
 #endif /* SLIP_CONF_ANSWER_MAC_REQUEST */
+    }
 
-  /*
-   * Interrupt can not change begin but may change pkt_end.
-   * If pkt_end != begin it will not change again.
-   */
-  if(begin != pkt_end) {
-    uint16_t len;
-
-    if(begin < pkt_end) {
-      len = pkt_end - begin;
-      if(len > blen) {
-	len = 0;
-      } else {
-	memcpy(outbuf, &rxbuf[begin], len);
+    for(i = 0; i < n; i++) {
+      c = data[i];
+      if(c == SLIP_END) {
+        ringbuf_consume(&rxbuf, i + 1);
+        len = rxframe_len;
+        if(rx_rubbish || rx_esc) {
+          SLIP_STATISTICS(slip_rubbish++);
+          len = 0;
+        }
+        rxframe_len = 0;
+        rx_esc = rx_rubbish = 0;
+        if(len > 0) {
+          return len;
+        }
+        /* Empty or dropped frame: go on with the next one. */
+        break;
       }
-    } else {
-      len = (RX_BUFSIZE - begin) + (pkt_end - 0);
-      if(len > blen) {
-	len = 0;
+      if(rx_esc) {
+        rx_esc = 0;
+        if(c == SLIP_ESC_END) {
+          c = SLIP_END;
+        } else if(c == SLIP_ESC_ESC) {
+          c = SLIP_ESC;
+        } else {
+          rx_rubbish = 1;
+        }
+      } else if(c == SLIP_ESC) {
+        rx_esc = 1;
+        continue;
+      }
+      if(rxframe_len < sizeof(rxframe)) {
+        rxframe[rxframe_len++] = c;
       } else {
-	unsigned i;
-	for(i = begin; i < RX_BUFSIZE; i++) {
-	  *outbuf++ = rxbuf[i];
-	}
-	for(i = 0; i < pkt_end; i++) {
-	  *outbuf++ = rxbuf[i];
-	}
+        rx_rubbish = 1;
       }
     }
-
-    /* Remove data from buffer together with the copied packet. */
-    begin = pkt_end;
-    if(state == STATE_TWOPACKETS) {
-      pkt_end = end;
-      state = STATE_OK;		/* Assume no bytes where lost! */
-      
-      /* One more packet is buffered, need to be polled again! */
-      process_poll(&slip_process);
+    if(i == n) {
+      ringbuf_consume(&rxbuf, n);
     }
-    return len;
   }
 
   return 0;
@@ -261,9 +278,13 @@ PROCESS_THREAD(slip_process, ev, data)
     
     slip_active = 1;
 
-    /* Move packet from rxbuf to buffer provided by uIP. */
-    uip_len = slip_poll_handler(&uip_buf[UIP_LLH_LEN],
-				UIP_BUFSIZE - UIP_LLH_LEN);
+    /* Move packet from rxframe to buffer provided by uIP. */
+    uip_len = slip_poll_handler();
+    if(uip_len > 0) {
+      memcpy(&uip_buf[UIP_LLH_LEN], rxframe, uip_len);
+      /* More frames may be buffered, need to be polled again! */
+      process_poll(&slip_process);
+    }
 #if !UIP_CONF_IPV6
     if(uip_len == 4 && strncmp((char*)&uip_buf[UIP_LLH_LEN], "?IPA", 4) == 0) {
       char buf[8];
@@ -318,74 +339,42 @@ PROCESS_THREAD(slip_process, ev, data)
 int
 slip_input_byte(unsigned char c)
 {
-  switch(state) {
-  case STATE_RUBBISH:
-    if(c == SLIP_END) {
-      state = STATE_OK;
-    }
-    return 0;
-    
-  case STATE_TWOPACKETS:       /* Two packets are already buffered! */
+  uint8_t *head;
+
+  if(!rx_ready) {
     return 0;
+  }
 
-  case STATE_ESC:
-    if(c == SLIP_ESC_END) {
-      c = SLIP_END;
-    } else if(c == SLIP_ESC_ESC) {
-      c = SLIP_ESC;
-    } else {
-      state = STATE_RUBBISH;
-      SLIP_STATISTICS(slip_rubbish++);
-      end = pkt_end;		/* remove rubbish */
+  if(overflow) {
+    /* Drop the rest of the frame, then end it with an invalid escape
+       sequence so that the upper half discards what was buffered. */
+    if(c != SLIP_END ||
+       ringbuf_size(&rxbuf) - 1 - ringbuf_elements(&rxbuf) < 2) {
       return 0;
     }
-    state = STATE_OK;
-    break;
+    ringbuf_put(&rxbuf, SLIP_ESC);
+    ringbuf_put(&rxbuf, SLIP_END);
+    overflow = 0;
+    process_poll(&slip_process);
+    return 1;
+  }
 
-  case STATE_OK:
-    if(c == SLIP_ESC) {
-      state = STATE_ESC;
-      return 0;
-    } else if(c == SLIP_END) {
-	/*
-	 * We have a new packet, possibly of zero length.
-	 *
-	 * There may already be one packet buffered.
-	 */
-      if(end != pkt_end) {	/* Non zero length. */
-	if(begin == pkt_end) {	/* None buffered. */
-	  pkt_end = end;
-	} else {
-	  state = STATE_TWOPACKETS;
-	  SLIP_STATISTICS(slip_twopackets++);
-	}
-	process_poll(&slip_process);
-	return 1;
-      }
-      return 0;
-    }
-    break;
+  if(ringbuf_put(&rxbuf, c) == 0) {
+    overflow = 1;
+    SLIP_STATISTICS(slip_overflow++);
+    process_poll(&slip_process);
+    return 0;
   }
 
-  /* add_char: */
-  {
-    unsigned next;
-    next = end + 1;
-    if(next == RX_BUFSIZE) {
-      next = 0;
-    }
-    if(next == begin) {		/* rxbuf is full */
-      state = STATE_RUBBISH;
-      SLIP_STATISTICS(slip_overflow++);
-      end = pkt_end;		/* remove rubbish */
-      return 0;
-    }
-    rxbuf[end] = c;
-    end = next;
+  /* Wake the upper half at the end of a frame, and before the ring
+     buffer fills up in the middle of a large one. */
+  if(c == SLIP_END || ringbuf_elements(&rxbuf) >= RX_RINGSIZE / 2) {
+    process_poll(&slip_process);
+    return 1;
   }
 
   /* There could be a separate poll routine for this. */
-  if(c == 'T' && rxbuf[begin] == 'C') {
+  if(c == 'T' && ringbuf_peek(&rxbuf, &head) > 0 && *head == 'C') {
     process_poll(&slip_process);
     return 1;
   }
@@ -393,3 +382,27 @@ slip_input_byte(unsigned char c)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+int
+slip_input(const uint8_t *data, int len)
+{
+  int n, wake;
+
+  if(!rx_ready || overflow) {
+    wake = 0;
+    while(len-- > 0) {
+      wake |= slip_input_byte(*data++);
+    }
+    return wake;
+  }
+
+  n = ringbuf_write(&rxbuf, data, len);
+  process_poll(&slip_process);
+  wake = n > 0;
+
+  /* The rest did not fit: the first byte starts the overflow handling */
+  for(data += n; n < len; n++) {
+    wake |= slip_input_byte(*data++);
+  }
+  return wake;
+}
+/*---------------------------------------------------------------------------*/
@@ -62,13 +62,27 @@ uint8_t slip_send(void);
  */
 int slip_input_byte(unsigned char c);
 
+/**
+ * Input a block of SLIP bytes.
+ *
+ * The same as calling slip_input_byte() for each byte, for drivers
+ * that receive data in blocks (e.g. by DMA). The bytes are copied
+ * into the SLIP receive buffer in one go.
+ *
+ * \param data The data that is to be passed to the SLIP driver
+ * \param len The number of bytes
+ *
+ * \return Non-zero if the CPU should be powered up, zero otherwise.
+ */
+int slip_input(const uint8_t *data, int len);
+
 uint8_t slip_write(const void *ptr, int len);
 
 /* Did we receive any bytes lately? */
 extern uint8_t slip_active;
 
 /* Statistics. */
-extern uint16_t slip_rubbish, slip_twopackets, slip_overflow, slip_ip_drop;
+extern uint16_t slip_rubbish, slip_overflow, slip_ip_drop;
 
 /**
  * Set a function to be called when there is activity on the SLIP
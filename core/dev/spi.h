@@ -56,6 +56,30 @@ extern unsigned char spi_busy;
 
 void spi_init(void);
 
+#ifdef SPI_CONF_DMA
+#define SPI_DMA SPI_CONF_DMA
+#else /* SPI_CONF_DMA */
+#define SPI_DMA 0
+#endif /* SPI_CONF_DMA */
+
+#if SPI_DMA
+/* Claim the bus for a sequence of transfers. Returns 1 if the bus was
+   free, 0 if it is held by someone else. Code that runs in interrupt
+   context, such as the radio driver, checks spi_busy and defers its
+   own bus access instead of waiting for spi_release(). */
+int spi_acquire(void);
+void spi_release(void);
+
+/* Clock out len bytes from tx (zeros if tx is NULL) while storing the
+   received bytes in rx (discarded if rx is NULL), using DMA. The bus
+   must be held by the caller. The callback is invoked from interrupt
+   context once the last byte has been received. Returns 0 if a
+   transfer is already in progress. */
+int spi_dma_transfer(const unsigned char *tx, unsigned char *rx,
+                     unsigned short len,
+                     void (*callback)(void *ptr), void *ptr);
+#endif /* SPI_DMA */
+
 /* Write one character to SPI */
 #define SPI_WRITE(data)                         \
   do {                                          \
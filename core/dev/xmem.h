@@ -31,6 +31,8 @@
 #ifndef XMEM_H
 #define XMEM_H
 
+#include "sys/process.h"
+
 void xmem_init(void);
 
 int xmem_pread(void *buf, int nbytes, unsigned long offset);
@@ -39,4 +41,17 @@ int xmem_pwrite(const void *buf, int nbytes, unsigned long offset);
 
 int xmem_erase(long nbytes, unsigned long offset);
 
+/* Drivers that can buffer writes (XMEM_CONF_PAGE_BUFFER) program the
+   buffered data when this is called. */
+void xmem_flush(void);
+
+/* Start erasing in the background and return. The process p, if not
+   NULL, is polled when the range has been erased. Other xmem calls
+   first complete the erase. */
+int xmem_erase_async(long nbytes, unsigned long offset, struct process *p);
+
+/* Non-zero while the flash is programming or erasing, for callers that
+   should not block on it. */
+int xmem_busy(void);
+
 #endif /* XMEM_H */
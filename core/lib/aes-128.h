@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * \file
+ *         Interface to AES-128 block ciphers
+ */
+
+#ifndef __AES_128_H__
+#define __AES_128_H__
+
+#include "contiki-conf.h"
+
+#define AES_128_BLOCK_SIZE 16
+#define AES_128_KEY_LENGTH 16
+
+/*
+ * A block cipher that only needs to encrypt: CCM* never runs AES in
+ * the decryption direction. Platforms with an AES engine point
+ * AES_128_CONF to a driver for it, everyone else gets the software
+ * implementation in aes-128.c.
+ */
+#ifdef AES_128_CONF
+#define AES_128 AES_128_CONF
+#else /* AES_128_CONF */
+#define AES_128 aes_128_driver
+#endif /* AES_128_CONF */
+
+struct aes_128_driver {
+
+  /** Sets the key that subsequent calls to encrypt() use. */
+  void (* set_key)(const uint8_t *key);
+
+  /** Encrypts one 16-byte block in place. */
+  void (* encrypt)(uint8_t *plaintext_and_result);
+};
+
+extern const struct aes_128_driver aes_128_driver;
+extern const struct aes_128_driver AES_128;
+
+#endif /* __AES_128_H__ */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * \file
+ *         CCM* authenticated encryption as used by IEEE 802.15.4
+ */
+
+#include "lib/ccm-star.h"
+#include "lib/aes-128.h"
+#include <string.h>
+
+/* The length field is two bytes, see CCM_STAR_NONCE_LENGTH. */
+#define CCM_STAR_L 2
+
+/*---------------------------------------------------------------------------*/
+static void
+set_nonce(uint8_t *block, uint8_t flags, const uint8_t *nonce, uint16_t counter)
+{
+  block[0] = flags;
+  memcpy(block + 1, nonce, CCM_STAR_NONCE_LENGTH);
+  block[14] = counter >> 8;
+  block[15] = counter & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+/* Feeds data into the CBC-MAC, starting at byte pos of the current
+   block. A trailing partial block is padded with zeroes. */
+static void
+cbc_mac(uint8_t *x, uint8_t pos, const uint8_t *data, uint8_t len)
+{
+  while(len > 0) {
+    x[pos++] ^= *data++;
+    len--;
+    if(pos == AES_128_BLOCK_SIZE || len == 0) {
+      AES_128.encrypt(x);
+      pos = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+ccm_star_mic(const uint8_t *nonce,
+             const uint8_t *a, uint8_t a_len,
+             const uint8_t *m, uint8_t m_len,
+             uint8_t *result, uint8_t mic_len)
+{
+  uint8_t x[AES_128_BLOCK_SIZE];
+  uint8_t s0[AES_128_BLOCK_SIZE];
+  uint8_t i;
+
+  set_nonce(x, (a_len ? 0x40 : 0x00) | (((mic_len - 2) >> 1) << 3) |
+            (CCM_STAR_L - 1), nonce, m_len);
+  AES_128.encrypt(x);
+
+  if(a_len > 0) {
+    /* The length of a is prepended to it */
+    x[1] ^= a_len;
+    if(a_len > AES_128_BLOCK_SIZE - 2) {
+      cbc_mac(x, 2, a, AES_128_BLOCK_SIZE - 2);
+      cbc_mac(x, 0, a + AES_128_BLOCK_SIZE - 2,
+              a_len - (AES_128_BLOCK_SIZE - 2));
+    } else {
+      cbc_mac(x, 2, a, a_len);
+    }
+  }
+  cbc_mac(x, 0, m, m_len);
+
+  /* Encrypt the tag with the first block of the key stream */
+  set_nonce(s0, CCM_STAR_L - 1, nonce, 0);
+  AES_128.encrypt(s0);
+  for(i = 0; i < mic_len; i++) {
+    result[i] = x[i] ^ s0[i];
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+ccm_star_ctr(const uint8_t *nonce, uint8_t *m, uint8_t m_len)
+{
+  uint8_t a[AES_128_BLOCK_SIZE];
+  uint16_t counter;
+  uint8_t i;
+
+  counter = 1;
+  while(m_len > 0) {
+    set_nonce(a, CCM_STAR_L - 1, nonce, counter++);
+    AES_128.encrypt(a);
+    for(i = 0; i < AES_128_BLOCK_SIZE && m_len > 0; i++, m_len--) {
+      *m++ ^= a[i];
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
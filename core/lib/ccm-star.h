@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * \file
+ *         CCM* authenticated encryption as used by IEEE 802.15.4
+ */
+
+#ifndef __CCM_STAR_H__
+#define __CCM_STAR_H__
+
+#include "contiki-conf.h"
+
+/* CCM* with a length field of two bytes, which leaves 13 bytes for
+   the nonce. */
+#define CCM_STAR_NONCE_LENGTH 13
+
+/**
+ * \brief         Computes the encrypted authentication tag of a message
+ * \param nonce   The CCM_STAR_NONCE_LENGTH byte nonce
+ * \param a       Data that is authenticated but not encrypted
+ * \param a_len   The length of a
+ * \param m       Data that is authenticated and, with ccm_star_ctr(), encrypted
+ * \param m_len   The length of m
+ * \param result  Where the tag is stored
+ * \param mic_len The tag length: 4, 8 or 16 bytes
+ *
+ *                m must be passed in plaintext, i.e. before
+ *                ccm_star_ctr() when sending and after it when
+ *                receiving.
+ */
+void ccm_star_mic(const uint8_t *nonce,
+                  const uint8_t *a, uint8_t a_len,
+                  const uint8_t *m, uint8_t m_len,
+                  uint8_t *result, uint8_t mic_len);
+
+/**
+ * \brief         Encrypts or decrypts a message in place
+ * \param nonce   The CCM_STAR_NONCE_LENGTH byte nonce
+ * \param m       The message
+ * \param m_len   The length of m
+ */
+void ccm_star_ctr(const uint8_t *nonce, uint8_t *m, uint8_t m_len);
+
+#endif /* __CCM_STAR_H__ */
@@ -38,7 +38,256 @@
  */
 
 #include "lib/checkpoint.h"
+#include "lib/crc16.h"
+#include "cfs/cfs.h"
 
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Memory is saved page by page. Each saved page is its page number
+ * (two bytes, little endian) followed by the page, run-length
+ * encoded: a control byte c below 0x80 is followed by c + 1 literal
+ * bytes, otherwise the next byte is repeated (c & 0x7f) + 3 times.
+ * The page number 0xffff ends the memory.
+ */
+#define LAST_PAGE 0xffff
+#define MAX_LITERALS 128
+#define MIN_RUN 3
+#define MAX_RUN (0x7f + MIN_RUN)
+
+/*
+ * The state of the library is itself left out of checkpoints, so that
+ * a rollback does not overwrite the page being restored.
+ */
+static struct {
+  unsigned char page[CHECKPOINT_PAGE_SIZE];
+#if CHECKPOINT_INCREMENTAL_PAGES
+  uint16_t hashes[CHECKPOINT_INCREMENTAL_PAGES];
+  uint8_t hashes_valid;
+#endif /* CHECKPOINT_INCREMENTAL_PAGES */
+  uint8_t incremental;
+  uint8_t serial_col;
+} cp;
+/*---------------------------------------------------------------------------*/
+int
+checkpoint_write(int fd, const void *buf, unsigned len)
+{
+  static const char hex[] = "0123456789abcdef";
+  const unsigned char *p;
+  unsigned i;
+
+  if(fd != CHECKPOINT_FD_SERIAL) {
+    return cfs_write(fd, buf, len);
+  }
+
+  p = buf;
+  for(i = 0; i < len; i++) {
+    if(cp.serial_col == 0) {
+      putchar('C');
+      putchar('P');
+      putchar('S');
+      putchar(':');
+    }
+    putchar(hex[p[i] >> 4]);
+    putchar(hex[p[i] & 0xf]);
+    if(++cp.serial_col == 32) {
+      putchar('\n');
+      cp.serial_col = 0;
+    }
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+checkpoint_read(int fd, void *buf, unsigned len)
+{
+  if(fd == CHECKPOINT_FD_SERIAL) {
+    return -1;
+  }
+  return cfs_read(fd, buf, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_page_number(int fd, uint16_t n)
+{
+  unsigned char b[2];
+
+  b[0] = n & 0xff;
+  b[1] = n >> 8;
+  checkpoint_write(fd, b, 2);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_literals(int fd, const unsigned char *p, int len)
+{
+  unsigned char c;
+  int n;
+
+  while(len > 0) {
+    n = len > MAX_LITERALS ? MAX_LITERALS : len;
+    c = n - 1;
+    checkpoint_write(fd, &c, 1);
+    checkpoint_write(fd, p, n);
+    p += n;
+    len -= n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_rle(int fd, const unsigned char *p, int len)
+{
+  unsigned char b[2];
+  int i, lit, run;
+
+  lit = 0;
+  i = 0;
+  while(i < len) {
+    for(run = 1; i + run < len && run < MAX_RUN && p[i + run] == p[i]; run++);
+    if(run >= MIN_RUN) {
+      write_literals(fd, &p[lit], i - lit);
+      b[0] = 0x80 | (run - MIN_RUN);
+      b[1] = p[i];
+      checkpoint_write(fd, b, 2);
+      i += run;
+      lit = i;
+    } else {
+      i++;
+    }
+  }
+  write_literals(fd, &p[lit], i - lit);
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_rle(int fd, unsigned char *p, int len)
+{
+  unsigned char c;
+  int i, n;
+
+  for(i = 0; i < len; i += n) {
+    if(checkpoint_read(fd, &c, 1) != 1) {
+      return -1;
+    }
+    if(c & 0x80) {
+      n = (c & 0x7f) + MIN_RUN;
+      if(i + n > len || checkpoint_read(fd, &c, 1) != 1) {
+        return -1;
+      }
+      memset(&p[i], c, n);
+    } else {
+      n = c + 1;
+      if(i + n > len || checkpoint_read(fd, &p[i], n) != n) {
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+in_hole(const unsigned char *addr, const struct checkpoint_hole *holes,
+        int nholes)
+{
+  int i;
+
+  if(addr >= (unsigned char *)&cp && addr < (unsigned char *)(&cp + 1)) {
+    return 1;
+  }
+  for(i = 0; i < nholes; i++) {
+    if(addr >= holes[i].start && addr < holes[i].end) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+checkpoint_mem_checkpoint(int fd, unsigned char *start, unsigned char *end,
+                          const struct checkpoint_hole *holes, int nholes)
+{
+  unsigned char *addr;
+  uint16_t n;
+  int i, len;
+#if CHECKPOINT_INCREMENTAL_PAGES
+  uint16_t hash;
+  int only_changed = cp.incremental && cp.hashes_valid;
+#endif /* CHECKPOINT_INCREMENTAL_PAGES */
+
+  for(n = 0, addr = start; addr < end; n++, addr += len) {
+    len = end - addr;
+    if(len > CHECKPOINT_PAGE_SIZE) {
+      len = CHECKPOINT_PAGE_SIZE;
+    }
+
+    /* Holes are saved as zeroes. */
+    for(i = 0; i < len; i++) {
+      cp.page[i] = in_hole(&addr[i], holes, nholes) ? 0 : addr[i];
+    }
+
+#if CHECKPOINT_INCREMENTAL_PAGES
+    if(n < CHECKPOINT_INCREMENTAL_PAGES) {
+      hash = crc16_data(cp.page, len, 0);
+      if(only_changed && hash == cp.hashes[n]) {
+        continue;
+      }
+      cp.hashes[n] = hash;
+    }
+#endif /* CHECKPOINT_INCREMENTAL_PAGES */
+
+    write_page_number(fd, n);
+    write_rle(fd, cp.page, len);
+  }
+  write_page_number(fd, LAST_PAGE);
+
+#if CHECKPOINT_INCREMENTAL_PAGES
+  cp.hashes_valid = 1;
+#endif /* CHECKPOINT_INCREMENTAL_PAGES */
+}
+/*---------------------------------------------------------------------------*/
+void
+checkpoint_mem_rollback(int fd, unsigned char *start, unsigned char *end,
+                        const struct checkpoint_hole *holes, int nholes)
+{
+  unsigned char b[2];
+  unsigned char *addr;
+  uint16_t n;
+  int i, len;
+
+#if CHECKPOINT_INCREMENTAL_PAGES
+  cp.hashes_valid = 0;
+#endif /* CHECKPOINT_INCREMENTAL_PAGES */
+
+  while(checkpoint_read(fd, b, 2) == 2) {
+    n = b[0] | (b[1] << 8);
+    if(n == LAST_PAGE) {
+      return;
+    }
+
+    addr = start + (unsigned long)n * CHECKPOINT_PAGE_SIZE;
+    if(addr >= end) {
+      break;
+    }
+    len = end - addr;
+    if(len > CHECKPOINT_PAGE_SIZE) {
+      len = CHECKPOINT_PAGE_SIZE;
+    }
+
+    if(read_rle(fd, cp.page, len) < 0) {
+      break;
+    }
+    for(i = 0; i < len; i++) {
+      if(!in_hole(&addr[i], holes, nholes)) {
+        addr[i] = cp.page[i];
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+checkpoint_set_incremental(int on)
+{
+  cp.incremental = on;
+}
 /*---------------------------------------------------------------------------*/
 void
 checkpoint_init(void)
@@ -49,7 +298,19 @@ checkpoint_init(void)
 void
 checkpoint_checkpoint(int fd)
 {
+  if(fd == CHECKPOINT_FD_SERIAL) {
+    printf("CPS:START\n");
+    cp.serial_col = 0;
+  }
+
   checkpoint_arch_checkpoint(fd);
+
+  if(fd == CHECKPOINT_FD_SERIAL) {
+    if(cp.serial_col != 0) {
+      putchar('\n');
+    }
+    printf("CPS:DONE\n");
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -42,12 +42,62 @@
 
 #include "contiki.h"
 
+/* Memory is saved in pages of this many bytes. */
+#ifdef CHECKPOINT_CONF_PAGE_SIZE
+#define CHECKPOINT_PAGE_SIZE CHECKPOINT_CONF_PAGE_SIZE
+#else
+#define CHECKPOINT_PAGE_SIZE 64
+#endif
+
+/* The number of pages whose hashes are remembered for incremental
+   checkpoints, two bytes each. Zero disables incremental checkpoints. */
+#ifdef CHECKPOINT_CONF_INCREMENTAL_PAGES
+#define CHECKPOINT_INCREMENTAL_PAGES CHECKPOINT_CONF_INCREMENTAL_PAGES
+#else
+#define CHECKPOINT_INCREMENTAL_PAGES 0
+#endif
+
+/* Checkpoints written to this file descriptor are streamed as hex
+   lines ("CPS:...") on the serial line instead of to a file. */
+#define CHECKPOINT_FD_SERIAL -2
+
+/* Largest size of len bytes of memory in a checkpoint. */
+#define CHECKPOINT_MEM_SIZE(len)                                        \
+  (((len) + CHECKPOINT_PAGE_SIZE - 1) / CHECKPOINT_PAGE_SIZE *          \
+   (2 + CHECKPOINT_PAGE_SIZE + (CHECKPOINT_PAGE_SIZE + 127) / 128) + 2)
+
+/* A part of a memory region that is left out of checkpoints. */
+struct checkpoint_hole {
+  unsigned char *start, *end;
+};
+
 void checkpoint_init(void);
 
 void checkpoint_checkpoint(int fd);
 
 void checkpoint_rollback(int fd);
 
+/**
+ * Make the following checkpoints incremental: they only contain the
+ * memory pages changed since the previous checkpoint, and must be
+ * rolled back on top of it. The first checkpoint after a rollback is
+ * always complete.
+ */
+void checkpoint_set_incremental(int on);
+
+/* Used by checkpoint_arch_checkpoint() and checkpoint_arch_rollback(). */
+int checkpoint_write(int fd, const void *buf, unsigned len);
+int checkpoint_read(int fd, void *buf, unsigned len);
+
+void checkpoint_mem_checkpoint(int fd, unsigned char *start,
+                               unsigned char *end,
+                               const struct checkpoint_hole *holes,
+                               int nholes);
+void checkpoint_mem_rollback(int fd, unsigned char *start,
+                             unsigned char *end,
+                             const struct checkpoint_hole *holes,
+                             int nholes);
+
 void checkpoint_arch_init(void);
 
 void checkpoint_arch_checkpoint(int fd);
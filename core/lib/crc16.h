@@ -54,6 +54,29 @@
 #ifndef __CRC16_H__
 #define __CRC16_H__
 
+/**
+ * \name CRC16 implementations
+ *
+ * CRC16_CONF_IMPL selects how the checksum is computed. All
+ * implementations produce the same checksum; they trade code size
+ * for speed:
+ *
+ * - CRC16_IMPL_BITWISE: shifts and xors, no tables (default)
+ * - CRC16_IMPL_NIBBLE: two lookups per byte in a 32 byte table
+ * - CRC16_IMPL_TABLE: one lookup per byte in a 512 byte table
+ * - CRC16_IMPL_SLICE2: two bytes per step using two 512 byte tables
+ *
+ * A platform with a CRC engine that computes this CRC can set
+ * CRC16_CONF_ARCH and provide crc16_arch_data(), which crc16_data()
+ * then uses.
+ * @{
+ */
+#define CRC16_IMPL_BITWISE 0
+#define CRC16_IMPL_NIBBLE  1
+#define CRC16_IMPL_TABLE   2
+#define CRC16_IMPL_SLICE2  3
+/** @} */
+
 /**
  * \brief      Update an accumulated CRC16 checksum with one byte.
  * \param b    The byte to be added to the checksum
@@ -64,10 +87,10 @@
  *             with one byte. It can be used as a running checksum, or
  *             to checksum an entire data block.
  *
- *             \note The algorithm used in this implementation is
- *             tailored for a running checksum and does not perform as
- *             well as a table-driven algorithm when checksumming an
- *             entire data block.
+ *             \note With the default CRC16_IMPL_BITWISE, the
+ *             algorithm is tailored for a running checksum and does
+ *             not perform as well as the table-driven ones when
+ *             checksumming an entire data block.
  *
  */
 unsigned short crc16_add(unsigned char b, unsigned short crc);
@@ -80,15 +103,15 @@ unsigned short crc16_add(unsigned char b, unsigned short crc);
  * \return     The CRC16 checksum.
  *
  *             This function calculates the CRC16 checksum of a data area.
- *
- *             \note The algorithm used in this implementation is
- *             tailored for a running checksum and does not perform as
- *             well as a table-driven algorithm when checksumming an
- *             entire data block.
  */
 unsigned short crc16_data(const unsigned char *data, int datalen,
 			  unsigned short acc);
 
+#if CRC16_CONF_ARCH
+unsigned short crc16_arch_data(const unsigned char *data, int datalen,
+                               unsigned short acc);
+#endif /* CRC16_CONF_ARCH */
+
 #endif /* __CRC16_H__ */
 
 /** @} */
@@ -0,0 +1,267 @@
+/**
+ * \addtogroup dlist
+ * @{
+ */
+
+/**
+ * \file
+ *         Doubly linked list
+ */
+
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+#include "lib/dlist.h"
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+struct dlist_item {
+  struct dlist_item *next;
+  struct dlist_item *prev;
+};
+
+/*---------------------------------------------------------------------------*/
+/**
+ * Initialize a list. The list will be empty afterwards.
+ *
+ * \param list The list to be initialized.
+ */
+void
+dlist_init(dlist_t list)
+{
+  list->head = NULL;
+  list->tail = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the first element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the first element, or NULL if the list is empty.
+ */
+void *
+dlist_head(dlist_t list)
+{
+  return list->head;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the last element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the last element, or NULL if the list is empty.
+ */
+void *
+dlist_tail(dlist_t list)
+{
+  return list->tail;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Check if an element is on a list, in constant time.
+ *
+ * The check trusts the links of the element, so an element must
+ * either be on the list or have its links cleared to NULL (for
+ * instance by being zero-initialized) before it is passed to any
+ * dlist function. Code that can be handed uninitialized elements must
+ * search the list instead.
+ *
+ * \param list The list.
+ * \param item The element.
+ * \return Non-zero if the element is on the list.
+ */
+int
+dlist_contains(dlist_t list, void *item)
+{
+  return ((struct dlist_item *)item)->prev != NULL || list->head == item;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove an element from a list, in constant time. Nothing is done
+ * if the element is not on the list.
+ *
+ * \param list The list.
+ * \param item The element to remove.
+ */
+void
+dlist_remove(dlist_t list, void *item)
+{
+  struct dlist_item *l = item;
+
+  if(!dlist_contains(list, item)) {
+    return;
+  }
+  if(l->prev == NULL) {
+    list->head = l->next;
+  } else {
+    l->prev->next = l->next;
+  }
+  if(l->next == NULL) {
+    list->tail = l->prev;
+  } else {
+    l->next->prev = l->prev;
+  }
+  l->next = NULL;
+  l->prev = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an element to the start of a list.
+ *
+ * \param list The list.
+ * \param item The element.
+ */
+void
+dlist_push(dlist_t list, void *item)
+{
+  struct dlist_item *l = item;
+
+  dlist_remove(list, item);
+
+  l->prev = NULL;
+  l->next = list->head;
+  if(l->next == NULL) {
+    list->tail = l;
+  } else {
+    l->next->prev = l;
+  }
+  list->head = l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an element to the end of a list.
+ *
+ * \param list The list.
+ * \param item The element.
+ */
+void
+dlist_add(dlist_t list, void *item)
+{
+  struct dlist_item *l = item;
+
+  dlist_remove(list, item);
+
+  l->next = NULL;
+  l->prev = list->tail;
+  if(l->prev == NULL) {
+    list->head = l;
+  } else {
+    l->prev->next = l;
+  }
+  list->tail = l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Insert an element after another element on a list.
+ *
+ * \param list The list.
+ * \param previtem The element after which the new element is inserted,
+ *                 or NULL to insert it at the start of the list.
+ * \param newitem The new element.
+ */
+void
+dlist_insert(dlist_t list, void *previtem, void *newitem)
+{
+  struct dlist_item *p = previtem;
+  struct dlist_item *l = newitem;
+
+  if(p == NULL) {
+    dlist_push(list, newitem);
+    return;
+  }
+
+  dlist_remove(list, newitem);
+
+  l->prev = p;
+  l->next = p->next;
+  if(l->next == NULL) {
+    list->tail = l;
+  } else {
+    l->next->prev = l;
+  }
+  p->next = l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the first element of a list.
+ *
+ * \param list The list.
+ * \return The removed element, or NULL if the list was empty.
+ */
+void *
+dlist_pop(dlist_t list)
+{
+  void *l = list->head;
+
+  if(l != NULL) {
+    dlist_remove(list, l);
+  }
+  return l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the last element of a list.
+ *
+ * \param list The list.
+ * \return The removed element, or NULL if the list was empty.
+ */
+void *
+dlist_chop(dlist_t list)
+{
+  void *l = list->tail;
+
+  if(l != NULL) {
+    dlist_remove(list, l);
+  }
+  return l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get the number of elements on a list.
+ *
+ * \param list The list.
+ * \return The length of the list.
+ */
+int
+dlist_length(dlist_t list)
+{
+  struct dlist_item *l;
+  int n = 0;
+
+  for(l = list->head; l != NULL; l = l->next) {
+    ++n;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,133 @@
+/** \addtogroup lib
+    @{ */
+/**
+ * \defgroup dlist Doubly linked list library
+ *
+ * The dlist library implements intrusive doubly linked lists. The
+ * first two elements of a list element \b must be pointers: the
+ * first points to the next element and the second to the previous
+ * one. Because the first element is the next pointer,
+ * list_item_next() can be used to iterate over a dlist as well.
+ *
+ * Every list keeps pointers to both its first and its last element,
+ * so adding or removing elements at either end, and removing a
+ * given element from anywhere in the list, take constant time.
+ *
+ * An element that is not on a list must have a NULL previous
+ * pointer. This holds for elements that are zero-initialized, such
+ * as static variables, and for elements that have been removed from
+ * a list; other elements must be cleared before their first use.
+ * As with the list library, adding an element that already is on
+ * the list moves it.
+ *
+ * Lists are declared with the DLIST() macro, or with DLIST_STRUCT()
+ * inside a structure.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ *         Doubly linked list
+ */
+
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+#ifndef __DLIST_H__
+#define __DLIST_H__
+
+#include "lib/list.h"
+
+/**
+ * The list head and tail. Only accessed through the dlist functions.
+ */
+struct dlist {
+  void *head;
+  void *tail;
+};
+
+/**
+ * The dlist type.
+ */
+typedef struct dlist * dlist_t;
+
+/**
+ * Declare a doubly linked list.
+ *
+ * The list variable is declared as static, in the same way as with
+ * the LIST() macro.
+ *
+ * \param name The name of the list.
+ */
+#define DLIST(name) \
+         static struct dlist LIST_CONCAT(name,_dlist) = { NULL, NULL }; \
+         static dlist_t name = &LIST_CONCAT(name,_dlist)
+
+/**
+ * Declare a doubly linked list inside a structure.
+ *
+ * The list must be initialized with DLIST_STRUCT_INIT() before use.
+ *
+ * \param name The name of the list.
+ */
+#define DLIST_STRUCT(name) \
+         struct dlist LIST_CONCAT(name,_dlist); \
+         dlist_t name
+
+/**
+ * Initialize a doubly linked list that is part of a structure.
+ *
+ * \param struct_ptr A pointer to the struct
+ * \param name The name of the list.
+ */
+#define DLIST_STRUCT_INIT(struct_ptr, name)                             \
+    do {                                                                \
+       (struct_ptr)->name = &((struct_ptr)->LIST_CONCAT(name,_dlist));  \
+       dlist_init((struct_ptr)->name);                                  \
+    } while(0)
+
+void   dlist_init(dlist_t list);
+void * dlist_head(dlist_t list);
+void * dlist_tail(dlist_t list);
+void * dlist_pop(dlist_t list);
+void * dlist_chop(dlist_t list);
+void   dlist_push(dlist_t list, void *item);
+void   dlist_add(dlist_t list, void *item);
+void   dlist_insert(dlist_t list, void *previtem, void *newitem);
+void   dlist_remove(dlist_t list, void *item);
+int    dlist_contains(dlist_t list, void *item);
+int    dlist_length(dlist_t list);
+
+#endif /* __DLIST_H__ */
+
+/** @} */
+/** @} */
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Fixed-point FFT and spectrum helpers
+ */
+
+#include "lib/fft.h"
+
+#define TABLE_SIZE FFT_MAX_SIZE
+
+/* sin(2 * pi * k / TABLE_SIZE) in Q15 for the first quarter of a
+   period; the rest follows from symmetry. */
+static const int16_t sin_table[TABLE_SIZE / 4 + 1] = {
+  0, 201, 402, 603, 804, 1005, 1206, 1407,
+  1608, 1809, 2009, 2210, 2411, 2611, 2811, 3012,
+  3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609,
+  4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195,
+  6393, 6590, 6787, 6983, 7180, 7376, 7571, 7767,
+  7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+  9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850,
+  11039, 11228, 11417, 11605, 11793, 11980, 12167, 12354,
+  12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+  14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+  15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673,
+  16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+  18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358,
+  19520, 19681, 19841, 20001, 20160, 20318, 20475, 20632,
+  20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+  22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028,
+  23170, 23312, 23453, 23593, 23732, 23870, 24008, 24144,
+  24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+  25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199,
+  26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+  27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+  28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803,
+  28899, 28993, 29086, 29178, 29269, 29359, 29448, 29535,
+  29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+  30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784,
+  30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298,
+  31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+  31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099,
+  32138, 32177, 32214, 32251, 32286, 32319, 32352, 32383,
+  32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+  32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718,
+  32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+  32767
+};
+
+/* The bits of every byte value in reverse order. */
+static const uint8_t bitrev_table[256] = {
+  0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0,
+  0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0,
+  0x08, 0x88, 0x48, 0xc8, 0x28, 0xa8, 0x68, 0xe8,
+  0x18, 0x98, 0x58, 0xd8, 0x38, 0xb8, 0x78, 0xf8,
+  0x04, 0x84, 0x44, 0xc4, 0x24, 0xa4, 0x64, 0xe4,
+  0x14, 0x94, 0x54, 0xd4, 0x34, 0xb4, 0x74, 0xf4,
+  0x0c, 0x8c, 0x4c, 0xcc, 0x2c, 0xac, 0x6c, 0xec,
+  0x1c, 0x9c, 0x5c, 0xdc, 0x3c, 0xbc, 0x7c, 0xfc,
+  0x02, 0x82, 0x42, 0xc2, 0x22, 0xa2, 0x62, 0xe2,
+  0x12, 0x92, 0x52, 0xd2, 0x32, 0xb2, 0x72, 0xf2,
+  0x0a, 0x8a, 0x4a, 0xca, 0x2a, 0xaa, 0x6a, 0xea,
+  0x1a, 0x9a, 0x5a, 0xda, 0x3a, 0xba, 0x7a, 0xfa,
+  0x06, 0x86, 0x46, 0xc6, 0x26, 0xa6, 0x66, 0xe6,
+  0x16, 0x96, 0x56, 0xd6, 0x36, 0xb6, 0x76, 0xf6,
+  0x0e, 0x8e, 0x4e, 0xce, 0x2e, 0xae, 0x6e, 0xee,
+  0x1e, 0x9e, 0x5e, 0xde, 0x3e, 0xbe, 0x7e, 0xfe,
+  0x01, 0x81, 0x41, 0xc1, 0x21, 0xa1, 0x61, 0xe1,
+  0x11, 0x91, 0x51, 0xd1, 0x31, 0xb1, 0x71, 0xf1,
+  0x09, 0x89, 0x49, 0xc9, 0x29, 0xa9, 0x69, 0xe9,
+  0x19, 0x99, 0x59, 0xd9, 0x39, 0xb9, 0x79, 0xf9,
+  0x05, 0x85, 0x45, 0xc5, 0x25, 0xa5, 0x65, 0xe5,
+  0x15, 0x95, 0x55, 0xd5, 0x35, 0xb5, 0x75, 0xf5,
+  0x0d, 0x8d, 0x4d, 0xcd, 0x2d, 0xad, 0x6d, 0xed,
+  0x1d, 0x9d, 0x5d, 0xdd, 0x3d, 0xbd, 0x7d, 0xfd,
+  0x03, 0x83, 0x43, 0xc3, 0x23, 0xa3, 0x63, 0xe3,
+  0x13, 0x93, 0x53, 0xd3, 0x33, 0xb3, 0x73, 0xf3,
+  0x0b, 0x8b, 0x4b, 0xcb, 0x2b, 0xab, 0x6b, 0xeb,
+  0x1b, 0x9b, 0x5b, 0xdb, 0x3b, 0xbb, 0x7b, 0xfb,
+  0x07, 0x87, 0x47, 0xc7, 0x27, 0xa7, 0x67, 0xe7,
+  0x17, 0x97, 0x57, 0xd7, 0x37, 0xb7, 0x77, 0xf7,
+  0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef,
+  0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff
+};
+/*---------------------------------------------------------------------------*/
+static int16_t
+sin_q15(uint16_t k)
+{
+  k &= TABLE_SIZE - 1;
+  if(k <= TABLE_SIZE / 4) {
+    return sin_table[k];
+  } else if(k <= TABLE_SIZE / 2) {
+    return sin_table[TABLE_SIZE / 2 - k];
+  } else if(k <= 3 * TABLE_SIZE / 4) {
+    return -sin_table[k - TABLE_SIZE / 2];
+  }
+  return -sin_table[TABLE_SIZE - k];
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+bitrev(uint16_t j, uint8_t shift)
+{
+  return (uint16_t)((bitrev_table[j & 0xff] << 8) | bitrev_table[j >> 8]) >>
+    shift;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+log2_of(uint16_t n)
+{
+  uint8_t log;
+
+  for(log = 0; n > 1; n >>= 1) {
+    ++log;
+  }
+  return log;
+}
+/*---------------------------------------------------------------------------*/
+void
+fft(int16_t re[], int16_t im[], uint16_t n)
+{
+#if FFT_CONF_ARCH
+  fft_arch(re, im, n);
+#else /* FFT_CONF_ARCH */
+  uint16_t i, j, k, half, size, step;
+  uint8_t shift;
+  int16_t t, wr, wi;
+  int32_t tr, ti;
+
+  /* Put the samples in bit-reversed order. */
+  shift = 16 - log2_of(n);
+  for(i = 0; i < n; ++i) {
+    j = bitrev(i, shift);
+    if(j > i) {
+      t = re[i];
+      re[i] = re[j];
+      re[j] = t;
+      t = im[i];
+      im[i] = im[j];
+      im[j] = t;
+    }
+  }
+
+  /* Butterfly stages, with all butterflies that share a twiddle
+     factor done together. */
+  for(size = 2; size <= n; size <<= 1) {
+    half = size >> 1;
+    step = TABLE_SIZE / size;
+    for(j = 0; j < half; ++j) {
+      wr = sin_q15(j * step + TABLE_SIZE / 4);
+      wi = -sin_q15(j * step);
+      for(i = j; i < n; i += size) {
+	k = i + half;
+	tr = ((int32_t)wr * re[k] - (int32_t)wi * im[k]) >> 15;
+	ti = ((int32_t)wr * im[k] + (int32_t)wi * re[k]) >> 15;
+	re[k] = (re[i] - tr) >> 1;
+	im[k] = (im[i] - ti) >> 1;
+	re[i] = (re[i] + tr) >> 1;
+	im[i] = (im[i] + ti) >> 1;
+      }
+    }
+  }
+#endif /* FFT_CONF_ARCH */
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+fft_sqrt(uint32_t v)
+{
+  uint32_t root, bit;
+
+  root = 0;
+  for(bit = 1UL << 30; bit > v; bit >>= 2);
+  for(; bit != 0; bit >>= 2) {
+    if(v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+  }
+  return root;
+}
+/*---------------------------------------------------------------------------*/
+void
+fft_spectrum(int16_t x[], int16_t work[], uint16_t n)
+{
+  uint16_t i;
+
+  for(i = 0; i < n; ++i) {
+    work[i] = 0;
+  }
+  fft(x, work, n);
+  for(i = 0; i <= n / 2; ++i) {
+    x[i] = fft_sqrt((int32_t)x[i] * x[i] + (int32_t)work[i] * work[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int16_t
+fft_remove_dc(int16_t x[], uint16_t n)
+{
+  int32_t sum;
+  uint16_t i;
+  int16_t mean;
+
+  sum = 0;
+  for(i = 0; i < n; ++i) {
+    sum += x[i];
+  }
+  mean = sum / n;
+  for(i = 0; i < n; ++i) {
+    x[i] -= mean;
+  }
+  return mean;
+}
+/*---------------------------------------------------------------------------*/
+void
+fft_window_hann(int16_t x[], uint16_t n)
+{
+  uint16_t i, step;
+  int32_t w;
+
+  /* w(i) = (1 - cos(2 * pi * i / n)) / 2 */
+  step = TABLE_SIZE / n;
+  for(i = 0; i < n; ++i) {
+    w = (32768L - sin_q15(i * step + TABLE_SIZE / 4)) >> 1;
+    x[i] = ((int32_t)x[i] * w) >> 15;
+  }
+}
+/*---------------------------------------------------------------------------*/
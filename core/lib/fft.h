@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \addtogroup lib
+ * @{
+ */
+
+/**
+ * \defgroup fft Fixed-point FFT and spectrum helpers
+ *
+ * A forward radix-2 FFT on 16-bit fixed-point data, and helpers to
+ * compute the magnitude spectrum of a block of sensor samples.
+ *
+ * The twiddle factors come from a constant quarter-wave sine table,
+ * and the bit-reversed order from a constant 256 entry table, so no
+ * trigonometry is done at run time. Transforms of up to FFT_MAX_SIZE
+ * points are supported.
+ *
+ * Every butterfly stage scales its output by 1/2, so the transform
+ * cannot overflow: the result is the discrete Fourier transform
+ * divided by n. A full-scale sine wave gives two bins with half its
+ * amplitude.
+ *
+ * A platform with a DSP library or hardware support, such as
+ * CMSIS-DSP on Cortex-M, can set FFT_CONF_ARCH and provide
+ * fft_arch() with the same scaling, which fft() then uses.
+ * @{
+ */
+
+/**
+ * \file
+ *         Fixed-point FFT and spectrum helpers
+ */
+
+#ifndef __FFT_H__
+#define __FFT_H__
+
+#include "contiki-conf.h"
+
+/** The largest number of points that fft() can transform. */
+#define FFT_MAX_SIZE 1024
+
+/**
+ * \brief      Forward FFT
+ * \param re   The real parts of the samples, replaced by the real parts of the result
+ * \param im   The imaginary parts of the samples, replaced by the imaginary parts of the result
+ * \param n    The number of points, a power of two from 2 to FFT_MAX_SIZE
+ *
+ *             The result is in natural order and scaled by 1/n.
+ */
+void fft(int16_t re[], int16_t im[], uint16_t n);
+
+/**
+ * \brief      Magnitude spectrum of real samples
+ * \param x    The samples, replaced by the spectrum
+ * \param work An array of n int16_t used during the computation
+ * \param n    The number of samples, a power of two from 2 to FFT_MAX_SIZE
+ *
+ *             After the call, x[0] to x[n / 2] hold the magnitudes
+ *             of the frequency bins from DC up to half the sampling
+ *             rate, scaled like the result of fft().
+ */
+void fft_spectrum(int16_t x[], int16_t work[], uint16_t n);
+
+/**
+ * \brief      Remove the DC component from samples
+ * \param x    The samples
+ * \param n    The number of samples
+ * \return     The mean that was subtracted
+ */
+int16_t fft_remove_dc(int16_t x[], uint16_t n);
+
+/**
+ * \brief      Apply a Hann window to samples
+ * \param x    The samples
+ * \param n    The number of samples, a power of two from 2 to FFT_MAX_SIZE
+ *
+ *             Windowing reduces the leakage of a strong frequency
+ *             into neighbouring bins.
+ */
+void fft_window_hann(int16_t x[], uint16_t n);
+
+/**
+ * \brief      Integer square root
+ * \param v    The value
+ * \return     The square root of v, rounded down
+ */
+uint16_t fft_sqrt(uint32_t v);
+
+#if FFT_CONF_ARCH
+void fft_arch(int16_t re[], int16_t im[], uint16_t n);
+#endif /* FFT_CONF_ARCH */
+
+#endif /* __FFT_H__ */
+
+/** @} */
+/** @} */
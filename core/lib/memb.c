@@ -43,16 +43,64 @@
  * \author Adam Dunkels <adam@sics.se>
  */
 #include <string.h>
+#include <stdio.h>
 
 #include "contiki.h"
 #include "lib/memb.h"
 
+#if MEMB_STATS
+static struct memb *stats_list;
+#endif /* MEMB_STATS */
+
+#if MEMB_BITMAP
+/*---------------------------------------------------------------------------*/
+static int
+first_zero(unsigned int word)
+{
+#ifdef __GNUC__
+  return __builtin_ctz(~word);
+#else /* __GNUC__ */
+  int i;
+
+  for(i = 0; word & 1; i++) {
+    word >>= 1;
+  }
+  return i;
+#endif /* __GNUC__ */
+}
+#endif /* MEMB_BITMAP */
+#if MEMB_STATS
+#define MEMB_STATS_ALLOC(m) do {                 \
+    if(++(m)->in_use > (m)->max_in_use) {        \
+      (m)->max_in_use = (m)->in_use;             \
+    }                                            \
+  } while(0)
+#else /* MEMB_STATS */
+#define MEMB_STATS_ALLOC(m)
+#endif /* MEMB_STATS */
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_BITMAP
+  memset(m->used, 0, MEMB_BITMAP_WORDS(m->num) * sizeof(unsigned int));
+#endif /* MEMB_BITMAP */
+#if MEMB_STATS
+  {
+    struct memb *s;
+
+    m->in_use = 0;
+
+    /* Memory blocks may be initialized more than once. */
+    for(s = stats_list; s != NULL && s != m; s = s->stats_next);
+    if(s == NULL) {
+      m->stats_next = stats_list;
+      stats_list = m;
+    }
+  }
+#endif /* MEMB_STATS */
 }
 /*---------------------------------------------------------------------------*/
 void *
@@ -60,18 +108,39 @@ memb_alloc(struct memb *m)
 {
   int i;
 
+#if MEMB_BITMAP
+  int w;
+
+  for(w = 0; w < MEMB_BITMAP_WORDS(m->num); ++w) {
+    if(m->used[w] != ~0U) {
+      i = w * MEMB_BITMAP_BITS + first_zero(m->used[w]);
+      if(i >= m->num) {
+	break;
+      }
+      m->used[w] |= 1U << (i % MEMB_BITMAP_BITS);
+      ++(m->count[i]);
+      MEMB_STATS_ALLOC(m);
+      return (void *)((char *)m->mem + (i * m->size));
+    }
+  }
+#else /* MEMB_BITMAP */
   for(i = 0; i < m->num; ++i) {
     if(m->count[i] == 0) {
       /* If this block was unused, we increase the reference count to
 	 indicate that it now is used and return a pointer to the
 	 memory block. */
       ++(m->count[i]);
+      MEMB_STATS_ALLOC(m);
       return (void *)((char *)m->mem + (i * m->size));
     }
   }
+#endif /* MEMB_BITMAP */
 
   /* No free block was found, so we return NULL to indicate failure to
      allocate block. */
+#if MEMB_STATS
+  m->failures++;
+#endif /* MEMB_STATS */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -79,25 +148,35 @@ char
 memb_free(struct memb *m, void *ptr)
 {
   int i;
-  char *ptr2;
+  unsigned int offset;
 
-  /* Walk through the list of blocks and try to find the block to
-     which the pointer "ptr" points to. */
-  ptr2 = (char *)m->mem;
-  for(i = 0; i < m->num; ++i) {
-    
-    if(ptr2 == (char *)ptr) {
-      /* We've found to block to which "ptr" points so we decrease the
-	 reference count and return the new value of it. */
-      if(m->count[i] > 0) {
-	/* Make sure that we don't deallocate free memory. */
-	--(m->count[i]);
-      }
-      return m->count[i];
+  /* Find the block to which "ptr" points from its offset in the
+     memory of the blocks. */
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  i = offset / m->size;
+
+  /* Decrease the reference count and return the new value of it. */
+  if(m->count[i] > 0) {
+    /* Make sure that we don't deallocate free memory. */
+    --(m->count[i]);
+#if MEMB_BITMAP
+    if(m->count[i] == 0) {
+      m->used[i / MEMB_BITMAP_BITS] &= ~(1U << (i % MEMB_BITMAP_BITS));
+    }
+#endif /* MEMB_BITMAP */
+#if MEMB_STATS
+    if(m->count[i] == 0) {
+      m->in_use--;
     }
-    ptr2 += m->size;
+#endif /* MEMB_STATS */
   }
-  return -1;
+  return m->count[i];
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -107,5 +186,25 @@ memb_inmemb(struct memb *m, void *ptr)
     (char *)ptr < (char *)m->mem + (m->num * m->size);
 }
 /*---------------------------------------------------------------------------*/
+#if MEMB_STATS
+struct memb *
+memb_stats_list_head(void)
+{
+  return stats_list;
+}
+/*---------------------------------------------------------------------------*/
+void
+memb_stats_print(void)
+{
+  struct memb *m;
+
+  printf("memb name size num in_use max_in_use failures\n");
+  for(m = stats_list; m != NULL; m = m->stats_next) {
+    printf("memb %s %u %u %u %u %u\n", m->name,
+           m->size, m->num, m->in_use, m->max_in_use, m->failures);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* MEMB_STATS */
 
 /** @} */
@@ -86,19 +86,74 @@ MEMB(connections, struct connection, 16);
  * \param num The total number of memory chunks in the block.
  *
  */
+#ifdef MEMB_CONF_BITMAP
+#define MEMB_BITMAP MEMB_CONF_BITMAP
+#else /* MEMB_CONF_BITMAP */
+#define MEMB_BITMAP 1
+#endif /* MEMB_CONF_BITMAP */
+
+#ifdef MEMB_CONF_STATS
+#define MEMB_STATS MEMB_CONF_STATS
+#else /* MEMB_CONF_STATS */
+#define MEMB_STATS 0
+#endif /* MEMB_CONF_STATS */
+
+#if MEMB_STATS
+/* The name of the memory block, followed by the usage counters that
+   start out as zero. */
+#define MEMB_STATS_INIT(name) , #name
+#define MEMB_STATS_FIELDS \
+  const char *name; \
+  struct memb *stats_next; \
+  unsigned short in_use; \
+  unsigned short max_in_use; \
+  unsigned short failures;
+#else /* MEMB_STATS */
+#define MEMB_STATS_INIT(name)
+#define MEMB_STATS_FIELDS
+#endif /* MEMB_STATS */
+
+#if MEMB_BITMAP
+/* One bit per block, set when the block is in use, so that
+   memb_alloc() can find a free block a word at a time. */
+#define MEMB_BITMAP_BITS (sizeof(unsigned int) * 8)
+#define MEMB_BITMAP_WORDS(num) (((num) + MEMB_BITMAP_BITS - 1) / MEMB_BITMAP_BITS)
+
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static unsigned int CC_CONCAT(name,_memb_used)[MEMB_BITMAP_WORDS(num)]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          CC_CONCAT(name,_memb_used) \
+                                          MEMB_STATS_INIT(name)}
 
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+  unsigned int *used;
+  MEMB_STATS_FIELDS
 };
+#else /* MEMB_BITMAP */
+#define MEMB(name, structure, num) \
+        static char CC_CONCAT(name,_memb_count)[num]; \
+        static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static struct memb name = {sizeof(structure), num, \
+                                          CC_CONCAT(name,_memb_count), \
+                                          (void *)CC_CONCAT(name,_memb_mem) \
+                                          MEMB_STATS_INIT(name)}
+
+struct memb {
+  unsigned short size;
+  unsigned short num;
+  char *count;
+  void *mem;
+  MEMB_STATS_FIELDS
+};
+#endif /* MEMB_BITMAP */
 
 /**
  * Initialize a memory block that was declared with MEMB().
@@ -130,6 +185,25 @@ char  memb_free(struct memb *m, void *ptr);
 
 int memb_inmemb(struct memb *m, void *ptr);
 
+#if MEMB_STATS
+/**
+ * Get the first of the memory blocks that have been initialized with
+ * memb_init(), to iterate through their usage counters.
+ *
+ * When MEMB_CONF_STATS is set, each memory block keeps track of the
+ * number of blocks in use (in_use), the largest number of blocks
+ * that have been in use at the same time (max_in_use) and the number
+ * of calls to memb_alloc() that failed because the memory block was
+ * exhausted (failures).
+ */
+struct memb *memb_stats_list_head(void);
+
+/**
+ * Print the usage counters of all initialized memory blocks.
+ */
+void memb_stats_print(void);
+#endif /* MEMB_STATS */
+
 
 /** @} */
 /** @} */
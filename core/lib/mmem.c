@@ -55,9 +55,19 @@
 #define MMEM_SIZE 4096
 #endif
 
+/* With lazy compaction, mmem_free() leaves a gap where the block was.
+   Allocations go into the first gap that fits, and blocks are moved
+   only when no gap is large enough, and then only until one is. */
+#ifdef MMEM_CONF_LAZY_COMPACTION
+#define MMEM_LAZY_COMPACTION MMEM_CONF_LAZY_COMPACTION
+#else
+#define MMEM_LAZY_COMPACTION 1
+#endif
+
 LIST(mmemlist);
 unsigned int avail_memory;
 static char memory[MMEM_SIZE];
+static unsigned int compactions;
 
 /*---------------------------------------------------------------------------*/
 /**
@@ -78,15 +88,61 @@ static char memory[MMEM_SIZE];
  *             macro MMEM_PTR() is used to get a pointer to the
  *             allocated memory.
  *
+ *             \note With MMEM_CONF_LAZY_COMPACTION (the default),
+ *             this function may move other blocks to make room, so
+ *             pointers obtained with MMEM_PTR() before the call are
+ *             no longer valid after it.
+ *
  */
 int
 mmem_alloc(struct mmem *m, unsigned int size)
 {
+#if MMEM_LAZY_COMPACTION
+  struct mmem *n, *prev;
+  char *start;
+#endif /* MMEM_LAZY_COMPACTION */
+
   /* Check if we have enough memory left for this allocation. */
   if(avail_memory < size) {
     return 0;
   }
 
+#if MMEM_LAZY_COMPACTION
+  /* The list is kept in address order. Find the first gap between
+     two blocks, or after the last block, that fits. */
+  prev = NULL;
+  start = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    if((unsigned int)((char *)n->ptr - start) >= size) {
+      break;
+    }
+    start = (char *)n->ptr + n->size;
+    prev = n;
+  }
+
+  if(n == NULL && (unsigned int)(&memory[MMEM_SIZE] - start) < size) {
+    /* No gap is large enough. Move blocks downwards, closing the
+       gaps between them, until the gap in front of a block fits. If
+       none does, all free memory ends up after the last block. */
+    ++compactions;
+    prev = NULL;
+    start = memory;
+    for(n = list_head(mmemlist); n != NULL; n = n->next) {
+      if((unsigned int)((char *)n->ptr - start) >= size) {
+	break;
+      }
+      if(n->ptr != start) {
+	memmove(start, n->ptr, n->size);
+	n->ptr = start;
+      }
+      start += n->size;
+      prev = n;
+    }
+  }
+
+  list_insert(mmemlist, prev, m);
+  m->ptr = start;
+#else /* MMEM_LAZY_COMPACTION */
   /* We had enough memory so we add this memory block to the end of
      the list of allocated memory blocks. */
   list_add(mmemlist, m);
@@ -94,6 +150,7 @@ mmem_alloc(struct mmem *m, unsigned int size)
   /* Set up the pointer so that it points to the first available byte
      in the memory block. */
   m->ptr = &memory[MMEM_SIZE - avail_memory];
+#endif /* MMEM_LAZY_COMPACTION */
 
   /* Remember the size of this memory block. */
   m->size = size;
@@ -118,6 +175,7 @@ mmem_alloc(struct mmem *m, unsigned int size)
 void
 mmem_free(struct mmem *m)
 {
+#if !MMEM_LAZY_COMPACTION
   struct mmem *n;
 
   if(m->next != NULL) {
@@ -132,6 +190,7 @@ mmem_free(struct mmem *m)
       n->ptr = (void *)((char *)n->ptr - m->size);
     }
   }
+#endif /* !MMEM_LAZY_COMPACTION */
 
   avail_memory += m->size;
 
@@ -153,6 +212,45 @@ mmem_init(void)
 {
   list_init(mmemlist);
   avail_memory = MMEM_SIZE;
+  compactions = 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get fragmentation statistics
+ * \param stats A pointer to a struct mmem_stats that is filled in
+ *
+ *             The amount of free memory, the largest block that can
+ *             currently be allocated without moving any memory, the
+ *             number of free gaps, and the number of times memory has
+ *             been compacted.
+ *
+ */
+void
+mmem_stats(struct mmem_stats *stats)
+{
+  struct mmem *n;
+  char *start;
+  unsigned int gap;
+
+  stats->avail = avail_memory;
+  stats->largest = 0;
+  stats->fragments = 0;
+  stats->compactions = compactions;
+
+  start = memory;
+  for(n = list_head(mmemlist); ; n = n->next) {
+    gap = (n != NULL ? (char *)n->ptr : &memory[MMEM_SIZE]) - start;
+    if(gap > 0) {
+      ++stats->fragments;
+      if(gap > stats->largest) {
+	stats->largest = gap;
+      }
+    }
+    if(n == NULL) {
+      break;
+    }
+    start = (char *)n->ptr + n->size;
+  }
 }
 /*---------------------------------------------------------------------------*/
 
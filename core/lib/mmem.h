@@ -39,11 +39,18 @@
  *
  * The managed memory allocator is a fragmentation-free memory
  * manager. It keeps the allocated memory free from fragmentation by
- * compacting the memory when blocks are freed. A program that uses
+ * compacting the memory when an allocation does not otherwise fit,
+ * or, with MMEM_CONF_LAZY_COMPACTION set to 0, whenever a block is
+ * freed. A program that uses
  * the managed memory module cannot be sure that allocated memory
  * stays in place. Therefore, a level of indirection is used: access
  * to allocated memory must always be done using a special macro.
  *
+ * \note By default, blocks are moved by mmem_alloc(), not by
+ * mmem_free(). Code written for the old allocator, which only moved
+ * blocks when one was freed, must fetch MMEM_PTR() again after every
+ * mmem_alloc(), or set MMEM_CONF_LAZY_COMPACTION to 0.
+ *
  * \note This module has not been heavily tested.
  * @{
  */
@@ -80,12 +87,20 @@ struct mmem {
   void *ptr;
 };
 
+struct mmem_stats {
+  unsigned int avail;
+  unsigned int largest;
+  unsigned int fragments;
+  unsigned int compactions;
+};
+
 /* XXX: tagga minne med "interrupt usage", vilke gr att man r
    speciellt varsam under free(). */
 
 int  mmem_alloc(struct mmem *m, unsigned int size);
 void mmem_free(struct mmem *);
 void mmem_init(void);
+void mmem_stats(struct mmem_stats *stats);
 
 #endif /* __MMEM_H__ */
 
@@ -56,7 +56,7 @@ void
 print_stats(void)
 {
 #if RIMESTATS_CONF_ENABLED
-  PRINTA("S %d.%d clock %lu tx %lu rx %lu rtx %lu rrx %lu rexmit %lu acktx %lu noacktx %lu ackrx %lu timedout %lu badackrx %lu toolong %lu tooshort %lu badsynch %lu badcrc %lu contentiondrop %lu sendingdrop %lu lltx %lu llrx %lu\n",
+  PRINTA("S %d.%d clock %lu tx %lu rx %lu rtx %lu rrx %lu rexmit %lu acktx %lu noacktx %lu ackrx %lu timedout %lu badackrx %lu toolong %lu tooshort %lu badsynch %lu badcrc %lu contentiondrop %lu sendingdrop %lu foreigndrop %lu lltx %lu llrx %lu\n",
 	 rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
 	 clock_seconds(),
 	 RIMESTATS_GET(tx), RIMESTATS_GET(rx),
@@ -66,6 +66,7 @@ print_stats(void)
 	 RIMESTATS_GET(toolong), RIMESTATS_GET(tooshort),
 	 RIMESTATS_GET(badsynch), RIMESTATS_GET(badcrc),
 	 RIMESTATS_GET(contentiondrop), RIMESTATS_GET(sendingdrop),
+	 RIMESTATS_GET(foreigndrop),
 	 RIMESTATS_GET(lltx), RIMESTATS_GET(llrx));
 #endif /* RIMESTATS_CONF_ENABLED */
 #if ENERGEST_CONF_ON
@@ -38,9 +38,21 @@
  */
 
 #include "lib/ringbuf.h"
+#include <string.h>
+
+/* Orders the data copies against the index update that publishes
+   them. A compiler barrier is enough when producer and consumer run
+   on the same core, such as an interrupt handler and a process. */
+#ifdef RINGBUF_CONF_BARRIER
+#define BARRIER() RINGBUF_CONF_BARRIER()
+#elif defined(__GNUC__)
+#define BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define BARRIER()
+#endif
 /*---------------------------------------------------------------------------*/
 void
-ringbuf_init(struct ringbuf *r, uint8_t *dataptr, uint8_t size)
+ringbuf_init(struct ringbuf *r, uint8_t *dataptr, unsigned int size)
 {
   r->data = dataptr;
   r->mask = size - 1;
@@ -51,41 +63,43 @@ ringbuf_init(struct ringbuf *r, uint8_t *dataptr, uint8_t size)
 int
 ringbuf_put(struct ringbuf *r, uint8_t c)
 {
+  ringbuf_index_t put_ptr = r->put_ptr;
+
   /* Check if buffer is full. If it is full, return 0 to indicate that
      the element was not inserted into the buffer.
 
-     XXX: there is a potential risk for a race condition here, because
-     the ->get_ptr field may be written concurrently by the
-     ringbuf_get() function. To avoid this, access to ->get_ptr must
-     be atomic. We use an uint8_t type, which makes access atomic on
-     most platforms, but C does not guarantee this.
+     The ->get_ptr field may be written concurrently by the
+     ringbuf_get() function, so access to it must be atomic; see
+     ringbuf_index_t in ringbuf.h.
   */
-  if(((r->put_ptr - r->get_ptr) & r->mask) == r->mask) {
+  if(((put_ptr - r->get_ptr) & r->mask) == r->mask) {
     return 0;
   }
-  r->data[r->put_ptr] = c;
-  r->put_ptr = (r->put_ptr + 1) & r->mask;
+  r->data[put_ptr] = c;
+  BARRIER();
+  r->put_ptr = (put_ptr + 1) & r->mask;
   return 1;
 }
 /*---------------------------------------------------------------------------*/
 int
 ringbuf_get(struct ringbuf *r)
 {
+  ringbuf_index_t get_ptr = r->get_ptr;
   uint8_t c;
-  
+
   /* Check if there are bytes in the buffer. If so, we return the
      first one and increase the pointer. If there are no bytes left, we
      return -1.
 
-     XXX: there is a potential risk for a race condition here, because
-     the ->put_ptr field may be written concurrently by the
-     ringbuf_put() function. To avoid this, access to ->get_ptr must
-     be atomic. We use an uint8_t type, which makes access atomic on
-     most platforms, but C does not guarantee this.
+     The ->put_ptr field may be written concurrently by the
+     ringbuf_put() function, so access to it must be atomic; see
+     ringbuf_index_t in ringbuf.h.
   */
-  if(((r->put_ptr - r->get_ptr) & r->mask) > 0) {
-    c = r->data[r->get_ptr];
-    r->get_ptr = (r->get_ptr + 1) & r->mask;
+  if(((r->put_ptr - get_ptr) & r->mask) > 0) {
+    BARRIER();
+    c = r->data[get_ptr];
+    BARRIER();
+    r->get_ptr = (get_ptr + 1) & r->mask;
     return c;
   } else {
     return -1;
@@ -93,6 +107,71 @@ ringbuf_get(struct ringbuf *r)
 }
 /*---------------------------------------------------------------------------*/
 int
+ringbuf_write(struct ringbuf *r, const uint8_t *data, int len)
+{
+  ringbuf_index_t put_ptr = r->put_ptr;
+  int space, first;
+
+  space = (r->get_ptr - put_ptr - 1) & r->mask;
+  if(len > space) {
+    len = space;
+  }
+  first = r->mask + 1 - put_ptr;
+  if(first > len) {
+    first = len;
+  }
+  memcpy(&r->data[put_ptr], data, first);
+  memcpy(&r->data[0], data + first, len - first);
+  BARRIER();
+  r->put_ptr = (put_ptr + len) & r->mask;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+ringbuf_read(struct ringbuf *r, uint8_t *data, int len)
+{
+  ringbuf_index_t get_ptr = r->get_ptr;
+  int avail, first;
+
+  avail = (r->put_ptr - get_ptr) & r->mask;
+  if(len > avail) {
+    len = avail;
+  }
+  first = r->mask + 1 - get_ptr;
+  if(first > len) {
+    first = len;
+  }
+  BARRIER();
+  memcpy(data, &r->data[get_ptr], first);
+  memcpy(data + first, &r->data[0], len - first);
+  BARRIER();
+  r->get_ptr = (get_ptr + len) & r->mask;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+ringbuf_peek(struct ringbuf *r, uint8_t **data)
+{
+  ringbuf_index_t get_ptr = r->get_ptr;
+  int avail;
+
+  avail = (r->put_ptr - get_ptr) & r->mask;
+  if(avail > r->mask + 1 - get_ptr) {
+    avail = r->mask + 1 - get_ptr;
+  }
+  BARRIER();
+  *data = &r->data[get_ptr];
+  return avail;
+}
+/*---------------------------------------------------------------------------*/
+void
+ringbuf_consume(struct ringbuf *r, int len)
+{
+  BARRIER();
+  r->get_ptr = (r->get_ptr + len) & r->mask;
+}
+/*---------------------------------------------------------------------------*/
+int
 ringbuf_size(struct ringbuf *r)
 {
   return r->mask + 1;
@@ -55,6 +55,18 @@
 
 #include "contiki-conf.h"
 
+/*
+ * The index type bounds the size of a ring buffer. Reads and writes
+ * of the index must be atomic on the target, since the producer and
+ * the consumer (typically an interrupt handler and a process) update
+ * them without locking. 8-bit CPUs should set this to uint8_t.
+ */
+#ifdef RINGBUF_CONF_INDEX_T
+typedef RINGBUF_CONF_INDEX_T ringbuf_index_t;
+#else
+typedef uint16_t ringbuf_index_t;
+#endif
+
 /**
  * \brief      Structure that holds the state of a ring buffer.
  *
@@ -66,10 +78,11 @@
  */
 struct ringbuf {
   uint8_t *data;
-  uint8_t mask;
-  
-  /* XXX these must be 8-bit quantities to avoid race conditions. */
-  uint8_t put_ptr, get_ptr;
+  ringbuf_index_t mask;
+
+  /* put_ptr is only written by the producer and get_ptr only by the
+     consumer. */
+  volatile ringbuf_index_t put_ptr, get_ptr;
 };
 
 /**
@@ -81,12 +94,13 @@ struct ringbuf {
  *             This function initiates a ring buffer. The data in the
  *             buffer is stored in an external array, to which a
  *             pointer must be supplied. The size of the ring buffer
- *             must be a power of two and cannot be larger than 128
- *             bytes.
+ *             must be a power of two and no larger than what
+ *             ringbuf_index_t can index (256 bytes for uint8_t). One
+ *             byte of the buffer is always kept free.
  *
  */
 void    ringbuf_init(struct ringbuf *r, uint8_t *a,
-		     uint8_t size_power_of_two);
+		     unsigned int size_power_of_two);
 
 /**
  * \brief      Insert a byte into the ring buffer
@@ -128,4 +142,53 @@ int     ringbuf_size(struct ringbuf *r);
  */
 int     ringbuf_elements(struct ringbuf *r);
 
+/**
+ * \brief      Insert a block of bytes into the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param data The bytes to be written to the buffer
+ * \param len  The number of bytes to write
+ * \return     The number of bytes written, which is less than len if the buffer filled up
+ *
+ *             This function copies as much of data as fits into the
+ *             ring buffer with at most two memcpy()s, and makes the
+ *             bytes visible to the consumer all at once. It may be
+ *             called from the producer side only.
+ *
+ */
+int     ringbuf_write(struct ringbuf *r, const uint8_t *data, int len);
+
+/**
+ * \brief      Remove a block of bytes from the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param data A buffer to copy the bytes to
+ * \param len  The size of the buffer
+ * \return     The number of bytes read, or zero if the buffer was empty
+ *
+ *             This function may be called from the consumer side only.
+ *
+ */
+int     ringbuf_read(struct ringbuf *r, uint8_t *data, int len);
+
+/**
+ * \brief      Get the contiguous bytes at the head of the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param data Set to point at the first byte in the buffer
+ * \return     The number of bytes that can be read at *data
+ *
+ *             This function lets the consumer work on the buffered
+ *             data in place. The bytes stay in the buffer until they
+ *             are released with ringbuf_consume(). If the data wraps
+ *             around the end of the buffer, only the part before the
+ *             end is returned.
+ *
+ */
+int     ringbuf_peek(struct ringbuf *r, uint8_t **data);
+
+/**
+ * \brief      Release bytes returned by ringbuf_peek()
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param len  The number of bytes to remove from the head of the buffer
+ */
+void    ringbuf_consume(struct ringbuf *r, int len);
+
 #endif /* __RINGBUF_H__ */
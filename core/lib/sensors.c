@@ -118,18 +118,32 @@ PROCESS_THREAD(sensors_process, ev, data)
 
     PROCESS_WAIT_EVENT();
 
-    do {
-      events = 0;
-      for(i = 0; i < num_sensors; ++i) {
-	if(sensors_flags[i] & FLAG_CHANGED) {
-	  if(process_post(PROCESS_BROADCAST, sensors_event, (void *)sensors[i]) == PROCESS_ERR_OK) {
-	    PROCESS_WAIT_EVENT_UNTIL(ev == sensors_event);
-	  }
-	  sensors_flags[i] &= ~FLAG_CHANGED;
-	  events++;
+    /* Deliver at most one event per changed sensor in each pass. The
+       flag is cleared before the event is posted, so that a change
+       during the delivery is reported in the next pass instead of
+       being lost. */
+    events = 0;
+    for(i = 0; i < num_sensors; ++i) {
+      if(sensors_flags[i] & FLAG_CHANGED) {
+	sensors_flags[i] &= ~FLAG_CHANGED;
+	if(process_post(PROCESS_BROADCAST, sensors_event, (void *)sensors[i]) == PROCESS_ERR_OK) {
+	  PROCESS_WAIT_EVENT_UNTIL(ev == sensors_event);
+	} else {
+	  sensors_flags[i] |= FLAG_CHANGED;
 	}
       }
-    } while(events);
+    }
+
+    /* Changes that came in during this pass; their polls were consumed
+       while we waited for our events. Let other processes run first. */
+    for(i = 0; i < num_sensors; ++i) {
+      if(sensors_flags[i] & FLAG_CHANGED) {
+	events++;
+      }
+    }
+    if(events) {
+      process_poll(&sensors_process);
+    }
   }
 
   PROCESS_END();
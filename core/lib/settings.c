@@ -78,6 +78,343 @@ typedef struct {
   settings_key_t key;
 } item_header_t;
 
+/** Key of an item that has been superseded or deleted in place. */
+#define SETTINGS_DELETED_KEY	0x0000
+
+#if SETTINGS_CONF_INDEX_SIZE
+/* RAM index of the items in the store, in store order, so that
+ * lookups do not have to walk the EEPROM. If the store holds more
+ * items than fit, lookups that miss in the index continue in EEPROM
+ * after the last indexed item.
+ */
+typedef struct {
+  settings_key_t key;
+  settings_iter_t iter;
+} index_entry_t;
+
+static index_entry_t item_index[SETTINGS_CONF_INDEX_SIZE];
+static uint8_t index_count;
+
+#define INDEX_STALE	0
+#define INDEX_COMPLETE	1
+#define INDEX_PARTIAL	2
+static uint8_t index_state;
+
+/* The last item in the store, where settings_add() appends. */
+static settings_iter_t last_iter;
+#endif /* SETTINGS_CONF_INDEX_SIZE */
+
+#if SETTINGS_CONF_BATCH_SIZE
+/* Values passed to settings_set() between settings_batch_begin() and
+ * settings_batch_end(). Each record is a key, a one-byte length and
+ * the value. Setting a key again replaces its pending record.
+ */
+static uint8_t batch_buf[SETTINGS_CONF_BATCH_SIZE];
+static uint16_t batch_len;
+static uint8_t batching;
+#define BATCH_RECORD_HDR	(sizeof(settings_key_t) + 1)
+#endif /* SETTINGS_CONF_BATCH_SIZE */
+
+/*****************************************************************************/
+// MARK: - Private Functions
+/*****************************************************************************/
+
+#if SETTINGS_CONF_INDEX_SIZE
+/*---------------------------------------------------------------------------*/
+static void
+index_add(settings_iter_t iter)
+{
+  settings_key_t key = settings_iter_get_key(iter);
+
+  last_iter = iter;
+
+  if(key == SETTINGS_DELETED_KEY || index_state == INDEX_PARTIAL) {
+    return;
+  }
+
+  if(index_count < SETTINGS_CONF_INDEX_SIZE) {
+    item_index[index_count].key = key;
+    item_index[index_count].iter = iter;
+    index_count++;
+  } else {
+    index_state = INDEX_PARTIAL;
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+index_reset(void)
+{
+  index_count = 0;
+  index_state = INDEX_COMPLETE;
+  last_iter = EEPROM_NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+index_build(void)
+{
+  settings_iter_t iter;
+
+  index_reset();
+  for(iter = settings_iter_begin(); iter; iter = settings_iter_next(iter)) {
+    index_add(iter);
+  }
+}
+#endif /* SETTINGS_CONF_INDEX_SIZE */
+
+/*---------------------------------------------------------------------------*/
+static settings_iter_t
+find_item(settings_key_t key, uint8_t index)
+{
+  settings_iter_t iter;
+
+#if SETTINGS_CONF_INDEX_SIZE
+  uint8_t i;
+
+  if(index_state == INDEX_STALE) {
+    index_build();
+  }
+
+  for(i = 0; i < index_count; i++) {
+    if(item_index[i].key == key) {
+      if(!index) {
+        return item_index[i].iter;
+      }
+      index--;
+    }
+  }
+
+  if(index_state == INDEX_COMPLETE) {
+    return EEPROM_NULL;
+  }
+
+  iter = settings_iter_next(item_index[index_count - 1].iter);
+#else
+  iter = settings_iter_begin();
+#endif /* SETTINGS_CONF_INDEX_SIZE */
+
+  for(; iter; iter = settings_iter_next(iter)) {
+    if(settings_iter_get_key(iter) == key) {
+      if(!index) {
+        break;
+      }
+      index--;
+    }
+  }
+
+  return iter;
+}
+
+/*---------------------------------------------------------------------------*/
+static settings_iter_t
+find_last_item(void)
+{
+  settings_iter_t iter;
+
+#if SETTINGS_CONF_INDEX_SIZE
+  if(index_state == INDEX_STALE) {
+    index_build();
+  }
+  iter = last_iter;
+#else
+  for(iter = settings_iter_begin(); settings_iter_next(iter);
+      iter = settings_iter_next(iter)) {
+    /* This block intentionally left blank. */
+  }
+#endif /* SETTINGS_CONF_INDEX_SIZE */
+
+  return iter;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Checks whether the item already holds the given value, so that
+ * rewriting the same value costs EEPROM reads instead of writes.
+ */
+static uint8_t
+value_is_equal(settings_iter_t iter, const uint8_t *value,
+               settings_length_t value_size)
+{
+  uint8_t buf[16];
+  eeprom_addr_t addr;
+  settings_length_t len;
+
+  if(settings_iter_get_value_length(iter) != value_size) {
+    return 0;
+  }
+
+  addr = settings_iter_get_value_addr(iter);
+  while(value_size) {
+    len = MIN(value_size, sizeof(buf));
+    eeprom_read(addr, buf, len);
+    if(memcmp(buf, value, len) != 0) {
+      return 0;
+    }
+    addr += len;
+    value += len;
+    value_size -= len;
+  }
+
+  return 1;
+}
+
+#if SETTINGS_CONF_APPEND_LOG
+/*---------------------------------------------------------------------------*/
+/* Marks an item as deleted by clearing its key. This only clears
+ * bits, so it also works on flash without erasing.
+ */
+static void
+mark_deleted(settings_iter_t iter)
+{
+  const settings_key_t key = SETTINGS_DELETED_KEY;
+#if SETTINGS_CONF_INDEX_SIZE
+  uint8_t i;
+#endif
+
+  eeprom_write(iter - sizeof(key), (uint8_t *)&key, sizeof(key));
+
+#if SETTINGS_CONF_INDEX_SIZE
+  for(i = 0; i < index_count; i++) {
+    if(item_index[i].iter == iter) {
+      index_count--;
+      memmove(&item_index[i], &item_index[i + 1],
+              (index_count - i) * sizeof(index_entry_t));
+      break;
+    }
+  }
+  if(index_state == INDEX_PARTIAL) {
+    /* An item that did not fit may fit now. */
+    index_state = INDEX_STALE;
+  }
+#endif /* SETTINGS_CONF_INDEX_SIZE */
+}
+#endif /* SETTINGS_CONF_APPEND_LOG */
+
+/*---------------------------------------------------------------------------*/
+static settings_status_t
+set_item(settings_key_t key, const uint8_t *value,
+         settings_length_t value_size)
+{
+  settings_status_t ret;
+
+  settings_iter_t iter = find_item(key, 0);
+
+  if(iter == EEPROM_NULL) {
+    return settings_add(key, value, value_size);
+  }
+
+  if(value_is_equal(iter, value, value_size)) {
+    return SETTINGS_STATUS_OK;
+  }
+
+#if SETTINGS_CONF_APPEND_LOG
+  /* Append the new value and retire the old one instead of writing
+   * over it, which flash does not allow, and instead of shifting the
+   * store when the size changes.
+   */
+  ret = settings_add(key, value, value_size);
+  if(ret == SETTINGS_STATUS_OK) {
+    mark_deleted(iter);
+  }
+#else
+  if(value_size != settings_iter_get_value_length(iter)) {
+    /* Requires the settings store to be shifted. Currently unimplemented. */
+    return SETTINGS_STATUS_UNIMPLEMENTED;
+  }
+
+  /* Now write the data */
+  eeprom_write(settings_iter_get_value_addr(iter),
+               (uint8_t *)value, value_size);
+
+  ret = SETTINGS_STATUS_OK;
+#endif /* SETTINGS_CONF_APPEND_LOG */
+
+  return ret;
+}
+
+#if SETTINGS_CONF_BATCH_SIZE
+/*---------------------------------------------------------------------------*/
+/* Returns the offset of the pending record for key, or batch_len. */
+static uint16_t
+batch_find(settings_key_t key)
+{
+  uint16_t offset;
+  settings_key_t k;
+
+  for(offset = 0; offset < batch_len;
+      offset += BATCH_RECORD_HDR + batch_buf[offset + sizeof(k)]) {
+    memcpy(&k, &batch_buf[offset], sizeof(k));
+    if(k == key) {
+      break;
+    }
+  }
+  return offset;
+}
+
+/*---------------------------------------------------------------------------*/
+static settings_status_t
+batch_flush(void)
+{
+  settings_status_t ret = SETTINGS_STATUS_OK;
+  settings_status_t status;
+  settings_key_t key;
+  uint16_t offset;
+  uint16_t end;
+  uint8_t len;
+
+  /* Empty the batch first: writing goes through settings_add(),
+     which flushes the batch itself. */
+  end = batch_len;
+  batch_len = 0;
+
+  for(offset = 0; offset < end; offset += BATCH_RECORD_HDR + len) {
+    memcpy(&key, &batch_buf[offset], sizeof(key));
+    len = batch_buf[offset + sizeof(key)];
+    status = set_item(key, &batch_buf[offset + BATCH_RECORD_HDR], len);
+    if(ret == SETTINGS_STATUS_OK) {
+      ret = status;
+    }
+  }
+
+  return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static settings_status_t
+batch_set(settings_key_t key, const uint8_t *value,
+          settings_length_t value_size)
+{
+  uint16_t offset;
+  uint16_t size;
+
+  if(value_size > 0xFF ||
+     BATCH_RECORD_HDR + value_size > SETTINGS_CONF_BATCH_SIZE) {
+    batch_flush();
+    return set_item(key, value, value_size);
+  }
+
+  /* Drop the value this one replaces */
+  offset = batch_find(key);
+  if(offset < batch_len) {
+    size = BATCH_RECORD_HDR + batch_buf[offset + sizeof(key)];
+    memmove(&batch_buf[offset], &batch_buf[offset + size],
+            batch_len - offset - size);
+    batch_len -= size;
+  }
+
+  if(batch_len + BATCH_RECORD_HDR + value_size > SETTINGS_CONF_BATCH_SIZE) {
+    batch_flush();
+  }
+
+  memcpy(&batch_buf[batch_len], &key, sizeof(key));
+  batch_buf[batch_len + sizeof(key)] = value_size;
+  memcpy(&batch_buf[batch_len + BATCH_RECORD_HDR], value, value_size);
+  batch_len += BATCH_RECORD_HDR + value_size;
+
+  return SETTINGS_STATUS_OK;
+}
+#endif /* SETTINGS_CONF_BATCH_SIZE */
+
 /*****************************************************************************/
 // MARK: - Public Travesal Functions
 /*****************************************************************************/
@@ -199,6 +536,14 @@ settings_iter_delete(settings_iter_t iter)
 {
   settings_status_t ret = SETTINGS_STATUS_FAILURE;
 
+#if SETTINGS_CONF_APPEND_LOG
+  /* Wiping a header is not possible on flash, so even the last item
+   * is only marked as deleted.
+   */
+  mark_deleted(iter);
+
+  ret = SETTINGS_STATUS_OK;
+#else
   settings_iter_t next = settings_iter_next(iter);
 
   if(!next) {
@@ -211,13 +556,18 @@ settings_iter_delete(settings_iter_t iter)
 
     eeprom_write(iter - sizeof(header), (uint8_t *)&header, sizeof(header));
 
+#if SETTINGS_CONF_INDEX_SIZE
+    index_state = INDEX_STALE;
+#endif
+
     ret = SETTINGS_STATUS_OK;
+  } else {
+    /* This case requires the settings store to be shifted.
+     * Currently unimplemented. TODO: Writeme!
+     */
+    ret = SETTINGS_STATUS_UNIMPLEMENTED;
   }
-
-  /* This case requires the settings store to be shifted.
-   * Currently unimplemented. TODO: Writeme!
-   */
-  ret = SETTINGS_STATUS_UNIMPLEMENTED;
+#endif /* SETTINGS_CONF_APPEND_LOG */
 
   return ret;
 }
@@ -230,22 +580,13 @@ settings_iter_delete(settings_iter_t iter)
 uint8_t
 settings_check(settings_key_t key, uint8_t index)
 {
-  uint8_t ret = 0;
-
-  settings_iter_t iter;
-
-  for(iter = settings_iter_begin(); iter; iter = settings_iter_next(iter)) {
-    if(settings_iter_get_key(iter) == key) {
-      if(!index) {
-        ret = 1;
-        break;
-      } else {
-        index--;
-      }
-    }
+#if SETTINGS_CONF_BATCH_SIZE
+  if(index == 0 && batch_find(key) < batch_len) {
+    return 1;
   }
+#endif
 
-  return ret;
+  return find_item(key, index) != EEPROM_NULL;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -253,27 +594,28 @@ settings_status_t
 settings_get(settings_key_t key, uint8_t index, uint8_t *value,
              settings_length_t * value_size)
 {
-  settings_status_t ret = SETTINGS_STATUS_NOT_FOUND;
-
   settings_iter_t iter;
 
-  for(iter = settings_iter_begin(); iter; iter = settings_iter_next(iter)) {
-    if(settings_iter_get_key(iter) == key) {
-      if(!index) {
-        /* We found it! */
-        *value_size = settings_iter_get_value_bytes(iter,
-                                                    (void *)value,
-                                                    *value_size);
-        ret = SETTINGS_STATUS_OK;
-        break;
-      } else {
-        /* Nope, keep looking */
-        index--;
-      }
-    }
+#if SETTINGS_CONF_BATCH_SIZE
+  uint16_t offset = batch_find(key);
+
+  if(index == 0 && offset < batch_len) {
+    /* A value that has not been written yet */
+    *value_size = MIN(*value_size, batch_buf[offset + sizeof(key)]);
+    memcpy(value, &batch_buf[offset + BATCH_RECORD_HDR], *value_size);
+    return SETTINGS_STATUS_OK;
   }
+#endif
 
-  return ret;
+  iter = find_item(key, index);
+  if(iter == EEPROM_NULL) {
+    return SETTINGS_STATUS_NOT_FOUND;
+  }
+
+  *value_size = settings_iter_get_value_bytes(iter, (void *)value,
+                                              *value_size);
+
+  return SETTINGS_STATUS_OK;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -287,11 +629,13 @@ settings_add(settings_key_t key, const uint8_t *value,
 
   item_header_t header;
 
+#if SETTINGS_CONF_BATCH_SIZE
+  /* Keep the order of the pending values and this one */
+  batch_flush();
+#endif
+
   /* Find the last item. */
-  for(iter = settings_iter_begin(); settings_iter_next(iter);
-      iter = settings_iter_next(iter)) {
-    /* This block intentionally left blank. */
-  }
+  iter = find_last_item();
 
   if(iter) {
     /* Value address of item is the same as the iterator for next item. */
@@ -348,6 +692,10 @@ settings_add(settings_key_t key, const uint8_t *value,
   /* Now write the data */
   eeprom_write(settings_iter_get_value_addr(iter), (uint8_t *)value, value_size);
 
+#if SETTINGS_CONF_INDEX_SIZE
+  index_add(iter);
+#endif
+
   /* This should be the last item. If this is not the case,
    * then we need to clear out the phantom setting.
    */
@@ -360,6 +708,11 @@ settings_add(settings_key_t key, const uint8_t *value,
   ret = SETTINGS_STATUS_OK;
 
 bail:
+#if SETTINGS_CONF_INDEX_SIZE
+  if(ret != SETTINGS_STATUS_OK) {
+    index_state = INDEX_STALE;
+  }
+#endif
   return ret;
 }
 
@@ -368,59 +721,52 @@ settings_status_t
 settings_set(settings_key_t key, const uint8_t *value,
              settings_length_t value_size)
 {
-  settings_status_t ret = SETTINGS_STATUS_FAILURE;
-
-  settings_iter_t iter;
-
-  for(iter = settings_iter_begin(); iter; iter = settings_iter_next(iter)) {
-    if(settings_iter_get_key(iter) == key) {
-      break;
-    }
-  }
-
-  if((iter == EEPROM_NULL) || !settings_iter_is_valid(iter)) {
-    ret = settings_add(key, value, value_size);
-    goto bail;
-  }
-
-  if(value_size != settings_iter_get_value_length(iter)) {
-    /* Requires the settings store to be shifted. Currently unimplemented. */
-    ret = SETTINGS_STATUS_UNIMPLEMENTED;
-    goto bail;
+#if SETTINGS_CONF_BATCH_SIZE
+  if(batching) {
+    return batch_set(key, value, value_size);
   }
+#endif
 
-  /* Now write the data */
-  eeprom_write(settings_iter_get_value_addr(iter),
-               (uint8_t *)value, value_size);
+  return set_item(key, value, value_size);
+}
 
-  ret = SETTINGS_STATUS_OK;
+/*---------------------------------------------------------------------------*/
+void
+settings_batch_begin(void)
+{
+#if SETTINGS_CONF_BATCH_SIZE
+  batching = 1;
+#endif
+}
 
-bail:
-  return ret;
+/*---------------------------------------------------------------------------*/
+settings_status_t
+settings_batch_end(void)
+{
+#if SETTINGS_CONF_BATCH_SIZE
+  batching = 0;
+  return batch_flush();
+#else
+  return SETTINGS_STATUS_OK;
+#endif
 }
 
 /*---------------------------------------------------------------------------*/
 settings_status_t
 settings_delete(settings_key_t key, uint8_t index)
 {
-  settings_status_t ret = SETTINGS_STATUS_NOT_FOUND;
-
   settings_iter_t iter;
 
-  for(iter = settings_iter_begin(); iter; iter = settings_iter_next(iter)) {
-    if(settings_iter_get_key(iter) == key) {
-      if(!index) {
-        /* We found it! */
-        ret = settings_iter_delete(iter);
-        break;
-      } else {
-        /* Nope, keep looking */
-        index--;
-      }
-    }
+#if SETTINGS_CONF_BATCH_SIZE
+  batch_flush();
+#endif
+
+  iter = find_item(key, index);
+  if(iter == EEPROM_NULL) {
+    return SETTINGS_STATUS_NOT_FOUND;
   }
 
-  return ret;
+  return settings_iter_delete(iter);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -433,6 +779,13 @@ settings_wipe(void)
   const uint32_t x = 0xFFFFFF;
 
   eeprom_write(SETTINGS_TOP_ADDR - sizeof(x), (uint8_t *)&x, sizeof(x));
+
+#if SETTINGS_CONF_INDEX_SIZE
+  index_reset();
+#endif
+#if SETTINGS_CONF_BATCH_SIZE
+  batch_len = 0;
+#endif
 }
 
 /*****************************************************************************/
@@ -51,6 +51,12 @@
  *   * Data can be appended without erasing EEPROM.
  *   * Max size of settings data can be easily increased in the future,
  *     as long as it doesn't overlap with application data.
+ *   * Lookups use a RAM index of the items, built on first use, instead
+ *     of walking the EEPROM (see SETTINGS_CONF_INDEX_SIZE).
+ *   * Writes can be batched with settings_batch_begin() and
+ *     settings_batch_end() (see SETTINGS_CONF_BATCH_SIZE).
+ *   * An append-log mode for flash-backed stores, where updates
+ *     never write over existing data (see SETTINGS_CONF_APPEND_LOG).
  *
  *  ## Data Format ##
  *
@@ -103,6 +109,15 @@
  *     of the size byte (or size_low byte).
  *   * The key has a value of 0x0000.
  *
+ *  ## Append-log Mode ##
+ *
+ *  With SETTINGS_CONF_APPEND_LOG, settings_set() does not write over
+ *  the old value. It appends the new value and clears the key of the
+ *  old item to 0x0000, which only clears bits and therefore works on
+ *  flash without an erase. Values can change size, and items in the
+ *  middle of the store can be deleted, the same way. Retired items
+ *  keep their space until settings_wipe().
+ *
  */
 
 #include <stdint.h>
@@ -165,6 +180,21 @@ typedef uint16_t settings_length_t;
 #define SETTINGS_CONF_SUPPORT_LARGE_VALUES  0
 #endif
 
+/** Number of items the RAM index holds. 0 disables the index. */
+#ifndef SETTINGS_CONF_INDEX_SIZE
+#define SETTINGS_CONF_INDEX_SIZE   16
+#endif
+
+/** Bytes of RAM for batched writes. 0 makes batches write through. */
+#ifndef SETTINGS_CONF_BATCH_SIZE
+#define SETTINGS_CONF_BATCH_SIZE   0
+#endif
+
+/** Append updated values instead of overwriting them. */
+#ifndef SETTINGS_CONF_APPEND_LOG
+#define SETTINGS_CONF_APPEND_LOG   0
+#endif
+
 #if SETTINGS_CONF_SUPPORT_LARGE_VALUES
 #define SETTINGS_MAX_VALUE_SIZE    0x3FFF        /* 16383 bytes */
 #else
@@ -200,6 +230,16 @@ extern settings_status_t settings_set(settings_key_t key,
 /** Removes the given key (at the given index) from the settings store. */
 extern settings_status_t settings_delete(settings_key_t key, uint8_t index);
 
+/** Holds back the values of subsequent settings_set() calls in RAM.
+ *  Setting a key again before settings_batch_end() replaces the held
+ *  value, so only the last one is written. settings_get() and
+ *  settings_check() see held values at index 0.
+ */
+extern void settings_batch_begin(void);
+
+/** Writes the held values. Returns the first error, if any. */
+extern settings_status_t settings_batch_end(void);
+
 /*****************************************************************************/
 // MARK: - Settings traversal functions
 
@@ -0,0 +1,218 @@
+/**
+ * \addtogroup tlist
+ * @{
+ */
+
+/**
+ * \file
+ *         Linked list with tail pointer
+ */
+
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+#include "lib/tlist.h"
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+struct tlist_item {
+  struct tlist_item *next;
+};
+
+/*---------------------------------------------------------------------------*/
+/**
+ * Initialize a list. The list will be empty afterwards.
+ *
+ * \param list The list to be initialized.
+ */
+void
+tlist_init(tlist_t list)
+{
+  list->head = NULL;
+  list->tail = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the first element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the first element, or NULL if the list is empty.
+ */
+void *
+tlist_head(tlist_t list)
+{
+  return list->head;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the last element of a list, in constant time.
+ *
+ * \param list The list.
+ * \return A pointer to the last element, or NULL if the list is empty.
+ */
+void *
+tlist_tail(tlist_t list)
+{
+  return list->tail;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the first element of a list.
+ *
+ * \param list The list.
+ * \return The removed element, or NULL if the list was empty.
+ */
+void *
+tlist_pop(tlist_t list)
+{
+  struct tlist_item *l;
+
+  l = list->head;
+  if(l != NULL) {
+    list->head = l->next;
+    if(list->head == NULL) {
+      list->tail = NULL;
+    }
+    l->next = NULL;
+  }
+  return l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an element to the start of a list.
+ *
+ * \param list The list.
+ * \param item The element, which must not already be on the list.
+ */
+void
+tlist_push(tlist_t list, void *item)
+{
+  ((struct tlist_item *)item)->next = list->head;
+  list->head = item;
+  if(list->tail == NULL) {
+    list->tail = item;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an element to the end of a list, in constant time.
+ *
+ * \param list The list.
+ * \param item The element, which must not already be on the list.
+ */
+void
+tlist_add(tlist_t list, void *item)
+{
+  ((struct tlist_item *)item)->next = NULL;
+  if(list->tail == NULL) {
+    list->head = item;
+  } else {
+    ((struct tlist_item *)list->tail)->next = item;
+  }
+  list->tail = item;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Insert an element after another element on a list.
+ *
+ * \param list The list.
+ * \param previtem The element after which the new element is inserted,
+ *                 or NULL to insert it at the start of the list.
+ * \param newitem The new element.
+ */
+void
+tlist_insert(tlist_t list, void *previtem, void *newitem)
+{
+  if(previtem == NULL) {
+    tlist_push(list, newitem);
+  } else {
+    ((struct tlist_item *)newitem)->next =
+      ((struct tlist_item *)previtem)->next;
+    ((struct tlist_item *)previtem)->next = newitem;
+    if(list->tail == previtem) {
+      list->tail = newitem;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove an element from a list.
+ *
+ * Removing the first element takes constant time; other elements
+ * are searched for from the start of the list.
+ *
+ * \param list The list.
+ * \param item The element to remove.
+ */
+void
+tlist_remove(tlist_t list, void *item)
+{
+  struct tlist_item *l, *r;
+
+  r = NULL;
+  for(l = list->head; l != NULL; l = l->next) {
+    if(l == item) {
+      if(r == NULL) {
+        list->head = l->next;
+      } else {
+        r->next = l->next;
+      }
+      if(list->tail == l) {
+        list->tail = r;
+      }
+      l->next = NULL;
+      return;
+    }
+    r = l;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get the number of elements on a list.
+ *
+ * \param list The list.
+ * \return The length of the list.
+ */
+int
+tlist_length(tlist_t list)
+{
+  struct tlist_item *l;
+  int n = 0;
+
+  for(l = list->head; l != NULL; l = l->next) {
+    ++n;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
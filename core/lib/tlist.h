@@ -0,0 +1,126 @@
+/** \addtogroup lib
+    @{ */
+/**
+ * \defgroup tlist Linked list library with tail pointer
+ *
+ * The tlist library works like the \ref list "list library", but
+ * every list also keeps a pointer to its last element. Adding an
+ * element to the end of a list and looking at the last element
+ * therefore take constant time instead of a walk through the list.
+ * This makes tlists suitable for queues.
+ *
+ * As with lists, the first element of a list element \b must be a
+ * pointer, and list_item_next() can be used to iterate over a tlist.
+ * Unlike list_add(), tlist_add() does not check if the element
+ * already is on the list; the caller must make sure it is not.
+ *
+ * Lists are declared with the TLIST() macro, or with TLIST_STRUCT()
+ * inside a structure.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ *         Linked list with tail pointer
+ */
+
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+#ifndef __TLIST_H__
+#define __TLIST_H__
+
+#include "lib/list.h"
+
+/**
+ * The list head and tail. Only accessed through the tlist functions.
+ */
+struct tlist {
+  void *head;
+  void *tail;
+};
+
+/**
+ * The tlist type.
+ */
+typedef struct tlist * tlist_t;
+
+/**
+ * Declare a linked list with tail pointer.
+ *
+ * The list variable is declared as static, in the same way as with
+ * the LIST() macro.
+ *
+ * \param name The name of the list.
+ */
+#define TLIST(name) \
+         static struct tlist LIST_CONCAT(name,_tlist) = { NULL, NULL }; \
+         static tlist_t name = &LIST_CONCAT(name,_tlist)
+
+/**
+ * Declare a linked list with tail pointer inside a structure.
+ *
+ * The list must be initialized with TLIST_STRUCT_INIT() before use.
+ *
+ * \param name The name of the list.
+ */
+#define TLIST_STRUCT(name) \
+         struct tlist LIST_CONCAT(name,_tlist); \
+         tlist_t name
+
+/**
+ * Initialize a linked list with tail pointer that is part of a
+ * structure.
+ *
+ * \param struct_ptr A pointer to the struct
+ * \param name The name of the list.
+ */
+#define TLIST_STRUCT_INIT(struct_ptr, name)                             \
+    do {                                                                \
+       (struct_ptr)->name = &((struct_ptr)->LIST_CONCAT(name,_tlist));  \
+       tlist_init((struct_ptr)->name);                                  \
+    } while(0)
+
+void   tlist_init(tlist_t list);
+void * tlist_head(tlist_t list);
+void * tlist_tail(tlist_t list);
+void * tlist_pop(tlist_t list);
+void   tlist_push(tlist_t list, void *item);
+void   tlist_add(tlist_t list, void *item);
+void   tlist_insert(tlist_t list, void *previtem, void *newitem);
+void   tlist_remove(tlist_t list, void *item);
+int    tlist_length(tlist_t list);
+
+#endif /* __TLIST_H__ */
+
+/** @} */
+/** @} */
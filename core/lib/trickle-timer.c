@@ -72,6 +72,18 @@ static clock_time_t loc_clock; /* A local, general-purpose placeholder */
 
 static void fire(void *ptr);
 static void double_interval(void *ptr);
+
+/* The events that a trickle timer waits for */
+#define EVENT_FIRE   0 /* Time t within the interval */
+#define EVENT_DOUBLE 1 /* End of the interval */
+
+#if TRICKLE_TIMER_SHARED_TIMER
+/* The running trickle timers, sorted by the time of their next event */
+static struct trickle_timer *queue;
+static struct ctimer shared_ct;
+/* Non-zero while the queue is modified in a batch or handled */
+static uint8_t deferred;
+#endif
 /*---------------------------------------------------------------------------*/
 /* Local utilities and functions to be used as ctimer callbacks */
 /*---------------------------------------------------------------------------*/
@@ -164,6 +176,118 @@ get_t(clock_time_t i_cur)
   return i_cur + (tt_rand() % i_cur);
 }
 /*---------------------------------------------------------------------------*/
+#if TRICKLE_TIMER_SHARED_TIMER
+static void run_queue(void *ptr);
+
+/* Arms the shared ctimer for the earliest event in the queue */
+static void
+rearm(void)
+{
+  clock_time_t delay;
+
+  if(deferred) {
+    return;
+  }
+  if(queue == NULL) {
+    ctimer_stop(&shared_ct);
+    return;
+  }
+  delay = queue->due - clock_time();
+  if(delay > (TRICKLE_TIMER_CLOCK_MAX >> 1)) {
+    delay = 0;
+  }
+  ctimer_set(&shared_ct, delay, run_queue, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+unlink_timer(struct trickle_timer *tt)
+{
+  struct trickle_timer **p;
+
+  for(p = &queue; *p != NULL; p = &(*p)->next) {
+    if(*p == tt) {
+      *p = tt->next;
+      tt->next = NULL;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+trickle_timer_unschedule(struct trickle_timer *tt)
+{
+  struct trickle_timer *first = queue;
+
+  unlink_timer(tt);
+  if(queue != first) {
+    rearm();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Runs the events that are due, and those that are due within
+   TRICKLE_TIMER_COALESCE ticks, then rearms the shared ctimer */
+static void
+run_queue(void *ptr)
+{
+  struct trickle_timer *tt;
+  clock_time_t now;
+
+  deferred = 1;
+  now = clock_time() + TRICKLE_TIMER_COALESCE;
+  while(queue != NULL &&
+        (clock_time_t)(now - queue->due) <= (TRICKLE_TIMER_CLOCK_MAX >> 1)) {
+    tt = queue;
+    queue = tt->next;
+    tt->next = NULL;
+
+    PROCESS_CONTEXT_BEGIN(tt->p);
+    if(tt->event == EVENT_FIRE) {
+      fire(tt);
+    } else {
+      double_interval(tt);
+    }
+    PROCESS_CONTEXT_END(tt->p);
+  }
+  deferred = 0;
+  rearm();
+}
+#endif /* TRICKLE_TIMER_SHARED_TIMER */
+/*---------------------------------------------------------------------------*/
+/* Schedules the next event of a timer in 'delay' ticks, and returns the time
+   when it was scheduled */
+static clock_time_t
+schedule(struct trickle_timer *tt, clock_time_t delay, uint8_t event)
+{
+#if TRICKLE_TIMER_SHARED_TIMER
+  struct trickle_timer **p;
+  struct trickle_timer *first;
+  clock_time_t now = clock_time();
+
+  first = queue;
+  unlink_timer(tt);
+
+  tt->due = now + delay;
+  tt->event = event;
+  tt->p = PROCESS_CURRENT();
+
+  /* Insert after timers that are due at the same time */
+  for(p = &queue;
+      *p != NULL &&
+      (clock_time_t)(tt->due - (*p)->due) <= (TRICKLE_TIMER_CLOCK_MAX >> 1);
+      p = &(*p)->next);
+  tt->next = *p;
+  *p = tt;
+
+  if(queue != first || first == tt) {
+    rearm();
+  }
+  return now;
+#else
+  ctimer_set(&tt->ct, delay, event == EVENT_FIRE ? fire : double_interval, tt);
+  return tt->ct.etimer.timer.start;
+#endif
+}
+/*---------------------------------------------------------------------------*/
 static void
 schedule_for_end(struct trickle_timer *tt)
 {
@@ -182,7 +306,7 @@ schedule_for_end(struct trickle_timer *tt)
     PRINTF("trickle_timer doubling: Was in the past. Compensating\n");
   }
 
-  ctimer_set(&tt->ct, loc_clock, double_interval, tt);
+  schedule(tt, loc_clock, EVENT_DOUBLE);
 }
 /*---------------------------------------------------------------------------*/
 /* This is used as a ctimer callback, thus its argument must be void *. ptr is
@@ -232,24 +356,22 @@ double_interval(void *ptr)
     loc_clock = 0;
     PRINTF("trickle_timer doubling: Was in the past. Compensating\n");
   }
-  ctimer_set(&loctt->ct, loc_clock, fire, loctt);
+  schedule(loctt, loc_clock, EVENT_FIRE);
 
   /* Store the actual interval start (absolute time), we need it later.
    * We pretend that it started at the same time when the last one ended */
   loctt->i_start = last_end;
 #else
   /* Assumed that the previous interval's end is 'now' and schedule in t ticks
-   * after 'now', ignoring potential offsets */
-  ctimer_set(&loctt->ct, loc_clock, fire, loctt);
-  /* Store the actual interval start (absolute time), we need it later */
-  loctt->i_start = loctt->ct.etimer.timer.start;
+   * after 'now', ignoring potential offsets. Store the actual interval start
+   * (absolute time), we need it later */
+  loctt->i_start = schedule(loctt, loc_clock, EVENT_FIRE);
 #endif
 
   PRINTF("trickle_timer doubling: Last end %lu, new end %lu, for %lu, I=%lu\n",
          (unsigned long)last_end,
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(loctt),
-         (unsigned long)(loctt->ct.etimer.timer.start +
-                         loctt->ct.etimer.timer.interval),
+         (unsigned long)TRICKLE_TIMER_NEXT_EVENT(loctt),
          (unsigned long)(loctt->i_cur));
 }
 /*---------------------------------------------------------------------------*/
@@ -263,8 +385,7 @@ fire(void *ptr)
 
   PRINTF("trickle_timer fire: at %lu (was for %lu)\n",
          (unsigned long)clock_time(),
-         (unsigned long)(loctt->ct.etimer.timer.start +
-                         loctt->ct.etimer.timer.interval));
+         (unsigned long)TRICKLE_TIMER_NEXT_EVENT(loctt));
 
   if(loctt->cb) {
     /*
@@ -291,10 +412,8 @@ new_interval(struct trickle_timer *tt)
   /* Random t in [I/2, I) */
   loc_clock = get_t(tt->i_cur);
 
-  ctimer_set(&tt->ct, loc_clock, fire, tt);
-
   /* Store the actual interval start (absolute time), we need it later */
-  tt->i_start = tt->ct.etimer.timer.start;
+  tt->i_start = schedule(tt, loc_clock, EVENT_FIRE);
   PRINTF("trickle_timer new interval: at %lu, ends %lu, ",
          (unsigned long)clock_time(),
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(tt));
@@ -325,6 +444,31 @@ trickle_timer_inconsistency(struct trickle_timer *tt)
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+trickle_timer_consistency_batch(struct trickle_timer *tt[], uint8_t n)
+{
+  while(n-- > 0) {
+    trickle_timer_consistency(tt[n]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+trickle_timer_inconsistency_batch(struct trickle_timer *tt[], uint8_t n)
+{
+#if TRICKLE_TIMER_SHARED_TIMER
+  uint8_t was_deferred = deferred;
+
+  deferred = 1;
+#endif
+  while(n-- > 0) {
+    trickle_timer_inconsistency(tt[n]);
+  }
+#if TRICKLE_TIMER_SHARED_TIMER
+  deferred = was_deferred;
+  rearm();
+#endif
+}
+/*---------------------------------------------------------------------------*/
 uint8_t
 trickle_timer_config(struct trickle_timer *tt, clock_time_t i_min,
                      uint8_t i_max, uint8_t k)
@@ -400,7 +544,7 @@ trickle_timer_set(struct trickle_timer *tt, trickle_timer_cb_t proto_cb,
   PRINTF("trickle_timer set: at %lu, ends %lu, t=%lu in [%lu , %lu)\n",
          (unsigned long)tt->i_start,
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(tt),
-         (unsigned long)tt->ct.etimer.timer.interval,
+         (unsigned long)(TRICKLE_TIMER_NEXT_EVENT(tt) - tt->i_start),
          (unsigned long)tt->i_cur >> 1, (unsigned long)tt->i_cur);
 
   return TRICKLE_TIMER_SUCCESS;
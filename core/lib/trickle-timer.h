@@ -204,6 +204,34 @@
 #define TRICKLE_TIMER_ERROR_CHECKING 1
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Schedules all trickle timers from a single ctimer
+ * 0: Disabled (default). Each trickle timer has its own \ref ctimer.
+ * 1: Enabled. Pending events of all trickle timers are kept in one queue,
+ * sorted by time, and a single ctimer is armed for the earliest one. This
+ * saves a ctimer per timer and the per-event ctimer list handling, and is
+ * worthwhile for protocols running many trickle instances.
+ */
+#ifdef TRICKLE_TIMER_CONF_SHARED_TIMER
+#define TRICKLE_TIMER_SHARED_TIMER TRICKLE_TIMER_CONF_SHARED_TIMER
+#else
+#define TRICKLE_TIMER_SHARED_TIMER 0
+#endif
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief With the shared timer, events due within this many clock ticks of
+ * each other are handled together.
+ *
+ * Handling events that are close together in one go lets the protocol
+ * coalesce the transmissions of several instances. An event may then run up
+ * to this many ticks early; keep it small compared to Imin.
+ */
+#ifdef TRICKLE_TIMER_CONF_COALESCE
+#define TRICKLE_TIMER_COALESCE TRICKLE_TIMER_CONF_COALESCE
+#else
+#define TRICKLE_TIMER_COALESCE 0
+#endif
+/*---------------------------------------------------------------------------*/
 /* Trickle Timer Library Macros */
 /*---------------------------------------------------------------------------*/
 /**
@@ -280,6 +308,19 @@
  */
 #define TRICKLE_TIMER_INTERVAL_END(tt) ((tt)->i_start + (tt)->i_cur)
 
+/**
+ * \brief Returns the time of a timer's next event (absolute time in ticks)
+ * \param tt A pointer to a ::trickle_timer structure
+ * \return Time t in the current interval, or the interval's end if t has
+ *         passed
+ */
+#if TRICKLE_TIMER_SHARED_TIMER
+#define TRICKLE_TIMER_NEXT_EVENT(tt) ((tt)->due)
+#else
+#define TRICKLE_TIMER_NEXT_EVENT(tt) \
+  ((tt)->ct.etimer.timer.start + (tt)->ct.etimer.timer.interval)
+#endif
+
 /**
  * \brief Checks whether an Imin value is suitable considering the various
  * restrictions imposed by our platform's clock as well as by the library itself
@@ -361,6 +402,9 @@ typedef void (* trickle_timer_cb_t)(void *ptr, uint8_t suppress);
  * boundaries of clock_time_t
  */
 struct trickle_timer {
+#if TRICKLE_TIMER_SHARED_TIMER
+  struct trickle_timer *next; /**< Next timer in the shared event queue */
+#endif
   clock_time_t i_min;     /**< Imin: Clock ticks */
   clock_time_t i_cur;     /**< I: Current interval in clock_ticks */
   clock_time_t i_start;   /**< Start of this interval (absolute clock_time) */
@@ -369,7 +413,13 @@ struct trickle_timer {
                                Imin << Imax used internally, so that we can
                                have direct access to the maximum interval size
                                without having to calculate it all the time */
+#if TRICKLE_TIMER_SHARED_TIMER
+  clock_time_t due;       /**< Time of the next event (absolute clock_time) */
+  struct process *p;      /**< Process that the callback runs in */
+  uint8_t event;          /**< The next event, used internally */
+#else
   struct ctimer ct;       /**< A \ref ctimer used internally */
+#endif
   trickle_timer_cb_t cb;  /**< Protocol's own callback, invoked at time t
                                within the current interval */
   void *cb_arg;           /**< Opaque pointer to be used as the argument of the
@@ -447,10 +497,20 @@ uint8_t trickle_timer_set(struct trickle_timer *tt,
  * to reset a timer manually. Instead, in response to events or inconsistencies,
  * the corresponding functions must be used
  */
+#if TRICKLE_TIMER_SHARED_TIMER
+#define trickle_timer_stop(tt) do { \
+  trickle_timer_unschedule(tt); \
+  (tt)->i_cur = TRICKLE_TIMER_IS_STOPPED; \
+} while(0)
+
+/* Removes a timer from the shared event queue. Use trickle_timer_stop(). */
+void trickle_timer_unschedule(struct trickle_timer *tt);
+#else
 #define trickle_timer_stop(tt) do { \
   ctimer_stop(&((tt)->ct)); \
   (tt)->i_cur = TRICKLE_TIMER_IS_STOPPED; \
 } while(0)
+#endif
 
 /**
  * \brief      To be called by the protocol when it hears a consistent
@@ -497,6 +557,28 @@ void trickle_timer_inconsistency(struct trickle_timer *tt);
  */
 #define trickle_timer_reset_event(tt) trickle_timer_inconsistency(tt)
 
+/**
+ * \brief      To be called by the protocol when a single transmission was
+ *             consistent for several trickle timers
+ * \param tt   An array of pointers to ::trickle_timer structures
+ * \param n    The number of timers in the array
+ *
+ * This is equivalent to calling trickle_timer_consistency() for each timer.
+ */
+void trickle_timer_consistency_batch(struct trickle_timer *tt[], uint8_t n);
+
+/**
+ * \brief      To be called by the protocol when a single transmission was
+ *             inconsistent for several trickle timers
+ * \param tt   An array of pointers to ::trickle_timer structures
+ * \param n    The number of timers in the array
+ *
+ * This is equivalent to calling trickle_timer_inconsistency() for each timer,
+ * but with ::TRICKLE_TIMER_CONF_SHARED_TIMER the shared ctimer is only
+ * rearmed once.
+ */
+void trickle_timer_inconsistency_batch(struct trickle_timer *tt[], uint8_t n);
+
 /**
  * \brief      To be called in order to determine whether a trickle timer is
  *             running
@@ -60,7 +60,18 @@ elfloader_arch_allocate_rom(int size)
 #endif /* ELFLOADER_CONF_TEXT_IN_ROM */
 }
 /*---------------------------------------------------------------------------*/
+/* Text is read from the file and burned in bursts of READSIZE bytes,
+   using the data memory as buffer before the data segment has been
+   loaded into it. READSIZE must divide the 512-byte flash segment. */
+#if ELFLOADER_DATAMEMORY_SIZE >= 256
+#define READSIZE 256
+#elif ELFLOADER_DATAMEMORY_SIZE >= 128
+#define READSIZE 128
+#elif ELFLOADER_DATAMEMORY_SIZE >= 64
+#define READSIZE 64
+#else
 #define READSIZE 32
+#endif
 void
 elfloader_arch_write_rom(int fd, unsigned short textoff, unsigned int size, char *mem)
 {
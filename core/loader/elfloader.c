@@ -52,6 +52,34 @@
 
 #define EI_NIDENT 16
 
+/* Resolved relocation symbols are cached by symbol table index, since
+   modules typically refer to the same few symbols from many
+   relocations. */
+#ifdef ELFLOADER_CONF_SYMBOL_CACHE_SIZE
+#define SYMBOL_CACHE_SIZE ELFLOADER_CONF_SYMBOL_CACHE_SIZE
+#else
+#define SYMBOL_CACHE_SIZE 16
+#endif
+
+/* The number of relocation entries read from the file at a time. */
+#define RELA_BUFFER_ENTRIES 8
+
+#if ELFLOADER_COMPACT
+/*
+ * A compact module (CELF) is made from a relocatable ELF object by
+ * tools/elf2celf, which documents the format. It consists of a
+ * header of 16-bit little endian fields, the names of the imported
+ * symbols, the text, rodata and data segments, and a compressed
+ * relocation stream for each segment. Symbols defined in the module
+ * are resolved at build time, so relocations only name a segment or
+ * an imported symbol.
+ */
+#define CELF_MAGIC        "\177CEL"
+#define CELF_MAGIC_SIZE   4
+#define CELF_HDRSIZE      (CELF_MAGIC_SIZE + 10 * 2)
+#define CELF_SEGMENTS     4	/* text, rodata, data, bss */
+#endif /* ELFLOADER_COMPACT */
+
 
 struct elf32_ehdr {
   unsigned char e_ident[EI_NIDENT];    /* ident bytes */
@@ -137,6 +165,13 @@ struct process * const * elfloader_autostart_processes;
 
 static struct relevant_section bss, data, rodata, text;
 
+struct symbol_cache_entry {
+  unsigned short key;		/* Symbol index + 1, or 0 if unused. */
+  char *addr;
+};
+
+static struct symbol_cache_entry symbol_cache[SYMBOL_CACHE_SIZE];
+
 static const unsigned char elf_magic_header[] =
   {0x7f, 0x45, 0x4c, 0x46,  /* 0x7f, 'E', 'L', 'F' */
    0x01,                    /* Only 32-bit objects. */
@@ -172,6 +207,21 @@ seek_write(int fd, unsigned int offset, char *buf, int len)
 }
 */
 /*---------------------------------------------------------------------------*/
+static struct relevant_section *
+find_section(unsigned int shndx)
+{
+  if(shndx == bss.number) {
+    return &bss;
+  } else if(shndx == data.number) {
+    return &data;
+  } else if(shndx == rodata.number) {
+    return &rodata;
+  } else if(shndx == text.number) {
+    return &text;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 static void *
 find_local_symbol(int fd, const char *symbol,
 		  unsigned int symtab, unsigned short symtabsize,
@@ -188,15 +238,8 @@ find_local_symbol(int fd, const char *symbol,
     if(s.st_name != 0) {
       seek_read(fd, strtab + s.st_name, name, sizeof(name));
       if(strcmp(name, symbol) == 0) {
-	if(s.st_shndx == bss.number) {
-	  sect = &bss;
-	} else if(s.st_shndx == data.number) {
-	  sect = &data;
-  } else if(s.st_shndx == rodata.number) {
-    sect = &rodata;
-	} else if(s.st_shndx == text.number) {
-	  sect = &text;
-	} else {
+	sect = find_section(s.st_shndx);
+	if(sect == NULL) {
 	  return NULL;
 	}
 	return &(sect->address[s.st_value]);
@@ -207,6 +250,57 @@ find_local_symbol(int fd, const char *symbol,
 }
 /*---------------------------------------------------------------------------*/
 static int
+resolve_symbol(int fd, unsigned int index,
+	       unsigned int strtab, unsigned int symtab,
+	       char **addrp)
+{
+  struct symbol_cache_entry *e;
+  struct elf32_sym s;
+  char name[30];
+  char *addr;
+  struct relevant_section *sect;
+
+  e = &symbol_cache[index % SYMBOL_CACHE_SIZE];
+  if(e->key == index + 1) {
+    *addrp = e->addr;
+    return ELFLOADER_OK;
+  }
+
+  seek_read(fd, symtab + sizeof(struct elf32_sym) * index,
+	    (char *)&s, sizeof(s));
+  sect = find_section(s.st_shndx);
+  if(s.st_name != 0) {
+    seek_read(fd, strtab + s.st_name, name, sizeof(name));
+    PRINTF("name: %s\n", name);
+    addr = (char *)symtab_lookup(name);
+    if(addr == NULL) {
+      PRINTF("name not found in global: %s\n", name);
+      if(sect == NULL) {
+	PRINTF("elfloader unknown name: '%30s'\n", name);
+	memcpy(elfloader_unknown, name, sizeof(elfloader_unknown));
+	elfloader_unknown[sizeof(elfloader_unknown) - 1] = 0;
+	return ELFLOADER_SYMBOL_NOT_FOUND;
+      }
+      /* The symbol is defined in this module, so its own entry gives
+	 its location and there is no need to search the symbol table
+	 for it by name. */
+      addr = &sect->address[s.st_value];
+      PRINTF("found address %p\n", addr);
+    }
+  } else {
+    if(sect == NULL) {
+      return ELFLOADER_SEGMENT_NOT_FOUND;
+    }
+    addr = sect->address;
+  }
+
+  e->key = index + 1;
+  e->addr = addr;
+  *addrp = addr;
+  return ELFLOADER_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
 relocate_section(int fd,
 		 unsigned int section, unsigned short size,
 		 unsigned int sectionaddr,
@@ -218,12 +312,11 @@ relocate_section(int fd,
 {
   /* sectionbase added; runtime start address of current section */
   struct elf32_rela rela; /* Now used both for rel and rela data! */
+  char buf[RELA_BUFFER_ENTRIES * sizeof(struct elf32_rela)];
   int rel_size = 0;
-  struct elf32_sym s;
-  unsigned int a;
-  char name[30];
+  unsigned int a, i, len;
   char *addr;
-  struct relevant_section *sect;
+  int ret;
 
   /* determine correct relocation entry sizes */
   if(using_relas) {
@@ -231,64 +324,227 @@ relocate_section(int fd,
   } else {
     rel_size = sizeof(struct elf32_rel);
   }
-  
-  for(a = section; a < section + size; a += rel_size) {
-    seek_read(fd, a, (char *)&rela, rel_size);
-    seek_read(fd,
-	      symtab + sizeof(struct elf32_sym) * ELF32_R_SYM(rela.r_info),
-	      (char *)&s, sizeof(s));
-    if(s.st_name != 0) {
-      seek_read(fd, strtab + s.st_name, name, sizeof(name));
-      PRINTF("name: %s\n", name);
-      addr = (char *)symtab_lookup(name);
-      /* ADDED */
-      if(addr == NULL) {
-	PRINTF("name not found in global: %s\n", name);
-	addr = find_local_symbol(fd, name, symtab, symtabsize, strtab);
-	PRINTF("found address %p\n", addr);
+
+  /* Read the relocation entries sequentially, several at a time. */
+  for(a = section; a < section + size; a += len) {
+    len = section + size - a;
+    if(len > RELA_BUFFER_ENTRIES * rel_size) {
+      len = RELA_BUFFER_ENTRIES * rel_size;
+    }
+    seek_read(fd, a, buf, len);
+
+    for(i = 0; i + rel_size <= len; i += rel_size) {
+      memcpy(&rela, &buf[i], rel_size);
+      ret = resolve_symbol(fd, ELF32_R_SYM(rela.r_info), strtab, symtab, &addr);
+      if(ret != ELFLOADER_OK) {
+	return ret;
       }
-      if(addr == NULL) {
-	if(s.st_shndx == bss.number) {
-	  sect = &bss;
-	} else if(s.st_shndx == data.number) {
-	  sect = &data;
-	} else if(s.st_shndx == rodata.number) {
-	  sect = &rodata;
-	} else if(s.st_shndx == text.number) {
-	  sect = &text;
-	} else {
-	  PRINTF("elfloader unknown name: '%30s'\n", name);
-	  memcpy(elfloader_unknown, name, sizeof(elfloader_unknown));
-	  elfloader_unknown[sizeof(elfloader_unknown) - 1] = 0;
-	  return ELFLOADER_SYMBOL_NOT_FOUND;
-	}
-	addr = sect->address;
+
+      if(!using_relas) {
+	/* copy addend to rela structure */
+	seek_read(fd, sectionaddr + rela.r_offset, (char *)&rela.r_addend, 4);
       }
+
+      elfloader_arch_relocate(fd, sectionaddr, sectionbase, &rela, addr);
+    }
+  }
+  return ELFLOADER_OK;
+}
+/*---------------------------------------------------------------------------*/
+#if ELFLOADER_COMPACT
+struct celf_reader {
+  int fd;
+  unsigned int off, end;
+  unsigned char buf[16];
+  unsigned char pos, len;
+};
+
+static struct relevant_section * const celf_segments[CELF_SEGMENTS] =
+  { &text, &rodata, &data, &bss };
+/*---------------------------------------------------------------------------*/
+static unsigned short
+get16(const unsigned char *p)
+{
+  return p[0] | (p[1] << 8);
+}
+/*---------------------------------------------------------------------------*/
+static int
+celf_byte(struct celf_reader *r)
+{
+  if(r->pos == r->len) {
+    if(r->off >= r->end) {
+      return -1;
+    }
+    r->len = r->end - r->off > sizeof(r->buf) ?
+      sizeof(r->buf) : r->end - r->off;
+    seek_read(r->fd, r->off, (char *)r->buf, r->len);
+    r->off += r->len;
+    r->pos = 0;
+  }
+  return r->buf[r->pos++];
+}
+/*---------------------------------------------------------------------------*/
+static int
+celf_varint(struct celf_reader *r, unsigned long *v)
+{
+  int b, shift;
+
+  *v = 0;
+  for(shift = 0; shift < 35; shift += 7) {
+    b = celf_byte(r);
+    if(b < 0) {
+      return -1;
+    }
+    *v |= (unsigned long)(b & 0x7f) << shift;
+    if((b & 0x80) == 0) {
+      return 0;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+celf_import(int fd, unsigned int nameoff, char **addrp)
+{
+  struct symbol_cache_entry *e;
+  char name[30];
+  char *addr;
+
+  e = &symbol_cache[nameoff % SYMBOL_CACHE_SIZE];
+  if(e->key == nameoff + 1) {
+    *addrp = e->addr;
+    return ELFLOADER_OK;
+  }
+
+  seek_read(fd, nameoff, name, sizeof(name));
+  name[sizeof(name) - 1] = 0;
+  addr = (char *)symtab_lookup(name);
+  if(addr == NULL) {
+    PRINTF("elfloader unknown name: '%30s'\n", name);
+    memcpy(elfloader_unknown, name, sizeof(elfloader_unknown));
+    return ELFLOADER_SYMBOL_NOT_FOUND;
+  }
+
+  e->key = nameoff + 1;
+  e->addr = addr;
+  *addrp = addr;
+  return ELFLOADER_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+celf_relocate(int fd, unsigned int reloff, unsigned short relsize,
+	      unsigned int sectionoff, char *sectionbase,
+	      unsigned int names)
+{
+  struct celf_reader r;
+  struct elf32_rela rela;
+  unsigned long offset, delta, target, addend;
+  char *addr;
+  int type, ret;
+
+  r.fd = fd;
+  r.off = reloff;
+  r.end = reloff + relsize;
+  r.pos = r.len = 0;
+
+  /* Each relocation is the offset from the previous one, the type,
+     the target and the addend. The target is a segment number, or
+     CELF_SEGMENTS plus the offset of the name of an imported symbol.
+     The addend is zigzag encoded. */
+  for(offset = 0; r.pos < r.len || r.off < r.end; offset += delta) {
+    if(celf_varint(&r, &delta) < 0 ||
+       (type = celf_byte(&r)) < 0 ||
+       celf_varint(&r, &target) < 0 ||
+       celf_varint(&r, &addend) < 0) {
+      return ELFLOADER_BAD_ELF_HEADER;
+    }
+
+    if(target < CELF_SEGMENTS) {
+      addr = celf_segments[target]->address;
     } else {
-      if(s.st_shndx == bss.number) {
-	sect = &bss;
-      } else if(s.st_shndx == data.number) {
-	sect = &data;
-      } else if(s.st_shndx == rodata.number) {
-	sect = &rodata;
-      } else if(s.st_shndx == text.number) {
-	sect = &text;
-      } else {
-	return ELFLOADER_SEGMENT_NOT_FOUND;
+      ret = celf_import(fd, names + target - CELF_SEGMENTS, &addr);
+      if(ret != ELFLOADER_OK) {
+	return ret;
       }
-      
-      addr = sect->address;
     }
 
-    if(!using_relas) {
-      /* copy addend to rela structure */
-      seek_read(fd, sectionaddr + rela.r_offset, (char *)&rela.r_addend, 4);
-    }
+    rela.r_offset = offset + delta;
+    rela.r_info = type;
+    rela.r_addend = (elf32_sword)(addend >> 1) ^ -(elf32_sword)(addend & 1);
+    elfloader_arch_relocate(fd, sectionoff, sectionbase, &rela, addr);
+  }
+  return ELFLOADER_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+load_compact(int fd)
+{
+  unsigned char hdr[CELF_HDRSIZE];
+  unsigned short textsize, rodatasize, datasize, bsssize, namesize;
+  unsigned short textrelsize, rodatarelsize, datarelsize;
+  unsigned short autostart_segment, autostart_offset;
+  unsigned int names, textoff, rodataoff, dataoff, reloff;
+  int ret;
+
+  seek_read(fd, 0, (char *)hdr, sizeof(hdr));
+  textsize = get16(&hdr[4]);
+  rodatasize = get16(&hdr[6]);
+  datasize = get16(&hdr[8]);
+  bsssize = get16(&hdr[10]);
+  namesize = get16(&hdr[12]);
+  textrelsize = get16(&hdr[14]);
+  rodatarelsize = get16(&hdr[16]);
+  datarelsize = get16(&hdr[18]);
+  autostart_segment = get16(&hdr[20]);
+  autostart_offset = get16(&hdr[22]);
 
-    elfloader_arch_relocate(fd, sectionaddr, sectionbase, &rela, addr);
+  if(textsize == 0) {
+    return ELFLOADER_NO_TEXT;
   }
+
+  names = CELF_HDRSIZE;
+  textoff = names + namesize;
+  rodataoff = textoff + textsize;
+  dataoff = rodataoff + rodatasize;
+  reloff = dataoff + datasize;
+
+  bss.address = (char *)elfloader_arch_allocate_ram(bsssize + datasize);
+  data.address = (char *)bss.address + bsssize;
+  text.address = (char *)elfloader_arch_allocate_rom(textsize + rodatasize);
+  rodata.address = (char *)text.address + textsize;
+
+  ret = celf_relocate(fd, reloff, textrelsize,
+		      textoff, text.address, names);
+  if(ret != ELFLOADER_OK) {
+    return ret;
+  }
+  reloff += textrelsize;
+  ret = celf_relocate(fd, reloff, rodatarelsize,
+		      rodataoff, rodata.address, names);
+  if(ret != ELFLOADER_OK) {
+    return ret;
+  }
+  reloff += rodatarelsize;
+  ret = celf_relocate(fd, reloff, datarelsize,
+		      dataoff, data.address, names);
+  if(ret != ELFLOADER_OK) {
+    return ret;
+  }
+
+  elfloader_arch_write_rom(fd, textoff, textsize, text.address);
+  elfloader_arch_write_rom(fd, rodataoff, rodatasize, rodata.address);
+
+  memset(bss.address, 0, bsssize);
+  seek_read(fd, dataoff, data.address, datasize);
+
+  if(autostart_segment >= CELF_SEGMENTS) {
+    return ELFLOADER_NO_STARTPOINT;
+  }
+  elfloader_autostart_processes = (struct process **)
+    &celf_segments[autostart_segment]->address[autostart_offset];
   return ELFLOADER_OK;
 }
+#endif /* ELFLOADER_COMPACT */
 /*---------------------------------------------------------------------------*/
 static void *
 find_program_processes(int fd,
@@ -361,10 +617,17 @@ elfloader_load(int fd)
   int ret;
 
   elfloader_unknown[0] = 0;
+  memset(symbol_cache, 0, sizeof(symbol_cache));
 
   /* The ELF header is located at the start of the buffer. */
   seek_read(fd, 0, (char *)&ehdr, sizeof(ehdr));
 
+#if ELFLOADER_COMPACT
+  if(memcmp(ehdr.e_ident, CELF_MAGIC, CELF_MAGIC_SIZE) == 0) {
+    return load_compact(fd);
+  }
+#endif /* ELFLOADER_COMPACT */
+
   /*  print_chars(ehdr.e_ident, sizeof(elf_magic_header));
       print_chars(elf_magic_header, sizeof(elf_magic_header));*/
   /* Make sure that we have a correct and compatible ELF header. */
@@ -140,6 +140,11 @@ void elfloader_init(void);
  *             to the process structure in the model is stored in the
  *             elfloader_loaded_process variable.
  *
+ *             With ELFLOADER_CONF_COMPACT, the file may also be a
+ *             compact module made by tools/elf2celf, which has the
+ *             symbols resolved and the relocations compressed at
+ *             build time.
+ *
  * \note       This function modifies the ELF file opened with cfs_open()!
  *             If the contents of the file is required to be intact,
  *             the file must be backed up first.
@@ -158,6 +163,16 @@ extern struct process * const * elfloader_autostart_processes;
  */
 extern char elfloader_unknown[30];
 
+/**
+ * Whether elfloader_load() accepts compact modules (CELF) as well as
+ * ELF files.
+ */
+#ifdef ELFLOADER_CONF_COMPACT
+#define ELFLOADER_COMPACT ELFLOADER_CONF_COMPACT
+#else
+#define ELFLOADER_COMPACT 1
+#endif
+
 #ifndef ELFLOADER_DATAMEMORY_SIZE
 #ifdef ELFLOADER_CONF_DATAMEMORY_SIZE
 #define ELFLOADER_DATAMEMORY_SIZE ELFLOADER_CONF_DATAMEMORY_SIZE
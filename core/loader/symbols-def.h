@@ -39,6 +39,10 @@ struct symbols {
 
 extern const int symbols_nelts;
 
+/* Only needed with SYMTAB_CONF_HASH, see core/loader/symtab.c. */
+extern const int symbols_hash_size;
+extern const unsigned short symbols_hash[];
+
 extern const struct symbols symbols[/* symbols_nelts */];
 
 #endif /* __SYMBOLS_DEF_H__ */
@@ -41,8 +41,45 @@
 #define SYMTAB_CONF_BINARY_SEARCH 1
 #endif
 
+/* Hashed lookup needs the symbols_hash[] table generated by
+   tools/mknmlist, but takes a couple of string comparisons per
+   symbol regardless of the number of symbols. */
+#ifndef SYMTAB_CONF_HASH
+#define SYMTAB_CONF_HASH 0
+#endif
+
+/*---------------------------------------------------------------------------*/
+#if SYMTAB_CONF_HASH
+/* The hash function must match the one in tools/mknmlist. */
+static unsigned short
+hash(const char *name)
+{
+  unsigned short h;
+
+  for(h = 5381; *name != 0; ++name) {
+    h = h * 33 + (unsigned char)*name;
+  }
+  return h;
+}
 /*---------------------------------------------------------------------------*/
-#if SYMTAB_CONF_BINARY_SEARCH
+void *
+symtab_lookup(const char *name)
+{
+  unsigned short i, n;
+
+  /* symbols_hash[] is an open addressing table of indices into
+     symbols[], plus one, with zero marking an empty slot. Its size is
+     a power of two with at least one empty slot. */
+  i = hash(name) & (symbols_hash_size - 1);
+  while((n = symbols_hash[i]) != 0) {
+    if(strcmp(name, symbols[n - 1].name) == 0) {
+      return symbols[n - 1].value;
+    }
+    i = (i + 1) & (symbols_hash_size - 1);
+  }
+  return NULL;
+}
+#elif SYMTAB_CONF_BINARY_SEARCH
 void *
 symtab_lookup(const char *name)
 {
@@ -55,6 +92,11 @@ symtab_lookup(const char *name)
   while(start <= end) {
     /* Check middle, divide */
     middle = (start + end) / 2;
+    if(symbols[middle].name == NULL) {
+      /* The terminating entry sorts after all names. */
+      end = middle - 1;
+      continue;
+    }
     r = strcmp(name, symbols[middle].name);
     if(r < 0) {
       end = middle - 1;
@@ -66,7 +108,7 @@ symtab_lookup(const char *name)
   }
   return NULL;
 }
-#else /* SYMTAB_CONF_BINARY_SEARCH */
+#else /* SYMTAB_CONF_HASH */
 void *
 symtab_lookup(const char *name)
 {
@@ -78,5 +120,5 @@ symtab_lookup(const char *name)
   }
   return 0;
 }
-#endif /* SYMTAB_CONF_BINARY_SEARCH */
+#endif /* SYMTAB_CONF_HASH */
 /*---------------------------------------------------------------------------*/
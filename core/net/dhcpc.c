@@ -35,12 +35,61 @@
 
 #include "contiki.h"
 #include "contiki-net.h"
+#include "lib/random.h"
 #include "net/dhcpc.h"
 
+/* Ask for the two-message exchange of RFC 4039 in DISCOVERs. */
+#ifdef DHCPC_CONF_RAPID_COMMIT
+#define DHCPC_RAPID_COMMIT DHCPC_CONF_RAPID_COMMIT
+#else
+#define DHCPC_RAPID_COMMIT 1
+#endif
+
+/* Keep the lease in CFS and ask for it again after a reboot. */
+#ifdef DHCPC_CONF_PERSIST
+#define DHCPC_PERSIST DHCPC_CONF_PERSIST
+#else
+#define DHCPC_PERSIST 0
+#endif
+
+#if DHCPC_PERSIST
+#include "cfs/cfs.h"
+
+#ifdef DHCPC_CONF_PERSIST_FILE
+#define DHCPC_PERSIST_FILE DHCPC_CONF_PERSIST_FILE
+#else
+#define DHCPC_PERSIST_FILE "dhcpc"
+#endif
+
+#define DHCPC_PERSIST_VERSION 1
+
+struct dhcpc_lease {
+  uint8_t version;
+  uint8_t mac_len;
+  uint8_t mac_addr[16];
+  uint8_t serverid[4];
+  uint16_t lease_time[2];
+  uip_ipaddr_t ipaddr;
+  uip_ipaddr_t netmask;
+  uip_ipaddr_t dnsaddr;
+  uip_ipaddr_t default_router;
+};
+#endif /* DHCPC_PERSIST */
+
+/* Retransmissions start after TIMEOUT_MIN and back off exponentially
+   up to TIMEOUT_MAX, randomized by up to half a second either way. */
+#define TIMEOUT_MIN CLOCK_SECOND
+#define TIMEOUT_MAX (CLOCK_SECOND * 64)
+
+/* REQUESTs sent before going back to DISCOVER. */
+#define REQUEST_ATTEMPTS 4
+#define REBOOT_ATTEMPTS  2
+
 #define STATE_INITIAL         0
 #define STATE_SENDING         1
 #define STATE_OFFER_RECEIVED  2
 #define STATE_CONFIG_RECEIVED 3
+#define STATE_REBOOTING       4
 
 static struct dhcpc_state s;
 
@@ -87,9 +136,11 @@ struct dhcp_msg {
 #define DHCP_OPTION_MSG_TYPE     53
 #define DHCP_OPTION_SERVER_ID    54
 #define DHCP_OPTION_REQ_LIST     55
+#define DHCP_OPTION_RAPID_COMMIT 80
 #define DHCP_OPTION_END         255
 
 static uint32_t xid;
+static uint8_t attempts;
 static const uint8_t magic_cookie[4] = {99, 130, 83, 99};
 /*---------------------------------------------------------------------------*/
 static uint8_t *
@@ -130,6 +181,16 @@ add_req_options(uint8_t *optptr)
   return optptr;
 }
 /*---------------------------------------------------------------------------*/
+#if DHCPC_RAPID_COMMIT
+static uint8_t *
+add_rapid_commit(uint8_t *optptr)
+{
+  *optptr++ = DHCP_OPTION_RAPID_COMMIT;
+  *optptr++ = 0;
+  return optptr;
+}
+#endif /* DHCPC_RAPID_COMMIT */
+/*---------------------------------------------------------------------------*/
 static uint8_t *
 add_end(uint8_t *optptr)
 {
@@ -172,6 +233,9 @@ send_discover(void)
 
   end = add_msg_type(&m->options[4], DHCPDISCOVER);
   end = add_req_options(end);
+#if DHCPC_RAPID_COMMIT
+  end = add_rapid_commit(end);
+#endif /* DHCPC_RAPID_COMMIT */
   end = add_end(end);
 
   uip_send(uip_appdata, (int)(end - (uint8_t *)uip_appdata));
@@ -186,8 +250,13 @@ send_request(void)
   create_msg(m);
   
   end = add_msg_type(&m->options[4], DHCPREQUEST);
-  end = add_server_id(end);
+  /* A rebooting client asks for its old address without naming the
+     server that handed it out (RFC 2131, section 4.3.2). */
+  if(s.state != STATE_REBOOTING) {
+    end = add_server_id(end);
+  }
   end = add_req_ipaddr(end);
+  end = add_req_options(end);
   end = add_end(end);
   
   uip_send(uip_appdata, (int)(end - (uint8_t *)uip_appdata));
@@ -267,63 +336,168 @@ msg_for_me(void)
   return -1;
 }
 /*---------------------------------------------------------------------------*/
+static void
+set_retransmit_timer(void)
+{
+  clock_time_t t;
+
+  t = s.ticks - CLOCK_SECOND / 2 + random_rand() % CLOCK_SECOND;
+  etimer_set(&s.etimer, t);
+  if(s.ticks < TIMEOUT_MAX) {
+    s.ticks *= 2;
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if DHCPC_PERSIST
+static void
+save_lease(void)
+{
+  struct dhcpc_lease l;
+  int fd;
+
+  memset(&l, 0, sizeof(l));
+  l.version = DHCPC_PERSIST_VERSION;
+  l.mac_len = s.mac_len < sizeof(l.mac_addr) ? s.mac_len : sizeof(l.mac_addr);
+  memcpy(l.mac_addr, s.mac_addr, l.mac_len);
+  memcpy(l.serverid, s.serverid, sizeof(l.serverid));
+  memcpy(l.lease_time, s.lease_time, sizeof(l.lease_time));
+  uip_ipaddr_copy(&l.ipaddr, &s.ipaddr);
+  uip_ipaddr_copy(&l.netmask, &s.netmask);
+  uip_ipaddr_copy(&l.dnsaddr, &s.dnsaddr);
+  uip_ipaddr_copy(&l.default_router, &s.default_router);
+
+  cfs_remove(DHCPC_PERSIST_FILE);
+  fd = cfs_open(DHCPC_PERSIST_FILE, CFS_WRITE);
+  if(fd >= 0) {
+    cfs_write(fd, &l, sizeof(l));
+    cfs_close(fd);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+load_lease(void)
+{
+  struct dhcpc_lease l;
+  int fd, len;
+
+  fd = cfs_open(DHCPC_PERSIST_FILE, CFS_READ);
+  if(fd < 0) {
+    return 0;
+  }
+  len = cfs_read(fd, &l, sizeof(l));
+  cfs_close(fd);
+
+  if(len != sizeof(l) || l.version != DHCPC_PERSIST_VERSION ||
+     l.mac_len != (s.mac_len < sizeof(l.mac_addr) ?
+                   s.mac_len : sizeof(l.mac_addr)) ||
+     memcmp(l.mac_addr, s.mac_addr, l.mac_len) != 0) {
+    return 0;
+  }
+
+  memcpy(s.serverid, l.serverid, sizeof(s.serverid));
+  memcpy(s.lease_time, l.lease_time, sizeof(s.lease_time));
+  uip_ipaddr_copy(&s.ipaddr, &l.ipaddr);
+  uip_ipaddr_copy(&s.netmask, &l.netmask);
+  uip_ipaddr_copy(&s.dnsaddr, &l.dnsaddr);
+  uip_ipaddr_copy(&s.default_router, &l.default_router);
+  return 1;
+}
+#endif /* DHCPC_PERSIST */
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(handle_dhcp(process_event_t ev, void *data))
 {
   clock_time_t ticks;
 
   PT_BEGIN(&s.pt);
+
+#if DHCPC_PERSIST
+  if(load_lease()) {
+    /* INIT-REBOOT: ask for the address we had before the reboot. A
+       NAK, or no answer at all, falls back to a full DISCOVER. */
+    xid++;
+    s.state = STATE_REBOOTING;
+    s.ticks = TIMEOUT_MIN;
+    for(attempts = 0; attempts < REBOOT_ATTEMPTS; attempts++) {
+      while(ev != tcpip_event) {
+        tcpip_poll_udp(s.conn);
+        PT_YIELD(&s.pt);
+      }
+      send_request();
+      set_retransmit_timer();
+      do {
+        PT_YIELD(&s.pt);
+        if(ev == tcpip_event && uip_newdata()) {
+          if(msg_for_me() == DHCPACK) {
+            parse_msg();
+            s.state = STATE_CONFIG_RECEIVED;
+            goto bound;
+          } else if(msg_for_me() == DHCPNAK) {
+            cfs_remove(DHCPC_PERSIST_FILE);
+            goto init;
+          }
+        }
+      } while(!etimer_expired(&s.etimer));
+    }
+  }
+#endif /* DHCPC_PERSIST */
   
  init:
   xid++;
   s.state = STATE_SENDING;
-  s.ticks = CLOCK_SECOND;
+  s.ticks = TIMEOUT_MIN;
   while (1) {
     while(ev != tcpip_event) {
       tcpip_poll_udp(s.conn);
       PT_YIELD(&s.pt);
     }
     send_discover();
-    etimer_set(&s.etimer, s.ticks);
+    set_retransmit_timer();
     do {
       PT_YIELD(&s.pt);
-      if(ev == tcpip_event && uip_newdata() && msg_for_me() == DHCPOFFER) {
-	parse_msg();
-	s.state = STATE_OFFER_RECEIVED;
-	goto selecting;
+      if(ev == tcpip_event && uip_newdata()) {
+        if(msg_for_me() == DHCPOFFER) {
+          parse_msg();
+          s.state = STATE_OFFER_RECEIVED;
+          goto selecting;
+        }
+#if DHCPC_RAPID_COMMIT
+        /* Only a server that does Rapid Commit answers a DISCOVER
+           with an ACK. */
+        if(msg_for_me() == DHCPACK) {
+          parse_msg();
+          s.state = STATE_CONFIG_RECEIVED;
+          goto bound;
+        }
+#endif /* DHCPC_RAPID_COMMIT */
       }
     } while (!etimer_expired(&s.etimer));
-
-    if(s.ticks < CLOCK_SECOND * 60) {
-      s.ticks *= 2;
-    }
   }
   
  selecting:
   xid++;
-  s.ticks = CLOCK_SECOND;
-  do {
+  s.ticks = TIMEOUT_MIN;
+  for(attempts = 0; attempts < REQUEST_ATTEMPTS; attempts++) {
     while(ev != tcpip_event) {
       tcpip_poll_udp(s.conn);
       PT_YIELD(&s.pt);
     }
     send_request();
-    etimer_set(&s.etimer, s.ticks);
+    set_retransmit_timer();
     do {
       PT_YIELD(&s.pt);
-      if(ev == tcpip_event && uip_newdata() && msg_for_me() == DHCPACK) {
-	parse_msg();
-	s.state = STATE_CONFIG_RECEIVED;
-	goto bound;
+      if(ev == tcpip_event && uip_newdata()) {
+        if(msg_for_me() == DHCPACK) {
+          parse_msg();
+          s.state = STATE_CONFIG_RECEIVED;
+          goto bound;
+        } else if(msg_for_me() == DHCPNAK) {
+          goto init;
+        }
       }
     } while (!etimer_expired(&s.etimer));
-
-    if(s.ticks <= CLOCK_SECOND * 10) {
-      s.ticks += CLOCK_SECOND;
-    } else {
-      goto init;
-    }
-  } while(s.state != STATE_CONFIG_RECEIVED);
+  }
+  goto init;
   
  bound:
 #if 0
@@ -336,6 +510,9 @@ PT_THREAD(handle_dhcp(process_event_t ev, void *data))
 	 uip_ntohs(s.lease_time[0])*65536ul + uip_ntohs(s.lease_time[1]));
 #endif
 
+#if DHCPC_PERSIST
+  save_lease();
+#endif /* DHCPC_PERSIST */
   dhcpc_configured(&s);
   
 #define MAX_TICKS (~((clock_time_t)0) / 2)
@@ -388,6 +565,9 @@ PT_THREAD(handle_dhcp(process_event_t ev, void *data))
   /* rebinding: */
 
   /* lease_expired: */
+#if DHCPC_PERSIST
+  cfs_remove(DHCPC_PERSIST_FILE);
+#endif /* DHCPC_PERSIST */
   dhcpc_unconfigured(&s);
   goto init;
 
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Link statistics: per-neighbor ETX, RSSI, freshness and
+ *         transmission counters, kept in a neighbor table.
+ */
+
+#include "net/link-stats.h"
+#include "net/nbr-table.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "sys/ctimer.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+/* EWMA weight, in percent, given to the old ETX. A lower weight is
+   used until the link is fresh so that new links converge quickly. */
+#define ETX_ALPHA           90
+#define ETX_BOOTSTRAP_ALPHA 70
+#define ETX_SCALE           100
+
+#define FRESHNESS_MAX 16
+
+/* The freshness timer ticks once a minute so that the half life fits
+   in a clock_time_t on all platforms. */
+#define FRESHNESS_TICK 60
+
+NBR_TABLE(struct link_stats, link_stats);
+
+static struct ctimer periodic_timer;
+static uint16_t freshness_ticks;
+
+/*---------------------------------------------------------------------------*/
+const struct link_stats *
+link_stats_from_lladdr(const rimeaddr_t *lladdr)
+{
+  return nbr_table_get_from_lladdr(link_stats, lladdr);
+}
+/*---------------------------------------------------------------------------*/
+int
+link_stats_is_fresh(const struct link_stats *stats)
+{
+  return stats != NULL &&
+    stats->freshness >= LINK_STATS_FRESHNESS_TARGET &&
+    clock_seconds() - stats->last_tx_time < LINK_STATS_FRESHNESS_EXPIRATION;
+}
+/*---------------------------------------------------------------------------*/
+void
+link_stats_packet_sent(const rimeaddr_t *lladdr, int status, int numtx)
+{
+  struct link_stats *stats;
+  uint16_t packet_etx;
+  uint8_t alpha;
+
+  if(rimeaddr_cmp(lladdr, &rimeaddr_null)) {
+    /* Broadcasts are not acknowledged. */
+    return;
+  }
+
+  /* Collisions and transmission errors say nothing about the link. */
+  if(status != MAC_TX_OK && status != MAC_TX_NOACK) {
+    return;
+  }
+
+  stats = nbr_table_get_from_lladdr(link_stats, lladdr);
+  if(stats == NULL) {
+    stats = nbr_table_add_lladdr(link_stats, lladdr);
+    if(stats == NULL) {
+      return;
+    }
+  }
+
+  stats->last_tx_time = clock_seconds();
+  if(stats->tx_count <= 0xffff - numtx) {
+    stats->tx_count += numtx;
+  }
+
+  if(status == MAC_TX_OK) {
+    packet_etx = numtx * LINK_STATS_ETX_DIVISOR;
+    if(stats->ack_count < 0xffff) {
+      stats->ack_count++;
+    }
+  } else {
+    packet_etx = LINK_STATS_ETX_NOACK_PENALTY * LINK_STATS_ETX_DIVISOR;
+  }
+
+  if(stats->etx == 0) {
+    /* The first sample is the best estimate we have. */
+    stats->etx = packet_etx;
+  } else {
+    alpha = link_stats_is_fresh(stats) ? ETX_ALPHA : ETX_BOOTSTRAP_ALPHA;
+    stats->etx = ((uint32_t)stats->etx * alpha +
+                  (uint32_t)packet_etx * (ETX_SCALE - alpha)) / ETX_SCALE;
+  }
+
+  stats->freshness += numtx;
+  if(stats->freshness > FRESHNESS_MAX) {
+    stats->freshness = FRESHNESS_MAX;
+  }
+
+  PRINTF("link-stats: ETX to ");
+  PRINTLLADDR((const uip_lladdr_t *)lladdr);
+  PRINTF(" is %u.%02u (packet ETX %u)\n",
+         stats->etx / LINK_STATS_ETX_DIVISOR,
+         (stats->etx % LINK_STATS_ETX_DIVISOR) * 100 / LINK_STATS_ETX_DIVISOR,
+         packet_etx / LINK_STATS_ETX_DIVISOR);
+}
+/*---------------------------------------------------------------------------*/
+void
+link_stats_input_callback(const rimeaddr_t *lladdr)
+{
+  struct link_stats *stats;
+
+  /* Only neighbors that we have sent to are tracked, so that
+     overheard traffic does not push real neighbors out of the
+     neighbor tables. */
+  stats = nbr_table_get_from_lladdr(link_stats, lladdr);
+  if(stats == NULL) {
+    return;
+  }
+
+  stats->rssi = (int16_t)packetbuf_attr(PACKETBUF_ATTR_RSSI);
+  if(stats->rx_count < 0xffff) {
+    stats->rx_count++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+periodic(void *ptr)
+{
+  struct link_stats *stats;
+
+  ctimer_reset(&periodic_timer);
+
+  if(++freshness_ticks < LINK_STATS_FRESHNESS_HALF_LIFE / FRESHNESS_TICK) {
+    return;
+  }
+  freshness_ticks = 0;
+
+  for(stats = nbr_table_head(link_stats); stats != NULL;
+      stats = nbr_table_next(link_stats, stats)) {
+    stats->freshness >>= 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+link_stats_init(void)
+{
+  nbr_table_register(link_stats, NULL);
+  ctimer_set(&periodic_timer, FRESHNESS_TICK * CLOCK_SECOND, periodic, NULL);
+}
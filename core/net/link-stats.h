@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Link statistics: per-neighbor ETX, RSSI, freshness and
+ *         transmission counters, shared by the routing protocols.
+ */
+
+#ifndef LINK_STATS_H_
+#define LINK_STATS_H_
+
+#include "contiki.h"
+#include "net/rime/rimeaddr.h"
+
+/* ETX fixed point divisor. 128 is the value used by RPL (RFC 6551). */
+#define LINK_STATS_ETX_DIVISOR 128
+
+/* The ETX recorded for a unicast that was never acknowledged. */
+#ifdef LINK_STATS_CONF_ETX_NOACK_PENALTY
+#define LINK_STATS_ETX_NOACK_PENALTY LINK_STATS_CONF_ETX_NOACK_PENALTY
+#else
+#define LINK_STATS_ETX_NOACK_PENALTY 10
+#endif
+
+/* A link is fresh when at least LINK_STATS_FRESHNESS_TARGET
+   transmissions have been recorded recently and the last one is no
+   older than LINK_STATS_FRESHNESS_EXPIRATION seconds. The freshness
+   counter is halved every LINK_STATS_FRESHNESS_HALF_LIFE seconds. */
+#ifdef LINK_STATS_CONF_FRESHNESS_TARGET
+#define LINK_STATS_FRESHNESS_TARGET LINK_STATS_CONF_FRESHNESS_TARGET
+#else
+#define LINK_STATS_FRESHNESS_TARGET 4
+#endif
+
+#ifdef LINK_STATS_CONF_FRESHNESS_EXPIRATION
+#define LINK_STATS_FRESHNESS_EXPIRATION LINK_STATS_CONF_FRESHNESS_EXPIRATION
+#else
+#define LINK_STATS_FRESHNESS_EXPIRATION (10 * 60)
+#endif
+
+#ifdef LINK_STATS_CONF_FRESHNESS_HALF_LIFE
+#define LINK_STATS_FRESHNESS_HALF_LIFE LINK_STATS_CONF_FRESHNESS_HALF_LIFE
+#else
+#define LINK_STATS_FRESHNESS_HALF_LIFE (15 * 60)
+#endif
+
+struct link_stats {
+  unsigned long last_tx_time; /* clock_seconds() of the last transmission */
+  uint16_t etx;               /* ETX in LINK_STATS_ETX_DIVISOR units, 0 if unknown */
+  int16_t rssi;               /* RSSI of the last packet received */
+  uint16_t tx_count;          /* Transmissions, including retransmissions */
+  uint16_t ack_count;         /* Acknowledged unicasts */
+  uint16_t rx_count;          /* Packets received */
+  uint8_t freshness;          /* Recent transmissions, halved periodically */
+};
+
+/** \brief Initialize the link statistics module */
+void link_stats_init(void);
+
+/** \brief The statistics for a neighbor, or NULL if nothing was sent to it */
+const struct link_stats *link_stats_from_lladdr(const rimeaddr_t *lladdr);
+
+/** \brief Non-zero if the statistics are based on recent transmissions */
+int link_stats_is_fresh(const struct link_stats *stats);
+
+/** \brief Record the outcome of a unicast, called from the MAC callback */
+void link_stats_packet_sent(const rimeaddr_t *lladdr, int status, int numtx);
+
+/** \brief Record a packet received from a neighbor */
+void link_stats_input_callback(const rimeaddr_t *lladdr);
+
+#endif /* LINK_STATS_H_ */
@@ -48,6 +48,7 @@
 #include "net/netstack.h"
 #include "net/rime.h"
 #include "sys/compower.h"
+#include "sys/energest.h"
 #include "sys/pt.h"
 #include "sys/rtimer.h"
 
@@ -83,12 +84,59 @@
 #ifndef RDC_CONF_MCU_SLEEP
 #define RDC_CONF_MCU_SLEEP           0
 #endif
+/* Each node listens for unicasts on its own channel */
+#ifdef CONTIKIMAC_CONF_MULTICHANNEL
+#define WITH_MULTICHANNEL            CONTIKIMAC_CONF_MULTICHANNEL
+#else
+#define WITH_MULTICHANNEL            0
+#endif
 
 #if NETSTACK_RDC_CHANNEL_CHECK_RATE >= 64
 #undef WITH_PHASE_OPTIMIZATION
 #define WITH_PHASE_OPTIMIZATION 0
 #endif
 
+/* With CONTIKIMAC_CONF_ADAPTIVE_RATE, a node that receives much
+   traffic checks the channel up to 2^CONTIKIMAC_CONF_MAX_RATE_SHIFT
+   times as often as NETSTACK_RDC_CHANNEL_CHECK_RATE, which stays the
+   rate of idle nodes. The faster checks keep the wake-ups of the base
+   rate, so the phases learned by neighbors remain valid. The current
+   rate is advertised in the ContikiMAC header, and senders that know
+   the phase of a receiver strobe only for its cycle. All nodes of a
+   network must agree on this setting. */
+#ifdef CONTIKIMAC_CONF_ADAPTIVE_RATE
+#define ADAPTIVE_RATE                CONTIKIMAC_CONF_ADAPTIVE_RATE
+#else
+#define ADAPTIVE_RATE                0
+#endif
+
+#ifdef CONTIKIMAC_CONF_MAX_RATE_SHIFT
+#define MAX_RATE_SHIFT               CONTIKIMAC_CONF_MAX_RATE_SHIFT
+#else
+#define MAX_RATE_SHIFT               2
+#endif
+
+/* The rate goes up after an interval with at least RATE_UP_PACKETS
+   received packets, and down after one with fewer than
+   RATE_DOWN_PACKETS. */
+#ifdef CONTIKIMAC_CONF_RATE_INTERVAL
+#define RATE_INTERVAL                CONTIKIMAC_CONF_RATE_INTERVAL
+#else
+#define RATE_INTERVAL                (8 * CLOCK_SECOND)
+#endif
+
+#ifdef CONTIKIMAC_CONF_RATE_UP_PACKETS
+#define RATE_UP_PACKETS              CONTIKIMAC_CONF_RATE_UP_PACKETS
+#else
+#define RATE_UP_PACKETS              8
+#endif
+
+#ifdef CONTIKIMAC_CONF_RATE_DOWN_PACKETS
+#define RATE_DOWN_PACKETS            CONTIKIMAC_CONF_RATE_DOWN_PACKETS
+#else
+#define RATE_DOWN_PACKETS            2
+#endif
+
 #if WITH_CONTIKIMAC_HEADER
 #define CONTIKIMAC_ID 0x00
 
@@ -114,6 +162,23 @@ struct hdr {
  */
 #if RTIMER_ARCH_SECOND & (RTIMER_ARCH_SECOND - 1)
 #define SYNC_CYCLE_STARTS                    1
+#if ADAPTIVE_RATE
+#warning "CONTIKIMAC_CONF_ADAPTIVE_RATE needs a power of two RTIMER_ARCH_SECOND, disabled"
+#undef ADAPTIVE_RATE
+#define ADAPTIVE_RATE                        0
+#endif
+#endif
+
+#if ADAPTIVE_RATE
+/* The rate is CHANNEL_CHECK_RATE << rate_shift. A new rate takes
+   effect at the start of a base cycle. */
+static volatile uint8_t rate_shift, next_rate_shift;
+static uint8_t rx_packets;
+static struct ctimer rate_timer;
+#define POWERCYCLE_TIME                      (CYCLE_TIME >> rate_shift)
+#define RATE_SHIFT_MASK                      0x0f
+#else
+#define POWERCYCLE_TIME                      CYCLE_TIME
 #endif
 
 /* Are we currently receiving a burst? */
@@ -133,6 +198,26 @@ static int we_are_receiving_burst = 0;
 #define CCA_COUNT_MAX                      2
 #endif
 
+#if WITH_MULTICHANNEL
+/* The channels that nodes listen for unicasts on. A node listens on
+   the channel picked by its address, and checks the broadcast channel
+   after its own channel. */
+#ifdef CONTIKIMAC_CONF_CHANNELS
+#define CHANNELS                           CONTIKIMAC_CONF_CHANNELS
+#else
+#define CHANNELS { 11, 12, 13, 14, 15, 16, 17, 18, \
+                   19, 20, 21, 22, 23, 24, 25, 26 }
+#endif
+#ifdef CONTIKIMAC_CONF_BROADCAST_CHANNEL
+#define BROADCAST_CHANNEL                  CONTIKIMAC_CONF_BROADCAST_CHANNEL
+#else
+#define BROADCAST_CHANNEL                  26
+#endif
+#define CCA_ROUNDS                         2
+#else /* WITH_MULTICHANNEL */
+#define CCA_ROUNDS                         1
+#endif /* WITH_MULTICHANNEL */
+
 /* Before starting a transmission, Contikimac checks the availability
    of the channel with CCA_COUNT_MAX_TX consecutive CCAs */
 #ifdef CONTIKIMAC_CONF_CCA_COUNT_MAX_TX
@@ -190,6 +275,15 @@ static int we_are_receiving_burst = 0;
    a transmitted should begin transmitting packets. */
 #define GUARD_TIME                         10 * CHECK_TIME + CHECK_TIME_TX
 
+/* SFD_GUARD_TIME is the guard time used with radios that timestamp
+   the start of frame delimiter in hardware. The phases are then
+   learnt without the software latency of starting a transmission. */
+#ifdef CONTIKIMAC_CONF_SFD_GUARD_TIME
+#define SFD_GUARD_TIME                     CONTIKIMAC_CONF_SFD_GUARD_TIME
+#else
+#define SFD_GUARD_TIME                     8 * CHECK_TIME + CHECK_TIME_TX
+#endif
+
 /* INTER_PACKET_INTERVAL is the interval between two successive packet transmissions */
 #ifdef CONTIKIMAC_CONF_INTER_PACKET_INTERVAL
 #define INTER_PACKET_INTERVAL              CONTIKIMAC_CONF_INTER_PACKET_INTERVAL
@@ -237,6 +331,9 @@ static volatile uint8_t contikimac_keep_radio_on = 0;
 static volatile unsigned char we_are_sending = 0;
 static volatile unsigned char radio_is_on = 0;
 
+/* The RADIO_CAP_ flags of the radio */
+static uint8_t radio_capabilities;
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -365,6 +462,34 @@ powercycle_turn_radio_on(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if WITH_MULTICHANNEL
+static const uint8_t channels[] = CHANNELS;
+
+static uint8_t
+channel_for(const rimeaddr_t *addr)
+{
+  uint16_t sum;
+  uint8_t i;
+
+  if(rimeaddr_cmp(addr, &rimeaddr_null)) {
+    return BROADCAST_CHANNEL;
+  }
+  sum = 0;
+  for(i = 0; i < sizeof(rimeaddr_t); i++) {
+    sum += addr->u8[i];
+  }
+  return channels[sum % sizeof(channels)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_channel(uint8_t channel)
+{
+  if(NETSTACK_RADIO.set_channel != NULL) {
+    NETSTACK_RADIO.set_channel(channel);
+  }
+}
+#endif /* WITH_MULTICHANNEL */
+/*---------------------------------------------------------------------------*/
 static char
 powercycle(struct rtimer *t, void *ptr)
 {
@@ -401,14 +526,31 @@ powercycle(struct rtimer *t, void *ptr)
 #endif
     }
 #else
-    cycle_start += CYCLE_TIME;
+    cycle_start += POWERCYCLE_TIME;
+#if ADAPTIVE_RATE
+    {
+      static uint8_t sub_cycle;
+      sub_cycle = (sub_cycle + 1) & ((1 << rate_shift) - 1);
+      if(sub_cycle == 0) {
+        rate_shift = next_rate_shift;
+      }
+    }
+#endif /* ADAPTIVE_RATE */
 #endif
 
     packet_seen = 0;
 
-    for(count = 0; count < CCA_COUNT_MAX; ++count) {
+    for(count = 0; count < CCA_COUNT_MAX * CCA_ROUNDS; ++count) {
       t0 = RTIMER_NOW();
       if(we_are_sending == 0 && we_are_receiving_burst == 0) {
+#if WITH_MULTICHANNEL
+        if(count % CCA_COUNT_MAX == 0) {
+          /* Check our own channel, then the broadcast channel */
+          set_channel(count == 0 ? channel_for(&rimeaddr_node_addr) :
+                      BROADCAST_CHANNEL);
+        }
+#endif /* WITH_MULTICHANNEL */
+        ENERGEST_EXTENDED_ON(ENERGEST_TYPE_CCA);
         powercycle_turn_radio_on();
         /* Check if a packet is seen in the air. If so, we keep the
              radio on for a while (LISTEN_TIME_AFTER_PACKET_DETECTED) to
@@ -417,10 +559,12 @@ powercycle(struct rtimer *t, void *ptr)
              false positive: a spurious radio interference that was not
              caused by an incoming packet. */
         if(NETSTACK_RADIO.channel_clear() == 0) {
+          ENERGEST_EXTENDED_OFF(ENERGEST_TYPE_CCA);
           packet_seen = 1;
           break;
         }
         powercycle_turn_radio_off();
+        ENERGEST_EXTENDED_OFF(ENERGEST_TYPE_CCA);
       }
       schedule_powercycle_fixed(t, RTIMER_NOW() + CCA_SLEEP_TIME);
       PT_YIELD(&pt);
@@ -428,10 +572,11 @@ powercycle(struct rtimer *t, void *ptr)
 
     if(packet_seen) {
       static rtimer_clock_t start;
-      static uint8_t silence_periods, periods;
+      static uint8_t silence_periods, periods, was_receiving;
       start = RTIMER_NOW();
+      ENERGEST_EXTENDED_ON(ENERGEST_TYPE_RX);
 
-      periods = silence_periods = 0;
+      periods = silence_periods = was_receiving = 0;
       while(we_are_sending == 0 && radio_is_on &&
             RTIMER_CLOCK_LT(RTIMER_NOW(),
                             (start + LISTEN_TIME_AFTER_PACKET_DETECTED))) {
@@ -456,6 +601,15 @@ powercycle(struct rtimer *t, void *ptr)
 
         if(NETSTACK_RADIO.receiving_packet()) {
           silence_periods = 0;
+          was_receiving = 1;
+        } else if(was_receiving &&
+                  (radio_capabilities & RADIO_CAP_ADDRESS_FILTER) &&
+                  !NETSTACK_RADIO.pending_packet()) {
+          /* A frame ended without being kept by the radio, so it was
+             not for us. There is no need to listen to the rest of
+             the strobes. */
+          powercycle_turn_radio_off();
+          break;
         }
         if(silence_periods > MAX_SILENCE_PERIODS) {
           powercycle_turn_radio_off();
@@ -483,9 +637,10 @@ powercycle(struct rtimer *t, void *ptr)
           powercycle_turn_radio_off();
         }
       }
+      ENERGEST_EXTENDED_OFF(ENERGEST_TYPE_RX);
     }
 
-    if(RTIMER_CLOCK_LT(RTIMER_NOW() - cycle_start, CYCLE_TIME - CHECK_TIME * 4)) {
+    if(RTIMER_CLOCK_LT(RTIMER_NOW() - cycle_start, POWERCYCLE_TIME - CHECK_TIME * 4)) {
       /* Schedule the next powercycle interrupt, or sleep the mcu
 	 until then.  Sleeping will not exit from this interrupt, so
 	 ensure an occasional wake cycle or foreground processing will
@@ -493,14 +648,14 @@ powercycle(struct rtimer *t, void *ptr)
 #if RDC_CONF_MCU_SLEEP
       static uint8_t sleepcycle;
       if((sleepcycle++ < 16) && !we_are_sending && !radio_is_on) {
-        rtimer_arch_sleep(CYCLE_TIME - (RTIMER_NOW() - cycle_start));
+        rtimer_arch_sleep(POWERCYCLE_TIME - (RTIMER_NOW() - cycle_start));
       } else {
         sleepcycle = 0;
-        schedule_powercycle_fixed(t, CYCLE_TIME + cycle_start);
+        schedule_powercycle_fixed(t, POWERCYCLE_TIME + cycle_start);
         PT_YIELD(&pt);
       }
 #else
-      schedule_powercycle_fixed(t, CYCLE_TIME + cycle_start);
+      schedule_powercycle_fixed(t, POWERCYCLE_TIME + cycle_start);
       PT_YIELD(&pt);
 #endif
     }
@@ -548,6 +703,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   int ret;
   uint8_t contikimac_was_on;
   uint8_t seqno;
+  rtimer_clock_t strobe_time = STROBE_TIME;
 #if WITH_CONTIKIMAC_HEADER
   struct hdr *chdr;
 #endif /* WITH_CONTIKIMAC_HEADER */
@@ -571,7 +727,8 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
     is_broadcast = 1;
     PRINTDEBUG("contikimac: send broadcast\n");
 
-    if(broadcast_rate_drop()) {
+    /* Only the first broadcast of a burst wakes the neighbors up */
+    if(!is_receiver_awake && broadcast_rate_drop()) {
       return MAC_TX_COLLISION;
     }
   } else {
@@ -605,6 +762,10 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   }
   chdr = packetbuf_hdrptr();
   chdr->id = CONTIKIMAC_ID;
+#if ADAPTIVE_RATE
+  /* Advertise the slower of the current and the coming rate. */
+  chdr->id |= rate_shift < next_rate_shift ? rate_shift : next_rate_shift;
+#endif /* ADAPTIVE_RATE */
   chdr->len = hdrlen;
   
   /* Create the MAC header for the data packet. */
@@ -655,8 +816,15 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
 
   if(!is_broadcast && !is_receiver_awake) {
 #if WITH_PHASE_OPTIMIZATION
+#if ADAPTIVE_RATE
+    /* The receiver wakes up at least once per cycle of its own rate. */
+    strobe_time = (CYCLE_TIME >> phase_rate(packetbuf_addr(PACKETBUF_ADDR_RECEIVER))) +
+      2 * CHECK_TIME;
+#endif /* ADAPTIVE_RATE */
     ret = phase_wait(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
-                     CYCLE_TIME, GUARD_TIME,
+                     strobe_time - 2 * CHECK_TIME,
+                     (radio_capabilities & RADIO_CAP_SFD_TIMESTAMP) ?
+                     SFD_GUARD_TIME : GUARD_TIME,
                      mac_callback, mac_callback_ptr, buf_list);
     if(ret == PHASE_DEFERRED) {
       return MAC_TX_DEFERRED;
@@ -689,6 +857,11 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
      the radio was doing a channel check. */
   off();
 
+#if WITH_MULTICHANNEL
+  /* Strobe on the channel that the receiver listens on */
+  set_channel(channel_for(packetbuf_addr(PACKETBUF_ADDR_RECEIVER)));
+#endif /* WITH_MULTICHANNEL */
+
 
   strobes = 0;
 
@@ -746,13 +919,16 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   watchdog_periodic();
   t0 = RTIMER_NOW();
   seqno = packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO);
+  ENERGEST_EXTENDED_ON(ENERGEST_TYPE_STROBE);
   for(strobes = 0, collisions = 0;
       got_strobe_ack == 0 && collisions == 0 &&
-      RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + STROBE_TIME); strobes++) {
+      RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + strobe_time); strobes++) {
 
     watchdog_periodic();
 
-    if(!is_broadcast && (is_receiver_awake || is_known_receiver) &&
+    /* Broadcasts in a burst only need a few strobes, as the
+       neighbors stay awake after the first broadcast. */
+    if((is_receiver_awake || (!is_broadcast && is_known_receiver)) &&
        !RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + MAX_PHASE_STROBE_TIME)) {
       PRINTF("miss to %d\n", packetbuf_addr(PACKETBUF_ADDR_RECEIVER)->u8[0]);
       break;
@@ -767,6 +943,11 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
 
       txtime = RTIMER_NOW();
       ret = NETSTACK_RADIO.transmit(transmit_len);
+      if(ret == RADIO_TX_OK &&
+         (radio_capabilities & RADIO_CAP_SFD_TIMESTAMP)) {
+        /* When the strobe actually started */
+        txtime = NETSTACK_RADIO.last_sfd_time();
+      }
 
 #if RDC_CONF_HARDWARE_ACK
      /* For radios that block in the transmit routine and detect the
@@ -811,6 +992,10 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   }
 
   off();
+  ENERGEST_EXTENDED_OFF(ENERGEST_TYPE_STROBE);
+#if WITH_MULTICHANNEL
+  set_channel(channel_for(&rimeaddr_node_addr));
+#endif /* WITH_MULTICHANNEL */
 
   PRINTF("contikimac: send (strobes=%u, len=%u, %s, %s), done\n", strobes,
          packetbuf_totlen(),
@@ -887,7 +1072,7 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
   /* Do not send during reception of a burst */
   if(we_are_receiving_burst) {
     /* Prepare the packetbuf for callback */
-    queuebuf_to_packetbuf(curr->buf);
+    queuebuf_lend_to_packetbuf(curr->buf);
     /* Return COLLISION so the MAC may try again later */
     mac_call_sent_callback(sent, ptr, MAC_TX_COLLISION, 1);
     return;
@@ -898,7 +1083,7 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
     next = list_item_next(curr);
 
     /* Prepare the packetbuf */
-    queuebuf_to_packetbuf(curr->buf);
+    queuebuf_lend_to_packetbuf(curr->buf);
     if(next != NULL) {
       packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 1);
     }
@@ -951,10 +1136,18 @@ input_packet(void)
 #if WITH_CONTIKIMAC_HEADER
     struct hdr *chdr;
     chdr = packetbuf_dataptr();
+#if ADAPTIVE_RATE
+    if((chdr->id & ~RATE_SHIFT_MASK) != CONTIKIMAC_ID) {
+#else
     if(chdr->id != CONTIKIMAC_ID) {
+#endif /* ADAPTIVE_RATE */
       PRINTF("contikimac: failed to parse hdr (%u)\n", packetbuf_totlen());
       return;
     }
+#if ADAPTIVE_RATE && WITH_PHASE_OPTIMIZATION
+    phase_set_rate(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                   chdr->id & RATE_SHIFT_MASK);
+#endif /* ADAPTIVE_RATE && WITH_PHASE_OPTIMIZATION */
     packetbuf_hdrreduce(sizeof(struct hdr));
     packetbuf_set_datalen(chdr->len);
 #endif /* WITH_CONTIKIMAC_HEADER */
@@ -968,6 +1161,12 @@ input_packet(void)
       /* This is a regular packet that is destined to us or to the
          broadcast address. */
 
+#if ADAPTIVE_RATE
+      if(rx_packets < 0xff) {
+        rx_packets++;
+      }
+#endif /* ADAPTIVE_RATE */
+
       /* If FRAME_PENDING is set, we are receiving a packets in a burst */
       we_are_receiving_burst = packetbuf_attr(PACKETBUF_ATTR_PENDING);
       if(we_are_receiving_burst) {
@@ -1021,16 +1220,33 @@ input_packet(void)
       return;
     } else {
       PRINTDEBUG("contikimac: data not for us\n");
+      RIMESTATS_ADD(foreigndrop);
     }
   } else {
     PRINTF("contikimac: failed to parse (%u)\n", packetbuf_totlen());
   }
 }
 /*---------------------------------------------------------------------------*/
+#if ADAPTIVE_RATE
+static void
+adapt_rate(void *ptr)
+{
+  if(rx_packets >= RATE_UP_PACKETS && next_rate_shift < MAX_RATE_SHIFT) {
+    next_rate_shift++;
+  } else if(rx_packets < RATE_DOWN_PACKETS && next_rate_shift > 0) {
+    next_rate_shift--;
+  }
+  PRINTF("contikimac: %u packets, rate shift %u\n", rx_packets, next_rate_shift);
+  rx_packets = 0;
+  ctimer_reset(&rate_timer);
+}
+#endif /* ADAPTIVE_RATE */
+/*---------------------------------------------------------------------------*/
 static void
 init(void)
 {
   radio_is_on = 0;
+  radio_capabilities = radio_get_capabilities(&NETSTACK_RADIO);
   PT_INIT(&pt);
 
   rtimer_set(&rt, RTIMER_NOW() + CYCLE_TIME, 1,
@@ -1042,6 +1258,9 @@ init(void)
   phase_init();
 #endif /* WITH_PHASE_OPTIMIZATION */
 
+#if ADAPTIVE_RATE
+  ctimer_set(&rate_timer, RATE_INTERVAL, adapt_rate, NULL);
+#endif /* ADAPTIVE_RATE */
 }
 /*---------------------------------------------------------------------------*/
 static int
@@ -43,12 +43,15 @@
 
 #include "sys/ctimer.h"
 #include "sys/clock.h"
+#include "sys/metrics.h"
+#include "sys/trace.h"
 
 #include "lib/random.h"
 
 #include "net/netstack.h"
 
 #include "lib/list.h"
+#include "lib/tlist.h"
 #include "lib/memb.h"
 
 #include <string.h>
@@ -76,11 +79,55 @@
 #error Change CSMA_CONF_MAX_MAC_TRANSMISSIONS in contiki-conf.h or in your Makefile.
 #endif /* CSMA_CONF_MAX_MAC_TRANSMISSIONS < 1 */
 
+/* The time to wait after a packet has been queued for a neighbor
+   with an empty queue before the queue is handed to the RDC layer.
+   Packets queued for the same neighbor in the meantime are sent in
+   the same burst, sharing a single wake-up of the receiver. */
+#ifdef CSMA_CONF_BURST_DELAY
+#define CSMA_BURST_DELAY CSMA_CONF_BURST_DELAY
+#else
+#define CSMA_BURST_DELAY 0
+#endif /* CSMA_CONF_BURST_DELAY */
+
+/* The burst delay for broadcasts. Broadcasts wake up every neighbor,
+   so setting it to one channel check interval of the RDC layer,
+   NETSTACK_RDC.channel_check_interval(), sends the broadcasts of that
+   time in one burst. Broadcasts are sent at once by default. */
+#ifdef CSMA_CONF_BROADCAST_DELAY
+#define CSMA_BROADCAST_DELAY CSMA_CONF_BROADCAST_DELAY
+#else
+#define CSMA_BROADCAST_DELAY 0
+#endif /* CSMA_CONF_BROADCAST_DELAY */
+
+#if CSMA_STATS
+struct csma_stats csma_stats;
+#define CSMA_STATS_ADD(x, v) csma_stats.x += (v)
+#else /* CSMA_STATS */
+#define CSMA_STATS_ADD(x, v)
+#endif /* CSMA_STATS */
+
+METRICS_COUNTER(metrics_tx_ok, "csma.tx.ok");
+METRICS_COUNTER(metrics_rexmit, "csma.rexmit");
+METRICS_COUNTER(metrics_drop_noack, "csma.drop.noack");
+METRICS_COUNTER(metrics_drop_collision, "csma.drop.collision");
+METRICS_COUNTER(metrics_drop_err, "csma.drop.err");
+METRICS_COUNTER(metrics_drop_nobuf, "csma.drop.nobuf");
+METRICS_COUNTER(metrics_drop_noneighbor, "csma.drop.noneighbor");
+METRICS_COUNTER(metrics_queue_max, "csma.queue.max");
+/* From queueing to the last hand-off to the RDC layer, and from
+   there to the outcome of the transmission. */
+METRICS_HISTOGRAM(metrics_queue_latency, "csma.latency.queue");
+METRICS_HISTOGRAM(metrics_radio_latency, "csma.latency.radio");
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
   void *cptr;
   uint8_t max_transmissions;
+  uint8_t priority;
+#if METRICS_ENABLED
+  rtimer_clock_t queued, handed_off;
+#endif /* METRICS_ENABLED */
 };
 
 /* Every neighbor has its own packet queue */
@@ -90,7 +137,8 @@ struct neighbor_queue {
   struct ctimer transmit_timer;
   uint8_t transmissions;
   uint8_t collisions, deferrals;
-  LIST_STRUCT(queued_packet_list);
+  uint8_t queued;
+  TLIST_STRUCT(queued_packet_list);
 };
 
 /* The maximum number of co-existing neighbor queues */
@@ -101,6 +149,27 @@ struct neighbor_queue {
 #endif /* CSMA_CONF_MAX_NEIGHBOR_QUEUES */
 
 #define MAX_QUEUED_PACKETS QUEUEBUF_NUM
+
+/* The number of packet buffers that only packets above the bulk
+   priority class may use, so that a bulk transfer cannot crowd out
+   routing control messages and acknowledgements. */
+#ifdef CSMA_CONF_PRIORITY_RESERVE
+#define CSMA_PRIORITY_RESERVE CSMA_CONF_PRIORITY_RESERVE
+#else
+#define CSMA_PRIORITY_RESERVE (MAX_QUEUED_PACKETS / 4)
+#endif /* CSMA_CONF_PRIORITY_RESERVE */
+
+/* The number of bulk packets that may be queued for one neighbor, so
+   that the remaining buffers are left to other neighbors. */
+#ifdef CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR
+#define CSMA_MAX_PACKETS_PER_NEIGHBOR CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR
+#elif CSMA_MAX_NEIGHBOR_QUEUES > 1
+#define CSMA_MAX_PACKETS_PER_NEIGHBOR (MAX_QUEUED_PACKETS / 2)
+#else
+#define CSMA_MAX_PACKETS_PER_NEIGHBOR MAX_QUEUED_PACKETS
+#endif /* CSMA_CONF_MAX_PACKETS_PER_NEIGHBOR */
+
+static uint8_t packets_queued;
 MEMB(neighbor_memb, struct neighbor_queue, CSMA_MAX_NEIGHBOR_QUEUES);
 MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
 MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
@@ -145,11 +214,31 @@ transmit_packet_list(void *ptr)
 {
   struct neighbor_queue *n = ptr;
   if(n) {
-    struct rdc_buf_list *q = list_head(n->queued_packet_list);
+    struct rdc_buf_list *q = tlist_head(n->queued_packet_list);
     if(q != NULL) {
+      int len = tlist_length(n->queued_packet_list);
+#if METRICS_ENABLED
+      struct rdc_buf_list *p;
+      for(p = q; p != NULL; p = list_item_next(p)) {
+        ((struct qbuf_metadata *)p->ptr)->handed_off = METRICS_NOW();
+      }
+#endif /* METRICS_ENABLED */
       PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
-          list_length(n->queued_packet_list));
-      /* Send packets in the neighbor's list */
+          len);
+      CSMA_STATS_ADD(lists, 1);
+      if(len > 1) {
+        CSMA_STATS_ADD(bursts, 1);
+        CSMA_STATS_ADD(burst_packets, len);
+#if CSMA_STATS
+        if(len > csma_stats.max_burst_len) {
+          csma_stats.max_burst_len = len > 255 ? 255 : len;
+        }
+#endif /* CSMA_STATS */
+      }
+      /* Send all packets in the neighbor's list as one burst. The
+         RDC layer sets the frame pending bit on all but the last
+         one, so that the receiver stays awake for the whole burst. */
+      TRACE(TRACE_CSMA_SEND, len);
       NETSTACK_RDC.send_list(packet_sent, n, q);
     }
   }
@@ -159,22 +248,34 @@ static void
 free_packet(struct neighbor_queue *n, struct rdc_buf_list *p)
 {
   if(p != NULL) {
+#if METRICS_ENABLED
+    struct qbuf_metadata *metadata = p->ptr;
+    metrics_histogram_add(&metrics_queue_latency,
+                          (rtimer_clock_t)(metadata->handed_off -
+                                           metadata->queued));
+    METRICS_LATENCY(metrics_radio_latency, metadata->handed_off);
+#endif /* METRICS_ENABLED */
     /* Remove packet from list and deallocate */
-    list_remove(n->queued_packet_list, p);
+    tlist_remove(n->queued_packet_list, p);
+    n->queued--;
+    packets_queued--;
 
     queuebuf_free(p->buf);
     memb_free(&metadata_memb, p->ptr);
     memb_free(&packet_memb, p);
     PRINTF("csma: free_queued_packet, queue length %d\n",
-        list_length(n->queued_packet_list));
-    if(list_head(n->queued_packet_list) != NULL) {
+        tlist_length(n->queued_packet_list));
+    if(tlist_head(n->queued_packet_list) != NULL) {
       /* There is a next packet. We reset current tx information */
       n->transmissions = 0;
       n->collisions = 0;
       n->deferrals = 0;
-      /* Set a timer for next transmissions */
+      /* Set a timer for next transmissions, and have the next
+         packet brought to RAM meanwhile if it was swapped out */
       ctimer_set(&n->transmit_timer, default_timebase(),
                  transmit_packet_list, n);
+      queuebuf_prefetch(((struct rdc_buf_list *)
+                         tlist_head(n->queued_packet_list))->buf);
     } else {
       /* This was the last packet in the queue, we free the neighbor */
       ctimer_stop(&n->transmit_timer);
@@ -200,6 +301,7 @@ packet_sent(void *ptr, int status, int num_transmissions)
   if(n == NULL) {
     return;
   }
+  TRACE(TRACE_CSMA_SENT, status);
   switch(status) {
   case MAC_TX_OK:
   case MAC_TX_NOACK:
@@ -213,7 +315,7 @@ packet_sent(void *ptr, int status, int num_transmissions)
     break;
   }
 
-  for(q = list_head(n->queued_packet_list);
+  for(q = tlist_head(n->queued_packet_list);
       q != NULL; q = list_item_next(q)) {
     if(queuebuf_attr(q->buf, PACKETBUF_ATTR_MAC_SEQNO) ==
        packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO)) {
@@ -265,6 +367,7 @@ packet_sent(void *ptr, int status, int num_transmissions)
 
         if(n->transmissions < metadata->max_transmissions) {
           PRINTF("csma: retransmitting with time %lu %p\n", time, q);
+          METRICS_INC(metrics_rexmit);
           ctimer_set(&n->transmit_timer, time,
                      transmit_packet_list, n);
           /* This is needed to correctly attribute energy that we spent
@@ -273,14 +376,21 @@ packet_sent(void *ptr, int status, int num_transmissions)
         } else {
           PRINTF("csma: drop with status %d after %d transmissions, %d collisions\n",
                  status, n->transmissions, n->collisions);
+          if(status == MAC_TX_NOACK) {
+            METRICS_INC(metrics_drop_noack);
+          } else {
+            METRICS_INC(metrics_drop_collision);
+          }
           free_packet(n, q);
           mac_call_sent_callback(sent, cptr, status, num_tx);
         }
       } else {
         if(status == MAC_TX_OK) {
           PRINTF("csma: rexmit ok %d\n", n->transmissions);
+          METRICS_INC(metrics_tx_ok);
         } else {
           PRINTF("csma: rexmit failed %d: %d\n", n->transmissions, status);
+          METRICS_INC(metrics_drop_err);
         }
         free_packet(n, q);
         mac_call_sent_callback(sent, cptr, status, num_tx);
@@ -289,6 +399,53 @@ packet_sent(void *ptr, int status, int num_transmissions)
   }
 }
 /*---------------------------------------------------------------------------*/
+static int
+packet_priority(void)
+{
+  if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
+     PACKETBUF_ATTR_PACKET_TYPE_ACK) {
+    return PACKETBUF_ATTR_PRIORITY_CONTROL;
+  }
+  return packetbuf_attr(PACKETBUF_ATTR_PRIORITY);
+}
+/*---------------------------------------------------------------------------*/
+/* Bulk packets are held to a share of the pool per neighbor and may
+   not use the buffers reserved for higher priority classes. */
+static int
+admit(struct neighbor_queue *n, int priority)
+{
+  if(priority > PACKETBUF_ATTR_PRIORITY_BULK) {
+    return 1;
+  }
+  return n->queued < CSMA_MAX_PACKETS_PER_NEIGHBOR &&
+    packets_queued + CSMA_PRIORITY_RESERVE < MAX_QUEUED_PACKETS;
+}
+/*---------------------------------------------------------------------------*/
+/* Queue a packet behind those of the same or a higher priority class.
+   A head packet that has already been tried keeps its place, as the
+   retransmission state of the queue belongs to it. */
+static void
+enqueue(struct neighbor_queue *n, struct rdc_buf_list *q, int priority)
+{
+  struct rdc_buf_list *prev, *p;
+
+  prev = NULL;
+  p = tlist_head(n->queued_packet_list);
+  if(p != NULL && (n->transmissions || n->collisions || n->deferrals)) {
+    prev = p;
+    p = list_item_next(p);
+  }
+  for(; p != NULL; p = list_item_next(p)) {
+    if(((struct qbuf_metadata *)p->ptr)->priority < priority) {
+      break;
+    }
+    prev = p;
+  }
+  tlist_insert(n->queued_packet_list, prev, q);
+  n->queued++;
+  packets_queued++;
+}
+/*---------------------------------------------------------------------------*/
 static void
 send_packet(mac_callback_t sent, void *ptr)
 {
@@ -296,6 +453,7 @@ send_packet(mac_callback_t sent, void *ptr)
   struct neighbor_queue *n;
   static uint16_t seqno;
   const rimeaddr_t *addr = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  int priority = packet_priority();
 
   if(seqno == 0) {
     /* PACKETBUF_ATTR_MAC_SEQNO cannot be zero, due to a pecuilarity
@@ -315,8 +473,9 @@ send_packet(mac_callback_t sent, void *ptr)
       n->transmissions = 0;
       n->collisions = 0;
       n->deferrals = 0;
+      n->queued = 0;
       /* Init packet list for this neighbor */
-      LIST_STRUCT_INIT(n, queued_packet_list);
+      TLIST_STRUCT_INIT(n, queued_packet_list);
       /* Add neighbor to the list */
       list_add(neighbor_list, n);
     }
@@ -324,7 +483,7 @@ send_packet(mac_callback_t sent, void *ptr)
 
   if(n != NULL) {
     /* Add packet to the neighbor's queue */
-    q = memb_alloc(&packet_memb);
+    q = admit(n, priority) ? memb_alloc(&packet_memb) : NULL;
     if(q != NULL) {
       q->ptr = memb_alloc(&metadata_memb);
       if(q->ptr != NULL) {
@@ -341,18 +500,24 @@ send_packet(mac_callback_t sent, void *ptr)
 	  }
 	  metadata->sent = sent;
 	  metadata->cptr = ptr;
-
-	  if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
-	     PACKETBUF_ATTR_PACKET_TYPE_ACK) {
-	    list_push(n->queued_packet_list, q);
-	  } else {
-	    list_add(n->queued_packet_list, q);
-	  }
-
-	  /* If q is the first packet in the neighbor's queue, send asap */
-	  if(list_head(n->queued_packet_list) == q) {
-	    ctimer_set(&n->transmit_timer, 0, transmit_packet_list, n);
+	  metadata->priority = priority;
+#if METRICS_ENABLED
+	  metadata->queued = METRICS_NOW();
+	  metadata->handed_off = metadata->queued;
+#endif /* METRICS_ENABLED */
+
+	  enqueue(n, q, priority);
+
+	  /* If q is the first packet in the neighbor's queue, send asap,
+	     or after the burst delay so that more packets can join */
+	  if(tlist_head(n->queued_packet_list) == q) {
+	    ctimer_set(&n->transmit_timer,
+	               rimeaddr_cmp(addr, &rimeaddr_null) ?
+	               CSMA_BROADCAST_DELAY : CSMA_BURST_DELAY,
+	               transmit_packet_list, n);
 	  }
+	  METRICS_MAX(metrics_queue_max, tlist_length(n->queued_packet_list));
+	  TRACE(TRACE_CSMA_QUEUE, tlist_length(n->queued_packet_list));
 	  return;
 	}
 	memb_free(&metadata_memb, q->ptr);
@@ -362,13 +527,15 @@ send_packet(mac_callback_t sent, void *ptr)
       PRINTF("csma: could not allocate queuebuf, dropping packet\n");
     }
     /* The packet allocation failed. Remove and free neighbor entry if empty. */
-    if(list_length(n->queued_packet_list) == 0) {
+    if(tlist_length(n->queued_packet_list) == 0) {
       list_remove(neighbor_list, n);
       memb_free(&neighbor_memb, n);
     }
     PRINTF("csma: could not allocate packet, dropping packet\n");
+    METRICS_INC(metrics_drop_nobuf);
   } else {
     PRINTF("csma: could not allocate neighbor, dropping packet\n");
+    METRICS_INC(metrics_drop_noneighbor);
   }
   mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
 }
@@ -406,6 +573,18 @@ init(void)
   memb_init(&packet_memb);
   memb_init(&metadata_memb);
   memb_init(&neighbor_memb);
+  packets_queued = 0;
+
+  METRICS_REGISTER_COUNTER(metrics_tx_ok);
+  METRICS_REGISTER_COUNTER(metrics_rexmit);
+  METRICS_REGISTER_COUNTER(metrics_drop_noack);
+  METRICS_REGISTER_COUNTER(metrics_drop_collision);
+  METRICS_REGISTER_COUNTER(metrics_drop_err);
+  METRICS_REGISTER_COUNTER(metrics_drop_nobuf);
+  METRICS_REGISTER_COUNTER(metrics_drop_noneighbor);
+  METRICS_REGISTER_COUNTER(metrics_queue_max);
+  METRICS_REGISTER_HISTOGRAM(metrics_queue_latency);
+  METRICS_REGISTER_HISTOGRAM(metrics_radio_latency);
 }
 /*---------------------------------------------------------------------------*/
 const struct mac_driver csma_driver = {
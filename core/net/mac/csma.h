@@ -44,6 +44,25 @@
 #include "net/mac/mac.h"
 #include "dev/radio.h"
 
+#ifdef CSMA_CONF_STATS
+#define CSMA_STATS CSMA_CONF_STATS
+#else
+#define CSMA_STATS 0
+#endif /* CSMA_CONF_STATS */
+
+#if CSMA_STATS
+/* Counters describing how well packets to the same neighbor are
+   coalesced into bursts. The average burst length is
+   burst_packets / bursts. */
+struct csma_stats {
+  uint32_t lists;         /* Number of send_list() calls */
+  uint32_t bursts;        /* send_list() calls with more than one packet */
+  uint32_t burst_packets; /* Packets handed to the RDC as part of a burst */
+  uint8_t max_burst_len;  /* Longest burst handed to the RDC */
+};
+extern struct csma_stats csma_stats;
+#endif /* CSMA_STATS */
+
 extern const struct mac_driver csma_driver;
 
 const struct mac_driver *csma_init(const struct mac_driver *r);
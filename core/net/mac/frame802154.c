@@ -91,6 +91,21 @@ addr_len(uint8_t mode)
   }
 }
 /*----------------------------------------------------------------------------*/
+CC_INLINE static uint8_t
+key_id_len(uint8_t key_id_mode)
+{
+  switch(key_id_mode) {
+  case FRAME802154_1_BYTE_KEY_ID:
+    return 1;
+  case FRAME802154_5_BYTE_KEY_ID:
+    return 5;
+  case FRAME802154_9_BYTE_KEY_ID:
+    return 9;
+  default:
+    return 0;
+  }
+}
+/*----------------------------------------------------------------------------*/
 static void
 field_len(frame802154_t *p, field_length_t *flen)
 {
@@ -122,25 +137,8 @@ field_len(frame802154_t *p, field_length_t *flen)
 
   /* Aux security header */
   if(p->fcf.security_enabled & 1) {
-    /* TODO Aux security header not yet implemented */
-#if 0
-    switch(p->aux_hdr.security_control.key_id_mode) {
-    case 0:
-      flen->aux_sec_len = 5; /* minimum value */
-      break;
-    case 1:
-      flen->aux_sec_len = 6;
-      break;
-    case 2:
-      flen->aux_sec_len = 10;
-      break;
-    case 3:
-      flen->aux_sec_len = 14;
-      break;
-    default:
-      break;
-    }
-#endif
+    flen->aux_sec_len = 5 +
+      key_id_len(p->aux_hdr.security_control.key_id_mode & 3);
   }
 }
 /*----------------------------------------------------------------------------*/
@@ -232,8 +230,15 @@ frame802154_create(frame802154_t *p, uint8_t *buf, int buf_len)
 
   /* Aux header */
   if(flen.aux_sec_len) {
-    /* TODO Aux security header not yet implemented */
-/*     pos += flen.aux_sec_len; */
+    tx_frame_buffer[pos++] = (p->aux_hdr.security_control.security_level & 7) |
+      ((p->aux_hdr.security_control.key_id_mode & 3) << 3);
+    tx_frame_buffer[pos++] = p->aux_hdr.frame_counter & 0xff;
+    tx_frame_buffer[pos++] = (p->aux_hdr.frame_counter >> 8) & 0xff;
+    tx_frame_buffer[pos++] = (p->aux_hdr.frame_counter >> 16) & 0xff;
+    tx_frame_buffer[pos++] = (p->aux_hdr.frame_counter >> 24) & 0xff;
+    c = flen.aux_sec_len - 5;
+    memcpy(tx_frame_buffer + pos, p->aux_hdr.key, c);
+    pos += c;
   }
 
   return (int)pos;
@@ -337,9 +342,23 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
     pf->src_pid = 0;
   }
 
+  /* Aux security header */
   if(fcf.security_enabled) {
-    /* TODO aux security header, not yet implemented */
-/*     return 0; */
+    if(p - data + 5 > len) {
+      return 0;
+    }
+    pf->aux_hdr.security_control.security_level = p[0] & 7;
+    pf->aux_hdr.security_control.key_id_mode = (p[0] >> 3) & 3;
+    pf->aux_hdr.security_control.reserved = (p[0] >> 5) & 7;
+    pf->aux_hdr.frame_counter = p[1] | ((uint16_t)p[2] << 8) |
+      ((uint32_t)p[3] << 16) | ((uint32_t)p[4] << 24);
+    p += 5;
+    c = key_id_len(pf->aux_hdr.security_control.key_id_mode);
+    if(p - data + c > len) {
+      return 0;
+    }
+    memcpy(pf->aux_hdr.key, p, c);
+    p += c;
   }
 
   /* header length */
@@ -96,8 +96,20 @@
 #define FRAME802154_IEEE802154_2003 (0x00)
 #define FRAME802154_IEEE802154_2006 (0x01)
 
-#define FRAME802154_SECURITY_LEVEL_NONE (0)
-#define FRAME802154_SECURITY_LEVEL_128  (3)
+#define FRAME802154_SECURITY_LEVEL_NONE        (0)
+#define FRAME802154_SECURITY_LEVEL_MIC_32      (1)
+#define FRAME802154_SECURITY_LEVEL_MIC_64      (2)
+#define FRAME802154_SECURITY_LEVEL_MIC_128     (3)
+#define FRAME802154_SECURITY_LEVEL_ENC         (4)
+#define FRAME802154_SECURITY_LEVEL_ENC_MIC_32  (5)
+#define FRAME802154_SECURITY_LEVEL_ENC_MIC_64  (6)
+#define FRAME802154_SECURITY_LEVEL_ENC_MIC_128 (7)
+#define FRAME802154_SECURITY_LEVEL_128  FRAME802154_SECURITY_LEVEL_MIC_128
+
+#define FRAME802154_IMPLICIT_KEY    (0)
+#define FRAME802154_1_BYTE_KEY_ID   (1)
+#define FRAME802154_5_BYTE_KEY_ID   (2)
+#define FRAME802154_9_BYTE_KEY_ID   (3)
 
 
 /**
@@ -38,6 +38,7 @@
 
 #include "net/mac/framer-802154.h"
 #include "net/mac/frame802154.h"
+#include "net/mac/llsec.h"
 #include "net/packetbuf.h"
 #include "lib/random.h"
 #include <string.h>
@@ -73,6 +74,34 @@ static const uint16_t mac_dst_pan_id = IEEE802154_PANID;
  */
 static const uint16_t mac_src_pan_id = IEEE802154_PANID;
 
+/* Headers recently created, per receiver. Apart from the sequence
+   number, the header only depends on the receiver, the ack request and
+   frame pending bits and our own address. */
+#ifdef FRAMER_802154_CONF_HEADER_CACHE
+#define HEADER_CACHE FRAMER_802154_CONF_HEADER_CACHE
+#else
+#define HEADER_CACHE 4
+#endif
+
+#if HEADER_CACHE > 0
+/* FCF, sequence number, PAN IDs, long addresses and, with link-layer
+   security, the auxiliary security header. Its frame counter, the
+   last four bytes, changes with every frame like the sequence
+   number. */
+#define HEADER_MAX_LEN (2 + 1 + 2 + 8 + 2 + 8 + 5)
+#define HEADER_SEQ_OFFSET 2
+
+struct header_cache_entry {
+  rimeaddr_t receiver;
+  uint8_t flags;
+  uint8_t len;
+  uint8_t hdr[HEADER_MAX_LEN];
+};
+static struct header_cache_entry header_cache[HEADER_CACHE];
+static uint8_t header_cache_next;
+static rimeaddr_t header_cache_addr;
+#endif /* HEADER_CACHE > 0 */
+
 /*---------------------------------------------------------------------------*/
 static int
 is_broadcast_addr(uint8_t mode, uint8_t *addr)
@@ -91,6 +120,11 @@ create(void)
 {
   frame802154_t params;
   int len;
+#if HEADER_CACHE > 0
+  struct header_cache_entry *e;
+  uint8_t flags;
+  int i;
+#endif /* HEADER_CACHE > 0 */
 
   /* init to zeros */
   memset(&params, 0, sizeof(params));
@@ -100,9 +134,23 @@ create(void)
     mac_dsn = random_rand() & 0xff;
   }
 
+#if LLSEC_SECURITY_LEVEL
+  if(packetbuf_datalen() + LLSEC_MIC_LEN > PACKETBUF_SIZE) {
+    PRINTF("15.4-OUT: no room for the MIC\n");
+    return FRAMER_FAILED;
+  }
+#endif /* LLSEC_SECURITY_LEVEL */
+
   /* Build the FCF. */
   params.fcf.frame_type = FRAME802154_DATAFRAME;
+#if LLSEC_SECURITY_LEVEL
+  params.fcf.security_enabled = 1;
+  params.aux_hdr.security_control.security_level = LLSEC_SECURITY_LEVEL;
+  params.aux_hdr.security_control.key_id_mode = FRAME802154_IMPLICIT_KEY;
+  params.aux_hdr.frame_counter = llsec_next_frame_counter();
+#else /* LLSEC_SECURITY_LEVEL */
   params.fcf.security_enabled = 0;
+#endif /* LLSEC_SECURITY_LEVEL */
   params.fcf.frame_pending = packetbuf_attr(PACKETBUF_ATTR_PENDING);
   if(rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &rimeaddr_null)) {
     params.fcf.ack_required = 0;
@@ -111,8 +159,13 @@ create(void)
   }
   params.fcf.panid_compression = 0;
 
+#if LLSEC_SECURITY_LEVEL
+  /* The auxiliary security header came with IEEE 802.15.4 (2006). */
+  params.fcf.frame_version = FRAME802154_IEEE802154_2006;
+#else /* LLSEC_SECURITY_LEVEL */
   /* Insert IEEE 802.15.4 (2003) version bit. */
   params.fcf.frame_version = FRAME802154_IEEE802154_2003;
+#endif /* LLSEC_SECURITY_LEVEL */
 
   /* Increment and set the data sequence number. */
   if(packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO)) {
@@ -123,6 +176,40 @@ create(void)
   }
 /*   params.seq = packetbuf_attr(PACKETBUF_ATTR_PACKET_ID); */
 
+#if HEADER_CACHE > 0
+  /* Our own address is part of every header */
+  if(!rimeaddr_cmp(&header_cache_addr, &rimeaddr_node_addr)) {
+    rimeaddr_copy(&header_cache_addr, &rimeaddr_node_addr);
+    for(i = 0; i < HEADER_CACHE; i++) {
+      header_cache[i].len = 0;
+    }
+  }
+
+  flags = params.fcf.ack_required | (params.fcf.frame_pending << 1);
+  for(i = 0; i < HEADER_CACHE; i++) {
+    e = &header_cache[i];
+    if(e->len > 0 && e->flags == flags &&
+       rimeaddr_cmp(&e->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER))) {
+      if(!packetbuf_hdralloc(e->len)) {
+        PRINTF("15.4-OUT: too large header: %u\n", e->len);
+        return FRAMER_FAILED;
+      }
+      memcpy(packetbuf_hdrptr(), e->hdr, e->len);
+      ((uint8_t *)packetbuf_hdrptr())[HEADER_SEQ_OFFSET] = params.seq;
+#if LLSEC_SECURITY_LEVEL
+      {
+        uint8_t *fc = (uint8_t *)packetbuf_hdrptr() + e->len - 4;
+        fc[0] = params.aux_hdr.frame_counter & 0xff;
+        fc[1] = (params.aux_hdr.frame_counter >> 8) & 0xff;
+        fc[2] = (params.aux_hdr.frame_counter >> 16) & 0xff;
+        fc[3] = (params.aux_hdr.frame_counter >> 24) & 0xff;
+      }
+#endif /* LLSEC_SECURITY_LEVEL */
+      return e->len;
+    }
+  }
+#endif /* HEADER_CACHE > 0 */
+
   /* Complete the addressing fields. */
   /**
      \todo For phase 1 the addresses are all long. We'll need a mechanism
@@ -172,6 +259,17 @@ create(void)
   if(packetbuf_hdralloc(len)) {
     frame802154_create(&params, packetbuf_hdrptr(), len);
 
+#if HEADER_CACHE > 0
+    if(len <= HEADER_MAX_LEN) {
+      e = &header_cache[header_cache_next];
+      header_cache_next = (header_cache_next + 1) % HEADER_CACHE;
+      rimeaddr_copy(&e->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+      e->flags = flags;
+      e->len = len;
+      memcpy(e->hdr, packetbuf_hdrptr(), len);
+    }
+#endif /* HEADER_CACHE > 0 */
+
     PRINTF("15.4-OUT: %2X", params.fcf.frame_type);
     PRINTADDR(params.dest_addr.u8);
     PRINTF("%d %u (%u)\n", len, packetbuf_datalen(), packetbuf_totlen());
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         A framer that streams the frames of another framer over the
+ *         serial line as pcap-ng blocks
+ */
+
+#include "contiki.h"
+#include "net/mac/framer-capture.h"
+#include "net/mac/framer-802154.h"
+#include "net/packetbuf.h"
+#include "dev/slip.h"
+
+#ifdef FRAMER_CAPTURE_CONF_FRAMER
+#define FRAMER_CAPTURE_FRAMER FRAMER_CAPTURE_CONF_FRAMER
+#else /* FRAMER_CAPTURE_CONF_FRAMER */
+#define FRAMER_CAPTURE_FRAMER framer_802154
+#endif /* FRAMER_CAPTURE_CONF_FRAMER */
+
+extern const struct framer FRAMER_CAPTURE_FRAMER;
+
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+
+#define PCAPNG_EPB          6
+#define PCAPNG_EPB_FLAGS    2
+#define PCAPNG_EPB_INBOUND  1
+#define PCAPNG_EPB_OUTBOUND 2
+
+/* Block header, timestamp, lengths, the flags option, the end of
+   options and the trailing block length. */
+#define EPB_OVERHEAD (7 * 4 + 8 + 4 + 4)
+
+/*---------------------------------------------------------------------------*/
+static void
+writeb(uint8_t c)
+{
+  if(c == SLIP_END) {
+    slip_arch_writeb(SLIP_ESC);
+    c = SLIP_ESC_END;
+  } else if(c == SLIP_ESC) {
+    slip_arch_writeb(SLIP_ESC);
+    c = SLIP_ESC_ESC;
+  }
+  slip_arch_writeb(c);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write32(uint32_t v)
+{
+  writeb(v & 0xff);
+  writeb((v >> 8) & 0xff);
+  writeb((v >> 16) & 0xff);
+  writeb(v >> 24);
+}
+/*---------------------------------------------------------------------------*/
+static void
+capture(const uint8_t *frame, uint16_t len, uint32_t direction)
+{
+  rtimer_clock_t now;
+  uint16_t padded, i;
+
+  now = RTIMER_NOW();
+  padded = (len + 3) & ~3;
+
+  slip_arch_writeb(SLIP_END);
+  write32(PCAPNG_EPB);
+  write32(EPB_OVERHEAD + padded);
+  write32(0);                   /* Interface */
+  write32(0);                   /* Timestamp, high */
+  write32(now);                 /* Timestamp, low */
+  write32(len);                 /* Captured length */
+  write32(len);                 /* Original length */
+  for(i = 0; i < padded; i++) {
+    writeb(i < len ? frame[i] : 0);
+  }
+  write32(PCAPNG_EPB_FLAGS | (4UL << 16));
+  write32(direction);
+  write32(0);                   /* End of options */
+  write32(EPB_OVERHEAD + padded);
+  slip_arch_writeb(SLIP_END);
+}
+/*---------------------------------------------------------------------------*/
+static int
+create(void)
+{
+  int hdr_len;
+
+  hdr_len = FRAMER_CAPTURE_FRAMER.create();
+  if(hdr_len >= 0) {
+    capture(packetbuf_hdrptr(), packetbuf_totlen(), PCAPNG_EPB_OUTBOUND);
+  }
+  return hdr_len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+parse(void)
+{
+  capture(packetbuf_dataptr(), packetbuf_datalen(), PCAPNG_EPB_INBOUND);
+  return FRAMER_CAPTURE_FRAMER.parse();
+}
+/*---------------------------------------------------------------------------*/
+const struct framer framer_capture = {
+  create, parse
+};
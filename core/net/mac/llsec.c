@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * \file
+ *         IEEE 802.15.4 link-layer security with AES-CCM*
+ */
+
+#include "net/mac/llsec.h"
+#include "net/packetbuf.h"
+#include "net/nbr-table.h"
+#include "lib/aes-128.h"
+#include "lib/ccm-star.h"
+#include <string.h>
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else /* DEBUG */
+#define PRINTF(...)
+#endif /* DEBUG */
+
+#ifdef LLSEC_CONF_KEY
+#define LLSEC_KEY LLSEC_CONF_KEY
+#else /* LLSEC_CONF_KEY */
+#define LLSEC_KEY { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, \
+                    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f }
+#endif /* LLSEC_CONF_KEY */
+
+#define WITH_ENCRYPTION (LLSEC_SECURITY_LEVEL & 4)
+
+/* The highest frame counter received from each neighbor. A frame
+   whose counter is not higher is a replay and gets dropped. Entries
+   are only created for frames that passed the MIC check, so forged
+   frames cannot push genuine neighbors out of the table. */
+struct llsec_neighbor {
+  uint32_t frame_counter;
+};
+NBR_TABLE(struct llsec_neighbor, llsec_neighbors);
+
+static uint32_t frame_counter;
+
+/* If LLSEC_CONF_PERSIST is set (the default), a high-water mark of
+   the frame counter is kept in the file system. At boot the counter
+   continues from the mark, so that neighbors do not drop our frames
+   as replays. The mark is written ahead of the counter, once every
+   LLSEC_PERSIST_STEP frames. */
+#ifdef LLSEC_CONF_PERSIST
+#define LLSEC_PERSIST LLSEC_CONF_PERSIST
+#else
+#define LLSEC_PERSIST 1
+#endif
+
+#if LLSEC_PERSIST
+#include "cfs/cfs.h"
+
+#ifdef LLSEC_CONF_PERSIST_FILE
+#define LLSEC_PERSIST_FILE LLSEC_CONF_PERSIST_FILE
+#else
+#define LLSEC_PERSIST_FILE "llsec"
+#endif
+
+#ifdef LLSEC_CONF_PERSIST_STEP
+#define LLSEC_PERSIST_STEP LLSEC_CONF_PERSIST_STEP
+#else
+#define LLSEC_PERSIST_STEP 1024
+#endif
+
+/* No frame counter above this has been used before the last boot. */
+static uint32_t frame_counter_mark;
+#endif /* LLSEC_PERSIST */
+
+/*---------------------------------------------------------------------------*/
+static void
+set_nonce(uint8_t *nonce, const uint8_t *src_addr, uint32_t counter)
+{
+  /* The extended source address, the frame counter and the security
+     level, all most significant byte first. */
+  memcpy(nonce, src_addr, 8);
+  nonce[8] = counter >> 24;
+  nonce[9] = (counter >> 16) & 0xff;
+  nonce[10] = (counter >> 8) & 0xff;
+  nonce[11] = counter & 0xff;
+  nonce[12] = LLSEC_SECURITY_LEVEL;
+}
+/*---------------------------------------------------------------------------*/
+#if LLSEC_MIC_LEN
+/* The length of the part of the frame that CCM* authenticates without
+   encrypting: the header, or the whole frame if there is no
+   encryption. The rest is both authenticated and encrypted. */
+static uint8_t
+auth_only_len(uint8_t hdrlen, uint8_t len)
+{
+  return WITH_ENCRYPTION ? hdrlen : len;
+}
+#endif /* LLSEC_MIC_LEN */
+/*---------------------------------------------------------------------------*/
+#if LLSEC_PERSIST
+static void
+save_frame_counter_mark(uint32_t mark)
+{
+  int fd;
+
+  fd = cfs_open(LLSEC_PERSIST_FILE, CFS_WRITE);
+  if(fd < 0) {
+    PRINTF("llsec: could not open %s for writing\n", LLSEC_PERSIST_FILE);
+    return;
+  }
+  if(cfs_write(fd, &mark, sizeof(mark)) == sizeof(mark)) {
+    frame_counter_mark = mark;
+  } else {
+    PRINTF("llsec: frame counter write failed\n");
+  }
+  cfs_close(fd);
+}
+/*---------------------------------------------------------------------------*/
+static void
+restore_frame_counter(void)
+{
+  int fd;
+
+  fd = cfs_open(LLSEC_PERSIST_FILE, CFS_READ);
+  if(fd >= 0) {
+    if(cfs_read(fd, &frame_counter, sizeof(frame_counter)) !=
+       sizeof(frame_counter)) {
+      frame_counter = 0;
+    }
+    cfs_close(fd);
+  }
+  /* The next frame moves the mark on before it is sent. */
+  frame_counter_mark = frame_counter;
+  PRINTF("llsec: frame counter starts at %lu\n",
+         (unsigned long)frame_counter);
+}
+#endif /* LLSEC_PERSIST */
+/*---------------------------------------------------------------------------*/
+void
+llsec_set_key(const uint8_t *key)
+{
+  AES_128.set_key(key);
+}
+/*---------------------------------------------------------------------------*/
+void
+llsec_init(void)
+{
+  static const uint8_t key[AES_128_KEY_LENGTH] = LLSEC_KEY;
+
+  llsec_set_key(key);
+  nbr_table_register(llsec_neighbors, NULL);
+#if LLSEC_PERSIST
+  restore_frame_counter();
+#endif /* LLSEC_PERSIST */
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+llsec_next_frame_counter(void)
+{
+  ++frame_counter;
+#if LLSEC_PERSIST
+  if(frame_counter > frame_counter_mark) {
+    save_frame_counter_mark(frame_counter + LLSEC_PERSIST_STEP);
+  }
+#endif /* LLSEC_PERSIST */
+  return frame_counter;
+}
+/*---------------------------------------------------------------------------*/
+void
+llsec_encrypt(void)
+{
+  frame802154_t frame;
+  uint8_t nonce[CCM_STAR_NONCE_LENGTH];
+#if LLSEC_MIC_LEN
+  uint8_t a_len;
+#endif /* LLSEC_MIC_LEN */
+  uint8_t *ptr;
+  int hdrlen;
+  int len;
+
+  /* Bring the header and the data together so that the frame, and
+     the MIC after it, are contiguous. framer_802154 has checked that
+     the MIC fits. */
+  packetbuf_compact();
+  ptr = packetbuf_hdrptr();
+  len = packetbuf_totlen();
+
+  memset(&frame, 0, sizeof(frame));
+  hdrlen = frame802154_parse(ptr, len, &frame);
+  if(hdrlen == 0 || !frame.fcf.security_enabled) {
+    return;
+  }
+
+  set_nonce(nonce, frame.src_addr, frame.aux_hdr.frame_counter);
+#if LLSEC_MIC_LEN
+  a_len = auth_only_len(hdrlen, len);
+  ccm_star_mic(nonce, ptr, a_len, ptr + a_len, len - a_len,
+               ptr + len, LLSEC_MIC_LEN);
+#endif /* LLSEC_MIC_LEN */
+#if WITH_ENCRYPTION
+  ccm_star_ctr(nonce, ptr + hdrlen, len - hdrlen);
+#endif /* WITH_ENCRYPTION */
+  packetbuf_set_datalen(packetbuf_datalen() + LLSEC_MIC_LEN);
+}
+/*---------------------------------------------------------------------------*/
+void
+llsec_decrypt(void)
+{
+  frame802154_t frame;
+  struct llsec_neighbor *n;
+  uint8_t nonce[CCM_STAR_NONCE_LENGTH];
+#if LLSEC_MIC_LEN
+  uint8_t mic[LLSEC_MIC_LEN];
+  uint8_t a_len;
+  uint8_t diff;
+  uint8_t i;
+#endif /* LLSEC_MIC_LEN */
+  uint8_t *ptr;
+  int hdrlen;
+  int len;
+
+  ptr = packetbuf_dataptr();
+  len = packetbuf_datalen();
+
+  memset(&frame, 0, sizeof(frame));
+  hdrlen = frame802154_parse(ptr, len, &frame);
+  if(hdrlen == 0) {
+    /* Leave it to the framer to reject */
+    return;
+  }
+  if(!frame.fcf.security_enabled ||
+     frame.aux_hdr.security_control.security_level != LLSEC_SECURITY_LEVEL ||
+     frame.aux_hdr.security_control.key_id_mode != FRAME802154_IMPLICIT_KEY ||
+     len - hdrlen < LLSEC_MIC_LEN) {
+    PRINTF("llsec: unsecured or malformed frame\n");
+    packetbuf_set_datalen(0);
+    return;
+  }
+
+  /* Frames to other nodes are dropped here already, rather than
+     spending cipher operations on them. */
+  if(frame.fcf.dest_addr_mode &&
+     !rimeaddr_cmp((rimeaddr_t *)frame.dest_addr, &rimeaddr_node_addr) &&
+     !(frame.dest_addr[0] == 0xff && frame.dest_addr[1] == 0xff)) {
+    packetbuf_set_datalen(0);
+    return;
+  }
+
+  n = nbr_table_get_from_lladdr(llsec_neighbors,
+                                (rimeaddr_t *)frame.src_addr);
+  if(n != NULL && frame.aux_hdr.frame_counter <= n->frame_counter) {
+    PRINTF("llsec: replayed frame counter %lu\n",
+           (unsigned long)frame.aux_hdr.frame_counter);
+    packetbuf_set_datalen(0);
+    return;
+  }
+
+  len -= LLSEC_MIC_LEN;
+  set_nonce(nonce, frame.src_addr, frame.aux_hdr.frame_counter);
+
+#if WITH_ENCRYPTION
+  ccm_star_ctr(nonce, ptr + hdrlen, len - hdrlen);
+#endif /* WITH_ENCRYPTION */
+
+#if LLSEC_MIC_LEN
+  a_len = auth_only_len(hdrlen, len);
+  ccm_star_mic(nonce, ptr, a_len, ptr + a_len, len - a_len,
+               mic, LLSEC_MIC_LEN);
+  /* Compare all bytes, so that the time taken does not tell how much
+     of the MIC was right. */
+  diff = 0;
+  for(i = 0; i < LLSEC_MIC_LEN; i++) {
+    diff |= mic[i] ^ ptr[len + i];
+  }
+  if(diff != 0) {
+    PRINTF("llsec: MIC mismatch\n");
+    packetbuf_set_datalen(0);
+    return;
+  }
+#endif /* LLSEC_MIC_LEN */
+
+  if(n == NULL) {
+    n = nbr_table_add_lladdr(llsec_neighbors, (rimeaddr_t *)frame.src_addr);
+  }
+  if(n != NULL) {
+    n->frame_counter = frame.aux_hdr.frame_counter;
+  }
+  packetbuf_set_datalen(len);
+}
+/*---------------------------------------------------------------------------*/
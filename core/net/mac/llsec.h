@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * \file
+ *         IEEE 802.15.4 link-layer security with AES-CCM*
+ *
+ *         With LLSEC_CONF_SECURITY_LEVEL set, framer_802154 adds an
+ *         auxiliary security header to every frame and the RDC
+ *         layer passes outgoing frames through llsec_encrypt() after
+ *         framing and incoming frames through llsec_decrypt() before
+ *         parsing, by way of the NETSTACK_ENCRYPT and
+ *         NETSTACK_DECRYPT hooks (nullrdc and ContikiMAC).
+ *
+ *         All nodes share one network key. The block cipher is
+ *         AES_128, so platforms with an AES engine get hardware
+ *         encryption by setting AES_128_CONF.
+ */
+
+#ifndef __LLSEC_H__
+#define __LLSEC_H__
+
+#include "contiki-conf.h"
+#include "net/mac/frame802154.h"
+
+/* One of the FRAME802154_SECURITY_LEVEL_* values; the default,
+   FRAME802154_SECURITY_LEVEL_NONE, disables link-layer security. */
+#ifdef LLSEC_CONF_SECURITY_LEVEL
+#define LLSEC_SECURITY_LEVEL LLSEC_CONF_SECURITY_LEVEL
+#else /* LLSEC_CONF_SECURITY_LEVEL */
+#define LLSEC_SECURITY_LEVEL FRAME802154_SECURITY_LEVEL_NONE
+#endif /* LLSEC_CONF_SECURITY_LEVEL */
+
+/* The number of bytes that security adds to the end of a frame */
+#define LLSEC_MIC_LEN ((LLSEC_SECURITY_LEVEL & 3) ? \
+                       (2 << (LLSEC_SECURITY_LEVEL & 3)) : 0)
+
+#if LLSEC_SECURITY_LEVEL
+#ifndef NETSTACK_ENCRYPT
+#define NETSTACK_ENCRYPT         llsec_encrypt
+#define NETSTACK_DECRYPT         llsec_decrypt
+#define NETSTACK_ENCRYPTION_INIT llsec_init
+#endif /* NETSTACK_ENCRYPT */
+#endif /* LLSEC_SECURITY_LEVEL */
+
+/**
+ * \brief Sets up the network key and the neighbor table.
+ */
+void llsec_init(void);
+
+/**
+ * \brief     Replaces the network key
+ * \param key The 16-byte key
+ */
+void llsec_set_key(const uint8_t *key);
+
+/**
+ * \brief Returns the frame counter to put in the next outgoing frame.
+ *        With LLSEC_CONF_PERSIST (the default), the counter goes on
+ *        from where it was before the last reboot, which needs CFS.
+ */
+uint32_t llsec_next_frame_counter(void);
+
+/**
+ * \brief Secures the frame in the packetbuf, which must have been
+ *        created by framer_802154.
+ */
+void llsec_encrypt(void);
+
+/**
+ * \brief Checks and decrypts the frame in the packetbuf. The packetbuf
+ *        is emptied if the frame is not acceptable, which makes the
+ *        framer reject it.
+ */
+void llsec_decrypt(void);
+
+#endif /* __LLSEC_H__ */
@@ -149,7 +149,16 @@ send_one_packet(mac_callback_t sent, void *ptr)
     uint8_t dsn;
     dsn = ((uint8_t *)packetbuf_hdrptr())[2] & 0xff;
 
-    NETSTACK_RADIO.prepare(packetbuf_hdrptr(), packetbuf_totlen());
+    {
+      struct radio_iovec iov[2];
+
+      /* The headers and data may not be adjacent in the packetbuf. */
+      iov[0].ptr = packetbuf_hdrptr();
+      iov[0].len = packetbuf_hdrlen();
+      iov[1].ptr = packetbuf_dataptr();
+      iov[1].len = packetbuf_datalen();
+      radio_prepare_v(&NETSTACK_RADIO, iov, 2);
+    }
 
     is_broadcast = rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
                                 &rimeaddr_null);
@@ -268,7 +277,7 @@ send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
     struct rdc_buf_list *next = buf_list->next;
     int last_sent_ok;
 
-    queuebuf_to_packetbuf(buf_list->buf);
+    queuebuf_lend_to_packetbuf(buf_list->buf);
     last_sent_ok = send_one_packet(sent, ptr);
 
     /* If packet transmission was not successful, we should back off and let
@@ -307,6 +316,7 @@ packet_input(void)
             !rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
                           &rimeaddr_null)) {
     PRINTF("nullrdc: not for us\n");
+    RIMESTATS_ADD(foreigndrop);
 #endif /* NULLRDC_ADDRESS_FILTER */
   } else {
     int duplicate = 0;
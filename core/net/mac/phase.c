@@ -44,18 +44,85 @@
 #include "net/queuebuf.h"
 #include "net/nbr-table.h"
 
+#include <string.h>
+
 #if PHASE_CONF_DRIFT_CORRECT
 #define PHASE_DRIFT_CORRECT PHASE_CONF_DRIFT_CORRECT
 #else
 #define PHASE_DRIFT_CORRECT 0
 #endif
 
+/* If PHASE_CONF_PERSIST is set, the phase table is checkpointed to
+   the file system (Coffee on most platforms) and restored at boot. */
+#ifdef PHASE_CONF_PERSIST
+#define PHASE_PERSIST PHASE_CONF_PERSIST
+#else
+#define PHASE_PERSIST 0
+#endif
+
+#if PHASE_PERSIST
+#include "cfs/cfs.h"
+
+#ifdef PHASE_CONF_PERSIST_FILE
+#define PHASE_PERSIST_FILE PHASE_CONF_PERSIST_FILE
+#else
+#define PHASE_PERSIST_FILE "phase"
+#endif
+
+/* How often the phase table is written out, if it has changed. */
+#ifdef PHASE_CONF_PERSIST_INTERVAL
+#define PHASE_PERSIST_INTERVAL PHASE_CONF_PERSIST_INTERVAL
+#else
+#define PHASE_PERSIST_INTERVAL (CLOCK_SECOND * 60 * 10)
+#endif
+
+/* Saved phases are rtimer timestamps and are only meaningful if the
+   rtimer time base at restore time can be related to the one at save
+   time. A platform whose rtimer keeps running across a reset, or that
+   has a real-time clock to measure the downtime, defines
+   PHASE_CONF_PERSIST_OFFSET(saved_at) to return the value to add to
+   saved timestamps; saved_at is RTIMER_NOW() at checkpoint time. The
+   drift correction in phase_wait() then extrapolates the phases over
+   the downtime. Without it, only the drift estimates are restored and
+   phases are re-learned at the first successful transmission. */
+#ifdef PHASE_CONF_PERSIST_OFFSET
+#define PHASE_PERSIST_OFFSET(saved_at) PHASE_CONF_PERSIST_OFFSET(saved_at)
+#endif
+
+#define PHASE_PERSIST_VERSION 1
+
+struct phase_persist_header {
+  uint8_t version;
+  uint8_t record_size;
+  rtimer_clock_t saved_at;
+};
+
+struct phase_persist_record {
+  rimeaddr_t addr;
+  rtimer_clock_t time;
+  rtimer_clock_t drift;
+};
+
+static struct ctimer persist_timer;
+static uint8_t persist_dirty;
+#define PHASE_PERSIST_CHANGED() persist_dirty = 1
+#else /* PHASE_PERSIST */
+#define PHASE_PERSIST_CHANGED()
+#endif /* PHASE_PERSIST */
+
 struct phase {
   rtimer_clock_t time;
 #if PHASE_DRIFT_CORRECT
   rtimer_clock_t drift;
 #endif
   uint8_t noacks;
+  /* The advertised channel check rate, see phase_set_rate() */
+  uint8_t rate_shift;
+#if PHASE_PERSIST
+  /* Set when time is a valid phase; cleared for entries restored
+     without a usable time base. */
+  uint8_t synced;
+#endif /* PHASE_PERSIST */
   struct timer noacks_timer;
 };
 
@@ -97,10 +164,19 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
   e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
   if(e != NULL) {
     if(mac_status == MAC_TX_OK) {
+#if PHASE_PERSIST
+      if(!e->synced) {
+        /* Keep the restored drift estimate, but take up the phase. */
+        e->synced = 1;
+      } else
+#endif /* PHASE_PERSIST */
+      {
 #if PHASE_DRIFT_CORRECT
-      e->drift = time-e->time;
+        e->drift = time-e->time;
 #endif
+      }
       e->time = time;
+      PHASE_PERSIST_CHANGED();
     }
     /* If the neighbor didn't reply to us, it may have switched
        phase (rebooted). We try a number of transmissions to it
@@ -108,12 +184,15 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
     if(mac_status == MAC_TX_NOACK) {
       PRINTF("phase noacks %d to %d.%d\n", e->noacks, neighbor->u8[0], neighbor->u8[1]);
       e->noacks++;
+      /* It may have slowed down without us hearing about it. */
+      e->rate_shift = 0;
       if(e->noacks == 1) {
         timer_set(&e->noacks_timer, MAX_NOACKS_TIME);
       }
       if(e->noacks >= MAX_NOACKS || timer_expired(&e->noacks_timer)) {
         PRINTF("drop %d\n", neighbor->u8[0]);
         nbr_table_remove(nbr_phase, e);
+        PHASE_PERSIST_CHANGED();
         return;
       }
     } else if(mac_status == MAC_TX_OK) {
@@ -129,11 +208,36 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
       e->drift = 0;
 #endif
       e->noacks = 0;
+      e->rate_shift = 0;
+#if PHASE_PERSIST
+      e->synced = 1;
+#endif /* PHASE_PERSIST */
+      PHASE_PERSIST_CHANGED();
       }
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+phase_set_rate(const rimeaddr_t *neighbor, uint8_t rate_shift)
+{
+  struct phase *e;
+
+  e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
+  if(e != NULL) {
+    e->rate_shift = rate_shift;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+phase_rate(const rimeaddr_t *neighbor)
+{
+  struct phase *e;
+
+  e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
+  return e != NULL ? e->rate_shift : 0;
+}
+/*---------------------------------------------------------------------------*/
 static void
 send_packet(void *ptr)
 {
@@ -163,6 +267,11 @@ phase_wait(const rimeaddr_t *neighbor, rtimer_clock_t cycle_time,
      time for the next expected phase and setup a ctimer to switch on
      the radio just before the phase. */
   e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
+#if PHASE_PERSIST
+  if(e != NULL && !e->synced) {
+    return PHASE_UNKNOWN;
+  }
+#endif /* PHASE_PERSIST */
   if(e != NULL) {
     rtimer_clock_t wait, now, expected, sync;
     clock_time_t ctimewait;
@@ -237,10 +346,113 @@ phase_wait(const rimeaddr_t *neighbor, rtimer_clock_t cycle_time,
   return PHASE_UNKNOWN;
 }
 /*---------------------------------------------------------------------------*/
+#if PHASE_PERSIST
+void
+phase_checkpoint(void)
+{
+  struct phase_persist_header h;
+  struct phase_persist_record r;
+  struct phase *e;
+  int fd;
+
+  cfs_remove(PHASE_PERSIST_FILE);
+  fd = cfs_open(PHASE_PERSIST_FILE, CFS_WRITE);
+  if(fd < 0) {
+    PRINTF("phase: could not open %s for writing\n", PHASE_PERSIST_FILE);
+    return;
+  }
+
+  memset(&h, 0, sizeof(h));
+  h.version = PHASE_PERSIST_VERSION;
+  h.record_size = sizeof(r);
+  h.saved_at = RTIMER_NOW();
+  if(cfs_write(fd, &h, sizeof(h)) != sizeof(h)) {
+    cfs_close(fd);
+    return;
+  }
+
+  for(e = nbr_table_head(nbr_phase); e != NULL;
+      e = nbr_table_next(nbr_phase, e)) {
+    if(!e->synced) {
+      continue;
+    }
+    memset(&r, 0, sizeof(r));
+    rimeaddr_copy(&r.addr, nbr_table_get_lladdr(nbr_phase, e));
+    r.time = e->time;
+#if PHASE_DRIFT_CORRECT
+    r.drift = e->drift;
+#endif
+    if(cfs_write(fd, &r, sizeof(r)) != sizeof(r)) {
+      PRINTF("phase: checkpoint write failed\n");
+      break;
+    }
+  }
+  cfs_close(fd);
+  persist_dirty = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+persist_timer_callback(void *ptr)
+{
+  if(persist_dirty) {
+    phase_checkpoint();
+  }
+  ctimer_reset(&persist_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+restore(void)
+{
+  struct phase_persist_header h;
+  struct phase_persist_record r;
+  struct phase *e;
+  int fd;
+
+  fd = cfs_open(PHASE_PERSIST_FILE, CFS_READ);
+  if(fd < 0) {
+    return;
+  }
+
+  if(cfs_read(fd, &h, sizeof(h)) != sizeof(h) ||
+     h.version != PHASE_PERSIST_VERSION || h.record_size != sizeof(r)) {
+    PRINTF("phase: ignoring incompatible %s\n", PHASE_PERSIST_FILE);
+    cfs_close(fd);
+    return;
+  }
+
+  while(cfs_read(fd, &r, sizeof(r)) == sizeof(r)) {
+    e = nbr_table_add_lladdr(nbr_phase, &r.addr);
+    if(e == NULL) {
+      break;
+    }
+    e->noacks = 0;
+    e->rate_shift = 0;
+#if PHASE_DRIFT_CORRECT
+    e->drift = r.drift;
+#endif
+#ifdef PHASE_PERSIST_OFFSET
+    e->time = r.time + PHASE_PERSIST_OFFSET(h.saved_at);
+    e->synced = 1;
+#else /* PHASE_PERSIST_OFFSET */
+    e->time = r.time;
+    e->synced = 0;
+#endif /* PHASE_PERSIST_OFFSET */
+    PRINTF("phase: restored %d.%d\n", r.addr.u8[0], r.addr.u8[1]);
+  }
+  cfs_close(fd);
+}
+#endif /* PHASE_PERSIST */
+/*---------------------------------------------------------------------------*/
 void
 phase_init(void)
 {
   memb_init(&queued_packets_memb);
   nbr_table_register(nbr_phase, NULL);
+#if PHASE_PERSIST
+  restore();
+  persist_dirty = 0;
+  ctimer_set(&persist_timer, PHASE_PERSIST_INTERVAL,
+             persist_timer_callback, NULL);
+#endif /* PHASE_PERSIST */
 }
 /*---------------------------------------------------------------------------*/
@@ -63,4 +63,25 @@ void phase_update(const rimeaddr_t *neighbor,
                   rtimer_clock_t time, int mac_status);
 void phase_remove(const rimeaddr_t *neighbor);
 
+/**
+ * \brief Record the channel check rate that a neighbor advertises,
+ *        as a power of two multiple of the base rate.
+ *
+ * Only neighbors with a known phase are tracked. The rate falls back
+ * to the base rate when the neighbor does not acknowledge a packet.
+ */
+void phase_set_rate(const rimeaddr_t *neighbor, uint8_t rate_shift);
+uint8_t phase_rate(const rimeaddr_t *neighbor);
+
+/**
+ * \brief Write the phase table to the file system.
+ *
+ * Only available with PHASE_CONF_PERSIST. The table is also written
+ * periodically; calling this before a planned reboot or firmware
+ * update avoids losing the phases learned since the last checkpoint.
+ */
+#if PHASE_CONF_PERSIST
+void phase_checkpoint(void);
+#endif /* PHASE_CONF_PERSIST */
+
 #endif /* PHASE_H */
@@ -0,0 +1,925 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH-MAC, a time slotted channel hopping radio duty cycling
+ *         protocol in the style of IEEE 802.15.4e TSCH.
+ *
+ *         Time is divided into timeslots, numbered by the absolute
+ *         slot number (ASN), and the timeslots repeat in a
+ *         slotframe. Each timeslot may have a link to transmit or
+ *         receive in. The channel of a link changes from slotframe to
+ *         slotframe through a hopping sequence.
+ *
+ *         Timeslot 0 is shared: all nodes listen in it, and it is used
+ *         for broadcasts and beacons. With autonomous links, each node
+ *         also listens in a timeslot derived from its address, and
+ *         unicasts are sent in the timeslot of the receiver. More
+ *         links are added with tschmac_add_link().
+ *
+ *         The coordinator sends beacons with the ASN. Other nodes scan
+ *         for beacons, join, and keep their slot timing to the node
+ *         they joined through, their time source, which they follow
+ *         by the arrival time of its frames.
+ */
+
+#include "contiki.h"
+#include "dev/radio.h"
+#include "lib/random.h"
+#include "net/mac/frame802154.h"
+#include "net/mac/tschmac.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "net/rime/rimestats.h"
+#include "sys/pt.h"
+#include "sys/rtimer.h"
+
+#include <string.h>
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/* The length of a timeslot */
+#ifdef TSCHMAC_CONF_SLOT_DURATION
+#define SLOT_DURATION TSCHMAC_CONF_SLOT_DURATION
+#else
+#define SLOT_DURATION (RTIMER_ARCH_SECOND / 100)
+#endif
+
+/* The number of timeslots in the slotframe. This should be relatively
+   prime to the length of the hopping sequence, so that every link
+   uses every channel. */
+#ifdef TSCHMAC_CONF_SLOTFRAME_LENGTH
+#define SLOTFRAME_LENGTH TSCHMAC_CONF_SLOTFRAME_LENGTH
+#else
+#define SLOTFRAME_LENGTH 11
+#endif
+
+/* The channels to hop over */
+#ifdef TSCHMAC_CONF_HOPPING_SEQUENCE
+#define HOPPING_SEQUENCE TSCHMAC_CONF_HOPPING_SEQUENCE
+#else
+#define HOPPING_SEQUENCE { 15, 25, 26, 20 }
+#endif
+
+/* Listen in the timeslot of our address and send unicasts in the
+   timeslot of the receiver */
+#ifdef TSCHMAC_CONF_AUTONOMOUS_LINKS
+#define AUTONOMOUS_LINKS TSCHMAC_CONF_AUTONOMOUS_LINKS
+#else
+#define AUTONOMOUS_LINKS 1
+#endif
+
+/* The number of links that can be added */
+#ifdef TSCHMAC_CONF_MAX_LINKS
+#define MAX_LINKS TSCHMAC_CONF_MAX_LINKS
+#else
+#define MAX_LINKS 8
+#endif
+
+/* The number of packets waiting for their timeslot */
+#ifdef TSCHMAC_CONF_QUEUE_SIZE
+#define QUEUE_SIZE TSCHMAC_CONF_QUEUE_SIZE
+#else
+#define QUEUE_SIZE 4
+#endif
+
+/* Packets wait a random number of shared timeslots, up to this
+   number, before they are sent in a shared timeslot */
+#ifdef TSCHMAC_CONF_SHARED_BACKOFF_WINDOW
+#define SHARED_BACKOFF_WINDOW TSCHMAC_CONF_SHARED_BACKOFF_WINDOW
+#else
+#define SHARED_BACKOFF_WINDOW 4
+#endif
+
+/* The number of slotframes between beacons */
+#ifdef TSCHMAC_CONF_BEACON_PERIOD
+#define BEACON_PERIOD TSCHMAC_CONF_BEACON_PERIOD
+#else
+#define BEACON_PERIOD 8
+#endif
+
+/* The number of slotframes without hearing the time source after
+   which a node considers itself out of sync and scans again */
+#ifdef TSCHMAC_CONF_DESYNC_TIMEOUT
+#define DESYNC_TIMEOUT TSCHMAC_CONF_DESYNC_TIMEOUT
+#else
+#define DESYNC_TIMEOUT (8 * BEACON_PERIOD)
+#endif
+
+/* Whether this node is the coordinator from the start */
+#ifdef TSCHMAC_CONF_COORDINATOR
+#define COORDINATOR TSCHMAC_CONF_COORDINATOR
+#else
+#define COORDINATOR 0
+#endif
+
+/* TX_OFFSET is the time from the start of a timeslot to the start of
+   the transmission. */
+#define TX_OFFSET                    (RTIMER_ARCH_SECOND / 500)
+
+/* RX_GUARD is how long before and after TX_OFFSET receivers listen
+   for the start of a frame. */
+#define RX_GUARD                     (RTIMER_ARCH_SECOND / 1000)
+
+/* RX_DELAY is the time from the start of a transmission until the
+   receiver detects the frame: the radio turnaround, preamble and
+   SFD. */
+#ifdef TSCHMAC_CONF_RX_DELAY
+#define RX_DELAY                     TSCHMAC_CONF_RX_DELAY
+#else
+#define RX_DELAY                     (RTIMER_ARCH_SECOND / 3000)
+#endif
+
+/* MAX_FRAME_TIME is the airtime of the longest frame. */
+#define MAX_FRAME_TIME               (RTIMER_ARCH_SECOND / 230)
+
+/* ACK_WAIT_TIME is the time to wait for an ack after a transmission,
+   and AFTER_ACK_DETECTED_WAIT_TIME the time until it can be read. */
+#define ACK_WAIT_TIME                (RTIMER_ARCH_SECOND / 2500)
+#define AFTER_ACK_DETECTED_WAIT_TIME (RTIMER_ARCH_SECOND / 1500)
+
+#define ACK_LEN 3
+
+/* ASN, join priority */
+#define BEACON_PAYLOAD_LEN 5
+#define BEACON_MAX_LEN     (2 + 1 + 2 + 2 + 2 + 8 + BEACON_PAYLOAD_LEN)
+
+struct tschmac_link {
+  rimeaddr_t neighbor;
+  uint16_t slot;
+  uint8_t channel_offset;
+  uint8_t options;
+};
+
+enum {
+  PACKET_FREE,
+  PACKET_QUEUED,
+  PACKET_DONE,
+};
+
+struct tschmac_packet {
+  struct queuebuf *buf;
+  mac_callback_t sent;
+  void *ptr;
+  rimeaddr_t receiver;
+  uint16_t order;
+  uint8_t backoff;
+  uint8_t ret;
+  volatile uint8_t state;
+};
+
+struct seqno {
+  rimeaddr_t sender;
+  uint8_t seqno;
+};
+
+#ifdef NETSTACK_CONF_MAC_SEQNO_HISTORY
+#define MAX_SEQNOS NETSTACK_CONF_MAC_SEQNO_HISTORY
+#else /* NETSTACK_CONF_MAC_SEQNO_HISTORY */
+#define MAX_SEQNOS 8
+#endif /* NETSTACK_CONF_MAC_SEQNO_HISTORY */
+
+static struct seqno received_seqnos[MAX_SEQNOS];
+
+static const uint8_t hopping_sequence[] = HOPPING_SEQUENCE;
+
+static struct tschmac_link links[MAX_LINKS];
+static struct tschmac_packet packets[QUEUE_SIZE];
+static uint16_t next_order;
+
+static struct rtimer rt;
+static struct pt pt;
+
+static uint8_t radio_capabilities;
+static uint8_t is_on;
+static uint8_t is_coordinator = COORDINATOR;
+
+/* The slot timing. current_slot_start is the start of the timeslot
+   with the number current_asn. */
+static volatile uint8_t associated;
+static uint32_t current_asn;
+static rtimer_clock_t current_slot_start;
+static uint8_t join_priority;
+static rimeaddr_t time_source;
+static uint32_t last_sync_asn;
+static uint32_t next_beacon_asn;
+static uint8_t beacon_seqno;
+
+/* The arrival of the last frame received in a timeslot, for the time
+   synchronization done when the frame is read */
+static volatile uint8_t last_rx_valid;
+static uint32_t last_rx_asn;
+static int16_t last_rx_drift;
+static volatile int16_t drift_correction;
+
+PROCESS(tschmac_process, "TSCH-MAC");
+
+static char slot_operation(struct rtimer *t, void *ptr);
+/*---------------------------------------------------------------------------*/
+static void
+schedule_slot_operation(struct rtimer *t, rtimer_clock_t time)
+{
+  if(RTIMER_CLOCK_LT(time, RTIMER_NOW() + 2)) {
+    time = RTIMER_NOW() + 2;
+  }
+  rtimer_set(t, time, 1, (void (*)(struct rtimer *, void *))slot_operation,
+             NULL);
+}
+#define SCHEDULE_AND_YIELD(t, time) do {        \
+    schedule_slot_operation(t, time);           \
+    PT_YIELD(&pt);                              \
+  } while(0)
+/*---------------------------------------------------------------------------*/
+static void
+set_channel(uint8_t channel_offset)
+{
+  if(NETSTACK_RADIO.set_channel != NULL) {
+    NETSTACK_RADIO.set_channel(hopping_sequence[(current_asn + channel_offset) %
+                                                sizeof(hopping_sequence)]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if AUTONOMOUS_LINKS
+static uint16_t
+autonomous_slot(const rimeaddr_t *addr)
+{
+  uint16_t sum;
+  uint8_t i;
+
+  sum = 0;
+  for(i = 0; i < sizeof(rimeaddr_t); i++) {
+    sum += addr->u8[i];
+  }
+  return 1 + sum % (SLOTFRAME_LENGTH - 1);
+}
+#endif /* AUTONOMOUS_LINKS */
+/*---------------------------------------------------------------------------*/
+static struct tschmac_link *
+find_link(uint16_t slot)
+{
+  uint8_t i;
+
+  for(i = 0; i < MAX_LINKS; i++) {
+    if(links[i].options != 0 && links[i].slot == slot) {
+      return &links[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+packet_fits_link(struct tschmac_packet *p, struct tschmac_link *link,
+                 uint16_t slot)
+{
+#if AUTONOMOUS_LINKS
+  if(!rimeaddr_cmp(&p->receiver, &rimeaddr_null) &&
+     autonomous_slot(&p->receiver) == slot) {
+    return 1;
+  }
+#endif /* AUTONOMOUS_LINKS */
+  if(link == NULL || !(link->options & TSCHMAC_LINK_TX)) {
+    return 0;
+  }
+  if(rimeaddr_cmp(&link->neighbor, &p->receiver)) {
+    return 1;
+  }
+  if(rimeaddr_cmp(&link->neighbor, &rimeaddr_null)) {
+    /* Back off in shared links, so that the neighbors that have
+       packets to send do not all send in the same timeslot. */
+    return !(link->options & TSCHMAC_LINK_SHARED) || p->backoff == 0;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+tx_channel_offset(struct tschmac_packet *p, struct tschmac_link *link,
+                  uint16_t slot)
+{
+#if AUTONOMOUS_LINKS
+  if(p != NULL && !rimeaddr_cmp(&p->receiver, &rimeaddr_null) &&
+     autonomous_slot(&p->receiver) == slot) {
+    return 0;
+  }
+#endif /* AUTONOMOUS_LINKS */
+  return link != NULL ? link->channel_offset : 0;
+}
+/*---------------------------------------------------------------------------*/
+static struct tschmac_packet *
+packet_for_slot(struct tschmac_link *link, uint16_t slot)
+{
+  struct tschmac_packet *p, *found;
+
+  found = NULL;
+  for(p = packets; p < packets + QUEUE_SIZE; p++) {
+    if(p->state != PACKET_QUEUED) {
+      continue;
+    }
+    /* The oldest packet goes first */
+    if(found != NULL && (int16_t)(p->order - found->order) > 0) {
+      continue;
+    }
+    if(packet_fits_link(p, link, slot)) {
+      found = p;
+    }
+  }
+
+  if(link != NULL && (link->options & TSCHMAC_LINK_SHARED)) {
+    for(p = packets; p < packets + QUEUE_SIZE; p++) {
+      if(p->state == PACKET_QUEUED && p->backoff > 0) {
+        p->backoff--;
+      }
+    }
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+static int
+create_beacon(uint8_t *buf)
+{
+  frame802154_t params;
+  int len;
+
+  memset(&params, 0, sizeof(params));
+  params.fcf.frame_type = FRAME802154_BEACONFRAME;
+  params.fcf.frame_version = FRAME802154_IEEE802154_2003;
+  params.fcf.dest_addr_mode = FRAME802154_SHORTADDRMODE;
+  params.dest_addr[0] = 0xFF;
+  params.dest_addr[1] = 0xFF;
+  params.dest_pid = IEEE802154_PANID;
+  if(sizeof(rimeaddr_t) == 2) {
+    params.fcf.src_addr_mode = FRAME802154_SHORTADDRMODE;
+  } else {
+    params.fcf.src_addr_mode = FRAME802154_LONGADDRMODE;
+  }
+  params.src_pid = IEEE802154_PANID;
+  rimeaddr_copy((rimeaddr_t *)&params.src_addr, &rimeaddr_node_addr);
+  params.seq = beacon_seqno++;
+
+  len = frame802154_create(&params, buf, BEACON_MAX_LEN - BEACON_PAYLOAD_LEN);
+  buf[len++] = current_asn & 0xff;
+  buf[len++] = (current_asn >> 8) & 0xff;
+  buf[len++] = (current_asn >> 16) & 0xff;
+  buf[len++] = (current_asn >> 24) & 0xff;
+  buf[len++] = join_priority;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_slot_operation(void)
+{
+  /* Skip the timeslots that have already started */
+  while(RTIMER_CLOCK_LT(current_slot_start, RTIMER_NOW() + TX_OFFSET)) {
+    current_asn++;
+    current_slot_start += SLOT_DURATION;
+  }
+  last_sync_asn = current_asn;
+  next_beacon_asn = current_asn + random_rand() % (BEACON_PERIOD * SLOTFRAME_LENGTH);
+  drift_correction = 0;
+  last_rx_valid = 0;
+  associated = 1;
+  NETSTACK_RADIO.off();
+  PT_INIT(&pt);
+  schedule_slot_operation(&rt, current_slot_start);
+}
+/*---------------------------------------------------------------------------*/
+static char
+slot_operation(struct rtimer *t, void *ptr)
+{
+  static struct tschmac_link *link;
+  static struct tschmac_packet *p;
+  static uint16_t slot;
+  static uint8_t beacon[BEACON_MAX_LEN];
+  static uint8_t dsn;
+  static uint8_t is_broadcast;
+  static rtimer_clock_t rx_start;
+  static int beacon_len;
+  static int ret;
+
+  PT_BEGIN(&pt);
+
+  while(associated && is_on) {
+    slot = current_asn % SLOTFRAME_LENGTH;
+    link = find_link(slot);
+    p = packet_for_slot(link, slot);
+    beacon_len = 0;
+
+    if(p == NULL && link != NULL && (link->options & TSCHMAC_LINK_SHARED) &&
+       (int32_t)(current_asn - next_beacon_asn) >= 0) {
+      beacon_len = create_beacon(beacon);
+      next_beacon_asn = current_asn + BEACON_PERIOD * SLOTFRAME_LENGTH +
+        random_rand() % SLOTFRAME_LENGTH;
+    }
+
+    if(p != NULL || beacon_len > 0) {
+      /* Transmit */
+      set_channel(tx_channel_offset(p, link, slot));
+      if(p != NULL) {
+        is_broadcast = rimeaddr_cmp(&p->receiver, &rimeaddr_null);
+        dsn = ((uint8_t *)queuebuf_dataptr(p->buf))[2];
+        NETSTACK_RADIO.prepare(queuebuf_dataptr(p->buf),
+                               queuebuf_datalen(p->buf));
+      } else {
+        is_broadcast = 1;
+        NETSTACK_RADIO.prepare(beacon, beacon_len);
+      }
+      if(!is_broadcast) {
+        /* Stay in receive mode after the transmission for the ack */
+        NETSTACK_RADIO.on();
+      }
+      SCHEDULE_AND_YIELD(t, current_slot_start + TX_OFFSET);
+
+      if(link != NULL && (link->options & TSCHMAC_LINK_SHARED) &&
+         NETSTACK_RADIO.channel_clear() == 0) {
+        ret = MAC_TX_COLLISION;
+      } else {
+        switch(NETSTACK_RADIO.transmit(p != NULL ?
+                                       queuebuf_datalen(p->buf) :
+                                       beacon_len)) {
+        case RADIO_TX_OK:
+          ret = MAC_TX_OK;
+          break;
+        case RADIO_TX_COLLISION:
+          ret = MAC_TX_COLLISION;
+          break;
+        case RADIO_TX_NOACK:
+          ret = MAC_TX_NOACK;
+          break;
+        default:
+          ret = MAC_TX_ERR;
+          break;
+        }
+      }
+
+      if(ret == MAC_TX_OK && !is_broadcast &&
+         (radio_capabilities & RADIO_CAP_AUTOACK)) {
+        SCHEDULE_AND_YIELD(t, RTIMER_NOW() + ACK_WAIT_TIME);
+        ret = MAC_TX_NOACK;
+        if(NETSTACK_RADIO.receiving_packet() ||
+           NETSTACK_RADIO.pending_packet() ||
+           NETSTACK_RADIO.channel_clear() == 0) {
+          uint8_t ackbuf[ACK_LEN];
+
+          SCHEDULE_AND_YIELD(t, RTIMER_NOW() + AFTER_ACK_DETECTED_WAIT_TIME);
+          if(NETSTACK_RADIO.pending_packet()) {
+            if(NETSTACK_RADIO.read(ackbuf, ACK_LEN) == ACK_LEN &&
+               ackbuf[2] == dsn) {
+              RIMESTATS_ADD(ackrx);
+              ret = MAC_TX_OK;
+            } else {
+              ret = MAC_TX_COLLISION;
+            }
+          }
+        }
+      }
+      NETSTACK_RADIO.off();
+
+      if(p != NULL) {
+        p->ret = ret;
+        p->state = PACKET_DONE;
+        process_poll(&tschmac_process);
+      }
+    } else if((link != NULL && (link->options & TSCHMAC_LINK_RX))
+#if AUTONOMOUS_LINKS
+              || slot == autonomous_slot(&rimeaddr_node_addr)
+#endif /* AUTONOMOUS_LINKS */
+              ) {
+      /* Receive */
+      set_channel(link != NULL && (link->options & TSCHMAC_LINK_RX) ?
+                  link->channel_offset : 0);
+      SCHEDULE_AND_YIELD(t, current_slot_start + TX_OFFSET - RX_GUARD);
+      NETSTACK_RADIO.on();
+
+      /* Wait for the start of a frame */
+      while(!NETSTACK_RADIO.receiving_packet() &&
+            !NETSTACK_RADIO.pending_packet() &&
+            RTIMER_CLOCK_LT(RTIMER_NOW(),
+                            current_slot_start + TX_OFFSET + RX_GUARD));
+      rx_start = RTIMER_NOW();
+
+      if(NETSTACK_RADIO.receiving_packet() ||
+         NETSTACK_RADIO.pending_packet()) {
+        if(radio_capabilities & RADIO_CAP_SFD_TIMESTAMP) {
+          rx_start = NETSTACK_RADIO.last_sfd_time();
+        }
+        last_rx_drift = (int16_t)(rx_start -
+                                  (current_slot_start + TX_OFFSET + RX_DELAY));
+        last_rx_asn = current_asn;
+        last_rx_valid = 1;
+
+        /* Stay on until the frame is in and the ack is sent */
+        while(NETSTACK_RADIO.receiving_packet() &&
+              RTIMER_CLOCK_LT(RTIMER_NOW(), current_slot_start + TX_OFFSET +
+                              RX_GUARD + MAX_FRAME_TIME)) {
+          SCHEDULE_AND_YIELD(t, RTIMER_NOW() + RX_GUARD / 4);
+        }
+        SCHEDULE_AND_YIELD(t, RTIMER_NOW() + ACK_WAIT_TIME +
+                           AFTER_ACK_DETECTED_WAIT_TIME);
+      }
+      NETSTACK_RADIO.off();
+    }
+
+    /* Move on to the next timeslot */
+    current_slot_start += drift_correction;
+    drift_correction = 0;
+    do {
+      current_asn++;
+      current_slot_start += SLOT_DURATION;
+    } while(RTIMER_CLOCK_LT(current_slot_start, RTIMER_NOW() + TX_OFFSET));
+
+    if(!is_coordinator &&
+       current_asn - last_sync_asn > DESYNC_TIMEOUT * SLOTFRAME_LENGTH) {
+      PRINTF("tschmac: lost sync\n");
+      associated = 0;
+      break;
+    }
+
+    SCHEDULE_AND_YIELD(t, current_slot_start);
+  }
+
+  if(is_on && !associated) {
+    /* Scan again, after the radio has been turned off above */
+    process_poll(&tschmac_process);
+  }
+
+  PT_END(&pt);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sync_to(const rimeaddr_t *sender)
+{
+  int16_t drift;
+
+  if(!last_rx_valid || !rimeaddr_cmp(sender, &time_source)) {
+    return;
+  }
+  last_rx_valid = 0;
+  drift = last_rx_drift;
+  if(drift > RX_GUARD) {
+    drift = RX_GUARD;
+  } else if(drift < -RX_GUARD) {
+    drift = -RX_GUARD;
+  }
+  drift_correction += drift;
+  last_sync_asn = last_rx_asn;
+}
+/*---------------------------------------------------------------------------*/
+static void
+beacon_input(void)
+{
+  frame802154_t frame;
+  rimeaddr_t sender;
+  rtimer_clock_t rx_time;
+  uint32_t asn;
+
+  if(frame802154_parse(packetbuf_dataptr(), packetbuf_datalen(), &frame) == 0 ||
+     frame.payload_len < BEACON_PAYLOAD_LEN) {
+    return;
+  }
+  rimeaddr_copy(&sender, (rimeaddr_t *)&frame.src_addr);
+  asn = frame.payload[0] | ((uint32_t)frame.payload[1] << 8) |
+    ((uint32_t)frame.payload[2] << 16) | ((uint32_t)frame.payload[3] << 24);
+
+  if(associated) {
+    if(rimeaddr_cmp(&sender, &time_source)) {
+      if(last_rx_valid && asn != last_rx_asn) {
+        PRINTF("tschmac: ASN mismatch, scanning again\n");
+        associated = 0;
+        process_poll(&tschmac_process);
+        return;
+      }
+      sync_to(&sender);
+    } else if(!is_coordinator && frame.payload[4] + 1 < join_priority) {
+      /* Switch to a time source closer to the coordinator */
+      rimeaddr_copy(&time_source, &sender);
+      join_priority = frame.payload[4] + 1;
+      sync_to(&sender);
+    }
+    return;
+  }
+
+  if(!is_on || is_coordinator) {
+    return;
+  }
+
+  /* Join */
+  if(radio_capabilities & RADIO_CAP_SFD_TIMESTAMP) {
+    rx_time = packetbuf_attr(PACKETBUF_ATTR_TIMESTAMP);
+  } else {
+    /* 32 us per byte, with the preamble and length */
+    rx_time = RTIMER_NOW() - ((packetbuf_datalen() + 6) *
+                              (unsigned long)RTIMER_ARCH_SECOND) / 31250;
+  }
+  current_asn = asn;
+  current_slot_start = rx_time - TX_OFFSET - RX_DELAY;
+  join_priority = frame.payload[4] + 1;
+  rimeaddr_copy(&time_source, &sender);
+  PRINTF("tschmac: joined through %d.%d, ASN %lu\n",
+         sender.u8[0], sender.u8[1], (unsigned long)asn);
+  start_slot_operation();
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_input(void)
+{
+  int i;
+
+  if(packetbuf_datalen() > 0 &&
+     (((uint8_t *)packetbuf_dataptr())[0] & 7) == FRAME802154_BEACONFRAME) {
+    beacon_input();
+    return;
+  }
+
+  if(NETSTACK_FRAMER.parse() < 0) {
+    PRINTF("tschmac: failed to parse %u\n", packetbuf_datalen());
+    return;
+  }
+  if(!rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                   &rimeaddr_node_addr) &&
+     !rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                   &rimeaddr_null)) {
+    PRINTF("tschmac: not for us\n");
+    RIMESTATS_ADD(foreigndrop);
+    return;
+  }
+
+  if(associated) {
+    sync_to(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  }
+
+  /* Check for duplicate packet by comparing the sequence number of
+     the incoming packet with the last few ones we saw. */
+  for(i = 0; i < MAX_SEQNOS; ++i) {
+    if(packetbuf_attr(PACKETBUF_ATTR_PACKET_ID) == received_seqnos[i].seqno &&
+       rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                    &received_seqnos[i].sender)) {
+      PRINTF("tschmac: drop duplicate\n");
+      return;
+    }
+  }
+  for(i = MAX_SEQNOS - 1; i > 0; --i) {
+    memcpy(&received_seqnos[i], &received_seqnos[i - 1],
+           sizeof(struct seqno));
+  }
+  received_seqnos[0].seqno = packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
+  rimeaddr_copy(&received_seqnos[0].sender,
+                packetbuf_addr(PACKETBUF_ADDR_SENDER));
+
+  NETSTACK_MAC.input();
+}
+/*---------------------------------------------------------------------------*/
+static int
+queue_packet(mac_callback_t sent, void *ptr)
+{
+  struct tschmac_packet *p;
+
+  for(p = packets; p < packets + QUEUE_SIZE; p++) {
+    if(p->state == PACKET_FREE) {
+      break;
+    }
+  }
+  if(p == packets + QUEUE_SIZE) {
+    PRINTF("tschmac: queue full\n");
+    return MAC_TX_ERR;
+  }
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr);
+  rimeaddr_copy(&p->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  /* Unicasts are acked by the radio of the receiver */
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK,
+                     !rimeaddr_cmp(&p->receiver, &rimeaddr_null) &&
+                     (radio_capabilities & RADIO_CAP_AUTOACK));
+  if(NETSTACK_FRAMER.create() < 0) {
+    PRINTF("tschmac: send failed, too large header\n");
+    return MAC_TX_ERR_FATAL;
+  }
+  p->buf = queuebuf_new_from_packetbuf();
+  if(p->buf == NULL) {
+    PRINTF("tschmac: no queuebuf\n");
+    return MAC_TX_ERR;
+  }
+  p->sent = sent;
+  p->ptr = ptr;
+  p->order = next_order++;
+  p->backoff = random_rand() % SHARED_BACKOFF_WINDOW;
+  p->state = PACKET_QUEUED;
+  return MAC_TX_DEFERRED;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  int ret;
+
+  ret = queue_packet(sent, ptr);
+  if(ret != MAC_TX_DEFERRED) {
+    mac_call_sent_callback(sent, ptr, ret, 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
+{
+  while(buf_list != NULL) {
+    /* We backup the next pointer, as it may be nullified by
+     * mac_call_sent_callback() */
+    struct rdc_buf_list *next = buf_list->next;
+    int ret;
+
+    queuebuf_to_packetbuf(buf_list->buf);
+    ret = queue_packet(sent, ptr);
+    if(ret != MAC_TX_DEFERRED) {
+      mac_call_sent_callback(sent, ptr, ret, 1);
+      return;
+    }
+    buf_list = next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tschmac_process, ev, data)
+{
+  struct tschmac_packet *p;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    /* Report the packets that have been sent */
+    for(p = packets; p < packets + QUEUE_SIZE; p++) {
+      if(p->state == PACKET_DONE) {
+        queuebuf_to_packetbuf(p->buf);
+        queuebuf_free(p->buf);
+        p->state = PACKET_FREE;
+        mac_call_sent_callback(p->sent, p->ptr, p->ret, 1);
+      }
+    }
+
+    if(is_on && !associated) {
+      /* Scan for beacons on one channel. The channel of the shared
+         timeslot goes through the whole hopping sequence. */
+      current_asn = 0;
+      set_channel(0);
+      NETSTACK_RADIO.on();
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+int
+tschmac_add_link(uint16_t slot, uint8_t channel_offset,
+                 uint8_t options, const rimeaddr_t *neighbor)
+{
+  uint8_t i;
+
+  if(slot >= SLOTFRAME_LENGTH || options == 0) {
+    return 0;
+  }
+  for(i = 0; i < MAX_LINKS; i++) {
+    if(links[i].options == 0) {
+      rimeaddr_copy(&links[i].neighbor, neighbor);
+      links[i].slot = slot;
+      links[i].channel_offset = channel_offset;
+      links[i].options = options;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+tschmac_remove_links(uint16_t slot)
+{
+  uint8_t i;
+
+  for(i = 0; i < MAX_LINKS; i++) {
+    if(links[i].slot == slot) {
+      links[i].options = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+start(void)
+{
+  if(is_coordinator) {
+    current_asn = 0;
+    current_slot_start = RTIMER_NOW() + SLOT_DURATION;
+    join_priority = 0;
+    rimeaddr_copy(&time_source, &rimeaddr_node_addr);
+    start_slot_operation();
+  } else {
+    process_poll(&tschmac_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tschmac_set_coordinator(int coordinator)
+{
+  is_coordinator = coordinator;
+  if(is_on) {
+    associated = 0;
+    start();
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+tschmac_is_associated(void)
+{
+  return associated;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  radio_capabilities = radio_get_capabilities(&NETSTACK_RADIO);
+  if(NETSTACK_RADIO.set_channel == NULL) {
+    PRINTF("tschmac: the radio cannot change channel, not hopping\n");
+  }
+
+  /* The shared timeslot */
+  tschmac_add_link(0, 0, TSCHMAC_LINK_TX | TSCHMAC_LINK_RX |
+                   TSCHMAC_LINK_SHARED, &rimeaddr_null);
+
+  process_start(&tschmac_process, NULL);
+  is_on = 1;
+  start();
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  if(!is_on) {
+    is_on = 1;
+    start();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(int keep_radio_on)
+{
+  is_on = 0;
+  associated = 0;
+  if(keep_radio_on) {
+    return NETSTACK_RADIO.on();
+  } else {
+    return NETSTACK_RADIO.off();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return ((unsigned long)SLOTFRAME_LENGTH * SLOT_DURATION * CLOCK_SECOND) /
+    RTIMER_ARCH_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+const struct rdc_driver tschmac_driver = {
+  "TSCH-MAC",
+  init,
+  send_packet,
+  send_list,
+  packet_input,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
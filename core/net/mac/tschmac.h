@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Header file for TSCH-MAC, a time slotted channel hopping radio
+ *         duty cycling protocol
+ */
+
+#ifndef TSCHMAC_H
+#define TSCHMAC_H
+
+#include "sys/rtimer.h"
+#include "net/mac/rdc.h"
+#include "net/rime/rimeaddr.h"
+#include "dev/radio.h"
+
+/* Link options */
+#define TSCHMAC_LINK_TX     0x01
+#define TSCHMAC_LINK_RX     0x02
+#define TSCHMAC_LINK_SHARED 0x04
+
+extern const struct rdc_driver tschmac_driver;
+
+/**
+ * \brief      Add a link to the slotframe
+ * \param slot The timeslot of the link, 0 to the slotframe length - 1
+ * \param channel_offset The channel offset of the link
+ * \param options TSCHMAC_LINK_ flags
+ * \param neighbor The neighbor of the link, or rimeaddr_null for any
+ * \return     Non-zero if the link was added
+ *
+ *             Timeslot 0 is a shared link used for broadcasts and
+ *             beacons. Dedicated links to a neighbor give
+ *             collision-free cells when both ends add them.
+ */
+int tschmac_add_link(uint16_t slot, uint8_t channel_offset,
+                     uint8_t options, const rimeaddr_t *neighbor);
+
+/**
+ * \brief      Remove the links of a timeslot
+ * \param slot The timeslot
+ */
+void tschmac_remove_links(uint16_t slot);
+
+/**
+ * \brief      Make this node the coordinator of the network
+ * \param coordinator Non-zero if the node starts the network
+ *
+ *             The coordinator defines the slot timing. Other nodes
+ *             join when they hear its beacons, or the beacons of
+ *             nodes that have joined.
+ */
+void tschmac_set_coordinator(int coordinator);
+
+/**
+ * \brief      Check if the node is synchronized to the network
+ * \return     Non-zero if the node is synchronized
+ */
+int tschmac_is_associated(void);
+
+#endif /* TSCHMAC_H */
@@ -62,6 +62,18 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_HASH
+#if NBR_TABLE_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error NBR_TABLE_HASH_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS
+#endif
+#if NBR_TABLE_MAX_NEIGHBORS > 255
+#error NBR_TABLE_CONF_HASH only supports up to 255 neighbors
+#endif
+/* Hash table of the neighbor indices, with linear probing. A slot
+   holds the neighbor index plus one, or zero if the slot is free. */
+static uint8_t hash_table[NBR_TABLE_HASH_SIZE];
+#endif /* NBR_TABLE_HASH */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -105,16 +117,87 @@ key_from_item(nbr_table_t *table, nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+#if NBR_TABLE_HASH
+/* Get the hash table slot where the search for an address starts */
+static int
+hash_slot(const rimeaddr_t *lladdr)
+{
+  uint16_t h;
+  int i;
+
+  h = 0;
+  for(i = 0; i < RIMEADDR_SIZE; i++) {
+    h = h * 31 + lladdr->u8[i];
+  }
+  return h % NBR_TABLE_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Add a key to the hash table */
+static void
+hash_add(nbr_table_key_t *key)
+{
+  int i;
+
+  for(i = hash_slot(&key->lladdr); hash_table[i] != 0;
+      i = (i + 1) % NBR_TABLE_HASH_SIZE);
+  hash_table[i] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the hash table. The following entries of the
+ * probe sequence are moved back so that no search stops early at the
+ * freed slot. */
+static void
+hash_remove(nbr_table_key_t *key)
+{
+  int i, j, home;
+
+  for(i = hash_slot(&key->lladdr); hash_table[i] != 0;
+      i = (i + 1) % NBR_TABLE_HASH_SIZE) {
+    if(hash_table[i] == index_from_key(key) + 1) {
+      break;
+    }
+  }
+  if(hash_table[i] == 0) {
+    return;
+  }
+
+  hash_table[i] = 0;
+  for(j = (i + 1) % NBR_TABLE_HASH_SIZE; hash_table[j] != 0;
+      j = (j + 1) % NBR_TABLE_HASH_SIZE) {
+    home = hash_slot(&key_from_index(hash_table[j] - 1)->lladdr);
+    /* Move the entry back unless its home slot lies cyclically
+       within (i, j]. */
+    if((i < j) ? (home <= i || home > j) : (home <= i && home > j)) {
+      hash_table[i] = hash_table[j];
+      hash_table[j] = 0;
+      i = j;
+    }
+  }
+}
+#endif /* NBR_TABLE_HASH */
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const rimeaddr_t *lladdr)
 {
   nbr_table_key_t *key;
+#if NBR_TABLE_HASH
+  int i;
+#endif /* NBR_TABLE_HASH */
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by rimeaddr_null. */
   if(lladdr == NULL) {
     lladdr = &rimeaddr_null;
   }
+#if NBR_TABLE_HASH
+  for(i = hash_slot(lladdr); hash_table[i] != 0;
+      i = (i + 1) % NBR_TABLE_HASH_SIZE) {
+    key = key_from_index(hash_table[i] - 1);
+    if(rimeaddr_cmp(lladdr, &key->lladdr)) {
+      return hash_table[i] - 1;
+    }
+  }
+#else /* NBR_TABLE_HASH */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && rimeaddr_cmp(lladdr, &key->lladdr)) {
@@ -122,6 +205,7 @@ index_from_lladdr(const rimeaddr_t *lladdr)
     }
     key = list_item_next(key);
   }
+#endif /* NBR_TABLE_HASH */
   return -1;
 }
 /*---------------------------------------------------------------------------*/
@@ -218,6 +302,9 @@ nbr_table_allocate(void)
       used_map[index_from_key(least_used_key)] = 0;
       /* Remove neighbor from list */
       list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_HASH
+      hash_remove(least_used_key);
+#endif /* NBR_TABLE_HASH */
       /* Return associated key */
       return least_used_key;
     }
@@ -298,6 +385,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
 
     /* Set link-layer address */
     rimeaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_HASH
+    hash_add(key);
+#endif /* NBR_TABLE_HASH */
   }
 
   /* Get item in the current table */
@@ -99,6 +99,7 @@
 #include "net/mac/mac.h"
 #include "net/mac/rdc.h"
 #include "net/mac/framer.h"
+#include "net/mac/llsec.h"
 #include "dev/radio.h"
 
 /**
@@ -79,6 +79,7 @@ packetbuf_clear(void)
   buflen = bufptr = 0;
   hdrptr = PACKETBUF_HDR_SIZE;
 
+  packetbuf = (uint8_t *)packetbuf_aligned;
   packetbufptr = &packetbuf[PACKETBUF_HDR_SIZE];
   packetbuf_attr_clear();
 }
@@ -235,6 +236,21 @@ packetbuf_reference_ptr(void)
   return packetbufptr;
 }
 /*---------------------------------------------------------------------------*/
+void
+packetbuf_borrow(void *buf, uint16_t len)
+{
+  packetbuf_clear();
+  packetbuf = buf;
+  packetbufptr = &packetbuf[PACKETBUF_HDR_SIZE];
+  buflen = len;
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_is_borrowed(const void *buf)
+{
+  return packetbuf == buf;
+}
+/*---------------------------------------------------------------------------*/
 uint16_t
 packetbuf_datalen(void)
 {
@@ -256,13 +272,9 @@ packetbuf_totlen(void)
 void
 packetbuf_attr_clear(void)
 {
-  int i;
-  for(i = 0; i < PACKETBUF_NUM_ATTRS; ++i) {
-    packetbuf_attrs[i].val = 0;
-  }
-  for(i = 0; i < PACKETBUF_NUM_ADDRS; ++i) {
-    rimeaddr_copy(&packetbuf_addrs[i].addr, &rimeaddr_null);
-  }
+  /* rimeaddr_null is all zeroes. */
+  memset(packetbuf_attrs, 0, sizeof(packetbuf_attrs));
+  memset(packetbuf_addrs, 0, sizeof(packetbuf_addrs));
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -286,13 +298,18 @@ int
 packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
 {
 /*   packetbuf_attrs[type].type = type; */
-  packetbuf_attrs[type].val = val;
+  if(PACKETBUF_ATTR_IS_ALLOCATED(type)) {
+    packetbuf_attrs[type].val = val;
+  }
   return 1;
 }
 /*---------------------------------------------------------------------------*/
 packetbuf_attr_t
 packetbuf_attr(uint8_t type)
 {
+  if(!PACKETBUF_ATTR_IS_ALLOCATED(type)) {
+    return 0;
+  }
   return packetbuf_attrs[type].val;
 }
 /*---------------------------------------------------------------------------*/
@@ -300,13 +317,18 @@ int
 packetbuf_set_addr(uint8_t type, const rimeaddr_t *addr)
 {
 /*   packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].type = type; */
-  rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr, addr);
+  if(PACKETBUF_ADDR_IS_ALLOCATED(type)) {
+    rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr, addr);
+  }
   return 1;
 }
 /*---------------------------------------------------------------------------*/
 const rimeaddr_t *
 packetbuf_addr(uint8_t type)
 {
+  if(!PACKETBUF_ADDR_IS_ALLOCATED(type)) {
+    return &rimeaddr_null;
+  }
   return &packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr;
 }
 /*---------------------------------------------------------------------------*/
@@ -218,6 +218,37 @@ int packetbuf_is_reference(void);
  */
 void *packetbuf_reference_ptr(void);
 
+/**
+ * \brief      Make the packetbuf use an external buffer as its storage
+ * \param buf  A pointer to the external buffer
+ * \param len  The length of the data in the external buffer
+ *
+ *             The external buffer must be PACKETBUF_HDR_SIZE +
+ *             PACKETBUF_SIZE bytes long, with the data starting
+ *             PACKETBUF_HDR_SIZE bytes into the buffer. Unlike data
+ *             referenced with packetbuf_reference(), headers are
+ *             allocated in the external buffer, in front of the data,
+ *             so that the packet can be sent without first being
+ *             copied into the packetbuf.
+ *
+ *             The packetbuf uses its own storage again after the next
+ *             call to packetbuf_clear(), or to any function that
+ *             clears the packetbuf.
+ *
+ */
+void packetbuf_borrow(void *buf, uint16_t len);
+
+/**
+ * \brief      Check if the packetbuf uses an external buffer
+ * \param buf  A pointer to the external buffer
+ * \retval     Non-zero if the packetbuf uses buf as its storage, zero otherwise.
+ *
+ *             This function is used to check if an external buffer
+ *             passed to packetbuf_borrow() is still in use by the
+ *             packetbuf.
+ */
+int packetbuf_is_borrowed(const void *buf);
+
 /**
  * \brief      Compact the packetbuf
  *
@@ -332,6 +363,12 @@ struct packetbuf_addr {
 #define PACKETBUF_ATTR_PACKET_TYPE_STREAM_END 3
 #define PACKETBUF_ATTR_PACKET_TYPE_TIMESTAMP 4
 
+/* Transmission priority classes; higher classes are queued ahead of
+   lower ones and may use buffers that are reserved for them. */
+#define PACKETBUF_ATTR_PRIORITY_BULK         0
+#define PACKETBUF_ATTR_PRIORITY_INTERACTIVE  1
+#define PACKETBUF_ATTR_PRIORITY_CONTROL      2
+
 enum {
   PACKETBUF_ATTR_NONE,
 
@@ -347,22 +384,27 @@ enum {
   PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
   PACKETBUF_ATTR_MAC_SEQNO,
   PACKETBUF_ATTR_MAC_ACK,
+  PACKETBUF_ATTR_PRIORITY,
 
   /* Scope 1 attributes: used between two neighbors only. */
   PACKETBUF_ATTR_RELIABLE,
   PACKETBUF_ATTR_PACKET_ID,
   PACKETBUF_ATTR_PACKET_TYPE,
-  PACKETBUF_ATTR_REXMIT,
-  PACKETBUF_ATTR_MAX_REXMIT,
-  PACKETBUF_ATTR_NUM_REXMIT,
   PACKETBUF_ATTR_PENDING,
   
   /* Scope 2 attributes: used between end-to-end nodes. */
+  PACKETBUF_ATTR_ERELIABLE,
+
+  /* Attributes that only Rime uses. Scope 1. */
+  PACKETBUF_ATTR_REXMIT,
+  PACKETBUF_ATTR_MAX_REXMIT,
+  PACKETBUF_ATTR_NUM_REXMIT,
+
+  /* Scope 2. */
   PACKETBUF_ATTR_HOPS,
   PACKETBUF_ATTR_TTL,
   PACKETBUF_ATTR_EPACKET_ID,
   PACKETBUF_ATTR_EPACKET_TYPE,
-  PACKETBUF_ATTR_ERELIABLE,
 
   /* These must be last */
   PACKETBUF_ADDR_SENDER,
@@ -373,12 +415,34 @@ enum {
   PACKETBUF_ATTR_MAX
 };
 
+/* The attributes and end-to-end addresses that only Rime uses are
+   allocated unless PACKETBUF_CONF_RIME_ATTRS is set to zero, which
+   saves RAM in the packet buffer and in every queuebuf on nodes that
+   do not run Rime protocols. Setting an attribute that is not
+   allocated has no effect, and reading it gives zero. */
+#ifdef PACKETBUF_CONF_RIME_ATTRS
+#define PACKETBUF_RIME_ATTRS PACKETBUF_CONF_RIME_ATTRS
+#else /* PACKETBUF_CONF_RIME_ATTRS */
+#define PACKETBUF_RIME_ATTRS 1
+#endif /* PACKETBUF_CONF_RIME_ATTRS */
+
+#if PACKETBUF_RIME_ATTRS
 #define PACKETBUF_NUM_ADDRS 4
-#define PACKETBUF_NUM_ATTRS (PACKETBUF_ATTR_MAX - PACKETBUF_NUM_ADDRS)
+#define PACKETBUF_NUM_ATTRS PACKETBUF_ADDR_SENDER
+#else /* PACKETBUF_RIME_ATTRS */
+#define PACKETBUF_NUM_ADDRS 2
+#define PACKETBUF_NUM_ATTRS PACKETBUF_ATTR_REXMIT
+#endif /* PACKETBUF_RIME_ATTRS */
 #define PACKETBUF_ADDR_FIRST PACKETBUF_ADDR_SENDER
 
 #define PACKETBUF_IS_ADDR(type) ((type) >= PACKETBUF_ADDR_FIRST)
 
+/* Whether storage is allocated for an attribute or address. Folds
+   to a constant for constant types. */
+#define PACKETBUF_ATTR_IS_ALLOCATED(type) ((type) < PACKETBUF_NUM_ATTRS)
+#define PACKETBUF_ADDR_IS_ALLOCATED(type) \
+  ((type) < PACKETBUF_ADDR_FIRST + PACKETBUF_NUM_ADDRS)
+
 #if PACKETBUF_CONF_ATTRS_INLINE
 
 extern struct packetbuf_attr packetbuf_attrs[];
@@ -393,12 +457,17 @@ static inline int
 packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
 {
 /*   packetbuf_attrs[type].type = type; */
-  packetbuf_attrs[type].val = val;
+  if(PACKETBUF_ATTR_IS_ALLOCATED(type)) {
+    packetbuf_attrs[type].val = val;
+  }
   return 1;
 }
 static inline packetbuf_attr_t
 packetbuf_attr(uint8_t type)
 {
+  if(!PACKETBUF_ATTR_IS_ALLOCATED(type)) {
+    return 0;
+  }
   return packetbuf_attrs[type].val;
 }
 
@@ -406,13 +475,18 @@ static inline int
 packetbuf_set_addr(uint8_t type, const rimeaddr_t *addr)
 {
 /*   packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].type = type; */
-  rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr, addr);
+  if(PACKETBUF_ADDR_IS_ALLOCATED(type)) {
+    rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr, addr);
+  }
   return 1;
 }
 
 static inline const rimeaddr_t *
 packetbuf_addr(uint8_t type)
 {
+  if(!PACKETBUF_ADDR_IS_ALLOCATED(type)) {
+    return &rimeaddr_null;
+  }
   return &packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr;
 }
 #else /* PACKETBUF_CONF_ATTRS_INLINE */
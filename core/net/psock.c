@@ -44,6 +44,8 @@
 #define STATE_BLOCKED_SEND 5
 #define STATE_DATA_SENT 6
 
+#define MIN(a, b) ((a) < (b)? (a) : (b))
+
 /*
  * Return value of the buffering functions that indicates that a
  * buffer was not filled by incoming data.
@@ -107,17 +109,26 @@ static uint8_t
 buf_bufto(CC_REGISTER_ARG struct psock_buf *buf, uint8_t endmarker,
 	  CC_REGISTER_ARG uint8_t **dataptr, CC_REGISTER_ARG uint16_t *datalen)
 {
-  uint8_t c;
-  while(buf->left > 0 && *datalen > 0) {
-    c = *buf->ptr = **dataptr;
-    ++*dataptr;
-    ++buf->ptr;
-    --*datalen;
-    --buf->left;
-    
-    if(c == endmarker) {
-      return BUF_FOUND;
-    }
+  uint8_t *end;
+  uint16_t len;
+
+  /* Locate the end marker with memchr() and move everything up to and
+     including it in one go, instead of copying the data byte by
+     byte. */
+  len = MIN(buf->left, *datalen);
+  end = memchr(*dataptr, endmarker, len);
+  if(end != NULL) {
+    len = end - *dataptr + 1;
+  }
+
+  memcpy(buf->ptr, *dataptr, len);
+  *dataptr += len;
+  buf->ptr += len;
+  *datalen -= len;
+  buf->left -= len;
+
+  if(end != NULL) {
+    return BUF_FOUND;
   }
 
   if(*datalen == 0) {
@@ -134,21 +145,21 @@ data_is_sent_and_acked(CC_REGISTER_ARG struct psock *s)
      increase the send pointer and call send_data() to send more
      data. */
   if(s->state != STATE_DATA_SENT || uip_rexmit()) {
+    /* The data stays where it is until it has been acked, so uIP can
+       retransmit it without calling us. */
     if(s->sendlen > uip_mss()) {
-      uip_send(s->sendptr, uip_mss());
+      s->sentlen = uip_mss();
     } else {
-      uip_send(s->sendptr, s->sendlen);
+      s->sentlen = s->sendlen;
     }
+    uip_send_stable(s->sendptr, s->sentlen);
     s->state = STATE_DATA_SENT;
     return 0;
   } else if(s->state == STATE_DATA_SENT && uip_acked()) {
-    if(s->sendlen > uip_mss()) {
-      s->sendlen -= uip_mss();
-      s->sendptr += uip_mss();
-    } else {
-      s->sendptr += s->sendlen;
-      s->sendlen = 0;
-    }
+    /* uip_mss() may have changed since the data was sent, so we
+       advance by what was actually sent. */
+    s->sendptr += s->sentlen;
+    s->sendlen -= s->sentlen;
     s->state = STATE_ACKED;
     return 1;
   }
@@ -248,6 +259,31 @@ psock_newdata(struct psock *s)
   }
 }
 /*---------------------------------------------------------------------------*/
+uint16_t
+psock_peek(struct psock *s, uint8_t **dataptr)
+{
+  /* Once the segment is used up, psock_newdata() blocks the psock
+     until the next one arrives, as for the PSOCK_READ functions. */
+  if(s->readlen == 0 && psock_newdata(s)) {
+    /* Start reading from a new segment. */
+    s->state = STATE_READ;
+    s->readptr = (uint8_t *)uip_appdata;
+    s->readlen = uip_datalen();
+  }
+  *dataptr = s->readptr;
+  return s->readlen;
+}
+/*---------------------------------------------------------------------------*/
+void
+psock_consume(struct psock *s, uint16_t len)
+{
+  if(len > s->readlen) {
+    len = s->readlen;
+  }
+  s->readptr += len;
+  s->readlen -= len;
+}
+/*---------------------------------------------------------------------------*/
 PT_THREAD(psock_readto(CC_REGISTER_ARG struct psock *psock, unsigned char c))
 {
   PT_BEGIN(&psock->psockpt);
@@ -120,6 +120,8 @@ struct psock {
 			    incoming data. */
   
   uint16_t sendlen;         /* The number of bytes left to be sent. */
+  uint16_t sentlen;         /* The number of bytes in the last segment
+			    sent. */
   uint16_t readlen;         /* The number of bytes left to be read. */
 
   struct psock_buf buf;  /* The structure holding the state of the
@@ -171,6 +173,11 @@ PT_THREAD(psock_send(struct psock *psock, const uint8_t *buf, unsigned int len))
  * until all data has been sent and is known to have been received by
  * the remote end of the TCP connection.
  *
+ * The data must stay unchanged until then: lost segments are resent
+ * from it, by uIP itself when UIP_TCP_STABLE_SEND is enabled. This
+ * makes constant and ROM data cheaper to send than output from
+ * PSOCK_GENERATOR_SEND(), which has to be generated again.
+ *
  * \param psock (struct psock *) A pointer to the protosocket over which
  * data is to be sent.
  *
@@ -361,6 +368,45 @@ char psock_newdata(struct psock *s);
  */
 #define PSOCK_NEWDATA(psock) psock_newdata(psock)
 
+/**
+ * Look at the incoming data without copying it.
+ *
+ * This function gives direct access to the part of the uip_appdata
+ * buffer that has not yet been read from the protosocket. Parsers
+ * that do not need to keep the data around can use it instead of
+ * PSOCK_READTO() to avoid copying every byte into the input
+ * buffer. The data is only valid until the protothread yields, and
+ * stays unread until it is passed to PSOCK_CONSUME().
+ *
+ * When all data has been consumed, PSOCK_PEEK() returns 0 until the
+ * next segment arrives. Wait for it with
+ * PSOCK_WAIT_UNTIL(psock, PSOCK_PEEK(psock, &dataptr) > 0) rather
+ * than with PSOCK_NEWDATA(), which would hand out the consumed
+ * segment once more.
+ *
+ * \param psock (struct psock *) A pointer to the protosocket.
+ * \param dataptr (uint8_t **) Set to point to the unread data.
+ *
+ * \return The number of unread bytes available at *dataptr.
+ *
+ * \hideinitializer
+ */
+#define PSOCK_PEEK(psock, dataptr) psock_peek(psock, dataptr)
+
+uint16_t psock_peek(struct psock *psock, uint8_t **dataptr);
+
+/**
+ * Mark data obtained with PSOCK_PEEK() as read.
+ *
+ * \param psock (struct psock *) A pointer to the protosocket.
+ * \param len (uint16_t) The number of bytes to skip.
+ *
+ * \hideinitializer
+ */
+#define PSOCK_CONSUME(psock, len) psock_consume(psock, len)
+
+void psock_consume(struct psock *psock, uint16_t len);
+
 /**
  * Wait until a condition is true.
  *
@@ -60,12 +60,18 @@
 struct queuebuf {
 #if QUEUEBUF_DEBUG
   struct queuebuf *next;
+  struct queuebuf *prev;
   const char *file;
   int line;
   clock_time_t time;
 #endif /* QUEUEBUF_DEBUG */
 #if WITH_SWAP
   enum {IN_RAM, IN_CFS} location;
+  /* Index in the destination table, or DEST_NONE */
+  uint8_t dest;
+  /* Allocation order, used to bring the oldest swapped queuebufs
+     back to RAM first */
+  uint16_t seq;
   union {
 #endif
     struct queuebuf_data *ram_ptr;
@@ -78,6 +84,11 @@ struct queuebuf {
 /* The actual queuebuf data */
 struct queuebuf_data {
   uint16_t len;
+#if QUEUEBUF_ZEROCOPY
+  /* Room for the headers of the lower layers, when the packetbuf
+     borrows the data. Must be right in front of data. */
+  uint8_t hdr[PACKETBUF_HDR_SIZE];
+#endif /* QUEUEBUF_ZEROCOPY */
   uint8_t data[PACKETBUF_SIZE];
   struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
   struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
@@ -99,34 +110,90 @@ MEMB(buframmem, struct queuebuf_data, QUEUEBUFRAM_NUM);
 /* Swapping allows to store up to QUEUEBUF_NUM - QUEUEBUFRAM_NUM
    queuebufs in CFS. The swap is made of several large CFS files.
    Every buffer stored in CFS has a swap id, referring to a specific
-   offset in one of these files. */
+   offset in one of these files. Swap ids are handed out in sequence,
+   so new buffers are written one after the other. */
+#ifdef QUEUEBUF_CONF_SWAP_FILES
+#define NQBUF_FILES QUEUEBUF_CONF_SWAP_FILES
+#else
 #define NQBUF_FILES 4
+#endif
+#ifdef QUEUEBUF_CONF_SWAP_PER_FILE
+#define NQBUF_PER_FILE QUEUEBUF_CONF_SWAP_PER_FILE
+#else
 #define NQBUF_PER_FILE 256
+#endif
 #define QBUF_FILE_SIZE (NQBUF_PER_FILE*sizeof(struct queuebuf_data))
 #define NQBUF_ID (NQBUF_PER_FILE * NQBUF_FILES)
 
+/* New swapped buffers are collected in RAM and written to CFS
+   together, with a single write, when SWAP_BATCH of them have been
+   collected or SWAP_FLUSH_DELAY after the first one. */
+#ifdef QUEUEBUF_CONF_SWAP_BATCH
+#define SWAP_BATCH QUEUEBUF_CONF_SWAP_BATCH
+#else
+#define SWAP_BATCH 4
+#endif
+#ifdef QUEUEBUF_CONF_SWAP_FLUSH_DELAY
+#define SWAP_FLUSH_DELAY QUEUEBUF_CONF_SWAP_FLUSH_DELAY
+#else
+#define SWAP_FLUSH_DELAY (CLOCK_SECOND / 4)
+#endif
+
+/* The number of queuebufs that can wait for queuebuf_prefetch() */
+#ifdef QUEUEBUF_CONF_PREFETCH_NUM
+#define PREFETCH_NUM QUEUEBUF_CONF_PREFETCH_NUM
+#else
+#define PREFETCH_NUM 4
+#endif
+
+/* The number of destinations that queuebufs are counted for */
+#ifdef QUEUEBUF_CONF_DEST_NUM
+#define DEST_NUM QUEUEBUF_CONF_DEST_NUM
+#else
+#define DEST_NUM 4
+#endif
+#define DEST_NONE 0xff
+
 struct qbuf_file {
   int fd;
   int usage;
   int renewable;
 };
 
-/* A statically allocated queuebuf used as a cache for swapped qbufs */
+struct qbuf_dest {
+  rimeaddr_t addr;
+  uint16_t count;
+};
+
+/* New swapped buffers that have not been written yet. They have the
+   consecutive swap ids wbuf_id to wbuf_id + wbuf_count - 1, all in
+   the same file. */
+static struct queuebuf_data wbuf[SWAP_BATCH];
+static int wbuf_id;
+static uint8_t wbuf_count;
+/* A cache for the swapped buffer that was last read from CFS */
 static struct queuebuf_data tmpdata;
-/* A pointer to the qbuf associated to the data in tmpdata */
-static struct queuebuf *tmpdata_qbuf = NULL;
+static int tmpdata_id = -1;
 /* The swap id counter */
 static int next_swap_id = 0;
 /* The swap files */
 static struct qbuf_file qbuf_files[NQBUF_FILES];
 /* The timer used to renew files during inactivity periods */
 static struct ctimer renew_timer;
+static struct ctimer flush_timer;
+static struct ctimer prefetch_timer;
+/* Swapped buffers that should be brought back to RAM first */
+static struct queuebuf *prefetch_list[PREFETCH_NUM];
+/* The number of buffers in CFS */
+static uint16_t swapped;
+static uint16_t next_seq;
+static struct qbuf_dest dests[DEST_NUM];
 
 #endif
 
 #if QUEUEBUF_DEBUG
-#include "lib/list.h"
-LIST(queuebuf_list);
+#include "lib/dlist.h"
+DLIST(queuebuf_list);
 #endif /* QUEUEBUF_DEBUG */
 
 #define DEBUG 0
@@ -147,6 +214,15 @@ LIST(queuebuf_list);
 uint8_t queuebuf_len, queuebuf_ref_len, queuebuf_max_len;
 #endif /* QUEUEBUF_STATS */
 
+#if QUEUEBUF_ZEROCOPY
+/* The queuebuf last lent to the packetbuf, and whether it has been
+   freed while the packetbuf still used it. */
+static struct queuebuf *lent_buf;
+static uint8_t lent_buf_freed;
+#endif /* QUEUEBUF_ZEROCOPY */
+
+static void release_lent(void);
+
 #if WITH_SWAP
 /*---------------------------------------------------------------------------*/
 static void
@@ -158,6 +234,9 @@ qbuf_renew_file(int file)
   name[1] = '\0';
   if(qbuf_files[file].renewable == 1) {
     PRINTF("qbuf_renew_file: removing file %d\n", file);
+    if(qbuf_files[file].fd >= 0) {
+      cfs_close(qbuf_files[file].fd);
+    }
     cfs_remove(name);
   }
   ret = cfs_open(name, CFS_READ | CFS_WRITE);
@@ -181,6 +260,37 @@ qbuf_renew_all(void *unused)
   }
 }
 /*---------------------------------------------------------------------------*/
+static int
+seek_swap_id(int swap_id)
+{
+  int fd;
+
+  fd = qbuf_files[swap_id / NQBUF_PER_FILE].fd;
+  if(cfs_seek(fd, (cfs_offset_t)(swap_id % NQBUF_PER_FILE) *
+              sizeof(struct queuebuf_data), CFS_SEEK_SET) == -1) {
+    PRINTF("queuebuf: cfs seek error\n");
+    return -1;
+  }
+  return fd;
+}
+/*---------------------------------------------------------------------------*/
+/* Writes the collected new swapped buffers to CFS */
+static void
+swap_flush(void *unused)
+{
+  int fd;
+
+  ctimer_stop(&flush_timer);
+  if(wbuf_count > 0) {
+    fd = seek_swap_id(wbuf_id);
+    if(fd == -1 ||
+       cfs_write(fd, wbuf, wbuf_count * sizeof(struct queuebuf_data)) == -1) {
+      PRINTF("queuebuf: cfs write error\n");
+    }
+    wbuf_count = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* Removes a queuebuf from its swap file */
 static void
 queuebuf_remove_from_file(int swap_id)
@@ -189,6 +299,7 @@ queuebuf_remove_from_file(int swap_id)
   if(swap_id != -1) {
     fileid = swap_id / NQBUF_PER_FILE;
     qbuf_files[fileid].usage--;
+    swapped--;
 
     /* The file is full but doesn't contain any more queuebuf, mark it as renewable */
     if(qbuf_files[fileid].usage == 0 && fileid != next_swap_id / NQBUF_PER_FILE) {
@@ -197,8 +308,8 @@ queuebuf_remove_from_file(int swap_id)
       ctimer_set(&renew_timer, 0, qbuf_renew_all, NULL);
     }
 
-    if(tmpdata_qbuf->swap_id == swap_id) {
-      tmpdata_qbuf->swap_id = -1;
+    if(tmpdata_id == swap_id) {
+      tmpdata_id = -1;
     }
   }
 }
@@ -218,68 +329,169 @@ get_new_swap_id(void)
     }
   }
   qbuf_files[fileid].usage++;
+  swapped++;
   next_swap_id = (next_swap_id+1) % NQBUF_ID;
   return swap_id;
 }
 /*---------------------------------------------------------------------------*/
-/* Flush tmpdata to CFS */
-static int
-queuebuf_flush_tmpdata(void)
+/* Gives a new queuebuf a swap id and the RAM for its data until it
+   is written to CFS */
+static struct queuebuf_data *
+swap_alloc(struct queuebuf *b)
 {
-  int fileid, fd, ret;
-  cfs_offset_t offset;
-  if(tmpdata_qbuf) {
-    queuebuf_remove_from_file(tmpdata_qbuf->swap_id);
-    tmpdata_qbuf->swap_id = get_new_swap_id();
-    if(tmpdata_qbuf->swap_id == -1) {
-      return -1;
-    }
-    fileid = tmpdata_qbuf->swap_id / NQBUF_PER_FILE;
-    offset = (tmpdata_qbuf->swap_id % NQBUF_PER_FILE) * sizeof(struct queuebuf_data);
-    fd = qbuf_files[fileid].fd;
-    ret = cfs_seek(fd, offset, CFS_SEEK_SET);
-    if(ret == -1) {
-      PRINTF("queuebuf_flush_tmpdata: cfs seek error\n");
-      return -1;
+  int swap_id;
+
+  swap_id = get_new_swap_id();
+  if(swap_id == -1) {
+    return NULL;
+  }
+  if(wbuf_count > 0 &&
+     (wbuf_count == SWAP_BATCH || swap_id != wbuf_id + wbuf_count ||
+      swap_id % NQBUF_PER_FILE == 0)) {
+    swap_flush(NULL);
+  }
+  if(wbuf_count == 0) {
+    wbuf_id = swap_id;
+    ctimer_set(&flush_timer, SWAP_FLUSH_DELAY, swap_flush, NULL);
+  }
+  b->swap_id = swap_id;
+  return &wbuf[wbuf_count++];
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the data of a swapped queuebuf, reading it from CFS unless
+   it has not been written yet or was read last */
+static struct queuebuf_data *
+swap_load(int swap_id)
+{
+  int fd;
+
+  if(wbuf_count > 0 && swap_id >= wbuf_id &&
+     swap_id < wbuf_id + wbuf_count) {
+    return &wbuf[swap_id - wbuf_id];
+  }
+  if(swap_id != tmpdata_id) {
+    tmpdata_id = swap_id;
+    fd = seek_swap_id(swap_id);
+    if(fd == -1 ||
+       cfs_read(fd, &tmpdata, sizeof(struct queuebuf_data)) == -1) {
+      PRINTF("queuebuf_load_to_ram: cfs read error\n");
+      tmpdata_id = -1;
     }
-    ret = cfs_write(fd, &tmpdata, sizeof(struct queuebuf_data));
-    if(ret == -1) {
-      PRINTF("queuebuf_flush_tmpdata: cfs write error\n");
-      return -1;
+  }
+  return &tmpdata;
+}
+/*---------------------------------------------------------------------------*/
+/* Writes back a swapped queuebuf that has been modified */
+static void
+swap_store(int swap_id)
+{
+  int fd;
+
+  if(swap_id == tmpdata_id) {
+    fd = seek_swap_id(swap_id);
+    if(fd == -1 ||
+       cfs_write(fd, &tmpdata, sizeof(struct queuebuf_data)) == -1) {
+      PRINTF("queuebuf: cfs write error\n");
     }
   }
-  return 0;
 }
 /*---------------------------------------------------------------------------*/
 /* If the queuebuf is in CFS, load it to tmpdata */
 static struct queuebuf_data *
 queuebuf_load_to_ram(struct queuebuf *b)
 {
-  int fileid, fd, ret;
-  cfs_offset_t offset;
   if(b->location == IN_RAM) { /* the qbuf is loacted in RAM */
     return b->ram_ptr;
   } else { /* the qbuf is located in CFS */
-    if(tmpdata_qbuf && tmpdata_qbuf->swap_id == b->swap_id) { /* the qbuf is already in tmpdata */
-      return &tmpdata;
-    } else { /* the qbuf needs to be loaded from CFS */
-      tmpdata_qbuf = b;
-      /* read the qbuf from CFS */
-      fileid = b->swap_id / NQBUF_PER_FILE;
-      offset = (b->swap_id % NQBUF_PER_FILE) * sizeof(struct queuebuf_data);
-      fd = qbuf_files[fileid].fd;
-      ret = cfs_seek(fd, offset, CFS_SEEK_SET);
-      if(ret == -1) {
-        PRINTF("queuebuf_load_to_ram: cfs seek error\n");
-      }
-      ret = cfs_read(fd, &tmpdata, sizeof(struct queuebuf_data));
-      if(ret == -1) {
-        PRINTF("queuebuf_load_to_ram: cfs read error\n");
+    return swap_load(b->swap_id);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Moves a swapped queuebuf to RAM, if there is room */
+static int
+swap_in(struct queuebuf *b)
+{
+  struct queuebuf_data *ram;
+
+  ram = memb_alloc(&buframmem);
+  if(ram == NULL) {
+    return 0;
+  }
+  memcpy(ram, swap_load(b->swap_id), sizeof(struct queuebuf_data));
+  queuebuf_remove_from_file(b->swap_id);
+  b->location = IN_RAM;
+  b->ram_ptr = ram;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static struct queuebuf *
+oldest_swapped(void)
+{
+  struct queuebuf *b, *oldest;
+  int i;
+
+  oldest = NULL;
+  for(i = 0; i < bufmem.num; i++) {
+    b = &((struct queuebuf *)bufmem.mem)[i];
+    if(bufmem.count[i] > 0 && b->location == IN_CFS &&
+       (oldest == NULL ||
+        (uint16_t)(next_seq - b->seq) > (uint16_t)(next_seq - oldest->seq))) {
+      oldest = b;
+    }
+  }
+  return oldest;
+}
+/*---------------------------------------------------------------------------*/
+/* Runs in the background, outside of the send path: brings the
+   queuebufs asked for with queuebuf_prefetch() and then the oldest
+   swapped queuebufs back to RAM, while there is room */
+static void
+prefetch(void *unused)
+{
+  struct queuebuf *b;
+  int i;
+
+  for(i = 0; i < PREFETCH_NUM; i++) {
+    b = prefetch_list[i];
+    if(b != NULL) {
+      if(memb_inmemb(&bufmem, b) && b->location == IN_CFS && !swap_in(b)) {
+        /* No room in RAM; keep it in the cache until there is */
+        swap_load(b->swap_id);
+        return;
       }
-      return &tmpdata;
+      prefetch_list[i] = NULL;
+    }
+  }
+  while(swapped > 0) {
+    b = oldest_swapped();
+    if(b == NULL || !swap_in(b)) {
+      break;
     }
   }
 }
+/*---------------------------------------------------------------------------*/
+static uint8_t
+dest_add(const rimeaddr_t *addr)
+{
+  uint8_t i, free;
+
+  free = DEST_NONE;
+  for(i = 0; i < DEST_NUM; i++) {
+    if(dests[i].count > 0 && rimeaddr_cmp(&dests[i].addr, addr)) {
+      dests[i].count++;
+      return i;
+    }
+    if(dests[i].count == 0 && free == DEST_NONE) {
+      free = i;
+    }
+  }
+  if(free != DEST_NONE) {
+    rimeaddr_copy(&dests[free].addr, addr);
+    dests[free].count = 1;
+  }
+  return free;
+}
+/*---------------------------------------------------------------------------*/
 #else /* WITH_SWAP */
 /*---------------------------------------------------------------------------*/
 static struct queuebuf_data *
@@ -295,6 +507,7 @@ queuebuf_init(void)
 #if WITH_SWAP
   int i;
   for(i=0; i<NQBUF_FILES; i++) {
+    qbuf_files[i].fd = -1;
     qbuf_files[i].renewable = 1;
     qbuf_renew_file(i);
   }
@@ -333,25 +546,33 @@ queuebuf_new_from_packetbuf(void)
     return (struct queuebuf *)rbuf;
   } else {
     struct queuebuf_data *buframptr;
+    release_lent();
     buf = memb_alloc(&bufmem);
     if(buf != NULL) {
 #if QUEUEBUF_DEBUG
-      list_add(queuebuf_list, buf);
+      dlist_add(queuebuf_list, buf);
       buf->file = file;
       buf->line = line;
       buf->time = clock_time();
 #endif /* QUEUEBUF_DEBUG */
       buf->ram_ptr = memb_alloc(&buframmem);
 #if WITH_SWAP
+      buf->seq = next_seq++;
       /* If the allocation failed, store the qbuf in swap files */
       if(buf->ram_ptr != NULL) {
         buf->location = IN_RAM;
         buframptr = buf->ram_ptr;
       } else {
         buf->location = IN_CFS;
-        buf->swap_id = -1;
-        tmpdata_qbuf = buf;
-        buframptr = &tmpdata;
+        buframptr = swap_alloc(buf);
+        if(buframptr == NULL) {
+          /* The swap is full */
+#if QUEUEBUF_DEBUG
+          dlist_remove(queuebuf_list, buf);
+#endif /* QUEUEBUF_DEBUG */
+          memb_free(&bufmem, buf);
+          return NULL;
+        }
       }
 #else
       if(buf->ram_ptr == NULL) {
@@ -365,13 +586,7 @@ queuebuf_new_from_packetbuf(void)
       packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
 
 #if WITH_SWAP
-      if(buf->location == IN_CFS) {
-        if(queuebuf_flush_tmpdata() == -1) {
-          /* We were unable to write the data in the swap */
-          memb_free(&bufmem, buf);
-          return NULL;
-        }
-      }
+      buf->dest = dest_add(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
 #endif
 
 #if QUEUEBUF_STATS
@@ -399,32 +614,69 @@ queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
-    queuebuf_flush_tmpdata();
+    swap_store(buf->swap_id);
   }
 #endif
 }
 /*---------------------------------------------------------------------------*/
-void
-queuebuf_free(struct queuebuf *buf)
+static void
+free_buf(struct queuebuf *buf)
 {
-  if(memb_inmemb(&bufmem, buf)) {
 #if WITH_SWAP
-    if(buf->location == IN_RAM) {
-      memb_free(&buframmem, buf->ram_ptr);
-    } else {
-      queuebuf_remove_from_file(buf->swap_id);
+  if(buf->dest != DEST_NONE) {
+    dests[buf->dest].count--;
+  }
+  if(buf->location == IN_RAM) {
+    memb_free(&buframmem, buf->ram_ptr);
+    if(swapped > 0) {
+      /* There is room for a swapped buffer in RAM again */
+      ctimer_set(&prefetch_timer, 0, prefetch, NULL);
     }
+  } else {
+    queuebuf_remove_from_file(buf->swap_id);
+  }
 #else
-    memb_free(&buframmem, buf->ram_ptr);
+  memb_free(&buframmem, buf->ram_ptr);
 #endif
-    memb_free(&bufmem, buf);
+  memb_free(&bufmem, buf);
 #if QUEUEBUF_STATS
-    --queuebuf_len;
-    printf("#A q=%d\n", queuebuf_len);
+  --queuebuf_len;
+  printf("#A q=%d\n", queuebuf_len);
 #endif /* QUEUEBUF_STATS */
 #if QUEUEBUF_DEBUG
-    list_remove(queuebuf_list, buf);
+  dlist_remove(queuebuf_list, buf);
 #endif /* QUEUEBUF_DEBUG */
+}
+/*---------------------------------------------------------------------------*/
+/* Free the queuebuf lent to the packetbuf if it has been freed in the
+   meantime and the packetbuf no longer uses it. */
+static void
+release_lent(void)
+{
+#if QUEUEBUF_ZEROCOPY
+  if(lent_buf != NULL && !packetbuf_is_borrowed(lent_buf->ram_ptr->hdr)) {
+    if(lent_buf_freed) {
+      free_buf(lent_buf);
+    }
+    lent_buf = NULL;
+    lent_buf_freed = 0;
+  }
+#endif /* QUEUEBUF_ZEROCOPY */
+}
+/*---------------------------------------------------------------------------*/
+void
+queuebuf_free(struct queuebuf *buf)
+{
+  if(memb_inmemb(&bufmem, buf)) {
+#if QUEUEBUF_ZEROCOPY
+    release_lent();
+    if(buf == lent_buf) {
+      /* The packetbuf still uses the data, we free it later. */
+      lent_buf_freed = 1;
+      return;
+    }
+#endif /* QUEUEBUF_ZEROCOPY */
+    free_buf(buf);
   } else if(memb_inmemb(&refbufmem, buf)) {
     memb_free(&refbufmem, buf);
 #if QUEUEBUF_STATS
@@ -450,6 +702,33 @@ queuebuf_to_packetbuf(struct queuebuf *b)
   }
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * Like queuebuf_to_packetbuf(), but with QUEUEBUF_ZEROCOPY the
+ * packetbuf uses the queuebuf data where it is, instead of a copy.
+ * The packetbuf data must then not be modified, only headers may be
+ * added to it, so that the queuebuf can be lent again for a
+ * retransmission. A queuebuf that is freed while the packetbuf uses
+ * it is freed when the packetbuf is cleared.
+ */
+void
+queuebuf_lend_to_packetbuf(struct queuebuf *b)
+{
+#if QUEUEBUF_ZEROCOPY && !defined(NETSTACK_ENCRYPT)
+  if(memb_inmemb(&bufmem, b)
+#if WITH_SWAP
+     && b->location == IN_RAM
+#endif /* WITH_SWAP */
+     ) {
+    packetbuf_borrow(b->ram_ptr->hdr, b->ram_ptr->len);
+    packetbuf_attr_copyfrom(b->ram_ptr->attrs, b->ram_ptr->addrs);
+    release_lent();
+    lent_buf = b;
+    return;
+  }
+#endif /* QUEUEBUF_ZEROCOPY && !defined(NETSTACK_ENCRYPT) */
+  queuebuf_to_packetbuf(b);
+}
+/*---------------------------------------------------------------------------*/
 void *
 queuebuf_dataptr(struct queuebuf *b)
 {
@@ -476,6 +755,9 @@ rimeaddr_t *
 queuebuf_addr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+  if(!PACKETBUF_ADDR_IS_ALLOCATED(type)) {
+    return (rimeaddr_t *)&rimeaddr_null;
+  }
   return &buframptr->addrs[type - PACKETBUF_ADDR_FIRST].addr;
 }
 /*---------------------------------------------------------------------------*/
@@ -483,16 +765,67 @@ packetbuf_attr_t
 queuebuf_attr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+  if(!PACKETBUF_ATTR_IS_ALLOCATED(type)) {
+    return 0;
+  }
   return buframptr->attrs[type].val;
 }
 /*---------------------------------------------------------------------------*/
 void
+queuebuf_prefetch(struct queuebuf *b)
+{
+#if WITH_SWAP
+  int i;
+
+  if(memb_inmemb(&bufmem, b) && b->location == IN_CFS) {
+    for(i = 0; i < PREFETCH_NUM; i++) {
+      if(prefetch_list[i] == b) {
+        break;
+      }
+      if(prefetch_list[i] == NULL) {
+        prefetch_list[i] = b;
+        break;
+      }
+    }
+    ctimer_set(&prefetch_timer, 0, prefetch, NULL);
+  }
+#endif /* WITH_SWAP */
+}
+/*---------------------------------------------------------------------------*/
+int
+queuebuf_dest_count(const rimeaddr_t *addr)
+{
+#if WITH_SWAP
+  int i;
+
+  for(i = 0; i < DEST_NUM; i++) {
+    if(dests[i].count > 0 && rimeaddr_cmp(&dests[i].addr, addr)) {
+      return dests[i].count;
+    }
+  }
+  return 0;
+#else /* WITH_SWAP */
+  return -1;
+#endif /* WITH_SWAP */
+}
+/*---------------------------------------------------------------------------*/
+int
+queuebuf_swapped(void)
+{
+#if WITH_SWAP
+  return swapped;
+#else /* WITH_SWAP */
+  return 0;
+#endif /* WITH_SWAP */
+}
+/*---------------------------------------------------------------------------*/
+void
 queuebuf_debug_print(void)
 {
 #if QUEUEBUF_DEBUG
   struct queuebuf *q;
   printf("queuebuf_list: ");
-  for(q = list_head(queuebuf_list); q != NULL;
+  for(q = dlist_head(queuebuf_list); q != NULL;
       q = list_item_next(q)) {
     printf("%s,%d,%lu ", q->file, q->line, q->time);
   }
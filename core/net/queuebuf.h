@@ -79,6 +79,16 @@
   #define WITH_SWAP 0
 #endif /* QUEUEBUFRAM_CONF_NUM */
 
+/* QUEUEBUF_ZEROCOPY lets the packetbuf use the storage of a queuebuf
+   in RAM when the queuebuf is lent with queuebuf_lend_to_packetbuf(),
+   instead of copying the queuebuf into the packetbuf. Each queuebuf
+   then also holds room for the headers of the lower layers. */
+#ifdef QUEUEBUF_CONF_ZEROCOPY
+#define QUEUEBUF_ZEROCOPY QUEUEBUF_CONF_ZEROCOPY
+#else /* QUEUEBUF_CONF_ZEROCOPY */
+#define QUEUEBUF_ZEROCOPY 0
+#endif /* QUEUEBUF_CONF_ZEROCOPY */
+
 #ifdef QUEUEBUF_CONF_DEBUG
 #define QUEUEBUF_DEBUG QUEUEBUF_CONF_DEBUG
 #else /* QUEUEBUF_CONF_DEBUG */
@@ -98,6 +108,7 @@ struct queuebuf *queuebuf_new_from_packetbuf(void);
 void queuebuf_update_attr_from_packetbuf(struct queuebuf *b);
 
 void queuebuf_to_packetbuf(struct queuebuf *b);
+void queuebuf_lend_to_packetbuf(struct queuebuf *b);
 void queuebuf_free(struct queuebuf *b);
 
 void *queuebuf_dataptr(struct queuebuf *b);
@@ -106,6 +117,20 @@ int queuebuf_datalen(struct queuebuf *b);
 rimeaddr_t *queuebuf_addr(struct queuebuf *b, uint8_t type);
 packetbuf_attr_t queuebuf_attr(struct queuebuf *b, uint8_t type);
 
+/* With swapping, asks for a queuebuf in CFS to be brought back to
+   RAM in the background, ahead of being sent. Swapped queuebufs are
+   otherwise brought back, oldest first, as soon as there is room. */
+void queuebuf_prefetch(struct queuebuf *b);
+
+/* With swapping, returns the number of queuebufs held for a
+   receiver, or zero if there are none or the receiver is not among
+   the QUEUEBUF_CONF_DEST_NUM tracked ones. Returns -1 without
+   swapping. */
+int queuebuf_dest_count(const rimeaddr_t *addr);
+
+/* Returns the number of queuebufs in CFS */
+int queuebuf_swapped(void);
+
 void queuebuf_debug_print(void);
 
 #endif /* __QUEUEBUF_H__ */
@@ -157,6 +157,40 @@ strcasecmp(const char *s1, const char *s2)
 #define RESOLV_SUPPORTS_RECORD_EXPIRATION 1
 #endif
 
+/** How long (in seconds) a failed lookup is remembered before the
+    name is asked for again. */
+#ifdef RESOLV_CONF_NEGATIVE_TTL
+#define RESOLV_NEGATIVE_TTL RESOLV_CONF_NEGATIVE_TTL
+#else
+#define RESOLV_NEGATIVE_TTL 30
+#endif
+
+/** Bounds (in seconds) applied to the TTL of received records. */
+#ifdef RESOLV_CONF_MIN_TTL
+#define RESOLV_MIN_TTL RESOLV_CONF_MIN_TTL
+#else
+#define RESOLV_MIN_TTL 10
+#endif
+
+#ifdef RESOLV_CONF_MAX_TTL
+#define RESOLV_MAX_TTL RESOLV_CONF_MAX_TTL
+#else
+#define RESOLV_MAX_TTL 86400UL
+#endif
+
+/* If RESOLV_CONF_PREFETCH_NAMES is set to a comma separated list of
+ * hostnames, these are queried RESOLV_CONF_PREFETCH_DELAY after the
+ * resolver has started, so that their records are already cached
+ * when applications ask for them.
+ */
+#ifdef RESOLV_CONF_PREFETCH_NAMES
+#ifdef RESOLV_CONF_PREFETCH_DELAY
+#define RESOLV_PREFETCH_DELAY RESOLV_CONF_PREFETCH_DELAY
+#else
+#define RESOLV_PREFETCH_DELAY (10 * CLOCK_SECOND)
+#endif
+#endif /* RESOLV_CONF_PREFETCH_NAMES */
+
 #if RESOLV_CONF_SUPPORTS_MDNS && !RESOLV_VERIFY_ANSWER_NAMES
 #error RESOLV_CONF_SUPPORTS_MDNS cannot be set without RESOLV_CONF_VERIFY_ANSWER_NAMES
 #endif
@@ -263,9 +297,10 @@ struct namemap {
 #define STATE_ASKING 3
 #define STATE_DONE   4
   uint8_t state;
-  uint8_t tmr;
   uint8_t retries;
+  struct timer tmr;
   uint8_t seqno;
+  uint8_t hash;
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
   unsigned long expiration;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
@@ -291,12 +326,34 @@ static struct uip_udp_conn *resolv_conn = NULL;
 
 static struct etimer retry;
 
+#ifdef RESOLV_CONF_PREFETCH_NAMES
+static const char *const prefetch_names[] = { RESOLV_CONF_PREFETCH_NAMES };
+
+static struct etimer prefetch;
+#endif /* RESOLV_CONF_PREFETCH_NAMES */
+
 process_event_t resolv_event_found;
 
 PROCESS(resolv_process, "DNS resolver");
 
 static void resolv_found(char *name, uip_ipaddr_t * ipaddr);
 
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * Case-insensitive hash of a name, compared before the full string
+ * compare when searching the name table.
+ */
+static uint8_t
+name_hash(const char *name)
+{
+  uint8_t hash = 0;
+
+  while(*name) {
+    hash = (hash << 3) + (hash >> 5) + tolower((unsigned char)*name++);
+  }
+  return hash;
+}
+
 /** \internal The DNS question message structure. */
 struct dns_question {
   uint16_t type;
@@ -644,7 +701,9 @@ mdns_prep_host_announce_packet(void)
 /*---------------------------------------------------------------------------*/
 /** \internal
  * Runs through the list of names to see if there are any that have
- * not yet been queried and, if so, sends out a query.
+ * not yet been queried or whose retransmission timer has run out and,
+ * if so, sends out a query. Every entry keeps its own timer, so any
+ * number of queries can be outstanding at the same time.
  */
 static void
 check_entries(void)
@@ -657,114 +716,147 @@ check_entries(void)
 
   register struct namemap *namemapptr;
 
+  uint8_t max_retries;
+
+  uint8_t sent = 0, more = 0, pending = 0;
+
+  clock_time_t interval, next = 0;
+
   for(i = 0; i < RESOLV_ENTRIES; ++i) {
     namemapptr = &names[i];
-    if(namemapptr->state == STATE_NEW || namemapptr->state == STATE_ASKING) {
-      etimer_set(&retry, CLOCK_SECOND / 4);
-      if(namemapptr->state == STATE_ASKING) {
-        if(--namemapptr->tmr == 0) {
+    if(namemapptr->state != STATE_NEW && namemapptr->state != STATE_ASKING) {
+      continue;
+    }
+    if(namemapptr->state == STATE_ASKING) {
+      if(!timer_expired(&namemapptr->tmr)) {
+        /* Its timer has not run out, so we only note when it will. */
+        interval = timer_remaining(&namemapptr->tmr);
+        if(!pending || interval < next) {
+          next = interval;
+        }
+        pending = 1;
+        continue;
+      }
 #if RESOLV_CONF_SUPPORTS_MDNS
-          if(++namemapptr->retries ==
-             (namemapptr->is_mdns ? RESOLV_CONF_MAX_MDNS_RETRIES :
-              RESOLV_CONF_MAX_RETRIES))
+      max_retries = namemapptr->is_mdns ? RESOLV_CONF_MAX_MDNS_RETRIES :
+                    RESOLV_CONF_MAX_RETRIES;
 #else /* RESOLV_CONF_SUPPORTS_MDNS */
-          if(++namemapptr->retries == RESOLV_CONF_MAX_RETRIES)
+      max_retries = RESOLV_CONF_MAX_RETRIES;
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
-          {
-            /* STATE_ERROR basically means "not found". */
-            namemapptr->state = STATE_ERROR;
+      if(namemapptr->retries + 1 >= max_retries) {
+        /* STATE_ERROR basically means "not found". */
+        namemapptr->state = STATE_ERROR;
 
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-            /* Keep the "not found" error valid for 30 seconds */
-            namemapptr->expiration = clock_seconds() + 30;
+        /* Keep the "not found" error cached for a while */
+        namemapptr->expiration = clock_seconds() + RESOLV_NEGATIVE_TTL;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
-            resolv_found(namemapptr->name, NULL);
-            continue;
-          }
-          namemapptr->tmr = namemapptr->retries * namemapptr->retries * 3;
+        resolv_found(namemapptr->name, NULL);
+        continue;
+      }
+    }
 
+    if(sent) {
+      /* Only one datagram can be sent per poll. Other queries that are
+       * due go out on the next poll, which we request right away.
+       */
+      more = 1;
+      continue;
+    }
+
+    if(namemapptr->state == STATE_ASKING) {
+      ++namemapptr->retries;
+      interval = namemapptr->retries * namemapptr->retries * 3 *
+                 (CLOCK_SECOND / 4);
 #if RESOLV_CONF_SUPPORTS_MDNS
-          if(namemapptr->is_probe) {
-            /* Probing retries are much more aggressive, 250ms */
-            namemapptr->tmr = 2;
-          }
-#endif /* RESOLV_CONF_SUPPORTS_MDNS */
-        } else {
-          /* Its timer has not run out, so we move on to next
-           * entry.
-           */
-          continue;
-        }
-      } else {
-        namemapptr->state = STATE_ASKING;
-        namemapptr->tmr = 1;
-        namemapptr->retries = 0;
+      if(namemapptr->is_probe) {
+        /* Probing retries are much more aggressive, 250ms */
+        interval = CLOCK_SECOND / 4;
       }
-      hdr = (struct dns_hdr *)uip_appdata;
-      memset(hdr, 0, sizeof(struct dns_hdr));
-      hdr->id = RESOLV_ENCODE_INDEX(i);
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+    } else {
+      namemapptr->state = STATE_ASKING;
+      namemapptr->retries = 0;
+      interval = CLOCK_SECOND / 4;
+    }
+    timer_set(&namemapptr->tmr, interval);
+    if(!pending || interval < next) {
+      next = interval;
+    }
+    pending = 1;
+    sent = 1;
+
+    hdr = (struct dns_hdr *)uip_appdata;
+    memset(hdr, 0, sizeof(struct dns_hdr));
+    hdr->id = RESOLV_ENCODE_INDEX(i);
 #if RESOLV_CONF_SUPPORTS_MDNS
-      if(!namemapptr->is_mdns || namemapptr->is_probe) {
-        hdr->flags1 = DNS_FLAG1_RD;
-      }
-      if(namemapptr->is_mdns) {
-        hdr->id = 0;
-      }
-#else /* RESOLV_CONF_SUPPORTS_MDNS */
+    if(!namemapptr->is_mdns || namemapptr->is_probe) {
       hdr->flags1 = DNS_FLAG1_RD;
+    }
+    if(namemapptr->is_mdns) {
+      hdr->id = 0;
+    }
+#else /* RESOLV_CONF_SUPPORTS_MDNS */
+    hdr->flags1 = DNS_FLAG1_RD;
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
-      hdr->numquestions = UIP_HTONS(1);
-      query = (unsigned char *)uip_appdata + sizeof(*hdr);
-      query = encode_name(query, namemapptr->name);
+    hdr->numquestions = UIP_HTONS(1);
+    query = (unsigned char *)uip_appdata + sizeof(*hdr);
+    query = encode_name(query, namemapptr->name);
 #if RESOLV_CONF_SUPPORTS_MDNS
-      if(namemapptr->is_probe) {
-        *query++ = (uint8_t) ((DNS_TYPE_ANY) >> 8);
-        *query++ = (uint8_t) ((DNS_TYPE_ANY));
-      } else
+    if(namemapptr->is_probe) {
+      *query++ = (uint8_t) ((DNS_TYPE_ANY) >> 8);
+      *query++ = (uint8_t) ((DNS_TYPE_ANY));
+    } else
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
-      {
-        *query++ = (uint8_t) ((NATIVE_DNS_TYPE) >> 8);
-        *query++ = (uint8_t) ((NATIVE_DNS_TYPE));
-      }
-      *query++ = (uint8_t) ((DNS_CLASS_IN) >> 8);
-      *query++ = (uint8_t) ((DNS_CLASS_IN));
+    {
+      *query++ = (uint8_t) ((NATIVE_DNS_TYPE) >> 8);
+      *query++ = (uint8_t) ((NATIVE_DNS_TYPE));
+    }
+    *query++ = (uint8_t) ((DNS_CLASS_IN) >> 8);
+    *query++ = (uint8_t) ((DNS_CLASS_IN));
 #if RESOLV_CONF_SUPPORTS_MDNS
-      if(namemapptr->is_mdns) {
-        if(namemapptr->is_probe) {
-          /* This is our conflict detection request.
-           * In order to be in compliance with the MDNS
-           * spec, we need to add the records we are proposing
-           * to the rrauth section.
-           */
-          uint8_t count = 0;
-
-          query = mdns_write_announce_records(query, &count);
-          hdr->numauthrr = UIP_HTONS(count);
-        }
-        uip_udp_packet_sendto(resolv_conn, uip_appdata,
-                              (query - (uint8_t *) uip_appdata),
-                              &resolv_mdns_addr, UIP_HTONS(MDNS_PORT));
-
-        PRINTF("resolver: (i=%d) Sent MDNS %s for \"%s\".\n", i,
-               namemapptr->is_probe?"probe":"request",namemapptr->name);
-      } else {
-        uip_udp_packet_sendto(resolv_conn, uip_appdata,
-                              (query - (uint8_t *) uip_appdata),
-                              &resolv_default_dns_server, UIP_HTONS(DNS_PORT));
+    if(namemapptr->is_mdns) {
+      if(namemapptr->is_probe) {
+        /* This is our conflict detection request.
+         * In order to be in compliance with the MDNS
+         * spec, we need to add the records we are proposing
+         * to the rrauth section.
+         */
+        uint8_t count = 0;
 
-        PRINTF("resolver: (i=%d) Sent DNS request for \"%s\".\n", i,
-               namemapptr->name);
+        query = mdns_write_announce_records(query, &count);
+        hdr->numauthrr = UIP_HTONS(count);
       }
-#else /* RESOLV_CONF_SUPPORTS_MDNS */
+      uip_udp_packet_sendto(resolv_conn, uip_appdata,
+                            (query - (uint8_t *) uip_appdata),
+                            &resolv_mdns_addr, UIP_HTONS(MDNS_PORT));
+
+      PRINTF("resolver: (i=%d) Sent MDNS %s for \"%s\".\n", i,
+             namemapptr->is_probe?"probe":"request",namemapptr->name);
+    } else {
       uip_udp_packet_sendto(resolv_conn, uip_appdata,
                             (query - (uint8_t *) uip_appdata),
                             &resolv_default_dns_server, UIP_HTONS(DNS_PORT));
+
       PRINTF("resolver: (i=%d) Sent DNS request for \"%s\".\n", i,
              namemapptr->name);
-#endif /* RESOLV_CONF_SUPPORTS_MDNS */
-      break;
     }
+#else /* RESOLV_CONF_SUPPORTS_MDNS */
+    uip_udp_packet_sendto(resolv_conn, uip_appdata,
+                          (query - (uint8_t *) uip_appdata),
+                          &resolv_default_dns_server, UIP_HTONS(DNS_PORT));
+    PRINTF("resolver: (i=%d) Sent DNS request for \"%s\".\n", i,
+           namemapptr->name);
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+  }
+
+  if(more) {
+    tcpip_poll_udp(resolv_conn);
+  }
+  if(pending) {
+    /* Wake up when the earliest outstanding query needs a retransmit. */
+    etimer_set(&retry, next);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -920,8 +1012,8 @@ newdata(void)
     namemapptr->err = hdr->flags2 & DNS_FLAG2_ERR_MASK;
 
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-    /* If we remain in the error state, keep it cached for 30 seconds. */
-    namemapptr->expiration = clock_seconds() + 30;
+    /* If we remain in the error state, keep it cached for a while. */
+    namemapptr->expiration = clock_seconds() + RESOLV_NEGATIVE_TTL;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
     /* Check for error. If so, call callback to inform. */
@@ -1000,6 +1092,7 @@ newdata(void)
           namemapptr = NULL;
           goto skip_to_next_answer;
         }
+        namemapptr->hash = name_hash(namemapptr->name);
       }
       if(i == RESOLV_ENTRIES) {
         DEBUG_PRINTF
@@ -1034,8 +1127,17 @@ newdata(void)
 
     namemapptr->state = STATE_DONE;
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-    namemapptr->expiration = ans->ttl[1] + (ans->ttl[0] << 8);
-    namemapptr->expiration += clock_seconds();
+    {
+      uint32_t ttl = ((uint32_t) uip_ntohs(ans->ttl[0]) << 16) |
+                     uip_ntohs(ans->ttl[1]);
+
+      if(ttl < RESOLV_MIN_TTL) {
+        ttl = RESOLV_MIN_TTL;
+      } else if(ttl > RESOLV_MAX_TTL) {
+        ttl = RESOLV_MAX_TTL;
+      }
+      namemapptr->expiration = clock_seconds() + ttl;
+    }
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
     uip_ipaddr_copy(&namemapptr->ipaddr, (uip_ipaddr_t *) ans->ipaddr);
@@ -1149,10 +1251,24 @@ PROCESS_THREAD(resolv_process, ev, data)
   resolv_set_hostname(CONTIKI_CONF_DEFAULT_HOSTNAME);
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
 
+#ifdef RESOLV_CONF_PREFETCH_NAMES
+  etimer_set(&prefetch, RESOLV_PREFETCH_DELAY);
+#endif /* RESOLV_CONF_PREFETCH_NAMES */
+
   while(1) {
     PROCESS_WAIT_EVENT();
 
     if(ev == PROCESS_EVENT_TIMER) {
+#ifdef RESOLV_CONF_PREFETCH_NAMES
+      if(data == &prefetch) {
+        uint8_t i;
+
+        for(i = 0; i < sizeof(prefetch_names) / sizeof(prefetch_names[0]); ++i) {
+          PRINTF("resolver: Prefetching \"%s\".\n", prefetch_names[i]);
+          resolv_query(prefetch_names[i]);
+        }
+      }
+#endif /* RESOLV_CONF_PREFETCH_NAMES */
       tcpip_poll_udp(resolv_conn);
     } else if(ev == tcpip_event) {
       if(uip_udp_conn == resolv_conn) {
@@ -1232,19 +1348,25 @@ resolv_query(const char *name)
 
   register struct namemap *nameptr = 0;
 
+  uint8_t hash;
+
   lseq = lseqi = 0;
 
   /* Remove trailing dots, if present. */
   name = remove_trailing_dots(name);
 
+  hash = name_hash(name);
+
   for(i = 0; i < RESOLV_ENTRIES; ++i) {
     nameptr = &names[i];
-    if(0 == strcasecmp(nameptr->name, name)) {
+    if(nameptr->state != STATE_UNUSED && nameptr->hash == hash &&
+       0 == strcasecmp(nameptr->name, name)) {
       break;
     }
     if((nameptr->state == STATE_UNUSED)
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-      || (nameptr->state == STATE_DONE && clock_seconds() > nameptr->expiration)
+      || ((nameptr->state == STATE_DONE || nameptr->state == STATE_ERROR) &&
+          clock_seconds() > nameptr->expiration)
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
     ) {
       lseqi = i;
@@ -1258,13 +1380,34 @@ resolv_query(const char *name)
   if(i == RESOLV_ENTRIES) {
     i = lseqi;
     nameptr = &names[i];
+  } else if(nameptr->state == STATE_NEW || nameptr->state == STATE_ASKING) {
+    /* A query for this name is already outstanding; its answer will be
+       broadcast to every process waiting for it. */
+    PRINTF("resolver: Query for \"%s\" already pending.\n", name);
+    return;
+  }
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+  else if((nameptr->state == STATE_DONE || nameptr->state == STATE_ERROR) &&
+          clock_seconds() <= nameptr->expiration
+#if RESOLV_CONF_SUPPORTS_MDNS
+          /* Probes for our own name must always go out on the link. */
+          && !(mdns_state == MDNS_STATE_PROBING &&
+               0 == strcmp(name, resolv_hostname))
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+    ) {
+    /* Answer from the cache, positive or negative, without asking. */
+    PRINTF("resolver: Answering \"%s\" from cache.\n", name);
+    process_post(PROCESS_BROADCAST, resolv_event_found, nameptr->name);
+    return;
   }
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
   PRINTF("resolver: Starting query for \"%s\".\n", name);
 
   memset(nameptr, 0, sizeof(*nameptr));
 
   strncpy(nameptr->name, name, sizeof(nameptr->name));
+  nameptr->hash = hash;
   nameptr->state = STATE_NEW;
   nameptr->seqno = seqno;
   ++seqno;
@@ -1309,6 +1452,8 @@ resolv_lookup(const char *name, uip_ipaddr_t ** ipaddr)
 
   struct namemap *nameptr;
 
+  uint8_t hash;
+
   /* Remove trailing dots, if present. */
   name = remove_trailing_dots(name);
 
@@ -1328,11 +1473,14 @@ resolv_lookup(const char *name, uip_ipaddr_t ** ipaddr)
   }
 #endif /* UIP_CONF_LOOPBACK_INTERFACE */
 
+  hash = name_hash(name);
+
   /* Walk through the list to see if the name is in there. */
   for(i = 0; i < RESOLV_ENTRIES; ++i) {
     nameptr = &names[i];
 
-    if(strcasecmp(name, nameptr->name) == 0) {
+    if(nameptr->state != STATE_UNUSED && nameptr->hash == hash &&
+       strcasecmp(name, nameptr->name) == 0) {
       switch (nameptr->state) {
       case STATE_DONE:
         ret = RESOLV_STATUS_CACHED;
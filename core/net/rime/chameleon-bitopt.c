@@ -271,7 +271,18 @@ pack_header(struct channel *c)
     /*    len = (a->len & 0xf8) + ((a->len & 7) ? 8: 0);*/
     len = a->len;
     byteptr = bitptr / 8;
-    if(PACKETBUF_IS_ADDR(a->type)) {
+    if((bitptr & 7) == 0 && (len & 7) == 0) {
+      /* Whole bytes at a byte boundary: set_bits() would copy them one
+         by one, so we copy them straight. */
+      if(PACKETBUF_IS_ADDR(a->type)) {
+        memcpy(&hdrptr[byteptr], packetbuf_addr(a->type), len / 8);
+      } else {
+        packetbuf_attr_t val;
+        val = packetbuf_attr(a->type);
+        memcpy(&hdrptr[byteptr], &val, len / 8);
+      }
+      PRINTF("aligned\n");
+    } else if(PACKETBUF_IS_ADDR(a->type)) {
       set_bits(&hdrptr[byteptr], bitptr & 7,
 	       (uint8_t *)packetbuf_addr(a->type), len);
       PRINTF("address %d.%d\n",
@@ -343,14 +354,22 @@ unpack_header(void)
     byteptr = bitptr / 8;
     if(PACKETBUF_IS_ADDR(a->type)) {
       rimeaddr_t addr;
-      get_bits((uint8_t *)&addr, &hdrptr[byteptr], bitptr & 7, len);
+      if((bitptr & 7) == 0 && (len & 7) == 0) {
+        memcpy(&addr, &hdrptr[byteptr], len / 8);
+      } else {
+        get_bits((uint8_t *)&addr, &hdrptr[byteptr], bitptr & 7, len);
+      }
       PRINTF("%d.%d: unpack_header type %d, addr %d.%d\n",
 	     rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
 	     a->type, addr.u8[0], addr.u8[1]);
       packetbuf_set_addr(a->type, &addr);
     } else {
       packetbuf_attr_t val = 0;
-      get_bits((uint8_t *)&val, &hdrptr[byteptr], bitptr & 7, len);
+      if((bitptr & 7) == 0 && (len & 7) == 0) {
+        memcpy(&val, &hdrptr[byteptr], len / 8);
+      } else {
+        get_bits((uint8_t *)&val, &hdrptr[byteptr], bitptr & 7, len);
+      }
 
       packetbuf_set_attr(a->type, val);
       PRINTF("%d.%d: unpack_header type %d, val %d\n",
@@ -43,11 +43,16 @@
 
 LIST(channel_list);
 
+/* Packets tend to arrive in bursts on the same channel, so we remember
+   the last channel that channel_lookup() found. */
+static struct channel *last_lookup;
+
 /*---------------------------------------------------------------------------*/
 void
 channel_init(void)
 {
   list_init(channel_list);
+  last_lookup = NULL;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -73,14 +78,22 @@ void
 channel_close(struct channel *c)
 {
   list_remove(channel_list, c);
+  if(last_lookup == c) {
+    last_lookup = NULL;
+  }
 }
 /*---------------------------------------------------------------------------*/
 struct channel *
 channel_lookup(uint16_t channelno)
 {
   struct channel *c;
+
+  if(last_lookup != NULL && last_lookup->channelno == channelno) {
+    return last_lookup;
+  }
   for(c = list_head(channel_list); c != NULL; c = list_item_next(c)) {
     if(c->channelno == channelno) {
+      last_lookup = c;
       return c;
     }
   }
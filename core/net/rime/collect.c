@@ -81,6 +81,11 @@ struct recent_packet {
 static struct recent_packet recent_packets[NUM_RECENT_PACKETS];
 static uint8_t recent_packet_ptr;
 
+/* The ACKs of the packets sent ahead are kept in an 8 bit bitmap. */
+#if COLLECT_WINDOW > 9
+#error COLLECT_CONF_WINDOW cannot be larger than 9
+#endif /* COLLECT_WINDOW > 9 */
+
 
 /* This is the header of data packets. The header comtains the routing
    metric of the last hop sender. This is used to avoid routing loops:
@@ -707,6 +712,12 @@ retransmit_current_packet(struct collect_conn *c)
 
       rimeaddr_copy(&c->current_parent, &c->parent);
       c->transmissions = 0;
+#if COLLECT_WINDOW > 1
+      /* The packets sent ahead went to the old parent, we send them
+         to the new one when they reach the head of the queue. */
+      c->window_sent = 0;
+      c->window_acked = 0;
+#endif /* COLLECT_WINDOW > 1 */
     }
     n = collect_neighbor_list_find(&c->neighbor_list, &c->current_parent);
 
@@ -741,6 +752,159 @@ retransmit_current_packet(struct collect_conn *c)
   }
 
 }
+#if COLLECT_WINDOW > 1
+/*---------------------------------------------------------------------------*/
+/**
+ * This function is called when the MAC layer is done with a data
+ * packet. While the first packet on the send queue waits for its ACK,
+ * we send the next packet on the queue ahead of it, until
+ * COLLECT_WINDOW packets are in flight. The k:th packet behind the
+ * first one gets the packet ID seqno + k, so that its ACK can be told
+ * apart. Retransmissions are only made for the first packet: a packet
+ * sent ahead that was not ACKed is retransmitted when it reaches the
+ * head of the queue.
+ */
+static void
+send_ahead(struct collect_conn *c)
+{
+  struct packetqueue_item *i;
+  struct queuebuf *q;
+  struct data_msg_hdr hdr;
+  int k, max_mac_rexmits;
+
+  if(!c->sending || c->window_sent >= COLLECT_WINDOW - 1) {
+    return;
+  }
+
+  /* Skip the first packet and the ones already sent ahead. */
+  i = packetqueue_first(&c->send_queue);
+  for(k = 0; i != NULL && k <= c->window_sent; k++) {
+    i = list_item_next(i);
+  }
+  if(i == NULL) {
+    return;
+  }
+
+  q = packetqueue_queuebuf(i);
+  if(q != NULL) {
+    queuebuf_to_packetbuf(q);
+
+    packetbuf_set_attr(PACKETBUF_ATTR_RELIABLE, 1);
+    max_mac_rexmits = packetbuf_attr(PACKETBUF_ATTR_MAX_REXMIT) > MAX_MAC_REXMITS?
+      MAX_MAC_REXMITS : packetbuf_attr(PACKETBUF_ATTR_MAX_REXMIT);
+    packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, max_mac_rexmits);
+    packetbuf_set_attr(PACKETBUF_ATTR_PACKET_ID,
+                       (c->seqno + 1 + c->window_sent) %
+                       (1 << COLLECT_PACKET_ID_BITS));
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.rtmetric = c->rtmetric;
+    memcpy(packetbuf_dataptr(), &hdr, sizeof(struct data_msg_hdr));
+
+    PRINTF("%d.%d: sending packet ahead to %d.%d with id %d\n",
+           rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+           c->current_parent.u8[0], c->current_parent.u8[1],
+           packetbuf_attr(PACKETBUF_ATTR_PACKET_ID));
+
+    c->window[c->window_sent] = i;
+    c->window_sent++;
+    stats.datasent++;
+    unicast_send(&c->unicast_conn, &c->current_parent);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * This function is called when the first packet on the send queue has
+ * been removed. The packets that were sent ahead and ACKed are removed
+ * too. If the new first packet was sent ahead but not ACKed yet, we
+ * give its ACK some time to arrive before we retransmit it. Returns 1
+ * if the new first packet is in flight, 0 if it should be sent.
+ */
+static int
+window_shift(struct collect_conn *c)
+{
+  struct packetqueue_item *i;
+
+  while(c->window_sent > 0) {
+    i = packetqueue_first(&c->send_queue);
+    if(i != c->window[0]) {
+      /* A packet in the window was removed from the queue when its
+         lifetime expired, so the window no longer matches the
+         queue. We forget the window and send the packets again. */
+      c->window_sent = 0;
+      c->window_acked = 0;
+      return 0;
+    }
+    memmove(&c->window[0], &c->window[1],
+            (COLLECT_WINDOW - 2) * sizeof(c->window[0]));
+    c->window_sent--;
+
+    if(c->window_acked & 1) {
+      c->window_acked >>= 1;
+      packetqueue_dequeue(&c->send_queue);
+      c->seqno = (c->seqno + 1) % (1 << COLLECT_PACKET_ID_BITS);
+      continue;
+    }
+    c->window_acked >>= 1;
+
+    c->sending = 1;
+    c->transmissions = 0;
+    c->max_rexmits = queuebuf_attr(packetqueue_queuebuf(i),
+                                   PACKETBUF_ATTR_MAX_REXMIT);
+    ctimer_set(&c->retransmission_timer, REXMIT_TIME,
+               retransmit_callback, c);
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * This function is called when an ACK for a packet that was sent
+ * ahead is received. Returns 0 if the ACK is not for such a packet.
+ */
+static int
+handle_window_ack(struct collect_conn *tc)
+{
+  struct ack_msg msg;
+  struct collect_neighbor *n;
+  uint8_t k;
+
+  k = (packetbuf_attr(PACKETBUF_ATTR_PACKET_ID) - tc->seqno - 1) %
+    (1 << COLLECT_PACKET_ID_BITS);
+  if(!rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                   &tc->current_parent) ||
+     k >= tc->window_sent) {
+    return 0;
+  }
+
+  memcpy(&msg, packetbuf_dataptr(), sizeof(struct ack_msg));
+  PRINTF("%d.%d: ACK for packet %d ahead, flags %02x\n",
+         rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+         k + 1, msg.flags);
+
+  n = collect_neighbor_list_find(&tc->neighbor_list,
+                                 packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  if(n != NULL) {
+    collect_neighbor_update_rtmetric(n, msg.rtmetric);
+    if(msg.flags & ACK_FLAGS_CONGESTED) {
+      collect_neighbor_set_congested(n);
+    }
+  }
+
+  /* A packet the parent dropped is sent again when it reaches the
+     head of the queue, unless its lifetime is exceeded. */
+  if((msg.flags & ACK_FLAGS_DROPPED) == 0 ||
+     (msg.flags & ACK_FLAGS_LIFETIME_EXCEEDED)) {
+    tc->window_acked |= 1 << k;
+  }
+
+  if(msg.flags & ACK_FLAGS_RTMETRIC_NEEDS_UPDATE) {
+    bump_advertisement(tc);
+  }
+  update_rtmetric(tc);
+  return 1;
+}
+#endif /* COLLECT_WINDOW > 1 */
 /*---------------------------------------------------------------------------*/
 static void
 send_next_packet(struct collect_conn *tc)
@@ -757,6 +921,13 @@ send_next_packet(struct collect_conn *tc)
   PRINTF("sending next packet, seqno %d, queue len %d\n",
          tc->seqno, packetqueue_len(&tc->send_queue));
 
+#if COLLECT_WINDOW > 1
+  /* The next packet may already be in flight. */
+  if(window_shift(tc)) {
+    return;
+  }
+#endif /* COLLECT_WINDOW > 1 */
+
   /* Send the next packet in the queue, if any. */
   send_queued_packet(tc);
 }
@@ -767,6 +938,12 @@ handle_ack(struct collect_conn *tc)
   struct ack_msg msg;
   struct collect_neighbor *n;
 
+#if COLLECT_WINDOW > 1
+  if(handle_window_ack(tc)) {
+    return;
+  }
+#endif /* COLLECT_WINDOW > 1 */
+
   PRINTF("handle_ack: sender %d.%d current_parent %d.%d, id %d seqno %d\n",
          packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[0],
          packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[1],
@@ -906,6 +1083,66 @@ add_packet_to_recent_packets(struct collect_conn *tc)
     recent_packet_ptr = (recent_packet_ptr + 1) % NUM_RECENT_PACKETS;
   }
 }
+#if COLLECT_AGGREGATION
+/*---------------------------------------------------------------------------*/
+static void
+aggregation_timeout(void *ptr)
+{
+  struct collect_conn *tc = ptr;
+
+  if(tc->aggregate_len > 0) {
+    PRINTF("%d.%d: sending aggregate of %d bytes\n",
+           rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+           tc->aggregate_len);
+    packetbuf_clear();
+    packetbuf_copyfrom(tc->aggregate, tc->aggregate_len);
+    tc->aggregate_len = 0;
+    collect_send(tc, tc->aggregate_rexmits);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * This function is called with a data packet that should be
+ * forwarded in the packetbuf. It offers the packet to the aggregate
+ * callback and returns 1 if the packet was merged into the aggregate,
+ * in which case the packet should not be forwarded.
+ */
+static int
+aggregate_packet(struct collect_conn *tc)
+{
+  int len;
+
+  /* Keepalives and probes carry no data to aggregate. */
+  if(tc->cb->aggregate == NULL || tc->aggregation_hold_time == 0 ||
+     packetbuf_datalen() <= sizeof(struct data_msg_hdr)) {
+    return 0;
+  }
+
+  len = tc->cb->aggregate(tc->aggregate, tc->aggregate_len,
+                          sizeof(tc->aggregate),
+                          (uint8_t *)packetbuf_dataptr() +
+                          sizeof(struct data_msg_hdr),
+                          packetbuf_datalen() - sizeof(struct data_msg_hdr),
+                          packetbuf_addr(PACKETBUF_ADDR_ESENDER),
+                          packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID),
+                          packetbuf_attr(PACKETBUF_ATTR_HOPS));
+  if(len < 0 || len > sizeof(tc->aggregate)) {
+    return 0;
+  }
+
+  /* The hold time starts with the first packet of the aggregate. */
+  if(tc->aggregate_len == 0) {
+    tc->aggregate_rexmits = 0;
+    ctimer_set(&tc->aggregation_timer, tc->aggregation_hold_time,
+               aggregation_timeout, tc);
+  }
+  tc->aggregate_len = len;
+  if(packetbuf_attr(PACKETBUF_ATTR_MAX_REXMIT) > tc->aggregate_rexmits) {
+    tc->aggregate_rexmits = packetbuf_attr(PACKETBUF_ATTR_MAX_REXMIT);
+  }
+  return 1;
+}
+#endif /* COLLECT_AGGREGATION */
 /*---------------------------------------------------------------------------*/
 static void
 node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
@@ -1039,6 +1276,16 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
              from->u8[0], from->u8[1], tc->sending,
              packetbuf_attr(PACKETBUF_ATTR_MAX_REXMIT));
 
+#if COLLECT_AGGREGATION
+      /* If the packet could be merged into our aggregate, it is
+         forwarded as part of the aggregate. */
+      if(aggregate_packet(tc)) {
+        add_packet_to_recent_packets(tc);
+        send_ack(tc, &ack_to, ackflags);
+        return;
+      }
+#endif /* COLLECT_AGGREGATION */
+
       /* We try to enqueue the packet on the outgoing packet queue. If
          we are able to enqueue the packet, we send a positive ACK. If
          we are unable to enqueue the packet, we send a negative ACK
@@ -1119,6 +1366,16 @@ node_packet_sent(struct unicast_conn *c, int status, int transmissions)
   if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
      PACKETBUF_ATTR_PACKET_TYPE_DATA) {
 
+#if COLLECT_WINDOW > 1
+    if(packetbuf_attr(PACKETBUF_ATTR_PACKET_ID) != tc->seqno) {
+      /* A packet sent ahead: keep the window going. */
+      if(status == MAC_TX_OK) {
+        send_ahead(tc);
+      }
+      return;
+    }
+#endif /* COLLECT_WINDOW > 1 */
+
     tc->transmissions += transmissions;
     PRINTF("tx %d\n", tc->transmissions);    
     PRINTF("%d.%d: MAC sent %d transmissions to %d.%d, status %d, total transmissions %d\n",
@@ -1134,6 +1391,11 @@ node_packet_sent(struct unicast_conn *c, int status, int transmissions)
       PRINTF("retransmission time %lu\n", time);
       ctimer_set(&tc->retransmission_timer, time,
                  retransmit_callback, tc);
+#if COLLECT_WINDOW > 1
+      if(status == MAC_TX_OK) {
+        send_ahead(tc);
+      }
+#endif /* COLLECT_WINDOW > 1 */
     }
   }
 }
@@ -1289,6 +1551,14 @@ collect_open(struct collect_conn *tc, uint16_t channels,
   tc->is_router = is_router;
   tc->seqno = 10;
   tc->eseqno = 0;
+#if COLLECT_WINDOW > 1
+  tc->window_sent = 0;
+  tc->window_acked = 0;
+#endif /* COLLECT_WINDOW > 1 */
+#if COLLECT_AGGREGATION
+  tc->aggregation_hold_time = 0;
+  tc->aggregate_len = 0;
+#endif /* COLLECT_AGGREGATION */
   LIST_STRUCT_INIT(tc, send_queue_list);
   collect_neighbor_list_new(&tc->neighbor_list);
   tc->send_queue.list = &(tc->send_queue_list);
@@ -1356,6 +1626,19 @@ collect_set_keepalive(struct collect_conn *c, clock_time_t period)
   c->keepalive_period = period;
   set_keepalive_timer(c);
 }
+#if COLLECT_AGGREGATION
+/*---------------------------------------------------------------------------*/
+void
+collect_set_aggregation(struct collect_conn *c, clock_time_t hold_time)
+{
+  c->aggregation_hold_time = hold_time;
+  if(hold_time == 0) {
+    /* Do not sit on what we have already aggregated. */
+    ctimer_stop(&c->aggregation_timer);
+    aggregation_timeout(c);
+  }
+}
+#endif /* COLLECT_AGGREGATION */
 /*---------------------------------------------------------------------------*/
 void
 collect_close(struct collect_conn *tc)
@@ -1366,6 +1649,10 @@ collect_close(struct collect_conn *tc)
   neighbor_discovery_close(&tc->neighbor_discovery_conn);
 #endif /* COLLECT_ANNOUNCEMENTS */
   unicast_close(&tc->unicast_conn);
+#if COLLECT_AGGREGATION
+  ctimer_stop(&tc->aggregation_timer);
+  tc->aggregate_len = 0;
+#endif /* COLLECT_AGGREGATION */
   while(packetqueue_first(&tc->send_queue) != NULL) {
     packetqueue_dequeue(&tc->send_queue);
   }
@@ -1387,6 +1674,10 @@ collect_set_sink(struct collect_conn *tc, int should_be_sink)
 
     /* Stop the retransmission timer. */
     ctimer_stop(&tc->retransmission_timer);
+#if COLLECT_WINDOW > 1
+    tc->window_sent = 0;
+    tc->window_acked = 0;
+#endif /* COLLECT_WINDOW > 1 */
   } else {
     tc->rtmetric = RTMETRIC_MAX;
   }
@@ -81,6 +81,18 @@
 struct collect_callbacks {
   void (* recv)(const rimeaddr_t *originator, uint8_t seqno,
 		uint8_t hops);
+  /* Called on a router, when COLLECT_CONF_AGGREGATION is set, for
+     every data packet it should forward. The callback may merge the
+     packet data into the aggregate, which currently holds len of at
+     most maxlen bytes, and return the new length of the aggregate. It
+     returns -1 to have the packet forwarded as is. The aggregate is
+     sent, as a packet originated by this node, when the hold time set
+     with collect_set_aggregation() has passed since the first packet
+     was merged into it. */
+  int (* aggregate)(uint8_t *aggregate, int len, int maxlen,
+                    const uint8_t *data, int datalen,
+                    const rimeaddr_t *originator, uint8_t seqno,
+                    uint8_t hops);
 };
 
 /* COLLECT_CONF_ANNOUNCEMENTS defines if the Collect implementation
@@ -92,6 +104,32 @@ struct collect_callbacks {
 #define COLLECT_ANNOUNCEMENTS COLLECT_CONF_ANNOUNCEMENTS
 #endif /* COLLECT_CONF_ANNOUNCEMENTS */
 
+/* COLLECT_CONF_WINDOW defines how many packets a node may have in
+   flight towards its parent at the same time. With a window of one,
+   a packet is only sent when the previous one has been ACKed. With a
+   larger window, the packets behind the first one on the send queue
+   are sent ahead while the first one waits for its ACK. */
+#ifndef COLLECT_CONF_WINDOW
+#define COLLECT_WINDOW 1
+#else
+#define COLLECT_WINDOW COLLECT_CONF_WINDOW
+#endif /* COLLECT_CONF_WINDOW */
+
+/* COLLECT_CONF_AGGREGATION enables in-network aggregation through the
+   aggregate callback. COLLECT_CONF_AGGREGATE_SIZE is the size of the
+   aggregate each connection holds. */
+#ifndef COLLECT_CONF_AGGREGATION
+#define COLLECT_AGGREGATION 0
+#else
+#define COLLECT_AGGREGATION COLLECT_CONF_AGGREGATION
+#endif /* COLLECT_CONF_AGGREGATION */
+
+#ifndef COLLECT_CONF_AGGREGATE_SIZE
+#define COLLECT_AGGREGATE_SIZE 64
+#else
+#define COLLECT_AGGREGATE_SIZE COLLECT_CONF_AGGREGATE_SIZE
+#endif /* COLLECT_CONF_AGGREGATE_SIZE */
+
 struct collect_conn {
   struct unicast_conn unicast_conn;
 #if ! COLLECT_ANNOUNCEMENTS
@@ -117,6 +155,16 @@ struct collect_conn {
   uint8_t sending, transmissions, max_rexmits;
   uint8_t eseqno;
   uint8_t is_router;
+#if COLLECT_WINDOW > 1
+  struct packetqueue_item *window[COLLECT_WINDOW - 1];
+  uint8_t window_sent, window_acked;
+#endif /* COLLECT_WINDOW > 1 */
+#if COLLECT_AGGREGATION
+  struct ctimer aggregation_timer;
+  clock_time_t aggregation_hold_time;
+  uint8_t aggregate[COLLECT_AGGREGATE_SIZE];
+  uint8_t aggregate_len, aggregate_rexmits;
+#endif /* COLLECT_AGGREGATION */
 
   clock_time_t send_time;
 };
@@ -140,6 +188,10 @@ const rimeaddr_t *collect_parent(struct collect_conn *c);
 
 void collect_set_keepalive(struct collect_conn *c, clock_time_t period);
 
+#if COLLECT_AGGREGATION
+void collect_set_aggregation(struct collect_conn *c, clock_time_t hold_time);
+#endif /* COLLECT_AGGREGATION */
+
 void collect_print_stats(void);
 
 #define COLLECT_MAX_DEPTH (COLLECT_LINK_ESTIMATE_UNIT * 64 - 1)
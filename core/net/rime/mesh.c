@@ -59,6 +59,22 @@
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+static int
+queue_slot(struct mesh_conn *c, const rimeaddr_t *dest)
+{
+  int i, free_slot;
+
+  free_slot = 0;
+  for(i = MESH_MAX_QUEUED - 1; i >= 0; i--) {
+    if(c->queued_data[i] == NULL) {
+      free_slot = i;
+    } else if(rimeaddr_cmp(&c->queued_data_dest[i], dest)) {
+      return i;
+    }
+  }
+  return free_slot;
+}
 /*---------------------------------------------------------------------------*/
 static void
 data_packet_received(struct multihop_conn *multihop,
@@ -90,16 +106,21 @@ data_packet_forward(struct multihop_conn *multihop,
   struct route_entry *rt;
   struct mesh_conn *c = (struct mesh_conn *)
     ((char *)multihop - offsetof(struct mesh_conn, multihop));
+  int i;
 
   rt = route_lookup(dest);
   if(rt == NULL) {
-    if(c->queued_data != NULL) {
-      queuebuf_free(c->queued_data);
+    /* Queue the packet in the slot for its destination, or in a free
+       one, while its route is being discovered. Discoveries to
+       different destinations run in parallel. */
+    i = queue_slot(c, dest);
+    if(c->queued_data[i] != NULL) {
+      queuebuf_free(c->queued_data[i]);
     }
 
     PRINTF("data_packet_forward: queueing data, sending rreq\n");
-    c->queued_data = queuebuf_new_from_packetbuf();
-    rimeaddr_copy(&c->queued_data_dest, dest);
+    c->queued_data[i] = queuebuf_new_from_packetbuf();
+    rimeaddr_copy(&c->queued_data_dest[i], dest);
     route_discovery_discover(&c->route_discovery_conn, dest, PACKET_TIMEOUT);
 
     return NULL;
@@ -116,24 +137,27 @@ found_route(struct route_discovery_conn *rdc, const rimeaddr_t *dest)
   struct route_entry *rt;
   struct mesh_conn *c = (struct mesh_conn *)
     ((char *)rdc - offsetof(struct mesh_conn, route_discovery_conn));
+  int i;
 
   PRINTF("found_route\n");
 
-  if(c->queued_data != NULL &&
-     rimeaddr_cmp(dest, &c->queued_data_dest)) {
-    queuebuf_to_packetbuf(c->queued_data);
-    queuebuf_free(c->queued_data);
-    c->queued_data = NULL;
-
-    rt = route_lookup(dest);
-    if(rt != NULL) {
-      multihop_resend(&c->multihop, &rt->nexthop);
-      if(c->cb->sent != NULL) {
-        c->cb->sent(c);
-      }
-    } else {
-      if(c->cb->timedout != NULL) {
-        c->cb->timedout(c);
+  for(i = 0; i < MESH_MAX_QUEUED; i++) {
+    if(c->queued_data[i] != NULL &&
+       rimeaddr_cmp(dest, &c->queued_data_dest[i])) {
+      queuebuf_to_packetbuf(c->queued_data[i]);
+      queuebuf_free(c->queued_data[i]);
+      c->queued_data[i] = NULL;
+
+      rt = route_lookup(dest);
+      if(rt != NULL) {
+        multihop_resend(&c->multihop, &rt->nexthop);
+        if(c->cb->sent != NULL) {
+          c->cb->sent(c);
+        }
+      } else {
+        if(c->cb->timedout != NULL) {
+          c->cb->timedout(c);
+        }
       }
     }
   }
@@ -144,14 +168,19 @@ route_timed_out(struct route_discovery_conn *rdc)
 {
   struct mesh_conn *c = (struct mesh_conn *)
     ((char *)rdc - offsetof(struct mesh_conn, route_discovery_conn));
+  int i;
 
-  if(c->queued_data != NULL) {
-    queuebuf_free(c->queued_data);
-    c->queued_data = NULL;
-  }
+  /* Drop the packets whose route discovery is no longer running. */
+  for(i = 0; i < MESH_MAX_QUEUED; i++) {
+    if(c->queued_data[i] != NULL &&
+       !route_discovery_pending(rdc, &c->queued_data_dest[i])) {
+      queuebuf_free(c->queued_data[i]);
+      c->queued_data[i] = NULL;
 
-  if(c->cb->timedout) {
-    c->cb->timedout(c);
+      if(c->cb->timedout) {
+        c->cb->timedout(c);
+      }
+    }
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -204,7 +233,14 @@ mesh_send(struct mesh_conn *c, const rimeaddr_t *to)
 int
 mesh_ready(struct mesh_conn *c)
 {
-  return (c->queued_data == NULL);
+  int i;
+
+  for(i = 0; i < MESH_MAX_QUEUED; i++) {
+    if(c->queued_data[i] == NULL) {
+      return 1;
+    }
+  }
+  return 0;
 }
 
 
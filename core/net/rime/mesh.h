@@ -79,11 +79,19 @@ struct mesh_callbacks {
   void (* timedout)(struct mesh_conn *c);
 };
 
+/* The number of packets that may wait for a route discovery, each to
+   a different destination. */
+#ifdef MESH_CONF_MAX_QUEUED
+#define MESH_MAX_QUEUED MESH_CONF_MAX_QUEUED
+#else /* MESH_CONF_MAX_QUEUED */
+#define MESH_MAX_QUEUED 2
+#endif /* MESH_CONF_MAX_QUEUED */
+
 struct mesh_conn {
   struct multihop_conn multihop;
   struct route_discovery_conn route_discovery_conn;
-  struct queuebuf *queued_data;
-  rimeaddr_t queued_data_dest;
+  struct queuebuf *queued_data[MESH_MAX_QUEUED];
+  rimeaddr_t queued_data_dest[MESH_MAX_QUEUED];
   const struct mesh_callbacks *cb;
 };
 
@@ -136,7 +144,7 @@ int mesh_send(struct mesh_conn *c, const rimeaddr_t *dest);
 /**
  * \brief      Test if mesh is ready to send a packet (or packet is queued)
  * \param c    The mesh connection on which is to be tested
- * \retval 0   Packet queued
+ * \retval 0   Packets queued for all available destinations
  * \retval !0  Ready
  */
 int mesh_ready(struct mesh_conn *c);
@@ -63,6 +63,123 @@ static const struct packetbuf_attrlist attributes[] =
 #define PRINTF(...)
 #endif
 
+#if MULTIHOP_LATENCY
+/*
+ * The latency trace is placed first in the packet data:
+ *
+ *  +------------------+-----------------------------------+-----+
+ *  | Records (1 byte) | Node (RIMEADDR_SIZE) | Delay (2)  | ... |
+ *  +------------------+-----------------------------------+-----+
+ *
+ * with room for MULTIHOP_LATENCY_HOPS records. The delay is sent
+ * in network byte order. While a node holds the packet, its own
+ * record carries the arrival time instead of the delay.
+ */
+#define TRACE_RECORD_LEN (RIMEADDR_SIZE + 2)
+#define TRACE_LEN (1 + MULTIHOP_LATENCY_HOPS * TRACE_RECORD_LEN)
+
+static struct multihop_latency latency;
+
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+trace_record(uint8_t *trace, int i)
+{
+  return trace + 1 + i * TRACE_RECORD_LEN;
+}
+/*---------------------------------------------------------------------------*/
+static void
+trace_arrive(void)
+{
+  uint8_t *trace = packetbuf_dataptr();
+  uint8_t *r;
+  uint16_t now = RTIMER_NOW();
+
+  if(trace[0] >= MULTIHOP_LATENCY_HOPS) {
+    return;
+  }
+  r = trace_record(trace, trace[0]++);
+  memcpy(r, &rimeaddr_node_addr, RIMEADDR_SIZE);
+  r[RIMEADDR_SIZE] = now >> 8;
+  r[RIMEADDR_SIZE + 1] = now & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static void
+trace_depart(struct multihop_conn *c)
+{
+  uint8_t *trace = packetbuf_dataptr();
+  uint8_t *r;
+  uint16_t now = RTIMER_NOW();
+  uint16_t delay;
+
+  /* Only the record that this node added on arrival is updated. */
+  if(trace[0] == 0) {
+    return;
+  }
+  r = trace_record(trace, trace[0] - 1);
+  if(memcmp(r, &rimeaddr_node_addr, RIMEADDR_SIZE) != 0) {
+    return;
+  }
+  delay = now - ((r[RIMEADDR_SIZE] << 8) | r[RIMEADDR_SIZE + 1]);
+  delay += c->tx_delay;
+  r[RIMEADDR_SIZE] = delay >> 8;
+  r[RIMEADDR_SIZE + 1] = delay & 0xff;
+
+  c->tx_start = now;
+  c->tx_pending = 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+trace_insert(void)
+{
+  uint8_t *data;
+  uint16_t len;
+
+  len = packetbuf_datalen();
+  if(len + TRACE_LEN > PACKETBUF_SIZE) {
+    return 0;
+  }
+  data = packetbuf_dataptr();
+  memmove(data + TRACE_LEN, data, len);
+  data[0] = 0;
+  packetbuf_set_datalen(len + TRACE_LEN);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+trace_remove(void)
+{
+  uint8_t *trace = packetbuf_dataptr();
+  uint8_t *r;
+  int i;
+
+  latency.hops = trace[0];
+  for(i = 0; i < latency.hops; ++i) {
+    r = trace_record(trace, i);
+    memcpy(&latency.hop[i].node, r, RIMEADDR_SIZE);
+    latency.hop[i].delay = (r[RIMEADDR_SIZE] << 8) | r[RIMEADDR_SIZE + 1];
+  }
+  packetbuf_hdrreduce(TRACE_LEN);
+}
+/*---------------------------------------------------------------------------*/
+static void
+data_packet_sent(struct unicast_conn *uc, int status, int num_tx)
+{
+  struct multihop_conn *c = (struct multihop_conn *)uc;
+  uint16_t elapsed;
+
+  /* Keep a running average of the time from handing a packet to the
+     MAC layer until it has been sent, with a weight of 1/8 for each
+     new sample. */
+  if(c->tx_pending) {
+    elapsed = (uint16_t)RTIMER_NOW() - c->tx_start;
+    c->tx_delay = ((uint32_t)c->tx_delay * 7 + elapsed) / 8;
+    c->tx_pending = 0;
+  }
+}
+#else /* MULTIHOP_LATENCY */
+#define trace_arrive()
+#define trace_depart(c)
+#endif /* MULTIHOP_LATENCY */
 /*---------------------------------------------------------------------------*/
 void
 data_packet_received(struct unicast_conn *uc, const rimeaddr_t *from)
@@ -71,6 +188,14 @@ data_packet_received(struct unicast_conn *uc, const rimeaddr_t *from)
   rimeaddr_t *nexthop;
   rimeaddr_t sender, receiver;
 
+#if MULTIHOP_LATENCY
+  if(packetbuf_datalen() < TRACE_LEN ||
+     *(uint8_t *)packetbuf_dataptr() > MULTIHOP_LATENCY_HOPS) {
+    PRINTF("data_packet_received: no latency trace\n");
+    return;
+  }
+#endif /* MULTIHOP_LATENCY */
+
   /* Copy the packet attributes to avoid them being overwritten or
      cleared by an application program that uses the packet buffer for
      its own needs. */
@@ -86,12 +211,16 @@ data_packet_received(struct unicast_conn *uc, const rimeaddr_t *from)
   if(rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_ERECEIVER),
 				 &rimeaddr_node_addr)) {
     PRINTF("for us!\n");
+#if MULTIHOP_LATENCY
+    trace_remove();
+#endif /* MULTIHOP_LATENCY */
     if(c->cb->recv) {
       c->cb->recv(c, &sender, from,
 		  packetbuf_attr(PACKETBUF_ATTR_HOPS));
     }
   } else {
     nexthop = NULL;
+    trace_arrive();
     if(c->cb->forward) {
       packetbuf_set_attr(PACKETBUF_ATTR_HOPS,
 			 packetbuf_attr(PACKETBUF_ATTR_HOPS) + 1);
@@ -100,12 +229,18 @@ data_packet_received(struct unicast_conn *uc, const rimeaddr_t *from)
     }
     if(nexthop) {
       PRINTF("forwarding to %d.%d\n", nexthop->u8[0], nexthop->u8[1]);
+      trace_depart(c);
       unicast_send(&c->c, nexthop);
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+#if MULTIHOP_LATENCY
+static const struct unicast_callbacks data_callbacks = { data_packet_received,
+                                                         data_packet_sent };
+#else /* MULTIHOP_LATENCY */
 static const struct unicast_callbacks data_callbacks = { data_packet_received };
+#endif /* MULTIHOP_LATENCY */
 /*---------------------------------------------------------------------------*/
 void
 multihop_open(struct multihop_conn *c, uint16_t channel,
@@ -114,6 +249,10 @@ multihop_open(struct multihop_conn *c, uint16_t channel,
   unicast_open(&c->c, channel, &data_callbacks);
   channel_set_attributes(channel, attributes);
   c->cb = callbacks;
+#if MULTIHOP_LATENCY
+  c->tx_delay = 0;
+  c->tx_pending = 0;
+#endif /* MULTIHOP_LATENCY */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -131,6 +270,13 @@ multihop_send(struct multihop_conn *c, const rimeaddr_t *to)
     return 0;
   }
   packetbuf_compact();
+#if MULTIHOP_LATENCY
+  if(!trace_insert()) {
+    PRINTF("multihop_send: no room for the latency trace\n");
+    return 0;
+  }
+  trace_arrive();
+#endif /* MULTIHOP_LATENCY */
   packetbuf_set_addr(PACKETBUF_ADDR_ERECEIVER, to);
   packetbuf_set_addr(PACKETBUF_ADDR_ESENDER, &rimeaddr_node_addr);
   packetbuf_set_attr(PACKETBUF_ATTR_HOPS, 1);
@@ -142,6 +288,7 @@ multihop_send(struct multihop_conn *c, const rimeaddr_t *to)
   } else {
     PRINTF("multihop_send: sending data towards %d.%d\n",
 	   nexthop->u8[0], nexthop->u8[1]);
+    trace_depart(c);
     unicast_send(&c->c, nexthop);
     return 1;
   }
@@ -150,7 +297,18 @@ multihop_send(struct multihop_conn *c, const rimeaddr_t *to)
 void
 multihop_resend(struct multihop_conn *c, const rimeaddr_t *nexthop)
 {
+  trace_depart(c);
   unicast_send(&c->c, nexthop);
 }
 /*---------------------------------------------------------------------------*/
+const struct multihop_latency *
+multihop_last_latency(void)
+{
+#if MULTIHOP_LATENCY
+  return &latency;
+#else /* MULTIHOP_LATENCY */
+  return NULL;
+#endif /* MULTIHOP_LATENCY */
+}
+/*---------------------------------------------------------------------------*/
 /** @} */
@@ -22,6 +22,16 @@
  * process.
  *
  *
+ * When MULTIHOP_CONF_LATENCY is set, every packet carries a latency
+ * trace in front of the application data. Each node that sends or
+ * forwards the packet adds a record with its address and the delay,
+ * in 16-bit rtimer ticks, between the packet arriving at the node
+ * and it being handed to the MAC layer, plus the node's running
+ * average of the time the MAC layer takes to transmit a packet. The
+ * receiver obtains the trace with multihop_last_latency() from within
+ * its recv callback. All nodes in the network must use the same
+ * setting.
+ *
  * \section channels Channels
  *
  * The multihop module uses 1 channel.
@@ -73,6 +83,19 @@
 #include "net/rime/unicast.h"
 #include "net/rime/rimeaddr.h"
 
+#ifdef MULTIHOP_CONF_LATENCY
+#define MULTIHOP_LATENCY MULTIHOP_CONF_LATENCY
+#else /* MULTIHOP_CONF_LATENCY */
+#define MULTIHOP_LATENCY 0
+#endif /* MULTIHOP_CONF_LATENCY */
+
+/* The number of hops recorded in the latency trace. */
+#ifdef MULTIHOP_CONF_LATENCY_HOPS
+#define MULTIHOP_LATENCY_HOPS MULTIHOP_CONF_LATENCY_HOPS
+#else /* MULTIHOP_CONF_LATENCY_HOPS */
+#define MULTIHOP_LATENCY_HOPS 4
+#endif /* MULTIHOP_CONF_LATENCY_HOPS */
+
 struct multihop_conn;
 
 #define MULTIHOP_ATTRIBUTES   { PACKETBUF_ADDR_ESENDER, PACKETBUF_ADDRSIZE }, \
@@ -97,6 +120,21 @@ struct multihop_callbacks {
 struct multihop_conn {
   struct unicast_conn c;
   const struct multihop_callbacks *cb;
+#if MULTIHOP_LATENCY
+  uint16_t tx_delay;
+  uint16_t tx_start;
+  uint8_t tx_pending;
+#endif /* MULTIHOP_LATENCY */
+};
+
+struct multihop_hop_latency {
+  rimeaddr_t node;
+  uint16_t delay;
+};
+
+struct multihop_latency {
+  uint8_t hops;
+  struct multihop_hop_latency hop[MULTIHOP_LATENCY_HOPS];
 };
 
 void multihop_open(struct multihop_conn *c, uint16_t channel,
@@ -105,6 +143,18 @@ void multihop_close(struct multihop_conn *c);
 int multihop_send(struct multihop_conn *c, const rimeaddr_t *to);
 void multihop_resend(struct multihop_conn *c, const rimeaddr_t *nexthop);
 
+/**
+ * \brief      Get the latency trace of the packet being received
+ * \return     The per-hop delays of the packet, or NULL if
+ *             MULTIHOP_CONF_LATENCY is not set
+ *
+ *             This function may only be called from the recv
+ *             callback. The trace holds one record for each of the
+ *             first MULTIHOP_LATENCY_HOPS nodes that sent the packet,
+ *             starting with the originator.
+ */
+const struct multihop_latency *multihop_last_latency(void);
+
 #endif /* __MULTIHOP_H__ */
 /** @} */
 /** @} */
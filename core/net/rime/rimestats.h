@@ -50,7 +50,8 @@ struct rimestats {
   unsigned long toolong, tooshort, badsynch, badcrc;
 
   unsigned long contentiondrop, /* Packet dropped due to contention */
-    sendingdrop; /* Packet dropped when we were sending a packet */
+    sendingdrop, /* Packet dropped when we were sending a packet */
+    foreigndrop; /* Packet not for us dropped by the RDC */
 
   unsigned long lltx, llrx;
 };
@@ -43,6 +43,8 @@
  */
 
 #include "contiki.h"
+#include "lib/list.h"
+#include "lib/memb.h"
 #include "net/rime.h"
 #include "net/rime/route.h"
 #include "net/rime/route-discovery.h"
@@ -77,7 +79,37 @@ struct rrep_hdr {
 #endif
 
 /*---------------------------------------------------------------------------*/
-static char rrep_pending;		/* A reply for a request is pending. */
+/* An outstanding route request, waiting for its reply. */
+struct pending {
+  struct pending *next;
+  struct route_discovery_conn *c;
+  struct ctimer t;
+  rimeaddr_t dest;
+};
+
+LIST(pending_list);
+MEMB(pending_mem, struct pending, ROUTE_DISCOVERY_ENTRIES);
+/*---------------------------------------------------------------------------*/
+static struct pending *
+find_pending(struct route_discovery_conn *c, const rimeaddr_t *dest)
+{
+  struct pending *p;
+
+  for(p = list_head(pending_list); p != NULL; p = list_item_next(p)) {
+    if(p->c == c && rimeaddr_cmp(&p->dest, dest)) {
+      return p;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+free_pending(struct pending *p)
+{
+  ctimer_stop(&p->t);
+  list_remove(pending_list, p);
+  memb_free(&pending_mem, p);
+}
 /*---------------------------------------------------------------------------*/
 static void
 send_rreq(struct route_discovery_conn *c, const rimeaddr_t *dest)
@@ -183,9 +215,13 @@ rrep_packet_received(struct unicast_conn *uc, const rimeaddr_t *from)
   insert_route(&msg->originator, from, msg->hops);
 
   if(rimeaddr_cmp(&msg->dest, &rimeaddr_node_addr)) {
+    struct pending *p;
+
     PRINTF("rrep for us!\n");
-    rrep_pending = 0;
-    ctimer_stop(&c->t);
+    p = find_pending(c, &msg->originator);
+    if(p != NULL) {
+      free_pending(p);
+    }
     if(c->cb->new_route) {
       rimeaddr_t originator;
 
@@ -284,17 +320,26 @@ route_discovery_open(struct route_discovery_conn *c,
 void
 route_discovery_close(struct route_discovery_conn *c)
 {
+  struct pending *p, *next;
+
   unicast_close(&c->rrepconn);
   netflood_close(&c->rreqconn);
-  ctimer_stop(&c->t);
+  for(p = list_head(pending_list); p != NULL; p = next) {
+    next = list_item_next(p);
+    if(p->c == c) {
+      free_pending(p);
+    }
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
 timeout_handler(void *ptr)
 {
-  struct route_discovery_conn *c = ptr;
+  struct pending *p = ptr;
+  struct route_discovery_conn *c = p->c;
+
   PRINTF("route_discovery: timeout, timed out\n");
-  rrep_pending = 0;
+  free_pending(p);
   if(c->cb->timedout) {
     c->cb->timedout(c);
   }
@@ -304,16 +349,32 @@ int
 route_discovery_discover(struct route_discovery_conn *c, const rimeaddr_t *addr,
 			 clock_time_t timeout)
 {
-  if(rrep_pending) {
+  struct pending *p;
+
+  if(find_pending(c, addr) != NULL) {
     PRINTF("route_discovery_send: ignoring request because of pending response\n");
     return 0;
   }
 
+  p = memb_alloc(&pending_mem);
+  if(p == NULL) {
+    PRINTF("route_discovery_send: too many pending requests\n");
+    return 0;
+  }
+  p->c = c;
+  rimeaddr_copy(&p->dest, addr);
+  list_add(pending_list, p);
+
   PRINTF("route_discovery_send: sending route request\n");
-  ctimer_set(&c->t, timeout, timeout_handler, c);
-  rrep_pending = 1;
+  ctimer_set(&p->t, timeout, timeout_handler, p);
   send_rreq(c, addr);
   return 1;
 }
 /*---------------------------------------------------------------------------*/
+int
+route_discovery_pending(struct route_discovery_conn *c, const rimeaddr_t *dest)
+{
+  return find_pending(c, dest) != NULL;
+}
+/*---------------------------------------------------------------------------*/
 /** @} */
@@ -68,12 +68,17 @@ struct route_discovery_callbacks {
   void (* timedout)(struct route_discovery_conn *c);
 };
 
+/* The number of route discoveries that may be outstanding at the
+   same time, shared by all connections. */
+#ifdef ROUTE_DISCOVERY_CONF_ENTRIES
+#define ROUTE_DISCOVERY_ENTRIES ROUTE_DISCOVERY_CONF_ENTRIES
+#else /* ROUTE_DISCOVERY_CONF_ENTRIES */
 #define ROUTE_DISCOVERY_ENTRIES 8
+#endif /* ROUTE_DISCOVERY_CONF_ENTRIES */
 
 struct route_discovery_conn {
   struct netflood_conn rreqconn;
   struct unicast_conn rrepconn;
-  struct ctimer t;
   rimeaddr_t last_rreq_originator;
   uint16_t last_rreq_id;
   uint16_t rreq_id;
@@ -85,6 +90,8 @@ void route_discovery_open(struct route_discovery_conn *c, clock_time_t time,
 			  const struct route_discovery_callbacks *callbacks);
 int route_discovery_discover(struct route_discovery_conn *c, const rimeaddr_t *dest,
 			     clock_time_t timeout);
+int route_discovery_pending(struct route_discovery_conn *c,
+                            const rimeaddr_t *dest);
 
 void route_discovery_close(struct route_discovery_conn *c);
 
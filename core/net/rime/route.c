@@ -43,9 +43,11 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "sys/clock.h"
 #include "sys/ctimer.h"
 #include "net/rime/route.h"
 #include "contiki-conf.h"
@@ -68,12 +70,32 @@
 #define DEFAULT_LIFETIME 60
 #endif /* ROUTE_CONF_DEFAULT_LIFETIME */
 
+#ifdef ROUTE_CONF_HASH_SIZE
+#define ROUTE_HASH_SIZE ROUTE_CONF_HASH_SIZE
+#else /* ROUTE_CONF_HASH_SIZE */
+#define ROUTE_HASH_SIZE 8
+#endif /* ROUTE_CONF_HASH_SIZE */
+
+/* The longest time the expiry timer sleeps, to keep clock_time_t
+   from overflowing with long lifetimes. */
+#define MAX_SLEEP 60
+
 /*
  * List of route entries.
  */
 LIST(route_table);
 MEMB(route_mem, struct route_entry, NUM_RT_ENTRIES);
 
+/*
+ * The entries hashed on their destination, and a binary heap with
+ * the least recently refreshed entry on top.
+ */
+static struct route_entry *route_hash[ROUTE_HASH_SIZE];
+static struct route_entry *heap[NUM_RT_ENTRIES];
+static uint8_t heap_len;
+
+#define HASH(a) (((a)->u8[0] + (a)->u8[RIMEADDR_SIZE - 1]) % ROUTE_HASH_SIZE)
+
 static struct ctimer t;
 
 static int max_time = DEFAULT_LIFETIME;
@@ -86,26 +108,110 @@ static int max_time = DEFAULT_LIFETIME;
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+static uint16_t
+age(const struct route_entry *e)
+{
+  return (uint16_t)clock_seconds() - e->refreshed;
+}
+/*---------------------------------------------------------------------------*/
+static int
+older(const struct route_entry *a, const struct route_entry *b)
+{
+  return (int16_t)(a->refreshed - b->refreshed) < 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_set(uint8_t i, struct route_entry *e)
+{
+  heap[i] = e;
+  e->heap_index = i;
+}
+/*---------------------------------------------------------------------------*/
+static void
+sift_up(uint8_t i)
+{
+  struct route_entry *e = heap[i];
+
+  while(i > 0 && older(e, heap[(i - 1) / 2])) {
+    heap_set(i, heap[(i - 1) / 2]);
+    i = (i - 1) / 2;
+  }
+  heap_set(i, e);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sift_down(uint8_t i)
+{
+  struct route_entry *e = heap[i];
+  uint8_t child;
+
+  while((child = 2 * i + 1) < heap_len) {
+    if(child + 1 < heap_len && older(heap[child + 1], heap[child])) {
+      child++;
+    }
+    if(!older(heap[child], e)) {
+      break;
+    }
+    heap_set(i, heap[child]);
+    i = child;
+  }
+  heap_set(i, e);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(struct route_entry *e)
+{
+  uint8_t i = e->heap_index;
 
+  heap_len--;
+  if(i < heap_len) {
+    e = heap[heap_len];
+    heap_set(i, e);
+    sift_up(i);
+    sift_down(e->heap_index);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+unlink_entry(struct route_entry *e)
+{
+  struct route_entry **p;
+
+  for(p = &route_hash[HASH(&e->dest)]; *p != NULL; p = &(*p)->hnext) {
+    if(*p == e) {
+      *p = e->hnext;
+      break;
+    }
+  }
+  heap_remove(e);
+  list_remove(route_table, e);
+}
 /*---------------------------------------------------------------------------*/
 static void
 periodic(void *ptr)
 {
   struct route_entry *e;
+  uint16_t remaining;
 
-  for(e = list_head(route_table); e != NULL; e = list_item_next(e)) {
-    e->time++;
-    if(e->time >= max_time) {
-      PRINTF("route periodic: removing entry to %d.%d with nexthop %d.%d and cost %d\n",
-	     e->dest.u8[0], e->dest.u8[1],
-	     e->nexthop.u8[0], e->nexthop.u8[1],
-	     e->cost);
-      list_remove(route_table, e);
-      memb_free(&route_mem, e);
-    }
+  /* Only the top of the heap needs to be looked at: the entries
+     below it have been refreshed more recently. */
+  while(heap_len > 0 && age(heap[0]) >= max_time) {
+    e = heap[0];
+    PRINTF("route periodic: removing entry to %d.%d with nexthop %d.%d and cost %d\n",
+	   e->dest.u8[0], e->dest.u8[1],
+	   e->nexthop.u8[0], e->nexthop.u8[1],
+	   e->cost);
+    route_remove(e);
   }
 
-  ctimer_set(&t, CLOCK_SECOND, periodic, NULL);
+  if(heap_len > 0) {
+    remaining = max_time - age(heap[0]);
+    if(remaining > MAX_SLEEP) {
+      remaining = MAX_SLEEP;
+    }
+    ctimer_set(&t, remaining * CLOCK_SECOND, periodic, NULL);
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -113,8 +219,10 @@ route_init(void)
 {
   list_init(route_table);
   memb_init(&route_mem);
+  memset(route_hash, 0, sizeof(route_hash));
+  heap_len = 0;
 
-  ctimer_set(&t, CLOCK_SECOND, periodic, NULL);
+  ctimer_stop(&t);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -126,17 +234,21 @@ route_add(const rimeaddr_t *dest, const rimeaddr_t *nexthop,
   /* Avoid inserting duplicate entries. */
   e = route_lookup(dest);
   if(e != NULL && rimeaddr_cmp(&e->nexthop, nexthop)) {
-    list_remove(route_table, e);
+    unlink_entry(e);
   } else {
-    /* Allocate a new entry or reuse the oldest entry with highest cost. */
+    /* Allocate a new entry or reuse the least recently refreshed
+       entry. */
     e = memb_alloc(&route_mem);
     if(e == NULL) {
-      /* Remove oldest entry.  XXX */
-      e = list_chop(route_table);
+      if(heap_len == 0) {
+        return -1;
+      }
+      e = heap[0];
       PRINTF("route_add: removing entry to %d.%d with nexthop %d.%d and cost %d\n",
 	     e->dest.u8[0], e->dest.u8[1],
 	     e->nexthop.u8[0], e->nexthop.u8[1],
 	     e->cost);
+      unlink_entry(e);
     }
   }
 
@@ -144,11 +256,21 @@ route_add(const rimeaddr_t *dest, const rimeaddr_t *nexthop,
   rimeaddr_copy(&e->nexthop, nexthop);
   e->cost = cost;
   e->seqno = seqno;
-  e->time = 0;
+  e->refreshed = (uint16_t)clock_seconds();
   e->decay = 0;
+  e->uses = 0;
 
   /* New entry goes first. */
   list_push(route_table, e);
+  e->hnext = route_hash[HASH(dest)];
+  route_hash[HASH(dest)] = e;
+  heap_set(heap_len, e);
+  heap_len++;
+  sift_up(e->heap_index);
+
+  if(ctimer_expired(&t)) {
+    ctimer_set(&t, CLOCK_SECOND, periodic, NULL);
+  }
 
   PRINTF("route_add: new entry to %d.%d with nexthop %d.%d and cost %d\n",
 	 e->dest.u8[0], e->dest.u8[1],
@@ -169,10 +291,7 @@ route_lookup(const rimeaddr_t *dest)
   best_entry = NULL;
   
   /* Find the route with the lowest cost. */
-  for(e = list_head(route_table); e != NULL; e = list_item_next(e)) {
-    /*    printf("route_lookup: comparing %d.%d.%d.%d with %d.%d.%d.%d\n",
-	   uip_ipaddr_to_quad(dest), uip_ipaddr_to_quad(&e->dest));*/
-
+  for(e = route_hash[HASH(dest)]; e != NULL; e = e->hnext) {
     if(rimeaddr_cmp(dest, &e->dest)) {
       if(e->cost < lowest_cost) {
 	best_entry = e;
@@ -189,11 +308,15 @@ route_refresh(struct route_entry *e)
   if(e != NULL) {
     /* Refresh age of route so that used routes do not get thrown
        out. */
-    e->time = 0;
+    e->refreshed = (uint16_t)clock_seconds();
     e->decay = 0;
+    if(e->uses < 0xffff) {
+      e->uses++;
+    }
+    sift_down(e->heap_index);
     
-    PRINTF("route_refresh: time %d last %d decay %d for entry to %d.%d with nexthop %d.%d and cost %d\n",
-           e->time, e->time_last_decay, e->decay,
+    PRINTF("route_refresh: last %d decay %d uses %u for entry to %d.%d with nexthop %d.%d and cost %d\n",
+           e->time_last_decay, e->decay, e->uses,
            e->dest.u8[0], e->dest.u8[1],
            e->nexthop.u8[0], e->nexthop.u8[1],
            e->cost);
@@ -204,18 +327,21 @@ route_refresh(struct route_entry *e)
 void
 route_decay(struct route_entry *e)
 {
+  uint8_t now;
+
   /* If routes are not refreshed, they decay over time. This function
      is called to decay a route. The route can only be decayed once
      per second. */
-  PRINTF("route_decay: time %d last %d decay %d for entry to %d.%d with nexthop %d.%d and cost %d\n",
-	 e->time, e->time_last_decay, e->decay,
+  PRINTF("route_decay: age %d last %d decay %d for entry to %d.%d with nexthop %d.%d and cost %d\n",
+	 age(e), e->time_last_decay, e->decay,
 	 e->dest.u8[0], e->dest.u8[1],
 	 e->nexthop.u8[0], e->nexthop.u8[1],
 	 e->cost);
   
-  if(e->time != e->time_last_decay) {
+  now = (uint8_t)clock_seconds();
+  if(now != e->time_last_decay) {
     /* Do not decay a route too often - not more than once per second. */
-    e->time_last_decay = e->time;
+    e->time_last_decay = now;
     e->decay++;
 
     if(e->decay >= DECAY_THRESHOLD) {
@@ -231,22 +357,15 @@ route_decay(struct route_entry *e)
 void
 route_remove(struct route_entry *e)
 {
-  list_remove(route_table, e);
+  unlink_entry(e);
   memb_free(&route_mem, e);
 }
 /*---------------------------------------------------------------------------*/
 void
 route_flush_all(void)
 {
-  struct route_entry *e;
-
-  while(1) {
-    e = list_pop(route_table);
-    if(e != NULL) {
-      memb_free(&route_mem, e);
-    } else {
-      break;
-    }
+  while(heap_len > 0) {
+    route_remove(heap[0]);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -254,18 +373,15 @@ void
 route_set_lifetime(int seconds)
 {
   max_time = seconds;
+  if(heap_len > 0) {
+    ctimer_set(&t, CLOCK_SECOND, periodic, NULL);
+  }
 }
 /*---------------------------------------------------------------------------*/
 int
 route_num(void)
 {
-  struct route_entry *e;
-  int i = 0;
-
-  for(e = list_head(route_table); e != NULL; e = list_item_next(e)) {
-    i++;
-  }
-  return i;
+  return heap_len;
 }
 /*---------------------------------------------------------------------------*/
 struct route_entry *
@@ -55,14 +55,17 @@
 
 struct route_entry {
   struct route_entry *next;
+  struct route_entry *hnext;
   rimeaddr_t dest;
   rimeaddr_t nexthop;
   uint8_t seqno;
   uint8_t cost;
-  uint8_t time;
+  uint16_t refreshed;
+  uint16_t uses;
 
   uint8_t decay;
   uint8_t time_last_decay;
+  uint8_t heap_index;
 };
 
 void route_init(void);
@@ -50,11 +50,13 @@
 
 #include <stdio.h>
 #include <stddef.h> /* for offsetof */
+#include <string.h>
 
 #include "net/rime.h"
 #include "net/rime/polite.h"
 #include "net/rime/rudolph2.h"
 #include "cfs/cfs.h"
+#include "lib/random.h"
 
 #define SEND_INTERVAL CLOCK_SECOND / 2
 #define STEADY_INTERVAL CLOCK_SECOND * 16
@@ -66,6 +68,11 @@ struct rudolph2_hdr {
   uint8_t hops_from_base;
   uint16_t version;
   uint16_t chunk;
+#if RUDOLPH2_CODED
+  uint8_t coeffs;
+  uint8_t gensize;
+  uint8_t lastlen;
+#endif /* RUDOLPH2_CODED */
 };
 
 #define POLITE_HEADER 1
@@ -91,6 +98,26 @@ enum {
 
 #define LT(a, b) ((signed short)((a) - (b)) < 0)
 
+#if RUDOLPH2_CODED
+#if RUDOLPH2_GENERATION_SIZE < 1 || RUDOLPH2_GENERATION_SIZE > 8
+#error "RUDOLPH2_GENERATION_SIZE must be between 1 and 8"
+#endif
+
+/* The number of extra coded packets sent for a generation before
+   moving on to the next one. */
+#define CODED_REDUNDANCY 2
+
+/* In coded mode, the chunk field of the header and snd_nxt hold a
+   generation number. We can send the generations that we have
+   received completely. */
+#define SENDABLE(c) (((c)->rcv_nxt + RUDOLPH2_GENERATION_SIZE - 1) / \
+                     RUDOLPH2_GENERATION_SIZE)
+#define RCV_NXT(c)  ((c)->rcv_nxt / RUDOLPH2_GENERATION_SIZE)
+#else /* RUDOLPH2_CODED */
+#define SENDABLE(c) ((c)->rcv_nxt)
+#define RCV_NXT(c)  ((c)->rcv_nxt)
+#endif /* RUDOLPH2_CODED */
+
 /*---------------------------------------------------------------------------*/
 static int
 read_data(struct rudolph2_conn *c, uint8_t *dataptr, int chunk)
@@ -104,6 +131,118 @@ read_data(struct rudolph2_conn *c, uint8_t *dataptr, int chunk)
   return len;
 }
 /*---------------------------------------------------------------------------*/
+#if RUDOLPH2_CODED
+static void
+xor_data(uint8_t *to, const uint8_t *from)
+{
+  int i;
+
+  for(i = 0; i < RUDOLPH2_DATASIZE; i++) {
+    to[i] ^= from[i];
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_decoder(struct rudolph2_conn *c)
+{
+  memset(c->coeffs, 0, sizeof(c->coeffs));
+  c->rank = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+format_data(struct rudolph2_conn *c, int generation)
+{
+  struct rudolph2_hdr *hdr;
+  uint8_t chunk[RUDOLPH2_DATASIZE];
+  uint8_t *dataptr;
+  int first, gensize, i, len;
+
+  packetbuf_clear();
+  hdr = packetbuf_dataptr();
+  hdr->type = TYPE_DATA;
+  hdr->hops_from_base = c->hops_from_base;
+  hdr->version = c->version;
+  hdr->chunk = generation;
+
+  first = generation * RUDOLPH2_GENERATION_SIZE;
+  gensize = c->rcv_nxt - first;
+  if(gensize > RUDOLPH2_GENERATION_SIZE) {
+    gensize = RUDOLPH2_GENERATION_SIZE;
+  }
+  hdr->gensize = gensize;
+  do {
+    hdr->coeffs = random_rand() & ((1 << gensize) - 1);
+  } while(hdr->coeffs == 0);
+
+  dataptr = (uint8_t *)hdr + sizeof(struct rudolph2_hdr);
+  memset(dataptr, 0, RUDOLPH2_DATASIZE);
+  len = RUDOLPH2_DATASIZE;
+  for(i = 0; i < gensize; i++) {
+    /* The last chunk is always read, since its length tells the
+       receiver whether this is the final generation. */
+    if((hdr->coeffs & (1 << i)) || i == gensize - 1) {
+      memset(chunk, 0, sizeof(chunk));
+      len = read_data(c, chunk, first + i);
+      if(hdr->coeffs & (1 << i)) {
+	xor_data(dataptr, chunk);
+      }
+    }
+  }
+  hdr->lastlen = len;
+  packetbuf_set_datalen(sizeof(struct rudolph2_hdr) + RUDOLPH2_DATASIZE);
+
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/* Add a coded packet to the current generation by Gaussian elimination
+   over GF(2). Row i of the decoder, if present, has its lowest set
+   coefficient at bit i. Returns non-zero when the generation has been
+   decoded. */
+static int
+decode_data(struct rudolph2_conn *c, struct rudolph2_hdr *hdr,
+	    const uint8_t *data)
+{
+  uint8_t row[RUDOLPH2_DATASIZE];
+  uint8_t coeffs;
+  int i, j, gensize;
+
+  gensize = hdr->gensize;
+  if(gensize == 0 || gensize > RUDOLPH2_GENERATION_SIZE) {
+    return 0;
+  }
+
+  coeffs = hdr->coeffs & ((1 << gensize) - 1);
+  memcpy(row, data, RUDOLPH2_DATASIZE);
+  for(i = 0; i < gensize; i++) {
+    if((coeffs & (1 << i)) && c->coeffs[i] != 0) {
+      coeffs ^= c->coeffs[i];
+      xor_data(row, c->rows[i]);
+    }
+  }
+  if(coeffs == 0) {
+    /* Not innovative. */
+    return 0;
+  }
+
+  for(i = 0; !(coeffs & (1 << i)); i++);
+  c->coeffs[i] = coeffs;
+  memcpy(c->rows[i], row, RUDOLPH2_DATASIZE);
+  if(++c->rank < gensize) {
+    return 0;
+  }
+
+  /* Back-substitute so that row i holds chunk i. */
+  for(i = gensize - 1; i >= 0; i--) {
+    for(j = i + 1; j < gensize; j++) {
+      if(c->coeffs[i] & (1 << j)) {
+	xor_data(c->rows[i], c->rows[j]);
+      }
+    }
+    c->coeffs[i] = 1 << i;
+  }
+  return 1;
+}
+#else /* RUDOLPH2_CODED */
 static int
 format_data(struct rudolph2_conn *c, int chunk)
 {
@@ -121,6 +260,7 @@ format_data(struct rudolph2_conn *c, int chunk)
 
   return len;
 }
+#endif /* RUDOLPH2_CODED */
 /*---------------------------------------------------------------------------*/
 static void
 write_data(struct rudolph2_conn *c, int chunk, uint8_t *data, int datalen)
@@ -176,7 +316,7 @@ send_nack(struct rudolph2_conn *c)
   hdr->hops_from_base = c->hops_from_base;
   hdr->type = TYPE_NACK;
   hdr->version = c->version;
-  hdr->chunk = c->rcv_nxt;
+  hdr->chunk = RCV_NXT(c);
 
   PRINTF("%d.%d: Sending nack for %d\n",
 	 rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
@@ -275,16 +415,60 @@ timed_send(void *ptr)
       c->flags &= ~FLAG_LAST_SENT;
     }
     
+#if RUDOLPH2_CODED
+    if(c->nacks == 0 &&
+       len == RUDOLPH2_DATASIZE &&
+       c->snd_nxt + 1 < SENDABLE(c) &&
+       ++c->coded_sent >= RUDOLPH2_GENERATION_SIZE + CODED_REDUNDANCY) {
+      c->snd_nxt++;
+      c->coded_sent = 0;
+    }
+#else /* RUDOLPH2_CODED */
     if(c->nacks == 0 &&
        len == RUDOLPH2_DATASIZE &&
      c->snd_nxt + 1 < c->rcv_nxt) {
       c->snd_nxt++;
     }
+#endif /* RUDOLPH2_CODED */
     c->nacks = 0;
     ctimer_set(&c->t, interval, timed_send, c);
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RUDOLPH2_CODED
+static void
+recv_coded(struct rudolph2_conn *c, struct rudolph2_hdr *hdr)
+{
+  struct rudolph2_hdr h;
+  int i, len;
+
+  /* The header is copied since write_chunk() may use the packetbuf. */
+  memcpy(&h, hdr, sizeof(h));
+  packetbuf_hdrreduce(sizeof(struct rudolph2_hdr));
+  if(packetbuf_totlen() < RUDOLPH2_DATASIZE ||
+     !decode_data(c, &h, packetbuf_dataptr())) {
+    return;
+  }
+
+  PRINTF("%d.%d: decoded generation %d\n",
+	 rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+	 h.chunk);
+  for(i = 0; i < h.gensize; i++) {
+    len = i == h.gensize - 1 ? h.lastlen : RUDOLPH2_DATASIZE;
+    write_data(c, c->rcv_nxt + i, c->rows[i], len);
+  }
+  c->rcv_nxt += h.gensize;
+  reset_decoder(c);
+  if(h.lastlen < RUDOLPH2_DATASIZE) {
+    c->flags |= FLAG_LAST_RECEIVED;
+    c->snd_nxt = 0;
+    c->coded_sent = 0;
+    send_data(c, RESEND_INTERVAL);
+    ctimer_set(&c->t, RESEND_INTERVAL, timed_send, c);
+  }
+}
+#endif /* RUDOLPH2_CODED */
+/*---------------------------------------------------------------------------*/
 static void
 recv(struct polite_conn *polite)
 {
@@ -301,12 +485,18 @@ recv(struct polite_conn *polite)
 	   hdr->version, hdr->chunk,
 	   c->version, c->rcv_nxt);
     if(hdr->version == c->version) {
-      if(hdr->chunk < c->rcv_nxt) {
+      if(hdr->chunk < SENDABLE(c)) {
 	c->snd_nxt = hdr->chunk;
+#if RUDOLPH2_CODED
+	c->coded_sent = 0;
+#endif /* RUDOLPH2_CODED */
 	send_data(c, SEND_INTERVAL);
       }
     } else if(LT(hdr->version, c->version)) {
       c->snd_nxt = 0;
+#if RUDOLPH2_CODED
+      c->coded_sent = 0;
+#endif /* RUDOLPH2_CODED */
       send_data(c, SEND_INTERVAL);
     }
   } else if(hdr->type == TYPE_DATA) {
@@ -322,12 +512,30 @@ recv(struct polite_conn *polite)
 	c->snd_nxt = c->rcv_nxt = 0;
 	c->flags &= ~FLAG_LAST_RECEIVED;
 	c->flags &= ~FLAG_LAST_SENT;
+#if RUDOLPH2_CODED
+	reset_decoder(c);
+	if(hdr->chunk != 0) {
+	  send_nack(c);
+	} else {
+	  recv_coded(c, hdr);
+	}
+#else /* RUDOLPH2_CODED */
 	if(hdr->chunk != 0) {
 	  send_nack(c);
 	} else {
 	  packetbuf_hdrreduce(sizeof(struct rudolph2_hdr));
 	  write_data(c, 0, packetbuf_dataptr(), packetbuf_totlen());
 	}
+#endif /* RUDOLPH2_CODED */
+#if RUDOLPH2_CODED
+      } else if(hdr->version == c->version &&
+		(c->flags & FLAG_LAST_RECEIVED) == 0) {
+	if(hdr->chunk == RCV_NXT(c)) {
+	  recv_coded(c, hdr);
+	} else if(hdr->chunk > RCV_NXT(c)) {
+	  send_nack(c);
+	}
+#else /* RUDOLPH2_CODED */
       } else if(hdr->version == c->version) {
 	PRINTF("%d.%d: got chunk %d snd_nxt %d rcv_nxt %d\n",
 	       rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
@@ -355,6 +563,7 @@ recv(struct polite_conn *polite)
 	} else if(hdr->chunk < c->rcv_nxt) {
 	  /* Ignore packets with a lower chunk number */
 	}
+#endif /* RUDOLPH2_CODED */
       }
     }
   }
@@ -370,6 +579,10 @@ rudolph2_open(struct rudolph2_conn *c, uint16_t channel,
   c->cb = cb;
   c->version = 0;
   c->hops_from_base = HOPS_MAX;
+#if RUDOLPH2_CODED
+  reset_decoder(c);
+  c->coded_sent = 0;
+#endif /* RUDOLPH2_CODED */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -386,6 +599,9 @@ rudolph2_send(struct rudolph2_conn *c, clock_time_t send_interval)
   c->hops_from_base = 0;
   c->version++;
   c->snd_nxt = 0;
+#if RUDOLPH2_CODED
+  c->coded_sent = 0;
+#endif /* RUDOLPH2_CODED */
   len = RUDOLPH2_DATASIZE;
   packetbuf_clear();
   for(c->rcv_nxt = 0; len == RUDOLPH2_DATASIZE; c->rcv_nxt++) {
@@ -79,6 +79,24 @@ struct rudolph2_callbacks {
 
 #define RUDOLPH2_DATASIZE 64
 
+/* In coded mode, the data is sent in generations of
+   RUDOLPH2_GENERATION_SIZE chunks. Each data packet is a random XOR
+   combination of the chunks of a generation, so a receiver needs any
+   RUDOLPH2_GENERATION_SIZE linearly independent packets rather than
+   specific chunks, and NACKs only name a generation. All nodes in the
+   network must use the same mode. */
+#ifdef RUDOLPH2_CONF_CODED
+#define RUDOLPH2_CODED RUDOLPH2_CONF_CODED
+#else
+#define RUDOLPH2_CODED 0
+#endif
+
+#ifdef RUDOLPH2_CONF_GENERATION_SIZE
+#define RUDOLPH2_GENERATION_SIZE RUDOLPH2_CONF_GENERATION_SIZE
+#else
+#define RUDOLPH2_GENERATION_SIZE 8
+#endif
+
 struct rudolph2_conn {
   struct polite_conn c;
   const struct rudolph2_callbacks *cb;
@@ -88,6 +106,12 @@ struct rudolph2_conn {
   uint8_t hops_from_base;
   uint8_t nacks;
   uint8_t flags;
+#if RUDOLPH2_CODED
+  uint8_t rows[RUDOLPH2_GENERATION_SIZE][RUDOLPH2_DATASIZE];
+  uint8_t coeffs[RUDOLPH2_GENERATION_SIZE];
+  uint8_t rank;
+  uint8_t coded_sent;
+#endif /* RUDOLPH2_CODED */
 };
 
 void rudolph2_open(struct rudolph2_conn *c, uint16_t channel,
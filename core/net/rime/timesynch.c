@@ -38,7 +38,8 @@
 
 /**
  * \file
- *         A simple time synchronization mechanism
+ *         A simple time synchronization mechanism that estimates
+ *         the offset and skew of the local clock
  * \author
  *         Adam Dunkels <adam@sics.se>
  */
@@ -47,12 +48,65 @@
 #include "lib/random.h"
 #include "net/rime.h"
 #include "net/rime/timesynch.h"
+#include <stdint.h>
 #include <string.h>
 
 #if TIMESYNCH_CONF_ENABLED
+
+#if UIP_CONF_IPV6
+#include "net/uip.h"
+#include "net/simple-udp.h"
+#endif /* UIP_CONF_IPV6 */
+
+/* Number of recent beacons over which the clock skew is estimated. */
+#ifdef TIMESYNCH_CONF_REGRESSION_ENTRIES
+#define TIMESYNCH_REGRESSION_ENTRIES TIMESYNCH_CONF_REGRESSION_ENTRIES
+#else
+#define TIMESYNCH_REGRESSION_ENTRIES 8
+#endif
+
+/* A beacon that deviates more than this many rtimer ticks from the
+   current estimate flushes the regression table. */
+#ifdef TIMESYNCH_CONF_ERROR_LIMIT
+#define TIMESYNCH_ERROR_LIMIT TIMESYNCH_CONF_ERROR_LIMIT
+#else
+#define TIMESYNCH_ERROR_LIMIT ((int32_t)RTIMER_SECOND / 500)
+#endif
+
+#ifdef TIMESYNCH_CONF_MAX_INTERVAL
+#define MAX_INTERVAL TIMESYNCH_CONF_MAX_INTERVAL
+#else
+#define MAX_INTERVAL CLOCK_SECOND * 60 * 5
+#endif
+
+#define MIN_INTERVAL CLOCK_SECOND * 8
+
+/* The skew is a fixed-point fraction with SKEW_SHIFT fractional bits. */
+#define SKEW_SHIFT 24
+
+/* Beacons must be at most this far apart for clock_time() to tell
+   how many times the rtimer has wrapped in between. */
+#define MAX_GAP_SECONDS ((unsigned long)(clock_time_t)~0 / CLOCK_SECOND - 2)
+
 static int authority_level;
 static rtimer_clock_t offset;
 
+/* The extended (32-bit) local time and offset of each sample. */
+struct sample {
+  uint32_t local;
+  int32_t offset;
+};
+static struct sample samples[TIMESYNCH_REGRESSION_ENTRIES];
+static uint8_t num_samples, next_sample;
+
+/* The reference point that the offset and skew are relative to. */
+static rtimer_clock_t ref_rtimer;
+static clock_time_t ref_clock;
+static unsigned long ref_seconds;
+static uint32_t ref_local;
+static int32_t ref_offset;
+static int32_t skew;
+
 #define TIMESYNCH_CHANNEL  7
 
 struct timesynch_msg {
@@ -72,9 +126,41 @@ struct timesynch_msg {
 };
 
 PROCESS(timesynch_process, "Timesynch process");
+/*---------------------------------------------------------------------------*/
+static int32_t
+rtimer_diff(rtimer_clock_t diff)
+{
+  if(sizeof(rtimer_clock_t) < sizeof(int32_t)) {
+    return (int16_t)diff;
+  }
+  return (int32_t)diff;
+}
+/*---------------------------------------------------------------------------*/
+/* The time elapsed from the reference point to the rtimer time t,
+   which is assumed to lie close to the current clock_time(). A 16-bit
+   rtimer wraps every few seconds, so the coarse clock_time() tells
+   how many times it has wrapped. */
+static int32_t
+elapsed(rtimer_clock_t t)
+{
+  clock_time_t ticks;
+  uint32_t coarse;
 
-#define MIN_INTERVAL CLOCK_SECOND * 8
-#define MAX_INTERVAL CLOCK_SECOND * 60 * 5
+  if(sizeof(rtimer_clock_t) >= sizeof(uint32_t)) {
+    return (int32_t)(t - ref_rtimer);
+  }
+  ticks = clock_time() - ref_clock;
+  coarse = (uint32_t)(ticks / CLOCK_SECOND) * RTIMER_SECOND +
+    (uint32_t)(ticks % CLOCK_SECOND) * RTIMER_SECOND / CLOCK_SECOND;
+  return (int32_t)(coarse +
+                   (int16_t)((uint16_t)(t - ref_rtimer) - (uint16_t)coarse));
+}
+/*---------------------------------------------------------------------------*/
+static int32_t
+correction(int32_t elapsed_time)
+{
+  return (int32_t)(((int64_t)elapsed_time * skew) >> SKEW_SHIFT);
+}
 /*---------------------------------------------------------------------------*/
 int
 timesynch_authority_level(void)
@@ -100,19 +186,22 @@ timesynch_set_authority_level(int level)
 rtimer_clock_t
 timesynch_time(void)
 {
-  return RTIMER_NOW() + offset;
+  return timesynch_rtimer_to_time(RTIMER_NOW());
 }
 /*---------------------------------------------------------------------------*/
 rtimer_clock_t
 timesynch_time_to_rtimer(rtimer_clock_t synched_time)
 {
-  return synched_time - offset;
+  rtimer_clock_t t;
+
+  t = synched_time - offset;
+  return t - correction(elapsed(t));
 }
 /*---------------------------------------------------------------------------*/
 rtimer_clock_t
 timesynch_rtimer_to_time(rtimer_clock_t rtimer_time)
 {
-  return rtimer_time + offset;
+  return rtimer_time + offset + correction(elapsed(rtimer_time));
 }
 /*---------------------------------------------------------------------------*/
 rtimer_clock_t
@@ -121,43 +210,206 @@ timesynch_offset(void)
   return offset;
 }
 /*---------------------------------------------------------------------------*/
+int32_t
+timesynch_skew(void)
+{
+  return (int32_t)(((int64_t)skew * 1000000) >> SKEW_SHIFT);
+}
+/*---------------------------------------------------------------------------*/
+/* Move the reference point to the rtimer time t, carrying the skew
+   accumulated since the previous reference into the offset. */
 static void
-adjust_offset(rtimer_clock_t authoritative_time, rtimer_clock_t local_time)
+set_reference(rtimer_clock_t t)
 {
-  offset = authoritative_time - local_time;
+  int32_t e;
+
+  e = elapsed(t);
+  ref_offset += correction(e);
+  ref_local += e;
+  ref_rtimer = t;
+  ref_clock = clock_time();
+  ref_seconds = clock_seconds();
+  offset = ref_offset;
 }
 /*---------------------------------------------------------------------------*/
+/* Fit a line through the (local time, offset) samples by least
+   squares. Its slope is the skew of the local clock and its value at
+   the reference point is the current offset. */
 static void
-broadcast_recv(struct broadcast_conn *c, const rimeaddr_t *from)
+regression(void)
 {
-  struct timesynch_msg msg;
+  int64_t sum_local, sum_offset, num, den;
+  int32_t mean_local, mean_offset, dl, dof;
+  int shift;
+  uint8_t i;
 
-  memcpy(&msg, packetbuf_dataptr(), sizeof(msg));
+  sum_local = sum_offset = 0;
+  for(i = 0; i < num_samples; i++) {
+    sum_local += (int32_t)(samples[i].local - ref_local);
+    sum_offset += samples[i].offset;
+  }
+  mean_local = sum_local / num_samples;
+  mean_offset = sum_offset / num_samples;
+
+  num = den = 0;
+  for(i = 0; i < num_samples; i++) {
+    dl = (int32_t)(samples[i].local - ref_local) - mean_local;
+    dof = samples[i].offset - mean_offset;
+    num += (int64_t)dl * dof;
+    den += (int64_t)dl * dl;
+  }
+
+  if(num_samples > 1 && den > 0) {
+    /* Scale the numerator as far as it goes without overflowing and
+       give up precision in the denominator for the rest. */
+    shift = SKEW_SHIFT;
+    while(shift > 0 && (num > (INT64_MAX >> shift) ||
+                        num < -(INT64_MAX >> shift))) {
+      den >>= 1;
+      shift--;
+    }
+    if(den > 0) {
+      skew = (int32_t)((num << shift) / den);
+    }
+  }
+
+  ref_offset = mean_offset + correction(-mean_local);
+  offset = ref_offset;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_sample(rtimer_clock_t authoritative_time, rtimer_clock_t local_time)
+{
+  int32_t e, error = 0;
+
+  if(num_samples > 0 && clock_seconds() - ref_seconds < MAX_GAP_SECONDS) {
+    e = elapsed(local_time);
+    error = rtimer_diff(authoritative_time - local_time -
+                        (rtimer_clock_t)(ref_offset + correction(e)));
+    if(num_samples > 2 &&
+       (error > TIMESYNCH_ERROR_LIMIT || error < -TIMESYNCH_ERROR_LIMIT)) {
+      num_samples = 0;
+    }
+  } else {
+    num_samples = 0;
+  }
+
+  if(num_samples == 0) {
+    /* Start over from the raw offset of this beacon. */
+    next_sample = 0;
+    skew = 0;
+    ref_offset = rtimer_diff(authoritative_time - local_time);
+    ref_rtimer = local_time;
+    ref_clock = clock_time();
+    ref_seconds = clock_seconds();
+  } else {
+    set_reference(local_time);
+    ref_offset += error;
+  }
+
+  samples[next_sample].local = ref_local;
+  samples[next_sample].offset = ref_offset;
+  next_sample = (next_sample + 1) % TIMESYNCH_REGRESSION_ENTRIES;
+  if(num_samples < TIMESYNCH_REGRESSION_ENTRIES) {
+    num_samples++;
+  }
 
+  regression();
+}
+/*---------------------------------------------------------------------------*/
+static void
+incoming_msg(const struct timesynch_msg *msg)
+{
   /* We check the authority level of the sender of the incoming
        packet. If the sending node has a lower authority level than we
        have, we synchronize to the time of the sending node and set our
        own authority level to be one more than the sending node. */
-  if(msg.authority_level < authority_level) {
-    adjust_offset(msg.timestamp + msg.authority_offset,
-                  packetbuf_attr(PACKETBUF_ATTR_TIMESTAMP));
-    timesynch_set_authority_level(msg.authority_level + 1);
+  if(msg->authority_level < authority_level) {
+    add_sample(msg->timestamp + msg->authority_offset,
+               packetbuf_attr(PACKETBUF_ATTR_TIMESTAMP));
+    timesynch_set_authority_level(msg->authority_level + 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_CONF_IPV6
+static struct simple_udp_connection udp;
+
+static void
+udp_recv(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr,
+         uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr,
+         uint16_t receiver_port,
+         const uint8_t *data,
+         uint16_t datalen)
+{
+  struct timesynch_msg msg;
+
+  if(datalen == sizeof(msg) && uip_is_addr_link_local(sender_addr)) {
+    memcpy(&msg, data, sizeof(msg));
+    incoming_msg(&msg);
   }
 }
+#else /* UIP_CONF_IPV6 */
+static void
+broadcast_recv(struct broadcast_conn *c, const rimeaddr_t *from)
+{
+  struct timesynch_msg msg;
+
+  memcpy(&msg, packetbuf_dataptr(), sizeof(msg));
+  incoming_msg(&msg);
+}
 static const struct broadcast_callbacks broadcast_call = {broadcast_recv};
 static struct broadcast_conn broadcast;
+#endif /* UIP_CONF_IPV6 */
+/*---------------------------------------------------------------------------*/
+static void
+send_msg(void)
+{
+  struct timesynch_msg msg;
+#if UIP_CONF_IPV6
+  uip_ipaddr_t addr;
+#endif /* UIP_CONF_IPV6 */
+
+  /* Move the reference point up so that the skew correction is never
+     computed over more than one beacon interval. */
+  set_reference(RTIMER_NOW());
+
+  msg.authority_level = authority_level;
+  msg.dummy = 0;
+  msg.authority_offset = offset;
+  msg.clock_fine = clock_fine();
+  msg.clock_time = clock_time();
+  msg.seconds = clock_seconds();
+  msg.timestamp = 0;
+#if UIP_CONF_IPV6
+  /* The 6lowpan layer asks the radio to timestamp link-local
+     multicasts between two TIMESYNCH_UDP_PORTs, and elides their UDP
+     checksum from the compressed header. */
+  uip_create_linklocal_allnodes_mcast(&addr);
+  simple_udp_sendto(&udp, &msg, sizeof(msg), &addr);
+#else /* UIP_CONF_IPV6 */
+  packetbuf_copyfrom(&msg, sizeof(msg));
+  packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
+                     PACKETBUF_ATTR_PACKET_TYPE_TIMESTAMP);
+  broadcast_send(&broadcast);
+#endif /* UIP_CONF_IPV6 */
+}
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(timesynch_process, ev, data)
 {
   static struct etimer sendtimer, intervaltimer;
   static clock_time_t interval;
-  struct timesynch_msg msg;
 
+#if !UIP_CONF_IPV6
   PROCESS_EXITHANDLER(broadcast_close(&broadcast);)
+#endif /* !UIP_CONF_IPV6 */
 
   PROCESS_BEGIN();
 
+#if !UIP_CONF_IPV6
   broadcast_open(&broadcast, TIMESYNCH_CHANNEL, &broadcast_call);
+#endif /* !UIP_CONF_IPV6 */
 
   interval = MIN_INTERVAL;
 
@@ -167,17 +419,7 @@ PROCESS_THREAD(timesynch_process, ev, data)
 
     PROCESS_WAIT_UNTIL(etimer_expired(&sendtimer));
 
-    msg.authority_level = authority_level;
-    msg.dummy = 0;
-    msg.authority_offset = offset;
-    msg.clock_fine = clock_fine();
-    msg.clock_time = clock_time();
-    msg.seconds = clock_seconds();
-    msg.timestamp = 0;
-    packetbuf_copyfrom(&msg, sizeof(msg));
-    packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
-                       PACKETBUF_ATTR_PACKET_TYPE_TIMESTAMP);
-    broadcast_send(&broadcast);
+    send_msg();
 
     PROCESS_WAIT_UNTIL(etimer_expired(&intervaltimer));
     interval *= 2;
@@ -192,6 +434,13 @@ PROCESS_THREAD(timesynch_process, ev, data)
 void
 timesynch_init(void)
 {
+  ref_clock = clock_time();
+  ref_seconds = clock_seconds();
+  ref_rtimer = RTIMER_NOW();
+#if UIP_CONF_IPV6
+  simple_udp_register(&udp, TIMESYNCH_UDP_PORT, NULL, TIMESYNCH_UDP_PORT,
+                      udp_recv);
+#endif /* UIP_CONF_IPV6 */
   process_start(&timesynch_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
@@ -70,6 +70,14 @@
 #include "net/mac/mac.h"
 #include "sys/rtimer.h"
 
+/* The UDP port of the beacons when running over IPv6 link-local
+   multicast instead of a Rime broadcast. */
+#ifdef TIMESYNCH_CONF_UDP_PORT
+#define TIMESYNCH_UDP_PORT TIMESYNCH_CONF_UDP_PORT
+#else
+#define TIMESYNCH_UDP_PORT 4445
+#endif
+
 /**
  * \brief      Initialize the timesynch module
  *
@@ -123,6 +131,18 @@ rtimer_clock_t timesynch_rtimer_to_time(rtimer_clock_t rtimer_time);
  */
 rtimer_clock_t timesynch_offset(void);
 
+/**
+ * \brief      Get the estimated skew of the rtimer clock, which is used mainly for debugging
+ * \return     The estimated skew in parts per million
+ *
+ *             This function returns how much faster the
+ *             time-synchronized clock runs than the local rtimer
+ *             clock, as estimated by a linear regression over the
+ *             most recent synchronization beacons.
+ *
+ */
+int32_t timesynch_skew(void);
+
 /**
  * \brief      Get the current authority level of the time-synchronized time
  * \return     The current authority level of the time-synchronized time
@@ -158,6 +158,26 @@
 #define RPL_DIO_REDUNDANCY          10
 #endif
 
+/*
+ * Adaptive DIO redundancy. When enabled, the redundancy constant used
+ * locally is scaled down by the number of IPv6 neighbors once there are
+ * more than RPL_DIO_REDUNDANCY_DENSITY of them, so that dense
+ * neighborhoods send fewer DIOs per interval. The redundancy advertised
+ * in DIOs is not changed. Note that the density that can be observed is
+ * limited by the size of the neighbor table.
+ */
+#ifdef RPL_CONF_DIO_REDUNDANCY_ADAPTIVE
+#define RPL_DIO_REDUNDANCY_ADAPTIVE RPL_CONF_DIO_REDUNDANCY_ADAPTIVE
+#else
+#define RPL_DIO_REDUNDANCY_ADAPTIVE 0
+#endif
+
+#ifdef RPL_CONF_DIO_REDUNDANCY_DENSITY
+#define RPL_DIO_REDUNDANCY_DENSITY  RPL_CONF_DIO_REDUNDANCY_DENSITY
+#else
+#define RPL_DIO_REDUNDANCY_DENSITY  4
+#endif
+
 /*
  * Initial metric attributed to a link when the ETX is unknown
  */
@@ -186,4 +206,58 @@
 #define RPL_DEFAULT_LIFETIME            RPL_CONF_DEFAULT_LIFETIME
 #endif
 
+/*
+ * The number of backup parents kept per DAG, ranked by the objective
+ * function. When the preferred parent fails, the node switches to
+ * the best backup that cannot be its descendant, instead of
+ * starting a local repair. The default of 0 disables backup parents.
+ */
+#ifdef RPL_CONF_BACKUP_PARENTS
+#define RPL_BACKUP_PARENTS              RPL_CONF_BACKUP_PARENTS
+#else
+#define RPL_BACKUP_PARENTS              0
+#endif /* RPL_CONF_BACKUP_PARENTS */
+
+/*
+ * The minimum time between two re-selections of the preferred parent
+ * that are caused by link metric updates alone. Link metrics change
+ * with every transmission, and the throttling keeps the parent
+ * selection from oscillating. Parents whose rank changed are processed
+ * at once. The default of 0 disables the throttling.
+ */
+#ifdef RPL_CONF_RESELECT_INTERVAL
+#define RPL_RESELECT_INTERVAL           RPL_CONF_RESELECT_INTERVAL
+#else
+#define RPL_RESELECT_INTERVAL           0
+#endif /* RPL_CONF_RESELECT_INTERVAL */
+
+/* DAG Mode of Operation */
+#define RPL_MOP_NO_DOWNWARD_ROUTES      0
+#define RPL_MOP_NON_STORING             1
+#define RPL_MOP_STORING_NO_MULTICAST    2
+#define RPL_MOP_STORING_MULTICAST       3
+
+#ifdef  RPL_CONF_MOP
+#define RPL_MOP_DEFAULT                 RPL_CONF_MOP
+#else
+#define RPL_MOP_DEFAULT                 RPL_MOP_STORING_NO_MULTICAST
+#endif
+
+/*
+ * In non-storing mode, DAOs go to the DAG root, which keeps the
+ * parent of every node and adds a source routing header (RFC 6554)
+ * to packets going down. Other nodes keep no downward routes.
+ */
+#define RPL_WITH_NON_STORING (RPL_MOP_DEFAULT == RPL_MOP_NON_STORING)
+
+/*
+ * The number of child-parent links the DAG root can keep in
+ * non-storing mode, which bounds the number of nodes it can route to.
+ */
+#ifdef RPL_CONF_NS_LINK_NUM
+#define RPL_NS_LINK_NUM                 RPL_CONF_NS_LINK_NUM
+#else
+#define RPL_NS_LINK_NUM                 32
+#endif /* RPL_CONF_NS_LINK_NUM */
+
 #endif /* RPL_CONF_H */
@@ -46,6 +46,7 @@
 #include "net/uip.h"
 #include "net/uip-nd6.h"
 #include "net/nbr-table.h"
+#include "net/sicslowpan.h"
 #include "lib/list.h"
 #include "lib/memb.h"
 #include "sys/ctimer.h"
@@ -70,6 +71,14 @@ static rpl_of_t * const objective_functions[] = {&RPL_OF};
 #define RPL_GROUNDED                    RPL_CONF_GROUNDED
 #endif /* !RPL_CONF_GROUNDED */
 
+/* The 6LoWPAN address context that is set to the DAG prefix, so that
+   global addresses in the DAG can be compressed. -1 disables this. */
+#ifdef RPL_CONF_LOWPAN_CONTEXT
+#define RPL_LOWPAN_CONTEXT              RPL_CONF_LOWPAN_CONTEXT
+#else
+#define RPL_LOWPAN_CONTEXT              0
+#endif /* RPL_CONF_LOWPAN_CONTEXT */
+
 /*---------------------------------------------------------------------------*/
 /* Per-parent RPL information */
 NBR_TABLE(rpl_parent_t, rpl_parents);
@@ -106,10 +115,16 @@ rpl_get_parent_link_metric(uip_lladdr_t *addr)
   }
 }
 /*---------------------------------------------------------------------------*/
+rimeaddr_t *
+rpl_get_parent_lladdr(rpl_parent_t *p)
+{
+  return nbr_table_get_lladdr(rpl_parents, p);
+}
+/*---------------------------------------------------------------------------*/
 uip_ipaddr_t *
 rpl_get_parent_ipaddr(rpl_parent_t *p)
 {
-  rimeaddr_t *lladdr = nbr_table_get_lladdr(rpl_parents, p);
+  rimeaddr_t *lladdr = rpl_get_parent_lladdr(p);
   return uip_ds6_nbr_ipaddr_from_lladdr((uip_lladdr_t *)lladdr);
 }
 /*---------------------------------------------------------------------------*/
@@ -155,6 +170,51 @@ lollipop_greater_than(int a, int b)
 			 RPL_LOLLIPOP_SEQUENCE_WINDOWS));
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_BACKUP_PARENTS > 0
+/* Insert a parent among the backup parents of its DAG, which are kept
+   ranked by the objective function, best first. */
+static void
+add_backup_parent(rpl_dag_t *dag, rpl_parent_t *p)
+{
+  rpl_parent_t **backups;
+  int i;
+
+  backups = dag->backup_parents;
+  for(i = 0; i < RPL_BACKUP_PARENTS; i++) {
+    if(backups[i] == NULL ||
+       dag->instance->of->best_parent(backups[i], p) == p) {
+      memmove(&backups[i + 1], &backups[i],
+              (RPL_BACKUP_PARENTS - i - 1) * sizeof(rpl_parent_t *));
+      backups[i] = p;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_backup_parent(rpl_dag_t *dag, rpl_parent_t *p)
+{
+  rpl_parent_t **backups;
+  int i;
+
+  backups = dag->backup_parents;
+  for(i = 0; i < RPL_BACKUP_PARENTS; i++) {
+    if(backups[i] == p) {
+      memmove(&backups[i], &backups[i + 1],
+              (RPL_BACKUP_PARENTS - i - 1) * sizeof(rpl_parent_t *));
+      backups[RPL_BACKUP_PARENTS - 1] = NULL;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+clear_backup_parents(rpl_dag_t *dag)
+{
+  memset(dag->backup_parents, 0, sizeof(dag->backup_parents));
+}
+#endif /* RPL_BACKUP_PARENTS > 0 */
+/*---------------------------------------------------------------------------*/
 /* Remove DAG parents with a rank that is at least the same as minimum_rank. */
 static void
 remove_parents(rpl_dag_t *dag, rpl_rank_t minimum_rank)
@@ -164,6 +224,10 @@ remove_parents(rpl_dag_t *dag, rpl_rank_t minimum_rank)
   PRINTF("RPL: Removing parents (minimum rank %u)\n",
 	minimum_rank);
 
+#if RPL_BACKUP_PARENTS > 0
+  clear_backup_parents(dag);
+#endif /* RPL_BACKUP_PARENTS > 0 */
+
   p = nbr_table_head(rpl_parents);
   while(p != NULL) {
     if(dag == p->dag && p->rank >= minimum_rank) {
@@ -181,6 +245,10 @@ nullify_parents(rpl_dag_t *dag, rpl_rank_t minimum_rank)
   PRINTF("RPL: Removing parents (minimum rank %u)\n",
 	minimum_rank);
 
+#if RPL_BACKUP_PARENTS > 0
+  clear_backup_parents(dag);
+#endif /* RPL_BACKUP_PARENTS > 0 */
+
   p = nbr_table_head(rpl_parents);
   while(p != NULL) {
     if(dag == p->dag && p->rank >= minimum_rank) {
@@ -210,6 +278,61 @@ acceptable_rank(rpl_dag_t *dag, rpl_rank_t rank)
      DAG_RANK(rank, dag->instance) <= DAG_RANK(dag->min_rank + dag->instance->max_rankinc, dag->instance));
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_BACKUP_PARENTS > 0
+/* Replace a failed preferred parent with the best backup parent,
+   without a local repair. Only a backup with a lower rank than our
+   own cannot be our descendant, so others are skipped to avoid
+   loops. */
+static int
+switch_to_backup_parent(rpl_dag_t *dag, rpl_parent_t *failed)
+{
+  rpl_instance_t *instance;
+  rpl_parent_t *p;
+  rpl_rank_t rank;
+
+  instance = dag->instance;
+  if(!dag->joined || dag->rank == INFINITE_RANK ||
+     failed != dag->preferred_parent) {
+    return 0;
+  }
+
+  while((p = dag->backup_parents[0]) != NULL) {
+    remove_backup_parent(dag, p);
+    if(p->rank == INFINITE_RANK ||
+       DAG_RANK(p->rank, instance) >= DAG_RANK(dag->rank, instance)) {
+      continue;
+    }
+    rank = instance->of->calculate_rank(p, 0);
+    if(!acceptable_rank(dag, rank)) {
+      continue;
+    }
+
+    PRINTF("RPL: Switching to backup parent ");
+    PRINT6ADDR(rpl_get_parent_ipaddr(p));
+    PRINTF(", rank changed from %u to %u\n", (unsigned)dag->rank, rank);
+
+    rpl_set_preferred_parent(dag, p);
+    dag->rank = rank;
+    if(dag == instance->current_dag) {
+      instance->of->update_metric_container(instance);
+    }
+    rpl_set_default_route(instance, rpl_get_parent_ipaddr(p));
+    if(instance->mop != RPL_MOP_NO_DOWNWARD_ROUTES) {
+#if !RPL_WITH_NON_STORING
+      /* Send a No-Path DAO to the failed preferred parent. */
+      dao_output(failed, RPL_ZERO_LIFETIME);
+#endif /* !RPL_WITH_NON_STORING */
+      RPL_LOLLIPOP_INCREMENT(instance->dtsn_out);
+      rpl_schedule_dao(instance);
+    }
+    rpl_reset_dio_timer(instance);
+    RPL_STAT(rpl_stats.backup_switch++);
+    return 1;
+  }
+  return 0;
+}
+#endif /* RPL_BACKUP_PARENTS > 0 */
+/*---------------------------------------------------------------------------*/
 static rpl_dag_t *
 get_dag(uint8_t instance_id, uip_ipaddr_t *dag_id)
 {
@@ -270,10 +393,6 @@ rpl_set_root(uint8_t instance_id, uip_ipaddr_t *dag_id)
 
   instance->dio_intdoubl = RPL_DIO_INTERVAL_DOUBLINGS;
   instance->dio_intmin = RPL_DIO_INTERVAL_MIN;
-  /* The current interval must differ from the minimum interval in order to
-     trigger a DIO timer reset. */
-  instance->dio_intcurrent = RPL_DIO_INTERVAL_MIN +
-    RPL_DIO_INTERVAL_DOUBLINGS;
   instance->dio_redundancy = RPL_DIO_REDUNDANCY;
   instance->max_rankinc = RPL_MAX_RANKINC;
   instance->min_hoprankinc = RPL_MIN_HOPRANKINC;
@@ -366,6 +485,14 @@ check_prefix(rpl_prefix_t *last_prefix, rpl_prefix_t *new_prefix)
       uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
     }
   }
+
+#if RPL_LOWPAN_CONTEXT >= 0
+  if(new_prefix != NULL) {
+    sicslowpan_context_set(RPL_LOWPAN_CONTEXT, &new_prefix->prefix);
+  } else {
+    sicslowpan_context_remove(RPL_LOWPAN_CONTEXT);
+  }
+#endif /* RPL_LOWPAN_CONTEXT >= 0 */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -501,7 +628,7 @@ rpl_free_instance(rpl_instance_t *instance)
 
   rpl_set_default_route(instance, NULL);
 
-  ctimer_stop(&instance->dio_timer);
+  trickle_timer_stop(&instance->dio_timer);
   ctimer_stop(&instance->dao_timer);
 
   if(default_instance == instance) {
@@ -522,6 +649,9 @@ rpl_free_dag(rpl_dag_t *dag)
 
     /* Remove routes installed by DAOs. */
     rpl_remove_routes(dag);
+#if RPL_WITH_NON_STORING
+    rpl_ns_remove_dag(dag);
+#endif /* RPL_WITH_NON_STORING */
 
    /* Remove autoconfigured address */
     if((dag->prefix_info.flags & UIP_ND6_RA_FLAG_AUTONOMOUS)) {
@@ -673,10 +803,14 @@ rpl_select_dag(rpl_instance_t *instance, rpl_parent_t *p)
   	(unsigned)old_rank, best_dag->rank);
     RPL_STAT(rpl_stats.parent_switch++);
     if(instance->mop != RPL_MOP_NO_DOWNWARD_ROUTES) {
+      /* In non-storing mode the DAO below replaces the link at the
+         root, so the old parent needs no No-Path DAO. */
+#if !RPL_WITH_NON_STORING
       if(last_parent != NULL) {
         /* Send a No-Path DAO to the removed preferred parent. */
         dao_output(last_parent, RPL_ZERO_LIFETIME);
       }
+#endif /* !RPL_WITH_NON_STORING */
       /* The DAO parent set changed - schedule a DAO transmission. */
       RPL_LOLLIPOP_INCREMENT(instance->dtsn_out);
       rpl_schedule_dao(instance);
@@ -693,8 +827,14 @@ rpl_parent_t *
 rpl_select_parent(rpl_dag_t *dag)
 {
   rpl_parent_t *p, *best;
+#if RPL_BACKUP_PARENTS > 0
+  rpl_parent_t *b;
+#endif /* RPL_BACKUP_PARENTS > 0 */
 
   best = NULL;
+#if RPL_BACKUP_PARENTS > 0
+  clear_backup_parents(dag);
+#endif /* RPL_BACKUP_PARENTS > 0 */
 
   p = nbr_table_head(rpl_parents);
   while(p != NULL) {
@@ -703,7 +843,17 @@ rpl_select_parent(rpl_dag_t *dag)
     } else if(best == NULL) {
       best = p;
     } else {
+#if RPL_BACKUP_PARENTS > 0
+      /* The candidate that loses against the best parent so far is
+         ranked among the backups. */
+      b = dag->instance->of->best_parent(best, p);
+      if(p->dag == dag && best->dag == dag) {
+        add_backup_parent(dag, b == p ? best : p);
+      }
+      best = b;
+#else /* RPL_BACKUP_PARENTS > 0 */
       best = dag->instance->of->best_parent(best, p);
+#endif /* RPL_BACKUP_PARENTS > 0 */
     }
     p = nbr_table_next(rpl_parents, p);
   }
@@ -731,6 +881,14 @@ void
 rpl_nullify_parent(rpl_parent_t *parent)
 {
   rpl_dag_t *dag = parent->dag;
+
+#if RPL_BACKUP_PARENTS > 0
+  remove_backup_parent(dag, parent);
+  if(switch_to_backup_parent(dag, parent)) {
+    return;
+  }
+#endif /* RPL_BACKUP_PARENTS > 0 */
+
   /* This function can be called when the preferred parent is NULL, so we
      need to handle this condition in order to trigger uip_ds6_defrt_rm. */
   if(parent == dag->preferred_parent || dag->preferred_parent == NULL) {
@@ -772,6 +930,10 @@ rpl_move_parent(rpl_dag_t *dag_src, rpl_dag_t *dag_dst, rpl_parent_t *parent)
     rpl_remove_routes_by_nexthop(rpl_get_parent_ipaddr(parent), dag_src);
   }
 
+#if RPL_BACKUP_PARENTS > 0
+  remove_backup_parent(dag_src, parent);
+#endif /* RPL_BACKUP_PARENTS > 0 */
+
   PRINTF("RPL: Moving parent ");
   PRINT6ADDR(rpl_get_parent_ipaddr(parent));
   PRINTF("\n");
@@ -882,7 +1044,6 @@ rpl_join_instance(uip_ipaddr_t *from, rpl_dio_t *dio)
   instance->min_hoprankinc = dio->dag_min_hoprankinc;
   instance->dio_intdoubl = dio->dag_intdoubl;
   instance->dio_intmin = dio->dag_intmin;
-  instance->dio_intcurrent = instance->dio_intmin + instance->dio_intdoubl;
   instance->dio_redundancy = dio->dag_redund;
   instance->default_lifetime = dio->default_lifetime;
   instance->lifetime_unit = dio->lifetime_unit;
@@ -1050,29 +1211,60 @@ rpl_local_repair(rpl_instance_t *instance)
   RPL_STAT(rpl_stats.local_repairs++);
 }
 /*---------------------------------------------------------------------------*/
+/* Set when a parent has been marked by rpl_parent_updated(), so that
+   rpl_recalculate_ranks() only sweeps the parent table when needed. */
+static uint8_t parents_updated;
+static clock_time_t last_reselect;
+
 void
 rpl_recalculate_ranks(void)
 {
   rpl_parent_t *p;
+  int throttled;
 
   /*
    * We recalculate ranks when we receive feedback from the system rather
    * than RPL protocol messages. This periodical recalculation is called
    * from a timer in order to keep the stack depth reasonably low.
    */
+  if(!parents_updated) {
+    return;
+  }
+
+#if RPL_RESELECT_INTERVAL > 0
+  throttled = (clock_time_t)(clock_time() - last_reselect) <
+    RPL_RESELECT_INTERVAL;
+#else
+  throttled = 0;
+#endif
+  parents_updated = 0;
+
   p = nbr_table_head(rpl_parents);
   while(p != NULL) {
     if(p->dag != NULL && p->dag->instance && p->updated) {
-      p->updated = 0;
-      PRINTF("RPL: rpl_process_parent_event recalculate_ranks\n");
-      if(!rpl_process_parent_event(p->dag->instance, p)) {
-        PRINTF("RPL: A parent was dropped\n");
+      if(throttled && !(p->updated & RPL_PARENT_UPDATED_RANK)) {
+        /* Only the link metric changed; wait for the next round. */
+        parents_updated = 1;
+      } else {
+        p->updated = 0;
+        last_reselect = clock_time();
+        PRINTF("RPL: rpl_process_parent_event recalculate_ranks\n");
+        if(!rpl_process_parent_event(p->dag->instance, p)) {
+          PRINTF("RPL: A parent was dropped\n");
+        }
       }
     }
     p = nbr_table_next(rpl_parents, p);
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+rpl_parent_updated(rpl_parent_t *parent, uint8_t reason)
+{
+  parent->updated |= reason;
+  parents_updated = 1;
+}
+/*---------------------------------------------------------------------------*/
 int
 rpl_process_parent_event(rpl_instance_t *instance, rpl_parent_t *p)
 {
@@ -1198,7 +1390,7 @@ rpl_process_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 
   if(dag->rank == ROOT_RANK(instance)) {
     if(dio->rank != INFINITE_RANK) {
-      instance->dio_counter++;
+      trickle_timer_consistency(&instance->dio_timer);
     }
     return;
   }
@@ -1235,7 +1427,7 @@ rpl_process_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
     if(p->rank == dio->rank) {
       PRINTF("RPL: Received consistent DIO\n");
       if(dag->joined) {
-        instance->dio_counter++;
+        trickle_timer_consistency(&instance->dio_timer);
       }
     } else {
       p->rank=dio->rank;
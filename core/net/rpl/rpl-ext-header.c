@@ -45,6 +45,7 @@
 #include "net/uip.h"
 #include "net/tcpip.h"
 #include "net/uip-ds6.h"
+#include "net/uip-icmp6.h"
 #include "net/rpl/rpl-private.h"
 
 #define DEBUG DEBUG_NONE
@@ -355,4 +356,252 @@ rpl_insert_header(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_NON_STORING
+/*
+ * Source routing header (RFC 6554). After the four bytes common to
+ * all routing headers come CmprI/CmprE, Pad and a reserved field, and
+ * then the addresses of the remaining hops. Each address is stored
+ * without the CmprI (CmprE for the last one) leading bytes it shares
+ * with the IPv6 destination address.
+ */
+#define SRH_CMPR(srh)             (srh)[4]
+#define SRH_PAD(srh)              ((srh)[5] >> 4)
+#define SRH_ADDRS(srh)            (&(srh)[RPL_SRH_LEN])
+
+/* The ROUTING header of a packet that has just been received. */
+#define UIP_RH_BUF                (&uip_buf[uip_l2_l3_hdr_len])
+/*---------------------------------------------------------------------------*/
+/* Find the source routing header of an outgoing packet, which can
+   only be preceded by the RPL hop-by-hop option. */
+static uint8_t *
+get_srh(uint8_t **next_hdr)
+{
+  uint8_t *next;
+  int offset;
+
+  next = &UIP_IP_BUF->proto;
+  offset = UIP_LLH_LEN + UIP_IPH_LEN;
+  if(*next == UIP_PROTO_HBHO) {
+    next = &uip_buf[offset];
+    offset += (uip_buf[offset + 1] << 3) + 8;
+  }
+  if(next_hdr != NULL) {
+    *next_hdr = next;
+  }
+  if(*next != UIP_PROTO_ROUTING ||
+     offset + RPL_SRH_LEN > UIP_LLH_LEN + uip_len ||
+     uip_buf[offset + 2] != RPL_RH_TYPE_SRH) {
+    return NULL;
+  }
+  return &uip_buf[offset];
+}
+/*---------------------------------------------------------------------------*/
+/* Get the root of the DAG, if we are it. */
+static rpl_dag_t *
+get_root_dag(void)
+{
+  rpl_dag_t *dag;
+
+  if(default_instance == NULL || !default_instance->used) {
+    return NULL;
+  }
+  dag = default_instance->current_dag;
+  if(dag == NULL || !dag->joined || dag->rank != ROOT_RANK(default_instance)) {
+    return NULL;
+  }
+  return dag;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns 0 if the routing header is not a source routing header for
+   us to process, 1 if the packet is to be dropped, 2 if it is to be
+   forwarded to the new destination address, and 3 if it is to be
+   dropped and an ICMPv6 error has been put in uip_buf instead. */
+int
+rpl_process_srh_header(void)
+{
+  uint8_t *srh;
+  uint8_t *addr;
+  uip_ipaddr_t next_hop;
+  uip_ipaddr_t hop;
+  uint8_t cmpr;
+  int size;
+  int n;
+  int i;
+  int j;
+
+  srh = UIP_RH_BUF;
+  if(srh[2] != RPL_RH_TYPE_SRH || srh[3] == 0) {
+    /* Not ours, or we are the final destination. */
+    return 0;
+  }
+
+  /* The whole header must be in the packet before any address is
+     read from it. */
+  size = srh[1] << 3;
+  if(UIP_IPH_LEN + uip_ext_len + 8 + size > uip_len) {
+    PRINTF("RPL: Truncated source routing header\n");
+    return 1;
+  }
+
+  /* Number of addresses in the header, given the compressed size of
+     all but the last one. */
+  cmpr = SRH_CMPR(srh) & 0x0f;
+  if(size < SRH_PAD(srh) + 16 - cmpr) {
+    PRINTF("RPL: Malformed source routing header\n");
+    return 1;
+  }
+  n = (size - SRH_PAD(srh) - (16 - cmpr)) / (16 - (SRH_CMPR(srh) >> 4)) + 1;
+  if(srh[3] > n) {
+    PRINTF("RPL: Too many segments left in source routing header\n");
+    return 1;
+  }
+
+  /* A route that comes back through us is a loop (RFC 6554, section
+     4.2). The hops after the next one are checked before the header
+     is changed, so that the error carries the packet as received. */
+  i = n - srh[3] + 1;
+  for(j = i + 1; j <= n; j++) {
+    addr = SRH_ADDRS(srh) + (j - 1) * (16 - (SRH_CMPR(srh) >> 4));
+    cmpr = j < n ? SRH_CMPR(srh) >> 4 : SRH_CMPR(srh) & 0x0f;
+    uip_ipaddr_copy(&hop, &UIP_IP_BUF->destipaddr);
+    memcpy(&hop.u8[cmpr], addr, 16 - cmpr);
+    if(uip_ds6_is_my_addr(&hop)) {
+      PRINTF("RPL: Loop in source routing header\n");
+      uip_icmp6_error_output(ICMP6_PARAM_PROB, ICMP6_PARAMPROB_HEADER,
+                             UIP_IPH_LEN + uip_ext_len + (addr - srh));
+      return 3;
+    }
+  }
+
+  /* Swap the destination address with the next address in the
+     header. Only the part that is not shared with the destination is
+     stored in the header. */
+  srh[3]--;
+  cmpr = i < n ? SRH_CMPR(srh) >> 4 : SRH_CMPR(srh) & 0x0f;
+  addr = SRH_ADDRS(srh) + (i - 1) * (16 - (SRH_CMPR(srh) >> 4));
+
+  uip_ipaddr_copy(&next_hop, &UIP_IP_BUF->destipaddr);
+  memcpy(&next_hop.u8[cmpr], addr, 16 - cmpr);
+  if(uip_is_addr_mcast(&next_hop) || uip_ds6_is_my_addr(&next_hop)) {
+    PRINTF("RPL: Bad next hop in source routing header\n");
+    return 1;
+  }
+  memcpy(addr, &UIP_IP_BUF->destipaddr.u8[cmpr], 16 - cmpr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &next_hop);
+
+  PRINTF("RPL: Source routing to ");
+  PRINT6ADDR(&next_hop);
+  PRINTF(", %u segments left\n", srh[3]);
+  return 2;
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_insert_srh_header(void)
+{
+  rpl_dag_t *dag;
+  uip_ipaddr_t *path[RPL_NS_LINK_NUM];
+  uip_ipaddr_t dest;
+  uint8_t *next;
+  uint8_t *srh;
+  uint8_t cmpr;
+  int offset;
+  int len;
+  int size;
+  int pad;
+  int i;
+
+  dag = get_root_dag();
+  if(dag == NULL || get_srh(NULL) != NULL) {
+    return 1;
+  }
+
+  uip_ipaddr_copy(&dest, &UIP_IP_BUF->destipaddr);
+  if(uip_is_addr_mcast(&dest) || uip_is_addr_link_local(&dest)) {
+    return 1;
+  }
+
+  /* path[0] is the destination and path[len - 1] the child of the
+     root that the packet is sent to first. Neighbors of the root need
+     no header. */
+  len = rpl_ns_get_path(dag, &dest, path, RPL_NS_LINK_NUM);
+  if(len <= 1) {
+    return 1;
+  }
+
+  /* Elide the prefix that all the hops share. */
+  for(cmpr = 0; cmpr < 15; cmpr++) {
+    for(i = 0; i < len - 1; i++) {
+      if(path[i]->u8[cmpr] != path[len - 1]->u8[cmpr]) {
+        break;
+      }
+    }
+    if(i < len - 1) {
+      break;
+    }
+  }
+  size = (len - 1) * (16 - cmpr);
+  pad = (8 - (size & 7)) & 7;
+  size += RPL_SRH_LEN + pad;
+
+  if(uip_len + size > UIP_LINK_MTU ||
+     UIP_LLH_LEN + uip_len + size > UIP_BUFSIZE) {
+    PRINTF("RPL: Packet too long for a source routing header\n");
+    return 0;
+  }
+
+  get_srh(&next);
+  offset = next == &UIP_IP_BUF->proto ? UIP_LLH_LEN + UIP_IPH_LEN :
+    UIP_LLH_LEN + UIP_IPH_LEN + (next[1] << 3) + 8;
+  srh = &uip_buf[offset];
+  memmove(srh + size, srh, UIP_LLH_LEN + uip_len - offset);
+
+  srh[0] = *next;
+  srh[1] = (size - 8) >> 3;
+  srh[2] = RPL_RH_TYPE_SRH;
+  srh[3] = len - 1;
+  SRH_CMPR(srh) = (cmpr << 4) | cmpr;
+  srh[5] = pad << 4;
+  srh[6] = 0;
+  srh[7] = 0;
+  for(i = 0; i < len - 1; i++) {
+    memcpy(SRH_ADDRS(srh) + i * (16 - cmpr), &path[len - 2 - i]->u8[cmpr],
+           16 - cmpr);
+  }
+  memset(srh + size - pad, 0, pad);
+  *next = UIP_PROTO_ROUTING;
+
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, path[len - 1]);
+  uip_len += size;
+  UIP_IP_BUF->len[0] = (uip_len - UIP_IPH_LEN) >> 8;
+  UIP_IP_BUF->len[1] = (uip_len - UIP_IPH_LEN) & 0xff;
+
+  PRINTF("RPL: Added a source routing header with %u hops to ", len - 1);
+  PRINT6ADDR(&dest);
+  PRINTF("\n");
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_srh_get_next_hop(uip_ipaddr_t *ipaddr)
+{
+  rpl_dag_t *dag;
+  uip_ipaddr_t *path[1];
+
+  /* A source routed packet, or one the root sends to a neighbor, is
+     sent to the destination itself, which is known to us by its
+     link-local address. */
+  if(get_srh(NULL) == NULL) {
+    dag = get_root_dag();
+    if(dag == NULL ||
+       rpl_ns_get_path(dag, &UIP_IP_BUF->destipaddr, path, 1) != 1) {
+      return 0;
+    }
+  }
+  uip_create_linklocal_prefix(ipaddr);
+  memcpy(&ipaddr->u8[8], &UIP_IP_BUF->destipaddr.u8[8], 8);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* RPL_WITH_NON_STORING */
+/*---------------------------------------------------------------------------*/
 #endif /* UIP_CONF_IPV6 */
@@ -562,6 +562,326 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
 #endif /* RPL_LEAF_ONLY */
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_DAO_AGGREGATION
+/* Targets of the DAOs we have received, waiting to be forwarded to
+   our preferred parent in a single DAO. With DAO ACKs, the first
+   dao_batch_count targets were sent in the DAO with sequence number
+   dao_batch_sequence and are kept until that DAO is acknowledged. */
+struct dao_target {
+  uip_ipaddr_t prefix;
+  uint8_t prefixlen;
+  uint8_t lifetime;
+};
+static struct dao_target dao_targets[RPL_DAO_AGGREGATION_MAX];
+static uint8_t dao_target_count;
+static rpl_instance_t *dao_target_instance;
+static struct ctimer dao_aggregation_timer;
+#if RPL_CONF_DAO_ACK
+static uint8_t dao_batch_count;
+static uint8_t dao_batch_sequence;
+static uint8_t dao_batch_transmissions;
+#define DAO_BATCH_PENDING() (dao_batch_count > 0)
+#else /* RPL_CONF_DAO_ACK */
+#define DAO_BATCH_PENDING() 0
+#endif /* RPL_CONF_DAO_ACK */
+#endif /* RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
+static int
+dao_header(unsigned char *buffer, rpl_dag_t *dag)
+{
+  int pos;
+
+  RPL_LOLLIPOP_INCREMENT(dao_sequence);
+  pos = 0;
+
+  buffer[pos++] = dag->instance->instance_id;
+  buffer[pos] = 0;
+#if RPL_DAO_SPECIFY_DAG
+  buffer[pos] |= RPL_DAO_D_FLAG;
+#endif /* RPL_DAO_SPECIFY_DAG */
+#if RPL_CONF_DAO_ACK
+  buffer[pos] |= RPL_DAO_K_FLAG;
+#endif /* RPL_CONF_DAO_ACK */
+  ++pos;
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = dao_sequence;
+#if RPL_DAO_SPECIFY_DAG
+  memcpy(buffer + pos, &dag->dag_id, sizeof(dag->dag_id));
+  pos+=sizeof(dag->dag_id);
+#endif /* RPL_DAO_SPECIFY_DAG */
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+static int
+dao_target_option(unsigned char *buffer, int pos,
+                  uip_ipaddr_t *prefix, uint8_t prefixlen)
+{
+  buffer[pos++] = RPL_OPTION_TARGET;
+  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = prefixlen;
+  memcpy(buffer + pos, prefix, (prefixlen + 7) / CHAR_BIT);
+  return pos + ((prefixlen + 7) / CHAR_BIT);
+}
+/*---------------------------------------------------------------------------*/
+static int
+dao_transit_option(unsigned char *buffer, int pos, uint8_t lifetime,
+                   uip_ipaddr_t *parent_addr)
+{
+  buffer[pos++] = RPL_OPTION_TRANSIT;
+  buffer[pos++] = parent_addr == NULL ? 4 : 4 + sizeof(uip_ipaddr_t);
+  buffer[pos++] = 0; /* flags - ignored */
+  buffer[pos++] = 0; /* path control - ignored */
+  buffer[pos++] = 0; /* path seq - ignored */
+  buffer[pos++] = lifetime;
+  if(parent_addr != NULL) {
+    memcpy(buffer + pos, parent_addr, sizeof(uip_ipaddr_t));
+    pos += sizeof(uip_ipaddr_t);
+  }
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_DAO_AGGREGATION
+static void
+dao_aggregation_send(void *ptr)
+{
+  rpl_instance_t *instance;
+  rpl_parent_t *parent;
+  unsigned char *buffer;
+  int pos;
+  int i;
+
+  instance = dao_target_instance;
+  ctimer_stop(&dao_aggregation_timer);
+
+#if RPL_CONF_DAO_ACK
+  if(dao_batch_count > 0 &&
+     dao_batch_transmissions >= RPL_DAO_MAX_TRANSMISSIONS) {
+    PRINTF("RPL: Giving up on %u unacknowledged DAO targets\n",
+           dao_batch_count);
+    dao_target_count -= dao_batch_count;
+    memmove(dao_targets, &dao_targets[dao_batch_count],
+            dao_target_count * sizeof(dao_targets[0]));
+    dao_batch_count = 0;
+    dao_batch_transmissions = 0;
+  }
+#endif /* RPL_CONF_DAO_ACK */
+
+  if(dao_target_count == 0 || instance == NULL || !instance->used) {
+    dao_target_count = 0;
+    return;
+  }
+
+  parent = instance->current_dag->preferred_parent;
+  if(parent == NULL || rpl_get_parent_ipaddr(parent) == NULL) {
+    PRINTF("RPL: No parent to forward %u DAO targets to\n",
+           dao_target_count);
+    dao_target_count = 0;
+#if RPL_CONF_DAO_ACK
+    dao_batch_count = 0;
+#endif /* RPL_CONF_DAO_ACK */
+    return;
+  }
+
+  buffer = UIP_ICMP_PAYLOAD;
+  pos = dao_header(buffer, instance->current_dag);
+  for(i = 0; i < dao_target_count; i++) {
+    pos = dao_target_option(buffer, pos, &dao_targets[i].prefix,
+                            dao_targets[i].prefixlen);
+    /* Targets with the same lifetime share a transit option. */
+    if(i + 1 == dao_target_count ||
+       dao_targets[i + 1].lifetime != dao_targets[i].lifetime) {
+      pos = dao_transit_option(buffer, pos, dao_targets[i].lifetime, NULL);
+    }
+  }
+
+  PRINTF("RPL: Forwarding %u DAO targets to parent ", dao_target_count);
+  PRINT6ADDR(rpl_get_parent_ipaddr(parent));
+  PRINTF("\n");
+
+#if RPL_CONF_DAO_ACK
+  /* Keep the targets until the parent acknowledges all of them. */
+  dao_batch_count = dao_target_count;
+  dao_batch_sequence = dao_sequence;
+  dao_batch_transmissions++;
+  ctimer_set(&dao_aggregation_timer, RPL_DAO_ACK_TIMEOUT,
+             dao_aggregation_send, NULL);
+#else /* RPL_CONF_DAO_ACK */
+  dao_target_count = 0;
+#endif /* RPL_CONF_DAO_ACK */
+
+  uip_icmp6_send(rpl_get_parent_ipaddr(parent), ICMP6_RPL, RPL_CODE_DAO, pos);
+}
+/*---------------------------------------------------------------------------*/
+static int
+dao_aggregate(rpl_instance_t *instance, uip_ipaddr_t *prefix,
+              uint8_t prefixlen, uint8_t lifetime)
+{
+  struct dao_target *t;
+  int i;
+
+  if(dao_target_count > 0 && dao_target_instance != instance) {
+    return 0;
+  }
+
+  for(i = 0; i < dao_target_count; i++) {
+    t = &dao_targets[i];
+    if(t->prefixlen == prefixlen && uip_ipaddr_cmp(&t->prefix, prefix)) {
+#if RPL_CONF_DAO_ACK
+      if(i < dao_batch_count) {
+        /* The new lifetime is not in the DAO waiting for an ACK, so
+           the target goes into the next one. */
+        memmove(t, t + 1, (dao_target_count - i - 1) * sizeof(*t));
+        dao_batch_count--;
+        dao_target_count--;
+        break;
+      }
+#endif /* RPL_CONF_DAO_ACK */
+      t->lifetime = lifetime;
+      return 1;
+    }
+  }
+
+  if(dao_target_count == RPL_DAO_AGGREGATION_MAX) {
+    return 0;
+  }
+
+  t = &dao_targets[dao_target_count++];
+  uip_ipaddr_copy(&t->prefix, prefix);
+  t->prefixlen = prefixlen;
+  t->lifetime = lifetime;
+  dao_target_instance = instance;
+
+  if(ctimer_expired(&dao_aggregation_timer)) {
+    ctimer_set(&dao_aggregation_timer, RPL_DAO_AGGREGATION_DELAY,
+               dao_aggregation_send, NULL);
+  }
+  return 1;
+}
+#endif /* RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
+/* Handle the targets in buffer[from] to buffer[to - 1], which share
+   the same transit information. Returns -1 if the DAO must be dropped
+   and 1 if it has to be forwarded to our parent as it is. */
+static int
+dao_input_targets(rpl_instance_t *instance, uip_ipaddr_t *sender,
+                  int learned_from, unsigned char *buffer, int from, int to,
+                  uint8_t lifetime, uip_ipaddr_t *parent_addr)
+{
+  rpl_dag_t *dag;
+  uip_ipaddr_t prefix;
+  uint8_t prefixlen;
+  uip_ds6_route_t *rep;
+  rpl_parent_t *p;
+  int forward;
+  int len;
+  int i;
+
+  dag = instance->current_dag;
+  forward = 0;
+
+  for(i = from; i < to; i += len) {
+    if(buffer[i] == RPL_OPTION_PAD1) {
+      len = 1;
+      continue;
+    }
+    len = 2 + buffer[i + 1];
+    if(buffer[i] != RPL_OPTION_TARGET) {
+      continue;
+    }
+
+    prefixlen = buffer[i + 3];
+    memset(&prefix, 0, sizeof(prefix));
+    memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
+
+    PRINTF("RPL: DAO lifetime: %u, prefix length: %u prefix: ",
+           (unsigned)lifetime, (unsigned)prefixlen);
+    PRINT6ADDR(&prefix);
+    PRINTF("\n");
+
+#if RPL_WITH_NON_STORING
+    /* In non-storing mode, only the root keeps track of where the
+       nodes are: it stores the parent of the target instead of a
+       route. */
+    if(lifetime == RPL_ZERO_LIFETIME) {
+      PRINTF("RPL: No-Path DAO received\n");
+      rpl_ns_expire_parent(dag, &prefix);
+    } else if(parent_addr == NULL ||
+              !rpl_ns_update_node(dag, &prefix, parent_addr,
+                                  RPL_LIFETIME(instance, lifetime))) {
+      PRINTF("RPL: Could not add a link after receiving a DAO\n");
+    }
+    continue;
+#endif /* RPL_WITH_NON_STORING */
+
+    rep = uip_ds6_route_lookup(&prefix);
+
+    if(lifetime == RPL_ZERO_LIFETIME) {
+      PRINTF("RPL: No-Path DAO received\n");
+      /* No-Path DAO received; invoke the route purging routine. */
+      if(rep != NULL &&
+         rep->state.nopath_received == 0 &&
+         rep->length == prefixlen &&
+         uip_ds6_route_nexthop(rep) != NULL &&
+         uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), sender)) {
+        PRINTF("RPL: Setting expiration timer for prefix ");
+        PRINT6ADDR(&prefix);
+        PRINTF("\n");
+        rep->state.nopath_received = 1;
+        rpl_set_route_lifetime(rep, DAO_EXPIRATION_TIMEOUT);
+      }
+      continue;
+    }
+
+    if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+      /* Check whether this is a DAO forwarding loop. */
+      p = rpl_find_parent(dag, sender);
+      /* check if this is a new DAO registration with an "illegal" rank */
+      /* if we already route to this node it is likely */
+      if(p != NULL &&
+         DAG_RANK(p->rank, instance) < DAG_RANK(dag->rank, instance)) {
+        PRINTF("RPL: Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
+            DAG_RANK(p->rank, instance), DAG_RANK(dag->rank, instance));
+        p->rank = INFINITE_RANK;
+        rpl_parent_updated(p, RPL_PARENT_UPDATED_RANK);
+        return -1;
+      }
+
+      /* If we get the DAO from our parent, we also have a loop. */
+      if(p != NULL && p == dag->preferred_parent) {
+        PRINTF("RPL: Loop detected when receiving a unicast DAO from our parent\n");
+        p->rank = INFINITE_RANK;
+        rpl_parent_updated(p, RPL_PARENT_UPDATED_RANK);
+        return -1;
+      }
+    }
+
+    PRINTF("RPL: adding DAO route\n");
+    rep = rpl_add_route(dag, &prefix, prefixlen, sender);
+    if(rep == NULL) {
+      RPL_STAT(rpl_stats.mem_overflows++);
+      PRINTF("RPL: Could not add a route after receiving a DAO\n");
+      return -1;
+    }
+
+    rpl_set_route_lifetime(rep, RPL_LIFETIME(instance, lifetime));
+    rep->state.learned_from = learned_from;
+
+    if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+#if RPL_DAO_AGGREGATION
+      /* The root has no parent to send an aggregated DAO to. */
+      if(dag->rank == ROOT_RANK(instance) ||
+         !dao_aggregate(instance, &prefix, prefixlen, lifetime)) {
+        forward = 1;
+      }
+#else /* RPL_DAO_AGGREGATION */
+      forward = 1;
+#endif /* RPL_DAO_AGGREGATION */
+    }
+  }
+  return forward;
+}
+/*---------------------------------------------------------------------------*/
 static void
 dao_input(void)
 {
@@ -572,23 +892,24 @@ dao_input(void)
   uint16_t sequence;
   uint8_t instance_id;
   uint8_t lifetime;
-  uint8_t prefixlen;
   uint8_t flags;
   uint8_t subopt_type;
   /*
   uint8_t pathcontrol;
   uint8_t pathsequence;
   */
-  uip_ipaddr_t prefix;
-  uip_ds6_route_t *rep;
+#if RPL_WITH_NON_STORING
+  uip_ipaddr_t parent_addr;
+#endif /* RPL_WITH_NON_STORING */
+  uip_ipaddr_t *parent;
   uint8_t buffer_length;
+  int first_target;
+  int forward;
   int pos;
   int len;
   int i;
+  int r;
   int learned_from;
-  rpl_parent_t *p;
-
-  prefixlen = 0;
 
   uip_ipaddr_copy(&dao_sender_addr, &UIP_IP_BUF->srcipaddr);
 
@@ -610,8 +931,6 @@ dao_input(void)
     return;
   }
 
-  lifetime = instance->default_lifetime;
-
   flags = buffer[pos++];
   /* reserved */
   pos++;
@@ -629,7 +948,24 @@ dao_input(void)
     /* Perhaps, there are verification to do but ... */
   }
 
-  /* Check if there are any RPL options present. */
+#if RPL_WITH_NON_STORING
+  if(dag->rank != ROOT_RANK(instance)) {
+    PRINTF("RPL: Ignoring a non-storing DAO as we are not the root\n");
+    return;
+  }
+#endif /* RPL_WITH_NON_STORING */
+
+  learned_from = uip_is_addr_mcast(&dao_sender_addr) ?
+                 RPL_ROUTE_FROM_MULTICAST_DAO : RPL_ROUTE_FROM_UNICAST_DAO;
+
+  PRINTF("RPL: DAO from %s\n",
+         learned_from == RPL_ROUTE_FROM_UNICAST_DAO? "unicast": "multicast");
+
+  /* Each transit option applies to the target options before it. A
+     DAO may carry several groups of them. */
+  first_target = 0;
+  forward = 0;
+  parent = NULL;
   for(i = pos; i < buffer_length; i += len) {
     subopt_type = buffer[i];
     if(subopt_type == RPL_OPTION_PAD1) {
@@ -641,96 +977,69 @@ dao_input(void)
 
     switch(subopt_type) {
     case RPL_OPTION_TARGET:
-      /* Handle the target option. */
-      prefixlen = buffer[i + 3];
-      memset(&prefix, 0, sizeof(prefix));
-      memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
+      if(first_target == 0) {
+        first_target = i;
+      }
       break;
     case RPL_OPTION_TRANSIT:
       /* The path sequence and control are ignored. */
       /*      pathcontrol = buffer[i + 3];
               pathsequence = buffer[i + 4];*/
       lifetime = buffer[i + 5];
+#if RPL_WITH_NON_STORING
+      if(buffer[i + 1] >= 4 + sizeof(parent_addr)) {
+        memcpy(&parent_addr, buffer + i + 6, sizeof(parent_addr));
+        parent = &parent_addr;
+      }
+#else /* RPL_WITH_NON_STORING */
       /* The parent address is also ignored. */
+#endif /* RPL_WITH_NON_STORING */
+      if(first_target > 0) {
+        r = dao_input_targets(instance, &dao_sender_addr, learned_from,
+                              buffer, first_target, i, lifetime, parent);
+        if(r < 0) {
+          return;
+        }
+        forward |= r;
+        first_target = 0;
+      }
+      parent = NULL;
       break;
     }
   }
-
-  PRINTF("RPL: DAO lifetime: %u, prefix length: %u prefix: ",
-          (unsigned)lifetime, (unsigned)prefixlen);
-  PRINT6ADDR(&prefix);
-  PRINTF("\n");
-
-  rep = uip_ds6_route_lookup(&prefix);
-
-  if(lifetime == RPL_ZERO_LIFETIME) {
-    PRINTF("RPL: No-Path DAO received\n");
-    /* No-Path DAO received; invoke the route purging routine. */
-    if(rep != NULL &&
-       rep->state.nopath_received == 0 &&
-       rep->length == prefixlen &&
-       uip_ds6_route_nexthop(rep) != NULL &&
-       uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &dao_sender_addr)) {
-      PRINTF("RPL: Setting expiration timer for prefix ");
-      PRINT6ADDR(&prefix);
-      PRINTF("\n");
-      rep->state.nopath_received = 1;
-      rep->state.lifetime = DAO_EXPIRATION_TIMEOUT;
-    }
-    return;
-  }
-
-  learned_from = uip_is_addr_mcast(&dao_sender_addr) ?
-                 RPL_ROUTE_FROM_MULTICAST_DAO : RPL_ROUTE_FROM_UNICAST_DAO;
-
-  PRINTF("RPL: DAO from %s\n",
-         learned_from == RPL_ROUTE_FROM_UNICAST_DAO? "unicast": "multicast");
-  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    /* Check whether this is a DAO forwarding loop. */
-    p = rpl_find_parent(dag, &dao_sender_addr);
-    /* check if this is a new DAO registration with an "illegal" rank */
-    /* if we already route to this node it is likely */
-    if(p != NULL &&
-       DAG_RANK(p->rank, instance) < DAG_RANK(dag->rank, instance)) {
-      PRINTF("RPL: Loop detected when receiving a unicast DAO from a node with a lower rank! (%u < %u)\n",
-          DAG_RANK(p->rank, instance), DAG_RANK(dag->rank, instance));
-      p->rank = INFINITE_RANK;
-      p->updated = 1;
-      return;
-    }
-
-    /* If we get the DAO from our parent, we also have a loop. */
-    if(p != NULL && p == dag->preferred_parent) {
-      PRINTF("RPL: Loop detected when receiving a unicast DAO from our parent\n");
-      p->rank = INFINITE_RANK;
-      p->updated = 1;
+  if(first_target > 0) {
+    r = dao_input_targets(instance, &dao_sender_addr, learned_from,
+                          buffer, first_target, buffer_length,
+                          instance->default_lifetime, NULL);
+    if(r < 0) {
       return;
     }
+    forward |= r;
   }
 
-  PRINTF("RPL: adding DAO route\n");
-  rep = rpl_add_route(dag, &prefix, prefixlen, &dao_sender_addr);
-  if(rep == NULL) {
-    RPL_STAT(rpl_stats.mem_overflows++);
-    PRINTF("RPL: Could not add a route after receiving a DAO\n");
+  if(learned_from != RPL_ROUTE_FROM_UNICAST_DAO) {
     return;
   }
 
-  rep->state.lifetime = RPL_LIFETIME(instance, lifetime);
-  rep->state.learned_from = learned_from;
-
-  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    if(dag->preferred_parent != NULL &&
-       rpl_get_parent_ipaddr(dag->preferred_parent) != NULL) {
-      PRINTF("RPL: Forwarding DAO to parent ");
-      PRINT6ADDR(rpl_get_parent_ipaddr(dag->preferred_parent));
-      PRINTF("\n");
-      uip_icmp6_send(rpl_get_parent_ipaddr(dag->preferred_parent),
-                     ICMP6_RPL, RPL_CODE_DAO, buffer_length);
-    }
-    if(flags & RPL_DAO_K_FLAG) {
-      dao_ack_output(instance, &dao_sender_addr, sequence);
-    }
+  /* Targets that could not be aggregated are forwarded in the DAO we
+     received. */
+  if(forward &&
+     dag->preferred_parent != NULL &&
+     rpl_get_parent_ipaddr(dag->preferred_parent) != NULL) {
+    PRINTF("RPL: Forwarding DAO to parent ");
+    PRINT6ADDR(rpl_get_parent_ipaddr(dag->preferred_parent));
+    PRINTF("\n");
+    uip_icmp6_send(rpl_get_parent_ipaddr(dag->preferred_parent),
+                   ICMP6_RPL, RPL_CODE_DAO, buffer_length);
+  }
+#if RPL_DAO_AGGREGATION
+  if(dao_target_count == RPL_DAO_AGGREGATION_MAX && !DAO_BATCH_PENDING()) {
+    /* No more targets fit, so there is no point in waiting. */
+    dao_aggregation_send(NULL);
+  }
+#endif /* RPL_DAO_AGGREGATION */
+  if(flags & RPL_DAO_K_FLAG) {
+    dao_ack_output(instance, &dao_sender_addr, sequence);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -755,7 +1064,10 @@ dao_output_target(rpl_parent_t *parent, uip_ipaddr_t *prefix, uint8_t lifetime)
   rpl_dag_t *dag;
   rpl_instance_t *instance;
   unsigned char *buffer;
-  uint8_t prefixlen;
+  uip_ipaddr_t *dest;
+#if RPL_WITH_NON_STORING
+  uip_ipaddr_t parent_addr;
+#endif /* RPL_WITH_NON_STORING */
   int pos;
 
   /* Destination Advertisement Object */
@@ -785,59 +1097,51 @@ dao_output_target(rpl_parent_t *parent, uip_ipaddr_t *prefix, uint8_t lifetime)
   RPL_DEBUG_DAO_OUTPUT(parent);
 #endif
 
+#if RPL_WITH_NON_STORING
+  /* The DAO goes to the root, and the parent is named in the transit
+     option. */
+  if(rpl_get_parent_ipaddr(parent) == NULL) {
+    PRINTF("RPL dao_output_target error parent address NULL\n");
+    return;
+  }
+  dest = &dag->dag_id;
+#else /* RPL_WITH_NON_STORING */
+  dest = rpl_get_parent_ipaddr(parent);
+#endif /* RPL_WITH_NON_STORING */
+
   buffer = UIP_ICMP_PAYLOAD;
 
-  RPL_LOLLIPOP_INCREMENT(dao_sequence);
-  pos = 0;
-
-  buffer[pos++] = instance->instance_id;
-  buffer[pos] = 0;
-#if RPL_DAO_SPECIFY_DAG
-  buffer[pos] |= RPL_DAO_D_FLAG;
-#endif /* RPL_DAO_SPECIFY_DAG */
-#if RPL_CONF_DAO_ACK
-  buffer[pos] |= RPL_DAO_K_FLAG;
-#endif /* RPL_CONF_DAO_ACK */
-  ++pos;
-  buffer[pos++] = 0; /* reserved */
-  buffer[pos++] = dao_sequence;
-#if RPL_DAO_SPECIFY_DAG
-  memcpy(buffer + pos, &dag->dag_id, sizeof(dag->dag_id));
-  pos+=sizeof(dag->dag_id);
-#endif /* RPL_DAO_SPECIFY_DAG */
+  pos = dao_header(buffer, dag);
 
   /* create target subopt */
-  prefixlen = sizeof(*prefix) * CHAR_BIT;
-  buffer[pos++] = RPL_OPTION_TARGET;
-  buffer[pos++] = 2 + ((prefixlen + 7) / CHAR_BIT);
-  buffer[pos++] = 0; /* reserved */
-  buffer[pos++] = prefixlen;
-  memcpy(buffer + pos, prefix, (prefixlen + 7) / CHAR_BIT);
-  pos += ((prefixlen + 7) / CHAR_BIT);
+  pos = dao_target_option(buffer, pos, prefix, sizeof(*prefix) * CHAR_BIT);
 
   /* Create a transit information sub-option. */
-  buffer[pos++] = RPL_OPTION_TRANSIT;
-  buffer[pos++] = 4;
-  buffer[pos++] = 0; /* flags - ignored */
-  buffer[pos++] = 0; /* path control - ignored */
-  buffer[pos++] = 0; /* path seq - ignored */
-  buffer[pos++] = lifetime;
+#if RPL_WITH_NON_STORING
+  /* The global address of the parent is the DAG prefix followed by
+     the interface identifier of its link-local address. */
+  memcpy(&parent_addr, &dag->dag_id, 8);
+  memcpy(&parent_addr.u8[8], &rpl_get_parent_ipaddr(parent)->u8[8], 8);
+  pos = dao_transit_option(buffer, pos, lifetime, &parent_addr);
+#else /* RPL_WITH_NON_STORING */
+  pos = dao_transit_option(buffer, pos, lifetime, NULL);
+#endif /* RPL_WITH_NON_STORING */
 
   PRINTF("RPL: Sending DAO with prefix ");
   PRINT6ADDR(prefix);
   PRINTF(" to ");
-  PRINT6ADDR(rpl_get_parent_ipaddr(parent));
+  PRINT6ADDR(dest);
   PRINTF("\n");
 
-  if(rpl_get_parent_ipaddr(parent) != NULL) {
-    uip_icmp6_send(rpl_get_parent_ipaddr(parent), ICMP6_RPL, RPL_CODE_DAO, pos);
+  if(dest != NULL) {
+    uip_icmp6_send(dest, ICMP6_RPL, RPL_CODE_DAO, pos);
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
 dao_ack_input(void)
 {
-#if DEBUG
+#if DEBUG || (RPL_DAO_AGGREGATION && RPL_CONF_DAO_ACK)
   unsigned char *buffer;
   uint8_t buffer_length;
   uint8_t instance_id;
@@ -855,7 +1159,25 @@ dao_ack_input(void)
     sequence, status);
   PRINT6ADDR(&UIP_IP_BUF->srcipaddr);
   PRINTF("\n");
-#endif /* DEBUG */
+
+#if RPL_DAO_AGGREGATION && RPL_CONF_DAO_ACK
+  /* The ACK confirms all the targets in the aggregated DAO. */
+  if(dao_batch_count > 0 && sequence == dao_batch_sequence &&
+     buffer_length >= 4 && status < 128 &&
+     instance_id == dao_target_instance->instance_id) {
+    dao_target_count -= dao_batch_count;
+    memmove(dao_targets, &dao_targets[dao_batch_count],
+            dao_target_count * sizeof(dao_targets[0]));
+    dao_batch_count = 0;
+    dao_batch_transmissions = 0;
+    ctimer_stop(&dao_aggregation_timer);
+    if(dao_target_count > 0) {
+      ctimer_set(&dao_aggregation_timer, RPL_DAO_AGGREGATION_DELAY,
+                 dao_aggregation_send, NULL);
+    }
+  }
+#endif /* RPL_DAO_AGGREGATION && RPL_CONF_DAO_ACK */
+#endif /* DEBUG || (RPL_DAO_AGGREGATION && RPL_CONF_DAO_ACK) */
 }
 /*---------------------------------------------------------------------------*/
 void
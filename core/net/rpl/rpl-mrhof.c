@@ -38,14 +38,19 @@
  *         The Minimum Rank with Hysteresis Objective Function (MRHOF)
  *
  *         This implementation uses the estimated number of 
- *         transmissions (ETX) as the additive routing metric,
- *         and also provides stubs for the energy metric.
+ *         transmissions (ETX) as the additive routing metric.
+ *         With the energy metric, parents are also ranked by the
+ *         remaining energy advertised on their path to the root.
  *
  * \author Joakim Eriksson <joakime@sics.se>, Nicolas Tsiftes <nvt@sics.se>
  */
 
 #include "net/rpl/rpl-private.h"
 #include "net/nbr-table.h"
+#include "net/link-stats.h"
+#if RPL_DAG_MC == RPL_DAG_MC_ENERGY
+#include "sys/energest.h"
+#endif /* RPL_DAG_MC == RPL_DAG_MC_ENERGY */
 
 #define DEBUG DEBUG_NONE
 #include "net/uip-debug.h"
@@ -67,13 +72,6 @@ rpl_of_t rpl_mrhof = {
   1
 };
 
-/* Constants for the ETX moving average */
-#define ETX_SCALE   100
-#define ETX_ALPHA   90
-
-/* Reject parents that have a higher link metric than the following. */
-#define MAX_LINK_METRIC			10
-
 /* Reject parents that have a higher path cost than the following. */
 #define MAX_PATH_COST			100
 
@@ -85,6 +83,74 @@ rpl_of_t rpl_mrhof = {
 
 typedef uint16_t rpl_path_metric_t;
 
+#if RPL_DAG_MC == RPL_DAG_MC_ENERGY
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/*
+ * With the energy metric, the cost of a path whose weakest node has
+ * no energy left is RPL_MRHOF_ENERGY_WEIGHT transmissions more than
+ * that of a mains-powered path with the same ETX.
+ */
+#ifdef RPL_MRHOF_CONF_ENERGY_WEIGHT
+#define RPL_MRHOF_ENERGY_WEIGHT RPL_MRHOF_CONF_ENERGY_WEIGHT
+#else
+#define RPL_MRHOF_ENERGY_WEIGHT 5
+#endif /* RPL_MRHOF_CONF_ENERGY_WEIGHT */
+
+/*
+ * The remaining battery energy of this node, in percent. Platforms
+ * with a calibrated battery sensor can map its reading here.
+ */
+#ifdef RPL_MRHOF_CONF_ENERGY_LEVEL
+#define RPL_MRHOF_ENERGY_LEVEL() RPL_MRHOF_CONF_ENERGY_LEVEL()
+#else
+#define RPL_MRHOF_ENERGY_LEVEL() 100
+#endif /* RPL_MRHOF_CONF_ENERGY_LEVEL */
+
+/* The radio-on fraction of this node in percent, averaged over the
+   intervals between metric container updates. */
+static uint8_t radio_load;
+
+static rpl_path_metric_t
+energy_cost(rpl_metric_container_t *mc)
+{
+  uint8_t energy;
+
+  if(((mc->obj.energy.flags >> RPL_DAG_MC_ENERGY_TYPE) & 3) ==
+     RPL_DAG_MC_ENERGY_TYPE_MAINS) {
+    return 0;
+  }
+  energy = MIN(mc->obj.energy.energy_est, 100);
+  return (uint32_t)(100 - energy) * RPL_MRHOF_ENERGY_WEIGHT *
+    RPL_DAG_MC_ETX_DIVISOR / 100;
+}
+
+/* Estimate the energy that this node has left for forwarding, from
+   its battery level and how much energest has seen the radio on. */
+static uint8_t
+node_energy(void)
+{
+#if ENERGEST_CONF_ON
+  static unsigned long last_radio, last_total;
+  unsigned long radio, total;
+  uint8_t load;
+
+  radio = energest_type_time(ENERGEST_TYPE_LISTEN) +
+    energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  total = energest_type_time(ENERGEST_TYPE_CPU) +
+    energest_type_time(ENERGEST_TYPE_LPM);
+  if(total - last_total >= RTIMER_ARCH_SECOND) {
+    load = MIN((radio - last_radio) / ((total - last_total) / 100), 100);
+    radio_load = (3 * radio_load + load) / 4;
+    last_radio = radio;
+    last_total = total;
+  }
+#endif /* ENERGEST_CONF_ON */
+
+  return (uint16_t)RPL_MRHOF_ENERGY_LEVEL() * (100 - radio_load) / 100;
+}
+#endif /* RPL_DAG_MC == RPL_DAG_MC_ENERGY */
+
 static rpl_path_metric_t
 calculate_path_metric(rpl_parent_t *p)
 {
@@ -97,7 +163,9 @@ calculate_path_metric(rpl_parent_t *p)
 #elif RPL_DAG_MC == RPL_DAG_MC_ETX
   return p->mc.obj.etx + (uint16_t)p->link_metric;
 #elif RPL_DAG_MC == RPL_DAG_MC_ENERGY
-  return p->mc.obj.energy.energy_est + (uint16_t)p->link_metric;
+  /* The rank carries the ETX, and the energy only adds to the cost of
+     the path, so that it does not affect loop avoidance. */
+  return p->rank + (uint16_t)p->link_metric + energy_cost(&p->mc);
 #else
 #error "Unsupported RPL_DAG_MC configured. See rpl.h."
 #endif /* RPL_DAG_MC */
@@ -112,24 +180,17 @@ reset(rpl_dag_t *sag)
 static void
 neighbor_link_callback(rpl_parent_t *p, int status, int numtx)
 {
-  uint16_t recorded_etx = p->link_metric;
-  uint16_t packet_etx = numtx * RPL_DAG_MC_ETX_DIVISOR;
-  uint16_t new_etx;
-
-  /* Do not penalize the ETX when collisions or transmission errors occur. */
-  if(status == MAC_TX_OK || status == MAC_TX_NOACK) {
-    if(status == MAC_TX_NOACK) {
-      packet_etx = MAX_LINK_METRIC * RPL_DAG_MC_ETX_DIVISOR;
-    }
-
-    new_etx = ((uint32_t)recorded_etx * ETX_ALPHA +
-               (uint32_t)packet_etx * (ETX_SCALE - ETX_ALPHA)) / ETX_SCALE;
-
-    PRINTF("RPL: ETX changed from %u to %u (packet ETX = %u)\n",
-        (unsigned)(recorded_etx / RPL_DAG_MC_ETX_DIVISOR),
-        (unsigned)(new_etx  / RPL_DAG_MC_ETX_DIVISOR),
-        (unsigned)(packet_etx / RPL_DAG_MC_ETX_DIVISOR));
-    p->link_metric = new_etx;
+  const struct link_stats *stats;
+
+  /* The ETX is estimated by the link-stats module, which has already
+     been updated with this transmission. */
+  stats = link_stats_from_lladdr(rpl_get_parent_lladdr(p));
+  if(stats != NULL && stats->etx != 0) {
+    PRINTF("RPL: ETX changed from %u to %u\n",
+        (unsigned)(p->link_metric / RPL_DAG_MC_ETX_DIVISOR),
+        (unsigned)(stats->etx / RPL_DAG_MC_ETX_DIVISOR));
+    p->link_metric = (uint32_t)stats->etx * RPL_DAG_MC_ETX_DIVISOR /
+                     LINK_STATS_ETX_DIVISOR;
   }
 }
 
@@ -218,15 +279,22 @@ update_metric_container(rpl_instance_t *instance)
 static void
 update_metric_container(rpl_instance_t *instance)
 {
-  rpl_path_metric_t path_metric;
   rpl_dag_t *dag;
-#if RPL_DAG_MC == RPL_DAG_MC_ENERGY
+#if RPL_DAG_MC == RPL_DAG_MC_ETX
+  rpl_path_metric_t path_metric;
+#elif RPL_DAG_MC == RPL_DAG_MC_ENERGY
   uint8_t type;
+  uint8_t energy;
 #endif
 
   instance->mc.type = RPL_DAG_MC;
   instance->mc.flags = RPL_DAG_MC_FLAG_P;
+#if RPL_DAG_MC == RPL_DAG_MC_ENERGY
+  /* The path advertises the energy of its weakest node. */
+  instance->mc.aggr = RPL_DAG_MC_AGGR_MINIMUM;
+#else
   instance->mc.aggr = RPL_DAG_MC_AGGR_ADDITIVE;
+#endif /* RPL_DAG_MC == RPL_DAG_MC_ENERGY */
   instance->mc.prec = 0;
 
   dag = instance->current_dag;
@@ -236,13 +304,13 @@ update_metric_container(rpl_instance_t *instance)
     return;
   }
 
+#if RPL_DAG_MC == RPL_DAG_MC_ETX
   if(dag->rank == ROOT_RANK(instance)) {
     path_metric = 0;
   } else {
     path_metric = calculate_path_metric(dag->preferred_parent);
   }
 
-#if RPL_DAG_MC == RPL_DAG_MC_ETX
   instance->mc.length = sizeof(instance->mc.obj.etx);
   instance->mc.obj.etx = path_metric;
 
@@ -255,12 +323,23 @@ update_metric_container(rpl_instance_t *instance)
 
   if(dag->rank == ROOT_RANK(instance)) {
     type = RPL_DAG_MC_ENERGY_TYPE_MAINS;
+    energy = 100;
   } else {
     type = RPL_DAG_MC_ENERGY_TYPE_BATTERY;
+    energy = node_energy();
+    if(dag->preferred_parent != NULL &&
+       ((dag->preferred_parent->mc.obj.energy.flags >>
+         RPL_DAG_MC_ENERGY_TYPE) & 3) != RPL_DAG_MC_ENERGY_TYPE_MAINS) {
+      energy = MIN(energy, dag->preferred_parent->mc.obj.energy.energy_est);
+    }
   }
 
-  instance->mc.obj.energy.flags = type << RPL_DAG_MC_ENERGY_TYPE;
-  instance->mc.obj.energy.energy_est = path_metric;
+  instance->mc.obj.energy.flags = type << RPL_DAG_MC_ENERGY_TYPE |
+    1 << RPL_DAG_MC_ENERGY_ESTIMATION;
+  instance->mc.obj.energy.energy_est = energy;
+
+  PRINTF("RPL: My path energy is %u%%, radio load %u%%\n",
+         energy, radio_load);
 #endif /* RPL_DAG_MC == RPL_DAG_MC_ETX */
 }
 #endif /* RPL_DAG_MC == RPL_DAG_MC_NONE */
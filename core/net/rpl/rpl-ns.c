@@ -0,0 +1,249 @@
+/**
+ * \addtogroup uip6
+ * @{
+ */
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+/**
+ * \file
+ *         Child-parent links kept by the DAG root in RPL non-storing
+ *         mode.
+ */
+
+#include "net/uip.h"
+#include "net/rpl/rpl-private.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+#include <string.h>
+
+#if UIP_CONF_IPV6 && RPL_WITH_NON_STORING
+/*---------------------------------------------------------------------------*/
+/* A node and the DAO parent it last announced. The DAG root has an
+   entry of its own, which has no parent and never expires. A node
+   whose parent is unknown has no parent either until its next DAO. */
+struct rpl_ns_node {
+  struct rpl_ns_node *next;
+  struct rpl_ns_node *parent;
+  rpl_dag_t *dag;
+  uint32_t lifetime;
+  uip_ipaddr_t addr;
+};
+typedef struct rpl_ns_node rpl_ns_node_t;
+
+#define INFINITE_LIFETIME 0xffffffff
+
+LIST(nodelist);
+MEMB(nodememb, rpl_ns_node_t, RPL_NS_LINK_NUM);
+/*---------------------------------------------------------------------------*/
+static rpl_ns_node_t *
+get_node(rpl_dag_t *dag, uip_ipaddr_t *addr)
+{
+  rpl_ns_node_t *n;
+
+  for(n = list_head(nodelist); n != NULL; n = list_item_next(n)) {
+    if(n->dag == dag && uip_ipaddr_cmp(&n->addr, addr)) {
+      return n;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_ns_node_t *
+add_node(rpl_dag_t *dag, uip_ipaddr_t *addr, uint32_t lifetime)
+{
+  rpl_ns_node_t *n;
+
+  n = memb_alloc(&nodememb);
+  if(n == NULL) {
+    RPL_STAT(rpl_stats.mem_overflows++);
+    PRINTF("RPL: No room for non-storing link to ");
+    PRINT6ADDR(addr);
+    PRINTF("\n");
+    return NULL;
+  }
+  n->parent = NULL;
+  n->dag = dag;
+  n->lifetime = lifetime;
+  uip_ipaddr_copy(&n->addr, addr);
+  list_add(nodelist, n);
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_node(rpl_ns_node_t *node)
+{
+  rpl_ns_node_t *n;
+
+  /* The children of the node are unreachable until they send new
+     DAOs. */
+  for(n = list_head(nodelist); n != NULL; n = list_item_next(n)) {
+    if(n->parent == node) {
+      n->parent = NULL;
+    }
+  }
+  list_remove(nodelist, node);
+  memb_free(&nodememb, node);
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_init(void)
+{
+  list_init(nodelist);
+  memb_init(&nodememb);
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_ns_update_node(rpl_dag_t *dag, uip_ipaddr_t *child,
+                   uip_ipaddr_t *parent, uint32_t lifetime)
+{
+  rpl_ns_node_t *c;
+  rpl_ns_node_t *p;
+
+  if(uip_ipaddr_cmp(child, parent) || uip_ipaddr_cmp(child, &dag->dag_id)) {
+    PRINTF("RPL: Ignoring a non-storing link from ");
+    PRINT6ADDR(child);
+    PRINTF("\n");
+    return 0;
+  }
+
+  p = get_node(dag, parent);
+  if(p == NULL) {
+    /* Until the parent sends a DAO of its own, it lives as long as
+       the link to its child. */
+    p = add_node(dag, parent, uip_ipaddr_cmp(parent, &dag->dag_id) ?
+                 INFINITE_LIFETIME : lifetime);
+    if(p == NULL) {
+      return 0;
+    }
+  }
+
+  c = get_node(dag, child);
+  if(c == NULL) {
+    c = add_node(dag, child, lifetime);
+    if(c == NULL) {
+      return 0;
+    }
+  }
+  c->parent = p;
+  c->lifetime = lifetime;
+
+  PRINTF("RPL: Non-storing link ");
+  PRINT6ADDR(child);
+  PRINTF(" -> ");
+  PRINT6ADDR(parent);
+  PRINTF(", lifetime %lu\n", (unsigned long)lifetime);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_expire_parent(rpl_dag_t *dag, uip_ipaddr_t *child)
+{
+  rpl_ns_node_t *n;
+
+  /* The node itself is kept for a while, so that its children are
+     reachable again as soon as it announces a new parent. */
+  n = get_node(dag, child);
+  if(n != NULL) {
+    n->parent = NULL;
+    if(n->lifetime > DAO_EXPIRATION_TIMEOUT) {
+      n->lifetime = DAO_EXPIRATION_TIMEOUT;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_ns_get_path(rpl_dag_t *dag, uip_ipaddr_t *addr,
+                uip_ipaddr_t **path, int max)
+{
+  rpl_ns_node_t *n;
+  int len;
+
+  /* Follow the parents from the destination up to the root. A path
+     longer than max is either too long to use or a loop. */
+  len = 0;
+  for(n = get_node(dag, addr); n != NULL; n = n->parent) {
+    if(uip_ipaddr_cmp(&n->addr, &dag->dag_id)) {
+      return len;
+    }
+    if(len == max) {
+      break;
+    }
+    path[len++] = &n->addr;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_remove_dag(rpl_dag_t *dag)
+{
+  rpl_ns_node_t *n;
+
+  n = list_head(nodelist);
+  while(n != NULL) {
+    if(n->dag == dag) {
+      remove_node(n);
+      n = list_head(nodelist);
+    } else {
+      n = list_item_next(n);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_periodic(void)
+{
+  rpl_ns_node_t *n;
+
+  for(n = list_head(nodelist); n != NULL; n = list_item_next(n)) {
+    if(n->lifetime != INFINITE_LIFETIME && n->lifetime > 0) {
+      n->lifetime--;
+    }
+  }
+
+  n = list_head(nodelist);
+  while(n != NULL) {
+    if(n->lifetime == 0) {
+      PRINTF("RPL: Non-storing link from ");
+      PRINT6ADDR(&n->addr);
+      PRINTF(" expired\n");
+      remove_node(n);
+      n = list_head(nodelist);
+    } else {
+      n = list_item_next(n);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_CONF_IPV6 && RPL_WITH_NON_STORING */
@@ -99,6 +99,10 @@
 #define RPL_HDR_OPT_RANK_ERR_SHIFT   	6
 #define RPL_HDR_OPT_FWD_ERR		0x20
 #define RPL_HDR_OPT_FWD_ERR_SHIFT   	5
+
+/* RPL source routing header (RFC 6554). */
+#define RPL_RH_TYPE_SRH                 3
+#define RPL_SRH_LEN                     8
 /*---------------------------------------------------------------------------*/
 /* Default values for RPL constants and variables. */
 
@@ -109,6 +113,35 @@
 #define RPL_DAO_LATENCY                 (CLOCK_SECOND * 4)
 #endif /* RPL_DAO_LATENCY */
 
+/* With RPL_CONF_DAO_AGGREGATION in storing mode, routers collect
+   the targets of the DAOs they receive for RPL_DAO_AGGREGATION_DELAY
+   and forward them to their preferred parent in one DAO of at most
+   RPL_DAO_AGGREGATION_MAX targets, which should fit in the link MTU.
+   Off by default, so each DAO is forwarded as it arrives. */
+#ifdef RPL_CONF_DAO_AGGREGATION
+#define RPL_DAO_AGGREGATION             (RPL_CONF_DAO_AGGREGATION && !RPL_WITH_NON_STORING)
+#else /* RPL_CONF_DAO_AGGREGATION */
+#define RPL_DAO_AGGREGATION             0
+#endif /* RPL_CONF_DAO_AGGREGATION */
+
+#ifdef RPL_CONF_DAO_AGGREGATION_DELAY
+#define RPL_DAO_AGGREGATION_DELAY       RPL_CONF_DAO_AGGREGATION_DELAY
+#else /* RPL_CONF_DAO_AGGREGATION_DELAY */
+#define RPL_DAO_AGGREGATION_DELAY       (CLOCK_SECOND / 2)
+#endif /* RPL_CONF_DAO_AGGREGATION_DELAY */
+
+#ifdef RPL_CONF_DAO_AGGREGATION_MAX
+#define RPL_DAO_AGGREGATION_MAX         RPL_CONF_DAO_AGGREGATION_MAX
+#else /* RPL_CONF_DAO_AGGREGATION_MAX */
+#define RPL_DAO_AGGREGATION_MAX         4
+#endif /* RPL_CONF_DAO_AGGREGATION_MAX */
+
+/* With RPL_CONF_DAO_ACK, an aggregated DAO that is not acknowledged
+   within RPL_DAO_ACK_TIMEOUT is sent again, up to
+   RPL_DAO_MAX_TRANSMISSIONS times in all. */
+#define RPL_DAO_ACK_TIMEOUT             (CLOCK_SECOND * 2)
+#define RPL_DAO_MAX_TRANSMISSIONS       3
+
 /* Special value indicating immediate removal. */
 #define RPL_ZERO_LIFETIME               0
 
@@ -169,18 +202,6 @@
 #define RPL_ROUTE_FROM_MULTICAST_DAO    2
 #define RPL_ROUTE_FROM_DIO              3
 
-/* DAG Mode of Operation */
-#define RPL_MOP_NO_DOWNWARD_ROUTES      0
-#define RPL_MOP_NON_STORING             1
-#define RPL_MOP_STORING_NO_MULTICAST    2
-#define RPL_MOP_STORING_MULTICAST       3
-
-#ifdef  RPL_CONF_MOP
-#define RPL_MOP_DEFAULT                 RPL_CONF_MOP
-#else
-#define RPL_MOP_DEFAULT                 RPL_MOP_STORING_NO_MULTICAST
-#endif
-
 /*
  * The ETX in the metric container is expressed as a fixed-point value 
  * whose integer part can be obtained by dividing the value by 
@@ -248,6 +269,7 @@ struct rpl_stats {
   uint16_t malformed_msgs;
   uint16_t resets;
   uint16_t parent_switch;
+  uint16_t backup_switch;
 };
 typedef struct rpl_stats rpl_stats_t;
 
@@ -297,12 +319,30 @@ rpl_parent_t *rpl_select_parent(rpl_dag_t *dag);
 rpl_dag_t *rpl_select_dag(rpl_instance_t *instance,rpl_parent_t *parent);
 void rpl_recalculate_ranks(void);
 
+/* The reasons for rpl_recalculate_ranks() to process a parent again. */
+#define RPL_PARENT_UPDATED_METRIC 1
+#define RPL_PARENT_UPDATED_RANK   2
+void rpl_parent_updated(rpl_parent_t *parent, uint8_t reason);
+
 /* RPL routing table functions. */
 void rpl_remove_routes(rpl_dag_t *dag);
 void rpl_remove_routes_by_nexthop(uip_ipaddr_t *nexthop, rpl_dag_t *dag);
 uip_ds6_route_t *rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix,
                                int prefix_len, uip_ipaddr_t *next_hop);
 void rpl_purge_routes(void);
+void rpl_set_route_lifetime(uip_ds6_route_t *r, uint32_t lifetime);
+
+#if RPL_WITH_NON_STORING
+/* Non-storing mode link table, used by the DAG root. */
+void rpl_ns_init(void);
+int rpl_ns_update_node(rpl_dag_t *dag, uip_ipaddr_t *child,
+                       uip_ipaddr_t *parent, uint32_t lifetime);
+void rpl_ns_expire_parent(rpl_dag_t *dag, uip_ipaddr_t *child);
+int rpl_ns_get_path(rpl_dag_t *dag, uip_ipaddr_t *addr,
+                    uip_ipaddr_t **path, int max);
+void rpl_ns_remove_dag(rpl_dag_t *dag);
+void rpl_ns_periodic(void);
+#endif /* RPL_WITH_NON_STORING */
 
 /* Objective function. */
 rpl_of_t *rpl_find_of(rpl_ocp_t);
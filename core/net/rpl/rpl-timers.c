@@ -53,19 +53,24 @@
 static struct ctimer periodic_timer;
 
 static void handle_periodic_timer(void *ptr);
-static void new_dio_interval(rpl_instance_t *instance);
-static void handle_dio_timer(void *ptr);
+static void handle_dio_timer(void *ptr, uint8_t suppress);
+static void handle_dio_retry_timer(void *ptr);
 
 static uint16_t next_dis;
 
 /* dio_send_ok is true if the node is ready to send DIOs */
 static uint8_t dio_send_ok;
 
+/* Retries the DIO every second until the node is ready to send it. */
+static struct ctimer dio_retry_timer;
+
 /*---------------------------------------------------------------------------*/
 static void
 handle_periodic_timer(void *ptr)
 {
-  rpl_purge_routes();
+#if RPL_WITH_NON_STORING
+  rpl_ns_periodic();
+#endif /* RPL_WITH_NON_STORING */
   rpl_recalculate_ranks();
 
   /* handle DIS */
@@ -79,53 +84,28 @@ handle_periodic_timer(void *ptr)
   ctimer_reset(&periodic_timer);
 }
 /*---------------------------------------------------------------------------*/
-static void
-new_dio_interval(rpl_instance_t *instance)
+/* The redundancy constant to use for the next DIO, 0 meaning that
+   DIOs are never suppressed. */
+static uint8_t
+dio_redundancy(rpl_instance_t *instance)
 {
-  uint32_t time;
-  clock_time_t ticks;
-
-  /* TODO: too small timer intervals for many cases */
-  time = 1UL << instance->dio_intcurrent;
-
-  /* Convert from milliseconds to CLOCK_TICKS. */
-  ticks = (time * CLOCK_SECOND) / 1000;
-  instance->dio_next_delay = ticks;
-
-  /* random number between I/2 and I */
-  ticks = ticks / 2 + (ticks / 2 * (uint32_t)random_rand()) / RANDOM_RAND_MAX;
-
-  /*
-   * The intervals must be equally long among the nodes for Trickle to
-   * operate efficiently. Therefore we need to calculate the delay between
-   * the randomized time and the start time of the next interval.
-   */
-  instance->dio_next_delay -= ticks;
-  instance->dio_send = 1;
-
-#if RPL_CONF_STATS
-  /* keep some stats */
-  instance->dio_totint++;
-  instance->dio_totrecv += instance->dio_counter;
-  ANNOTATE("#A rank=%u.%u(%u),stats=%d %d %d %d,color=%s\n",
-	   DAG_RANK(instance->current_dag->rank, instance),
-           (10 * (instance->current_dag->rank % instance->min_hoprankinc)) / instance->min_hoprankinc,
-           instance->current_dag->version,
-           instance->dio_totint, instance->dio_totsend,
-           instance->dio_totrecv,instance->dio_intcurrent,
-	   instance->current_dag->rank == ROOT_RANK(instance) ? "BLUE" : "ORANGE");
-#endif /* RPL_CONF_STATS */
-
-  /* reset the redundancy counter */
-  instance->dio_counter = 0;
-
-  /* schedule the timer */
-  PRINTF("RPL: Scheduling DIO timer %lu ticks in future (Interval)\n", ticks);
-  ctimer_set(&instance->dio_timer, ticks, &handle_dio_timer, instance);
+#if RPL_DIO_REDUNDANCY_ADAPTIVE
+  int neighbors;
+  uint16_t k;
+
+  neighbors = uip_ds6_nbr_num();
+  if(instance->dio_redundancy != 0 &&
+     neighbors > RPL_DIO_REDUNDANCY_DENSITY) {
+    k = (uint16_t)instance->dio_redundancy * RPL_DIO_REDUNDANCY_DENSITY /
+        neighbors;
+    return k > 0 ? k : 1;
+  }
+#endif /* RPL_DIO_REDUNDANCY_ADAPTIVE */
+  return instance->dio_redundancy;
 }
 /*---------------------------------------------------------------------------*/
 static void
-handle_dio_timer(void *ptr)
+handle_dio_timer(void *ptr, uint8_t suppress)
 {
   rpl_instance_t *instance;
 
@@ -137,34 +117,46 @@ handle_dio_timer(void *ptr)
       dio_send_ok = 1;
     } else {
       PRINTF("RPL: Postponing DIO transmission since link local address is not ok\n");
-      ctimer_set(&instance->dio_timer, CLOCK_SECOND, &handle_dio_timer, instance);
+      ctimer_set(&dio_retry_timer, CLOCK_SECOND, &handle_dio_retry_timer,
+                 instance);
       return;
     }
   }
 
-  if(instance->dio_send) {
-    /* send DIO if counter is less than desired redundancy */
-    if(instance->dio_counter < instance->dio_redundancy) {
+  /* The redundancy may have changed with the neighbor density since
+     the timer module decided on suppression, so decide again. */
+  instance->dio_timer.k = dio_redundancy(instance);
+  if(TRICKLE_TIMER_PROTO_TX_ALLOW(&instance->dio_timer)) {
 #if RPL_CONF_STATS
-      instance->dio_totsend++;
+    instance->dio_totsend++;
 #endif /* RPL_CONF_STATS */
-      dio_output(instance, NULL);
-    } else {
-      PRINTF("RPL: Supressing DIO transmission (%d >= %d)\n",
-             instance->dio_counter, instance->dio_redundancy);
-    }
-    instance->dio_send = 0;
-    PRINTF("RPL: Scheduling DIO timer %lu ticks in future (sent)\n",
-           instance->dio_next_delay);
-    ctimer_set(&instance->dio_timer, instance->dio_next_delay, handle_dio_timer, instance);
+    dio_output(instance, NULL);
   } else {
-    /* check if we need to double interval */
-    if(instance->dio_intcurrent < instance->dio_intmin + instance->dio_intdoubl) {
-      instance->dio_intcurrent++;
-      PRINTF("RPL: DIO Timer interval doubled %d\n", instance->dio_intcurrent);
-    }
-    new_dio_interval(instance);
+#if RPL_CONF_STATS
+    instance->dio_totsuppress++;
+#endif /* RPL_CONF_STATS */
+    PRINTF("RPL: Supressing DIO transmission (%d >= %d)\n",
+           instance->dio_timer.c, instance->dio_timer.k);
   }
+
+#if RPL_CONF_STATS
+  /* keep some stats */
+  instance->dio_totint++;
+  instance->dio_totrecv += instance->dio_timer.c;
+  ANNOTATE("#A rank=%u.%u(%u),stats=%d %d %d %d,color=%s\n",
+	   DAG_RANK(instance->current_dag->rank, instance),
+           (10 * (instance->current_dag->rank % instance->min_hoprankinc)) / instance->min_hoprankinc,
+           instance->current_dag->version,
+           instance->dio_totint, instance->dio_totsend,
+           instance->dio_totrecv, instance->dio_totsuppress,
+	   instance->current_dag->rank == ROOT_RANK(instance) ? "BLUE" : "ORANGE");
+#endif /* RPL_CONF_STATS */
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_dio_retry_timer(void *ptr)
+{
+  handle_dio_timer(ptr, 0);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -176,18 +168,37 @@ rpl_reset_periodic_timer(void)
   ctimer_set(&periodic_timer, CLOCK_SECOND, handle_periodic_timer, NULL);
 }
 /*---------------------------------------------------------------------------*/
-/* Resets the DIO timer in the instance to its minimal interval. */
+/* Resets the DIO timer in the instance to its minimal interval, starting
+   it if it is not running. */
 void
 rpl_reset_dio_timer(rpl_instance_t *instance)
 {
 #if !RPL_LEAF_ONLY
-  /* Do not reset if we are already on the minimum interval,
-     unless forced to do so. */
-  if(instance->dio_intcurrent > instance->dio_intmin) {
-    instance->dio_counter = 0;
-    instance->dio_intcurrent = instance->dio_intmin;
-    new_dio_interval(instance);
+  clock_time_t i_min;
+  uint8_t doublings;
+
+  /* Convert from 2^n milliseconds to clock ticks. */
+  i_min = ((1UL << instance->dio_intmin) * CLOCK_SECOND) / 1000;
+  if(i_min < 2) {
+    i_min = 2;
+  }
+  /* The timer module needs at least one doubling. */
+  doublings = instance->dio_intdoubl > 0 ? instance->dio_intdoubl : 1;
+
+  /* A redundancy of 0 disables suppression, which the timer module
+     does not accept as configuration, so k is set separately. */
+  if(trickle_timer_config(&instance->dio_timer, i_min, doublings, 1) ==
+     TRICKLE_TIMER_ERROR) {
+    PRINTF("RPL: Invalid DIO interval %u\n", instance->dio_intmin);
+    return;
+  }
+  instance->dio_timer.k = dio_redundancy(instance);
+
+  if(!trickle_timer_is_running(&instance->dio_timer)) {
+    trickle_timer_set(&instance->dio_timer, handle_dio_timer, instance);
   }
+  /* Does nothing if we are already on the minimum interval. */
+  trickle_timer_reset_event(&instance->dio_timer);
 #if RPL_CONF_STATS
   rpl_stats.resets++;
 #endif /* RPL_CONF_STATS */
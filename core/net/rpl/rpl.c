@@ -57,6 +57,57 @@
 rpl_stats_t rpl_stats;
 #endif
 
+/*---------------------------------------------------------------------------*/
+/*
+ * Route lifetimes are kept as absolute expiration times, and a single
+ * timer is armed for the route that expires first. Routes that are
+ * refreshed by DAOs are therefore never touched by the timer, and a
+ * node whose routes all have long lifetimes does not wake up every
+ * second to count them down.
+ */
+static struct ctimer route_timer;
+static uint8_t route_timer_pending;
+static unsigned long route_timer_expiration;
+
+/* The longest interval that fits in a clock_time_t timer. */
+#define ROUTE_TIMER_MAX_WAIT \
+  ((unsigned long)(((clock_time_t)~0) >> 1) / CLOCK_SECOND)
+
+static void
+route_timer_callback(void *ptr)
+{
+  route_timer_pending = 0;
+  rpl_purge_routes();
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule_route_timer(unsigned long expiration)
+{
+  unsigned long now;
+  unsigned long wait;
+
+  now = clock_seconds();
+  wait = (long)(expiration - now) > 0 ? expiration - now : 0;
+  if(wait > ROUTE_TIMER_MAX_WAIT) {
+    wait = ROUTE_TIMER_MAX_WAIT;
+  }
+
+  route_timer_expiration = now + wait;
+  route_timer_pending = 1;
+  ctimer_set(&route_timer, (clock_time_t)wait * CLOCK_SECOND,
+             route_timer_callback, NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_set_route_lifetime(uip_ds6_route_t *r, uint32_t lifetime)
+{
+  r->state.expiration = clock_seconds() + lifetime;
+
+  if(!route_timer_pending ||
+     (long)(r->state.expiration - route_timer_expiration) < 0) {
+    schedule_route_timer(r->state.expiration);
+  }
+}
 /*---------------------------------------------------------------------------*/
 void
 rpl_purge_routes(void)
@@ -64,29 +115,18 @@ rpl_purge_routes(void)
   uip_ds6_route_t *r;
   uip_ipaddr_t prefix;
   rpl_dag_t *dag;
+  unsigned long now;
+  unsigned long next;
+  uint8_t have_next;
 
-  /* First pass, decrement lifetime */
-  r = uip_ds6_route_head();
-
-  while(r != NULL) {
-    if(r->state.lifetime >= 1) {
-      /*
-       * If a route is at lifetime == 1, set it to 0, scheduling it for
-       * immediate removal below. This achieves the same as the original code,
-       * which would delete lifetime <= 1
-       */
-      r->state.lifetime--;
-    }
-    r = uip_ds6_route_next(r);
-  }
+  now = clock_seconds();
+  next = 0;
+  have_next = 0;
 
-  /* Second pass, remove dead routes */
   r = uip_ds6_route_head();
 
   while(r != NULL) {
-    if(r->state.lifetime < 1) {
-      /* Routes with lifetime == 1 have only just been decremented from 2 to 1,
-       * thus we want to keep them. Hence < and not <= */
+    if((long)(r->state.expiration - now) <= 0) {
       uip_ipaddr_copy(&prefix, &r->ipaddr);
       uip_ds6_route_rm(r);
       r = uip_ds6_route_head();
@@ -97,14 +137,26 @@ rpl_purge_routes(void)
       if(dag->rank != ROOT_RANK(default_instance)) {
         PRINTF(" -> generate No-Path DAO\n");
         dao_output_target(dag->preferred_parent, &prefix, RPL_ZERO_LIFETIME);
-        /* Don't schedule more than 1 No-Path DAO, let next iteration handle that */
+        /* Don't schedule more than 1 No-Path DAO, let next second handle that */
+        schedule_route_timer(now + 1);
         return;
       }
       PRINTF("\n");
     } else {
+      if(!have_next || (long)(r->state.expiration - next) < 0) {
+        next = r->state.expiration;
+        have_next = 1;
+      }
       r = uip_ds6_route_next(r);
     }
   }
+
+  if(have_next) {
+    schedule_route_timer(next);
+  } else {
+    ctimer_stop(&route_timer);
+    route_timer_pending = 0;
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -155,7 +207,8 @@ rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix, int prefix_len,
   }
 
   rep->state.dag = dag;
-  rep->state.lifetime = RPL_LIFETIME(dag->instance, dag->instance->default_lifetime);
+  rpl_set_route_lifetime(rep, RPL_LIFETIME(dag->instance,
+                                            dag->instance->default_lifetime));
   rep->state.learned_from = RPL_ROUTE_FROM_INTERNAL;
 
   PRINTF("RPL: Added a route to ");
@@ -174,6 +227,7 @@ rpl_link_neighbor_callback(const rimeaddr_t *addr, int status, int numtx)
   rpl_parent_t *parent;
   rpl_instance_t *instance;
   rpl_instance_t *end;
+  uint16_t link_metric;
 
   uip_ip6addr(&ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
   uip_ds6_set_addr_iid(&ipaddr, (uip_lladdr_t *)addr);
@@ -182,12 +236,15 @@ rpl_link_neighbor_callback(const rimeaddr_t *addr, int status, int numtx)
     if(instance->used == 1 ) {
       parent = rpl_find_parent_any_dag(instance, &ipaddr);
       if(parent != NULL) {
-        /* Trigger DAG rank recalculation. */
-        PRINTF("RPL: rpl_link_neighbor_callback triggering update\n");
-        parent->updated = 1;
+        link_metric = parent->link_metric;
         if(instance->of->neighbor_link_callback != NULL) {
           instance->of->neighbor_link_callback(parent, status, numtx);
         }
+        if(parent->link_metric != link_metric) {
+          /* Trigger DAG rank recalculation. */
+          PRINTF("RPL: rpl_link_neighbor_callback triggering update\n");
+          rpl_parent_updated(parent, RPL_PARENT_UPDATED_METRIC);
+        }
       }
     }
   }
@@ -210,7 +267,7 @@ rpl_ipv6_neighbor_callback(uip_ds6_nbr_t *nbr)
         p->rank = INFINITE_RANK;
         /* Trigger DAG rank recalculation. */
         PRINTF("RPL: rpl_ipv6_neighbor_callback infinite rank\n");
-        p->updated = 1;
+        rpl_parent_updated(p, RPL_PARENT_UPDATED_RANK);
       }
     }
   }
@@ -224,6 +281,9 @@ rpl_init(void)
   default_instance = NULL;
 
   rpl_dag_init();
+#if RPL_WITH_NON_STORING
+  rpl_ns_init();
+#endif /* RPL_WITH_NON_STORING */
   rpl_reset_periodic_timer();
 
   /* add rpl multicast address */
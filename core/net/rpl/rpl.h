@@ -44,6 +44,7 @@
 #include "net/uip.h"
 #include "net/uip-ds6.h"
 #include "sys/ctimer.h"
+#include "lib/trickle-timer.h"
 
 /*---------------------------------------------------------------------------*/
 /* The amount of parents that this node has in a particular DAG. */
@@ -140,6 +141,9 @@ struct rpl_dag {
   /* live data for the DAG */
   uint8_t joined;
   rpl_parent_t *preferred_parent;
+#if RPL_BACKUP_PARENTS > 0
+  rpl_parent_t *backup_parents[RPL_BACKUP_PARENTS];
+#endif /* RPL_BACKUP_PARENTS > 0 */
   rpl_rank_t rank;
   struct rpl_instance *instance;
   LIST_STRUCT(parents);
@@ -211,19 +215,16 @@ struct rpl_instance {
   uint8_t dio_intmin;
   uint8_t dio_redundancy;
   uint8_t default_lifetime;
-  uint8_t dio_intcurrent;
-  uint8_t dio_send; /* for keeping track of which mode the timer is in */
-  uint8_t dio_counter;
   rpl_rank_t max_rankinc;
   rpl_rank_t min_hoprankinc;
   uint16_t lifetime_unit; /* lifetime in seconds = l_u * d_l */
 #if RPL_CONF_STATS
   uint16_t dio_totint;
   uint16_t dio_totsend;
+  uint16_t dio_totsuppress;
   uint16_t dio_totrecv;
 #endif /* RPL_CONF_STATS */
-  clock_time_t dio_next_delay; /* delay for completion of dio interval */
-  struct ctimer dio_timer;
+  struct trickle_timer dio_timer;
   struct ctimer dao_timer;
 };
 
@@ -243,7 +244,13 @@ int rpl_verify_header(int);
 void rpl_insert_header(void);
 void rpl_remove_header(void);
 uint8_t rpl_invert_header(void);
+#if RPL_WITH_NON_STORING
+int rpl_process_srh_header(void);
+int rpl_insert_srh_header(void);
+int rpl_srh_get_next_hop(uip_ipaddr_t *ipaddr);
+#endif /* RPL_WITH_NON_STORING */
 uip_ipaddr_t *rpl_get_parent_ipaddr(rpl_parent_t *nbr);
+rimeaddr_t *rpl_get_parent_lladdr(rpl_parent_t *nbr);
 rpl_rank_t rpl_get_parent_rank(uip_lladdr_t *addr);
 uint16_t rpl_get_parent_link_metric(uip_lladdr_t *addr);
 void rpl_dag_init(void);
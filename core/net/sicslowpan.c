@@ -66,6 +66,7 @@
 #include "net/rime.h"
 #include "net/sicslowpan.h"
 #include "net/netstack.h"
+#include "net/link-stats.h"
 
 #if UIP_CONF_IPV6
 
@@ -112,6 +113,26 @@ void uip_log(char *msg);
 #endif /* SICSLOWPAN_CONF_COMPRESSION */
 #endif /* SICSLOWPAN_COMPRESSION */
 
+#if TIMESYNCH_CONF_ENABLED && SICSLOWPAN_COMPRESSION != SICSLOWPAN_COMPRESSION_HC06
+#warning "Timesynch beacons are only timestamped with SICSLOWPAN_COMPRESSION_HC06"
+#endif
+
+/* With SICSLOWPAN_CONF_TX_IN_PLACE, unfragmented packets are sent
+   from uip_buf: the compressed header is written in front of the
+   payload and the MAC prepends its headers in the uip_buf headroom,
+   which saves copying the payload into the packetbuf. */
+#ifdef SICSLOWPAN_CONF_TX_IN_PLACE
+#define SICSLOWPAN_TX_IN_PLACE SICSLOWPAN_CONF_TX_IN_PLACE
+#else
+#define SICSLOWPAN_TX_IN_PLACE 0
+#endif
+
+#if SICSLOWPAN_TX_IN_PLACE && defined(NETSTACK_ENCRYPT)
+#warning "SICSLOWPAN_CONF_TX_IN_PLACE is disabled with link-layer security"
+#undef SICSLOWPAN_TX_IN_PLACE
+#define SICSLOWPAN_TX_IN_PLACE 0
+#endif
+
 #define GET16(ptr,index) (((uint16_t)((ptr)[index] << 8)) | ((ptr)[(index) + 1]))
 #define SET16(ptr,index,value) do {     \
   (ptr)[index] = ((value) >> 8) & 0xff; \
@@ -172,6 +193,15 @@ void uip_log(char *msg);
 #define COMPRESSION_THRESHOLD 0
 #endif
 
+/** \brief If set, ICMPv6 messages (ND, RPL) are compressed with
+    6LoWPAN-GHC (RFC 7400) when the result fits into a single frame.
+    All nodes of the network must support GHC. */
+#ifdef SICSLOWPAN_CONF_GHC
+#define SICSLOWPAN_GHC SICSLOWPAN_CONF_GHC
+#else
+#define SICSLOWPAN_GHC 0
+#endif
+
 /** \name General variables
  *  @{
  */
@@ -208,6 +238,19 @@ static uint8_t rime_payload_len;
  */
 static uint8_t uncomp_hdr_len;
 
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+/**
+ * Set when the header of the received packet had its UDP checksum
+ * elided, so that it has to be computed before the packet is passed
+ * up. Timesynch beacons are sent that way.
+ */
+static uint8_t udp_chksum_elided;
+
+/* The radio timestamps the packet after its UDP checksum was computed */
+#define ELIDE_UDP_CHKSUM() (packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) == \
+                            PACKETBUF_ATTR_PACKET_TYPE_TIMESTAMP)
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+
 /**
  * the result of the last transmitted fragment
  */
@@ -219,35 +262,90 @@ static int last_tx_status;
  *  @{
  */
 
+/** The total length of an unfragmented IPv6 packet in the sicslowpan_buf. */
 static uint16_t sicslowpan_len;
 
 /**
- * The buffer used for the 6lowpan reassembly.
- * This buffer contains only the IPv6 packet (no MAC header, 6lowpan, etc).
- * It has a fix size as we do not use dynamic memory allocation.
+ * A reassembly context, holding a fragmented packet that is being
+ * reassembled. Fragments are matched to a context by the sender,
+ * the datagram tag and the datagram size, so that fragments of
+ * several packets can be reassembled at the same time.
  */
-static uip_buf_t sicslowpan_aligned_buf;
-#define sicslowpan_buf (sicslowpan_aligned_buf.u8)
+struct sicslowpan_reass {
+  /**
+   * The buffer used for the 6lowpan reassembly.
+   * This buffer contains only the IPv6 packet (no MAC header, 6lowpan, etc).
+   * It has a fix size as we do not use dynamic memory allocation.
+   */
+  uip_buf_t buf;
+
+  /** The total length of the IPv6 packet, zero if the context is free. */
+  uint16_t len;
+
+  /**
+   * length of the ip packet already received.
+   * It includes IP and transport headers.
+   */
+  uint16_t processed_ip_in_len;
+
+  /** The tag in the fragments being merged. */
+  uint16_t tag;
+
+  /** The source address of the fragments being merged */
+  rimeaddr_t sender;
+
+  /** Reassembly %process %timer. */
+  struct timer timer;
+};
 
-/** The total length of the IPv6 packet in the sicslowpan_buf. */
+static struct sicslowpan_reass reass_contexts[SICSLOWPAN_REASS_CONTEXTS];
+
+/** The reassembly context of the fragment being processed, if any. */
+static struct sicslowpan_reass *reass;
 
 /**
- * length of the ip packet already sent / received.
- * It includes IP and transport headers.
+ * The buffer the packet being processed is uncompressed into: the
+ * buffer of its reassembly context if it is a fragment, uip_buf
+ * otherwise.
  */
-static uint16_t processed_ip_in_len;
+static uint8_t *sicslowpan_buf;
 
 /** Datagram tag to be put in the fragments I send. */
 static uint16_t my_tag;
 
-/** When reassembling, the tag in the fragments being merged. */
-static uint16_t reass_tag;
+#if SICSLOWPAN_CONF_FRAG_FORWARD
+/**
+ * A fragment forwarding entry. Once the first fragment of a packet
+ * that is not for us has been relayed to the next hop, the following
+ * fragments of the packet are relayed as they arrive, with the
+ * datagram tag we chose for the next hop.
+ */
+struct sicslowpan_fwd {
+  /** The total length of the IPv6 packet, zero if the entry is free. */
+  uint16_t len;
+
+  /** The tag in the fragments we receive. */
+  uint16_t tag;
+
+  /** The tag in the fragments we relay. */
+  uint16_t fwd_tag;
+
+  /** The source address of the fragments we receive */
+  rimeaddr_t sender;
 
-/** When reassembling, the source address of the fragments being merged */
-rimeaddr_t frag_sender;
+  /** The next hop the fragments are relayed to */
+  rimeaddr_t nexthop;
 
-/** Reassembly %process %timer. */
-static struct timer reass_timer;
+  /** Forwarding entry timer, the entry is freed when it expires. */
+  struct timer timer;
+};
+
+static struct sicslowpan_fwd fwd_entries[SICSLOWPAN_FRAG_FORWARD_ENTRIES];
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARD */
+
+#if SICSLOWPAN_CONF_REASS_STATS
+struct sicslowpan_reass_stats sicslowpan_reass_stats;
+#endif /* SICSLOWPAN_CONF_REASS_STATS */
 
 /** @} */
 #else /* SICSLOWPAN_CONF_FRAG */
@@ -303,6 +401,35 @@ set_packet_attrs()
 /*   } */
 
 }
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Classify the packet in uip_buf for the MAC layer queues.
+ *
+ * ICMPv6, which carries RPL and neighbor discovery, is control traffic.
+ * Bare TCP acknowledgements and CoAP ACK and RST messages are small
+ * and hold up a peer, so they go ahead of bulk data.
+ */
+#define COAP_PORT UIP_HTONS(5683)
+static int
+packet_priority(void)
+{
+  if(UIP_IP_BUF->proto == UIP_PROTO_ICMP6) {
+    return PACKETBUF_ATTR_PRIORITY_CONTROL;
+  }
+  if(UIP_IP_BUF->proto == UIP_PROTO_TCP &&
+     (UIP_TCP_BUF->flags & 0x3f) == 0x10 &&
+     uip_len == UIP_IPTCPH_LEN + ((UIP_TCP_BUF->tcpoffset >> 4) - 5) * 4) {
+    return PACKETBUF_ATTR_PRIORITY_INTERACTIVE;
+  }
+  if(UIP_IP_BUF->proto == UIP_PROTO_UDP &&
+     (UIP_UDP_BUF->srcport == COAP_PORT ||
+      UIP_UDP_BUF->destport == COAP_PORT) &&
+     uip_len > UIP_IPUDPH_LEN &&
+     (uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN] & 0x20) != 0) {
+    return PACKETBUF_ATTR_PRIORITY_INTERACTIVE;
+  }
+  return PACKETBUF_ATTR_PRIORITY_BULK;
+}
 
 
 
@@ -323,6 +450,39 @@ static struct sicslowpan_addr_context *context;
 /** pointer to the byte where to write next inline field. */
 static uint8_t *hc06_ptr;
 
+/* Compressed headers of recent flows. Apart from the UDP checksum, the
+   IPHC header only depends on the IPv6 header without the payload
+   length, the UDP ports, the link-layer destination and the address
+   contexts, so packets of the same flow can reuse it. */
+#ifdef SICSLOWPAN_CONF_FLOW_CACHE
+#define FLOW_CACHE SICSLOWPAN_CONF_FLOW_CACHE
+#else
+#define FLOW_CACHE 2
+#endif
+
+#ifdef SICSLOWPAN_NH_COMPRESSOR
+/* The additional compressor may depend on more than the flow */
+#undef FLOW_CACHE
+#define FLOW_CACHE 0
+#endif
+
+#if FLOW_CACHE > 0
+/* IPHC with CID, TC/FL, NH, HL, two inline addresses and UDP NHC */
+#define FLOW_HDR_MAX_LEN (3 + 4 + 1 + 1 + 16 + 16 + 5)
+
+struct flow_cache_entry {
+  uint8_t tcflow[4];    /* version, traffic class and flow label */
+  uint8_t ip[2 + 32];   /* next header, hop limit and addresses */
+  uint16_t ports[2];
+  rimeaddr_t dest;
+  uint8_t hdr_len;      /* zero if the entry is free */
+  uint8_t hdr[FLOW_HDR_MAX_LEN];
+};
+static struct flow_cache_entry flow_cache[FLOW_CACHE];
+static uint8_t flow_cache_next;
+static rimeaddr_t flow_cache_addr;
+#endif /* FLOW_CACHE > 0 */
+
 /* Uncompression of linklocal */
 /*   0 -> 16 bytes from packet  */
 /*   1 -> 2 bytes from prefix - bunch of zeroes and 8 from packet */
@@ -389,6 +549,308 @@ addr_context_lookup_by_number(uint8_t number)
 #endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
   return NULL;
 }
+#if FLOW_CACHE > 0
+/*--------------------------------------------------------------------*/
+static void
+flow_cache_flush(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < FLOW_CACHE; i++) {
+    flow_cache[i].hdr_len = 0;
+  }
+}
+/*--------------------------------------------------------------------*/
+/** \brief find the cached compressed header of the packet in uip_buf */
+static struct flow_cache_entry *
+flow_cache_lookup(rimeaddr_t *rime_destaddr)
+{
+  struct flow_cache_entry *e;
+
+  /* Our link-layer address is used to elide the source address */
+  if(!rimeaddr_cmp(&flow_cache_addr, &rimeaddr_node_addr)) {
+    rimeaddr_copy(&flow_cache_addr, &rimeaddr_node_addr);
+    flow_cache_flush();
+    return NULL;
+  }
+
+  for(e = flow_cache; e < &flow_cache[FLOW_CACHE]; e++) {
+    if(e->hdr_len > 0 &&
+       memcmp(e->tcflow, &UIP_IP_BUF->vtc, sizeof(e->tcflow)) == 0 &&
+       memcmp(e->ip, &UIP_IP_BUF->proto, sizeof(e->ip)) == 0 &&
+       rimeaddr_cmp(&e->dest, rime_destaddr) &&
+       (UIP_IP_BUF->proto != UIP_PROTO_UDP ||
+        (e->ports[0] == UIP_UDP_BUF->srcport &&
+         e->ports[1] == UIP_UDP_BUF->destport))) {
+      return e;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/** \brief remember the compressed header of the packet in uip_buf */
+static void
+flow_cache_add(rimeaddr_t *rime_destaddr, uint8_t hdr_len)
+{
+  struct flow_cache_entry *e;
+
+  if(hdr_len > FLOW_HDR_MAX_LEN) {
+    return;
+  }
+  e = &flow_cache[flow_cache_next];
+  flow_cache_next = (flow_cache_next + 1) % FLOW_CACHE;
+
+  memcpy(e->tcflow, &UIP_IP_BUF->vtc, sizeof(e->tcflow));
+  memcpy(e->ip, &UIP_IP_BUF->proto, sizeof(e->ip));
+  rimeaddr_copy(&e->dest, rime_destaddr);
+  e->ports[0] = UIP_UDP_BUF->srcport;
+  e->ports[1] = UIP_UDP_BUF->destport;
+  e->hdr_len = hdr_len;
+  memcpy(e->hdr, rime_ptr, hdr_len);
+}
+#endif /* FLOW_CACHE > 0 */
+/*--------------------------------------------------------------------*/
+int
+sicslowpan_context_set(uint8_t number, const uip_ipaddr_t *prefix)
+{
+#if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+  struct sicslowpan_addr_context *c;
+  int i;
+
+  if(number > 15) {
+    return 0;
+  }
+  c = addr_context_lookup_by_number(number);
+  for(i = 0; c == NULL && i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
+    if(addr_contexts[i].used == 0) {
+      c = &addr_contexts[i];
+    }
+  }
+  if(c == NULL) {
+    PRINTF("sicslowpan: no room for context %u\n", number);
+    return 0;
+  }
+  c->used = 1;
+  c->number = number;
+  memcpy(c->prefix, prefix, sizeof(c->prefix));
+#if FLOW_CACHE > 0
+  flow_cache_flush();
+#endif /* FLOW_CACHE > 0 */
+  PRINTF("sicslowpan: context %u set to %02x%02x:%02x%02x:%02x%02x:%02x%02x::/64\n",
+         number, c->prefix[0], c->prefix[1], c->prefix[2], c->prefix[3],
+         c->prefix[4], c->prefix[5], c->prefix[6], c->prefix[7]);
+  return 1;
+#else /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
+  return 0;
+#endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
+}
+/*--------------------------------------------------------------------*/
+void
+sicslowpan_context_remove(uint8_t number)
+{
+  struct sicslowpan_addr_context *c;
+
+  c = addr_context_lookup_by_number(number);
+  if(c != NULL) {
+    PRINTF("sicslowpan: context %u removed\n", number);
+    c->used = 0;
+#if FLOW_CACHE > 0
+    flow_cache_flush();
+#endif /* FLOW_CACHE > 0 */
+  }
+}
+#if SICSLOWPAN_GHC
+/*--------------------------------------------------------------------*/
+/** \name 6LoWPAN-GHC compression of ICMPv6 messages
+ * @{                                                                 */
+/*--------------------------------------------------------------------*/
+/* The GHC dictionary is the source address, the destination address
+   and a static part; back-references may reach into it. */
+#define GHC_DICT_LEN 48
+
+static const uint8_t ghc_static_dict[16] = {
+  0x16, 0xfe, 0xfd, 0x17, 0xfe, 0xfd, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00
+};
+
+static uint8_t ghc_dict[GHC_DICT_LEN];
+
+/* Byte at position pos of the dictionary followed by buf */
+#define GHC_BYTE(buf, pos) \
+  ((pos) < GHC_DICT_LEN ? ghc_dict[pos] : (buf)[(pos) - GHC_DICT_LEN])
+
+/* Longest run of zeros and longest back-reference we encode */
+#define GHC_MAX_ZEROS 17
+#define GHC_MAX_MATCH 17
+
+/* An uncompressed message must fit in the buffer and in uncomp_hdr_len */
+#if UIP_BUFSIZE - UIP_LLIPH_LEN < 0xff - UIP_IPH_LEN
+#define GHC_MAX_UNCOMPRESSED (UIP_BUFSIZE - UIP_LLIPH_LEN)
+#else
+#define GHC_MAX_UNCOMPRESSED (0xff - UIP_IPH_LEN)
+#endif
+
+/** Set when the packet in uip_buf may be compressed with GHC */
+static uint8_t ghc_allowed;
+
+static int framer_hdr_len(rimeaddr_t *dest);
+
+static void
+ghc_dict_init(struct uip_ip_hdr *ip)
+{
+  memcpy(ghc_dict, &ip->srcipaddr, 16);
+  memcpy(ghc_dict + 16, &ip->destipaddr, 16);
+  memcpy(ghc_dict + 32, ghc_static_dict, sizeof(ghc_static_dict));
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Compress data with GHC
+ * \param data The data to compress
+ * \param len The length of the data
+ * \param out Where to put the compressed data
+ * \param max The space available at out
+ * \return The length of the compressed data, 0 if it does not fit
+ */
+static uint16_t
+ghc_compress(const uint8_t *data, uint16_t len, uint8_t *out, uint16_t max)
+{
+  uint16_t pos, o, literal, i, n, zeros;
+  uint16_t best_len, best_dist, ext, a, b;
+
+  pos = o = literal = 0;
+  while(pos <= len) {
+    zeros = best_len = best_dist = ext = 0;
+    if(pos < len) {
+      while(pos + zeros < len && zeros < GHC_MAX_ZEROS && data[pos + zeros] == 0) {
+        zeros++;
+      }
+      /* Find the longest match; later candidates need fewer
+         extension bytes, so they win ties. */
+      for(i = 0; i < GHC_DICT_LEN + pos; i++) {
+        for(n = 0; n < GHC_MAX_MATCH && pos + n < len &&
+              n < GHC_DICT_LEN + pos - i &&
+              GHC_BYTE(data, i + n) == data[pos + n]; n++);
+        if(n >= 2 && n >= best_len) {
+          best_len = n;
+          best_dist = GHC_DICT_LEN + pos - i;
+        }
+      }
+      if(best_len > 0) {
+        a = (best_len - 2) >> 3;
+        b = ((best_dist - best_len) >> 3);
+        ext = (b + 14) / 15;
+        if(a > ext) {
+          ext = a;
+        }
+      }
+    }
+
+    if(literal > 0 &&
+       (pos == len || literal == SICSLOWPAN_GHC_LITERAL_MAX ||
+        zeros >= 2 || best_len > ext + 1)) {
+      /* Flush the pending literal bytes */
+      if(o + 1 + literal > max) {
+        return 0;
+      }
+      out[o++] = literal;
+      memcpy(out + o, data + pos - literal, literal);
+      o += literal;
+      literal = 0;
+    }
+    if(pos == len) {
+      break;
+    }
+
+    if(zeros >= 2 && zeros >= best_len) {
+      if(o + 1 > max) {
+        return 0;
+      }
+      out[o++] = SICSLOWPAN_GHC_ZEROS | (zeros - 2);
+      pos += zeros;
+    } else if(best_len > ext + 1) {
+      if(o + 1 + ext > max) {
+        return 0;
+      }
+      a = (best_len - 2) >> 3;
+      b = (best_dist - best_len) >> 3;
+      while(a > 0 || b > 0) {
+        n = b > 15 ? 15 : b;
+        out[o++] = SICSLOWPAN_GHC_EXTEND | (a > 0 ? 0x10 : 0) | n;
+        b -= n;
+        if(a > 0) {
+          a--;
+        }
+      }
+      out[o++] = SICSLOWPAN_GHC_BACKREF | (((best_len - 2) & 7) << 3) |
+        ((best_dist - best_len) & 7);
+      pos += best_len;
+    } else {
+      literal++;
+      pos++;
+    }
+  }
+  return o;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Uncompress GHC data
+ * \param in The compressed data
+ * \param len The length of the compressed data
+ * \param out Where to put the uncompressed data
+ * \param max The space available at out
+ * \param consumed Set to the number of compressed bytes used
+ * \return The length of the uncompressed data, -1 on error
+ */
+static int
+ghc_uncompress(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t max,
+               uint16_t *consumed)
+{
+  uint16_t i, o, n, s, sa, na;
+  uint8_t code;
+
+  i = o = sa = na = 0;
+  while(i < len) {
+    code = in[i++];
+    if((code & 0x80) == 0) {
+      /* Literal bytes */
+      n = code;
+      if(n > SICSLOWPAN_GHC_LITERAL_MAX || i + n > len || o + n > max) {
+        return -1;
+      }
+      memcpy(out + o, in + i, n);
+      i += n;
+      o += n;
+    } else if((code & 0xf0) == SICSLOWPAN_GHC_ZEROS) {
+      n = (code & 0x0f) + 2;
+      if(o + n > max) {
+        return -1;
+      }
+      memset(out + o, 0, n);
+      o += n;
+    } else if(code == SICSLOWPAN_GHC_STOP) {
+      break;
+    } else if((code & 0xe0) == SICSLOWPAN_GHC_EXTEND) {
+      sa += (code & 0x0f) << 3;
+      na += (code & 0x10) >> 1;
+    } else if((code & 0xc0) == SICSLOWPAN_GHC_BACKREF) {
+      n = na + ((code >> 3) & 7) + 2;
+      s = (code & 7) + sa + n;
+      if(s > GHC_DICT_LEN + o || o + n > max) {
+        return -1;
+      }
+      for(; n > 0; n--, o++) {
+        out[o] = GHC_BYTE(out, GHC_DICT_LEN + o - s);
+      }
+      sa = na = 0;
+    } else {
+      return -1;
+    }
+  }
+  *consumed = i;
+  return o;
+}
+/** @} */
+#endif /* SICSLOWPAN_GHC */
 /*--------------------------------------------------------------------*/
 static uint8_t
 compress_addr_64(uint8_t bitpos, uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr)
@@ -489,6 +951,12 @@ static void
 compress_hdr_hc06(rimeaddr_t *rime_destaddr)
 {
   uint8_t tmp, iphc0, iphc1;
+#if SICSLOWPAN_GHC
+  uint8_t *nh_ptr = NULL;
+#endif /* SICSLOWPAN_GHC */
+#if FLOW_CACHE > 0
+  struct flow_cache_entry *e;
+#endif /* FLOW_CACHE > 0 */
 #if DEBUG
   { uint16_t ndx;
     PRINTF("before compression (%d): ", UIP_IP_BUF->len[1]);
@@ -500,6 +968,26 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
   }
 #endif
 
+#if FLOW_CACHE > 0
+  /* ICMPv6 may be compressed with GHC, which depends on the payload */
+  if(!(SICSLOWPAN_GHC && UIP_IP_BUF->proto == UIP_PROTO_ICMP6) &&
+     !ELIDE_UDP_CHKSUM() &&
+     (e = flow_cache_lookup(rime_destaddr)) != NULL) {
+    memcpy(rime_ptr, e->hdr, e->hdr_len);
+    hc06_ptr = rime_ptr + e->hdr_len;
+    uncomp_hdr_len = UIP_IPH_LEN;
+#if UIP_CONF_UDP || UIP_CONF_ROUTER
+    if(UIP_IP_BUF->proto == UIP_PROTO_UDP) {
+      memcpy(hc06_ptr, &UIP_UDP_BUF->udpchksum, 2);
+      hc06_ptr += 2;
+      uncomp_hdr_len += UIP_UDPH_LEN;
+    }
+#endif /*UIP_CONF_UDP*/
+    rime_hdr_len = hc06_ptr - rime_ptr;
+    return;
+  }
+#endif /* FLOW_CACHE > 0 */
+
   hc06_ptr = rime_ptr + 2;
   /*
    * As we copy some bit-length fields, in the IPHC encoding bytes,
@@ -586,6 +1074,15 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
     iphc0 |= SICSLOWPAN_IPHC_NH_C;
   }
 #endif
+#if SICSLOWPAN_GHC
+  /* uncomp_hdr_len must be able to hold the whole packet */
+  if(ghc_allowed && UIP_IP_BUF->proto == UIP_PROTO_ICMP6 && uip_len <= 0xff) {
+    /* Remember where the next header goes, in case GHC does not pay
+       off and it has to be carried inline after all. */
+    iphc0 |= SICSLOWPAN_IPHC_NH_C;
+    nh_ptr = hc06_ptr;
+  }
+#endif /* SICSLOWPAN_GHC */
   if ((iphc0 & SICSLOWPAN_IPHC_NH_C) == 0) {
     *hc06_ptr = UIP_IP_BUF->proto;
     hc06_ptr += 1;
@@ -701,6 +1198,8 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
 #if UIP_CONF_UDP || UIP_CONF_ROUTER
   /* UDP header compression */
   if(UIP_IP_BUF->proto == UIP_PROTO_UDP) {
+    uint8_t *udp_nhc_ptr = hc06_ptr;
+
     PRINTF("IPHC: Uncompressed UDP ports on send side: %x, %x\n",
 	   UIP_HTONS(UIP_UDP_BUF->srcport), UIP_HTONS(UIP_UDP_BUF->destport));
     /* Mask out the last 4 bits can be used as a mask */
@@ -740,8 +1239,11 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
       memcpy(hc06_ptr + 1, &UIP_UDP_BUF->srcport, 4);
       hc06_ptr += 5;
     }
-    /* always inline the checksum  */
-    if(1) {
+    if(ELIDE_UDP_CHKSUM()) {
+      /* The receiver computes the checksum over what it received,
+         as RFC 6282 requires for an elided checksum. */
+      *udp_nhc_ptr |= SICSLOWPAN_NHC_UDP_CHECKSUMC;
+    } else {
       memcpy(hc06_ptr, &UIP_UDP_BUF->udpchksum, 2);
       hc06_ptr += 2;
     }
@@ -749,6 +1251,34 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
   }
 #endif /*UIP_CONF_UDP*/
 
+#if SICSLOWPAN_GHC
+  /* ICMPv6 compression with GHC, only if the packet fits in one frame */
+  if(nh_ptr != NULL) {
+    uint16_t ghc_len = 0;
+    int max;
+
+    max = (int)MAC_MAX_PAYLOAD - framer_hdr_len(rime_destaddr) -
+      (int)(hc06_ptr - rime_ptr) - 1;
+    if(max > 0) {
+      ghc_dict_init(UIP_IP_BUF);
+      ghc_len = ghc_compress((uint8_t *)UIP_ICMP_BUF, uip_len - UIP_IPH_LEN,
+                             hc06_ptr + 1, max);
+    }
+    if(ghc_len > 0 && ghc_len < uip_len - UIP_IPH_LEN) {
+      PRINTF("IPHC: GHC compressed ICMPv6 from %u to %u bytes\n",
+             uip_len - UIP_IPH_LEN, ghc_len);
+      *hc06_ptr = SICSLOWPAN_NHC_GHC_ICMP6;
+      hc06_ptr += 1 + ghc_len;
+      uncomp_hdr_len = uip_len;
+    } else {
+      memmove(nh_ptr + 1, nh_ptr, hc06_ptr - nh_ptr);
+      *nh_ptr = UIP_IP_BUF->proto;
+      hc06_ptr++;
+      iphc0 &= ~SICSLOWPAN_IPHC_NH_C;
+    }
+  }
+#endif /* SICSLOWPAN_GHC */
+
 #ifdef SICSLOWPAN_NH_COMPRESSOR
   /* if nothing to compress just return zero  */
   hc06_ptr += SICSLOWPAN_NH_COMPRESSOR.compress(hc06_ptr, &uncomp_hdr_len);
@@ -759,6 +1289,15 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
   RIME_IPHC_BUF[1] = iphc1;
 
   rime_hdr_len = hc06_ptr - rime_ptr;
+
+#if FLOW_CACHE > 0
+  if(!(SICSLOWPAN_GHC && UIP_IP_BUF->proto == UIP_PROTO_ICMP6) &&
+     !ELIDE_UDP_CHKSUM()) {
+    /* Everything but the UDP checksum at the end can be reused */
+    flow_cache_add(rime_destaddr, rime_hdr_len -
+                   (uncomp_hdr_len > UIP_IPH_LEN ? 2 : 0));
+  }
+#endif /* FLOW_CACHE > 0 */
   return;
 }
 
@@ -985,9 +1524,32 @@ uncompress_hdr_hc06(uint16_t ip_len)
 	PRINTF("IPHC: sicslowpan uncompress_hdr: checksum included\n");
       } else {
 	PRINTF("IPHC: sicslowpan uncompress_hdr: checksum *NOT* included\n");
+	SICSLOWPAN_UDP_BUF->udpchksum = 0;
+	udp_chksum_elided = 1;
       }
       uncomp_hdr_len += UIP_UDPH_LEN;
     }
+#if SICSLOWPAN_GHC
+    else if(*hc06_ptr == SICSLOWPAN_NHC_GHC_ICMP6) {
+      int len;
+      uint16_t consumed;
+
+      SICSLOWPAN_IP_BUF->proto = UIP_PROTO_ICMP6;
+      hc06_ptr++;
+      ghc_dict_init(SICSLOWPAN_IP_BUF);
+      len = ghc_uncompress(hc06_ptr, packetbuf_datalen() - (hc06_ptr - rime_ptr),
+                           (uint8_t *)SICSLOWPAN_IP_BUF + UIP_IPH_LEN,
+                           GHC_MAX_UNCOMPRESSED, &consumed);
+      if(len < 0) {
+        PRINTF("sicslowpan uncompress_hdr: error in GHC data\n");
+        return;
+      }
+      PRINTF("IPHC: GHC uncompressed ICMPv6 from %u to %d bytes\n",
+             consumed, len);
+      hc06_ptr += consumed;
+      uncomp_hdr_len += len;
+    }
+#endif /* SICSLOWPAN_GHC */
 #ifdef SICSLOWPAN_NH_COMPRESSOR
     else {
       hc06_ptr += SICSLOWPAN_NH_COMPRESSOR.uncompress(hc06_ptr, sicslowpan_buf, &uncomp_hdr_len);
@@ -1016,6 +1578,18 @@ uncompress_hdr_hc06(uint16_t ip_len)
   return;
 }
 /** @} */
+#else /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+/*--------------------------------------------------------------------*/
+int
+sicslowpan_context_set(uint8_t number, const uip_ipaddr_t *prefix)
+{
+  return 0;
+}
+/*--------------------------------------------------------------------*/
+void
+sicslowpan_context_remove(uint8_t number)
+{
+}
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
 
 
@@ -1303,6 +1877,8 @@ compress_hdr_ipv6(rimeaddr_t *rime_destaddr)
 static void
 packet_sent(void *ptr, int status, int transmissions)
 {
+  link_stats_packet_sent(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                         status, transmissions);
   uip_ds6_link_neighbor_callback(status, transmissions);
 
   if(callback != NULL) {
@@ -1311,6 +1887,45 @@ packet_sent(void *ptr, int status, int transmissions)
   last_tx_status = status;
 }
 /*--------------------------------------------------------------------*/
+#if SICSLOWPAN_TX_IN_PLACE
+/**
+ * \brief Let the packetbuf use the unfragmented packet in uip_buf
+ * \return 1 if the packetbuf uses uip_buf, 0 if the payload must be
+ * copied
+ *
+ * The compressed header in the packetbuf is moved in front of the
+ * payload in uip_buf, over the uncompressed header that it replaces,
+ * and the packetbuf borrows uip_buf from there on. The headroom
+ * below the compressed header, including UIP_BUFFER_HEADROOM, must
+ * leave room for PACKETBUF_HDR_SIZE bytes of MAC headers.
+ */
+static int
+borrow_uip_buf(void)
+{
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint8_t *data;
+
+  if(UIP_BUFFER_HEADROOM + UIP_LLH_LEN + uncomp_hdr_len <
+     PACKETBUF_HDR_SIZE + rime_hdr_len) {
+    return 0;
+  }
+  data = (uint8_t *)UIP_IP_BUF + uncomp_hdr_len - rime_hdr_len;
+  if(((uintptr_t)data & 1) != 0) {
+    /* Keep the packetbuf aligned on an even 16-bit boundary. */
+    return 0;
+  }
+
+  memcpy(data, rime_ptr, rime_hdr_len);
+  packetbuf_attr_copyto(attrs, addrs);
+  packetbuf_borrow(data - PACKETBUF_HDR_SIZE,
+                   uip_len - uncomp_hdr_len + rime_hdr_len);
+  packetbuf_attr_copyfrom(attrs, addrs);
+  rime_ptr = packetbuf_dataptr();
+  return 1;
+}
+#endif /* SICSLOWPAN_TX_IN_PLACE */
+/*--------------------------------------------------------------------*/
 /**
  * \brief This function is called by the 6lowpan code to send out a
  * packet.
@@ -1344,6 +1959,42 @@ send_packet(rimeaddr_t *dest)
   watchdog_periodic();
 }
 /*--------------------------------------------------------------------*/
+/**
+ * \brief Calculate NETSTACK_FRAMER's header length, that will be added
+ * in the NETSTACK_RDC.
+ * \param dest the link layer destination address of the packet
+ *
+ * The packetbuf attributes are cleared, but the packetbuf data is
+ * left in place.
+ */
+static int
+framer_hdr_len(rimeaddr_t *dest)
+{
+  int framer_hdrlen;
+
+#define USE_FRAMER_HDRLEN 1
+#if USE_FRAMER_HDRLEN
+  packetbuf_clear();
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  framer_hdrlen = NETSTACK_FRAMER.create();
+  if(framer_hdrlen < 0) {
+    /* Framing failed, we assume the maximum header length */
+    framer_hdrlen = 21;
+  }
+  /* The MIC of link-layer security takes room in the frame as well */
+  framer_hdrlen += LLSEC_MIC_LEN;
+  packetbuf_clear();
+
+  /* We must set the max transmissions attribute again after clearing
+     the buffer. */
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
+#else /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = 21;
+#endif /* USE_FRAMER_HDRLEN */
+  return framer_hdrlen;
+}
+/*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
  *  \param localdest The MAC address of the destination
@@ -1395,6 +2046,20 @@ output(uip_lladdr_t *localdest)
     packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
                        PACKETBUF_ATTR_PACKET_TYPE_STREAM_END);
   }
+#if TIMESYNCH_CONF_ENABLED && SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  /* The radio writes its transmission timestamp over the last two
+     bytes of the link-local timesynch beacons. The UDP checksum
+     computed by uIP no longer holds then, so it is elided from the
+     compressed header and the receiver computes it. */
+  if(UIP_IP_BUF->proto == UIP_PROTO_UDP &&
+     UIP_UDP_BUF->srcport == UIP_HTONS(TIMESYNCH_UDP_PORT) &&
+     UIP_UDP_BUF->destport == UIP_HTONS(TIMESYNCH_UDP_PORT) &&
+     uip_is_addr_linklocal_allnodes_mcast(&UIP_IP_BUF->destipaddr)) {
+    packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
+                       PACKETBUF_ATTR_PACKET_TYPE_TIMESTAMP);
+  }
+#endif /* TIMESYNCH_CONF_ENABLED && SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+  packetbuf_set_attr(PACKETBUF_ATTR_PRIORITY, packet_priority());
 
   /*
    * The destination address will be tagged to each outbound
@@ -1418,7 +2083,13 @@ output(uip_lladdr_t *localdest)
     compress_hdr_ipv6(&dest);
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+#if SICSLOWPAN_GHC
+    ghc_allowed = 1;
+#endif /* SICSLOWPAN_GHC */
     compress_hdr_hc06(&dest);
+#if SICSLOWPAN_GHC
+    ghc_allowed = 0;
+#endif /* SICSLOWPAN_GHC */
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
   } else {
     compress_hdr_ipv6(&dest);
@@ -1428,24 +2099,7 @@ output(uip_lladdr_t *localdest)
   /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_RDC.
    * We calculate it here only to make a better decision of whether the outgoing packet
    * needs to be fragmented or not. */
-#define USE_FRAMER_HDRLEN 1
-#if USE_FRAMER_HDRLEN
-  packetbuf_clear();
-  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
-  framer_hdrlen = NETSTACK_FRAMER.create();
-  if(framer_hdrlen < 0) {
-    /* Framing failed, we assume the maximum header length */
-    framer_hdrlen = 21;
-  }
-  packetbuf_clear();
-
-  /* We must set the max transmissions attribute again after clearing
-     the buffer. */
-  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
-                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
-#else /* USE_FRAMER_HDRLEN */
-  framer_hdrlen = 21;
-#endif /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = framer_hdr_len(&dest);
 
   if((int)uip_len - (int)uncomp_hdr_len > (int)MAC_MAX_PAYLOAD - framer_hdrlen - (int)rime_hdr_len) {
 #if SICSLOWPAN_CONF_FRAG
@@ -1560,14 +2214,229 @@ output(uip_lladdr_t *localdest)
      * The packet does not need to be fragmented
      * copy "payload" and send
      */
-    memcpy(rime_ptr + rime_hdr_len, (uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
-           uip_len - uncomp_hdr_len);
-    packetbuf_set_datalen(uip_len - uncomp_hdr_len + rime_hdr_len);
+#if SICSLOWPAN_TX_IN_PLACE
+    if(!borrow_uip_buf())
+#endif /* SICSLOWPAN_TX_IN_PLACE */
+    {
+      memcpy(rime_ptr + rime_hdr_len, (uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
+             uip_len - uncomp_hdr_len);
+      packetbuf_set_datalen(uip_len - uncomp_hdr_len + rime_hdr_len);
+    }
     send_packet(&dest);
   }
   return 1;
 }
 
+#if SICSLOWPAN_CONF_FRAG
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Get a reassembly context for a new fragmented packet
+ *
+ * If all contexts are in use, the one that has been reassembling for
+ * the longest time is reused. We prefer to start reassembling the new
+ * packet, since this lessens the negative impacts of too high
+ * SICSLOWPAN_REASS_MAXAGE.
+ */
+static struct sicslowpan_reass *
+reass_alloc(void)
+{
+  struct sicslowpan_reass *r, *oldest;
+
+  oldest = NULL;
+  for(r = reass_contexts; r < &reass_contexts[SICSLOWPAN_REASS_CONTEXTS]; r++) {
+    if(r->len == 0) {
+      return r;
+    }
+    if(oldest == NULL ||
+       clock_time() - r->timer.start > clock_time() - oldest->timer.start) {
+      oldest = r;
+    }
+  }
+  PRINTFI("sicslowpan input: dropping reassembly of tag %d for new packet\n",
+          oldest->tag);
+  SICSLOWPAN_REASS_STATS_ADD(evicted);
+  return oldest;
+}
+#if SICSLOWPAN_CONF_FRAG_FORWARD
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find the next hop of the packet being reassembled, if it can
+ * be relayed fragment by fragment
+ * \return The link layer address of the next hop, or NULL if the
+ * packet must be reassembled and passed to the IP layer
+ *
+ * Packets for us, multicast packets, packets with extension headers
+ * (that the IP layer may have to process, such as the RPL hop-by-hop
+ * option) and packets whose hop limit expires are left to the IP
+ * layer. The next hop is looked up as in tcpip_ipv6_output().
+ */
+static rimeaddr_t *
+fwd_nexthop(void)
+{
+  uip_ipaddr_t *nexthop;
+  uip_ds6_route_t *route;
+  uip_ds6_nbr_t *nbr;
+
+  if(uip_is_addr_mcast(&SICSLOWPAN_IP_BUF->destipaddr) ||
+     uip_ds6_is_my_addr(&SICSLOWPAN_IP_BUF->destipaddr)) {
+    return NULL;
+  }
+  if(SICSLOWPAN_IP_BUF->proto != UIP_PROTO_UDP &&
+     SICSLOWPAN_IP_BUF->proto != UIP_PROTO_TCP &&
+     SICSLOWPAN_IP_BUF->proto != UIP_PROTO_ICMP6) {
+    return NULL;
+  }
+  if(SICSLOWPAN_IP_BUF->ttl <= 1) {
+    return NULL;
+  }
+
+  if(uip_ds6_is_addr_onlink(&SICSLOWPAN_IP_BUF->destipaddr)) {
+    nexthop = &SICSLOWPAN_IP_BUF->destipaddr;
+  } else {
+    route = uip_ds6_route_lookup(&SICSLOWPAN_IP_BUF->destipaddr);
+    if(route == NULL) {
+      nexthop = uip_ds6_defrt_choose();
+    } else {
+      nexthop = uip_ds6_route_nexthop(route);
+    }
+  }
+  if(nexthop == NULL) {
+    return NULL;
+  }
+
+  nbr = uip_ds6_nbr_lookup(nexthop);
+  if(nbr == NULL || nbr->state == NBR_INCOMPLETE) {
+    return NULL;
+  }
+  return (rimeaddr_t *)uip_ds6_nbr_get_ll(nbr);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Relay the first fragment of the packet being reassembled
+ * \param nexthop The link layer address of the next hop
+ * \return 1 if the fragment was relayed, 0 if the packet must be
+ * reassembled
+ *
+ * The IP header is taken from the reassembly buffer, its hop
+ * limit is decremented and it is compressed again for the next
+ * hop. The fragment payload is left unchanged, so that the
+ * following fragments can be relayed as they are.
+ */
+static int
+fwd_first_fragment(rimeaddr_t *nexthop)
+{
+  struct sicslowpan_fwd *f;
+  int framer_hdrlen;
+  int payload_len;
+
+  for(f = fwd_entries; f < &fwd_entries[SICSLOWPAN_FRAG_FORWARD_ENTRIES]; f++) {
+    if(f->len == 0) {
+      break;
+    }
+  }
+  if(f == &fwd_entries[SICSLOWPAN_FRAG_FORWARD_ENTRIES]) {
+    return 0;
+  }
+
+  memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF,
+         reass->processed_ip_in_len);
+  UIP_IP_BUF->ttl = UIP_IP_BUF->ttl - 1;
+
+  packetbuf_clear();
+  rime_ptr = packetbuf_dataptr();
+  uncomp_hdr_len = 0;
+  rime_hdr_len = 0;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC1
+  compress_hdr_hc1(nexthop);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC1 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6
+  compress_hdr_ipv6(nexthop);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  compress_hdr_hc06(nexthop);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+
+  /* The compressed header may be larger than the one we received,
+     since the addresses can no longer be derived from the link layer
+     addresses of the previous hop. */
+  framer_hdrlen = framer_hdr_len(nexthop);
+  payload_len = (int)reass->processed_ip_in_len - (int)uncomp_hdr_len;
+  if(payload_len < 0 ||
+     payload_len > (int)MAC_MAX_PAYLOAD - framer_hdrlen -
+     (int)rime_hdr_len - SICSLOWPAN_FRAG1_HDR_LEN) {
+    PRINTFI("sicslowpan input: first fragment does not fit, reassembling\n");
+    return 0;
+  }
+
+  memmove(rime_ptr + SICSLOWPAN_FRAG1_HDR_LEN, rime_ptr, rime_hdr_len);
+  SET16(RIME_FRAG_PTR, RIME_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | reass->len));
+  SET16(RIME_FRAG_PTR, RIME_FRAG_TAG, my_tag);
+  rime_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  memcpy(rime_ptr + rime_hdr_len, (uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
+         payload_len);
+  packetbuf_set_datalen(payload_len + rime_hdr_len);
+
+  f->len = reass->len;
+  f->tag = reass->tag;
+  f->fwd_tag = my_tag;
+  rimeaddr_copy(&f->sender, &reass->sender);
+  rimeaddr_copy(&f->nexthop, nexthop);
+  timer_set(&f->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  my_tag++;
+
+  PRINTFI("sicslowpan input: relaying first fragment (len %d, tag %d -> %d)\n",
+          f->len, f->tag, f->fwd_tag);
+  send_packet(&f->nexthop);
+  SICSLOWPAN_REASS_STATS_ADD(forwarded);
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Relay a fragment of a packet whose first fragment we relayed
+ * \return 1 if the fragment was relayed, 0 if it is not part of a
+ * packet we relay
+ *
+ * The fragment in packetbuf is sent as it is, except for the
+ * datagram tag.
+ */
+static int
+fwd_fragment(uint16_t frag_size, uint16_t frag_tag, uint8_t frag_offset)
+{
+  struct sicslowpan_fwd *f;
+
+  for(f = fwd_entries; f < &fwd_entries[SICSLOWPAN_FRAG_FORWARD_ENTRIES]; f++) {
+    if(f->len > 0 && f->len == frag_size && f->tag == frag_tag &&
+       rimeaddr_cmp(&f->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+      break;
+    }
+  }
+  if(f == &fwd_entries[SICSLOWPAN_FRAG_FORWARD_ENTRIES]) {
+    return 0;
+  }
+
+  SET16(RIME_FRAG_PTR, RIME_FRAG_TAG, f->fwd_tag);
+  if(((uint16_t)frag_offset << 3) + packetbuf_datalen() -
+     SICSLOWPAN_FRAGN_HDR_LEN >= f->len) {
+    /* This is the last fragment. */
+    f->len = 0;
+  }
+
+  /* Move the fragment to the start of packetbuf, to leave room for the
+     headers of the lower layers. */
+  packetbuf_compact();
+  packetbuf_clear_hdr();
+  packetbuf_attr_clear();
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
+
+  PRINTFI("sicslowpan input: relaying fragment (offset %d, tag %d -> %d)\n",
+          frag_offset, frag_tag, f->fwd_tag);
+  send_packet(&f->nexthop);
+  return 1;
+}
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARD */
+#endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *  \param r The MAC layer
@@ -1598,16 +2467,40 @@ input(void)
   /* init */
   uncomp_hdr_len = 0;
   rime_hdr_len = 0;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  udp_chksum_elided = 0;
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
 
   /* The MAC puts the 15.4 payload inside the RIME data buffer */
   rime_ptr = packetbuf_dataptr();
 
+  link_stats_input_callback(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+#if UIP_DS6_LL_NUD_ONLY
+  uip_ds6_link_neighbor_heard(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+#endif /* UIP_DS6_LL_NUD_ONLY */
+
 #if SICSLOWPAN_CONF_FRAG
   /* if reassembly timed out, cancel it */
-  if(timer_expired(&reass_timer)) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
+  for(reass = reass_contexts;
+      reass < &reass_contexts[SICSLOWPAN_REASS_CONTEXTS]; reass++) {
+    if(reass->len > 0 && timer_expired(&reass->timer)) {
+      PRINTFI("sicslowpan input: reassembly of tag %d timed out\n", reass->tag);
+      reass->len = 0;
+      SICSLOWPAN_REASS_STATS_ADD(timedout);
+    }
   }
+  reass = NULL;
+  sicslowpan_buf = uip_buf;
+#if SICSLOWPAN_CONF_FRAG_FORWARD
+  {
+    struct sicslowpan_fwd *f;
+    for(f = fwd_entries; f < &fwd_entries[SICSLOWPAN_FRAG_FORWARD_ENTRIES]; f++) {
+      if(f->len > 0 && timer_expired(&f->timer)) {
+        f->len = 0;
+      }
+    }
+  }
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARD */
   /*
    * Since we don't support the mesh and broadcast header, the first header
    * we look for is the fragmentation header
@@ -1639,72 +2532,70 @@ input(void)
       PRINTFI("size %d, tag %d, offset %d)\n",
              frag_size, frag_tag, frag_offset);
       rime_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
-
-      /* If this is the last fragment, we may shave off any extrenous
-         bytes at the end. We must be liberal in what we accept. */
-      PRINTFI("last_fragment?: processed_ip_in_len %d rime_payload_len %d frag_size %d\n",
-              processed_ip_in_len, packetbuf_datalen() - rime_hdr_len, frag_size);
-
-      if(processed_ip_in_len + packetbuf_datalen() - rime_hdr_len >= frag_size) {
-        last_fragment = 1;
-      }
       is_fragment = 1;
       break;
     default:
       break;
   }
 
-  /* We are currently reassembling a packet, but have just received the first
-   * fragment of another packet. We can either ignore it and hope to receive
-   * the rest of the under-reassembly packet fragments, or we can discard the
-   * previous packet altogether, and start reassembling the new packet.
-   *
-   * We discard the previous packet, and start reassembling the new packet.
-   * This lessens the negative impacts of too high SICSLOWPAN_REASS_MAXAGE.
-   */
-#define PRIORITIZE_NEW_PACKETS 1
-#if PRIORITIZE_NEW_PACKETS
-  if(processed_ip_in_len > 0 && first_fragment
-      && !rimeaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  }
-#endif /* PRIORITIZE_NEW_PACKETS */
-
-  if(processed_ip_in_len > 0) {
-    /* reassembly is ongoing */
-    /*    printf("frag %d %d\n", reass_tag, frag_tag);*/
-    if((frag_size > 0 &&
-        (frag_size != sicslowpan_len ||
-         reass_tag  != frag_tag ||
-         !rimeaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))))  ||
-       frag_size == 0) {
-      /*
-       * the packet is a fragment that does not belong to the packet
-       * being reassembled or the packet is not a fragment.
-       */
-      PRINTFI("sicslowpan input: Dropping 6lowpan packet that is not a fragment of the packet currently being reassembled\n");
-      return;
+#if SICSLOWPAN_CONF_FRAG_FORWARD
+  if(is_fragment && !first_fragment &&
+     fwd_fragment(frag_size, frag_tag, frag_offset)) {
+    return;
+  }
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARD */
+
+  if(is_fragment) {
+    /* Find the reassembly context of the packet this fragment belongs to. */
+    for(reass = reass_contexts;
+        reass < &reass_contexts[SICSLOWPAN_REASS_CONTEXTS]; reass++) {
+      if(reass->len > 0 && reass->len == frag_size && reass->tag == frag_tag &&
+         rimeaddr_cmp(&reass->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+        break;
+      }
     }
-  } else {
-    /*
-     * reassembly is off
-     * start it if we received a fragment
-     */
-    if((frag_size > 0) && (frag_size <= UIP_BUFSIZE)) {
-      /* We are currently not reassembling a packet, but have received a packet fragment
-       * that is not the first one. */
-      if(is_fragment && !first_fragment) {
+    if(reass == &reass_contexts[SICSLOWPAN_REASS_CONTEXTS]) {
+      reass = NULL;
+    }
+
+    if(first_fragment) {
+      if(frag_size == 0 || frag_size > UIP_BUFSIZE) {
+        PRINTFI("sicslowpan input: Dropping fragment of too large packet (%d)\n",
+                frag_size);
+        SICSLOWPAN_REASS_STATS_ADD(dropped);
         return;
       }
-
-      sicslowpan_len = frag_size;
-      reass_tag = frag_tag;
-      timer_set(&reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+      if(reass == NULL) {
+        reass = reass_alloc();
+        SICSLOWPAN_REASS_STATS_ADD(started);
+      }
+      /* A first fragment (re)starts the reassembly of the packet. */
+      reass->len = frag_size;
+      reass->processed_ip_in_len = 0;
+      reass->tag = frag_tag;
+      timer_set(&reass->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
       PRINTFI("sicslowpan input: INIT FRAGMENTATION (len %d, tag %d)\n",
-             sicslowpan_len, reass_tag);
-      rimeaddr_copy(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+              reass->len, reass->tag);
+      rimeaddr_copy(&reass->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+    } else if(reass == NULL) {
+      /*
+       * the packet is a fragment that does not belong to any packet
+       * being reassembled.
+       */
+      PRINTFI("sicslowpan input: Dropping 6lowpan fragment that does not belong to a packet being reassembled\n");
+      SICSLOWPAN_REASS_STATS_ADD(dropped);
+      return;
+    } else {
+      /* If this is the last fragment, we may shave off any extrenous
+         bytes at the end. We must be liberal in what we accept. */
+      PRINTFI("last_fragment?: processed_ip_in_len %d rime_payload_len %d frag_size %d\n",
+              reass->processed_ip_in_len, packetbuf_datalen() - rime_hdr_len, frag_size);
+
+      if(reass->processed_ip_in_len + packetbuf_datalen() - rime_hdr_len >= frag_size) {
+        last_fragment = 1;
+      }
     }
+    sicslowpan_buf = reass->buf.u8;
   }
 
   if(rime_hdr_len == SICSLOWPAN_FRAGN_HDR_LEN) {
@@ -1766,11 +2657,11 @@ input(void)
   {
     int req_size = UIP_LLH_LEN + uncomp_hdr_len + (uint16_t)(frag_offset << 3)
         + rime_payload_len;
-    if(req_size > sizeof(sicslowpan_buf)) {
+    if(req_size > UIP_BUFSIZE) {
       PRINTF(
           "SICSLOWPAN: packet dropped, minimum required SICSLOWPAN_IP_BUF size: %d+%d+%d+%d=%d (current size: %d)\n",
           UIP_LLH_LEN, uncomp_hdr_len, (uint16_t)(frag_offset << 3),
-          rime_payload_len, req_size, sizeof(sicslowpan_buf));
+          rime_payload_len, req_size, UIP_BUFSIZE);
       return;
     }
   }
@@ -1780,19 +2671,31 @@ input(void)
   /* update processed_ip_in_len if fragment, sicslowpan_len otherwise */
 
 #if SICSLOWPAN_CONF_FRAG
-  if(frag_size > 0) {
+  if(reass != NULL) {
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
-      processed_ip_in_len += uncomp_hdr_len;
+      reass->processed_ip_in_len += uncomp_hdr_len;
     }
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
     if(last_fragment != 0) {
-      processed_ip_in_len = frag_size;
+      reass->processed_ip_in_len = frag_size;
     } else {
-      processed_ip_in_len += rime_payload_len;
+      reass->processed_ip_in_len += rime_payload_len;
+    }
+    PRINTF("processed_ip_in_len %d, rime_payload_len %d\n",
+           reass->processed_ip_in_len, rime_payload_len);
+
+#if SICSLOWPAN_CONF_FRAG_FORWARD
+    /* Relay the packet fragment by fragment if it is not for us. */
+    if(first_fragment && reass->processed_ip_in_len < reass->len) {
+      rimeaddr_t *nexthop = fwd_nexthop();
+      if(nexthop != NULL && fwd_first_fragment(nexthop)) {
+        reass->len = 0;
+        return;
+      }
     }
-    PRINTF("processed_ip_in_len %d, rime_payload_len %d\n", processed_ip_in_len, rime_payload_len);
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARD */
 
   } else {
 #endif /* SICSLOWPAN_CONF_FRAG */
@@ -1804,15 +2707,18 @@ input(void)
    * If we have a full IP packet in sicslowpan_buf, deliver it to
    * the IP stack
    */
-  PRINTF("sicslowpan_init processed_ip_in_len %d, sicslowpan_len %d\n",
-         processed_ip_in_len, sicslowpan_len);
-  if(processed_ip_in_len == 0 || (processed_ip_in_len == sicslowpan_len)) {
-    PRINTFI("sicslowpan input: IP packet ready (length %d)\n",
-           sicslowpan_len);
-    memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, sicslowpan_len);
-    uip_len = sicslowpan_len;
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
+  if(reass == NULL || reass->processed_ip_in_len == reass->len) {
+    if(reass != NULL) {
+      PRINTFI("sicslowpan input: IP packet ready (length %d)\n", reass->len);
+      memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, reass->len);
+      uip_len = reass->len;
+      reass->len = 0;
+      SICSLOWPAN_REASS_STATS_ADD(completed);
+    } else {
+      PRINTFI("sicslowpan input: IP packet ready (length %d)\n",
+              sicslowpan_len);
+      uip_len = sicslowpan_len;
+    }
 #endif /* SICSLOWPAN_CONF_FRAG */
 
 #if DEBUG
@@ -1827,6 +2733,19 @@ input(void)
     }
 #endif
 
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 && UIP_UDP_CHECKSUMS
+    /* Only a packet that came in one frame is still marked here. The
+       fragments of a larger one keep a zero checksum. */
+    if(udp_chksum_elided) {
+      /* A compressed UDP header directly follows the IPv6 header */
+      uip_ext_len = 0;
+      UIP_UDP_BUF->udpchksum = ~(uip_udpchksum());
+      if(UIP_UDP_BUF->udpchksum == 0) {
+        UIP_UDP_BUF->udpchksum = 0xffff;
+      }
+    }
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 && UIP_UDP_CHECKSUMS */
+
     /* if callback is set then set attributes and call */
     if(callback) {
       set_packet_attrs();
@@ -1852,6 +2771,8 @@ sicslowpan_init(void)
    */
   tcpip_set_outputfunc(output);
 
+  link_stats_init();
+
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
 /* Preinitialize any address contexts for better header compression
  * (Saves up to 13 bytes per 6lowpan packet)
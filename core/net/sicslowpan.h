@@ -143,6 +143,19 @@
 #define SICSLOWPAN_NHC_MASK                         0xF0
 #define SICSLOWPAN_NHC_EXT_HDR                      0xE0
 
+/**
+ * \name 6LoWPAN-GHC (RFC 7400) encoding
+ * @{
+ */
+#define SICSLOWPAN_NHC_GHC_ICMP6                    0xDF
+
+#define SICSLOWPAN_GHC_LITERAL_MAX                  95
+#define SICSLOWPAN_GHC_ZEROS                        0x80
+#define SICSLOWPAN_GHC_STOP                         0x90
+#define SICSLOWPAN_GHC_EXTEND                       0xA0
+#define SICSLOWPAN_GHC_BACKREF                      0xC0
+/** @} */
+
 /**
  * \name LOWPAN_UDP encoding (works together with IPHC)
  * @{
@@ -318,7 +331,47 @@ struct sicslowpan_nh_compressor {
 };
 
 
+#if SICSLOWPAN_CONF_REASS_STATS
+/**
+ * \brief Statistics on 6lowpan reassembly
+ */
+struct sicslowpan_reass_stats {
+  uint16_t started;     /**< Number of datagrams whose reassembly started. */
+  uint16_t completed;   /**< Number of datagrams that were reassembled. */
+  uint16_t timedout;    /**< Number of reassemblies that timed out. */
+  uint16_t evicted;     /**< Number of reassemblies dropped to make room
+                             for a new datagram. */
+  uint16_t dropped;     /**< Number of fragments dropped since they did
+                             not belong to any datagram. */
+  uint16_t forwarded;   /**< Number of datagrams relayed fragment by
+                             fragment, without reassembly. */
+};
+
+extern struct sicslowpan_reass_stats sicslowpan_reass_stats;
+#define SICSLOWPAN_REASS_STATS_ADD(x) sicslowpan_reass_stats.x++
+#else /* SICSLOWPAN_CONF_REASS_STATS */
+#define SICSLOWPAN_REASS_STATS_ADD(x)
+#endif /* SICSLOWPAN_CONF_REASS_STATS */
+
 extern const struct network_driver sicslowpan_driver;
 
+/**
+ * \brief Install or update an IPHC address context
+ * \param number The context identifier, 0-15
+ * \param prefix The address whose first 64 bits form the context prefix
+ * \return 1 if the context was installed, 0 if there was no room
+ *
+ * Contexts are learned at run-time from RPL DIOs and from 6LoWPAN
+ * context options in router advertisements, so that global addresses
+ * can be compressed without configuring the prefix beforehand.
+ */
+int sicslowpan_context_set(uint8_t number, const uip_ipaddr_t *prefix);
+
+/**
+ * \brief Remove an IPHC address context
+ * \param number The context identifier, 0-15
+ */
+void sicslowpan_context_remove(uint8_t number);
+
 #endif /* __SICSLOWPAN_H__ */
 /** @} */
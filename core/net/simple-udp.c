@@ -51,6 +51,8 @@ PROCESS(simple_udp_process, "Simple UDP process");
 static uint8_t started = 0;
 static uint8_t databuffer[UIP_BUFSIZE];
 
+static void appcall(void *state);
+
 #define UIP_IP_BUF   ((struct uip_udpip_hdr *)&uip_buf[UIP_LLH_LEN])
 
 /*---------------------------------------------------------------------------*/
@@ -63,6 +65,25 @@ init_simple_udp(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the buffer for the payload of the next UDP packet
+ * \param capacity Set to the number of bytes that fit in the buffer,
+ *                 if not NULL
+ * \return     A pointer to the buffer
+ *
+ *             Data written to this buffer and then passed to one of
+ *             the send functions is sent without being copied. The
+ *             buffer is shared with the IP stack and must not be used
+ *             from within a receive callback.
+ *
+ * \sa uip_udp_packet_reserve()
+ */
+void *
+simple_udp_reserve(uint16_t *capacity)
+{
+  return uip_udp_packet_reserve(capacity);
+}
+/*---------------------------------------------------------------------------*/
 /**
  * \brief      Send a UDP packet
  * \param c    A pointer to a struct simple_udp_connection
@@ -176,11 +197,16 @@ simple_udp_register(struct simple_udp_connection *c,
     uip_ipaddr_copy(&c->remote_addr, remote_addr);
   }
   c->receive_callback = receive_callback;
+  c->client_process = PROCESS_CURRENT();
 
   PROCESS_CONTEXT_BEGIN(&simple_udp_process);
   c->udp_conn = udp_new(remote_addr, UIP_HTONS(remote_port), c);
   if(c->udp_conn != NULL) {
     udp_bind(c->udp_conn, UIP_HTONS(local_port));
+#if TCPIP_DIRECT_APPCALL
+    /* Skip the dispatch through simple_udp_process for every packet */
+    udp_set_appcall(c->udp_conn, appcall);
+#endif
   }
   PROCESS_CONTEXT_END();
 
@@ -190,51 +216,54 @@ simple_udp_register(struct simple_udp_connection *c,
   return 1;
 }
 /*---------------------------------------------------------------------------*/
-PROCESS_THREAD(simple_udp_process, ev, data)
+static void
+appcall(void *state)
 {
   struct simple_udp_connection *c;
+
+  c = (struct simple_udp_connection *)state;
+
+  /* Defensive coding: although the appstate *should* be non-null
+     here, we make sure to avoid the program crashing on us. */
+  if(c == NULL) {
+    return;
+  }
+
+  /* If we were called because of incoming data, we should call the
+     reception callback. */
+  if(uip_newdata()) {
+    /* Copy the data from the uIP data buffer into our own buffer to
+       avoid the uIP buffer being messed with by the callee. */
+    memcpy(databuffer, uip_appdata, uip_datalen());
+
+    /* Call the client process. We use the PROCESS_CONTEXT mechanism
+       to temporarily switch process context to the client process. */
+    if(c->receive_callback != NULL) {
+      PROCESS_CONTEXT_BEGIN(c->client_process);
+      c->receive_callback(c,
+                          &(UIP_IP_BUF->srcipaddr),
+                          UIP_HTONS(UIP_IP_BUF->srcport),
+                          &(UIP_IP_BUF->destipaddr),
+                          UIP_HTONS(UIP_IP_BUF->destport),
+                          databuffer, uip_datalen());
+      PROCESS_CONTEXT_END();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(simple_udp_process, ev, data)
+{
   PROCESS_BEGIN();
   
   while(1) {
     PROCESS_WAIT_EVENT();
     if(ev == tcpip_event) {
-
       /* An appstate pointer is passed to use from the IP stack
          through the 'data' pointer. We registered this appstate when
          we did the udp_new() call in simple_udp_register() as the
-         struct simple_udp_connection pointer. So we extract this
-         pointer and use it when calling the reception callback. */
-      c = (struct simple_udp_connection *)data;
-
-      /* Defensive coding: although the appstate *should* be non-null
-         here, we make sure to avoid the program crashing on us. */
-      if(c != NULL) {
-
-        /* If we were called because of incoming data, we should call
-           the reception callback. */
-        if(uip_newdata()) {
-          /* Copy the data from the uIP data buffer into our own
-             buffer to avoid the uIP buffer being messed with by the
-             callee. */
-          memcpy(databuffer, uip_appdata, uip_datalen());
-
-          /* Call the client process. We use the PROCESS_CONTEXT
-             mechanism to temporarily switch process context to the
-             client process. */
-          if(c->receive_callback != NULL) {
-            PROCESS_CONTEXT_BEGIN(c->client_process);
-            c->receive_callback(c,
-                                &(UIP_IP_BUF->srcipaddr),
-                                UIP_HTONS(UIP_IP_BUF->srcport),
-                                &(UIP_IP_BUF->destipaddr),
-                                UIP_HTONS(UIP_IP_BUF->destport),
-                                databuffer, uip_datalen());
-            PROCESS_CONTEXT_END();
-          }
-        }
-      }
+         struct simple_udp_connection pointer. */
+      appcall(data);
     }
-
   }
 
   PROCESS_END();
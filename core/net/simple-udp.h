@@ -79,6 +79,8 @@ int simple_udp_register(struct simple_udp_connection *c,
                         uint16_t remote_port,
                         simple_udp_callback receive_callback);
 
+void *simple_udp_reserve(uint16_t *capacity);
+
 int simple_udp_send(struct simple_udp_connection *c,
                     const void *data, uint16_t datalen);
 
@@ -45,6 +45,7 @@
 #if UIP_CONF_IPV6
 #include "net/uip-nd6.h"
 #include "net/uip-ds6.h"
+#include "net/uip-mcast6.h"
 #endif
 
 #include <string.h>
@@ -128,6 +129,38 @@ tcpip_set_outputfunc(uint8_t (*f)(uip_lladdr_t *))
 {
   outputfunc = f;
 }
+
+#if TCPIP_INTERFACES
+LIST(interfaces);
+
+void
+tcpip_add_interface(struct tcpip_interface *iface)
+{
+  list_add(interfaces, iface);
+}
+
+void
+tcpip_remove_interface(struct tcpip_interface *iface)
+{
+  list_remove(interfaces, iface);
+}
+
+static struct tcpip_interface *
+interface_lookup(uip_ipaddr_t *addr)
+{
+  struct tcpip_interface *iface;
+  struct tcpip_interface *found;
+
+  found = NULL;
+  for(iface = list_head(interfaces); iface != NULL; iface = iface->next) {
+    if(uip_ipaddr_prefixcmp(addr, &iface->prefix, iface->prefix_len) &&
+       (found == NULL || iface->prefix_len > found->prefix_len)) {
+      found = iface;
+    }
+  }
+  return found;
+}
+#endif /* TCPIP_INTERFACES */
 #else
 
 static uint8_t (* outputfunc)(void);
@@ -291,6 +324,9 @@ tcp_attach(struct uip_conn *conn,
   s = &conn->appstate;
   s->p = PROCESS_CURRENT();
   s->state = appstate;
+#if TCPIP_DIRECT_APPCALL
+  s->appcall = NULL;
+#endif
 }
 
 #endif /* UIP_TCP */
@@ -305,7 +341,18 @@ udp_attach(struct uip_udp_conn *conn,
   s = &conn->appstate;
   s->p = PROCESS_CURRENT();
   s->state = appstate;
+#if TCPIP_DIRECT_APPCALL
+  s->appcall = NULL;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+#if TCPIP_DIRECT_APPCALL
+void
+udp_set_appcall(struct uip_udp_conn *conn, tcpip_appcall_t appcall)
+{
+  conn->appstate.appcall = appcall;
 }
+#endif /* TCPIP_DIRECT_APPCALL */
 /*---------------------------------------------------------------------------*/
 struct uip_udp_conn *
 udp_new(const uip_ipaddr_t *ripaddr, uint16_t port, void *appstate)
@@ -536,11 +583,69 @@ tcpip_input(void)
 }
 /*---------------------------------------------------------------------------*/
 #if UIP_CONF_IPV6
+#if defined(UIP_FALLBACK_INTERFACE) || TCPIP_INTERFACES
+/* Removes the extension headers, which only concern the primary
+   interface, before a packet is sent on another interface. */
+static void
+remove_ext_headers(void)
+{
+  if(uip_ext_len > 0) {
+    extern void remove_ext_hdr(void);
+    uint8_t proto = *((uint8_t *)UIP_IP_BUF + 40);
+    remove_ext_hdr();
+    /* This should be copied from the ext header... */
+    UIP_IP_BUF->proto = proto;
+  }
+}
+#endif /* UIP_FALLBACK_INTERFACE || TCPIP_INTERFACES */
+/*---------------------------------------------------------------------------*/
+/* The neighbor that the last packet of the current batch was sent
+   to, and the destination address of that packet. */
+static uint8_t batch_active;
+static uip_ipaddr_t batch_dest;
+static uip_ds6_nbr_t *batch_nbr;
+
+void
+tcpip_batch_begin(void)
+{
+  batch_active = 1;
+  batch_nbr = NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+tcpip_batch_end(void)
+{
+  batch_active = 0;
+  batch_nbr = NULL;
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_CONF_IPV6_QUEUE_PKT
+/* Queues the packet in uip_buf until address resolution for nbr
+   completes. The packet is dropped if the queue is full. */
+static void
+queue_packet(uip_ds6_nbr_t *nbr)
+{
+  struct uip_packetqueue_packet *p;
+
+  p = uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME);
+  if(p != NULL) {
+    memcpy(p->queue_buf, UIP_IP_BUF, uip_len);
+    p->queue_buf_len = uip_len;
+  }
+}
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
+/*---------------------------------------------------------------------------*/
 void
 tcpip_ipv6_output(void)
 {
   uip_ds6_nbr_t *nbr = NULL;
   uip_ipaddr_t *nexthop;
+#if TCPIP_INTERFACES
+  struct tcpip_interface *iface;
+#endif /* TCPIP_INTERFACES */
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+  uip_ipaddr_t srh_nexthop;
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
 
   if(uip_len == 0) {
     return;
@@ -562,11 +667,54 @@ tcpip_ipv6_output(void)
     /* Next hop determination */
     nbr = NULL;
 
+#if TCPIP_INTERFACES
+    iface = interface_lookup(&UIP_IP_BUF->destipaddr);
+    if(iface != NULL) {
+      remove_ext_headers();
+      if(uip_len > iface->mtu) {
+        UIP_LOG("tcpip_ipv6_output: Packet to big for interface");
+      } else {
+        iface->output();
+      }
+      uip_len = 0;
+      uip_ext_len = 0;
+      return;
+    }
+#endif /* TCPIP_INTERFACES */
+
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+    /* As the root of a non-storing DAG, we source route packets to
+       the nodes in it. */
+    if(!rpl_insert_srh_header()) {
+      uip_len = 0;
+      return;
+    }
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
+
+    /* Within a batch, packets to the destination of the previous
+       packet go to the same neighbor without a new lookup. */
+    if(batch_nbr != NULL &&
+       uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &batch_dest)) {
+#if UIP_CONF_IPV6_RPL
+      if(rpl_update_header_final(&batch_nbr->ipaddr)) {
+        uip_len = 0;
+        return;
+      }
+#endif /* UIP_CONF_IPV6_RPL */
+      tcpip_output(uip_ds6_nbr_get_ll(batch_nbr));
+      uip_len = 0;
+      return;
+    }
+
     /* We first check if the destination address is on our immediate
        link. If so, we simply use the destination address as our
        nexthop address. */
     if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)){
       nexthop = &UIP_IP_BUF->destipaddr;
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+    } else if(rpl_srh_get_next_hop(&srh_nexthop)) {
+      nexthop = &srh_nexthop;
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
     } else {
       uip_ds6_route_t *route;
       /* Check if we have a route to the destination address. */
@@ -580,13 +728,7 @@ tcpip_ipv6_output(void)
 #ifdef UIP_FALLBACK_INTERFACE
 	  PRINTF("FALLBACK: removing ext hdrs & setting proto %d %d\n", 
 		 uip_ext_len, *((uint8_t *)UIP_IP_BUF + 40));
-	  if(uip_ext_len > 0) {
-	    extern void remove_ext_hdr(void);
-	    uint8_t proto = *((uint8_t *)UIP_IP_BUF + 40);
-	    remove_ext_hdr();
-	    /* This should be copied from the ext header... */
-	    UIP_IP_BUF->proto = proto;
-	  }
+	  remove_ext_headers();
 	  UIP_FALLBACK_INTERFACE.output();
 #else
           PRINTF("tcpip_ipv6_output: Destination off-link but no route\n");
@@ -648,18 +790,33 @@ tcpip_ipv6_output(void)
     }
 #endif /* UIP_CONF_IPV6_RPL */
     nbr = uip_ds6_nbr_lookup(nexthop);
+#if UIP_ND6_6LOWPAN
+    /* RFC 6775: link-local addresses are built from the link-layer
+       address, so we resolve them without a multicast NS. */
+    if(nbr == NULL && uip_is_addr_link_local(nexthop)) {
+      uip_lladdr_t lladdr;
+
+      uip_ds6_set_lladdr_from_iid(&lladdr, nexthop);
+      if((nbr = uip_ds6_nbr_add(nexthop, &lladdr, 0, NBR_REACHABLE)) != NULL) {
+        stimer_set(&nbr->reachable, uip_ds6_if.reachable_time / 1000);
+      }
+    }
+#endif /* UIP_ND6_6LOWPAN */
+
     if(nbr == NULL) {
-#if UIP_ND6_SEND_NA
+#if UIP_ND6_6LOWPAN
+      /* Other next hops are our routers or have registered with us */
+      PRINTF("tcpip_ipv6_output: next hop not registered, dropping\n");
+      uip_len = 0;
+      return;
+#elif UIP_ND6_SEND_NA
       if((nbr = uip_ds6_nbr_add(nexthop, NULL, 0, NBR_INCOMPLETE)) == NULL) {
         uip_len = 0;
         return;
       } else {
 #if UIP_CONF_IPV6_QUEUE_PKT
         /* Copy outgoing pkt in the queuing buffer for later transmit. */
-        if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-          memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-          uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
-        }
+        queue_packet(nbr);
 #endif
       /* RFC4861, 7.2.2:
        * "If the source address of the packet prompting the solicitation is the
@@ -676,7 +833,7 @@ tcpip_ipv6_output(void)
         stimer_set(&nbr->sendns, uip_ds6_if.retrans_timer / 1000);
         nbr->nscount = 1;
       }
-#endif /* UIP_ND6_SEND_NA */
+#endif /* UIP_ND6_6LOWPAN */
     } else {
 #if UIP_ND6_SEND_NA
       if(nbr->state == NBR_INCOMPLETE) {
@@ -684,10 +841,7 @@ tcpip_ipv6_output(void)
 #if UIP_CONF_IPV6_QUEUE_PKT
         /* Copy outgoing pkt in the queuing buffer for later transmit and set
            the destination nbr to nbr. */
-        if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-          memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-          uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
-        }
+        queue_packet(nbr);
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
         uip_len = 0;
         return;
@@ -702,6 +856,11 @@ tcpip_ipv6_output(void)
       }
 #endif /* UIP_ND6_SEND_NA */
 
+      if(batch_active) {
+        uip_ipaddr_copy(&batch_dest, &UIP_IP_BUF->destipaddr);
+        batch_nbr = nbr;
+      }
+
       tcpip_output(uip_ds6_nbr_get_ll(nbr));
 
 #if UIP_CONF_IPV6_QUEUE_PKT
@@ -709,9 +868,9 @@ tcpip_ipv6_output(void)
        * Send the queued packets from here, may not be 100% perfect though.
        * This happens in a few cases, for example when instead of receiving a
        * NA after sendiong a NS, you receive a NS with SLLAO: the entry moves
-       * to STALE, and you must both send a NA and the queued packet.
+       * to STALE, and you must both send a NA and the queued packets.
        */
-      if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
+      while(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
         uip_len = uip_packetqueue_buflen(&nbr->packethandle);
         memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
         uip_packetqueue_free(&nbr->packethandle);
@@ -725,6 +884,15 @@ tcpip_ipv6_output(void)
     return;
   }
   /* Multicast IP destination address. */
+#if UIP_IPV6_MULTICAST
+  if(uip_is_addr_mcast_routable(&UIP_IP_BUF->destipaddr)) {
+    UIP_MCAST6.out();
+    if(uip_len == 0) {
+      uip_ext_len = 0;
+      return;
+    }
+  }
+#endif /* UIP_IPV6_MULTICAST */
   tcpip_output(NULL);
   uip_len = 0;
   uip_ext_len = 0;
@@ -776,6 +944,9 @@ tcpip_uipcall(void)
 	  l->p != PROCESS_NONE) {
 	 ts->p = l->p;
 	 ts->state = NULL;
+#if TCPIP_DIRECT_APPCALL
+	 ts->appcall = NULL;
+#endif
 	 break;
        }
        ++l;
@@ -787,6 +958,15 @@ tcpip_uipcall(void)
  }
 #endif /* UIP_TCP */
   
+#if TCPIP_DIRECT_APPCALL
+  if(ts->appcall != NULL) {
+    PROCESS_CONTEXT_BEGIN(ts->p);
+    ts->appcall(ts->state);
+    PROCESS_CONTEXT_END(ts->p);
+    return;
+  }
+#endif /* TCPIP_DIRECT_APPCALL */
+
   if(ts->p != NULL) {
     process_post_synch(ts->p, tcpip_event, ts->state);
   }
@@ -821,6 +1001,9 @@ PROCESS_THREAD(tcpip_process, ev, data)
 #if UIP_CONF_IPV6 && UIP_CONF_IPV6_RPL
   rpl_init();
 #endif /* UIP_CONF_IPV6_RPL */
+#if UIP_IPV6_MULTICAST
+  uip_mcast6_init();
+#endif /* UIP_IPV6_MULTICAST */
 
   while(1) {
     PROCESS_YIELD();
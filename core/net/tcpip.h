@@ -70,9 +70,25 @@
 
 struct uip_conn;
 
+/*
+ * With TCPIP_CONF_DIRECT_APPCALL, a connection can have a function
+ * that the stack calls directly instead of posting tcpip_event to the
+ * process with process_post_synch(). See udp_set_appcall().
+ */
+#ifdef TCPIP_CONF_DIRECT_APPCALL
+#define TCPIP_DIRECT_APPCALL TCPIP_CONF_DIRECT_APPCALL
+#else
+#define TCPIP_DIRECT_APPCALL 0
+#endif
+
+typedef void (* tcpip_appcall_t)(void *state);
+
 struct tcpip_uipstate {
   struct process *p;
   void *state;
+#if TCPIP_DIRECT_APPCALL
+  tcpip_appcall_t appcall;
+#endif
 };
 
 #define UIP_APPCALL tcpip_uipcall
@@ -228,6 +244,26 @@ void udp_attach(struct uip_udp_conn *conn,
 CCIF struct uip_udp_conn *udp_new(const uip_ipaddr_t *ripaddr, uint16_t port,
 				  void *appstate);
 
+#if TCPIP_DIRECT_APPCALL
+/**
+ * Call a function directly for events on a UDP connection.
+ *
+ * Instead of posting a synchronous tcpip_event to the process that
+ * owns the connection, the stack calls \e appcall with the appstate
+ * pointer of the connection, in the context of the owning process.
+ * This avoids a protothread dispatch per packet on the receive path.
+ * The function is called for the same events as the process would
+ * be, so it must check uip_newdata() and friends. Passing NULL
+ * restores event delivery to the process.
+ *
+ * \note Only available with TCPIP_CONF_DIRECT_APPCALL.
+ *
+ * \param conn A pointer to the UDP connection.
+ * \param appcall The function to call, or NULL.
+ */
+void udp_set_appcall(struct uip_udp_conn *conn, tcpip_appcall_t appcall);
+#endif /* TCPIP_DIRECT_APPCALL */
+
 /**
  * Create a new UDP broadcast connection.
  *
@@ -352,8 +388,68 @@ void tcpip_set_outputfunc(uint8_t (* f)(void));
  */
 #if UIP_CONF_IPV6
 void tcpip_ipv6_output(void);
+
+/**
+ * \brief      Start a batch of outgoing packets
+ *
+ *             Between tcpip_batch_begin() and tcpip_batch_end(),
+ *             tcpip_ipv6_output() remembers the neighbor that a
+ *             unicast packet was sent to. Following packets to the
+ *             same destination are handed to the MAC layer for that
+ *             neighbor without a new route and neighbor lookup, and
+ *             are queued back to back so that CSMA sends them as
+ *             one burst.
+ *
+ *             A batch must be started and ended without yielding,
+ *             since the neighbor table may change in between.
+ *
+ *             \code
+ *             tcpip_batch_begin();
+ *             for(i = 0; i < n; i++) {
+ *               simple_udp_sendto(&conn, &readings[i], sizeof(readings[i]), &sink);
+ *             }
+ *             tcpip_batch_end();
+ *             \endcode
+ */
+void tcpip_batch_begin(void);
+
+/**
+ * \brief      End a batch of outgoing packets
+ * \sa         tcpip_batch_begin()
+ */
+void tcpip_batch_end(void);
+#endif
+
+#ifdef TCPIP_CONF_INTERFACES
+#define TCPIP_INTERFACES TCPIP_CONF_INTERFACES
+#else
+#define TCPIP_INTERFACES 0
 #endif
 
+#if UIP_CONF_IPV6 && TCPIP_INTERFACES
+/**
+ * \brief An additional network interface
+ *
+ * Packets to destinations within the prefix of an additional
+ * interface are sent with its output function instead of the one set
+ * with tcpip_set_outputfunc(). Border routers use this for a wired
+ * uplink next to the radio. Additional interfaces are point-to-point
+ * links, so no neighbor discovery is done on them, and the RPL
+ * extension headers are removed before output. The interface with the
+ * longest matching prefix is used.
+ */
+struct tcpip_interface {
+  struct tcpip_interface *next;
+  uip_ipaddr_t prefix;
+  uint8_t prefix_len;
+  uint16_t mtu;
+  void (*output)(void);
+};
+
+void tcpip_add_interface(struct tcpip_interface *iface);
+void tcpip_remove_interface(struct tcpip_interface *iface);
+#endif /* UIP_CONF_IPV6 && TCPIP_INTERFACES */
+
 /**
  * \brief Is forwarding generally enabled?
  */
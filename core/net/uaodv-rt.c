@@ -41,22 +41,49 @@
 #include "net/uaodv-rt.h"
 #include "contiki-net.h"
 
+#include <string.h>
+
 #ifndef UAODV_NUM_RT_ENTRIES
 #define UAODV_NUM_RT_ENTRIES 8
 #endif
 
+#ifndef UAODV_RT_HASH_SIZE
+#define UAODV_RT_HASH_SIZE 8
+#endif
+
 /*
  * LRU (with respect to insertion time) list of route entries.
  */
 LIST(route_table);
 MEMB(route_mem, struct uaodv_rt_entry, UAODV_NUM_RT_ENTRIES);
 
+/*
+ * Route entries hashed on their destination.
+ */
+static struct uaodv_rt_entry *route_hash[UAODV_RT_HASH_SIZE];
+
+#define RT_HASH(a) (((a)->u8[2] + (a)->u8[3]) % UAODV_RT_HASH_SIZE)
+
+/*---------------------------------------------------------------------------*/
+static void
+unhash(struct uaodv_rt_entry *e)
+{
+  struct uaodv_rt_entry **p;
+
+  for(p = &route_hash[RT_HASH(&e->dest)]; *p != NULL; p = &(*p)->hnext) {
+    if(*p == e) {
+      *p = e->hnext;
+      return;
+    }
+  }
+}
 /*---------------------------------------------------------------------------*/
 void
 uaodv_rt_init(void)
 {
   list_init(route_table);
   memb_init(&route_mem);
+  memset(route_hash, 0, sizeof(route_hash));
 }
 /*---------------------------------------------------------------------------*/
 struct uaodv_rt_entry *
@@ -74,14 +101,21 @@ uaodv_rt_add(uip_ipaddr_t *dest, uip_ipaddr_t *nexthop,
     e = memb_alloc(&route_mem);
     if(e == NULL) {
       e = list_chop(route_table); /* Remove oldest entry. */
+      unhash(e);
     }
+    uip_ipaddr_copy(&e->dest, dest);
+    e->hnext = route_hash[RT_HASH(dest)];
+    route_hash[RT_HASH(dest)] = e;
   }
 
-  uip_ipaddr_copy(&e->dest, dest);
   uip_ipaddr_copy(&e->nexthop, nexthop);
   e->hop_count = hop_count;
   e->hseqno = uip_ntohl(*seqno);
   e->is_bad = 0;
+#if UAODV_ROUTE_LIFETIME
+  e->is_active = 0;
+  e->expires = clock_seconds() + UAODV_ROUTE_LIFETIME;
+#endif
 
   /* New entry goes first. */
   list_push(route_table, e);
@@ -94,7 +128,7 @@ uaodv_rt_lookup_any(uip_ipaddr_t *dest)
 {
   struct uaodv_rt_entry *e;
 
-  for(e = list_head(route_table); e != NULL; e = e->next) {
+  for(e = route_hash[RT_HASH(dest)]; e != NULL; e = e->hnext) {
     if(uip_ipaddr_cmp(dest, &e->dest)) {
       return e;
     }
@@ -108,6 +142,10 @@ uaodv_rt_lookup(uip_ipaddr_t *dest)
   struct uaodv_rt_entry *e;
 
   e = uaodv_rt_lookup_any(dest);
+#if UAODV_ROUTE_LIFETIME
+  if(e != NULL && (long)(e->expires - clock_seconds()) <= 0)
+    e->is_bad = 1;
+#endif
   if(e != NULL && e->is_bad)
     return NULL;
   return e;
@@ -118,6 +156,7 @@ void
 uaodv_rt_remove(struct uaodv_rt_entry *e)
 {
   list_remove(route_table, e);
+  unhash(e);
   memb_free(&route_mem, e);
 }
 #endif
@@ -143,4 +182,37 @@ uaodv_rt_flush_all(void)
     else
       break;
   }
+  memset(route_hash, 0, sizeof(route_hash));
+}
+/*---------------------------------------------------------------------------*/
+#if UAODV_ROUTE_LIFETIME
+/*
+ * Mark a route as carrying traffic. Only such routes are refreshed,
+ * the others are left to expire.
+ */
+void
+uaodv_rt_used(struct uaodv_rt_entry *e)
+{
+  e->is_active = 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Find a route that has been used since it was last refreshed and
+ * that expires within margin seconds, so that it can be rediscovered
+ * before it goes bad.
+ */
+struct uaodv_rt_entry *
+uaodv_rt_refresh_candidate(unsigned long margin)
+{
+  struct uaodv_rt_entry *e;
+  unsigned long now = clock_seconds();
+
+  for(e = list_head(route_table); e != NULL; e = e->next) {
+    if(e->is_active && !e->is_bad && e->expires - now <= margin) {
+      e->is_active = 0;
+      return e;
+    }
+  }
+  return NULL;
 }
+#endif /* UAODV_ROUTE_LIFETIME */
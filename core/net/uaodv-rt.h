@@ -42,13 +42,26 @@
 
 #include "contiki-net.h"
 
+/*
+ * Lifetime of routes in seconds, extended whenever a route is used.
+ * Routes never expire if zero.
+ */
+#ifndef UAODV_ROUTE_LIFETIME
+#define UAODV_ROUTE_LIFETIME 0
+#endif
+
 struct uaodv_rt_entry {
   struct uaodv_rt_entry *next;
+  struct uaodv_rt_entry *hnext;		/* Next in the same hash bucket. */
   uip_ipaddr_t dest;
   uip_ipaddr_t nexthop;
   uint32_t hseqno;			/* In host byte order! */
   uint8_t hop_count;
   uint8_t is_bad;			/* Only one bit is used. */
+#if UAODV_ROUTE_LIFETIME
+  uint8_t is_active;			/* Used since the last refresh. */
+  unsigned long expires;		/* In clock_seconds(). */
+#endif
 };
 
 struct uaodv_rt_entry *
@@ -60,4 +73,11 @@ void uaodv_rt_remove(struct uaodv_rt_entry *e);
 void uaodv_rt_lru(struct uaodv_rt_entry *e);
 void uaodv_rt_flush_all(void);
 
+#if UAODV_ROUTE_LIFETIME
+void uaodv_rt_used(struct uaodv_rt_entry *e);
+struct uaodv_rt_entry *uaodv_rt_refresh_candidate(unsigned long margin);
+#else
+#define uaodv_rt_used(e)
+#endif
+
 #endif /* __UAODV_RT_H__ */
@@ -52,8 +52,14 @@
 #define RSSI_THRESHOLD -39	/* accept -39 ... xx */
 #endif
 
+#if UAODV_ROUTE_LIFETIME
+#define MY_ROUTE_TIMEOUT (UAODV_ROUTE_LIFETIME * 1000UL)
+/* Routes in use are rediscovered this many seconds before they expire. */
+#define REFRESH_MARGIN   (UAODV_ROUTE_LIFETIME / 4 + 1)
+#else
 /* This implementation never expires routes!!! */
 #define MY_ROUTE_TIMEOUT 0x7fffffff /* Should be 0xffffffff! */
+#endif
 #define MY_NET_DIAMETER  20
 
 PROCESS(uaodv_process, "uAODV");
@@ -536,37 +542,104 @@ uaodv_bad_dest(uip_ipaddr_t *dest)
   process_post(&uaodv_process, PROCESS_EVENT_MSG, NULL);
 }
 
-static uip_ipaddr_t rreq_addr;
-static struct timer next_time;
-
-struct uaodv_rt_entry *
-uaodv_request_route_to(uip_ipaddr_t *host)
+/*
+ * Learn the reverse path from data forwarded to us: src can be reached
+ * through the neighbour prevhop that sent it. This repairs routes to
+ * the senders of traffic without a route discovery.
+ */
+void
+uaodv_learn_route(uip_ipaddr_t *src, uip_ipaddr_t *prevhop)
 {
-  struct uaodv_rt_entry *route = uaodv_rt_lookup(host);
+  struct uaodv_rt_entry *rt;
+  uint32_t net_seqno;
 
-  if(route != NULL) {
-    uaodv_rt_lru(route);
-    return route;
+  if(uip_ipaddr_cmp(src, &uip_hostaddr)) {
+    return;
   }
 
+  rt = uaodv_rt_lookup(src);
+  if(rt != NULL) {
+    if(uip_ipaddr_cmp(&rt->nexthop, prevhop)) {
+      uaodv_rt_used(rt);
+    }
+    return;
+  }
+
+  /* The sequence number is the last one we know of, so any route
+     discovered later replaces this one. */
+  print_debug("Learning route to %d.%d.%d.%d\n", uip_ipaddr_to_quad(src));
+  net_seqno = last_known_seqno(src);
+  uaodv_rt_add(src, prevhop,
+	       uip_ipaddr_cmp(src, prevhop) ? 0 : MY_NET_DIAMETER,
+	       &net_seqno);
+}
+
+static uip_ipaddr_t rreq_addr;
+static uint8_t rreq_refresh;
+static struct timer next_time;
+
+static int
+request_route(uip_ipaddr_t *host, uint8_t refresh)
+{
   /*
    * Broadcast protocols must be rate-limited!
    */
   if(!timer_expired(&next_time)) {
-    return NULL;
+    return 0;
   }
 
   if(command != COMMAND_NONE) {
-    return NULL;
+    return 0;
   }
 
   uip_ipaddr_copy(&rreq_addr, host);
+  rreq_refresh = refresh;
   command = COMMAND_SEND_RREQ;
   process_post(&uaodv_process, PROCESS_EVENT_MSG, NULL);
   timer_set(&next_time, CLOCK_SECOND/8); /* Max 10/s per RFC3561. */
+  return 1;
+}
+
+struct uaodv_rt_entry *
+uaodv_request_route_to(uip_ipaddr_t *host)
+{
+  struct uaodv_rt_entry *route = uaodv_rt_lookup(host);
+
+  if(route != NULL) {
+    uaodv_rt_lru(route);
+    uaodv_rt_used(route);
+    return route;
+  }
+
+  request_route(host, 0);
   return NULL;
 }
 
+#if UAODV_ROUTE_LIFETIME
+static struct etimer refresh_timer;
+
+/*
+ * Rediscover a route in use before it expires, so that traffic keeps
+ * flowing while the new route is found.
+ */
+static void
+refresh_routes(void)
+{
+  struct uaodv_rt_entry *route;
+
+  if(command != COMMAND_NONE || !timer_expired(&next_time)) {
+    return;
+  }
+
+  route = uaodv_rt_refresh_candidate(REFRESH_MARGIN);
+  if(route != NULL) {
+    print_debug("Refreshing route to %d.%d.%d.%d\n",
+		uip_ipaddr_to_quad(&route->dest));
+    request_route(&route->dest, 1);
+  }
+}
+#endif /* UAODV_ROUTE_LIFETIME */
+
 PROCESS_THREAD(uaodv_process, ev, data)
 {
   PROCESS_EXITHANDLER(goto exit);
@@ -577,6 +650,9 @@ PROCESS_THREAD(uaodv_process, ev, data)
 
   bcastconn = udp_broadcast_new(UIP_HTONS(UAODV_UDPPORT), NULL);
   unicastconn = udp_broadcast_new(UIP_HTONS(UAODV_UDPPORT), NULL);
+#if UAODV_ROUTE_LIFETIME
+  etimer_set(&refresh_timer, CLOCK_SECOND * (REFRESH_MARGIN / 2 + 1));
+#endif
   
   while(1) {
     PROCESS_WAIT_EVENT();
@@ -588,7 +664,7 @@ PROCESS_THREAD(uaodv_process, ev, data)
       }
       if(uip_poll()) {
 	if(command == COMMAND_SEND_RREQ) {
-	  if(uaodv_rt_lookup(&rreq_addr) == NULL)
+	  if(rreq_refresh || uaodv_rt_lookup(&rreq_addr) == NULL)
 	    send_rreq(&rreq_addr);
 	} else if (command == COMMAND_SEND_RERR) {
 	  send_rerr(&bad_dest, &bad_seqno);
@@ -601,6 +677,13 @@ PROCESS_THREAD(uaodv_process, ev, data)
     if(ev == PROCESS_EVENT_MSG) {
       tcpip_poll_udp(bcastconn);
     }
+
+#if UAODV_ROUTE_LIFETIME
+    if(ev == PROCESS_EVENT_TIMER && data == &refresh_timer) {
+      etimer_reset(&refresh_timer);
+      refresh_routes();
+    }
+#endif
   }
 
  exit:
@@ -610,6 +693,9 @@ PROCESS_THREAD(uaodv_process, ev, data)
   bcastconn = NULL;
   uip_udp_remove(unicastconn);
   unicastconn = NULL;
+#if UAODV_ROUTE_LIFETIME
+  etimer_stop(&refresh_timer);
+#endif
   printf("uaodv_process exiting\n");
   PROCESS_END();
 }
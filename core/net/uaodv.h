@@ -47,5 +47,6 @@ PROCESS_NAME(uaodv_process);
 
 struct uaodv_rt_entry * uaodv_request_route_to(uip_ipaddr_t *host);
 void uaodv_bad_dest(uip_ipaddr_t *);
+void uaodv_learn_route(uip_ipaddr_t *src, uip_ipaddr_t *prevhop);
 
 #endif /* __UAODV_H__ */
@@ -50,6 +50,7 @@
 #include "net/rime/rimeaddr.h"
 #include "net/packetbuf.h"
 #include "net/uip-ds6-nbr.h"
+#include "sys/metrics.h"
 
 #define DEBUG DEBUG_NONE
 #include "net/uip-debug.h"
@@ -70,11 +71,18 @@ void LINK_NEIGHBOR_CALLBACK(const rimeaddr_t *addr, int status, int numtx);
 
 NBR_TABLE_GLOBAL(uip_ds6_nbr_t, ds6_neighbors);
 
+/* Unicast NS probes sent, and probes that link-layer NUD made
+   unnecessary. */
+METRICS_COUNTER(metrics_nud_probes, "ds6.nud.probes");
+METRICS_COUNTER(metrics_nud_saved, "ds6.nud.saved");
+
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_neighbors_init(void)
 {
   nbr_table_register(ds6_neighbors, (nbr_table_callback *)uip_ds6_nbr_rm);
+  METRICS_REGISTER_COUNTER(metrics_nud_probes);
+  METRICS_REGISTER_COUNTER(metrics_nud_saved);
 }
 /*---------------------------------------------------------------------------*/
 uip_ds6_nbr_t *
@@ -93,6 +101,9 @@ uip_ds6_nbr_add(uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr,
     stimer_set(&nbr->reachable, 0);
     stimer_set(&nbr->sendns, 0);
     nbr->nscount = 0;
+#if UIP_DS6_LL_NUD_ONLY
+    nbr->ll_failures = 0;
+#endif /* UIP_DS6_LL_NUD_ONLY */
     PRINTF("Adding neighbor with ip addr ");
     PRINT6ADDR(ipaddr);
     PRINTF(" link addr ");
@@ -116,7 +127,7 @@ uip_ds6_nbr_rm(uip_ds6_nbr_t *nbr)
 {
   if(nbr != NULL) {
 #if UIP_CONF_IPV6_QUEUE_PKT
-    uip_packetqueue_free(&nbr->packethandle);
+    uip_packetqueue_flush(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
     NEIGHBOR_STATE_CHANGED(nbr);
     nbr_table_remove(ds6_neighbors, nbr);
@@ -206,16 +217,52 @@ uip_ds6_link_neighbor_callback(int status, int numtx)
     nbr = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)dest);
     if(nbr != NULL &&
         (nbr->state == NBR_STALE || nbr->state == NBR_DELAY ||
-         nbr->state == NBR_PROBE)) {
+         nbr->state == NBR_PROBE || UIP_DS6_LL_NUD_ONLY)) {
       nbr->state = NBR_REACHABLE;
       stimer_set(&nbr->reachable, UIP_ND6_REACHABLE_TIME / 1000);
+#if UIP_DS6_LL_NUD_ONLY
+      nbr->ll_failures = 0;
+#endif /* UIP_DS6_LL_NUD_ONLY */
       PRINTF("uip-ds6-neighbor : received a link layer ACK : ");
       PRINTLLADDR((uip_lladdr_t *)dest);
       PRINTF(" is reachable.\n");
     }
   }
+#if UIP_DS6_LL_NUD_ONLY
+  else if(status == MAC_TX_NOACK) {
+    uip_ds6_nbr_t *nbr;
+    nbr = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)dest);
+    if(nbr != NULL && nbr->state != NBR_INCOMPLETE &&
+       nbr->state != NBR_PROBE &&
+       ++nbr->ll_failures >= UIP_DS6_LL_NUD_MAX_FAILURES) {
+      /* Only now does the neighbor need an NS probe. */
+      nbr->state = NBR_PROBE;
+      nbr->nscount = 0;
+      stimer_set(&nbr->sendns, 0);
+      PRINTF("uip-ds6-neighbor : %u link layer failures : ", nbr->ll_failures);
+      PRINTLLADDR((uip_lladdr_t *)dest);
+      PRINTF(" moving to PROBE.\n");
+    }
+  }
+#endif /* UIP_DS6_LL_NUD_ONLY */
 #endif /* UIP_DS6_LL_NUD */
 
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_ds6_link_neighbor_heard(const rimeaddr_t *lladdr)
+{
+#if UIP_DS6_LL_NUD_ONLY
+  uip_ds6_nbr_t *nbr;
+
+  /* A frame from a known neighbor shows that it is still there. */
+  nbr = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)lladdr);
+  if(nbr != NULL && nbr->state != NBR_INCOMPLETE) {
+    nbr->state = NBR_REACHABLE;
+    stimer_set(&nbr->reachable, UIP_ND6_REACHABLE_TIME / 1000);
+    nbr->ll_failures = 0;
+  }
+#endif /* UIP_DS6_LL_NUD_ONLY */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -245,6 +292,16 @@ uip_ds6_neighbor_periodic(void)
       }
       break;
     case NBR_DELAY:
+#if UIP_DS6_LL_NUD_ONLY
+      if(stimer_expired(&nbr->reachable)) {
+        /* No failures were reported, so no probe is needed. Packets
+           sent in the meantime bring the neighbor back to DELAY. */
+        nbr->state = NBR_STALE;
+        METRICS_INC(metrics_nud_saved);
+        PRINTF("DELAY: no link layer failures, back to STALE\n");
+      }
+      break;
+#endif /* UIP_DS6_LL_NUD_ONLY */
       if(stimer_expired(&nbr->reachable)) {
         nbr->state = NBR_PROBE;
         nbr->nscount = 0;
@@ -265,6 +322,7 @@ uip_ds6_neighbor_periodic(void)
       } else if(stimer_expired(&nbr->sendns) && (uip_len == 0)) {
         nbr->nscount++;
         PRINTF("PROBE: NS %u\n", nbr->nscount);
+        METRICS_INC(metrics_nud_probes);
         uip_nd6_ns_output(NULL, &nbr->ipaddr, &nbr->ipaddr);
         stimer_set(&nbr->sendns, uip_ds6_if.retrans_timer / 1000);
       }
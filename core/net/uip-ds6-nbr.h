@@ -74,6 +74,9 @@ typedef struct uip_ds6_nbr {
   uint8_t nscount;
   uint8_t isrouter;
   uint8_t state;
+#if UIP_DS6_LL_NUD_ONLY
+  uint8_t ll_failures;
+#endif /* UIP_DS6_LL_NUD_ONLY */
 #if UIP_CONF_IPV6_QUEUE_PKT
   struct uip_packetqueue_handle packethandle;
 #define UIP_DS6_NBR_PACKET_LIFETIME CLOCK_SECOND * 4
@@ -93,6 +96,7 @@ uip_ds6_nbr_t *uip_ds6_nbr_ll_lookup(uip_lladdr_t *lladdr);
 uip_ipaddr_t *uip_ds6_nbr_ipaddr_from_lladdr(uip_lladdr_t *lladdr);
 uip_lladdr_t *uip_ds6_nbr_lladdr_from_ipaddr(uip_ipaddr_t *ipaddr);
 void uip_ds6_link_neighbor_callback(int status, int numtx);
+void uip_ds6_link_neighbor_heard(const rimeaddr_t *lladdr);
 void uip_ds6_neighbor_periodic(void);
 int uip_ds6_nbr_num(void);
 
@@ -65,6 +65,30 @@ LIST(notificationlist);
 
 static int num_routes = 0;
 
+#if UIP_DS6_ROUTE_TRIE
+/* A node in the route trie. Each node holds a prefix of the given
+   length; the children of a node hold longer prefixes that start with
+   it and that differ in the bit that follows it. Nodes that do not
+   hold a route only exist where two such prefixes branch out. */
+struct route_trie_node {
+  struct route_trie_node *child[2];
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+  /* Number of routes with this prefix: uip_ds6_route_add() can leave
+     two routes with the same prefix in the table. */
+  uint8_t refs;
+};
+
+MEMB(trienodememb, struct route_trie_node, 2 * UIP_DS6_ROUTE_NB);
+static struct route_trie_node *trie_root;
+#endif /* UIP_DS6_ROUTE_TRIE */
+
+#if UIP_DS6_ROUTE_CACHE
+static uip_ds6_route_t *cached_route;
+static uip_ipaddr_t cached_addr;
+#endif /* UIP_DS6_ROUTE_CACHE */
+
 #undef DEBUG
 #define DEBUG DEBUG_NONE
 #include "net/uip-debug.h"
@@ -136,10 +160,190 @@ uip_ds6_notification_rm(struct uip_ds6_notification *n)
 }
 #endif
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_TRIE
+/* uip_ipaddr_prefixcmp() only compares whole bytes, so the trie does
+   the same by ignoring the bits of a prefix that do not fill a byte. */
+#define TRIE_LENGTH(length) ((length) & ~7)
+
+static uint8_t
+trie_bit(const uip_ipaddr_t *addr, uint8_t bit)
+{
+  return (addr->u8[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Return the number of leading bits, up to max, that a and b have in
+   common. */
+static uint8_t
+trie_common_bits(const uip_ipaddr_t *a, const uip_ipaddr_t *b, uint8_t max)
+{
+  uint8_t bits;
+
+  for(bits = 0; bits < max && a->u8[bits >> 3] == b->u8[bits >> 3];
+      bits += 8);
+  while(bits < max && trie_bit(a, bits) == trie_bit(b, bits)) {
+    bits++;
+  }
+  return bits > max ? max : bits;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie_node *
+trie_node_new(const uip_ipaddr_t *prefix, uint8_t length,
+              uip_ds6_route_t *route)
+{
+  struct route_trie_node *n;
+
+  n = memb_alloc(&trienodememb);
+  if(n != NULL) {
+    n->child[0] = n->child[1] = NULL;
+    uip_ipaddr_copy(&n->prefix, prefix);
+    n->length = length;
+    n->route = route;
+    n->refs = route != NULL ? 1 : 0;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+trie_add(uip_ds6_route_t *route)
+{
+  struct route_trie_node **link, *n, *m, *b;
+  uint8_t length, common;
+
+  length = TRIE_LENGTH(route->length);
+  link = &trie_root;
+
+  while(1) {
+    n = *link;
+    if(n == NULL) {
+      *link = trie_node_new(&route->ipaddr, length, route);
+      return;
+    }
+
+    common = trie_common_bits(&route->ipaddr, &n->prefix,
+                              length < n->length ? length : n->length);
+    if(common == n->length) {
+      if(n->length == length) {
+        /* The prefix is already in the trie. */
+        n->route = route;
+        n->refs++;
+        return;
+      }
+      /* The prefix is longer than that of the node, go further down. */
+      link = &n->child[trie_bit(&route->ipaddr, n->length)];
+      continue;
+    }
+
+    m = trie_node_new(&route->ipaddr, length, route);
+    if(m == NULL) {
+      return;
+    }
+    if(common == length) {
+      /* The prefix is a prefix of that of the node: put it above the
+         node. */
+      m->child[trie_bit(&n->prefix, length)] = n;
+      *link = m;
+    } else {
+      /* The prefixes differ after the common bits: add a node where
+         they branch out. */
+      b = trie_node_new(&route->ipaddr, common, NULL);
+      if(b == NULL) {
+        memb_free(&trienodememb, m);
+        return;
+      }
+      b->child[trie_bit(&route->ipaddr, common)] = m;
+      b->child[trie_bit(&n->prefix, common)] = n;
+      *link = b;
+    }
+    return;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+trie_rm(uip_ds6_route_t *route)
+{
+  struct route_trie_node **link, **parent_link, *n, *parent;
+  uip_ds6_route_t *r;
+  uint8_t length;
+
+  length = TRIE_LENGTH(route->length);
+  parent_link = NULL;
+  parent = NULL;
+  link = &trie_root;
+
+  /* Find the node that holds the prefix of the route. */
+  for(n = *link; n != NULL && n->length < length; n = *link) {
+    parent_link = link;
+    parent = n;
+    link = &n->child[trie_bit(&route->ipaddr, n->length)];
+  }
+  if(n == NULL || n->length != length || n->refs == 0 ||
+     trie_common_bits(&route->ipaddr, &n->prefix, length) != length) {
+    return;
+  }
+
+  if(--n->refs > 0) {
+    /* Another route has the same prefix: make sure the node points to
+       a route that remains in the table. */
+    if(n->route == route) {
+      for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+        if(r != route && TRIE_LENGTH(r->length) == length &&
+           uip_ipaddr_prefixcmp(&r->ipaddr, &route->ipaddr, length)) {
+          n->route = r;
+          break;
+        }
+      }
+    }
+    return;
+  }
+
+  n->route = NULL;
+  if(n->child[0] != NULL && n->child[1] != NULL) {
+    /* The node is still needed as a branch point. */
+    return;
+  }
+
+  *link = n->child[0] != NULL ? n->child[0] : n->child[1];
+  memb_free(&trienodememb, n);
+
+  /* If the parent only was a branch point, it is not needed anymore. */
+  if(*link == NULL && parent != NULL && parent->route == NULL) {
+    *parent_link = parent->child[0] != NULL ? parent->child[0] : parent->child[1];
+    memb_free(&trienodememb, parent);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+trie_lookup(uip_ipaddr_t *addr)
+{
+  struct route_trie_node *n;
+  uip_ds6_route_t *found_route;
+
+  found_route = NULL;
+  for(n = trie_root;
+      n != NULL && trie_common_bits(addr, &n->prefix, n->length) == n->length;
+      n = n->child[trie_bit(addr, n->length)]) {
+    if(n->route != NULL) {
+      found_route = n->route;
+    }
+    if(n->length == 128) {
+      break;
+    }
+  }
+  return found_route;
+}
+#endif /* UIP_DS6_ROUTE_TRIE */
+/*---------------------------------------------------------------------------*/
 void
 uip_ds6_route_init(void)
 {
   memb_init(&routememb);
+#if UIP_DS6_ROUTE_TRIE
+  memb_init(&trienodememb);
+  trie_root = NULL;
+#endif /* UIP_DS6_ROUTE_TRIE */
+#if UIP_DS6_ROUTE_CACHE
+  cached_route = NULL;
+#endif /* UIP_DS6_ROUTE_CACHE */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 
@@ -216,15 +420,25 @@ uip_ds6_route_num_routes(void)
 uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_TRIE */
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
+#if UIP_DS6_ROUTE_CACHE
+  if(cached_route != NULL && uip_ipaddr_cmp(addr, &cached_addr)) {
+    return cached_route;
+  }
+#endif /* UIP_DS6_ROUTE_CACHE */
 
+#if UIP_DS6_ROUTE_TRIE
+  found_route = trie_lookup(addr);
+#else /* UIP_DS6_ROUTE_TRIE */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -236,6 +450,14 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
       found_route = r;
     }
   }
+#endif /* UIP_DS6_ROUTE_TRIE */
+
+#if UIP_DS6_ROUTE_CACHE
+  if(found_route != NULL) {
+    cached_route = found_route;
+    uip_ipaddr_copy(&cached_addr, addr);
+  }
+#endif /* UIP_DS6_ROUTE_CACHE */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -277,6 +499,11 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
     PRINTF("uip_ds6_route_add: old route already found, updating this one instead: ");
     PRINT6ADDR(ipaddr);
     PRINTF("\n");
+#if UIP_DS6_ROUTE_TRIE
+    /* The prefix of the route may change, so take it out of the trie
+       and put it back below. */
+    trie_rm(r);
+#endif /* UIP_DS6_ROUTE_TRIE */
   } else {
     struct uip_ds6_route_neighbor_routes *routes;
     /* If there is no routing entry, create one */
@@ -331,6 +558,13 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
 
+#if UIP_DS6_ROUTE_TRIE
+  trie_add(r);
+#endif /* UIP_DS6_ROUTE_TRIE */
+#if UIP_DS6_ROUTE_CACHE
+  cached_route = NULL;
+#endif /* UIP_DS6_ROUTE_CACHE */
+
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
 #endif
@@ -365,6 +599,13 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     PRINT6ADDR(&route->ipaddr);
     PRINTF("\n");
 
+#if UIP_DS6_ROUTE_TRIE
+    trie_rm(route);
+#endif /* UIP_DS6_ROUTE_TRIE */
+#if UIP_DS6_ROUTE_CACHE
+    cached_route = NULL;
+#endif /* UIP_DS6_ROUTE_CACHE */
+
     list_remove(route->routes->route_list, route);
     if(list_head(route->routes->route_list) == NULL) {
       /* If this was the only route using this neighbor, remove the
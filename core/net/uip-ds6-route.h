@@ -80,17 +80,41 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB UIP_CONF_MAX_ROUTES
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* With UIP_DS6_ROUTE_TRIE, the routing table is indexed by a
+   path-compressed binary trie so that uip_ds6_route_lookup() takes
+   time proportional to the prefix length rather than to the number
+   of routes. The trie uses up to two nodes per route. */
+#ifdef UIP_CONF_DS6_ROUTE_TRIE
+#define UIP_DS6_ROUTE_TRIE UIP_CONF_DS6_ROUTE_TRIE
+#else
+#define UIP_DS6_ROUTE_TRIE 0
+#endif
+
+/* With UIP_DS6_ROUTE_CACHE, uip_ds6_route_lookup() remembers the last
+   destination it found a route for, so that back-to-back packets to
+   the same destination do not need a new lookup. */
+#ifdef UIP_CONF_DS6_ROUTE_CACHE
+#define UIP_DS6_ROUTE_CACHE UIP_CONF_DS6_ROUTE_CACHE
+#else
+#define UIP_DS6_ROUTE_CACHE 0
+#endif
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
 #define UIP_DS6_ROUTE_STATE_TYPE rpl_route_entry_t
 /* Needed for the extended route entry state when using ContikiRPL */
 typedef struct rpl_route_entry {
-  uint32_t lifetime;
+  unsigned long expiration; /* clock_seconds() at which the route expires */
   void *dag;
   uint8_t learned_from;
   uint8_t nopath_received;
 } rpl_route_entry_t;
+
+/** \brief The number of seconds left before a RPL route expires */
+#define RPL_ROUTE_LIFETIME(r)                                           \
+  ((long)((r)->state.expiration - clock_seconds()) > 0 ?               \
+   (unsigned long)((r)->state.expiration - clock_seconds()) : 0UL)
 #endif /* UIP_DS6_ROUTE_STATE_TYPE */
 
 /** \brief The neighbor routes hold a list of routing table entries
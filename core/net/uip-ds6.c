@@ -69,6 +69,7 @@ static uint8_t rscount;                                         /** \brief numbe
 /** \name "DS6" Data structures */
 /** @{ */
 uip_ds6_netif_t uip_ds6_if;                                       /** \brief The single interface */
+uint32_t uip_ds6_addr_filter, uip_ds6_maddr_filter;
 uip_ds6_prefix_t uip_ds6_prefix_list[UIP_DS6_PREFIX_NB];          /** \brief Prefix list */
 
 /* Used by Cooja to enable extraction of addresses from memory.*/
@@ -100,6 +101,7 @@ uip_ds6_init(void)
      UIP_DS6_ADDR_NB, UIP_DS6_MADDR_NB, UIP_DS6_AADDR_NB);
   memset(uip_ds6_prefix_list, 0, sizeof(uip_ds6_prefix_list));
   memset(&uip_ds6_if, 0, sizeof(uip_ds6_if));
+  uip_ds6_addr_filter = uip_ds6_maddr_filter = 0;
   uip_ds6_addr_size = sizeof(struct uip_ds6_addr);
   uip_ds6_netif_addr_list_offset = offsetof(struct uip_ds6_netif, addr_list);
 
@@ -158,6 +160,12 @@ uip_ds6_periodic(void)
                 && (uip_len == 0)) {
         uip_ds6_dad(locaddr);
 #endif /* UIP_ND6_DEF_MAXDADNS > 0 */
+#if UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER
+      } else if(!uip_is_addr_link_local(&locaddr->ipaddr)
+                && stimer_expired(&locaddr->regtimer)
+                && (uip_len == 0)) {
+        uip_ds6_register(locaddr);
+#endif /* UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER */
       }
     }
   }
@@ -186,12 +194,12 @@ uip_ds6_periodic(void)
 
   uip_ds6_neighbor_periodic();
 
-#if UIP_CONF_ROUTER & UIP_ND6_SEND_RA
+#if UIP_CONF_ROUTER & UIP_ND6_SEND_RA & !UIP_ND6_6LOWPAN
   /* Periodic RA sending */
   if(stimer_expired(&uip_ds6_timer_ra) && (uip_len == 0)) {
     uip_ds6_send_ra_periodic();
   }
-#endif /* UIP_CONF_ROUTER & UIP_ND6_SEND_RA */
+#endif /* UIP_CONF_ROUTER & UIP_ND6_SEND_RA & !UIP_ND6_6LOWPAN */
   etimer_reset(&uip_ds6_timer_periodic);
   return;
 }
@@ -316,6 +324,35 @@ uip_ds6_is_addr_onlink(uip_ipaddr_t *ipaddr)
   return 0;
 }
 
+/*---------------------------------------------------------------------------*/
+static void
+update_addr_filter(void)
+{
+  uip_ds6_addr_t *a;
+
+  /* Not locaddr: uip_ds6_periodic() removes addresses while walking it */
+  uip_ds6_addr_filter = 0;
+  for(a = uip_ds6_if.addr_list;
+      a < uip_ds6_if.addr_list + UIP_DS6_ADDR_NB; a++) {
+    if(a->isused) {
+      uip_ds6_addr_filter |= UIP_DS6_FILTER_BIT(&a->ipaddr);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_maddr_filter(void)
+{
+  uip_ds6_maddr_t *m;
+
+  uip_ds6_maddr_filter = 0;
+  for(m = uip_ds6_if.maddr_list;
+      m < uip_ds6_if.maddr_list + UIP_DS6_MADDR_NB; m++) {
+    if(m->isused) {
+      uip_ds6_maddr_filter |= UIP_DS6_FILTER_BIT(&m->ipaddr);
+    }
+  }
+}
 /*---------------------------------------------------------------------------*/
 uip_ds6_addr_t *
 uip_ds6_addr_add(uip_ipaddr_t *ipaddr, unsigned long vlifetime, uint8_t type)
@@ -326,6 +363,7 @@ uip_ds6_addr_add(uip_ipaddr_t *ipaddr, unsigned long vlifetime, uint8_t type)
       (uip_ds6_element_t **)&locaddr) == FREESPACE) {
     locaddr->isused = 1;
     uip_ipaddr_copy(&locaddr->ipaddr, ipaddr);
+    uip_ds6_addr_filter |= UIP_DS6_FILTER_BIT(ipaddr);
     locaddr->type = type;
     if(vlifetime == 0) {
       locaddr->isinfinite = 1;
@@ -342,6 +380,10 @@ uip_ds6_addr_add(uip_ipaddr_t *ipaddr, unsigned long vlifetime, uint8_t type)
 #else /* UIP_ND6_DEF_MAXDADNS > 0 */
     locaddr->state = ADDR_PREFERRED;
 #endif /* UIP_ND6_DEF_MAXDADNS > 0 */
+#if UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER
+    stimer_set(&locaddr->regtimer, 0);
+    locaddr->regcount = 0;
+#endif /* UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER */
     uip_create_solicited_node(ipaddr, &loc_fipaddr);
     uip_ds6_maddr_add(&loc_fipaddr);
     return locaddr;
@@ -359,6 +401,7 @@ uip_ds6_addr_rm(uip_ds6_addr_t *addr)
       uip_ds6_maddr_rm(locmaddr);
     }
     addr->isused = 0;
+    update_addr_filter();
   }
   return;
 }
@@ -424,6 +467,7 @@ uip_ds6_maddr_add(const uip_ipaddr_t *ipaddr)
       (uip_ds6_element_t **)&locmaddr) == FREESPACE) {
     locmaddr->isused = 1;
     uip_ipaddr_copy(&locmaddr->ipaddr, ipaddr);
+    uip_ds6_maddr_filter |= UIP_DS6_FILTER_BIT(ipaddr);
     return locmaddr;
   }
   return NULL;
@@ -435,6 +479,7 @@ uip_ds6_maddr_rm(uip_ds6_maddr_t *maddr)
 {
   if(maddr != NULL) {
     maddr->isused = 0;
+    update_maddr_filter();
   }
   return;
 }
@@ -544,6 +589,23 @@ uip_ds6_set_addr_iid(uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr)
 #endif
 }
 
+/*---------------------------------------------------------------------------*/
+void
+uip_ds6_set_lladdr_from_iid(uip_lladdr_t *lladdr, uip_ipaddr_t *ipaddr)
+{
+  /* Inverse of uip_ds6_set_addr_iid */
+#if (UIP_LLADDR_LEN == 8)
+  memcpy(lladdr, ipaddr->u8 + 8, UIP_LLADDR_LEN);
+  lladdr->addr[0] ^= 0x02;
+#elif (UIP_LLADDR_LEN == 6)
+  memcpy(lladdr, ipaddr->u8 + 8, 3);
+  memcpy((uint8_t *)lladdr + 3, ipaddr->u8 + 13, 3);
+  lladdr->addr[0] ^= 0x02;
+#else
+#error uip-ds6.c cannot build link-layer address when UIP_LLADDR_LEN is not 6 or 8
+#endif
+}
+
 /*---------------------------------------------------------------------------*/
 uint8_t
 get_match_length(uip_ipaddr_t *src, uip_ipaddr_t *dst)
@@ -685,6 +747,32 @@ uip_ds6_send_rs(void)
   return;
 }
 
+#if UIP_ND6_6LOWPAN
+/*---------------------------------------------------------------------------*/
+void
+uip_ds6_register(uip_ds6_addr_t *addr)
+{
+  uip_ipaddr_t *router;
+
+  /* Wait for a RA to know where to register */
+  router = uip_ds6_defrt_choose();
+  if(router == NULL) {
+    return;
+  }
+
+  if(addr->regcount < UIP_ND6_MAX_UNICAST_SOLICIT) {
+    uip_nd6_ns_aro_output(router, &addr->ipaddr,
+                          UIP_ND6_REGISTRATION_LIFETIME);
+    addr->regcount++;
+    stimer_set(&addr->regtimer, uip_ds6_if.retrans_timer / 1000);
+  } else {
+    PRINTF("No answer to address registration, backing off\n");
+    addr->regcount = 0;
+    stimer_set(&addr->regtimer, UIP_ND6_REGISTRATION_BACKOFF);
+  }
+}
+#endif /* UIP_ND6_6LOWPAN */
+
 #endif /* UIP_CONF_ROUTER */
 /*---------------------------------------------------------------------------*/
 uint32_t
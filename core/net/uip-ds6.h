@@ -119,6 +119,25 @@
 #define UIP_DS6_LL_NUD UIP_CONF_DS6_LL_NUD
 #endif
 
+/* Keep reachability by link-layer ACKs and received frames alone. A
+   neighbor is only probed with NS after UIP_DS6_LL_NUD_MAX_FAILURES
+   consecutive transmissions to it have gone unacknowledged. */
+#ifndef UIP_CONF_DS6_LL_NUD_ONLY
+#define UIP_DS6_LL_NUD_ONLY 0
+#else
+#define UIP_DS6_LL_NUD_ONLY UIP_CONF_DS6_LL_NUD_ONLY
+#endif
+#if UIP_DS6_LL_NUD_ONLY && !UIP_DS6_LL_NUD
+#undef UIP_DS6_LL_NUD
+#define UIP_DS6_LL_NUD 1
+#endif
+
+#ifndef UIP_CONF_DS6_LL_NUD_MAX_FAILURES
+#define UIP_DS6_LL_NUD_MAX_FAILURES 3
+#else
+#define UIP_DS6_LL_NUD_MAX_FAILURES UIP_CONF_DS6_LL_NUD_MAX_FAILURES
+#endif
+
 /** \brief Possible states for the an address  (RFC 4862) */
 #define ADDR_TENTATIVE 0
 #define ADDR_PREFERRED 1
@@ -174,6 +193,10 @@ typedef struct uip_ds6_addr {
   struct timer dadtimer;
   uint8_t dadnscount;
 #endif /* UIP_ND6_DEF_MAXDADNS > 0 */
+#if UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER
+  struct stimer regtimer;
+  uint8_t regcount;
+#endif /* UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER */
 } uip_ds6_addr_t;
 
 /** \brief Anycast address  */
@@ -299,6 +322,9 @@ uip_ds6_aaddr_t *uip_ds6_aaddr_lookup(uip_ipaddr_t *ipaddr);
 /** \brief set the last 64 bits of an IP address based on the MAC address */
 void uip_ds6_set_addr_iid(uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr);
 
+/** \brief set the MAC address from the last 64 bits of an IP address */
+void uip_ds6_set_lladdr_from_iid(uip_lladdr_t *lladdr, uip_ipaddr_t *ipaddr);
+
 /** \brief Get the number of matching bits of two addresses */
 uint8_t get_match_length(uip_ipaddr_t *src, uip_ipaddr_t *dst);
 
@@ -324,15 +350,40 @@ void uip_ds6_send_ra_periodic(void);
 #else /* UIP_CONF_ROUTER */
 /** \brief Send periodic RS to find router */
 void uip_ds6_send_rs(void);
+
+#if UIP_ND6_6LOWPAN
+/** \brief Register an address with the default router, see RFC 6775 */
+void uip_ds6_register(uip_ds6_addr_t *addr);
+#endif /* UIP_ND6_6LOWPAN */
 #endif /* UIP_CONF_ROUTER */
 
 /** \brief Compute the reachable time based on base reachable time, see RFC 4861*/
 uint32_t uip_ds6_compute_reachable_time(void); /** \brief compute random reachable timer */
 
-/** \name Macros to check if an IP address (unicast, multicast or anycast) is mine */
+/**
+ * \brief One-word filters over the unicast and multicast addresses of
+ * the interface, kept up to date as addresses are added and removed.
+ * A clear bit for an address means that it is not one of ours, so most
+ * packets that are not for us are told apart without a list lookup.
+ */
+extern uint32_t uip_ds6_addr_filter, uip_ds6_maddr_filter;
+#define UIP_DS6_FILTER_BIT(addr) \
+  ((uint32_t)1 << (((addr)->u8[14] ^ (addr)->u8[15]) & 31))
+
+/** \name Functions to check if an IP address (unicast, multicast or anycast) is mine */
 /** @{ */
-#define uip_ds6_is_my_addr(addr)  (uip_ds6_addr_lookup(addr) != NULL)
-#define uip_ds6_is_my_maddr(addr) (uip_ds6_maddr_lookup(addr) != NULL)
+static inline int
+uip_ds6_is_my_addr(uip_ipaddr_t *addr)
+{
+  return (uip_ds6_addr_filter & UIP_DS6_FILTER_BIT(addr)) &&
+    uip_ds6_addr_lookup(addr) != NULL;
+}
+static inline int
+uip_ds6_is_my_maddr(uip_ipaddr_t *addr)
+{
+  return (uip_ds6_maddr_filter & UIP_DS6_FILTER_BIT(addr)) &&
+    uip_ds6_maddr_lookup(addr) != NULL;
+}
 #define uip_ds6_is_my_aaddr(addr) (uip_ds6_aaddr_lookup(addr) != NULL)
 /** @} */
 /** @} */
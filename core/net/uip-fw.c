@@ -176,6 +176,37 @@ static struct fwcache_entry fwcache[FWCACHE_SIZE];
  */
 #define FW_TIME 20
 
+/*
+ * The number of destination addresses for which the outgoing network
+ * interface is remembered, as a power of two. Zero disables the route
+ * cache. The cache is flushed when interfaces are registered, so the
+ * address and netmask of an interface should be set before it is
+ * registered.
+ */
+#ifdef UIP_CONF_FW_ROUTE_CACHE
+#define FW_ROUTE_CACHE UIP_CONF_FW_ROUTE_CACHE
+#else
+#define FW_ROUTE_CACHE 0
+#endif
+
+#if FW_ROUTE_CACHE
+struct route_cache_entry {
+  uip_ipaddr_t ipaddr;
+  struct uip_fw_netif *netif;
+};
+
+static struct route_cache_entry route_cache[FW_ROUTE_CACHE];
+
+#define ROUTE_CACHE_HASH(addr) (((addr)->u8[3] ^ (addr)->u8[2]) & \
+                                (FW_ROUTE_CACHE - 1))
+
+static void
+route_cache_flush(void)
+{
+  memset(route_cache, 0, sizeof(route_cache));
+}
+#endif /* FW_ROUTE_CACHE */
+
 /*------------------------------------------------------------------------------*/
 /**
  * Initialize the uIP packet forwarding module.
@@ -191,6 +222,9 @@ uip_fw_init(void)
     netifs = netifs->next;
     t->next = NULL;
   }
+#if FW_ROUTE_CACHE
+  route_cache_flush();
+#endif /* FW_ROUTE_CACHE */
 }
 /*------------------------------------------------------------------------------*/
 /**
@@ -320,18 +354,34 @@ static struct uip_fw_netif *
 find_netif(void)
 {
   struct uip_fw_netif *netif;
+#if FW_ROUTE_CACHE
+  struct route_cache_entry *r;
+
+  r = &route_cache[ROUTE_CACHE_HASH(&BUF->destipaddr)];
+  if(r->netif != NULL && uip_ipaddr_cmp(&r->ipaddr, &BUF->destipaddr)) {
+    return r->netif;
+  }
+#endif /* FW_ROUTE_CACHE */
   
   /* Walk through every network interface to check for a match. */
   for(netif = netifs; netif != NULL; netif = netif->next) {
     if(ipaddr_maskcmp(&BUF->destipaddr, &netif->ipaddr,
 		      &netif->netmask)) {
       /* If there was a match, we break the loop. */
-      return netif;
+      break;
     }
   }
   
   /* If no matching netif was found, we use default netif. */
-  return defaultnetif;
+  if(netif == NULL) {
+    netif = defaultnetif;
+  }
+
+#if FW_ROUTE_CACHE
+  uip_ipaddr_copy(&r->ipaddr, &BUF->destipaddr);
+  r->netif = netif;
+#endif /* FW_ROUTE_CACHE */
+  return netif;
 }
 /*------------------------------------------------------------------------------*/
 /**
@@ -499,6 +549,9 @@ uip_fw_register(struct uip_fw_netif *netif)
 {
   netif->next = netifs;
   netifs = netif;
+#if FW_ROUTE_CACHE
+  route_cache_flush();
+#endif /* FW_ROUTE_CACHE */
 }
 /*------------------------------------------------------------------------------*/
 /**
@@ -515,6 +568,9 @@ void
 uip_fw_default(struct uip_fw_netif *netif)
 {
   defaultnetif = netif;
+#if FW_ROUTE_CACHE
+  route_cache_flush();
+#endif /* FW_ROUTE_CACHE */
 }
 /*------------------------------------------------------------------------------*/
 /**
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Trickle-based multicast dissemination after MPL (RFC 7731).
+ *
+ *         The seed of a message is its IPv6 source address, so the MPL
+ *         option only carries a sequence number. Each node keeps the
+ *         newest messages in a buffer, each with a Trickle timer that
+ *         retransmits it until enough neighbours are heard sending the
+ *         same message, for a given number of Trickle intervals.
+ */
+
+#include "contiki.h"
+#include "net/uip-mcast6.h"
+#include "net/uip-ds6.h"
+#include "lib/trickle-timer.h"
+
+#include <string.h>
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+#if UIP_IPV6_MULTICAST && UIP_MCAST6_ENGINE == UIP_MCAST6_ENGINE_MPL
+
+/* The number of messages buffered for retransmission. */
+#ifdef UIP_MCAST6_CONF_MPL_MSGS
+#define MPL_MSGS UIP_MCAST6_CONF_MPL_MSGS
+#else
+#define MPL_MSGS 4
+#endif
+
+/* The largest message that is buffered, including the IPv6 header.
+   Larger messages are delivered but not forwarded. */
+#ifdef UIP_MCAST6_CONF_MPL_MSG_LEN
+#define MPL_MSG_LEN UIP_MCAST6_CONF_MPL_MSG_LEN
+#else
+#define MPL_MSG_LEN 128
+#endif
+
+/* Trickle parameters of buffered messages. */
+#ifdef UIP_MCAST6_CONF_MPL_IMIN
+#define MPL_IMIN UIP_MCAST6_CONF_MPL_IMIN
+#else
+#define MPL_IMIN (CLOCK_SECOND / 4)
+#endif
+
+#ifdef UIP_MCAST6_CONF_MPL_IMAX
+#define MPL_IMAX UIP_MCAST6_CONF_MPL_IMAX
+#else
+#define MPL_IMAX 1
+#endif
+
+#ifdef UIP_MCAST6_CONF_MPL_K
+#define MPL_K UIP_MCAST6_CONF_MPL_K
+#else
+#define MPL_K 1
+#endif
+
+/* The number of Trickle intervals a message stays buffered. */
+#ifdef UIP_MCAST6_CONF_MPL_EXPIRATIONS
+#define MPL_EXPIRATIONS UIP_MCAST6_CONF_MPL_EXPIRATIONS
+#else
+#define MPL_EXPIRATIONS 3
+#endif
+
+/* The MPL hop-by-hop option: type, length, S/M/V flags and sequence.
+   Seed-id length S is 0, the seed being the source address. */
+#define MPL_OPT_LEN   2
+#define MPL_HBH_LEN   8
+#define MPL_FLAGS_S   0xc0
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_HBH_BUF (&uip_buf[UIP_LLIPH_LEN])
+
+struct mpl_msg {
+  struct trickle_timer tt;
+  uint16_t len;
+  uint8_t seq;
+  uint8_t expirations;
+  uint8_t data[MPL_MSG_LEN];
+};
+
+#define MSG_IP(m) ((struct uip_ip_hdr *)(m)->data)
+
+static struct mpl_msg msgs[MPL_MSGS];
+static uint8_t last_seq;
+/*---------------------------------------------------------------------------*/
+static void
+msg_free(struct mpl_msg *m)
+{
+  trickle_timer_stop(&m->tt);
+  m->len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+msg_timer(void *ptr, uint8_t suppress)
+{
+  struct mpl_msg *m = ptr;
+
+  if(suppress == TRICKLE_TIMER_TX_OK && MSG_IP(m)->ttl > 0) {
+    uip_mcast6_send(m->data, m->len);
+    UIP_MCAST6_STATS_ADD(&MSG_IP(m)->destipaddr, UIP_MCAST6_STATS_FWD);
+  }
+  if(++m->expirations >= MPL_EXPIRATIONS) {
+    msg_free(m);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct mpl_msg *
+msg_lookup(const uip_ipaddr_t *seed, uint8_t seq)
+{
+  struct mpl_msg *m;
+
+  for(m = msgs; m < &msgs[MPL_MSGS]; m++) {
+    if(m->len != 0 && m->seq == seq &&
+       uip_ipaddr_cmp(&MSG_IP(m)->srcipaddr, seed)) {
+      return m;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Buffer the packet in uip_buf, replacing the message that has been
+   buffered the longest if there is no room. */
+static void
+msg_add(uint8_t seq, uint8_t hops)
+{
+  struct mpl_msg *m, *victim;
+
+  if(uip_len > MPL_MSG_LEN) {
+    PRINTF("MPL: message too large to buffer (%u)\n", uip_len);
+    return;
+  }
+
+  victim = &msgs[0];
+  for(m = msgs; m < &msgs[MPL_MSGS]; m++) {
+    if(m->len == 0) {
+      victim = m;
+      break;
+    }
+    if(m->expirations > victim->expirations) {
+      victim = m;
+    }
+  }
+  if(victim->len != 0) {
+    msg_free(victim);
+  }
+
+  memcpy(victim->data, UIP_IP_BUF, uip_len);
+  victim->len = uip_len;
+  victim->seq = seq;
+  victim->expirations = 0;
+  MSG_IP(victim)->ttl -= hops;
+  trickle_timer_config(&victim->tt, MPL_IMIN, MPL_IMAX, MPL_K);
+  trickle_timer_set(&victim->tt, msg_timer, victim);
+}
+/*---------------------------------------------------------------------------*/
+/* Find the MPL option of the packet in uip_buf. Returns a pointer to
+   it, or NULL. */
+static uint8_t *
+find_option(void)
+{
+  uint8_t *hbh;
+  uint16_t off, end;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_HBHO) {
+    return NULL;
+  }
+  hbh = UIP_HBH_BUF;
+  end = (hbh[1] << 3) + 8;
+  off = 2;
+  while(off + 1 < end) {
+    if(hbh[off] == UIP_EXT_HDR_OPT_PAD1) {
+      off++;
+      continue;
+    }
+    if(hbh[off] == UIP_EXT_HDR_OPT_MPL && hbh[off + 1] >= MPL_OPT_LEN &&
+       off + 2 + MPL_OPT_LEN <= end) {
+      return &hbh[off];
+    }
+    off += hbh[off + 1] + 2;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+in(void)
+{
+  uint8_t *opt;
+  struct mpl_msg *m;
+  uint8_t seq;
+
+  opt = find_option();
+  if(opt == NULL || (opt[2] & MPL_FLAGS_S) != 0) {
+    PRINTF("MPL: no usable MPL option, not forwarding\n");
+    goto deliver;
+  }
+  seq = opt[3];
+
+  m = msg_lookup(&UIP_IP_BUF->srcipaddr, seq);
+  if(m != NULL) {
+    /* A neighbour has the message we have: consistent. */
+    trickle_timer_consistency(&m->tt);
+    UIP_MCAST6_STATS_ADD(&UIP_IP_BUF->destipaddr, UIP_MCAST6_STATS_DUPS);
+    return UIP_MCAST6_DROP;
+  }
+  if(uip_mcast6_seen(&UIP_IP_BUF->srcipaddr, seq)) {
+    UIP_MCAST6_STATS_ADD(&UIP_IP_BUF->destipaddr, UIP_MCAST6_STATS_DUPS);
+    return UIP_MCAST6_DROP;
+  }
+
+  UIP_MCAST6_STATS_ADD(&UIP_IP_BUF->destipaddr, UIP_MCAST6_STATS_IN);
+  msg_add(seq, 1);
+
+deliver:
+  if(uip_ds6_is_my_maddr(&UIP_IP_BUF->destipaddr)) {
+    return UIP_MCAST6_ACCEPT;
+  }
+  return UIP_MCAST6_DROP;
+}
+/*---------------------------------------------------------------------------*/
+static void
+out(void)
+{
+  uint8_t *hbh;
+
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO) {
+    PRINTF("MPL: packet already has a hop-by-hop header, dropping\n");
+    uip_len = 0;
+    return;
+  }
+  if(uip_len + MPL_HBH_LEN > UIP_LINK_MTU ||
+     uip_len + MPL_HBH_LEN > UIP_BUFSIZE - UIP_LLH_LEN) {
+    PRINTF("MPL: no room for the MPL option, dropping\n");
+    uip_len = 0;
+    return;
+  }
+
+  /* Insert a hop-by-hop header with the MPL option after the IPv6
+     header. The upper-layer checksum does not cover it. */
+  hbh = UIP_HBH_BUF;
+  memmove(hbh + MPL_HBH_LEN, hbh, uip_len - UIP_IPH_LEN);
+  hbh[0] = UIP_IP_BUF->proto;
+  hbh[1] = 0;
+  hbh[2] = UIP_EXT_HDR_OPT_MPL;
+  hbh[3] = MPL_OPT_LEN;
+  hbh[4] = 0;
+  hbh[5] = ++last_seq;
+  hbh[6] = UIP_EXT_HDR_OPT_PADN;
+  hbh[7] = 0;
+  UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+  uip_len += MPL_HBH_LEN;
+  UIP_IP_BUF->len[0] = (uip_len - UIP_IPH_LEN) >> 8;
+  UIP_IP_BUF->len[1] = (uip_len - UIP_IPH_LEN) & 0xff;
+
+  uip_mcast6_seen(&UIP_IP_BUF->srcipaddr, last_seq);
+  UIP_MCAST6_STATS_ADD(&UIP_IP_BUF->destipaddr, UIP_MCAST6_STATS_OUT);
+  msg_add(last_seq, 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  struct mpl_msg *m;
+
+  for(m = msgs; m < &msgs[MPL_MSGS]; m++) {
+    if(m->len != 0) {
+      msg_free(m);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+const struct uip_mcast6_driver mpl_driver = {
+  "MPL",
+  init,
+  out,
+  in,
+};
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_IPV6_MULTICAST && UIP_MCAST6_ENGINE == UIP_MCAST6_ENGINE_MPL */
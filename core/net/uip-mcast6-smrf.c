@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         SMRF, stateless RPL-aware multicast forwarding. Multicast is
+ *         only accepted from the preferred RPL parent and rebroadcast
+ *         once, so a message sent by the DAG root floods the DAG
+ *         downwards.
+ */
+
+#include "contiki.h"
+#include "net/uip-mcast6.h"
+#include "net/uip-ds6.h"
+#include "net/packetbuf.h"
+#include "lib/crc16.h"
+#include "lib/random.h"
+#include "sys/ctimer.h"
+
+#include <string.h>
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+#if UIP_IPV6_MULTICAST && UIP_MCAST6_ENGINE == UIP_MCAST6_ENGINE_SMRF
+
+#if !UIP_CONF_IPV6_RPL
+#error "The SMRF multicast engine requires RPL"
+#endif
+#include "net/rpl/rpl.h"
+
+/* The maximum delay before a message is forwarded. */
+#ifdef UIP_MCAST6_CONF_SMRF_FWD_DELAY
+#define FWD_DELAY UIP_MCAST6_CONF_SMRF_FWD_DELAY
+#else
+#define FWD_DELAY (CLOCK_SECOND / 8)
+#endif
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+/* The message waiting to be forwarded; one at a time. */
+static uint8_t fwd_buf[UIP_BUFSIZE - UIP_LLH_LEN];
+static uint16_t fwd_len;
+static struct ctimer fwd_timer;
+/*---------------------------------------------------------------------------*/
+static void
+forward(void *ptr)
+{
+  uip_mcast6_send(fwd_buf, fwd_len);
+  UIP_MCAST6_STATS_ADD(&((struct uip_ip_hdr *)fwd_buf)->destipaddr,
+                       UIP_MCAST6_STATS_FWD);
+  fwd_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+in(void)
+{
+  rpl_dag_t *dag;
+  rimeaddr_t *parent;
+  uint16_t id;
+
+  dag = rpl_get_any_dag();
+  if(dag == NULL || dag->preferred_parent == NULL) {
+    PRINTF("SMRF: no parent, dropping\n");
+    return UIP_MCAST6_DROP;
+  }
+  parent = rpl_get_parent_lladdr(dag->preferred_parent);
+  if(parent == NULL ||
+     !rimeaddr_cmp(parent, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+    PRINTF("SMRF: not from the preferred parent, dropping\n");
+    return UIP_MCAST6_DROP;
+  }
+
+  /* Link-layer retransmissions may bring us the same message twice. */
+  id = crc16_data(&uip_buf[UIP_LLIPH_LEN], uip_len - UIP_IPH_LEN, 0);
+  if(uip_mcast6_seen(&UIP_IP_BUF->srcipaddr, id)) {
+    UIP_MCAST6_STATS_ADD(&UIP_IP_BUF->destipaddr, UIP_MCAST6_STATS_DUPS);
+    return UIP_MCAST6_DROP;
+  }
+  UIP_MCAST6_STATS_ADD(&UIP_IP_BUF->destipaddr, UIP_MCAST6_STATS_IN);
+
+  if(UIP_IP_BUF->ttl > 1) {
+    if(fwd_len != 0) {
+      PRINTF("SMRF: forwarding buffer busy\n");
+    } else {
+      fwd_len = uip_len;
+      memcpy(fwd_buf, UIP_IP_BUF, fwd_len);
+      ((struct uip_ip_hdr *)fwd_buf)->ttl--;
+      ctimer_set(&fwd_timer, random_rand() % (FWD_DELAY + 1), forward, NULL);
+    }
+  }
+
+  if(uip_ds6_is_my_maddr(&UIP_IP_BUF->destipaddr)) {
+    return UIP_MCAST6_ACCEPT;
+  }
+  return UIP_MCAST6_DROP;
+}
+/*---------------------------------------------------------------------------*/
+static void
+out(void)
+{
+  /* Only the messages of the DAG root reach the whole DAG, but others
+     still reach their own children. */
+  UIP_MCAST6_STATS_ADD(&UIP_IP_BUF->destipaddr, UIP_MCAST6_STATS_OUT);
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  fwd_len = 0;
+  ctimer_stop(&fwd_timer);
+}
+/*---------------------------------------------------------------------------*/
+const struct uip_mcast6_driver smrf_driver = {
+  "SMRF",
+  init,
+  out,
+  in,
+};
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_IPV6_MULTICAST && UIP_MCAST6_ENGINE == UIP_MCAST6_ENGINE_SMRF */
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Duplicate suppression, statistics and sending shared by the
+ *         IPv6 multicast engines.
+ */
+
+#include "net/uip-mcast6.h"
+#include "net/tcpip.h"
+#include "sys/clock.h"
+
+#include <string.h>
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+#if UIP_IPV6_MULTICAST
+/*---------------------------------------------------------------------------*/
+struct seen_entry {
+  uip_ipaddr_t src;
+  unsigned long time;
+  uint16_t id;
+  uint8_t used;
+};
+
+static struct seen_entry seen[UIP_MCAST6_CACHE_SIZE];
+
+#if UIP_MCAST6_STATS_GROUPS
+static struct uip_mcast6_stats stats[UIP_MCAST6_STATS_GROUPS];
+static uint8_t stats_next;
+#endif /* UIP_MCAST6_STATS_GROUPS */
+/*---------------------------------------------------------------------------*/
+int
+uip_mcast6_seen(const uip_ipaddr_t *src, uint16_t id)
+{
+  struct seen_entry *e, *oldest;
+  unsigned long now;
+
+  now = clock_seconds();
+  oldest = &seen[0];
+  for(e = seen; e < &seen[UIP_MCAST6_CACHE_SIZE]; e++) {
+    if(e->used && now - e->time >= UIP_MCAST6_CACHE_LIFETIME) {
+      e->used = 0;
+    }
+    if(e->used && e->id == id && uip_ipaddr_cmp(&e->src, src)) {
+      return 1;
+    }
+    if(!e->used || (oldest->used && e->time < oldest->time)) {
+      oldest = e;
+    }
+  }
+
+  uip_ipaddr_copy(&oldest->src, src);
+  oldest->id = id;
+  oldest->time = now;
+  oldest->used = 1;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_MCAST6_STATS_GROUPS
+struct uip_mcast6_stats *
+uip_mcast6_stats_get(const uip_ipaddr_t *group)
+{
+  struct uip_mcast6_stats *s;
+
+  for(s = stats; s < &stats[UIP_MCAST6_STATS_GROUPS]; s++) {
+    if(uip_ipaddr_cmp(&s->group, group)) {
+      return s;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_stats_add(const uip_ipaddr_t *group, uint8_t counter)
+{
+  struct uip_mcast6_stats *s;
+
+  s = uip_mcast6_stats_get(group);
+  if(s == NULL) {
+    /* Reuse the slots in turn for new groups. */
+    s = &stats[stats_next];
+    stats_next = (stats_next + 1) % UIP_MCAST6_STATS_GROUPS;
+    memset(s, 0, sizeof(*s));
+    uip_ipaddr_copy(&s->group, group);
+  }
+
+  switch(counter) {
+  case UIP_MCAST6_STATS_IN:
+    s->in++;
+    break;
+  case UIP_MCAST6_STATS_DUPS:
+    s->dups++;
+    break;
+  case UIP_MCAST6_STATS_FWD:
+    s->fwd++;
+    break;
+  case UIP_MCAST6_STATS_OUT:
+    s->out++;
+    break;
+  }
+}
+#endif /* UIP_MCAST6_STATS_GROUPS */
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_send(const uint8_t *pkt, uint16_t len)
+{
+  memcpy(&uip_buf[UIP_LLH_LEN], pkt, len);
+  uip_len = len;
+  uip_ext_len = 0;
+  PRINTF("uip-mcast6: sending %u bytes to ", len);
+  PRINT6ADDR(&((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])->destipaddr);
+  PRINTF("\n");
+  tcpip_output(NULL);
+  uip_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_init(void)
+{
+  memset(seen, 0, sizeof(seen));
+#if UIP_MCAST6_STATS_GROUPS
+  memset(stats, 0, sizeof(stats));
+  stats_next = 0;
+#endif /* UIP_MCAST6_STATS_GROUPS */
+  PRINTF("uip-mcast6: using %s\n", UIP_MCAST6.name);
+  UIP_MCAST6.init();
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_IPV6_MULTICAST */
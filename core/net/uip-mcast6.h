@@ -0,0 +1,185 @@
+/**
+ * \addtogroup uip6
+ * @{
+ */
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+/**
+ * \file
+ *         Forwarding of IPv6 multicast beyond the local link.
+ *
+ *         Packets to multicast groups of realm-local (ff03::/16) or
+ *         wider scope are handed to a multicast engine, which decides
+ *         whether they are delivered locally and whether they are
+ *         forwarded. Two engines are available:
+ *
+ *         - SMRF, stateless RPL-aware forwarding: a node only accepts
+ *           multicast from its preferred RPL parent and rebroadcasts it
+ *           to its own children after a short random delay. Messages go
+ *           downwards from the DAG root.
+ *
+ *         - MPL, Trickle-based dissemination (RFC 7731): a seed tags
+ *           each message with a sequence number in a hop-by-hop option,
+ *           and every node buffers new messages for a while and
+ *           retransmits them on its own Trickle timer. Any node can
+ *           send, and no routing state is needed.
+ */
+
+#ifndef UIP_MCAST6_H_
+#define UIP_MCAST6_H_
+
+#include "net/uip.h"
+
+/** Multicast is forwarded when UIP_CONF_IPV6_MULTICAST is set. */
+#ifdef UIP_CONF_IPV6_MULTICAST
+#define UIP_IPV6_MULTICAST (UIP_CONF_IPV6 && UIP_CONF_IPV6_MULTICAST)
+#else
+#define UIP_IPV6_MULTICAST 0
+#endif
+
+/* Multicast engines, to be set in UIP_MCAST6_CONF_ENGINE. */
+#define UIP_MCAST6_ENGINE_SMRF 1
+#define UIP_MCAST6_ENGINE_MPL  2
+
+#ifdef UIP_MCAST6_CONF_ENGINE
+#define UIP_MCAST6_ENGINE UIP_MCAST6_CONF_ENGINE
+#else
+#define UIP_MCAST6_ENGINE UIP_MCAST6_ENGINE_SMRF
+#endif
+
+#if UIP_MCAST6_ENGINE == UIP_MCAST6_ENGINE_SMRF
+#define UIP_MCAST6 smrf_driver
+#elif UIP_MCAST6_ENGINE == UIP_MCAST6_ENGINE_MPL
+#define UIP_MCAST6 mpl_driver
+#else
+#error "Unknown UIP_MCAST6_CONF_ENGINE"
+#endif
+
+/** The number of recently seen messages used to drop duplicates. */
+#ifdef UIP_MCAST6_CONF_CACHE_SIZE
+#define UIP_MCAST6_CACHE_SIZE UIP_MCAST6_CONF_CACHE_SIZE
+#else
+#define UIP_MCAST6_CACHE_SIZE 8
+#endif
+
+/** The number of seconds a message is remembered as seen. */
+#ifdef UIP_MCAST6_CONF_CACHE_LIFETIME
+#define UIP_MCAST6_CACHE_LIFETIME UIP_MCAST6_CONF_CACHE_LIFETIME
+#else
+#define UIP_MCAST6_CACHE_LIFETIME 60
+#endif
+
+/** The number of groups to keep statistics for; zero disables them. */
+#ifdef UIP_MCAST6_CONF_STATS_GROUPS
+#define UIP_MCAST6_STATS_GROUPS UIP_MCAST6_CONF_STATS_GROUPS
+#else
+#define UIP_MCAST6_STATS_GROUPS 4
+#endif
+
+/* Return values of the in() function of a multicast engine. */
+#define UIP_MCAST6_DROP   0
+#define UIP_MCAST6_ACCEPT 1
+
+/** The scope of a multicast address. */
+#define uip_mcast6_scope(a) ((a)->u8[1] & 0x0f)
+
+/** Is a multicast address of a scope that is forwarded by an engine? */
+#define uip_is_addr_mcast_routable(a)                                   \
+  (uip_is_addr_mcast(a) && uip_mcast6_scope(a) > 2)
+
+/**
+ * The structure of a multicast engine.
+ */
+struct uip_mcast6_driver {
+  char *name;
+
+  /** Initialize the engine. */
+  void (* init)(void);
+
+  /** Prepare a multicast packet originated by this node, which is in
+      uip_buf. The packet is dropped if uip_len is zero on return,
+      otherwise it is broadcast on the link. */
+  void (* out)(void);
+
+  /** Handle a multicast packet received in uip_buf, keeping a copy
+      to forward if needed. Returns UIP_MCAST6_ACCEPT if the packet
+      should also be delivered to this node, else UIP_MCAST6_DROP. */
+  uint8_t (* in)(void);
+};
+
+/** Per-group multicast statistics. */
+struct uip_mcast6_stats {
+  uip_ipaddr_t group;
+  uint16_t in;          /**< Messages received for the first time. */
+  uint16_t dups;        /**< Duplicates dropped. */
+  uint16_t fwd;         /**< Messages forwarded. */
+  uint16_t out;         /**< Messages originated by this node. */
+};
+
+#define UIP_MCAST6_STATS_IN   0
+#define UIP_MCAST6_STATS_DUPS 1
+#define UIP_MCAST6_STATS_FWD  2
+#define UIP_MCAST6_STATS_OUT  3
+
+#if UIP_MCAST6_STATS_GROUPS
+void uip_mcast6_stats_add(const uip_ipaddr_t *group, uint8_t counter);
+
+/**
+ * Get the statistics of a multicast group, or NULL if none are kept
+ * for it. Statistics are kept for the groups most recently seen.
+ */
+struct uip_mcast6_stats *uip_mcast6_stats_get(const uip_ipaddr_t *group);
+#define UIP_MCAST6_STATS_ADD(g, c) uip_mcast6_stats_add(g, c)
+#else
+#define UIP_MCAST6_STATS_ADD(g, c)
+#endif /* UIP_MCAST6_STATS_GROUPS */
+
+/**
+ * Look up a message in the cache of seen messages, and add it if it
+ * was not there. A message is identified by its source and a 16-bit
+ * identifier chosen by the engine.
+ *
+ * \return Non-zero if the message had been seen before.
+ */
+int uip_mcast6_seen(const uip_ipaddr_t *src, uint16_t id);
+
+/**
+ * Send a packet kept by an engine as a link-layer broadcast. The
+ * packet is copied into uip_buf, which is then consumed.
+ */
+void uip_mcast6_send(const uint8_t *pkt, uint16_t len);
+
+void uip_mcast6_init(void);
+
+extern const struct uip_mcast6_driver UIP_MCAST6;
+
+#endif /* UIP_MCAST6_H_ */
+/** @} */
@@ -73,6 +73,9 @@
 #include "net/uip-nd6.h"
 #include "net/uip-ds6.h"
 #include "lib/random.h"
+#if UIP_ND6_6LOWPAN
+#include "net/sicslowpan.h"
+#endif /* UIP_ND6_6LOWPAN */
 
 #if UIP_CONF_IPV6
 /*------------------------------------------------------------------*/
@@ -126,6 +129,9 @@ static uip_ds6_prefix_t *prefix; /**  Pointer to a prefix list entry */
 static uip_ds6_nbr_t *nbr; /**  Pointer to a nbr cache entry*/
 static uip_ds6_defrt_t *defrt; /**  Pointer to a router list entry */
 static uip_ds6_addr_t *addr; /**  Pointer to an interface address */
+#if UIP_ND6_6LOWPAN
+static uip_nd6_opt_aro *nd6_opt_aro; /**  Pointer to ARO option in uip_buf */
+#endif /* UIP_ND6_6LOWPAN */
 
 
 /*------------------------------------------------------------------*/
@@ -140,6 +146,156 @@ create_llao(uint8_t *llao, uint8_t type) {
          UIP_ND6_OPT_LLAO_LEN - 2 - UIP_LLADDR_LEN);
 }
 
+#if UIP_ND6_6LOWPAN
+/*------------------------------------------------------------------*/
+/* create an aro, eui64 is the EUI-64 of the registering host */
+static void
+create_aro(uip_nd6_opt_aro *aro, uint8_t status, uint16_t lifetime,
+           uint8_t *eui64)
+{
+  aro->type = UIP_ND6_OPT_ARO;
+  aro->len = UIP_ND6_OPT_ARO_LEN >> 3;
+  aro->status = status;
+  aro->reserved1 = 0;
+  aro->reserved2 = 0;
+  aro->lifetime = uip_htons(lifetime);
+  memcpy(aro->eui64, eui64, sizeof(aro->eui64));
+}
+#endif /* UIP_ND6_6LOWPAN */
+
+#if UIP_ND6_6LOWPAN && !(UIP_CONF_ROUTER && UIP_CONF_IPV6_RPL)
+/*------------------------------------------------------------------*/
+/* The EUI-64 is the interface identifier without the U/L bit flipped */
+static void
+get_eui64(uint8_t *eui64, uip_lladdr_t *lladdr)
+{
+  uip_ipaddr_t iid;
+
+  uip_ds6_set_addr_iid(&iid, lladdr);
+  memcpy(eui64, &iid.u8[8], 8);
+  eui64[0] ^= 0x02;
+}
+#endif /* UIP_ND6_6LOWPAN && !(UIP_CONF_ROUTER && UIP_CONF_IPV6_RPL) */
+
+#if UIP_ND6_6LOWPAN && UIP_CONF_ROUTER
+/*------------------------------------------------------------------*/
+/*
+ * Process the registration of host with link-layer address lladdr, as
+ * carried by a NS with an ARO (RFC 6775, 6.5), and return the ARO status.
+ *
+ * The neighbor table holds one IP address per link-layer address, so we
+ * keep the host under its link-local address, with the registration
+ * lifetime as reachable time, and reach its registered address through a
+ * host route.
+ */
+static uint8_t
+aro_register(uip_ipaddr_t *host, uip_lladdr_t *lladdr, uip_nd6_opt_aro *aro)
+{
+  uip_ipaddr_t ll;
+  uint16_t lifetime;
+#if !UIP_CONF_IPV6_RPL
+  uip_ds6_route_t *r;
+  uint8_t eui64[8];
+#endif /* !UIP_CONF_IPV6_RPL */
+
+  lifetime = uip_ntohs(aro->lifetime);
+  uip_create_linklocal_prefix(&ll);
+  uip_ds6_set_addr_iid(&ll, lladdr);
+
+#if !UIP_CONF_IPV6_RPL
+  /* Is the address still registered by somebody else? */
+  r = uip_ds6_route_lookup(host);
+  if(r != NULL && r->length == 128 && uip_ipaddr_cmp(&r->ipaddr, host)) {
+    nbr = uip_ds6_nbr_lookup(uip_ds6_route_nexthop(r));
+    if(nbr != NULL && nbr->state == NBR_REACHABLE) {
+      get_eui64(eui64, uip_ds6_nbr_get_ll(nbr));
+      if(memcmp(eui64, aro->eui64, sizeof(eui64)) != 0) {
+        PRINTF("ARO: duplicate address ");
+        PRINT6ADDR(host);
+        PRINTF("\n");
+        return UIP_ND6_ARO_STATUS_DUPLICATE;
+      }
+    }
+  }
+
+  if(lifetime == 0) {
+    /* Deregistration */
+    if(r != NULL && uip_ipaddr_cmp(&r->ipaddr, host)) {
+      uip_ds6_route_rm(r);
+    }
+    return UIP_ND6_ARO_STATUS_SUCCESS;
+  }
+#else /* !UIP_CONF_IPV6_RPL */
+  if(lifetime == 0) {
+    return UIP_ND6_ARO_STATUS_SUCCESS;
+  }
+#endif /* !UIP_CONF_IPV6_RPL */
+
+  nbr = uip_ds6_nbr_lookup(&ll);
+  if(nbr == NULL) {
+    nbr = uip_ds6_nbr_add(&ll, lladdr, 0, NBR_REACHABLE);
+    if(nbr == NULL) {
+      return UIP_ND6_ARO_STATUS_CACHE_FULL;
+    }
+  }
+  nbr->state = NBR_REACHABLE;
+  nbr->isrouter = 0;
+  stimer_set(&nbr->reachable, lifetime * 60UL);
+
+#if !UIP_CONF_IPV6_RPL
+  /* With RPL the routes to the registered address come from DAOs */
+  if(!uip_ipaddr_cmp(host, &ll) &&
+     uip_ds6_route_add(host, 128, &ll) == NULL) {
+    return UIP_ND6_ARO_STATUS_CACHE_FULL;
+  }
+#endif /* !UIP_CONF_IPV6_RPL */
+  PRINTF("ARO: registered ");
+  PRINT6ADDR(host);
+  PRINTF(" for %u minutes\n", lifetime);
+  return UIP_ND6_ARO_STATUS_SUCCESS;
+}
+
+/*------------------------------------------------------------------*/
+/* Answer a registration with a NA carrying the ARO status */
+static void
+aro_na_output(uip_ipaddr_t *host, uip_nd6_opt_aro *aro)
+{
+  uip_ext_len = 0;
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->tcflow = 0;
+  UIP_IP_BUF->flow = 0;
+  UIP_IP_BUF->len[0] = 0;       /* length will not be more than 255 */
+  UIP_IP_BUF->len[1] = UIP_ICMPH_LEN + UIP_ND6_NA_LEN + UIP_ND6_OPT_ARO_LEN;
+  UIP_IP_BUF->proto = UIP_PROTO_ICMP6;
+  UIP_IP_BUF->ttl = UIP_ND6_HOP_LIMIT;
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, host);
+  uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
+
+  UIP_ICMP_BUF->type = ICMP6_NA;
+  UIP_ICMP_BUF->icode = 0;
+
+  UIP_ND6_NA_BUF->flagsreserved =
+    UIP_ND6_NA_FLAG_SOLICITED | UIP_ND6_NA_FLAG_ROUTER;
+  memset(UIP_ND6_NA_BUF->reserved, 0, sizeof(UIP_ND6_NA_BUF->reserved));
+  uip_ipaddr_copy(&UIP_ND6_NA_BUF->tgtipaddr, host);
+
+  create_aro((uip_nd6_opt_aro *)&uip_buf[uip_l2_l3_icmp_hdr_len +
+                                         UIP_ND6_NA_LEN],
+             aro->status, uip_ntohs(aro->lifetime), aro->eui64);
+
+  UIP_ICMP_BUF->icmpchksum = 0;
+  UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+
+  uip_len =
+    UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NA_LEN + UIP_ND6_OPT_ARO_LEN;
+
+  UIP_STAT(++uip_stat.nd6.sent);
+  PRINTF("Sending NA with ARO status %u to ", aro->status);
+  PRINT6ADDR(&UIP_IP_BUF->destipaddr);
+  PRINTF("\n");
+}
+#endif /* UIP_ND6_6LOWPAN && UIP_CONF_ROUTER */
+
 /*------------------------------------------------------------------*/
 
 
@@ -167,6 +323,9 @@ uip_nd6_ns_input(void)
 
   /* Options processing */
   nd6_opt_llao = NULL;
+#if UIP_ND6_6LOWPAN
+  nd6_opt_aro = NULL;
+#endif /* UIP_ND6_6LOWPAN */
   nd6_opt_offset = UIP_ND6_NS_LEN;
   while(uip_l3_icmp_hdr_len + nd6_opt_offset < uip_len) {
 #if UIP_CONF_IPV6_CHECKS
@@ -178,40 +337,69 @@ uip_nd6_ns_input(void)
     switch (UIP_ND6_OPT_HDR_BUF->type) {
     case UIP_ND6_OPT_SLLAO:
       nd6_opt_llao = &uip_buf[uip_l2_l3_icmp_hdr_len + nd6_opt_offset];
+      break;
+#if UIP_ND6_6LOWPAN
+    case UIP_ND6_OPT_ARO:
+      nd6_opt_aro = (uip_nd6_opt_aro *)UIP_ND6_OPT_HDR_BUF;
+      break;
+#endif /* UIP_ND6_6LOWPAN */
+    default:
+      PRINTF("ND option not supported in NS");
+      break;
+    }
+    nd6_opt_offset += (UIP_ND6_OPT_HDR_BUF->len << 3);
+  }
+
+#if UIP_ND6_6LOWPAN && UIP_CONF_ROUTER
+  /* Address registration, the target is the host address, not ours */
+  if(nd6_opt_aro != NULL) {
+    uip_nd6_opt_aro aro;
+    uip_ipaddr_t host;
+
+    if(nd6_opt_llao == NULL ||
+       nd6_opt_aro->len != UIP_ND6_OPT_ARO_LEN >> 3 ||
+       uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
+      PRINTF("NS received is bad\n");
+      goto discard;
+    }
+    memcpy(&aro, nd6_opt_aro, sizeof(aro));
+    uip_ipaddr_copy(&host, &UIP_IP_BUF->srcipaddr);
+    aro.status = aro_register(&host,
+        (uip_lladdr_t *)&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET], &aro);
+    aro_na_output(&host, &aro);
+    return;
+  }
+#endif /* UIP_ND6_6LOWPAN && UIP_CONF_ROUTER */
+
+  if(nd6_opt_llao != NULL) {
 #if UIP_CONF_IPV6_CHECKS
-      /* There must be NO option in a DAD NS */
-      if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
-        PRINTF("NS received is bad\n");
-        goto discard;
-      } else {
+    /* There must be NO option in a DAD NS */
+    if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
+      PRINTF("NS received is bad\n");
+      goto discard;
+    } else {
 #endif /*UIP_CONF_IPV6_CHECKS */
-        nbr = uip_ds6_nbr_lookup(&UIP_IP_BUF->srcipaddr);
-        if(nbr == NULL) {
-          uip_ds6_nbr_add(&UIP_IP_BUF->srcipaddr,
-			  (uip_lladdr_t *)&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
-			  0, NBR_STALE);
+      nbr = uip_ds6_nbr_lookup(&UIP_IP_BUF->srcipaddr);
+      if(nbr == NULL) {
+        uip_ds6_nbr_add(&UIP_IP_BUF->srcipaddr,
+                        (uip_lladdr_t *)&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
+                        0, NBR_STALE);
+      } else {
+        uip_lladdr_t *lladdr = uip_ds6_nbr_get_ll(nbr);
+        if(memcmp(&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
+                  lladdr, UIP_LLADDR_LEN) != 0) {
+          memcpy(lladdr, &nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
+                 UIP_LLADDR_LEN);
+          nbr->state = NBR_STALE;
         } else {
-          uip_lladdr_t *lladdr = uip_ds6_nbr_get_ll(nbr);
-          if(memcmp(&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
-		    lladdr, UIP_LLADDR_LEN) != 0) {
-            memcpy(lladdr, &nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
-		   UIP_LLADDR_LEN);
+          if(nbr->state == NBR_INCOMPLETE) {
             nbr->state = NBR_STALE;
-          } else {
-            if(nbr->state == NBR_INCOMPLETE) {
-              nbr->state = NBR_STALE;
-            }
           }
         }
-#if UIP_CONF_IPV6_CHECKS
       }
-#endif /*UIP_CONF_IPV6_CHECKS */
-      break;
-    default:
-      PRINTF("ND option not supported in NS");
-      break;
+#if UIP_CONF_IPV6_CHECKS
     }
-    nd6_opt_offset += (UIP_ND6_OPT_HDR_BUF->len << 3);
+#endif /*UIP_CONF_IPV6_CHECKS */
   }
 
   addr = uip_ds6_addr_lookup(&UIP_ND6_NS_BUF->tgtipaddr);
@@ -389,6 +577,55 @@ uip_nd6_ns_output(uip_ipaddr_t * src, uip_ipaddr_t * dest, uip_ipaddr_t * tgt)
   return;
 }
 
+#if UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER
+/*------------------------------------------------------------------*/
+void
+uip_nd6_ns_aro_output(uip_ipaddr_t * dest, uip_ipaddr_t * tgt,
+                      uint16_t lifetime)
+{
+  uint8_t eui64[8];
+
+  uip_ext_len = 0;
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->tcflow = 0;
+  UIP_IP_BUF->flow = 0;
+  UIP_IP_BUF->proto = UIP_PROTO_ICMP6;
+  UIP_IP_BUF->ttl = UIP_ND6_HOP_LIMIT;
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, dest);
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, tgt);
+
+  UIP_ICMP_BUF->type = ICMP6_NS;
+  UIP_ICMP_BUF->icode = 0;
+  UIP_ND6_NS_BUF->reserved = 0;
+  uip_ipaddr_copy((uip_ipaddr_t *) &UIP_ND6_NS_BUF->tgtipaddr, tgt);
+
+  /* RFC 6775, 5.5.1: the SLLAO and the ARO are both mandatory */
+  create_llao(&uip_buf[uip_l2_l3_icmp_hdr_len + UIP_ND6_NS_LEN],
+              UIP_ND6_OPT_SLLAO);
+  get_eui64(eui64, &uip_lladdr);
+  create_aro((uip_nd6_opt_aro *)&uip_buf[uip_l2_l3_icmp_hdr_len +
+                                         UIP_ND6_NS_LEN +
+                                         UIP_ND6_OPT_LLAO_LEN],
+             UIP_ND6_ARO_STATUS_SUCCESS, lifetime, eui64);
+
+  UIP_IP_BUF->len[0] = 0;       /* length will not be more than 255 */
+  UIP_IP_BUF->len[1] = UIP_ICMPH_LEN + UIP_ND6_NS_LEN +
+    UIP_ND6_OPT_LLAO_LEN + UIP_ND6_OPT_ARO_LEN;
+  uip_len = UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NS_LEN +
+    UIP_ND6_OPT_LLAO_LEN + UIP_ND6_OPT_ARO_LEN;
+
+  UIP_ICMP_BUF->icmpchksum = 0;
+  UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+
+  UIP_STAT(++uip_stat.nd6.sent);
+  PRINTF("Registering ");
+  PRINT6ADDR(tgt);
+  PRINTF(" with ");
+  PRINT6ADDR(dest);
+  PRINTF(" for %u minutes\n", lifetime);
+}
+#endif /* UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER */
+
 
 
 /*------------------------------------------------------------------*/
@@ -433,6 +670,9 @@ uip_nd6_na_input(void)
   /* Options processing: we handle TLLAO, and must ignore others */
   nd6_opt_offset = UIP_ND6_NA_LEN;
   nd6_opt_llao = NULL;
+#if UIP_ND6_6LOWPAN
+  nd6_opt_aro = NULL;
+#endif /* UIP_ND6_6LOWPAN */
   while(uip_l3_icmp_hdr_len + nd6_opt_offset < uip_len) {
 #if UIP_CONF_IPV6_CHECKS
     if(UIP_ND6_OPT_HDR_BUF->len == 0) {
@@ -444,6 +684,11 @@ uip_nd6_na_input(void)
     case UIP_ND6_OPT_TLLAO:
       nd6_opt_llao = (uint8_t *)UIP_ND6_OPT_HDR_BUF;
       break;
+#if UIP_ND6_6LOWPAN
+    case UIP_ND6_OPT_ARO:
+      nd6_opt_aro = (uip_nd6_opt_aro *)UIP_ND6_OPT_HDR_BUF;
+      break;
+#endif /* UIP_ND6_6LOWPAN */
     default:
       PRINTF("ND option not supported in NA\n");
       break;
@@ -453,6 +698,28 @@ uip_nd6_na_input(void)
   addr = uip_ds6_addr_lookup(&UIP_ND6_NA_BUF->tgtipaddr);
   /* Message processing, including TLLAO if any */
   if(addr != NULL) {
+#if UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER
+    /* Answer to the registration of one of our addresses */
+    if(nd6_opt_aro != NULL) {
+      switch(nd6_opt_aro->status) {
+      case UIP_ND6_ARO_STATUS_SUCCESS:
+        /* Refresh the registration before it expires */
+        addr->regcount = 0;
+        stimer_set(&addr->regtimer, UIP_ND6_REGISTRATION_LIFETIME * 45UL);
+        break;
+      case UIP_ND6_ARO_STATUS_DUPLICATE:
+        PRINTF("ARO: address is a duplicate, removing it\n");
+        uip_ds6_addr_rm(addr);
+        break;
+      default:
+        /* The router has no room for us right now */
+        addr->regcount = 0;
+        stimer_set(&addr->regtimer, UIP_ND6_REGISTRATION_BACKOFF);
+        break;
+      }
+      goto discard;
+    }
+#endif /* UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER */
 #if UIP_ND6_DEF_MAXDADNS > 0
     if(addr->state == ADDR_TENTATIVE) {
       uip_ds6_dad_failed(addr);
@@ -625,8 +892,19 @@ uip_nd6_rs_input(void)
 #endif /*UIP_CONF_IPV6_CHECKS */
   }
 
+#if UIP_ND6_6LOWPAN
+  /* RFC 6775, 6.5.2: there are no periodic RAs, answer right away */
+  uip_ext_len = 0;
+  if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
+    uip_nd6_ra_output(NULL);
+  } else {
+    uip_nd6_ra_output(&UIP_IP_BUF->srcipaddr);
+  }
+  return;
+#else /* UIP_ND6_6LOWPAN */
   /* Schedule a sollicited RA */
   uip_ds6_send_ra_sollicited();
+#endif /* UIP_ND6_6LOWPAN */
 
 discard:
   uip_len = 0;
@@ -829,6 +1107,29 @@ uip_nd6_ra_input(void)
         nbr->isrouter = 1;
       }
       break;
+#if UIP_ND6_6LOWPAN
+    case UIP_ND6_OPT_6CO:
+      PRINTF("Processing 6CO option in RA\n");
+      {
+        uip_nd6_opt_6co *co = (uip_nd6_opt_6co *)UIP_ND6_OPT_HDR_BUF;
+        uint8_t len = (co->ctxlen + 7) / 8;
+
+        /* The prefix field is 8 or 16 bytes long */
+        if(len > (co->len << 3) - 8) {
+          len = (co->len << 3) - 8;
+        }
+        if(co->lifetime == 0) {
+          sicslowpan_context_remove(co->flagscid & UIP_ND6_6CO_CID_MASK);
+        } else if(co->flagscid & UIP_ND6_6CO_FLAG_C) {
+          /* Contexts that are valid for decompression only are not
+             supported; we never install them. */
+          memset(&ipaddr, 0, sizeof(ipaddr));
+          memcpy(&ipaddr, co->prefix, len > 16 ? 16 : len);
+          sicslowpan_context_set(co->flagscid & UIP_ND6_6CO_CID_MASK, &ipaddr);
+        }
+      }
+      break;
+#endif /* UIP_ND6_6LOWPAN */
     case UIP_ND6_OPT_MTU:
       PRINTF("Processing MTU option in RA\n");
       uip_ds6_if.link_mtu =
@@ -89,13 +89,37 @@
 #define UIP_ND6_MAX_RA_DELAY_TIME_MS        500 /*milli seconds*/
 /** @} */
 
+/** \name RFC 6775 (6LoWPAN-ND) */
+/** @{ */
+/**
+ * \brief Use the optimized neighbor discovery of RFC 6775: addresses are
+ * built from the EUI-64 and not checked with DAD, hosts register their
+ * global addresses with their router (ARO), link-local next hops are
+ * resolved from their interface identifier without multicast NS, and
+ * routers only send RAs in answer to host RSs.
+ */
+#ifdef UIP_CONF_ND6_6LOWPAN
+#define UIP_ND6_6LOWPAN UIP_CONF_ND6_6LOWPAN
+#else
+#define UIP_ND6_6LOWPAN                     0
+#endif
+/** \brief Lifetime of an address registration, in units of 60 seconds */
+#ifdef UIP_CONF_ND6_REGISTRATION_LIFETIME
+#define UIP_ND6_REGISTRATION_LIFETIME UIP_CONF_ND6_REGISTRATION_LIFETIME
+#else
+#define UIP_ND6_REGISTRATION_LIFETIME       60
+#endif
+/** \brief Seconds to wait before retrying a registration nobody answered */
+#define UIP_ND6_REGISTRATION_BACKOFF        60
+/** @} */
+
 #ifndef UIP_CONF_ND6_DEF_MAXDADNS
 /** \brief Do not try DAD when using EUI-64 as allowed by draft-ietf-6lowpan-nd-15 section 8.2 */
-#if UIP_CONF_LL_802154
+#if UIP_CONF_LL_802154 || UIP_ND6_6LOWPAN
 #define UIP_ND6_DEF_MAXDADNS 0
-#else /* UIP_CONF_LL_802154 */
+#else /* UIP_CONF_LL_802154 || UIP_ND6_6LOWPAN */
 #define UIP_ND6_DEF_MAXDADNS UIP_ND6_SEND_NA
-#endif /* UIP_CONF_LL_802154 */
+#endif /* UIP_CONF_LL_802154 || UIP_ND6_6LOWPAN */
 #else /* UIP_CONF_ND6_DEF_MAXDADNS */
 #define UIP_ND6_DEF_MAXDADNS UIP_CONF_ND6_DEF_MAXDADNS
 #endif /* UIP_CONF_ND6_DEF_MAXDADNS */
@@ -134,6 +158,21 @@
 #define UIP_ND6_OPT_PREFIX_INFO         3
 #define UIP_ND6_OPT_REDIRECTED_HDR      4
 #define UIP_ND6_OPT_MTU                 5
+#define UIP_ND6_OPT_ARO                 33
+#define UIP_ND6_OPT_6CO                 34
+/** @} */
+
+/** \name Address Registration Option status values (RFC 6775) */
+/** @{ */
+#define UIP_ND6_ARO_STATUS_SUCCESS      0
+#define UIP_ND6_ARO_STATUS_DUPLICATE    1
+#define UIP_ND6_ARO_STATUS_CACHE_FULL   2
+/** @} */
+
+/** \name 6LoWPAN Context Option flags (RFC 6775) */
+/** @{ */
+#define UIP_ND6_6CO_FLAG_C              0x10
+#define UIP_ND6_6CO_CID_MASK            0x0f
 /** @} */
 
 /** \name ND6 option types */
@@ -156,6 +195,7 @@
 #define UIP_ND6_OPT_HDR_LEN            2
 #define UIP_ND6_OPT_PREFIX_INFO_LEN    32
 #define UIP_ND6_OPT_MTU_LEN            8
+#define UIP_ND6_OPT_ARO_LEN            16
 
 
 /* Length of TLLAO and SLLAO options, it is L2 dependant */
@@ -284,6 +324,28 @@ typedef struct uip_nd6_opt_redirected_hdr {
   uint8_t len;
   uint8_t reserved[6];
 } uip_nd6_opt_redirected_hdr;
+
+/** \brief ND option Address Registration (RFC 6775) */
+typedef struct uip_nd6_opt_aro {
+  uint8_t type;
+  uint8_t len;
+  uint8_t status;
+  uint8_t reserved1;
+  uint16_t reserved2;
+  uint16_t lifetime;
+  uint8_t eui64[8];
+} uip_nd6_opt_aro;
+
+/** \brief ND option 6LoWPAN Context (RFC 6775) */
+typedef struct uip_nd6_opt_6co {
+  uint8_t type;
+  uint8_t len;
+  uint8_t ctxlen;
+  uint8_t flagscid;
+  uint16_t reserved;
+  uint16_t lifetime;
+  uint8_t prefix[16];
+} uip_nd6_opt_6co;
 /** @} */
 
 /**
@@ -337,6 +399,21 @@ uip_nd6_ns_input(void);
 void
 uip_nd6_ns_output(uip_ipaddr_t *src, uip_ipaddr_t *dest, uip_ipaddr_t *tgt);
 
+#if UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER
+/**
+ * \brief Send a NS registering one of our addresses with a router (RFC 6775)
+ * \param dest the link-local address of the router
+ * \param tgt the address to register, also used as source of the NS
+ * \param lifetime registration lifetime in units of 60 seconds, 0 to
+ * remove the registration
+ *
+ * The NS carries a SLLAO and an ARO. The router answers with a NA
+ * carrying the ARO status, see uip_nd6_na_input.
+ */
+void
+uip_nd6_ns_aro_output(uip_ipaddr_t *dest, uip_ipaddr_t *tgt, uint16_t lifetime);
+#endif /* UIP_ND6_6LOWPAN && !UIP_CONF_ROUTER */
+
 /**
  * \brief Process a Neighbor Advertisement
  *
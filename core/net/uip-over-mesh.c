@@ -145,7 +145,8 @@ static void
 timedout(struct route_discovery_conn *c)
 {
   PRINTF("uip-over-mesh: packet timed out\n");
-  if(queued_packet) {
+  if(queued_packet &&
+     !route_discovery_pending(c, &queued_receiver)) {
     PRINTF("uip-over-mesh: freeing queued packet\n");
     queuebuf_free(queued_packet);
     queued_packet = NULL;
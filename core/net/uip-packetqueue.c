@@ -6,8 +6,7 @@
 
 #include "net/uip-packetqueue.h"
 
-#define MAX_NUM_QUEUED_PACKETS 2
-MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
+MEMB(packets_memb, struct uip_packetqueue_packet, UIP_PACKETQUEUE_NUM);
 
 #define DEBUG 0
 #if DEBUG
@@ -17,15 +16,31 @@ MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+static void
+remove_packet(struct uip_packetqueue_packet *p)
+{
+  struct uip_packetqueue_handle *h = p->handle;
+  struct uip_packetqueue_packet **pp;
+
+  for(pp = &h->packet; *pp != NULL; pp = &(*pp)->next) {
+    if(*pp == p) {
+      *pp = p->next;
+      h->count--;
+      break;
+    }
+  }
+  ctimer_stop(&p->lifetimer);
+  memb_free(&packets_memb, p);
+}
 /*---------------------------------------------------------------------------*/
 static void
 packet_timedout(void *ptr)
 {
-  struct uip_packetqueue_handle *h = ptr;
+  struct uip_packetqueue_packet *p = ptr;
 
-  PRINTF("uip_packetqueue_free timed out %p\n", h);
-  memb_free(&packets_memb, h->packet);
-  h->packet = NULL;
+  PRINTF("uip_packetqueue_free timed out %p\n", p->handle);
+  remove_packet(p);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -33,24 +48,37 @@ uip_packetqueue_new(struct uip_packetqueue_handle *handle)
 {
   PRINTF("uip_packetqueue_new %p\n", handle);
   handle->packet = NULL;
+  handle->count = 0;
 }
 /*---------------------------------------------------------------------------*/
 struct uip_packetqueue_packet *
 uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifetime)
 {
+  struct uip_packetqueue_packet *p;
+  struct uip_packetqueue_packet **pp;
+
   PRINTF("uip_packetqueue_alloc %p\n", handle);
-  if(handle->packet != NULL) {
-    PRINTF("alloced\n");
+  if(handle->count >= UIP_PACKETQUEUE_PER_HANDLE) {
+    PRINTF("queue full\n");
     return NULL;
   }
-  handle->packet = memb_alloc(&packets_memb);
-  if(handle->packet != NULL) {
-    ctimer_set(&handle->packet->lifetimer, lifetime,
-               packet_timedout, handle);
-  } else {
+  p = memb_alloc(&packets_memb);
+  if(p == NULL) {
     PRINTF("uip_packetqueue_alloc failed\n");
+    return NULL;
   }
-  return handle->packet;
+
+  p->next = NULL;
+  p->queue_buf_len = 0;
+  p->handle = handle;
+  ctimer_set(&p->lifetimer, lifetime, packet_timedout, p);
+
+  /* Append, so that the packets are sent in the order they came. */
+  for(pp = &handle->packet; *pp != NULL; pp = &(*pp)->next);
+  *pp = p;
+  handle->count++;
+
+  return p;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -58,9 +86,15 @@ uip_packetqueue_free(struct uip_packetqueue_handle *handle)
 {
   PRINTF("uip_packetqueue_free %p\n", handle);
   if(handle->packet != NULL) {
-    ctimer_stop(&handle->packet->lifetimer);
-    memb_free(&packets_memb, handle->packet);
-    handle->packet = NULL;
+    remove_packet(handle->packet);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_packetqueue_flush(struct uip_packetqueue_handle *handle)
+{
+  while(handle->packet != NULL) {
+    remove_packet(handle->packet);
   }
 }
 /*---------------------------------------------------------------------------*/
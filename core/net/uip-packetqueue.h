@@ -3,30 +3,53 @@
 
 #include "sys/ctimer.h"
 
+/* The number of packets that can be queued in total, shared by all
+   queues. */
+#ifdef UIP_PACKETQUEUE_CONF_NUM
+#define UIP_PACKETQUEUE_NUM UIP_PACKETQUEUE_CONF_NUM
+#else
+#define UIP_PACKETQUEUE_NUM 2
+#endif
+
+/* The number of packets that can be queued in a single queue. */
+#ifdef UIP_PACKETQUEUE_CONF_PER_HANDLE
+#define UIP_PACKETQUEUE_PER_HANDLE UIP_PACKETQUEUE_CONF_PER_HANDLE
+#else
+#define UIP_PACKETQUEUE_PER_HANDLE UIP_PACKETQUEUE_NUM
+#endif
+
 struct uip_packetqueue_handle;
 
 struct uip_packetqueue_packet {
-  struct uip_ds6_queued_packet *next;
+  struct uip_packetqueue_packet *next;
   uint8_t queue_buf[UIP_BUFSIZE - UIP_LLH_LEN];
   uint16_t queue_buf_len;
   struct ctimer lifetimer;
   struct uip_packetqueue_handle *handle;
 };
 
+/* A queue of packets, oldest first. */
 struct uip_packetqueue_handle {
   struct uip_packetqueue_packet *packet;
+  uint8_t count;
 };
 
 void uip_packetqueue_new(struct uip_packetqueue_handle *handle);
 
-
+/* Adds a packet at the end of the queue. The caller copies the packet
+   into the queue_buf of the returned packet and sets queue_buf_len. */
 struct uip_packetqueue_packet *
 uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifetime);
 
-
+/* Removes the oldest packet. */
 void
 uip_packetqueue_free(struct uip_packetqueue_handle *handle);
 
+/* Removes all packets. */
+void
+uip_packetqueue_flush(struct uip_packetqueue_handle *handle);
+
+/* Access to the oldest packet. */
 uint8_t *uip_packetqueue_buf(struct uip_packetqueue_handle *h);
 uint16_t uip_packetqueue_buflen(struct uip_packetqueue_handle *h);
 void uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len);
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Retransmission buffers for uIP TCP connections with more
+ *         than one segment in flight
+ */
+
+#include <string.h>
+
+#include "net/uip-tcp-window.h"
+#include "net/uip_arch.h"
+#include "net/tcpip.h"
+#include "lib/memb.h"
+
+#if UIP_TCP_WINDOW
+
+MEMB(segments, struct uip_tcp_segment, UIP_TCP_WINDOW);
+
+/* The number of segment buffers left in the pool. */
+static uint8_t nfree;
+
+/*---------------------------------------------------------------------------*/
+void
+uip_tcp_window_init(void)
+{
+  memb_init(&segments);
+  nfree = UIP_TCP_WINDOW;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_tcp_window_room(struct uip_conn *conn)
+{
+  uint16_t room;
+
+  /* While lost segments are being resent, no new data is sent. */
+  if(conn->window < 2 || conn->queued >= conn->window || nfree == 0 ||
+     (conn->wflags & (UIP_TCP_WINDOW_RECOVER | UIP_TCP_WINDOW_CLOSE))) {
+    return 0;
+  }
+
+  /* The data in flight must fit in the window that the peer has
+     advertised, and each segment must fit the peer's MSS. */
+  if(conn->snd_wnd <= conn->len) {
+    return 0;
+  }
+  room = conn->snd_wnd - conn->len;
+  if(room > conn->initialmss) {
+    room = conn->initialmss;
+  }
+  return room;
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_tcp_window_push(struct uip_conn *conn, const void *data, uint16_t len)
+{
+  struct uip_tcp_segment *s, **p;
+
+  s = memb_alloc(&segments);
+  if(s == NULL) {
+    return 0;
+  }
+  --nfree;
+
+  memcpy(s->data, data, len);
+  s->len = len;
+  s->next = NULL;
+
+  /* The segments are kept in the order they were sent. */
+  for(p = &conn->segments; *p != NULL; p = &(*p)->next);
+  *p = s;
+  ++conn->queued;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_tcp_window_ack(struct uip_conn *conn, const uint8_t *ackno)
+{
+  struct uip_tcp_segment *s, *next;
+  uint8_t seqno[4];
+  uint16_t acked;
+
+  /* Find the segment that ends where the ACK points. */
+  memcpy(seqno, conn->snd_nxt, sizeof(seqno));
+  acked = 0;
+  for(s = conn->segments; s != NULL; s = s->next) {
+    uip_add32(seqno, s->len);
+    memcpy(seqno, uip_acc32, sizeof(seqno));
+    acked += s->len;
+    if(memcmp(seqno, ackno, sizeof(seqno)) == 0) {
+      break;
+    }
+  }
+  if(s == NULL) {
+    return 0;
+  }
+
+  /* Release it together with all segments before it. */
+  next = s->next;
+  for(s = conn->segments; s != next; s = conn->segments) {
+    conn->segments = s->next;
+    memb_free(&segments, s);
+    ++nfree;
+    --conn->queued;
+  }
+  memcpy(conn->snd_nxt, seqno, sizeof(seqno));
+  conn->len -= acked;
+  return acked;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_tcp_window_copy(struct uip_conn *conn, void *dest)
+{
+  memcpy(dest, conn->segments->data, conn->segments->len);
+  return conn->segments->len;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_tcp_window_flush(struct uip_conn *conn)
+{
+  struct uip_tcp_segment *s;
+
+  while(conn->segments != NULL) {
+    s = conn->segments;
+    conn->segments = s->next;
+    memb_free(&segments, s);
+    ++nfree;
+  }
+  conn->queued = 0;
+  conn->dupacks = 0;
+  conn->wflags = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_tcp_window_poll(struct uip_conn *conn)
+{
+  tcpip_poll_tcp(conn);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_TCP_WINDOW */
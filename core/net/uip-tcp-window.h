@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+/**
+ * \addtogroup uip
+ * @{
+ */
+
+/**
+ * \defgroup uiptcpwindow uIP TCP send window
+ * @{
+ *
+ * The basic uIP TCP implementation only allows each TCP connection to
+ * have a single TCP segment in flight at any given time, and asks the
+ * application to regenerate that segment if it is lost.
+ *
+ * When UIP_CONF_TCP_WINDOW is set, uIP keeps a copy of every segment
+ * it sends on a connection for which uip_set_window() has been called
+ * with more than one segment. The copies are taken from a pool of
+ * UIP_CONF_TCP_WINDOW segment buffers that is shared by all
+ * connections. As soon as a segment has been copied, the application
+ * is told that its data has been acknowledged so that it can produce
+ * the next segment, and uIP retransmits lost segments from the copies
+ * without invoking the application. A segment is retransmitted when
+ * the retransmission timer expires, and also immediately when three
+ * duplicate ACKs are received (fast retransmit).
+ *
+ * Connections with a window of zero or one segment, and connections
+ * that find the pool empty, work exactly as without this module.
+ */
+
+/**
+ * \file
+ * Retransmission buffers for uIP TCP connections with more than one
+ * segment in flight.
+ */
+
+#ifndef __UIP_TCP_WINDOW_H__
+#define __UIP_TCP_WINDOW_H__
+
+#include "net/uip.h"
+
+#if UIP_TCP_WINDOW
+
+/**
+ * The number of duplicate ACKs that trigger a fast retransmit.
+ */
+#ifndef UIP_TCP_WINDOW_CONF_DUPACKS
+#define UIP_TCP_WINDOW_DUPACKS 3
+#else /* UIP_TCP_WINDOW_CONF_DUPACKS */
+#define UIP_TCP_WINDOW_DUPACKS (UIP_TCP_WINDOW_CONF_DUPACKS)
+#endif /* UIP_TCP_WINDOW_CONF_DUPACKS */
+
+/* Bits in the wflags field of the uip_conn structure. */
+#define UIP_TCP_WINDOW_REXMIT  0x01 /* The first segment must be resent. */
+#define UIP_TCP_WINDOW_RECOVER 0x02 /* A segment has been resent. */
+#define UIP_TCP_WINDOW_CLOSE   0x04 /* Send a FIN once all data is acked. */
+
+/**
+ * A copy of a TCP segment that has not yet been acknowledged.
+ */
+struct uip_tcp_segment {
+  struct uip_tcp_segment *next;
+  uint16_t len;
+  uint8_t data[UIP_TCP_MSS];
+};
+
+/**
+ * Initialize the pool of segment buffers.
+ *
+ * This function is called by uip_init().
+ */
+void uip_tcp_window_init(void);
+
+/**
+ * Check how much new data can be put in flight on a connection.
+ *
+ * \param conn The connection.
+ *
+ * \return The number of bytes that the next segment may contain, or
+ * zero if the connection does not use a window, if the window is
+ * full or if the peer has no room for more data.
+ */
+uint16_t uip_tcp_window_room(struct uip_conn *conn);
+
+/**
+ * Keep a copy of a segment that is being sent.
+ *
+ * \param conn The connection.
+ * \param data The segment data.
+ * \param len The length of the segment data.
+ *
+ * \return Non-zero if the segment was copied, zero if there was no
+ * free segment buffer.
+ */
+int uip_tcp_window_push(struct uip_conn *conn, const void *data,
+                        uint16_t len);
+
+/**
+ * Remove the segments that an incoming ACK covers.
+ *
+ * The snd_nxt and len fields of the connection are updated to
+ * account for the segments that are removed. An ACK that does not
+ * end at a segment boundary is ignored.
+ *
+ * \param conn The connection.
+ * \param ackno The acknowledgment number of the incoming segment.
+ *
+ * \return The number of bytes that were acknowledged.
+ */
+uint16_t uip_tcp_window_ack(struct uip_conn *conn, const uint8_t *ackno);
+
+/**
+ * Copy the oldest unacknowledged segment of a connection.
+ *
+ * \param conn The connection.
+ * \param dest Where to copy the segment data.
+ *
+ * \return The length of the segment.
+ */
+uint16_t uip_tcp_window_copy(struct uip_conn *conn, void *dest);
+
+/**
+ * Release all segments of a connection.
+ *
+ * \param conn The connection.
+ */
+void uip_tcp_window_flush(struct uip_conn *conn);
+
+/**
+ * Arrange for the connection to be polled as soon as possible.
+ *
+ * \param conn The connection.
+ */
+void uip_tcp_window_poll(struct uip_conn *conn);
+
+#endif /* UIP_TCP_WINDOW */
+
+#endif /* __UIP_TCP_WINDOW_H__ */
+
+/** @} */
+/** @} */
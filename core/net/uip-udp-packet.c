@@ -45,17 +45,34 @@ extern uint16_t uip_slen;
 
 #include <string.h>
 
+#define UDP_PAYLOAD  (&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN])
+#define UDP_CAPACITY (UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN)
+
+/*---------------------------------------------------------------------------*/
+void *
+uip_udp_packet_reserve(uint16_t *capacity)
+{
+  if(capacity != NULL) {
+    *capacity = UDP_CAPACITY;
+  }
+  return UDP_PAYLOAD;
+}
 /*---------------------------------------------------------------------------*/
 void
 uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len)
 {
 #if UIP_UDP
   if(data != NULL) {
+    if(len > UDP_CAPACITY) {
+      len = UDP_CAPACITY;
+    }
     uip_udp_conn = c;
     uip_slen = len;
-    memcpy(&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN], data,
-           len > UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN?
-           UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN: len);
+    /* Data written in place after uip_udp_packet_reserve() already
+       is where it should be. */
+    if(data != UDP_PAYLOAD) {
+      memcpy(UDP_PAYLOAD, data, len);
+    }
     uip_process(UIP_UDP_SEND_CONN);
 #if UIP_CONF_IPV6
     tcpip_ipv6_output();
@@ -93,3 +110,16 @@ uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+uip_udp_packet_commit(struct uip_udp_conn *c, int len)
+{
+  uip_udp_packet_send(c, UDP_PAYLOAD, len);
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_packet_committo(struct uip_udp_conn *c, int len,
+                        const uip_ipaddr_t *toaddr, uint16_t toport)
+{
+  uip_udp_packet_sendto(c, UDP_PAYLOAD, len, toaddr, toport);
+}
+/*---------------------------------------------------------------------------*/
@@ -46,4 +46,41 @@ void uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len);
 void uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
 			   const uip_ipaddr_t *toaddr, uint16_t toport);
 
+/**
+ * \brief      Get the buffer for the payload of the next UDP packet
+ * \param capacity Set to the number of bytes that fit in the buffer,
+ *                 if not NULL
+ * \return     A pointer to the payload area of uip_buf
+ *
+ *             The payload can be written directly to the returned
+ *             buffer and then sent with uip_udp_packet_commit() or
+ *             uip_udp_packet_committo(), which saves copying it into
+ *             uip_buf. Passing the buffer to uip_udp_packet_send()
+ *             or uip_udp_packet_sendto() has the same effect.
+ *
+ *             The buffer is uip_buf, so it must not be reserved
+ *             while uip_buf holds a packet that still is in use, such
+ *             as in a callback for an incoming packet, and it is only
+ *             valid until the packet has been sent.
+ */
+void *uip_udp_packet_reserve(uint16_t *capacity);
+
+/**
+ * \brief      Send the payload written after uip_udp_packet_reserve()
+ * \param c    The UDP connection
+ * \param len  The length of the payload
+ */
+void uip_udp_packet_commit(struct uip_udp_conn *c, int len);
+
+/**
+ * \brief      Send the payload written after uip_udp_packet_reserve()
+ *             to a specified address and port
+ * \param c    The UDP connection
+ * \param len  The length of the payload
+ * \param toaddr The IP address of the receiver
+ * \param toport The UDP port of the receiver, in network byte order
+ */
+void uip_udp_packet_committo(struct uip_udp_conn *c, int len,
+                             const uip_ipaddr_t *toaddr, uint16_t toport);
+
 #endif /* __UIP_UDP_PACKET_H__ */
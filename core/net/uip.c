@@ -74,6 +74,7 @@
 #include "net/uipopt.h"
 #include "net/uip_arp.h"
 #include "net/uip_arch.h"
+#include "net/uip-tcp-window.h"
 
 #if !UIP_CONF_IPV6 /* If UIP_CONF_IPV6 is defined, we compile the
 		      uip6.c file instead of this one. Therefore
@@ -126,13 +127,22 @@ uip_lladdr_t uip_lladdr = {{0,0,0,0,0,0}};
 #endif
 
 /* The packet buffer that contains incoming packets. */
+#if UIP_BUFFER_HEADROOM
+uip_headroom_buf_t uip_headroom_buf;
+#else /* UIP_BUFFER_HEADROOM */
 uip_buf_t uip_aligned_buf;
+#endif /* UIP_BUFFER_HEADROOM */
 
 void *uip_appdata;               /* The uip_appdata pointer points to
 				    application data. */
 void *uip_sappdata;              /* The uip_appdata pointer points to
 				    the application data which is to
 				    be sent. */
+#if UIP_TCP_STABLE_SEND
+static const void *uip_srexmit;  /* Where the data which is to be
+				    sent was copied from, if the
+				    application keeps it there. */
+#endif /* UIP_TCP_STABLE_SEND */
 #if UIP_URGDATA > 0
 void *uip_urgdata;               /* The uip_urgdata pointer points to
    				    urgent data (out-of-band data), if
@@ -267,36 +277,42 @@ uip_add32(uint8_t *op32, uint16_t op16)
 
 #if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
+#if UIP_ARCH_SUM
+#define chksum(sum, data, len) uip_arch_sum(sum, data, len)
+#else /* UIP_ARCH_SUM */
 static uint16_t
 chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-  
-  while(dataptr < last_byte) {	/* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-    dataptr += 2;
+  uint32_t acc;
+
+  /* The 16-bit words are added up in 32 bits and the carries are
+     folded back in once at the end. With at most 32768 words the
+     accumulator cannot overflow. */
+  acc = sum;
+  while(len >= 8) {
+    acc += ((uint16_t)data[0] << 8) + data[1];
+    acc += ((uint16_t)data[2] << 8) + data[3];
+    acc += ((uint16_t)data[4] << 8) + data[5];
+    acc += ((uint16_t)data[6] << 8) + data[7];
+    data += 8;
+    len -= 8;
   }
-  
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
+  while(len >= 2) {
+    acc += ((uint16_t)data[0] << 8) + data[1];
+    data += 2;
+    len -= 2;
   }
+  if(len > 0) {
+    acc += (uint16_t)data[0] << 8;
+  }
+
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
 
   /* Return sum in host byte order. */
-  return sum;
+  return (uint16_t)acc;
 }
+#endif /* UIP_ARCH_SUM */
 /*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
@@ -374,7 +390,13 @@ uip_init(void)
   }
   for(c = 0; c < UIP_CONNS; ++c) {
     uip_conns[c].tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+    uip_conns[c].segments = NULL;
+#endif /* UIP_TCP_WINDOW */
   }
+#if UIP_TCP_WINDOW
+  uip_tcp_window_init();
+#endif /* UIP_TCP_WINDOW */
 #if UIP_ACTIVE_OPEN || UIP_UDP
   lastport = 1024;
 #endif /* UIP_ACTIVE_OPEN || UIP_UDP */
@@ -454,6 +476,10 @@ uip_connect(uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->lport = uip_htons(lastport);
   conn->rport = rport;
   uip_ipaddr_copy(&conn->ripaddr, ripaddr);
+#if UIP_TCP_WINDOW
+  uip_tcp_window_flush(conn);
+  conn->window = UIP_TCP_WINDOW_DEFAULT;
+#endif /* UIP_TCP_WINDOW */
   
   return conn;
 }
@@ -669,6 +695,23 @@ uip_add_rcv_nxt(uint16_t n)
   uip_conn->rcv_nxt[3] = uip_acc32[3];
 }
 /*---------------------------------------------------------------------------*/
+static void
+uip_update_rtt(void)
+{
+  signed char m;
+
+  m = uip_conn->rto - uip_conn->timer;
+  /* This is taken directly from VJs original code in his paper */
+  m = m - (uip_conn->sa >> 3);
+  uip_conn->sa += m;
+  if(m < 0) {
+    m = -m;
+  }
+  m = m - (uip_conn->sv >> 2);
+  uip_conn->sv += m;
+  uip_conn->rto = (uip_conn->sa >> 3) + uip_conn->sv;
+}
+/*---------------------------------------------------------------------------*/
 void
 uip_process(uint8_t flag)
 {
@@ -685,6 +728,26 @@ uip_process(uint8_t flag)
   /* Check if we were invoked because of a poll request for a
      particular connection. */
   if(flag == UIP_POLL_REQUEST) {
+#if UIP_TCP_WINDOW
+    if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+       uip_connr->segments != NULL) {
+      if(uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) {
+	UIP_STAT(++uip_stat.tcp.rexmit);
+	goto tcp_window_rexmit;
+      }
+      tmp16 = uip_tcp_window_room(uip_connr);
+      if(tmp16 > 0) {
+	/* The data in flight has been copied, so we tell the
+	   application that it has been acknowledged and let it send
+	   as much more as fits in the window. */
+	uip_connr->mss = tmp16;
+	uip_flags = UIP_ACKDATA;
+	UIP_APPCALL();
+	goto appsend;
+      }
+      goto drop;
+    }
+#endif /* UIP_TCP_WINDOW */
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
        !uip_outstanding(uip_connr)) {
 	uip_flags = UIP_POLL;
@@ -742,6 +805,9 @@ uip_process(uint8_t flag)
 	       uip_connr->tcpstateflags == UIP_SYN_RCVD) &&
 	      uip_connr->nrtx == UIP_MAXSYNRTX)) {
 	    uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+	    uip_tcp_window_flush(uip_connr);
+#endif /* UIP_TCP_WINDOW */
 
 	    /* We call UIP_APPCALL() with uip_flags set to
 	       UIP_TIMEDOUT to inform the application that the
@@ -781,6 +847,21 @@ uip_process(uint8_t flag)
 #endif /* UIP_ACTIVE_OPEN */
 	    
 	  case UIP_ESTABLISHED:
+#if UIP_TCP_WINDOW
+	    /* Segments in flight are resent from their copies. */
+	    if(uip_connr->segments != NULL) {
+	      goto tcp_window_rexmit;
+	    }
+#endif /* UIP_TCP_WINDOW */
+#if UIP_TCP_STABLE_SEND
+	    /* Data sent with uip_send_stable() is still where it
+	       was sent from, so we can resend it ourselves. */
+	    if(uip_connr->rexmit_data != NULL) {
+	      uip_slen = uip_connr->len;
+	      memcpy(uip_sappdata, uip_connr->rexmit_data, uip_slen);
+	      goto apprexmit;
+	    }
+#endif /* UIP_TCP_STABLE_SEND */
 	    /* In the ESTABLISHED state, we call upon the application
                to do the actual retransmit after which we jump into
                the code for sending out the packet (the apprexmit
@@ -1363,6 +1444,10 @@ uip_process(uint8_t flag)
   uip_connr->rport = BUF->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &BUF->srcipaddr);
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
+#if UIP_TCP_WINDOW
+  uip_tcp_window_flush(uip_connr);
+  uip_connr->window = UIP_TCP_WINDOW_DEFAULT;
+#endif /* UIP_TCP_WINDOW */
 
   uip_connr->snd_nxt[0] = iss[0];
   uip_connr->snd_nxt[1] = iss[1];
@@ -1442,6 +1527,9 @@ uip_process(uint8_t flag)
      before we accept the reset. */
   if(BUF->flags & TCP_RST) {
     uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+    uip_tcp_window_flush(uip_connr);
+#endif /* UIP_TCP_WINDOW */
     UIP_LOG("tcp: got reset, aborting connection.");
     uip_flags = UIP_ABORT;
     UIP_APPCALL();
@@ -1477,6 +1565,44 @@ uip_process(uint8_t flag)
      data. If so, we update the sequence number, reset the length of
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
+#if UIP_TCP_WINDOW
+  if((BUF->flags & TCP_ACK) && uip_connr->segments != NULL) {
+    /* With several segments in flight, the ACK may cover any number
+       of them. */
+    if(uip_tcp_window_ack(uip_connr, BUF->ackno) > 0) {
+      /* Do RTT estimation, unless we have done retransmissions. */
+      if(uip_connr->nrtx == 0 &&
+	 !(uip_connr->wflags & UIP_TCP_WINDOW_RECOVER)) {
+	uip_update_rtt();
+      }
+      uip_flags = UIP_ACKDATA;
+      uip_connr->timer = uip_connr->rto;
+      uip_connr->nrtx = 0;
+      uip_connr->dupacks = 0;
+      if(uip_connr->segments == NULL) {
+	uip_connr->wflags &= ~(UIP_TCP_WINDOW_REXMIT | UIP_TCP_WINDOW_RECOVER);
+      } else if(uip_connr->wflags & UIP_TCP_WINDOW_RECOVER) {
+	/* An ACK that only covers part of the data in flight after a
+	   retransmission means that the next segment was lost too. */
+	uip_connr->wflags |= UIP_TCP_WINDOW_REXMIT;
+      }
+    } else if(uip_len == 0 && (BUF->flags & (TCP_SYN | TCP_FIN)) == 0 &&
+	      BUF->ackno[0] == uip_connr->snd_nxt[0] &&
+	      BUF->ackno[1] == uip_connr->snd_nxt[1] &&
+	      BUF->ackno[2] == uip_connr->snd_nxt[2] &&
+	      BUF->ackno[3] == uip_connr->snd_nxt[3]) {
+      /* A duplicate ACK. Enough of them means that the oldest
+	 segment was lost while later ones got through, so we resend
+	 it without waiting for the retransmission timer. */
+      if(++uip_connr->dupacks == UIP_TCP_WINDOW_DUPACKS) {
+	uip_connr->wflags |= UIP_TCP_WINDOW_REXMIT;
+      }
+    }
+    if(uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) {
+      uip_tcp_window_poll(uip_connr);
+    }
+  } else
+#endif /* UIP_TCP_WINDOW */
   if((BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
@@ -1492,18 +1618,7 @@ uip_process(uint8_t flag)
 	
       /* Do RTT estimation, unless we have done retransmissions. */
       if(uip_connr->nrtx == 0) {
-	signed char m;
-	m = uip_connr->rto - uip_connr->timer;
-	/* This is taken directly from VJs original code in his paper */
-	m = m - (uip_connr->sa >> 3);
-	uip_connr->sa += m;
-	if(m < 0) {
-	  m = -m;
-	}
-	m = m - (uip_connr->sv >> 2);
-	uip_connr->sv += m;
-	uip_connr->rto = (uip_connr->sa >> 3) + uip_connr->sv;
-
+	uip_update_rtt();
       }
       /* Set the acknowledged flag. */
       uip_flags = UIP_ACKDATA;
@@ -1516,6 +1631,13 @@ uip_process(uint8_t flag)
     
   }
 
+#if UIP_TCP_WINDOW
+  /* Remember how much data the peer has room for. */
+  if(BUF->flags & TCP_ACK) {
+    uip_connr->snd_wnd = ((uint16_t)BUF->wnd[0] << 8) + (uint16_t)BUF->wnd[1];
+  }
+#endif /* UIP_TCP_WINDOW */
+
   /* Do different things depending on in what state the connection is. */
   switch(uip_connr->tcpstateflags & UIP_TS_MASK) {
     /* CLOSED and LISTEN are not handled here. CLOSE_WAIT is not
@@ -1686,6 +1808,44 @@ uip_process(uint8_t flag)
     }
     uip_connr->mss = tmp16;
 
+#if UIP_TCP_WINDOW
+    if(uip_connr->wflags & UIP_TCP_WINDOW_CLOSE) {
+      /* The application has closed the connection while it had data
+	 in flight. We send the FIN when all of it is acknowledged,
+	 and drop any data that arrives in the meantime. */
+      if(!uip_outstanding(uip_connr)) {
+	goto tcp_window_close;
+      }
+      if(uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) {
+	UIP_STAT(++uip_stat.tcp.rexmit);
+	goto tcp_window_rexmit;
+      }
+      if(uip_flags & UIP_NEWDATA) {
+	goto tcp_send_ack;
+      }
+      goto drop;
+    }
+    if((uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) &&
+       !(uip_flags & UIP_NEWDATA)) {
+      /* Nothing to pass to the application, so we can use this
+	 chance to retransmit. */
+      UIP_STAT(++uip_stat.tcp.rexmit);
+      goto tcp_window_rexmit;
+    }
+    if(uip_connr->segments != NULL) {
+      /* Everything the application has sent is either acknowledged
+	 or copied, but it may only send more if it fits in the
+	 window, so uip_mss() is cut down to the room left. */
+      tmp16 = uip_tcp_window_room(uip_connr);
+      if(tmp16 > 0) {
+	uip_connr->mss = tmp16;
+	uip_flags |= UIP_ACKDATA;
+      } else {
+	uip_flags &= ~UIP_ACKDATA;
+      }
+    }
+#endif /* UIP_TCP_WINDOW */
+
     /* If this packet constitutes an ACK for outstanding data (flagged
        by the UIP_ACKDATA flag, we should call the application since it
        might want to send more data. If the incoming packet had data
@@ -1711,11 +1871,24 @@ uip_process(uint8_t flag)
       if(uip_flags & UIP_ABORT) {
 	uip_slen = 0;
 	uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+	uip_tcp_window_flush(uip_connr);
+#endif /* UIP_TCP_WINDOW */
 	BUF->flags = TCP_RST | TCP_ACK;
 	goto tcp_send_nodata;
       }
 
       if(uip_flags & UIP_CLOSE) {
+#if UIP_TCP_WINDOW
+	if(uip_connr->segments != NULL) {
+	  /* Data which the application believes to be acknowledged is
+	     still in flight, so the FIN has to wait. */
+	  uip_connr->wflags |= UIP_TCP_WINDOW_CLOSE;
+	  goto drop;
+	}
+      tcp_window_close:
+	uip_connr->wflags = 0;
+#endif /* UIP_TCP_WINDOW */
 	uip_slen = 0;
 	uip_connr->len = 1;
 	uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
@@ -1727,6 +1900,24 @@ uip_process(uint8_t flag)
       /* If uip_slen > 0, the application has data to be sent. */
       if(uip_slen > 0) {
 
+#if UIP_TCP_WINDOW
+	/* If the connection has a window with room in it, the data
+	   is copied and sent after the data already in flight. */
+	if(uip_connr->segments != NULL || uip_connr->len == 0) {
+	  tmp16 = uip_tcp_window_room(uip_connr);
+	  if(uip_slen <= tmp16 &&
+	     uip_tcp_window_push(uip_connr, uip_sappdata, uip_slen)) {
+	    goto tcp_window_send;
+	  }
+	  if(uip_connr->segments != NULL) {
+	    /* uip_mss() never exceeds the room in the window, so the
+	       application should not have sent this. */
+	    uip_slen = 0;
+	    goto apprexmit;
+	  }
+	}
+#endif /* UIP_TCP_WINDOW */
+
 	/* If the connection has acknowledged data, the contents of
 	   the ->len variable should be discarded. */
 	if((uip_flags & UIP_ACKDATA) != 0) {
@@ -1748,6 +1939,9 @@ uip_process(uint8_t flag)
 	  /* Remember how much data we send out now so that we know
 	     when everything has been acknowledged. */
 	  uip_connr->len = uip_slen;
+#if UIP_TCP_STABLE_SEND
+	  uip_connr->rexmit_data = uip_srexmit;
+#endif /* UIP_TCP_STABLE_SEND */
 	} else {
 
 	  /* If the application already had unacknowledged data, we
@@ -1779,6 +1973,36 @@ uip_process(uint8_t flag)
       }
     }
     goto drop;
+
+#if UIP_TCP_WINDOW
+  tcp_window_send:
+    /* The new segment follows all data that already is in flight. */
+    uip_add32(uip_connr->snd_nxt, uip_connr->len);
+    BUF->seqno[0] = uip_acc32[0];
+    BUF->seqno[1] = uip_acc32[1];
+    BUF->seqno[2] = uip_acc32[2];
+    BUF->seqno[3] = uip_acc32[3];
+    uip_connr->len += uip_slen;
+    if(uip_tcp_window_room(uip_connr) > 0) {
+      /* Let the application fill the rest of the window. */
+      uip_tcp_window_poll(uip_connr);
+    }
+    uip_appdata = uip_sappdata;
+    uip_len = uip_slen + UIP_TCPIP_HLEN;
+    BUF->flags = TCP_ACK | TCP_PSH;
+    BUF->tcpoffset = (UIP_TCPH_LEN / 4) << 4;
+    goto tcp_send_seqno;
+
+  tcp_window_rexmit:
+    /* Resend the oldest segment in flight from its copy. */
+    uip_connr->wflags &= ~UIP_TCP_WINDOW_REXMIT;
+    uip_connr->wflags |= UIP_TCP_WINDOW_RECOVER;
+    uip_appdata = uip_sappdata;
+    uip_slen = uip_tcp_window_copy(uip_connr, uip_sappdata);
+    uip_len = uip_slen + UIP_TCPIP_HLEN;
+    BUF->flags = TCP_ACK | TCP_PSH;
+    goto tcp_send_noopts;
+#endif /* UIP_TCP_WINDOW */
   case UIP_LAST_ACK:
     /* We can close this connection if the peer has acknowledged our
        FIN. This is indicated by the UIP_ACKDATA flag. */
@@ -1862,16 +2086,19 @@ uip_process(uint8_t flag)
      headers before calculating the checksum and finally send the
      packet. */
  tcp_send:
-  BUF->ackno[0] = uip_connr->rcv_nxt[0];
-  BUF->ackno[1] = uip_connr->rcv_nxt[1];
-  BUF->ackno[2] = uip_connr->rcv_nxt[2];
-  BUF->ackno[3] = uip_connr->rcv_nxt[3];
-  
   BUF->seqno[0] = uip_connr->snd_nxt[0];
   BUF->seqno[1] = uip_connr->snd_nxt[1];
   BUF->seqno[2] = uip_connr->snd_nxt[2];
   BUF->seqno[3] = uip_connr->snd_nxt[3];
 
+#if UIP_TCP_WINDOW
+ tcp_send_seqno:
+#endif /* UIP_TCP_WINDOW */
+  BUF->ackno[0] = uip_connr->rcv_nxt[0];
+  BUF->ackno[1] = uip_connr->rcv_nxt[1];
+  BUF->ackno[2] = uip_connr->rcv_nxt[2];
+  BUF->ackno[3] = uip_connr->rcv_nxt[3];
+
   BUF->proto = UIP_PROTO_TCP;
   
   BUF->srcport  = uip_connr->lport;
@@ -1968,7 +2195,21 @@ uip_send(const void *data, int len)
       memcpy(uip_sappdata, (data), uip_slen);
     }
   }
+#if UIP_TCP_STABLE_SEND
+  uip_srexmit = NULL;
+#endif /* UIP_TCP_STABLE_SEND */
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP_STABLE_SEND
+void
+uip_send_stable(const void *data, int len)
+{
+  uip_send(data, len);
+  if(data != uip_sappdata) {
+    uip_srexmit = data;
+  }
 }
+#endif /* UIP_TCP_STABLE_SEND */
 /*---------------------------------------------------------------------------*/
 /** @} */
 #endif /* UIP_CONF_IPV6 */
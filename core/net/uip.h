@@ -479,7 +479,17 @@ typedef union {
   uint8_t u8[UIP_BUFSIZE];
 } uip_buf_t;
 
+#if UIP_BUFFER_HEADROOM
+typedef struct {
+  uint8_t headroom[UIP_BUFFER_HEADROOM];
+  uip_buf_t buf;
+} uip_headroom_buf_t;
+
+CCIF extern uip_headroom_buf_t uip_headroom_buf;
+#define uip_aligned_buf (uip_headroom_buf.buf)
+#else /* UIP_BUFFER_HEADROOM */
 CCIF extern uip_buf_t uip_aligned_buf;
+#endif /* UIP_BUFFER_HEADROOM */
 #define uip_buf (uip_aligned_buf.u8)
 
 
@@ -599,6 +609,27 @@ struct uip_conn *uip_connect(uip_ipaddr_t *ripaddr, uint16_t port);
  */
 CCIF void uip_send(const void *data, int len);
 
+/**
+ * Send data that stays unchanged until it has been acknowledged.
+ *
+ * This function works like uip_send(), but the data must remain at
+ * the same place and unchanged until the remote host has acknowledged
+ * it, such as a constant string or a file in ROM. If it is lost, uIP
+ * resends it from there without invoking the application with the
+ * uip_rexmit() event.
+ *
+ * \param data A pointer to the data which is to be sent.
+ *
+ * \param len The maximum amount of data bytes to be sent.
+ *
+ * \hideinitializer
+ */
+#if UIP_TCP_STABLE_SEND
+CCIF void uip_send_stable(const void *data, int len);
+#else /* UIP_TCP_STABLE_SEND */
+#define uip_send_stable(data, len) uip_send(data, len)
+#endif /* UIP_TCP_STABLE_SEND */
+
 /**
  * The length of any incoming data that is currently available (if available)
  * in the uip_appdata buffer.
@@ -798,6 +829,36 @@ CCIF void uip_send(const void *data, int len);
  */
 #define uip_mss()             (uip_conn->mss)
 
+/**
+ * Set the number of segments that a connection may have in flight.
+ *
+ * With more than one segment, uIP keeps a copy of the data that the
+ * application sends and reports it as acknowledged as soon as it has
+ * been copied, so that the application can go on sending while
+ * earlier segments travel to the peer. Lost segments are then
+ * retransmitted by uIP and the application never sees the
+ * uip_rexmit() event. The copies come from a pool of
+ * UIP_CONF_TCP_WINDOW buffers shared by all connections; a
+ * connection that finds the pool empty sends a single segment at a
+ * time.
+ *
+ * The application still follows the usual rules for when it may
+ * send new data, and must not send more than uip_mss(), which is
+ * then limited to the room left in the window.
+ *
+ * \param conn A pointer to the uip_conn structure for the connection.
+ *
+ * \param segments The number of segments. Zero or one gives the
+ * normal uIP behaviour.
+ *
+ * \hideinitializer
+ */
+#if UIP_TCP_WINDOW
+#define uip_set_window(conn, segments) ((conn)->window = (segments))
+#else /* UIP_TCP_WINDOW */
+#define uip_set_window(conn, segments)
+#endif /* UIP_TCP_WINDOW */
+
 /**
  * Set up a new UDP connection.
  *
@@ -834,7 +895,11 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if UIP_CONF_IPV6 && UIP_DEMUX_CACHE
+#define uip_udp_remove(conn) ((conn)->lport = 0, uip_demux_flush())
+#else
 #define uip_udp_remove(conn) (conn)->lport = 0
+#endif
 
 /**
  * Bind a UDP connection to a local port.
@@ -846,7 +911,19 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if UIP_CONF_IPV6 && UIP_DEMUX_CACHE
+#define uip_udp_bind(conn, port) ((conn)->lport = port, uip_demux_flush())
+#else
 #define uip_udp_bind(conn, port) (conn)->lport = port
+#endif
+
+#if UIP_CONF_IPV6 && UIP_DEMUX_CACHE
+/**
+ * Forget all cached connection lookups. Called when UDP connections
+ * are created, bound or removed.
+ */
+void uip_demux_flush(void);
+#endif
 
 /**
  * Send a UDP datagram of length len on the current connection.
@@ -1319,6 +1396,20 @@ struct uip_conn {
   uint8_t timer;         /**< The retransmission timer. */
   uint8_t nrtx;          /**< The number of retransmissions for the last
 			 segment sent. */
+#if UIP_TCP_STABLE_SEND
+  const void *rexmit_data; /**< Where the data in transit was sent from
+			      with uip_send_stable(), or NULL. */
+#endif /* UIP_TCP_STABLE_SEND */
+#if UIP_TCP_WINDOW
+  struct uip_tcp_segment *segments; /**< Copies of the segments in
+				       flight, oldest first. */
+  uint16_t snd_wnd;      /**< The window advertised by the peer. */
+  uint8_t window;        /**< The number of segments that may be in
+			 flight. */
+  uint8_t queued;        /**< The number of copied segments in flight. */
+  uint8_t dupacks;       /**< The number of duplicate ACKs received. */
+  uint8_t wflags;        /**< Send window state flags. */
+#endif /* UIP_TCP_WINDOW */
 
   /** The application state. */
   uip_tcp_appstate_t appstate;
@@ -1856,6 +1947,7 @@ struct uip_udp_hdr {
 #define UIP_EXT_HDR_OPT_PAD1  0
 #define UIP_EXT_HDR_OPT_PADN  1
 #define UIP_EXT_HDR_OPT_RPL   0x63
+#define UIP_EXT_HDR_OPT_MPL   0x6d
 
 /** @} */
 
@@ -72,9 +72,12 @@
 
 #include "net/uip.h"
 #include "net/uipopt.h"
+#include "net/uip_arch.h"
 #include "net/uip-icmp6.h"
 #include "net/uip-nd6.h"
 #include "net/uip-ds6.h"
+#include "net/uip-tcp-window.h"
+#include "net/uip-mcast6.h"
 
 #include <string.h>
 
@@ -143,7 +146,6 @@ uint8_t uip_ext_opt_offset = 0;
 /** \name Buffer defines
  *  @{
  */
-#define FBUF                             ((struct uip_tcpip_hdr *)&uip_reassbuf[0])
 #define UIP_IP_BUF                          ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
 #define UIP_ICMP_BUF                      ((struct uip_icmp_hdr *)&uip_buf[uip_l2_l3_hdr_len])
 #define UIP_UDP_BUF                        ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
@@ -165,13 +167,22 @@ uint8_t uip_ext_opt_offset = 0;
  */
 /** Packet buffer for incoming and outgoing packets */
 #ifndef UIP_CONF_EXTERNAL_BUFFER
+#if UIP_BUFFER_HEADROOM
+uip_headroom_buf_t uip_headroom_buf;
+#else /* UIP_BUFFER_HEADROOM */
 uip_buf_t uip_aligned_buf;
+#endif /* UIP_BUFFER_HEADROOM */
 #endif /* UIP_CONF_EXTERNAL_BUFFER */
 
 /* The uip_appdata pointer points to application data. */
 void *uip_appdata;
 /* The uip_appdata pointer points to the application data which is to be sent*/
 void *uip_sappdata;
+#if UIP_TCP_STABLE_SEND
+/* Where the data which is to be sent was copied from, if the application
+   keeps it there */
+static const void *uip_srexmit;
+#endif /* UIP_TCP_STABLE_SEND */
 
 #if UIP_URGDATA > 0
 /* The uip_urgdata pointer points to urgent data (out-of-band data), if present */
@@ -255,6 +266,32 @@ struct uip_udp_conn uip_udp_conns[UIP_UDP_CONNS];
 #endif /* UIP_UDP */
 /** @} */
 
+#if UIP_DEMUX_CACHE
+/*---------------------------------------------------------------------------*/
+/** @{ \name Connection lookup caches                                       */
+/*---------------------------------------------------------------------------*/
+/**
+ * An entry maps the ports and source address of a packet to the
+ * connection it was last delivered to. Hits are checked against the
+ * connection, so entries only need flushing when a connection that
+ * comes earlier in the connection table could start to match, i.e.
+ * when UDP connections are created or bound.
+ */
+struct uip_demux_entry {
+  void *conn;
+  uint16_t lport;
+  uint16_t rport;
+  uip_ipaddr_t ripaddr;
+};
+#if UIP_TCP
+static struct uip_demux_entry uip_tcp_demux[UIP_DEMUX_CACHE];
+#endif /* UIP_TCP */
+#if UIP_UDP
+static struct uip_demux_entry uip_udp_demux[UIP_DEMUX_CACHE];
+#endif /* UIP_UDP */
+/** @} */
+#endif /* UIP_DEMUX_CACHE */
+
 /*---------------------------------------------------------------------------*/
 /** @{ \name ICMPv6 variables                                                */
 /*---------------------------------------------------------------------------*/
@@ -299,36 +336,42 @@ uip_add32(uint8_t *op32, uint16_t op16)
 
 #if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
+#if UIP_ARCH_SUM
+#define chksum(sum, data, len) uip_arch_sum(sum, data, len)
+#else /* UIP_ARCH_SUM */
 static uint16_t
 chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-  
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
-    dataptr += 2;
+  uint32_t acc;
+
+  /* The 16-bit words are added up in 32 bits and the carries are
+     folded back in once at the end. With at most 32768 words the
+     accumulator cannot overflow. */
+  acc = sum;
+  while(len >= 8) {
+    acc += ((uint16_t)data[0] << 8) + data[1];
+    acc += ((uint16_t)data[2] << 8) + data[3];
+    acc += ((uint16_t)data[4] << 8) + data[5];
+    acc += ((uint16_t)data[6] << 8) + data[7];
+    data += 8;
+    len -= 8;
   }
-  
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
+  while(len >= 2) {
+    acc += ((uint16_t)data[0] << 8) + data[1];
+    data += 2;
+    len -= 2;
+  }
+  if(len > 0) {
+    acc += (uint16_t)data[0] << 8;
   }
 
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
+
   /* Return sum in host byte order. */
-  return sum;
+  return (uint16_t)acc;
 }
+#endif /* UIP_ARCH_SUM */
 /*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
@@ -417,7 +460,13 @@ uip_init(void)
   }
   for(c = 0; c < UIP_CONNS; ++c) {
     uip_conns[c].tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+    uip_conns[c].segments = NULL;
+#endif /* UIP_TCP_WINDOW */
   }
+#if UIP_TCP_WINDOW
+  uip_tcp_window_init();
+#endif /* UIP_TCP_WINDOW */
 #endif /* UIP_TCP */
 
 #if UIP_ACTIVE_OPEN || UIP_UDP
@@ -429,8 +478,58 @@ uip_init(void)
     uip_udp_conns[c].lport = 0;
   }
 #endif /* UIP_UDP */
+
+#if UIP_DEMUX_CACHE
+  uip_demux_flush();
+#endif /* UIP_DEMUX_CACHE */
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_DEMUX_CACHE
+void
+uip_demux_flush(void)
+{
+#if UIP_TCP
+  memset(uip_tcp_demux, 0, sizeof(uip_tcp_demux));
+#endif /* UIP_TCP */
+#if UIP_UDP
+  memset(uip_udp_demux, 0, sizeof(uip_udp_demux));
+#endif /* UIP_UDP */
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * Returns the cache entry for the ports and source address of the
+ * packet in uip_buf. The entry is a hit if its conn is non-NULL and
+ * its key matches, otherwise it may be refilled by the caller.
+ */
+static struct uip_demux_entry *
+uip_demux_bucket(struct uip_demux_entry *cache, uint16_t lport, uint16_t rport)
+{
+  uint16_t h;
+
+  h = lport ^ rport ^ UIP_IP_BUF->srcipaddr.u16[6] ^
+    UIP_IP_BUF->srcipaddr.u16[7];
+  h ^= h >> 8;
+  return &cache[h & (UIP_DEMUX_CACHE - 1)];
+}
+
+static uint8_t
+uip_demux_hit(struct uip_demux_entry *e, uint16_t lport, uint16_t rport)
+{
+  return e->conn != NULL && e->lport == lport && e->rport == rport &&
+    uip_ipaddr_cmp(&e->ripaddr, &UIP_IP_BUF->srcipaddr);
+}
+
+static void
+uip_demux_fill(struct uip_demux_entry *e, void *conn,
+               uint16_t lport, uint16_t rport)
+{
+  e->conn = conn;
+  e->lport = lport;
+  e->rport = rport;
+  uip_ipaddr_copy(&e->ripaddr, &UIP_IP_BUF->srcipaddr);
+}
+#endif /* UIP_DEMUX_CACHE */
+/*---------------------------------------------------------------------------*/
 #if UIP_TCP && UIP_ACTIVE_OPEN
 struct uip_conn *
 uip_connect(uip_ipaddr_t *ripaddr, uint16_t rport)
@@ -497,6 +596,10 @@ uip_connect(uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->lport = uip_htons(lastport);
   conn->rport = rport;
   uip_ipaddr_copy(&conn->ripaddr, ripaddr);
+#if UIP_TCP_WINDOW
+  uip_tcp_window_flush(conn);
+  conn->window = UIP_TCP_WINDOW_DEFAULT;
+#endif /* UIP_TCP_WINDOW */
   
   return conn;
 }
@@ -567,6 +670,10 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
     uip_ipaddr_copy(&conn->ripaddr, ripaddr);
   }
   conn->ttl = uip_ds6_if.cur_hop_limit;
+
+#if UIP_DEMUX_CACHE
+  uip_demux_flush();
+#endif /* UIP_DEMUX_CACHE */
   
   return conn;
 }
@@ -600,20 +707,36 @@ uip_listen(uint16_t port)
 #if UIP_CONF_IPV6_REASSEMBLY
 #define UIP_REASS_BUFSIZE (UIP_BUFSIZE - UIP_LLH_LEN)
 
-static uint8_t uip_reassbuf[UIP_REASS_BUFSIZE];
-
-static uint8_t uip_reassbitmap[UIP_REASS_BUFSIZE / (8 * 8)];
-/*the first byte of an IP fragment is aligned on an 8-byte boundary */
-
-static const uint8_t bitmap_bits[8] = {0xff, 0x7f, 0x3f, 0x1f,
-                                    0x0f, 0x07, 0x03, 0x01};
-static uint16_t uip_reasslen;
-static uint8_t uip_reassflags;
+/* One bit per 8-byte block of the reassembly buffer */
+#define UIP_REASS_BITMAP_SIZE ((UIP_REASS_BUFSIZE / 8 + 7) / 8)
 
 #define UIP_REASS_FLAG_LASTFRAG 0x01
 #define UIP_REASS_FLAG_FIRSTFRAG 0x02
 #define UIP_REASS_FLAG_ERROR_MSG 0x04
 
+/**
+ * A reassembly context: a fragmented packet being reassembled, identified
+ * by its source and destination addresses and fragment identification.
+ */
+struct uip_reass_ctx {
+  uint8_t buf[UIP_REASS_BUFSIZE];
+  /* the first byte of an IP fragment is aligned on an 8-byte boundary */
+  uint8_t bitmap[UIP_REASS_BITMAP_SIZE];
+  /* length of the fragmentable part, known once the last fragment is in */
+  uint16_t len;
+  /* length of the extension headers in the unfragmentable part */
+  uint8_t ext_len;
+  uint8_t flags;
+  /* equal to 1 if this context is reassembling a packet */
+  uint8_t on;
+  uint32_t id;
+  struct timer timer;
+};
+
+static struct uip_reass_ctx uip_reass_contexts[UIP_REASS_CONTEXTS];
+
+/* UIP_REASS_FLAG_ERROR_MSG if uip_reass() left an error message in uip_buf */
+static uint8_t uip_reassflags;
 
 /*
  * See RFC 2460 for a description of fragmentation in IPv6
@@ -625,156 +748,217 @@ static uint8_t uip_reassflags;
  */
 
 
-struct etimer uip_reass_timer; /* timer for reassembly */
-uint8_t uip_reass_on; /* equal to 1 if we are currently reassembling a packet */
+struct etimer uip_reass_timer; /* fires when the oldest context expires */
 
-static uint32_t uip_id; /* For every packet that is to be fragmented, the source
-                        node generates an Identification value that is present
-                        in all the fragments */
 #define IP_MF   0x0001
 
+#define FBUF(r)                 ((struct uip_tcpip_hdr *)&(r)->buf[0])
+#define BLOCK_SET(r, b)         ((r)->bitmap[(b) >> 3] & (0x80 >> ((b) & 7)))
+
+/* Arm uip_reass_timer for the context that expires first. */
+static void
+uip_reass_set_timer(void)
+{
+  struct uip_reass_ctx *r;
+  clock_time_t next = 0, left;
+  uint8_t armed = 0;
+
+  for(r = uip_reass_contexts; r < &uip_reass_contexts[UIP_REASS_CONTEXTS]; r++) {
+    if(r->on) {
+      left = timer_expired(&r->timer) ? 0 : timer_remaining(&r->timer);
+      if(!armed || left < next) {
+        next = left;
+        armed = 1;
+      }
+    }
+  }
+  if(armed) {
+    etimer_set(&uip_reass_timer, next);
+  } else {
+    etimer_stop(&uip_reass_timer);
+  }
+}
+
+static void
+uip_reass_free(struct uip_reass_ctx *r)
+{
+  r->on = 0;
+  uip_reass_set_timer();
+}
+
 static uint16_t
 uip_reass(void)
 {
+  struct uip_reass_ctx *r, *free_ctx = NULL;
   uint16_t offset=0;
   uint16_t len;
-  uint16_t i;
-  
-  /* If ip_reasstmr is zero, no packet is present in the buffer */
-  /* We first write the unfragmentable part of IP header into the reassembly
-     buffer. The reset the other reassembly variables. */
-  if(uip_reass_on == 0) {
+  uint16_t b, first, last, seen;
+
+  uip_reassflags = 0;
+
+  /*
+   * Look for the context the incoming fragment belongs to. If there is
+   * none, we start reassembling the packet in a free context, after
+   * writing the unfragmentable part of the IP header into its buffer.
+   */
+  for(r = uip_reass_contexts; r < &uip_reass_contexts[UIP_REASS_CONTEXTS]; r++) {
+    if(!r->on) {
+      if(free_ctx == NULL) {
+        free_ctx = r;
+      }
+    } else if(uip_ipaddr_cmp(&FBUF(r)->srcipaddr, &UIP_IP_BUF->srcipaddr) &&
+              uip_ipaddr_cmp(&FBUF(r)->destipaddr, &UIP_IP_BUF->destipaddr) &&
+              UIP_FRAG_BUF->id == r->id) {
+      break;
+    }
+  }
+  if(r == &uip_reass_contexts[UIP_REASS_CONTEXTS]) {
+    if(free_ctx == NULL) {
+      PRINTF("No free reassembly context\n");
+      return 0;
+    }
     PRINTF("Starting reassembly\n");
-    memcpy(FBUF, UIP_IP_BUF, uip_ext_len + UIP_IPH_LEN);
+    r = free_ctx;
+    memcpy(FBUF(r), UIP_IP_BUF, uip_ext_len + UIP_IPH_LEN);
     /* temporary in case we do not receive the fragment with offset 0 first */
-    etimer_set(&uip_reass_timer, UIP_REASS_MAXAGE*CLOCK_SECOND);
-    uip_reass_on = 1;
-    uip_reassflags = 0;
-    uip_id = UIP_FRAG_BUF->id;
+    timer_set(&r->timer, UIP_REASS_MAXAGE * CLOCK_SECOND);
+    r->on = 1;
+    r->flags = 0;
+    r->len = 0;
+    r->ext_len = uip_ext_len;
+    r->id = UIP_FRAG_BUF->id;
     /* Clear the bitmap. */
-    memset(uip_reassbitmap, 0, sizeof(uip_reassbitmap));
+    memset(r->bitmap, 0, sizeof(r->bitmap));
+    uip_reass_set_timer();
   }
-  /*
-   * Check if the incoming fragment matches the one currently present
-   * in the reasembly buffer. If so, we proceed with copying the fragment
-   * into the buffer.
-   */
-  if(uip_ipaddr_cmp(&FBUF->srcipaddr, &UIP_IP_BUF->srcipaddr) &&
-     uip_ipaddr_cmp(&FBUF->destipaddr, &UIP_IP_BUF->destipaddr) &&
-     UIP_FRAG_BUF->id == uip_id) {
-    len = uip_len - uip_ext_len - UIP_IPH_LEN - UIP_FRAGH_LEN;
-    offset = (uip_ntohs(UIP_FRAG_BUF->offsetresmore) & 0xfff8);
-    /* in byte, originaly in multiple of 8 bytes*/
-    PRINTF("len %d\n", len);
-    PRINTF("offset %d\n", offset);
-    if(offset == 0){
-      uip_reassflags |= UIP_REASS_FLAG_FIRSTFRAG;
-      /*
-       * The Next Header field of the last header of the Unfragmentable
-       * Part is obtained from the Next Header field of the first
-       * fragment's Fragment header.
-       */
-      *uip_next_hdr = UIP_FRAG_BUF->next;
-      memcpy(FBUF, UIP_IP_BUF, uip_ext_len + UIP_IPH_LEN);
-      PRINTF("src ");
-      PRINT6ADDR(&FBUF->srcipaddr);
-      PRINTF("dest ");
-      PRINT6ADDR(&FBUF->destipaddr);
-      PRINTF("next %d\n", UIP_IP_BUF->proto);
-      
-    }
-    
-    /* If the offset or the offset + fragment length overflows the
-       reassembly buffer, we discard the entire packet. */
-    if(offset > UIP_REASS_BUFSIZE ||
-       offset + len > UIP_REASS_BUFSIZE) {
-      uip_reass_on = 0;
-      etimer_stop(&uip_reass_timer);
+
+  /* Fragments are stored right after the unfragmentable part */
+  if(uip_ext_len != r->ext_len) {
+    PRINTF("Unfragmentable part changed, dropping fragment\n");
+    return 0;
+  }
+
+  len = uip_len - uip_ext_len - UIP_IPH_LEN - UIP_FRAGH_LEN;
+  offset = (uip_ntohs(UIP_FRAG_BUF->offsetresmore) & 0xfff8);
+  /* in byte, originaly in multiple of 8 bytes*/
+  PRINTF("len %d\n", len);
+  PRINTF("offset %d\n", offset);
+
+  /* If the offset or the offset + fragment length overflows the
+     reassembly buffer, we discard the entire packet. */
+  if(offset > UIP_REASS_BUFSIZE - UIP_IPH_LEN - r->ext_len ||
+     offset + len > UIP_REASS_BUFSIZE - UIP_IPH_LEN - r->ext_len) {
+    uip_reass_free(r);
+    return 0;
+  }
+
+  /* If this fragment has the More Fragments flag set to zero, it is the
+     last fragment*/
+  if((uip_ntohs(UIP_FRAG_BUF->offsetresmore) & IP_MF) == 0) {
+    /* Two last fragments with different lengths: the packet is bogus */
+    if((r->flags & UIP_REASS_FLAG_LASTFRAG) && r->len != offset + len) {
+      uip_reass_free(r);
       return 0;
     }
+    r->flags |= UIP_REASS_FLAG_LASTFRAG;
+    /*calculate the size of the entire packet*/
+    r->len = offset + len;
+    PRINTF("LAST FRAGMENT reasslen %d\n", r->len);
+  } else {
+    /* If len is not a multiple of 8 octets and the M flag of that fragment
+       is 1, then that fragment must be discarded and an ICMP Parameter
+       Problem, Code 0, message should be sent to the source of the fragment,
+       pointing to the Payload Length field of the fragment packet. */
+    if(len % 8 != 0){
+      uip_icmp6_error_output(ICMP6_PARAM_PROB, ICMP6_PARAMPROB_HEADER, 4);
+      uip_reassflags |= UIP_REASS_FLAG_ERROR_MSG;
+      /* not clear if we should interrupt reassembly, but it seems so from
+         the conformance tests */
+      uip_reass_free(r);
+      return uip_len;
+    }
+  }
 
-    /* If this fragment has the More Fragments flag set to zero, it is the
-       last fragment*/
-    if((uip_ntohs(UIP_FRAG_BUF->offsetresmore) & IP_MF) == 0) {
-      uip_reassflags |= UIP_REASS_FLAG_LASTFRAG;
-      /*calculate the size of the entire packet*/
-      uip_reasslen = offset + len;
-      PRINTF("LAST FRAGMENT reasslen %d\n", uip_reasslen);
-    } else {
-      /* If len is not a multiple of 8 octets and the M flag of that fragment
-         is 1, then that fragment must be discarded and an ICMP Parameter
-         Problem, Code 0, message should be sent to the source of the fragment,
-         pointing to the Payload Length field of the fragment packet. */
-      if(len % 8 != 0){
-        uip_icmp6_error_output(ICMP6_PARAM_PROB, ICMP6_PARAMPROB_HEADER, 4);
-        uip_reassflags |= UIP_REASS_FLAG_ERROR_MSG;
-        /* not clear if we should interrupt reassembly, but it seems so from
-           the conformance tests */
-        uip_reass_on = 0;
-        etimer_stop(&uip_reass_timer);
-        return uip_len;
-      }
+  /* A fragment past the end of the packet: the packet is bogus */
+  if((r->flags & UIP_REASS_FLAG_LASTFRAG) && offset + len > r->len) {
+    uip_reass_free(r);
+    return 0;
+  }
+
+  /*
+   * Overlapping fragments: RFC 5722 requires the whole packet to be
+   * discarded. Exact duplicates, which occur in the network, are only
+   * dropped themselves.
+   */
+  first = offset >> 3;
+  last = (offset + len + 7) >> 3;
+  seen = 0;
+  for(b = first; b < last; b++) {
+    if(BLOCK_SET(r, b)) {
+      seen++;
     }
-    
-    /* Copy the fragment into the reassembly buffer, at the right
-       offset. */
-    memcpy((uint8_t *)FBUF + UIP_IPH_LEN + uip_ext_len + offset,
-           (uint8_t *)UIP_FRAG_BUF + UIP_FRAGH_LEN, len);
-    
-    /* Update the bitmap. */
-    if(offset >> 6 == (offset + len) >> 6) {
-      uip_reassbitmap[offset >> 6] |=
-        bitmap_bits[(offset >> 3) & 7] &
-        ~bitmap_bits[((offset + len) >> 3)  & 7];
+  }
+  if(seen > 0) {
+    if(seen == last - first &&
+       memcmp((uint8_t *)FBUF(r) + UIP_IPH_LEN + r->ext_len + offset,
+              (uint8_t *)UIP_FRAG_BUF + UIP_FRAGH_LEN, len) == 0) {
+      PRINTF("Duplicate fragment\n");
     } else {
-      /* If the two endpoints are in different bytes, we update the
-         bytes in the endpoints and fill the stuff inbetween with
-         0xff. */
-      uip_reassbitmap[offset >> 6] |= bitmap_bits[(offset >> 3) & 7];
- 
-      for(i = (1 + (offset >> 6)); i < ((offset + len) >> 6); ++i) {
-        uip_reassbitmap[i] = 0xff;
-      }
-      uip_reassbitmap[(offset + len) >> 6] |=
-        ~bitmap_bits[((offset + len) >> 3) & 7];
+      PRINTF("Overlapping fragment, dropping packet\n");
+      uip_reass_free(r);
     }
-  
-    /* Finally, we check if we have a full packet in the buffer. We do
-       this by checking if we have the last fragment and if all bits
-       in the bitmap are set. */
-    
-    if(uip_reassflags & UIP_REASS_FLAG_LASTFRAG) {
-      /* Check all bytes up to and including all but the last byte in
-         the bitmap. */
-      for(i = 0; i < (uip_reasslen >> 6); ++i) {
-        if(uip_reassbitmap[i] != 0xff) {
-          return 0;
-        }
-      }
-      /* Check the last byte in the bitmap. It should contain just the
-         right amount of bits. */
-      if(uip_reassbitmap[uip_reasslen >> 6] !=
-         (uint8_t)~bitmap_bits[(uip_reasslen >> 3) & 7]) {
+    return 0;
+  }
+
+  if(offset == 0){
+    r->flags |= UIP_REASS_FLAG_FIRSTFRAG;
+    /*
+     * The Next Header field of the last header of the Unfragmentable
+     * Part is obtained from the Next Header field of the first
+     * fragment's Fragment header.
+     */
+    *uip_next_hdr = UIP_FRAG_BUF->next;
+    memcpy(FBUF(r), UIP_IP_BUF, uip_ext_len + UIP_IPH_LEN);
+    PRINTF("src ");
+    PRINT6ADDR(&FBUF(r)->srcipaddr);
+    PRINTF("dest ");
+    PRINT6ADDR(&FBUF(r)->destipaddr);
+    PRINTF("next %d\n", UIP_IP_BUF->proto);
+  }
+
+  /* Copy the fragment into the reassembly buffer, at the right
+     offset. */
+  memcpy((uint8_t *)FBUF(r) + UIP_IPH_LEN + r->ext_len + offset,
+         (uint8_t *)UIP_FRAG_BUF + UIP_FRAGH_LEN, len);
+
+  /* Update the bitmap. */
+  for(b = first; b < last; b++) {
+    r->bitmap[b >> 3] |= 0x80 >> (b & 7);
+  }
+
+  /* Finally, we check if we have a full packet in the buffer. We do
+     this by checking if we have the last fragment and if all blocks
+     up to its end are in the bitmap. */
+  if(r->flags & UIP_REASS_FLAG_LASTFRAG) {
+    last = (r->len + 7) >> 3;
+    for(b = 0; b < last; b++) {
+      if(!BLOCK_SET(r, b)) {
         return 0;
       }
-
-     /* If we have come this far, we have a full packet in the
-         buffer, so we copy it to uip_buf. We also reset the timer. */
-      uip_reass_on = 0;
-      etimer_stop(&uip_reass_timer);
-
-      uip_reasslen += UIP_IPH_LEN + uip_ext_len;
-      memcpy(UIP_IP_BUF, FBUF, uip_reasslen);
-      UIP_IP_BUF->len[0] = ((uip_reasslen - UIP_IPH_LEN) >> 8);
-      UIP_IP_BUF->len[1] = ((uip_reasslen - UIP_IPH_LEN) & 0xff);
-      PRINTF("REASSEMBLED PAQUET %d (%d)\n", uip_reasslen,
-             (UIP_IP_BUF->len[0] << 8) | UIP_IP_BUF->len[1]);
-   
-      return uip_reasslen;
-      
     }
-  } else {
-    PRINTF("Already reassembling another paquet\n");
+
+    /* If we have come this far, we have a full packet in the
+       buffer, so we copy it to uip_buf. We also free the context. */
+    uip_reass_free(r);
+
+    len = r->len + UIP_IPH_LEN + r->ext_len;
+    memcpy(UIP_IP_BUF, FBUF(r), len);
+    UIP_IP_BUF->len[0] = ((len - UIP_IPH_LEN) >> 8);
+    UIP_IP_BUF->len[1] = ((len - UIP_IPH_LEN) & 0xff);
+    PRINTF("REASSEMBLED PAQUET %d (%d)\n", len,
+           (UIP_IP_BUF->len[0] << 8) | UIP_IP_BUF->len[1]);
+
+    return len;
   }
   return 0;
 }
@@ -782,31 +966,41 @@ uip_reass(void)
 void
 uip_reass_over(void)
 {
-   /* to late, we abandon the reassembly of the packet */
-
-  uip_reass_on = 0;
-  etimer_stop(&uip_reass_timer);
-
-  if(uip_reassflags & UIP_REASS_FLAG_FIRSTFRAG){
-    PRINTF("FRAG INTERRUPTED TOO LATE\n");
-    /* If the first fragment has been received, an ICMP Time Exceeded
-       -- Fragment Reassembly Time Exceeded message should be sent to the
-       source of that fragment. */
-    /** \note
-     * We don't have a complete packet to put in the error message.
-     * We could include the first fragment but since its not mandated by
-     * any RFC, we decided not to include it as it reduces the size of
-     * the packet.
-     */
-    uip_len = 0;
-    uip_ext_len = 0;
-    memcpy(UIP_IP_BUF, FBUF, UIP_IPH_LEN); /* copy the header for src
-                                              and dest address*/
-    uip_icmp6_error_output(ICMP6_TIME_EXCEEDED, ICMP6_TIME_EXCEED_REASSEMBLY, 0);
-    
-    UIP_STAT(++uip_stat.ip.sent);
-    uip_flags = 0;
+  struct uip_reass_ctx *r;
+
+  uip_len = 0;
+  for(r = uip_reass_contexts; r < &uip_reass_contexts[UIP_REASS_CONTEXTS]; r++) {
+    if(!r->on || !timer_expired(&r->timer)) {
+      continue;
+    }
+
+    /* to late, we abandon the reassembly of the packet */
+    r->on = 0;
+
+    if(r->flags & UIP_REASS_FLAG_FIRSTFRAG){
+      PRINTF("FRAG INTERRUPTED TOO LATE\n");
+      /* If the first fragment has been received, an ICMP Time Exceeded
+         -- Fragment Reassembly Time Exceeded message should be sent to the
+         source of that fragment. */
+      /** \note
+       * We don't have a complete packet to put in the error message.
+       * We could include the first fragment but since its not mandated by
+       * any RFC, we decided not to include it as it reduces the size of
+       * the packet.
+       */
+      uip_ext_len = 0;
+      memcpy(UIP_IP_BUF, FBUF(r), UIP_IPH_LEN); /* copy the header for src
+                                                   and dest address*/
+      uip_icmp6_error_output(ICMP6_TIME_EXCEEDED, ICMP6_TIME_EXCEED_REASSEMBLY, 0);
+
+      UIP_STAT(++uip_stat.ip.sent);
+      uip_flags = 0;
+      /* uip_buf holds the error message: other expired contexts are
+         handled when the timer fires again, right away */
+      break;
+    }
   }
+  uip_reass_set_timer();
 }
 
 #endif /* UIP_CONF_IPV6_REASSEMBLY */
@@ -822,6 +1016,23 @@ uip_add_rcv_nxt(uint16_t n)
   uip_conn->rcv_nxt[2] = uip_acc32[2];
   uip_conn->rcv_nxt[3] = uip_acc32[3];
 }
+/*---------------------------------------------------------------------------*/
+static void
+uip_update_rtt(void)
+{
+  signed char m;
+
+  m = uip_conn->rto - uip_conn->timer;
+  /* This is taken directly from VJs original code in his paper */
+  m = m - (uip_conn->sa >> 3);
+  uip_conn->sa += m;
+  if(m < 0) {
+    m = -m;
+  }
+  m = m - (uip_conn->sv >> 2);
+  uip_conn->sv += m;
+  uip_conn->rto = (uip_conn->sa >> 3) + uip_conn->sv;
+}
 #endif
 /*---------------------------------------------------------------------------*/
 
@@ -870,6 +1081,13 @@ ext_hdr_options_process(void)
 #endif /* UIP_CONF_IPV6_RPL */
         uip_ext_opt_offset += (UIP_EXT_HDR_OPT_BUF->len) + 2;
         return 0;
+#if UIP_IPV6_MULTICAST
+      case UIP_EXT_HDR_OPT_MPL:
+        /* Interpreted by the multicast engine. */
+        PRINTF("Processing MPL option\n");
+        uip_ext_opt_offset += UIP_EXT_HDR_OPT_BUF->len + 2;
+        break;
+#endif /* UIP_IPV6_MULTICAST */
       default:
         /*
          * check the two highest order bits of the option
@@ -909,12 +1127,29 @@ ext_hdr_options_process(void)
 
 
 /*---------------------------------------------------------------------------*/
+/* Does a connection accept the UDP datagram / TCP segment in uip_buf? */
+#define UIP_UDP_CONN_MATCH(conn)                                        \
+  ((conn)->lport != 0 &&                                                \
+   UIP_UDP_BUF->destport == (conn)->lport &&                            \
+   ((conn)->rport == 0 ||                                               \
+    UIP_UDP_BUF->srcport == (conn)->rport) &&                           \
+   (uip_is_addr_unspecified(&(conn)->ripaddr) ||                        \
+    uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &(conn)->ripaddr)))
+#define UIP_TCP_CONN_MATCH(conn)                                        \
+  ((conn)->tcpstateflags != UIP_CLOSED &&                               \
+   UIP_TCP_BUF->destport == (conn)->lport &&                            \
+   UIP_TCP_BUF->srcport == (conn)->rport &&                             \
+   uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &(conn)->ripaddr))
+
 void
 uip_process(uint8_t flag)
 {
 #if UIP_TCP
   register struct uip_conn *uip_connr = uip_conn;
 #endif /* UIP_TCP */
+#if UIP_DEMUX_CACHE
+  struct uip_demux_entry *demux;
+#endif /* UIP_DEMUX_CACHE */
 #if UIP_UDP
   if(flag == UIP_UDP_SEND_CONN) {
     goto udp_send;
@@ -926,6 +1161,26 @@ uip_process(uint8_t flag)
      particular connection. */
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
+#if UIP_TCP_WINDOW
+    if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+       uip_connr->segments != NULL) {
+      if(uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) {
+        UIP_STAT(++uip_stat.tcp.rexmit);
+        goto tcp_window_rexmit;
+      }
+      tmp16 = uip_tcp_window_room(uip_connr);
+      if(tmp16 > 0) {
+        /* The data in flight has been copied, so we tell the
+           application that it has been acknowledged and let it send
+           as much more as fits in the window. */
+        uip_connr->mss = tmp16;
+        uip_flags = UIP_ACKDATA;
+        UIP_APPCALL();
+        goto appsend;
+      }
+      goto drop;
+    }
+#endif /* UIP_TCP_WINDOW */
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
        !uip_outstanding(uip_connr)) {
       uip_flags = UIP_POLL;
@@ -981,6 +1236,9 @@ uip_process(uint8_t flag)
                uip_connr->tcpstateflags == UIP_SYN_RCVD) &&
               uip_connr->nrtx == UIP_MAXSYNRTX)) {
             uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+            uip_tcp_window_flush(uip_connr);
+#endif /* UIP_TCP_WINDOW */
                   
             /*
              * We call UIP_APPCALL() with uip_flags set to
@@ -1023,6 +1281,23 @@ uip_process(uint8_t flag)
 #endif /* UIP_ACTIVE_OPEN */
                      
             case UIP_ESTABLISHED:
+#if UIP_TCP_WINDOW
+              /* Segments in flight are resent from their copies. */
+              if(uip_connr->segments != NULL) {
+                goto tcp_window_rexmit;
+              }
+#endif /* UIP_TCP_WINDOW */
+#if UIP_TCP_STABLE_SEND
+              /*
+               * Data sent with uip_send_stable() is still where it was
+               * sent from, so we can resend it ourselves.
+               */
+              if(uip_connr->rexmit_data != NULL) {
+                uip_slen = uip_connr->len;
+                memcpy(uip_sappdata, uip_connr->rexmit_data, uip_slen);
+                goto apprexmit;
+              }
+#endif /* UIP_TCP_STABLE_SEND */
               /*
                * In the ESTABLISHED state, we call upon the application
                * to do the actual retransmit after which we jump into
@@ -1151,6 +1426,17 @@ uip_process(uint8_t flag)
     }
   }
 
+#if UIP_IPV6_MULTICAST
+  /* Multicast beyond the link is left to the multicast engine, which
+     forwards it if needed and tells whether it is for us too. */
+  if(uip_is_addr_mcast_routable(&UIP_IP_BUF->destipaddr)) {
+    if(UIP_MCAST6.in() == UIP_MCAST6_DROP) {
+      UIP_STAT(++uip_stat.ip.drop);
+      goto drop;
+    }
+    goto process;
+  }
+#endif /* UIP_IPV6_MULTICAST */
 
   /* TBD Some Parameter problem messages */
   if(!uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) &&
@@ -1176,6 +1462,9 @@ uip_process(uint8_t flag)
         goto send;
       }
 
+      /* Neither the hop limit nor the hop-by-hop options are covered
+         by the upper-layer checksum, so a forwarded packet keeps its
+         checksum as it is. */
 #if UIP_CONF_IPV6_RPL
       rpl_update_header_empty();
 #endif /* UIP_CONF_IPV6_RPL */
@@ -1220,6 +1509,9 @@ uip_process(uint8_t flag)
   uip_ext_bitmap = 0;
 #endif /* UIP_CONF_ROUTER */
 
+#if UIP_CONF_ROUTER && UIP_IPV6_MULTICAST
+ process:
+#endif /* UIP_CONF_ROUTER && UIP_IPV6_MULTICAST */
   while(1) {
     switch(*uip_next_hdr){
 #if UIP_TCP
@@ -1308,6 +1600,28 @@ uip_process(uint8_t flag)
          */
 
         PRINTF("Processing Routing header\n");
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+        /* Forward source routed packets to the next address in the
+           header. */
+        switch(rpl_process_srh_header()) {
+          case 1:
+            UIP_STAT(++uip_stat.ip.drop);
+            goto drop;
+          case 2:
+            if(UIP_IP_BUF->ttl <= 1) {
+              uip_icmp6_error_output(ICMP6_TIME_EXCEEDED,
+                                     ICMP6_TIME_EXCEED_TRANSIT, 0);
+              UIP_STAT(++uip_stat.ip.drop);
+              goto send;
+            }
+            UIP_IP_BUF->ttl = UIP_IP_BUF->ttl - 1;
+            UIP_STAT(++uip_stat.ip.forwarded);
+            goto send;
+          case 3:
+            UIP_STAT(++uip_stat.ip.drop);
+            goto send;
+        }
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
         if(UIP_ROUTING_BUF->seg_left > 0) {
           uip_icmp6_error_output(ICMP6_PARAM_PROB, ICMP6_PARAMPROB_HEADER, UIP_IPH_LEN + uip_ext_len + 2);
           UIP_STAT(++uip_stat.ip.drop);
@@ -1492,6 +1806,16 @@ uip_process(uint8_t flag)
   }
 
   /* Demultiplex this UDP packet between the UDP "connections". */
+#if UIP_DEMUX_CACHE
+  demux = uip_demux_bucket(uip_udp_demux,
+                           UIP_UDP_BUF->destport, UIP_UDP_BUF->srcport);
+  if(uip_demux_hit(demux, UIP_UDP_BUF->destport, UIP_UDP_BUF->srcport)) {
+    uip_udp_conn = demux->conn;
+    if(UIP_UDP_CONN_MATCH(uip_udp_conn)) {
+      goto udp_found;
+    }
+  }
+#endif /* UIP_DEMUX_CACHE */
   for(uip_udp_conn = &uip_udp_conns[0];
       uip_udp_conn < &uip_udp_conns[UIP_UDP_CONNS];
       ++uip_udp_conn) {
@@ -1502,12 +1826,11 @@ uip_process(uint8_t flag)
        connection is bound to a remote port. Finally, if the
        connection is bound to a remote IP address, the source IP
        address of the packet is checked. */
-    if(uip_udp_conn->lport != 0 &&
-       UIP_UDP_BUF->destport == uip_udp_conn->lport &&
-       (uip_udp_conn->rport == 0 ||
-        UIP_UDP_BUF->srcport == uip_udp_conn->rport) &&
-       (uip_is_addr_unspecified(&uip_udp_conn->ripaddr) ||
-        uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &uip_udp_conn->ripaddr))) {
+    if(UIP_UDP_CONN_MATCH(uip_udp_conn)) {
+#if UIP_DEMUX_CACHE
+      uip_demux_fill(demux, uip_udp_conn,
+                     UIP_UDP_BUF->destport, UIP_UDP_BUF->srcport);
+#endif /* UIP_DEMUX_CACHE */
       goto udp_found;
     }
   }
@@ -1599,12 +1922,25 @@ uip_process(uint8_t flag)
 
   /* Demultiplex this segment. */
   /* First check any active connections. */
+#if UIP_DEMUX_CACHE
+  /* Active connections have unique ports and addresses, so a cached
+     connection that still matches is the one the scan would find. */
+  demux = uip_demux_bucket(uip_tcp_demux,
+                           UIP_TCP_BUF->destport, UIP_TCP_BUF->srcport);
+  if(uip_demux_hit(demux, UIP_TCP_BUF->destport, UIP_TCP_BUF->srcport)) {
+    uip_connr = demux->conn;
+    if(UIP_TCP_CONN_MATCH(uip_connr)) {
+      goto found;
+    }
+  }
+#endif /* UIP_DEMUX_CACHE */
   for(uip_connr = &uip_conns[0]; uip_connr <= &uip_conns[UIP_CONNS - 1];
       ++uip_connr) {
-    if(uip_connr->tcpstateflags != UIP_CLOSED &&
-       UIP_TCP_BUF->destport == uip_connr->lport &&
-       UIP_TCP_BUF->srcport == uip_connr->rport &&
-       uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &uip_connr->ripaddr)) {
+    if(UIP_TCP_CONN_MATCH(uip_connr)) {
+#if UIP_DEMUX_CACHE
+      uip_demux_fill(demux, uip_connr,
+                     UIP_TCP_BUF->destport, UIP_TCP_BUF->srcport);
+#endif /* UIP_DEMUX_CACHE */
       goto found;
     }
   }
@@ -1724,6 +2060,10 @@ uip_process(uint8_t flag)
   uip_connr->rport = UIP_TCP_BUF->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &UIP_IP_BUF->srcipaddr);
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
+#if UIP_TCP_WINDOW
+  uip_tcp_window_flush(uip_connr);
+  uip_connr->window = UIP_TCP_WINDOW_DEFAULT;
+#endif /* UIP_TCP_WINDOW */
 
   uip_connr->snd_nxt[0] = iss[0];
   uip_connr->snd_nxt[1] = iss[1];
@@ -1804,6 +2144,9 @@ uip_process(uint8_t flag)
      before we accept the reset. */
   if(UIP_TCP_BUF->flags & TCP_RST) {
     uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+    uip_tcp_window_flush(uip_connr);
+#endif /* UIP_TCP_WINDOW */
     UIP_LOG("tcp: got reset, aborting connection.");
     uip_flags = UIP_ABORT;
     UIP_APPCALL();
@@ -1843,6 +2186,45 @@ uip_process(uint8_t flag)
      data. If so, we update the sequence number, reset the length of
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
+#if UIP_TCP_WINDOW
+  if((UIP_TCP_BUF->flags & TCP_ACK) && uip_connr->segments != NULL) {
+    /* With several segments in flight, the ACK may cover any number
+       of them. */
+    if(uip_tcp_window_ack(uip_connr, UIP_TCP_BUF->ackno) > 0) {
+      /* Do RTT estimation, unless we have done retransmissions. */
+      if(uip_connr->nrtx == 0 &&
+         !(uip_connr->wflags & UIP_TCP_WINDOW_RECOVER)) {
+        uip_update_rtt();
+      }
+      uip_flags = UIP_ACKDATA;
+      uip_connr->timer = uip_connr->rto;
+      uip_connr->nrtx = 0;
+      uip_connr->dupacks = 0;
+      if(uip_connr->segments == NULL) {
+        uip_connr->wflags &= ~(UIP_TCP_WINDOW_REXMIT | UIP_TCP_WINDOW_RECOVER);
+      } else if(uip_connr->wflags & UIP_TCP_WINDOW_RECOVER) {
+        /* An ACK that only covers part of the data in flight after a
+           retransmission means that the next segment was lost too. */
+        uip_connr->wflags |= UIP_TCP_WINDOW_REXMIT;
+      }
+    } else if(uip_len == 0 &&
+              (UIP_TCP_BUF->flags & (TCP_SYN | TCP_FIN)) == 0 &&
+              UIP_TCP_BUF->ackno[0] == uip_connr->snd_nxt[0] &&
+              UIP_TCP_BUF->ackno[1] == uip_connr->snd_nxt[1] &&
+              UIP_TCP_BUF->ackno[2] == uip_connr->snd_nxt[2] &&
+              UIP_TCP_BUF->ackno[3] == uip_connr->snd_nxt[3]) {
+      /* A duplicate ACK. Enough of them means that the oldest
+         segment was lost while later ones got through, so we resend
+         it without waiting for the retransmission timer. */
+      if(++uip_connr->dupacks == UIP_TCP_WINDOW_DUPACKS) {
+        uip_connr->wflags |= UIP_TCP_WINDOW_REXMIT;
+      }
+    }
+    if(uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) {
+      uip_tcp_window_poll(uip_connr);
+    }
+  } else
+#endif /* UIP_TCP_WINDOW */
   if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
@@ -1858,18 +2240,7 @@ uip_process(uint8_t flag)
    
       /* Do RTT estimation, unless we have done retransmissions. */
       if(uip_connr->nrtx == 0) {
-        signed char m;
-        m = uip_connr->rto - uip_connr->timer;
-        /* This is taken directly from VJs original code in his paper */
-        m = m - (uip_connr->sa >> 3);
-        uip_connr->sa += m;
-        if(m < 0) {
-          m = -m;
-        }
-        m = m - (uip_connr->sv >> 2);
-        uip_connr->sv += m;
-        uip_connr->rto = (uip_connr->sa >> 3) + uip_connr->sv;
-
+        uip_update_rtt();
       }
       /* Set the acknowledged flag. */
       uip_flags = UIP_ACKDATA;
@@ -1882,6 +2253,14 @@ uip_process(uint8_t flag)
     
   }
 
+#if UIP_TCP_WINDOW
+  /* Remember how much data the peer has room for. */
+  if(UIP_TCP_BUF->flags & TCP_ACK) {
+    uip_connr->snd_wnd = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) +
+      (uint16_t)UIP_TCP_BUF->wnd[1];
+  }
+#endif /* UIP_TCP_WINDOW */
+
   /* Do different things depending on in what state the connection is. */
   switch(uip_connr->tcpstateflags & UIP_TS_MASK) {
     /* CLOSED and LISTEN are not handled here. CLOSE_WAIT is not
@@ -2052,6 +2431,44 @@ uip_process(uint8_t flag)
       }
       uip_connr->mss = tmp16;
 
+#if UIP_TCP_WINDOW
+      if(uip_connr->wflags & UIP_TCP_WINDOW_CLOSE) {
+        /* The application has closed the connection while it had data
+           in flight. We send the FIN when all of it is acknowledged,
+           and drop any data that arrives in the meantime. */
+        if(!uip_outstanding(uip_connr)) {
+          goto tcp_window_close;
+        }
+        if(uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) {
+          UIP_STAT(++uip_stat.tcp.rexmit);
+          goto tcp_window_rexmit;
+        }
+        if(uip_flags & UIP_NEWDATA) {
+          goto tcp_send_ack;
+        }
+        goto drop;
+      }
+      if((uip_connr->wflags & UIP_TCP_WINDOW_REXMIT) &&
+         !(uip_flags & UIP_NEWDATA)) {
+        /* Nothing to pass to the application, so we can use this
+           chance to retransmit. */
+        UIP_STAT(++uip_stat.tcp.rexmit);
+        goto tcp_window_rexmit;
+      }
+      if(uip_connr->segments != NULL) {
+        /* Everything the application has sent is either acknowledged
+           or copied, but it may only send more if it fits in the
+           window, so uip_mss() is cut down to the room left. */
+        tmp16 = uip_tcp_window_room(uip_connr);
+        if(tmp16 > 0) {
+          uip_connr->mss = tmp16;
+          uip_flags |= UIP_ACKDATA;
+        } else {
+          uip_flags &= ~UIP_ACKDATA;
+        }
+      }
+#endif /* UIP_TCP_WINDOW */
+
       /* If this packet constitutes an ACK for outstanding data (flagged
          by the UIP_ACKDATA flag, we should call the application since it
          might want to send more data. If the incoming packet had data
@@ -2077,11 +2494,24 @@ uip_process(uint8_t flag)
         if(uip_flags & UIP_ABORT) {
           uip_slen = 0;
           uip_connr->tcpstateflags = UIP_CLOSED;
+#if UIP_TCP_WINDOW
+          uip_tcp_window_flush(uip_connr);
+#endif /* UIP_TCP_WINDOW */
           UIP_TCP_BUF->flags = TCP_RST | TCP_ACK;
           goto tcp_send_nodata;
         }
 
         if(uip_flags & UIP_CLOSE) {
+#if UIP_TCP_WINDOW
+          if(uip_connr->segments != NULL) {
+            /* Data which the application believes to be acknowledged
+               is still in flight, so the FIN has to wait. */
+            uip_connr->wflags |= UIP_TCP_WINDOW_CLOSE;
+            goto drop;
+          }
+        tcp_window_close:
+          uip_connr->wflags = 0;
+#endif /* UIP_TCP_WINDOW */
           uip_slen = 0;
           uip_connr->len = 1;
           uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
@@ -2093,6 +2523,24 @@ uip_process(uint8_t flag)
         /* If uip_slen > 0, the application has data to be sent. */
         if(uip_slen > 0) {
 
+#if UIP_TCP_WINDOW
+          /* If the connection has a window with room in it, the data
+             is copied and sent after the data already in flight. */
+          if(uip_connr->segments != NULL || uip_connr->len == 0) {
+            tmp16 = uip_tcp_window_room(uip_connr);
+            if(uip_slen <= tmp16 &&
+               uip_tcp_window_push(uip_connr, uip_sappdata, uip_slen)) {
+              goto tcp_window_send;
+            }
+            if(uip_connr->segments != NULL) {
+              /* uip_mss() never exceeds the room in the window, so the
+                 application should not have sent this. */
+              uip_slen = 0;
+              goto apprexmit;
+            }
+          }
+#endif /* UIP_TCP_WINDOW */
+
           /* If the connection has acknowledged data, the contents of
              the ->len variable should be discarded. */
           if((uip_flags & UIP_ACKDATA) != 0) {
@@ -2114,6 +2562,9 @@ uip_process(uint8_t flag)
             /* Remember how much data we send out now so that we know
                when everything has been acknowledged. */
             uip_connr->len = uip_slen;
+#if UIP_TCP_STABLE_SEND
+            uip_connr->rexmit_data = uip_srexmit;
+#endif /* UIP_TCP_STABLE_SEND */
           } else {
 
             /* If the application already had unacknowledged data, we
@@ -2145,6 +2596,36 @@ uip_process(uint8_t flag)
         }
       }
       goto drop;
+
+#if UIP_TCP_WINDOW
+    tcp_window_send:
+      /* The new segment follows all data that already is in flight. */
+      uip_add32(uip_connr->snd_nxt, uip_connr->len);
+      UIP_TCP_BUF->seqno[0] = uip_acc32[0];
+      UIP_TCP_BUF->seqno[1] = uip_acc32[1];
+      UIP_TCP_BUF->seqno[2] = uip_acc32[2];
+      UIP_TCP_BUF->seqno[3] = uip_acc32[3];
+      uip_connr->len += uip_slen;
+      if(uip_tcp_window_room(uip_connr) > 0) {
+        /* Let the application fill the rest of the window. */
+        uip_tcp_window_poll(uip_connr);
+      }
+      uip_appdata = uip_sappdata;
+      uip_len = uip_slen + UIP_TCPIP_HLEN;
+      UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+      UIP_TCP_BUF->tcpoffset = (UIP_TCPH_LEN / 4) << 4;
+      goto tcp_send_seqno;
+
+    tcp_window_rexmit:
+      /* Resend the oldest segment in flight from its copy. */
+      uip_connr->wflags &= ~UIP_TCP_WINDOW_REXMIT;
+      uip_connr->wflags |= UIP_TCP_WINDOW_RECOVER;
+      uip_appdata = uip_sappdata;
+      uip_slen = uip_tcp_window_copy(uip_connr, uip_sappdata);
+      uip_len = uip_slen + UIP_TCPIP_HLEN;
+      UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+      goto tcp_send_noopts;
+#endif /* UIP_TCP_WINDOW */
     case UIP_LAST_ACK:
       /* We can close this connection if the peer has acknowledged our
          FIN. This is indicated by the UIP_ACKDATA flag. */
@@ -2230,16 +2711,19 @@ uip_process(uint8_t flag)
  tcp_send:
   PRINTF("In tcp_send\n");
    
-  UIP_TCP_BUF->ackno[0] = uip_connr->rcv_nxt[0];
-  UIP_TCP_BUF->ackno[1] = uip_connr->rcv_nxt[1];
-  UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
-  UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
-  
   UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
   UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
   UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
   UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
 
+#if UIP_TCP_WINDOW
+ tcp_send_seqno:
+#endif /* UIP_TCP_WINDOW */
+  UIP_TCP_BUF->ackno[0] = uip_connr->rcv_nxt[0];
+  UIP_TCP_BUF->ackno[1] = uip_connr->rcv_nxt[1];
+  UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
+  UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
+
   UIP_IP_BUF->proto = UIP_PROTO_TCP;
 
   UIP_TCP_BUF->srcport  = uip_connr->lport;
@@ -2323,7 +2807,21 @@ uip_send(const void *data, int len)
       memcpy(uip_sappdata, (data), uip_slen);
     }
   }
+#if UIP_TCP_STABLE_SEND
+  uip_srexmit = NULL;
+#endif /* UIP_TCP_STABLE_SEND */
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP_STABLE_SEND
+void
+uip_send_stable(const void *data, int len)
+{
+  uip_send(data, len);
+  if(data != uip_sappdata) {
+    uip_srexmit = data;
+  }
 }
+#endif /* UIP_TCP_STABLE_SEND */
 /*---------------------------------------------------------------------------*/
 /** @} */
 #endif /* UIP_CONF_IPV6 */
@@ -103,6 +103,26 @@ void uip_add32(uint8_t *op32, uint16_t op16);
  */
 uint16_t uip_chksum(uint16_t *buf, uint16_t len);
 
+/**
+ * Add data to a partial Internet checksum.
+ *
+ * All checksums in uIP are computed with this function. uIP has a
+ * portable implementation, but an architecture that sets
+ * UIP_ARCH_SUM to 1 provides its own, usually one that reads whole
+ * machine words at a time.
+ *
+ * \param sum The one's complement sum so far, in host byte order.
+ *
+ * \param data A pointer to the data, which need not be aligned.
+ *
+ * \param len The length of the data. If it is odd, the last byte is
+ * added as if it was followed by a zero byte.
+ *
+ * \return The one's complement sum of sum and the 16-bit big-endian
+ * words in the data, in host byte order.
+ */
+uint16_t uip_arch_sum(uint16_t sum, const uint8_t *data, uint16_t len);
+
 /**
  * Calculate the IP header checksum of the packet header in uip_buf.
  *
@@ -98,6 +98,10 @@ struct arp_entry {
   uip_ipaddr_t ipaddr;
   struct uip_eth_addr ethaddr;
   uint8_t time;
+#if UIP_ARP_HASH_SIZE
+  uint8_t next;                 /* Next entry in the same hash bucket. */
+  uint8_t lru_prev, lru_next;   /* Neighbours in the recency list. */
+#endif /* UIP_ARP_HASH_SIZE */
 };
 
 static const struct uip_eth_addr broadcast_ethaddr =
@@ -106,10 +110,31 @@ static const uint16_t broadcast_ipaddr[2] = {0xffff,0xffff};
 
 static struct arp_entry arp_table[UIP_ARPTAB_SIZE];
 static uip_ipaddr_t ipaddr;
-static uint8_t i, c;
+static uint8_t i;
 
 static uint8_t arptime;
+#if !UIP_ARP_HASH_SIZE
+static uint8_t c;
 static uint8_t tmpage;
+#endif /* !UIP_ARP_HASH_SIZE */
+
+#if UIP_ARP_HASH_SIZE
+/*
+ * With a hashed ARP table, entries are found through hash chains, and
+ * all entries are kept in a recency list: the most recently used entry
+ * is at the head, free entries and the least recently used entry at
+ * the tail, which is where new mappings are stored.
+ */
+#if UIP_ARPTAB_SIZE >= 255
+#error "UIP_ARPTAB_SIZE must be below 255 with UIP_CONF_ARP_HASH_SIZE"
+#endif
+#define ARP_NONE 0xff
+#define ARP_HASH(addr) (((addr)->u8[3] ^ ((addr)->u8[2] << 2) ^ \
+                         (addr)->u8[1]) & (UIP_ARP_HASH_SIZE - 1))
+
+static uint8_t arp_hash[UIP_ARP_HASH_SIZE];
+static uint8_t lru_head, lru_tail;
+#endif /* UIP_ARP_HASH_SIZE */
 
 #define BUF   ((struct arp_hdr *)&uip_buf[0])
 #define IPBUF ((struct ethip_hdr *)&uip_buf[0])
@@ -122,6 +147,110 @@ static uint8_t tmpage;
 #define PRINTF(...)
 #endif
 
+#if UIP_ARP_HASH_SIZE
+/*-----------------------------------------------------------------------------------*/
+static void
+lru_unlink(uint8_t n)
+{
+  struct arp_entry *e = &arp_table[n];
+
+  if(e->lru_prev == ARP_NONE) {
+    lru_head = e->lru_next;
+  } else {
+    arp_table[e->lru_prev].lru_next = e->lru_next;
+  }
+  if(e->lru_next == ARP_NONE) {
+    lru_tail = e->lru_prev;
+  } else {
+    arp_table[e->lru_next].lru_prev = e->lru_prev;
+  }
+}
+/*-----------------------------------------------------------------------------------*/
+static void
+lru_insert(uint8_t n, uint8_t at_head)
+{
+  struct arp_entry *e = &arp_table[n];
+
+  if(at_head) {
+    e->lru_prev = ARP_NONE;
+    e->lru_next = lru_head;
+    if(lru_head != ARP_NONE) {
+      arp_table[lru_head].lru_prev = n;
+    }
+    lru_head = n;
+    if(lru_tail == ARP_NONE) {
+      lru_tail = n;
+    }
+  } else {
+    e->lru_next = ARP_NONE;
+    e->lru_prev = lru_tail;
+    if(lru_tail != ARP_NONE) {
+      arp_table[lru_tail].lru_next = n;
+    }
+    lru_tail = n;
+    if(lru_head == ARP_NONE) {
+      lru_head = n;
+    }
+  }
+}
+/*-----------------------------------------------------------------------------------*/
+static void
+arp_touch(uint8_t n)
+{
+  if(lru_head != n) {
+    lru_unlink(n);
+    lru_insert(n, 1);
+  }
+}
+/*-----------------------------------------------------------------------------------*/
+static void
+hash_unlink(uint8_t n)
+{
+  uint8_t *p;
+
+  for(p = &arp_hash[ARP_HASH(&arp_table[n].ipaddr)];
+      *p != ARP_NONE; p = &arp_table[*p].next) {
+    if(*p == n) {
+      *p = arp_table[n].next;
+      return;
+    }
+  }
+}
+/*-----------------------------------------------------------------------------------*/
+static void
+arp_free(uint8_t n)
+{
+  hash_unlink(n);
+  memset(&arp_table[n].ipaddr, 0, 4);
+  lru_unlink(n);
+  lru_insert(n, 0);
+}
+#endif /* UIP_ARP_HASH_SIZE */
+/*-----------------------------------------------------------------------------------*/
+/* Returns the index of the table entry for addr, or UIP_ARPTAB_SIZE. */
+static uint8_t
+arp_find(const uip_ipaddr_t *addr)
+{
+#if UIP_ARP_HASH_SIZE
+  uint8_t n;
+
+  for(n = arp_hash[ARP_HASH(addr)]; n != ARP_NONE; n = arp_table[n].next) {
+    if(uip_ipaddr_cmp(addr, &arp_table[n].ipaddr)) {
+      return n;
+    }
+  }
+  return UIP_ARPTAB_SIZE;
+#else /* UIP_ARP_HASH_SIZE */
+  uint8_t n;
+
+  for(n = 0; n < UIP_ARPTAB_SIZE; ++n) {
+    if(uip_ipaddr_cmp(addr, &arp_table[n].ipaddr)) {
+      break;
+    }
+  }
+  return n;
+#endif /* UIP_ARP_HASH_SIZE */
+}
 /*-----------------------------------------------------------------------------------*/
 /**
  * Initialize the ARP module.
@@ -134,6 +263,13 @@ uip_arp_init(void)
   for(i = 0; i < UIP_ARPTAB_SIZE; ++i) {
     memset(&arp_table[i].ipaddr, 0, 4);
   }
+#if UIP_ARP_HASH_SIZE
+  memset(arp_hash, ARP_NONE, sizeof(arp_hash));
+  lru_head = lru_tail = ARP_NONE;
+  for(i = 0; i < UIP_ARPTAB_SIZE; ++i) {
+    lru_insert(i, 0);
+  }
+#endif /* UIP_ARP_HASH_SIZE */
 }
 /*-----------------------------------------------------------------------------------*/
 /**
@@ -153,9 +289,13 @@ uip_arp_timer(void)
   ++arptime;
   for(i = 0; i < UIP_ARPTAB_SIZE; ++i) {
     tabptr = &arp_table[i];
-    if(uip_ipaddr_cmp(&tabptr->ipaddr, &uip_all_zeroes_addr) &&
+    if(!uip_ipaddr_cmp(&tabptr->ipaddr, &uip_all_zeroes_addr) &&
        arptime - tabptr->time >= UIP_ARP_MAXAGE) {
+#if UIP_ARP_HASH_SIZE
+      arp_free(i);
+#else /* UIP_ARP_HASH_SIZE */
       memset(&tabptr->ipaddr, 0, 4);
+#endif /* UIP_ARP_HASH_SIZE */
     }
   }
 
@@ -167,32 +307,42 @@ uip_arp_update(uip_ipaddr_t *ipaddr, struct uip_eth_addr *ethaddr)
 {
   register struct arp_entry *tabptr = arp_table;
 
-  /* Walk through the ARP mapping table and try to find an entry to
-     update. If none is found, the IP -> MAC address mapping is
-     inserted in the ARP table. */
-  for(i = 0; i < UIP_ARPTAB_SIZE; ++i) {
-    tabptr = &arp_table[i];
-
-    /* Only check those entries that are actually in use. */
-    if(!uip_ipaddr_cmp(&tabptr->ipaddr, &uip_all_zeroes_addr)) {
+  /* Try to find an entry to update. If none is found, the IP -> MAC
+     address mapping is inserted in the ARP table. */
+  if(!uip_ipaddr_cmp(ipaddr, &uip_all_zeroes_addr)) {
+    i = arp_find(ipaddr);
+    if(i < UIP_ARPTAB_SIZE) {
+      tabptr = &arp_table[i];
 
-      /* Check if the source IP address of the incoming packet matches
-         the IP address in this ARP table entry. */
-      if(uip_ipaddr_cmp(ipaddr, &tabptr->ipaddr)) {
-	 
-	/* An old entry found, update this and return. */
-	memcpy(tabptr->ethaddr.addr, ethaddr->addr, 6);
-	tabptr->time = arptime;
+      /* An old entry found, update this and return. */
+      memcpy(tabptr->ethaddr.addr, ethaddr->addr, 6);
+      tabptr->time = arptime;
+#if UIP_ARP_HASH_SIZE
+      arp_touch(i);
+#endif /* UIP_ARP_HASH_SIZE */
 
-	return;
-      }
+      return;
     }
-	tabptr++;
   }
 
   /* If we get here, no existing ARP table entry was found, so we
      create one. */
 
+#if UIP_ARP_HASH_SIZE
+  /* The tail of the recency list is either unused or the least
+     recently used entry, which we throw away. */
+  i = lru_tail;
+  tabptr = &arp_table[i];
+  if(!uip_ipaddr_cmp(&tabptr->ipaddr, &uip_all_zeroes_addr)) {
+    hash_unlink(i);
+  }
+  uip_ipaddr_copy(&tabptr->ipaddr, ipaddr);
+  memcpy(tabptr->ethaddr.addr, ethaddr->addr, 6);
+  tabptr->time = arptime;
+  tabptr->next = arp_hash[ARP_HASH(ipaddr)];
+  arp_hash[ARP_HASH(ipaddr)] = i;
+  arp_touch(i);
+#else /* UIP_ARP_HASH_SIZE */
   /* First, we try to find an unused entry in the ARP table. */
   for(i = 0; i < UIP_ARPTAB_SIZE; ++i) {
     tabptr = &arp_table[i];
@@ -222,6 +372,7 @@ uip_arp_update(uip_ipaddr_t *ipaddr, struct uip_eth_addr *ethaddr)
   uip_ipaddr_copy(&tabptr->ipaddr, ipaddr);
   memcpy(tabptr->ethaddr.addr, ethaddr->addr, 6);
   tabptr->time = arptime;
+#endif /* UIP_ARP_HASH_SIZE */
 }
 /*-----------------------------------------------------------------------------------*/
 /**
@@ -364,7 +515,6 @@ uip_arp_arpin(void)
 void
 uip_arp_out(void)
 {
-  struct arp_entry *tabptr = arp_table;
   
   /* Find the destination IP address in the ARP table and construct
      the Ethernet header. If the destination IP addres isn't on the
@@ -395,12 +545,7 @@ uip_arp_out(void)
       /* Else, we use the destination IP address. */
       uip_ipaddr_copy(&ipaddr, &IPBUF->destipaddr);
     }
-    for(i = 0; i < UIP_ARPTAB_SIZE; ++i) {
-      if(uip_ipaddr_cmp(&ipaddr, &tabptr->ipaddr)) {
-	break;
-      }
-	  tabptr++;
-    }
+    i = arp_find(&ipaddr);
 
     if(i == UIP_ARPTAB_SIZE) {
       /* The destination address was not in our ARP table, so we
@@ -426,8 +571,12 @@ uip_arp_out(void)
       return;
     }
 
+#if UIP_ARP_HASH_SIZE
+    arp_touch(i);
+#endif /* UIP_ARP_HASH_SIZE */
+
     /* Build an ethernet header. */
-    memcpy(IPBUF->ethhdr.dest.addr, tabptr->ethaddr.addr, 6);
+    memcpy(IPBUF->ethhdr.dest.addr, arp_table[i].ethaddr.addr, 6);
   }
   memcpy(IPBUF->ethhdr.src.addr, uip_lladdr.addr, 6);
   
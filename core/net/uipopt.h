@@ -203,6 +203,28 @@
 #define UIP_CONF_IPV6_REASSEMBLY      0
 #endif
 
+/**
+ * How many fragmented IPv6 packets can be reassembled at the same
+ * time. Each reassembly context holds a buffer of UIP_BUFSIZE bytes.
+ */
+#ifdef UIP_CONF_REASS_CONTEXTS
+#define UIP_REASS_CONTEXTS UIP_CONF_REASS_CONTEXTS
+#else
+#define UIP_REASS_CONTEXTS 1
+#endif
+
+/**
+ * Number of entries (a power of two) of the caches that map the ports
+ * and source address of incoming TCP segments and UDP datagrams to
+ * their connections, saving the scan of all connections for each
+ * packet. Useful with many connections (default: 0, no cache)
+ */
+#ifdef UIP_CONF_DEMUX_CACHE
+#define UIP_DEMUX_CACHE UIP_CONF_DEMUX_CACHE
+#else
+#define UIP_DEMUX_CACHE 0
+#endif
+
 #ifndef UIP_CONF_NETIF_MAX_ADDRESSES
 /** Default number of IPv6 addresses associated to the node's interface */
 #define UIP_CONF_NETIF_MAX_ADDRESSES  3
@@ -307,6 +329,56 @@
 #define UIP_ACTIVE_OPEN (UIP_CONF_ACTIVE_OPEN)
 #endif /* UIP_CONF_ACTIVE_OPEN */
 
+/**
+ * Determines if uIP retransmits data sent with uip_send_stable() by
+ * itself.
+ *
+ * The data is then copied from where the application keeps it
+ * instead of the application being invoked with the uip_rexmit()
+ * event. This costs one pointer in each TCP connection.
+ *
+ * \hideinitializer
+ */
+#ifndef UIP_CONF_TCP_STABLE_SEND
+#define UIP_TCP_STABLE_SEND 1
+#else /* UIP_CONF_TCP_STABLE_SEND */
+#define UIP_TCP_STABLE_SEND (UIP_CONF_TCP_STABLE_SEND)
+#endif /* UIP_CONF_TCP_STABLE_SEND */
+
+/**
+ * The number of segment buffers that TCP connections share for
+ * keeping more than one segment in flight.
+ *
+ * Each buffer takes UIP_TCP_MSS bytes plus a few bytes of overhead,
+ * and each TCP connection grows by a pointer and a few bytes. If set
+ * to zero, each connection only has a single segment in flight, as
+ * in the original uIP.
+ *
+ * \sa uip_set_window()
+ *
+ * \hideinitializer
+ */
+#ifndef UIP_CONF_TCP_WINDOW
+#define UIP_TCP_WINDOW 0
+#else /* UIP_CONF_TCP_WINDOW */
+#define UIP_TCP_WINDOW (UIP_CONF_TCP_WINDOW)
+#endif /* UIP_CONF_TCP_WINDOW */
+
+/**
+ * The number of segments that a new TCP connection may have in
+ * flight, until changed with uip_set_window().
+ *
+ * Zero or one means that the connection keeps the single segment
+ * behaviour of uIP.
+ *
+ * \hideinitializer
+ */
+#ifndef UIP_CONF_TCP_WINDOW_DEFAULT
+#define UIP_TCP_WINDOW_DEFAULT 0
+#else /* UIP_CONF_TCP_WINDOW_DEFAULT */
+#define UIP_TCP_WINDOW_DEFAULT (UIP_CONF_TCP_WINDOW_DEFAULT)
+#endif /* UIP_CONF_TCP_WINDOW_DEFAULT */
+
 /**
  * The maximum number of simultaneously open TCP connections.
  *
@@ -438,6 +510,21 @@
  */
 #define UIP_ARP_MAXAGE 120
 
+/**
+ * The number of buckets (a power of two) of the ARP table hash.
+ *
+ * When non-zero, ARP table lookups go through a hash instead of
+ * scanning the table, and the least recently used entry is replaced
+ * when the table is full. Useful with a large UIP_ARPTAB_SIZE.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_ARP_HASH_SIZE
+#define UIP_ARP_HASH_SIZE (UIP_CONF_ARP_HASH_SIZE)
+#else
+#define UIP_ARP_HASH_SIZE 0
+#endif
+
 
 /** @} */
 
@@ -489,6 +576,41 @@
 #define SICSLOWPAN_CONF_FRAG  0
 #endif
 
+/**
+ * How many fragmented packets can be reassembled at the same
+ * time. Each reassembly context holds a buffer of UIP_BUFSIZE bytes.
+ */
+#ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
+#define SICSLOWPAN_REASS_CONTEXTS SICSLOWPAN_CONF_REASS_CONTEXTS
+#else
+#define SICSLOWPAN_REASS_CONTEXTS 1
+#endif
+
+/**
+ * Do we keep statistics on 6lowpan reassembly (default: no)
+ */
+#ifndef SICSLOWPAN_CONF_REASS_STATS
+#define SICSLOWPAN_CONF_REASS_STATS 0
+#endif
+
+/**
+ * Do we relay the fragments of packets that are not for us as they
+ * arrive, instead of reassembling the packets first (default: no).
+ * Only used if SICSLOWPAN_CONF_FRAG is set.
+ */
+#ifndef SICSLOWPAN_CONF_FRAG_FORWARD
+#define SICSLOWPAN_CONF_FRAG_FORWARD 0
+#endif
+
+/**
+ * How many fragmented packets can be relayed at the same time.
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARD_ENTRIES
+#define SICSLOWPAN_FRAG_FORWARD_ENTRIES SICSLOWPAN_CONF_FRAG_FORWARD_ENTRIES
+#else
+#define SICSLOWPAN_FRAG_FORWARD_ENTRIES 2
+#endif
+
 /** @} */
 
 /*------------------------------------------------------------------------------*/
@@ -513,6 +635,21 @@
 #define UIP_BUFSIZE (UIP_CONF_BUFFER_SIZE)
 #endif /* UIP_CONF_BUFFER_SIZE */
 
+/**
+ * The number of bytes reserved in front of the uIP packet buffer.
+ *
+ * Lower layers may use the headroom to prepend their headers to an
+ * outgoing packet where it is in uip_buf, instead of copying the
+ * packet to a buffer of their own. Zero by default.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_BUFFER_HEADROOM
+#define UIP_BUFFER_HEADROOM (UIP_CONF_BUFFER_HEADROOM)
+#else /* UIP_CONF_BUFFER_HEADROOM */
+#define UIP_BUFFER_HEADROOM 0
+#endif /* UIP_CONF_BUFFER_HEADROOM */
+
 
 /**
  * Determines if statistics support should be compiled in.
@@ -131,6 +131,19 @@ void clock_wait(clock_time_t t);
  */
 void clock_delay_usec(uint16_t dt);
 
+#if CLOCK_CONF_TICKLESS
+/**
+ * Program the clock hardware to wake the system up when the next
+ * etimer expires.
+ *
+ * Only provided by platforms with a tickless clock
+ * (CLOCK_CONF_TICKLESS). The idle loop calls it with interrupts
+ * disabled before putting the CPU to sleep. If an etimer has already
+ * expired, the etimer process is polled instead.
+ */
+void clock_update_wakeup(void);
+#endif /* CLOCK_CONF_TICKLESS */
+
 /**
  * Deprecated platform-specific routines.
  *
@@ -47,7 +47,10 @@
 #include "sys/compower.h"
 #include "net/packetbuf.h"
 
+#include <stddef.h>
+
 struct compower_activity compower_idle_activity;
+static compower_neighbor_callback_t neighbor_callback;
 
 /*---------------------------------------------------------------------------*/
 void
@@ -86,6 +89,25 @@ compower_attrconv(struct compower_activity *e)
                      packetbuf_attr(PACKETBUF_ATTR_LISTEN_TIME) + e->listen);
   packetbuf_set_attr(PACKETBUF_ATTR_TRANSMIT_TIME,
                      packetbuf_attr(PACKETBUF_ATTR_TRANSMIT_TIME) + e->transmit);
+
+  if(neighbor_callback != NULL) {
+    /* The neighbor is the receiver of packets that we send and the
+       sender of packets that we receive. */
+    if(rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                    &rimeaddr_node_addr)) {
+      neighbor_callback(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                        e->transmit, e->listen);
+    } else {
+      neighbor_callback(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                        e->transmit, e->listen);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+compower_set_neighbor_callback(compower_neighbor_callback_t f)
+{
+  neighbor_callback = f;
 }
 /*---------------------------------------------------------------------------*/
 void
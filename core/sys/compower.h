@@ -54,6 +54,8 @@
 #ifndef __COMPOWER_H__
 #define __COMPOWER_H__
 
+#include "net/rime/rimeaddr.h"
+
 /**
  * \brief      An activity record that contains power consumption information for a specific communication activity.
  *
@@ -76,6 +78,25 @@ struct compower_activity {
  */
 extern struct compower_activity compower_idle_activity;
 
+/**
+ * \brief      A function that is told about the radio time spent on
+ *             each packet and the neighbor it was sent to or received
+ *             from.
+ */
+typedef void (* compower_neighbor_callback_t)(const rimeaddr_t *neighbor,
+                                              uint32_t transmit,
+                                              uint32_t listen);
+
+/**
+ * \brief      Set the neighbor attribution callback
+ * \param f    The callback, or NULL
+ *
+ *             The callback is called from compower_attrconv(), which
+ *             the RDC layer calls for every packet it sends or
+ *             receives.
+ */
+void compower_set_neighbor_callback(compower_neighbor_callback_t f);
+
 /**
  * \brief      Initialize the communication power accounting module.
  *
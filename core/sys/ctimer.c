@@ -44,9 +44,12 @@
 
 #include "sys/ctimer.h"
 #include "contiki.h"
-#include "lib/list.h"
+#include "lib/dlist.h"
+#include <stddef.h>
 
-LIST(ctimer_list);
+/* The pending ctimers. A doubly linked list, so that an expired
+   ctimer can be found from its etimer and removed without a search. */
+DLIST(ctimer_list);
 
 static char initialized;
 
@@ -58,6 +61,35 @@ static char initialized;
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+/*
+ * The ctimer API does not require a struct ctimer to be initialized
+ * before ctimer_set(), so its links may hold garbage and the constant
+ * time dlist_contains() can not be trusted. Look the ctimer up on the
+ * list instead, as list_add() did before.
+ */
+static int
+is_listed(struct ctimer *c)
+{
+  struct ctimer *l;
+
+  for(l = dlist_head(ctimer_list); l != NULL; l = l->next) {
+    if(l == c) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_ctimer(struct ctimer *c)
+{
+  if(!is_listed(c)) {
+    c->next = NULL;
+    c->prev = NULL;
+  }
+  dlist_add(ctimer_list, c);
+}
 /*---------------------------------------------------------------------------*/
 PROCESS(ctimer_process, "Ctimer process");
 PROCESS_THREAD(ctimer_process, ev, data)
@@ -65,23 +97,24 @@ PROCESS_THREAD(ctimer_process, ev, data)
   struct ctimer *c;
   PROCESS_BEGIN();
 
-  for(c = list_head(ctimer_list); c != NULL; c = c->next) {
+  for(c = dlist_head(ctimer_list); c != NULL; c = c->next) {
     etimer_set(&c->etimer, c->etimer.timer.interval);
   }
   initialized = 1;
 
   while(1) {
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_TIMER);
-    for(c = list_head(ctimer_list); c != NULL; c = c->next) {
-      if(&c->etimer == data) {
-	list_remove(ctimer_list, c);
-	PROCESS_CONTEXT_BEGIN(c->p);
-	if(c->f != NULL) {
-	  c->f(c->ptr);
-	}
-	PROCESS_CONTEXT_END(c->p);
-	break;
+    /* Only the etimers of ctimers are set from this process, so the
+       event data points into a struct ctimer. */
+    c = (struct ctimer *)((char *)data - offsetof(struct ctimer, etimer));
+    /* The ctimer went through add_ctimer(), so its links are valid */
+    if(dlist_contains(ctimer_list, c)) {
+      dlist_remove(ctimer_list, c);
+      PROCESS_CONTEXT_BEGIN(c->p);
+      if(c->f != NULL) {
+	c->f(c->ptr);
       }
+      PROCESS_CONTEXT_END(c->p);
     }
   }
   PROCESS_END();
@@ -91,7 +124,7 @@ void
 ctimer_init(void)
 {
   initialized = 0;
-  list_init(ctimer_list);
+  dlist_init(ctimer_list);
   process_start(&ctimer_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
@@ -111,8 +144,7 @@ ctimer_set(struct ctimer *c, clock_time_t t,
     c->etimer.timer.interval = t;
   }
 
-  list_remove(ctimer_list, c);
-  list_add(ctimer_list, c);
+  add_ctimer(c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -124,8 +156,7 @@ ctimer_reset(struct ctimer *c)
     PROCESS_CONTEXT_END(&ctimer_process);
   }
 
-  list_remove(ctimer_list, c);
-  list_add(ctimer_list, c);
+  add_ctimer(c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -137,8 +168,7 @@ ctimer_restart(struct ctimer *c)
     PROCESS_CONTEXT_END(&ctimer_process);
   }
 
-  list_remove(ctimer_list, c);
-  list_add(ctimer_list, c);
+  add_ctimer(c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -150,22 +180,18 @@ ctimer_stop(struct ctimer *c)
     c->etimer.next = NULL;
     c->etimer.p = PROCESS_NONE;
   }
-  list_remove(ctimer_list, c);
+  if(is_listed(c)) {
+    dlist_remove(ctimer_list, c);
+  }
 }
 /*---------------------------------------------------------------------------*/
 int
 ctimer_expired(struct ctimer *c)
 {
-  struct ctimer *t;
   if(initialized) {
     return etimer_expired(&c->etimer);
   }
-  for(t = list_head(ctimer_list); t != NULL; t = t->next) {
-    if(t == c) {
-      return 0;
-    }
-  }
-  return 1;
+  return !is_listed(c);
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
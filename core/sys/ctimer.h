@@ -58,6 +58,7 @@
 
 struct ctimer {
   struct ctimer *next;
+  struct ctimer *prev;
   struct etimer etimer;
   struct process *p;
   void (*f)(void *);
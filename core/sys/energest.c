@@ -68,6 +68,12 @@ energest_init(void)
 /*---------------------------------------------------------------------------*/
 unsigned long
 energest_type_time(int type)
+{
+  return energest_type_total(type);
+}
+/*---------------------------------------------------------------------------*/
+energest_time_t
+energest_type_total(int type)
 {
   /* Note: does not support ENERGEST_CONF_LEVELDEVICE_LEVELS! */
 #ifndef ENERGEST_CONF_LEVELDEVICE_LEVELS
@@ -117,5 +123,6 @@ energest_flush(void)
 void energest_type_set(int type, unsigned long val) {}
 void energest_init(void) {}
 unsigned long energest_type_time(int type) { return 0; }
+energest_time_t energest_type_total(int type) { return 0; }
 void energest_flush(void) {}
 #endif /* ENERGEST_CONF_ON */
@@ -42,9 +42,18 @@
 
 #include "sys/rtimer.h"
 
+/* The type of the accumulated times. Set ENERGEST_CONF_TIME_T to
+   uint64_t to make the totals practically never overflow; a 32-bit
+   total of 32768 Hz rtimer ticks wraps after 36 hours. */
+#ifdef ENERGEST_CONF_TIME_T
+typedef ENERGEST_CONF_TIME_T energest_time_t;
+#else /* ENERGEST_CONF_TIME_T */
+typedef unsigned long energest_time_t;
+#endif /* ENERGEST_CONF_TIME_T */
+
 typedef struct {
   /*  unsigned long cumulative[2];*/
-  unsigned long current;
+  energest_time_t current;
 } energest_t;
 
 enum energest_type {
@@ -64,11 +73,29 @@ enum energest_type {
 
   ENERGEST_TYPE_SERIAL,
 
+#if ENERGEST_CONF_EXTENDED
+  /* Breakdown of the radio on-time by the RDC layer. These overlap
+     with LISTEN and TRANSMIT: CCA is spent on channel checks, RX
+     listening to a detected packet, and STROBE on sending a packet
+     train until it is acknowledged. Idle listening is what remains
+     of LISTEN. */
+  ENERGEST_TYPE_CCA,
+  ENERGEST_TYPE_RX,
+  ENERGEST_TYPE_STROBE,
+#endif /* ENERGEST_CONF_EXTENDED */
+
+#ifdef ENERGEST_CONF_PLATFORM_ADDITIONS
+  /* Platform-specific types, e.g. a breakdown of LPM by sleep mode */
+  ENERGEST_CONF_PLATFORM_ADDITIONS
+#endif /* ENERGEST_CONF_PLATFORM_ADDITIONS */
+
   ENERGEST_TYPE_MAX
 };
 
 void energest_init(void);
 unsigned long energest_type_time(int type);
+/* As energest_type_time(), but with the full width of energest_time_t. */
+energest_time_t energest_type_total(int type);
 #ifdef ENERGEST_CONF_LEVELDEVICE_LEVELS
 unsigned long energest_leveldevice_leveltime(int powerlevel);
 #endif
@@ -126,4 +153,13 @@ extern energest_t energest_leveldevice_current_leveltime[ENERGEST_CONF_LEVELDEVI
 #define ENERGEST_OFF_LEVEL(type,level) do { } while(0)
 #endif /* ENERGEST_CONF_ON */
 
+/* For the types that only exist with ENERGEST_CONF_EXTENDED. */
+#if ENERGEST_CONF_EXTENDED
+#define ENERGEST_EXTENDED_ON(type) ENERGEST_ON(type)
+#define ENERGEST_EXTENDED_OFF(type) ENERGEST_OFF(type)
+#else /* ENERGEST_CONF_EXTENDED */
+#define ENERGEST_EXTENDED_ON(type) do { } while(0)
+#define ENERGEST_EXTENDED_OFF(type) do { } while(0)
+#endif /* ENERGEST_CONF_EXTENDED */
+
 #endif /* __ENERGEST_H__ */
@@ -52,8 +52,141 @@
 static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
+#if ETIMER_CONF_HEAP_SIZE
+/*
+ * Pending timers are kept in a binary min-heap ordered by the time
+ * left until they expire, so heap[0] is the next timer to expire. The
+ * timerlist only holds the timers that did not fit in the heap.
+ */
+static struct etimer *heap[ETIMER_CONF_HEAP_SIZE];
+static unsigned short heap_count;
+#endif /* ETIMER_CONF_HEAP_SIZE */
+
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+#if ETIMER_CONF_HEAP_SIZE
+/*
+ * The time left until a timer expires, or zero if it has expired.
+ * Unlike the absolute expiration time, this value orders the timers
+ * correctly across clock wraps, and the order it gives does not
+ * change as time passes.
+ */
+static clock_time_t
+time_left(struct etimer *t, clock_time_t now)
+{
+  clock_time_t elapsed;
+
+  elapsed = now - t->timer.start;
+  return elapsed >= t->timer.interval ? 0 : t->timer.interval - elapsed;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_set(unsigned short i, struct etimer *t)
+{
+  heap[i] = t;
+  t->heap_index = i;
+}
+/*---------------------------------------------------------------------------*/
+static void
+sift_up(unsigned short i, clock_time_t now)
+{
+  struct etimer *t;
+  clock_time_t left;
+  unsigned short parent;
+
+  t = heap[i];
+  left = time_left(t, now);
+  while(i > 0) {
+    parent = (i - 1) / 2;
+    if(time_left(heap[parent], now) <= left) {
+      break;
+    }
+    heap_set(i, heap[parent]);
+    i = parent;
+  }
+  heap_set(i, t);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sift_down(unsigned short i, clock_time_t now)
+{
+  struct etimer *t;
+  clock_time_t left;
+  unsigned short child;
+
+  t = heap[i];
+  left = time_left(t, now);
+  while((child = 2 * i + 1) < heap_count) {
+    if(child + 1 < heap_count &&
+       time_left(heap[child + 1], now) < time_left(heap[child], now)) {
+      child++;
+    }
+    if(left <= time_left(heap[child], now)) {
+      break;
+    }
+    heap_set(i, heap[child]);
+    i = child;
+  }
+  heap_set(i, t);
+}
+/*---------------------------------------------------------------------------*/
+static int
+in_heap(struct etimer *t)
+{
+  return t->heap_index < heap_count && heap[t->heap_index] == t;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Restore the heap order around a timer whose expiration time has
+ * changed.
+ */
+static void
+heap_update(struct etimer *t)
+{
+  clock_time_t now;
+
+  now = clock_time();
+  sift_up(t->heap_index, now);
+  sift_down(t->heap_index, now);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_insert(struct etimer *t)
+{
+  heap_set(heap_count, t);
+  heap_count++;
+  sift_up(heap_count - 1, clock_time());
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Move timers from the overflow list into the heap while there is
+ * room for them.
+ */
+static void
+heap_fill(void)
+{
+  struct etimer *t;
+
+  while(timerlist != NULL && heap_count < ETIMER_CONF_HEAP_SIZE) {
+    t = timerlist;
+    timerlist = t->next;
+    t->next = NULL;
+    heap_insert(t);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(unsigned short i)
+{
+  heap_count--;
+  if(i < heap_count) {
+    heap_set(i, heap[heap_count]);
+    heap_update(heap[i]);
+  }
+  heap_fill();
+}
+#endif /* ETIMER_CONF_HEAP_SIZE */
+/*---------------------------------------------------------------------------*/
 static void
 update_time(void)
 {
@@ -61,6 +194,21 @@ update_time(void)
   clock_time_t now;
   struct etimer *t;
 
+#if ETIMER_CONF_HEAP_SIZE
+  if(heap_count > 0) {
+    now = clock_time();
+    tdist = time_left(heap[0], now);
+    /* Only timers that did not fit in the heap need to be scanned. */
+    for(t = timerlist; t != NULL; t = t->next) {
+      if(time_left(t, now) < tdist) {
+	tdist = time_left(t, now);
+      }
+    }
+    next_expiration = now + tdist;
+    return;
+  }
+#endif /* ETIMER_CONF_HEAP_SIZE */
+
   if (timerlist == NULL) {
     next_expiration = 0;
   } else {
@@ -80,10 +228,16 @@ update_time(void)
 PROCESS_THREAD(etimer_process, ev, data)
 {
   struct etimer *t, *u;
+#if ETIMER_CONF_HEAP_SIZE
+  unsigned short i, j;
+#endif /* ETIMER_CONF_HEAP_SIZE */
 	
   PROCESS_BEGIN();
 
   timerlist = NULL;
+#if ETIMER_CONF_HEAP_SIZE
+  heap_count = 0;
+#endif /* ETIMER_CONF_HEAP_SIZE */
   
   while(1) {
     PROCESS_YIELD();
@@ -91,6 +245,22 @@ PROCESS_THREAD(etimer_process, ev, data)
     if(ev == PROCESS_EVENT_EXITED) {
       struct process *p = data;
 
+#if ETIMER_CONF_HEAP_SIZE
+      /* Drop the timers of the exited process and rebuild the heap
+	 from the remaining ones. */
+      for(i = j = 0; i < heap_count; i++) {
+	if(heap[i]->p != p) {
+	  heap_set(j++, heap[i]);
+	}
+      }
+      if(j != heap_count) {
+	heap_count = j;
+	for(i = heap_count / 2; i > 0; i--) {
+	  sift_down(i - 1, clock_time());
+	}
+      }
+#endif /* ETIMER_CONF_HEAP_SIZE */
+
       while(timerlist != NULL && timerlist->p == p) {
 	timerlist = timerlist->next;
       }
@@ -104,12 +274,30 @@ PROCESS_THREAD(etimer_process, ev, data)
 	    t = t->next;
 	}
       }
+#if ETIMER_CONF_HEAP_SIZE
+      heap_fill();
+      update_time();
+#endif /* ETIMER_CONF_HEAP_SIZE */
       continue;
     } else if(ev != PROCESS_EVENT_POLL) {
       continue;
     }
 
   again:
+
+#if ETIMER_CONF_HEAP_SIZE
+    while(heap_count > 0 && timer_expired(&heap[0]->timer)) {
+      t = heap[0];
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
+	t->p = PROCESS_NONE;
+	heap_remove(0);
+      } else {
+	etimer_request_poll();
+	break;
+      }
+    }
+    update_time();
+#endif /* ETIMER_CONF_HEAP_SIZE */
     
     u = NULL;
     
@@ -155,6 +343,15 @@ add_timer(struct etimer *timer)
   etimer_request_poll();
 
   if(timer->p != PROCESS_NONE) {
+#if ETIMER_CONF_HEAP_SIZE
+    if(in_heap(timer)) {
+      /* Timer already in the heap, move it to its new position. */
+      timer->p = PROCESS_CURRENT();
+      heap_update(timer);
+      update_time();
+      return;
+    }
+#endif /* ETIMER_CONF_HEAP_SIZE */
     for(t = timerlist; t != NULL; t = t->next) {
       if(t == timer) {
 	/* Timer already on list, bail out. */
@@ -167,6 +364,14 @@ add_timer(struct etimer *timer)
 
   /* Timer not on list. */
   timer->p = PROCESS_CURRENT();
+#if ETIMER_CONF_HEAP_SIZE
+  if(heap_count < ETIMER_CONF_HEAP_SIZE) {
+    timer->next = NULL;
+    heap_insert(timer);
+    update_time();
+    return;
+  }
+#endif /* ETIMER_CONF_HEAP_SIZE */
   timer->next = timerlist;
   timerlist = timer;
 
@@ -198,6 +403,11 @@ void
 etimer_adjust(struct etimer *et, int timediff)
 {
   et->timer.start += timediff;
+#if ETIMER_CONF_HEAP_SIZE
+  if(in_heap(et)) {
+    heap_update(et);
+  }
+#endif /* ETIMER_CONF_HEAP_SIZE */
   update_time();
 }
 /*---------------------------------------------------------------------------*/
@@ -222,6 +432,11 @@ etimer_start_time(struct etimer *et)
 int
 etimer_pending(void)
 {
+#if ETIMER_CONF_HEAP_SIZE
+  if(heap_count > 0) {
+    return 1;
+  }
+#endif /* ETIMER_CONF_HEAP_SIZE */
   return timerlist != NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -236,6 +451,12 @@ etimer_stop(struct etimer *et)
 {
   struct etimer *t;
 
+#if ETIMER_CONF_HEAP_SIZE
+  if(in_heap(et)) {
+    heap_remove(et->heap_index);
+    update_time();
+  } else
+#endif /* ETIMER_CONF_HEAP_SIZE */
   /* First check if et is the first event timer on the list. */
   if(et == timerlist) {
     timerlist = timerlist->next;
@@ -65,6 +65,20 @@
 #include "sys/timer.h"
 #include "sys/process.h"
 
+/**
+ * ETIMER_CONF_HEAP_SIZE selects the data structure used for the
+ * pending event timers. When zero (the default), pending timers are
+ * kept on a linked list that is scanned on every clock poll. When
+ * non-zero, up to ETIMER_CONF_HEAP_SIZE pending timers are kept in a
+ * binary min-heap ordered by expiration time: setting and stopping a
+ * timer is O(log n) and the next expiration time is known without a
+ * scan. Timers set while the heap is full are kept on the linked list
+ * and moved into the heap as room becomes available.
+ */
+#ifndef ETIMER_CONF_HEAP_SIZE
+#define ETIMER_CONF_HEAP_SIZE 0
+#endif /* ETIMER_CONF_HEAP_SIZE */
+
 /**
  * A timer.
  *
@@ -77,6 +91,9 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_CONF_HEAP_SIZE
+  unsigned short heap_index;
+#endif /* ETIMER_CONF_HEAP_SIZE */
 };
 
 /**
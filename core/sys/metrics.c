@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Registry of counters and latency histograms
+ */
+
+#include "sys/metrics.h"
+#include "lib/list.h"
+
+#include <stdio.h>
+#include <string.h>
+
+LIST(counters);
+LIST(histograms);
+
+/*---------------------------------------------------------------------------*/
+void
+metrics_register_counter(struct metrics_counter *c)
+{
+  /* Registering twice would make the list circular. */
+  list_remove(counters, c);
+  list_add(counters, c);
+}
+/*---------------------------------------------------------------------------*/
+void
+metrics_register_histogram(struct metrics_histogram *h)
+{
+  list_remove(histograms, h);
+  list_add(histograms, h);
+}
+/*---------------------------------------------------------------------------*/
+void
+metrics_histogram_add(struct metrics_histogram *h, unsigned long value)
+{
+  int i;
+
+  value >>= METRICS_HISTOGRAM_SHIFT;
+  for(i = 0; value != 0 && i < METRICS_HISTOGRAM_BINS - 1; i++) {
+    value >>= 1;
+  }
+  h->bins[i]++;
+}
+/*---------------------------------------------------------------------------*/
+struct metrics_counter *
+metrics_counters(void)
+{
+  return list_head(counters);
+}
+/*---------------------------------------------------------------------------*/
+struct metrics_histogram *
+metrics_histograms(void)
+{
+  return list_head(histograms);
+}
+/*---------------------------------------------------------------------------*/
+int
+metrics_snprint_counter(char *buf, int size, const struct metrics_counter *c)
+{
+  return snprintf(buf, size, "%s %lu", c->name, c->value);
+}
+/*---------------------------------------------------------------------------*/
+int
+metrics_snprint_histogram(char *buf, int size,
+                          const struct metrics_histogram *h)
+{
+  int len, i;
+
+  len = snprintf(buf, size, "%s", h->name);
+  for(i = 0; i < METRICS_HISTOGRAM_BINS; i++) {
+    len += snprintf(buf + (len < size ? len : size),
+                    len < size ? size - len : 0, " %lu", h->bins[i]);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+void
+metrics_reset(void)
+{
+  struct metrics_counter *c;
+  struct metrics_histogram *h;
+
+  for(c = list_head(counters); c != NULL; c = c->next) {
+    c->value = 0;
+  }
+  for(h = list_head(histograms); h != NULL; h = h->next) {
+    memset(h->bins, 0, sizeof(h->bins));
+  }
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Registry of counters and latency histograms
+ *
+ *         Counters and histograms are declared statically in the
+ *         module that updates them and registered at initialization.
+ *         The registry can be printed from the shell (shell-metrics)
+ *         or exported over UDP (apps/metrics). With
+ *         METRICS_CONF_ENABLED set to 0, the default, all macros
+ *         compile to nothing.
+ */
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include "contiki-conf.h"
+#include "sys/rtimer.h"
+
+#ifdef METRICS_CONF_ENABLED
+#define METRICS_ENABLED METRICS_CONF_ENABLED
+#else /* METRICS_CONF_ENABLED */
+#define METRICS_ENABLED 0
+#endif /* METRICS_CONF_ENABLED */
+
+/* Histogram bin i counts values below 2^(METRICS_HISTOGRAM_SHIFT + i)
+   not counted by a lower bin. The last bin counts all larger values. */
+#ifdef METRICS_CONF_HISTOGRAM_BINS
+#define METRICS_HISTOGRAM_BINS METRICS_CONF_HISTOGRAM_BINS
+#else /* METRICS_CONF_HISTOGRAM_BINS */
+#define METRICS_HISTOGRAM_BINS 10
+#endif /* METRICS_CONF_HISTOGRAM_BINS */
+
+#ifdef METRICS_CONF_HISTOGRAM_SHIFT
+#define METRICS_HISTOGRAM_SHIFT METRICS_CONF_HISTOGRAM_SHIFT
+#else /* METRICS_CONF_HISTOGRAM_SHIFT */
+#define METRICS_HISTOGRAM_SHIFT 4
+#endif /* METRICS_CONF_HISTOGRAM_SHIFT */
+
+struct metrics_counter {
+  struct metrics_counter *next;
+  const char *name;
+  unsigned long value;
+};
+
+struct metrics_histogram {
+  struct metrics_histogram *next;
+  const char *name;
+  unsigned long bins[METRICS_HISTOGRAM_BINS];
+};
+
+#if METRICS_ENABLED
+
+#define METRICS_COUNTER(c, name) \
+  static struct metrics_counter c = { NULL, name, 0 }
+#define METRICS_HISTOGRAM(h, name) \
+  static struct metrics_histogram h = { NULL, name, { 0 } }
+
+#define METRICS_REGISTER_COUNTER(c) metrics_register_counter(&(c))
+#define METRICS_REGISTER_HISTOGRAM(h) metrics_register_histogram(&(h))
+
+#define METRICS_ADD(c, v) ((c).value += (v))
+#define METRICS_INC(c) METRICS_ADD(c, 1)
+/* Keep the largest value seen, for example of a queue length. */
+#define METRICS_MAX(c, v) do {		\
+    if((unsigned long)(v) > (c).value) {	\
+      (c).value = (v);			\
+    }					\
+  } while(0)
+
+/* Time stamps for latency histograms, in rtimer ticks. */
+#define METRICS_NOW() RTIMER_NOW()
+#define METRICS_LATENCY(h, since) \
+  metrics_histogram_add(&(h), (rtimer_clock_t)(RTIMER_NOW() - (since)))
+
+#else /* METRICS_ENABLED */
+
+#define METRICS_COUNTER(c, name) extern struct metrics_counter c
+#define METRICS_HISTOGRAM(h, name) extern struct metrics_histogram h
+#define METRICS_REGISTER_COUNTER(c)
+#define METRICS_REGISTER_HISTOGRAM(h)
+#define METRICS_ADD(c, v)
+#define METRICS_INC(c)
+#define METRICS_MAX(c, v)
+#define METRICS_NOW() 0
+#define METRICS_LATENCY(h, since)
+
+#endif /* METRICS_ENABLED */
+
+void metrics_register_counter(struct metrics_counter *c);
+void metrics_register_histogram(struct metrics_histogram *h);
+void metrics_histogram_add(struct metrics_histogram *h, unsigned long value);
+
+/**
+ * The registered counters and histograms, to be walked through the
+ * next pointers.
+ */
+struct metrics_counter *metrics_counters(void);
+struct metrics_histogram *metrics_histograms(void);
+
+/**
+ * Format a counter or histogram as a line of text, without newline:
+ * the name followed by the value, or by the counts of the bins.
+ *
+ * \return The length of the line, as for snprintf().
+ */
+int metrics_snprint_counter(char *buf, int size,
+                            const struct metrics_counter *c);
+int metrics_snprint_histogram(char *buf, int size,
+                              const struct metrics_histogram *h);
+
+/**
+ * Set all registered counters and histograms to zero.
+ */
+void metrics_reset(void);
+
+#endif /* __METRICS_H__ */
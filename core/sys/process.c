@@ -47,6 +47,12 @@
 
 #include "sys/process.h"
 #include "sys/arg.h"
+#include "sys/trace.h"
+#if PROCESS_CONF_ACCOUNTING
+#include "sys/clock.h"
+#include "sys/rtimer.h"
+#include <string.h>
+#endif /* PROCESS_CONF_ACCOUNTING */
 
 /*
  * Pointer to the currently running process structure.
@@ -65,15 +71,71 @@ struct event_data {
   struct process *p;
 };
 
-static process_num_events_t nevents, fevent;
-static struct event_data events[PROCESS_CONF_NUMEVENTS];
+static process_num_events_t nevents;
+
+#if PROCESS_CONF_PRIO
+/*
+ * With priority classes, the event array is split into one circular
+ * queue per class. qbase[] is the start of each queue in the array,
+ * qsize[] its length, qfirst[] the index of its first event and
+ * qevents[] the number of events in it.
+ */
+#define NUMEVENTS (PROCESS_CONF_NUMEVENTS_URGENT + PROCESS_CONF_NUMEVENTS + \
+                   PROCESS_CONF_NUMEVENTS_BACKGROUND)
+
+static const process_num_events_t qsize[PROCESS_PRIO_NUM] = {
+  PROCESS_CONF_NUMEVENTS_URGENT,
+  PROCESS_CONF_NUMEVENTS,
+  PROCESS_CONF_NUMEVENTS_BACKGROUND
+};
+static const process_num_events_t qbase[PROCESS_PRIO_NUM] = {
+  0,
+  PROCESS_CONF_NUMEVENTS_URGENT,
+  PROCESS_CONF_NUMEVENTS_URGENT + PROCESS_CONF_NUMEVENTS
+};
+static process_num_events_t qfirst[PROCESS_PRIO_NUM], qevents[PROCESS_PRIO_NUM];
+
+/* Number of events dispatched from more urgent classes while events
+   in the class were waiting. */
+static unsigned char skipped[PROCESS_PRIO_NUM];
+#else /* PROCESS_CONF_PRIO */
+#define NUMEVENTS PROCESS_CONF_NUMEVENTS
+static process_num_events_t fevent;
+#endif /* PROCESS_CONF_PRIO */
+
+static struct event_data events[NUMEVENTS];
 
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
+#if PROCESS_CONF_PRIO
+process_num_events_t process_maxevents_prio[PROCESS_PRIO_NUM];
+#endif /* PROCESS_CONF_PRIO */
 #endif
 
 static volatile unsigned char poll_requested;
 
+#if PROCESS_CONF_POLL_QUEUE
+#if (PROCESS_CONF_POLL_QUEUE & (PROCESS_CONF_POLL_QUEUE - 1)) != 0 || \
+  PROCESS_CONF_POLL_QUEUE > 128
+#error PROCESS_CONF_POLL_QUEUE must be a power of two no larger than 128
+#endif
+/*
+ * Processes that have requested a poll, in the order of the
+ * requests. poll_write is only advanced by process_poll() and
+ * poll_read only by do_poll(), so no locking is needed between the
+ * main loop and an interrupt handler.
+ */
+static struct process *poll_queue[PROCESS_CONF_POLL_QUEUE];
+static volatile unsigned char poll_read, poll_write;
+static volatile unsigned char poll_overflow;
+#endif /* PROCESS_CONF_POLL_QUEUE */
+
+#if PROCESS_CONF_ACCOUNTING
+/* Ticks spent in processes called synchronously from the current
+   invocation, which are not accounted to the caller. */
+static rtimer_clock_t nested_ticks;
+#endif /* PROCESS_CONF_ACCOUNTING */
+
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
@@ -113,6 +175,9 @@ process_start(struct process *p, const char *arg)
   process_list = p;
   p->state = PROCESS_STATE_RUNNING;
   PT_INIT(&p->pt);
+#if PROCESS_CONF_ACCOUNTING
+  memset(&p->acct, 0, sizeof(p->acct));
+#endif /* PROCESS_CONF_ACCOUNTING */
 
   PRINTF("process: starting '%s'\n", PROCESS_NAME_STRING(p));
 
@@ -157,6 +222,11 @@ exit_process(struct process *p, struct process *fromprocess)
     }
   }
 
+#if PROCESS_CONF_POLL_QUEUE
+  /* The process may still be in the poll queue. */
+  p->needspoll = 0;
+#endif /* PROCESS_CONF_POLL_QUEUE */
+
   if(p == process_list) {
     process_list = process_list->next;
   } else {
@@ -175,6 +245,9 @@ static void
 call_process(struct process *p, process_event_t ev, process_data_t data)
 {
   int ret;
+#if PROCESS_CONF_ACCOUNTING
+  rtimer_clock_t start, elapsed, outer_nested;
+#endif /* PROCESS_CONF_ACCOUNTING */
 
 #if DEBUG
   if(p->state == PROCESS_STATE_CALLED) {
@@ -187,7 +260,23 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+    TRACE_PTR(TRACE_PROCESS_CALL, p);
+#if PROCESS_CONF_ACCOUNTING
+    outer_nested = nested_ticks;
+    nested_ticks = 0;
+    start = RTIMER_NOW();
+#endif /* PROCESS_CONF_ACCOUNTING */
     ret = p->thread(&p->pt, ev, data);
+#if PROCESS_CONF_ACCOUNTING
+    elapsed = RTIMER_NOW() - start;
+    p->acct.ticks += (rtimer_clock_t)(elapsed - nested_ticks);
+    if((rtimer_clock_t)(elapsed - nested_ticks) > p->acct.max) {
+      p->acct.max = (rtimer_clock_t)(elapsed - nested_ticks);
+    }
+    p->acct.calls++;
+    nested_ticks = outer_nested + elapsed;
+#endif /* PROCESS_CONF_ACCOUNTING */
+    TRACE_PTR(TRACE_PROCESS_RETURN, p);
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
@@ -207,9 +296,24 @@ process_exit(struct process *p)
 void
 process_init(void)
 {
+#if PROCESS_CONF_PRIO
+  int i;
+#endif /* PROCESS_CONF_PRIO */
+
   lastevent = PROCESS_EVENT_MAX;
 
-  nevents = fevent = 0;
+  nevents = 0;
+#if PROCESS_CONF_PRIO
+  for(i = 0; i < PROCESS_PRIO_NUM; i++) {
+    qfirst[i] = qevents[i] = 0;
+    skipped[i] = 0;
+#if PROCESS_CONF_STATS
+    process_maxevents_prio[i] = 0;
+#endif /* PROCESS_CONF_STATS */
+  }
+#else /* PROCESS_CONF_PRIO */
+  fevent = 0;
+#endif /* PROCESS_CONF_PRIO */
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
 #endif /* PROCESS_CONF_STATS */
@@ -227,6 +331,23 @@ do_poll(void)
   struct process *p;
 
   poll_requested = 0;
+#if PROCESS_CONF_POLL_QUEUE
+  /* Call the processes in the poll queue. */
+  while(poll_read != poll_write) {
+    p = poll_queue[poll_read % PROCESS_CONF_POLL_QUEUE];
+    poll_read++;
+    if(p->needspoll) {
+      p->state = PROCESS_STATE_RUNNING;
+      p->needspoll = 0;
+      call_process(p, PROCESS_EVENT_POLL, NULL);
+    }
+  }
+
+  if(!poll_overflow) {
+    return;
+  }
+  poll_overflow = 0;
+#endif /* PROCESS_CONF_POLL_QUEUE */
   /* Call the processes that needs to be polled. */
   for(p = process_list; p != NULL; p = p->next) {
     if(p->needspoll) {
@@ -237,6 +358,41 @@ do_poll(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_PRIO
+/*
+ * Select the priority class to take the next event from: the most
+ * urgent class that has events, unless a less urgent class has been
+ * passed over PROCESS_CONF_PRIO_MAX_BURST times. Must only be called
+ * when there are events in the queue.
+ */
+static unsigned char
+next_prio(void)
+{
+  unsigned char prio, i;
+
+  for(prio = 0; qevents[prio] == 0; prio++);
+
+  for(i = prio + 1; i < PROCESS_PRIO_NUM; i++) {
+    if(qevents[i] > 0 && skipped[i] >= PROCESS_CONF_PRIO_MAX_BURST) {
+      prio = i;
+      break;
+    }
+  }
+
+  for(i = 0; i < PROCESS_PRIO_NUM; i++) {
+    if(i == prio) {
+      continue;
+    }
+    if(qevents[i] > 0 && skipped[i] < 0xff) {
+      skipped[i]++;
+    }
+  }
+  skipped[prio] = 0;
+
+  return prio;
+}
+#endif /* PROCESS_CONF_PRIO */
+/*---------------------------------------------------------------------------*/
 /*
  * Process the next event in the event queue and deliver it to
  * listening processes.
@@ -249,7 +405,11 @@ do_event(void)
   static process_data_t data;
   static struct process *receiver;
   static struct process *p;
-  
+#if PROCESS_CONF_PRIO
+  static unsigned char prio;
+  static process_num_events_t i;
+#endif /* PROCESS_CONF_PRIO */
+
   /*
    * If there are any events in the queue, take the first one and walk
    * through the list of processes to see if the event should be
@@ -261,6 +421,19 @@ do_event(void)
   if(nevents > 0) {
     
     /* There are events that we should deliver. */
+#if PROCESS_CONF_PRIO
+    prio = next_prio();
+    i = qbase[prio] + qfirst[prio];
+    ev = events[i].ev;
+
+    data = events[i].data;
+    receiver = events[i].p;
+
+    /* Since we have seen the new event, we move pointer upwards
+       and decrese the number of events. */
+    qfirst[prio] = (qfirst[prio] + 1) % qsize[prio];
+    --qevents[prio];
+#else /* PROCESS_CONF_PRIO */
     ev = events[fevent].ev;
     
     data = events[fevent].data;
@@ -269,6 +442,7 @@ do_event(void)
     /* Since we have seen the new event, we move pointer upwards
        and decrese the number of events. */
     fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+#endif /* PROCESS_CONF_PRIO */
     --nevents;
 
     /* If this is a broadcast event, we deliver it to all events, in
@@ -319,7 +493,32 @@ process_nevents(void)
 }
 /*---------------------------------------------------------------------------*/
 int
+process_nevents_prio(unsigned char prio)
+{
+#if PROCESS_CONF_PRIO
+  if(prio < PROCESS_PRIO_NUM) {
+    return qevents[prio];
+  }
+  return 0;
+#else /* PROCESS_CONF_PRIO */
+  return prio == PROCESS_PRIO_NORMAL ? nevents : 0;
+#endif /* PROCESS_CONF_PRIO */
+}
+/*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_PRIO
+int
 process_post(struct process *p, process_event_t ev, process_data_t data)
+{
+  return process_post_prio(p, ev, data, PROCESS_PRIO_NORMAL);
+}
+/*---------------------------------------------------------------------------*/
+int
+process_post_prio(struct process *p, process_event_t ev, process_data_t data,
+                  unsigned char prio)
+#else /* PROCESS_CONF_PRIO */
+int
+process_post(struct process *p, process_event_t ev, process_data_t data)
+#endif /* PROCESS_CONF_PRIO */
 {
   static process_num_events_t snum;
 
@@ -332,7 +531,14 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
 	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
   }
   
+#if PROCESS_CONF_PRIO
+  if(prio >= PROCESS_PRIO_NUM) {
+    prio = PROCESS_PRIO_BACKGROUND;
+  }
+  if(qevents[prio] == qsize[prio]) {
+#else /* PROCESS_CONF_PRIO */
   if(nevents == PROCESS_CONF_NUMEVENTS) {
+#endif /* PROCESS_CONF_PRIO */
 #if DEBUG
     if(p == PROCESS_BROADCAST) {
       printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
@@ -343,16 +549,33 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
     return PROCESS_ERR_FULL;
   }
   
+#if PROCESS_CONF_PRIO
+  snum = qbase[prio] +
+    (process_num_events_t)(qfirst[prio] + qevents[prio]) % qsize[prio];
+  ++qevents[prio];
+#else /* PROCESS_CONF_PRIO */
   snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
+#endif /* PROCESS_CONF_PRIO */
   events[snum].ev = ev;
   events[snum].data = data;
   events[snum].p = p;
   ++nevents;
+#if PROCESS_CONF_ACCOUNTING
+  if(p != PROCESS_BROADCAST) {
+    p->acct.events++;
+  }
+#endif /* PROCESS_CONF_ACCOUNTING */
+  TRACE(TRACE_PROCESS_POST, ev);
 
 #if PROCESS_CONF_STATS
   if(nevents > process_maxevents) {
     process_maxevents = nevents;
   }
+#if PROCESS_CONF_PRIO
+  if(qevents[prio] > process_maxevents_prio[prio]) {
+    process_maxevents_prio[prio] = qevents[prio];
+  }
+#endif /* PROCESS_CONF_PRIO */
 #endif /* PROCESS_CONF_STATS */
   
   return PROCESS_ERR_OK;
@@ -373,12 +596,37 @@ process_poll(struct process *p)
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
+#if PROCESS_CONF_POLL_QUEUE
+      if(!p->needspoll) {
+        p->needspoll = 1;
+        if((unsigned char)(poll_write - poll_read) < PROCESS_CONF_POLL_QUEUE) {
+          poll_queue[poll_write % PROCESS_CONF_POLL_QUEUE] = p;
+          poll_write++;
+        } else {
+          poll_overflow = 1;
+        }
+      }
+#else /* PROCESS_CONF_POLL_QUEUE */
       p->needspoll = 1;
+#endif /* PROCESS_CONF_POLL_QUEUE */
       poll_requested = 1;
+      TRACE_PTR(TRACE_PROCESS_POLL, p);
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_ACCOUNTING
+void
+process_accounting_reset(void)
+{
+  struct process *p;
+
+  for(p = process_list; p != NULL; p = p->next) {
+    memset(&p->acct, 0, sizeof(p->acct));
+  }
+}
+#endif /* PROCESS_CONF_ACCOUNTING */
+/*---------------------------------------------------------------------------*/
 int
 process_is_running(struct process *p)
 {
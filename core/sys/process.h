@@ -88,6 +88,92 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * \name Event priority classes
+ *
+ * When PROCESS_CONF_PRIO is set, the kernel keeps one event queue per
+ * priority class and always dispatches from the most urgent non-empty
+ * queue. Events posted with process_post() go to the normal class, so
+ * existing code behaves as before. The normal queue holds
+ * PROCESS_CONF_NUMEVENTS events, the other two queues are sized by
+ * PROCESS_CONF_NUMEVENTS_URGENT and PROCESS_CONF_NUMEVENTS_BACKGROUND.
+ *
+ * To bound the latency of the lower classes, at most
+ * PROCESS_CONF_PRIO_MAX_BURST events are dispatched from a higher
+ * class in a row while a lower class has events waiting.
+ * @{
+ */
+#ifndef PROCESS_CONF_PRIO
+#define PROCESS_CONF_PRIO 0
+#endif /* PROCESS_CONF_PRIO */
+
+#define PROCESS_PRIO_URGENT     0
+#define PROCESS_PRIO_NORMAL     1
+#define PROCESS_PRIO_BACKGROUND 2
+
+#if PROCESS_CONF_PRIO
+#define PROCESS_PRIO_NUM        3
+
+#ifndef PROCESS_CONF_NUMEVENTS_URGENT
+#define PROCESS_CONF_NUMEVENTS_URGENT 8
+#endif /* PROCESS_CONF_NUMEVENTS_URGENT */
+
+#ifndef PROCESS_CONF_NUMEVENTS_BACKGROUND
+#define PROCESS_CONF_NUMEVENTS_BACKGROUND 8
+#endif /* PROCESS_CONF_NUMEVENTS_BACKGROUND */
+
+#ifndef PROCESS_CONF_PRIO_MAX_BURST
+#define PROCESS_CONF_PRIO_MAX_BURST 8
+#endif /* PROCESS_CONF_PRIO_MAX_BURST */
+#else /* PROCESS_CONF_PRIO */
+#define PROCESS_PRIO_NUM        1
+#endif /* PROCESS_CONF_PRIO */
+/** @} */
+
+/**
+ * \name Per-process CPU accounting
+ *
+ * When PROCESS_CONF_ACCOUNTING is set, the kernel measures every
+ * invocation of a process in rtimer ticks. Time spent in processes
+ * called synchronously with process_post_synch() is accounted to the
+ * called process only. The counters are kept in the process
+ * structure and listed by the shell "ps" command.
+ * @{
+ */
+#ifndef PROCESS_CONF_ACCOUNTING
+#define PROCESS_CONF_ACCOUNTING 0
+#endif /* PROCESS_CONF_ACCOUNTING */
+
+#if PROCESS_CONF_ACCOUNTING
+struct process_accounting {
+  unsigned long ticks;  /* Total rtimer ticks spent in the process */
+  unsigned long max;    /* Longest single invocation, in rtimer ticks */
+  unsigned long calls;  /* Number of invocations */
+  unsigned long events; /* Number of events posted to the process */
+};
+#endif /* PROCESS_CONF_ACCOUNTING */
+/** @} */
+
+/**
+ * \name Poll queue
+ *
+ * By default, the kernel scans the whole process list for processes
+ * that have requested a poll whenever any process is polled. With
+ * PROCESS_CONF_POLL_QUEUE set, process_poll() instead appends the
+ * process to a queue of PROCESS_CONF_POLL_QUEUE entries (a power of two, e.g. 16)
+ * and only the
+ * queued processes are visited. If the queue fills up, the kernel
+ * falls back to scanning the list once.
+ *
+ * process_poll() may be called from interrupt handlers, but not from
+ * interrupt handlers that can preempt each other.
+ * @{
+ */
+#ifndef PROCESS_CONF_POLL_QUEUE
+#define PROCESS_CONF_POLL_QUEUE 0
+#endif /* PROCESS_CONF_POLL_QUEUE */
+/** @} */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +409,9 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_CONF_ACCOUNTING
+  struct process_accounting acct;
+#endif /* PROCESS_CONF_ACCOUNTING */
 };
 
 /**
@@ -364,6 +453,37 @@ CCIF void process_start(struct process *p, const char *arg);
  */
 CCIF int process_post(struct process *p, process_event_t ev, void* data);
 
+/**
+ * Post an asynchronous event with a priority class.
+ *
+ * This function works like process_post() but puts the event in the
+ * queue of the given priority class. Events in a more urgent class
+ * are delivered before events in less urgent classes. If the kernel
+ * is built without PROCESS_CONF_PRIO, the priority class is ignored
+ * and the event is posted with process_post().
+ *
+ * \param p The process to which the event should be posted, or
+ * PROCESS_BROADCAST if the event should be posted to all processes.
+ *
+ * \param ev The event to be posted.
+ *
+ * \param data The auxiliary data to be sent with the event
+ *
+ * \param prio The priority class: PROCESS_PRIO_URGENT,
+ * PROCESS_PRIO_NORMAL or PROCESS_PRIO_BACKGROUND.
+ *
+ * \retval PROCESS_ERR_OK The event could be posted.
+ *
+ * \retval PROCESS_ERR_FULL The event queue of the priority class was
+ * full and the event could not be posted.
+ */
+#if PROCESS_CONF_PRIO
+CCIF int process_post_prio(struct process *p, process_event_t ev,
+                           void *data, unsigned char prio);
+#else /* PROCESS_CONF_PRIO */
+#define process_post_prio(p, ev, data, prio) process_post(p, ev, data)
+#endif /* PROCESS_CONF_PRIO */
+
 /**
  * Post a synchronous event to a process.
  *
@@ -469,6 +589,13 @@ CCIF process_event_t process_alloc_event(void);
  */
 CCIF void process_poll(struct process *p);
 
+#if PROCESS_CONF_ACCOUNTING
+/**
+ * Reset the CPU accounting counters of all running processes.
+ */
+void process_accounting_reset(void);
+#endif /* PROCESS_CONF_ACCOUNTING */
+
 /** @} */
 
 /**
@@ -519,6 +646,17 @@ CCIF int process_is_running(struct process *p);
  */
 int process_nevents(void);
 
+/**
+ * Number of events of a priority class waiting to be processed.
+ *
+ * \param prio The priority class.
+ *
+ * \return The number of events in the queue of the priority
+ * class. Without PROCESS_CONF_PRIO, all events are counted in the
+ * PROCESS_PRIO_NORMAL class.
+ */
+int process_nevents_prio(unsigned char prio);
+
 /** @} */
 
 CCIF extern struct process *process_list;
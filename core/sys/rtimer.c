@@ -45,6 +45,7 @@
  */
 
 #include "sys/rtimer.h"
+#include "sys/trace.h"
 #include "contiki.h"
 
 #define DEBUG 0
@@ -55,15 +56,172 @@
 #define PRINTF(...)
 #endif
 
+#ifdef RTIMER_CONF_LATE_TICKS
+#define RTIMER_LATE_TICKS RTIMER_CONF_LATE_TICKS
+#else
+#define RTIMER_LATE_TICKS (RTIMER_ARCH_SECOND / 1000 + 1)
+#endif
+
+#if RTIMER_QUEUE
+#ifdef RTIMER_CONF_QUEUE_SIZE
+#define RTIMER_QUEUE_SIZE RTIMER_CONF_QUEUE_SIZE
+#else
+#define RTIMER_QUEUE_SIZE 4
+#endif
+
+#ifndef rtimer_arch_irq_disable
+#error RTIMER_CONF_QUEUE needs rtimer_arch_irq_disable() in rtimer-arch.h
+#endif
+#endif /* RTIMER_QUEUE */
+
+/* With RTIMER_QUEUE, the pending tasks sorted by deadline. The list
+   is linked through the tasks themselves, so no storage besides the
+   tasks is needed. */
 static struct rtimer *next_rtimer;
+#if RTIMER_QUEUE
+static unsigned char queued;
+#endif /* RTIMER_QUEUE */
+static struct rtimer_stats stats;
 
 /*---------------------------------------------------------------------------*/
 void
 rtimer_init(void)
 {
+  next_rtimer = NULL;
+#if RTIMER_QUEUE
+  queued = 0;
+#endif /* RTIMER_QUEUE */
   rtimer_arch_init();
 }
 /*---------------------------------------------------------------------------*/
+static void
+count_lateness(struct rtimer *t, rtimer_clock_t now)
+{
+  rtimer_clock_t lateness;
+
+  lateness = now - t->time;
+  if(!RTIMER_CLOCK_LT(now, t->time) && lateness > RTIMER_LATE_TICKS) {
+    stats.late++;
+    if(lateness > stats.max_lateness) {
+      stats.max_lateness = lateness;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if RTIMER_QUEUE
+/* Must be called with interrupts masked. */
+static int
+remove_task(struct rtimer *rtimer)
+{
+  struct rtimer **p;
+
+  for(p = &next_rtimer; *p != NULL; p = &(*p)->next) {
+    if(*p == rtimer) {
+      *p = rtimer->next;
+      rtimer->next = NULL;
+      queued--;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
+	   rtimer_clock_t duration,
+	   rtimer_callback_t func, void *ptr)
+{
+  struct rtimer **p;
+  struct rtimer *first;
+  rtimer_arch_irq_t irq;
+
+  PRINTF("rtimer_set time %d\n", time);
+
+  irq = rtimer_arch_irq_disable();
+
+  first = next_rtimer;
+  remove_task(rtimer);
+
+  if(queued >= RTIMER_QUEUE_SIZE) {
+    stats.full++;
+    rtimer_arch_irq_restore(irq);
+    return RTIMER_ERR_FULL;
+  }
+
+  rtimer->func = func;
+  rtimer->ptr = ptr;
+  rtimer->time = time;
+
+  /* Insert after any task with the same deadline, so that tasks set
+     for the same time run in the order they were set. */
+  for(p = &next_rtimer;
+      *p != NULL && !RTIMER_CLOCK_LT(time, (*p)->time);
+      p = &(*p)->next);
+  rtimer->next = *p;
+  *p = rtimer;
+  queued++;
+
+  if(next_rtimer != first || first == rtimer) {
+    rtimer_arch_schedule(next_rtimer->time);
+  }
+
+  rtimer_arch_irq_restore(irq);
+  return RTIMER_OK;
+}
+/*---------------------------------------------------------------------------*/
+int
+rtimer_cancel(struct rtimer *rtimer)
+{
+  struct rtimer *first;
+  rtimer_arch_irq_t irq;
+  int removed;
+
+  irq = rtimer_arch_irq_disable();
+
+  first = next_rtimer;
+  removed = remove_task(rtimer);
+  if(removed && next_rtimer != first && next_rtimer != NULL) {
+    rtimer_arch_schedule(next_rtimer->time);
+  }
+
+  rtimer_arch_irq_restore(irq);
+  return removed;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_run_next(void)
+{
+  struct rtimer *t;
+  rtimer_clock_t now;
+  rtimer_arch_irq_t irq;
+
+  /* Run the tasks that are due. The interrupt may have been armed
+     for a task that since has been cancelled or rescheduled, so the
+     first task is not run unless its deadline has passed. */
+  while(1) {
+    irq = rtimer_arch_irq_disable();
+    now = RTIMER_NOW();
+    t = next_rtimer;
+    if(t == NULL || RTIMER_CLOCK_LT(now, t->time)) {
+      break;
+    }
+    next_rtimer = t->next;
+    t->next = NULL;
+    queued--;
+    rtimer_arch_irq_restore(irq);
+
+    count_lateness(t, now);
+    TRACE_PTR(TRACE_RTIMER_RUN, t);
+    t->func(t, t->ptr);
+  }
+
+  if(next_rtimer != NULL) {
+    rtimer_arch_schedule(next_rtimer->time);
+  }
+  rtimer_arch_irq_restore(irq);
+}
+#else /* RTIMER_QUEUE */
+/*---------------------------------------------------------------------------*/
 int
 rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
 	   rtimer_clock_t duration,
@@ -89,6 +247,16 @@ rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
   return RTIMER_OK;
 }
 /*---------------------------------------------------------------------------*/
+int
+rtimer_cancel(struct rtimer *rtimer)
+{
+  if(next_rtimer != rtimer) {
+    return 0;
+  }
+  next_rtimer = NULL;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 void
 rtimer_run_next(void)
 {
@@ -98,10 +266,19 @@ rtimer_run_next(void)
   }
   t = next_rtimer;
   next_rtimer = NULL;
+  count_lateness(t, RTIMER_NOW());
+  TRACE_PTR(TRACE_RTIMER_RUN, t);
   t->func(t, t->ptr);
   if(next_rtimer != NULL) {
     rtimer_arch_schedule(next_rtimer->time);
   }
   return;
 }
+#endif /* RTIMER_QUEUE */
+/*---------------------------------------------------------------------------*/
+const struct rtimer_stats *
+rtimer_stats(void)
+{
+  return &stats;
+}
 /*---------------------------------------------------------------------------*/
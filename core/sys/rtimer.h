@@ -61,6 +61,19 @@ typedef unsigned short rtimer_clock_t;
 
 #include "rtimer-arch.h"
 
+/*
+ * With RTIMER_CONF_QUEUE set, several tasks may be pending at the
+ * same time. The queue is edited with interrupts masked, so the
+ * architecture must provide rtimer_arch_irq_disable() and
+ * rtimer_arch_irq_restore() in rtimer-arch.h. Without it, a single
+ * task is pending and setting another one replaces it.
+ */
+#ifdef RTIMER_CONF_QUEUE
+#define RTIMER_QUEUE RTIMER_CONF_QUEUE
+#else /* RTIMER_CONF_QUEUE */
+#define RTIMER_QUEUE 0
+#endif /* RTIMER_CONF_QUEUE */
+
 /**
  * \brief      Initialize the real-time scheduler.
  *
@@ -81,11 +94,26 @@ typedef void (* rtimer_callback_t)(struct rtimer *t, void *ptr);
  *             support module for the real-time module.
  */
 struct rtimer {
+#if RTIMER_QUEUE
+  struct rtimer *next;
+#endif /* RTIMER_QUEUE */
   rtimer_clock_t time;
   rtimer_callback_t func;
   void *ptr;
 };
 
+/**
+ * \brief      Statistics kept by the real-time scheduler
+ *
+ *             A task is counted as late if it runs more than
+ *             RTIMER_LATE_TICKS ticks after its deadline.
+ */
+struct rtimer_stats {
+  unsigned short late;
+  rtimer_clock_t max_lateness;
+  unsigned short full;
+};
+
 enum {
   RTIMER_OK,
   RTIMER_ERR_FULL,
@@ -100,25 +128,44 @@ enum {
  * \param duration Unused argument.
  * \param func A function to be called when the task is executed.
  * \param ptr An opaque pointer that will be supplied as an argument to the callback function.
- * \return     Non-zero (true) if the task could be scheduled, zero
- *             (false) if the task could not be scheduled.
+ * \return     RTIMER_OK if the task was scheduled, RTIMER_ERR_FULL
+ *             if RTIMER_QUEUE_SIZE tasks already are pending.
  *
  *             This function schedules a real-time task at a specified
- *             time in the future.
+ *             time in the future. With RTIMER_CONF_QUEUE, several
+ *             tasks may be pending at the same time; they are run in
+ *             deadline order, and setting a task that already is
+ *             pending reschedules it. Otherwise the task replaces
+ *             the one that is pending.
  *
  */
 int rtimer_set(struct rtimer *task, rtimer_clock_t time,
 	       rtimer_clock_t duration, rtimer_callback_t func, void *ptr);
 
 /**
- * \brief      Execute the next real-time task and schedule the next task, if any
+ * \brief      Remove a pending real-time task
+ * \param task The task
+ * \return     Non-zero if the task was pending, zero otherwise
+ */
+int rtimer_cancel(struct rtimer *task);
+
+/**
+ * \brief      Execute the due real-time tasks and schedule the next task, if any
  *
  *             This function is called by the architecture dependent
  *             code to execute and schedule the next real-time task.
+ *             With RTIMER_CONF_QUEUE, all tasks whose deadline has
+ *             passed are run before the hardware timer is rearmed
+ *             for the earliest remaining task.
  *
  */
 void rtimer_run_next(void);
 
+/**
+ * \brief      Get the real-time scheduler statistics
+ */
+const struct rtimer_stats *rtimer_stats(void);
+
 /**
  * \brief      Get the current clock time
  * \return     The current time
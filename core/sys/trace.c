@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Binary tracing of hot paths
+ */
+
+#include "contiki.h"
+#include "sys/trace.h"
+
+#if (TRACE_SIZE & (TRACE_SIZE - 1)) != 0
+#error TRACE_CONF_SIZE must be a power of two
+#endif
+
+static struct trace_record records[TRACE_SIZE];
+static volatile uint16_t head, count;
+static volatile uint8_t dumping;
+
+/*---------------------------------------------------------------------------*/
+void
+trace_add(uint16_t id, uint16_t arg)
+{
+  struct trace_record *r;
+
+  if(dumping) {
+    return;
+  }
+
+  /* Claim the slot before filling it in, so that an interrupt that
+     adds a record in between gets a slot of its own. */
+  r = &records[head++ & (TRACE_SIZE - 1)];
+  if(count < TRACE_SIZE) {
+    count++;
+  }
+  r->time = RTIMER_NOW();
+  r->id = id;
+  r->arg = arg;
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_value(void (* write_byte)(unsigned char c), unsigned long v, int len)
+{
+  while(len-- > 0) {
+    write_byte(v & 0xff);
+    v >>= 8;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+trace_dump(void (* write_byte)(unsigned char c))
+{
+  struct trace_record *r;
+  uint16_t i, n;
+
+  dumping = 1;
+  n = count;
+
+  write_byte('T');
+  write_byte('R');
+  write_value(write_byte, n, 2);
+  write_value(write_byte, sizeof(rtimer_clock_t), 1);
+  write_value(write_byte, RTIMER_SECOND, 4);
+
+  for(i = head - n; i != head; i++) {
+    r = &records[i & (TRACE_SIZE - 1)];
+    write_value(write_byte, r->id, 2);
+    write_value(write_byte, r->arg, 2);
+    write_value(write_byte, r->time, sizeof(rtimer_clock_t));
+  }
+
+  count = 0;
+  dumping = 0;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Binary tracing of hot paths
+ *
+ *         A tracepoint writes a record with a numeric id, a 16-bit
+ *         argument and an rtimer time stamp into a ring buffer. This
+ *         takes a few instructions and can be done from interrupt
+ *         context. trace_dump() writes the buffer out in binary, for
+ *         tools/trace-decode to turn into text on the host. With
+ *         TRACE_CONF_ENABLED set to 0, the default, tracepoints
+ *         compile to nothing.
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "contiki-conf.h"
+#include "sys/rtimer.h"
+
+#ifdef TRACE_CONF_ENABLED
+#define TRACE_ENABLED TRACE_CONF_ENABLED
+#else /* TRACE_CONF_ENABLED */
+#define TRACE_ENABLED 0
+#endif /* TRACE_CONF_ENABLED */
+
+/* The number of records in the ring buffer. Must be a power of two. */
+#ifdef TRACE_CONF_SIZE
+#define TRACE_SIZE TRACE_CONF_SIZE
+#else /* TRACE_CONF_SIZE */
+#define TRACE_SIZE 64
+#endif /* TRACE_CONF_SIZE */
+
+/* Tracepoints of the core. The names are known to tools/trace-decode.
+   Applications use ids from TRACE_USER upwards. */
+enum {
+  TRACE_PROCESS_POST = 1,   /* arg: event */
+  TRACE_PROCESS_CALL,       /* arg: process address */
+  TRACE_PROCESS_RETURN,     /* arg: process address */
+  TRACE_PROCESS_POLL,       /* arg: process address */
+  TRACE_RTIMER_RUN,         /* arg: rtimer address */
+  TRACE_CSMA_QUEUE,         /* arg: neighbor queue length */
+  TRACE_CSMA_SEND,          /* arg: packets handed to the RDC layer */
+  TRACE_CSMA_SENT,          /* arg: MAC_TX_ status */
+  TRACE_USER = 128
+};
+
+struct trace_record {
+  uint16_t id;
+  uint16_t arg;
+  rtimer_clock_t time;
+};
+
+#if TRACE_ENABLED
+#define TRACE(id, arg) trace_add((id), (uint16_t)(arg))
+/* For pointer arguments: the low 16 bits of the address. */
+#define TRACE_PTR(id, ptr) trace_add((id), (uint16_t)(uintptr_t)(ptr))
+#else /* TRACE_ENABLED */
+#define TRACE(id, arg)
+#define TRACE_PTR(id, ptr)
+#endif /* TRACE_ENABLED */
+
+void trace_add(uint16_t id, uint16_t arg);
+
+/**
+ * Write the records in the ring buffer, oldest first, and empty it.
+ *
+ * The output starts with the bytes 'T' 'R', the number of records
+ * (16 bits), the size of a time stamp in bytes (8 bits) and
+ * RTIMER_SECOND (32 bits). Each record follows as id, arg and time
+ * stamp. All values are little endian. Tracepoints are ignored while
+ * the buffer is written.
+ *
+ * \param write_byte A function that writes a byte, such as
+ *                   slip_arch_writeb() or a serial output function.
+ */
+void trace_dump(void (* write_byte)(unsigned char c));
+
+#endif /* __TRACE_H__ */
@@ -160,4 +160,7 @@ typedef unsigned short uip_stats_t;
 #define cfs_remove   remove
 #endif /* WITH_PFS */
 
+/* 16-bit loads and stores are not atomic, see lib/ringbuf.h */
+#define RINGBUF_CONF_INDEX_T uint8_t
+
 #endif /* __6502DEF_H__ */
@@ -91,7 +91,8 @@ chksum(void) {
   asm("beq chksumlast");
 
 
-  /* If checksum is > 256, do the first runs. */
+  /* If checksum is > 256, do the first runs. Unrolled to four bytes
+     per iteration, which still divides a page evenly. */
   asm("ldy #0");
   asm("clc");
   asm("chksumloop_256:");
@@ -103,6 +104,14 @@ chksum(void) {
   asm("adc tmp1+1");
   asm("sta tmp1+1");
   asm("iny");
+  asm("lda (ptr1),y");
+  asm("adc tmp1");
+  asm("sta tmp1");
+  asm("iny");
+  asm("lda (ptr1),y");
+  asm("adc tmp1+1");
+  asm("sta tmp1+1");
+  asm("iny");
   asm("bne chksumloop_256");
   asm("inc ptr1+1");
   asm("dec _chksum_len+1");
@@ -134,28 +143,29 @@ chksum(void) {
   asm("noinc1:");
   asm("dec _chksum_len");
 
+  /* Walk the remaining words backwards. The loop test uses tya rather
+     than cpy so that the carry survives without going via the stack. */
   asm("chksum_noodd:");
   asm("clc");
-  asm("php");
   asm("ldy _chksum_len");
-  asm("chksum_loop1:");
-  asm("cpy #0");
   asm("beq chksum_loop1_end");
-  asm("plp");
-  asm("dey");
+  asm("chksum_loop1:");
   asm("dey");
   asm("lda (ptr1),y");
-  asm("adc tmp1");
-  asm("sta tmp1");
-  asm("iny");
-  asm("lda (ptr1),y");
   asm("adc tmp1+1");
   asm("sta tmp1+1");
   asm("dey");
-  asm("php");
-  asm("jmp chksum_loop1");
+  asm("lda (ptr1),y");
+  asm("adc tmp1");
+  asm("sta tmp1");
+  asm("tya");
+  asm("bne chksum_loop1");
   asm("chksum_loop1_end:");
-  asm("plp");
+  /* The last addition went into the low byte, so its carry belongs
+     to the high byte before the usual fold below. */
+  asm("lda tmp1+1");
+  asm("adc #0");
+  asm("sta tmp1+1");
   
   asm("chksum_endloop:");
   asm("lda tmp1");
@@ -261,24 +271,33 @@ transport_chksum(uint8_t protocol)
   asm("sta _chksum_len+1");
   
   
-  asm("ldy #$0c");
+  /* Add the source and destination addresses, unrolled so that the
+     carry does not have to be saved around a loop test. */
   asm("clc");
-  asm("php");
-  asm("tcpchksum_loop2:");
-  asm("plp");
-  asm("lda _uip_aligned_buf+%b,y", UIP_LLH_LEN);
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x0c);
   asm("adc _chksum_tmp");
   asm("sta _chksum_tmp");
-  asm("iny");
-  asm("lda _uip_aligned_buf+%b,y", UIP_LLH_LEN);
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x0d);
+  asm("adc _chksum_tmp+1");
+  asm("sta _chksum_tmp+1");
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x0e);
+  asm("adc _chksum_tmp");
+  asm("sta _chksum_tmp");
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x0f);
+  asm("adc _chksum_tmp+1");
+  asm("sta _chksum_tmp+1");
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x10);
+  asm("adc _chksum_tmp");
+  asm("sta _chksum_tmp");
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x11);
+  asm("adc _chksum_tmp+1");
+  asm("sta _chksum_tmp+1");
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x12);
+  asm("adc _chksum_tmp");
+  asm("sta _chksum_tmp");
+  asm("lda _uip_aligned_buf+%b", UIP_LLH_LEN + 0x13);
   asm("adc _chksum_tmp+1");
   asm("sta _chksum_tmp+1");
-  asm("iny");
-  asm("php");
-  asm("cpy #$14");
-  asm("bne tcpchksum_loop2");
-
-  asm("plp");
   
   asm("lda _chksum_tmp");
   asm("adc #0");
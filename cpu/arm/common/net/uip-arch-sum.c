@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Internet checksum for ARM Cortex-M3 and Cortex-M4, summing
+ *         32-bit words with the carry flag
+ */
+
+#include <stdint.h>
+
+#include "net/uip.h"
+#include "net/uip_arch.h"
+
+#if UIP_ARCH_SUM && defined(__GNUC__)
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_arch_sum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint32_t acc;
+  const uint32_t *w;
+  uint8_t odd;
+
+  /* The data is read as little-endian words from aligned addresses,
+     so each byte counts as the low half of a word if its address is
+     even and as the high half if it is odd. Starting at an even
+     address this gives the byte-swapped big-endian sum; starting at
+     an odd address it gives the big-endian sum itself. */
+  odd = (uintptr_t)data & 1;
+  acc = 0;
+  if(odd && len > 0) {
+    acc = (uint32_t)*data++ << 8;
+    --len;
+  }
+  if(((uintptr_t)data & 2) && len >= 2) {
+    acc += *(const uint16_t *)data;
+    data += 2;
+    len -= 2;
+  }
+
+  /* Add four words per iteration, feeding each carry into the next
+     addition and the last one back into the sum. */
+  w = (const uint32_t *)data;
+  for(; len >= 16; len -= 16, w += 4) {
+    __asm__("adds %0, %0, %1\n\t"
+            "adcs %0, %0, %2\n\t"
+            "adcs %0, %0, %3\n\t"
+            "adcs %0, %0, %4\n\t"
+            "adc  %0, %0, #0"
+            : "+r" (acc)
+            : "r" (w[0]), "r" (w[1]), "r" (w[2]), "r" (w[3])
+            : "cc");
+  }
+  for(; len >= 4; len -= 4, ++w) {
+    __asm__("adds %0, %0, %1\n\t"
+            "adc  %0, %0, #0"
+            : "+r" (acc)
+            : "r" (*w)
+            : "cc");
+  }
+  data = (const uint8_t *)w;
+
+  acc = (acc & 0xffff) + (acc >> 16);
+  if(len >= 2) {
+    acc += *(const uint16_t *)data;
+    data += 2;
+    len -= 2;
+  }
+  if(len > 0) {
+    acc += *data;
+  }
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
+
+  if(!odd) {
+    acc = ((acc & 0xff) << 8) | (acc >> 8);
+  }
+
+  acc += sum;
+  acc = (acc & 0xffff) + (acc >> 16);
+  return (uint16_t)acc;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_ARCH_SUM && defined(__GNUC__) */
@@ -60,4 +60,7 @@ typedef unsigned char spl_t;
 static inline void splx(spl_t s) { SREG = s; }
 static inline spl_t splhigh(void) { spl_t s = SREG; cli(); return s; }
 
+/* 16-bit loads and stores are not atomic, see lib/ringbuf.h */
+#define RINGBUF_CONF_INDEX_T uint8_t
+
 #endif /* AVRDEF_H */
@@ -68,4 +68,11 @@
 #endif
 
 void rtimer_arch_sleep(rtimer_clock_t howlong);
+
+/* Interrupt masking for the rtimer queue (RTIMER_CONF_QUEUE) */
+#include "avrdef.h"
+typedef spl_t rtimer_arch_irq_t;
+#define rtimer_arch_irq_disable() splhigh()
+#define rtimer_arch_irq_restore(s) splx(s)
+
 #endif /* __RTIMER_ARCH_H__ */
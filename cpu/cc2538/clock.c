@@ -39,6 +39,11 @@
  * To implement the clock functionality, we use the SysTick peripheral on the
  * cortex-M3. We run the system clock at 16 MHz and we set the SysTick to give
  * us 128 interrupts / sec
+ *
+ * With CLOCK_CONF_TICKLESS the SysTick interrupt is left disabled. Instead,
+ * clock_time() is derived from the free-running 32 kHz Sleep Timer which also
+ * drives rtimers, and an rtimer task wakes the CPU up when the next etimer is
+ * due. lpm_enter() calls clock_update_wakeup() before going to sleep.
  * @{
  *
  * \file
@@ -52,6 +57,8 @@
 #include "dev/sys-ctrl.h"
 
 #include "sys/energest.h"
+#include "sys/etimer.h"
+#include "sys/rtimer.h"
 
 #include <stdint.h>
 /*---------------------------------------------------------------------------*/
@@ -61,6 +68,113 @@ static volatile clock_time_t count;
 static volatile unsigned long secs = 0;
 static volatile uint8_t second_countdown = CLOCK_SECOND;
 /*---------------------------------------------------------------------------*/
+#ifdef CLOCK_CONF_TICKLESS
+#define CLOCK_TICKLESS CLOCK_CONF_TICKLESS
+#else
+#define CLOCK_TICKLESS 0
+#endif
+
+#if CLOCK_TICKLESS
+#if !RTIMER_QUEUE
+/* The wake-up task is pending alongside the MAC's rtimer tasks */
+#error CLOCK_CONF_TICKLESS needs RTIMER_CONF_QUEUE
+#endif
+/*
+ * Longest time we leave the CPU asleep without an etimer to serve. The
+ * wake-up keeps the software extension of the 32-bit Sleep Timer current,
+ * so it must be well below the 36 h wrap-around period.
+ */
+#ifdef CLOCK_CONF_TICKLESS_MAX_SLEEP
+#define TICKLESS_MAX_SLEEP CLOCK_CONF_TICKLESS_MAX_SLEEP
+#else
+#define TICKLESS_MAX_SLEEP (3600UL * CLOCK_SECOND)
+#endif
+
+#define RTIMER_CLOCK_TICK_RATIO (RTIMER_SECOND / CLOCK_SECOND)
+#define MAX_TICKS (~((clock_time_t)0) / 2)
+
+/* Upper 32 bits of the Sleep Timer and its value when last read */
+static uint32_t rt_high;
+static rtimer_clock_t rt_last;
+static volatile unsigned long secs_offset;
+
+static struct rtimer wakeup_task;
+static rtimer_clock_t wakeup_at;
+static uint8_t wakeup_armed;
+/*---------------------------------------------------------------------------*/
+static uint64_t
+sleep_timer_now(void)
+{
+  rtimer_clock_t now;
+  unsigned long primask;
+  uint64_t t;
+
+  primask = INTERRUPTS_DISABLE();
+  now = RTIMER_NOW();
+  if(now < rt_last) {
+    rt_high++;
+  }
+  rt_last = now;
+  t = ((uint64_t)rt_high << 32) | now;
+  if(!primask) {
+    INTERRUPTS_ENABLE();
+  }
+  return t;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wakeup(struct rtimer *rt, void *ptr)
+{
+  wakeup_armed = 0;
+  if(etimer_pending() &&
+     (etimer_next_expiration_time() - clock_time() - 1) > MAX_TICKS) {
+    etimer_request_poll();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Schedule the next wake-up for the earliest etimer expiration
+ *
+ * Called by lpm_enter() before putting the CPU to sleep. If an etimer has
+ * already expired, the etimer process is polled instead and the caller will
+ * see a pending event.
+ */
+void
+clock_update_wakeup(void)
+{
+  clock_time_t now, next;
+  rtimer_clock_t at;
+  unsigned long primask;
+
+  now = clock_time();
+  next = now + TICKLESS_MAX_SLEEP;
+  if(etimer_pending()) {
+    next = etimer_next_expiration_time();
+    if((next - now - 1) > MAX_TICKS) {
+      etimer_request_poll();
+      return;
+    }
+    if(next - now > TICKLESS_MAX_SLEEP) {
+      next = now + TICKLESS_MAX_SLEEP;
+    }
+  }
+
+  /* Clock ticks are aligned to multiples of the ratio on the Sleep Timer */
+  at = (rtimer_clock_t)(next * RTIMER_CLOCK_TICK_RATIO);
+
+  primask = INTERRUPTS_DISABLE();
+  if(!wakeup_armed || at != wakeup_at) {
+    if(rtimer_set(&wakeup_task, at, 1, wakeup, NULL) == RTIMER_OK) {
+      wakeup_at = at;
+      wakeup_armed = 1;
+    }
+  }
+  if(!primask) {
+    INTERRUPTS_ENABLE();
+  }
+}
+#endif /* CLOCK_TICKLESS */
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Arch-specific implementation of clock_init for the cc2538
  *
@@ -82,8 +196,10 @@ clock_init(void)
   /* System clock source, Enable */
   REG(SYSTICK_STCTRL) |= SYSTICK_STCTRL_CLK_SRC | SYSTICK_STCTRL_ENABLE;
 
+#if !CLOCK_TICKLESS
   /* Enable the SysTick Interrupt */
   REG(SYSTICK_STCTRL) |= SYSTICK_STCTRL_INTEN;
+#endif
 
   /*
    * Remove the clock gate to enable GPT0 and then initialise it
@@ -109,19 +225,31 @@ clock_init(void)
 CCIF clock_time_t
 clock_time(void)
 {
+#if CLOCK_TICKLESS
+  return (clock_time_t)(sleep_timer_now() / RTIMER_CLOCK_TICK_RATIO);
+#else
   return count;
+#endif
 }
 /*---------------------------------------------------------------------------*/
 void
 clock_set_seconds(unsigned long sec)
 {
+#if CLOCK_TICKLESS
+  secs_offset = sec - (unsigned long)(sleep_timer_now() / RTIMER_SECOND);
+#else
   secs = sec;
+#endif
 }
 /*---------------------------------------------------------------------------*/
 CCIF unsigned long
 clock_seconds(void)
 {
+#if CLOCK_TICKLESS
+  return (unsigned long)(sleep_timer_now() / RTIMER_SECOND) + secs_offset;
+#else
   return secs;
+#endif
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -171,10 +299,17 @@ clock_delay(unsigned int i)
  *
  * \note This function is only meant to be used by lpm_exit(). Applications
  * should really avoid calling this
+ *
+ * \note In tickless mode the clock is derived from the Sleep Timer, which
+ * keeps running in PM1/2, so there is nothing to adjust
  */
 void
 clock_adjust(clock_time_t ticks)
 {
+#if CLOCK_TICKLESS
+  return;
+#endif
+
   /* Halt the SysTick while adjusting */
   REG(SYSTICK_STCTRL) &= ~SYSTICK_STCTRL_ENABLE;
 
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2013, Texas Instruments Incorporated - http://www.ti.com/
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \addtogroup cc2538-adc-sampler
+ * @{
+ *
+ * \file
+ * Implementation of the cc2538 ADC block sampler
+ */
+#include "contiki.h"
+#include "dev/adc-sampler.h"
+#include "dev/soc-adc.h"
+#include "dev/gptimer.h"
+#include "dev/sys-ctrl.h"
+#include "dev/ioc.h"
+#include "dev/gpio.h"
+#include "dev/udma.h"
+#include "lpm.h"
+#include "reg.h"
+
+#include <stdint.h>
+
+#if ADC_SAMPLER_CONF_ENABLE
+/*---------------------------------------------------------------------------*/
+#if !defined(UDMA_CONF_MAX_ALT_CHANNEL) || \
+  UDMA_CONF_MAX_ALT_CHANNEL < ADC_SAMPLER_DMA_CHAN
+#error "The ADC sampler needs the uDMA alternate structure of its channel"
+#endif
+
+#if ADC_SAMPLER_AIN > 7
+#error "ADC_SAMPLER_CONF_AIN must be in [0, 7]"
+#endif
+
+#define DMA_ENC   (ADC_SAMPLER_AIN < 4 ? 0x00 : 0x01)
+
+#define DMA_FLAGS (UDMA_CHCTL_ARBSIZE_1 | UDMA_CHCTL_XFERMODE_PINGPONG \
+    | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_DSTSIZE_8 \
+    | UDMA_CHCTL_SRCINC_NONE | UDMA_CHCTL_DSTINC_8)
+
+/* The largest uDMA transfer */
+#define DMA_MAX_LEN 1024
+
+/* GPT1 counts the 16 MHz system clock */
+#define TIMER_CLOCK 16000000UL
+
+static uint8_t *buf;
+static uint16_t len;
+static uint8_t decimation;
+static int16_t *out;
+static adc_sampler_callback_t callback;
+static clock_time_t check_interval;
+
+/* The buffer half the uDMA completes next, 0: primary, 1: alternate */
+static uint8_t next;
+static uint16_t overruns;
+static uint8_t running;
+
+PROCESS(adc_sampler_process, "ADC sampler");
+/*---------------------------------------------------------------------------*/
+static void
+arm(uint8_t half)
+{
+  uint32_t dst = (uint32_t)&buf[half * len + len - 1];
+  uint32_t ctrl = DMA_FLAGS | udma_xfer_size(len);
+
+  if(half) {
+    udma_set_alt_channel(ADC_SAMPLER_DMA_CHAN, SOC_ADC_ADCH, dst, ctrl);
+  } else {
+    udma_set_channel_src(ADC_SAMPLER_DMA_CHAN, SOC_ADC_ADCH);
+    udma_set_channel_dst(ADC_SAMPLER_DMA_CHAN, dst);
+    udma_set_channel_control_word(ADC_SAMPLER_DMA_CHAN, ctrl);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+completed(uint8_t half)
+{
+  if(half) {
+    return udma_channel_get_alt_remaining(ADC_SAMPLER_DMA_CHAN) == 0;
+  }
+  return udma_channel_get_remaining(ADC_SAMPLER_DMA_CHAN) == 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Average each run of 'decimation' results into one Q8 fixed point sample */
+static void
+decimate(const int8_t *in)
+{
+  uint16_t i;
+  uint8_t j;
+  int32_t sum;
+
+  for(i = 0; i < len / decimation; i++) {
+    sum = 0;
+    for(j = 0; j < decimation; j++) {
+      sum += *in++;
+    }
+    out[i] = (int16_t)(sum * 256 / decimation);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(void)
+{
+  while(completed(next)) {
+    decimate((const int8_t *)&buf[next * len]);
+    arm(next);
+    next ^= 1;
+    callback(out, len / decimation);
+    if(!running) {
+      /* The callback stopped us */
+      return;
+    }
+  }
+
+  /*
+   * The uDMA disables the channel when it switches to a structure that has
+   * not been re-armed yet. Both halves are armed again by now, so resume
+   */
+  if(!(REG(UDMA_ENASET) & (1 << ADC_SAMPLER_DMA_CHAN))) {
+    overruns++;
+    udma_channel_enable(ADC_SAMPLER_DMA_CHAN);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(adc_sampler_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  /* Check at twice the block rate, so no half is completed twice unseen */
+  etimer_set(&et, check_interval);
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+    deliver();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+int
+adc_sampler_start(uint32_t rate, uint8_t *buffer, uint16_t length,
+                  uint8_t dec, int16_t *output,
+                  adc_sampler_callback_t cb)
+{
+  if(rate == 0 || rate > TIMER_CLOCK || length == 0 || length > DMA_MAX_LEN
+     || dec == 0 || length % dec || cb == NULL) {
+    return ADC_SAMPLER_ERR;
+  }
+
+  check_interval = (clock_time_t)(((uint32_t)length * CLOCK_SECOND)
+                                  / (2 * rate));
+  if(check_interval == 0) {
+    return ADC_SAMPLER_ERR;
+  }
+
+  adc_sampler_stop();
+
+  buf = buffer;
+  len = length;
+  decimation = dec;
+  out = output;
+  callback = cb;
+  next = 0;
+  overruns = 0;
+
+  /* The AIN pin is an analog input without pulls */
+  GPIO_SOFTWARE_CONTROL(GPIO_A_BASE, GPIO_PIN_MASK(ADC_SAMPLER_AIN));
+  GPIO_SET_INPUT(GPIO_A_BASE, GPIO_PIN_MASK(ADC_SAMPLER_AIN));
+  ioc_set_over(GPIO_A_NUM, ADC_SAMPLER_AIN, IOC_OVERRIDE_ANA);
+
+  /* Sequence from AIN0 up to our pin, started by the timer */
+  REG(SOC_ADC_ADCCON2) = ADC_SAMPLER_SDIV | ADC_SAMPLER_AIN;
+  REG(SOC_ADC_ADCCON1) = (REG(SOC_ADC_ADCCON1) & ~SOC_ADC_ADCCON1_STSEL)
+    | SOC_ADC_ADCCON1_STSEL_TIMER;
+
+  udma_set_channel_assignment(ADC_SAMPLER_DMA_CHAN, DMA_ENC);
+  udma_channel_use_primary(ADC_SAMPLER_DMA_CHAN);
+  udma_channel_use_single(ADC_SAMPLER_DMA_CHAN);
+  udma_channel_mask_clr(ADC_SAMPLER_DMA_CHAN);
+  arm(0);
+  arm(1);
+  udma_channel_enable(ADC_SAMPLER_DMA_CHAN);
+
+  /* GPT1 timer A: 32-bit periodic, its time-out triggers the ADC */
+  REG(SYS_CTRL_RCGCGPT) |= SYS_CTRL_RCGCGPT_GPT1;
+  REG(SYS_CTRL_SCGCGPT) |= SYS_CTRL_SCGCGPT_GPT1;
+  REG(GPT_1_BASE | GPTIMER_CTL) = 0;
+  REG(GPT_1_BASE | GPTIMER_CFG) = 0;
+  REG(GPT_1_BASE | GPTIMER_TAMR) = GPTIMER_TAMR_TAMR_PERIODIC;
+  REG(GPT_1_BASE | GPTIMER_TAILR) = TIMER_CLOCK / rate - 1;
+
+  /* The timer, ADC and uDMA stop in PM1 and PM2 */
+  lpm_hold(LPM_PM0);
+
+  REG(GPT_1_BASE | GPTIMER_CTL) = GPTIMER_CTL_TAOTE | GPTIMER_CTL_TAEN;
+
+  running = 1;
+  process_start(&adc_sampler_process, NULL);
+
+  return ADC_SAMPLER_SUCCESS;
+}
+/*---------------------------------------------------------------------------*/
+void
+adc_sampler_stop(void)
+{
+  if(!running) {
+    return;
+  }
+
+  running = 0;
+  process_exit(&adc_sampler_process);
+
+  REG(GPT_1_BASE | GPTIMER_CTL) = 0;
+  REG(SYS_CTRL_SCGCGPT) &= ~SYS_CTRL_SCGCGPT_GPT1;
+  REG(SYS_CTRL_RCGCGPT) &= ~SYS_CTRL_RCGCGPT_GPT1;
+
+  udma_channel_disable(ADC_SAMPLER_DMA_CHAN);
+  udma_channel_mask_set(ADC_SAMPLER_DMA_CHAN);
+
+  /* Back to conversions started by software */
+  REG(SOC_ADC_ADCCON1) |= SOC_ADC_ADCCON1_STSEL_ST;
+
+  lpm_release(LPM_PM0);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+adc_sampler_overruns(void)
+{
+  return overruns;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* ADC_SAMPLER_CONF_ENABLE */
+
+/** @} */
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2013, Texas Instruments Incorporated - http://www.ti.com/
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \addtogroup cc2538
+ * @{
+ *
+ * \defgroup cc2538-adc-sampler cc2538 ADC block sampler
+ *
+ * Timer-triggered ADC acquisition into double buffers over the uDMA
+ *
+ * GPT1 timer A triggers an ADC conversion sequence at a fixed rate and the
+ * uDMA moves each result into one half of a caller supplied buffer, switching
+ * to the other half in ping-pong mode when one is full. No interrupt is taken
+ * per sample: a process checks the buffer halves once per half block period,
+ * reduces each completed half by the decimation factor and hands the result
+ * to a callback. Between blocks the CPU sleeps in PM0 with the timer, ADC and
+ * uDMA running.
+ *
+ * Only the most significant byte of each conversion is transferred. Each
+ * output sample is the average of \e decimation of these bytes, scaled to a
+ * signed 16-bit fixed point value (the 8-bit result in the upper byte), so
+ * averaging adds resolution in the lower byte.
+ *
+ * The driver is built with ADC_SAMPLER_CONF_ENABLE. The AIN pin is chosen at
+ * compile time with ADC_SAMPLER_CONF_AIN, because it determines the uDMA
+ * channel (see the platform's uDMA channel allocations).
+ * The conversion sequence runs from AIN0 up to the sampled pin, so the rate
+ * must leave time for all of those conversions.
+ * @{
+ *
+ * \file
+ * Header file for the cc2538 ADC block sampler
+ */
+#ifndef ADC_SAMPLER_H_
+#define ADC_SAMPLER_H_
+
+#include "contiki.h"
+
+#include <stdint.h>
+/*---------------------------------------------------------------------------*/
+/** \name ADC sampler configuration
+ * @{
+ */
+#define ADC_SAMPLER_AIN       ADC_SAMPLER_CONF_AIN
+#define ADC_SAMPLER_DMA_CHAN  ADC_SAMPLER_CONF_DMA_CHAN
+
+/* Conversion decimation rate, one of SOC_ADC_ADCCON2_SDIV_xyz */
+#ifdef ADC_SAMPLER_CONF_SDIV
+#define ADC_SAMPLER_SDIV ADC_SAMPLER_CONF_SDIV
+#else
+#define ADC_SAMPLER_SDIV SOC_ADC_ADCCON2_SDIV_64
+#endif
+/** @} */
+/*---------------------------------------------------------------------------*/
+/** \name ADC sampler return values
+ * @{
+ */
+#define ADC_SAMPLER_SUCCESS   0
+#define ADC_SAMPLER_ERR      -1
+/** @} */
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Block callback type
+ * \param block The decimated samples of the block
+ * \param len The number of samples in \e block
+ *
+ * Called from the sampler's process. \e block is only valid until the
+ * callback returns, since it is overwritten by the next block
+ */
+typedef void (*adc_sampler_callback_t)(const int16_t *block, uint16_t len);
+
+/**
+ * \brief Start sampling
+ * \param rate The sample rate in Hz, before decimation
+ * \param buf Buffer of 2 * \e len bytes, filled by the uDMA
+ * \param len The number of samples per block, at most 1024
+ * \param decimation The number of samples averaged into each output sample
+ * \param out Buffer of \e len / \e decimation output samples
+ * \param callback Called with \e out once a block has been decimated
+ * \return ADC_SAMPLER_SUCCESS or ADC_SAMPLER_ERR
+ *
+ * \e len must be a multiple of \e decimation, and a block must last at least
+ * two clock ticks. The buffers must remain valid until adc_sampler_stop()
+ */
+int adc_sampler_start(uint32_t rate, uint8_t *buf, uint16_t len,
+                      uint8_t decimation, int16_t *out,
+                      adc_sampler_callback_t callback);
+
+/**
+ * \brief Stop sampling
+ *
+ * Blocks in progress are discarded
+ */
+void adc_sampler_stop(void);
+
+/**
+ * \brief Retrieve the number of blocks lost since adc_sampler_start()
+ * \return The number of times the uDMA ran out of free buffer halves
+ *
+ * A block is lost when the callback of the previous one does not return
+ * before the next one completes
+ */
+uint16_t adc_sampler_overruns(void);
+
+#endif /* ADC_SAMPLER_H_ */
+
+/**
+ * @}
+ * @}
+ */
@@ -59,6 +59,11 @@
     | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_DSTSIZE_8 \
     | UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_DSTINC_NONE)
 
+/* Flags of the scatter-gather TX tasks, the mode depends on the task */
+#define UDMA_TX_SG_FLAGS (UDMA_CHCTL_ARBSIZE_128 \
+    | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_DSTSIZE_8 \
+    | UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_DSTINC_NONE)
+
 #define UDMA_RX_FLAGS (UDMA_CHCTL_ARBSIZE_128 | UDMA_CHCTL_XFERMODE_AUTO \
     | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_DSTSIZE_8 \
     | UDMA_CHCTL_SRCINC_NONE | UDMA_CHCTL_DSTINC_8)
@@ -68,6 +73,23 @@
  * if its size is above this threshold
  */
 #define UDMA_RX_SIZE_THRESHOLD 3
+
+/*
+ * The largest number of buffers that prepare_v() streams to the TX FIFO
+ * with a single scatter-gather uDMA transfer. More buffers are streamed
+ * one after the other
+ */
+#define UDMA_TX_SG_TASKS 4
+
+#if CC2538_RF_CONF_TX_USE_SG_DMA && defined(UDMA_CONF_MAX_ALT_CHANNEL)
+#define TX_USE_SG_DMA 1
+#else
+#define TX_USE_SG_DMA 0
+#endif
+
+#if TX_USE_SG_DMA
+static struct udma_sg_task tx_tasks[UDMA_TX_SG_TASKS];
+#endif
 /*---------------------------------------------------------------------------*/
 #include <stdio.h>
 #define DEBUG 0
@@ -344,10 +366,73 @@ init(void)
   return 1;
 }
 /*---------------------------------------------------------------------------*/
+static void
+tx_dma(const void *payload, unsigned short payload_len)
+{
+#if TX_USE_SG_DMA
+  /* A scatter-gather transfer leaves the channel on its alternate structure
+   * and its primary destination pointing to it */
+  udma_channel_use_primary(CC2538_RF_CONF_TX_DMA_CHAN);
+  udma_set_channel_dst(CC2538_RF_CONF_TX_DMA_CHAN, RFCORE_SFR_RFDATA);
+#endif
+
+  /* Set the transfer source's end address */
+  udma_set_channel_src(CC2538_RF_CONF_TX_DMA_CHAN,
+                       (uint32_t)(payload) + payload_len - 1);
+
+  /* Configure the control word */
+  udma_set_channel_control_word(CC2538_RF_CONF_TX_DMA_CHAN,
+                                UDMA_TX_FLAGS | udma_xfer_size(payload_len));
+
+  /* Enabled the RF TX uDMA channel */
+  udma_channel_enable(CC2538_RF_CONF_TX_DMA_CHAN);
+
+  /* Trigger the uDMA transfer */
+  udma_channel_sw_request(CC2538_RF_CONF_TX_DMA_CHAN);
+}
+/*---------------------------------------------------------------------------*/
+#if TX_USE_SG_DMA
+static void
+tx_dma_sg(const struct radio_iovec *iov, unsigned char iovcnt)
+{
+  uint8_t i, n;
+
+  n = 0;
+  for(i = 0; i < iovcnt; i++) {
+    if(iov[i].len > 0) {
+      tx_tasks[n].src_end_ptr = (uint32_t)(iov[i].ptr) + iov[i].len - 1;
+      tx_tasks[n].dst_end_ptr = RFCORE_SFR_RFDATA;
+      tx_tasks[n].ctrl_word = UDMA_TX_SG_FLAGS | udma_xfer_size(iov[i].len)
+        | UDMA_CHCTL_XFERMODE_MEM_SGA;
+      n++;
+    }
+  }
+
+  /* The last task ends the transfer */
+  tx_tasks[n - 1].ctrl_word = (tx_tasks[n - 1].ctrl_word & ~0x07)
+    | UDMA_CHCTL_XFERMODE_AUTO;
+
+  udma_channel_use_primary(CC2538_RF_CONF_TX_DMA_CHAN);
+  udma_set_channel_sg(CC2538_RF_CONF_TX_DMA_CHAN, tx_tasks, n);
+  udma_channel_enable(CC2538_RF_CONF_TX_DMA_CHAN);
+  udma_channel_sw_request(CC2538_RF_CONF_TX_DMA_CHAN);
+}
+#endif
+/*---------------------------------------------------------------------------*/
 static int
-prepare(const void *payload, unsigned short payload_len)
+prepare_v(const struct radio_iovec *iov, unsigned char iovcnt)
 {
-  uint8_t i;
+  uint8_t i, j, n;
+  unsigned short payload_len;
+
+  payload_len = 0;
+  n = 0;
+  for(i = 0; i < iovcnt; i++) {
+    payload_len += iov[i].len;
+    if(iov[i].len > 0) {
+      n++;
+    }
+  }
 
   PRINTF("RF: Prepare 0x%02x bytes\n", payload_len + CHECKSUM_LEN);
 
@@ -367,22 +452,25 @@ prepare(const void *payload, unsigned short payload_len)
   /* Send the phy length byte first */
   REG(RFCORE_SFR_RFDATA) = payload_len + CHECKSUM_LEN;
 
-  if(CC2538_RF_CONF_TX_USE_DMA) {
+  if(CC2538_RF_CONF_TX_USE_DMA && n > 0) {
     PRINTF("<uDMA payload>");
 
-    /* Set the transfer source's end address */
-    udma_set_channel_src(CC2538_RF_CONF_TX_DMA_CHAN,
-                         (uint32_t)(payload) + payload_len - 1);
-
-    /* Configure the control word */
-    udma_set_channel_control_word(CC2538_RF_CONF_TX_DMA_CHAN,
-                                  UDMA_TX_FLAGS | udma_xfer_size(payload_len));
-
-    /* Enabled the RF TX uDMA channel */
-    udma_channel_enable(CC2538_RF_CONF_TX_DMA_CHAN);
+#if TX_USE_SG_DMA
+    if(n > 1 && n <= UDMA_TX_SG_TASKS) {
+      tx_dma_sg(iov, iovcnt);
+      n = 0;
+    }
+#endif
 
-    /* Trigger the uDMA transfer */
-    udma_channel_sw_request(CC2538_RF_CONF_TX_DMA_CHAN);
+    for(i = 0; i < iovcnt && n > 0; i++) {
+      if(iov[i].len > 0) {
+        tx_dma(iov[i].ptr, iov[i].len);
+        if(--n > 0) {
+          /* The next buffer must wait for this one to be in the FIFO */
+          while(udma_channel_get_mode(CC2538_RF_CONF_TX_DMA_CHAN));
+        }
+      }
+    }
 
     /*
      * No need to wait for this to end. Even if transmit() gets called
@@ -390,9 +478,11 @@ prepare(const void *payload, unsigned short payload_len)
      * faster than transmit() can empty it
      */
   } else {
-    for(i = 0; i < payload_len; i++) {
-      REG(RFCORE_SFR_RFDATA) = ((unsigned char *)(payload))[i];
-      PRINTF("%02x", ((unsigned char *)(payload))[i]);
+    for(j = 0; j < iovcnt; j++) {
+      for(i = 0; i < iov[j].len; i++) {
+        REG(RFCORE_SFR_RFDATA) = ((unsigned char *)(iov[j].ptr))[i];
+        PRINTF("%02x", ((unsigned char *)(iov[j].ptr))[i]);
+      }
     }
   }
   PRINTF("\n");
@@ -401,6 +491,16 @@ prepare(const void *payload, unsigned short payload_len)
 }
 /*---------------------------------------------------------------------------*/
 static int
+prepare(const void *payload, unsigned short payload_len)
+{
+  struct radio_iovec iov;
+
+  iov.ptr = payload;
+  iov.len = payload_len;
+  return prepare_v(&iov, 1);
+}
+/*---------------------------------------------------------------------------*/
+static int
 transmit(unsigned short transmit_len)
 {
   uint8_t counter;
@@ -624,6 +724,7 @@ const struct radio_driver cc2538_rf_driver = {
   pending_packet,
   on,
   off,
+  prepare_v,
 };
 /*---------------------------------------------------------------------------*/
 /**
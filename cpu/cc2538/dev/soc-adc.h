@@ -65,6 +65,11 @@
 #define SOC_ADC_ADCCON1_RCTRL   0x0000000C /**< Controls the 16-bit RNG */
 #define SOC_ADC_ADCCON1_RCTRL1  0x00000008 /**< RCTRL high bit */
 #define SOC_ADC_ADCCON1_RCTRL0  0x00000004 /**< RCTRL low bit */
+
+#define SOC_ADC_ADCCON1_STSEL_EXT   0x00000000 /**< Start on PD0 pin edge */
+#define SOC_ADC_ADCCON1_STSEL_FULL  0x00000010 /**< Full speed */
+#define SOC_ADC_ADCCON1_STSEL_TIMER 0x00000020 /**< Start on timer trigger */
+#define SOC_ADC_ADCCON1_STSEL_ST    0x00000030 /**< Start on ADCCON1.ST */
 /** @} */
 /*---------------------------------------------------------------------------*/
 /** \name SOC_ADC_ADCCON2 register bit masks
@@ -73,6 +78,11 @@
 #define SOC_ADC_ADCCON2_SREF    0x000000C0 /**< Reference voltage for sequence */
 #define SOC_ADC_ADCCON2_SDIV    0x00000030 /**< Decimation rate for sequence */
 #define SOC_ADC_ADCCON2_SCH     0x0000000F /**< Sequence channel select */
+
+#define SOC_ADC_ADCCON2_SDIV_64  0x00000000 /**< 64 decimation rate (7 bits) */
+#define SOC_ADC_ADCCON2_SDIV_128 0x00000010 /**< 128 decimation rate (9 bits) */
+#define SOC_ADC_ADCCON2_SDIV_256 0x00000020 /**< 256 decimation rate (10 bits) */
+#define SOC_ADC_ADCCON2_SDIV_512 0x00000030 /**< 512 decimation rate (12 bits) */
 /** @} */
 /*---------------------------------------------------------------------------*/
 /** \name SOC_ADC_ADCCON3 register bit masks
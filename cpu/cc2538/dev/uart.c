@@ -41,12 +41,14 @@
 #include "dev/ioc.h"
 #include "dev/gpio.h"
 #include "dev/uart.h"
+#include "dev/udma.h"
 #include "reg.h"
 
 #include <stdint.h>
 #include <string.h>
 
 static int (* input_handler)(unsigned char c);
+static int (* block_input_handler)(const uint8_t *data, int len);
 /*---------------------------------------------------------------------------*/
 /*
  * Once we know what UART we're on, configure correct values to be written to
@@ -72,6 +74,140 @@ static int (* input_handler)(unsigned char c);
 #define IOC_UARTRXD_UART       IOC_UARTRXD_UART0
 #endif
 /*---------------------------------------------------------------------------*/
+#if UART_CONF_USE_DMA
+/*
+ * RX: the uDMA moves the RX FIFO contents into two buffers in ping-pong mode,
+ * eight bytes at a time (burst requests only, matching the 1/2 FIFO level).
+ * Whatever is left in the FIFO when the line goes idle is picked up by the
+ * RX timeout interrupt. TX: uart_write() hands whole blocks to the uDMA
+ */
+#if UART_CONF_RX_DMA_CHAN != 8 || UART_CONF_TX_DMA_CHAN != 9
+#error "The UART uDMA triggers are on channels 8 (RX) and 9 (TX)"
+#endif
+
+#if UART_BASE==UART_1_BASE
+#define RX_DMA_ENC             UDMA_CH8_UART1RX
+#define TX_DMA_ENC             UDMA_CH9_UART1TX
+#else
+#define RX_DMA_ENC             UDMA_CH8_UART0RX
+#define TX_DMA_ENC             UDMA_CH9_UART0TX
+#endif
+
+#ifdef UART_CONF_RX_DMA_BUFSIZE
+#define RX_DMA_BUFSIZE UART_CONF_RX_DMA_BUFSIZE
+#else
+#define RX_DMA_BUFSIZE 64
+#endif
+
+#if RX_DMA_BUFSIZE % 8
+#error "UART_CONF_RX_DMA_BUFSIZE must be a multiple of the 8 byte burst"
+#endif
+
+#define RX_DMA_FLAGS (UDMA_CHCTL_ARBSIZE_8 | UDMA_CHCTL_XFERMODE_PINGPONG \
+    | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_DSTSIZE_8 \
+    | UDMA_CHCTL_SRCINC_NONE | UDMA_CHCTL_DSTINC_8)
+
+#define TX_DMA_FLAGS (UDMA_CHCTL_ARBSIZE_4 | UDMA_CHCTL_XFERMODE_BASIC \
+    | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_DSTSIZE_8 \
+    | UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_DSTINC_NONE)
+
+/* The largest uDMA transfer */
+#define TX_DMA_MAX_LEN 1024
+
+static uint8_t rx_dma_buf[2][RX_DMA_BUFSIZE];
+static uint8_t rx_active;      /* 0: primary structure, 1: alternate */
+static uint16_t rx_done;       /* Bytes of the active buffer handed over */
+#endif /* UART_CONF_USE_DMA */
+/*---------------------------------------------------------------------------*/
+static void
+deliver(const uint8_t *data, int len)
+{
+  if(block_input_handler != NULL) {
+    block_input_handler(data, len);
+  } else if(input_handler != NULL) {
+    while(len-- > 0) {
+      input_handler(*data++);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if UART_CONF_USE_DMA
+static void
+rx_dma_arm(uint8_t alt)
+{
+  uint32_t dst = (uint32_t)&rx_dma_buf[alt][RX_DMA_BUFSIZE - 1];
+  uint32_t ctrl = RX_DMA_FLAGS | udma_xfer_size(RX_DMA_BUFSIZE);
+
+  if(alt) {
+    udma_set_alt_channel(UART_CONF_RX_DMA_CHAN, UART_BASE | UART_DR, dst, ctrl);
+  } else {
+    udma_set_channel_src(UART_CONF_RX_DMA_CHAN, UART_BASE | UART_DR);
+    udma_set_channel_dst(UART_CONF_RX_DMA_CHAN, dst);
+    udma_set_channel_control_word(UART_CONF_RX_DMA_CHAN, ctrl);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Hand over the buffers the uDMA has filled and what it has written to the
+ * active one so far */
+static void
+rx_dma_poll(void)
+{
+  uint16_t written;
+
+  while(1) {
+    written = RX_DMA_BUFSIZE - (rx_active ?
+      udma_channel_get_alt_remaining(UART_CONF_RX_DMA_CHAN) :
+      udma_channel_get_remaining(UART_CONF_RX_DMA_CHAN));
+
+    if(written > rx_done) {
+      deliver(&rx_dma_buf[rx_active][rx_done], written - rx_done);
+      rx_done = written;
+    }
+
+    if(written < RX_DMA_BUFSIZE) {
+      break;
+    }
+
+    /* The uDMA has moved on to the other buffer: re-arm this one. If both
+     * filled up before we got here, the channel stopped and must be
+     * re-enabled */
+    rx_dma_arm(rx_active);
+    rx_active ^= 1;
+    rx_done = 0;
+    udma_channel_enable(UART_CONF_RX_DMA_CHAN);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+dma_init(void)
+{
+  udma_set_channel_assignment(UART_CONF_RX_DMA_CHAN, RX_DMA_ENC);
+  udma_set_channel_assignment(UART_CONF_TX_DMA_CHAN, TX_DMA_ENC);
+
+  udma_channel_use_primary(UART_CONF_RX_DMA_CHAN);
+  udma_channel_use_burst(UART_CONF_RX_DMA_CHAN);
+  udma_channel_mask_clr(UART_CONF_RX_DMA_CHAN);
+  rx_active = 0;
+  rx_done = 0;
+  rx_dma_arm(0);
+  rx_dma_arm(1);
+  udma_channel_enable(UART_CONF_RX_DMA_CHAN);
+
+  udma_channel_use_primary(UART_CONF_TX_DMA_CHAN);
+  udma_channel_mask_clr(UART_CONF_TX_DMA_CHAN);
+  udma_set_channel_dst(UART_CONF_TX_DMA_CHAN, UART_BASE | UART_DR);
+
+  REG(UART_BASE | UART_DMACTL) = UART_DMACTL_RXDMAE | UART_DMACTL_TXDMAE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tx_dma_wait(void)
+{
+  while(udma_channel_get_mode(UART_CONF_TX_DMA_CHAN)
+        != UDMA_CHCTL_XFERMODE_STOP);
+}
+#endif /* UART_CONF_USE_DMA */
+/*---------------------------------------------------------------------------*/
 static void
 reset(void)
 {
@@ -133,11 +269,21 @@ uart_init(void)
    * Acknowledge RX and RX Timeout
    * Acknowledge Framing, Overrun and Break Errors
    */
+#if UART_CONF_USE_DMA
+  /* The uDMA serves the RX FIFO level, we only need the RX timeout */
+  REG(UART_BASE | UART_IM) = UART_IM_RTIM;
+#else
   REG(UART_BASE | UART_IM) = UART_IM_RXIM | UART_IM_RTIM;
+#endif
   REG(UART_BASE | UART_IM) |= UART_IM_OEIM | UART_IM_BEIM | UART_IM_FEIM;
 
+#if UART_CONF_USE_DMA
+  REG(UART_BASE | UART_IFLS) =
+    UART_IFLS_RXIFLSEL_1_2 | UART_IFLS_TXIFLSEL_1_2;
+#else
   REG(UART_BASE | UART_IFLS) =
     UART_IFLS_RXIFLSEL_1_8 | UART_IFLS_TXIFLSEL_1_2;
+#endif
 
   /* Make sure the UART is disabled before trying to configure it */
   REG(UART_BASE | UART_CTL) = UART_CTL_TXE | UART_CTL_RXE;
@@ -149,6 +295,10 @@ uart_init(void)
   /* UART Control: 8N1 with FIFOs */
   REG(UART_BASE | UART_LCRH) = UART_LCRH_WLEN_8 | UART_LCRH_FEN;
 
+#if UART_CONF_USE_DMA
+  dma_init();
+#endif
+
   /* UART Enable */
   REG(UART_BASE | UART_CTL) |= UART_CTL_UARTEN;
 
@@ -163,8 +313,19 @@ uart_set_input(int (* input)(unsigned char c))
 }
 /*---------------------------------------------------------------------------*/
 void
+uart_set_block_input(int (* input)(const uint8_t *data, int len))
+{
+  block_input_handler = input;
+}
+/*---------------------------------------------------------------------------*/
+void
 uart_write_byte(uint8_t b)
 {
+#if UART_CONF_USE_DMA
+  /* Keep the byte behind a block that is still being sent */
+  tx_dma_wait();
+#endif
+
   /* Block if the TX FIFO is full */
   while(REG(UART_BASE | UART_FR) & UART_FR_TXFF);
 
@@ -172,9 +333,36 @@ uart_write_byte(uint8_t b)
 }
 /*---------------------------------------------------------------------------*/
 void
+uart_write(const uint8_t *data, uint16_t len)
+{
+#if UART_CONF_USE_DMA
+  uint16_t n;
+
+  while(len > 0) {
+    n = len > TX_DMA_MAX_LEN ? TX_DMA_MAX_LEN : len;
+
+    tx_dma_wait();
+    udma_set_channel_src(UART_CONF_TX_DMA_CHAN, (uint32_t)&data[n - 1]);
+    udma_set_channel_control_word(UART_CONF_TX_DMA_CHAN,
+                                  TX_DMA_FLAGS | udma_xfer_size(n));
+    udma_channel_enable(UART_CONF_TX_DMA_CHAN);
+
+    data += n;
+    len -= n;
+  }
+#else
+  while(len-- > 0) {
+    uart_write_byte(*data++);
+  }
+#endif
+}
+/*---------------------------------------------------------------------------*/
+void
 uart_isr(void)
 {
   uint16_t mis;
+  uint8_t buf[16];
+  unsigned int i;
 
   ENERGEST_ON(ENERGEST_TYPE_IRQ);
 
@@ -184,20 +372,47 @@ uart_isr(void)
 
   REG(UART_BASE | UART_ICR) = 0x0000FFBF;
 
+#if UART_CONF_USE_DMA
+  /* uDMA completions are signalled on the UART interrupt */
+  REG(UDMA_CHIS) = (1 << UART_CONF_RX_DMA_CHAN) | (1 << UART_CONF_TX_DMA_CHAN);
+
+  if(mis & UART_MIS_RTMIS) {
+    /* The line went idle with less than a burst left in the FIFO. Stop the
+     * uDMA while we take the rest, so that bytes are delivered in order */
+    REG(UART_BASE | UART_DMACTL) &= ~UART_DMACTL_RXDMAE;
+    rx_dma_poll();
+    while(!(REG(UART_BASE | UART_FR) & UART_FR_RXFE)) {
+      i = 0;
+      while(i < sizeof(buf) && !(REG(UART_BASE | UART_FR) & UART_FR_RXFE)) {
+        buf[i++] = REG(UART_BASE | UART_DR) & 0xFF;
+      }
+      deliver(buf, i);
+    }
+    REG(UART_BASE | UART_DMACTL) |= UART_DMACTL_RXDMAE;
+  } else {
+    rx_dma_poll();
+  }
+  if(mis & (UART_MIS_OEMIS | UART_MIS_BEMIS | UART_MIS_FEMIS)) {
+    /* ISR triggered due to some error condition */
+    reset();
+  }
+#else
   if(mis & (UART_MIS_RXMIS | UART_MIS_RTMIS)) {
+    /* Drain the FIFO and hand the bytes over in one go */
     while(!(REG(UART_BASE | UART_FR) & UART_FR_RXFE)) {
-      if(input_handler != NULL) {
-        input_handler((unsigned char)(REG(UART_BASE | UART_DR) & 0xFF));
-      } else {
-        /* To prevent an Overrun Error, we need to flush the FIFO even if we
-         * don't have an input_handler. Use mis as a data trash can */
-        mis = REG(UART_BASE | UART_DR);
+      i = 0;
+      while(i < sizeof(buf) && !(REG(UART_BASE | UART_FR) & UART_FR_RXFE)) {
+        buf[i++] = REG(UART_BASE | UART_DR) & 0xFF;
       }
+      /* To prevent an Overrun Error, we need to flush the FIFO even if we
+       * don't have an input handler */
+      deliver(buf, i);
     }
   } else if(mis & (UART_MIS_OEMIS | UART_MIS_BEMIS | UART_MIS_FEMIS)) {
     /* ISR triggered due to some error condition */
     reset();
   }
+#endif
 
   ENERGEST_OFF(ENERGEST_TYPE_IRQ);
 }
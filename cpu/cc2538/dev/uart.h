@@ -379,6 +379,26 @@ void uart_write_byte(uint8_t b);
  */
 void uart_set_input(int (* input)(unsigned char c));
 
+/** \brief Assigns a callback to be called with blocks of received bytes
+ * \param input A pointer to the function
+ *
+ * When set, this takes precedence over the callback set with
+ * uart_set_input(). The ISR passes all the bytes it has collected in a
+ * single call: a FIFO's worth, or with UART_CONF_USE_DMA, a uDMA buffer
+ */
+void uart_set_block_input(int (* input)(const uint8_t *data, int len));
+
+/** \brief Sends a block of bytes down the UART
+ * \param data The bytes to transmit
+ * \param len The number of bytes
+ *
+ * With UART_CONF_USE_DMA the block is sent by the uDMA and this function
+ * returns as soon as the transfer has started. \e data must then remain
+ * untouched until the next call to uart_write() or uart_write_byte(), which
+ * wait for the transfer to complete
+ */
+void uart_write(const uint8_t *data, uint16_t len);
+
 /** @} */
 
 #endif /* UART_H_ */
@@ -50,7 +50,13 @@ struct channel_ctrl {
   uint32_t unused;
 };
 
-static volatile struct channel_ctrl channel_config[UDMA_CONF_MAX_CHANNEL + 1]
+#ifdef UDMA_CONF_MAX_ALT_CHANNEL
+#define CHANNEL_CONFIG_LEN (UDMA_ALT_CHANNEL_OFFSET + UDMA_CONF_MAX_ALT_CHANNEL + 1)
+#else
+#define CHANNEL_CONFIG_LEN (UDMA_CONF_MAX_CHANNEL + 1)
+#endif
+
+static volatile struct channel_ctrl channel_config[CHANNEL_CONFIG_LEN]
   __attribute__ ((aligned(1024)));
 /*---------------------------------------------------------------------------*/
 void
@@ -241,6 +247,74 @@ udma_channel_get_mode(uint8_t channel)
   return (channel_config[channel].ctrl_word & 0x07);
 }
 /*---------------------------------------------------------------------------*/
+static uint16_t
+remaining(uint32_t ctrl)
+{
+  if((ctrl & 0x07) == UDMA_CHCTL_XFERMODE_STOP) {
+    return 0;
+  }
+  return ((ctrl >> 4) & 0x3FF) + 1;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+udma_channel_get_remaining(uint8_t channel)
+{
+  if(channel > UDMA_CONF_MAX_CHANNEL) {
+    return 0;
+  }
+
+  return remaining(channel_config[channel].ctrl_word);
+}
+/*---------------------------------------------------------------------------*/
+#ifdef UDMA_CONF_MAX_ALT_CHANNEL
+void
+udma_set_channel_sg(uint8_t channel, const struct udma_sg_task *tasks,
+                    uint8_t count)
+{
+  if(channel > UDMA_CONF_MAX_ALT_CHANNEL || count == 0) {
+    return;
+  }
+
+  /*
+   * The primary structure copies the tasks, four words at a time, to the
+   * alternate structure
+   */
+  channel_config[channel].src_end_ptr = (uint32_t)&tasks[count - 1].unused;
+  channel_config[channel].dst_end_ptr =
+    (uint32_t)&channel_config[UDMA_ALT_CHANNEL_OFFSET + channel].unused;
+  channel_config[channel].ctrl_word = UDMA_CHCTL_DSTINC_32
+    | UDMA_CHCTL_DSTSIZE_32 | UDMA_CHCTL_SRCINC_32 | UDMA_CHCTL_SRCSIZE_32
+    | UDMA_CHCTL_ARBSIZE_4 | udma_xfer_size(count * 4)
+    | UDMA_CHCTL_XFERMODE_MEM_SG;
+}
+/*---------------------------------------------------------------------------*/
+void
+udma_set_alt_channel(uint8_t channel, uint32_t src_end, uint32_t dst_end,
+                     uint32_t ctrl)
+{
+  volatile struct channel_ctrl *alt;
+
+  if(channel > UDMA_CONF_MAX_ALT_CHANNEL) {
+    return;
+  }
+
+  alt = &channel_config[UDMA_ALT_CHANNEL_OFFSET + channel];
+  alt->src_end_ptr = src_end;
+  alt->dst_end_ptr = dst_end;
+  alt->ctrl_word = ctrl;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+udma_channel_get_alt_remaining(uint8_t channel)
+{
+  if(channel > UDMA_CONF_MAX_ALT_CHANNEL) {
+    return 0;
+  }
+
+  return remaining(channel_config[UDMA_ALT_CHANNEL_OFFSET + channel].ctrl_word);
+}
+#endif
+/*---------------------------------------------------------------------------*/
 void
 udma_isr()
 {
@@ -55,6 +55,18 @@
 #ifndef UDMA_CONF_MAX_CHANNEL
 #define UDMA_CONF_MAX_CHANNEL   31
 #endif
+
+/*
+ * Scatter-gather transfers need the alternate channel control data
+ * structure of the channel, which is located 32 structures after the
+ * primary ones. Define this to the number of the highest channel that
+ * performs scatter-gather transfers, to make room for the alternate
+ * structures up to that channel. Leave it undefined to save the RAM if
+ * no channel does
+ */
+#ifdef UDMA_CONF_MAX_ALT_CHANNEL
+#define UDMA_ALT_CHANNEL_OFFSET 32
+#endif
 /*---------------------------------------------------------------------------*/
 /**
  * \name uDMA Register offset declarations
@@ -550,6 +562,21 @@
 /** @} */
 /*---------------------------------------------------------------------------*/
 
+/**
+ * \brief A task of a scatter-gather transfer
+ *
+ * Each task has the format of a channel control data structure. The
+ * uDMA controller copies the tasks one by one to the alternate
+ * structure of the channel, and performs them
+ */
+struct udma_sg_task {
+  uint32_t src_end_ptr;
+  uint32_t dst_end_ptr;
+  uint32_t ctrl_word;
+  uint32_t unused;
+};
+/*---------------------------------------------------------------------------*/
+
 /**
  * \brief Initialise the uDMA driver
  *
@@ -684,6 +711,16 @@ void udma_channel_sw_request(uint8_t channel);
  */
 uint8_t udma_channel_get_mode(uint8_t channel);
 
+/**
+ * \brief Retrieve the number of items a channel has left to transfer
+ * \param channel The channel as a value in [0 , UDMA_CONF_MAX_CHANNEL]
+ * \return The number of items left, 0 once the transfer has completed
+ *
+ * The count is updated by the controller after each arbitration, so this
+ * can be used to track the progress of a peripheral transfer
+ */
+uint16_t udma_channel_get_remaining(uint8_t channel);
+
 /**
  * \brief Calculate the value of the xfersize field in the control structure
  * \param len The number of items to be transferred
@@ -695,6 +732,42 @@ uint8_t udma_channel_get_mode(uint8_t channel);
  */
 #define udma_xfer_size(len) ((len - 1) << 4)
 
+#ifdef UDMA_CONF_MAX_ALT_CHANNEL
+/**
+ * \brief Configure a channel for a memory scatter-gather transfer
+ * \param channel The channel as a value in [0 , UDMA_CONF_MAX_ALT_CHANNEL]
+ * \param tasks The tasks to perform
+ * \param count The number of tasks
+ *
+ * The control word of each task but the last one must use
+ * UDMA_CHCTL_XFERMODE_MEM_SGA and the control word of the last one
+ * UDMA_CHCTL_XFERMODE_AUTO. The tasks must remain in memory until the
+ * transfer has completed
+ */
+void udma_set_channel_sg(uint8_t channel, const struct udma_sg_task *tasks,
+                         uint8_t count);
+
+/**
+ * \brief Configure the alternate control structure of a channel
+ * \param channel The channel as a value in [0 , UDMA_CONF_MAX_ALT_CHANNEL]
+ * \param src_end The source end address
+ * \param dst_end The destination end address
+ * \param ctrl The value of the control word
+ *
+ * Used with UDMA_CHCTL_XFERMODE_PINGPONG, where the controller switches
+ * between the primary and the alternate structure each time one completes
+ */
+void udma_set_alt_channel(uint8_t channel, uint32_t src_end, uint32_t dst_end,
+                          uint32_t ctrl);
+
+/**
+ * \brief Retrieve the number of items left in the alternate structure
+ * \param channel The channel as a value in [0 , UDMA_CONF_MAX_ALT_CHANNEL]
+ * \return The number of items left, 0 once the transfer has completed
+ */
+uint16_t udma_channel_get_alt_remaining(uint8_t channel);
+#endif
+
 #endif /* UDMA_H_ */
 
 /**
@@ -38,12 +38,15 @@
 #include "contiki-conf.h"
 #include "sys/energest.h"
 #include "sys/process.h"
+#include "sys/clock.h"
 #include "dev/sys-ctrl.h"
 #include "dev/scb.h"
 #include "dev/rfcore-xreg.h"
 #include "dev/usb-regs.h"
+#include "dev/udma.h"
 #include "rtimer-arch.h"
 #include "reg.h"
+#include "cpu.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -69,6 +72,10 @@ static unsigned long irq_energest = 0;
  */
 #define DEEP_SLEEP_PM1_THRESHOLD    10
 #define DEEP_SLEEP_PM2_THRESHOLD    100
+
+/* Time to come back from PM1/2 to a running 32MHz XOSC, in rtimer ticks */
+#define PM1_EXIT_LATENCY            LPM_CONF_PM1_EXIT_LATENCY
+#define PM2_EXIT_LATENCY            LPM_CONF_PM2_EXIT_LATENCY
 /*---------------------------------------------------------------------------*/
 #define assert_wfi() do { asm("wfi"::); } while(0)
 /*---------------------------------------------------------------------------*/
@@ -96,6 +103,64 @@ void clock_adjust(clock_time_t ticks);
 /*---------------------------------------------------------------------------*/
 /* Stores the currently specified MAX allowed PM */
 static uint8_t max_pm;
+
+/* Number of lpm_hold() calls in effect for PM0 and PM1 */
+static uint8_t holds[2];
+
+/*
+ * When dropping to PM1/2 the Sleep Timer is moved earlier by the exit
+ * latency. prewake_at is the time we programmed, wake_deadline the time the
+ * next rtimer task is actually due.
+ */
+static rtimer_clock_t prewake_at;
+static rtimer_clock_t wake_deadline;
+
+/* The PM we dropped to, for energest */
+static uint8_t sleep_pm;
+/*---------------------------------------------------------------------------*/
+/*
+ * Return the deepest PM we may enter, considering configuration, holds
+ * placed by drivers and peripherals which need the system clock.
+ */
+static uint8_t
+deepest_allowed_pm(void)
+{
+  /*
+   * If either the RF or the USB is on, dropping to PM1/2 would equal pulling
+   * the rug (32MHz XOSC) from under their feet. The same goes for an ongoing
+   * uDMA transfer.
+   *
+   * Note: USB Suspend/Resume/Remote Wake-Up are not supported. Once the PLL is
+   * on, it stays on.
+   */
+  if((REG(RFCORE_XREG_FSMSTAT0) & RFCORE_XREG_FSMSTAT0_FSM_FFCTRL_STATE) != 0
+     || REG(USB_CTRL) != 0 || REG(UDMA_ENASET) != 0) {
+    return 0;
+  }
+
+  if(holds[0] > 0) {
+    return 0;
+  }
+
+  if(holds[1] > 0 && max_pm > 1) {
+    return 1;
+  }
+
+  return max_pm;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Put the Sleep Timer back to the rtimer deadline if we programmed it early
+ * and nobody has rescheduled it since.
+ */
+static void
+cancel_prewake(void)
+{
+  if(prewake_at != 0 && rtimer_arch_next_trigger() == prewake_at) {
+    rtimer_arch_schedule(wake_deadline);
+  }
+  prewake_at = 0;
+}
 /*---------------------------------------------------------------------------*/
 /*
  * Routine to put is in PM0. We also need to do some housekeeping if the stats
@@ -171,9 +236,29 @@ lpm_exit()
   clock_adjust((clock_time_t)
                ((RTIMER_NOW() - sleep_enter_time) / RTIMER_CLOCK_TICK_RATIO));
 
+  if(sleep_pm == 2) {
+    ENERGEST_OFF(ENERGEST_TYPE_PM2);
+  } else {
+    ENERGEST_OFF(ENERGEST_TYPE_PM1);
+  }
+
   /* Restore system clock to the 32 MHz XOSC */
   select_32_mhz_xosc();
 
+  if(prewake_at != 0) {
+    if(rtimer_arch_next_trigger() == 0) {
+      /*
+       * The early Sleep Timer interrupt woke us up and the XOSC is running.
+       * Hold on until the rtimer task is actually due.
+       */
+      while((int32_t)(RTIMER_NOW() - wake_deadline) < 0);
+      prewake_at = 0;
+    } else {
+      /* Something else woke us up. The rtimer task is still pending */
+      cancel_prewake();
+    }
+  }
+
   /* Restore PMCTL to PM0 for next pass */
   REG(SYS_CTRL_PMCTL) = SYS_CTRL_PMCTL_PM0;
 
@@ -189,17 +274,27 @@ lpm_enter()
 {
   rtimer_clock_t lpm_exit_time;
   rtimer_clock_t duration;
+  rtimer_clock_t latency;
+  uint8_t pm;
 
+#if CLOCK_CONF_TICKLESS
   /*
-   * If either the RF or the USB is on, dropping to PM1/2 would equal pulling
-   * the rug (32MHz XOSC) from under their feet. Thus, we only drop to PM0.
-   * PM0 is also used if max_pm==0
-   *
-   * Note: USB Suspend/Resume/Remote Wake-Up are not supported. Once the PLL is
-   * on, it stays on.
+   * The clock does not tick while we sleep. Arm an rtimer for the next etimer
+   * expiration, which also guarantees a Sleep Timer wake-up so that PM1/2
+   * can be used below. Don't sleep if an etimer is already due.
    */
-  if((REG(RFCORE_XREG_FSMSTAT0) & RFCORE_XREG_FSMSTAT0_FSM_FFCTRL_STATE) != 0
-     || REG(USB_CTRL) != 0 || max_pm == 0) {
+  clock_update_wakeup();
+  if(process_nevents()) {
+    return;
+  }
+#endif
+
+  /*
+   * Drop to PM0 if a peripheral needs the 32MHz XOSC or the system clock, if
+   * a driver holds us there, or if max_pm==0
+   */
+  pm = deepest_allowed_pm();
+  if(pm == 0) {
     enter_pm0();
 
     /* We reach here when the interrupt context that woke us up has returned */
@@ -243,15 +338,26 @@ lpm_enter()
     select_32_mhz_xosc();
 
     return;
-  } else if(duration >= DEEP_SLEEP_PM2_THRESHOLD && max_pm == 2) {
+  } else if(duration >= DEEP_SLEEP_PM2_THRESHOLD && pm == 2) {
     /* Long sleep duration and PM2 is allowed. Use it */
     REG(SYS_CTRL_PMCTL) = SYS_CTRL_PMCTL_PM2;
+    sleep_pm = 2;
+    latency = PM2_EXIT_LATENCY;
   } else {
     /*
      * Anticipated duration too short for PM2 but long enough for PM1 and we
      * are allowed to use PM1
      */
     REG(SYS_CTRL_PMCTL) = SYS_CTRL_PMCTL_PM1;
+    sleep_pm = 1;
+    latency = PM1_EXIT_LATENCY;
+  }
+
+  /* Wake up early enough to have the XOSC running when the task is due */
+  if(latency > 0) {
+    wake_deadline = lpm_exit_time;
+    rtimer_arch_schedule(lpm_exit_time - latency);
+    prewake_at = rtimer_arch_next_trigger();
   }
 
   /* We are only interested in IRQ energest while idle or in LPM */
@@ -259,6 +365,12 @@ lpm_enter()
   ENERGEST_OFF(ENERGEST_TYPE_CPU);
   ENERGEST_ON(ENERGEST_TYPE_LPM);
 
+  if(sleep_pm == 2) {
+    ENERGEST_ON(ENERGEST_TYPE_PM2);
+  } else {
+    ENERGEST_ON(ENERGEST_TYPE_PM1);
+  }
+
   /* Remember the current time so we can adjust the clock when we wake up */
   sleep_enter_time = RTIMER_NOW();
 
@@ -275,7 +387,10 @@ lpm_enter()
   if(process_nevents() || rtimer_arch_next_trigger() == 0) {
     /* Event flag raised or rtimer inactive.
      * Turn on the 32MHz XOSC, restore PMCTL and abort */
+    ENERGEST_OFF(ENERGEST_TYPE_PM1);
+    ENERGEST_OFF(ENERGEST_TYPE_PM2);
     select_32_mhz_xosc();
+    cancel_prewake();
 
     REG(SYS_CTRL_PMCTL) = SYS_CTRL_PMCTL_PM0;
   } else {
@@ -299,6 +414,36 @@ lpm_set_max_pm(uint8_t pm)
 }
 /*---------------------------------------------------------------------------*/
 void
+lpm_hold(uint8_t pm)
+{
+  unsigned long primask;
+
+  if(pm < 2) {
+    primask = INTERRUPTS_DISABLE();
+    holds[pm]++;
+    if(!primask) {
+      INTERRUPTS_ENABLE();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+lpm_release(uint8_t pm)
+{
+  unsigned long primask;
+
+  if(pm < 2) {
+    primask = INTERRUPTS_DISABLE();
+    if(holds[pm] > 0) {
+      holds[pm]--;
+    }
+    if(!primask) {
+      INTERRUPTS_ENABLE();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
 lpm_init()
 {
   /*
@@ -101,6 +101,8 @@ void lpm_init(void);
  * This PM selection heuristic has the following primary criteria:
  * - Is the RF off?
  * - Is the USB PLL off?
+ * - Is no uDMA channel active?
+ * - Does no driver hold the SoC in PM0 through lpm_hold()?
  * - Is the Sleep Timer scheduled to fire an interrupt?
  *
  * If the answer to any of those questions is no, we will drop to PM0 and
@@ -112,6 +114,9 @@ void lpm_init(void);
  * Sleep Timer will wake us up. Depending on the estimated deep sleep duration
  * and the max PM allowed by user configuration, we select the most efficient
  * Power Mode to drop to. If the duration is too short, we simply IDLE in PM0.
+ * The Sleep Timer is then moved ahead of the next rtimer task by the exit
+ * latency of the chosen PM (LPM_CONF_PM1_EXIT_LATENCY,
+ * LPM_CONF_PM2_EXIT_LATENCY), so that the task still runs on time.
  *
  * Dropping to PM1/2 requires a switch to the 16MHz OSC. We have the option of
  * letting the SoC do this for us automatically. However, if an interrupt fires
@@ -172,6 +177,26 @@ void lpm_exit(void);
  * \sa lpm_enter()
  */
 void lpm_set_max_pm(uint8_t pm);
+
+/**
+ * \brief Keep the SoC from dropping to a PM higher than \e pm
+ * \param pm LPM_PM0 or LPM_PM1
+ *
+ * Meant for drivers that need the system clock or the 32MHz XOSC while an
+ * operation is in progress, e.g. during a peripheral transfer. Holds nest:
+ * each call must be matched by a call to lpm_release() with the same \e pm.
+ * Unlike lpm_set_max_pm(), independent drivers can use this without
+ * overriding each other's restrictions.
+ *
+ * \sa lpm_release()
+ */
+void lpm_hold(uint8_t pm);
+
+/**
+ * \brief Release a hold previously placed with lpm_hold()
+ * \param pm The same value that was passed to lpm_hold()
+ */
+void lpm_release(uint8_t pm);
 /*---------------------------------------------------------------------------*/
 /* Disable the entire module if required */
 #if LPM_CONF_ENABLE==0
@@ -179,6 +204,8 @@ void lpm_set_max_pm(uint8_t pm);
 #define lpm_enter()
 #define lpm_exit()
 #define lpm_set_max_pm(...)
+#define lpm_hold(...)
+#define lpm_release(...)
 #endif
 
 #endif /* LPM_H_ */
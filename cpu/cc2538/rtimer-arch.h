@@ -62,6 +62,7 @@
 
 #include "contiki.h"
 #include "dev/gptimer.h"
+#include "cpu.h"
 
 #define RTIMER_ARCH_SECOND 32768
 
@@ -74,6 +75,14 @@ rtimer_clock_t rtimer_arch_now(void);
  */
 rtimer_clock_t rtimer_arch_next_trigger(void);
 
+/** \name Interrupt masking for the rtimer queue (RTIMER_CONF_QUEUE)
+ * @{
+ */
+typedef unsigned long rtimer_arch_irq_t;
+#define rtimer_arch_irq_disable() cpu_cpsid()
+#define rtimer_arch_irq_restore(s) do { if(!(s)) { cpu_cpsie(); } } while(0)
+/** @} */
+
 #endif /* RTIMER_ARCH_H_ */
 
 /**
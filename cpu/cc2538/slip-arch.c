@@ -49,8 +49,11 @@
 
 #if SLIP_ARCH_CONF_USB
 #define write_byte(b) usb_serial_writeb(b)
-#define set_input(f)  usb_serial_set_input(f)
+#define set_input(f)  usb_serial_set_block_input(slip_input) /* in blocks */
 #define flush()       usb_serial_flush()
+#elif UART_CONF_USE_DMA
+#define TX_DMA        1
+#define set_input(f)  uart_set_block_input(slip_input) /* in blocks */
 #else
 #define write_byte(b) uart_write_byte(b)
 #define set_input(f)  uart_set_input(f)
@@ -59,6 +62,58 @@
 
 #define SLIP_END     0300
 /*---------------------------------------------------------------------------*/
+#if TX_DMA
+/*
+ * Frames are collected in one buffer while the uDMA sends the other one, and
+ * handed to uart_write() whole when their closing SLIP_END is written. Frames
+ * larger than a buffer go out in buffer-sized pieces
+ */
+#ifdef SLIP_ARCH_CONF_TX_BUFSIZE
+#define TX_BUFSIZE SLIP_ARCH_CONF_TX_BUFSIZE
+#else
+#define TX_BUFSIZE 256
+#endif
+
+static uint8_t tx_buf[2][TX_BUFSIZE];
+static uint8_t tx_cur;
+static uint16_t tx_len;
+static uint8_t in_frame;
+/*---------------------------------------------------------------------------*/
+static void
+tx_flush(void)
+{
+  /* uart_write() waits for the other buffer to go out before it starts this
+   * one, so the other one is free to be filled afterwards */
+  uart_write(tx_buf[tx_cur], tx_len);
+  tx_cur ^= 1;
+  tx_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_byte(unsigned char c)
+{
+  tx_buf[tx_cur][tx_len++] = c;
+  if(c != SLIP_END) {
+    in_frame = 1;
+  }
+  if(tx_len == TX_BUFSIZE) {
+    tx_flush();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush(void)
+{
+  /* A SLIP_END that opens a frame stays with the frame */
+  if(in_frame) {
+    tx_flush();
+    in_frame = 0;
+  } else {
+    in_frame = 1;
+  }
+}
+#endif /* TX_DMA */
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Write a byte over SLIP
  * \param c the byte
@@ -145,9 +145,9 @@ const struct configuration_st {
     {
       sizeof(configuration_block.ep_in),
       ENDPOINT,
-      0x82,
+      0x84,
       0x02,
-      USB_EP2_SIZE,
+      USB_EP4_SIZE,
       0
     },
     {
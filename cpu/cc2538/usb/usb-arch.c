@@ -98,6 +98,17 @@ static const uint16_t ep_xfer_size[] = {
   USB_EP5_SIZE,
 };
 /*---------------------------------------------------------------------------*/
+/* Hardware FIFO size of each endpoint, in each direction */
+static const uint16_t ep_fifo_size[] = { 64, 32, 64, 128, 256, 512 };
+
+/*
+ * A bulk endpoint FIFO which can hold two packets is split in two halves:
+ * the host can then fill (or drain) one while the CPU works on the other
+ */
+#define EP_DOUBLE_BUFFER(ep, ei) (USB_ARCH_CONF_DOUBLE_BUFFER && \
+                                  IS_BULK_EP(ep) && \
+                                  2 * (ep)->xfer_size <= ep_fifo_size[ei])
+/*---------------------------------------------------------------------------*/
 typedef struct _USBBuffer usb_buffer;
 /*---------------------------------------------------------------------------*/
 struct usb_endpoint {
@@ -462,6 +473,12 @@ in_ep_setup(uint8_t addr)
   } else {
     REG(USB_CSIH) &= ~USB_CSOH_ISO;
   }
+
+  if(EP_DOUBLE_BUFFER(ep, ei)) {
+    REG(USB_CSIH) |= USB_CSIH_IN_DBL_BUF;
+  } else {
+    REG(USB_CSIH) &= ~USB_CSIH_IN_DBL_BUF;
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -481,6 +498,12 @@ out_ep_setup(uint8_t addr)
   } else {
     REG(USB_CSOH) &= ~USB_CSOH_ISO;
   }
+
+  if(EP_DOUBLE_BUFFER(ep, ei)) {
+    REG(USB_CSOH) |= USB_CSOH_OUT_DBL_BUF;
+  } else {
+    REG(USB_CSOH) &= ~USB_CSOH_OUT_DBL_BUF;
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -1171,12 +1194,20 @@ out_ep_interrupt_handler(uint8_t ep_hw)
     REG(USB_CSOL) &= ~USB_CSOL_OVERRUN;
   }
 
-  if(csl & USB_CSOL_OUTPKT_RDY) {
+  /*
+   * With a double-buffered FIFO, a second packet may already be waiting
+   * behind the one we read. Drain them all while we have buffers for them
+   */
+  while(csl & USB_CSOL_OUTPKT_RDY) {
     res = ep_get_data_pkt(ep_hw);
 
     if(res & USB_READ_NOTIFY) {
       notify_ep_process(ep, USB_EP_EVENT_NOTIFICATION);
     }
+    if((res & USB_READ_BLOCK) || ep->halted) {
+      break;
+    }
+    csl = REG(USB_CSOL);
   }
 }
 /*---------------------------------------------------------------------------*/
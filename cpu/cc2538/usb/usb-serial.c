@@ -112,25 +112,37 @@ static const struct product product = {
   }
 };
 /*---------------------------------------------------------------------------*/
-#define EPIN  0x82
+#define EPIN  0x84
 #define EPOUT 0x03
 
 #define RX_BUFFER_SIZE USB_EP3_SIZE
-#define TX_BUFFER_SIZE (USB_EP2_SIZE - 1)
+#define TX_BUFFER_SIZE (USB_EP4_SIZE - 1)
+
+/*
+ * Number of OUT buffers kept queued with the controller. While the process
+ * hands one of them to the input handler, the others can still be filled
+ */
+#ifdef USB_SERIAL_CONF_RX_URBS
+#define RX_URBS USB_SERIAL_CONF_RX_URBS
+#else
+#define RX_URBS 2
+#endif
 
 typedef struct _USBBuffer usb_buffer;
 
-static usb_buffer data_rx_urb;
+static usb_buffer data_rx_urb[RX_URBS];
 static usb_buffer data_tx_urb;
-static uint8_t usb_rx_data[RX_BUFFER_SIZE];
+static uint8_t usb_rx_data[RX_URBS][RX_BUFFER_SIZE];
+static uint8_t rx_next;
 static uint8_t enabled = 0;
 
 #define SLIP_END 0300
 static uint8_t usb_tx_data[TX_BUFFER_SIZE];
 static uint8_t buffered_data = 0;
 
-/* Callback to the input handler */
+/* Callbacks to the input handlers */
 static int (* input_handler)(unsigned char c);
+static int (* block_input_handler)(const uint8_t *data, int len);
 /*---------------------------------------------------------------------------*/
 uint8_t *
 usb_class_get_string_descriptor(uint16_t lang, uint8_t string)
@@ -170,20 +182,33 @@ set_serial_number(void)
 }
 /*---------------------------------------------------------------------------*/
 static void
-queue_rx_urb(void)
+queue_rx_urb(uint8_t i)
+{
+  data_rx_urb[i].flags = USB_BUFFER_PACKET_END;
+  data_rx_urb[i].flags |= USB_BUFFER_NOTIFY;
+  data_rx_urb[i].data = usb_rx_data[i];
+  data_rx_urb[i].left = RX_BUFFER_SIZE;
+  data_rx_urb[i].next = NULL;
+  usb_submit_recv_buffer(EPOUT, &data_rx_urb[i]);
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(const uint8_t *data, int len)
 {
-  data_rx_urb.flags = USB_BUFFER_PACKET_END;
-  data_rx_urb.flags |= USB_BUFFER_NOTIFY;
-  data_rx_urb.data = usb_rx_data;
-  data_rx_urb.left = RX_BUFFER_SIZE;
-  data_rx_urb.next = NULL;
-  usb_submit_recv_buffer(EPOUT, &data_rx_urb);
+  if(block_input_handler != NULL) {
+    block_input_handler(data, len);
+  } else if(input_handler != NULL) {
+    while(len-- > 0) {
+      input_handler(*data++);
+    }
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
 do_work(void)
 {
   unsigned int events;
+  uint8_t i;
 
   events = usb_get_global_events();
   if(events & USB_EVENT_CONFIG) {
@@ -191,7 +216,10 @@ do_work(void)
     usb_setup_bulk_endpoint(EPIN);
     usb_setup_bulk_endpoint(EPOUT);
 
-    queue_rx_urb();
+    for(i = 0; i < RX_URBS; i++) {
+      queue_rx_urb(i);
+    }
+    rx_next = 0;
   }
   if(events & USB_EVENT_RESET) {
     enabled = 0;
@@ -213,20 +241,17 @@ do_work(void)
   }
 
   events = usb_get_ep_events(EPOUT);
-  if((events & USB_EP_EVENT_NOTIFICATION)
-     && !(data_rx_urb.flags & USB_BUFFER_SUBMITTED)) {
-    if(!(data_rx_urb.flags & USB_BUFFER_FAILED)) {
-      if(input_handler) {
-        uint8_t len;
-        uint8_t i;
-
-        len = RX_BUFFER_SIZE - data_rx_urb.left;
-        for(i = 0; i < len; i++) {
-          input_handler(usb_rx_data[i]);
-        }
+  if(events & USB_EP_EVENT_NOTIFICATION) {
+    /* URBs complete in the order they were queued */
+    for(i = 0; i < RX_URBS
+        && !(data_rx_urb[rx_next].flags & USB_BUFFER_SUBMITTED); i++) {
+      if(!(data_rx_urb[rx_next].flags & USB_BUFFER_FAILED)) {
+        deliver(usb_rx_data[rx_next],
+                RX_BUFFER_SIZE - data_rx_urb[rx_next].left);
       }
+      queue_rx_urb(rx_next);
+      rx_next = (rx_next + 1) % RX_URBS;
     }
-    queue_rx_urb();
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -298,6 +323,12 @@ usb_serial_set_input(int (* input)(unsigned char c))
 }
 /*---------------------------------------------------------------------------*/
 void
+usb_serial_set_block_input(int (* input)(const uint8_t *data, int len))
+{
+  block_input_handler = input;
+}
+/*---------------------------------------------------------------------------*/
+void
 usb_serial_init()
 {
   process_start(&usb_serial_process, NULL);
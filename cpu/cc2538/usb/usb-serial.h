@@ -62,6 +62,15 @@ void usb_serial_writeb(uint8_t b);
  */
 void usb_serial_set_input(int (* input)(unsigned char c));
 
+/**
+ * \brief Set an input hook for blocks of bytes received over USB
+ * \param input A pointer to a function to be called with received data
+ *
+ * When set, this takes precedence over the hook set with
+ * usb_serial_set_input(). Each call passes the payload of one USB packet
+ */
+void usb_serial_set_block_input(int (* input)(const uint8_t *data, int len));
+
 /**
  * \brief Immediately transmit the content of Serial-over-USB TX buffers
  * \sa usb_serial_writeb()
@@ -115,4 +115,7 @@ typedef unsigned short clock_time_t;
 #define uip_ipaddr_copy(dest, src)		\
     memcpy(dest, src, sizeof(*dest))
 
+/* 16-bit loads and stores are not atomic, see lib/ringbuf.h */
+#define RINGBUF_CONF_INDEX_T uint8_t
+
 #endif /* __8051_DEF_H__ */
@@ -112,20 +112,60 @@ def populate(project, modules, segment_rules, bins):
 				user_total += code_size
 			else:
 				# We are free to allocate this module
-				modules.append([mod, code_size, "NONE"])
+				modules.append([mod, code_size, "NONE", 0])
 				bankable_total += code_size
 	return bankable_total, user_total
 
+# Read an execution profile: one '<count> <file spec>' entry per line, where
+# count is how often code in matching modules gets called (e.g. from a
+# profiling build or a static call graph) and the file spec is a python regex,
+# as in segment.rules. Counts of all entries matching a module are summed.
+# Comments starting with "#" are supported
+def read_profile(profile):
+	entries = list()
+	for line in open(profile):
+		line = line.split('#', 1)[0]
+		tokens = line.split(None)
+		if len(tokens) < 2:
+			continue
+		entries.append([int(tokens[0]), re.compile(tokens[1])])
+	return entries
+
+def module_heat(module, profile):
+	heat = 0
+	for entry in profile:
+		if entry[1].search(module) is not None:
+			heat += entry[0]
+	return heat
+
+# Hot modules get the first shot at HOME, so that calls to them do not go
+# through the bank switching trampoline. We prefer the modules which save the
+# most bank switches per byte of HOME they occupy
+def place_hot(modules, bins, log):
+	hot = [m for m in modules if m[3] > 0 and m[1] > 0]
+	hot.sort(key=lambda m: float(m[3]) / m[1], reverse=True)
+	for module in hot:
+		if bins['HOME'][0] + module[1] < bins['HOME'][1]:
+			bins['HOME'][0] += module[1]
+			module[2] = 'HOME'
+			log.writelines('  '.join([module[2].ljust(8), \
+				str(module[1]).rjust(5), module[0], \
+				'(' + str(module[3]) + ' calls)', '\n']))
+
 # Allocate bankable modules to banks according to a simple
 # 'first fit, decreasing' bin packing heuristic.
 def bin_pack(modules, bins, offset, log):
 	if offset==1:
 		bins['HOME'][1] -= 4096
 
+	place_hot(modules, bins, log)
+
 	# Sort by size, descending, in=place
 	modules.sort(key=operator.itemgetter(1), reverse=True)
 
 	for module in modules:
+		if module[2] != "NONE":
+			continue
 		# We want to iterate in a specific order and dict.keys() won't do that
 		for bin_id in ['HOME', 'BANK1', 'BANK2', 'BANK3', 'BANK4', 'BANK5', 'BANK6', 'BANK7']:
 			if bins[bin_id][0] + module[1] < bins[bin_id][1]:
@@ -203,6 +243,14 @@ sizes['total'] = get_total_size(basename)
 sizes['bankable'], sizes['user'] = populate(basename, modules, segment_rules, bins)
 sizes['libs'] = sizes['total'] - sizes['bankable'] - sizes['user']
 
+# Optional execution profile, passed by the Makefile as BANK_PROFILE
+profile_file = os.environ.get('BANK_PROFILE')
+if profile_file:
+	profile = read_profile(profile_file)
+	for module in modules:
+		module[3] = module_heat(module[0], profile)
+	print 'Using profile', profile_file, 'with', len(profile), 'entries'
+
 print 'Total Size =', sizes['total'], 'bytes (' + \
 	str(sizes['bankable']), 'bankable,', \
 	str(sizes['user']), 'user-allocated,', \
@@ -65,6 +65,16 @@ unsigned short node_id = 0;
 
 static volatile uint8_t tx_complete;
 static volatile uint8_t tx_status;
+#if BLOCKING_TX
+/* prepped_p is queued in the maca and must not be touched */
+static volatile uint8_t tx_pending;
+
+static int tx_busy(void) {
+	/* the tx queue is dropped when the maca is reset */
+	if(tx_head == 0) { tx_pending = 0; }
+	return tx_pending;
+}
+#endif
 
 /* contiki mac driver */
 
@@ -98,6 +108,8 @@ static volatile uint8_t contiki_maca_request_off = 0;
 
 static process_event_t event_data_ready;
 
+/* with BLOCKING_TX, prepped_p is handed to the maca as is: */
+/* the payload is copied once, straight into the DMA buffer */
 static volatile packet_t prepped_p;
 
 void contiki_maca_set_mac_address(uint64_t eui) {
@@ -215,6 +227,9 @@ int contiki_maca_prepare(const void *payload, unsigned short payload_len) {
 	volatile int i;
 
 	PRINTF("contiki maca prepare");
+#if BLOCKING_TX
+	if(tx_busy()) return RADIO_TX_ERR;
+#endif
 #if CONTIKI_MACA_RAW_MODE
 	prepped_p.offset = 1;
 	prepped_p.length = payload_len + 1;
@@ -241,16 +256,21 @@ int contiki_maca_prepare(const void *payload, unsigned short payload_len) {
 
 }
 
-/* gets a packet from the radio (if available), */
-/* copies the prepared packet prepped_p */
-/* and transmits it */
+/* transmits the prepared packet prepped_p */
+/* without BLOCKING_TX it is copied to a packet from the radio (if available) */
 int contiki_maca_transmit(unsigned short transmit_len) {
+#if !BLOCKING_TX
 	volatile packet_t *p;
+#endif
 
 	PRINTF("contiki maca transmit\n\r");
 #if BLOCKING_TX
+	if(tx_busy()) return RADIO_TX_ERR;
 	tx_complete = 0;
-#endif
+	tx_pending = 1;
+	set_tx_buffer(&prepped_p);
+	tx_packet(&prepped_p);
+#else
 	if(p = get_free_packet()) {
 		p->offset = prepped_p.offset;
 		p->length = prepped_p.length;
@@ -262,11 +282,13 @@ int contiki_maca_transmit(unsigned short transmit_len) {
 		PRINTF("couldn't get free packet for transmit\n\r");
 		return RADIO_TX_ERR;
 	}
+#endif
 
 #if BLOCKING_TX
 	/* block until tx_complete, set by contiki_maca_tx_callback */
 	while((maca_pwr == 1) && !tx_complete && (tx_head != 0)) { continue; }
 #endif
+	return RADIO_TX_OK;
 }
 
 int contiki_maca_send(const void *payload, unsigned short payload_len) {
@@ -333,6 +355,7 @@ void maca_rx_callback(volatile packet_t *p __attribute((unused))) {
 
 #if BLOCKING_TX
 void maca_tx_callback(volatile packet_t *p __attribute((unused))) {
+	if(p == &prepped_p) { tx_pending = 0; }
 	tx_complete = 1;
 	tx_status = p->status;
 }
@@ -73,6 +73,9 @@ volatile packet_t* rx_packet(void);
 volatile packet_t* get_free_packet(void);
 void free_packet(volatile packet_t *p);
 void free_all_packets(void);
+/* tx_packet() may also be passed this packet, which lives outside the */
+/* packet pool: it is sent in place and never returned to the pool */
+void set_tx_buffer(volatile packet_t *p);
 
 extern volatile packet_t *rx_head, *tx_head;
 extern volatile uint32_t maca_entry;
@@ -96,6 +96,8 @@ volatile packet_t *rx_head, *tx_head;
 /* used for ack recpetion if the packet_pool goes empty */
 /* doesn't go back into the pool when freed */
 static volatile packet_t dummy_ack;
+/* transmit buffer owned by the caller, see set_tx_buffer() */
+static volatile packet_t *tx_buffer;
 static volatile packet_t dummy_rx;
 
 /* incremented on every maca entry */
@@ -288,7 +290,8 @@ void bound_check(volatile packet_t *p) {
 	volatile int i;
 
 	if((p == 0) ||
-	   (p == &dummy_ack)) { return; }
+	   (p == &dummy_ack) ||
+	   (p == tx_buffer)) { return; }
 	for(i=0; i < NUM_PACKETS; i++) {
 		if(p == &packet_pool[i]) { return; }
 	}
@@ -301,6 +304,8 @@ void bound_check(volatile packet_t *p) {
 /* heads are to the right */
 /* ends are to the left */
 void free_packet(volatile packet_t *p) {
+	if(p == tx_buffer) { return; }
+
 	safe_irq_disable(MACA);
 
 	BOUND_CHECK(p);
@@ -506,6 +511,10 @@ void free_all_packets(void) {
 	return;
 }
 
+void set_tx_buffer(volatile packet_t *p) {
+	tx_buffer = p;
+}
+
 /* private routines used by driver */
 		
 void free_tx_head(void) {
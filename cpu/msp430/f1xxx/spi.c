@@ -28,7 +28,10 @@
  *
  */
 
-#include "contiki-conf.h"
+#include "contiki.h"
+#include "sys/energest.h"
+#include "dev/spi.h"
+#include "isr_compat.h"
 
 /*
  * On the Tmote sky access to I2C/SPI/UART0 must always be
@@ -66,3 +69,106 @@ spi_init(void)
   ME1   |= USPIE0;	   /* Module enable ME1 --> U0ME? xxx/bg */
   U0CTL &= ~SWRST;		/* Remove RESET */
 }
+/*---------------------------------------------------------------------------*/
+#if SPI_DMA
+/*
+ * DMA channel 1 empties U0RXBUF and channel 2 refills U0TXBUF. Channel
+ * 0 is left to the UART1 receiver. The receive channel has the higher
+ * priority, so each byte is read before the next one has been shifted
+ * in.
+ */
+static void (*dma_callback)(void *ptr);
+static void *dma_ptr;
+static volatile unsigned char dma_active;
+static unsigned char dma_rx_dummy;
+static const unsigned char dma_tx_dummy = 0;
+
+int
+spi_acquire(void)
+{
+  int s;
+
+  s = splhigh();
+  if(spi_busy) {
+    splx(s);
+    return 0;
+  }
+  spi_busy = 1;
+  splx(s);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+spi_release(void)
+{
+  spi_busy = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+spi_dma_transfer(const unsigned char *tx, unsigned char *rx,
+                 unsigned short len,
+                 void (*callback)(void *ptr), void *ptr)
+{
+  if(dma_active || len == 0) {
+    return 0;
+  }
+  dma_active = 1;
+  dma_callback = callback;
+  dma_ptr = ptr;
+
+  /* The USART and the DMA need the DCO until the transfer is done */
+  msp430_add_lpm_req(MSP430_REQUIRE_LPM1);
+
+  DMACTL0 = (DMACTL0 & 0x000f) | DMA1TSEL_3 | DMA2TSEL_4;
+
+  /* The triggers are edge sensitive: a pending URXIFG0 would hide the
+     first received byte. */
+  SPI_WAITFOREOTx();
+  SPI_FLUSH();
+
+  DMA1SA = (unsigned short)&SPI_RXBUF;
+  DMA1SZ = len;
+  if(rx != NULL) {
+    DMA1DA = (unsigned short)rx;
+    DMA1CTL = DMADT_0 | DMASBDB | DMADSTINCR_3 | DMAIE | DMAEN;
+  } else {
+    DMA1DA = (unsigned short)&dma_rx_dummy;
+    DMA1CTL = DMADT_0 | DMASBDB | DMAIE | DMAEN;
+  }
+
+  DMA2DA = (unsigned short)&SPI_TXBUF;
+  DMA2SZ = len;
+  if(tx != NULL) {
+    DMA2SA = (unsigned short)tx;
+    DMA2CTL = DMADT_0 | DMASBDB | DMASRCINCR_3 | DMAEN;
+  } else {
+    DMA2SA = (unsigned short)&dma_tx_dummy;
+    DMA2CTL = DMADT_0 | DMASBDB | DMAEN;
+  }
+
+  /* UTXIFG0 is already set when the bus is idle. Give the transmit
+     channel the edge it needs to send the first byte. */
+  IFG1 &= ~UTXIFG0;
+  IFG1 |= UTXIFG0;
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+ISR(DACDMA, spi_dma_interrupt)
+{
+  ENERGEST_ON(ENERGEST_TYPE_IRQ);
+
+  if(DMA1CTL & DMAIFG) {
+    DMA1CTL &= ~(DMAIFG | DMAIE);
+    dma_active = 0;
+    msp430_remove_lpm_req(MSP430_REQUIRE_LPM1);
+    if(dma_callback != NULL) {
+      dma_callback(dma_ptr);
+    }
+    LPM4_EXIT;
+  }
+
+  ENERGEST_OFF(ENERGEST_TYPE_IRQ);
+}
+#endif /* SPI_DMA */
+/*---------------------------------------------------------------------------*/
@@ -222,7 +222,7 @@ uart1_init(unsigned long ubr)
 #if RX_WITH_DMA
   IE2 &= ~URXIE1; /* disable USART1 RX interrupt  */
   /* UART1_RX trigger */
-  DMACTL0 = DMA0TSEL_9;
+  DMACTL0 = (DMACTL0 & ~0x000f) | DMA0TSEL_9; /* Channels 1, 2 may be SPI */
 
   /* source address = RXBUF1 */
   DMA0SA = (unsigned int) &RXBUF1;
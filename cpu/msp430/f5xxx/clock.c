@@ -41,6 +41,168 @@
 
 #define MAX_TICKS (~((clock_time_t)0) / 2)
 
+#ifdef CLOCK_CONF_TICKLESS
+#define CLOCK_TICKLESS CLOCK_CONF_TICKLESS
+#else
+#define CLOCK_TICKLESS 0
+#endif
+
+#if CLOCK_TICKLESS
+/*
+ * Tickless mode: TA1 free-runs at RTIMER_ARCH_SECOND and is shared with the
+ * rtimer. clock_time() is derived from the counter and the number of times
+ * it has wrapped, and CCR1 is only armed for the next etimer expiration
+ * instead of interrupting every clock tick.
+ */
+
+/* Clock ticks per wrap of the 16-bit counter */
+#define TICKS_PER_WRAP (0x10000UL / INTERVAL)
+
+static volatile unsigned long overflows;
+static volatile unsigned long seconds_offset;
+/*---------------------------------------------------------------------------*/
+static void
+read_counter(unsigned long *ovf, uint16_t *tar)
+{
+  int s;
+  uint16_t t1, t2;
+  unsigned long o;
+
+  s = splhigh();
+  do {
+    t1 = TA1R;
+    t2 = TA1R;
+  } while(t1 != t2);
+  o = overflows;
+  /* The counter wrapped but the overflow interrupt has not run yet */
+  if((TA1CTL & TAIFG) && t1 < 0x8000) {
+    o++;
+  }
+  splx(s);
+
+  *ovf = o;
+  *tar = t1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+counter_seconds(void)
+{
+  unsigned long o;
+  uint16_t t;
+
+  read_counter(&o, &t);
+  return o * (0x10000UL / RTIMER_ARCH_SECOND) + t / RTIMER_ARCH_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+static int
+etimer_due(void)
+{
+  return etimer_pending() &&
+    (etimer_next_expiration_time() - clock_time() - 1) > MAX_TICKS;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Arm CCR1 for the next etimer expiration. Called from the idle loop with
+ * interrupts disabled before entering LPM, and from the timer interrupts.
+ * Polls the etimer process instead if an etimer is already due.
+ */
+void
+clock_update_wakeup(void)
+{
+  clock_time_t now, next;
+
+  if(!etimer_pending()) {
+    /* Only the overflow interrupt keeps running */
+    TA1CCTL1 = 0;
+    return;
+  }
+
+  now = clock_time();
+  next = etimer_next_expiration_time();
+  if((next - now - 1) > MAX_TICKS) {
+    TA1CCTL1 = 0;
+    etimer_request_poll();
+    return;
+  }
+
+  if(next - now < TICKS_PER_WRAP - 1) {
+    /* Clock ticks are aligned to multiples of INTERVAL on the counter */
+    TA1CCR1 = (uint16_t)(next * INTERVAL);
+    TA1CCTL1 = CCIE;
+  } else {
+    /* Too far ahead; the overflow interrupt will check again */
+    TA1CCTL1 = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+ISR(TIMER1_A1, timera1)
+{
+  ENERGEST_ON(ENERGEST_TYPE_IRQ);
+
+  switch(TA1IV) {
+  case 2: /* CCR1 */
+    /* HW timer bug fix: Interrupt handler called before TR==CCR. */
+    while(TA1CTL & MC1 && TA1CCR1 - TA1R == 1);
+    break;
+  case 14: /* TA1IFG, counter wrapped */
+    ++overflows;
+    energest_flush();
+    break;
+  default:
+    ENERGEST_OFF(ENERGEST_TYPE_IRQ);
+    return;
+  }
+
+  if(etimer_due()) {
+    TA1CCTL1 = 0;
+    etimer_request_poll();
+    LPM4_EXIT;
+  } else {
+    clock_update_wakeup();
+  }
+
+  ENERGEST_OFF(ENERGEST_TYPE_IRQ);
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+clock_time(void)
+{
+  unsigned long o;
+  uint16_t t;
+
+  read_counter(&o, &t);
+  return (clock_time_t)(o * TICKS_PER_WRAP + t / INTERVAL);
+}
+/*---------------------------------------------------------------------------*/
+void
+clock_set(clock_time_t clock, clock_time_t fclock)
+{
+  int s;
+
+  s = splhigh();
+  overflows = clock / TICKS_PER_WRAP;
+  TA1R = (clock % TICKS_PER_WRAP) * INTERVAL + fclock;
+  TA1CTL &= ~TAIFG;
+  splx(s);
+}
+/*---------------------------------------------------------------------------*/
+int
+clock_fine_max(void)
+{
+  return INTERVAL;
+}
+/*---------------------------------------------------------------------------*/
+unsigned short
+clock_fine(void)
+{
+  unsigned long o;
+  uint16_t t;
+
+  read_counter(&o, &t);
+  return (unsigned short)(t % INTERVAL);
+}
+#else /* CLOCK_TICKLESS */
+
 static volatile unsigned long seconds;
 
 static volatile clock_time_t count = 0;
@@ -130,6 +292,7 @@ clock_fine(void)
   /* perform calc based on t, TAR will not be changed during interrupt */
   return (unsigned short) (TA1R - t);
 }
+#endif /* CLOCK_TICKLESS */
 /*---------------------------------------------------------------------------*/
 void
 clock_init(void)
@@ -150,6 +313,16 @@ clock_init(void)
 #error NEED TO UPDATE clock.c to match interval!
 #endif
 
+#if CLOCK_TICKLESS
+  /* Count counter wrap-arounds; CCR1 is armed on demand. */
+  TA1CCTL1 = 0;
+  TA1CTL |= TAIE;
+
+  /* Start Timer_A in continuous mode. */
+  TA1CTL |= MC1;
+
+  overflows = 0;
+#else
   /* Initialize ccr1 to create the X ms interval. */
   /* CCR1 interrupt enabled, interrupt occurs when timer equals CCR1. */
   TA1CCTL1 = CCIE;
@@ -161,6 +334,7 @@ clock_init(void)
   TA1CTL |= MC1;
 
   count = 0;
+#endif
 
   /* Enable interrupts. */
   eint();
@@ -196,19 +370,27 @@ clock_set_seconds(unsigned long sec)
 {
   int s;
   s = splhigh();
+#if CLOCK_TICKLESS
+  seconds_offset = sec - counter_seconds();
+#else
   seconds = sec;
+#endif
   splx(s);
 }
 /*---------------------------------------------------------------------------*/
 unsigned long
 clock_seconds(void)
 {
+#if CLOCK_TICKLESS
+  return counter_seconds() + seconds_offset;
+#else
   unsigned long t1, t2;
   do {
     t1 = seconds;
     t2 = seconds;
   } while(t1 != t2);
   return t1;
+#endif
 }
 /*---------------------------------------------------------------------------*/
 rtimer_clock_t
@@ -50,4 +50,10 @@
 
 rtimer_clock_t rtimer_arch_now(void);
 
+/* Interrupt masking for the rtimer queue (RTIMER_CONF_QUEUE) */
+#include "msp430def.h"
+typedef spl_t rtimer_arch_irq_t;
+#define rtimer_arch_irq_disable() splhigh()
+#define rtimer_arch_irq_restore(s) splx(s)
+
 #endif /* __RTIMER_ARCH_H__ */
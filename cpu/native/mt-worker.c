@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Worker threads for the native platforms
+ */
+
+#include "mt-worker.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef MT_WORKER_CONF_THREADS
+#define MT_WORKER_THREADS MT_WORKER_CONF_THREADS
+#else /* MT_WORKER_CONF_THREADS */
+#define MT_WORKER_THREADS 2
+#endif /* MT_WORKER_CONF_THREADS */
+
+#ifdef MT_WORKER_CONF_STACKSIZE
+#define MT_WORKER_STACKSIZE MT_WORKER_CONF_STACKSIZE
+#else /* MT_WORKER_CONF_STACKSIZE */
+#define MT_WORKER_STACKSIZE (256 * 1024)
+#endif /* MT_WORKER_CONF_STACKSIZE */
+
+#ifdef MT_WORKER_CONF_JOBS
+#define MT_WORKER_JOBS MT_WORKER_CONF_JOBS
+#else /* MT_WORKER_CONF_JOBS */
+#define MT_WORKER_JOBS 8
+#endif /* MT_WORKER_CONF_JOBS */
+
+#ifdef MT_WORKER_CONF_POSTS
+#define MT_WORKER_POSTS MT_WORKER_CONF_POSTS
+#else /* MT_WORKER_CONF_POSTS */
+#define MT_WORKER_POSTS 16
+#endif /* MT_WORKER_CONF_POSTS */
+
+struct job {
+  mt_worker_func_t func;
+  void *data;
+  struct process *p;
+};
+
+struct post {
+  struct process *p;
+  process_event_t ev;
+  process_data_t data;
+};
+
+/* Jobs waiting for a worker, protected by lock. */
+static struct job jobs[MT_WORKER_JOBS];
+static int job_first, job_count;
+
+/* Events waiting to be posted from the main thread, protected by lock. */
+static struct post posts[MT_WORKER_POSTS];
+static int post_first, post_count;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_added = PTHREAD_COND_INITIALIZER;
+
+process_event_t mt_worker_event;
+
+PROCESS(mt_worker_process, "Worker threads");
+/*---------------------------------------------------------------------------*/
+static void *
+worker(void *arg)
+{
+  struct job job;
+
+  while(1) {
+    pthread_mutex_lock(&lock);
+    while(job_count == 0) {
+      pthread_cond_wait(&job_added, &lock);
+    }
+    job = jobs[job_first];
+    job_first = (job_first + 1) % MT_WORKER_JOBS;
+    job_count--;
+    pthread_mutex_unlock(&lock);
+
+    job.func(job.data);
+
+    /* The job is finished only when its completion event is queued. */
+    while(mt_worker_post(job.p, mt_worker_event, job.data) != MT_WORKER_OK) {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+mt_worker_init(void)
+{
+  pthread_attr_t attr;
+  pthread_t thread;
+  int i;
+
+  mt_worker_event = process_alloc_event();
+  process_start(&mt_worker_process, NULL);
+
+  /* The threads and their stacks are created once and reused for
+     every job. */
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, MT_WORKER_STACKSIZE);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for(i = 0; i < MT_WORKER_THREADS; i++) {
+    if(pthread_create(&thread, &attr, worker, NULL) != 0) {
+      perror("mt-worker: pthread_create");
+      exit(1);
+    }
+  }
+  pthread_attr_destroy(&attr);
+}
+/*---------------------------------------------------------------------------*/
+int
+mt_worker_start(mt_worker_func_t func, void *data, struct process *p)
+{
+  struct job *job;
+
+  pthread_mutex_lock(&lock);
+  if(job_count == MT_WORKER_JOBS) {
+    pthread_mutex_unlock(&lock);
+    return MT_WORKER_ERR_FULL;
+  }
+  job = &jobs[(job_first + job_count) % MT_WORKER_JOBS];
+  job->func = func;
+  job->data = data;
+  job->p = p;
+  job_count++;
+  pthread_cond_signal(&job_added);
+  pthread_mutex_unlock(&lock);
+  return MT_WORKER_OK;
+}
+/*---------------------------------------------------------------------------*/
+int
+mt_worker_post(struct process *p, process_event_t ev, process_data_t data)
+{
+  struct post *post;
+
+  pthread_mutex_lock(&lock);
+  if(post_count == MT_WORKER_POSTS) {
+    pthread_mutex_unlock(&lock);
+    return MT_WORKER_ERR_FULL;
+  }
+  post = &posts[(post_first + post_count) % MT_WORKER_POSTS];
+  post->p = p;
+  post->ev = ev;
+  post->data = data;
+  post_count++;
+  pthread_mutex_unlock(&lock);
+
+  /* Like an interrupt handler, wake the main thread with a poll. */
+  process_poll(&mt_worker_process);
+#if SELECT_CONF_WAKEUP
+  select_wakeup();
+#endif /* SELECT_CONF_WAKEUP */
+  return MT_WORKER_OK;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(mt_worker_process, ev, data)
+{
+  struct post post;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    pthread_mutex_lock(&lock);
+    while(post_count > 0) {
+      post = posts[post_first];
+      if(process_post(post.p, post.ev, post.data) != PROCESS_ERR_OK) {
+        /* The event queue is full; try again on the next poll. */
+        process_poll(&mt_worker_process);
+        break;
+      }
+      post_first = (post_first + 1) % MT_WORKER_POSTS;
+      post_count--;
+    }
+    pthread_mutex_unlock(&lock);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
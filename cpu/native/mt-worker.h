@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Worker threads for the native platforms
+ *
+ *         Long computations can be handed to a pool of operating
+ *         system threads so that they do not stall the event loop.
+ *         A worker reports back to Contiki processes with
+ *         mt_worker_post(), which is safe to call from any thread;
+ *         the event is delivered from the main thread.
+ */
+
+#ifndef __MT_WORKER_H__
+#define __MT_WORKER_H__
+
+#include "contiki.h"
+
+#define MT_WORKER_OK       0
+#define MT_WORKER_ERR_FULL 1
+
+typedef void (* mt_worker_func_t)(void *data);
+
+/**
+ * The event posted to the process that started a job when the job
+ * has finished. The event data is the data pointer of the job.
+ */
+extern process_event_t mt_worker_event;
+
+/**
+ * Start the worker threads. Called once at system startup.
+ */
+void mt_worker_init(void);
+
+/**
+ * Run func(data) on a worker thread. When it has returned,
+ * mt_worker_event is posted to process p with data as event data.
+ *
+ * \return MT_WORKER_OK, or MT_WORKER_ERR_FULL if the job queue is full.
+ */
+int mt_worker_start(mt_worker_func_t func, void *data, struct process *p);
+
+/**
+ * Post an event to a process from a worker thread.
+ *
+ * \return MT_WORKER_OK, or MT_WORKER_ERR_FULL if too many posts are
+ *         waiting for delivery.
+ */
+int mt_worker_post(struct process *p, process_event_t ev, process_data_t data);
+
+#endif /* __MT_WORKER_H__ */
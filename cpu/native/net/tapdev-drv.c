@@ -42,6 +42,14 @@
 
 #include "tapdev-drv.h"
 
+/* Frames handled per poll. Each is passed up the stack before the
+   next one is read into uip_buf. */
+#ifdef TAPDEV_CONF_RX_BATCH
+#define TAPDEV_RX_BATCH TAPDEV_CONF_RX_BATCH
+#else
+#define TAPDEV_RX_BATCH 16
+#endif
+
 #define BUF ((struct uip_eth_hdr *)&uip_buf[0])
 #define IPBUF ((struct uip_tcpip_hdr *)&uip_buf[UIP_LLH_LEN])
 
@@ -61,9 +69,14 @@ tapdev_output(void)
 static void
 pollhandler(void)
 {
-  uip_len = tapdev_poll();
+  int i;
+
+  for(i = 0; i < TAPDEV_RX_BATCH; i++) {
+    uip_len = tapdev_poll();
+    if(uip_len == 0) {
+      return;
+    }
 
-  if(uip_len > 0) {
 #if UIP_CONF_IPV6
     if(BUF->type == uip_htons(UIP_ETHTYPE_IPV6)) {
       tcpip_input();
@@ -86,6 +99,9 @@ pollhandler(void)
       uip_len = 0;
     }
   }
+
+  /* More frames may be waiting */
+  process_poll(&tapdev_process);
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(tapdev_process, ev, data)
@@ -38,6 +38,7 @@
 
 #if UIP_CONF_IPV6
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -111,30 +112,24 @@ tapdev_fd(void)
 uint16_t
 tapdev_poll(void)
 {
-  fd_set fdset;
-  struct timeval tv;
   int ret;
-  
-  tv.tv_sec = 0;
-  tv.tv_usec = 0;
-  
-  FD_ZERO(&fdset);
-  if(fd > 0) {
-    FD_SET(fd, &fdset);
-  }
-
-  ret = select(fd + 1, &fdset, NULL, NULL, &tv);
 
-  if(ret == 0) {
+  if(fd <= 0) {
     return 0;
   }
+
+  /* The fd is non-blocking: one read() per frame, and no select()
+     beforehand to find out whether there is one */
   ret = read(fd, uip_buf, UIP_BUFSIZE);
 
-  PRINTF("tapdev6: read %d bytes (max %d)\n", ret, UIP_BUFSIZE);
-  
   if(ret == -1) {
-    perror("tapdev_poll: read");
+    if(errno != EAGAIN && errno != EINTR) {
+      perror("tapdev_poll: read");
+    }
+    return 0;
   }
+
+  PRINTF("tapdev6: read %d bytes (max %d)\n", ret, UIP_BUFSIZE);
   return ret;
 }
 /*---------------------------------------------------------------------------*/
@@ -318,6 +313,8 @@ tapdev_init(void)
   tapdev_init_darwin_routes();
 #endif
 
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
   /* Linux (ubuntu)
      snprintf(buf, sizeof(buf), "ip link set tap0 up");
      system(buf);
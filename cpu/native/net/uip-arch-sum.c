@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Internet checksum for the native platforms, using SSE2 when
+ *         the compiler has it
+ */
+
+#include <string.h>
+
+#include "net/uip.h"
+#include "net/uip_arch.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif /* __SSE2__ */
+
+#if UIP_ARCH_SUM
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_arch_sum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint64_t acc;
+  uint32_t w;
+  uint16_t h;
+#ifdef __SSE2__
+  __m128i zero, lo, hi, v;
+  uint32_t lanes[4];
+#endif /* __SSE2__ */
+
+  /* The data is added up in host byte order, as RFC 1071 allows,
+     and the carries are folded back in at the end. */
+  acc = 0;
+
+#ifdef __SSE2__
+  if(len >= 16) {
+    /* Widen eight 16-bit words at a time into 32-bit lanes. A lane
+       gets at most 8192 words, so it cannot overflow. */
+    zero = _mm_setzero_si128();
+    lo = hi = zero;
+    for(; len >= 16; len -= 16, data += 16) {
+      v = _mm_loadu_si128((const __m128i *)data);
+      lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(v, zero));
+      hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(v, zero));
+    }
+    _mm_storeu_si128((__m128i *)lanes, _mm_add_epi32(lo, hi));
+    acc = (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+#endif /* __SSE2__ */
+
+  for(; len >= 4; len -= 4, data += 4) {
+    memcpy(&w, data, sizeof(w));
+    acc += w;
+  }
+  if(len >= 2) {
+    memcpy(&h, data, sizeof(h));
+    acc += h;
+    data += 2;
+    len -= 2;
+  }
+  if(len > 0) {
+    /* The last byte is the first half of a 16-bit word. */
+    h = 0;
+    memcpy(&h, data, 1);
+    acc += h;
+  }
+
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
+  }
+
+#if UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN
+  /* A little-endian sum is the byte-swapped big-endian sum. */
+  acc = ((acc & 0xff) << 8) | (acc >> 8);
+#endif /* UIP_BYTE_ORDER == UIP_LITTLE_ENDIAN */
+
+  acc += sum;
+  acc = (acc & 0xffff) + (acc >> 16);
+  return (uint16_t)acc;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_ARCH_SUM */
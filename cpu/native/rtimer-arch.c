@@ -60,6 +60,9 @@ interrupt(int sig)
 {
   signal(sig, interrupt);
   rtimer_run_next();
+#if SELECT_CONF_WAKEUP
+  select_wakeup();
+#endif /* SELECT_CONF_WAKEUP */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -70,6 +73,25 @@ rtimer_arch_init(void)
 #endif /* !_WIN32 */
 }
 /*---------------------------------------------------------------------------*/
+#ifndef _WIN32
+rtimer_arch_irq_t
+rtimer_arch_block_alarm(void)
+{
+  sigset_t alarm, old;
+
+  sigemptyset(&alarm);
+  sigaddset(&alarm, SIGALRM);
+  sigprocmask(SIG_BLOCK, &alarm, &old);
+  return old;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_restore_alarm(rtimer_arch_irq_t s)
+{
+  sigprocmask(SIG_SETMASK, &s, NULL);
+}
+#endif /* !_WIN32 */
+/*---------------------------------------------------------------------------*/
 void
 rtimer_arch_schedule(rtimer_clock_t t)
 {
@@ -46,4 +46,21 @@
 
 #define rtimer_arch_now() clock_time()
 
+#ifndef _WIN32
+#include <signal.h>
+
+/* rtimer_run_next() runs from the SIGALRM handler, so the rtimer queue
+   is protected by blocking SIGALRM. */
+typedef sigset_t rtimer_arch_irq_t;
+rtimer_arch_irq_t rtimer_arch_block_alarm(void);
+void rtimer_arch_restore_alarm(rtimer_arch_irq_t s);
+#define rtimer_arch_irq_disable() rtimer_arch_block_alarm()
+#define rtimer_arch_irq_restore(s) rtimer_arch_restore_alarm(s)
+#else /* _WIN32 */
+/* No SIGALRM, so nothing interrupts the rtimer queue */
+typedef int rtimer_arch_irq_t;
+#define rtimer_arch_irq_disable() 0
+#define rtimer_arch_irq_restore(s) (void)(s)
+#endif /* _WIN32 */
+
 #endif /* __RTIMER_ARCH_H__ */
@@ -88,4 +88,7 @@ typedef unsigned int size_t;
 
 #define snprintf(a...)
 
+/* 16-bit loads and stores are not atomic, see lib/ringbuf.h */
+#define RINGBUF_CONF_INDEX_T uint8_t
+
 #endif /* __Z80_DEF_H__ */
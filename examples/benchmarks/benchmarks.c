@@ -0,0 +1,510 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Micro-benchmarks for core data structures, timers and the
+ *         6LoWPAN header compressor
+ *
+ *         Each benchmark repeats a batch of operations until at
+ *         least BENCHMARK_MIN_TIME rtimer ticks have been spent in
+ *         them, and prints a line
+ *
+ *           BENCH <name> <operations> <rtimer ticks> <ticks per second>
+ *
+ *         that tools/benchmarks/compare-benchmarks turns into
+ *         nanoseconds per operation and compares between runs.
+ *         Batches are kept short so that 16-bit rtimers do not wrap
+ *         while one is measured.
+ */
+
+#include "contiki.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "lib/mmem.h"
+#include "lib/fft.h"
+#include "lib/ifft.h"
+#include "dev/watchdog.h"
+
+#if UIP_CONF_IPV6
+#include "contiki-net.h"
+#include "net/netstack.h"
+#include "net/nbr-table.h"
+#include "net/uip-ds6.h"
+#endif /* UIP_CONF_IPV6 */
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef BENCHMARK_CONF_MIN_TIME
+#define BENCHMARK_MIN_TIME BENCHMARK_CONF_MIN_TIME
+#else /* BENCHMARK_CONF_MIN_TIME */
+#define BENCHMARK_MIN_TIME (RTIMER_ARCH_SECOND / 2)
+#endif /* BENCHMARK_CONF_MIN_TIME */
+
+/* Number of items in the list, memb and mmem workloads */
+#define ITEMS   32
+/* Number of timers in the timer storms */
+#define TIMERS  16
+/* Packets per batch in the 6LoWPAN workloads */
+#define PACKETS 8
+
+/*---------------------------------------------------------------------------*/
+PROCESS(benchmark_process, "Benchmarks");
+#if UIP_CONF_IPV6
+PROCESS(sink_process, "Benchmark UDP sink");
+#endif /* UIP_CONF_IPV6 */
+AUTOSTART_PROCESSES(&benchmark_process);
+/*---------------------------------------------------------------------------*/
+struct item {
+  struct item *next;
+  uint16_t key;
+};
+
+LIST(items);
+MEMB(items_memb, struct item, ITEMS);
+static struct item item_storage[ITEMS];
+static struct mmem mmems[ITEMS];
+
+static unsigned long total_ops, total_ticks;
+static rtimer_clock_t batch_start;
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name)
+{
+  printf("BENCH %s %lu %lu %lu\n", name, total_ops, total_ticks,
+         (unsigned long)RTIMER_ARCH_SECOND);
+  total_ops = total_ticks = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+batch_begin(void)
+{
+  watchdog_periodic();
+  batch_start = RTIMER_NOW();
+}
+/*---------------------------------------------------------------------------*/
+static void
+batch_end(unsigned long ops)
+{
+  total_ticks += (rtimer_clock_t)(RTIMER_NOW() - batch_start);
+  total_ops += ops;
+}
+/*---------------------------------------------------------------------------*/
+/* Runs batches of a workload that needs no waiting until enough time
+   has been measured. */
+static void
+run(const char *name, unsigned long (*batch)(void))
+{
+  while(total_ticks < BENCHMARK_MIN_TIME) {
+    batch_begin();
+    batch_end(batch());
+  }
+  report(name);
+}
+/*---------------------------------------------------------------------------*/
+/* Builds a list, finds every item in it and takes it apart again. */
+static unsigned long
+list_batch(void)
+{
+  struct item *i;
+  uint16_t key;
+
+  list_init(items);
+  for(key = 0; key < ITEMS; key++) {
+    item_storage[key].key = key;
+    list_add(items, &item_storage[key]);
+  }
+  for(key = 0; key < ITEMS; key++) {
+    for(i = list_head(items); i != NULL && i->key != key; i = list_item_next(i));
+    if(i != NULL) {
+      list_remove(items, i);
+    }
+  }
+  return 2 * ITEMS;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+memb_batch(void)
+{
+  static struct item *allocated[ITEMS];
+  int i;
+
+  for(i = 0; i < ITEMS; i++) {
+    allocated[i] = memb_alloc(&items_memb);
+  }
+  for(i = 0; i < ITEMS; i++) {
+    memb_free(&items_memb, allocated[i]);
+  }
+  return 2 * ITEMS;
+}
+/*---------------------------------------------------------------------------*/
+#define FFT_POINTS 256
+static int16_t fft_samples[FFT_POINTS], fft_work[FFT_POINTS];
+
+static void
+fft_fill(void)
+{
+  int i;
+
+  /* A square wave with a period of 16 samples, in 8-bit range so
+     that ifft() does not overflow. */
+  for(i = 0; i < FFT_POINTS; i++) {
+    fft_samples[i] = (i & 8) ? 100 : -100;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+fft_batch(void)
+{
+  fft_fill();
+  fft_spectrum(fft_samples, fft_work, FFT_POINTS);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+ifft_batch(void)
+{
+  fft_fill();
+  ifft(fft_samples, fft_work, FFT_POINTS);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Frees every other block first, so that mmem has to compact. */
+static unsigned long
+mmem_batch(void)
+{
+  int i;
+
+  for(i = 0; i < ITEMS; i++) {
+    mmem_alloc(&mmems[i], 8 + i);
+  }
+  for(i = 0; i < ITEMS; i += 2) {
+    mmem_free(&mmems[i]);
+  }
+  for(i = 1; i < ITEMS; i += 2) {
+    mmem_free(&mmems[i]);
+  }
+  return 2 * ITEMS;
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_CONF_IPV6
+#define UIP_IP_BUF   ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_UDP_BUF  ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+struct bench_nbr {
+  uint8_t dummy;
+};
+NBR_TABLE(struct bench_nbr, bench_nbrs);
+
+static rimeaddr_t nbr_addr;
+static uip_lladdr_t peer_lladdr;
+static uip_ipaddr_t peer_ipaddr, route_addr;
+static unsigned long received;
+
+struct canned {
+  uint8_t packet[UIP_BUFSIZE - UIP_LLH_LEN];
+  uint16_t packet_len;
+  uint8_t frame[PACKETBUF_SIZE];
+  uint16_t frame_len;
+};
+static struct canned link_local, global;
+static struct canned *current;
+/*---------------------------------------------------------------------------*/
+static void
+set_nbr_addr(uint16_t i)
+{
+  memset(&nbr_addr, 0, sizeof(nbr_addr));
+  nbr_addr.u8[0] = 0x02;
+  nbr_addr.u8[sizeof(nbr_addr) - 2] = i >> 8;
+  nbr_addr.u8[sizeof(nbr_addr) - 1] = i;
+}
+/*---------------------------------------------------------------------------*/
+/* Adds twice as many neighbors as fit, so that the table has to evict,
+   then looks up and removes the ones that are left. */
+static unsigned long
+nbr_batch(void)
+{
+  struct bench_nbr *n;
+  uint16_t i;
+
+  for(i = 0; i < 2 * NBR_TABLE_MAX_NEIGHBORS; i++) {
+    set_nbr_addr(i);
+    nbr_table_add_lladdr(bench_nbrs, &nbr_addr);
+  }
+  for(i = 0; i < 2 * NBR_TABLE_MAX_NEIGHBORS; i++) {
+    set_nbr_addr(i);
+    n = nbr_table_get_from_lladdr(bench_nbrs, &nbr_addr);
+    if(n != NULL) {
+      nbr_table_remove(bench_nbrs, n);
+    }
+  }
+  return 4 * NBR_TABLE_MAX_NEIGHBORS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_route_addr(uint16_t prefix, uint16_t i)
+{
+  uip_ip6addr(&route_addr, prefix, 0, 0, 0, 0, 0, 0, i + 1);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+route_add_rm_batch(void)
+{
+  uip_ds6_route_t *r;
+  uint16_t i;
+
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    set_route_addr(0xaaaa, i);
+    uip_ds6_route_add(&route_addr, 128, &peer_ipaddr);
+  }
+  while((r = uip_ds6_route_head()) != NULL) {
+    uip_ds6_route_rm(r);
+  }
+  return 2 * UIP_DS6_ROUTE_NB;
+}
+/*---------------------------------------------------------------------------*/
+/* Looks up every route in a full table and as many misses. */
+static unsigned long
+route_lookup_batch(void)
+{
+  uint16_t i;
+
+  for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+    set_route_addr(0xaaaa, i);
+    uip_ds6_route_lookup(&route_addr);
+    set_route_addr(0xbbbb, i);
+    uip_ds6_route_lookup(&route_addr);
+  }
+  return 2 * UIP_DS6_ROUTE_NB;
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(struct canned *c, uint16_t prefix, uint16_t srcport,
+            uint16_t destport, uint16_t payload_len)
+{
+  uip_lladdr_t our_lladdr;
+
+  memcpy(&our_lladdr, &uip_lladdr, sizeof(our_lladdr));
+  memset(uip_buf, 0, UIP_BUFSIZE);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->len[0] = (UIP_UDPH_LEN + payload_len) >> 8;
+  UIP_IP_BUF->len[1] = (UIP_UDPH_LEN + payload_len) & 0xff;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, prefix, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&UIP_IP_BUF->srcipaddr, &our_lladdr);
+  uip_ip6addr(&UIP_IP_BUF->destipaddr, prefix, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&UIP_IP_BUF->destipaddr, &peer_lladdr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(srcport);
+  UIP_UDP_BUF->destport = UIP_HTONS(destport);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + payload_len);
+  memset(&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN], 'b', payload_len);
+  UIP_UDP_BUF->udpchksum = ~(uip_udpchksum());
+  if(UIP_UDP_BUF->udpchksum == 0) {
+    UIP_UDP_BUF->udpchksum = 0xffff;
+  }
+  c->packet_len = UIP_IPUDPH_LEN + payload_len;
+  memcpy(c->packet, &uip_buf[UIP_LLH_LEN], c->packet_len);
+
+  /* The frame that comes back is the same packet as the peer would
+     compress it for us. The UDP checksum does not depend on the order
+     of the addresses. */
+  uip_ds6_set_addr_iid(&UIP_IP_BUF->srcipaddr, &peer_lladdr);
+  uip_ds6_set_addr_iid(&UIP_IP_BUF->destipaddr, &our_lladdr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(destport);
+  UIP_UDP_BUF->destport = UIP_HTONS(srcport);
+  uip_len = c->packet_len;
+  memcpy(&uip_lladdr, &peer_lladdr, sizeof(uip_lladdr));
+  rimeaddr_copy(&rimeaddr_node_addr, (rimeaddr_t *)&peer_lladdr);
+  tcpip_output(&our_lladdr);
+  c->frame_len = packetbuf_copyto(c->frame);
+  memcpy(&uip_lladdr, &our_lladdr, sizeof(uip_lladdr));
+  rimeaddr_copy(&rimeaddr_node_addr, (rimeaddr_t *)&our_lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+compress_batch(void)
+{
+  int i;
+
+  for(i = 0; i < PACKETS; i++) {
+    memcpy(&uip_buf[UIP_LLH_LEN], current->packet, current->packet_len);
+    uip_len = current->packet_len;
+    tcpip_output(&peer_lladdr);
+  }
+  return PACKETS;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+decompress_batch(void)
+{
+  int i;
+
+  for(i = 0; i < PACKETS; i++) {
+    packetbuf_clear();
+    packetbuf_copyfrom(current->frame, current->frame_len);
+    NETSTACK_FRAMER.parse();
+    NETSTACK_NETWORK.input();
+  }
+  return PACKETS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_iphc(const char *compress_name, const char *decompress_name,
+         struct canned *c)
+{
+  current = c;
+  run(compress_name, compress_batch);
+  received = 0;
+  run(decompress_name, decompress_batch);
+  if(received == 0) {
+    printf("%s: packets were not delivered\n", decompress_name);
+  }
+}
+#endif /* UIP_CONF_IPV6 */
+/*---------------------------------------------------------------------------*/
+static int ctimers_fired;
+
+static void
+ctimer_callback(void *ptr)
+{
+  if(++ctimers_fired == TIMERS) {
+    process_poll(&benchmark_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(benchmark_process, ev, data)
+{
+  static struct etimer etimers[TIMERS];
+  static struct ctimer ctimers[TIMERS];
+  static int i, expired;
+
+  PROCESS_BEGIN();
+
+  printf("Benchmarks starting\n");
+
+  run("list", list_batch);
+
+  memb_init(&items_memb);
+  run("memb", memb_batch);
+
+  mmem_init();
+  run("mmem", mmem_batch);
+
+  run("fft-spectrum-256", fft_batch);
+  run("ifft-256", ifft_batch);
+
+  /* Timer storms: all timers expire at once, so this measures setting
+     them and dispatching their expiration, not waiting for them. */
+  while(total_ticks < BENCHMARK_MIN_TIME) {
+    batch_begin();
+    for(i = 0; i < TIMERS; i++) {
+      etimer_set(&etimers[i], 0);
+    }
+    for(expired = 0; expired < TIMERS; expired++) {
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    }
+    batch_end(TIMERS);
+  }
+  report("etimer-storm");
+
+  while(total_ticks < BENCHMARK_MIN_TIME) {
+    batch_begin();
+    ctimers_fired = 0;
+    for(i = 0; i < TIMERS; i++) {
+      ctimer_set(&ctimers[i], 0, ctimer_callback, NULL);
+    }
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    batch_end(TIMERS);
+  }
+  report("ctimer-storm");
+
+#if UIP_CONF_IPV6
+  nbr_table_register(bench_nbrs, NULL);
+  run("nbr-table-churn", nbr_batch);
+
+  memcpy(&peer_lladdr, &uip_lladdr, sizeof(peer_lladdr));
+  peer_lladdr.addr[sizeof(peer_lladdr) - 1] ^= 0x55;
+  uip_ip6addr(&peer_ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&peer_ipaddr, &peer_lladdr);
+  if(uip_ds6_nbr_add(&peer_ipaddr, &peer_lladdr, 0, NBR_REACHABLE) == NULL) {
+    printf("route benchmarks: could not add the next hop\n");
+  } else {
+    run("route-add-remove", route_add_rm_batch);
+    for(i = 0; i < UIP_DS6_ROUTE_NB; i++) {
+      set_route_addr(0xaaaa, i);
+      uip_ds6_route_add(&route_addr, 128, &peer_ipaddr);
+    }
+    run("route-lookup", route_lookup_batch);
+  }
+
+  process_start(&sink_process, NULL);
+  uip_ip6addr(&route_addr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&route_addr, &uip_lladdr);
+  uip_ds6_addr_add(&route_addr, 0, ADDR_MANUAL);
+  make_packet(&link_local, 0xfe80, 0xf0b1, 0xf0b2, 16);
+  make_packet(&global, 0xaaaa, 5683, 5684, 64);
+  run_iphc("iphc-compress-link-local", "iphc-decompress-link-local",
+           &link_local);
+  run_iphc("iphc-compress-global", "iphc-decompress-global", &global);
+#endif /* UIP_CONF_IPV6 */
+
+  printf("Benchmarks done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_CONF_IPV6
+PROCESS_THREAD(sink_process, ev, data)
+{
+  static struct uip_udp_conn *conn1, *conn2;
+
+  PROCESS_BEGIN();
+
+  /* Receive what the decompression benchmarks feed into uIP. */
+  conn1 = udp_new(NULL, 0, NULL);
+  udp_bind(conn1, UIP_HTONS(0xf0b1));
+  conn2 = udp_new(NULL, 0, NULL);
+  udp_bind(conn2, UIP_HTONS(5683));
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+    if(uip_newdata()) {
+      received++;
+    }
+  }
+
+  PROCESS_END();
+}
+#endif /* UIP_CONF_IPV6 */
+/*---------------------------------------------------------------------------*/
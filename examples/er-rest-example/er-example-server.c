@@ -47,6 +47,7 @@
 #define REST_RES_HELLO 0
 #define REST_RES_CHUNKS 1
 #define REST_RES_SEPARATE 1
+#define REST_RES_SLOW 0
 #define REST_RES_PUSHING 1
 #define REST_RES_EVENT 1
 #define REST_RES_SUB 1
@@ -463,6 +464,68 @@ separate_finalize_handler()
 }
 #endif
 
+/******************************************************************************/
+#if REST_RES_SLOW && WITH_COAP == 13
+#include "er-coap-13-separate.h"
+/*
+ * Example for the pool of separate requests.
+ * The representation takes SLOW_SECONDS to produce. GETs for the same query that arrive in
+ * the meantime are queued and answered with the same result. The periodic handler drives the
+ * slow operation and resumes the waiting requests when it is done.
+ */
+PERIODIC_RESOURCE(slow, METHOD_GET, "test/slow", "title=\"Slow demo: ?q=..\"", CLOCK_SECOND);
+
+#define SLOW_SECONDS 3
+
+static uint8_t slow_remaining = 0; /* seconds until the representation is ready, 0 if idle */
+static uint16_t slow_key;
+static char slow_buffer[REST_MAX_CHUNK_SIZE];
+
+void
+slow_handler(void* request, void* response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  const char *query = NULL;
+  int len = REST.get_query(request, &query);
+  uint16_t key;
+
+  if (!slow_remaining)
+  {
+    /* Prepared before queueing, as the separate ACK overwrites the request. */
+    snprintf(slow_buffer, sizeof(slow_buffer), "Slow result for '%.*s'", len, query);
+  }
+
+  switch (coap_separate_queue(&resource_slow, request, &key))
+  {
+    case COAP_SEPARATE_START:
+      if (slow_remaining)
+      {
+        /* The example runs one slow operation at a time. */
+        coap_separate_complete(&resource_slow, key, SERVICE_UNAVAILABLE_5_03, REST.type.TEXT_PLAIN, (uint8_t *)"Busy", 4);
+        break;
+      }
+      slow_key = key;
+      slow_remaining = SLOW_SECONDS;
+      break;
+    case COAP_SEPARATE_QUEUED:
+      /* Joined the operation that is already running. */
+      break;
+    default:
+      /* COAP_SEPARATE_FULL: the pool already answered with 5.03. */
+      break;
+  }
+}
+
+void
+slow_periodic_handler(resource_t *r)
+{
+  if (slow_remaining && --slow_remaining==0)
+  {
+    PRINTF("Slow done: %d waiting\n", coap_separate_pending(r, slow_key));
+    coap_separate_complete(r, slow_key, REST.status.OK, REST.type.TEXT_PLAIN, (uint8_t *)slow_buffer, strlen(slow_buffer));
+  }
+}
+#endif
+
 /******************************************************************************/
 #if REST_RES_PUSHING
 /*
@@ -822,6 +885,9 @@ PROCESS_THREAD(rest_server_example, ev, data)
 #if REST_RES_PUSHING
   rest_activate_periodic_resource(&periodic_resource_pushing);
 #endif
+#if REST_RES_SLOW && WITH_COAP == 13
+  rest_activate_periodic_resource(&periodic_resource_slow);
+#endif
 #if defined (PLATFORM_HAS_BUTTON) && REST_RES_EVENT
   rest_activate_event_resource(&resource_event);
 #endif
@@ -175,8 +175,8 @@ PT_THREAD(generate_routes(struct httpd_state *s))
     ipaddr_add(&r->ipaddr);
     ADD("/%u (via ", r->length);
     ipaddr_add(uip_ds6_route_nexthop(r));
-    if(r->state.lifetime < 600) {
-      ADD(") %lus\n", (unsigned long)r->state.lifetime);
+    if(RPL_ROUTE_LIFETIME(r) < 600) {
+      ADD(") %lus\n", RPL_ROUTE_LIFETIME(r));
     } else {
       ADD(")\n");
     }
@@ -248,8 +248,8 @@ PT_THREAD(generate_routes(struct httpd_state *s))
 #endif
     ADD("/%u (via ", r->length);
     ipaddr_add(uip_ds6_route_nexthop(r));
-    if(1 || (r->state.lifetime < 600)) {
-      ADD(") %lus\n", r->state.lifetime);
+    if(1 || (RPL_ROUTE_LIFETIME(r) < 600)) {
+      ADD(") %lus\n", RPL_ROUTE_LIFETIME(r));
     } else {
       ADD(")\n");
     }
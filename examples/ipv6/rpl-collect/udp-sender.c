@@ -141,7 +141,7 @@ collect_common_send(void)
       }
     }
     rtmetric = dag->rank;
-    beacon_interval = (uint16_t) ((2L << dag->instance->dio_intcurrent) / 1000);
+    beacon_interval = (uint16_t) (2 * dag->instance->dio_timer.i_cur / CLOCK_SECOND);
     num_neighbors = RPL_PARENT_COUNT(dag);
   } else {
     rtmetric = 0;
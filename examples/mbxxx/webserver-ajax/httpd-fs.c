@@ -80,6 +80,8 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
     if(httpd_fs_strcmp(name, f->name) == 0) {
       file->data = f->data;
       file->len = f->len - 1;
+      file->header = NULL;
+      file->segments = NULL;
 #if HTTPD_FS_STATISTICS
       ++count[i];
 #endif /* HTTPD_FS_STATISTICS */
@@ -93,6 +95,18 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
   return 0;
 }
 /*-----------------------------------------------------------------------------------*/
+int
+httpd_fs_open_gzip(const char *name, struct httpd_fs_file *file)
+{
+  return httpd_fs_open(name, file);
+}
+/*-----------------------------------------------------------------------------------*/
+uint8_t
+httpd_fs_match_etag(const char *name, const char *etag)
+{
+  return 0;
+}
+/*-----------------------------------------------------------------------------------*/
 void
 httpd_fs_init(void)
 {
@@ -50,6 +50,9 @@
 
 #include <stdint.h>
 
+/* Ring buffer indices must be atomic on the AVR */
+#define RINGBUF_CONF_INDEX_T uint8_t
+
 /* The AVR tick interrupt usually is done with an 8 bit counter around 128 Hz.
  * 125 Hz needs slightly more overhead during the interrupt, as does a 32 bit
  * clock_time_t.
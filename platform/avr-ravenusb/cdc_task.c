@@ -608,8 +608,8 @@ extern uip_ds6_netif_t uip_ds6_if;
 					ipaddr_add(&route->ipaddr);
 					PRINTF_P(PSTR("/%u (via "), route->length);
 					ipaddr_add(uip_ds6_route_nexthop(route));
-					if(route->state.lifetime < 600) {
-						PRINTF_P(PSTR(") %lus\n\r"), route->state.lifetime);
+					if(RPL_ROUTE_LIFETIME(route) < 600) {
+						PRINTF_P(PSTR(") %lus\n\r"), RPL_ROUTE_LIFETIME(route));
 					 } else {
 						PRINTF_P(PSTR(")\n\r"));
 					}
@@ -56,6 +56,9 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+
+/* Ring buffer indices must be atomic on the AVR */
+#define RINGBUF_CONF_INDEX_T uint8_t
 #include <string.h>
 
 #include <avr/eeprom.h>
@@ -684,8 +684,8 @@ extern uip_ds6_netif_t uip_ds6_if;
       uip_debug_ipaddr_print(&r->ipaddr);
       PRINTA("/%u (via ", r->length);
       uip_debug_ipaddr_print(uip_ds6_route_nexthop(r));
- //     if(r->state.lifetime < 600) {
-        PRINTA(") %lus\n", r->state.lifetime);
+ //     if(RPL_ROUTE_LIFETIME(r) < 600) {
+        PRINTA(") %lus\n", RPL_ROUTE_LIFETIME(r));
  //     } else {
  //       PRINTA(")\n");
  //     }
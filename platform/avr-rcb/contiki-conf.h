@@ -44,6 +44,9 @@
 
 #include <stdint.h>
 
+/* Ring buffer indices must be atomic on the AVR */
+#define RINGBUF_CONF_INDEX_T uint8_t
+
 //typedef int32_t s32_t;
 
 /*
@@ -50,6 +50,9 @@
 #endif
 
 #include <stdint.h>
+
+/* Ring buffer indices must be atomic on the AVR */
+#define RINGBUF_CONF_INDEX_T uint8_t
 #include <avr/eeprom.h>
 
 /* Skip the last four bytes of the EEPROM, to leave room for things
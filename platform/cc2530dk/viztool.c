@@ -127,7 +127,7 @@ process_request() CC_NON_BANKED
       if(rt != NULL) {
         entry_size = sizeof(i) + sizeof(rt->ipaddr)
           + sizeof(rt->length)
-          + sizeof(rt->state.lifetime)
+          + sizeof(uint32_t)
           + sizeof(rt->state.learned_from);
 
         memcpy(buf + len, &i, sizeof(i));
@@ -142,10 +142,10 @@ process_request() CC_NON_BANKED
         PRINTF(" - ");
         PRINT6ADDR(uip_ds6_route_nexthop(rt));
 
-        flip = uip_htonl(rt->state.lifetime);
+        flip = uip_htonl(RPL_ROUTE_LIFETIME(rt));
         memcpy(buf + len, &flip, sizeof(flip));
         len += sizeof(flip);
-        PRINTF(" - %08lx", rt->state.lifetime);
+        PRINTF(" - %08lx", RPL_ROUTE_LIFETIME(rt));
 
         memcpy(buf + len, &rt->state.learned_from,
                sizeof(rt->state.learned_from));
@@ -47,15 +47,21 @@ typedef uint32_t rtimer_clock_t;
  * otherwise
  * @{
  */
+#define USB_MAX_ENDPOINTS           5
 #define CTRL_EP_SIZE                8
 #define USB_EP1_SIZE               32
 #define USB_EP2_SIZE               64
 #define USB_EP3_SIZE               64
+#define USB_EP4_SIZE               64
 #define USB_ARCH_WRITE_NOTIFY       0
 
 #ifndef USB_ARCH_CONF_DMA
 #define USB_ARCH_CONF_DMA           1 /**< Change to Enable/Disable USB DMA */
 
+#endif
+
+#ifndef USB_ARCH_CONF_DOUBLE_BUFFER
+#define USB_ARCH_CONF_DOUBLE_BUFFER 1 /**< Double-buffer bulk EP FIFOs */
 #endif
 /** @} */
 /*---------------------------------------------------------------------------*/
@@ -68,6 +74,15 @@ typedef uint32_t rtimer_clock_t;
 #define ENERGEST_CONF_ON            0 /**< Energest Module */
 #endif
 
+/**
+ * \brief Energest types for the time spent in PM1 and PM2
+ *
+ * Both are part of ENERGEST_TYPE_LPM, which also includes PM0
+ */
+#ifndef ENERGEST_CONF_PLATFORM_ADDITIONS
+#define ENERGEST_CONF_PLATFORM_ADDITIONS ENERGEST_TYPE_PM1, ENERGEST_TYPE_PM2,
+#endif
+
 #ifndef STARTUP_CONF_VERBOSE
 #define STARTUP_CONF_VERBOSE        1 /**< Set to 0 to decrease startup verbosity */
 #endif
@@ -82,6 +97,8 @@ typedef uint32_t rtimer_clock_t;
 #define USB_ARCH_CONF_TX_DMA_CHAN   1 /**< RAM -> USB DMA channel */
 #define CC2538_RF_CONF_TX_DMA_CHAN  2 /**< RF -> RAM DMA channel */
 #define CC2538_RF_CONF_RX_DMA_CHAN  3 /**< RAM -> RF DMA channel */
+#define UART_CONF_RX_DMA_CHAN       8 /**< UART -> RAM DMA channel */
+#define UART_CONF_TX_DMA_CHAN       9 /**< RAM -> UART DMA channel */
 #define UDMA_CONF_MAX_CHANNEL       CC2538_RF_CONF_RX_DMA_CHAN
 /** @} */
 /*---------------------------------------------------------------------------*/
@@ -98,9 +115,21 @@ typedef uint32_t rtimer_clock_t;
 #define UART_CONF_BAUD_RATE    115200 /**< Default baud rate */
 #endif
 
+/*
+ * Move UART data with the uDMA: RX into ping-pong buffers handed over in
+ * blocks, TX of whole blocks written with uart_write(). Costs the RAM of the
+ * RX buffers and of the uDMA control structures up to channel 9
+ */
+#ifndef UART_CONF_USE_DMA
+#define UART_CONF_USE_DMA           0 /**< UART RX/TX over uDMA */
+#endif
+
 #ifndef SLIP_ARCH_CONF_USB
 #define SLIP_ARCH_CONF_USB          0 /**< SLIP over UART by default */
 #endif
+#ifndef SLIP_CONF_RX_RINGSIZE
+#define SLIP_CONF_RX_RINGSIZE     512 /**< Room for a few USB/uDMA blocks */
+#endif
 #ifndef CC2538_RF_CONF_SNIFFER_USB
 #define CC2538_RF_CONF_SNIFFER_USB  0 /**< Sniffer out over UART by default */
 #endif
@@ -242,6 +271,20 @@ typedef uint32_t rtimer_clock_t;
 #ifndef LPM_CONF_STATS
 #define LPM_CONF_STATS        0 /**< Set to 1 to enable LPM-related stats */
 #endif
+
+/**
+ * \brief Exit latency of PM1 and PM2 in rtimer ticks
+ *
+ * The Sleep Timer is programmed to wake us up this much ahead of the next
+ * rtimer task, so that the 32MHz XOSC is stable by the time the task runs
+ */
+#ifndef LPM_CONF_PM1_EXIT_LATENCY
+#define LPM_CONF_PM1_EXIT_LATENCY 2
+#endif
+
+#ifndef LPM_CONF_PM2_EXIT_LATENCY
+#define LPM_CONF_PM2_EXIT_LATENCY 8
+#endif
 /** @} */
 /*---------------------------------------------------------------------------*/
 /**
@@ -290,6 +333,50 @@ typedef uint32_t rtimer_clock_t;
 #define CC2538_RF_CONF_TX_USE_DMA            1 /**< RF TX over DMA */
 #endif
 
+/*
+ * Stream the header and payload buffers passed to prepare_v() to the TX FIFO
+ * with a single scatter-gather uDMA transfer. Costs the RAM of the uDMA
+ * alternate channel control structures
+ */
+#ifndef CC2538_RF_CONF_TX_USE_SG_DMA
+#define CC2538_RF_CONF_TX_USE_SG_DMA         0 /**< RF TX over sg DMA */
+#endif
+
+#if CC2538_RF_CONF_TX_USE_DMA && CC2538_RF_CONF_TX_USE_SG_DMA
+#define UDMA_CONF_MAX_ALT_CHANNEL   CC2538_RF_CONF_TX_DMA_CHAN
+#endif
+
+/* UART RX over uDMA uses the alternate structure for ping-pong transfers */
+#if UART_CONF_USE_DMA
+#undef UDMA_CONF_MAX_CHANNEL
+#define UDMA_CONF_MAX_CHANNEL       UART_CONF_TX_DMA_CHAN
+#undef UDMA_CONF_MAX_ALT_CHANNEL
+#define UDMA_CONF_MAX_ALT_CHANNEL   UART_CONF_RX_DMA_CHAN
+#endif
+
+/*
+ * Timer triggered ADC sampling over uDMA (dev/adc-sampler.h). The sampled
+ * AIN pin selects the uDMA channel, 14-17 for AIN0-3 and 24-27 for AIN4-7,
+ * whose alternate structure is used for ping-pong transfers
+ */
+#ifndef ADC_SAMPLER_CONF_ENABLE
+#define ADC_SAMPLER_CONF_ENABLE     0 /**< ADC block sampler */
+#endif
+
+#ifndef ADC_SAMPLER_CONF_AIN
+#define ADC_SAMPLER_CONF_AIN        0 /**< AIN pin sampled */
+#endif
+
+#if ADC_SAMPLER_CONF_ENABLE
+#define ADC_SAMPLER_CONF_DMA_CHAN   (ADC_SAMPLER_CONF_AIN < 4 ? \
+                                     14 + ADC_SAMPLER_CONF_AIN : \
+                                     20 + ADC_SAMPLER_CONF_AIN)
+#undef UDMA_CONF_MAX_CHANNEL
+#define UDMA_CONF_MAX_CHANNEL       ADC_SAMPLER_CONF_DMA_CHAN
+#undef UDMA_CONF_MAX_ALT_CHANNEL
+#define UDMA_CONF_MAX_ALT_CHANNEL   ADC_SAMPLER_CONF_DMA_CHAN
+#endif
+
 #ifndef CC2538_RF_CONF_RX_USE_DMA
 #define CC2538_RF_CONF_RX_USE_DMA            1 /**< RF RX over DMA */
 #endif
@@ -301,6 +388,9 @@ typedef uint32_t rtimer_clock_t;
  * @{
  */
 
+/* Checksums are computed by cpu/arm/common/net/uip-arch-sum.c */
+#define UIP_ARCH_SUM                         1
+
 /* Don't let contiki-default-conf.h decide if we are an IPv6 build */
 #ifndef UIP_CONF_IPV6
 #define UIP_CONF_IPV6                        0
@@ -142,6 +142,9 @@ main(void)
   watchdog_init();
   button_sensor_init();
 
+  /* Before the UART, which may configure uDMA channels */
+  udma_init();
+
   /*
    * Character I/O Initialisation.
    * When the UART receives a character it will call serial_line_input_byte to
@@ -180,8 +183,6 @@ main(void)
   /* Initialise the H/W RNG engine. */
   random_init(0);
 
-  udma_init();
-
   process_start(&etimer_process, NULL);
   ctimer_init();
 
@@ -50,7 +50,8 @@
 #define FWD_ID "fWd:"
 #define FWD_ID_LENGTH 4
 #define FWD_NEXT_IP FWD_ID_LENGTH
-#define FWD_PACKET_LENGTH (FWD_NEXT_IP + 4)
+#define FWD_PREV_IP (FWD_NEXT_IP + 4)
+#define FWD_PACKET_LENGTH (FWD_PREV_IP + 4)
 
 /* Acknowledgement packet */
 #define ACK_ID "aCk"
@@ -191,6 +192,14 @@ receiver(const struct radio_driver *d)
     process_post(&radio_uip_process, EVENT_SEND_ACK, (void*) (uint32_t) crc);
   }
 
+  /* Learn the way back to the sender through the previous hop */
+  {
+    uip_ipaddr_t prevhop;
+    memcpy(&prevhop, &uip_buf[UIP_LLH_LEN + FWD_PREV_IP], 4);
+    uaodv_learn_route(&((struct uip_udpip_hdr *)&uip_buf[UIP_LLH_LEN + FWD_PACKET_LENGTH])->srcipaddr,
+                      &prevhop);
+  }
+
   /* Strip header and receive packet */
   uip_len = radio_uip_uaodv_remove_header(&uip_buf[UIP_LLH_LEN], uip_len);
   tcpip_input();
@@ -237,6 +246,7 @@ radio_uip_uaodv_send(void)
       
     return UIP_FW_DROPPED;
   }
+  uaodv_rt_used(route);
   
   /* Add header and buffer packet for persistent transmission */
   uip_len = radio_uip_uaodv_add_header(&uip_buf[UIP_LLH_LEN], uip_len, uip_ds6_route_nexthop(route)); /* TODO Correct? */
@@ -361,6 +371,7 @@ radio_uip_uaodv_add_header(uint8_t *buf, int len, uip_ipaddr_t *addr)
   memcpy(&buf[FWD_PACKET_LENGTH], tempbuf, len);
   memcpy(buf, FWD_ID, FWD_ID_LENGTH);
   memcpy(&buf[FWD_NEXT_IP], (char*)addr, 4);
+  memcpy(&buf[FWD_PREV_IP], &uip_hostaddr, 4);
   return FWD_PACKET_LENGTH + len;     
 }
 /*---------------------------------------------------------------------------*/
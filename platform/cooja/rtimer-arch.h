@@ -43,4 +43,9 @@ int rtimer_arch_check(void);
 int rtimer_arch_pending(void);
 rtimer_clock_t rtimer_arch_next(void);
 
+/* Cooja runs motes single-threaded, nothing interrupts the rtimer queue */
+typedef int rtimer_arch_irq_t;
+#define rtimer_arch_irq_disable() 0
+#define rtimer_arch_irq_restore(s) (void)(s)
+
 #endif /* __RTIMER_ARCH_H__ */
@@ -307,6 +307,10 @@ main(int argc, char **argv)
      * Idle processing.
      */
     int s = splhigh();          /* Disable interrupts. */
+#if CLOCK_CONF_TICKLESS
+    /* Arm the clock for the next etimer before sleeping */
+    clock_update_wakeup();
+#endif
     /* uart1_active is for avoiding LPM3 when still sending or receiving */
     if(process_nevents() != 0 || uart1_active()) {
       splx(s);                  /* Re-enable interrupts. */
@@ -95,6 +95,10 @@ typedef unsigned long rtimer_clock_t;
 
 #define UIP_ARCH_ADD32           1
 #define UIP_ARCH_CHKSUM          0
+#ifdef __GNUC__
+/* The word-wise checksum in cpu/arm/common/net uses GCC inline assembly. */
+#define UIP_ARCH_SUM             1
+#endif /* __GNUC__ */
 
 #define UIP_CONF_BYTE_ORDER      UIP_LITTLE_ENDIAN
 
@@ -143,6 +143,7 @@ typedef unsigned short uip_stats_t;
 #define UIP_CONF_MAX_LISTENPORTS      40
 #define UIP_CONF_MAX_CONNECTIONS      40
 #define UIP_CONF_BYTE_ORDER           UIP_LITTLE_ENDIAN
+#define UIP_ARCH_SUM                  1
 #define UIP_CONF_TCP_SPLIT            0
 #define UIP_CONF_IP_FORWARD           0
 #define UIP_CONF_LOGGING              0
@@ -44,6 +44,12 @@ struct select_callback {
 };
 int select_set_callback(int fd, const struct select_callback *callback);
 
+/* The main loop sleeps in select() until an fd is ready or the next
+   etimer expires. Code that polls processes from other threads or
+   from signal handlers must wake it with select_wakeup(). */
+void select_wakeup(void);
+#define SELECT_CONF_WAKEUP 1
+
 #define CC_CONF_REGISTER_ARGS          1
 #define CC_CONF_FUNCTION_POINTER_ARGS  1
 #define CC_CONF_FASTCALL
@@ -70,6 +76,7 @@ typedef unsigned short uip_stats_t;
 #define UIP_CONF_MAX_LISTENPORTS 40
 #define UIP_CONF_BUFFER_SIZE     420
 #define UIP_CONF_BYTE_ORDER      UIP_LITTLE_ENDIAN
+#define UIP_ARCH_SUM             1
 #define UIP_CONF_TCP       1
 #define UIP_CONF_TCP_SPLIT       0
 #define UIP_CONF_LOGGING         0
@@ -31,6 +31,8 @@
  *
  */
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -69,6 +71,9 @@
 static const struct select_callback *select_callback[SELECT_MAX];
 static int select_max = 0;
 
+/* Self-pipe used to wake the main loop from select() */
+static int wakeup_fd[2] = { -1, -1 };
+
 SENSORS(&pir_sensor, &vib_sensor, &button_sensor);
 
 static uint8_t serial_id[] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
@@ -106,6 +111,92 @@ select_set_callback(int fd, const struct select_callback *callback)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+void
+select_wakeup(void)
+{
+  char c = 0;
+
+  /* Called from threads and signal handlers; write() is safe in both.
+     A full pipe already holds a pending wakeup. */
+  if(wakeup_fd[1] >= 0) {
+    if(write(wakeup_fd[1], &c, 1) < 0) {
+      /* Ignore */
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+wakeup_set_fd(fd_set *rset, fd_set *wset)
+{
+  FD_SET(wakeup_fd[0], rset);
+  return 1;
+}
+static void
+wakeup_handle_fd(fd_set *rset, fd_set *wset)
+{
+  char buf[16];
+  if(FD_ISSET(wakeup_fd[0], rset)) {
+    while(read(wakeup_fd[0], buf, sizeof(buf)) > 0);
+  }
+}
+const static struct select_callback wakeup_fd_callback = {
+  wakeup_set_fd, wakeup_handle_fd
+};
+/*---------------------------------------------------------------------------*/
+static void
+wakeup_init(void)
+{
+  if(pipe(wakeup_fd) < 0) {
+    perror("pipe");
+    wakeup_fd[0] = wakeup_fd[1] = -1;
+    return;
+  }
+  fcntl(wakeup_fd[0], F_SETFL, fcntl(wakeup_fd[0], F_GETFL) | O_NONBLOCK);
+  fcntl(wakeup_fd[1], F_SETFL, fcntl(wakeup_fd[1], F_GETFL) | O_NONBLOCK);
+  if(!select_set_callback(wakeup_fd[0], &wakeup_fd_callback)) {
+    close(wakeup_fd[0]);
+    close(wakeup_fd[1]);
+    wakeup_fd[0] = wakeup_fd[1] = -1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Time to sleep in select(): nothing while events are pending, until
+ * the next etimer expiration otherwise, and forever when there are no
+ * timers. Without a wakeup pipe, sleep at most one millisecond.
+ */
+static struct timeval *
+select_timeout(struct timeval *tv, int events_pending)
+{
+  clock_time_t now, next, diff;
+
+  tv->tv_sec = 0;
+  tv->tv_usec = 0;
+  if(events_pending) {
+    return tv;
+  }
+
+  if(etimer_pending()) {
+    next = etimer_next_expiration_time();
+    now = clock_time();
+    diff = next - now;
+    if(diff > ((clock_time_t)~0) / 2) {
+      /* Already expired */
+      return tv;
+    }
+    tv->tv_sec = diff / CLOCK_SECOND;
+    tv->tv_usec = (diff % CLOCK_SECOND) * (1000000 / CLOCK_SECOND);
+  } else if(wakeup_fd[0] >= 0) {
+    return NULL;
+  }
+
+  if(wakeup_fd[0] < 0 && (tv->tv_sec > 0 || tv->tv_usec > 1000)) {
+    tv->tv_sec = 0;
+    tv->tv_usec = 1000;
+  }
+  return tv;
+}
+/*---------------------------------------------------------------------------*/
 static int
 stdin_set_fd(fd_set *rset, fd_set *wset)
 {
@@ -116,9 +207,14 @@ static void
 stdin_handle_fd(fd_set *rset, fd_set *wset)
 {
   char c;
+  int len;
   if(FD_ISSET(STDIN_FILENO, rset)) {
-    if(read(STDIN_FILENO, &c, 1) > 0) {
+    len = read(STDIN_FILENO, &c, 1);
+    if(len > 0) {
       serial_line_input_byte(c);
+    } else if(len == 0) {
+      /* End of file: stop watching stdin, it would always be ready */
+      select_set_callback(STDIN_FILENO, NULL);
     }
   }
 }
@@ -235,18 +331,18 @@ main(int argc, char **argv)
   setvbuf(stdout, (char *)NULL, _IONBF, 0);
 
   select_set_callback(STDIN_FILENO, &stdin_fd);
+  wakeup_init();
   while(1) {
     fd_set fdr;
     fd_set fdw;
     int maxfd;
     int i;
     int retval;
-    struct timeval tv;
+    struct timeval tv, *timeout;
 
     retval = process_run();
 
-    tv.tv_sec = 0;
-    tv.tv_usec = retval ? 1 : 1000;
+    timeout = select_timeout(&tv, retval);
 
     FD_ZERO(&fdr);
     FD_ZERO(&fdw);
@@ -257,9 +353,11 @@ main(int argc, char **argv)
       }
     }
 
-    retval = select(maxfd + 1, &fdr, &fdw, NULL, &tv);
+    retval = select(maxfd + 1, &fdr, &fdw, NULL, timeout);
     if(retval < 0) {
-      perror("select");
+      if(errno != EINTR) {
+        perror("select");
+      }
     } else if(retval > 0) {
       /* timeout => retval == 0 */
       for(i = 0; i <= maxfd; i++) {
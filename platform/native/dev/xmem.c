@@ -39,26 +39,56 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define XMEM_SIZE 1024 * 1024
 
+/*
+ * With XMEM_CONF_FILE set to a file name, the memory is a shared
+ * mapping of that file, so its contents persist between runs while
+ * accesses still go at memory speed.
+ */
+#ifdef XMEM_CONF_FILE
+#include <sys/mman.h>
+
+static unsigned char *xmem;
+#else /* XMEM_CONF_FILE */
 static unsigned char xmem[XMEM_SIZE];
+#endif /* XMEM_CONF_FILE */
+/*---------------------------------------------------------------------------*/
+#ifdef XMEM_CONF_FILE
+static void
+map_file(void)
+{
+  int fd;
+  void *p;
+
+  fd = open(XMEM_CONF_FILE, O_RDWR | O_CREAT, 0644);
+  if(fd < 0 || ftruncate(fd, XMEM_SIZE) < 0) {
+    perror("xmem: " XMEM_CONF_FILE);
+    exit(1);
+  }
+  p = mmap(NULL, XMEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(p == MAP_FAILED) {
+    perror("xmem: mmap");
+    exit(1);
+  }
+  /* The mapping stays valid after the descriptor is closed */
+  close(fd);
+  xmem = p;
+}
+#define MAP() do { if(xmem == NULL) { map_file(); } } while(0)
+#else /* XMEM_CONF_FILE */
+#define MAP()
+#endif /* XMEM_CONF_FILE */
 /*---------------------------------------------------------------------------*/
 int
 xmem_pwrite(const void *buf, int size, unsigned long offset)
 {
-  /*  int f;
-  char name[400];
-
-  snprintf(name, sizeof(name), "xmem.%d.%d", node_x(), node_y());
-  f = open(name, O_WRONLY | O_APPEND | O_CREAT, 0644);
-  lseek(f, addr, SEEK_SET);
-  write(f, buf, size);
-  close(f);*/
-
   /*  printf("xmem_write(offset 0x%02x, buf %p, size %l);\n", offset, buf, size);*/
 
+  MAP();
   memcpy(&xmem[offset], buf, size);
   return size;
 }
@@ -67,6 +97,7 @@ int
 xmem_pread(void *buf, int size, unsigned long offset)
 {
   /*  printf("xmem_read(addr 0x%02x, buf %p, size %d);\n", addr, buf, size);*/
+  MAP();
   memcpy(buf, &xmem[offset], size);
   return size;
 }
@@ -75,13 +106,40 @@ int
 xmem_erase(long nbytes, unsigned long offset)
 {
   /*  printf("xmem_read(addr 0x%02x, buf %p, size %d);\n", addr, buf, size);*/
+  MAP();
   memset(&xmem[offset], 0, nbytes);
   return nbytes;
 }
 /*---------------------------------------------------------------------------*/
+int
+xmem_erase_async(long nbytes, unsigned long offset, struct process *p)
+{
+  xmem_erase(nbytes, offset);
+  if(p != NULL) {
+    process_poll(p);
+  }
+  return nbytes;
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_busy(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_flush(void)
+{
+#ifdef XMEM_CONF_FILE
+  if(xmem != NULL) {
+    msync(xmem, XMEM_SIZE, MS_ASYNC);
+  }
+#endif /* XMEM_CONF_FILE */
+}
+/*---------------------------------------------------------------------------*/
 void
 xmem_init(void)
 {
-
+  MAP();
 }
 /*---------------------------------------------------------------------------*/
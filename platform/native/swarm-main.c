@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Main loop for running many Contiki nodes in one process
+ *
+ *         Build with "make TARGET=native SWARM=1". All nodes run the
+ *         same program. Each node has its own copy of the program's
+ *         .data and .bss sections; the copy of the node that runs is
+ *         swapped into place, in the same way as Cooja motes are run.
+ *         Nodes are placed at random in a square area and hear every
+ *         node within radio range, through swarm-radio.
+ *
+ *         State that must survive node switches is kept on the heap.
+ *         rtimers are not supported, so the RDC layer should not
+ *         depend on them (nullrdc is the native default).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/uip.h"
+#include "net/rime.h"
+#include "dev/serial-line.h"
+#include "dev/swarm-radio.h"
+
+#if WITH_UIP6
+#include "net/uip-ds6.h"
+#endif /* WITH_UIP6 */
+
+/* Events handled per node before the next node gets to run */
+#ifdef SWARM_CONF_MAX_EVENTS
+#define SWARM_MAX_EVENTS SWARM_CONF_MAX_EVENTS
+#else
+#define SWARM_MAX_EVENTS 64
+#endif
+
+/* Section boundaries, defined by the linker */
+extern char __data_start[], _edata[], __bss_start[], _end[];
+
+struct swarm_packet {
+  struct swarm_packet *next;
+  unsigned short len;
+  uint8_t data[];
+};
+
+struct swarm_node {
+  uint16_t id;
+  double x, y;
+  char *mem;
+  int *neighbors;
+  int neighbor_count;
+  struct swarm_packet *rx_head, *rx_tail;
+  /* Scheduling state, saved when the node is unloaded */
+  int events;
+  int timer_pending;
+  clock_time_t next_timer;
+};
+
+/* Shared by all nodes. Only the pointer lives in .bss; it is set before
+   the nodes' memory is copied, so it is the same in every copy. */
+struct swarm {
+  int count;
+  struct swarm_node *nodes;
+  struct swarm_node *loaded;
+  char *pristine;
+  struct swarm_packet *tx_head, *tx_tail;
+  unsigned long tx_frames, rx_frames;
+};
+static struct swarm *swarm;
+
+int contiki_argc = 0;
+char **contiki_argv;
+/*---------------------------------------------------------------------------*/
+static size_t
+data_size(void)
+{
+  return _edata - __data_start;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+bss_size(void)
+{
+  return _end - __bss_start;
+}
+/*---------------------------------------------------------------------------*/
+static void
+mem_save(char *mem)
+{
+  memcpy(mem, __data_start, data_size());
+  memcpy(mem + data_size(), __bss_start, bss_size());
+}
+/*---------------------------------------------------------------------------*/
+static void
+mem_load(const char *mem)
+{
+  memcpy(__data_start, mem, data_size());
+  memcpy(__bss_start, mem + data_size(), bss_size());
+}
+/*---------------------------------------------------------------------------*/
+static void
+load(struct swarm_node *node)
+{
+  struct swarm *s = swarm;
+
+  if(s->loaded == node) {
+    return;
+  }
+  if(s->loaded != NULL) {
+    mem_save(s->loaded->mem);
+  }
+  mem_load(node->mem);
+  s->loaded = node;
+}
+/*---------------------------------------------------------------------------*/
+void
+swarm_radio_output(const void *data, unsigned short len)
+{
+  struct swarm_packet *p;
+
+  p = malloc(sizeof(struct swarm_packet) + len);
+  if(p == NULL) {
+    return;
+  }
+  p->next = NULL;
+  p->len = len;
+  memcpy(p->data, data, len);
+  if(swarm->tx_tail != NULL) {
+    swarm->tx_tail->next = p;
+  } else {
+    swarm->tx_head = p;
+  }
+  swarm->tx_tail = p;
+  swarm->tx_frames++;
+}
+/*---------------------------------------------------------------------------*/
+/* Queue the frames sent by a node at each of its neighbours */
+static void
+deliver(struct swarm_node *sender)
+{
+  struct swarm_packet *p, *copy;
+  struct swarm_node *dest;
+  int i;
+
+  while(swarm->tx_head != NULL) {
+    p = swarm->tx_head;
+    swarm->tx_head = p->next;
+    for(i = 0; i < sender->neighbor_count; i++) {
+      dest = &swarm->nodes[sender->neighbors[i]];
+      copy = malloc(sizeof(struct swarm_packet) + p->len);
+      if(copy == NULL) {
+        continue;
+      }
+      memcpy(copy, p, sizeof(struct swarm_packet) + p->len);
+      copy->next = NULL;
+      if(dest->rx_tail != NULL) {
+        dest->rx_tail->next = copy;
+      } else {
+        dest->rx_head = copy;
+      }
+      dest->rx_tail = copy;
+    }
+    free(p);
+  }
+  swarm->tx_tail = NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(struct swarm_node *node)
+{
+  struct swarm_packet *p;
+  int n;
+
+  load(node);
+
+  while(node->rx_head != NULL) {
+    p = node->rx_head;
+    node->rx_head = p->next;
+    swarm_radio_input(p->data, p->len);
+    swarm->rx_frames++;
+    free(p);
+  }
+  node->rx_tail = NULL;
+
+  etimer_request_poll();
+  for(n = 0; n < SWARM_MAX_EVENTS && process_run() > 0; n++);
+
+  node->events = process_nevents() > 0;
+  node->timer_pending = etimer_pending();
+  node->next_timer = etimer_next_expiration_time();
+
+  deliver(node);
+}
+/*---------------------------------------------------------------------------*/
+static void
+node_init(struct swarm_node *node)
+{
+  uint8_t serial_id[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+  rimeaddr_t addr;
+
+  serial_id[6] = node->id >> 8;
+  serial_id[7] = node->id & 0xff;
+
+  memset(&addr, 0, sizeof(rimeaddr_t));
+#if UIP_CONF_IPV6
+  memcpy(addr.u8, serial_id, sizeof(addr.u8));
+#else
+  addr.u8[0] = serial_id[7];
+  addr.u8[1] = serial_id[6];
+#endif
+  rimeaddr_set_node_addr(&addr);
+
+  process_init();
+  process_start(&etimer_process, NULL);
+  ctimer_init();
+
+  queuebuf_init();
+  netstack_init();
+
+#if WITH_UIP6
+  memcpy(&uip_lladdr.addr, serial_id, sizeof(uip_lladdr.addr));
+  process_start(&tcpip_process, NULL);
+  {
+    uip_ds6_addr_t *lladdr;
+    lladdr = uip_ds6_get_link_local(-1);
+    lladdr->state = ADDR_AUTOCONF;
+  }
+#else
+  process_start(&tcpip_process, NULL);
+#endif
+
+  serial_line_init();
+
+  autostart_start(autostart_processes);
+}
+/*---------------------------------------------------------------------------*/
+static void
+topology_init(double area, double range)
+{
+  struct swarm_node *a, *b;
+  int i, j;
+
+  for(i = 0; i < swarm->count; i++) {
+    a = &swarm->nodes[i];
+    a->x = area * rand() / RAND_MAX;
+    a->y = area * rand() / RAND_MAX;
+  }
+  for(i = 0; i < swarm->count; i++) {
+    a = &swarm->nodes[i];
+    a->neighbors = malloc(swarm->count * sizeof(int));
+    if(a->neighbors == NULL) {
+      perror("swarm: malloc");
+      exit(1);
+    }
+    for(j = 0; j < swarm->count; j++) {
+      b = &swarm->nodes[j];
+      if(i != j && hypot(a->x - b->x, a->y - b->y) <= range) {
+        a->neighbors[a->neighbor_count++] = j;
+      }
+    }
+    a->neighbors = realloc(a->neighbors, (a->neighbor_count + 1) * sizeof(int));
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+select_set_callback(int fd, const struct select_callback *callback)
+{
+  /* Nodes have no file descriptors of their own */
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+select_wakeup(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  struct swarm_node *node;
+  clock_time_t now, wait;
+  double area = 100, range = 30;
+  int count = 10, seed = 1;
+  int c, i, waiting;
+  size_t size;
+
+  while((c = getopt(argc, argv, "n:a:r:s:")) != -1) {
+    switch(c) {
+    case 'n':
+      count = atoi(optarg);
+      break;
+    case 'a':
+      area = atof(optarg);
+      break;
+    case 'r':
+      range = atof(optarg);
+      break;
+    case 's':
+      seed = atoi(optarg);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-n nodes] [-a area] [-r range] [-s seed]\n",
+              argv[0]);
+      exit(1);
+    }
+  }
+  contiki_argc = argc - optind + 1;
+  contiki_argv = argv + optind - 1;
+
+  if(count < 1 || count > 0xffff) {
+    fprintf(stderr, "swarm: bad node count %d\n", count);
+    exit(1);
+  }
+
+  setvbuf(stdout, (char *)NULL, _IONBF, 0);
+  srand(seed);
+
+  size = data_size() + bss_size();
+  swarm = calloc(1, sizeof(struct swarm));
+  if(swarm == NULL) {
+    perror("swarm: calloc");
+    exit(1);
+  }
+  swarm->count = count;
+  swarm->nodes = calloc(count, sizeof(struct swarm_node));
+  swarm->pristine = malloc(size);
+  if(swarm->nodes == NULL || swarm->pristine == NULL) {
+    perror("swarm: calloc");
+    exit(1);
+  }
+  topology_init(area, range);
+  mem_save(swarm->pristine);
+
+  printf(CONTIKI_VERSION_STRING " swarm: %d nodes, %lu bytes per node\n",
+         count, (unsigned long)size);
+  printf("MAC %s RDC %s NETWORK %s\n", NETSTACK_MAC.name, NETSTACK_RDC.name,
+         NETSTACK_NETWORK.name);
+
+  for(i = 0; i < count; i++) {
+    node = &swarm->nodes[i];
+    node->id = i + 1;
+    node->mem = malloc(size);
+    if(node->mem == NULL) {
+      perror("swarm: malloc");
+      exit(1);
+    }
+    memcpy(node->mem, swarm->pristine, size);
+    load(node);
+    node_init(node);
+    run(node);
+  }
+
+  while(1) {
+    now = clock_time();
+    waiting = 0;
+    wait = CLOCK_SECOND;
+
+    for(i = 0; i < count; i++) {
+      node = &swarm->nodes[i];
+      if(node->events || node->rx_head != NULL ||
+         (node->timer_pending && (long)(node->next_timer - now) <= 0)) {
+        run(node);
+      }
+      if(node->events || node->rx_head != NULL) {
+        wait = 0;
+      } else if(node->timer_pending) {
+        if((long)(node->next_timer - now) <= 0) {
+          wait = 0;
+        } else if(node->next_timer - now < wait) {
+          wait = node->next_timer - now;
+        }
+        waiting = 1;
+      }
+    }
+
+    if(wait > 0) {
+      /* Nothing to do before the first timer expires; without timers,
+         nothing will ever happen again */
+      if(!waiting) {
+        wait = CLOCK_SECOND;
+      }
+      usleep(wait * (1000000 / CLOCK_SECOND));
+    }
+  }
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+log_message(char *m1, char *m2)
+{
+  fprintf(stderr, "%s%s\n", m1, m2);
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_log(char *m)
+{
+  fprintf(stderr, "%s\n", m);
+}
+/*---------------------------------------------------------------------------*/
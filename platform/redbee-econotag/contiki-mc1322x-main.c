@@ -624,7 +624,7 @@ extern uip_ds6_netif_t uip_ds6_if;
       ipaddr_add(&r->ipaddr);
       PRINTF("/%u (via ", r->length);
       ipaddr_add(uip_ds6_route_nexthop(r));
-       PRINTF(") %lus\n", r->state.lifetime);
+       PRINTF(") %lus\n", RPL_ROUTE_LIFETIME(r));
       j = 0;
     }
   }
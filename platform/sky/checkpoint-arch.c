@@ -130,7 +130,7 @@ typedef union {
 static int
 write_byte(int fd, uint8_t c)
 {
-  return cfs_write(fd, &c, 1);
+  return checkpoint_write(fd, &c, 1);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -146,7 +146,7 @@ static uint8_t
 read_byte(int fd)
 {
   uint8_t c;
-  cfs_read(fd, &c, 1);
+  checkpoint_read(fd, &c, 1);
   return c;
 }
 /*---------------------------------------------------------------------------*/
@@ -159,45 +159,31 @@ read_word(int fd)
   return tmp.u16;
 }
 /*---------------------------------------------------------------------------*/
-static void
-thread_checkpoint(int fd)
-{
 #if INCLUDE_RAM
-  unsigned char *addr;
-  uint16_t size = 0;
-  unsigned char *thread_mem_start = (unsigned char *)&checkpoint_thread.thread.stack;
-  unsigned char *thread_mem_end = thread_mem_start + sizeof(checkpoint_thread.thread.stack) - 1;
-  unsigned char *coffee_mem_start = cfs_coffee_get_protected_mem(&size);
-  unsigned char *coffee_mem_end = coffee_mem_start + size - 1;
-#endif /* INCLUDE_RAM */
+/* The stack of the checkpoint thread and the protected memory of
+   Coffee are left out of checkpoints. */
+static struct checkpoint_hole holes[2];
 
-  /*PRINTF("protected thread memory: %u, size=%u\n", (uint16_t) thread_mem_start, sizeof(checkpoint_thread.thread.stack));*/
-  /*PRINTF("protected coffee memory: %u, size=%u\n", (uint16_t) coffee_mem_start, size);*/
+static int
+set_holes(void)
+{
+  uint16_t size = 0;
 
+  holes[0].start = (unsigned char *)&checkpoint_thread.thread.stack;
+  holes[0].end = holes[0].start + sizeof(checkpoint_thread.thread.stack);
+  holes[1].start = cfs_coffee_get_protected_mem(&size);
+  holes[1].end = holes[1].start + size;
+  return 2;
+}
+#endif /* INCLUDE_RAM */
+/*---------------------------------------------------------------------------*/
+static void
+thread_checkpoint(int fd)
+{
   /* RAM */
 #if INCLUDE_RAM
-  for(addr = (unsigned char *)RAM_START;
-  addr < (unsigned char *)RAM_END;
-  addr++) {
-
-    if((addr >= thread_mem_start && addr <= thread_mem_end)) {
-      /* Skip */
-      continue;
-    }
-
-    if((addr >= coffee_mem_start && addr <= coffee_mem_end)) {
-      /* Skip */
-      continue;
-    }
-
-    /* TODO Use write_array() */
-    write_byte(fd, *addr);
-
-    /*if(((int)addr % 512) == 0) {
-      PRINTF(".");
-    }*/
-  }
-
+  checkpoint_mem_checkpoint(fd, (unsigned char *)RAM_START,
+                            (unsigned char *)RAM_END, holes, set_holes());
 #endif /* INCLUDE_RAM */
 
   /* Timers */
@@ -228,35 +214,10 @@ thread_checkpoint(int fd)
 static void
 thread_rollback(int fd)
 {
-#if INCLUDE_RAM
-  unsigned char *addr;
-  uint16_t size = 0;
-  unsigned char *thread_mem_start = (unsigned char *)&checkpoint_thread.thread.stack;
-  unsigned char *thread_mem_end = thread_mem_start + sizeof(checkpoint_thread.thread.stack) - 1;
-  unsigned char *coffee_mem_start = cfs_coffee_get_protected_mem(&size);
-  unsigned char *coffee_mem_end = coffee_mem_start + size - 1;
-#endif /* INCLUDE_RAM */
-
-  /*PRINTF("protected thread memory: %u, size=%u\n", (uint16_t) thread_mem_start, sizeof(checkpoint_thread.thread.stack));*/
-  /*PRINTF("protected coffee memory: %u, size=%u\n", (uint16_t) coffee_mem_start, size);*/
-
   /* RAM */
 #if INCLUDE_RAM
-  for(addr = (unsigned char *)RAM_START;
-  addr < (unsigned char *)RAM_END;
-  addr++) {
-    if((addr >= thread_mem_start && addr <= thread_mem_end)) {
-      /* Skip */
-      continue;
-    }
-
-    if((addr >= coffee_mem_start && addr <= coffee_mem_end)) {
-      /* Skip */
-      continue;
-    }
-
-    *addr = read_byte(fd);
-  }
+  checkpoint_mem_rollback(fd, (unsigned char *)RAM_START,
+                          (unsigned char *)RAM_END, holes, set_holes());
 #endif /* INCLUDE_RAM */
 
   /* Timers */
@@ -350,7 +311,8 @@ checkpoint_thread_loop(void *data)
 int
 checkpoint_arch_size()
 {
-  return 10258;
+  /* RAM, timers, LEDs and the padding byte */
+  return CHECKPOINT_MEM_SIZE(RAM_END - RAM_START) + 16 + 1 + 1;
 }
 /*---------------------------------------------------------------------------*/
 void
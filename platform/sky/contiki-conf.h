@@ -33,6 +33,11 @@
 #define CC2420_CONF_AUTOACK              1
 #endif /* CC2420_CONF_AUTOACK */
 
+/* Use the CC2420 AES engine, e.g. for link-layer security */
+#ifndef AES_128_CONF
+#define AES_128_CONF cc2420_aes_128_driver
+#endif /* AES_128_CONF */
+
 /* Specify whether the RDC layer should enable
    per-packet power profiling. */
 #define CONTIKIMAC_CONF_COMPOWER         1
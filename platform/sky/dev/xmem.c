@@ -64,6 +64,62 @@
 #define  SPI_FLASH_INS_BE          0xc7
 #define  SPI_FLASH_INS_DP          0xb9
 #define  SPI_FLASH_INS_RES         0xab
+
+#if SPI_DMA
+/* Bulk transfers hold the bus instead of disabling interrupts: the
+   radio driver defers its own bus access while spi_busy is set. The
+   bus is never held across a blocking call, so it is always free when
+   we get here from a process. */
+#define BUS_LOCK()   spi_acquire()
+#define BUS_UNLOCK() spi_release()
+
+static volatile unsigned char dma_done;
+#else /* SPI_DMA */
+#define BUS_LOCK()   s = splhigh()
+#define BUS_UNLOCK() splx(s)
+#endif /* SPI_DMA */
+
+#ifdef XMEM_CONF_PAGE_BUFFER
+#define PAGE_BUFFER XMEM_CONF_PAGE_BUFFER
+#else /* XMEM_CONF_PAGE_BUFFER */
+#define PAGE_BUFFER 0
+#endif /* XMEM_CONF_PAGE_BUFFER */
+
+/* How long a partially written page may stay in the page buffer. */
+#ifdef XMEM_CONF_FLUSH_TIME
+#define FLUSH_TIME XMEM_CONF_FLUSH_TIME
+#else /* XMEM_CONF_FLUSH_TIME */
+#define FLUSH_TIME CLOCK_SECOND
+#endif /* XMEM_CONF_FLUSH_TIME */
+
+/* How often a background erase polls the status register. */
+#ifdef XMEM_CONF_POLL_INTERVAL
+#define POLL_INTERVAL XMEM_CONF_POLL_INTERVAL
+#else /* XMEM_CONF_POLL_INTERVAL */
+#define POLL_INTERVAL (CLOCK_SECOND / 16)
+#endif /* XMEM_CONF_POLL_INTERVAL */
+
+#define PAGE_SIZE  256
+#define NO_PAGE    0xffffffffUL
+#define STATUS_WIP 0x01
+
+/* Sectors that remain to be erased in the background. */
+static unsigned long erase_next, erase_end;
+static struct process *erase_requester;
+
+PROCESS(xmem_erase_process, "xmem erase");
+
+#if PAGE_BUFFER
+/*
+ * A partially written page, in plain (not inverted) form. Programming
+ * can only set bits of the plain data, so writes to the same byte are
+ * ORed together, just as if each of them had been programmed.
+ */
+static unsigned char page_buf[PAGE_SIZE];
+static unsigned long page_addr = NO_PAGE;
+static unsigned short page_lo, page_hi;
+static struct ctimer flush_timer;
+#endif /* PAGE_BUFFER */
 /*---------------------------------------------------------------------------*/
 static void
 write_enable(void)
@@ -138,6 +194,72 @@ erase_sector(unsigned long offset)
   splx(s);
 }
 /*---------------------------------------------------------------------------*/
+#if SPI_DMA
+static void
+dma_callback(void *ptr)
+{
+  dma_done = 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Receive size bytes into p with DMA, sleeping until it is done.
+ */
+static void
+dma_read(unsigned char *p, int size)
+{
+  dma_done = 0;
+  spi_dma_transfer(NULL, p, size, dma_callback, NULL);
+  for(;;) {
+    dint();
+    if(dma_done) {
+      eint();
+      break;
+    }
+    /* The DMA interrupt brings us out of LPM0 */
+    _BIS_SR(GIE | CPUOFF);
+  }
+}
+#endif /* SPI_DMA */
+/*---------------------------------------------------------------------------*/
+/*
+ * Complete a background erase before the flash is used otherwise.
+ */
+static void
+finish_erase(void)
+{
+  while(erase_next < erase_end) {
+    erase_sector(erase_next);
+    erase_next += XMEM_ERASE_UNIT_SIZE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if PAGE_BUFFER
+/*
+ * Add the buffered writes to data that has been read from the flash.
+ */
+static void
+merge_page(unsigned char *p, int size, unsigned long offset)
+{
+  unsigned long i, end;
+
+  if(page_addr == NO_PAGE) {
+    return;
+  }
+
+  i = page_addr + page_lo;
+  if(i < offset) {
+    i = offset;
+  }
+  end = page_addr + page_hi;
+  if(end > offset + size) {
+    end = offset + size;
+  }
+  for(; i < end; i++) {
+    p[i - offset] |= page_buf[i - page_addr];
+  }
+}
+#endif /* PAGE_BUFFER */
+/*---------------------------------------------------------------------------*/
 /*
  * Initialize external flash *and* SPI bus!
  */
@@ -166,13 +288,16 @@ xmem_pread(void *_p, int size, unsigned long offset)
 {
   unsigned char *p = _p;
   const unsigned char *end = p + size;
+#if !SPI_DMA
   int s;
+#endif /* !SPI_DMA */
 
+  finish_erase();
   wait_ready();
 
   ENERGEST_ON(ENERGEST_TYPE_FLASH_READ);
 
-  s = splhigh();
+  BUS_LOCK();
   SPI_FLASH_ENABLE();
 
   SPI_WRITE_FAST(SPI_FLASH_INS_READ);
@@ -182,6 +307,17 @@ xmem_pread(void *_p, int size, unsigned long offset)
   SPI_WAITFORTx_ENDED();
   
   SPI_FLUSH();
+#if SPI_DMA
+  if(size > 0) {
+    dma_read(p, size);
+  }
+  SPI_FLASH_DISABLE();
+  BUS_UNLOCK();
+
+  for(; p < end; p++) {
+    *p = ~*p;
+  }
+#else /* SPI_DMA */
   for(; p < end; p++) {
     unsigned char u;
     SPI_READ(u);
@@ -189,10 +325,15 @@ xmem_pread(void *_p, int size, unsigned long offset)
   }
 
   SPI_FLASH_DISABLE();
-  splx(s);
+  BUS_UNLOCK();
+#endif /* SPI_DMA */
 
   ENERGEST_OFF(ENERGEST_TYPE_FLASH_READ);
 
+#if PAGE_BUFFER
+  merge_page(_p, size, offset);
+#endif /* PAGE_BUFFER */
+
   return size;
 }
 /*---------------------------------------------------------------------------*/
@@ -200,12 +341,14 @@ static const unsigned char *
 program_page(unsigned long offset, const unsigned char *p, int nbytes)
 {
   const unsigned char *end = p + nbytes;
+#if !SPI_DMA
   int s;
+#endif /* !SPI_DMA */
 
   wait_ready();
   write_enable();
 
-  s = splhigh();
+  BUS_LOCK();
   SPI_FLASH_ENABLE();
   
   SPI_WRITE_FAST(SPI_FLASH_INS_PP);
@@ -219,10 +362,75 @@ program_page(unsigned long offset, const unsigned char *p, int nbytes)
   SPI_WAITFORTx_ENDED();
 
   SPI_FLASH_DISABLE();
-  splx(s);
+  BUS_UNLOCK();
+
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_flush(void)
+{
+#if PAGE_BUFFER
+  if(page_addr == NO_PAGE) {
+    return;
+  }
+
+  ctimer_stop(&flush_timer);
+  if(page_lo < page_hi) {
+    finish_erase();
+    ENERGEST_ON(ENERGEST_TYPE_FLASH_WRITE);
+    program_page(page_addr + page_lo, &page_buf[page_lo], page_hi - page_lo);
+    ENERGEST_OFF(ENERGEST_TYPE_FLASH_WRITE);
+  }
+  page_addr = NO_PAGE;
+#endif /* PAGE_BUFFER */
+}
+/*---------------------------------------------------------------------------*/
+#if PAGE_BUFFER
+static void
+flush_callback(void *ptr)
+{
+  xmem_flush();
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Write within one page through the page buffer. The page is
+ * programmed once it has been written from start to end, when another
+ * page is written, or after FLUSH_TIME.
+ */
+static const unsigned char *
+buffer_page(unsigned long offset, const unsigned char *p, int nbytes)
+{
+  unsigned short i = offset & (PAGE_SIZE - 1);
+  unsigned short end = i + nbytes;
+
+  if(page_addr != offset - i) {
+    xmem_flush();
+    memset(page_buf, 0, sizeof(page_buf));
+    page_addr = offset - i;
+    page_lo = PAGE_SIZE;
+    page_hi = 0;
+  }
+
+  if(i < page_lo) {
+    page_lo = i;
+  }
+  if(end > page_hi) {
+    page_hi = end;
+  }
+  for(; i < end; i++) {
+    page_buf[i] |= *p++;
+  }
+
+  if(page_lo == 0 && page_hi == PAGE_SIZE) {
+    xmem_flush();
+  } else {
+    ctimer_set(&flush_timer, FLUSH_TIME, flush_callback, NULL);
+  }
 
   return p;
 }
+#endif /* PAGE_BUFFER */
 /*---------------------------------------------------------------------------*/
 int
 xmem_pwrite(const void *_buf, int size, unsigned long addr)
@@ -231,6 +439,8 @@ xmem_pwrite(const void *_buf, int size, unsigned long addr)
   const unsigned long end = addr + size;
   unsigned long i, next_page;
 
+  finish_erase();
+
   ENERGEST_ON(ENERGEST_TYPE_FLASH_WRITE);
 
   for(i = addr; i < end;) {
@@ -238,7 +448,11 @@ xmem_pwrite(const void *_buf, int size, unsigned long addr)
     if(next_page > end) {
       next_page = end;
     }
+#if PAGE_BUFFER
+    p = buffer_page(i, p, next_page - i);
+#else /* PAGE_BUFFER */
     p = program_page(i, p, next_page - i);
+#endif /* PAGE_BUFFER */
     i = next_page;
   }
 
@@ -247,21 +461,48 @@ xmem_pwrite(const void *_buf, int size, unsigned long addr)
   return size;
 }
 /*---------------------------------------------------------------------------*/
-int
-xmem_erase(long size, unsigned long addr)
+static int
+check_erase(long size, unsigned long addr)
 {
-  unsigned long end = addr + size;
-
   if(size % XMEM_ERASE_UNIT_SIZE != 0) {
     PRINTF("xmem_erase: bad size\n");
-    return -1;
+    return 0;
   }
 
   if(addr % XMEM_ERASE_UNIT_SIZE != 0) {
     PRINTF("xmem_erase: bad offset\n");
+    return 0;
+  }
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * A buffered page that is about to be erased need not be programmed.
+ */
+static void
+drop_page(unsigned long addr, unsigned long end)
+{
+#if PAGE_BUFFER
+  if(page_addr != NO_PAGE && page_addr >= addr && page_addr < end) {
+    ctimer_stop(&flush_timer);
+    page_addr = NO_PAGE;
+  }
+#endif /* PAGE_BUFFER */
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_erase(long size, unsigned long addr)
+{
+  unsigned long end = addr + size;
+
+  if(!check_erase(size, addr)) {
     return -1;
   }
 
+  finish_erase();
+  drop_page(addr, end);
+
   for (; addr < end; addr += XMEM_ERASE_UNIT_SIZE) {
     erase_sector(addr);
   }
@@ -269,3 +510,59 @@ xmem_erase(long size, unsigned long addr)
   return size;
 }
 /*---------------------------------------------------------------------------*/
+int
+xmem_erase_async(long size, unsigned long addr, struct process *p)
+{
+  if(!check_erase(size, addr)) {
+    return -1;
+  }
+
+  finish_erase();
+  drop_page(addr, addr + size);
+
+  if(erase_requester != NULL && erase_requester != p) {
+    /* Its erase has been completed by finish_erase() */
+    process_poll(erase_requester);
+  }
+  erase_requester = p;
+  erase_next = addr;
+  erase_end = addr + size;
+  process_start(&xmem_erase_process, NULL);
+
+  return size;
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_busy(void)
+{
+  return erase_next < erase_end || (read_status_register() & STATUS_WIP);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(xmem_erase_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  /* Start each sector once the flash is done with the previous one,
+     polling the status register instead of busy waiting. */
+  while(1) {
+    if(!(read_status_register() & STATUS_WIP)) {
+      if(erase_next >= erase_end) {
+        break;
+      }
+      erase_sector(erase_next);
+      erase_next += XMEM_ERASE_UNIT_SIZE;
+    }
+    etimer_set(&et, POLL_INTERVAL);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+
+  if(erase_requester != NULL) {
+    process_poll(erase_requester);
+    erase_requester = NULL;
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -123,6 +123,12 @@ typedef unsigned long off_t;
                                 /* USART0 Tx buffer ready? */
 #define SPI_WAITFORTxREADY() while ((IFG1 & UTXIFG0) == 0)
 
+/* Bulk transfers over DMA channels 1 and 2, with the bus held through
+   spi_busy rather than by disabling interrupts. */
+#ifndef SPI_CONF_DMA
+#define SPI_CONF_DMA 1
+#endif
+
 #define SCK            1  /* P3.1 - Output: SPI Serial Clock (SCLK) */
 #define MOSI           2  /* P3.2 - Output: SPI Master out - slave in (MOSI) */
 #define MISO           3  /* P3.3 - Input:  SPI Master in - slave out (MISO) */
@@ -93,7 +93,7 @@ write_byte(int fd, uint8_t c)
     printf("err #1\n");
   }
 #else /* DATA_AS_HEX */
-  if(cfs_write(fd, &c, 1) != 1) {
+  if(checkpoint_write(fd, &c, 1) != 1) {
     printf("err #2\n");
   }
 #endif /* DATA_AS_HEX */
@@ -147,7 +147,7 @@ read_byte(int fd)
   return (uint8_t)((hex[0]<<4)&0xf0) | (hex[1]&0x0f);
 #else /* DATA_AS_HEX */
   uint8_t c;
-  cfs_read(fd, &c, 1);
+  checkpoint_read(fd, &c, 1);
   return c;
 #endif /* DATA_AS_HEX */
 }
@@ -161,47 +161,31 @@ read_word(int fd)
   return tmp.u16;
 }
 /*---------------------------------------------------------------------------*/
-static void
-thread_checkpoint(int fd)
-{
 #if INCLUDE_RAM
-  unsigned char *addr;
-  uint16_t size = 0;
-  unsigned char *thread_mem_start = (unsigned char *)&checkpoint_thread.thread.stack;
-  unsigned char *thread_mem_end = thread_mem_start + sizeof(checkpoint_thread.thread.stack) - 1;
-  unsigned char *coffee_mem_start = cfs_coffee_get_protected_mem(&size);
-  unsigned char *coffee_mem_end = coffee_mem_start + size - 1;
-#endif /* INCLUDE_RAM */
+/* The stack of the checkpoint thread and the protected memory of
+   Coffee are left out of checkpoints. */
+static struct checkpoint_hole holes[2];
 
-  /*printf("protected thread memory: %u, size=%u\n", (uint16_t) thread_mem_start, sizeof(checkpoint_thread.thread.stack));*/
-  /*printf("protected coffee memory: %u, size=%u\n", (uint16_t) coffee_mem_start, size);*/
+static int
+set_holes(void)
+{
+  uint16_t size = 0;
 
+  holes[0].start = (unsigned char *)&checkpoint_thread.thread.stack;
+  holes[0].end = holes[0].start + sizeof(checkpoint_thread.thread.stack);
+  holes[1].start = cfs_coffee_get_protected_mem(&size);
+  holes[1].end = holes[1].start + size;
+  return 2;
+}
+#endif /* INCLUDE_RAM */
+/*---------------------------------------------------------------------------*/
+static void
+thread_checkpoint(int fd)
+{
   /* RAM */
 #if INCLUDE_RAM
-  for(addr = (unsigned char *)RAM_START;
-      addr < (unsigned char *)RAM_END;
-      addr++) {
-
-    if((addr >= thread_mem_start && addr <= thread_mem_end)) {
-      /* Writing dummy memory */
-      /*write_byte(fd, 1);*/
-      continue;
-    }
-
-    if((addr >= coffee_mem_start && addr <= coffee_mem_end)) {
-      /* Writing dummy memory */
-      /*write_byte(fd, 2);*/
-      continue;
-    }
-
-    /* TODO Use write_array() */
-    write_byte(fd, *addr);
-
-    if(((int)addr % 512) == 0) {
-      PRINTF(".");
-    }
-  }
-
+  checkpoint_mem_checkpoint(fd, (unsigned char *)RAM_START,
+                            (unsigned char *)RAM_END, holes, set_holes());
 #endif /* INCLUDE_RAM */
 
   /* Timers */
@@ -232,42 +216,10 @@ thread_checkpoint(int fd)
 static void
 thread_rollback(int fd)
 {
-#if INCLUDE_RAM
-  unsigned char *addr;
-  uint16_t size = 0;
-  unsigned char *thread_mem_start = (unsigned char *)&checkpoint_thread.thread.stack;
-  unsigned char *thread_mem_end = thread_mem_start + sizeof(checkpoint_thread.thread.stack) - 1;
-  unsigned char *coffee_mem_start = cfs_coffee_get_protected_mem(&size);
-  unsigned char *coffee_mem_end = coffee_mem_start + size - 1;
-#endif /* INCLUDE_RAM */
-
-  /*printf("protected thread memory: %u, size=%u\n", (uint16_t) thread_mem_start, sizeof(checkpoint_thread.thread.stack));*/
-  /*printf("protected coffee memory: %u, size=%u\n", (uint16_t) coffee_mem_start, size);*/
-
   /* RAM */
 #if INCLUDE_RAM
-  for(addr = (unsigned char *)RAM_START;
-      addr < (unsigned char *)RAM_END;
-      addr++) {
-    if((addr >= thread_mem_start && addr <= thread_mem_end)) {
-      /* Ignoring incoming memory */
-      /*read_byte(fd);*/
-      continue;
-    }
-
-    if((addr >= coffee_mem_start && addr <= coffee_mem_end)) {
-      /* Ignoring incoming memory */
-      /*read_byte(fd);*/
-      continue;
-    }
-
-    *addr = read_byte(fd);
-
-    if(((int)addr % 512) == 0) {
-      PRINTF(".");
-    }
-  }
-
+  checkpoint_mem_rollback(fd, (unsigned char *)RAM_START,
+                          (unsigned char *)RAM_END, holes, set_holes());
 #endif /* INCLUDE_RAM */
 
   /* Timers */
@@ -331,7 +283,8 @@ thread_loop(void *data)
 int
 checkpoint_arch_size()
 {
-  return 10258;
+  /* RAM, timers, LEDs and the padding byte */
+  return CHECKPOINT_MEM_SIZE(RAM_END - RAM_START) + 16 + 1 + 1;
 }
 /*---------------------------------------------------------------------------*/
 void
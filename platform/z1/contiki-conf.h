@@ -90,6 +90,11 @@
 
 #endif /* WITH_UIP6 */
 
+/* Use the CC2420 AES engine, e.g. for link-layer security */
+#ifndef AES_128_CONF
+#define AES_128_CONF cc2420_aes_128_driver
+#endif /* AES_128_CONF */
+
 #define PACKETBUF_CONF_ATTRS_INLINE 1
 
 #ifndef RF_CHANNEL
@@ -0,0 +1,149 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/mrm</project>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/mspsim</project>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/avrora</project>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/native_gateway</project>
+  <simulation>
+    <title>My simulation</title>
+    <delaytime>0</delaytime>
+    <randomseed>generated</randomseed>
+    <motedelay_us>1000000</motedelay_us>
+    <radiomedium>
+      se.sics.cooja.radiomediums.UDGM
+      <transmitting_range>50.0</transmitting_range>
+      <interference_range>100.0</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>1.0</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+    <motetype>
+      se.sics.cooja.mspmote.SkyMoteType
+      <identifier>sky1</identifier>
+      <description>netperf6 shell</description>
+      <source>[CONTIKI_DIR]/examples/netperf6/netperf6-shell.c</source>
+      <commands>make clean TARGET=sky
+make netperf6-shell.sky TARGET=sky</commands>
+      <firmware>[CONTIKI_DIR]/examples/netperf6/netperf6-shell.sky</firmware>
+      <moteinterface>se.sics.cooja.interfaces.Position</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.RimeAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyCoffeeFilesystem</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyByteRadio</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkySerial</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyLED</moteinterface>
+    </motetype>
+    <mote>
+      se.sics.cooja.mspmote.SkyMote
+      <motetype_identifier>sky1</motetype_identifier>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>49.48292285385544</x>
+        <y>97.67000744426045</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>1</id>
+      </interface_config>
+    </mote>
+    <mote>
+      se.sics.cooja.mspmote.SkyMote
+      <motetype_identifier>sky1</motetype_identifier>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>80.21380569499377</x>
+        <y>98.51039574575084</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>2</id>
+      </interface_config>
+    </mote>
+  </simulation>
+  <plugin>
+    se.sics.cooja.plugins.SimControl
+    <width>290</width>
+    <z>2</z>
+    <height>172</height>
+    <location_x>0</location_x>
+    <location_y>0</location_y>
+    <minimized>false</minimized>
+  </plugin>
+  <plugin>
+    se.sics.cooja.plugins.LogListener
+    <plugin_config>
+      <filter />
+    </plugin_config>
+    <width>1024</width>
+    <z>0</z>
+    <height>377</height>
+    <location_x>0</location_x>
+    <location_y>171</location_y>
+    <minimized>false</minimized>
+  </plugin>
+  <plugin>
+    se.sics.cooja.plugins.TimeLine
+    <plugin_config>
+      <mote>0</mote>
+      <mote>1</mote>
+      <showRadioRXTX />
+      <showRadioHW />
+      <showLEDs />
+      <split>118</split>
+      <zoom>9</zoom>
+    </plugin_config>
+    <width>1024</width>
+    <z>1</z>
+    <height>150</height>
+    <location_x>0</location_x>
+    <location_y>548</location_y>
+    <minimized>false</minimized>
+  </plugin>
+  <plugin>
+    se.sics.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>TIMEOUT(300000);
+started = 0;
+booted = 0;
+while(true) {
+  YIELD(); /* wait for another mote output */
+  log.log(time + " " + id + " " + msg + "\n");
+  if(msg.startsWith("Done")) {
+    log.testOK();
+  }
+  if(msg.startsWith("netperf6 control connection failed")) {
+    log.testFailed();
+  }
+  if(msg.startsWith("Tentative link-local IPv6 address")) {
+    booted++;
+  }
+  if(booted == 2 &amp;&amp; started == 0) {
+    /* Measure from mote 1 to the link-local address of mote 2 */
+    write(sim.getMoteWithID(1), "netperf6 -pst fe80::212:7402:2:202 20\n");
+    started = 1;
+  }
+}
+//log.testOK(); /* Report test success and quit */
+//log.testFailed(); /* Report test failure and quit */</script>
+      <active>true</active>
+    </plugin_config>
+    <width>600</width>
+    <z>-1</z>
+    <height>476</height>
+    <location_x>399</location_x>
+    <location_y>154</location_y>
+    <minimized>true</minimized>
+  </plugin>
+</simconf>
+
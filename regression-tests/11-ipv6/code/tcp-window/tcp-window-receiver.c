@@ -0,0 +1,43 @@
+#include "contiki.h"
+#include "contiki-lib.h"
+#include "contiki-net.h"
+
+#include <stdio.h>
+
+#define TCP_PORT 61619
+
+/*---------------------------------------------------------------------------*/
+PROCESS(tcp_window_receiver_process, "TCP window receiver");
+AUTOSTART_PROCESSES(&tcp_window_receiver_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tcp_window_receiver_process, ev, data)
+{
+  static uint16_t received;
+  static uint16_t errors;
+  uint8_t *p;
+  uint16_t i;
+
+  PROCESS_BEGIN();
+
+  tcp_listen(UIP_HTONS(TCP_PORT));
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+    if(uip_newdata()) {
+      /* The sender sends the byte sequence 0, 1, ..., 250, 0, 1, ... */
+      p = uip_appdata;
+      for(i = 0; i < uip_datalen(); i++) {
+        if(p[i] != received % 251) {
+          errors++;
+        }
+        received++;
+      }
+    }
+    if(uip_closed() || uip_aborted() || uip_timedout()) {
+      printf("Received %u bytes, %u errors\n", received, errors);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,68 @@
+#include "contiki.h"
+#include "contiki-lib.h"
+#include "contiki-net.h"
+
+#include <stdio.h>
+
+#define TCP_PORT 61619
+
+/* Much larger than the window, so that the stream has to be sent in
+   segments that only partly fill the peer's receive window. */
+#define SIZE 1000
+
+static struct psock ps;
+static uint8_t inbuf[8];
+static uint8_t stream[SIZE];
+
+/*---------------------------------------------------------------------------*/
+PROCESS(tcp_window_sender_process, "TCP window sender");
+AUTOSTART_PROCESSES(&tcp_window_sender_process);
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(send_stream(struct psock *p))
+{
+  PSOCK_BEGIN(p);
+
+  PSOCK_SEND(p, stream, sizeof(stream));
+  printf("Sent %u bytes\n", (unsigned)sizeof(stream));
+  PSOCK_CLOSE(p);
+
+  PSOCK_END(p);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tcp_window_sender_process, ev, data)
+{
+  static struct etimer et;
+  static uint16_t i;
+  uip_ipaddr_t addr;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < sizeof(stream); i++) {
+    stream[i] = i % 251;
+  }
+
+  /* Give the receiver time to boot. */
+  etimer_set(&et, 10 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  /* The link-local address of Cooja mote 1. */
+  uip_ip6addr(&addr, 0xfe80, 0, 0, 0, 0x0201, 0x0001, 0x0001, 0x0001);
+  tcp_connect(&addr, UIP_HTONS(TCP_PORT), NULL);
+  PSOCK_INIT(&ps, inbuf, sizeof(inbuf));
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+    if(uip_aborted() || uip_timedout()) {
+      printf("Connection lost\n");
+      break;
+    }
+    if(uip_closed()) {
+      break;
+    }
+    send_stream(&ps);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
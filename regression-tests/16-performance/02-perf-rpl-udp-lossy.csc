@@ -0,0 +1,397 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project EXPORT="discard">[APPS_DIR]/mrm</project>
+  <project EXPORT="discard">[APPS_DIR]/mspsim</project>
+  <project EXPORT="discard">[APPS_DIR]/avrora</project>
+  <project EXPORT="discard">[APPS_DIR]/serial_socket</project>
+  <project EXPORT="discard">[APPS_DIR]/collect-view</project>
+  <project EXPORT="discard">[APPS_DIR]/powertracker</project>
+  <simulation>
+    <title>RPL and UDP performance over lossy links</title>
+    <randomseed>123456</randomseed>
+    <motedelay_us>1000000</motedelay_us>
+    <radiomedium>
+      se.sics.cooja.radiomediums.UDGM
+      <transmitting_range>50.0</transmitting_range>
+      <interference_range>100.0</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>0.8</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+    <motetype>
+      se.sics.cooja.mspmote.SkyMoteType
+      <identifier>perfroot</identifier>
+      <description>Performance test root</description>
+      <source EXPORT="discard">[CONFIG_DIR]/code/perf-root.c</source>
+      <commands EXPORT="discard">make perf-root.sky TARGET=sky</commands>
+      <firmware EXPORT="copy">[CONFIG_DIR]/code/perf-root.sky</firmware>
+      <moteinterface>se.sics.cooja.interfaces.Position</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.RimeAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.MoteAttributes</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyCoffeeFilesystem</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyByteRadio</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyLED</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspDebugOutput</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyTemperature</moteinterface>
+    </motetype>
+    <motetype>
+      se.sics.cooja.mspmote.SkyMoteType
+      <identifier>perfsender</identifier>
+      <description>Performance test sender</description>
+      <source EXPORT="discard">[CONFIG_DIR]/code/perf-sender.c</source>
+      <commands EXPORT="discard">make perf-sender.sky TARGET=sky</commands>
+      <firmware EXPORT="copy">[CONFIG_DIR]/code/perf-sender.sky</firmware>
+      <moteinterface>se.sics.cooja.interfaces.Position</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.RimeAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.MoteAttributes</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyCoffeeFilesystem</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyByteRadio</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyLED</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspDebugOutput</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyTemperature</moteinterface>
+    </motetype>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>0.0</x>
+        <y>0.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>1</id>
+      </interface_config>
+      <motetype_identifier>perfroot</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>40.0</x>
+        <y>0.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>2</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>80.0</x>
+        <y>0.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>3</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>120.0</x>
+        <y>0.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>4</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>0.0</x>
+        <y>40.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>5</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>40.0</x>
+        <y>40.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>6</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>80.0</x>
+        <y>40.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>7</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>120.0</x>
+        <y>40.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>8</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>0.0</x>
+        <y>80.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>9</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>40.0</x>
+        <y>80.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>10</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>80.0</x>
+        <y>80.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>11</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>120.0</x>
+        <y>80.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>12</id>
+      </interface_config>
+      <motetype_identifier>perfsender</motetype_identifier>
+    </mote>
+  </simulation>
+  <plugin>
+    se.sics.cooja.plugins.SimControl
+    <width>280</width>
+    <z>1</z>
+    <height>160</height>
+    <location_x>400</location_x>
+    <location_y>0</location_y>
+  </plugin>
+  <plugin>
+    se.sics.cooja.plugins.LogListener
+    <plugin_config>
+      <filter />
+    </plugin_config>
+    <width>1000</width>
+    <z>2</z>
+    <height>300</height>
+    <location_x>0</location_x>
+    <location_y>400</location_y>
+  </plugin>
+  <plugin>
+    se.sics.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>/*
+ * Performance regression test. Node 1 is the RPL root, all other
+ * nodes send UDP packets to it once they have joined the DAG.
+ *
+ * Every metric is logged as "PERF &lt;test&gt; &lt;metric&gt; &lt;value&gt; &lt;limit&gt;",
+ * with lower values being better. The test fails if any metric is
+ * above its limit, which is its expected value plus TOLERANCE.
+ */
+TEST = "02-perf-rpl-udp-lossy";
+DURATION = 1800000; /* Simulated milliseconds */
+TOLERANCE = 0.25;
+
+/* Expected values, to be lowered when the stack gets better */
+EXPECTED_CONVERGENCE_S = 300;
+EXPECTED_LATENCY_MS = 2000;
+EXPECTED_LATENCY_P90_MS = 4000;
+EXPECTED_LOSS_PERCENT = 15;
+EXPECTED_DUTY_CYCLE_PERCENT = 5.0;
+
+/* Radio duty cycle is measured from this time on, in microseconds, to
+   leave out the formation of the network */
+WARMUP = 600000000;
+/* Packets sent this close to the end, in microseconds, are not
+   expected to have arrived yet */
+IN_FLIGHT = 60000000;
+
+joined = new Array();
+sentTime = new Object();
+sent = 0;
+received = 0;
+latencies = new Array();
+powerStart = new Object();
+powerEnd = new Object();
+
+function check(metric, value, expected) {
+  value = Math.round(100 * value) / 100;
+  limit = Math.round(100 * expected * (1 + TOLERANCE)) / 100;
+  log.log("PERF " + TEST + " " + metric + " " + value + " " + limit + "\n");
+  if(value &gt; limit) {
+    log.log("Regression: " + metric + " " + value + " is above " + limit + "\n");
+    return false;
+  }
+  return true;
+}
+
+function finish() {
+  ok = true;
+  nodes = sim.getMotesCount() - 1;
+
+  convergence = 0;
+  count = 0;
+  for(id in joined) {
+    count++;
+    if(joined[id] &gt; convergence) {
+      convergence = joined[id];
+    }
+  }
+  if(count &lt; nodes) {
+    log.log(count + " of " + nodes + " nodes joined the DAG\n");
+    convergence = DURATION / 1000;
+  }
+  ok = check("convergence_s", convergence, EXPECTED_CONVERGENCE_S) &amp;&amp; ok;
+
+  loss = sent &gt; 0 ? 100 * (sent - received) / sent : 100;
+  ok = check("loss_percent", loss, EXPECTED_LOSS_PERCENT) &amp;&amp; ok;
+
+  latencies.sort(function(a, b) { return a - b; });
+  total = 0;
+  for(i = 0; i &lt; latencies.length; i++) {
+    total += latencies[i];
+  }
+  average = latencies.length &gt; 0 ? total / latencies.length : DURATION;
+  p90 = latencies.length &gt; 0 ?
+    latencies[Math.floor(0.9 * (latencies.length - 1))] : DURATION;
+  ok = check("latency_ms", average, EXPECTED_LATENCY_MS) &amp;&amp; ok;
+  ok = check("latency_p90_ms", p90, EXPECTED_LATENCY_P90_MS) &amp;&amp; ok;
+
+  radio = 0;
+  time = 0;
+  for(id in powerEnd) {
+    if(powerStart[id] != undefined) {
+      radio += powerEnd[id][2] + powerEnd[id][3] -
+        powerStart[id][2] - powerStart[id][3];
+      time += powerEnd[id][0] + powerEnd[id][1] -
+        powerStart[id][0] - powerStart[id][1];
+    }
+  }
+  dutyCycle = time &gt; 0 ? 100 * radio / time : 100;
+  ok = check("duty_cycle_percent", dutyCycle, EXPECTED_DUTY_CYCLE_PERCENT) &amp;&amp; ok;
+
+  if(ok) {
+    log.testOK();
+  } else {
+    log.testFailed();
+  }
+}
+
+TIMEOUT(DURATION, finish());
+
+while(true) {
+  YIELD();
+  if(msg.startsWith("Joined DAG")) {
+    if(joined[id] == undefined) {
+      joined[id] = time / 1000000;
+    }
+  } else if(msg.startsWith("Sending ")) {
+    if(time &lt; DURATION * 1000 - IN_FLIGHT) {
+      sentTime[id + "." + msg.split(" ")[1]] = time;
+      sent++;
+    }
+  } else if(msg.startsWith("Received ")) {
+    fields = msg.split(" ");
+    key = fields[3] + "." + fields[1];
+    if(sentTime[key] != undefined) {
+      latencies.push((time - sentTime[key]) / 1000);
+      delete sentTime[key];
+      received++;
+    }
+  } else if(msg.indexOf(" P ") &gt;= 0) {
+    /* powertrace: all_cpu all_lpm all_transmit all_listen */
+    fields = msg.substring(msg.indexOf(" P ") + 3).split(" ");
+    power = [parseInt(fields[2]), parseInt(fields[3]),
+             parseInt(fields[4]), parseInt(fields[5])];
+    if(time &gt;= WARMUP &amp;&amp; powerStart[id] == undefined) {
+      powerStart[id] = power;
+    }
+    powerEnd[id] = power;
+  }
+}</script>
+      <active>true</active>
+    </plugin_config>
+    <width>600</width>
+    <z>0</z>
+    <height>700</height>
+    <location_x>680</location_x>
+    <location_y>0</location_y>
+  </plugin>
+</simconf>
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         UDP sender of the performance regression tests
+ *
+ *         The node reports when it has joined the RPL DAG and then
+ *         sends a sequence-numbered packet to the root every
+ *         PERF_SEND_INTERVAL. The test script matches the "Sending"
+ *         and "Received" lines to compute latency and delivery.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "net/uip.h"
+#include "net/uip-ds6.h"
+#include "net/rpl/rpl.h"
+#include "simple-udp.h"
+#include "powertrace.h"
+
+#include <stdio.h>
+
+static struct simple_udp_connection connection;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(perf_sender_process, "Performance test sender");
+AUTOSTART_PROCESSES(&perf_sender_process);
+/*---------------------------------------------------------------------------*/
+static int
+joined(void)
+{
+  rpl_dag_t *dag;
+
+  dag = rpl_get_any_dag();
+  return dag != NULL && dag->preferred_parent != NULL;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(perf_sender_process, ev, data)
+{
+  static struct etimer periodic_timer;
+  static struct etimer send_timer;
+  static uip_ipaddr_t root;
+  static uint16_t seqno;
+  uip_ipaddr_t ipaddr;
+  uint8_t buf[2];
+
+  PROCESS_BEGIN();
+
+  uip_ip6addr(&ipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&ipaddr, &uip_lladdr);
+  uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
+
+  /* The root is node 1 */
+  uip_ip6addr(&root, 0xaaaa, 0, 0, 0, 0x0212, 0x7401, 0x0001, 0x0101);
+
+  simple_udp_register(&connection, PERF_UDP_PORT,
+                      NULL, PERF_UDP_PORT, NULL);
+
+  powertrace_start(PERF_POWER_INTERVAL);
+
+  etimer_set(&periodic_timer, CLOCK_SECOND);
+  while(!joined()) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&periodic_timer));
+    etimer_reset(&periodic_timer);
+  }
+  printf("Joined DAG\n");
+
+  etimer_set(&periodic_timer, PERF_SEND_INTERVAL);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&periodic_timer));
+    etimer_reset(&periodic_timer);
+    etimer_set(&send_timer, random_rand() % PERF_SEND_INTERVAL);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
+
+    seqno++;
+    buf[0] = seqno >> 8;
+    buf[1] = seqno & 0xff;
+    printf("Sending %u\n", seqno);
+    simple_udp_sendto(&connection, buf, sizeof(buf), &root);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
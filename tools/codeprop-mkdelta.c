@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/*
+ * Make a codeprop delta image (see apps/codeprop/codeprop-delta.h)
+ * that turns the module currently installed on the nodes into a new
+ * one. The delta is sent with the codeprop tool like a full module.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Should be included from codeprop-delta.h, but the include paths in
+   the makefiles aren't set up for that. */
+#define DELTA_MAGIC      "CPD1"
+#define DELTA_INSERT_MAX 128
+#define DELTA_COPY       0x80
+#define DELTA_COPY_MAX   32768
+
+/* A copy command is four bytes, so shorter matches are sent as
+   literal bytes. */
+#define MIN_MATCH 6
+
+#define MAX_SIZE 65535
+
+static unsigned char *out;
+static long outlen;
+
+/*---------------------------------------------------------------------*/
+/* Same as crc16_add() in core/lib/crc16.c. */
+static unsigned short
+crc16_add(unsigned char b, unsigned short acc)
+{
+  acc ^= b;
+  acc  = (acc >> 8) | (acc << 8);
+  acc ^= (acc & 0xff00) << 4;
+  acc ^= (acc >> 8) >> 4;
+  acc ^= (acc & 0xff00) >> 5;
+  return acc;
+}
+/*---------------------------------------------------------------------*/
+static unsigned char *
+read_file(const char *name, long *len)
+{
+  FILE *f;
+  unsigned char *data;
+
+  f = fopen(name, "rb");
+  if(f == NULL) {
+    perror(name);
+    exit(1);
+  }
+  data = malloc(MAX_SIZE + 1);
+  if(data == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+  *len = fread(data, 1, MAX_SIZE + 1, f);
+  fclose(f);
+  if(*len > MAX_SIZE) {
+    fprintf(stderr, "%s: file is larger than %d bytes\n", name, MAX_SIZE);
+    exit(1);
+  }
+  return data;
+}
+/*---------------------------------------------------------------------*/
+static void
+put8(int b)
+{
+  out[outlen++] = b;
+}
+/*---------------------------------------------------------------------*/
+static void
+put16(int w)
+{
+  put8(w >> 8);
+  put8(w & 0xff);
+}
+/*---------------------------------------------------------------------*/
+static void
+flush_insert(const unsigned char *data, long len)
+{
+  long n;
+
+  while(len > 0) {
+    n = len > DELTA_INSERT_MAX ? DELTA_INSERT_MAX : len;
+    put8(n - 1);
+    memcpy(&out[outlen], data, n);
+    outlen += n;
+    data += n;
+    len -= n;
+  }
+}
+/*---------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  unsigned char *base, *new;
+  long base_len, new_len;
+  long pos, literal, i, j, len, best_len, best_off;
+  unsigned short crc;
+  FILE *f;
+
+  if(argc != 4) {
+    fprintf(stderr, "usage: %s installed-module new-module delta\n", argv[0]);
+    exit(1);
+  }
+
+  base = read_file(argv[1], &base_len);
+  new = read_file(argv[2], &new_len);
+
+  /* Worst case: every byte is a literal. */
+  out = malloc(10 + new_len + new_len / DELTA_INSERT_MAX + 1);
+  if(out == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  crc = 0;
+  for(i = 0; i < base_len; i++) {
+    crc = crc16_add(base[i], crc);
+  }
+  memcpy(out, DELTA_MAGIC, 4);
+  outlen = 4;
+  put16(base_len);
+  put16(crc);
+  put16(new_len);
+
+  /* Greedy longest match. Modules are at most a few kilobytes, so a
+     brute force search is fast enough. */
+  literal = 0;
+  for(pos = 0; pos < new_len; ) {
+    best_len = 0;
+    best_off = 0;
+    for(i = 0; i < base_len; i++) {
+      for(j = 0; pos + j < new_len && i + j < base_len &&
+	    j < DELTA_COPY_MAX && base[i + j] == new[pos + j]; j++);
+      if(j > best_len) {
+	best_len = j;
+	best_off = i;
+      }
+    }
+
+    if(best_len >= MIN_MATCH) {
+      flush_insert(&new[literal], pos - literal);
+      len = best_len - 1;
+      put8(DELTA_COPY | (len >> 8));
+      put8(len & 0xff);
+      put16(best_off);
+      pos += best_len;
+      literal = pos;
+    } else {
+      pos++;
+    }
+  }
+  flush_insert(&new[literal], pos - literal);
+
+  f = fopen(argv[3], "wb");
+  if(f == NULL) {
+    perror(argv[3]);
+    exit(1);
+  }
+  if(fwrite(out, 1, outlen, f) != outlen) {
+    perror(argv[3]);
+    exit(1);
+  }
+  fclose(f);
+
+  printf("%s: %ld bytes (new module %ld bytes)\n", argv[3], outlen, new_len);
+  return 0;
+}
+/*---------------------------------------------------------------------*/
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ *
+ * -----------------------------------------------------------------
+ *
+ * CollectLogger
+ *
+ * Created : 15 oct 2013
+ */
+
+package se.sics.contiki.collect;
+import java.io.IOException;
+import java.util.Hashtable;
+
+/**
+ * Headless sensor data collection: writes all received sensor data to
+ * a binary time series file without starting the user interface.
+ */
+public class CollectLogger implements SerialConnectionListener, NodeTable {
+
+  private static final long FLUSH_INTERVAL = 5000;
+
+  private final Hashtable<String,Node> nodeTable = new Hashtable<String,Node>();
+  private final SensorDataWriter writer;
+  private final String filename;
+  private boolean hasSerialOpened;
+  private long lastFlush;
+  private int dataCount;
+
+  public CollectLogger(String filename) throws IOException {
+    this.filename = filename;
+    this.writer = new SensorDataWriter(filename);
+  }
+
+  public void start(SerialConnection connection) {
+    Runtime.getRuntime().addShutdownHook(new Thread() {
+      public void run() {
+        close();
+      }
+    });
+    String comPort = connection.getComPort();
+    if (comPort == null && connection.isMultiplePortsSupported()) {
+      System.err.println("No serial port specified");
+      System.exit(1);
+    }
+    connection.open(comPort);
+  }
+
+  private void close() {
+    try {
+      writer.close();
+    } catch (IOException e) {
+      System.err.println("Failed to close sensor data file '" + filename + '\'');
+      e.printStackTrace();
+    }
+  }
+
+  @Override
+  public Node addNode(String nodeID) {
+    Node node = nodeTable.get(nodeID);
+    if (node == null) {
+      node = new Node(nodeID);
+      nodeTable.put(nodeID, node);
+    }
+    return node;
+  }
+
+  // -------------------------------------------------------------------
+  // SerialConnection Listener
+  // -------------------------------------------------------------------
+
+  @Override
+  public void serialData(SerialConnection connection, String line) {
+    if (line.length() == 0 || line.charAt(0) == '#') {
+      // Ignore empty lines, comments, and annotations.
+      return;
+    }
+    long time = System.currentTimeMillis();
+    SensorData sensorData = SensorData.parseSensorData(this, line, time);
+    if (sensorData == null) {
+      System.out.println("SERIAL: " + line);
+      return;
+    }
+    try {
+      writer.write(sensorData);
+      dataCount++;
+      if (time - lastFlush > FLUSH_INTERVAL) {
+        writer.flush();
+        lastFlush = time;
+      }
+    } catch (IOException e) {
+      System.err.println("Failed to write sensor data to '" + filename + '\'');
+      e.printStackTrace();
+      System.exit(1);
+    }
+  }
+
+  @Override
+  public void serialOpened(SerialConnection connection) {
+    hasSerialOpened = true;
+    System.out.println("*** Logging sensor data from " + connection.getConnectionName()
+        + " to " + filename + " ***");
+  }
+
+  @Override
+  public void serialClosed(SerialConnection connection) {
+    if (hasSerialOpened) {
+      hasSerialOpened = false;
+      System.out.println("*** Serial connection terminated after " + dataCount
+          + " sensor data records ***");
+      System.exit(0);
+    }
+  }
+
+}
@@ -60,6 +60,8 @@ import java.util.HashMap;
 import java.util.Hashtable;
 import java.util.Map;
 import java.util.Properties;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.BlockingQueue;
 import javax.swing.AbstractAction;
 import javax.swing.Action;
 import javax.swing.BorderFactory;
@@ -77,6 +79,7 @@ import javax.swing.JScrollPane;
 import javax.swing.JTabbedPane;
 import javax.swing.ListCellRenderer;
 import javax.swing.SwingUtilities;
+import javax.swing.Timer;
 import javax.swing.event.ListSelectionEvent;
 import javax.swing.event.ListSelectionListener;
 import org.jfree.chart.axis.NumberAxis;
@@ -92,7 +95,7 @@ import se.sics.contiki.collect.gui.TimeChartPanel;
 /**
  *
  */
-public class CollectServer implements SerialConnectionListener {
+public class CollectServer implements SerialConnectionListener, NodeTable {
 
   public static final String WINDOW_TITLE = "Sensor Data Collect with Contiki";
   public static final String STDIN_COMMAND = "<STDIN>";
@@ -109,12 +112,22 @@ public class CollectServer implements SerialConnectionListener {
   private static final String SENSORS = "Sensors";
   private static final String POWER = "Power";
 
+  /* Serial data waiting to be parsed */
+  private static final int INCOMING_QUEUE_SIZE = 4096;
+  /* Default time between user interface updates in milliseconds */
+  private static final int REFRESH_INTERVAL = 1000;
+
   private Properties config = new Properties();
 
   private String configFile;
   private Properties configTable = new Properties();
 
   private ArrayList<SensorData> sensorDataList = new ArrayList<SensorData>();
+  private final ArrayList<SensorData> pendingSensorData = new ArrayList<SensorData>();
+  private final BlockingQueue<IncomingData> incomingQueue =
+    new ArrayBlockingQueue<IncomingData>(INCOMING_QUEUE_SIZE);
+  private Thread parserThread;
+  private Timer refreshTimer;
   private PrintWriter sensorDataOutput;
   private boolean isSensorLogUsed;
 
@@ -788,6 +801,21 @@ public class CollectServer implements SerialConnectionListener {
         getNode(property, true);
       }
     }
+
+    int refreshInterval = REFRESH_INTERVAL;
+    try {
+      refreshInterval = Integer.parseInt(getConfig("collect.refresh",
+          Integer.toString(REFRESH_INTERVAL)));
+    } catch (NumberFormatException e) {
+      System.err.println("Illegal refresh interval: " + getConfig("collect.refresh"));
+    }
+    refreshTimer = new Timer(refreshInterval, new ActionListener() {
+
+      public void actionPerformed(ActionEvent e) {
+        refreshVisualizers();
+      }
+
+    });
   }
 
   private int getUserInputAsInteger(String title, String message, int defaultValue) {
@@ -812,9 +840,17 @@ public class CollectServer implements SerialConnectionListener {
     if (isSensorLogUsed) {
       initSensorData();
     }
+    parserThread = new Thread(new Runnable() {
+      public void run() {
+        parseIncomingData();
+      }
+    }, "parser");
+    parserThread.setDaemon(true);
+    parserThread.start();
     SwingUtilities.invokeLater(new Runnable() {
       public void run() {
         window.setVisible(true);
+        refreshTimer.start();
       }
     });
     connectToSerial();
@@ -1128,6 +1164,27 @@ public class CollectServer implements SerialConnectionListener {
     return false;
   }
 
+  private void parseIncomingData() {
+    ArrayList<IncomingData> batch = new ArrayList<IncomingData>();
+    try {
+      while (true) {
+        batch.add(incomingQueue.take());
+        incomingQueue.drainTo(batch);
+        for (IncomingData data : batch) {
+          handleIncomingData(data.systemTime, data.line);
+        }
+        batch.clear();
+
+        PrintWriter output = this.sensorDataOutput;
+        if (output != null) {
+          output.flush();
+        }
+      }
+    } catch (InterruptedException e) {
+      // Parser stopped
+    }
+  }
+
   public void handleIncomingData(long systemTime, String line) {
     if (line.length() == 0 || line.charAt(0) == '#') {
       // Ignore empty lines, comments, and annotations.
@@ -1175,14 +1232,26 @@ public class CollectServer implements SerialConnectionListener {
       updateNodeTime(sensorData);
       sensorDataList.add(sensorData);
       handleLinks(sensorData);
-      if (visualizers != null) {
-        SwingUtilities.invokeLater(new Runnable() {
-          public void run() {
-            for (int i = 0, n = visualizers.length; i < n; i++) {
-              visualizers[i].nodeDataReceived(sensorData);
-            }
-          }
-        });
+      synchronized (pendingSensorData) {
+        pendingSensorData.add(sensorData);
+      }
+    }
+  }
+
+  private void refreshVisualizers() {
+    ArrayList<SensorData> list;
+    synchronized (pendingSensorData) {
+      if (pendingSensorData.isEmpty()) {
+        return;
+      }
+      list = new ArrayList<SensorData>(pendingSensorData);
+      pendingSensorData.clear();
+    }
+    if (visualizers != null) {
+      for (SensorData sensorData : list) {
+        for (int i = 0, n = visualizers.length; i < n; i++) {
+          visualizers[i].nodeDataReceived(sensorData);
+        }
       }
     }
   }
@@ -1250,12 +1319,14 @@ public class CollectServer implements SerialConnectionListener {
     }
     if (output != null) {
       output.println(data.toString());
-      output.flush();
     }
   }
 
   private void clearSensorData() {
     sensorDataList.clear();
+    synchronized (pendingSensorData) {
+      pendingSensorData.clear();
+    }
     Node[] nodes = getNodes();
     this.selectedNodes = null;
     nodeList.clearSelection();
@@ -1393,7 +1464,22 @@ public class CollectServer implements SerialConnectionListener {
 
   @Override
   public void serialData(SerialConnection connection, String line) {
-    handleIncomingData(System.currentTimeMillis(), line);
+    try {
+      // Blocks the serial thread only if the parser falls too far behind
+      incomingQueue.put(new IncomingData(System.currentTimeMillis(), line));
+    } catch (InterruptedException e) {
+      Thread.currentThread().interrupt();
+    }
+  }
+
+  private static class IncomingData {
+    public final long systemTime;
+    public final String line;
+
+    public IncomingData(long systemTime, String line) {
+      this.systemTime = systemTime;
+      this.line = line;
+    }
   }
 
   @Override
@@ -1478,6 +1564,7 @@ public class CollectServer implements SerialConnectionListener {
     String command = null;
     String logFileToLoad = null;
     String comPort = null;
+    String binaryFile = null;
     int port = -1;
     for(int i = 0, n = args.length; i < n; i++) {
       String arg = args[i];
@@ -1524,6 +1611,13 @@ public class CollectServer implements SerialConnectionListener {
             logFileToLoad = args[++i];
           }
           break;
+        case 'b':
+          if (i + 1 < n) {
+            binaryFile = args[++i];
+          } else {
+            usage(arg);
+          }
+          break;
         case 'h':
           usage(null);
           break;
@@ -1538,23 +1632,38 @@ public class CollectServer implements SerialConnectionListener {
       }
     }
 
-    CollectServer server = new CollectServer();
+    CollectServer server = null;
+    CollectLogger logger = null;
+    SerialConnectionListener listener;
+    if (binaryFile != null) {
+      try {
+        logger = new CollectLogger(binaryFile);
+      } catch (IOException e) {
+        System.err.println("Failed to open sensor data file '" + binaryFile + '\'');
+        e.printStackTrace();
+        System.exit(1);
+      }
+      listener = logger;
+    } else {
+      listener = server = new CollectServer();
+    }
+
     SerialConnection serialConnection;
     if (host != null) {
         if (port <= 0) {
             port = 60001;
         }
-        serialConnection = new TCPClientConnection(server, host, port);
+        serialConnection = new TCPClientConnection(listener, host, port);
     } else if (port > 0) {
-      serialConnection = new UDPConnection(server, port);
+      serialConnection = new UDPConnection(listener, port);
     } else if (command == null) {
-      serialConnection = new SerialDumpConnection(server);
+      serialConnection = new SerialDumpConnection(listener);
     } else if (command == STDIN_COMMAND) {
-      serialConnection = new StdinConnection(server);
+      serialConnection = new StdinConnection(listener);
     } else {
-      serialConnection = new CommandConnection(server, command);
+      serialConnection = new CommandConnection(listener, command);
     }
-    if (comPort == null) {
+    if (comPort == null && server != null) {
       comPort = server.getConfig("collect.serialport");
     }
     if (comPort != null) {
@@ -1564,6 +1673,11 @@ public class CollectServer implements SerialConnectionListener {
       serialConnection.setSerialOutputSupported(false);
     }
 
+    if (logger != null) {
+      logger.start(serialConnection);
+      return;
+    }
+
     server.isSensorLogUsed = useSensorLog;
     if (useSensorLog && resetSensorLog) {
       server.clearSensorDataLog();
@@ -1578,11 +1692,12 @@ public class CollectServer implements SerialConnectionListener {
     if (arg != null) {
       System.err.println("Unknown argument '" + arg + '\'');
     }
-    System.err.println("Usage: java CollectServer [-n] [-i] [-r] [-f [file]] [-a host:port] [-p port] [-c command] [COMPORT]");
+    System.err.println("Usage: java CollectServer [-n] [-i] [-r] [-f [file]] [-b file] [-a host:port] [-p port] [-c command] [COMPORT]");
     System.err.println("       -n : Do not read or save sensor data log");
     System.err.println("       -r : Clear any existing sensor data log at startup");
     System.err.println("       -i : Do not allow serial output");
     System.err.println("       -f : Read serial data from standard in");
+    System.err.println("       -b : Run without GUI and write sensor data to binary file");
     System.err.println("       -a : Connect to specified host:port");
     System.err.println("       -p : Read data from specified UDP port");
     System.err.println("       -c : Use specified command for serial data input/output");
@@ -112,11 +112,11 @@ public class SensorData implements SensorInfo {
     return sb.toString();
   }
 
-  public static SensorData parseSensorData(CollectServer server, String line) {
+  public static SensorData parseSensorData(NodeTable server, String line) {
     return parseSensorData(server, line, 0);
   }
 
-  public static SensorData parseSensorData(CollectServer server, String line, long systemTime) {
+  public static SensorData parseSensorData(NodeTable server, String line, long systemTime) {
     String[] components = line.trim().split("[ \t]+");
     // Check if COOJA log
     if (components.length == VALUES_COUNT + 2 && components[1].startsWith("ID:")) {
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ *
+ * -----------------------------------------------------------------
+ *
+ * SensorDataWriter
+ *
+ * Created : 15 oct 2013
+ */
+
+package se.sics.contiki.collect;
+import java.io.BufferedOutputStream;
+import java.io.DataOutputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.util.HashMap;
+
+/**
+ * Writes sensor data to a compact binary time series file.
+ *
+ * Each time the file is opened a header is appended: the magic number
+ * "CVTS" followed by a version byte. Every sensor data record that
+ * follows consists of variable length integers (7 bits per byte, least
+ * significant group first, high bit set on all but the last byte):
+ *
+ *   node id, system time delta, value count, value deltas...
+ *
+ * The system time delta is relative to the previous record and each
+ * value is stored as the difference to the same value in the previous
+ * record from the same node, since the header. Signed numbers are zig-zag
+ * encoded.
+ */
+public class SensorDataWriter implements SensorInfo {
+
+  public static final int MAGIC = 0x43565453;
+  public static final int VERSION = 1;
+
+  private final DataOutputStream out;
+  private final HashMap<Integer,int[]> lastValues = new HashMap<Integer,int[]>();
+  private long lastTime;
+
+  public SensorDataWriter(String filename) throws IOException {
+    out = new DataOutputStream(new BufferedOutputStream(new FileOutputStream(filename, true)));
+    out.writeInt(MAGIC);
+    out.writeByte(VERSION);
+  }
+
+  public void write(SensorData data) throws IOException {
+    int nodeID = data.getValue(NODE_ID);
+    int count = data.getValueCount();
+    int[] last = lastValues.get(nodeID);
+    if (last == null || last.length != count) {
+      last = new int[count];
+      lastValues.put(nodeID, last);
+    }
+
+    writeNumber(nodeID & 0xffffL);
+    writeNumber(zigzag(data.getSystemTime() - lastTime));
+    writeNumber(count);
+    for (int i = 0; i < count; i++) {
+      int value = data.getValue(i);
+      writeNumber(zigzag(value - last[i]));
+      last[i] = value;
+    }
+    lastTime = data.getSystemTime();
+  }
+
+  public void flush() throws IOException {
+    out.flush();
+  }
+
+  public void close() throws IOException {
+    out.close();
+  }
+
+  private static long zigzag(long value) {
+    return (value << 1) ^ (value >> 63);
+  }
+
+  private void writeNumber(long value) throws IOException {
+    while ((value & ~0x7fL) != 0) {
+      out.writeByte((int) (value & 0x7f) | 0x80);
+      value >>>= 7;
+    }
+    out.writeByte((int) value);
+  }
+
+}
@@ -36,13 +36,19 @@ import java.awt.geom.Point2D;
 import java.awt.geom.Rectangle2D;
 import java.util.ArrayList;
 import java.util.Collection;
+import java.util.Collections;
 import java.util.Enumeration;
 import java.util.Hashtable;
+import java.util.LinkedHashMap;
+import java.util.Map;
 import java.util.Observable;
 import java.util.Observer;
 import java.util.Properties;
 import java.util.Random;
 import java.util.Vector;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
 
 import javax.swing.tree.DefaultMutableTreeNode;
 
@@ -62,6 +68,11 @@ import statistics.GaussianWrapper;
  * By registering as a settings observer on this channel model, other parts will
  * be notified if the settings change.
  *
+ * The ray-traced path gain and delay spread between two positions are cached,
+ * since they only depend on the positions, the obstacles and the ray tracer
+ * settings. The cache is flushed whenever the settings or obstacles change;
+ * moved radios simply get new entries. See precalculatePaths().
+ *
  * TODO Add better support for different signal strengths
  *
  * @author Fredrik Osterlind
@@ -93,18 +104,82 @@ public class ChannelModel {
   private Simulation simulation;
 
   
-  // Ray tracing components temporary vector
-  private Vector<Vector<Line2D>> calculatedVisibleSides = new Vector<Vector<Line2D>>();
-  private Vector<Point2D> calculatedVisibleSidesSources = new Vector<Point2D>();
-  private Vector<Line2D> calculatedVisibleSidesLines = new Vector<Line2D>();
-  private Vector<AngleInterval> calculatedVisibleSidesAngleIntervals = new Vector<AngleInterval>();
+  // Ray tracing components temporary vectors, kept per thread
+  private static class VisibleSidesCache {
+    int generation;
+    Vector<Vector<Line2D>> sides = new Vector<Vector<Line2D>>();
+    Vector<Point2D> sources = new Vector<Point2D>();
+    Vector<Line2D> lines = new Vector<Line2D>();
+    Vector<AngleInterval> angleIntervals = new Vector<AngleInterval>();
+  }
+  private ThreadLocal<VisibleSidesCache> visibleSidesCache = new ThreadLocal<VisibleSidesCache>() {
+    protected VisibleSidesCache initialValue() {
+      return new VisibleSidesCache();
+    }
+  };
   private static int maxSavedVisibleSides = 30; // Max size of lists above
 
+  /**
+   * Ray-traced result between two positions, independent of
+   * transmission power, antenna gains and random components.
+   */
+  private static class PathData {
+    final double gain; /* dB */
+    final double delaySpread;
+    final double delaySpreadRMS;
+
+    PathData(double gain, double delaySpread, double delaySpreadRMS) {
+      this.gain = gain;
+      this.delaySpread = delaySpread;
+      this.delaySpreadRMS = delaySpreadRMS;
+    }
+  }
+
+  private static class PathKey {
+    private final double fromX, fromY, toX, toY;
+
+    PathKey(Point2D from, Point2D to) {
+      fromX = from.getX();
+      fromY = from.getY();
+      toX = to.getX();
+      toY = to.getY();
+    }
+
+    public boolean equals(Object o) {
+      if (!(o instanceof PathKey)) {
+        return false;
+      }
+      PathKey k = (PathKey) o;
+      return fromX == k.fromX && fromY == k.fromY && toX == k.toX && toY == k.toY;
+    }
+
+    public int hashCode() {
+      long h = Double.doubleToLongBits(fromX);
+      h = 31*h + Double.doubleToLongBits(fromY);
+      h = 31*h + Double.doubleToLongBits(toX);
+      h = 31*h + Double.doubleToLongBits(toY);
+      return (int) (h ^ (h >>> 32));
+    }
+  }
+
+  // Cached path data, least recently used entries are dropped first
+  private static int maxCachedPaths = 200000;
+  private Map<PathKey,PathData> pathCache = Collections.synchronizedMap(
+      new LinkedHashMap<PathKey,PathData>(1024, 0.75f, true) {
+        protected boolean removeEldestEntry(Map.Entry<PathKey,PathData> eldest) {
+          return size() > maxCachedPaths;
+        }
+      });
+
+  // Incremented when obstacles or settings change, invalidating cached paths
+  private volatile int pathGeneration = 0;
+
   /**
    * Notifies observers when this channel model has changed settings.
    */
   private class SettingsObservable extends Observable {
     private void notifySettingsChanged() {
+      invalidatePaths();
       setChanged();
       notifyObservers();
     }
@@ -358,6 +433,7 @@ public class ChannelModel {
    */
   public void addRectObstacle(double startX, double startY, double width, double height, boolean notify) {
     myObstacleWorld.addObstacle(startX, startY, width, height);
+    invalidatePaths();
 
     if (notify) {
       settingsObservable.notifySettingsChanged();
@@ -1015,31 +1091,41 @@ public class ChannelModel {
    */
   private Vector<Line2D> getAllVisibleSides(double sourceX, double sourceY, AngleInterval angleInterval, Line2D lookThrough) {
     Point2D source = new Point2D.Double(sourceX, sourceY);
+    VisibleSidesCache cache = visibleSidesCache.get();
+
+    // Forget results calculated with other obstacles
+    if (cache.generation != pathGeneration) {
+      cache.sides.clear();
+      cache.sources.clear();
+      cache.lines.clear();
+      cache.angleIntervals.clear();
+      cache.generation = pathGeneration;
+    }
 
     // Check if results were already calculated earlier
-    for (int i=0; i < calculatedVisibleSidesSources.size(); i++) {
+    for (int i=0; i < cache.sources.size(); i++) {
       if (
           // Compare sources
-          source.equals(calculatedVisibleSidesSources.get(i)) &&
+          source.equals(cache.sources.get(i)) &&
 
           // Compare angle intervals
-          (angleInterval == calculatedVisibleSidesAngleIntervals.get(i) ||
-              angleInterval != null && angleInterval.equals(calculatedVisibleSidesAngleIntervals.get(i)) ) &&
+          (angleInterval == cache.angleIntervals.get(i) ||
+              angleInterval != null && angleInterval.equals(cache.angleIntervals.get(i)) ) &&
 
               // Compare lines
-              (lookThrough == calculatedVisibleSidesLines.get(i) ||
-                  lookThrough != null && lookThrough.equals(calculatedVisibleSidesLines.get(i)) )
+              (lookThrough == cache.lines.get(i) ||
+                  lookThrough != null && lookThrough.equals(cache.lines.get(i)) )
       ) {
         // Move to top of list
-        Point2D oldSource = calculatedVisibleSidesSources.remove(i);
-        Line2D oldLine = calculatedVisibleSidesLines.remove(i);
-        AngleInterval oldAngleInterval = calculatedVisibleSidesAngleIntervals.remove(i);
-        Vector<Line2D> oldVisibleLines = calculatedVisibleSides.remove(i);
+        Point2D oldSource = cache.sources.remove(i);
+        Line2D oldLine = cache.lines.remove(i);
+        AngleInterval oldAngleInterval = cache.angleIntervals.remove(i);
+        Vector<Line2D> oldVisibleLines = cache.sides.remove(i);
 
-        calculatedVisibleSidesSources.add(0, oldSource);
-        calculatedVisibleSidesLines.add(0, oldLine);
-        calculatedVisibleSidesAngleIntervals.add(0, oldAngleInterval);
-        calculatedVisibleSides.add(0, oldVisibleLines);
+        cache.sources.add(0, oldSource);
+        cache.lines.add(0, oldLine);
+        cache.angleIntervals.add(0, oldAngleInterval);
+        cache.sides.add(0, oldVisibleLines);
 
         // Return old results
         return oldVisibleLines;
@@ -1384,19 +1470,19 @@ public class ChannelModel {
     } // End of outer loop
 
     // Save results in order to speed up later calculations
-    int size = calculatedVisibleSides.size();
+    int size = cache.sides.size();
     // Crop saved sides vectors
     if (size >= maxSavedVisibleSides) {
-      calculatedVisibleSides.remove(size-1);
-      calculatedVisibleSidesSources.remove(size-1);
-      calculatedVisibleSidesAngleIntervals.remove(size-1);
-      calculatedVisibleSidesLines.remove(size-1);
+      cache.sides.remove(size-1);
+      cache.sources.remove(size-1);
+      cache.angleIntervals.remove(size-1);
+      cache.lines.remove(size-1);
     }
 
-    calculatedVisibleSides.add(0, visibleLines);
-    calculatedVisibleSidesSources.add(0, source);
-    calculatedVisibleSidesAngleIntervals.add(0, angleInterval);
-    calculatedVisibleSidesLines.add(0, lookThrough);
+    cache.sides.add(0, visibleLines);
+    cache.sources.add(0, source);
+    cache.angleIntervals.add(0, angleInterval);
+    cache.lines.add(0, lookThrough);
 
     return visibleLines;
   }
@@ -1423,12 +1509,89 @@ public class ChannelModel {
   }
   
 
-  // TODO Fix better data type support
-  private double[] getTransmissionData(TxPair txPair, TransmissionData dataType) {
-    Point2D source = txPair.getFrom();
-    Point2D dest = txPair.getTo();
-    double accumulatedVariance = 0;
+  /**
+   * Returns the ray-traced path gain and delay spread between two positions,
+   * using the path cache.
+   *
+   * @param source Source position
+   * @param dest Destination position
+   * @return Path data
+   */
+  private PathData getPathData(Point2D source, Point2D dest) {
+    PathKey key = new PathKey(source, dest);
+    PathData path = pathCache.get(key);
+    if (path != null) {
+      return path;
+    }
+
+    int generation = pathGeneration;
+    path = computePathData(source, dest, false);
+    if (generation == pathGeneration) {
+      pathCache.put(key, path);
+    }
+    return path;
+  }
 
+  /**
+   * Flushes all cached ray tracing results. Called when obstacles or
+   * settings change.
+   */
+  private void invalidatePaths() {
+    pathGeneration++;
+    pathCache.clear();
+  }
+
+  /**
+   * Ray-traces the paths between all given positions in parallel, using all
+   * available processors, and stores the results in the path cache.
+   * Already cached pairs are skipped. Blocks until done.
+   *
+   * @param positions Radio positions
+   */
+  public void precalculatePaths(final Point2D[] positions) {
+    if (positions.length < 2) {
+      return;
+    }
+    int nrThreads = Runtime.getRuntime().availableProcessors();
+    long startTime = System.currentTimeMillis();
+    ExecutorService executor = Executors.newFixedThreadPool(nrThreads);
+    ArrayList<Future<?>> tasks = new ArrayList<Future<?>>();
+
+    for (final Point2D source: positions) {
+      tasks.add(executor.submit(new Runnable() {
+        public void run() {
+          for (Point2D dest: positions) {
+            if (source != dest && !source.equals(dest)) {
+              getPathData(source, dest);
+            }
+          }
+        }
+      }));
+    }
+
+    try {
+      for (Future<?> task: tasks) {
+        task.get();
+      }
+    } catch (Exception e) {
+      logger.warn("Path precalculation failed: " + e.getMessage(), e);
+    } finally {
+      executor.shutdown();
+    }
+
+    logger.info("Precalculated paths between " + positions.length + " positions in " +
+        (System.currentTimeMillis() - startTime) + " ms using " + nrThreads + " threads");
+  }
+
+  /**
+   * Ray-traces all paths from source to destination and combines them.
+   *
+   * @param source Source position
+   * @param dest Destination position
+   * @param log If true, signal components are logged
+   * @return Path data
+   */
+  private PathData computePathData(Point2D source, Point2D dest, boolean log) {
     // - Get all ray paths from source to destination -
     RayData originRayData = new RayData(
         RayData.RayType.ORIGIN,
@@ -1446,7 +1609,7 @@ public class ChannelModel {
     // Calculate all paths from source to destination, using above calculated tree
     Vector<RayPath> allPaths = getConnectingPaths(source, dest, visibleLinesTree);
 
-    if (logMode) {
+    if (log) {
       logInfo.append("Signal components:\n");
       Enumeration<RayPath> pathsEnum = allPaths.elements();
       while (pathsEnum.hasMoreElements()) {
@@ -1574,10 +1737,10 @@ public class ChannelModel {
 
         // Using Rician fading approach, TODO Only one best signal considered - combine these? (need two limits)
         totalPathGain += Math.pow(10, pathGain[i]/10.0)*Math.cos(2*Math.PI * pathModdedLengths[i]/wavelength);
-        if (logMode) {
+        if (log) {
           logInfo.append("Signal component: " + String.format("%2.3f", pathGain[i]) + " dB, phase " + String.format("%2.3f", (2*/*Math.PI* */ pathModdedLengths[i]/wavelength)) + " pi\n");
         }
-      } else if (logMode) {
+      } else if (log) {
         /* TODO Log mode affects result? */
         pathModdedLengths[i] = (pathLengths[i] - pathLengths[bestSignalNr]) % wavelength;
         logInfo.append("(IGNORED) Signal component: " + String.format("%2.3f", pathGain[i]) + " dB, phase " + String.format("%2.3f", (2*/*Math.PI* */ pathModdedLengths[i]/wavelength)) + " pi\n");
@@ -1593,12 +1756,32 @@ public class ChannelModel {
     // Convert back to dB
     totalPathGain = 10*Math.log10(Math.abs(totalPathGain));
 
-    if (logMode) {
+    if (log) {
         logInfo.append("\nTotal path gain: " + String.format("%2.3f", totalPathGain) + " dB\n");
         logInfo.append("Delay spread: " + String.format("%2.3f", delaySpread) + "\n");
         logInfo.append("RMS delay spread: " + String.format("%2.3f", delaySpreadRMS) + "\n");
     }
 
+    return new PathData(totalPathGain, delaySpread, delaySpreadRMS);
+  }
+
+  // TODO Fix better data type support
+  private double[] getTransmissionData(TxPair txPair, TransmissionData dataType) {
+    Point2D source = txPair.getFrom();
+    Point2D dest = txPair.getTo();
+    double accumulatedVariance = 0;
+
+    // - Get path gain and delay spread, ray-traced or cached -
+    PathData path;
+    if (logMode) {
+      path = computePathData(source, dest, true);
+    } else {
+      path = getPathData(source, dest);
+    }
+    double totalPathGain = path.gain;
+    double delaySpread = path.delaySpread;
+    double delaySpreadRMS = path.delaySpreadRMS;
+
     // - Calculate received power -
     // Using formula (dB)
     //  Received power = Output power + System gain + Transmitter gain + Path Loss + Receiver gain
@@ -30,6 +30,8 @@
 
 package se.sics.mrm;
 
+import java.awt.geom.Point2D;
+import java.util.ArrayList;
 import java.util.Collection;
 import java.util.Hashtable;
 import java.util.Observable;
@@ -81,6 +83,7 @@ public class MRM extends AbstractRadioMedium {
   public final static boolean WITH_DIRECTIONAL = true; /* DirectionalAntennaRadio */
 
   private Observer channelModelObserver = null;
+  private Observer simulationObserver = null;
 
   private boolean WITH_CAPTURE_EFFECT;
   private double CAPTURE_EFFECT_THRESHOLD;
@@ -117,6 +120,16 @@ public class MRM extends AbstractRadioMedium {
       }
     });
     
+    /* Ray-trace all radio pairs in parallel before the simulation starts
+     * (or resumes after radios moved), instead of at each transmission */
+    sim.addObserver(simulationObserver = new Observer() {
+      public void update(Observable o, Object arg) {
+        if (sim.isRunning()) {
+          precalculatePaths();
+        }
+      }
+    });
+
     /* Register plugins */
     sim.getGUI().registerPlugin(AreaViewer.class);
     sim.getGUI().registerPlugin(FormulaViewer.class);
@@ -132,6 +145,16 @@ public class MRM extends AbstractRadioMedium {
     Visualizer.unregisterVisualizerSkin(MRMVisualizerSkin.class);
 
     currentChannelModel.deleteSettingsObserver(channelModelObserver);
+    sim.deleteObserver(simulationObserver);
+  }
+
+  private void precalculatePaths() {
+    ArrayList<Point2D> positions = new ArrayList<Point2D>();
+    for (Radio radio: getRegisteredRadios()) {
+      Position pos = radio.getPosition();
+      positions.add(new Point2D.Double(pos.getXCoordinate(), pos.getYCoordinate()));
+    }
+    currentChannelModel.precalculatePaths(positions.toArray(new Point2D[0]));
   }
   
   private NoiseLevelListener noiseListener = new NoiseLevelListener() {
@@ -52,6 +52,7 @@ import se.sics.cooja.Simulation;
 import se.sics.cooja.Watchpoint;
 import se.sics.cooja.WatchpointMote;
 import se.sics.cooja.interfaces.IPAddress;
+import se.sics.cooja.interfaces.Radio;
 import se.sics.cooja.motes.AbstractEmulatedMote;
 import se.sics.cooja.mspmote.interfaces.Msp802154Radio;
 import se.sics.cooja.mspmote.interfaces.MspSerial;
@@ -84,7 +85,21 @@ import se.sics.mspsim.util.SimpleProfiler;
 public abstract class MspMote extends AbstractEmulatedMote implements Mote, WatchpointMote {
   private static Logger logger = Logger.getLogger(MspMote.class);
 
-  private final static int EXECUTE_DURATION_US = 1; /* We always execute in 1 us steps */
+  private final static int EXECUTE_DURATION_US = 1; /* Default execution quantum */
+
+  /* Execution quantum used while no radio interaction is possible.
+   * Configured via the MSPSIM_IDLE_QUANTUM_US external tools setting. */
+  private final static int EXECUTE_IDLE_DURATION_US;
+  static {
+    int idle = EXECUTE_DURATION_US;
+    try {
+      idle = Integer.parseInt(GUI.getExternalToolsSetting(
+          "MSPSIM_IDLE_QUANTUM_US", String.valueOf(EXECUTE_DURATION_US)).trim());
+    } catch (NumberFormatException e) {
+      logger.warn("Bad MSPSIM_IDLE_QUANTUM_US setting, using " + EXECUTE_DURATION_US + " us");
+    }
+    EXECUTE_IDLE_DURATION_US = Math.max(EXECUTE_DURATION_US, idle);
+  }
 
   {
     Visualizer.registerVisualizerSkin(CodeVisualizerSkin.class);
@@ -288,7 +303,27 @@ public abstract class MspMote extends AbstractEmulatedMote implements Mote, Watc
   private long lastExecute = -1; /* Last time mote executed */
   private long nextExecute;
   public void execute(long time) {
-    execute(time, EXECUTE_DURATION_US);
+    /* MSPSim already jumps over low-power mode to the next scheduled
+     * event. While the radio is off we may also execute active code in
+     * larger quanta, since no other mote can observe the difference. */
+    if (EXECUTE_IDLE_DURATION_US > EXECUTE_DURATION_US && !isRadioActive()) {
+      execute(time, EXECUTE_IDLE_DURATION_US);
+    } else {
+      execute(time, EXECUTE_DURATION_US);
+    }
+  }
+  private Radio myRadio = null;
+  private boolean isRadioActive() {
+    if (myRadio == null) {
+      if (myMoteInterfaceHandler == null) {
+        return true;
+      }
+      myRadio = myMoteInterfaceHandler.getRadio();
+      if (myRadio == null) {
+        return false;
+      }
+    }
+    return myRadio.isRadioOn() || myRadio.isTransmitting() || myRadio.isReceiving();
   }
   public void execute(long t, int duration) {
     /* Wait until mote boots */
@@ -40,6 +40,7 @@ import java.awt.event.ItemEvent;
 import java.awt.event.ItemListener;
 import java.io.File;
 import java.io.IOException;
+import java.util.ArrayDeque;
 import java.util.ArrayList;
 import java.util.Collection;
 import java.util.Observable;
@@ -97,7 +98,20 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
   private final static int LABEL_WIDTH = 170;
   private final static int LABEL_HEIGHT = 20;
 
+  /* All open gateways; destinations are split between those that capture
+   * the same traffic */
+  private final static ArrayList<NativeIPGateway> gateways =
+    new ArrayList<NativeIPGateway>();
+
+  /* Captured packets are SLIP-encoded on the capture thread and queued
+   * here, to be written to the mote by the simulation thread in batches */
+  private final static int INJECT_QUEUE_SIZE = 256;
+  private final ArrayDeque<byte[]> injectQueue = new ArrayDeque<byte[]>();
+  private boolean injectPending = false;
+  private int droppedPkts = 0;
+
   private Mote mote;
+  private Simulation simulation;
   private SerialPort serialPort = null;
   private boolean registeredGateway = false;
 
@@ -144,6 +158,7 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
   public NativeIPGateway(Mote mote, Simulation simulation, final GUI gui) {
     super("Native IP Gateway (" + mote + ")", gui, false);
     this.mote = mote;
+    this.simulation = simulation;
 
     /* Native OS - plugin depends on platform specific commands */
     String osName = System.getProperty("os.name").toLowerCase();
@@ -283,6 +298,10 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
       setSize(getWidth()+10, getHeight()+10);
     }
 
+    synchronized (gateways) {
+      gateways.add(this);
+    }
+
     /* Start capturing network traffic for simulated network */
     if (tunnelInterface != null) {
       startCapturingPackets(tunnelInterface);
@@ -357,7 +376,7 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
             continue;
           }
 
-          if (!moteIP.equals("0.0.0.0")) {
+          if (!moteIP.equals("0.0.0.0") && routesTo(packet)) {
             handleIncomingPacket(packet);
           }
         }
@@ -755,10 +774,97 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
     }
   }
 
+  /**
+   * @param g Other gateway
+   * @return True if both gateways capture the same traffic
+   */
+  private boolean sharesCapture(NativeIPGateway g) {
+    if (g.networkInterface == null || networkInterface == null ||
+        !String.valueOf(g.networkInterface.intf.name).equals(
+            String.valueOf(networkInterface.intf.name)) ||
+        g.moteIP.equals("0.0.0.0")) {
+      return false;
+    }
+    String[] a = moteIP.split("\\.");
+    String[] b = g.moteIP.split("\\.");
+    return a.length == 4 && b.length == 4 &&
+      a[0].equals(b[0]) && a[1].equals(b[1]);
+  }
+
+  /**
+   * Decides whether this gateway injects a captured packet. Gateways that
+   * capture the same traffic would otherwise all inject it: a packet for
+   * one of the gateway motes goes to that gateway, other destinations are
+   * hash-partitioned so that each always uses the same gateway.
+   *
+   * @param packet Captured packet
+   * @return True if this gateway should inject the packet
+   */
+  private boolean routesTo(IPPacket packet) {
+    String dst = packet.dst_ip.getHostAddress();
+    ArrayList<NativeIPGateway> candidates = new ArrayList<NativeIPGateway>();
+
+    synchronized (gateways) {
+      for (NativeIPGateway g: gateways) {
+        if (g == this || sharesCapture(g)) {
+          if (dst.equals(g.moteIP)) {
+            return g == this;
+          }
+          candidates.add(g);
+        }
+      }
+    }
+    if (candidates.size() <= 1) {
+      return true;
+    }
+
+    int hash = packet.dst_ip.hashCode();
+    hash ^= (hash >>> 16);
+    return candidates.get((hash & 0x7fffffff) % candidates.size()) == this;
+  }
+
+  /**
+   * Queues SLIP-encoded data for the mote serial port. May be called from
+   * any thread; the simulation thread drains the whole queue at once.
+   *
+   * @param slip SLIP-encoded packet
+   */
+  private void injectPacket(byte[] slip) {
+    synchronized (injectQueue) {
+      if (injectQueue.size() >= INJECT_QUEUE_SIZE) {
+        droppedPkts++;
+        return;
+      }
+      injectQueue.addLast(slip);
+      if (injectPending) {
+        return;
+      }
+      injectPending = true;
+    }
+    simulation.invokeSimulationThread(injectQueued);
+  }
+
+  private final Runnable injectQueued = new Runnable() {
+    public void run() {
+      byte[] slip;
+      while (true) {
+        synchronized (injectQueue) {
+          slip = injectQueue.pollFirst();
+          if (slip == null) {
+            injectPending = false;
+            return;
+          }
+        }
+        serialPort.writeArray(slip);
+      }
+    }
+  };
+
   private void handleIncomingPacket(IPPacket packet) {
     if (!registeredGateway) {
       /* Make mote register as gateway (only needed once) */
-      writeAsSlip("?IPA".getBytes(), serialPort);
+      byte[] register = "?IPA".getBytes();
+      injectPacket(encodeSlip(register, 0, register.length, null));
       registeredGateway = true;
     }
 
@@ -770,17 +876,19 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
 
     /* Send IP packet data (without captured non-IP header) */
     int offset = packet.len - packet.length;
-    byte[] packetData = new byte[packet.header.length + packet.data.length - offset];
-    System.arraycopy(packet.header, offset, packetData, 0, packet.header.length-offset);
-    System.arraycopy(packet.data, 0, packetData, packet.header.length-offset, packet.data.length);
-    writeAsSlip(packetData, serialPort);
+    injectPacket(encodeSlip(packet.header, offset, packet.header.length - offset,
+        packet.data));
 
     inPkts++;
     inBytes += packet.len;
 
     /* Update GUI */
     if (GUI.isVisualized()) {
-      inLabel.setText(inPkts + " (" + inBytes + " bytes)");
+      if (droppedPkts > 0) {
+        inLabel.setText(inPkts + " (" + inBytes + " bytes, " + droppedPkts + " dropped)");
+      } else {
+        inLabel.setText(inPkts + " (" + inBytes + " bytes)");
+      }
     }
   }
 
@@ -836,27 +944,56 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
     }
   }
 
-  /**
-   * Wraps packet as SLIP.
-   *
-   * @param packet Packet data
-   */
-  private static void writeAsSlip(byte[] packet, SerialPort serialPort) {
-    serialPort.writeByte(SLIP_END);
+  private static int slipLength(byte[] data, int offset, int len) {
+    int slipLen = len;
+    for (int i = offset; i < offset + len; i++) {
+      if (data[i] == SLIP_END || data[i] == SLIP_ESC) {
+        slipLen++;
+      }
+    }
+    return slipLen;
+  }
 
-    for (byte b: packet) {
+  private static int slipCopy(byte[] data, int offset, int len, byte[] slip, int pos) {
+    for (int i = offset; i < offset + len; i++) {
+      byte b = data[i];
       if (b == SLIP_END) {
-        serialPort.writeByte(SLIP_ESC);
-        serialPort.writeByte(SLIP_ESC_END);
+        slip[pos++] = SLIP_ESC;
+        slip[pos++] = SLIP_ESC_END;
       } else if (b == SLIP_ESC) {
-        serialPort.writeByte(SLIP_ESC);
-        serialPort.writeByte(SLIP_ESC_ESC);
+        slip[pos++] = SLIP_ESC;
+        slip[pos++] = SLIP_ESC_ESC;
       } else {
-        serialPort.writeByte(b);
+        slip[pos++] = b;
       }
     }
+    return pos;
+  }
 
-    serialPort.writeByte(SLIP_END);
+  /**
+   * Wraps packet as SLIP, straight from the captured header and payload
+   * into a single array of the exact encoded size.
+   *
+   * @param header Packet header
+   * @param offset Start of data in header
+   * @param len Length of data in header
+   * @param data Packet payload, or null
+   * @return SLIP-encoded packet
+   */
+  private static byte[] encodeSlip(byte[] header, int offset, int len, byte[] data) {
+    int dataLen = data == null ? 0 : data.length;
+    byte[] slip = new byte[2 + slipLength(header, offset, len) +
+                           (data == null ? 0 : slipLength(data, 0, dataLen))];
+    int pos = 0;
+
+    slip[pos++] = SLIP_END;
+    pos = slipCopy(header, offset, len, slip, pos);
+    if (data != null) {
+      pos = slipCopy(data, 0, dataLen, slip, pos);
+    }
+    slip[pos++] = SLIP_END;
+
+    return slip;
   }
 
   public enum SlipState {
@@ -983,6 +1120,10 @@ public class NativeIPGateway extends VisPlugin implements MotePlugin {
   }
 
   public void closePlugin() {
+    synchronized (gateways) {
+      gateways.remove(this);
+    }
+
     if (sender != null) {
       sender.close();
     }
@@ -88,11 +88,30 @@ public class SerialSocketServer extends VisPlugin implements MotePlugin {
   private DataInputStream in;
   private DataOutputStream out;
 
+  /* Mote -> socket: serial data is collected here and written to the
+   * socket in chunks, after at most FLUSH_DELAY ms or once FLUSH_THRESHOLD
+   * bytes are waiting. Data that does not fit is dropped. */
+  private final static int OUT_BUFFER_SIZE = 16*1024;
+  private final static int FLUSH_THRESHOLD = 1024;
+  private final static int FLUSH_DELAY = 5;
+  private final byte[] outBuffer = new byte[OUT_BUFFER_SIZE];
+  private int outBufferLen = 0;
+  private int outDropped = 0;
+
+  /* Socket -> mote: data is handed to the simulation thread in chunks. The
+   * socket is not read while more than IN_PENDING_MAX bytes are waiting
+   * to be written to the serial port, so TCP pushes back on the client. */
+  private final static int IN_PENDING_MAX = 1024;
+  private final Object inLock = new Object();
+  private int inPending = 0;
+
   private Mote mote;
+  private Simulation simulation;
 
   public SerialSocketServer(Mote mote, Simulation simulation, final GUI gui) {
     super("Serial Socket (SERVER) (" + mote + ")", gui, false);
     this.mote = mote;
+    this.simulation = simulation;
 
     updateTimer.start();
 
@@ -134,8 +153,8 @@ public class SerialSocketServer extends VisPlugin implements MotePlugin {
               in = new DataInputStream(client.getInputStream());
               out = new DataOutputStream(client.getOutputStream());
               out.flush();
-
               startSocketReadThread(in);
+              startSocketWriteThread(out);
               if (GUI.isVisualized()) {
                 statusLabel.setText("Client connected: " + client.getInetAddress());
               }
@@ -156,18 +175,20 @@ public class SerialSocketServer extends VisPlugin implements MotePlugin {
     /* Observe serial port for outgoing data */
     serialPort.addSerialDataObserver(serialDataObserver = new Observer() {
       public void update(Observable obs, Object obj) {
-        try {
-          if (out == null) {
-            /*logger.debug("out is null");*/
+        if (out == null) {
+          /*logger.debug("out is null");*/
+          return;
+        }
+
+        synchronized (outBuffer) {
+          if (outBufferLen == OUT_BUFFER_SIZE) {
+            outDropped++;
             return;
           }
-          
-          out.write(serialPort.getLastSerialData());
-          out.flush();
-          
-          outBytes++;
-        } catch (IOException e) {
-          cleanupClient();
+          outBuffer[outBufferLen++] = serialPort.getLastSerialData();
+          if (outBufferLen == 1 || outBufferLen == FLUSH_THRESHOLD) {
+            outBuffer.notifyAll();
+          }
         }
       }
     });
@@ -189,11 +210,33 @@ public class SerialSocketServer extends VisPlugin implements MotePlugin {
           }
 
           if (numRead >= 0) {
-            for (int i=0; i < numRead; i++) {
-              serialPort.writeByte(data[i]);
+            final byte[] chunk = new byte[numRead];
+            System.arraycopy(data, 0, chunk, 0, numRead);
+            synchronized (inLock) {
+              inPending += numRead;
             }
+            simulation.invokeSimulationThread(new Runnable() {
+              public void run() {
+                serialPort.writeArray(chunk);
+                synchronized (inLock) {
+                  inPending -= chunk.length;
+                  inLock.notifyAll();
+                }
+              }
+            });
 
             inBytes += numRead;
+
+            /* Flow control: wait for the simulation to catch up */
+            try {
+              synchronized (inLock) {
+                while (inPending > IN_PENDING_MAX && SerialSocketServer.this.in == in) {
+                  inLock.wait(100);
+                }
+              }
+            } catch (InterruptedException e) {
+              break;
+            }
           } else {
             cleanupClient();
             break;
@@ -204,6 +247,52 @@ public class SerialSocketServer extends VisPlugin implements MotePlugin {
     incomingDataThread.start();
   }
 
+  private void startSocketWriteThread(final DataOutputStream out) {
+    /* Forward data: mote -> virtual port */
+    Thread outgoingDataThread = new Thread(new Runnable() {
+      public void run() {
+        byte[] chunk = new byte[OUT_BUFFER_SIZE];
+        int len;
+
+        synchronized (outBuffer) {
+          /* Drop what the mote wrote before the client connected */
+          outBufferLen = 0;
+        }
+        while (true) {
+          synchronized (outBuffer) {
+            try {
+              while (outBufferLen == 0 && SerialSocketServer.this.out == out) {
+                outBuffer.wait();
+              }
+              if (SerialSocketServer.this.out != out) {
+                break;
+              }
+              /* Coalesce: give the mote a moment to write some more */
+              if (outBufferLen < FLUSH_THRESHOLD) {
+                outBuffer.wait(FLUSH_DELAY);
+              }
+            } catch (InterruptedException e) {
+              break;
+            }
+            len = outBufferLen;
+            System.arraycopy(outBuffer, 0, chunk, 0, len);
+            outBufferLen = 0;
+          }
+
+          try {
+            out.write(chunk, 0, len);
+            out.flush();
+            outBytes += len;
+          } catch (IOException e) {
+            cleanupClient();
+            break;
+          }
+        }
+      }
+    });
+    outgoingDataThread.start();
+  }
+
   private JLabel configureLabel(JComponent pane, String desc, String value) {
     JPanel smallPane = new JPanel(new BorderLayout());
     JLabel label = new JLabel(desc);
@@ -246,6 +335,13 @@ public class SerialSocketServer extends VisPlugin implements MotePlugin {
       }
     } catch (IOException e) {
     }
+    synchronized (outBuffer) {
+      outBufferLen = 0;
+      outBuffer.notifyAll();
+    }
+    synchronized (inLock) {
+      inLock.notifyAll();
+    }
 
     if (GUI.isVisualized()) {
       SwingUtilities.invokeLater(new Runnable() {
@@ -280,7 +376,11 @@ public class SerialSocketServer extends VisPlugin implements MotePlugin {
 		  }
 		  
 		  inLabel.setText(inBytes + " bytes");
-		  outLabel.setText(outBytes + " bytes");
+		  if (outDropped > 0) {
+			  outLabel.setText(outBytes + " bytes (" + outDropped + " dropped)");
+		  } else {
+			  outLabel.setText(outBytes + " bytes");
+		  }
 	  }
   });
 }
@@ -30,13 +30,23 @@
 
 package se.sics.cooja;
 
+import java.util.Arrays;
+
 /**
+ * Time-ordered queue of simulation events.
+ *
+ * Events are kept in a binary heap ordered by time, and by scheduling order
+ * among events with the same time. Adding and popping an event is
+ * O(log n). Events removed with {@link TimeEvent#remove()} stay in the heap
+ * until they reach the top, so removal is O(1).
+ *
  * @author Joakim Eriksson (ported to COOJA by Fredrik Osterlind)
  */
 public class EventQueue {
 
-  private TimeEvent first;
+  private TimeEvent[] heap = new TimeEvent[64];
   private int eventCount = 0;
+  private long scheduled = 0;
 
   /**
    * Should only be called from simulation thread!
@@ -57,29 +67,61 @@ public class EventQueue {
       removeFromQueue(event);
     }
 
-    if (first == null) {
-      first = event;
-    } else {
-      TimeEvent pos = first;
-      TimeEvent lastPos = first;
-      while (pos != null && pos.time <= event.time) {
-        lastPos = pos;
-        pos = pos.nextEvent;
-      }
-      // Here pos will be the first TE after event
-      // and lastPos the first before
-      if (pos == first) {
-        // Before all other
-        event.nextEvent = pos;
-        first = event;
-      } else {
-        event.nextEvent = pos;
-        lastPos.nextEvent = event;
-      }
+    if (eventCount == heap.length) {
+      heap = Arrays.copyOf(heap, 2 * heap.length);
     }
+    event.order = scheduled++;
+    heap[eventCount] = event;
+    event.heapIndex = eventCount;
+    eventCount++;
+    siftUp(event.heapIndex);
+
     event.queue = this;
     event.isScheduled = true;
-    eventCount++;
+  }
+
+  private static boolean before(TimeEvent a, TimeEvent b) {
+    if (a.time != b.time) {
+      return a.time < b.time;
+    }
+    return a.order < b.order;
+  }
+
+  private void place(TimeEvent event, int index) {
+    heap[index] = event;
+    event.heapIndex = index;
+  }
+
+  private void siftUp(int index) {
+    TimeEvent event = heap[index];
+    while (index > 0) {
+      int parent = (index - 1) / 2;
+      if (!before(event, heap[parent])) {
+        break;
+      }
+      place(heap[parent], index);
+      index = parent;
+    }
+    place(event, index);
+  }
+
+  private void siftDown(int index) {
+    TimeEvent event = heap[index];
+    while (true) {
+      int child = 2 * index + 1;
+      if (child >= eventCount) {
+        break;
+      }
+      if (child + 1 < eventCount && before(heap[child + 1], heap[child])) {
+        child++;
+      }
+      if (!before(heap[child], event)) {
+        break;
+      }
+      place(heap[child], index);
+      index = child;
+    }
+    place(event, index);
   }
 
   /**
@@ -89,30 +131,25 @@ public class EventQueue {
    * @return True if event was removed
    */
   private boolean removeFromQueue(TimeEvent event) {
-    TimeEvent pos = first;
-    TimeEvent lastPos = first;
-
-    while (pos != null && pos != event) {
-      lastPos = pos;
-      pos = pos.nextEvent;
-    }
-    if (pos == null) {
+    int index = event.heapIndex;
+    if (event.queue != this || index >= eventCount || heap[index] != event) {
       return false;
     }
-    // pos == event!
-    if (pos == first) {
-      // remove it from first pos.
-      first = pos.nextEvent;
-    } else {
-      // else link prev to next...
-      lastPos.nextEvent = pos.nextEvent;
+
+    eventCount--;
+    if (index < eventCount) {
+      /* Fill the hole with the last event */
+      place(heap[eventCount], index);
+      if (index > 0 && before(heap[index], heap[(index - 1) / 2])) {
+        siftUp(index);
+      } else {
+        siftDown(index);
+      }
     }
-    // unlink
-    pos.nextEvent = null;
+    heap[eventCount] = null;
 
     event.queue = null;
     event.isScheduled = false;
-    eventCount--;
     return true;
   }
 
@@ -129,29 +166,39 @@ public class EventQueue {
    * @return Event
    */
   public TimeEvent popFirst() {
-    TimeEvent tmp = first;
-    if (tmp == null) {
-      return null;
-    }
-
-    first = tmp.nextEvent;
-    // Unlink.
-    tmp.nextEvent = null;
+    while (eventCount > 0) {
+      TimeEvent tmp = heap[0];
+      boolean wasScheduled = tmp.isScheduled;
+      removeFromQueue(tmp);
 
-    // No longer scheduled!
-    tmp.queue = null;
-    eventCount--;
-
-    if (!tmp.isScheduled) {
-      /* pop and return another event instead */
-      return popFirst();
+      if (wasScheduled) {
+        return tmp;
+      }
+      /* Removed while queued: pop another event instead */
     }
-    tmp.isScheduled = false;
-    return tmp;
+    return null;
   }
 
   public TimeEvent peekFirst() {
-    return first;
+    /* Drop removed events from the top */
+    while (eventCount > 0 && !heap[0].isScheduled) {
+      removeFromQueue(heap[0]);
+    }
+    return eventCount > 0 ? heap[0] : null;
+  }
+
+  /**
+   * @return Scheduled events, in no particular order
+   */
+  public TimeEvent[] getEvents() {
+    TimeEvent[] events = new TimeEvent[eventCount];
+    int n = 0;
+    for (int i = 0; i < eventCount; i++) {
+      if (heap[i].isScheduled) {
+        events[n++] = heap[i];
+      }
+    }
+    return Arrays.copyOf(events, n);
   }
 
   public String toString() {
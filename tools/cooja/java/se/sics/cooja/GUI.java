@@ -270,6 +270,8 @@ public class GUI extends Observable {
 
     "PARSE_WITH_COMMAND",
 
+    "PATH_FIRMWARE_CACHE",
+
     "MAPFILE_DATA_START", "MAPFILE_DATA_SIZE",
     "MAPFILE_BSS_START", "MAPFILE_BSS_SIZE",
     "MAPFILE_COMMON_START", "MAPFILE_COMMON_SIZE",
@@ -56,6 +56,11 @@ public class SectionMoteMemory implements MoteMemory, AddressMemory {
 
   /* used to map Cooja's address space to native (Contiki's) addresses */
   private final int offset;
+
+  /* While attached, the native core holds this memory: writes go through to
+   * it, and reads come from it once the core has run (coreAhead) */
+  private CoreComm core = null;
+  private boolean coreAhead = false;
   
   /**
    * @param addresses Symbol addresses
@@ -87,6 +92,49 @@ public class SectionMoteMemory implements MoteMemory, AddressMemory {
     sections.clear();
   }
 
+  /**
+   * Copies this memory to the native core and keeps the two in sync until
+   * {@link #detachCore()}. Only the segments that are read or written are
+   * transferred while attached, instead of all sections.
+   *
+   * @param comm Core communicator of the native library
+   */
+  public void attachCore(CoreComm comm) {
+    for (MoteMemorySection section : sections) {
+      comm.setMemory(section.getStartAddr(), section.getSize(), section.getData());
+    }
+    core = comm;
+    coreAhead = false;
+  }
+
+  /**
+   * Copies the native core memory back, if it has changed, and stops
+   * accessing the core.
+   */
+  public void detachCore() {
+    syncFromCore();
+    core = null;
+  }
+
+  /**
+   * Must be called after the attached core has run.
+   */
+  public void coreChanged() {
+    if (core != null) {
+      coreAhead = true;
+    }
+  }
+
+  private void syncFromCore() {
+    if (core == null || !coreAhead) {
+      return;
+    }
+    for (MoteMemorySection section : sections) {
+      core.getMemory(section.getStartAddr(), section.getSize(), section.getData());
+    }
+    coreAhead = false;
+  }
+
   public byte[] getMemorySegment(int address, int size) {
     /* Cooja address space */
     address -= offset;
@@ -94,6 +142,12 @@ public class SectionMoteMemory implements MoteMemory, AddressMemory {
     for (MoteMemorySection section : sections) {
       if (section.includesAddr(address)
           && section.includesAddr(address + size - 1)) {
+        if (core != null && coreAhead) {
+          byte[] data = new byte[size];
+          core.getMemory(address, size, data);
+          section.setMemorySegment(address, data);
+          return data;
+        }
         return section.getMemorySegment(address, size);
       }
     }
@@ -117,6 +171,10 @@ public class SectionMoteMemory implements MoteMemory, AddressMemory {
     /* Cooja address space */
     address -= offset;
 
+    if (core != null) {
+      core.setMemory(address, data.length, data);
+    }
+
     /* TODO XXX Sections may overlap */
     for (MoteMemorySection section : sections) {
       if (section.includesAddr(address)
@@ -189,6 +247,7 @@ public class SectionMoteMemory implements MoteMemory, AddressMemory {
     if (sectionNr >= sections.size()) {
       return null;
     }
+    syncFromCore();
 
     return sections.get(sectionNr).getData();
   }
@@ -357,6 +416,7 @@ public class SectionMoteMemory implements MoteMemory, AddressMemory {
   }
 
   public SectionMoteMemory clone() {
+    syncFromCore();
     ArrayList<MoteMemorySection> sectionsClone = new ArrayList<MoteMemorySection>();
     for (MoteMemorySection section : sections) {
       sectionsClone.add(section.clone());
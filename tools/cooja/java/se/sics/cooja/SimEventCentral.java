@@ -62,6 +62,7 @@ public class SimEventCentral {
 
     /* Default buffer sizes */
     logOutputBufferSize = Integer.parseInt(GUI.getExternalToolsSetting("BUFFERSIZE_LOGOUTPUT", "" + 40000));
+    radioLogBufferSize = Integer.parseInt(GUI.getExternalToolsSetting("BUFFERSIZE_RADIOLOG", "" + 40000));
 
     
     moteObservations = new ArrayList<MoteObservation>();
@@ -197,6 +198,7 @@ public class SimEventCentral {
     }
   }
   private int logOutputBufferSize;
+  private int radioLogBufferSize;
   private ArrayDeque<LogOutputEvent> logOutputEvents;
   public interface LogOutputListener extends MoteCountListener {
     public void removedLogOutput(LogOutputEvent ev);
@@ -295,6 +297,17 @@ public class SimEventCentral {
       }
     }
   }
+
+  /**
+   * @return Max number of radio packets retained by radio loggers
+   */
+  public int getRadioLogBufferSize() {
+    return radioLogBufferSize;
+  }
+  public void setRadioLogBufferSize(int size) {
+    radioLogBufferSize = size;
+  }
+
   public int getLogOutputObservationsCount() {
     int count=0;
     MoteObservation[] observations = moteObservations.toArray(new MoteObservation[0]);
@@ -353,6 +366,11 @@ public class SimEventCentral {
     element.setText("" + logOutputBufferSize);
     config.add(element);
 
+    /* Radio log buffer size */
+    element = new Element("radiolog");
+    element.setText("" + radioLogBufferSize);
+    config.add(element);
+
     return config;
   }
 
@@ -363,6 +381,8 @@ public class SimEventCentral {
       String name = element.getName();
       if (name.equals("logoutput")) {
         logOutputBufferSize = Integer.parseInt(element.getText());
+      } else if (name.equals("radiolog")) {
+        radioLogBufferSize = Integer.parseInt(element.getText());
       }
     }
     return true;
@@ -762,14 +762,12 @@ public class Simulation extends Observable implements Runnable {
 
         /* Loop through all scheduled events.
          * Delete all events associated with deleted mote. */
-        TimeEvent ev = eventQueue.peekFirst();
-        while (ev != null) {
+        for (TimeEvent ev: eventQueue.getEvents()) {
           if (ev instanceof MoteTimeEvent) {
             if (((MoteTimeEvent)ev).getMote() == mote) {
               ev.remove();
             }
           }
-          ev = ev.nextEvent;
         }
       }
     };
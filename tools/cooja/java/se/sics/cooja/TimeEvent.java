@@ -34,8 +34,9 @@ package se.sics.cooja;
  * @author Joakim Eriksson (ported to COOJA by Fredrik Osterlind)
  */
 public abstract class TimeEvent {
-  TimeEvent nextEvent;
-  TimeEvent prevEvent;
+  /* Position in the EventQueue heap, and tie-breaker for equal times */
+  int heapIndex;
+  long order;
 
   EventQueue queue = null;
   String name;
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+package se.sics.cooja.contikimote;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.util.Arrays;
+
+import org.apache.log4j.Logger;
+
+import se.sics.cooja.GUI;
+
+/**
+ * Content-addressed cache of compiled Cooja mote libraries.
+ * <p>
+ * The cache key is a digest of the compilation environment, the compile
+ * commands, and all C sources, headers and makefiles that a Cooja mote build
+ * may depend on: the application directory, the Contiki core, apps, the
+ * Cooja platform and CPU, and any project C_SOURCES directories.
+ * The library, map and archive files of a successful build are stored under
+ * the key, and restored instead of recompiling when the key matches.
+ * <p>
+ * The cache is enabled by setting the external tools setting
+ * PATH_FIRMWARE_CACHE to a directory.
+ *
+ * @see ContikiMoteType
+ */
+public class ContikiFirmwareCache {
+  private static Logger logger = Logger.getLogger(ContikiFirmwareCache.class);
+
+  /* Contiki directories that Cooja mote builds depend on */
+  private static final String[] CONTIKI_SOURCE_DIRS = {
+    "core", "apps", "cpu/x86", "platform/cooja"
+  };
+
+  /**
+   * @return Cache directory, or null if the cache is disabled
+   */
+  public static File getCacheDirectory() {
+    String path = GUI.getExternalToolsSetting("PATH_FIRMWARE_CACHE", "");
+    if (path == null || path.trim().isEmpty()) {
+      return null;
+    }
+    return new File(path.trim());
+  }
+
+  /**
+   * Calculates the cache key of a Cooja mote build.
+   *
+   * @param contikiApp Contiki application source file
+   * @param env Compilation environment
+   * @param commands Compile commands
+   * @return Cache key, or null if the cache is disabled or at errors
+   */
+  public static String createKey(File contikiApp, String[][] env, String commands) {
+    if (getCacheDirectory() == null) {
+      return null;
+    }
+
+    try {
+      MessageDigest digest = MessageDigest.getInstance("MD5");
+      for (String[] var: env) {
+        digest.update((var[0] + "=" + var[1] + "\n").getBytes());
+        if (var[0].equals("COOJA_SOURCEDIRS")) {
+          for (String dir: var[1].split(" ")) {
+            if (!dir.trim().isEmpty()) {
+              updateDirectory(digest, new File(dir.trim()), false);
+            }
+          }
+        }
+      }
+      digest.update(commands.getBytes());
+
+      updateDirectory(digest, contikiApp.getParentFile(), false);
+      File contiki = new File(GUI.getExternalToolsSetting("PATH_CONTIKI"));
+      updateFile(digest, new File(contiki, "Makefile.include"));
+      for (String dir: CONTIKI_SOURCE_DIRS) {
+        updateDirectory(digest, new File(contiki, dir), true);
+      }
+
+      StringBuilder sb = new StringBuilder();
+      for (byte b: digest.digest()) {
+        sb.append(String.format("%02x", b & 0xff));
+      }
+      return sb.toString();
+    } catch (NoSuchAlgorithmException e) {
+      logger.warn("Firmware cache disabled: " + e.getMessage());
+    } catch (IOException e) {
+      logger.warn("Firmware cache disabled: " + e.getMessage());
+    }
+    return null;
+  }
+
+  /**
+   * Copies cached build output to the given files.
+   *
+   * @param key Cache key
+   * @param files Build output files
+   * @return True if all files were restored from the cache
+   */
+  public static boolean restore(String key, File... files) {
+    File entry = new File(getCacheDirectory(), key);
+    for (File file: files) {
+      if (!new File(entry, file.getName()).exists()) {
+        return false;
+      }
+    }
+    try {
+      for (File file: files) {
+        file.getParentFile().mkdirs();
+        copyFile(new File(entry, file.getName()), file);
+      }
+    } catch (IOException e) {
+      logger.warn("Error when restoring cached firmware: " + e.getMessage());
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Stores build output in the cache.
+   * The files are written to a temporary directory that is renamed when
+   * complete, so concurrent simulations never see partial entries.
+   *
+   * @param key Cache key
+   * @param files Build output files
+   */
+  public static void store(String key, File... files) {
+    File cache = getCacheDirectory();
+    File entry = new File(cache, key);
+    if (entry.exists()) {
+      return;
+    }
+    File tmp = new File(cache, key + ".tmp" + System.nanoTime());
+    try {
+      if (!tmp.mkdirs()) {
+        throw new IOException("Could not create " + tmp);
+      }
+      for (File file: files) {
+        copyFile(file, new File(tmp, file.getName()));
+      }
+      if (tmp.renameTo(entry)) {
+        return;
+      }
+    } catch (IOException e) {
+      logger.warn("Error when caching firmware: " + e.getMessage());
+    }
+
+    /* Failed, or another simulation cached the same firmware first */
+    File[] tmpFiles = tmp.listFiles();
+    if (tmpFiles != null) {
+      for (File file: tmpFiles) {
+        file.delete();
+      }
+    }
+    tmp.delete();
+  }
+
+  private static void updateDirectory(MessageDigest digest, File dir, boolean recursive)
+  throws IOException {
+    File[] files = dir.listFiles();
+    if (files == null) {
+      return;
+    }
+    Arrays.sort(files);
+    for (File file: files) {
+      String name = file.getName();
+      if (file.isDirectory()) {
+        if (recursive && !name.startsWith(".") && !name.startsWith("obj_")) {
+          updateDirectory(digest, file, true);
+        }
+      } else if (name.endsWith(".c") || name.endsWith(".h") ||
+          name.startsWith("Makefile")) {
+        updateFile(digest, file);
+      }
+    }
+  }
+
+  private static void updateFile(MessageDigest digest, File file)
+  throws IOException {
+    if (!file.exists()) {
+      return;
+    }
+    digest.update((file.getPath() + "\n").getBytes());
+    byte[] buf = new byte[4096];
+    InputStream in = new FileInputStream(file);
+    try {
+      int len;
+      while ((len = in.read(buf)) > 0) {
+        digest.update(buf, 0, len);
+      }
+    } finally {
+      in.close();
+    }
+  }
+
+  private static void copyFile(File from, File to)
+  throws IOException {
+    byte[] buf = new byte[4096];
+    InputStream in = new FileInputStream(from);
+    try {
+      OutputStream out = new FileOutputStream(to);
+      try {
+        int len;
+        while ((len = in.read(buf)) > 0) {
+          out.write(buf, 0, len);
+        }
+      } finally {
+        out.close();
+      }
+    } finally {
+      in.close();
+    }
+  }
+}
@@ -115,7 +115,8 @@ public class ContikiMote extends AbstractWakeupMote implements Mote {
   /**
    * Ticks mote once. This is done by first polling all interfaces
    * and letting them act on the stored memory before the memory is set. Then
-   * the mote is ticked, and the new memory is received.
+   * the mote is ticked; the new memory is read back from the core lazily,
+   * segment by segment, until another mote of the same type runs.
    * Finally all interfaces are allowing to act on the new memory in order to
    * discover relevant changes. This method also schedules the next mote tick time
    * depending on Contiki specifics; pending timers and polled processes.
@@ -134,14 +135,14 @@ public class ContikiMote extends AbstractWakeupMote implements Mote {
       return;
     }
 
-    /* Copy mote memory to Contiki */
-    myType.setCoreMemory(myMemory);
+    /* Give Contiki this mote's memory, unless it already has it */
+    myType.switchCoreMemory(myMemory);
 
     /* Handle a single Contiki events */
     myType.tick();
 
-    /* Copy mote memory from Contiki */
-    myType.getCoreMemory(myMemory);
+    /* Memory is read back from Contiki on demand */
+    myMemory.coreChanged();
 
     /* Poll mote interfaces */
     myMemory.pollForMemoryChanges();
@@ -197,6 +197,9 @@ public class ContikiMoteType implements MoteType {
   // Initial memory for all motes of this type
   private SectionMoteMemory initialMemory = null;
 
+  /* The mote memory currently held by the native library */
+  private SectionMoteMemory coreMemoryOwner = null;
+
   /**
    * Creates a new uninitialized Cooja mote type. This mote type needs to load
    * a library file and parse a map file before it can be used.
@@ -299,8 +302,18 @@ public class ContikiMoteType implements MoteType {
       if (getCompileCommands() == null) {
         throw new MoteTypeCreationException("No compile commands specified");
       }
+
+      /* Reuse previously compiled firmware, if cached */
+      String cacheKey = ContikiFirmwareCache.createKey(
+          contikiApp, env, getCompileCommands());
+      boolean cached = cacheKey != null &&
+          ContikiFirmwareCache.restore(cacheKey, libFile, mapFile, archiveFile);
+      if (cached) {
+        logger.info("Using cached firmware: " + cacheKey);
+      }
+
       final MessageList compilationOutput = new MessageList();
-      String[] arr = getCompileCommands().split("\n");
+      String[] arr = cached?new String[0]:getCompileCommands().split("\n");
       for (String cmd: arr) {
         if (cmd.trim().isEmpty()) {
           continue;
@@ -342,6 +355,10 @@ public class ContikiMoteType implements MoteType {
           !getContikiFirmwareFile().exists()) {
         throw new MoteTypeCreationException("Contiki firmware file does not exist: " + getContikiFirmwareFile());
       }
+
+      if (cacheKey != null && !cached) {
+        ContikiFirmwareCache.store(cacheKey, libFile, mapFile, archiveFile);
+      }
     }
 
     /* Load compiled library */
@@ -558,6 +575,26 @@ public class ContikiMoteType implements MoteType {
     return initialMemory.clone();
   }
 
+  /**
+   * Make the native library hold the given mote memory. All motes of this
+   * type share the library, so the memory is only copied when a different
+   * mote runs than the one that ran last: the previous owner's memory is
+   * then copied back, and the new one copied in. While a mote owns the
+   * library, its memory reads and writes go to the library directly.
+   *
+   * @param mem Mote memory
+   */
+  public void switchCoreMemory(SectionMoteMemory mem) {
+    if (coreMemoryOwner == mem) {
+      return;
+    }
+    if (coreMemoryOwner != null) {
+      coreMemoryOwner.detachCore();
+    }
+    mem.attachCore(myCoreComm);
+    coreMemoryOwner = mem;
+  }
+
   /**
    * Copy given memory to the Contiki system. This should not be used directly,
    * but instead via ContikiMote.setMemory().
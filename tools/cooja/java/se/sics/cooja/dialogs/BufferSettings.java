@@ -103,6 +103,19 @@ public class BufferSettings extends JDialog {
       }
     });
 
+    value = addEntry(main, "Radio log packets");
+    value.setValue(central.getRadioLogBufferSize());
+    value.addPropertyChangeListener("value", new PropertyChangeListener() {
+      public void propertyChange(PropertyChangeEvent evt) {
+        int newVal = ((Number)evt.getNewValue()).intValue();
+        if (newVal < 1) {
+          newVal = 1;
+          ((JFormattedTextField)evt.getSource()).setValue(newVal);
+        }
+        central.setRadioLogBufferSize(newVal);
+      }
+    });
+
     main.add(Box.createVerticalStrut(10));
 
     Box line = Box.createHorizontalBox();
@@ -146,6 +159,7 @@ public class BufferSettings extends JDialog {
       }
 
       GUI.setExternalToolsSetting("BUFFERSIZE_LOGOUTPUT", "" + central.getLogOutputBufferSize());
+      GUI.setExternalToolsSetting("BUFFERSIZE_RADIOLOG", "" + central.getRadioLogBufferSize());
     }
   };
 
@@ -44,11 +44,13 @@ import java.awt.event.MouseAdapter;
 import java.awt.event.MouseEvent;
 import java.io.File;
 import java.io.FileWriter;
+import java.io.IOException;
 import java.io.PrintWriter;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Collection;
 import java.util.HashMap;
+import java.util.List;
 import java.util.Observable;
 import java.util.Observer;
 import java.util.Properties;
@@ -93,12 +95,14 @@ import se.sics.cooja.RadioPacket;
 import se.sics.cooja.Simulation;
 import se.sics.cooja.VisPlugin;
 import se.sics.cooja.dialogs.TableColumnAdjuster;
+import se.sics.cooja.dialogs.UpdateAggregator;
 import se.sics.cooja.interfaces.Radio;
 import se.sics.cooja.plugins.analyzers.ICMPv6Analyzer;
 import se.sics.cooja.plugins.analyzers.IEEE802154Analyzer;
 import se.sics.cooja.plugins.analyzers.IPHCPacketAnalyzer;
 import se.sics.cooja.plugins.analyzers.IPv6PacketAnalyzer;
 import se.sics.cooja.plugins.analyzers.PacketAnalyzer;
+import se.sics.cooja.plugins.analyzers.PcapExporter;
 import se.sics.cooja.plugins.analyzers.RadioLoggerAnalyzerSuite;
 import se.sics.cooja.util.StringUtils;
 
@@ -137,6 +141,7 @@ public class RadioLogger extends VisPlugin {
   private final JTable dataTable;
   private TableRowSorter<TableModel> logFilter;
   private ArrayList<RadioConnectionLog> connections = new ArrayList<RadioConnectionLog>();
+  private int removedConnections = 0; /* Packets dropped from the buffer */
   private RadioMedium radioMedium;
   private Observer radioMediumObserver;
   private AbstractTableModel model;
@@ -147,6 +152,42 @@ public class RadioLogger extends VisPlugin {
 
   private JTextField searchField = new JTextField(30);
 
+  /* Streamed pcap export: accessed from the simulation thread */
+  private PcapExporter pcapExporter = null;
+
+  private static final int UPDATE_INTERVAL = 250;
+  private UpdateAggregator<RadioConnectionLog> logUpdateAggregator =
+    new UpdateAggregator<RadioConnectionLog>(UPDATE_INTERVAL) {
+    protected void handle(List<RadioConnectionLog> ls) {
+      /* Check if the last row is visible */
+      boolean isVisible = false;
+      int rowCount = dataTable.getRowCount();
+      if (rowCount > 0) {
+        Rectangle lastRow = dataTable.getCellRect(rowCount - 1, 0, true);
+        Rectangle visible = dataTable.getVisibleRect();
+        isVisible = visible.y <= lastRow.y && visible.y + visible.height >= lastRow.y + lastRow.height;
+      }
+
+      /* Add */
+      int index = connections.size();
+      connections.addAll(ls);
+      model.fireTableRowsInserted(index, connections.size() - 1);
+
+      /* Remove old */
+      int removed = connections.size() - simulation.getEventCentral().getRadioLogBufferSize();
+      if (removed > 0) {
+        connections.subList(0, removed).clear();
+        removedConnections += removed;
+        model.fireTableRowsDeleted(0, removed - 1);
+      }
+
+      if (isVisible) {
+        dataTable.scrollRectToVisible(dataTable.getCellRect(dataTable.getRowCount() - 1, 0, true));
+      }
+      setTitle("Radio messages: showing " + dataTable.getRowCount() + "/" + connections.size() + " packets");
+    }
+  };
+
   public RadioLogger(final Simulation simulationToControl, final GUI gui) {
     super("Radio messages", gui);
     setLayout(new BorderLayout());
@@ -206,9 +247,9 @@ public class RadioLogger extends VisPlugin {
         RadioConnectionLog conn = connections.get(row);
         if (col == COLUMN_NO) {
           if (!showDuplicates && conn.hides > 0) {
-            return (String) "" + (row + 1) + "+" + conn.hides;
+            return (String) "" + (row + 1 + removedConnections) + "+" + conn.hides;
           }
-          return (String) "" + (row + 1);
+          return (String) "" + (row + 1 + removedConnections);
         } else if (col == COLUMN_TIME) {
           if (formatTimeString) {
             return LogListener.getFormattedTime(conn.startTime);
@@ -403,6 +444,11 @@ public class RadioLogger extends VisPlugin {
     });
 
     fileMenu.add(new JMenuItem(saveAction));
+    fileMenu.add(new JCheckBoxMenuItem(pcapAction) {
+      public boolean isSelected() {
+        return pcapExporter != null;
+      }
+    });
 
 
     JPopupMenu popupMenu = new JPopupMenu();
@@ -504,29 +550,14 @@ public class RadioLogger extends VisPlugin {
         loggedConn.endTime = simulation.getSimulationTime();
         loggedConn.connection = conn;
         loggedConn.packet = conn.getSource().getLastPacketTransmitted();
-        java.awt.EventQueue.invokeLater(new Runnable() {
-          public void run() {
-            int lastSize = connections.size();
-            // Check if the last row is visible
-            boolean isVisible = false;
-            int rowCount = dataTable.getRowCount();
-            if (rowCount > 0) {
-              Rectangle lastRow = dataTable.getCellRect(rowCount - 1, 0, true);
-              Rectangle visible = dataTable.getVisibleRect();
-              isVisible = visible.y <= lastRow.y && visible.y + visible.height >= lastRow.y + lastRow.height;
-            }
-            connections.add(loggedConn);
-            if (connections.size() > lastSize) {
-              model.fireTableRowsInserted(lastSize, connections.size() - 1);
-            }
-            if (isVisible) {
-              dataTable.scrollRectToVisible(dataTable.getCellRect(dataTable.getRowCount() - 1, 0, true));
-            }
-            setTitle("Radio messages: showing " + dataTable.getRowCount() + "/" + connections.size() + " packets");
-          }
-        });
+        if (loggedConn.packet == null) {
+          return;
         }
-      });
+        exportPcap(loggedConn);
+        logUpdateAggregator.add(loggedConn);
+      }
+    });
+    logUpdateAggregator.start();
 
     setSize(500, 300);
     try {
@@ -764,6 +795,32 @@ public class RadioLogger extends VisPlugin {
     if (radioMediumObserver != null) {
       radioMedium.deleteRadioMediumObserver(radioMediumObserver);
     }
+    logUpdateAggregator.stop();
+    closePcap();
+  }
+
+  private synchronized void exportPcap(RadioConnectionLog conn) {
+    if (pcapExporter == null) {
+      return;
+    }
+    try {
+      pcapExporter.exportPacketData(conn.packet.getPacketData(), conn.startTime);
+    } catch (IOException e) {
+      logger.fatal("Could not write pcap data: " + e.getMessage());
+      closePcap();
+    }
+  }
+
+  private synchronized void closePcap() {
+    if (pcapExporter == null) {
+      return;
+    }
+    try {
+      pcapExporter.closePcap();
+    } catch (IOException e) {
+      logger.warn("Could not close pcap file: " + e.getMessage());
+    }
+    pcapExporter = null;
   }
 
   public Collection<Element> getConfigXML() {
@@ -913,6 +970,7 @@ public class RadioLogger extends VisPlugin {
 
     public void actionPerformed(ActionEvent e) {
       int size = connections.size();
+      removedConnections = 0;
       if (size > 0) {
         connections.clear();
         model.fireTableRowsDeleted(0, size - 1);
@@ -1000,6 +1058,35 @@ public class RadioLogger extends VisPlugin {
     }
   };
 
+  private Action pcapAction = new AbstractAction("Stream to pcap file...") {
+    private static final long serialVersionUID = -5286537950209475853L;
+
+    public void actionPerformed(ActionEvent e) {
+      if (pcapExporter != null) {
+        /* Stop streaming */
+        closePcap();
+        return;
+      }
+
+      JFileChooser fc = new JFileChooser();
+      int returnVal = fc.showSaveDialog(GUI.getTopParentContainer());
+      if (returnVal != JFileChooser.APPROVE_OPTION) {
+        return;
+      }
+
+      File pcapFile = fc.getSelectedFile();
+      try {
+        PcapExporter exporter = new PcapExporter();
+        exporter.openPcap(pcapFile);
+        synchronized (RadioLogger.this) {
+          pcapExporter = exporter;
+        }
+      } catch (IOException ex) {
+        logger.fatal("Could not open pcap file: " + pcapFile);
+      }
+    }
+  };
+
   private Action timeLineAction = new AbstractAction("Timeline") {
     private static final long serialVersionUID = -4035633464748224192L;
     public void actionPerformed(ActionEvent e) {
@@ -188,6 +188,11 @@ public class Visualizer extends VisPlugin implements HasQuickHelp {
   private final static Color MOVE_COLOR = Color.WHITE;
   private Observer moteRelationsObserver = null;
 
+  /* Repaint requests are coalesced and served at most once per frame */
+  private final static int FRAME_INTERVAL = 40; /* ms */
+  private boolean repaintPending = false;
+  private Timer repaintTimer = null;
+
   /* Popup menu */
   public static interface SimulationMenuAction {
     public boolean isEnabled(Visualizer visualizer, Simulation simulation);
@@ -300,6 +305,22 @@ public class Visualizer extends VisPlugin implements HasQuickHelp {
     canvas.setBackground(Color.WHITE);
     viewportTransform = new AffineTransform();
 
+    repaintTimer = new Timer(FRAME_INTERVAL, new ActionListener() {
+      public void actionPerformed(ActionEvent e) {
+        synchronized (repaintTimer) {
+          if (!repaintPending || isIcon()) {
+            /* Idle, or nothing to see: the timer restarts on demand */
+            repaintPending = false;
+            repaintTimer.stop();
+            return;
+          }
+          repaintPending = false;
+        }
+        Visualizer.super.repaint();
+      }
+    });
+    repaintTimer.setInitialDelay(0);
+
     this.add(BorderLayout.CENTER, canvas);
 
     /* Observe simulation and mote positions */
@@ -1013,6 +1034,25 @@ public class Visualizer extends VisPlugin implements HasQuickHelp {
     return motes.toArray(motesArr);
   }
 
+  /**
+   * Requests a repaint. Mote, radio and skin events may request repaints
+   * far more often than the screen can show them, and from any thread:
+   * requests are coalesced and served at most once every FRAME_INTERVAL ms.
+   */
+  public void repaint() {
+    if (repaintTimer == null) {
+      /* Still being constructed */
+      super.repaint();
+      return;
+    }
+    synchronized (repaintTimer) {
+      repaintPending = true;
+      if (!repaintTimer.isRunning()) {
+        repaintTimer.start();
+      }
+    }
+  }
+
   public void paintMotes(Graphics g) {
     Mote[] allMotes = simulation.getMotes();
 
@@ -1246,6 +1286,9 @@ public class Visualizer extends VisPlugin implements HasQuickHelp {
   }
 
   public void closePlugin() {
+    if (repaintTimer != null) {
+      repaintTimer.stop();
+    }
     for (VisualizerSkin skin: currentSkins) {
       skin.setInactive();
     }
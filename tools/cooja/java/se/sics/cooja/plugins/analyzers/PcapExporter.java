@@ -1,6 +1,8 @@
 package se.sics.cooja.plugins.analyzers;
 
+import java.io.BufferedOutputStream;
 import java.io.DataOutputStream;
+import java.io.File;
 import java.io.FileInputStream;
 import java.io.FileOutputStream;
 import java.io.FileWriter;
@@ -14,7 +16,11 @@ public class PcapExporter {
     }
     
     public void openPcap() throws IOException {
-        out = new DataOutputStream(new FileOutputStream("radiolog-" + System.currentTimeMillis() + ".pcap"));
+        openPcap(new File("radiolog-" + System.currentTimeMillis() + ".pcap"));
+    }
+
+    public void openPcap(File file) throws IOException {
+        out = new DataOutputStream(new BufferedOutputStream(new FileOutputStream(file)));
         /* pcap header */
         out.writeInt(0xa1b2c3d4);
         out.writeShort(0x0002);
@@ -26,6 +32,9 @@ public class PcapExporter {
         out.flush();
         System.out.println("Opened pcap file!");
     }
+    public void flush() throws IOException {
+        out.flush();
+    }
     public void closePcap() throws IOException {
         out.close();
     }
@@ -47,6 +56,24 @@ public class PcapExporter {
             e.printStackTrace();
         }
     }
+
+    /**
+     * Streams a packet stamped with simulated time. The stream is not
+     * flushed per packet; call flush() or closePcap() when done.
+     *
+     * @param data Packet data
+     * @param time Simulated time (us)
+     */
+    public void exportPacketData(byte[] data, long time) throws IOException {
+        if (out == null) {
+            openPcap();
+        }
+        out.writeInt((int) (time / 1000000));
+        out.writeInt((int) (time % 1000000));
+        out.writeInt(data.length);
+        out.writeInt(data.length+2);
+        out.write(data);
+    }
     
     
     
@@ -32,6 +32,7 @@ package se.sics.cooja.radiomediums;
 
 import java.util.ArrayList;
 import java.util.Collection;
+import java.util.HashMap;
 import java.util.Observable;
 import java.util.Observer;
 import java.util.Random;
@@ -91,28 +92,61 @@ public class UDGM extends AbstractRadioMedium {
 
   private Random random = null;
 
+  /* Radios whose signal strengths were set by the last update */
+  private ArrayList<Radio> signalRadios = new ArrayList<Radio>();
+  private boolean signalResetAll = true;
+
   public UDGM(Simulation simulation) {
     super(simulation);
     random = simulation.getRandomGenerator();
     dgrm = new DirectedGraphMedium() {
       protected void analyzeEdges() {
         /* Create edges according to distances.
-         * XXX May be slow for mobile networks */
+         * Radios are bucketed in a uniform grid with cells as wide as the
+         * largest range, so only radios in neighbouring cells are compared */
         clearEdges();
-        for (Radio source: UDGM.this.getRegisteredRadios()) {
+        double range = Math.max(TRANSMITTING_RANGE, INTERFERENCE_RANGE);
+        if (range <= 0) {
+          super.analyzeEdges();
+          return;
+        }
+        Radio[] radios = UDGM.this.getRegisteredRadios();
+        HashMap<Long,ArrayList<Radio>> grid = new HashMap<Long,ArrayList<Radio>>();
+        for (Radio radio: radios) {
+          Position pos = radio.getPosition();
+          Long cell = gridCell(gridIndex(pos.getXCoordinate(), range),
+              gridIndex(pos.getYCoordinate(), range));
+          ArrayList<Radio> list = grid.get(cell);
+          if (list == null) {
+            list = new ArrayList<Radio>();
+            grid.put(cell, list);
+          }
+          list.add(radio);
+        }
+
+        for (Radio source: radios) {
           Position sourcePos = source.getPosition();
-          for (Radio dest: UDGM.this.getRegisteredRadios()) {
-            Position destPos = dest.getPosition();
-            /* Ignore ourselves */
-            if (source == dest) {
-              continue;
-            }
-            double distance = sourcePos.getDistanceTo(destPos);
-            if (distance < Math.max(TRANSMITTING_RANGE, INTERFERENCE_RANGE)) {
-              /* Add potential destination */
-              addEdge(
-                  new DirectedGraphMedium.Edge(source, 
-                      new DGRMDestinationRadio(dest)));
+          int cx = gridIndex(sourcePos.getXCoordinate(), range);
+          int cy = gridIndex(sourcePos.getYCoordinate(), range);
+          for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+              ArrayList<Radio> list = grid.get(gridCell(cx + dx, cy + dy));
+              if (list == null) {
+                continue;
+              }
+              for (Radio dest: list) {
+                /* Ignore ourselves */
+                if (source == dest) {
+                  continue;
+                }
+                double distance = sourcePos.getDistanceTo(dest.getPosition());
+                if (distance < range) {
+                  /* Add potential destination */
+                  addEdge(
+                      new DirectedGraphMedium.Edge(source,
+                          new DGRMDestinationRadio(dest)));
+                }
+              }
             }
           }
         }
@@ -153,6 +187,19 @@ public class UDGM extends AbstractRadioMedium {
 		Visualizer.unregisterVisualizerSkin(UDGMVisualizerSkin.class);
   }
   
+  private static int gridIndex(double coordinate, double cellSize) {
+    return (int) Math.floor(coordinate / cellSize);
+  }
+
+  private static Long gridCell(int x, int y) {
+    return Long.valueOf(((long) x << 32) | (y & 0xffffffffL));
+  }
+
+  public void registerRadioInterface(Radio radio, Simulation sim) {
+    signalResetAll = true;
+    super.registerRadioInterface(radio, sim);
+  }
+
   public void setTxRange(double r) {
     TRANSMITTING_RANGE = r;
     dgrm.requestEdgeAnalysis();
@@ -274,13 +321,31 @@ public class UDGM extends AbstractRadioMedium {
   public void updateSignalStrengths() {
     /* Override: uses distance as signal strength factor */
     
-    /* Reset signal strengths */
-    for (Radio radio : getRegisteredRadios()) {
-      radio.setCurrentSignalStrength(SS_NOTHING);
+    /* Reset signal strengths.
+     * Only radios touched by the previous update can be above nothing */
+    if (signalResetAll) {
+      for (Radio radio : getRegisteredRadios()) {
+        radio.setCurrentSignalStrength(SS_NOTHING);
+      }
+      signalResetAll = false;
+    } else {
+      for (Radio radio : signalRadios) {
+        radio.setCurrentSignalStrength(SS_NOTHING);
+      }
     }
+    signalRadios.clear();
 
     /* Set signal strength to below strong on destinations */
     RadioConnection[] conns = getActiveConnections();
+    for (RadioConnection conn : conns) {
+      signalRadios.add(conn.getSource());
+      for (Radio radio : conn.getDestinations()) {
+        signalRadios.add(radio);
+      }
+      for (Radio radio : conn.getInterfered()) {
+        signalRadios.add(radio);
+      }
+    }
     for (RadioConnection conn : conns) {
       if (conn.getSource().getCurrentSignalStrength() < SS_STRONG) {
         conn.getSource().setCurrentSignalStrength(SS_STRONG);
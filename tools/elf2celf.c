@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/*
+ * Convert a relocatable ELF32 object (a .ce module) into a compact
+ * module (CELF) for core/loader/elfloader.c.
+ *
+ * The sections of the object are merged into four segments: text,
+ * rodata, data and bss. Symbols defined in the module are resolved
+ * here, so the module carries no symbol table, string table or
+ * section headers. Only the names of imported symbols remain.
+ *
+ * Format, with all header fields 16-bit little endian:
+ *
+ *   "\177CEL"
+ *   text size, rodata size, data size, bss size
+ *   size of the imported names
+ *   size of the text, rodata and data relocation streams
+ *   segment and offset of autostart_processes (0xffff if none)
+ *   imported names, each null terminated
+ *   text, rodata and data segment contents
+ *   text, rodata and data relocation streams
+ *
+ * A relocation stream is a sequence of relocations sorted by offset.
+ * Each relocation is encoded as:
+ *
+ *   varint  offset from the previous relocation in the stream
+ *   byte    ELF relocation type
+ *   varint  target: 0 text, 1 rodata, 2 data, 3 bss, or 4 plus the
+ *           offset of the name of an imported symbol
+ *   varint  addend, zigzag encoded, relative to the target
+ *
+ * Varints are little endian groups of seven bits, with the top bit
+ * set on all but the last byte.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define CELF_MAGIC "\177CEL"
+#define CELF_NO_AUTOSTART 0xffff
+
+enum { TEXT, RODATA, DATA, BSS, SEGMENTS };
+
+#define ET_REL        1
+#define SHT_PROGBITS  1
+#define SHT_SYMTAB    2
+#define SHT_RELA      4
+#define SHT_NOBITS    8
+#define SHT_REL       9
+#define SHF_WRITE     0x1
+#define SHF_ALLOC     0x2
+#define SHF_EXECINSTR 0x4
+#define SHN_UNDEF     0
+#define SHN_LORESERVE 0xff00
+
+#define SHDR_NAME      0
+#define SHDR_TYPE      4
+#define SHDR_FLAGS     8
+#define SHDR_OFFSET    16
+#define SHDR_SIZE      20
+#define SHDR_LINK      24
+#define SHDR_INFO      28
+#define SHDR_ADDRALIGN 32
+
+#define SYM_SIZE 16
+
+struct reloc {
+  uint32_t offset;
+  unsigned char type;
+  uint32_t target;
+  int32_t addend;
+};
+
+struct segment {
+  unsigned char *data;
+  uint32_t size;
+  struct reloc *relocs;
+  int nrelocs;
+};
+
+static unsigned char *elf;
+static long elfsize;
+static unsigned shnum, shentsize;
+static uint32_t shoff;
+
+static struct segment segments[SEGMENTS];
+static int *section_segment;
+static uint32_t *section_base;
+
+static char names[65536];
+static uint32_t namesize;
+
+static unsigned char *out;
+static long outlen, outmax;
+
+/*---------------------------------------------------------------------*/
+static void
+fail(const char *msg, const char *arg)
+{
+  fprintf(stderr, "elf2celf: %s%s\n", msg, arg);
+  exit(1);
+}
+/*---------------------------------------------------------------------*/
+static uint32_t
+get(uint32_t offset, int len)
+{
+  uint32_t v;
+  int i;
+
+  if(offset + len > elfsize) {
+    fail("truncated ELF file", "");
+  }
+  for(v = 0, i = len - 1; i >= 0; i--) {
+    v = (v << 8) | elf[offset + i];
+  }
+  return v;
+}
+/*---------------------------------------------------------------------*/
+static uint32_t
+shdr(unsigned section, int field)
+{
+  return get(shoff + section * shentsize + field, 4);
+}
+/*---------------------------------------------------------------------*/
+static const char *
+string(unsigned strtab, uint32_t offset)
+{
+  uint32_t start;
+
+  start = shdr(strtab, SHDR_OFFSET) + offset;
+  if(start >= elfsize || memchr(&elf[start], 0, elfsize - start) == NULL) {
+    fail("bad string table", "");
+  }
+  return (const char *)&elf[start];
+}
+/*---------------------------------------------------------------------*/
+static int
+segment_of(unsigned section)
+{
+  uint32_t type, flags;
+
+  type = shdr(section, SHDR_TYPE);
+  flags = shdr(section, SHDR_FLAGS);
+  if((flags & SHF_ALLOC) == 0) {
+    return -1;
+  }
+  if(type == SHT_NOBITS) {
+    return BSS;
+  }
+  if(type != SHT_PROGBITS) {
+    return -1;
+  }
+  if(flags & SHF_EXECINSTR) {
+    return TEXT;
+  }
+  return (flags & SHF_WRITE) ? DATA : RODATA;
+}
+/*---------------------------------------------------------------------*/
+static uint32_t
+import(const char *name)
+{
+  uint32_t i;
+  size_t len;
+
+  for(i = 0; i < namesize; i += strlen(&names[i]) + 1) {
+    if(strcmp(&names[i], name) == 0) {
+      return i;
+    }
+  }
+  len = strlen(name) + 1;
+  if(namesize + len > sizeof(names)) {
+    fail("too many imported symbols", "");
+  }
+  memcpy(&names[namesize], name, len);
+  namesize += len;
+  return i;
+}
+/*---------------------------------------------------------------------*/
+static void
+add_relocs(unsigned relsec, unsigned symtab)
+{
+  unsigned target, strtab;
+  uint32_t off, end, entsize, info, symoff, value;
+  unsigned symindex, shndx;
+  struct segment *seg;
+  struct reloc *r;
+  int segment, rela;
+
+  target = shdr(relsec, SHDR_INFO);
+  if(target >= shnum || section_segment[target] < 0) {
+    return;
+  }
+  segment = section_segment[target];
+  if(segment == BSS) {
+    fail("relocations in bss", "");
+  }
+  seg = &segments[segment];
+  strtab = shdr(symtab, SHDR_LINK);
+
+  rela = shdr(relsec, SHDR_TYPE) == SHT_RELA;
+  entsize = rela ? 12 : 8;
+  off = shdr(relsec, SHDR_OFFSET);
+  end = off + shdr(relsec, SHDR_SIZE);
+
+  for(; off + entsize <= end; off += entsize) {
+    seg->relocs = realloc(seg->relocs, (seg->nrelocs + 1) * sizeof(*r));
+    if(seg->relocs == NULL) {
+      fail("out of memory", "");
+    }
+    r = &seg->relocs[seg->nrelocs++];
+
+    info = get(off + 4, 4);
+    r->offset = section_base[target] + get(off, 4);
+    r->type = info & 0xff;
+    if(rela) {
+      r->addend = (int32_t)get(off + 8, 4);
+    } else {
+      /* Like the ELF loader, take the addend from the section. */
+      r->addend = (int32_t)get(shdr(target, SHDR_OFFSET) + get(off, 4), 4);
+    }
+
+    symindex = info >> 8;
+    symoff = shdr(symtab, SHDR_OFFSET) + symindex * SYM_SIZE;
+    shndx = get(symoff + 14, 2);
+    value = get(symoff + 4, 4);
+    if(shndx == SHN_UNDEF) {
+      if(get(symoff, 4) == 0) {
+	fail("relocation against an undefined unnamed symbol", "");
+      }
+      r->target = SEGMENTS + import(string(strtab, get(symoff, 4)));
+    } else if(shndx < shnum && shndx < SHN_LORESERVE &&
+	      section_segment[shndx] >= 0) {
+      r->target = section_segment[shndx];
+      r->addend += section_base[shndx] + value;
+    } else {
+      fail("relocation against an unsupported symbol ",
+	   get(symoff, 4) ? string(strtab, get(symoff, 4)) : "");
+    }
+  }
+}
+/*---------------------------------------------------------------------*/
+static int
+compare_relocs(const void *a, const void *b)
+{
+  const struct reloc *ra = a, *rb = b;
+
+  return ra->offset < rb->offset ? -1 : ra->offset > rb->offset;
+}
+/*---------------------------------------------------------------------*/
+static void
+put8(unsigned b)
+{
+  if(outlen == outmax) {
+    outmax = outmax ? 2 * outmax : 4096;
+    out = realloc(out, outmax);
+    if(out == NULL) {
+      fail("out of memory", "");
+    }
+  }
+  out[outlen++] = b;
+}
+/*---------------------------------------------------------------------*/
+static void
+put16(long v, const char *what)
+{
+  if(v < 0 || v > 0xffff) {
+    fail("too large for a compact module: ", what);
+  }
+  put8(v & 0xff);
+  put8(v >> 8);
+}
+/*---------------------------------------------------------------------*/
+static void
+putvarint(uint32_t v)
+{
+  while(v >= 0x80) {
+    put8((v & 0x7f) | 0x80);
+    v >>= 7;
+  }
+  put8(v);
+}
+/*---------------------------------------------------------------------*/
+static long
+put_relocs(struct segment *seg)
+{
+  long start;
+  uint32_t prev;
+  int i;
+
+  start = outlen;
+  qsort(seg->relocs, seg->nrelocs, sizeof(struct reloc), compare_relocs);
+  for(prev = 0, i = 0; i < seg->nrelocs; i++) {
+    putvarint(seg->relocs[i].offset - prev);
+    put8(seg->relocs[i].type);
+    putvarint(seg->relocs[i].target);
+    putvarint(((uint32_t)seg->relocs[i].addend << 1) ^
+	      (uint32_t)(seg->relocs[i].addend >> 31));
+    prev = seg->relocs[i].offset;
+  }
+  return outlen - start;
+}
+/*---------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  FILE *f;
+  unsigned i, symtab, strtab;
+  uint32_t align, size, symoff, end;
+  long relsize[SEGMENTS], relsizepos;
+  int autostart_segment, s;
+  uint32_t autostart_offset;
+
+  if(argc != 3) {
+    fprintf(stderr, "usage: %s module.ce module.celf\n", argv[0]);
+    exit(1);
+  }
+
+  f = fopen(argv[1], "rb");
+  if(f == NULL) {
+    perror(argv[1]);
+    exit(1);
+  }
+  fseek(f, 0, SEEK_END);
+  elfsize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  elf = malloc(elfsize);
+  if(elf == NULL || fread(elf, 1, elfsize, f) != elfsize) {
+    perror(argv[1]);
+    exit(1);
+  }
+  fclose(f);
+
+  /* Only 32-bit, little endian, relocatable objects. */
+  if(elfsize < 52 || memcmp(elf, "\177ELF\001\001\001", 7) != 0 ||
+     get(16, 2) != ET_REL) {
+    fail("not a 32-bit little endian relocatable ELF object: ", argv[1]);
+  }
+  shoff = get(32, 4);
+  shentsize = get(46, 2);
+  shnum = get(48, 2);
+
+  /* Lay out the sections in the segments. */
+  section_segment = calloc(shnum, sizeof(int));
+  section_base = calloc(shnum, sizeof(uint32_t));
+  if(section_segment == NULL || section_base == NULL) {
+    fail("out of memory", "");
+  }
+  symtab = 0;
+  for(i = 0; i < shnum; i++) {
+    section_segment[i] = s = segment_of(i);
+    if(shdr(i, SHDR_TYPE) == SHT_SYMTAB) {
+      symtab = i;
+    }
+    if(s < 0) {
+      continue;
+    }
+    align = shdr(i, SHDR_ADDRALIGN);
+    size = shdr(i, SHDR_SIZE);
+    if(align > 1) {
+      segments[s].size = (segments[s].size + align - 1) & ~(align - 1);
+    }
+    section_base[i] = segments[s].size;
+    if(s != BSS) {
+      segments[s].data = realloc(segments[s].data, segments[s].size + size);
+      if(segments[s].data == NULL) {
+	fail("out of memory", "");
+      }
+      memset(&segments[s].data[section_base[i]], 0,
+	     segments[s].size - section_base[i]);
+      if(shdr(i, SHDR_OFFSET) + size > elfsize) {
+	fail("truncated ELF file", "");
+      }
+      memcpy(&segments[s].data[section_base[i]],
+	     &elf[shdr(i, SHDR_OFFSET)], size);
+    }
+    segments[s].size += size;
+  }
+  if(symtab == 0) {
+    fail("no symbol table in ", argv[1]);
+  }
+  strtab = shdr(symtab, SHDR_LINK);
+
+  for(i = 0; i < shnum; i++) {
+    if(shdr(i, SHDR_TYPE) == SHT_REL || shdr(i, SHDR_TYPE) == SHT_RELA) {
+      add_relocs(i, symtab);
+    }
+  }
+
+  /* Find autostart_processes. */
+  autostart_segment = -1;
+  autostart_offset = 0;
+  end = shdr(symtab, SHDR_OFFSET) + shdr(symtab, SHDR_SIZE);
+  for(symoff = shdr(symtab, SHDR_OFFSET); symoff + SYM_SIZE <= end;
+      symoff += SYM_SIZE) {
+    i = get(symoff + 14, 2);
+    if(get(symoff, 4) != 0 && i < shnum && i < SHN_LORESERVE &&
+       section_segment[i] >= 0 &&
+       strcmp(string(strtab, get(symoff, 4)), "autostart_processes") == 0) {
+      autostart_segment = section_segment[i];
+      autostart_offset = section_base[i] + get(symoff + 4, 4);
+      break;
+    }
+  }
+
+  /* Write the module. The relocation stream sizes are filled in
+     afterwards. */
+  for(i = 0; i < 4; i++) {
+    put8(CELF_MAGIC[i]);
+  }
+  put16(segments[TEXT].size, "text");
+  put16(segments[RODATA].size, "rodata");
+  put16(segments[DATA].size, "data");
+  put16(segments[BSS].size, "bss");
+  put16(namesize, "imported names");
+  relsizepos = outlen;
+  put16(0, "");
+  put16(0, "");
+  put16(0, "");
+  if(autostart_segment < 0) {
+    put16(CELF_NO_AUTOSTART, "");
+    put16(0, "");
+  } else {
+    put16(autostart_segment, "");
+    put16(autostart_offset, "autostart_processes offset");
+  }
+
+  for(i = 0; i < namesize; i++) {
+    put8(names[i]);
+  }
+  for(s = TEXT; s < BSS; s++) {
+    for(i = 0; i < segments[s].size; i++) {
+      put8(segments[s].data[i]);
+    }
+  }
+  for(s = TEXT; s < BSS; s++) {
+    relsize[s] = put_relocs(&segments[s]);
+  }
+
+  end = outlen;
+  outlen = relsizepos;
+  for(s = TEXT; s < BSS; s++) {
+    put16(relsize[s], "relocations");
+  }
+  outlen = end;
+
+  f = fopen(argv[2], "wb");
+  if(f == NULL || fwrite(out, 1, outlen, f) != outlen) {
+    perror(argv[2]);
+    exit(1);
+  }
+  fclose(f);
+
+  printf("%s: %ld bytes (%s: %ld bytes)\n", argv[2], outlen, argv[1], elfsize);
+  return 0;
+}
+/*---------------------------------------------------------------------*/
@@ -1,4 +1,6 @@
 #include "symbols.h"
 
 const int symbols_nelts = 0;
+const int symbols_hash_size = 1;
+const unsigned short symbols_hash[] = {0};
 const struct symbols symbols[] = {{0,0}};
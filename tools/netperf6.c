@@ -0,0 +1,623 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/*
+ * Host-side counterpart of the netperf6 shell command in
+ * apps/shell/shell-netperf6.c.
+ *
+ * Without a host argument it serves as a measurement peer for
+ * Contiki nodes: it answers UDP echo requests, counts UDP stream
+ * packets and TCP bulk data, and reports its counters in the same
+ * format as a node does (with zero energest times).
+ *
+ * With a host argument it measures towards a Contiki node running
+ * shell_netperf6_init() and prints the same statistics, including
+ * the node's energy per bit computed from its energest times.
+ *
+ * The message formats and port numbers must match shell-netperf6.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+#include <err.h>
+
+#define UDP_PORT 6011
+#define TCP_PORT 6012
+
+enum {
+  ECHO_REQUEST = 1,
+  ECHO_REPLY   = 2,
+  STREAM       = 3,
+  CLEAR        = 4,
+  CLEAR_ACK    = 5,
+  STATS        = 6,
+  STATS_REPLY  = 7,
+};
+
+#define HDR_LEN         4
+#define STATS_REPLY_LEN (HDR_LEN + 7 * 4)
+
+#define MAX_SIZE        1280
+#define TIMEOUT_MS      4000
+#define MAX_RETRIES     8
+#define STREAM_INTERVAL_MS 125
+
+/* Tmote Sky currents (uA) and supply voltage (mV), as on the nodes. */
+#define CURRENT_CPU 1800ULL
+#define CURRENT_LPM 55ULL
+#define CURRENT_RX  20000ULL
+#define CURRENT_TX  17700ULL
+#define VOLTAGE     3000ULL
+
+#define HISTOGRAM_BUCKETS 13
+
+int verbose = 0;
+
+static int udpfd;
+static struct sockaddr_storage peer;
+static socklen_t peerlen;
+static uint16_t seqno;
+
+static unsigned long served_packets, served_bytes;
+
+static unsigned sent, received, timedout;
+static unsigned long rtt_min, rtt_max, rtt_total;
+static unsigned histogram[HISTOGRAM_BUCKETS];
+
+struct remote_stats {
+  unsigned long packets, bytes, second;
+  unsigned long cpu, lpm, rx, tx;
+};
+
+/*---------------------------------------------------------------------------*/
+static unsigned long
+now_ms(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000UL + tv.tv_usec / 1000;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint8_t *p, unsigned long v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+get32(const uint8_t *p)
+{
+  return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) |
+    ((unsigned long)p[2] << 8) | p[3];
+}
+/*---------------------------------------------------------------------------*/
+static void
+serve_udp(void)
+{
+  uint8_t buf[MAX_SIZE];
+  struct sockaddr_storage from;
+  socklen_t fromlen = sizeof(from);
+  ssize_t len;
+
+  len = recvfrom(udpfd, buf, sizeof(buf), 0,
+                 (struct sockaddr *)&from, &fromlen);
+  if(len < HDR_LEN) {
+    return;
+  }
+  switch(buf[0]) {
+  case ECHO_REQUEST:
+    served_packets++;
+    served_bytes += len;
+    buf[0] = ECHO_REPLY;
+    break;
+  case STREAM:
+    served_packets++;
+    served_bytes += len;
+    return;
+  case CLEAR:
+    served_packets = served_bytes = 0;
+    buf[0] = CLEAR_ACK;
+    len = HDR_LEN;
+    if(verbose) {
+      fprintf(stderr, "netperf6: cleared statistics\n");
+    }
+    break;
+  case STATS:
+    buf[0] = STATS_REPLY;
+    memset(&buf[HDR_LEN], 0, STATS_REPLY_LEN - HDR_LEN);
+    put32(&buf[HDR_LEN], served_packets);
+    put32(&buf[HDR_LEN + 4], served_bytes);
+    len = STATS_REPLY_LEN;
+    if(verbose) {
+      fprintf(stderr, "netperf6: %lu packets, %lu bytes received\n",
+              served_packets, served_bytes);
+    }
+    break;
+  default:
+    return;
+  }
+  sendto(udpfd, buf, len, 0, (struct sockaddr *)&from, fromlen);
+}
+/*---------------------------------------------------------------------------*/
+static void
+server(void)
+{
+  struct sockaddr_in6 sin6;
+  int tcpfd, connfd, maxfd, on = 1;
+  uint8_t buf[MAX_SIZE];
+  fd_set fds;
+  ssize_t len;
+
+  memset(&sin6, 0, sizeof(sin6));
+  sin6.sin6_family = AF_INET6;
+  sin6.sin6_addr = in6addr_any;
+
+  udpfd = socket(AF_INET6, SOCK_DGRAM, 0);
+  if(udpfd < 0) {
+    err(1, "socket");
+  }
+  sin6.sin6_port = htons(UDP_PORT);
+  if(bind(udpfd, (struct sockaddr *)&sin6, sizeof(sin6)) < 0) {
+    err(1, "bind UDP port %d", UDP_PORT);
+  }
+
+  tcpfd = socket(AF_INET6, SOCK_STREAM, 0);
+  if(tcpfd < 0) {
+    err(1, "socket");
+  }
+  setsockopt(tcpfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sin6.sin6_port = htons(TCP_PORT);
+  if(bind(tcpfd, (struct sockaddr *)&sin6, sizeof(sin6)) < 0 ||
+     listen(tcpfd, 1) < 0) {
+    err(1, "bind TCP port %d", TCP_PORT);
+  }
+
+  fprintf(stderr, "netperf6: serving UDP port %d and TCP port %d\n",
+          UDP_PORT, TCP_PORT);
+
+  connfd = -1;
+  while(1) {
+    FD_ZERO(&fds);
+    FD_SET(udpfd, &fds);
+    FD_SET(tcpfd, &fds);
+    maxfd = udpfd > tcpfd ? udpfd : tcpfd;
+    if(connfd >= 0) {
+      FD_SET(connfd, &fds);
+      maxfd = connfd > maxfd ? connfd : maxfd;
+    }
+    if(select(maxfd + 1, &fds, NULL, NULL, NULL) < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      err(1, "select");
+    }
+    if(FD_ISSET(udpfd, &fds)) {
+      serve_udp();
+    }
+    if(FD_ISSET(tcpfd, &fds)) {
+      if(connfd >= 0) {
+        close(connfd);
+      }
+      connfd = accept(tcpfd, NULL, NULL);
+    }
+    if(connfd >= 0 && FD_ISSET(connfd, &fds)) {
+      len = read(connfd, buf, sizeof(buf));
+      if(len <= 0) {
+        close(connfd);
+        connfd = -1;
+      } else {
+        served_packets++;
+        served_bytes += len;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(uint8_t type, int len)
+{
+  uint8_t buf[MAX_SIZE];
+
+  memset(buf, 'n', len);
+  buf[0] = type;
+  buf[1] = 0;
+  buf[2] = seqno >> 8;
+  buf[3] = seqno & 0xff;
+  if(sendto(udpfd, buf, len, 0, (struct sockaddr *)&peer, peerlen) < 0) {
+    warn("sendto");
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Waits for a reply of the given type to the current sequence number.
+   Returns its length, or -1 on timeout. */
+static int
+wait_reply(uint8_t type, uint8_t *buf, int timeout_ms)
+{
+  unsigned long deadline = now_ms() + timeout_ms;
+  struct timeval tv;
+  fd_set fds;
+  long left;
+  ssize_t len;
+
+  while((left = (long)(deadline - now_ms())) > 0) {
+    FD_ZERO(&fds);
+    FD_SET(udpfd, &fds);
+    tv.tv_sec = left / 1000;
+    tv.tv_usec = (left % 1000) * 1000;
+    if(select(udpfd + 1, &fds, NULL, NULL, &tv) <= 0) {
+      continue;
+    }
+    len = recv(udpfd, buf, MAX_SIZE, 0);
+    if(len >= HDR_LEN && buf[0] == type &&
+       ((buf[2] << 8) | buf[3]) == seqno) {
+      return len;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+control(uint8_t type, uint8_t reply, uint8_t *buf)
+{
+  int i, len;
+
+  seqno++;
+  for(i = 0; i < MAX_RETRIES; i++) {
+    send_packet(type, HDR_LEN);
+    len = wait_reply(reply, buf, TIMEOUT_MS);
+    if(len >= 0) {
+      return len;
+    }
+  }
+  errx(1, "control connection failed");
+}
+/*---------------------------------------------------------------------------*/
+static void
+record_rtt(unsigned long rtt)
+{
+  int bucket;
+
+  for(bucket = 0; bucket < HISTOGRAM_BUCKETS - 1 && rtt >= (1UL << bucket);
+      bucket++);
+  histogram[bucket]++;
+  rtt_total += rtt;
+  if(rtt < rtt_min) {
+    rtt_min = rtt;
+  }
+  if(rtt > rtt_max) {
+    rtt_max = rtt;
+  }
+  received++;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+percentile(int p)
+{
+  unsigned long target, count;
+  int i;
+
+  target = ((unsigned long)received * p + 99) / 100;
+  count = 0;
+  for(i = 0; i < HISTOGRAM_BUCKETS - 1; i++) {
+    count += histogram[i];
+    if(count >= target) {
+      return 1UL << i;
+    }
+  }
+  return rtt_max;
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_stats(const char *name, unsigned long time, unsigned long bytes,
+            const struct remote_stats *r)
+{
+  unsigned long long charge, uj;
+  unsigned long total;
+  int i;
+
+  if(time == 0) {
+    time = 1;
+  }
+  printf("-------- %s --------\n", name);
+  printf("Local statistics:\n");
+  printf("  Total transfer time:       %lu.%03lu seconds, %lu bytes/second\n",
+         time / 1000, time % 1000, bytes * 1000 / time);
+  if(sent > 0) {
+    printf("  Packets:                   sent %u, answered %u, timed out %u\n",
+           sent, received, timedout);
+  }
+  if(received > 0) {
+    printf("  Round-trip time:           min %lu avg %lu max %lu ms\n",
+           rtt_min, rtt_total / received, rtt_max);
+    printf("  Round-trip percentiles:    50%% <= %lu 90%% <= %lu 99%% <= %lu ms\n",
+           percentile(50), percentile(90), percentile(99));
+    for(i = 0; i < HISTOGRAM_BUCKETS; i++) {
+      if(histogram[i] > 0) {
+        if(i == HISTOGRAM_BUCKETS - 1) {
+          printf("    >= %5lu ms: %u\n", 1UL << (i - 1), histogram[i]);
+        } else {
+          printf("    <  %5lu ms: %u\n", 1UL << i, histogram[i]);
+        }
+      }
+    }
+  }
+
+  printf("Remote node statistics:\n");
+  printf("  Received:                  %lu packets, %lu bytes\n",
+         r->packets, r->bytes);
+  total = r->cpu + r->lpm;
+  if(r->second > 0 && total > 0) {
+    printf("  Remote radio duty cycle:   rx %.2f%% tx %.2f%%\n",
+           100.0 * r->rx / total, 100.0 * r->tx / total);
+    charge = r->cpu * CURRENT_CPU + r->lpm * CURRENT_LPM +
+      r->rx * CURRENT_RX + r->tx * CURRENT_TX;
+    uj = charge * VOLTAGE / 1000 / r->second;
+    printf("  Remote energy:             %llu uJ", uj);
+    if(r->bytes > 0) {
+      printf(", %llu nJ/bit", 1000 * uj / (8 * r->bytes));
+    }
+    printf("\n");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+get_remote_stats(struct remote_stats *r)
+{
+  uint8_t buf[MAX_SIZE];
+  const uint8_t *p;
+
+  if(control(STATS, STATS_REPLY, buf) < STATS_REPLY_LEN) {
+    errx(1, "short statistics reply");
+  }
+  p = &buf[HDR_LEN];
+  r->packets = get32(p);
+  r->bytes = get32(p + 4);
+  r->second = get32(p + 8);
+  r->cpu = get32(p + 12);
+  r->lpm = get32(p + 16);
+  r->rx = get32(p + 20);
+  r->tx = get32(p + 24);
+}
+/*---------------------------------------------------------------------------*/
+static void
+clear_stats(void)
+{
+  uint8_t buf[MAX_SIZE];
+
+  control(CLEAR, CLEAR_ACK, buf);
+  sent = received = timedout = 0;
+  rtt_min = ~0UL;
+  rtt_max = rtt_total = 0;
+  memset(histogram, 0, sizeof(histogram));
+}
+/*---------------------------------------------------------------------------*/
+static void
+pingpong(int num, int size)
+{
+  uint8_t buf[MAX_SIZE];
+  struct remote_stats r;
+  unsigned long start, t;
+  unsigned long bytes = 0;
+  int i, len;
+
+  clear_stats();
+  start = now_ms();
+  for(i = 0; i < num; i++) {
+    seqno++;
+    t = now_ms();
+    send_packet(ECHO_REQUEST, size);
+    sent++;
+    len = wait_reply(ECHO_REPLY, buf, TIMEOUT_MS);
+    if(len < 0) {
+      timedout++;
+    } else {
+      record_rtt(now_ms() - t);
+      bytes += len;
+    }
+  }
+  t = now_ms() - start;
+  get_remote_stats(&r);
+  print_stats("UDP ping-pong", t, bytes, &r);
+}
+/*---------------------------------------------------------------------------*/
+static void
+stream(int num, int size)
+{
+  struct remote_stats r;
+  unsigned long start, t;
+  int i;
+
+  clear_stats();
+  start = now_ms();
+  for(i = 0; i < num; i++) {
+    seqno++;
+    send_packet(STREAM, size);
+    sent++;
+    usleep(STREAM_INTERVAL_MS * 1000);
+  }
+  t = now_ms() - start;
+  get_remote_stats(&r);
+  print_stats("UDP stream", t, r.bytes, &r);
+  printf("  Packets received:          %.1f%%, %lu of %u\n",
+         100.0 * r.packets / sent, r.packets, sent);
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_bulk(const char *host, int num, int size)
+{
+  struct addrinfo hints, *res;
+  struct remote_stats r;
+  uint8_t buf[MAX_SIZE];
+  unsigned long start, t, left;
+  char port[8];
+  ssize_t len;
+  int fd;
+
+  clear_stats();
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET6;
+  hints.ai_socktype = SOCK_STREAM;
+  snprintf(port, sizeof(port), "%d", TCP_PORT);
+  if(getaddrinfo(host, port, &hints, &res) != 0) {
+    errx(1, "cannot resolve %s", host);
+  }
+  fd = socket(AF_INET6, SOCK_STREAM, 0);
+  if(fd < 0) {
+    err(1, "socket");
+  }
+  start = now_ms();
+  if(connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+    err(1, "connect");
+  }
+  freeaddrinfo(res);
+  memset(buf, 'n', sizeof(buf));
+  for(left = (unsigned long)num * size; left > 0; left -= len) {
+    len = write(fd, buf, left < sizeof(buf) ? left : sizeof(buf));
+    if(len <= 0) {
+      err(1, "write");
+    }
+  }
+  shutdown(fd, SHUT_WR);
+  /* Wait for the node to close its end, i.e., to receive everything. */
+  while(read(fd, buf, sizeof(buf)) > 0);
+  close(fd);
+  t = now_ms() - start;
+  get_remote_stats(&r);
+  print_stats("TCP bulk", t, r.bytes, &r);
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr, "usage: netperf6 [-v]\n");
+  fprintf(stderr, "       netperf6 [-p] [-s] [-t] [-n num] [-l size] host\n");
+  fprintf(stderr, "  Without host, answer netperf6 measurements from Contiki nodes.\n");
+  fprintf(stderr, "  -p  measure UDP ping-pong performance\n");
+  fprintf(stderr, "  -s  measure UDP stream performance\n");
+  fprintf(stderr, "  -t  measure TCP bulk transfer of num * size bytes\n");
+  fprintf(stderr, "  -n  number of packets (default 20)\n");
+  fprintf(stderr, "  -l  packet size (default 32)\n");
+  fprintf(stderr, "  -v  verbose\n");
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  struct addrinfo hints, *res;
+  int c, num = 20, size = 32;
+  int do_pingpong = 0, do_stream = 0, do_tcp = 0;
+  char port[8];
+
+  while((c = getopt(argc, argv, "pstn:l:vh")) != -1) {
+    switch(c) {
+    case 'p':
+      do_pingpong = 1;
+      break;
+    case 's':
+      do_stream = 1;
+      break;
+    case 't':
+      do_tcp = 1;
+      break;
+    case 'n':
+      num = atoi(optarg);
+      break;
+    case 'l':
+      size = atoi(optarg);
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    default:
+      usage();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+
+  if(argc == 0) {
+    server();
+    return 0;
+  }
+  if(argc != 1 || num <= 0 || size < HDR_LEN || size > MAX_SIZE) {
+    usage();
+  }
+  if(!do_pingpong && !do_stream && !do_tcp) {
+    do_pingpong = 1;
+  }
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET6;
+  hints.ai_socktype = SOCK_DGRAM;
+  snprintf(port, sizeof(port), "%d", UDP_PORT);
+  if(getaddrinfo(argv[0], port, &hints, &res) != 0) {
+    errx(1, "cannot resolve %s", argv[0]);
+  }
+  memcpy(&peer, res->ai_addr, res->ai_addrlen);
+  peerlen = res->ai_addrlen;
+  freeaddrinfo(res);
+
+  udpfd = socket(AF_INET6, SOCK_DGRAM, 0);
+  if(udpfd < 0) {
+    err(1, "socket");
+  }
+
+  if(do_pingpong) {
+    pingpong(num, size);
+  }
+  if(do_stream) {
+    stream(num, size);
+  }
+  if(do_tcp) {
+    tcp_bulk(argv[0], num, size);
+  }
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/*
+ * Reads the SLIP framed pcap-ng blocks that framer-capture streams
+ * from a node and writes a pcap-ng capture to stdout, e.g.
+ *
+ *   pcapslip -s ttyUSB0 | wireshark -k -i -
+ *
+ * The node timestamps its frames with the raw rtimer, which wraps
+ * often. The rtimer is unwrapped using the arrival time of each block
+ * and converted into microseconds of wall clock time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/time.h>
+
+#include <err.h>
+
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+
+#define PCAPNG_SHB 0x0a0d0d0a
+#define PCAPNG_IDB 1
+#define PCAPNG_EPB 6
+
+/* IEEE 802.15.4 without FCS. */
+#define LINKTYPE_IEEE802_15_4_NOFCS 230
+
+#define MAX_BLOCK 1024
+
+static uint32_t ticks_per_second = 32768;
+static int rtimer_bits = 16;
+
+static int have_base;
+static uint64_t last_ticks;
+static uint64_t last_us, base_us, base_ticks;
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_us(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_headers(void)
+{
+  uint8_t shb[28], idb[32];
+
+  /* Little-endian section header, version 1.0, unknown length. */
+  put32(shb, PCAPNG_SHB);
+  put32(shb + 4, sizeof(shb));
+  put32(shb + 8, 0x1a2b3c4d);
+  put32(shb + 12, 1);
+  put32(shb + 16, 0xffffffff);
+  put32(shb + 20, 0xffffffff);
+  put32(shb + 24, sizeof(shb));
+
+  /* Interface with microsecond timestamps (the default if_tsresol). */
+  put32(idb, PCAPNG_IDB);
+  put32(idb + 4, sizeof(idb));
+  put32(idb + 8, LINKTYPE_IEEE802_15_4_NOFCS);
+  put32(idb + 12, 0);
+  /* if_tsresol = 6, followed by the end of options. */
+  put32(idb + 16, 9 | (1 << 16));
+  put32(idb + 20, 6);
+  put32(idb + 24, 0);
+  put32(idb + 28, sizeof(idb));
+
+  fwrite(shb, sizeof(shb), 1, stdout);
+  fwrite(idb, sizeof(idb), 1, stdout);
+  fflush(stdout);
+}
+/*---------------------------------------------------------------------------*/
+/* Turn a raw rtimer value into microseconds since the epoch. The
+   arrival time tells how many times the rtimer has wrapped since the
+   previous block, as long as the serial line delays blocks by less
+   than half a wrap. */
+static uint64_t
+timestamp(uint32_t raw)
+{
+  uint64_t arrival, expected, mask, ticks;
+  int64_t diff;
+
+  arrival = now_us();
+  mask = rtimer_bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << rtimer_bits) - 1;
+
+  if(!have_base) {
+    have_base = 1;
+    ticks = raw;
+    base_ticks = ticks;
+    base_us = arrival;
+  } else {
+    expected = last_ticks +
+      (arrival - last_us) * ticks_per_second / 1000000;
+    diff = (int64_t)((raw - expected) & mask);
+    if(diff > (int64_t)(mask >> 1)) {
+      diff -= mask + 1;
+    }
+    ticks = expected + diff;
+  }
+  last_ticks = ticks;
+  last_us = arrival;
+
+  return base_us + (ticks - base_ticks) * 1000000 / ticks_per_second;
+}
+/*---------------------------------------------------------------------------*/
+static void
+block_input(uint8_t *block, int len)
+{
+  uint64_t ts;
+
+  /* Anything else on the serial line, such as printf() output, is
+     dropped here. */
+  if(len < 32 || len > MAX_BLOCK || (len & 3) != 0 ||
+     get32(block) != PCAPNG_EPB ||
+     get32(block + 4) != (uint32_t)len ||
+     get32(block + len - 4) != (uint32_t)len) {
+    return;
+  }
+
+  ts = timestamp(get32(block + 16));
+  put32(block + 12, ts >> 32);
+  put32(block + 16, ts);
+
+  fwrite(block, len, 1, stdout);
+  fflush(stdout);
+}
+/*---------------------------------------------------------------------------*/
+static void
+stty_raw(int fd, speed_t speed)
+{
+  struct termios tty;
+
+  if(tcgetattr(fd, &tty) == -1) {
+    err(1, "tcgetattr");
+  }
+  cfmakeraw(&tty);
+  tty.c_cc[VTIME] = 0;
+  tty.c_cc[VMIN] = 1;
+  tty.c_cflag |= CLOCAL;
+  cfsetispeed(&tty, speed);
+  cfsetospeed(&tty, speed);
+  if(tcsetattr(fd, TCSAFLUSH, &tty) == -1) {
+    err(1, "tcsetattr");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static speed_t
+baudrate(int rate)
+{
+  switch(rate) {
+  case 9600:
+    return B9600;
+  case 19200:
+    return B19200;
+  case 38400:
+    return B38400;
+  case 57600:
+    return B57600;
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+#ifndef __APPLE__
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+#endif
+  default:
+    errx(1, "unknown baudrate %d", rate);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  static uint8_t block[MAX_BLOCK];
+  char dev[64];
+  uint8_t buf[256];
+  int c, fd, n, i, len, esc;
+  int rate = 115200;
+
+  fd = STDIN_FILENO;
+  while((c = getopt(argc, argv, "B:s:t:w:h")) != -1) {
+    switch(c) {
+    case 'B':
+      rate = atoi(optarg);
+      break;
+    case 's':
+      if(strncmp("/dev/", optarg, 5) == 0) {
+        snprintf(dev, sizeof(dev), "%s", optarg);
+      } else {
+        snprintf(dev, sizeof(dev), "/dev/%s", optarg);
+      }
+      fd = open(dev, O_RDONLY | O_NOCTTY);
+      if(fd == -1) {
+        err(1, "can't open '%s'", dev);
+      }
+      break;
+    case 't':
+      ticks_per_second = strtoul(optarg, NULL, 0);
+      break;
+    case 'w':
+      rtimer_bits = atoi(optarg);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-B baudrate] [-s siodev] [-t rtimer ticks per second] [-w rtimer bits]\n",
+              argv[0]);
+      fprintf(stderr, "  Writes pcap-ng to stdout, e.g. %s -s ttyUSB0 | wireshark -k -i -\n",
+              argv[0]);
+      exit(1);
+    }
+  }
+  if(ticks_per_second == 0 || rtimer_bits < 8 || rtimer_bits > 64) {
+    errx(1, "bad rtimer parameters");
+  }
+  if(isatty(fd)) {
+    stty_raw(fd, baudrate(rate));
+  }
+
+  write_headers();
+
+  len = 0;
+  esc = 0;
+  while((n = read(fd, buf, sizeof(buf))) > 0) {
+    for(i = 0; i < n; i++) {
+      c = buf[i];
+      if(c == SLIP_END) {
+        if(len > 0) {
+          block_input(block, len);
+        }
+        len = 0;
+        esc = 0;
+        continue;
+      }
+      if(esc) {
+        esc = 0;
+        if(c == SLIP_ESC_END) {
+          c = SLIP_END;
+        } else if(c == SLIP_ESC_ESC) {
+          c = SLIP_ESC;
+        }
+      } else if(c == SLIP_ESC) {
+        esc = 1;
+        continue;
+      }
+      if(len < MAX_BLOCK) {
+        block[len++] = c;
+      } else {
+        /* Too long to be one of ours; skip to the next SLIP_END. */
+        len = MAX_BLOCK + 1;
+      }
+    }
+  }
+  return 0;
+}
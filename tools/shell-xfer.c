@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/*
+ * Host side of the xfer-read and xfer-fetch shell commands in
+ * apps/shell/shell-xfer.c.
+ *
+ * Copies a file from a node running the serial shell to the host.
+ * With -n, the node attached to the serial port first fetches the
+ * file over the radio from another node with xfer-fetch, and the
+ * copy is then read from the attached node.
+ *
+ * The file is sent as binary frames with a CRC per chunk. Damaged
+ * or lost frames make the transfer restart from the first missing
+ * byte. If the local file already exists, the transfer continues
+ * from its end unless -f is given.
+ *
+ * Without -s, the shell is accessed through stdin and stdout, so the
+ * tool can be used with a native node or another serial tool.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+
+#define FRAME_HDRLEN  10
+#define TIMEOUT       2
+#define MAX_RETRIES   8
+#define FETCH_TIMEOUT 3600
+
+static int infd = 0, outfd = 1;
+static unsigned char inbuf[4096];
+static int inlen;
+static int verbose;
+/*---------------------------------------------------------------------------*/
+static unsigned short
+crc16_add(unsigned char b, unsigned short acc)
+{
+  acc ^= b;
+  acc  = (acc >> 8) | (acc << 8);
+  acc ^= (acc & 0xff00) << 4;
+  acc ^= (acc >> 8) >> 4;
+  acc ^= (acc & 0xff00) >> 5;
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+crc16_data(const unsigned char *data, int len)
+{
+  unsigned short acc = 0;
+  int i;
+
+  for(i = 0; i < len; ++i) {
+    acc = crc16_add(data[i], acc);
+  }
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr, "usage: shell-xfer [-s siodev] [-B baudrate] [-w window] "
+	  "[-n node addr] [-f] [-v] remote-file [local-file]\n");
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+static speed_t
+baudrate(int baud)
+{
+  switch(baud) {
+  case 9600: return B9600;
+  case 19200: return B19200;
+  case 38400: return B38400;
+  case 57600: return B57600;
+  case 115200: return B115200;
+  case 230400: return B230400;
+  default:
+    fprintf(stderr, "unknown baudrate %d\n", baud);
+    exit(1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+serial_open(const char *dev, speed_t speed)
+{
+  struct termios tty;
+
+  infd = outfd = open(dev, O_RDWR | O_NOCTTY);
+  if(infd < 0) {
+    perror(dev);
+    exit(1);
+  }
+  if(tcgetattr(infd, &tty) < 0) {
+    perror("tcgetattr");
+    exit(1);
+  }
+  cfmakeraw(&tty);
+  tty.c_cc[VTIME] = 0;
+  tty.c_cc[VMIN] = 0;
+  tty.c_cflag &= ~CRTSCTS;
+  tty.c_cflag |= CLOCAL;
+  cfsetispeed(&tty, speed);
+  cfsetospeed(&tty, speed);
+  if(tcsetattr(infd, TCSAFLUSH, &tty) < 0) {
+    perror("tcsetattr");
+    exit(1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_line(const char *fmt, ...)
+{
+  char line[128];
+  va_list ap;
+  int len;
+
+  va_start(ap, fmt);
+  len = vsnprintf(line, sizeof(line) - 1, fmt, ap);
+  va_end(ap);
+  line[len++] = '\n';
+  if(verbose) {
+    fprintf(stderr, "> %.*s", len, line);
+  }
+  if(write(outfd, line, len) != len) {
+    perror("write");
+    exit(1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Reads more data from the node. Returns 0 on timeout. */
+static int
+fill(int timeout)
+{
+  struct timeval tv;
+  fd_set fds;
+  int n;
+
+  if(inlen == sizeof(inbuf)) {
+    /* Nothing in the buffer can be used. */
+    inlen = 0;
+  }
+
+  FD_ZERO(&fds);
+  FD_SET(infd, &fds);
+  tv.tv_sec = timeout;
+  tv.tv_usec = 0;
+  if(select(infd + 1, &fds, NULL, NULL, &tv) <= 0) {
+    return 0;
+  }
+  n = read(infd, inbuf + inlen, sizeof(inbuf) - inlen);
+  if(n <= 0) {
+    fprintf(stderr, "shell-xfer: the node closed the connection\n");
+    exit(1);
+  }
+  inlen += n;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+consume(int len)
+{
+  memmove(inbuf, inbuf + len, inlen - len);
+  inlen -= len;
+}
+/*---------------------------------------------------------------------------*/
+/* Waits for a line that contains str. Returns a pointer to the rest
+   of the line, or NULL on timeout. */
+static char *
+wait_for_line(const char *str, int timeout)
+{
+  static char line[sizeof(inbuf) + 1];
+  time_t end = time(NULL) + timeout;
+  unsigned char *nl;
+  char *p;
+  int len;
+
+  while(time(NULL) < end) {
+    while((nl = memchr(inbuf, '\n', inlen)) != NULL) {
+      len = nl - inbuf;
+      memcpy(line, inbuf, len);
+      line[len] = 0;
+      consume(len + 1);
+      if(verbose) {
+	fprintf(stderr, "< %s\n", line);
+      }
+      if((p = strstr(line, str)) != NULL) {
+	return p + strlen(str);
+      }
+    }
+    fill(1);
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Finds the next frame in the input. Returns the length of the frame,
+   0 if more data is needed. */
+static int
+find_frame(void)
+{
+  int i;
+
+  for(i = 0; i + 3 <= inlen; ++i) {
+    if(memcmp(&inbuf[i], "#XF", 3) == 0) {
+      break;
+    }
+  }
+  consume(i);
+  if(inlen < FRAME_HDRLEN || memcmp(inbuf, "#XF", 3) != 0 ||
+     inlen < FRAME_HDRLEN + inbuf[7]) {
+    return 0;
+  }
+  return FRAME_HDRLEN + inbuf[7];
+}
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  const char *siodev = NULL, *node = NULL, *remote, *local;
+  speed_t speed = B115200;
+  int window = 8, force = 0;
+  int c, fd, len, frames, retries, rewinding;
+  uint32_t expected, offset, start;
+  unsigned short crc;
+  struct stat st;
+  double t;
+  char *p;
+
+  while((c = getopt(argc, argv, "s:B:w:n:fv")) != -1) {
+    switch(c) {
+    case 's':
+      siodev = optarg;
+      break;
+    case 'B':
+      speed = baudrate(atoi(optarg));
+      break;
+    case 'w':
+      window = atoi(optarg);
+      break;
+    case 'n':
+      node = optarg;
+      break;
+    case 'f':
+      force = 1;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    default:
+      usage();
+    }
+  }
+  if(optind >= argc || window < 2) {
+    usage();
+  }
+  remote = argv[optind];
+  local = optind + 1 < argc ? argv[optind + 1] : remote;
+
+  if(siodev != NULL) {
+    serial_open(siodev, speed);
+  }
+
+  fd = open(local, O_WRONLY | O_CREAT | (force ? O_TRUNC : 0), 0644);
+  if(fd < 0 || fstat(fd, &st) < 0) {
+    perror(local);
+    exit(1);
+  }
+  start = expected = st.st_size;
+  lseek(fd, expected, SEEK_SET);
+  if(expected > 0) {
+    fprintf(stderr, "shell-xfer: resuming at %lu bytes\n",
+	    (unsigned long)expected);
+  }
+
+  t = now();
+  if(node != NULL) {
+    send_line("xfer-fetch %s %s", node, remote);
+    p = wait_for_line("xfer-fetch: ", FETCH_TIMEOUT);
+    if(p == NULL || strncmp(p, "done", 4) != 0) {
+      fprintf(stderr, "shell-xfer: fetch from %s failed: %s\n", node,
+	      p == NULL ? "timeout" : p);
+      exit(1);
+    }
+    fprintf(stderr, "shell-xfer: fetched from %s: %s\n", node, p);
+  }
+
+  send_line("xfer-read %s %lu %d", remote, (unsigned long)expected, window);
+
+  frames = retries = rewinding = 0;
+  while(1) {
+    len = find_frame();
+    if(len == 0) {
+      if(!fill(TIMEOUT)) {
+	if(++retries > MAX_RETRIES) {
+	  fprintf(stderr, "shell-xfer: no answer after %lu bytes\n",
+		  (unsigned long)expected);
+	  exit(1);
+	}
+	send_line("r %lu", (unsigned long)expected);
+	rewinding = 1;
+      }
+      continue;
+    }
+
+    offset = ((uint32_t)inbuf[3] << 24) | ((uint32_t)inbuf[4] << 16) |
+      ((uint32_t)inbuf[5] << 8) | inbuf[6];
+    crc = (inbuf[8] << 8) | inbuf[9];
+    if(crc16_data(&inbuf[FRAME_HDRLEN], inbuf[7]) != crc) {
+      /* Possibly not a frame at all: only skip the marker. */
+      consume(3);
+      if(!rewinding) {
+	send_line("r %lu", (unsigned long)expected);
+	rewinding = 1;
+      }
+      continue;
+    }
+    if(offset != expected) {
+      consume(len);
+      if(!rewinding) {
+	send_line("r %lu", (unsigned long)expected);
+	rewinding = 1;
+      }
+      continue;
+    }
+
+    rewinding = 0;
+    retries = 0;
+    if(inbuf[7] == 0) {
+      break;
+    }
+    if(write(fd, &inbuf[FRAME_HDRLEN], inbuf[7]) != inbuf[7]) {
+      perror(local);
+      exit(1);
+    }
+    expected += inbuf[7];
+    consume(len);
+    if(++frames >= window / 2) {
+      frames = 0;
+      send_line("a %lu", (unsigned long)expected);
+    }
+  }
+  send_line("a %lu", (unsigned long)expected);
+  close(fd);
+
+  t = now() - t;
+  fprintf(stderr, "shell-xfer: %lu bytes in %.1f s (%.0f bytes/s)\n",
+	  (unsigned long)(expected - start), t,
+	  t > 0 ? (expected - start) / t : 0);
+  return 0;
+}
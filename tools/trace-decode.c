@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2013, Swedish Institute of Computer Science
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/*
+ * Decode the binary output of trace_dump() (core/sys/trace.h). The
+ * input may be interleaved with other serial output; everything
+ * outside of a dump is skipped. Each record is printed with its time
+ * in microseconds relative to the first record of the dump and the
+ * time since the previous record.
+ *
+ * Usage: trace-decode < dump
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *names[] = {
+  NULL,
+  "process_post",
+  "process_call",
+  "process_return",
+  "process_poll",
+  "rtimer_run",
+  "csma_queue",
+  "csma_send",
+  "csma_sent",
+};
+
+#define NUM_NAMES (sizeof(names) / sizeof(names[0]))
+
+/*---------------------------------------------------------------------------*/
+static unsigned long
+get(int len)
+{
+  unsigned long v;
+  int i, c;
+
+  for(v = 0, i = 0; i < len; i++) {
+    c = getchar();
+    if(c == EOF) {
+      fprintf(stderr, "trace-decode: truncated dump\n");
+      exit(1);
+    }
+    v |= (unsigned long)c << (8 * i);
+  }
+  return v;
+}
+/*---------------------------------------------------------------------------*/
+static void
+decode(void)
+{
+  unsigned long n, i, timesize, second, mask;
+  unsigned long id, arg, time, prev, elapsed;
+
+  n = get(2);
+  timesize = get(1);
+  second = get(4);
+  if(timesize < 1 || timesize > 4 || second == 0) {
+    fprintf(stderr, "trace-decode: bad dump header\n");
+    return;
+  }
+  mask = timesize == 4 ? 0xffffffffUL : (1UL << (8 * timesize)) - 1;
+
+  printf("# %lu records, %lu ticks per second\n", n, second);
+  elapsed = 0;
+  prev = 0;
+  for(i = 0; i < n; i++) {
+    id = get(2);
+    arg = get(2);
+    time = get(timesize);
+    /* Time stamps wrap around; add up the differences. */
+    if(i > 0) {
+      elapsed += (time - prev) & mask;
+    }
+    printf("%12.1f %10.1f  ",
+	   elapsed * 1e6 / second,
+	   i > 0 ? ((time - prev) & mask) * 1e6 / second : 0.0);
+    if(id < NUM_NAMES && names[id] != NULL) {
+      printf("%-16s", names[id]);
+    } else {
+      printf("%-16lu", id);
+    }
+    printf(" 0x%04lx\n", arg);
+    prev = time;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  int c, last;
+
+  last = EOF;
+  while((c = getchar()) != EOF) {
+    if(last == 'T' && c == 'R') {
+      decode();
+      c = EOF;
+    }
+    last = c;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
@@ -151,41 +151,28 @@ is_sensible_string(const unsigned char *s, int len)
 }
 
 /*
- * Read from serial, when we have a packet write it to tun. No output
- * buffering, input buffered by stdio.
+ * Handle one SLIP decoded byte from serial; when we have a packet
+ * write it to tun.
  */
-void
-serial_to_tun(FILE *inslip, int outfd)
+static void
+serial_input(int outfd, unsigned char c, int end)
 {
   static union {
     unsigned char inbuf[2000];
   } uip;
   static int inbufptr = 0;
-  int ret,i;
-  unsigned char c;
-
-#ifdef linux
-  ret = fread(&c, 1, 1, inslip);
-  if(ret == -1 || ret == 0) err(1, "serial_to_tun: read");
-  goto after_fread;
-#endif
+  int i;
 
- read_more:
   if(inbufptr >= sizeof(uip.inbuf)) {
      if(timestamp) stamptime();
      fprintf(stderr, "*** dropping large %d byte packet\n",inbufptr);
 	 inbufptr = 0;
   }
-  ret = fread(&c, 1, 1, inslip);
-#ifdef linux
- after_fread:
-#endif
-  if(ret == -1) {
-    err(1, "serial_to_tun: read");
-  }
-  if(ret == 0) {
-    clearerr(inslip);
-    return;
+  if(end) {
+    c = SLIP_END;
+  } else if(c == SLIP_END) {
+    /* Escaped END: data, not a frame delimiter */
+    goto data;
   }
   /*  fprintf(stderr, ".");*/
   switch(c) {
@@ -274,24 +261,8 @@ serial_to_tun(FILE *inslip, int outfd)
     }
     break;
 
-  case SLIP_ESC:
-    if(fread(&c, 1, 1, inslip) != 1) {
-      clearerr(inslip);
-      /* Put ESC back and give up! */
-      ungetc(SLIP_ESC, inslip);
-      return;
-    }
-
-    switch(c) {
-    case SLIP_ESC_END:
-      c = SLIP_END;
-      break;
-    case SLIP_ESC_ESC:
-      c = SLIP_ESC;
-      break;
-    }
-    /* FALLTHROUGH */
   default:
+  data:
     uip.inbuf[inbufptr++] = c;
 
     /* Echo lines as they are received for verbose=2,3,5+ */
@@ -313,11 +284,61 @@ serial_to_tun(FILE *inslip, int outfd)
     
     break;
   }
+}
 
-  goto read_more;
+/*
+ * Read from serial in bulk and SLIP decode in memory. The escape state
+ * is kept between calls, so frames may span several reads.
+ */
+void
+serial_to_tun(int infd, int outfd)
+{
+  static int esc = 0;
+  unsigned char buf[4096];
+  unsigned char c;
+  int ret, i;
+
+  ret = read(infd, buf, sizeof(buf));
+  if(ret == -1) {
+    if(errno == EAGAIN || errno == EINTR) {
+      return;
+    }
+    err(1, "serial_to_tun: read");
+  }
+  if(ret == 0) {
+#ifdef linux
+    err(1, "serial_to_tun: read");
+#endif
+    return;
+  }
+
+  for(i = 0; i < ret; i++) {
+    c = buf[i];
+    if(esc) {
+      esc = 0;
+      switch(c) {
+      case SLIP_ESC_END:
+        c = SLIP_END;
+        break;
+      case SLIP_ESC_ESC:
+        c = SLIP_ESC;
+        break;
+      }
+      serial_input(outfd, c, 0);
+    } else if(c == SLIP_ESC) {
+      esc = 1;
+    } else {
+      serial_input(outfd, c, c == SLIP_END);
+    }
+  }
 }
 
-unsigned char slip_buf[2000];
+/* Room for several escaped packets, so that packets from tun can be
+   queued and written to serial in bulk */
+#ifndef SLIP_BUFSIZE
+#define SLIP_BUFSIZE (8 * 2000)
+#endif
+unsigned char slip_buf[SLIP_BUFSIZE];
 int slip_end, slip_begin;
 
 void
@@ -354,6 +375,17 @@ slip_empty()
   return slip_end == 0;
 }
 
+int
+slip_space()
+{
+  if(slip_begin > 0) {
+    memmove(slip_buf, slip_buf + slip_begin, slip_end - slip_begin);
+    slip_end -= slip_begin;
+    slip_begin = 0;
+  }
+  return sizeof(slip_buf) - slip_end;
+}
+
 void
 slip_flushbuf(int fd)
 {
@@ -381,6 +413,7 @@ void
 write_to_serial(int outfd, void *inbuf, int len)
 {
   u_int8_t *p = inbuf;
+  unsigned char *q;
   int i;
 
   if(verbose>2) {
@@ -407,22 +440,28 @@ write_to_serial(int outfd, void *inbuf, int len)
    */
   /* slip_send(outfd, SLIP_END); */
 
+  /* Escape directly into the output buffer */
+  if(slip_space() < 2 * len + 1) {
+    err(1, "write_to_serial overflow");
+  }
+  q = slip_buf + slip_end;
   for(i = 0; i < len; i++) {
     switch(p[i]) {
     case SLIP_END:
-      slip_send(outfd, SLIP_ESC);
-      slip_send(outfd, SLIP_ESC_END);
+      *q++ = SLIP_ESC;
+      *q++ = SLIP_ESC_END;
       break;
     case SLIP_ESC:
-      slip_send(outfd, SLIP_ESC);
-      slip_send(outfd, SLIP_ESC_ESC);
+      *q++ = SLIP_ESC;
+      *q++ = SLIP_ESC_ESC;
       break;
     default:
-      slip_send(outfd, p[i]);
+      *q++ = p[i];
       break;
     }
   }
-  slip_send(outfd, SLIP_END);
+  *q++ = SLIP_END;
+  slip_end = q - slip_buf;
   PROGRESS("t");
 }
 
@@ -692,7 +731,6 @@ main(int argc, char **argv)
   int tunfd, maxfd;
   int ret;
   fd_set rset, wset;
-  FILE *inslip;
   const char *siodev = NULL;
   const char *host = NULL;
   const char *port = NULL;
@@ -912,8 +950,6 @@ exit(1);
     stty_telos(slipfd);
   }
   slip_send(slipfd, SLIP_END);
-  inslip = fdopen(slipfd, "r");
-  if(inslip == NULL) err(1, "main: fdopen");
 
   tunfd = tun_alloc(tundev, tap);
   if(tunfd == -1) err(1, "main: open");
@@ -951,8 +987,9 @@ exit(1);
     FD_SET(slipfd, &rset);	/* Read from slip ASAP! */
     if(slipfd > maxfd) maxfd = slipfd;
     
-    /* We only have one packet at a time queued for slip output. */
-    if(slip_empty()) {
+    /* Queue packets for slip output while there is room for one more.
+       With an outgoing packet delay, only one packet at a time. */
+    if(slip_space() >= 2 * 2000 + 1 && (basedelay == 0 || slip_empty())) {
       FD_SET(tunfd, &rset);
       if(tunfd > maxfd) maxfd = tunfd;
     }
@@ -962,7 +999,7 @@ exit(1);
       err(1, "select");
     } else if(ret > 0) {
       if(FD_ISSET(slipfd, &rset)) {
-        serial_to_tun(inslip, tunfd);
+        serial_to_tun(slipfd, tunfd);
       }
       
       if(FD_ISSET(slipfd, &wset)) {
@@ -982,7 +1019,7 @@ exit(1);
       }
       if(delaymsec==0) {
         int size;
-        if(slip_empty() && FD_ISSET(tunfd, &rset)) {
+        if(FD_ISSET(tunfd, &rset)) {
           size=tun_to_serial(tunfd, slipfd);
           slip_flushbuf(slipfd);
           sigalarm_reset();